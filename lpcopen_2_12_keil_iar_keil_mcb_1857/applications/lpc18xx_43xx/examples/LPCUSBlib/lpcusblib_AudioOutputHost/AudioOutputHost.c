@@ -47,6 +47,17 @@ static USB_ClassInfo_Audio_Host_t Speaker_Audio_Interface = {
 	},
 };
 
+/* Output stream format, the attached speaker must use the same sample size */
+#define AUDIO_SAMPLE_RATE           48000
+#define AUDIO_CHANNELS              2
+#define AUDIO_SUBFRAME_SIZE         3		/* bytes per sample, 3 for 24-bit, 2 for 16-bit devices */
+#define AUDIO_FRAME_BYTES           ((AUDIO_SAMPLE_RATE / 1000) * AUDIO_CHANNELS * AUDIO_SUBFRAME_SIZE)
+
+/* Frames queued ahead of the host controller, each slot is refilled as soon as it has been sent */
+#define AUDIO_RING_SLOTS            8
+
+static uint8_t AudioRing[AUDIO_RING_SLOTS * AUDIO_FRAME_BYTES];
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -55,30 +66,6 @@ static USB_ClassInfo_Audio_Host_t Speaker_Audio_Interface = {
  * Private functions
  ****************************************************************************/
 
-/* Timer setup for audio waveform */
-static void Init_Timer(uint32_t freq)
-{
-	/* Enable timer 1 clock and reset */
-	Chip_TIMER_Init(LPC_TIMER1);
-
-	/* Timer setup for match and interrupt at TICKRATE */
-	Chip_TIMER_Reset(LPC_TIMER1);
-	Chip_TIMER_MatchEnableInt(LPC_TIMER1, 1);
-	Chip_TIMER_SetMatch(LPC_TIMER1, 1, (1000000 / freq));
-	Chip_TIMER_ResetOnMatchEnable(LPC_TIMER1, 1);
-	Chip_TIMER_Enable(LPC_TIMER1);
-
-	NVIC_SetPriority(TIMER1_IRQn, ((0x01 << 3) | 0x01));
-	/* Enable timer interrupt */
-	NVIC_EnableIRQ(TIMER1_IRQn);
-}
-
-static void DeInitTimer(void)
-{
-	Chip_TIMER_Disable(LPC_TIMER1);
-	NVIC_DisableIRQ(TIMER1_IRQn);
-}
-
 /* Configures the board hardware and chip peripherals for the demo's functionality. */
 static void SetupHardware(void)
 {
@@ -98,22 +85,16 @@ static void SetupHardware(void)
 	Board_Buttons_Init();
 }
 
-/*****************************************************************************
- * Public functions
- ****************************************************************************/
-
-/**
- * @brief	ISR to handle the reloading of the PWM timer with the next sample
- * @return	Nothing
- */
 #define USE_TEST_TONE
-#if defined(__LPC175X_6X__) || defined(__LPC177X_8X__) || defined(__LPC407X_8X__) || defined(__LPC18XX__) || defined(__LPC43XX__)
-void TIMER1_IRQHandler(void)
+
+/* Fill one frame of the output stream, called from the USB interrupt as each frame slot is sent */
+static uint32_t AudioStreamFill(uint32_t PipeHandle, uint8_t *pBuffer, uint32_t MaxLength, void *pArg)
 {
-	uint8_t PrevPipe = Pipe_GetCurrentPipe(Speaker_Audio_Interface.Config.PortNumber);
-	/* Check that the USB bus is ready for the next sample to write */
-	if (Audio_Host_IsReadyForNextSample(&Speaker_Audio_Interface)) {
-		int16_t AudioSample;
+	uint32_t Len = 0;
+
+	while (Len + (AUDIO_CHANNELS * AUDIO_SUBFRAME_SIZE) <= MIN(MaxLength, AUDIO_FRAME_BYTES)) {
+		int32_t AudioSample;
+		uint8_t ch, i;
 #if defined(USE_TEST_TONE)
 		static uint8_t SquareWaveSampleCount;
 		static int16_t CurrentWaveValue;
@@ -135,14 +116,20 @@ void TIMER1_IRQHandler(void)
 #endif /* defined(MICROPHONE_BIASED_TO_HALF_RAIL) */
 #endif /* defined(USE_TEST_TONE) */
 
-		Audio_Host_WriteSample16(&Speaker_Audio_Interface, AudioSample);
-		Audio_Host_WriteSample16(&Speaker_Audio_Interface, AudioSample);
+		/* 16-bit sample left aligned in the subframe, little endian */
+		AudioSample *= 1 << ((AUDIO_SUBFRAME_SIZE - 2) * 8);
+		for (ch = 0; ch < AUDIO_CHANNELS; ch++) {
+			for (i = 0; i < AUDIO_SUBFRAME_SIZE; i++) {
+				pBuffer[Len++] = (uint8_t) (AudioSample >> (i * 8));
+			}
+		}
 	}
-
-	Pipe_SelectPipe(Speaker_Audio_Interface.Config.PortNumber, PrevPipe);
+	return Len;
 }
 
-#endif /* defined(__LPC17XX__) ... */
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
 
 /**
  * @brief	Main program entry point
@@ -176,7 +163,7 @@ void EVENT_USB_Host_DeviceAttached(const uint8_t corenum)
 void EVENT_USB_Host_DeviceUnattached(const uint8_t corenum)
 {
 	DEBUGOUT(("\r\nDevice Unattached on port %d\r\n"), corenum);
-	DeInitTimer();
+	Audio_Host_StopOutputStream(&Speaker_Audio_Interface);
 }
 
 /* Event handler for the USB_DeviceEnumerationComplete event. This indicates that a
@@ -215,7 +202,7 @@ void EVENT_USB_Host_DeviceEnumerationComplete(const uint8_t corenum)
 		return;
 	}
 
-	USB_Audio_SampleFreq_t SampleRate = AUDIO_SAMPLE_FREQ(48000);
+	USB_Audio_SampleFreq_t SampleRate = AUDIO_SAMPLE_FREQ(AUDIO_SAMPLE_RATE);
 	if (Audio_Host_GetSetEndpointProperty(&Speaker_Audio_Interface, Speaker_Audio_Interface.Config.DataOUTPipeNumber,
 										  AUDIO_REQ_SetCurrent, AUDIO_EPCONTROL_SamplingFreq,
 										  sizeof(SampleRate), &SampleRate) != HOST_SENDCONTROL_Successful) {
@@ -225,7 +212,12 @@ void EVENT_USB_Host_DeviceEnumerationComplete(const uint8_t corenum)
 		//return;
 	}
 	DEBUGOUT("Audio Device Enumerated.\r\n");
-	Init_Timer(48000);
+
+	if (Audio_Host_StartOutputStream(&Speaker_Audio_Interface, AudioRing, AUDIO_FRAME_BYTES, AUDIO_RING_SLOTS,
+									 AudioStreamFill, NULL) != HCD_STATUS_OK) {
+		DEBUGOUT("Error Starting Audio Output Stream, check the device supports %d byte frames.\r\n",
+				 AUDIO_FRAME_BYTES);
+	}
 }
 
 /* Event handler for the USB_HostError event. This indicates that a hardware error
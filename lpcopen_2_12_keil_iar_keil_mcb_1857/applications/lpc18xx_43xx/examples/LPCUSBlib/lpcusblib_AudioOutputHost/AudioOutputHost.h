@@ -46,9 +46,11 @@ extern "C" {
  * This example implements an audio interface class host mode device that enumerates
  * an audio interface class device (USB speakers) and sends samples to the device.
  *
- * The samples are created by a simple square wave generator in a timer ISR and
- * shipped out the streaming isochronous output pipe when a button is pressed on
- * the board.
+ * The samples are created by a simple square wave generator and shipped out the
+ * streaming isochronous output pipe when a button is pressed on the board. The
+ * stream runs at 48 kHz, 24-bit stereo (AUDIO_SUBFRAME_SIZE selects 16-bit) from a
+ * ring of 8 frames that the host driver refills from the USB interrupt, so no
+ * timer is used and a late main loop cannot cause gaps.
  * When the example is first run the terminal window will display:
  * Audio Output Host Demo running.
  *
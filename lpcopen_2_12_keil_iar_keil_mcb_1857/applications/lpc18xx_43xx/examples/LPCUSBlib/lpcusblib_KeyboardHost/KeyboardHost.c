@@ -36,6 +36,22 @@
  * Private types/enumerations/variables
  ****************************************************************************/
 
+/* Set to 1 to run the keyboard in Report protocol mode, decoding each report through a compiled parser table */
+#ifndef KEYBOARD_REPORT_PROTOCOL
+#define KEYBOARD_REPORT_PROTOCOL    0
+#endif
+
+/* HID usage page of keyboard key codes */
+#define KEYBOARD_USAGE_PAGE         0x07
+
+#if KEYBOARD_REPORT_PROTOCOL
+static HID_ReportInfo_t HIDReportInfo;
+static HID_CompiledReport_t HIDCompiledReport;
+
+/* First key code array item, looked up once at enumeration */
+static HID_ReportItem_t *KeyCodeItem;
+#endif
+
 /** LPCUSBlib HID Class driver interface configuration and state information. This structure is
  *  passed to all HID Class driver functions, so that multiple instances of the same class
  *  within a device can be differentiated from one another.
@@ -49,6 +65,10 @@ static USB_ClassInfo_HID_Host_t Keyboard_HID_Interface = {
 		.DataOUTPipeDoubleBank  = false,
 
 		.HIDInterfaceProtocol   = HID_CSCP_KeyboardBootProtocol,
+#if KEYBOARD_REPORT_PROTOCOL
+		.HIDParserData          = &HIDReportInfo,
+		.HIDCompiledData        = &HIDCompiledReport,
+#endif
 		.PortNumber = 0,
 	},
 };
@@ -71,10 +91,21 @@ static void KeyboardHost_Task(void)
 	}
 
 	if (HID_Host_IsReportReceived(&Keyboard_HID_Interface)) {
+#if KEYBOARD_REPORT_PROTOCOL
+		uint8_t KeyboardReport[64];
+
+		/* The class driver decodes the report items, only the cached key code item is read back */
+		if (HID_Host_ReceiveReport(&Keyboard_HID_Interface, KeyboardReport) != PIPE_RWSTREAM_NoError) {
+			return;
+		}
+
+		KeyCode = KeyCodeItem->Value;
+#else
 		USB_KeyboardReport_Data_t KeyboardReport;
 		HID_Host_ReceiveReport(&Keyboard_HID_Interface, &KeyboardReport);
 
 		KeyCode = KeyboardReport.KeyCode[0];
+#endif
 
 		if (KeyCode) {
 			char PressedKey = 0;
@@ -189,12 +220,38 @@ void EVENT_USB_Host_DeviceEnumerationComplete(const uint8_t corenum)
 		return;
 	}
 
+#if KEYBOARD_REPORT_PROTOCOL
+	if (HID_Host_SetReportProtocol(&Keyboard_HID_Interface) != 0) {
+		DEBUGOUT("Could not Set Report Protocol Mode.\r\n");
+
+		USB_Host_SetDeviceConfiguration(Keyboard_HID_Interface.Config.PortNumber, 0);
+		return;
+	}
+
+	KeyCodeItem = NULL;
+	for (uint8_t i = 0; i < HIDCompiledReport.TotalFields; i++) {
+		HID_ReportItem_t *ReportItem = HIDCompiledReport.Fields[i].Item;
+
+		if (!(ReportItem->ItemFlags & HID_IOF_VARIABLE)) {
+			KeyCodeItem = ReportItem;
+			break;
+		}
+	}
+
+	if ((KeyCodeItem == NULL) || (Keyboard_HID_Interface.State.LargestReportSize > 64)) {
+		DEBUGOUT("Unsupported Keyboard Report Layout.\r\n");
+
+		USB_Host_SetDeviceConfiguration(Keyboard_HID_Interface.Config.PortNumber, 0);
+		return;
+	}
+#else
 	if (HID_Host_SetBootProtocol(&Keyboard_HID_Interface) != 0) {
 		DEBUGOUT("Could not Set Boot Protocol Mode.\r\n");
 
 		USB_Host_SetDeviceConfiguration(Keyboard_HID_Interface.Config.PortNumber, 0);
 		return;
 	}
+#endif
 
 	DEBUGOUT("Keyboard Enumerated.\r\n");
 }
@@ -226,8 +283,13 @@ void EVENT_USB_Host_DeviceEnumerationFailed(const uint8_t corenum,
 			 corenum, ErrorCode, SubErrorCode, USB_HostState[corenum]);
 }
 
-/* Dummy callback function for HID Parser */
+/* HID Parser filter, only the keyboard key code items are kept in Report protocol mode */
 bool CALLBACK_HIDParser_FilterHIDReportItem(HID_ReportItem_t *const CurrentItem)
 {
+#if KEYBOARD_REPORT_PROTOCOL
+	return (CurrentItem->ItemType == HID_REPORT_ITEM_In) &&
+		   (CurrentItem->Attributes.Usage.Page == KEYBOARD_USAGE_PAGE);
+#else
 	return true;
+#endif
 }
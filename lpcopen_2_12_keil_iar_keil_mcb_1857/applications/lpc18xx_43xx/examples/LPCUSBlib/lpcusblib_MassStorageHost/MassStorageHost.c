@@ -33,6 +33,7 @@
 #include "MassStorageHost.h"
 #include "fsusb_cfg.h"
 #include "ff.h"
+#include "stopwatch.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -42,6 +43,9 @@
  *  passed to all Mass Storage Class driver functions, so that multiple instances of the same class
  *  within a device can be differentiated from one another.
  */
+/* Sequential read-ahead cache of the class driver, FatFs reads one sector at a time */
+static uint8_t ReadAheadCache[16 * 512];
+
 static USB_ClassInfo_MS_Host_t FlashDisk_MS_Interface = {
 	.Config = {
 		.DataINPipeNumber       = 1,
@@ -50,15 +54,41 @@ static USB_ClassInfo_MS_Host_t FlashDisk_MS_Interface = {
 		.DataOUTPipeNumber      = 2,
 		.DataOUTPipeDoubleBank  = false,
 		.PortNumber = 0,
+
+		.ReadAheadBuffer        = ReadAheadCache,
+		.ReadAheadBufferSize    = sizeof(ReadAheadCache),
 	},
 };
 
 static SCSI_Capacity_t DiskCapacity;
+
+/* Largest READ(10)/WRITE(10) data phase, the host driver chains qTDs across the whole command */
+#define MS_MAX_XFER_SIZE        (128 * 1024)
 static uint8_t buffer[8 * 1024];
 
 STATIC FATFS fatFS;	/* File system object */
 STATIC FIL fileObj;	/* File object */
 
+/* Set to 1 to sweep raw LBA and FatFs throughput after the functional test */
+#ifndef MS_BENCHMARK
+#define MS_BENCHMARK            0
+#endif
+
+#if MS_BENCHMARK
+/* Bytes moved per benchmark case, split into commands of the swept size */
+#define MS_BENCH_TOTAL_SIZE     (1024 * 1024)
+#define MS_BENCH_MIN_SIZE       512
+
+#if defined(FRAMEBUFFER_ADDR)
+/* Internal SRAM cannot hold a 128KB buffer, borrow the (unused) LCD frame buffer in SDRAM */
+#define MS_BENCH_MAX_SIZE       MS_MAX_XFER_SIZE
+#define benchBuffer             ((uint8_t *) FRAMEBUFFER_ADDR)
+#else
+#define MS_BENCH_MAX_SIZE       sizeof(buffer)
+#define benchBuffer             buffer
+#endif
+#endif /* MS_BENCHMARK */
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -91,8 +121,140 @@ static void SetupHardware(void)
 	USB_Init(FlashDisk_MS_Interface.Config.PortNumber, USB_MODE_Host);
 	/* Hardware Initialization */
 	Board_Debug_Init();
+#if MS_BENCHMARK
+	StopWatch_Init();
+#endif
+}
+
+#if MS_BENCHMARK
+/* Print one benchmark result line, rate in MB/s (10^6 bytes) with two decimals */
+static void BenchReport(const char *name, uint32_t size, uint32_t bytes, uint32_t cmds, uint32_t us)
+{
+	char debugBuf[96];
+	uint32_t rate;
+
+	if (us == 0) {
+		us = 1;
+	}
+	rate = (uint32_t) (((uint64_t) bytes * 100) / us);
+	sprintf(debugBuf, "%-6s %7lu B  %4lu.%02lu MB/s  %7lu us/cmd\r\n", name, size,
+			rate / 100, rate % 100, us / cmds);
+	DEBUGOUT(debugBuf);
 }
 
+/* Raw LBA sweep, the write pass puts back the data just read so the medium is left unchanged */
+static void BenchRaw(DISK_HANDLE_T *hDisk)
+{
+	uint32_t size, i, t, us, wrUs;
+	uint32_t blockSize = DiskCapacity.BlockSize;
+	uint32_t lba = DiskCapacity.Blocks / 2;
+
+	if ((blockSize == 0) || (DiskCapacity.Blocks < (2 * MS_BENCH_TOTAL_SIZE / blockSize))) {
+		DEBUGOUT("Disk too small for raw benchmark.\r\n");
+		return;
+	}
+
+	for (size = MS_BENCH_MIN_SIZE; size <= MS_BENCH_MAX_SIZE; size <<= 1) {
+		uint32_t numSec = size / blockSize;
+		uint32_t cmds = MS_BENCH_TOTAL_SIZE / size;
+
+		if (numSec == 0) {
+			continue;
+		}
+
+		us = 0;
+		for (i = 0; i < cmds; i++) {
+			t = StopWatch_Start();
+			if (!FSUSB_DiskReadSectors(hDisk, benchBuffer, lba + i * numSec, numSec)) {
+				return;
+			}
+			us += StopWatch_TicksToUs(StopWatch_Elapsed(t));
+		}
+		BenchReport("LBA rd", size, cmds * numSec * blockSize, cmds, us);
+
+		wrUs = 0;
+		for (i = 0; i < cmds; i++) {
+			if (!FSUSB_DiskReadSectors(hDisk, benchBuffer, lba + i * numSec, numSec)) {
+				return;
+			}
+			t = StopWatch_Start();
+			if (!FSUSB_DiskWriteSectors(hDisk, benchBuffer, lba + i * numSec, numSec)) {
+				return;
+			}
+			wrUs += StopWatch_TicksToUs(StopWatch_Elapsed(t));
+		}
+		BenchReport("LBA wr", size, cmds * numSec * blockSize, cmds, wrUs);
+	}
+}
+
+/* FatFs sweep on BENCH.BIN, the close is timed with the last command so cached data is counted */
+static void BenchFile(void)
+{
+	FRESULT rc;
+	UINT bw, br;
+	uint32_t size, i, t, us;
+
+	for (size = MS_BENCH_MIN_SIZE; size <= MS_BENCH_MAX_SIZE; size <<= 1) {
+		uint32_t cmds = MS_BENCH_TOTAL_SIZE / size;
+
+		memset(benchBuffer, (uint8_t) size, size);
+		rc = f_open(&fileObj, "BENCH.BIN", FA_WRITE | FA_CREATE_ALWAYS);
+		if (rc) {
+			die(rc);
+			return;
+		}
+		us = 0;
+		for (i = 0; i < cmds; i++) {
+			t = StopWatch_Start();
+			rc = f_write(&fileObj, benchBuffer, size, &bw);
+			if ((i + 1) == cmds) {
+				rc |= f_close(&fileObj);
+			}
+			us += StopWatch_TicksToUs(StopWatch_Elapsed(t));
+			if (rc || (bw != size)) {
+				f_close(&fileObj);
+				die(rc);
+				return;
+			}
+		}
+		BenchReport("FAT wr", size, cmds * size, cmds, us);
+
+		rc = f_open(&fileObj, "BENCH.BIN", FA_READ);
+		if (rc) {
+			die(rc);
+			return;
+		}
+		us = 0;
+		for (i = 0; i < cmds; i++) {
+			t = StopWatch_Start();
+			rc = f_read(&fileObj, benchBuffer, size, &br);
+			us += StopWatch_TicksToUs(StopWatch_Elapsed(t));
+			if (rc || (br != size)) {
+				break;
+			}
+		}
+		f_close(&fileObj);
+		if (rc || (br != size)) {
+			die(rc);
+			return;
+		}
+		BenchReport("FAT rd", size, cmds * size, cmds, us);
+	}
+}
+
+/* Throughput sweep from 512B to MS_BENCH_MAX_SIZE, raw LBA access first then FatFs file I/O */
+static void USB_Benchmark(void)
+{
+	char debugBuf[64];
+
+	sprintf(debugBuf, "\r\nBenchmark: %lu KB per case.\r\n", (uint32_t) (MS_BENCH_TOTAL_SIZE / 1024));
+	DEBUGOUT(debugBuf);
+	BenchRaw(&FlashDisk_MS_Interface);
+	BenchFile();
+}
+
+#endif /* MS_BENCHMARK */
+
 /* Function to do the read/write to USB Disk */
 static void USB_ReadWriteFile(void)
 {
@@ -183,6 +345,9 @@ static void USB_ReadWriteFile(void)
 			die(rc);
 		}
 	}
+#if MS_BENCHMARK
+	USB_Benchmark();
+#endif
 	DEBUGOUT("\r\nTest completed.\r\n");
 	USB_Host_SetDeviceConfiguration(FlashDisk_MS_Interface.Config.PortNumber, 0);
 }
@@ -377,10 +542,19 @@ uint32_t FSUSB_DiskGetSectorSz(DISK_HANDLE_T *hDisk)
 /* Read sectors */
 int FSUSB_DiskReadSectors(DISK_HANDLE_T *hDisk, void *buff, uint32_t secStart, uint32_t numSec)
 {
-	if (MS_Host_ReadDeviceBlocks(hDisk, 0, secStart, numSec, DiskCapacity.BlockSize, buff)) {
-		DEBUGOUT("Error reading device block.\r\n");
-		USB_Host_SetDeviceConfiguration(FlashDisk_MS_Interface.Config.PortNumber, 0);
-		return 0;
+	uint32_t maxSec = MS_MAX_XFER_SIZE / DiskCapacity.BlockSize;
+
+	while (numSec > 0) {
+		uint32_t cnt = MIN(numSec, maxSec);
+
+		if (MS_Host_ReadDeviceBlocks(hDisk, 0, secStart, cnt, DiskCapacity.BlockSize, buff)) {
+			DEBUGOUT("Error reading device block.\r\n");
+			USB_Host_SetDeviceConfiguration(FlashDisk_MS_Interface.Config.PortNumber, 0);
+			return 0;
+		}
+		buff = (uint8_t *) buff + cnt * DiskCapacity.BlockSize;
+		secStart += cnt;
+		numSec -= cnt;
 	}
 	return 1;
 }
@@ -388,9 +562,18 @@ int FSUSB_DiskReadSectors(DISK_HANDLE_T *hDisk, void *buff, uint32_t secStart, u
 /* Write Sectors */
 int FSUSB_DiskWriteSectors(DISK_HANDLE_T *hDisk, void *buff, uint32_t secStart, uint32_t numSec)
 {
-	if (MS_Host_WriteDeviceBlocks(hDisk, 0, secStart, numSec, DiskCapacity.BlockSize, buff)) {
-		DEBUGOUT("Error writing device block.\r\n");
-		return 0;
+	uint32_t maxSec = MS_MAX_XFER_SIZE / DiskCapacity.BlockSize;
+
+	while (numSec > 0) {
+		uint32_t cnt = MIN(numSec, maxSec);
+
+		if (MS_Host_WriteDeviceBlocks(hDisk, 0, secStart, cnt, DiskCapacity.BlockSize, buff)) {
+			DEBUGOUT("Error writing device block.\r\n");
+			return 0;
+		}
+		buff = (uint8_t *) buff + cnt * DiskCapacity.BlockSize;
+		secStart += cnt;
+		numSec -= cnt;
 	}
 	return 1;
 }
@@ -90,6 +90,16 @@ typedef int32_t (*progalgo_read)(void *, uint32_t, uint32_t);
 /* Pointer to programming algorithm close function */
 typedef void (*progalgo_close)(uint32_t start);
 
+/*
+ * Pointer to programming algorithm erase-ahead function (optional)
+ * First parameter is the address of the next erase unit to erase
+ * Second parameter is the number of bytes still pending in the erase range
+ * Erases the single erase unit (sector/block) at the address, skipping the
+ * erase if the unit is already blank.
+ * Returns bytes of the pending range covered by the unit or 0 on failure
+ */
+typedef int32_t (*progalgo_erase_next)(uint32_t, uint32_t);
+
 /* Pointer to programming algorithm region erase function */
 typedef struct {
 	progalgo_init			init;
@@ -98,6 +108,7 @@ typedef struct {
 	progalgo_write			write;
 	progalgo_read			read;
 	progalgo_close			close;
+	progalgo_erase_next		erase_next;	/* NULL if erase-ahead is not supported */
 } PROGALGOS_T;
 
 /* Maximum number of supported regions and algorithms */
@@ -143,7 +154,9 @@ typedef enum {
 	DFU_HOSTCMD_PROGRAM,		/* Program a region defined with addr/size */
 	DFU_HOSTCMD_READBACK,		/* Read a region defined with addr/size */
 	DFU_HOSTCMD_RESET,			/* Reset the device/board */
-	DFU_HOSTCMD_EXECUTE
+	DFU_HOSTCMD_EXECUTE,		/* Jump to an address */
+	DFU_HOSTCMD_PROGRAM_LZ,		/* Program a region from a compressed (usbd_dfulz) stream */
+	DFU_HOSTCMD_CRC32			/* CRC-32 of a region defined with addr/size, read back as 4 bytes */
 } DFU_HOSTCMD_T;
 
 /* Host DFU download packet header. This is appended to a data packet when
@@ -159,8 +172,10 @@ typedef struct {
 	/* ERASE/PROG/READ command: start of program/erase/read region, or execute address */
 	/* RESET command: Argument not used */
 	/* EXECUTE command: Address to jump to */
+	/* PROGRAM_LZ command: start of program region */
+	/* CRC32 command: start of the region to checksum */
 	uint32_t addr;
-	uint32_t size;			/* Size of program/erase/read region */
+	uint32_t size;			/* Size of program/erase/read region, compressed stream size for PROGRAM_LZ */
 	uint32_t magic;			/* Should be DFUPROG_VALIDVAL */
 //	uint32_t options[4];	/* Option values */
 } DFU_FROMHOST_PACKETHDR_T;
@@ -218,6 +233,7 @@ int32_t algo_root_erase_all(uint32_t addr);
 int32_t algo_root_write(void *buff, uint32_t addr, uint32_t size);
 int32_t algo_root_read(void *buff, uint32_t addr, uint32_t size);
 bool algo_root_close(uint32_t addr);
+bool algo_root_erase_ahead(void);
 
 /* Programming algorithm Init functins */
 int32_t progalgo_intflash_init(struct DFUPROG_REGION *reg, int32_t avail);
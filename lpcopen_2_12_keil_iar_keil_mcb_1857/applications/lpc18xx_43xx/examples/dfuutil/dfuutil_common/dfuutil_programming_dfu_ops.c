@@ -40,6 +40,7 @@
 
 #include "board.h"
 #include "dfuutil_programming_api.h"
+#include "usbd_dfulz.h"
 
 #include "string.h"
 
@@ -68,6 +69,9 @@ static volatile uint32_t currCmdAddr, currCmdSize;
 /* Time counter in 1mS ticks */
 static volatile uint32_t u32Milliseconds;
 
+/* Free running 1mS tick count, used to time programming */
+static volatile uint32_t u32Ticks;
+
 /* Size of USB debug message buffer */
 #define USBMSGBUFFSIZE 2048
 
@@ -83,11 +87,40 @@ static uint32_t dfuIn[((sizeof(DFU_TOHOST_PACKETHDR_T) + 64 + 4096) /
 static uint32_t dfuOut[((sizeof(DFU_FROMHOST_PACKETHDR_T) + 4096 +
 						 sizeof(uint32_t)) / sizeof(uint32_t))];
 
-/* Program data buffer (to free up USB buffer) */
-static uint32_t dfuProgBuff[(4096 / sizeof(uint32_t))];
+/* Program data buffers (to free up USB buffer). Block N is programmed from
+   one while block N+1 is received into the other. */
+#define DFUPROGBUFFS 2
+static uint32_t dfuProgBuff[DFUPROGBUFFS][(4096 / sizeof(uint32_t))];
+
+/* Queued program size (0 = free) and address for each program buffer */
+static volatile uint32_t progSize[DFUPROGBUFFS], progAddr[DFUPROGBUFFS];
+
+/* Program buffer being received and next program buffer to program */
+static volatile uint32_t progRxIdx, progIdx;
+
+/* Decoder for a PROGRAM_LZ stream, its output block and the address the
+   next decoded block is programmed at. Compressed program buffers are
+   queued like raw ones and decoded by the background loop. */
+static bool progLz;
+static DFULZ_T dfuLz;
+static uint32_t dfuLzOut[DFULZ_MAX_BLOCK / sizeof(uint32_t)];
+static uint32_t lzAddr;
+
+/* A DFU_HOSTCMD_CRC32 runs as a readback: the background loop reads the
+   region a buffer at a time into the CRC and the host reads the result
+   as a 4 byte block */
+static bool crcRegion;
+static uint32_t crcValue;
+
+/* Measured programming time for one buffer in mS, reported to the host
+   as the poll timeout when it has to wait for a free buffer */
+static uint32_t progTimeMs = 1;
 
 /* IN packet indexing and size */
-static volatile uint32_t inPktSize, inPktSizeIdx, outPktSizeIdx, progSize;
+static volatile uint32_t inPktSize, inPktSizeIdx, outPktSizeIdx;
+
+/* USB interrupt in use, masked while the programming queue is updated */
+static IRQn_Type usbIrq;
 
 /* Be careful with this number, as the linker may be setup to use ranges
    just outside this area's size */
@@ -265,16 +298,32 @@ static void usbDFUEraseRegion(uint32_t addr, uint32_t size)
 	currCmdSize = size;
 }
 
-/* Respond to DFU_HOSTCMD_PROGRAM command */
-static void usbDFUProgRegion(uint32_t addr, uint32_t size)
+/* Respond to DFU_HOSTCMD_PROGRAM and DFU_HOSTCMD_PROGRAM_LZ commands */
+static void usbDFUProgRegion(uint32_t cmd, uint32_t addr, uint32_t size)
 {
+	int32_t regIndex;
+	uint32_t maxRaw = 0;
+
 	/* Set erase start state so it starts in the background. */
 	currStatus = DFU_OPSTS_PROG_STREAM;
-	hostCmd = DFU_HOSTCMD_PROGRAM;
+	hostCmd = cmd;
 
-	/* Save program address and size */
+	/* Save program address and size, for a compressed stream the size
+	   counts stream bytes and lzAddr tracks the programmed address */
 	currCmdAddr = addr;
 	currCmdSize = size;
+
+	progLz = (bool) (cmd == DFU_HOSTCMD_PROGRAM_LZ);
+	if (progLz) {
+		/* The decoded image has to fit in the region it starts in */
+		regIndex = algo_root_isRegionValid(addr, 1);
+		if (regIndex >= 0) {
+			maxRaw = dfuRegionList.regionList[regIndex].region_addr +
+					 dfuRegionList.regionList[regIndex].region_size - addr;
+		}
+		DfuLz_Init(&dfuLz, maxRaw);
+		lzAddr = addr;
+	}
 }
 
 /* Respond to DFU_HOSTCMD_READBACK command */
@@ -289,6 +338,15 @@ static void usbDFUReadRegion(uint32_t addr, uint32_t size)
 	currCmdSize = size;
 }
 
+/* Respond to DFU_HOSTCMD_CRC32 command */
+static void usbDFUCrcRegion(uint32_t addr, uint32_t size)
+{
+	crcRegion = true;
+	crcValue = 0;
+	usbDFUReadRegion(addr, size);
+	hostCmd = DFU_HOSTCMD_CRC32;
+}
+
 /* Respond to DFU_HOSTCMD_RESET command */
 static void usbDFUReset(void)
 {
@@ -343,6 +401,43 @@ static bool checkMagicHeader(DFU_FROMHOST_PACKETHDR_T *pOutHdr)
 	return true;
 }
 
+/* Set the 24-bit bwPollTimeout field of the next GETSTATUS response */
+static void dfuSetPollTimeout(uint8_t *bwPollTimeout, uint32_t ms)
+{
+	bwPollTimeout[0] = (uint8_t) ms;
+	bwPollTimeout[1] = (uint8_t) (ms >> 8);
+	bwPollTimeout[2] = (uint8_t) (ms >> 16);
+}
+
+/* Queue a received program buffer and switch reception to the other one */
+static void dfuQueueProgBuff(uint8_t *bwPollTimeout)
+{
+	uint32_t idx = progRxIdx;
+	bool last;
+
+	progAddr[idx] = currCmdAddr;
+	progSize[idx] = outPktSizeIdx;
+	currCmdAddr += outPktSizeIdx;
+	currCmdSize -= outPktSizeIdx;
+
+	/* A short buffer ends the stream */
+	last = (outPktSizeIdx < buffer_size) || (currCmdSize == 0);
+	if (last) {
+		currCmdSize = 0;
+	}
+
+	progRxIdx = idx ^ 1;
+	if ((last == false) && (progSize[progRxIdx] == 0)) {
+		/* The other buffer is free, host can send the next block right away */
+		dfuSetPollTimeout(bwPollTimeout, 0);
+	}
+	else {
+		/* Host has to wait until a buffer has been programmed */
+		currStatus = DFU_OPSTS_PROG;
+		dfuSetPollTimeout(bwPollTimeout, progTimeMs);
+	}
+}
+
 /* Handles OUT (from host) packets and requests from host */
 static uint8_t dfu_wr(uint32_t block_num, uint8_t * *pBuff, uint32_t length,
 					  uint8_t *bwPollTimeout)
@@ -361,13 +456,11 @@ static uint8_t dfu_wr(uint32_t block_num, uint8_t * *pBuff, uint32_t length,
 	if (currStatus == DFU_OPSTS_PROG_STREAM) {
 		if (length == 0) {
 			outPktSizeIdx = 0;
-			*pBuff = (uint8_t *) dfuProgBuff;
+			*pBuff = (uint8_t *) dfuProgBuff[progRxIdx];
 		}
 		else if ((outPktSizeIdx == buffer_size) ||
 				 (outPktSizeIdx == currCmdSize)) {
-			currStatus = DFU_OPSTS_PROG;
-			progSize = outPktSizeIdx;
-			currCmdSize -= outPktSizeIdx;
+			dfuQueueProgBuff(bwPollTimeout);
 			outPktSizeIdx = 0;
 			*pBuff = (uint8_t *) dfuIn;
 		}
@@ -402,16 +495,23 @@ static uint8_t dfu_wr(uint32_t block_num, uint8_t * *pBuff, uint32_t length,
 			break;
 
 		case DFU_HOSTCMD_PROGRAM:
+		case DFU_HOSTCMD_PROGRAM_LZ:
 			/* Only called in stream mode */
-			usbDFUProgRegion(addr, size);
+			usbDFUProgRegion(pOutHdr->hostCmd, addr, size);
+			progSize[0] = progSize[1] = 0;
+			progRxIdx = progIdx = 0;
 			outPktSizeIdx = 0;
-			*pBuff = (uint8_t *) dfuProgBuff;
+			*pBuff = (uint8_t *) dfuProgBuff[progRxIdx];
 			return DFU_STATUS_OK;
 
 		case DFU_HOSTCMD_READBACK:
 			usbDFUReadRegion(addr, size);
 			break;
 
+		case DFU_HOSTCMD_CRC32:
+			usbDFUCrcRegion(addr, size);
+			break;
+
 		case DFU_HOSTCMD_RESET:
 			usbDFUReset();
 			break;
@@ -497,7 +597,7 @@ static uint32_t dfu_rd(uint32_t block_num, uint8_t * *pBuff, uint32_t length)
 			}
 			currCmdSize -= inPktSize;
 			inPktSizeIdx = 0;
-			ptrCurr = (uint8_t *) dfuProgBuff;
+			ptrCurr = (uint8_t *) dfuProgBuff[0];
 		}
 
 		if (inPktSize != 0) {
@@ -640,11 +740,12 @@ static uint32_t algo_dfu_setup(void)
 		}
 
 		if ((LPC_SCU->SFSUSB & (1 << 4)) == 0) {
-			NVIC_EnableIRQ(USB0_IRQn);
+			usbIrq = USB0_IRQn;
 		}
 		else {
-			NVIC_EnableIRQ(USB1_IRQn);
+			usbIrq = USB1_IRQn;
 		}
+		NVIC_EnableIRQ(usbIrq);
 	}
 
 	tickDelayMS(900);
@@ -678,6 +779,88 @@ static void usbPLLSetup(void)
 	   boot ROM on USB boot */
 }
 
+/* Decode a compressed program buffer and program the blocks it completes */
+static bool dfuLzProgram(const uint8_t *pIn, uint32_t len)
+{
+	int32_t n;
+
+	while (len != 0) {
+		n = DfuLz_Feed(&dfuLz, &pIn, &len, (uint8_t *) dfuLzOut);
+		if (n < 0) {
+			DFUDEBUG("Compressed image rejected before 0x%p\n", (void *) lzAddr);
+			return false;
+		}
+		if ((n > 0) && (algo_root_write((void *) dfuLzOut, lzAddr, n) != n)) {
+			return false;
+		}
+		lzAddr += n;
+	}
+
+	return true;
+}
+
+/* Program the next queued buffer, also moves the stream state on */
+static void dfuProgNext(void)
+{
+	uint32_t idx = progIdx, t, sz = progSize[idx];
+	bool ok, truncated = false;
+
+	if (sz == 0) {
+		/* Nothing queued, done once the last block has been programmed */
+		NVIC_DisableIRQ(usbIrq);
+		if ((currStatus == DFU_OPSTS_PROG) && (progSize[idx ^ 1] == 0)) {
+			currStatus = DFU_OPSTS_IDLE;
+		}
+		NVIC_EnableIRQ(usbIrq);
+
+		/* Erase upcoming sectors while waiting for the host */
+		if (algo_root_erase_ahead() == false) {
+			__WFI();
+		}
+		return;
+	}
+
+	/* USB keeps receiving into the other buffer while this one is programmed */
+	t = u32Ticks;
+	if (progLz) {
+		ok = dfuLzProgram((const uint8_t *) dfuProgBuff[idx], sz);
+	}
+	else {
+		ok = (algo_root_write((void *) dfuProgBuff[idx], progAddr[idx], sz) == sz);
+	}
+	t = u32Ticks - t;
+
+	/* Smoothed time per buffer, at least 1mS */
+	progTimeMs = ((progTimeMs * 3) + t + 3) / 4;
+	if (progTimeMs == 0) {
+		progTimeMs = 1;
+	}
+
+	NVIC_DisableIRQ(usbIrq);
+	progSize[idx] = 0;
+	progIdx = idx ^ 1;
+	if (ok && progLz && (currCmdSize == 0) && (progSize[idx ^ 1] == 0) &&
+		(DfuLz_IsDone(&dfuLz) == false)) {
+		/* Stream ended before the last block of the image */
+		truncated = true;
+		ok = false;
+	}
+	if (ok == false) {
+		progSize[0] = progSize[1] = 0;
+		currStatus = DFU_OPSTS_PROGER;
+	}
+	else if ((currStatus == DFU_OPSTS_PROG) && (currCmdSize != 0) && (progSize[progRxIdx] == 0)) {
+		/* Host was waiting for a free buffer */
+		currStatus = DFU_OPSTS_PROG_STREAM;
+	}
+	NVIC_EnableIRQ(usbIrq);
+
+	if (truncated) {
+		DFUDEBUG("Compressed image ended at 0x%p, short of %p bytes\n", (void *) lzAddr,
+				 (void *) (dfuLz.hdr.raw_size - dfuLz.raw_done));
+	}
+}
+
 /* DFU processing entry point */
 static void dfu_util_process(void)
 {
@@ -711,7 +894,11 @@ static void dfu_util_process(void)
 		/* Background processing loop */
 		switch (currStatus) {
 		case DFU_OPSTS_IDLE:
-		/* Do nothing when idle */
+			/* Keep erasing a scheduled erase range when idle */
+			if (algo_root_erase_ahead()) {
+				break;
+			}
+		/* Otherwise do nothing when idle */
 		case DFU_OPSTS_ERRER:
 		case DFU_OPSTS_READER:
 		case DFU_OPSTS_PROGER:
@@ -728,7 +915,25 @@ static void dfu_util_process(void)
 			if (blks > buffer_size) {
 				blks = buffer_size;
 			}
-			if (algo_root_read(dfuProgBuff, currCmdAddr, blks) == 0) {
+			if (crcRegion) {
+				/* fold the region into the CRC, then hand out the result */
+				if (blks == 0) {
+					memcpy(dfuProgBuff[0], &crcValue, 4);
+					currCmdSize = 4;
+					crcRegion = false;
+					currStatus = DFU_OPSTS_READTRIG;
+				}
+				else if (algo_root_read(dfuProgBuff[0], currCmdAddr, blks) == 0) {
+					crcRegion = false;
+					currStatus = DFU_OPSTS_READER;
+				}
+				else {
+					crcValue = Chip_CRCSW_CRC32(crcValue, dfuProgBuff[0], blks);
+					currCmdAddr += blks;
+					currCmdSize -= blks;
+				}
+			}
+			else if (algo_root_read(dfuProgBuff[0], currCmdAddr, blks) == 0) {
 				currStatus = DFU_OPSTS_READER;
 			}
 			else {
@@ -768,28 +973,9 @@ static void dfu_util_process(void)
 			break;
 
 		case DFU_OPSTS_PROG_STREAM:
-			/* Nothing to do in this state */
-			__WFI();
-			break;
-
 		case DFU_OPSTS_PROG:
-			if (progSize == 0) {
-				/* Done, go back to idle */
-				currStatus = DFU_OPSTS_IDLE;
-			}
-			else {
-				if (algo_root_write((void *) dfuProgBuff, currCmdAddr, progSize) != progSize) {
-					currStatus = DFU_OPSTS_PROGER;
-				}
-				else if ((progSize < buffer_size) ||
-						 (currCmdSize == 0)) {
-					currStatus = DFU_OPSTS_IDLE;
-				}
-				else {
-					currStatus = DFU_OPSTS_PROG_STREAM;
-					currCmdAddr += progSize;
-				}
-			}
+			/* Program queued buffers while the host streams the next one */
+			dfuProgNext();
 			break;
 
 		case DFU_OPSTS_RESET:
@@ -832,6 +1018,7 @@ static void dfu_util_process(void)
  */
 void SysTick_Handler(void)
 {
+	u32Ticks++;
 	if (u32Milliseconds > 0) {
 		u32Milliseconds--;
 	}
@@ -98,6 +98,7 @@ static int32_t progalgo_intflash_erase_all(uint32_t start, uint32_t size);
 static int32_t progalgo_intflash_write(void *buff, uint32_t start, uint32_t size);
 static int32_t progalgo_intflash_read(void *buff, uint32_t start, uint32_t size);
 static void progalgo_intflash_close(uint32_t start);
+static int32_t progalgo_intflash_erase_next(uint32_t start, uint32_t size);
 
 /* Function table for exposed API functions */
 static const PROGALGOS_T palgos = {
@@ -107,6 +108,7 @@ static const PROGALGOS_T palgos = {
 	progalgo_intflash_write,
 	progalgo_intflash_read,
 	progalgo_intflash_close,
+	progalgo_intflash_erase_next,
 };
 
 /* Number of program regions */
@@ -360,6 +362,50 @@ static int32_t progalgo_intflash_erase_region(uint32_t start, uint32_t size)
 	return size;
 }
 
+/* Erase the single sector starting at the passed address, sectors that
+   are already blank are not erased again */
+static int32_t progalgo_intflash_erase_next(uint32_t start, uint32_t size)
+{
+	int bank, aligned;
+	uint32_t secstart, secend, secsize;
+
+	/* Get sector and bank info for the first page of the range */
+	if ((progalgo_iflash_progaddrvalid(start, PAGE_SIZE) == 0) ||
+		(progalgo_iflash_find_sectorrange(start, PAGE_SIZE, &bank,
+										  &secstart, &secend, &aligned) == 0)) {
+		DFUDEBUG("FLASHERASE: sector lookup failure @ %p\r\n", (void *) start);
+		return 0;
+	}
+
+	/* The sector must start at the address and fit in the range */
+	secsize = sectorinfo[secstart].sector_size;
+	if ((start != (pregions[bank].region_addr + sectorinfo[secstart].sector_offset)) ||
+		(secsize > size)) {
+		DFUDEBUG("FLASHERASE: Address range must be sector aligned\r\n");
+		return 0;
+	}
+
+	/* Skip the erase cycle for a blank sector */
+	if (Chip_IAP_BlankCheckSector(secstart, secstart, bank) == IAP_CMD_SUCCESS) {
+		return secsize;
+	}
+
+	DFUDEBUG("FLASHERASE: Bank %d, sec %d\n", bank, secstart);
+
+	if (progalgo_iflash_prepwrite(bank, secstart, secstart) != IAP_CMD_SUCCESS) {
+		return 0;
+	}
+	if (progalgo_iflash_erasesectors(bank, secstart, secstart) != IAP_CMD_SUCCESS) {
+		return 0;
+	}
+	if (Chip_IAP_BlankCheckSector(secstart, secstart, bank) != IAP_CMD_SUCCESS) {
+		DFUDEBUG("FLASHERASE: Error erasing sector %d\r\n", secstart);
+		return 0;
+	}
+
+	return secsize;
+}
+
 /* Erase the entire device */
 static int32_t progalgo_intflash_erase_all(uint32_t start, uint32_t size)
 {
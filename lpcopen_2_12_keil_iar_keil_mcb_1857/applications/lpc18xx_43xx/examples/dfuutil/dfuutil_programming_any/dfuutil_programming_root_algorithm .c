@@ -38,6 +38,13 @@
  * Private types/enumerations/variables
  ****************************************************************************/
 
+/* Pending erase-ahead range, eraseAddr == eraseEnd when nothing is pending */
+static uint32_t eraseAddr, eraseEnd;
+static const PROGALGOS_T *eraseAlgos;
+
+/* Set when a background erase step failed, reported on the next operation */
+static bool eraseFailed;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -49,6 +56,46 @@ DFUPROG_REGIONLIST_T dfuRegionList;
  * Private functions
  ****************************************************************************/
 
+/* Erase the next unit of the pending erase range */
+static bool algo_root_erase_step(void)
+{
+	int32_t sz;
+
+	sz = eraseAlgos->erase_next(eraseAddr, eraseEnd - eraseAddr);
+	if (sz <= 0) {
+		DFUDEBUG("erase_next failed: %p\n", (void *) eraseAddr);
+		eraseFailed = true;
+		eraseAddr = eraseEnd;
+		return false;
+	}
+
+	eraseAddr += (uint32_t) sz;
+	if (eraseAddr > eraseEnd) {
+		eraseAddr = eraseEnd;
+	}
+
+	return true;
+}
+
+/* Finish any pending erase that overlaps the passed range, returns false
+   if an erase failed since the last operation */
+static bool algo_root_erase_finish(uint32_t addr, uint32_t size)
+{
+	uint32_t end = addr + size;
+
+	/* Erase proceeds in address order, so stop once past the range */
+	while ((eraseAddr != eraseEnd) && (eraseAddr < end) && (addr < eraseEnd)) {
+		algo_root_erase_step();
+	}
+
+	if (eraseFailed) {
+		eraseFailed = false;
+		return false;
+	}
+
+	return true;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -91,6 +138,20 @@ int32_t algo_root_erase_region(uint32_t addr, uint32_t size)
 		return 0;
 	}
 
+	/* Only one range is tracked, complete the previous one first */
+	if (algo_root_erase_finish(0, 0xFFFFFFFF) == false) {
+		return 0;
+	}
+
+	/* Algorithms with erase-ahead support erase in the background while
+	   the host streams the program data for the range */
+	if ((dfuRegionList.regionList[regIndex].pprogalgos->erase_next != NULL) && (size > 0)) {
+		eraseAlgos = dfuRegionList.regionList[regIndex].pprogalgos;
+		eraseAddr = addr;
+		eraseEnd = addr + size;
+		return size;
+	}
+
 	return dfuRegionList.regionList[regIndex].pprogalgos->erase_region(addr, size);
 }
 
@@ -106,6 +167,10 @@ int32_t algo_root_erase_all(uint32_t addr)
 		return 0;
 	}
 
+	if (algo_root_erase_finish(0, 0xFFFFFFFF) == false) {
+		return 0;
+	}
+
 	return dfuRegionList.regionList[regIndex].pprogalgos->erase_all(
 		dfuRegionList.regionList[regIndex].region_addr,
 		dfuRegionList.regionList[regIndex].region_size);
@@ -123,6 +188,11 @@ int32_t algo_root_write(void *buff, uint32_t addr, uint32_t size)
 		return 0;
 	}
 
+	/* Sectors being written must be erased first */
+	if (algo_root_erase_finish(addr, size) == false) {
+		return 0;
+	}
+
 	return dfuRegionList.regionList[regIndex].pprogalgos->write(buff, addr, size);
 }
 
@@ -138,6 +208,10 @@ int32_t algo_root_read(void *buff, uint32_t addr, uint32_t size)
 		return 0;
 	}
 
+	if (algo_root_erase_finish(addr, size) == false) {
+		return 0;
+	}
+
 	return dfuRegionList.regionList[regIndex].pprogalgos->read(buff, addr, size);
 }
 
@@ -153,11 +227,27 @@ bool algo_root_close(uint32_t addr)
 		return false;
 	}
 
+	/* Leave nothing half erased */
+	algo_root_erase_finish(0, 0xFFFFFFFF);
+
 	dfuRegionList.regionList[regIndex].pprogalgos->close(addr);
 
 	return true;
 }
 
+/* Erase one unit of the pending erase range, returns true if an erase
+   step was performed */
+bool algo_root_erase_ahead(void)
+{
+	if (eraseAddr == eraseEnd) {
+		return false;
+	}
+
+	algo_root_erase_step();
+
+	return true;
+}
+
 /* Initializes device programming and enumerates prog interfaces */
 DFUPROG_REGIONLIST_T *algo_root_init(void)
 {
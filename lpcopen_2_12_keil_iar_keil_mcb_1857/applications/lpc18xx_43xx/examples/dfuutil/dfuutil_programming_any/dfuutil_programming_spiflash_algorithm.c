@@ -54,6 +54,7 @@ static int32_t progalgo_spiflash_erase_region(uint32_t start, uint32_t size);
 static int32_t progalgo_spiflash_write(void *buff, uint32_t start, uint32_t size);
 static int32_t progalgo_spiflash_read(void *buff, uint32_t start, uint32_t size);
 static void progalgo_spiflash_close(uint32_t start);
+static int32_t progalgo_spiflash_erase_next(uint32_t start, uint32_t size);
 
 /* Function table for exposed API functions */
 static const PROGALGOS_T palgos = {
@@ -63,6 +64,7 @@ static const PROGALGOS_T palgos = {
 	progalgo_spiflash_write,
 	progalgo_spiflash_read,
 	progalgo_spiflash_close,
+	progalgo_spiflash_erase_next,
 };
 
 /* Number of program regions */
@@ -165,6 +167,53 @@ static int32_t progalgo_spiflash_erase_region(uint32_t start, uint32_t size)
 	return size;
 }
 
+/* Erase the single erase block holding the passed address, blocks that
+   already read back as all 0xFF are not erased again */
+static int32_t progalgo_spiflash_erase_next(uint32_t start, uint32_t size)
+{
+	uint32_t blkSize, blkStart, covered, idx;
+	uint32_t *p32;
+	bool blank = true;
+
+	if (progalgo_spiflash_progaddrvalid(start, size) == 0) {
+		SPIFIDEBUG("SPIFIERASE Invalid address\n");
+		return 0;
+	}
+
+	start = progalgo_spiflash_chk_alt(start);
+	blkSize = spifiDevGetInfo(pSpifi, SPIFI_INFO_ERASE_BLOCKSIZE);
+	blkStart = start & ~(blkSize - 1);
+
+	/* Part of the range handled by this block */
+	covered = (blkStart + blkSize) - start;
+	if (covered > size) {
+		covered = size;
+	}
+
+	/* Blank check the whole block through the memory mapped window */
+	spifiDevSetMemMode(pSpifi, true);
+	p32 = (uint32_t *) blkStart;
+	for (idx = 0; idx < (blkSize / sizeof(uint32_t)); idx++) {
+		if (p32[idx] != 0xFFFFFFFF) {
+			blank = false;
+			break;
+		}
+	}
+	spifiDevSetMemMode(pSpifi, false);
+
+	if (blank) {
+		return covered;
+	}
+
+	SPIFIDEBUG("SPIFIERASE block %p\n", (void *) blkStart);
+	if (spifiEraseByAddr(pSpifi, blkStart, blkStart + blkSize - 1) != SPIFI_ERR_NONE) {
+		SPIFIDEBUG("SPIFIERASE spifiEraseByAddr() failed\n");
+		return 0;
+	}
+
+	return covered;
+}
+
 /* Write the buffer to the device. Returns 0 if the region cannot
    be written (programming failure or region overlap) or the write
    size>0 if it passed. */
@@ -0,0 +1,262 @@
+/*
+ * @brief Host side packer for compressed DFU images (usbd_dfulz)
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * @par
+ * Compresses a raw binary image into the block container decoded by
+ * usbd_dfulz.c: a 16 byte header (magic, image size, CRC-32, block size)
+ * and one length word plus LZ4 block per image block. Blocks that do not
+ * compress are stored. Download the output in place of the raw image,
+ * with DFU_HOSTCMD_PROGRAM_LZ to dfuutil or with dfu-util to the DFU
+ * composite example. Build with any C compiler, for example:
+ *   gcc -O2 -o dfu_lzpack dfu_lzpack.c
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Must match usbd_dfulz.h of the firmware */
+#define DFULZ_MAGIC         0x5A4C4644
+#define DFULZ_MAX_BLOCK     4096
+#define DFULZ_BLK_STORED    0x80000000
+
+/* LZ4 block rules: last 5 bytes are literals, no match starts in the last 12 */
+#define MIN_MATCH           4
+#define LAST_LITERALS       5
+#define MF_LIMIT            12
+
+#define HASH_BITS           12
+
+static uint16_t g_hash[1 << HASH_BITS];
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void wr_le32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) (v >> 16);
+	p[3] = (uint8_t) (v >> 24);
+}
+
+static uint32_t rd_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/* CRC-32 as zlib, bit at a time, host speed does not matter here */
+static uint32_t crc32_update(uint32_t crc, const uint8_t *p, size_t len)
+{
+	int k;
+
+	crc = ~crc;
+	while (len--) {
+		crc ^= *p++;
+		for (k = 0; k < 8; k++) {
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+	}
+	return ~crc;
+}
+
+static uint32_t hash4(const uint8_t *p)
+{
+	return (rd_le32(p) * 2654435761U) >> (32 - HASH_BITS);
+}
+
+/* Put an LZ4 length extension, returns the new output pointer */
+static uint8_t *put_len(uint8_t *op, uint32_t len)
+{
+	while (len >= 255) {
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = (uint8_t) len;
+	return op;
+}
+
+/* Emit one sequence of literals and an optional match */
+static uint8_t *put_seq(uint8_t *op, const uint8_t *lit, uint32_t nlit, uint32_t off, uint32_t mlen)
+{
+	uint8_t *token = op++;
+
+	*token = (uint8_t) (((nlit >= 15) ? 15 : nlit) << 4);
+	if (nlit >= 15) {
+		op = put_len(op, nlit - 15);
+	}
+	memcpy(op, lit, nlit);
+	op += nlit;
+
+	if (mlen != 0) {
+		*op++ = (uint8_t) off;
+		*op++ = (uint8_t) (off >> 8);
+		mlen -= MIN_MATCH;
+		*token |= (uint8_t) ((mlen >= 15) ? 15 : mlen);
+		if (mlen >= 15) {
+			op = put_len(op, mlen - 15);
+		}
+	}
+	return op;
+}
+
+/* Greedy LZ4 block compressor, returns the compressed size or 0 if it does
+   not fit in max bytes */
+static uint32_t lz4_block(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t max)
+{
+	const uint8_t *ip = src, *anchor = src, *ilimit, *mlimit, *ref;
+	uint8_t *op = dst;
+	uint32_t h, cand, mlen;
+
+	/* dst holds the worst case, the size is checked against max at the end */
+	memset(g_hash, 0xFF, sizeof(g_hash));
+	if (len > MF_LIMIT) {
+		ilimit = src + len - MF_LIMIT;
+		mlimit = src + len - LAST_LITERALS;
+		while (ip < ilimit) {
+			h = hash4(ip);
+			cand = g_hash[h];
+			g_hash[h] = (uint16_t) (ip - src);
+			if ((cand == 0xFFFF) || (rd_le32(src + cand) != rd_le32(ip))) {
+				ip++;
+				continue;
+			}
+
+			ref = src + cand;
+			mlen = MIN_MATCH;
+			while ((ip + mlen < mlimit) && (ref[mlen] == ip[mlen])) {
+				mlen++;
+			}
+			op = put_seq(op, anchor, (uint32_t) (ip - anchor), (uint32_t) (ip - ref), mlen);
+			ip += mlen;
+			anchor = ip;
+		}
+	}
+	op = put_seq(op, anchor, (uint32_t) (src + len - anchor), 0, 0);
+
+	return ((uint32_t) (op - dst) < max) ? (uint32_t) (op - dst) : 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-b block_bytes] image.bin image.dlz\n", name);
+	fprintf(stderr, "  -b  image bytes per block, up to %d (default %d)\n", DFULZ_MAX_BLOCK, DFULZ_MAX_BLOCK);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	static uint8_t cbuf[DFULZ_MAX_BLOCK + (DFULZ_MAX_BLOCK / 255) + 16];
+	uint32_t blk = DFULZ_MAX_BLOCK, off, n, clen;
+	uint8_t *img = NULL, hdr[16];
+	long size;
+	size_t out_bytes;
+	FILE *fi, *fo;
+	int i = 1;
+
+	if ((argc > 2) && (strcmp(argv[1], "-b") == 0)) {
+		blk = (uint32_t) atoi(argv[2]);
+		i = 3;
+	}
+	if ((argc != i + 2) || (blk < 16) || (blk > DFULZ_MAX_BLOCK)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	fi = fopen(argv[i], "rb");
+	if (fi == NULL) {
+		perror(argv[i]);
+		return 1;
+	}
+	fseek(fi, 0, SEEK_END);
+	size = ftell(fi);
+	fseek(fi, 0, SEEK_SET);
+	if (size > 0) {
+		img = malloc((size_t) size);
+	}
+	if ((size < 0) || ((size > 0) && ((img == NULL) || (fread(img, 1, (size_t) size, fi) != (size_t) size)))) {
+		fprintf(stderr, "%s: read failed\n", argv[i]);
+		return 1;
+	}
+	fclose(fi);
+
+	fo = fopen(argv[i + 1], "wb");
+	if (fo == NULL) {
+		perror(argv[i + 1]);
+		return 1;
+	}
+
+	wr_le32(&hdr[0], DFULZ_MAGIC);
+	wr_le32(&hdr[4], (uint32_t) size);
+	wr_le32(&hdr[8], crc32_update(0, img, (size_t) size));
+	wr_le32(&hdr[12], blk);
+	fwrite(hdr, 1, sizeof(hdr), fo);
+	out_bytes = sizeof(hdr);
+
+	for (off = 0; off < (uint32_t) size; off += n) {
+		n = (uint32_t) size - off;
+		if (n > blk) {
+			n = blk;
+		}
+		clen = lz4_block(&img[off], n, cbuf, n);
+		if (clen != 0) {
+			wr_le32(hdr, clen);
+			fwrite(hdr, 1, 4, fo);
+			fwrite(cbuf, 1, clen, fo);
+		}
+		else {
+			/* Does not compress, store it */
+			clen = n;
+			wr_le32(hdr, n | DFULZ_BLK_STORED);
+			fwrite(hdr, 1, 4, fo);
+			fwrite(&img[off], 1, n, fo);
+		}
+		out_bytes += 4 + clen;
+	}
+
+	if (fclose(fo) != 0) {
+		perror(argv[i + 1]);
+		return 1;
+	}
+	printf("%ld -> %lu bytes (%.1f%%), %u byte blocks\n", size, (unsigned long) out_bytes,
+		   (size > 0) ? (100.0 * out_bytes / size) : 100.0, blk);
+	free(img);
+
+	return 0;
+}
@@ -42,6 +42,7 @@
 #undef  EXAMPLE_LWIP
 #undef  EXAMPLE_EMWIN
 #undef  EXAMPLE_USB_HOST      /* Not supported yet */
+#undef  EXAMPLE_IPC_BENCH     /* Replaces the IPC example, build it alone */
 #endif
 
 /*
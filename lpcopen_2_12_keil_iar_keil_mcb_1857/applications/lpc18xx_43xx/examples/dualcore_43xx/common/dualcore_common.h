@@ -127,6 +127,30 @@
 #define SHARED_MEM_M4          0x10089FC0
 #endif
 
+/* Run control of the IPC benchmark, 64 bytes below the M0 queue header */
+#ifndef SHARED_MEM_BENCH
+#define SHARED_MEM_BENCH       0x10089F40
+#endif
+
+/*
+ * Shared buffer pools used to hand large payloads between the cores without
+ * copying them (see ipc_pool.h). Each core owns one pool, the default places
+ * both in the 16K ETB SRAM at 0x2000C000, which is free when trace is not
+ * used. The pools must be at the same address in both images.
+ */
+#ifndef SHARED_MEM_POOL_M4
+#define SHARED_MEM_POOL_M4     0x2000C000
+#endif
+#ifndef SHARED_MEM_POOL_M4_SZ
+#define SHARED_MEM_POOL_M4_SZ  0x3000
+#endif
+#ifndef SHARED_MEM_POOL_M0
+#define SHARED_MEM_POOL_M0     0x2000F000
+#endif
+#ifndef SHARED_MEM_POOL_M0_SZ
+#define SHARED_MEM_POOL_M0_SZ  0x1000
+#endif
+
 /* Size RAM DISK image used by FAT Filesystem */
 #ifndef RAMDISK_SIZE
 #define RAMDISK_SIZE           0x2000
@@ -272,6 +296,17 @@ extern void EMWIN_Init(void);
  */
 extern void BLINKY_Init(void);
 
+/**
+ * @brief	IPC benchmark initialization
+ *
+ * Sets up the run control shared with the other core. *This function is
+ * called by @link EXAMPLE_DUALCORE_CMN_MAIN main()@endlink in place of
+ * IPCEX_Init() only when EXAMPLE_IPC_BENCH is defined*.
+ *
+ * @return	None
+ */
+extern void IPC_BENCH_Init(void);
+
 /**
  * @brief	Dual Core IPC example implementation task
  *
@@ -297,6 +332,19 @@ extern void ipcex_tasks(void);
  */
 extern void blinky_tasks(void);
 
+/**
+ * @brief	IPC benchmark task
+ *
+ * On the M4 this runs the latency and throughput sweep and prints the
+ * results, on the M0 it answers the M4. When no OS is specified this will
+ * be repeatedly *called from dual core @link EXAMPLE_DUALCORE_CMN_MAIN
+ * main()@endlink or once if any OS is defined, only when EXAMPLE_IPC_BENCH
+ * is defined*.
+ *
+ * @return	None
+ */
+extern void ipc_bench_tasks(void);
+
 /**
  * @brief	Dual Core USB host task
  *
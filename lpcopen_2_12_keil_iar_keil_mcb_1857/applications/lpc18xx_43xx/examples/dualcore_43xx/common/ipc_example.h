@@ -69,6 +69,9 @@ extern "C" {
 #define IPCEX_ID_FREEMEM       1  /*!< Frees memory allocated by other core */
 #define IPCEX_ID_GBLUPDATE     2  /*!< Update global variable or other core */
 #define IPCEX_ID_BLINKY        4  /*!< Blinky IPC event ID */
+#define IPCEX_ID_USBDATA       5  /*!< Written MSC disk extents, M0 pool buffer (msc_split.h) */
+#define IPCEX_ID_SOCKDATA      6  /*!< TCP stream data, pool buffer of either core (ipc_sock.h) */
+#define IPCEX_ID_SOCKEVT       7  /*!< TCP connection opened/closed by the M0 (ipc_sock.h) */
 #define IPCEX_ID_USER1         10 /*!< Used by Example IPC code */
 #define IPCEX_ID_USER2         11 /*!< IPC ID that can be used by other user examples */
 
@@ -111,9 +111,13 @@ static void os_event_handler(void)
 	portEND_SWITCHING_ISR(wake1 || wake2);
 }
 
-/* Misc Init function that initializes OS semaphores */
+/* Misc Init function that initializes OS semaphores, once for queues that
+   are set up again (IPC benchmark) */
 static void ipc_misc_init(void)
 {
+	if (event_tx && event_rx) {
+		return;
+	}
 	vSemaphoreCreateBinary(event_tx);
 	vSemaphoreCreateBinary(event_rx);
 
@@ -141,7 +145,13 @@ static void ipc_misc_init(void)
 
 static void ipc_misc_init(void)
 {
+	static int created;
 	OS_ERR ret;
+
+	if (created) {
+		return;
+	}
+	created = 1;
 	OSSemCreate(&event_tx, "TX Sema", 0, &ret);
 	if (ret != OS_ERR_NONE) {
 		while (1) {}
@@ -278,6 +288,9 @@ int IPC_pushMsgTout(const void *data, int tout)
 	}
 
 	memcpy(qwr->data + ((qwr->head & (qwr->count - 1)) * qwr->size), data, qwr->size);
+
+	/* Message must reach memory before the other core sees the new head */
+	__DMB();
 	qwr->head++;
 	ipc_send_signal();
 
@@ -313,8 +326,12 @@ int IPC_popMsgTout(void *data, int tout)
 		}
 	}
 
-	/* Pop the queue Item */
+	/* Pop the queue Item, not before the head that covers it was read */
+	__DMB();
 	memcpy(data, qrd->data + ((qrd->tail & (qrd->count - 1)) * qrd->size), qrd->size);
+
+	/* Message must be read before the other core can reuse its slot */
+	__DMB();
 	qrd->tail++;
 
 #ifdef EVENT_ON_RX
@@ -0,0 +1,305 @@
+/*
+ * @brief LPC43XX shared buffer pool for zero-copy IPC
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "app_dualcore_cfg.h"
+#include "ipc_msg.h"
+#include "ipc_pool.h"
+
+/** @ingroup EXAMPLE_DUALCORE_CMN_IPC_POOL
+ * @{
+ */
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#ifdef CORE_M4
+#define IPC_POOL_CORE_SELF   IPC_POOL_CORE_M4
+#define SHARED_MEM_POOL      SHARED_MEM_POOL_M4
+#define SHARED_MEM_POOL_SZ   SHARED_MEM_POOL_M4_SZ
+
+#elif defined(CORE_M0)
+#define IPC_POOL_CORE_SELF   IPC_POOL_CORE_M0
+#define SHARED_MEM_POOL      SHARED_MEM_POOL_M0
+#define SHARED_MEM_POOL_SZ   SHARED_MEM_POOL_M0_SZ
+
+#else
+#error "For LPC43XX, CORE_M0 or CORE_M4 must be defined!"
+#endif
+
+/* Pool headers of both cores, indexed by the owner field of a handle */
+static struct ipc_pool *const pools[2] = {
+	(struct ipc_pool *) SHARED_MEM_POOL_M4,
+	(struct ipc_pool *) SHARED_MEM_POOL_M0,
+};
+
+#define pool_self   pools[IPC_POOL_CORE_SELF]
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Keeps tasks and interrupts of this core out, the other core never writes
+   what is changed under it */
+static INLINE uint32_t ipc_pool_lock(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	return primask;
+}
+
+static INLINE void ipc_pool_unlock(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+/* Looks up the pool of a handle, NULL if the handle is not valid */
+static struct ipc_pool *ipc_pool_get(ipc_buf_t h)
+{
+	struct ipc_pool *pool;
+
+	if (IPC_POOL_HANDLE_CORE(h) > IPC_POOL_CORE_M0) {
+		return NULL;
+	}
+	pool = pools[IPC_POOL_HANDLE_CORE(h)];
+	if (pool->valid != IPC_POOL_MAGIC_VALID || IPC_POOL_HANDLE_IDX(h) >= pool->count) {
+		return NULL;
+	}
+	return pool;
+}
+
+/* Drops a reference on a buffer of this core, called with the pool locked */
+static int ipc_pool_drop(struct ipc_pool *pool, int idx)
+{
+	if (!pool->refs[idx]) {
+		return QUEUE_ERROR;		/* BUG: buffer freed twice */
+	}
+	if (--pool->refs[idx] == 0) {
+		pool->next[idx] = pool->free_top;
+		pool->free_top = idx;
+		pool->nfree++;
+	}
+	return QUEUE_INSERT;
+}
+
+/* Drains the return ring of this core, called with the pool locked */
+static int ipc_pool_reclaim(struct ipc_pool *pool)
+{
+	int n = 0;
+
+	while (pool->ret_tail != pool->ret_head) {
+		int idx;
+
+		/* Entry is read only after the head that covers it */
+		__DMB();
+		idx = pool->ret[pool->ret_tail & (IPC_POOL_RING_SZ - 1)];
+
+		/* Entry must be read before the other core reuses it */
+		__DMB();
+		pool->ret_tail++;
+		if (idx < pool->count && ipc_pool_drop(pool, idx) == QUEUE_INSERT) {
+			n++;
+		}
+	}
+	return n;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize the shared buffer pool of the calling core */
+int IPC_initPool(int bufsz)
+{
+	struct ipc_pool *pool = pool_self;
+	uint32_t end = SHARED_MEM_POOL + SHARED_MEM_POOL_SZ;
+	uint32_t data = (SHARED_MEM_POOL + sizeof(*pool) + IPC_POOL_ALIGN - 1) & ~(IPC_POOL_ALIGN - 1);
+	int i, count;
+
+	bufsz = (bufsz + IPC_POOL_ALIGN - 1) & ~(IPC_POOL_ALIGN - 1);
+	if (bufsz <= 0 || bufsz > 0xFFFF || data + bufsz > end) {
+		return 0;
+	}
+	count = MIN((int) ((end - data) / bufsz), IPC_POOL_MAX_BUFS);
+
+	memset(pool, 0, sizeof(*pool));
+	pool->bufsz = bufsz;
+	pool->count = count;
+	pool->data = data;
+	pool->free_top = -1;
+	for (i = count - 1; i >= 0; i--) {
+		pool->next[i] = pool->free_top;
+		pool->free_top = i;
+	}
+	pool->nfree = count;
+
+	/* Header must be complete before the other core can see it valid */
+	__DMB();
+	pool->valid = IPC_POOL_MAGIC_VALID;
+
+	return count;
+}
+
+/* Allocate a buffer from the pool of the calling core */
+ipc_buf_t IPC_poolAlloc(void)
+{
+	struct ipc_pool *pool = pool_self;
+	ipc_buf_t h = IPC_POOL_INVALID;
+	uint32_t primask;
+	int idx;
+
+	if (pool->valid != IPC_POOL_MAGIC_VALID) {
+		return IPC_POOL_INVALID;
+	}
+
+	primask = ipc_pool_lock();
+	if (pool->free_top < 0) {
+		ipc_pool_reclaim(pool);
+	}
+	idx = pool->free_top;
+	if (idx >= 0) {
+		pool->free_top = pool->next[idx];
+		pool->nfree--;
+		pool->refs[idx] = 1;
+		h = IPC_POOL_HANDLE(IPC_POOL_CORE_SELF, idx);
+	}
+	ipc_pool_unlock(primask);
+
+	return h;
+}
+
+/* Take one more reference on a buffer */
+int IPC_poolRef(ipc_buf_t h)
+{
+	struct ipc_pool *pool = ipc_pool_get(h);
+	uint32_t primask;
+	int ret = QUEUE_ERROR;
+
+	if (pool != pool_self) {
+		return QUEUE_ERROR;
+	}
+
+	primask = ipc_pool_lock();
+	if (pool->refs[IPC_POOL_HANDLE_IDX(h)]) {
+		pool->refs[IPC_POOL_HANDLE_IDX(h)]++;
+		ret = QUEUE_INSERT;
+	}
+	ipc_pool_unlock(primask);
+
+	return ret;
+}
+
+/* Drop one reference on a buffer */
+int IPC_poolFree(ipc_buf_t h)
+{
+	struct ipc_pool *pool = ipc_pool_get(h);
+	uint32_t primask;
+	int ret = QUEUE_INSERT;
+
+	if (!pool) {
+		return QUEUE_ERROR;
+	}
+
+	primask = ipc_pool_lock();
+	if (pool == pool_self) {
+		ret = ipc_pool_drop(pool, IPC_POOL_HANDLE_IDX(h));
+	}
+	else if (pool->ret_head - pool->ret_tail >= IPC_POOL_RING_SZ) {
+		ret = QUEUE_FULL;
+	}
+	else {
+		pool->ret[pool->ret_head & (IPC_POOL_RING_SZ - 1)] = IPC_POOL_HANDLE_IDX(h);
+
+		/* Entry must reach memory before the owner sees the new head */
+		__DMB();
+		pool->ret_head++;
+	}
+	ipc_pool_unlock(primask);
+
+	return ret;
+}
+
+/* Put buffers returned by the other core back on the free list */
+int IPC_poolReclaim(void)
+{
+	struct ipc_pool *pool = pool_self;
+	uint32_t primask;
+	int n;
+
+	if (pool->valid != IPC_POOL_MAGIC_VALID) {
+		return 0;
+	}
+
+	primask = ipc_pool_lock();
+	n = ipc_pool_reclaim(pool);
+	ipc_pool_unlock(primask);
+
+	return n;
+}
+
+/* Number of free buffers in the pool of the calling core */
+int IPC_poolAvail(void)
+{
+	struct ipc_pool *pool = pool_self;
+
+	if (pool->valid != IPC_POOL_MAGIC_VALID) {
+		return 0;
+	}
+	return pool->nfree;
+}
+
+/* Get the payload of a buffer */
+void *IPC_poolData(ipc_buf_t h)
+{
+	struct ipc_pool *pool = ipc_pool_get(h);
+
+	if (!pool) {
+		return NULL;
+	}
+	return (void *) (pool->data + IPC_POOL_HANDLE_IDX(h) * pool->bufsz);
+}
+
+/* Get the size of a buffer */
+int IPC_poolBufSize(ipc_buf_t h)
+{
+	struct ipc_pool *pool = ipc_pool_get(h);
+
+	return pool ? pool->bufsz : 0;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,230 @@
+/*
+ * @brief LPC43XX shared buffer pool for zero-copy IPC
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __IPC_POOL_H_
+#define __IPC_POOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup EXAMPLE_DUALCORE_CMN_IPC_POOL LPC43xx IPC shared buffer pool
+ * @ingroup EXAMPLE_DUALCORE_CMN_IPC
+ * The shared buffer pool lets large payloads (network frames, sample blocks)
+ * change hands between the M0 and M4 core without being copied. A buffer is
+ * allocated on one core, its handle is sent through the IPC queue and the
+ * receiving core uses the data in place and frees it when done.
+ *
+ * Each core owns one pool at a fixed address in shared SRAM
+ * (#SHARED_MEM_POOL_M4 / #SHARED_MEM_POOL_M0). The M0 has no exclusive load
+ * and store, so nothing in a pool is ever written by both cores: the free
+ * list and the reference counts are only changed by the owning core, and
+ * the other core returns buffers through a single producer ring in the same
+ * pool header, which the owner drains when it allocates or calls
+ * IPC_poolReclaim().
+ *
+ * Sending a handle moves one reference to the receiver. The owner can take
+ * more references with IPC_poolRef() before sending the same buffer to
+ * several places, every reference is dropped with IPC_poolFree().
+ * @{
+ */
+
+/**
+ * \def IPC_POOL_MAX_BUFS
+ * Maximum number of buffers in the pool of one core
+ */
+#ifndef IPC_POOL_MAX_BUFS
+#define IPC_POOL_MAX_BUFS     32
+#endif
+
+/**
+ * \def IPC_POOL_RING_SZ
+ * Number of entries in the return ring of a pool, must be a power of 2
+ */
+#ifndef IPC_POOL_RING_SZ
+#define IPC_POOL_RING_SZ      64
+#endif
+
+/**
+ * \def IPC_POOL_ALIGN
+ * Alignment of the buffer data, suits the Ethernet and GPDMA engines
+ */
+#define IPC_POOL_ALIGN        32
+
+/**
+ * \def IPC_POOL_CORE_M4
+ * Owner field of buffers allocated by the M4 core
+ */
+#define IPC_POOL_CORE_M4      0
+
+/**
+ * \def IPC_POOL_CORE_M0
+ * Owner field of buffers allocated by the M0 core
+ */
+#define IPC_POOL_CORE_M0      1
+
+/**
+ * \def IPC_POOL_HANDLE(core, idx)
+ * Builds the handle of buffer \a idx in the pool of \a core
+ */
+#define IPC_POOL_HANDLE(core, idx)  (((uint32_t) (core) << 16) | (idx))
+
+/**
+ * \def IPC_POOL_HANDLE_CORE(h)
+ * Owner core of handle \a h
+ */
+#define IPC_POOL_HANDLE_CORE(h)     ((h) >> 16)
+
+/**
+ * \def IPC_POOL_HANDLE_IDX(h)
+ * Buffer index of handle \a h
+ */
+#define IPC_POOL_HANDLE_IDX(h)      ((h) & 0xFFFF)
+
+/**
+ * \def IPC_POOL_INVALID
+ * Handle returned when no buffer is available
+ */
+#define IPC_POOL_INVALID            0xFFFFFFFF
+
+/**
+ * \def IPC_POOL_MAGIC_VALID
+ * Macro used to identify if a pool is valid
+ */
+#define IPC_POOL_MAGIC_VALID        0xB0F5A11C
+
+/**
+ * @brief Shared buffer handle, fits the data word of an IPC message
+ */
+typedef uint32_t ipc_buf_t;
+
+/**
+ * @brief Pool header, placed at the start of each core's pool area
+ *
+ * Only the owning core writes the header, except ret_head and the ring
+ * entries, which only the other core writes.
+ */
+struct ipc_pool {
+	uint32_t valid;						/*!< Pool is valid only if this is #IPC_POOL_MAGIC_VALID */
+	uint16_t bufsz;						/*!< Size of a buffer, multiple of #IPC_POOL_ALIGN */
+	uint16_t count;						/*!< Number of buffers in the pool */
+	uint32_t data;						/*!< Address of the first buffer */
+	volatile uint32_t ret_head;			/*!< Return ring head, written by the other core */
+	volatile uint32_t ret_tail;			/*!< Return ring tail, written by the owner */
+	int16_t free_top;					/*!< First free buffer, -1 if none */
+	uint16_t nfree;						/*!< Number of free buffers */
+	int16_t next[IPC_POOL_MAX_BUFS];	/*!< Free list links */
+	volatile uint16_t refs[IPC_POOL_MAX_BUFS];	/*!< Reference counts */
+	volatile uint16_t ret[IPC_POOL_RING_SZ];	/*!< Buffers returned by the other core */
+};
+
+/**
+ * @brief	Initialize the shared buffer pool of the calling core
+ *
+ * Carves the pool area of the calling core (#SHARED_MEM_POOL_M4 on the M4,
+ * #SHARED_MEM_POOL_M0 on the M0) into buffers of \a bufsz bytes. Must be
+ * called before the other core sees a handle from this pool.
+ *
+ * @param	bufsz	: Size of a buffer in bytes, rounded up to #IPC_POOL_ALIGN
+ * @return	Number of buffers in the pool, 0 if the area is too small
+ */
+int IPC_initPool(int bufsz);
+
+/**
+ * @brief	Allocate a buffer from the pool of the calling core
+ *
+ * Buffers returned by the other core are reclaimed first, the new buffer
+ * has a reference count of 1. Can be called from interrupt handlers.
+ *
+ * @return	Handle of the buffer, #IPC_POOL_INVALID if the pool is empty
+ */
+ipc_buf_t IPC_poolAlloc(void);
+
+/**
+ * @brief	Take one more reference on a buffer
+ * @param	h	: Handle of a buffer owned by the calling core
+ * @return	#QUEUE_INSERT on success, #QUEUE_ERROR if the calling core does
+ *          not own the buffer or the handle is not valid
+ * @note	Only the owner counts references, a core that received a buffer
+ *          of the other core can pass its reference on or free it.
+ */
+int IPC_poolRef(ipc_buf_t h);
+
+/**
+ * @brief	Drop one reference on a buffer
+ *
+ * The owner puts the buffer back on its free list when the last reference
+ * goes. A buffer of the other core is queued on the return ring of its
+ * pool without waiting for the owner.
+ *
+ * @param	h	: Handle of the buffer
+ * @return	#QUEUE_INSERT on success, #QUEUE_FULL if the return ring of the
+ *          owner is full, #QUEUE_ERROR if the handle is not valid
+ */
+int IPC_poolFree(ipc_buf_t h);
+
+/**
+ * @brief	Put buffers returned by the other core back on the free list
+ * @return	Number of references dropped
+ * @note	IPC_poolAlloc() does this on its own, call it from the IPC
+ *          receive event of a core that rarely allocates.
+ */
+int IPC_poolReclaim(void);
+
+/**
+ * @brief	Number of free buffers in the pool of the calling core
+ * @return	Free buffers, not counting those still on the return ring
+ */
+int IPC_poolAvail(void);
+
+/**
+ * @brief	Get the payload of a buffer
+ * @param	h	: Handle of the buffer, from either pool
+ * @return	Pointer to the buffer data, NULL if the handle is not valid
+ */
+void *IPC_poolData(ipc_buf_t h);
+
+/**
+ * @brief	Get the size of a buffer
+ * @param	h	: Handle of the buffer, from either pool
+ * @return	Size in bytes, 0 if the handle is not valid
+ */
+int IPC_poolBufSize(ipc_buf_t h);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef __IPC_POOL_H_ */
@@ -139,7 +139,11 @@ static void prvSetupHardware(void)
 	} while(0);
 #endif
 	/* Initialize the IPC Queue */
+#ifdef EXAMPLE_IPC_BENCH
+	IPC_BENCH_Init();
+#else
 	IPCEX_Init();
+#endif
 
 	#ifdef EXAMPLE_USB_HOST
 	USBHOST_Init();
@@ -168,7 +172,11 @@ static void main_tasks(void)
 #endif
 
 	do {
+#ifdef EXAMPLE_IPC_BENCH
+		ipc_bench_tasks();
+#else
 		ipcex_tasks();
+#endif
 #ifdef EXAMPLE_BLINKY
 		blinky_tasks();
 #endif
@@ -64,15 +64,20 @@
 #define IP_SOF_BROADCAST                1
 #define IP_SOF_BROADCAST_RECV           1
 
-/* The ethernet FCS is performed in hardware. The IP, TCP, and UDP
-   CRCs still need to be done in hardware. */
-#define CHECKSUM_GEN_IP                 1
-#define CHECKSUM_GEN_UDP                1
-#define CHECKSUM_GEN_TCP                1
-#define CHECKSUM_CHECK_IP               1
-#define CHECKSUM_CHECK_UDP              1
-#define CHECKSUM_CHECK_TCP              1
-#define LWIP_CHECKSUM_ON_COPY           1
+/* The ethernet FCS is performed in hardware. Set LPC_CHECKSUM_OFFLOAD
+   to 1 when the EMAC driver enables Chip_ENET_Ring_SetChecksumOffload()
+   to also move the IP, TCP, and UDP checksums into the MAC, otherwise
+   they are done in software. */
+#ifndef LPC_CHECKSUM_OFFLOAD
+#define LPC_CHECKSUM_OFFLOAD            0
+#endif
+#define CHECKSUM_GEN_IP                 (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_GEN_UDP                (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_GEN_TCP                (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_CHECK_IP               (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_CHECK_UDP              (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_CHECK_TCP              (!LPC_CHECKSUM_OFFLOAD)
+#define LWIP_CHECKSUM_ON_COPY           (!LPC_CHECKSUM_OFFLOAD)
 
 /* Use LWIP version of htonx() to allow generic functionality across
    all platforms. If you are using the Cortex Mx devices, you might
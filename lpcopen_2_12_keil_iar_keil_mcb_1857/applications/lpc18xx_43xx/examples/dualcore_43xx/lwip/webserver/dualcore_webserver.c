@@ -41,6 +41,10 @@
 #include "app_dualcore_cfg.h"
 #include "ipc_msg.h"
 #include "ipc_example.h"
+#include "ipc_sock.h"
+
+/* With LWIP_SPLIT_CORE the M4 builds only ipc_sock.c of this example */
+#if !defined(LWIP_SPLIT_CORE) || defined(CORE_M0)
 
 /* lwIP include files */
 #include "lwip/opt.h"
@@ -284,6 +288,9 @@ void LWIP_Init(void)
 
 	/* Initialize and start application */
 	httpd_init();
+#ifdef LWIP_SPLIT_CORE
+	ipc_sock_init();
+#endif
 
 	return;
 #endif
@@ -343,6 +350,11 @@ void lwip_tasks(void)
 		/* LWIP timers - ARP, DHCP, TCP, etc. */
 		sys_check_timeouts();
 
+#ifdef LWIP_SPLIT_CORE
+		/* Socket data held back for the M4 or for lwIP */
+		ipc_sock_task();
+#endif
+
 		/* Call the PHY status update state machine once in a while
 		   to keep the link status up-to-date */
 		physts = lpcPHYStsPoll();
@@ -381,3 +393,5 @@ void lwip_tasks(void)
 }
 
 #endif
+
+#endif /* !defined(LWIP_SPLIT_CORE) || defined(CORE_M0) */
@@ -0,0 +1,446 @@
+/*
+ * @brief Split core TCP socket bridge of the webserver example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "app_dualcore_cfg.h"
+#include "ipc_msg.h"
+#include "ipc_example.h"
+#include "ipc_sock.h"
+
+#ifdef LWIP_SPLIT_CORE
+
+#ifdef CORE_M0
+#include "lwip/opt.h"
+#include "lwip/tcp.h"
+
+#if !NO_SYS
+#error "The split core socket bridge needs the stand-alone lwIP build on the M0"
+#endif
+#ifdef USB_SPLIT_CORE
+#error "USB_SPLIT_CORE and LWIP_SPLIT_CORE both need the M0 buffer pool"
+#endif
+#endif
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#ifdef CORE_M0
+static struct tcp_pcb *g_listen;
+static struct tcp_pcb *g_client;
+
+/* Buffers from the M4, oldest first, the first g_txWritten are with lwIP */
+static ipc_buf_t g_txq[IPC_SOCK_TXQ_SZ];
+static uint32_t g_txIn, g_txOut;
+static uint32_t g_txWritten;
+static uint32_t g_txAcked;		/* Bytes of the oldest buffer acknowledged */
+static uint32_t g_txDropped;
+
+/* Messages for the M4, held while its queue is full */
+static ipcex_msg_t g_rxq[IPC_SOCK_RXQ_SZ];
+static uint32_t g_rxIn, g_rxOut;
+static uint16_t g_rxSeq;
+#endif
+
+#ifdef CORE_M4
+static int g_connected;
+static uint16_t g_txSeq;
+static uint32_t g_echoed;
+#endif
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+#ifdef CORE_M0
+/* Push the held messages to the M4, in order, until its queue is full */
+static void sock_flush_rx(void)
+{
+	while (g_rxOut != g_rxIn) {
+		if (IPC_tryPushMsg(&g_rxq[g_rxOut & (IPC_SOCK_RXQ_SZ - 1)]) != QUEUE_INSERT) {
+			break;
+		}
+		g_rxOut++;
+	}
+}
+
+/* Queue a message for the M4 behind the data already held */
+static int sock_queue_msg(uint32_t id, uint32_t data)
+{
+	ipcex_msg_t *pMsg;
+
+	if ((g_rxIn - g_rxOut) >= IPC_SOCK_RXQ_SZ) {
+		return 0;
+	}
+	pMsg = &g_rxq[g_rxIn & (IPC_SOCK_RXQ_SZ - 1)];
+	pMsg->id = id;
+	pMsg->data = data;
+	g_rxIn++;
+	return 1;
+}
+
+/* Tell the M4 the connection state changed */
+static void sock_event(uint32_t evt)
+{
+	if (!sock_queue_msg(IPCEX_ID_SOCKEVT, evt)) {
+		DEBUGOUT("Socket bridge: event %lu lost\r\n", (unsigned long) evt);
+	}
+	sock_flush_rx();
+}
+
+/* Hand queued M4 buffers to lwIP while the send buffer has room */
+static void sock_write_pending(void)
+{
+	const ipc_sock_hdr_t *pHdr;
+	int written = 0;
+
+	while ((g_client != NULL) && ((g_txOut + g_txWritten) != g_txIn)) {
+		pHdr = (const ipc_sock_hdr_t *) IPC_poolData(g_txq[(g_txOut + g_txWritten) & (IPC_SOCK_TXQ_SZ - 1)]);
+		if ((pHdr->len > tcp_sndbuf(g_client)) || (tcp_sndqueuelen(g_client) >= (TCP_SND_QUEUELEN - 1))) {
+			break;
+		}
+		/* no copy, lwIP sends from the pool buffer until it is acknowledged */
+		if (tcp_write(g_client, pHdr + 1, pHdr->len, 0) != ERR_OK) {
+			break;
+		}
+		g_txWritten++;
+		written = 1;
+	}
+	if (written) {
+		tcp_output(g_client);
+	}
+}
+
+/* Give back every buffer held for the connection */
+static void sock_release_tx(void)
+{
+	while (g_txOut != g_txIn) {
+		IPC_poolFree(g_txq[g_txOut & (IPC_SOCK_TXQ_SZ - 1)]);
+		g_txOut++;
+	}
+	g_txWritten = 0;
+	g_txAcked = 0;
+}
+
+/* Drop the client, returns ERR_ABRT when the pcb had to be aborted */
+static err_t sock_close(struct tcp_pcb *pcb)
+{
+	err_t ret = ERR_OK;
+
+	tcp_arg(pcb, NULL);
+	tcp_recv(pcb, NULL);
+	tcp_sent(pcb, NULL);
+	tcp_err(pcb, NULL);
+	tcp_poll(pcb, NULL, 0);
+	g_client = NULL;
+
+	/* lwIP still points into unacknowledged buffers, so it cannot keep
+	   the pcb once they are freed */
+	if ((g_txWritten != 0) || (tcp_close(pcb) != ERR_OK)) {
+		tcp_abort(pcb);
+		ret = ERR_ABRT;
+	}
+	sock_release_tx();
+	sock_event(IPC_SOCK_EVT_CLOSED);
+	return ret;
+}
+
+/* Client data, copied into M0 pool buffers for the M4 */
+static err_t sock_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+	ipc_sock_hdr_t *pHdr;
+	ipc_buf_t h;
+	u16_t off, n;
+	int need;
+
+	if (p == NULL) {
+		return sock_close(pcb);
+	}
+	if (err != ERR_OK) {
+		pbuf_free(p);
+		return err;
+	}
+
+	need = (p->tot_len + IPC_SOCK_PAYLOAD - 1) / IPC_SOCK_PAYLOAD;
+	IPC_poolReclaim();
+	if ((IPC_poolAvail() < need) || ((int) (IPC_SOCK_RXQ_SZ - (g_rxIn - g_rxOut)) < need)) {
+		/* lwIP keeps the pbuf and offers it again from its timer */
+		return ERR_MEM;
+	}
+
+	for (off = 0; off < p->tot_len; off += n) {
+		h = IPC_poolAlloc();
+		pHdr = (ipc_sock_hdr_t *) IPC_poolData(h);
+		n = pbuf_copy_partial(p, pHdr + 1, (u16_t) IPC_SOCK_PAYLOAD, off);
+		pHdr->len = n;
+		pHdr->seq = g_rxSeq++;
+		sock_queue_msg(IPCEX_ID_SOCKDATA, h);
+	}
+	tcp_recved(pcb, p->tot_len);
+	pbuf_free(p);
+
+	sock_flush_rx();
+	return ERR_OK;
+}
+
+/* Acknowledged bytes, frees the buffers that are done */
+static err_t sock_sent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+	const ipc_sock_hdr_t *pHdr;
+	ipc_buf_t h;
+	uint32_t left = len;
+
+	while ((left != 0) && (g_txWritten != 0)) {
+		h = g_txq[g_txOut & (IPC_SOCK_TXQ_SZ - 1)];
+		pHdr = (const ipc_sock_hdr_t *) IPC_poolData(h);
+		if (left < (pHdr->len - g_txAcked)) {
+			g_txAcked += left;
+			break;
+		}
+		left -= pHdr->len - g_txAcked;
+		g_txAcked = 0;
+		IPC_poolFree(h);
+		g_txOut++;
+		g_txWritten--;
+	}
+
+	sock_write_pending();
+	return ERR_OK;
+}
+
+/* Connection aborted by lwIP, the pcb is already gone */
+static void sock_err(void *arg, err_t err)
+{
+	g_client = NULL;
+	sock_release_tx();
+	sock_event(IPC_SOCK_EVT_CLOSED);
+}
+
+/* Retry held data every second or so */
+static err_t sock_poll(void *arg, struct tcp_pcb *pcb)
+{
+	sock_flush_rx();
+	sock_write_pending();
+	return ERR_OK;
+}
+
+/* New client, only one at a time is bridged */
+static err_t sock_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+	tcp_accepted(g_listen);
+	if ((err != ERR_OK) || (g_client != NULL)) {
+		tcp_abort(newpcb);
+		return ERR_ABRT;
+	}
+
+	g_client = newpcb;
+	g_rxSeq = 0;
+	tcp_recv(newpcb, sock_recv);
+	tcp_sent(newpcb, sock_sent);
+	tcp_err(newpcb, sock_err);
+	tcp_poll(newpcb, sock_poll, 2);
+	sock_event(IPC_SOCK_EVT_CONNECTED);
+	return ERR_OK;
+}
+
+/* Buffer from the M4, queued on the connection */
+static void sock_receive(uint32_t data)
+{
+	ipc_buf_t h = (ipc_buf_t) data;
+	const ipc_sock_hdr_t *pHdr = (const ipc_sock_hdr_t *) IPC_poolData(h);
+
+	if (pHdr == NULL) {
+		return;
+	}
+	if ((g_client == NULL) || (pHdr->len == 0) ||
+		(pHdr->len > (IPC_poolBufSize(h) - sizeof(ipc_sock_hdr_t))) ||
+		((g_txIn - g_txOut) >= IPC_SOCK_TXQ_SZ)) {
+		g_txDropped++;
+		IPC_poolFree(h);
+		return;
+	}
+
+	g_txq[g_txIn & (IPC_SOCK_TXQ_SZ - 1)] = h;
+	g_txIn++;
+	sock_write_pending();
+}
+
+#endif /* CORE_M0 */
+
+#ifdef CORE_M4
+/* Connection state from the M0 */
+static void echo_event(uint32_t data)
+{
+	g_connected = (data == IPC_SOCK_EVT_CONNECTED);
+	if (g_connected) {
+		g_txSeq = 0;
+		g_echoed = 0;
+		ipc_sock_send("M4 echo service\r\n", 17);
+	}
+	else {
+		DEBUGOUT("Socket bridge: client gone, %lu bytes echoed\r\n", (unsigned long) g_echoed);
+	}
+}
+
+/* Client data, upper cased in place and sent back in the same buffer */
+static void echo_receive(uint32_t data)
+{
+	ipc_buf_t h = (ipc_buf_t) data;
+	ipc_sock_hdr_t *pHdr = (ipc_sock_hdr_t *) IPC_poolData(h);
+	uint8_t *p;
+	int i;
+
+	if (pHdr == NULL) {
+		return;
+	}
+	p = (uint8_t *) (pHdr + 1);
+	for (i = 0; i < pHdr->len; i++) {
+		if ((p[i] >= 'a') && (p[i] <= 'z')) {
+			p[i] -= 'a' - 'A';
+		}
+	}
+	g_echoed += pHdr->len;
+
+	ipc_sock_sendBuf(h);
+}
+
+#endif /* CORE_M4 */
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+#ifdef CORE_M0
+/* Create the M0 pool and listen on the bridged port */
+void ipc_sock_init(void)
+{
+	struct tcp_pcb *pcb;
+
+	IPC_initPool(IPC_SOCK_BUF_SIZE);
+	ipcex_register_callback(IPCEX_ID_SOCKDATA, sock_receive);
+
+	pcb = tcp_new();
+	if ((pcb == NULL) || (tcp_bind(pcb, IP_ADDR_ANY, IPC_SOCK_PORT) != ERR_OK)) {
+		DEBUGSTR("Socket bridge: unable to bind\r\n");
+		return;
+	}
+	g_listen = tcp_listen(pcb);
+	if (g_listen == NULL) {
+		DEBUGSTR("Socket bridge: unable to listen\r\n");
+		return;
+	}
+	tcp_accept(g_listen, sock_accept);
+	DEBUGOUT("Socket bridge: TCP port %d to the M4\r\n", IPC_SOCK_PORT);
+}
+
+/* Retry data held back by a full IPC queue or send buffer */
+void ipc_sock_task(void)
+{
+	sock_flush_rx();
+	sock_write_pending();
+}
+
+#endif /* CORE_M0 */
+
+#ifdef CORE_M4
+/* Send a buffer to the connected client */
+int ipc_sock_sendBuf(ipc_buf_t h)
+{
+	ipcex_msg_t msg;
+	int ret;
+
+	msg.id = IPCEX_ID_SOCKDATA;
+	msg.data = h;
+	ret = IPC_tryPushMsg(&msg);
+	if (ret != QUEUE_INSERT) {
+		IPC_poolFree(h);
+	}
+	return ret;
+}
+
+/* Copy data into M4 pool buffers and send it */
+int ipc_sock_send(const void *data, int len)
+{
+	const uint8_t *pSrc = (const uint8_t *) data;
+	ipc_sock_hdr_t *pHdr;
+	ipc_buf_t h;
+	int sent = 0, n;
+
+	while (sent < len) {
+		h = IPC_poolAlloc();
+		if (h == IPC_POOL_INVALID) {
+			break;
+		}
+		n = len - sent;
+		if (n > (int) IPC_SOCK_PAYLOAD) {
+			n = IPC_SOCK_PAYLOAD;
+		}
+		pHdr = (ipc_sock_hdr_t *) IPC_poolData(h);
+		pHdr->len = n;
+		pHdr->seq = g_txSeq++;
+		memcpy(pHdr + 1, &pSrc[sent], n);
+		if (ipc_sock_sendBuf(h) != QUEUE_INSERT) {
+			break;
+		}
+		sent += n;
+	}
+	return sent;
+}
+
+/* Tell if a client is connected */
+int ipc_sock_connected(void)
+{
+	return g_connected;
+}
+
+/**
+ * @brief	Bridge the echo service to the M0, which runs lwIP
+ * @return	Nothing
+ */
+void LWIP_Init(void)
+{
+	IPC_initPool(IPC_SOCK_BUF_SIZE);
+	ipcex_register_callback(IPCEX_ID_SOCKEVT, echo_event);
+	ipcex_register_callback(IPCEX_ID_SOCKDATA, echo_receive);
+}
+
+/* Socket data is handled by the IPC dispatch */
+void lwip_tasks(void)
+{
+}
+
+#endif /* CORE_M4 */
+
+#endif /* LWIP_SPLIT_CORE */
@@ -0,0 +1,164 @@
+/*
+ * @brief Split core TCP socket bridge of the webserver example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __IPC_SOCK_H_
+#define __IPC_SOCK_H_
+
+#include "app_dualcore_cfg.h"
+#include "ipc_pool.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup EXAMPLE_DUALCORE_LWIP_SOCK Split core TCP socket bridge
+ * @ingroup EXAMPLE_DUALCORE_LWIP
+ * With LWIP_SPLIT_CORE defined in both images the M0 owns the EMAC and runs
+ * lwIP and the HTTP server, the M4 runs no network code at all. The M0 also
+ * listens on #IPC_SOCK_PORT and passes the stream of one client to the M4
+ * as #IPCEX_ID_SOCKDATA messages, each carrying a pool buffer
+ * (ipc_pool.h) that starts with an #ipc_sock_hdr_t.
+ *
+ * Received data is copied once, from the lwIP pbufs into M0 pool buffers;
+ * the M4 works on it in place. Data from the M4 is queued on the connection
+ * without a copy, lwIP sends straight out of the pool buffer and the M0
+ * frees it once the peer has acknowledged it. An M4 that sends back the
+ * buffers it received (the echo service does) moves no payload at all.
+ * While the M0 pool is empty the M0 refuses the data, so lwIP holds it and
+ * closes the receive window instead of dropping segments.
+ *
+ * The cost per message can be measured with the IPC benchmark
+ * (EXAMPLE_IPC_BENCH) for the buffer size in use.
+ * @{
+ */
+
+/**
+ * \def IPC_SOCK_PORT
+ * TCP port the M0 bridges to the M4
+ */
+#ifndef IPC_SOCK_PORT
+#define IPC_SOCK_PORT       7000
+#endif
+
+/**
+ * \def IPC_SOCK_BUF_SIZE
+ * Pool buffer size used by both cores, header included
+ */
+#ifndef IPC_SOCK_BUF_SIZE
+#define IPC_SOCK_BUF_SIZE   512
+#endif
+
+/**
+ * \def IPC_SOCK_TXQ_SZ
+ * Buffers from the M4 the M0 can hold on the connection, queued or not yet
+ * acknowledged, must be a power of 2. The default holds every buffer of
+ * both pools, so the M4 is only paced by its pool running dry.
+ */
+#ifndef IPC_SOCK_TXQ_SZ
+#define IPC_SOCK_TXQ_SZ     (2 * IPC_POOL_MAX_BUFS)
+#endif
+
+/**
+ * \def IPC_SOCK_RXQ_SZ
+ * Messages the M0 can hold for a full M4 queue, must be a power of 2
+ */
+#ifndef IPC_SOCK_RXQ_SZ
+#define IPC_SOCK_RXQ_SZ     16
+#endif
+
+#define IPC_SOCK_EVT_CLOSED     0	/*!< #IPCEX_ID_SOCKEVT data: client gone */
+#define IPC_SOCK_EVT_CONNECTED  1	/*!< #IPCEX_ID_SOCKEVT data: client connected */
+
+/**
+ * @brief Start of every socket data buffer
+ */
+typedef struct {
+	uint16_t len;			/*!< Payload bytes following the header */
+	uint16_t seq;			/*!< Buffer number set by the sender, for tracing */
+} ipc_sock_hdr_t;
+
+/**
+ * \def IPC_SOCK_PAYLOAD
+ * Payload bytes in one buffer
+ */
+#define IPC_SOCK_PAYLOAD    (IPC_SOCK_BUF_SIZE - sizeof(ipc_sock_hdr_t))
+
+#ifdef CORE_M0
+/**
+ * @brief	Create the M0 pool and listen on #IPC_SOCK_PORT (M0)
+ * @return	Nothing
+ * @note	Call after lwIP is up, from the stand-alone lwIP init.
+ */
+void ipc_sock_init(void);
+
+/**
+ * @brief	Retry data held back by a full IPC queue or send buffer (M0)
+ * @return	Nothing
+ * @note	Call from the lwIP main loop.
+ */
+void ipc_sock_task(void);
+#endif
+
+#ifdef CORE_M4
+/**
+ * @brief	Send a buffer to the connected client (M4)
+ * @param	h	: Pool buffer of either core, starting with an #ipc_sock_hdr_t
+ * @return	#QUEUE_INSERT on success, #QUEUE_FULL or #QUEUE_ERROR on error
+ * @note	The reference on \a h goes to the M0, which frees it once sent,
+ *          or at once if no client is connected. It is freed here on error.
+ */
+int ipc_sock_sendBuf(ipc_buf_t h);
+
+/**
+ * @brief	Copy data into M4 pool buffers and send it to the client (M4)
+ * @param	data	: Data to send
+ * @param	len		: Number of bytes
+ * @return	Bytes queued, less than \a len if the pool or the queue ran out
+ */
+int ipc_sock_send(const void *data, int len);
+
+/**
+ * @brief	Tell if the M0 has a client connected (M4)
+ * @return	!0 when connected, 0 otherwise
+ */
+int ipc_sock_connected(void);
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IPC_SOCK_H_ */
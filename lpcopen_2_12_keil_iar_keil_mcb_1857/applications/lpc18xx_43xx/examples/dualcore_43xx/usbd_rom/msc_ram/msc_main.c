@@ -34,6 +34,11 @@
 #include <string.h>
 #include "app_usbd_cfg.h"
 #include "msc_disk.h"
+#include "msc_split.h"
+
+/* With USB_SPLIT_CORE the USB stack runs on the M0 only, see msc_split.c
+   for the M4 side */
+#if !defined(USB_SPLIT_CORE) || defined(CORE_M0)
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -135,6 +140,10 @@ void USBDEV_Init(void)
 
 	/* Initialize the ramdisk */
 	DataRam_Initialize();
+#ifdef USB_SPLIT_CORE
+	/* written extents go to the M4 in buffers of the M0 pool */
+	msc_split_init();
+#endif
 
 	/* enable clocks and pinmux */
 	USB_init_pin_clk();
@@ -185,7 +194,13 @@ void USBDEV_Init(void)
 	}
 }
 
-/* Nothing to do in USBDEV task */
+/* Nothing to do in USBDEV task, except for sending a held back batch to
+   the M4 in split core mode */
 void usb_device_tasks(void)
 {
+#ifdef USB_SPLIT_CORE
+	msc_split_flush();
+#endif
 }
+
+#endif /* !defined(USB_SPLIT_CORE) || defined(CORE_M0) */
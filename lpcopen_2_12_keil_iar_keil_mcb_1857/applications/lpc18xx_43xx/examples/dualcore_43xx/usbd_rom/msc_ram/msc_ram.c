@@ -34,6 +34,7 @@
 #include "board.h"
 #include "app_usbd_cfg.h"
 #include "msc_disk.h"
+#include "msc_split.h"
 
 /** @ingroup EXAMPLES_USBDROM_18XX43XX_MSC
  * @{
@@ -73,6 +74,10 @@ static void translate_rd( uint32_t offset, uint8_t** buff_adr, uint32_t length,
 static void translate_wr( uint32_t offset, uint8_t** buff_adr, uint32_t length, uint32_t hi_offset)
 {
   *buff_adr =  &g_memDiskArea[(((uint64_t)offset)|(((uint64_t)hi_offset)<<32)) + length];
+#ifdef USB_SPLIT_CORE
+  /* the data is in the disk already, tell the M4 where */
+  msc_split_written(offset, length);
+#endif
 }
 /**
  * @brief	USB device mass storage class get write buffer callback routine
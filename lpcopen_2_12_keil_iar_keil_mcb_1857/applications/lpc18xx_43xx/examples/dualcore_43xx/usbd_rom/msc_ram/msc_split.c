@@ -0,0 +1,194 @@
+/*
+ * @brief Split core USB data handoff of the MSC RAM example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "app_usbd_cfg.h"
+#include "msc_disk.h"
+#include "ipc_msg.h"
+#include "msc_split.h"
+
+#ifdef USB_SPLIT_CORE
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#ifdef CORE_M0
+/* Batch being filled, IPC_POOL_INVALID when none */
+static ipc_buf_t g_pending = IPC_POOL_INVALID;
+static uint32_t g_seq;
+static uint16_t g_dropped;
+#endif
+
+#ifdef CORE_M4
+/* CRC-32 of every disk block, updated as the M0 reports writes */
+static uint32_t g_blockCrc[MSC_MEM_DISK_BLOCK_COUNT];
+static uint32_t g_blocks;
+static uint32_t g_lost;
+#endif
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+#ifdef CORE_M0
+/* Push the pending batch, interrupts masked or from the USB interrupt */
+static void msc_split_send(void)
+{
+	ipcex_msg_t msg;
+
+	msg.id = IPCEX_ID_USBDATA;
+	msg.data = g_pending;
+	/* never wait here, a full queue keeps the batch growing */
+	if (IPC_tryPushMsg(&msg) == QUEUE_INSERT) {
+		g_pending = IPC_POOL_INVALID;
+	}
+}
+#endif
+
+#ifdef CORE_M4
+/* Work on the blocks of one batch in place, then give the buffer back */
+static void msc_split_receive(uint32_t data)
+{
+	const msc_split_batch_t *pBatch = (const msc_split_batch_t *) IPC_poolData((ipc_buf_t) data);
+	const uint8_t *pDisk = (const uint8_t *) MSC_MEM_DISK_BASE;
+	uint32_t i, blk, end;
+
+	if (pBatch == NULL) {
+		return;
+	}
+	for (i = 0; i < pBatch->count; i++) {
+		blk = pBatch->ext[i].offset / MSC_MEM_DISK_BLOCK_SIZE;
+		end = (pBatch->ext[i].offset + pBatch->ext[i].length + MSC_MEM_DISK_BLOCK_SIZE - 1) /
+			  MSC_MEM_DISK_BLOCK_SIZE;
+		for (; (blk < end) && (blk < MSC_MEM_DISK_BLOCK_COUNT); blk++) {
+			g_blockCrc[blk] = Chip_CRCSW_CRC32(0, &pDisk[blk * MSC_MEM_DISK_BLOCK_SIZE],
+											   MSC_MEM_DISK_BLOCK_SIZE);
+			g_blocks++;
+		}
+	}
+	g_lost += pBatch->dropped;
+	if ((pBatch->seq & 15) == 0) {
+		DEBUGOUT("USB split: batch %lu, %lu blocks checked, %lu extents lost\r\n",
+				 (unsigned long) pBatch->seq, (unsigned long) g_blocks, (unsigned long) g_lost);
+	}
+
+	/* back to the M0 through its return ring */
+	IPC_poolFree((ipc_buf_t) data);
+}
+#endif
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+#ifdef CORE_M0
+/* Create the M0 buffer pool for the batches */
+void msc_split_init(void)
+{
+	IPC_initPool(sizeof(msc_split_batch_t));
+}
+
+/* Add a written range to the pending batch */
+void msc_split_written(uint32_t offset, uint32_t length)
+{
+	msc_split_batch_t *pBatch;
+	msc_split_extent_t *pLast;
+
+	if (g_pending == IPC_POOL_INVALID) {
+		g_pending = IPC_poolAlloc();
+		if (g_pending == IPC_POOL_INVALID) {
+			g_dropped++;
+			return;
+		}
+		pBatch = (msc_split_batch_t *) IPC_poolData(g_pending);
+		pBatch->seq = g_seq++;
+		pBatch->count = 0;
+		pBatch->dropped = g_dropped;
+		g_dropped = 0;
+	}
+	pBatch = (msc_split_batch_t *) IPC_poolData(g_pending);
+
+	/* a sequential write extends the last extent */
+	pLast = (pBatch->count != 0) ? &pBatch->ext[pBatch->count - 1] : NULL;
+	if ((pLast != NULL) && ((pLast->offset + pLast->length) == offset)) {
+		pLast->length += length;
+	}
+	else if (pBatch->count < MSC_SPLIT_MAX_EXTENTS) {
+		pBatch->ext[pBatch->count].offset = offset;
+		pBatch->ext[pBatch->count].length = length;
+		pBatch->count++;
+	}
+	else {
+		g_dropped++;
+	}
+
+	msc_split_send();
+}
+
+/* Send a batch left pending on a full IPC queue */
+void msc_split_flush(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (g_pending != IPC_POOL_INVALID) {
+		msc_split_send();
+	}
+	__set_PRIMASK(primask);
+}
+
+#endif /* CORE_M0 */
+
+#ifdef CORE_M4
+/**
+ * @brief	Take the written blocks from the M0, which runs the USB stack
+ * @return	Nothing
+ */
+void USBDEV_Init(void)
+{
+	Chip_CRCSW_Init();
+	ipcex_register_callback(IPCEX_ID_USBDATA, msc_split_receive);
+}
+
+/* Batches are handled by the IPC dispatch */
+void usb_device_tasks(void)
+{
+}
+
+#endif /* CORE_M4 */
+
+#endif /* USB_SPLIT_CORE */
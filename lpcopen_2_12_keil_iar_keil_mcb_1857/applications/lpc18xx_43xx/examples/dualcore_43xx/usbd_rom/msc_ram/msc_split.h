@@ -0,0 +1,108 @@
+/*
+ * @brief Split core USB data handoff of the MSC RAM example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __MSC_SPLIT_H_
+#define __MSC_SPLIT_H_
+
+#include "app_dualcore_cfg.h"
+#include "ipc_pool.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_MSC
+ * @{
+ */
+
+/* With USB_SPLIT_CORE defined in both images the M0 owns the USB
+   controller and the ROM stack, the M4 runs no USB code at all. Host
+   writes go by USB DMA straight into the RAM disk in shared SRAM; the M0
+   then hands the written extents to the M4 in a buffer of its IPC pool
+   (ipc_pool.h), sent as an IPCEX_ID_USBDATA message. The M4 works on the
+   blocks in place and frees the buffer, which goes back to the M0 pool
+   through its return ring. While the M4 queue is full the M0 keeps adding
+   extents to the pending buffer, so a busy M4 gets fewer, larger batches.
+ */
+
+/* Extents in one batch buffer */
+#define MSC_SPLIT_MAX_EXTENTS   8
+
+/**
+ * @brief Written disk range
+ */
+typedef struct {
+	uint32_t offset;		/*!< Disk byte offset */
+	uint32_t length;		/*!< Bytes written */
+} msc_split_extent_t;
+
+/**
+ * @brief Batch sent to the M4, the payload of an M0 pool buffer
+ */
+typedef struct {
+	uint32_t seq;			/*!< Batch number, counts from 0 */
+	uint16_t count;			/*!< Extents used */
+	uint16_t dropped;		/*!< Extents lost to an empty pool before this batch */
+	msc_split_extent_t ext[MSC_SPLIT_MAX_EXTENTS];
+} msc_split_batch_t;
+
+/**
+ * @brief	Create the M0 buffer pool for the batches (M0)
+ * @return	Nothing
+ */
+void msc_split_init(void);
+
+/**
+ * @brief	Add a written range to the pending batch and try to send it (M0)
+ * @param	offset	: Disk byte offset
+ * @param	length	: Bytes written
+ * @return	Nothing
+ * @note	Called from the MSC write callback in the USB interrupt.
+ */
+void msc_split_written(uint32_t offset, uint32_t length);
+
+/**
+ * @brief	Send a batch left pending on a full IPC queue (M0)
+ * @return	Nothing
+ * @note	Call from the M0 main loop.
+ */
+void msc_split_flush(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MSC_SPLIT_H_ */
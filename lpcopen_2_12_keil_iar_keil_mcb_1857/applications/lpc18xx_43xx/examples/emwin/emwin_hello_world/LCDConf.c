@@ -32,6 +32,9 @@ Purpose     : Display controller configuration (single layer)
 
 #include "GUI.h"
 #include "GUIDRV_Lin.h"
+#include "LCDConf.h"
+#include "board.h"
+#include <string.h>
 
 /*********************************************************************
 *
@@ -86,9 +89,24 @@ Purpose     : Display controller configuration (single layer)
 //
 // Buffers / VScreens
 //
-#define NUM_BUFFERS  1 // Number of multiple buffers to be used
+#define NUM_BUFFERS  3 // Number of multiple buffers to be used, page flipped on the LCD base address update
 #define NUM_VSCREENS 1 // Number of virtual screens to be used
 
+//
+// GPDMA acceleration
+//
+#define USE_GPDMA        1  // Copy buffers, fill and copy rectangles with the GPDMA
+#define GPDMA_MIN_PIXELS 64 // Rectangles smaller than this are done by the CPU
+
+//
+// Dirty rectangle tracking, only copy the area changed since a buffer was
+// last drawn into at the start of a multiple buffer update. Everything the
+// application draws has to reach the frame buffer through the GPDMA hooks
+// (memory devices, see WM_SetCreateFlags(WM_CF_MEMDEV)), or be reported
+// with LCDConf_AddDirtyRect(). Needs the unrotated hooks.
+//
+#define USE_DIRTY_RECTS  0
+
 /*********************************************************************
 *
 *       Configuration checking
@@ -96,7 +114,7 @@ Purpose     : Display controller configuration (single layer)
 **********************************************************************
 */
 #ifndef   VRAM_ADDR
-  #define VRAM_ADDR 0x28000000 // TBD by customer: This has to be the frame buffer start address
+  #define VRAM_ADDR FRAMEBUFFER_ADDR // Start of the frame buffers, NUM_BUFFERS of them back to back
 #endif
 #ifndef   XSIZE_PHYS
   #error Physical X size of display is not defined!
@@ -120,10 +138,16 @@ Purpose     : Display controller configuration (single layer)
 #if (NUM_VSCREENS > 1) && (NUM_BUFFERS > 1)
   #error Virtual screens and multiple buffers are not allowed!
 #endif
+#if (USE_DIRTY_RECTS == 1) && ((USE_GPDMA == 0) || (NUM_BUFFERS == 1))
+  #error Dirty rectangle tracking needs USE_GPDMA and multiple buffers!
+#endif
 
 #ifndef   DISPLAY_ORIENTATION
   #define DISPLAY_ORIENTATION  0
 #endif
+#if (USE_DIRTY_RECTS == 1) && (DISPLAY_ORIENTATION != 0)
+  #error Dirty rectangle tracking needs an unrotated display!
+#endif
 
 #if ((DISPLAY_ORIENTATION & GUI_SWAP_XY) != 0)
 #define LANDSCAPE   1
@@ -171,6 +195,257 @@ Purpose     : Display controller configuration (single layer)
   #endif
 #endif
 
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+//
+// Frame buffer manager, flips between the emWin buffers in sync with the
+// LCD controller so the buffer being scanned out is never drawn into
+//
+static LCD_FB_T _LCD_FB;
+
+#if (USE_GPDMA == 1)
+//
+// GPDMA channel and one descriptor per frame buffer line
+//
+static uint8_t                  _DMAChannel = GPDMA_NO_CHANNEL;
+static DMA_TransferDescriptor_t _aDMADesc[YSIZE_PHYS];
+//
+// Buffer emWin draws into, the destination of the last buffer copy
+//
+static int                      _DrawIndex;
+//
+// Pattern the fill source address points at
+//
+static volatile uint32_t        _FillPattern;
+#endif
+
+#if (USE_DIRTY_RECTS == 1)
+//
+// Area of each buffer that is older than the latest drawing. A rectangle
+// with x0 > x1 is empty.
+//
+typedef struct {
+  int x0, y0, x1, y1;
+} DIRTY_RECT;
+
+static DIRTY_RECT _aDirty[NUM_BUFFERS];
+#endif
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+#if (USE_GPDMA == 1)
+/*********************************************************************
+*
+*       _GetPixelAddr
+*
+* Purpose:
+*   Returns the address of a pixel of a frame buffer.
+*/
+static uint32_t _GetPixelAddr(int Index, int x, int y) {
+  return VRAM_ADDR + Index * XSIZE_PHYS * YSIZE_PHYS * 2 + (y * XSIZE_PHYS + x) * 2;
+}
+
+#if (USE_DIRTY_RECTS == 1)
+/*********************************************************************
+*
+*       _AddDirty
+*
+* Purpose:
+*   Records drawing into the draw buffer, which leaves the same area out
+*   of date in all other buffers.
+*/
+static void _AddDirty(int x0, int y0, int x1, int y1) {
+  DIRTY_RECT * pRect;
+  int          i;
+
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    if (i != _DrawIndex) {
+      pRect = &_aDirty[i];
+      if (pRect->x0 > pRect->x1) {
+        pRect->x0 = x0;
+        pRect->y0 = y0;
+        pRect->x1 = x1;
+        pRect->y1 = y1;
+      } else {
+        pRect->x0 = (x0 < pRect->x0) ? x0 : pRect->x0;
+        pRect->y0 = (y0 < pRect->y0) ? y0 : pRect->y0;
+        pRect->x1 = (x1 > pRect->x1) ? x1 : pRect->x1;
+        pRect->y1 = (y1 > pRect->y1) ? y1 : pRect->y1;
+      }
+    }
+  }
+}
+#else
+  #define _AddDirty(x0, y0, x1, y1)
+#endif
+
+/*********************************************************************
+*
+*       _CPU_Rect
+*
+* Purpose:
+*   Fills a rectangle with _FillPattern or copies it line by line with
+*   the CPU, for small or overlapping rectangles.
+*/
+static void _CPU_Rect(uint32_t Dst, int DstStride, uint32_t Src, int SrcStride, int xSize, int ySize, bool Fill) {
+  uint16_t * pPixel;
+  int        x;
+  int        y;
+
+  for (y = 0; y < ySize; y++) {
+    if (Fill) {
+      pPixel = (uint16_t *)Dst;
+      for (x = 0; x < xSize; x++) {
+        *pPixel++ = (uint16_t)_FillPattern;
+      }
+    } else {
+      memmove((void *)Dst, (void *)Src, xSize * 2);
+    }
+    Dst += DstStride;
+    Src += SrcStride;
+  }
+}
+
+/*********************************************************************
+*
+*       _DMA_Rect
+*
+* Purpose:
+*   Runs a rectangle transfer on the GPDMA, one descriptor per line, and
+*   waits for its last line. Falls back to the CPU without a channel.
+*/
+static void _DMA_Rect(uint32_t Dst, int DstStride, uint32_t Src, int SrcStride, int xSize, int ySize, bool Fill) {
+  if ((_DMAChannel != GPDMA_NO_CHANNEL) &&
+      (Chip_GPDMA_RectTransfer(LPC_GPDMA, _DMAChannel, _aDMADesc, Dst, DstStride, Src, SrcStride, xSize * 2, ySize, Fill) == SUCCESS)) {
+    while (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_ENABLED_CH, _DMAChannel)) {}
+    Chip_GPDMA_ClearIntPending(LPC_GPDMA, GPDMA_STATCLR_INTTC, _DMAChannel);
+  } else {
+    _CPU_Rect(Dst, DstStride, Src, SrcStride, xSize, ySize, Fill);
+  }
+}
+#endif
+
+#if (USE_GPDMA == 1) && (DISPLAY_ORIENTATION == 0)
+/*********************************************************************
+*
+*       _LCD_FillRect
+*
+* Purpose:
+*   LCD_DEVFUNC_FILLRECT, fills a rectangle of the draw buffer.
+*/
+static void _LCD_FillRect(int LayerIndex, int x0, int y0, int x1, int y1, U32 PixelIndex) {
+  int xSize;
+  int ySize;
+
+  xSize = x1 - x0 + 1;
+  ySize = y1 - y0 + 1;
+  if (GUI_GetDrawMode() == GUI_DM_XOR) {
+    //
+    // XOR needs the destination, leave it to the driver
+    //
+    LCD_SetDevFunc(LayerIndex, LCD_DEVFUNC_FILLRECT, NULL);
+    LCD_FillRect(x0, y0, x1, y1);
+    LCD_SetDevFunc(LayerIndex, LCD_DEVFUNC_FILLRECT, (void(*)(void))_LCD_FillRect);
+  } else {
+    _FillPattern = (PixelIndex & 0xFFFF) | (PixelIndex << 16);
+    if ((xSize * ySize) < GPDMA_MIN_PIXELS) {
+      _CPU_Rect(_GetPixelAddr(_DrawIndex, x0, y0), XSIZE_PHYS * 2, 0, 0, xSize, ySize, true);
+    } else {
+      _DMA_Rect(_GetPixelAddr(_DrawIndex, x0, y0), XSIZE_PHYS * 2, (uint32_t)&_FillPattern, 0, xSize, ySize, true);
+    }
+  }
+  _AddDirty(x0, y0, x1, y1);
+}
+
+/*********************************************************************
+*
+*       _LCD_CopyRect
+*
+* Purpose:
+*   LCD_DEVFUNC_COPYRECT, copies a rectangle of the draw buffer from
+*   x0/y0 to x1/y1, used for scrolling and moving windows.
+*/
+static void _LCD_CopyRect(int LayerIndex, int x0, int y0, int x1, int y1, int xSize, int ySize) {
+  int Stride;
+
+  (void)LayerIndex;
+  Stride = XSIZE_PHYS * 2;
+  if (((y0 == y1) && (x1 > x0) && (x1 < x0 + xSize)) || ((xSize * ySize) < GPDMA_MIN_PIXELS)) {
+    //
+    // Small rectangles, and overlapping moves to the right within the
+    // lines, which the DMA cannot do as it copies each line upwards
+    //
+    _CPU_Rect(_GetPixelAddr(_DrawIndex, x1, y1), Stride, _GetPixelAddr(_DrawIndex, x0, y0), Stride, xSize, ySize, false);
+  } else if (y1 > y0) {
+    //
+    // Moving down, copy the lines from the bottom up
+    //
+    Stride = -Stride;
+    _DMA_Rect(_GetPixelAddr(_DrawIndex, x1, y1 + ySize - 1), Stride, _GetPixelAddr(_DrawIndex, x0, y0 + ySize - 1), Stride, xSize, ySize, false);
+  } else {
+    _DMA_Rect(_GetPixelAddr(_DrawIndex, x1, y1), Stride, _GetPixelAddr(_DrawIndex, x0, y0), Stride, xSize, ySize, false);
+  }
+  _AddDirty(x1, y1, x1 + xSize - 1, y1 + ySize - 1);
+}
+
+/*********************************************************************
+*
+*       _LCD_DrawBitmap16bpp
+*
+* Purpose:
+*   LCD_DEVFUNC_DRAWBMP_16BPP, copies a 16bpp bitmap such as the content
+*   of a memory device into the draw buffer.
+*/
+static void _LCD_DrawBitmap16bpp(int LayerIndex, int x, int y, U16 const * p, int xSize, int ySize, int BytesPerLine) {
+  (void)LayerIndex;
+  if ((xSize * ySize) < GPDMA_MIN_PIXELS) {
+    _CPU_Rect(_GetPixelAddr(_DrawIndex, x, y), XSIZE_PHYS * 2, (uint32_t)p, BytesPerLine, xSize, ySize, false);
+  } else {
+    _DMA_Rect(_GetPixelAddr(_DrawIndex, x, y), XSIZE_PHYS * 2, (uint32_t)p, BytesPerLine, xSize, ySize, false);
+  }
+  _AddDirty(x, y, x + xSize - 1, y + ySize - 1);
+}
+#endif
+
+#if (USE_GPDMA == 1) && (NUM_BUFFERS > 1)
+/*********************************************************************
+*
+*       _LCD_CopyBuffer
+*
+* Purpose:
+*   LCD_DEVFUNC_COPYBUFFER, called by emWin at the start of a multiple
+*   buffer update to copy the front buffer into the next draw buffer.
+*/
+static void _LCD_CopyBuffer(int LayerIndex, int IndexSrc, int IndexDst) {
+  #if (USE_DIRTY_RECTS == 1)
+    DIRTY_RECT * pRect;
+
+    //
+    // Only the area drawn since the destination was last drawn into differs
+    //
+    pRect = &_aDirty[IndexDst];
+    if (pRect->x0 <= pRect->x1) {
+      _DMA_Rect(_GetPixelAddr(IndexDst, pRect->x0, pRect->y0), XSIZE_PHYS * 2, _GetPixelAddr(IndexSrc, pRect->x0, pRect->y0), XSIZE_PHYS * 2,
+                pRect->x1 - pRect->x0 + 1, pRect->y1 - pRect->y0 + 1, false);
+      pRect->x0 = 1;
+      pRect->x1 = 0;
+    }
+  #else
+    _DMA_Rect(_GetPixelAddr(IndexDst, 0, 0), XSIZE_PHYS * 2, _GetPixelAddr(IndexSrc, 0, 0), XSIZE_PHYS * 2, XSIZE_PHYS, YSIZE_PHYS, false);
+  #endif
+  (void)LayerIndex;
+  _DrawIndex = IndexDst;
+}
+#endif
+
 /*********************************************************************
 *
 *       Public code
@@ -187,6 +462,10 @@ Purpose     : Display controller configuration (single layer)
 *   
 */
 void LCD_X_Config(void) {
+  #if (USE_DIRTY_RECTS == 1)
+    int i;
+
+  #endif
   //
   // At first initialize use of multiple buffers on demand
   //
@@ -208,6 +487,34 @@ void LCD_X_Config(void) {
     LCD_SetVSizeEx(0, XSIZE_PHYS, YSIZE_PHYS * NUM_VSCREENS);
   }
   LCD_SetVRAMAddrEx(0, (void *)VRAM_ADDR);
+
+  #if (USE_GPDMA == 1)
+    //
+    // Set the GPDMA routines for frame buffer copies and, with the
+    // frame buffer in display order, rectangle fills and copies
+    //
+    #if (NUM_BUFFERS > 1)
+      LCD_SetDevFunc(0, LCD_DEVFUNC_COPYBUFFER, (void(*)(void))_LCD_CopyBuffer);
+    #endif
+    #if (DISPLAY_ORIENTATION == 0)
+      LCD_SetDevFunc(0, LCD_DEVFUNC_FILLRECT, (void(*)(void))_LCD_FillRect);
+      LCD_SetDevFunc(0, LCD_DEVFUNC_COPYRECT, (void(*)(void))_LCD_CopyRect);
+      LCD_SetDevFunc(0, LCD_DEVFUNC_DRAWBMP_16BPP, (void(*)(void))_LCD_DrawBitmap16bpp);
+    #endif
+  #endif
+  #if (USE_DIRTY_RECTS == 1)
+    //
+    // Drawing starts in buffer 0, the content of the others is unknown
+    //
+    for (i = 1; i < NUM_BUFFERS; i++) {
+      _aDirty[i].x0 = 0;
+      _aDirty[i].y0 = 0;
+      _aDirty[i].x1 = XSIZE_PHYS - 1;
+      _aDirty[i].y1 = YSIZE_PHYS - 1;
+    }
+    _aDirty[0].x0 = 1;
+    _aDirty[0].x1 = 0;
+  #endif
  
   #if (USE_TOUCH == 1)
     //
@@ -229,6 +536,25 @@ void LCD_X_Config(void) {
   #endif
 }
 
+/*********************************************************************
+*
+*       LCDConf_AddDirtyRect
+*
+* Purpose:
+*   Reports drawing that did not go through the GPDMA hooks, in physical
+*   coordinates, when dirty rectangle tracking is used.
+*/
+void LCDConf_AddDirtyRect(int x0, int y0, int x1, int y1) {
+  #if (USE_DIRTY_RECTS == 1)
+    _AddDirty(x0, y0, x1, y1);
+  #else
+    (void)x0;
+    (void)y0;
+    (void)x1;
+    (void)y1;
+  #endif
+}
+
 /*********************************************************************
 *
 *       LCD_X_DisplayDriver
@@ -261,7 +587,18 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData) {
     // controller is not initialized by any external routine this needs
     // to be adapted by the customer...
     //
-    // ...
+    void * apBuffer[NUM_BUFFERS];
+    int    i;
+
+    for (i = 0; i < NUM_BUFFERS; i++) {
+      apBuffer[i] = (void *)(VRAM_ADDR + i * XSIZE_PHYS * YSIZE_PHYS * 2);
+    }
+    Chip_LCD_FB_Init(LPC_LCD, &_LCD_FB, apBuffer, NUM_BUFFERS, XSIZE_PHYS * YSIZE_PHYS * 2);
+    NVIC_EnableIRQ(LCD_IRQn);
+    #if (USE_GPDMA == 1)
+      Chip_GPDMA_Init(LPC_GPDMA);
+      _DMAChannel = Chip_GPDMA_GetPriorityChannel(LPC_GPDMA, GPDMA_CONN_MEMORY, GPDMA_PRIO_BACKGROUND, false);
+    #endif
     return 0;
   }
   case LCD_X_SETVRAMADDR: {
@@ -287,9 +624,11 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData) {
     //
     // Required if multiple buffers are used. The 'Index' element of p contains the buffer index.
     //
-    //LCD_X_SHOWBUFFER_INFO * p;
-    //p = (LCD_X_SHOWBUFFER_INFO *)pData;
-    //...
+    // The buffer is confirmed to emWin from LCD_IRQHandler() once shown.
+    //
+    LCD_X_SHOWBUFFER_INFO * p;
+    p = (LCD_X_SHOWBUFFER_INFO *)pData;
+    Chip_LCD_FB_Queue(&_LCD_FB, p->Index);
     return 0;
   }
   case LCD_X_SETLUTENTRY: {
@@ -320,6 +659,27 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData) {
   return r;
 }
 
+/*********************************************************************
+*
+*       LCD_IRQHandler
+*
+* Purpose:
+*   Confirms a buffer passed with LCD_X_SHOWBUFFER to emWin once the LCD
+*   controller has loaded it at the start of a frame.
+*/
+void LCD_IRQHandler(void) {
+  int Index;
+
+  Index = Chip_LCD_FB_IRQHandler(&_LCD_FB);
+  #if (NUM_BUFFERS > 1)
+    if (Index >= 0) {
+      GUI_MULTIBUF_Confirm(Index);
+    }
+  #else
+    (void)Index;
+  #endif
+}
+
 /*********************************************************************
 *
 *       Global functions for GUI touch
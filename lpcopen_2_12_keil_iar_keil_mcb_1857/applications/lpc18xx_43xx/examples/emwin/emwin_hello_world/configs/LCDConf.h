@@ -33,6 +33,16 @@ Purpose     : Display driver configuration file
 #ifndef LCDCONF_H
 #define LCDCONF_H
 
+/*********************************************************************
+*
+*       LCDConf_AddDirtyRect
+*
+* Purpose:
+*   Reports drawing into the frame buffer that bypassed the display
+*   driver hooks, for dirty rectangle tracking (USE_DIRTY_RECTS).
+*/
+void LCDConf_AddDirtyRect(int x0, int y0, int x1, int y1);
+
 #endif /* LCDCONF_H */
 
 /*************************** End of file ****************************/
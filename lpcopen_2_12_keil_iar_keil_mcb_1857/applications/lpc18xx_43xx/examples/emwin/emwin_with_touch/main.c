@@ -49,7 +49,7 @@ static int16_t old_tmp_x = -1, old_tmp_y = -1;
 /**
  * @brief GUI buffers required for emwin library
  */
-#define GUI_BUF_ADDR  0x28050000
+#define GUI_BUF_ADDR  0x28080000	/* After the LCDConf.c frame buffers */
 #define GUI_NUMBYTES  ((1024 * 1024) * 2)
 U32 GUI_Memory_Size = GUI_NUMBYTES;
 U32 GUI_Block_Size = 0x128;
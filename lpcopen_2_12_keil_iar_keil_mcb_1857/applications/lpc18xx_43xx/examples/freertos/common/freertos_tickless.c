@@ -0,0 +1,208 @@
+/*
+ * @brief FreeRTOS tickless idle for LPC18xx/43xx using the RI timer
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Tickless idle, selected in FreeRTOSConfig.h with configUSE_TICKLESS_IDLE
+   and portSUPPRESS_TICKS_AND_SLEEP() mapped to vApplicationSleep(). While
+   the idle task is the only one ready, SysTick is stopped and the RI timer,
+   which counts at the core clock, wakes the core when the next task has to
+   run. The time actually slept is read back from the RI timer so the tick
+   count does not drift, whichever interrupt ended the sleep.
+
+   With TICKLESS_LOW_CLOCK set, sleeps of TICKLESS_LOW_CLOCK_MIN_TICKS or
+   more also move the core and bus clock (BASE_M3) to the 12MHz IRC. The PLL
+   keeps running so switching back is immediate. Peripherals clocked from
+   BASE_M3 branches, such as the timers, run slower during these sleeps;
+   those on their own base clocks (UARTs, SSP, USB, Ethernet) are not
+   affected. The RI timer is used by this file only. */
+
+#if (configUSE_TICKLESS_IDLE == 1)
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#ifndef TICKLESS_LOW_CLOCK
+#define TICKLESS_LOW_CLOCK            0
+#endif
+
+#ifndef TICKLESS_LOW_CLOCK_MIN_TICKS
+#define TICKLESS_LOW_CLOCK_MIN_TICKS  10
+#endif
+
+/* Set once the RI timer runs free and can wake the core */
+static bool ritReady;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Free running RI timer, the match only raises the wake up interrupt */
+static void tickless_init(void)
+{
+	Chip_RIT_Init(LPC_RITIMER);
+	Chip_RIT_Disable(LPC_RITIMER);
+	NVIC_SetPriority(RITIMER_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY);
+	NVIC_EnableIRQ(RITIMER_IRQn);
+	ritReady = true;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* RI timer match, only there to end the WFI */
+void RIT_IRQHandler(void)
+{
+	Chip_RIT_ClearInt(LPC_RITIMER);
+}
+
+/* Sleep for up to xExpectedIdleTime ticks with the tick stopped */
+void vApplicationSleep(portTickType xExpectedIdleTime)
+{
+	uint32_t cyclesPerTick = SystemCoreClock / configTICK_RATE_HZ;
+	uint32_t remaining, target, elapsed, ticks;
+#if TICKLESS_LOW_CLOCK
+	CHIP_CGU_CLKIN_T coreClkIn = CLKIN_IRC;
+	uint32_t lowStart, lowEnd;
+	bool lowClock;
+#endif
+
+	if (!ritReady) {
+		tickless_init();
+	}
+
+	/* Keep the sleep inside the 32-bit RI timer count */
+	if (xExpectedIdleTime > (0xFFFFFFFF / cyclesPerTick) - 1) {
+		xExpectedIdleTime = (0xFFFFFFFF / cyclesPerTick) - 1;
+	}
+
+	/* Stop the tick, the part of the current tick not gone yet is kept */
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	remaining = SysTick->VAL;
+	if (remaining == 0) {
+		remaining = cyclesPerTick;
+	}
+
+	/* Interrupts stay masked from here, a pending one still ends the WFI */
+	__disable_irq();
+	if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+		/* Carry on with the tick as it was */
+		SysTick->LOAD = remaining - 1;
+		SysTick->VAL = 0;
+		SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+		SysTick->LOAD = cyclesPerTick - 1;
+		__enable_irq();
+		return;
+	}
+
+	/* Wake at the tick boundary the expected idle time ends on */
+	target = remaining + (cyclesPerTick * (xExpectedIdleTime - 1));
+	Chip_RIT_Disable(LPC_RITIMER);
+	LPC_RITIMER->COUNTER = 0;
+	Chip_RIT_ClearInt(LPC_RITIMER);
+	NVIC_ClearPendingIRQ(RITIMER_IRQn);
+
+#if TICKLESS_LOW_CLOCK
+	lowClock = xExpectedIdleTime >= TICKLESS_LOW_CLOCK_MIN_TICKS;
+	if (lowClock) {
+		/* The timer counts at the IRC rate until the clock is restored */
+		coreClkIn = Chip_Clock_GetBaseClock(CLK_BASE_MX);
+		Chip_RIT_SetCOMPVAL(LPC_RITIMER, 0xFFFFFFFF);
+		Chip_RIT_Enable(LPC_RITIMER);
+		Chip_Clock_SetBaseClock(CLK_BASE_MX, CLKIN_IRC, true, false);
+		lowStart = Chip_RIT_GetCounter(LPC_RITIMER);
+		Chip_RIT_SetCOMPVAL(LPC_RITIMER, lowStart +
+							(uint32_t) (((uint64_t) (target - lowStart) * CGU_IRC_FREQ) / SystemCoreClock));
+	}
+	else
+#endif
+	{
+		Chip_RIT_SetCOMPVAL(LPC_RITIMER, target);
+		Chip_RIT_Enable(LPC_RITIMER);
+	}
+
+	/* Sleep mode, not deep sleep, so the RI timer keeps counting */
+	SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+	__DSB();
+	Chip_PMC_Sleep();
+	__ISB();
+
+#if TICKLESS_LOW_CLOCK
+	if (lowClock) {
+		lowEnd = Chip_RIT_GetCounter(LPC_RITIMER);
+		Chip_Clock_SetBaseClock(CLK_BASE_MX, coreClkIn, true, false);
+
+		/* Time spent at the IRC rate, scaled back to core clocks */
+		elapsed = lowStart + (uint32_t) (((uint64_t) (lowEnd - lowStart) * SystemCoreClock) / CGU_IRC_FREQ);
+		elapsed += Chip_RIT_GetCounter(LPC_RITIMER) - lowEnd;
+	}
+	else
+#endif
+	{
+		elapsed = Chip_RIT_GetCounter(LPC_RITIMER);
+	}
+	Chip_RIT_Disable(LPC_RITIMER);
+
+	if (elapsed < remaining) {
+		/* Woken before the tick that was due, finish that tick */
+		SysTick->LOAD = MAX(remaining - elapsed, 2) - 1;
+	}
+	else {
+		/* Whole ticks gone, the last one is counted by the tick handler so
+		   tasks due on it are unblocked there */
+		elapsed -= remaining;
+		ticks = 1 + (elapsed / cyclesPerTick);
+		if (ticks > xExpectedIdleTime) {
+			ticks = xExpectedIdleTime;
+		}
+		vTaskStepTick(ticks - 1);
+		SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+		SysTick->LOAD = MAX(cyclesPerTick - (elapsed % cyclesPerTick), 2) - 1;
+	}
+
+	/* Restart the tick with the rest of the current period, then go back to
+	   full periods from the next reload */
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	SysTick->LOAD = cyclesPerTick - 1;
+
+	__enable_irq();
+}
+
+#endif /* configUSE_TICKLESS_IDLE == 1 */
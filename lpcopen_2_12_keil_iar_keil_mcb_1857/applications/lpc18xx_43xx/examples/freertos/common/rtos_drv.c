@@ -0,0 +1,369 @@
+/*
+ * @brief RTOS aware blocking peripheral transfers for the FreeRTOS and uC/OS-III examples
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include "rtos_drv.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* SSP interrupts used while a transfer is running */
+#define SSP_XFER_INTS   (SSP_TXIM | SSP_RXIM | SSP_RTIM)
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+#if defined(OS_FREE_RTOS)
+
+/* FreeRTOS semaphore and mutex */
+static int drv_create(RTOS_DRV_T *pDrv)
+{
+	vSemaphoreCreateBinary(pDrv->done);
+	pDrv->lock = xSemaphoreCreateMutex();
+	return (pDrv->done == NULL) || (pDrv->lock == NULL);
+}
+
+/* Drop a completion left over from an earlier transfer */
+static void drv_arm(RTOS_DRV_T *pDrv)
+{
+	xSemaphoreTake(pDrv->done, 0);
+}
+
+static void drv_wait(RTOS_DRV_T *pDrv)
+{
+	while (pDrv->pXfer != NULL) {
+		xSemaphoreTake(pDrv->done, portMAX_DELAY);
+	}
+}
+
+static void drv_signal_isr(RTOS_DRV_T *pDrv)
+{
+	portBASE_TYPE woken = pdFALSE;
+
+	xSemaphoreGiveFromISR(pDrv->done, &woken);
+	portEND_SWITCHING_ISR(woken);
+}
+
+static void drv_lock(RTOS_DRV_T *pDrv)
+{
+	xSemaphoreTake(pDrv->lock, portMAX_DELAY);
+}
+
+static void drv_unlock(RTOS_DRV_T *pDrv)
+{
+	xSemaphoreGive(pDrv->lock);
+}
+
+static void drv_sleep_tick(void)
+{
+	vTaskDelay(1);
+}
+
+#elif defined(OS_UCOS_III)
+
+/* uC/OS-III semaphore and mutex */
+static int drv_create(RTOS_DRV_T *pDrv)
+{
+	OS_ERR os_err;
+
+	OSSemCreate(&pDrv->done, "DrvDone", 0, &os_err);
+	if (os_err != OS_ERR_NONE) {
+		return 1;
+	}
+	OSMutexCreate(&pDrv->lock, "DrvLock", &os_err);
+	return os_err != OS_ERR_NONE;
+}
+
+/* Drop a completion left over from an earlier transfer */
+static void drv_arm(RTOS_DRV_T *pDrv)
+{
+	OS_ERR os_err;
+
+	OSSemSet(&pDrv->done, 0, &os_err);
+}
+
+static void drv_wait(RTOS_DRV_T *pDrv)
+{
+	CPU_TS ts;
+	OS_ERR os_err;
+
+	while (pDrv->pXfer != NULL) {
+		OSSemPend(&pDrv->done, 0, OS_OPT_PEND_BLOCKING, &ts, &os_err);
+	}
+}
+
+/* Called between OSIntEnter() and OSIntExit(), which does the switch */
+static void drv_signal_isr(RTOS_DRV_T *pDrv)
+{
+	OS_ERR os_err;
+
+	OSSemPost(&pDrv->done, OS_OPT_POST_1, &os_err);
+}
+
+static void drv_lock(RTOS_DRV_T *pDrv)
+{
+	CPU_TS ts;
+	OS_ERR os_err;
+
+	OSMutexPend(&pDrv->lock, 0, OS_OPT_PEND_BLOCKING, &ts, &os_err);
+}
+
+static void drv_unlock(RTOS_DRV_T *pDrv)
+{
+	OS_ERR os_err;
+
+	OSMutexPost(&pDrv->lock, OS_OPT_POST_NONE, &os_err);
+}
+
+static void drv_sleep_tick(void)
+{
+	OS_ERR os_err;
+
+	OSTimeDly(1, OS_OPT_TIME_DLY, &os_err);
+}
+
+#else
+
+/* Stand-alone, sleeps with WFI until the interrupt handler is done */
+static int drv_create(RTOS_DRV_T *pDrv)
+{
+	return 0;
+}
+
+static void drv_arm(RTOS_DRV_T *pDrv)
+{}
+
+static void drv_wait(RTOS_DRV_T *pDrv)
+{
+	while (pDrv->pXfer != NULL) {
+		__WFI();
+	}
+}
+
+static void drv_signal_isr(RTOS_DRV_T *pDrv)
+{}
+
+static void drv_lock(RTOS_DRV_T *pDrv)
+{}
+
+static void drv_unlock(RTOS_DRV_T *pDrv)
+{}
+
+#endif
+
+/* Mark the transfer done and wake the waiting task, from the IRQ handler */
+static void drv_complete(RTOS_DRV_T *pDrv, uint32_t result)
+{
+	pDrv->result = result;
+	pDrv->pXfer = NULL;
+	drv_signal_isr(pDrv);
+}
+
+/* Publish a transfer to the IRQ handler, before its interrupt source is enabled */
+static void drv_start(RTOS_DRV_T *pDrv, void *pXfer)
+{
+	drv_arm(pDrv);
+	pDrv->pXfer = pXfer;
+	NVIC_EnableIRQ(pDrv->irq);
+}
+
+/* Sleep until the IRQ handler is done with the transfer */
+static uint32_t drv_finish(RTOS_DRV_T *pDrv)
+{
+	drv_wait(pDrv);
+	return pDrv->result;
+}
+
+#if defined(OS_FREE_RTOS) || defined(OS_UCOS_III)
+/* EEPROM wait, one tick per poll, a page takes a few ms to program */
+static void drv_eeprom_wait(LPC_EEPROM_T *pEEPROM, uint32_t mask)
+{
+	while ((Chip_EEPROM_GetIntStatus(pEEPROM) & mask) != mask) {
+		drv_sleep_tick();
+	}
+}
+
+#endif
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Create the semaphore and the mutex of a peripheral */
+int RTOS_Drv_Init(RTOS_DRV_T *pDrv, void *pBase, IRQn_Type irq)
+{
+	pDrv->pBase = pBase;
+	pDrv->irq = irq;
+	pDrv->pXfer = NULL;
+	return drv_create(pDrv);
+}
+
+/* I2C master transfer, sleeping until it is done */
+uint32_t RTOS_I2CM_XferBlocking(RTOS_DRV_T *pDrv, I2CM_XFER_T *xfer)
+{
+	uint32_t ret;
+
+	drv_lock(pDrv);
+	drv_start(pDrv, xfer);
+	/* START goes out now, the state changes that follow run the transfer */
+	Chip_I2CM_Xfer((LPC_I2C_T *) pDrv->pBase, xfer);
+	ret = drv_finish(pDrv);
+	drv_unlock(pDrv);
+
+	return ret;
+}
+
+/* I2C interrupt handler */
+void RTOS_I2CM_IRQHandler(RTOS_DRV_T *pDrv)
+{
+	LPC_I2C_T *pI2C = (LPC_I2C_T *) pDrv->pBase;
+	I2CM_XFER_T *xfer = (I2CM_XFER_T *) pDrv->pXfer;
+
+	if (xfer == NULL) {
+		Chip_I2CM_ClearSI(pI2C);
+		return;
+	}
+	if (Chip_I2CM_XferHandler(pI2C, xfer) != 0) {
+		/* SI cannot be masked in the peripheral */
+		NVIC_DisableIRQ(pDrv->irq);
+		drv_complete(pDrv, 1);
+	}
+}
+
+/* SSP read/write, sleeping until all frames are received */
+uint32_t RTOS_SSP_RWFrames_Blocking(RTOS_DRV_T *pDrv, Chip_SSP_DATA_SETUP_T *xf_setup)
+{
+	LPC_SSP_T *pSSP = (LPC_SSP_T *) pDrv->pBase;
+	uint32_t ret;
+
+	drv_lock(pDrv);
+	Chip_SSP_Int_FlushData(pSSP);
+	drv_start(pDrv, xf_setup);
+	/* TX FIFO half empty fires at once and keeps the FIFO fed */
+	Chip_SSP_Int_Enable(pSSP);
+	ret = drv_finish(pDrv);
+	drv_unlock(pDrv);
+
+	return ret;
+}
+
+/* SSP interrupt handler */
+void RTOS_SSP_IRQHandler(RTOS_DRV_T *pDrv)
+{
+	LPC_SSP_T *pSSP = (LPC_SSP_T *) pDrv->pBase;
+	Chip_SSP_DATA_SETUP_T *xf_setup = (Chip_SSP_DATA_SETUP_T *) pDrv->pXfer;
+	Status ret;
+
+	if (xf_setup == NULL) {
+		pSSP->IMSC &= ~SSP_XFER_INTS;
+		return;
+	}
+
+	Chip_SSP_ClearIntPending(pSSP, SSP_RTIC);
+	if (Chip_SSP_GetDataSize(pSSP) > SSP_BITS_8) {
+		ret = Chip_SSP_Int_RWFrames16Bits(pSSP, xf_setup);
+	}
+	else {
+		ret = Chip_SSP_Int_RWFrames8Bits(pSSP, xf_setup);
+	}
+
+	if ((xf_setup->rx_cnt >= xf_setup->length) && (xf_setup->tx_cnt >= xf_setup->length)) {
+		pSSP->IMSC &= ~SSP_XFER_INTS;
+		drv_complete(pDrv, xf_setup->tx_cnt);
+	}
+	else if (ret == ERROR) {
+		/* receive overrun */
+		pSSP->IMSC &= ~SSP_XFER_INTS;
+		drv_complete(pDrv, ERROR);
+	}
+	else if (xf_setup->tx_cnt >= xf_setup->length) {
+		/* All frames queued, wake on received frames or the RX timeout
+		   only, so an empty TX FIFO does not keep interrupting */
+		pSSP->IMSC = (pSSP->IMSC & ~SSP_TXIM) | SSP_RXIM | SSP_RTIM;
+	}
+}
+
+/* UART send, sleeping until the last byte is in the FIFO */
+int RTOS_UART_SendBlocking(RTOS_DRV_T *pDrv, const void *data, int numBytes)
+{
+	LPC_USART_T *pUART = (LPC_USART_T *) pDrv->pBase;
+
+	if (numBytes <= 0) {
+		return 0;
+	}
+
+	drv_lock(pDrv);
+	pDrv->pTx = (const uint8_t *) data;
+	pDrv->txLeft = numBytes;
+	drv_start(pDrv, (void *) data);
+	/* THRE interrupts as soon as it is enabled on an empty FIFO */
+	Chip_UART_IntEnable(pUART, UART_IER_THREINT);
+	drv_finish(pDrv);
+	drv_unlock(pDrv);
+
+	return numBytes;
+}
+
+/* UART transmit interrupt handler */
+void RTOS_UART_IRQHandler(RTOS_DRV_T *pDrv)
+{
+	LPC_USART_T *pUART = (LPC_USART_T *) pDrv->pBase;
+	int n;
+
+	if ((pDrv->pXfer == NULL) || ((Chip_UART_ReadLineStatus(pUART) & UART_LSR_THRE) == 0)) {
+		return;
+	}
+
+	/* FIFO is empty on THRE, fill all of it */
+	for (n = 0; (n < UART_TX_FIFO_SIZE) && (pDrv->txLeft > 0); n++) {
+		Chip_UART_SendByte(pUART, *pDrv->pTx++);
+		pDrv->txLeft--;
+	}
+	if (pDrv->txLeft == 0) {
+		Chip_UART_IntDisable(pUART, UART_IER_THREINT);
+		drv_complete(pDrv, 0);
+	}
+}
+
+/* Make EEPROM erase/program waits sleep instead of spin */
+void RTOS_EEPROM_Init(void)
+{
+#if defined(OS_FREE_RTOS) || defined(OS_UCOS_III)
+	Chip_EEPROM_SetWaitFunc(drv_eeprom_wait);
+#endif
+}
@@ -0,0 +1,165 @@
+/*
+ * @brief RTOS aware blocking peripheral transfers for the FreeRTOS and uC/OS-III examples
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __RTOS_DRV_H_
+#define __RTOS_DRV_H_
+
+#include "board.h"
+
+#if defined(OS_FREE_RTOS)
+#include "FreeRTOS.h"
+#include "semphr.h"
+#elif defined(OS_UCOS_III)
+#include "os.h"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup EXAMPLES_RTOS_DRV RTOS aware blocking transfers
+ * @ingroup EXAMPLES_FREERTOS_18XX43XX
+ * Counterparts of Chip_I2CM_XferBlocking(), Chip_SSP_RWFrames_Blocking()
+ * and Chip_UART_SendBlocking() that sleep on a semaphore while the
+ * peripheral interrupt moves the data, instead of spinning on its status
+ * register, so other tasks run for the length of the transfer. Each
+ * peripheral gets one RTOS_DRV_T, which also holds a mutex so several
+ * tasks can share it.
+ *
+ * The transfer runs from the peripheral IRQ handler of the application,
+ * which calls the matching RTOS_xxx_IRQHandler(). Under uC/OS-III the IRQ
+ * handler must be wrapped in OSIntEnter()/OSIntExit() as usual. With
+ * neither OS_FREE_RTOS nor OS_UCOS_III defined the same calls wait with
+ * __WFI() for the interrupt.
+ *
+ * EEPROM erase/program cycles have no transfer to drive, the wait set by
+ * RTOS_EEPROM_Init() sleeps one tick at a time until the cycle is done.
+ * @{
+ */
+
+/**
+ * @brief Transfer state of one peripheral
+ */
+typedef struct {
+	void *pBase;					/*!< Peripheral registers */
+	IRQn_Type irq;					/*!< Peripheral interrupt */
+	void *volatile pXfer;			/*!< Transfer in progress, NULL when idle */
+	const uint8_t *pTx;				/*!< UART: next byte to send */
+	volatile int txLeft;			/*!< UART: bytes left to send */
+	volatile uint32_t result;		/*!< Set by the IRQ handler when done */
+#if defined(OS_FREE_RTOS)
+	xSemaphoreHandle done;
+	xSemaphoreHandle lock;
+#elif defined(OS_UCOS_III)
+	OS_SEM done;
+	OS_MUTEX lock;
+#endif
+} RTOS_DRV_T;
+
+/**
+ * @brief	Create the semaphore and the mutex of a peripheral
+ * @param	pDrv	: Transfer state to set up
+ * @param	pBase	: Peripheral registers (LPC_I2C0, LPC_SSP1, LPC_USART0, ...)
+ * @param	irq		: Peripheral interrupt, enabled by the first transfer
+ * @return	0 on success, 1 if the OS objects could not be created
+ * @note	Set the peripheral itself up with the chip driver as usual.
+ */
+int RTOS_Drv_Init(RTOS_DRV_T *pDrv, void *pBase, IRQn_Type irq);
+
+/**
+ * @brief	I2C master transfer, sleeping until it is done
+ * @param	pDrv	: Transfer state of the I2C peripheral
+ * @param	xfer	: Transfer, as for Chip_I2CM_XferBlocking()
+ * @return	Non-zero when the transfer completed, xfer->status has the result
+ */
+uint32_t RTOS_I2CM_XferBlocking(RTOS_DRV_T *pDrv, I2CM_XFER_T *xfer);
+
+/**
+ * @brief	I2C interrupt handler for RTOS_I2CM_XferBlocking()
+ * @param	pDrv	: Transfer state of the I2C peripheral
+ * @return	Nothing
+ */
+void RTOS_I2CM_IRQHandler(RTOS_DRV_T *pDrv);
+
+/**
+ * @brief	SSP read/write, sleeping until all frames are received
+ * @param	pDrv		: Transfer state of the SSP peripheral
+ * @param	xf_setup	: Transfer, as for Chip_SSP_RWFrames_Blocking(),
+ *						  tx_cnt and rx_cnt set to 0 by the caller
+ * @return	Frames transferred, ERROR on receive overrun
+ */
+uint32_t RTOS_SSP_RWFrames_Blocking(RTOS_DRV_T *pDrv, Chip_SSP_DATA_SETUP_T *xf_setup);
+
+/**
+ * @brief	SSP interrupt handler for RTOS_SSP_RWFrames_Blocking()
+ * @param	pDrv	: Transfer state of the SSP peripheral
+ * @return	Nothing
+ */
+void RTOS_SSP_IRQHandler(RTOS_DRV_T *pDrv);
+
+/**
+ * @brief	UART send, sleeping until the last byte is in the FIFO
+ * @param	pDrv		: Transfer state of the UART
+ * @param	data		: Bytes to send
+ * @param	numBytes	: Number of bytes
+ * @return	Number of bytes sent
+ */
+int RTOS_UART_SendBlocking(RTOS_DRV_T *pDrv, const void *data, int numBytes);
+
+/**
+ * @brief	UART transmit interrupt handler for RTOS_UART_SendBlocking()
+ * @param	pDrv	: Transfer state of the UART
+ * @return	Nothing
+ * @note	Only looks at THRE and leaves IIR alone, so it can be called
+ *			next to the receive handling of the application.
+ */
+void RTOS_UART_IRQHandler(RTOS_DRV_T *pDrv);
+
+/**
+ * @brief	Make EEPROM erase/program waits sleep instead of spin
+ * @return	Nothing
+ * @note	Installs a wait with Chip_EEPROM_SetWaitFunc(), does nothing
+ *			without an RTOS. EEPROM writes must then be made from tasks,
+ *			the wait uses the OS delay.
+ */
+void RTOS_EEPROM_Init(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTOS_DRV_H_ */
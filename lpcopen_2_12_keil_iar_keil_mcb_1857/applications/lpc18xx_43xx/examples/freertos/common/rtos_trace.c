@@ -0,0 +1,165 @@
+/*
+ * @brief Binary RTOS event trace for the FreeRTOS and uC/OS-III examples
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include "rtos_trace.h"
+#include <string.h>
+
+#ifdef RTOS_TRACE
+
+#if defined(CORE_M0)
+#error "RTOS trace needs the LDREX/STREX and DWT cycle counter of the Cortex-M3/M4"
+#endif
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* head counts claimed slots and tail drained ones, both free running. Only
+   the writers move head and only the reader moves tail and clears slots. */
+typedef struct {
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	volatile uint32_t dropped;
+	uint32_t dropSent;
+	volatile bool on;
+	RTOS_TRACE_REC_T ring[RTOS_TRACE_RING_SZ];
+} RTOS_TRACE_T;
+
+static RTOS_TRACE_T trace;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Count a record lost to a full ring */
+static void trace_drop(void)
+{
+	uint32_t d;
+
+	do {
+		d = __LDREXW((uint32_t *) &trace.dropped);
+	} while (__STREXW(d + 1, (uint32_t *) &trace.dropped));
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start the cycle counter and empty the ring */
+void RTOS_Trace_Init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	trace.on = false;
+	memset(trace.ring, 0, sizeof(trace.ring));
+	trace.head = trace.tail = 0;
+	trace.dropped = trace.dropSent = 0;
+	trace.on = true;
+}
+
+/* Claim a slot, fill it and publish it by writing the type last */
+HOTFUNC void RTOS_Trace_Put(uint8_t type, uint16_t id, uint8_t aux)
+{
+	RTOS_TRACE_REC_T *pRec;
+	uint32_t head;
+
+	if (!trace.on) {
+		return;
+	}
+
+	do {
+		head = __LDREXW((uint32_t *) &trace.head);
+		if ((head - trace.tail) >= RTOS_TRACE_RING_SZ) {
+			__CLREX();
+			trace_drop();
+			return;
+		}
+	} while (__STREXW(head + 1, (uint32_t *) &trace.head));
+
+	pRec = &trace.ring[head & (RTOS_TRACE_RING_SZ - 1)];
+	pRec->ts = DWT->CYCCNT;
+	pRec->aux = aux;
+	pRec->id = id;
+	__DMB();
+	*(volatile uint8_t *) &pRec->type = type;
+}
+
+/* Move up to one packet of records out of the ring */
+uint32_t RTOS_Trace_Read(uint8_t *pPkt)
+{
+	RTOS_TRACE_REC_T *pRec;
+	uint32_t tail = trace.tail, count = 0, dropped;
+
+	while ((count < RTOS_TRACE_PKT_RECS) && (tail != trace.head)) {
+		pRec = &trace.ring[tail & (RTOS_TRACE_RING_SZ - 1)];
+		if (*(volatile uint8_t *) &pRec->type == RTOS_TRACE_EV_NONE) {
+			break;
+		}
+		__DMB();
+		memcpy(&pPkt[8 + (count * 8)], pRec, 8);
+		*(volatile uint8_t *) &pRec->type = RTOS_TRACE_EV_NONE;
+		tail++;
+		count++;
+	}
+
+	/* Slots are cleared before they are handed back to the writers */
+	__DMB();
+	trace.tail = tail;
+
+	dropped = trace.dropped - trace.dropSent;
+	if ((count == 0) && (dropped == 0)) {
+		return 0;
+	}
+	trace.dropSent += dropped;
+	if (dropped > 0xFFFF) {
+		dropped = 0xFFFF;
+	}
+
+	pPkt[0] = (uint8_t) RTOS_TRACE_MAGIC;
+	pPkt[1] = (uint8_t) (RTOS_TRACE_MAGIC >> 8);
+	pPkt[2] = RTOS_TRACE_VERSION;
+	pPkt[3] = (uint8_t) count;
+	pPkt[4] = (uint8_t) dropped;
+	pPkt[5] = (uint8_t) (dropped >> 8);
+	pPkt[6] = (uint8_t) (SystemCoreClock / 1000000);
+	pPkt[7] = (uint8_t) ((SystemCoreClock / 1000000) >> 8);
+
+	return 8 + (count * 8);
+}
+
+#endif /* RTOS_TRACE */
@@ -0,0 +1,174 @@
+/*
+ * @brief Binary RTOS event trace for the FreeRTOS and uC/OS-III examples
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __RTOS_TRACE_H_
+#define __RTOS_TRACE_H_
+
+#include "board.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup EXAMPLES_RTOS_TRACE RTOS event trace
+ * @ingroup EXAMPLES_FREERTOS_18XX43XX
+ * Task switches, interrupts and queue operations are recorded as 8 byte
+ * records in a RAM ring, time stamped with the DWT cycle counter. Any
+ * context, including nested interrupts, can add a record: the slot is
+ * claimed with LDREX/STREX and nothing is masked. The ring is drained in
+ * 64 byte packets by RTOS_Trace_Read(), sized for one full speed HID
+ * report or bulk packet, so whichever USB channel the application has
+ * can stream it to the host.
+ *
+ * Enable with RTOS_TRACE defined for the whole project. FreeRTOSConfig.h
+ * then maps the kernel trace macros here; for uC/OS-III the kernel hooks
+ * are installed by UCOS_Trace_Init() (ucos_iii/common/ucos_trace.c).
+ * @{
+ */
+
+/** Records held in the ring, a power of 2 */
+#ifndef RTOS_TRACE_RING_SZ
+#define RTOS_TRACE_RING_SZ          256
+#endif
+
+/** Size of one packet returned by RTOS_Trace_Read() */
+#define RTOS_TRACE_PKT_BYTES        64
+
+/** Records in one full packet */
+#define RTOS_TRACE_PKT_RECS         ((RTOS_TRACE_PKT_BYTES - 8) / 8)
+
+/** First two bytes of every packet, "RT" */
+#define RTOS_TRACE_MAGIC            0x5452
+
+/** Format version in byte 2 of every packet */
+#define RTOS_TRACE_VERSION          1
+
+/**
+ * @brief Record types, the id and aux fields depend on the type
+ */
+typedef enum {
+	RTOS_TRACE_EV_NONE = 0,			/*!< Slot claimed but not written yet */
+	RTOS_TRACE_EV_TASK_IN,			/*!< Task switched in, id = task, aux = priority */
+	RTOS_TRACE_EV_TASK_CREATE,		/*!< Task created, id = task, aux = priority */
+	RTOS_TRACE_EV_ISR_ENTER,		/*!< Interrupt entry, id = exception number */
+	RTOS_TRACE_EV_ISR_EXIT,			/*!< Interrupt exit, id = exception number */
+	RTOS_TRACE_EV_QUEUE_SEND,		/*!< Queue send, id = queue, aux = items before */
+	RTOS_TRACE_EV_QUEUE_RECV,		/*!< Queue receive, id = queue, aux = items before */
+	RTOS_TRACE_EV_QUEUE_SEND_BLOCK,	/*!< Sender blocks on a full queue, id = queue */
+	RTOS_TRACE_EV_QUEUE_RECV_BLOCK,	/*!< Receiver blocks on an empty queue, id = queue */
+	RTOS_TRACE_EV_TICK,				/*!< Tick, id = tick count bits 15:0 */
+	RTOS_TRACE_EV_USER = 0x80		/*!< First application defined type */
+} RTOS_TRACE_EV_T;
+
+/**
+ * @brief One trace record, 8 bytes
+ */
+typedef struct {
+	uint32_t ts;		/*!< DWT cycle count when the record was made */
+	uint8_t type;		/*!< RTOS_TRACE_EV_T, written last */
+	uint8_t aux;		/*!< Type specific, see RTOS_TRACE_EV_T */
+	uint16_t id;		/*!< Task, queue or exception the record is about */
+} RTOS_TRACE_REC_T;
+
+/* Layout of a packet, all fields little endian:
+     byte 0..1  : RTOS_TRACE_MAGIC
+     byte 2     : RTOS_TRACE_VERSION
+     byte 3     : number of records that follow, 0 to RTOS_TRACE_PKT_RECS
+     byte 4..5  : records dropped on a full ring since the previous packet,
+                  saturating at 0xFFFF
+     byte 6..7  : core clock in MHz, to turn time stamps into time
+     byte 8..   : records, the fields of RTOS_TRACE_REC_T in order
+   Time stamps wrap every 2^32 core clocks; the host unwraps them from one
+   record to the next. Records are in the order their slots were claimed,
+   an interrupt between claiming and stamping can make the time stamps of
+   neighbouring records step back, so the host sorts by time stamp.
+   Task ids are the FreeRTOS task number, or bits 17:2 of the uC/OS-III
+   OS_TCB address; queue ids are the FreeRTOS queue number. */
+
+/**
+ * @brief	Start the cycle counter and empty the ring
+ * @return	Nothing
+ * @note	Call before the scheduler starts. Records made before this
+ *			are ignored.
+ */
+void RTOS_Trace_Init(void);
+
+/**
+ * @brief	Add one record to the ring
+ * @param	type	: Record type, a RTOS_TRACE_EV_T value
+ * @param	id		: Task, queue or exception the record is about
+ * @param	aux		: Type specific value
+ * @return	Nothing
+ * @note	Safe from any task or interrupt, a record that finds the
+ *			ring full is counted as dropped.
+ */
+void RTOS_Trace_Put(uint8_t type, uint16_t id, uint8_t aux);
+
+/**
+ * @brief	Move the oldest records into one packet
+ * @param	pPkt	: Buffer of RTOS_TRACE_PKT_BYTES bytes
+ * @return	Packet length in bytes, 0 when there was nothing to send
+ * @note	Single reader: call from one task only, at the pace the USB
+ *			channel takes packets. A record whose slot is claimed but
+ *			not written yet ends the packet, it goes with the next one.
+ */
+uint32_t RTOS_Trace_Read(uint8_t *pPkt);
+
+/**
+ * @brief	Start the trace and install the uC/OS-III hooks that feed it
+ * @return	Nothing
+ * @note	uC/OS-III only, call after OSInit(). Needs OS_CFG_APP_HOOKS_EN.
+ *			The kernel has no queue or interrupt hooks, interrupts are
+ *			recorded with RTOS_TRACE_ISR_ENTER()/RTOS_TRACE_ISR_EXIT().
+ */
+void UCOS_Trace_Init(void);
+
+#ifdef RTOS_TRACE
+/** Record the entry of the running interrupt, put first in an IRQ handler */
+#define RTOS_TRACE_ISR_ENTER()  RTOS_Trace_Put(RTOS_TRACE_EV_ISR_ENTER, (uint16_t) __get_IPSR(), 0)
+/** Record the exit of the running interrupt, put last in an IRQ handler */
+#define RTOS_TRACE_ISR_EXIT()   RTOS_Trace_Put(RTOS_TRACE_EV_ISR_EXIT, (uint16_t) __get_IPSR(), 0)
+#else
+#define RTOS_TRACE_ISR_ENTER()
+#define RTOS_TRACE_ISR_EXIT()
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTOS_TRACE_H_ */
@@ -89,6 +89,14 @@
 #define configUSE_MUTEXES			1
 #define configUSE_TICKLESS_IDLE		1
 
+/* Tickless idle, the RI timer wakes the core (freertos/common/freertos_tickless.c).
+Set TICKLESS_LOW_CLOCK to 1 to also run the core from the IRC during long sleeps. */
+#define TICKLESS_LOW_CLOCK			0
+#ifndef __IASMARM__
+extern void vApplicationSleep(uint32_t xExpectedIdleTime);
+#endif
+#define portSUPPRESS_TICKS_AND_SLEEP(xIdleTime)	vApplicationSleep(xIdleTime)
+
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
 
 #define configUSE_COUNTING_SEMAPHORES 	1
@@ -163,6 +171,31 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 #endif /* defined(CORE_M4) */
 #endif /* defined(CORE_M3) */
 
+/* RTOS event trace (freertos/common/rtos_trace.c), enabled with RTOS_TRACE
+defined for the project. Task switches and queue operations are recorded by
+the kernel, interrupts by RTOS_TRACE_ISR_ENTER()/RTOS_TRACE_ISR_EXIT() in the
+handlers. Define RTOS_TRACE_TICKS to also record every tick. */
+#if defined(RTOS_TRACE) && !defined(__IASMARM__)
+#include "rtos_trace.h"
+#define traceTASK_SWITCHED_IN()						RTOS_Trace_Put(RTOS_TRACE_EV_TASK_IN, \
+	(uint16_t) pxCurrentTCB->uxTCBNumber, (uint8_t) pxCurrentTCB->uxPriority)
+#define traceTASK_CREATE(pxNewTCB)					RTOS_Trace_Put(RTOS_TRACE_EV_TASK_CREATE, \
+	(uint16_t) (pxNewTCB)->uxTCBNumber, (uint8_t) (pxNewTCB)->uxPriority)
+#define traceQUEUE_SEND(pxQueue)					RTOS_Trace_Put(RTOS_TRACE_EV_QUEUE_SEND, \
+	(uint16_t) (pxQueue)->uxQueueNumber, (uint8_t) (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)			traceQUEUE_SEND(pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)					RTOS_Trace_Put(RTOS_TRACE_EV_QUEUE_RECV, \
+	(uint16_t) (pxQueue)->uxQueueNumber, (uint8_t) (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)		traceQUEUE_RECEIVE(pxQueue)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)		RTOS_Trace_Put(RTOS_TRACE_EV_QUEUE_SEND_BLOCK, \
+	(uint16_t) (pxQueue)->uxQueueNumber, 0)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)		RTOS_Trace_Put(RTOS_TRACE_EV_QUEUE_RECV_BLOCK, \
+	(uint16_t) (pxQueue)->uxQueueNumber, 0)
+#ifdef RTOS_TRACE_TICKS
+#define traceTASK_INCREMENT_TICK(xTickCount)		RTOS_Trace_Put(RTOS_TRACE_EV_TICK, (uint16_t) (xTickCount), 0)
+#endif
+#endif
+
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
 standard names - or at least those used in the unmodified vector table. */
 #define vPortSVCHandler SVC_Handler
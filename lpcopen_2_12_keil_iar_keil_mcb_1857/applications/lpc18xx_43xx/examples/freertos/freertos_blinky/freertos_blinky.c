@@ -32,11 +32,40 @@
 #include "board.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#ifdef RTOS_TRACE
+#include "rtos_trace.h"
+#endif
+#ifdef MEMDIAG
+#include "memdiag.h"
+#endif
+#ifdef RTOS_DRV
+#include <stdio.h>
+#include "rtos_drv.h"
+#endif
 
 /*****************************************************************************
  * Private types/enumerations/variables
  ****************************************************************************/
 
+#ifdef RTOS_TRACE
+/* One trace packet, as it would go out on a USB HID or bulk endpoint */
+static uint8_t tracePkt[RTOS_TRACE_PKT_BYTES];
+#endif
+
+#ifdef MEMDIAG
+/* Tasks whose stack use is reported */
+static TaskHandle_t taskHandles[3];
+#define TASK_HANDLE(n) (&taskHandles[(n)])
+#else
+#define TASK_HANDLE(n) ((TaskHandle_t *) NULL)
+#endif
+
+#ifdef RTOS_DRV
+/* Debug UART, the tick line is sent from its interrupt */
+static RTOS_DRV_T uartDrv;
+static char uartLine[32];
+#endif
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -53,8 +82,23 @@ static void prvSetupHardware(void)
 
 	/* Initial LED0 state is off */
 	Board_LED_Set(0, false);
+
+#ifdef RTOS_DRV
+	RTOS_Drv_Init(&uartDrv, DEBUG_UART, USART3_IRQn);
+	/* gives a semaphore, so no higher than the kernel allows */
+	NVIC_SetPriority(USART3_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+#endif
 }
 
+#ifdef MEMDIAG
+/* Stack high-water mark of a task, the kernel paints its stacks */
+static uint32_t taskStackUsed(void *ctx)
+{
+	return (configMINIMAL_STACK_SIZE - uxTaskGetStackHighWaterMark(*(TaskHandle_t *) ctx)) *
+		   sizeof(StackType_t);
+}
+#endif
+
 /* LED1 toggle thread */
 static void vLEDTask1(void *pvParameters) {
 	bool LedState = false;
@@ -86,9 +130,33 @@ static void vUARTTask(void *pvParameters) {
 	int tickCnt = 0;
 
 	while (1) {
+#ifdef RTOS_DRV
+		/* the task sleeps while the interrupt feeds the FIFO */
+		RTOS_UART_SendBlocking(&uartDrv, uartLine, sprintf(uartLine, "Tick: %d \r\n", tickCnt));
+#else
 		DEBUGOUT("Tick: %d \r\n", tickCnt);
+#endif
 		tickCnt++;
 
+#ifdef RTOS_TRACE
+		{
+			/* Stands in for the USB channel, only the totals are printed */
+			uint32_t recs = 0, dropped = 0;
+
+			while (RTOS_Trace_Read(tracePkt) != 0) {
+				recs += tracePkt[3];
+				dropped += tracePkt[4] | (tracePkt[5] << 8);
+			}
+			DEBUGOUT("Trace: %d records, %d dropped\r\n", recs, dropped);
+		}
+#endif
+#ifdef MEMDIAG
+		/* every 10s, the table takes a while on the UART */
+		if ((tickCnt % 10) == 0) {
+			MemDiag_Report(NULL);
+		}
+#endif
+
 		/* About a 1s delay here */
 		vTaskDelay(configTICK_RATE_HZ);
 	}
@@ -98,6 +166,18 @@ static void vUARTTask(void *pvParameters) {
  * Public functions
  ****************************************************************************/
 
+#ifdef RTOS_DRV
+/**
+ * @brief	UART3 interrupt handler, sends for RTOS_UART_SendBlocking()
+ * @return	Nothing
+ */
+void UART3_IRQHandler(void)
+{
+	RTOS_UART_IRQHandler(&uartDrv);
+}
+
+#endif
+
 /**
  * @brief	main routine for FreeRTOS blinky example
  * @return	Nothing, function should not exit
@@ -106,17 +186,34 @@ int main(void)
 {
 	prvSetupHardware();
 
+#ifdef RTOS_TRACE
+	RTOS_Trace_Init();
+#endif
+#ifdef MEMDIAG
+	/* paints the MSP, which runs main() and then the interrupts */
+	MemDiag_Init();
+#endif
+
 	/* LED1 toggle thread */
 	xTaskCreate(vLEDTask1, "vTaskLed1", configMINIMAL_STACK_SIZE,
-			NULL, (tskIDLE_PRIORITY + 1UL), (TaskHandle_t *) NULL);
+			NULL, (tskIDLE_PRIORITY + 1UL), TASK_HANDLE(0));
 
 	/* LED2 toggle thread */
 	xTaskCreate(vLEDTask2, "vTaskLed2", configMINIMAL_STACK_SIZE,
-			NULL, (tskIDLE_PRIORITY + 1UL), (TaskHandle_t *) NULL);
+			NULL, (tskIDLE_PRIORITY + 1UL), TASK_HANDLE(1));
 
 	/* UART output thread, simply counts seconds */
 	xTaskCreate(vUARTTask, "vTaskUart", configMINIMAL_STACK_SIZE,
-			NULL, (tskIDLE_PRIORITY + 1UL), (TaskHandle_t *) NULL);
+			NULL, (tskIDLE_PRIORITY + 1UL), TASK_HANDLE(2));
+
+#ifdef MEMDIAG
+	MemDiag_Add("vTaskLed1", MEMDIAG_STACK, NULL, configMINIMAL_STACK_SIZE * sizeof(StackType_t),
+				taskStackUsed, &taskHandles[0]);
+	MemDiag_Add("vTaskLed2", MEMDIAG_STACK, NULL, configMINIMAL_STACK_SIZE * sizeof(StackType_t),
+				taskStackUsed, &taskHandles[1]);
+	MemDiag_Add("vTaskUart", MEMDIAG_STACK, NULL, configMINIMAL_STACK_SIZE * sizeof(StackType_t),
+				taskStackUsed, &taskHandles[2]);
+#endif
 
 	/* Start the scheduler */
 	vTaskStartScheduler();
@@ -48,7 +48,7 @@
 #include "arch/lpc_arch.h"
 #include "arch/sys_arch.h"
 #include "lpc_phy.h" /* For the PHY monitor support */
-#include "tcpecho.h"
+#include "tcpecho_bench.h"
 
 /* When building the example to run in FLASH, the number of available
    pbufs and memory size (in lwipopts.h) and the number of descriptors
@@ -66,6 +66,11 @@ static struct netif lpc_netif;
  * Public types/enumerations/variables
  ****************************************************************************/
 
+#if LPC_LWIP_HEAP_DMAMEM
+/* lwIP heap in the AHB SRAM, see LPC_LWIP_HEAP_DMAMEM in lwipopts.h */
+DMAMEM unsigned char lpc_lwip_heap[MEM_SIZE + (2 * MEM_ALIGNMENT) + 64];
+#endif
+
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
@@ -133,7 +138,7 @@ static void vSetupIFTask(void *pvParameters) {
 #endif
 
 	/* Initialize and start application */
-	tcpecho_init();
+	tcpecho_bench_init();
 
 	/* This loop monitors the PHY link and will handle cable events
 	   via the PHY driver. */
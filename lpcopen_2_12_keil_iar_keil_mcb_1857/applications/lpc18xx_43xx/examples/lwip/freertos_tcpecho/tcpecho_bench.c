@@ -0,0 +1,303 @@
+/*
+ * @brief Multi-connection zero-copy TCP echo benchmark (netconn API)
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/api.h"
+#include "lwip/sys.h"
+#include "lwip/tcp.h"
+
+#include "board.h"
+#include "stopwatch.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "tcpecho_bench.h"
+
+#if LWIP_NETCONN
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Netbufs held per connection until their echo is acked */
+#define ECHO_HELD               8
+
+/* Time allowed for the last echo to be acked before the connection closes */
+#define ECHO_CLOSE_WAIT_MS      2000
+
+/* Stack of each connection task */
+#define ECHO_TASK_STACK         (configMINIMAL_STACK_SIZE * 2)
+
+/* Latency statistics, in uS */
+typedef struct {
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t cnt;
+} ECHO_LAT_T;
+
+/* Echo connection state, only used by its own task */
+typedef struct {
+	struct netconn *conn;
+	struct netbuf *held[ECHO_HELD];	/* FIFO of echoed netbufs */
+	uint64_t heldEnd[ECHO_HELD];	/* queued after each netbuf */
+	uint32_t heldTicks[ECHO_HELD];	/* Stopwatch time of reception */
+	uint8_t heldHead;
+	uint8_t heldCnt;
+	uint8_t num;
+	uint32_t startMs;
+	uint32_t repMs;
+	uint64_t queued;				/* Bytes passed to netconn_write */
+	uint64_t acked;
+	uint64_t repBytes;
+	ECHO_LAT_T lat;					/* Whole connection */
+	ECHO_LAT_T repLat;				/* Current report interval */
+} ECHO_CONN_T;
+
+static ECHO_CONN_T echoConns[ECHO_BENCH_MAX_CONN];
+static uint8_t echoNum;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static uint32_t echoMs(void)
+{
+	return (uint32_t) ((xTaskGetTickCount() * 1000ULL) / configTICK_RATE_HZ);
+}
+
+static void echoLatAdd(ECHO_LAT_T *lat, uint32_t us)
+{
+	if ((lat->cnt == 0) || (us < lat->min)) {
+		lat->min = us;
+	}
+	if (us > lat->max) {
+		lat->max = us;
+	}
+	lat->sum += us;
+	lat->cnt++;
+}
+
+/* Prints the throughput and latency of one connection */
+static void echoReport(ECHO_CONN_T *c, uint32_t fromMs, uint32_t toMs, uint64_t bytes,
+					   ECHO_LAT_T *lat, bool final)
+{
+	uint32_t ms = toMs - fromMs;
+
+	DEBUGOUT("[%u] %s %lu.%03lu s %lu KBytes %lu Kbits/sec",
+			 c->num, final ? "total" : "     ",
+			 (unsigned long) (ms / 1000), (unsigned long) (ms % 1000),
+			 (unsigned long) (bytes / 1024),
+			 (unsigned long) ((ms != 0) ? (bytes * 8) / ms : 0));
+	if (lat->cnt != 0) {
+		DEBUGOUT(" latency %lu/%lu/%lu uS", (unsigned long) lat->min,
+				 (unsigned long) (lat->sum / lat->cnt), (unsigned long) lat->max);
+	}
+	DEBUGOUT("\r\n");
+}
+
+/* Frees the netbufs whose echo the peer has acknowledged. The TCP send
+   buffer space is read from the TCPIP thread's pcb without a lock: it only
+   grows when data is acked, so a stale value never frees data early. */
+static void echoRelease(ECHO_CONN_T *c)
+{
+	struct tcp_pcb *pcb = c->conn->pcb.tcp;
+	uint32_t unacked = 0;
+	uint32_t tps, now;
+
+	if (pcb != NULL) {
+		unacked = TCP_SND_BUF - tcp_sndbuf(pcb);
+	}
+	c->acked = c->queued - unacked;
+
+	tps = StopWatch_TicksPerSecond();
+	now = StopWatch_Start();
+	while ((c->heldCnt != 0) && (c->heldEnd[c->heldHead] <= c->acked)) {
+		uint32_t us = (uint32_t) (((uint64_t) (now - c->heldTicks[c->heldHead]) * 1000000) / tps);
+
+		echoLatAdd(&c->lat, us);
+		echoLatAdd(&c->repLat, us);
+		netbuf_delete(c->held[c->heldHead]);
+		c->heldHead = (c->heldHead + 1) % ECHO_HELD;
+		c->heldCnt--;
+	}
+}
+
+/* Prints the interval report when it is due */
+static void echoIntervalCheck(ECHO_CONN_T *c)
+{
+	uint32_t now = echoMs();
+
+	if ((now - c->repMs) >= ECHO_BENCH_REPORT_MS) {
+		echoReport(c, c->repMs, now, c->acked - c->repBytes, &c->repLat, false);
+		c->repMs = now;
+		c->repBytes = c->acked;
+		memset(&c->repLat, 0, sizeof(c->repLat));
+	}
+}
+
+/* Echoes one connection */
+static void echoConnTask(void *pvParameters)
+{
+	ECHO_CONN_T *c = (ECHO_CONN_T *) pvParameters;
+	struct netbuf *buf;
+	void *data;
+	u16_t len;
+	err_t err;
+	int i;
+
+	while (1) {
+		/* Poll for acks while echoed data is held, else sleep until the
+		   next packet or report */
+		netconn_set_recvtimeout(c->conn, (c->heldCnt != 0) ? 1 : ECHO_BENCH_REPORT_MS);
+		err = netconn_recv(c->conn, &buf);
+		echoRelease(c);
+		if (err == ERR_TIMEOUT) {
+			echoIntervalCheck(c);
+			continue;
+		}
+		if (err != ERR_OK) {
+			break;
+		}
+
+		/* Wait for a free slot, the window stays closed meanwhile */
+		while (c->heldCnt == ECHO_HELD) {
+			vTaskDelay(1);
+			echoRelease(c);
+		}
+		i = (c->heldHead + c->heldCnt) % ECHO_HELD;
+		c->held[i] = buf;
+		c->heldTicks[i] = StopWatch_Start();
+		c->heldCnt++;
+
+		/* Echo each pbuf in place */
+		do {
+			netbuf_data(buf, &data, &len);
+			err = netconn_write(c->conn, data, len, NETCONN_NOCOPY);
+			if (err != ERR_OK) {
+				break;
+			}
+			c->queued += len;
+		} while (netbuf_next(buf) >= 0);
+		c->heldEnd[i] = c->queued;
+		if (err != ERR_OK) {
+			break;
+		}
+
+		echoIntervalCheck(c);
+	}
+
+	/* The stack references the held data until it is acked, a peer that
+	   stops acking for ECHO_CLOSE_WAIT_MS is treated as gone */
+	for (i = 0; (c->heldCnt != 0) && (i < (ECHO_CLOSE_WAIT_MS * configTICK_RATE_HZ) / 1000); i++) {
+		vTaskDelay(1);
+		echoRelease(c);
+	}
+	echoReport(c, c->startMs, echoMs(), c->acked, &c->lat, true);
+	netconn_close(c->conn);
+	netconn_delete(c->conn);
+	while (c->heldCnt != 0) {
+		netbuf_delete(c->held[c->heldHead]);
+		c->heldHead = (c->heldHead + 1) % ECHO_HELD;
+		c->heldCnt--;
+	}
+
+	/* Slot can be reused */
+	c->conn = NULL;
+	vTaskDelete(NULL);
+}
+
+/* Accepts connections and starts a task for each */
+static void echoListenTask(void *pvParameters)
+{
+	struct netconn *conn, *newconn;
+	ECHO_CONN_T *c;
+	int i;
+
+	conn = netconn_new(NETCONN_TCP);
+	if ((conn == NULL) || (netconn_bind(conn, NULL, ECHO_BENCH_PORT) != ERR_OK)) {
+		DEBUGOUT("Echo benchmark: can't bind port %d\r\n", ECHO_BENCH_PORT);
+		vTaskDelete(NULL);
+	}
+	netconn_listen(conn);
+
+	while (1) {
+		if (netconn_accept(conn, &newconn) != ERR_OK) {
+			continue;
+		}
+
+		c = NULL;
+		for (i = 0; i < ECHO_BENCH_MAX_CONN; i++) {
+			if (echoConns[i].conn == NULL) {
+				c = &echoConns[i];
+				break;
+			}
+		}
+		if (c == NULL) {
+			netconn_close(newconn);
+			netconn_delete(newconn);
+			continue;
+		}
+
+		memset(c, 0, sizeof(*c));
+		c->conn = newconn;
+		c->num = ++echoNum;
+		c->startMs = c->repMs = echoMs();
+		DEBUGOUT("[%u] connected\r\n", c->num);
+		if (xTaskCreate(echoConnTask, (signed char *) "EchoConn", ECHO_TASK_STACK, c,
+						(tskIDLE_PRIORITY + 1UL), (xTaskHandle *) NULL) != pdPASS) {
+			c->conn = NULL;
+			netconn_close(newconn);
+			netconn_delete(newconn);
+		}
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Starts the echo benchmark server task */
+void tcpecho_bench_init(void)
+{
+	StopWatch_Init();
+
+	xTaskCreate(echoListenTask, (signed char *) "EchoBench",
+				configMINIMAL_STACK_SIZE * 2, NULL, (tskIDLE_PRIORITY + 1UL),
+				(xTaskHandle *) NULL);
+}
+
+#endif /* LWIP_NETCONN */
@@ -0,0 +1,365 @@
+/*
+ * @brief Multi-connection zero-copy TCP echo benchmark (raw API)
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+#include "lwip/tcp.h"
+#include "lwip/timers.h"
+
+#include "board.h"
+#include "stopwatch.h"
+#include "echo_bench.h"
+
+#if LWIP_TCP
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Receive time marks kept per connection for the latency figures */
+#define ECHO_MARKS              8
+
+/* Latency statistics, in uS */
+typedef struct {
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t cnt;
+} ECHO_LAT_T;
+
+/* Echo connection state */
+typedef struct {
+	struct tcp_pcb *pcb;
+	struct pbuf *unsent;	/* Received chain not yet queued for the echo */
+	struct pbuf *ackHead;	/* Queued by reference, freed once acked */
+	struct pbuf *ackTail;
+	uint16_t ackOff;		/* Acked bytes of ackHead */
+	uint8_t num;
+	uint8_t closing;
+	uint32_t startMs;
+	uint32_t repMs;
+	uint64_t rxBytes;
+	uint64_t ackBytes;
+	uint64_t repBytes;
+	struct {
+		uint64_t end;		/* rxBytes after the segment */
+		uint32_t ticks;		/* Stopwatch time of arrival */
+	} marks[ECHO_MARKS];
+	uint8_t markHead;
+	uint8_t markCnt;
+	ECHO_LAT_T lat;			/* Whole connection */
+	ECHO_LAT_T repLat;		/* Current report interval */
+} ECHO_CONN_T;
+
+static ECHO_CONN_T echoConns[ECHO_BENCH_MAX_CONN];
+static uint8_t echoNum;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void echoLatAdd(ECHO_LAT_T *lat, uint32_t us)
+{
+	if ((lat->cnt == 0) || (us < lat->min)) {
+		lat->min = us;
+	}
+	if (us > lat->max) {
+		lat->max = us;
+	}
+	lat->sum += us;
+	lat->cnt++;
+}
+
+/* Prints the throughput and latency of one connection */
+static void echoReport(ECHO_CONN_T *c, uint32_t fromMs, uint32_t toMs, uint64_t bytes,
+					   ECHO_LAT_T *lat, bool final)
+{
+	uint32_t ms = toMs - fromMs;
+
+	DEBUGOUT("[%u] %s %lu.%03lu s %lu KBytes %lu Kbits/sec",
+			 c->num, final ? "total" : "     ",
+			 (unsigned long) (ms / 1000), (unsigned long) (ms % 1000),
+			 (unsigned long) (bytes / 1024),
+			 (unsigned long) ((ms != 0) ? (bytes * 8) / ms : 0));
+	if (lat->cnt != 0) {
+		DEBUGOUT(" latency %lu/%lu/%lu uS", (unsigned long) lat->min,
+				 (unsigned long) (lat->sum / lat->cnt), (unsigned long) lat->max);
+	}
+	DEBUGOUT("\r\n");
+}
+
+/* Queues the received pbufs for the echo without copying them */
+static void echoSend(ECHO_CONN_T *c)
+{
+	struct tcp_pcb *pcb = c->pcb;
+
+	while (c->unsent != NULL) {
+		struct pbuf *q = c->unsent;
+
+		if ((q->len > tcp_sndbuf(pcb)) || (tcp_sndqueuelen(pcb) >= TCP_SND_QUEUELEN)) {
+			break;
+		}
+		if ((q->len != 0) && (tcp_write(pcb, q->payload, q->len, 0) != ERR_OK)) {
+			/* Out of segments, retried from sent or poll */
+			break;
+		}
+
+		/* Unlink q, the chain below keeps its own reference count */
+		c->unsent = q->next;
+		q->next = NULL;
+		q->tot_len = q->len;
+		if (c->ackHead == NULL) {
+			c->ackHead = q;
+		}
+		else {
+			c->ackTail->next = q;
+		}
+		c->ackTail = q;
+	}
+	tcp_output(pcb);
+}
+
+/* Frees all pbufs of a connection */
+static void echoFreeAll(ECHO_CONN_T *c)
+{
+	while (c->ackHead != NULL) {
+		struct pbuf *q = c->ackHead;
+
+		c->ackHead = q->next;
+		q->next = NULL;
+		pbuf_free(q);
+	}
+	if (c->unsent != NULL) {
+		pbuf_free(c->unsent);
+		c->unsent = NULL;
+	}
+}
+
+/* Reports and releases a connection */
+static void echoEnd(ECHO_CONN_T *c)
+{
+	echoReport(c, c->startMs, sys_now(), c->ackBytes, &c->lat, true);
+	echoFreeAll(c);
+	c->pcb = NULL;
+}
+
+static void echoClose(ECHO_CONN_T *c)
+{
+	struct tcp_pcb *pcb = c->pcb;
+
+	tcp_arg(pcb, NULL);
+	tcp_recv(pcb, NULL);
+	tcp_sent(pcb, NULL);
+	tcp_err(pcb, NULL);
+	tcp_poll(pcb, NULL, 0);
+	echoEnd(c);
+	if (tcp_close(pcb) != ERR_OK) {
+		tcp_abort(pcb);
+	}
+}
+
+static err_t echoRecv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+	ECHO_CONN_T *c = (ECHO_CONN_T *) arg;
+
+	if (p == NULL) {
+		/* Remote side closed, finish echoing what is left first */
+		c->closing = 1;
+		if ((c->unsent == NULL) && (c->ackHead == NULL)) {
+			echoClose(c);
+		}
+		return ERR_OK;
+	}
+	if (err != ERR_OK) {
+		pbuf_free(p);
+		return err;
+	}
+
+	c->rxBytes += p->tot_len;
+	if (c->markCnt < ECHO_MARKS) {
+		uint8_t i = (c->markHead + c->markCnt) % ECHO_MARKS;
+		c->marks[i].end = c->rxBytes;
+		c->marks[i].ticks = StopWatch_Start();
+		c->markCnt++;
+	}
+
+	if (c->unsent == NULL) {
+		c->unsent = p;
+	}
+	else {
+		pbuf_cat(c->unsent, p);
+	}
+	echoSend(c);
+	return ERR_OK;
+}
+
+static err_t echoSent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+	ECHO_CONN_T *c = (ECHO_CONN_T *) arg;
+	uint32_t tps = StopWatch_TicksPerSecond();
+	uint32_t now = StopWatch_Start();
+
+	c->ackBytes += len;
+
+	/* Release the acked pbufs and give their space back to the window */
+	while ((c->ackHead != NULL) && (len != 0 || c->ackHead->len == 0)) {
+		struct pbuf *q = c->ackHead;
+		uint16_t left = q->len - c->ackOff;
+
+		if (len < left) {
+			c->ackOff += len;
+			break;
+		}
+		len -= left;
+		c->ackOff = 0;
+		c->ackHead = q->next;
+		q->next = NULL;
+		tcp_recved(pcb, q->len);
+		pbuf_free(q);
+	}
+
+	/* Segments whose echo is completely acked */
+	while ((c->markCnt != 0) && (c->marks[c->markHead].end <= c->ackBytes)) {
+		uint32_t us = (uint32_t) (((uint64_t) (now - c->marks[c->markHead].ticks) * 1000000) / tps);
+
+		echoLatAdd(&c->lat, us);
+		echoLatAdd(&c->repLat, us);
+		c->markHead = (c->markHead + 1) % ECHO_MARKS;
+		c->markCnt--;
+	}
+
+	echoSend(c);
+	if (c->closing && (c->unsent == NULL) && (c->ackHead == NULL)) {
+		echoClose(c);
+	}
+	return ERR_OK;
+}
+
+static err_t echoPoll(void *arg, struct tcp_pcb *pcb)
+{
+	ECHO_CONN_T *c = (ECHO_CONN_T *) arg;
+
+	if (c->unsent != NULL) {
+		echoSend(c);
+	}
+	return ERR_OK;
+}
+
+static void echoError(void *arg, err_t err)
+{
+	ECHO_CONN_T *c = (ECHO_CONN_T *) arg;
+
+	/* The pcb is already freed */
+	DEBUGOUT("[%u] error %d\r\n", c->num, err);
+	echoEnd(c);
+}
+
+static err_t echoAccept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+	ECHO_CONN_T *c = NULL;
+	int i;
+
+	for (i = 0; i < ECHO_BENCH_MAX_CONN; i++) {
+		if (echoConns[i].pcb == NULL) {
+			c = &echoConns[i];
+			break;
+		}
+	}
+	if (c == NULL) {
+		/* The stack aborts the connection */
+		return ERR_MEM;
+	}
+
+	memset(c, 0, sizeof(*c));
+	c->pcb = pcb;
+	c->num = ++echoNum;
+	c->startMs = c->repMs = sys_now();
+	DEBUGOUT("[%u] connected, port %u\r\n", c->num, pcb->remote_port);
+
+	tcp_arg(pcb, c);
+	tcp_recv(pcb, echoRecv);
+	tcp_sent(pcb, echoSent);
+	tcp_err(pcb, echoError);
+	tcp_poll(pcb, echoPoll, 2);
+	return ERR_OK;
+}
+
+/* Periodic per-connection report */
+static void echoReportTimer(void *arg)
+{
+	uint32_t now = sys_now();
+	int i;
+
+	for (i = 0; i < ECHO_BENCH_MAX_CONN; i++) {
+		ECHO_CONN_T *c = &echoConns[i];
+
+		if (c->pcb != NULL) {
+			echoReport(c, c->repMs, now, c->ackBytes - c->repBytes, &c->repLat, false);
+			c->repMs = now;
+			c->repBytes = c->ackBytes;
+			memset(&c->repLat, 0, sizeof(c->repLat));
+		}
+	}
+	sys_timeout(ECHO_BENCH_REPORT_MS, echoReportTimer, NULL);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Starts the echo benchmark server */
+void echo_bench_init(void)
+{
+	struct tcp_pcb *pcb;
+
+	StopWatch_Init();
+
+	pcb = tcp_new();
+	if (pcb == NULL) {
+		return;
+	}
+	if (tcp_bind(pcb, IP_ADDR_ANY, ECHO_BENCH_PORT) != ERR_OK) {
+		tcp_close(pcb);
+		return;
+	}
+	pcb = tcp_listen(pcb);
+	tcp_accept(pcb, echoAccept);
+
+	sys_timeout(ECHO_BENCH_REPORT_MS, echoReportTimer, NULL);
+}
+
+#endif /* LWIP_TCP */
@@ -0,0 +1,62 @@
+/*
+ * @brief Multi-connection zero-copy TCP echo benchmark (raw API)
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __ECHO_BENCH_H_
+#define __ECHO_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* TCP port of the echo service */
+#define ECHO_BENCH_PORT         7
+
+/* Connections echoed at the same time, more are refused */
+#define ECHO_BENCH_MAX_CONN     4
+
+/* Interval between the per-connection UART reports */
+#define ECHO_BENCH_REPORT_MS    5000
+
+/**
+ * @brief	Starts the echo benchmark server on ECHO_BENCH_PORT
+ * @return	Nothing
+ * @note	Received pbufs are echoed by reference and only released, and
+ * the receive window reopened, once the peer has acknowledged the echo.
+ * Each connection reports its echo throughput and its latency from
+ * segment arrival to acknowledge of the echoed data on the debug UART.
+ */
+void echo_bench_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ECHO_BENCH_H_ */
@@ -47,7 +47,7 @@
 #include "lpc_phy.h"
 #include "arch/lpc18xx_43xx_emac.h"
 #include "arch/lpc_arch.h"
-#include "echo.h"
+#include "echo_bench.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -60,6 +60,11 @@ static struct netif lpc_netif;
  * Public types/enumerations/variables
  ****************************************************************************/
 
+#if LPC_LWIP_HEAP_DMAMEM
+/* lwIP heap in the AHB SRAM, see LPC_LWIP_HEAP_DMAMEM in lwipopts.h */
+DMAMEM unsigned char lpc_lwip_heap[MEM_SIZE + (2 * MEM_ALIGNMENT) + 64];
+#endif
+
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
@@ -121,7 +126,7 @@ int main(void)
 #endif
 
 	/* Initialize and start application */
-	echo_init();
+	echo_bench_init();
 
 	/* This could be done in the sysTick ISR, but may stay in IRQ context
 	   too long, so do this stuff with a background loop. */
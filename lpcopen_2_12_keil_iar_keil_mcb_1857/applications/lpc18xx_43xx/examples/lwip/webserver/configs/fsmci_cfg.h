@@ -41,6 +41,7 @@
 #include "ffconf.h"
 #include "diskio.h"
 #include "board.h"
+#include "sd_cache.h"
 
 typedef mci_card_struct CARD_HANDLE_T;
 
@@ -48,9 +49,10 @@ typedef mci_card_struct CARD_HANDLE_T;
  * @def		FSMCI_CardAcquire(hc)
  * @brief	Card acquire adapter function
  * LPC43xx/18xx implementation of the FSMCI adapter function, that
- * will successfully acquire/initialize the SD Card.
+ * will successfully acquire/initialize the SD Card. The sector cache
+ * is emptied for the new card.
  */
-#define FSMCI_CardAcquire(hc)          Chip_SDMMC_Acquire(LPC_SDMMC, hc)
+#define FSMCI_CardAcquire(hc)          (sd_cache_init(), Chip_SDMMC_Acquire(LPC_SDMMC, hc))
 
 /**
  * @def		FSMCI_CardInit()
@@ -103,17 +105,17 @@ typedef mci_card_struct CARD_HANDLE_T;
 
 /**
  * @def		FSMCI_CardReadSectors(hc, buf, startSector, numSector)
- * @brief	Read data from sectors
+ * @brief	Read data from sectors, through the sector cache
  */
 #define FSMCI_CardReadSectors(hc, buf, startSector, numSector) \
-        Chip_SDMMC_ReadBlocks(LPC_SDMMC, buf, startSector, numSector)
+        sd_cache_read(buf, startSector, numSector)
 
 /**
  * @def		FSMCI_CardWriteSectors(hc, buf, startSector, numSector)
- * @brief	Write data to sectors
+ * @brief	Write data to sectors, through the sector cache
  */
 #define FSMCI_CardWriteSectors(hc, buf, startSector, numSector) \
-        Chip_SDMMC_WriteBlocks(LPC_SDMMC, buf, startSector, numSector)
+        sd_cache_write(buf, startSector, numSector)
 
 /**
  * @def		FSMCI_InitRealTimeClock()
@@ -132,11 +134,18 @@ extern void rtc_initialize(void);   /**< RTC initialization function */
  * @param	hCrd	: Pointer to Card Handle
  * @param	tout	: Time to wait, in milliseconds
  * @return	0 when operation failed 1 when successfully completed
+ * @note	Dirty sectors of a write-back cache are written to the card first.
  */
 STATIC INLINE int FSMCI_CardReadyWait(CARD_HANDLE_T *hCrd, int tout)
 {
-	int32_t curr = (int32_t) Chip_RIT_GetCounter(LPC_RITIMER);
-	int32_t final = curr + ((SystemCoreClock / 1000) * tout);
+	int32_t curr, final;
+
+	if (sd_cache_flush() != 0) {
+		return 0;
+	}
+
+	curr = (int32_t) Chip_RIT_GetCounter(LPC_RITIMER);
+	final = curr + ((SystemCoreClock / 1000) * tout);
 
 	if ((final < 0) && (curr > 0)) {
 		while (Chip_RIT_GetCounter(LPC_RITIMER) < (uint32_t) final) { if (Chip_SDMMC_GetState(LPC_SDMMC) != -1) break; }
@@ -44,12 +44,32 @@
 
 #define LWIP_HTTPD_DYNAMIC_HEADERS      1
 
+/* Keep connections open between requests, see httpd.c */
+#define LWIP_HTTPD_SUPPORT_11_KEEPALIVE 1
+
+/* Serve the files of a memory mapped image in flash bank B in place, see
+   lwip_fs.h. Names not in the image still come from the SD card. */
+#define LWIP_FS_MAPPED                  1
+
+/* Send "name.gz", when there is one, to browsers that take gzip, see
+   lwip_fs.h */
+#define LWIP_FS_GZIP                    1
+
 /* Need for memory protection */
 #define SYS_LIGHTWEIGHT_PROT            0
 
 /* 32-bit alignment */
 #define MEM_ALIGNMENT                   4
 
+/* Set LPC_LWIP_HEAP_DMAMEM to 1 to run lwIP from its own heap, placed with
+   DMAMEM (lpc_types.h) in the AHB SRAM, instead of the C library heap next
+   to the CPU's data. With MEMP_MEM_MALLOC the pools, and so the pbufs the
+   EMAC DMA receives into and sends from, come from that heap too, which
+   MEM_SIZE then has to cover. The example defines lpc_lwip_heap. */
+#ifndef LPC_LWIP_HEAP_DMAMEM
+#define LPC_LWIP_HEAP_DMAMEM            0
+#endif
+
 /* pbuf buffers in pool. In zero-copy mode, these buffers are
    located in peripheral RAM. In copied mode, they are located in
    internal IRAM */
@@ -61,15 +81,20 @@
 #define IP_SOF_BROADCAST                1
 #define IP_SOF_BROADCAST_RECV           1
 
-/* The ethernet FCS is performed in hardware. The IP, TCP, and UDP
-   CRCs still need to be done in hardware. */
-#define CHECKSUM_GEN_IP                 1
-#define CHECKSUM_GEN_UDP                1
-#define CHECKSUM_GEN_TCP                1
-#define CHECKSUM_CHECK_IP               1
-#define CHECKSUM_CHECK_UDP              1
-#define CHECKSUM_CHECK_TCP              1
-#define LWIP_CHECKSUM_ON_COPY           1
+/* The ethernet FCS is performed in hardware. Set LPC_CHECKSUM_OFFLOAD
+   to 1 when the EMAC driver enables Chip_ENET_Ring_SetChecksumOffload()
+   to also move the IP, TCP, and UDP checksums into the MAC, otherwise
+   they are done in software. */
+#ifndef LPC_CHECKSUM_OFFLOAD
+#define LPC_CHECKSUM_OFFLOAD            0
+#endif
+#define CHECKSUM_GEN_IP                 (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_GEN_UDP                (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_GEN_TCP                (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_CHECK_IP               (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_CHECK_UDP              (!LPC_CHECKSUM_OFFLOAD)
+#define CHECKSUM_CHECK_TCP              (!LPC_CHECKSUM_OFFLOAD)
+#define LWIP_CHECKSUM_ON_COPY           (!LPC_CHECKSUM_OFFLOAD)
 
 /* Use LWIP version of htonx() to allow generic functionality across
    all platforms. If you are using the Cortex Mx devices, you might
@@ -77,7 +102,11 @@
 #define LWIP_PLATFORM_BYTESWAP          0
 
 /* Non-static memory, used with DMA pool */
+#if LPC_LWIP_HEAP_DMAMEM
+#define MEM_SIZE                        ((12 * 1024) + (PBUF_POOL_SIZE * 1600))
+#else
 #define MEM_SIZE                        (12 * 1024)
+#endif
 
 /* Raw interface not needed */
 #define LWIP_RAW                        1
@@ -118,7 +147,13 @@
    get debug messages for the driver. */
 #define EMAC_DEBUG                    LWIP_DBG_OFF
 
+#if LPC_LWIP_HEAP_DMAMEM
+#define MEM_LIBC_MALLOC                 0
+#define LWIP_RAM_HEAP_POINTER           lpc_lwip_heap
+extern unsigned char lpc_lwip_heap[];
+#else
 #define MEM_LIBC_MALLOC                 1
+#endif
 #define MEMP_MEM_MALLOC                 1
 
 /* Needed for malloc/free */
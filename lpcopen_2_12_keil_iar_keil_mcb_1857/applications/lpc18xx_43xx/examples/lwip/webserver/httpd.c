@@ -91,6 +91,7 @@
 #if (defined(BOARD_HITEX_EVA_1850) || defined(BOARD_HITEX_EVA_4350))
 #define fs_open(nam) NULL
 #define fs_read(fp,buff,sz) 0
+#define fs_prefetch(fp,sz)
 #endif
 
 #if LWIP_TCP
@@ -162,6 +163,31 @@
 #define LWIP_HTTPD_SUPPORT_REQUESTLIST      0
 #endif
 
+/** Set this to 1 to keep connections open between requests (HTTP/1.1, or
+ * "Connection: keep-alive"). Responses are framed by Content-Length and
+ * requests that arrive while a response is sent are served in order after
+ * it. Needs LWIP_HTTPD_DYNAMIC_HEADERS and a request in a single pbuf. */
+#ifndef LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+#define LWIP_HTTPD_SUPPORT_11_KEEPALIVE     0
+#endif
+
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+/** Idle time before a persistent connection is closed, in polls of
+ * HTTPD_POLL_INTERVAL (5 * 2s by default) */
+#ifndef HTTPD_KEEPALIVE_IDLE_POLLS
+#define HTTPD_KEEPALIVE_IDLE_POLLS          5
+#endif
+
+/** Number of requests served on one connection, the last one closes it */
+#ifndef HTTPD_KEEPALIVE_MAX_REQUESTS
+#define HTTPD_KEEPALIVE_MAX_REQUESTS        100
+#endif
+
+#if !LWIP_HTTPD_DYNAMIC_HEADERS || LWIP_HTTPD_SUPPORT_REQUESTLIST
+#error "LWIP_HTTPD_SUPPORT_11_KEEPALIVE needs LWIP_HTTPD_DYNAMIC_HEADERS and no LWIP_HTTPD_SUPPORT_REQUESTLIST"
+#endif
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+
 #if LWIP_HTTPD_SUPPORT_REQUESTLIST
 /** Number of rx pbufs to enqueue to parse an incoming request (up to the first
     newline) */
@@ -196,6 +222,35 @@
 #define LWIP_HTTPD_SSI_INCLUDE_TAG           1
 #endif
 
+/** Set this to 1 to remember where the SSI tags of a file are. The first
+ * request for a file parses it as usual and notes the tag offsets, later
+ * requests skip from one tag to the next. The text in between is then sent
+ * in large writes (in place from the memory mapped image) and only the tags
+ * are parsed. A file is known by name and length, another length drops the
+ * offsets. Needs LWIP_HTTPD_SSI. */
+#ifndef LWIP_HTTPD_SSI_TAG_CACHE
+#define LWIP_HTTPD_SSI_TAG_CACHE             0
+#endif
+
+#if LWIP_HTTPD_SSI_TAG_CACHE
+/** Number of SSI files with remembered tag offsets */
+#ifndef LWIP_HTTPD_SSI_TAG_CACHE_FILES
+#define LWIP_HTTPD_SSI_TAG_CACHE_FILES       4
+#endif
+
+/** Most tags remembered for a file, a file with more is always parsed */
+#ifndef LWIP_HTTPD_SSI_TAG_CACHE_TAGS
+#define LWIP_HTTPD_SSI_TAG_CACHE_TAGS        32
+#endif
+
+/** Longest file name (with the NUL) of the tag cache */
+#define LWIP_HTTPD_SSI_TAG_CACHE_NAME        32
+
+#if !LWIP_HTTPD_SSI
+#error "LWIP_HTTPD_SSI_TAG_CACHE needs LWIP_HTTPD_SSI"
+#endif
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
+
 /** Set this to 1 to call tcp_abort when tcp_close fails with memory error.
  * This can be used to prevent consuming all memory in situations where the
  * HTTP server has low priority compared to other communication. */
@@ -222,8 +277,9 @@
 #define HTTP_IS_DATA_VOLATILE(hs) ((hs->file < (char *)0x20000000) ? 0 : TCP_WRITE_FLAG_COPY)*/
 #ifndef HTTP_IS_DATA_VOLATILE
 #if LWIP_HTTPD_SSI
-/* Copy for SSI files, no copy for non-SSI files */
-#define HTTP_IS_DATA_VOLATILE(hs)   ((hs)->tag_check ? TCP_WRITE_FLAG_COPY : 0)
+/* SSI files are copied unless sent in place (see HTTP_FILE_WRITE_FLAGS),
+   no copy for non-SSI files */
+#define HTTP_IS_DATA_VOLATILE(hs)   ((hs)->tag_check ? HTTP_FILE_WRITE_FLAGS(hs) : 0)
 #else /* LWIP_HTTPD_SSI */
 /** Default: don't copy if the data is sent from file-system directly */
 #define HTTP_IS_DATA_VOLATILE(hs) (((hs->file != NULL) && (hs->handle != NULL) && (hs->file == \
@@ -232,11 +288,33 @@
 #endif /* LWIP_HTTPD_SSI */
 #endif
 
-/** Default: headers are sent from ROM */
+/** File data is left to TCP uncopied only when it is served in place from the
+ * memory mapped file image or the file system header cache, which stay valid
+ * until it is acknowledged. Data in the file read buffer or the file system
+ * scratch area is copied. */
+#define HTTP_IS_FILE_STATIC(hs)     fs_is_static((hs)->file)
+#define HTTP_FILE_WRITE_FLAGS(hs)   (HTTP_IS_FILE_STATIC(hs) ? 0 : TCP_WRITE_FLAG_COPY)
+
+/** Default: headers are sent from ROM, except for the Content-Length and
+ * Connection lines of a persistent connection built in hs->hdr_ka */
 #ifndef HTTP_IS_HDR_VOLATILE
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+#define HTTP_IS_HDR_VOLATILE(hs, ptr) ((((const char*)(ptr) >= (hs)->hdr_ka) && \
+                                       ((const char*)(ptr) < &(hs)->hdr_ka[sizeof((hs)->hdr_ka)])) \
+                                       ? TCP_WRITE_FLAG_COPY : 0)
+#else /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
 #define HTTP_IS_HDR_VOLATILE(hs, ptr) 0
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
 #endif
 
+/** True if the file being sent is the gzip copy of the requested one, its
+ * header then has "Content-Encoding: gzip" (see LWIP_FS_GZIP) */
+#if LWIP_FS_GZIP
+#define HTTP_IS_GZIP(hs) (((hs)->handle != NULL) && (hs)->handle->is_gzip)
+#else /* LWIP_FS_GZIP */
+#define HTTP_IS_GZIP(hs) 0
+#endif /* LWIP_FS_GZIP */
+
 #if LWIP_HTTPD_SSI
 /** Default: Tags are sent from struct http_state and are therefore volatile */
 #ifndef HTTP_IS_TAG_VOLATILE
@@ -295,6 +373,33 @@ enum tag_check_state {
   TAG_LEADOUT,    /* Tag lead out "-->" being processed */
   TAG_SENDING     /* Sending tag replacement string */
 };
+
+#if LWIP_HTTPD_SSI_TAG_CACHE
+/* State of a tag cache entry */
+#define SSI_TAGS_FREE     0 /* Not used */
+#define SSI_TAGS_NOTING   1 /* Tags are noted while the file is parsed */
+#define SSI_TAGS_KNOWN    2 /* All tags of the file are known */
+#define SSI_TAGS_MANY     3 /* More tags than fit, the file is parsed */
+
+/* Tag offsets of an SSI file. An offset counts the bytes from the tag
+   lead-in to the end of the file, so it doesn't depend on whether the HTTP
+   header is sent from the file or not. */
+struct http_ssi_tags {
+  u32_t hash;   /* FNV-1a hash of the name */
+  u32_t size;   /* Length of the file */
+  u16_t gen;    /* Changed each time the entry is reset */
+  u16_t count;  /* Number of offsets */
+  u8_t state;   /* SSI_TAGS_* */
+  char name[LWIP_HTTPD_SSI_TAG_CACHE_NAME];
+  u32_t offset[LWIP_HTTPD_SSI_TAG_CACHE_TAGS]; /* In file order */
+};
+
+static struct http_ssi_tags ssi_tags[LWIP_HTTPD_SSI_TAG_CACHE_FILES];
+static u8_t ssi_tags_next;
+
+/* Bytes from the parse position to the end of the file */
+#define HTTP_SSI_POS(hs) ((hs)->parse_left + (u32_t)fs_bytes_left((hs)->handle))
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
 #endif /* LWIP_HTTPD_SSI */
 
 struct http_state {
@@ -328,6 +433,12 @@ struct http_state {
   char tag_name[LWIP_HTTPD_MAX_TAG_NAME_LEN + 1]; /* Last tag name extracted */
   char tag_insert[LWIP_HTTPD_MAX_TAG_INSERT_LEN + 1]; /* Insert string for tag_name */
   enum tag_check_state tag_state; /* State of the tag processor */
+#if LWIP_HTTPD_SSI_TAG_CACHE
+  struct http_ssi_tags *tags; /* Tag offsets of the file, or NULL */
+  u32_t tag_pos;     /* Offset of the tag lead-in being parsed */
+  u16_t tag_gen;     /* gen of tags when it was looked up */
+  u16_t tag_next;    /* Next entry of tags->offset to skip to */
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
 #endif /* LWIP_HTTPD_SSI */
 #if LWIP_HTTPD_CGI
   char *params[LWIP_HTTPD_MAX_CGI_PARAMETERS]; /* Params extracted from the request URI */
@@ -339,6 +450,15 @@ struct http_state {
                         current string */
   u16_t hdr_index;   /* The index of the hdr string currently being sent. */
 #endif /* LWIP_HTTPD_DYNAMIC_HEADERS */
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+  struct pbuf *pipeline; /* Requests received while a response was sent */
+  u16_t keepalive_count; /* Responses completed on this connection */
+  u8_t keepalive;   /* true if the connection stays open after this response */
+  char hdr_ka[56];  /* Content-Length and Connection header lines */
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+#if LWIP_FS_GZIP
+  u8_t accept_gzip; /* true if the request takes Content-Encoding: gzip */
+#endif /* LWIP_FS_GZIP */
 #if LWIP_HTTPD_TIMING
   u32_t time_started;
 #endif /* LWIP_HTTPD_TIMING */
@@ -438,6 +558,12 @@ http_state_free(struct http_state *hs)
       hs->buf = NULL;
     }
 #endif /* LWIP_HTTPD_SSI || LWIP_HTTPD_DYNAMIC_HEADERS */
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+    if (hs->pipeline != NULL) {
+      pbuf_free(hs->pipeline);
+      hs->pipeline = NULL;
+    }
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
 #if HTTPD_USE_MEM_POOL
     memp_free(MEMP_HTTPD_STATE, hs);
 #else /* HTTPD_USE_MEM_POOL */
@@ -533,6 +659,136 @@ http_close_conn(struct tcp_pcb *pcb, struct http_state *hs)
   }
   return err;
 }
+
+#if LWIP_HTTPD_SSI_TAG_CACHE
+/**
+ * Look up the tag offsets of an SSI file. If they are not known (or no more
+ * for this length), start noting them while the file is parsed.
+ *
+ * @param hs http connection state with the file opened
+ * @param uri the file name
+ */
+static void
+http_ssi_tags_attach(struct http_state *hs, const char *uri)
+{
+  struct http_ssi_tags *t = NULL;
+  u32_t hash = 2166136261UL;
+  u32_t size = (u32_t)hs->handle->len;
+  const char *p;
+  size_t nlen;
+  int i;
+
+  hs->tags = NULL;
+  hs->tag_next = 0;
+  for (p = uri; *p; p++) {
+    hash = (hash ^ (u8_t)*p) * 16777619UL;
+  }
+  nlen = p - uri;
+  if (nlen >= LWIP_HTTPD_SSI_TAG_CACHE_NAME) {
+    return;
+  }
+  for (i = 0; i < LWIP_HTTPD_SSI_TAG_CACHE_FILES; i++) {
+    if ((ssi_tags[i].state != SSI_TAGS_FREE) && (ssi_tags[i].hash == hash) &&
+        !strcmp(ssi_tags[i].name, uri)) {
+      t = &ssi_tags[i];
+      break;
+    }
+  }
+  if (t == NULL) {
+    /* Replace the oldest entry */
+    t = &ssi_tags[ssi_tags_next];
+    ssi_tags_next = (ssi_tags_next + 1) % LWIP_HTTPD_SSI_TAG_CACHE_FILES;
+    t->hash = hash;
+    MEMCPY(t->name, uri, nlen + 1);
+  } else if (t->size == size) {
+    if (t->state == SSI_TAGS_MANY) {
+      return;
+    }
+    if (t->state == SSI_TAGS_KNOWN) {
+      hs->tags = t;
+      hs->tag_gen = t->gen;
+      return;
+    }
+  }
+  /* Noted again by this connection, one that was noting them stops */
+  t->gen++;
+  t->size = size;
+  t->count = 0;
+  t->state = SSI_TAGS_NOTING;
+  hs->tags = t;
+  hs->tag_gen = t->gen;
+}
+
+/** Tag offsets of the file if they are all known, NULL otherwise */
+static struct http_ssi_tags *
+http_ssi_tags_known(struct http_state *hs)
+{
+  struct http_ssi_tags *t = hs->tags;
+
+  if ((t != NULL) && (t->gen == hs->tag_gen) && (t->state == SSI_TAGS_KNOWN)) {
+    return t;
+  }
+  return NULL;
+}
+
+/**
+ * Note the offset of a tag just parsed, if the connection notes the tags
+ *
+ * @param hs http connection state
+ * @param done 1 at the end of the file: all tags are known then
+ */
+static void
+http_ssi_tags_note(struct http_state *hs, u8_t done)
+{
+  struct http_ssi_tags *t = hs->tags;
+
+  if ((t == NULL) || (t->gen != hs->tag_gen) || (t->state != SSI_TAGS_NOTING)) {
+    return;
+  }
+  if (done) {
+    t->state = SSI_TAGS_KNOWN;
+  } else if (t->count < LWIP_HTTPD_SSI_TAG_CACHE_TAGS) {
+    t->offset[t->count++] = hs->tag_pos;
+  } else {
+    t->state = SSI_TAGS_MANY;
+  }
+}
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
+
+/**
+ * The whole response has been queued for sending. Keep a persistent
+ * connection open for the next request, close any other one.
+ *
+ * @param pcb the tcp pcb of the connection
+ * @param hs connection state
+ * @return 1 if the connection is kept open, 0 if it was closed
+ */
+static u8_t
+http_eof(struct tcp_pcb *pcb, struct http_state *hs)
+{
+#if LWIP_HTTPD_SSI_TAG_CACHE
+  if (hs->tag_check) {
+    http_ssi_tags_note(hs, 1);
+  }
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+  if (hs->keepalive) {
+    LWIP_DEBUGF(HTTPD_DEBUG, ("End of file, keeping connection %p open\n", (void*)pcb));
+    /* The read buffer is kept for the next file */
+    fs_close(hs->handle);
+    hs->handle = NULL;
+    hs->file = NULL;
+    hs->left = 0;
+    hs->retries = 0;
+    hs->hdr_index = NUM_FILE_HDR_STRINGS;
+    hs->keepalive = false;
+    hs->keepalive_count++;
+    return 1;
+  }
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+  http_close_conn(pcb, hs);
+  return 0;
+}
 #if LWIP_HTTPD_CGI
 /**
  * Extract URI parameters from the parameter-part of an URI in the form
@@ -661,6 +917,171 @@ get_tag_insert(struct http_state *hs)
 }
 #endif /* LWIP_HTTPD_SSI */
 
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+/**
+ * Set up the headers of a response on a persistent connection: the HTTP/1.1
+ * status line, Content-Length and Connection lines built into hs->hdr_ka, then
+ * the server and content type lines of the cached file system header.
+ *
+ * @param hs http connection state with the file opened
+ * @param hdr the cached header of the file
+ * @return 1 if the headers were set up, 0 if hdr has an unknown status line
+ */
+static u8_t
+http_keepalive_headers(struct http_state *hs, const char *hdr)
+{
+  const char *rest;
+  char num[11];
+  char *p;
+  u32_t len;
+  int i;
+
+  rest = strchr(hdr, '\n');
+  if (rest == NULL) {
+    return 0;
+  }
+  rest++;
+  for (i = HTTP_HDR_OK; i <= HTTP_HDR_NOT_IMPL; i++) {
+    if (!strncmp(hdr, g_psHTTPHeaderStrings[i], rest - hdr)) {
+      break;
+    }
+  }
+  if (i > HTTP_HDR_NOT_IMPL) {
+    return 0;
+  }
+
+  /* Body left in memory and in the file */
+  len = hs->left + fs_bytes_left(hs->handle);
+  p = &num[sizeof(num) - 1];
+  *p = 0;
+  do {
+    *--p = (char)('0' + (len % 10));
+    len /= 10;
+  } while (len != 0);
+  strcpy(hs->hdr_ka, g_psHTTPHeaderStrings[HTTP_HDR_CONTENT_LENGTH]);
+  strcat(hs->hdr_ka, p);
+  strcat(hs->hdr_ka, CRLF);
+  strcat(hs->hdr_ka, g_psHTTPHeaderStrings[HTTP_HDR_CONN_KEEPALIVE]);
+
+  hs->hdrs[0] = g_psHTTPHeaderStrings[i + (HTTP_HDR_OK_11 - HTTP_HDR_OK)];
+  hs->hdrs[1] = hs->hdr_ka;
+  hs->hdrs[2] = rest;
+  hs->hdr_index = 0;
+  hs->hdr_pos = 0;
+  return 1;
+}
+
+/**
+ * Tell whether the client wants the connection kept open after this request:
+ * HTTP/1.1 unless it sends "Connection: close", HTTP/1.0 only if it sends
+ * "Connection: keep-alive". The whole request header must be in data.
+ *
+ * @param hs http connection state
+ * @param data the request
+ * @param data_len length of the request
+ * @param crlf end of the request line
+ */
+static u8_t
+http_want_keepalive(struct http_state *hs, const char *data, u16_t data_len, const char *crlf)
+{
+  const char *end;
+  u16_t hdr_len;
+
+  if ((hs->keepalive_count + 1) >= HTTPD_KEEPALIVE_MAX_REQUESTS) {
+    return false;
+  }
+  end = strnstr(data, CRLF CRLF, data_len);
+  if (end == NULL) {
+    return false;
+  }
+  hdr_len = (u16_t)(end - data);
+  if (strnstr(data, "Connection: close", hdr_len) || strnstr(data, "Connection: Close", hdr_len)) {
+    return false;
+  }
+  if (strnstr(data, "Connection: keep-alive", hdr_len) || strnstr(data, "Connection: Keep-Alive", hdr_len)) {
+    return true;
+  }
+  return ((crlf - data) >= 8) && !strncmp(crlf - 8, "HTTP/1.1", 8);
+}
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+
+#if LWIP_FS_GZIP
+/**
+ * Tell whether the client takes a gzip compressed response: "gzip" in its
+ * Accept-Encoding line and not turned off with a quality of 0. The whole
+ * request header must be in data.
+ *
+ * @param data the request
+ * @param data_len length of the request
+ */
+static u8_t
+http_accepts_gzip(const char *data, u16_t data_len)
+{
+  const char *end, *line, *eol, *p;
+
+  end = strnstr(data, CRLF CRLF, data_len);
+  if (end == NULL) {
+    return false;
+  }
+  line = strnstr(data, "Accept-Encoding:", end - data);
+  if (line == NULL) {
+    line = strnstr(data, "accept-encoding:", end - data);
+  }
+  if (line == NULL) {
+    return false;
+  }
+  eol = strnstr(line, CRLF, end + 2 - line);
+  p = strnstr(line, "gzip", eol - line);
+  if (p == NULL) {
+    return false;
+  }
+  for (p += 4; (p < eol) && (*p == ' '); p++) {
+  }
+  if ((p < eol) && (*p == ';')) {
+    do {
+      p++;
+    } while ((p < eol) && (*p == ' '));
+    if (((eol - p) >= 3) && !strncmp(p, "q=0", 3)) {
+      /* "q=0", "q=0.0" and so on refuse it, "q=0.5" doesn't */
+      for (p += 3; (p < eol) && ((*p == '.') || (*p == '0')); p++) {
+      }
+      return (p < eol) && (*p >= '1') && (*p <= '9');
+    }
+  }
+  return true;
+}
+#endif /* LWIP_FS_GZIP */
+
+/**
+ * Open a file for a request, its gzip copy if the client takes it and the
+ * file has no SSI tags to parse.
+ *
+ * @param hs http connection state
+ * @param uri the file name
+ * @return file struct or NULL if the file was not found
+ */
+static struct fs_file *
+http_fs_open(struct http_state *hs, const char *uri)
+{
+#if LWIP_FS_GZIP
+  u8_t gzip = hs->accept_gzip;
+#if LWIP_HTTPD_SSI
+  size_t loop;
+
+  for (loop = 0; loop < NUM_SHTML_EXTENSIONS; loop++) {
+    if (strstr(uri, g_pcSSIExtensions[loop])) {
+      gzip = false;
+      break;
+    }
+  }
+#endif /* LWIP_HTTPD_SSI */
+  return fs_open_enc(uri, gzip);
+#else /* LWIP_FS_GZIP */
+  LWIP_UNUSED_ARG(hs);
+  return fs_open(uri);
+#endif /* LWIP_FS_GZIP */
+}
+
 #if LWIP_HTTPD_DYNAMIC_HEADERS
 /**
  * Generate the relevant HTTP headers for the given filename and write
@@ -673,6 +1094,31 @@ get_http_headers(struct http_state *pState, char *pszURI)
   char *pszWork;
   char *pszExt;
   char *pszVars;
+  const char *pszHdr;
+  int hdrLen;
+
+  /* A URI without variables has its whole header built once by the file
+     system, send that as the last header string. */
+  if ((pszURI != NULL) && (strchr(pszURI, '?') == NULL)) {
+    pszHdr = fs_get_http_header(pszURI, HTTP_IS_GZIP(pState), &hdrLen);
+    if (pszHdr != NULL) {
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+      if (pState->keepalive && (hdrLen != 0) && http_keepalive_headers(pState, pszHdr)) {
+        return;
+      }
+      pState->keepalive = false;
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+      pState->hdrs[NUM_FILE_HDR_STRINGS - 1] = pszHdr;
+      pState->hdr_index = (hdrLen != 0) ? (NUM_FILE_HDR_STRINGS - 1) : NUM_FILE_HDR_STRINGS;
+      pState->hdr_pos = 0;
+      return;
+    }
+  }
+
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+  /* Headers without Content-Length, the connection is closed after them */
+  pState->keepalive = false;
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
 
   /* Ensure that we initialize the loop counter. */
   iLoop = 0;
@@ -772,9 +1218,15 @@ http_send_data(struct tcp_pcb *pcb, struct http_state *hs)
   u16_t len;
   u16_t mss;
   u8_t data_to_send = false;
+#if LWIP_HTTPD_SSI || LWIP_HTTPD_DYNAMIC_HEADERS
+  u8_t refill = true;
+#endif /* LWIP_HTTPD_SSI || LWIP_HTTPD_DYNAMIC_HEADERS */
 #if LWIP_HTTPD_DYNAMIC_HEADERS
   u16_t hdrlen, sendlen;
 #endif /* LWIP_HTTPD_DYNAMIC_HEADERS */
+#if LWIP_HTTPD_SSI_TAG_CACHE
+  struct http_ssi_tags *tags;
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
 
   LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("http_send_data: pcb=%p hs=%p left=%d\n", (void*)pcb,
     (void*)hs, hs != NULL ? hs->left : 0));
@@ -848,6 +1300,9 @@ http_send_data(struct tcp_pcb *pcb, struct http_state *hs)
   err = ERR_OK;
 #endif /* LWIP_HTTPD_DYNAMIC_HEADERS */
 
+#if LWIP_HTTPD_SSI || LWIP_HTTPD_DYNAMIC_HEADERS
+read_block:
+#endif /* LWIP_HTTPD_SSI || LWIP_HTTPD_DYNAMIC_HEADERS */
   /* Have we run out of file data to send? If so, we need to read the next
    * block from the file. */
   if (hs->left == 0) {
@@ -862,10 +1317,9 @@ http_send_data(struct tcp_pcb *pcb, struct http_state *hs)
       return 0;
     }
     if (fs_bytes_left(hs->handle) <= 0) {
-      /* We reached the end of the file so this request is done.
-       * @todo: don't close here for HTTP/1.1? */
+      /* We reached the end of the file so this request is done. */
       LWIP_DEBUGF(HTTPD_DEBUG, ("End of file.\n"));
-      http_close_conn(pcb, hs);
+      http_eof(pcb, hs);
       return 0;
     }
 #if LWIP_HTTPD_SSI || LWIP_HTTPD_DYNAMIC_HEADERS
@@ -908,6 +1362,9 @@ http_send_data(struct tcp_pcb *pcb, struct http_state *hs)
     LWIP_DEBUGF(HTTPD_DEBUG, ("Read %d bytes.\n", count));
     hs->left = count;
     hs->file = hs->buf;
+    /* Have the card read the next block while this one is sent, the tcp_sent
+     * callback then finds it in the sector cache. */
+    fs_prefetch(hs->handle, hs->buf_len);
 #if LWIP_HTTPD_SSI
     hs->parse_left = count;
     hs->parsed = hs->buf;
@@ -936,11 +1393,20 @@ http_send_data(struct tcp_pcb *pcb, struct http_state *hs)
       len = 2 * mss;
     }
 
-    err = http_write(pcb, hs->file, &len, TCP_WRITE_FLAG_COPY);
+    err = http_write(pcb, hs->file, &len, HTTP_FILE_WRITE_FLAGS(hs));
     if (err == ERR_OK) {
       data_to_send = true;
       hs->file += len;
       hs->left -= len;
+#if LWIP_HTTPD_SSI || LWIP_HTTPD_DYNAMIC_HEADERS
+      /* A header sent from the file system is followed by the first block
+       * of the body straight away, so both go out in the same segment. */
+      if (refill && (hs->left == 0) && (hs->handle != NULL) &&
+          (fs_bytes_left(hs->handle) > 0) && (tcp_sndbuf(pcb) > 0)) {
+        refill = false;
+        goto read_block;
+      }
+#endif /* LWIP_HTTPD_SSI || LWIP_HTTPD_DYNAMIC_HEADERS */
     }
 #if LWIP_HTTPD_SSI
   } else {
@@ -992,6 +1458,28 @@ http_send_data(struct tcp_pcb *pcb, struct http_state *hs)
       }
       switch(hs->tag_state) {
         case TAG_NONE:
+#if LWIP_HTTPD_SSI_TAG_CACHE
+          tags = http_ssi_tags_known(hs);
+          if (tags != NULL) {
+            /* The tags are known: skip to the next one, or to the end of
+             * the block if it has no more, and parse only the tag. */
+            u32_t pos = HTTP_SSI_POS(hs);
+            u32_t skip = hs->parse_left;
+
+            while ((hs->tag_next < tags->count) && (tags->offset[hs->tag_next] > pos)) {
+              hs->tag_next++;
+            }
+            if (hs->tag_next < tags->count) {
+              skip = LWIP_MIN(skip, pos - tags->offset[hs->tag_next]);
+            }
+            if (skip != 0) {
+              hs->parse_left -= skip;
+              hs->parsed += skip;
+              break;
+            }
+            hs->tag_next++;
+          }
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
           /* We are not currently processing an SSI tag so scan for the
            * start of the lead-in marker. */
           if(*hs->parsed == g_pcTagLeadIn[0]) {
@@ -999,6 +1487,9 @@ http_send_data(struct tcp_pcb *pcb, struct http_state *hs)
              * state appropriately. */
             hs->tag_state = TAG_LEADIN;
             hs->tag_index = 1;
+#if LWIP_HTTPD_SSI_TAG_CACHE
+            hs->tag_pos = HTTP_SSI_POS(hs);
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
 #if !LWIP_HTTPD_SSI_INCLUDE_TAG
             hs->tag_started = hs->parsed;
 #endif /* !LWIP_HTTPD_SSI_INCLUDE_TAG */
@@ -1117,6 +1608,9 @@ http_send_data(struct tcp_pcb *pcb, struct http_state *hs)
 #if LWIP_HTTPD_SSI_MULTIPART
               hs->tag_part = 0; /* start with tag part 0 */
 #endif /* LWIP_HTTPD_SSI_MULTIPART */
+#if LWIP_HTTPD_SSI_TAG_CACHE
+              http_ssi_tags_note(hs, 0);
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
               get_tag_insert(hs);
 
               /* Next time through, we are going to be sending data
@@ -1281,11 +1775,10 @@ http_send_data(struct tcp_pcb *pcb, struct http_state *hs)
 
   if((hs->left == 0) && (fs_bytes_left(hs->handle) <= 0)) {
     /* We reached the end of the file so this request is done.
-     * This adds the FIN flag right into the last data segment.
-     * @todo: don't close here for HTTP/1.1? */
+     * This adds the FIN flag right into the last data segment, unless the
+     * connection is kept open. */
     LWIP_DEBUGF(HTTPD_DEBUG, ("End of file.\n"));
-    http_close_conn(pcb, hs);
-    return 0;
+    return http_eof(pcb, hs) ? data_to_send : 0;
   }
   LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("send_data end.\n"));
   return data_to_send;
@@ -1632,9 +2125,20 @@ http_parse_request(struct pbuf **inp, struct http_state *hs, struct tcp_pcb *pcb
       char *sp1, *sp2;
       u16_t left_len, uri_len;
       LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("CRLF received, parsing request\n"));
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+      hs->keepalive = false;
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+#if LWIP_FS_GZIP
+      hs->accept_gzip = http_accepts_gzip(data, data_len);
+#endif /* LWIP_FS_GZIP */
       /* parse method */
       if (!strncmp(data, "GET ", 4)) {
         sp1 = data + 3;
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+        /* Only GET requests are kept alive, checked before the request is
+           cut up by the parsing below */
+        hs->keepalive = http_want_keepalive(hs, data, data_len, crlf);
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
         /* received GET request */
         LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("Received GET request\"\n"));
 #if LWIP_HTTPD_SUPPORT_POST
@@ -1758,7 +2262,7 @@ http_find_file(struct http_state *hs, const char *uri, int is_09)
        that exists. */
     for (loop = 0; loop < NUM_DEFAULT_FILENAMES; loop++) {
       LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("Looking for %s...\n", g_psDefaultFilenames[loop].name));
-      file = fs_open((char *)g_psDefaultFilenames[loop].name);
+      file = http_fs_open(hs, g_psDefaultFilenames[loop].name);
       uri = (char *)g_psDefaultFilenames[loop].name;
       if(file != NULL) {
         LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("Opened.\n"));
@@ -1808,7 +2312,7 @@ http_find_file(struct http_state *hs, const char *uri, int is_09)
 
     LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("Opening %s\n", uri));
 
-    file = fs_open(uri);
+    file = http_fs_open(hs, uri);
     if (file == NULL) {
       file = http_get_404_file(&uri);
     }
@@ -1844,15 +2348,12 @@ http_find_file(struct http_state *hs, const char *uri, int is_09)
 static err_t
 http_init_file(struct http_state *hs, struct fs_file *file, int is_09, const char *uri)
 {
+#if LWIP_HTTPD_DYNAMIC_HEADERS
+  u8_t hdr_in_file = false;
+#endif /* LWIP_HTTPD_DYNAMIC_HEADERS */
+
   if (file != NULL) {
     /* file opened, initialise struct http_state */
-#if LWIP_HTTPD_SSI
-    hs->tag_index = 0;
-    hs->tag_state = TAG_NONE;
-    hs->parsed = file->data;
-    hs->parse_left = file->len;
-    hs->tag_end = file->data;
-#endif /* LWIP_HTTPD_SSI */
     hs->handle = file;
     hs->file = (char*)file->data;
     LWIP_ASSERT("File length must be positive!", (file->len >= 0));
@@ -1876,16 +2377,55 @@ http_init_file(struct http_state *hs, struct fs_file *file, int is_09, const cha
       }
     }
 #endif /* LWIP_HTTPD_SUPPORT_V09*/
+#if LWIP_HTTPD_DYNAMIC_HEADERS
+    hdr_in_file = hs->handle->http_header_included;
+#endif /* LWIP_HTTPD_DYNAMIC_HEADERS */
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+    if (is_09) {
+      hs->keepalive = false;
+    } else if (hdr_in_file && hs->keepalive) {
+      /* The header in the file has no Content-Length, skip it and send
+         the one built for the persistent connection instead. */
+      char *file_start = strnstr(hs->file, CRLF CRLF, hs->left);
+      if (file_start != NULL) {
+        size_t diff = file_start + 4 - hs->file;
+        hs->file += diff;
+        hs->left -= (u32_t)diff;
+        hdr_in_file = false;
+      } else {
+        hs->keepalive = false;
+      }
+    }
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+#if LWIP_HTTPD_SSI
+    /* Parse what is in memory (file->index bytes, the header only for a
+       file on the card), after a header that was skipped above */
+    hs->tag_index = 0;
+    hs->tag_state = TAG_NONE;
+    hs->parsed = hs->file;
+    hs->parse_left = hs->left;
+    hs->tag_end = hs->file;
+#if LWIP_HTTPD_SSI_TAG_CACHE
+    if (hs->tag_check && (uri != NULL)) {
+      http_ssi_tags_attach(hs, uri);
+    } else {
+      hs->tags = NULL;
+    }
+#endif /* LWIP_HTTPD_SSI_TAG_CACHE */
+#endif /* LWIP_HTTPD_SSI */
   } else {
     hs->handle = NULL;
     hs->file = NULL;
     hs->left = 0;
     hs->retries = 0;
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+    hs->keepalive = false;
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
   }
 #if LWIP_HTTPD_DYNAMIC_HEADERS
     /* Determine the HTTP headers to send based on the file extension of
    * the requested URI. */
-  if ((hs->handle == NULL) || !hs->handle->http_header_included) {
+  if ((hs->handle == NULL) || !hdr_in_file) {
     get_http_headers(hs, (char*)uri);
   }
 #else /* LWIP_HTTPD_DYNAMIC_HEADERS */
@@ -1894,6 +2434,88 @@ http_init_file(struct http_state *hs, struct fs_file *file, int is_09, const cha
   return ERR_OK;
 }
 
+/**
+ * Parse a received request and start sending the response.
+ *
+ * @param pcb the tcp_pcb which received the request
+ * @param hs the connection state, with no file open
+ * @param p the received data, freed or kept by this function
+ */
+static void
+http_handle_request(struct tcp_pcb *pcb, struct http_state *hs, struct pbuf *p)
+{
+  err_t parsed;
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+  /* End of the request, for a pipelined one that follows in the same pbuf */
+  char *end = strnstr((char *)p->payload, CRLF CRLF, p->len);
+  u16_t req_len = (end != NULL) ? (u16_t)(end + 4 - (char *)p->payload) : 0;
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+
+  parsed = http_parse_request(&p, hs, pcb);
+  LWIP_ASSERT("http_parse_request: unexpected return value", parsed == ERR_OK
+    || parsed == ERR_INPROGRESS ||parsed == ERR_ARG || parsed == ERR_USE);
+#if LWIP_HTTPD_SUPPORT_REQUESTLIST
+  if (parsed != ERR_INPROGRESS) {
+    /* request fully parsed or error */
+    if (hs->req != NULL) {
+      pbuf_free(hs->req);
+      hs->req = NULL;
+    }
+  }
+#else /* LWIP_HTTPD_SUPPORT_REQUESTLIST */
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+  if ((p != NULL) && (parsed == ERR_OK) && hs->keepalive) {
+    /* Keep whatever follows this request for later */
+    if (req_len == 0) {
+      hs->keepalive = false;
+    } else if (req_len < p->len) {
+      pbuf_header(p, -(s16_t)req_len);
+      hs->pipeline = p;
+      p = NULL;
+    } else if (p->next != NULL) {
+      hs->pipeline = pbuf_dechain(p);
+      p = NULL;
+    }
+  }
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+  if (p != NULL) {
+    /* pbuf not passed to application, free it now */
+    pbuf_free(p);
+  }
+#endif /* LWIP_HTTPD_SUPPORT_REQUESTLIST */
+  if (parsed == ERR_OK) {
+#if LWIP_HTTPD_SUPPORT_POST
+    if (hs->post_content_len_left == 0)
+#endif /* LWIP_HTTPD_SUPPORT_POST */
+    {
+      LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("http_recv: data %p len %"S32_F"\n", hs->file, hs->left));
+      http_send_data(pcb, hs);
+    }
+  } else if (parsed == ERR_ARG) {
+    /* @todo: close on ERR_USE? */
+    http_close_conn(pcb, hs);
+  }
+}
+
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+/**
+ * Serve the next pipelined request once the connection is idle.
+ *
+ * @param pcb the tcp_pcb of the connection
+ * @param hs the connection state
+ */
+static void
+http_next_request(struct tcp_pcb *pcb, struct http_state *hs)
+{
+  struct pbuf *p = hs->pipeline;
+
+  if ((hs->handle == NULL) && (p != NULL)) {
+    hs->pipeline = NULL;
+    http_handle_request(pcb, hs, p);
+  }
+}
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
+
 /**
  * The pcb had an error and is already deallocated.
  * The argument might still be valid (if != NULL).
@@ -1930,6 +2552,13 @@ http_sent(void *arg, struct tcp_pcb *pcb, u16_t len)
 
   hs->retries = 0;
 
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+  if (hs->handle == NULL) {
+    /* Persistent connection between requests */
+    http_next_request(pcb, hs);
+    return ERR_OK;
+  }
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
   http_send_data(pcb, hs);
 
   return ERR_OK;
@@ -1964,6 +2593,18 @@ http_poll(void *arg, struct tcp_pcb *pcb)
     return ERR_OK;
   } else {
     hs->retries++;
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+    if ((hs->handle == NULL) && (hs->keepalive_count != 0)) {
+      /* Persistent connection waiting for its next request */
+      if (hs->retries >= HTTPD_KEEPALIVE_IDLE_POLLS) {
+        LWIP_DEBUGF(HTTPD_DEBUG, ("http_poll: keep-alive timeout, close\n"));
+        http_close_conn(pcb, hs);
+      } else {
+        http_next_request(pcb, hs);
+      }
+      return ERR_OK;
+    }
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
     if (hs->retries == HTTPD_MAX_RETRIES) {
       LWIP_DEBUGF(HTTPD_DEBUG, ("http_poll: too many retries, close\n"));
       http_close_conn(pcb, hs);
@@ -1993,7 +2634,6 @@ http_poll(void *arg, struct tcp_pcb *pcb)
 static err_t
 http_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 {
-  err_t parsed = ERR_ABRT;
   struct http_state *hs = (struct http_state *)arg;
   LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("http_recv: pcb=%p pbuf=%p err=%s\n", (void*)pcb,
     (void*)p, lwip_strerr(err)));
@@ -2038,38 +2678,30 @@ http_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
   } else
 #endif /* LWIP_HTTPD_SUPPORT_POST */
   {
+#if LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+    if ((hs->handle != NULL) || (hs->pipeline != NULL)) {
+      if ((hs->handle == NULL) || hs->keepalive) {
+        /* Pipelined request, served when the ones before it are done */
+        if (hs->pipeline == NULL) {
+          hs->pipeline = p;
+        } else {
+          pbuf_cat(hs->pipeline, p);
+        }
+        http_next_request(pcb, hs);
+      } else {
+        LWIP_DEBUGF(HTTPD_DEBUG, ("http_recv: already sending data\n"));
+        pbuf_free(p);
+      }
+      return ERR_OK;
+    }
+#endif /* LWIP_HTTPD_SUPPORT_11_KEEPALIVE */
     if (hs->handle == NULL) {
-      parsed = http_parse_request(&p, hs, pcb);
-      LWIP_ASSERT("http_parse_request: unexpected return value", parsed == ERR_OK
-        || parsed == ERR_INPROGRESS ||parsed == ERR_ARG || parsed == ERR_USE);
+      http_handle_request(pcb, hs, p);
     } else {
       LWIP_DEBUGF(HTTPD_DEBUG, ("http_recv: already sending data\n"));
-    }
-#if LWIP_HTTPD_SUPPORT_REQUESTLIST
-    if (parsed != ERR_INPROGRESS) {
-      /* request fully parsed or error */
-      if (hs->req != NULL) {
-        pbuf_free(hs->req);
-        hs->req = NULL;
-      }
-    }
-#else /* LWIP_HTTPD_SUPPORT_REQUESTLIST */
-    if (p != NULL) {
-      /* pbuf not passed to application, free it now */
+#if !LWIP_HTTPD_SUPPORT_REQUESTLIST
       pbuf_free(p);
-    }
-#endif /* LWIP_HTTPD_SUPPORT_REQUESTLIST */
-    if (parsed == ERR_OK) {
-#if LWIP_HTTPD_SUPPORT_POST
-      if (hs->post_content_len_left == 0)
-#endif /* LWIP_HTTPD_SUPPORT_POST */
-      {
-        LWIP_DEBUGF(HTTPD_DEBUG | LWIP_DBG_TRACE, ("http_recv: data %p len %"S32_F"\n", hs->file, hs->left));
-        http_send_data(pcb, hs);
-      }
-    } else if (parsed == ERR_ARG) {
-      /* @todo: close on ERR_USE? */
-      http_close_conn(pcb, hs);
+#endif /* !LWIP_HTTPD_SUPPORT_REQUESTLIST */
     }
   }
   return ERR_OK;
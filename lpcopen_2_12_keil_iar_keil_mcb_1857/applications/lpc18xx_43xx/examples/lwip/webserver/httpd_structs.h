@@ -56,7 +56,8 @@ static const char * const g_psHTTPHeaderStrings[] =
  "Connection: Close\r\n",
  "Connection: keep-alive\r\n",
  "Server: "HTTPD_SERVER_AGENT"\r\n",
- "\r\n<html><body><h2>404: The requested file cannot be found.</h2></body></html>\r\n"
+ "\r\n<html><body><h2>404: The requested file cannot be found.</h2></body></html>\r\n",
+ "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n"
 };
 
 /* Indexes into the g_psHTTPHeaderStrings array */
@@ -87,6 +88,7 @@ static const char * const g_psHTTPHeaderStrings[] =
 #define HTTP_HDR_CONN_KEEPALIVE 24 /* Connection: keep-alive (HTTP 1.1) */
 #define HTTP_HDR_SERVER         25 /* Server: HTTPD_SERVER_AGENT */
 #define DEFAULT_404_HTML        26 /* default 404 body */
+#define HTTP_HDR_GZIP           27 /* Content-Encoding: gzip */
 
 /** A list of extension-to-HTTP header strings */
 const static tHTTPHeader g_psHTTPHeaders[] =
@@ -39,6 +39,7 @@
 #include "ff.h"
 #include "lwip_fs.h"
 #include "httpd_structs.h"
+#include "sd_cache.h"
 
 /**
  * @ingroup EXAMPLE_LWIP_WEBSERVER_18XX43XX_FS
@@ -70,6 +71,53 @@ struct file_ds {
 };
 static volatile int32_t sdio_wait_exit = 0;
 
+/* Cached header index of a status/content type pair, the content types are
+   followed by an extra one for the 404 body sent when there is no file */
+#define HDR_STATUS_NUM  (HTTP_HDR_NOT_IMPL - HTTP_HDR_OK + 1)
+#define HDR_TYPE_404    (HTTP_HDR_DEFAULT_TYPE + 1)
+#define HDR_TYPE_NUM    (HDR_TYPE_404 + 1)
+#define HDR_COMBO(status, type) ((((status) - HTTP_HDR_OK) * HDR_TYPE_NUM) + (type))
+#define HDR_COMBO_NONE  (HDR_STATUS_NUM * HDR_TYPE_NUM)	/* No header at all */
+
+/* The headers of gzip copies follow those of the plain files in the cache */
+#if LWIP_FS_GZIP
+#define HDR_CACHE_NUM   (2 * HDR_COMBO_NONE)
+#define HDR_CACHE_INDEX(combo, gz) ((gz) ? ((combo) + HDR_COMBO_NONE) : (combo))
+#else
+#define HDR_CACHE_NUM   HDR_COMBO_NONE
+#define HDR_CACHE_INDEX(combo, gz) (combo)
+#endif
+
+/* Whether a file name has a gzip copy */
+#define HDR_GZ_UNKNOWN  0	/* Not looked up yet */
+#define HDR_GZ_NONE     1	/* No copy */
+#define HDR_GZ_FOUND    2	/* Copy opened before */
+
+/* File name entry of the HTTP header cache */
+struct hdr_file {
+	uint32_t hash;		/* FNV-1a hash of the name */
+	uint8_t combo;		/* Header index + 1, 0 for an unused entry */
+#if LWIP_FS_GZIP
+	uint8_t gz;			/* HDR_GZ_* */
+#endif
+	char name[LWIP_FS_HDR_NAME_MAX];
+};
+
+/* HTTP header cache: headers are only appended to the pool, so a pointer to
+   one stays valid for TCP as long as the server runs */
+static char hdrPool[LWIP_FS_HDR_CACHE_SZ];
+static uint16_t hdrPoolUsed;
+static uint16_t hdrComboOff[HDR_CACHE_NUM];
+static uint16_t hdrComboLen[HDR_CACHE_NUM];
+static struct hdr_file hdrFiles[LWIP_FS_HDR_CACHE_FILES];
+static uint8_t hdrFileNext;
+
+#if LWIP_FS_MAPPED
+/* Memory mapped file image and its end, NULL if there is no valid image */
+static const uint8_t *mapBase;
+static const uint8_t *mapEnd;
+#endif
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -84,6 +132,10 @@ mci_card_struct sdcardinfo;
 #include "FreeRTOS.h"
 #include "semphr.h"
 static xSemaphoreHandle open_lock;
+
+/* Given by the SDIO interrupt, so the task waiting on a block transfer
+   sleeps and the other connections are served meanwhile */
+static xSemaphoreHandle sdio_event;
 /* FreeRTOS mutex lock */
 static int mutex_lock(xSemaphoreHandle *mx)
 {
@@ -170,48 +222,33 @@ static void mutex_unlock(int *mx)
 
 #endif
 
-/**
- * Generate the relevant HTTP headers for the given filename and write
- * them into the supplied buffer.
- */
-static int
-get_http_headers(const char *fName, char *buff)
+/* Work out the status and content type pair of a file name */
+static int get_http_combo(const char *fName)
 {
-	unsigned int iLoop;
-	const char *pszExt = NULL;
-	const char *hdrs[4];
-
-	/* Ensure that we initialize the loop counter. */
-	iLoop = 0;
-
-	/* In all cases, the second header we send is the server identification
-	   so set it here. */
-	hdrs[1] = g_psHTTPHeaderStrings[HTTP_HDR_SERVER];
+	unsigned int iLoop, status;
+	const char *pszExt;
 
 	/* Is this a normal file or the special case we use to send back the
 	   default "404: Page not found" response? */
 	if (( fName == NULL) || ( *fName == 0) ) {
-		hdrs[0] = g_psHTTPHeaderStrings[HTTP_HDR_NOT_FOUND];
-		hdrs[2] = g_psHTTPHeaderStrings[DEFAULT_404_HTML];
-		goto end_fn;
+		return HDR_COMBO(HTTP_HDR_NOT_FOUND, HDR_TYPE_404);
 	}
 	/* We are dealing with a particular filename. Look for one other
 	    special case.  We assume that any filename with "404" in it must be
 	    indicative of a 404 server error whereas all other files require
 	    the 200 OK header. */
 	if (strstr(fName, "404")) {
-		iLoop = HTTP_HDR_NOT_FOUND;
+		status = HTTP_HDR_NOT_FOUND;
 	}
 	else if (strstr(fName, "400")) {
-		iLoop = HTTP_HDR_BAD_REQUEST;
+		status = HTTP_HDR_BAD_REQUEST;
 	}
 	else if (strstr(fName, "501")) {
-		iLoop = HTTP_HDR_NOT_IMPL;
+		status = HTTP_HDR_NOT_IMPL;
 	}
 	else {
-		iLoop = HTTP_HDR_OK;
+		status = HTTP_HDR_OK;
 	}
-	hdrs[0] = g_psHTTPHeaderStrings[iLoop];
 
 	/* Get a pointer to the file extension.  We find this by looking for the
 	     last occurrence of "." in the filename passed. */
@@ -221,7 +258,7 @@ get_http_headers(const char *fName, char *buff)
 	     is a special-case URL used for control state notification and we do
 	     not send any HTTP headers with the response. */
 	if (pszExt == NULL) {
-		return 0;
+		return HDR_COMBO_NONE;
 	}
 
 	pszExt++;
@@ -229,24 +266,178 @@ get_http_headers(const char *fName, char *buff)
 	for (iLoop = 0; (iLoop < NUM_HTTP_HEADERS); iLoop++)
 		/* Have we found a matching extension? */
 		if (!strcmp(g_psHTTPHeaders[iLoop].extension, pszExt)) {
-			hdrs[2] =
-				g_psHTTPHeaderStrings[g_psHTTPHeaders[iLoop].headerIndex];
-			break;
+			return HDR_COMBO(status, g_psHTTPHeaders[iLoop].headerIndex);
+		}
+
+	/* No - use the default, plain text file type. */
+	return HDR_COMBO(status, HTTP_HDR_DEFAULT_TYPE);
+}
+
+/* Build the header of a cache index, or only size it if buff is NULL */
+static int build_http_header(int combo, char *buff)
+{
+	const char *hdrs[4];
+	int i, n, cnt = 0, len = 0, gz = 0;
+
+	if (combo >= HDR_COMBO_NONE) {
+		/* gzip copy, the status and content type of the plain file */
+		combo -= HDR_COMBO_NONE;
+		gz = 1;
+	}
+	hdrs[cnt++] = g_psHTTPHeaderStrings[HTTP_HDR_OK + (combo / HDR_TYPE_NUM)];
+	hdrs[cnt++] = g_psHTTPHeaderStrings[HTTP_HDR_SERVER];
+	if (gz) {
+		hdrs[cnt++] = g_psHTTPHeaderStrings[HTTP_HDR_GZIP];
+	}
+	i = combo % HDR_TYPE_NUM;
+	hdrs[cnt++] = g_psHTTPHeaderStrings[(i == HDR_TYPE_404) ? DEFAULT_404_HTML : i];
+	for (i = 0; i < cnt; i++) {
+		n = strlen(hdrs[i]);
+		if (buff != NULL) {
+			memcpy(&buff[len], hdrs[i], n);
 		}
+		len += n;
+	}
+	return len;
+}
+
+/* Find the name entry of the header cache and the status/content type pair
+   of a file name, adding the entry on first use. The entry is NULL for a
+   name that is too long to be kept. */
+static struct hdr_file *get_hdr_file(const char *fName, int *pCombo)
+{
+	struct hdr_file *ent;
+	uint32_t hash = 2166136261UL;
+	const char *p;
+	int i, nlen = 0;
+
+	/* FNV-1a hash of the name, compared before the name itself */
+	if (fName != NULL) {
+		for (p = fName; *p; p++) {
+			hash = (hash ^ (uint8_t) *p) * 16777619UL;
+		}
+		nlen = p - fName;
+	}
+
+	for (i = 0; (i < LWIP_FS_HDR_CACHE_FILES) && (nlen > 0); i++) {
+		ent = &hdrFiles[i];
+		if (ent->combo && (ent->hash == hash) && !strcmp(ent->name, fName)) {
+			*pCombo = ent->combo - 1;
+			return ent;
+		}
+	}
+
+	*pCombo = get_http_combo(fName);
+	if ((nlen == 0) || (nlen >= LWIP_FS_HDR_NAME_MAX)) {
+		return NULL;
+	}
+	/* Remember the name, replacing the oldest entry */
+	ent = &hdrFiles[hdrFileNext];
+	hdrFileNext = (hdrFileNext + 1) % LWIP_FS_HDR_CACHE_FILES;
+	ent->hash = hash;
+	ent->combo = *pCombo + 1;
+#if LWIP_FS_GZIP
+	ent->gz = HDR_GZ_UNKNOWN;
+#endif
+	memcpy(ent->name, fName, nlen + 1);
+	return ent;
+}
+
+/* Find the cached HTTP header of a file name, or of its gzip copy, building
+   it on first use. Returns NULL if it is not cached and the cache has no
+   room left for it. */
+static const char *get_http_headers(const char *fName, int gz, int *len)
+{
+	int i, combo;
+
+	get_hdr_file(fName, &combo);
+	if (combo == HDR_COMBO_NONE) {
+		*len = 0;
+		return "";
+	}
+	combo = HDR_CACHE_INDEX(combo, gz);
+	if (hdrComboLen[combo] == 0) {
+		i = build_http_header(combo, NULL);
+		if (i > (int) (sizeof(hdrPool) - hdrPoolUsed)) {
+			return NULL;
+		}
+		build_http_header(combo, &hdrPool[hdrPoolUsed]);
+		hdrComboOff[combo] = hdrPoolUsed;
+		hdrComboLen[combo] = i;
+		hdrPoolUsed += i;
+	}
+	*len = hdrComboLen[combo];
+	return &hdrPool[hdrComboOff[combo]];
+}
+
+/* Get the HTTP header of a file name, built into buff if it can't be cached */
+static const char *get_http_headers_buf(const char *fName, int gz, char *buff, int *len)
+{
+	const char *hdr = get_http_headers(fName, gz, len);
+
+	if (hdr == NULL) {
+		*len = build_http_header(HDR_CACHE_INDEX(get_http_combo(fName), gz), buff);
+		hdr = buff;
+	}
+	return hdr;
+}
+
+#if LWIP_FS_MAPPED
+/* Check the image header and work out how far the file data goes */
+static void fs_mapped_init(void)
+{
+	const uint32_t *hdr = (const uint32_t *) LWIP_FS_MAPPED_BASE;
+	const struct fs_mapped_entry *ent = (const struct fs_mapped_entry *) &hdr[2];
+	uint32_t i, end = 8 + (hdr[1] * sizeof(*ent));
+
+	mapBase = mapEnd = NULL;
+	if ((hdr[0] != FS_MAPPED_MAGIC) || (hdr[1] > 1024)) {
+		return;
+	}
+	for (i = 0; i < hdr[1]; i++) {
+		end = MAX(end, ent[i].data + ent[i].len);
+	}
+	mapBase = (const uint8_t *) hdr;
+	mapEnd = mapBase + end;
+}
 
-	/* Did we find a matching extension? */
-	if (iLoop == NUM_HTTP_HEADERS) {
-		/* No - use the default, plain text file type. */
-		hdrs[2] = g_psHTTPHeaderStrings[HTTP_HDR_DEFAULT_TYPE];
+/* Open a file of the mapped image, its data is used in place */
+static struct fs_file *fs_mapped_open(const char *name)
+{
+	const struct fs_mapped_entry *ent;
+	struct fs_file *fs;
+	uint32_t i, count;
+
+	if (mapBase == NULL) {
+		return NULL;
+	}
+	count = ((const uint32_t *) mapBase)[1];
+	ent = (const struct fs_mapped_entry *) (mapBase + 8);
+	for (i = 0; i < count; i++, ent++) {
+		if (strcmp((const char *) mapBase + ent->name, name) == 0) {
+			break;
+		}
+	}
+	if (i == count) {
+		return NULL;
 	}
 
-end_fn:
-	iLoop = strlen(hdrs[0]);
-	strcpy(buff, hdrs[0]);
-	strcat(buff, hdrs[1]);
-	strcat(buff, hdrs[2]);
-	return strlen(buff);
+	/* No extension, the whole file is in memory already */
+	fs = (struct fs_file *) mem_malloc(sizeof(*fs));
+	if (fs == NULL) {
+		DEBUGSTR("Malloc Failure, Out of Memory!\r\n");
+		return NULL;
+	}
+	memset(fs, 0, sizeof(*fs));
+	fs->data = (const char *) mapBase + ent->data;
+	fs->len = ent->len;
+	fs->index = ent->len;
+	fs->http_header_included = (ent->flags & FS_MAPPED_HDR_INCLUDED) != 0;
+	return fs;
 }
+
+#endif
+
 /* Delay callback for timed SDIF/SDMMC functions */
 static void sdmmc_waitms(uint32_t time)
 {
@@ -278,6 +469,9 @@ static void sdmmc_setup_wakeup(void *bits)
 	/* Wait for IRQ - for an RTOS, you would pend on an event here with a IRQ based wakeup. */
 	NVIC_ClearPendingIRQ(SDIO_IRQn);
 	sdio_wait_exit = 0;
+#ifdef OS_FREE_RTOS
+	xSemaphoreTake(sdio_event, 0);
+#endif
 	Chip_SDIF_SetIntMask(LPC_SDMMC, bit_mask);
 	NVIC_EnableIRQ(SDIO_IRQn);
 }
@@ -291,7 +485,13 @@ static uint32_t sdmmc_irq_driven_wait(void)
 	uint32_t status;
 
 	/* Wait for event, would be nice to have a timeout, but keep it  simple */
+#ifdef OS_FREE_RTOS
+	while (sdio_wait_exit == 0) {
+		xSemaphoreTake(sdio_event, portMAX_DELAY);
+	}
+#else
 	while (sdio_wait_exit == 0) {}
+#endif
 
 	/* Get status and clear interrupts */
 	status = Chip_SDIF_GetIntStatus(LPC_SDMMC);
@@ -305,6 +505,9 @@ static uint32_t sdmmc_irq_driven_wait(void)
 static void App_SDMMC_Init()
 {
 	memset(&sdcardinfo, 0, sizeof(sdcardinfo));
+#ifdef OS_FREE_RTOS
+	vSemaphoreCreateBinary(sdio_event);
+#endif
 	sdcardinfo.card_info.evsetup_cb = sdmmc_setup_wakeup;
 	sdcardinfo.card_info.waitfunc_cb = sdmmc_irq_driven_wait;
 	sdcardinfo.card_info.msdelay_func = sdmmc_waitms;
@@ -316,6 +519,67 @@ static void App_SDMMC_Init()
 	Chip_SDIF_Init(LPC_SDMMC);
 }
 
+/* Open the file at path, with the HTTP header of name */
+static struct fs_file *fs_open_file(const char *path, const char *name, int gz)
+{
+	FRESULT res;
+	int hlen;
+	struct file_ds *fds;
+	struct fs_file *fs;
+
+	/* Too huge to keep in stack, must be protected with mutex */
+	static struct file_ds tmpds;
+
+#if LWIP_FS_MAPPED
+	fs = fs_mapped_open(path);
+	if (fs != NULL) {
+#if LWIP_FS_GZIP
+		fs->is_gzip = gz;
+#endif
+		return fs;
+	}
+#endif
+
+	if (mutex_lock(&open_lock)) {
+		LWIP_DEBUGF(HTTPD_DEBUG, ("DFS: ERROR: Mutex Timeout!\r\n"));
+		return NULL;
+	}
+	memset(&tmpds, 0, sizeof(tmpds));
+	fds = &tmpds;
+
+	res = f_open(&fds->fi, path, FA_READ);
+	if (res) {
+		LWIP_DEBUGF(HTTPD_DEBUG, ("DFS: OPEN: File %s does not exist\r\n", path));
+		mutex_unlock(&open_lock);
+		return NULL;
+	}
+
+	fds = (struct file_ds *)mem_malloc(sizeof(*fds));
+ 	if (fds == NULL) {
+		DEBUGSTR("Malloc Failure, Out of Memory!\r\n");
+		mutex_unlock(&open_lock);
+		return NULL;
+	}
+	memcpy(fds, &tmpds, sizeof(*fds));
+
+	/* The header is sent in place from the cache, the scratch buffer is
+	   only used when the cache is full */
+	fs = &fds->fs;
+	fs->data = get_http_headers_buf(name, gz, (char *) fds->scratch, &hlen);
+	mutex_unlock(&open_lock);
+
+	fds->fi_valid = 1;
+	fs->pextension = (void *) fds;	/* Store this for later use */
+	fs->index = hlen;
+	fs->len = f_size(&fds->fi) + hlen;
+	fs->http_header_included = 1;
+#if LWIP_FS_GZIP
+	fs->is_gzip = gz;
+#endif
+
+	return fs;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -323,13 +587,24 @@ static void App_SDMMC_Init()
 /* Read http header information into a string */
 int GetHTTP_Header(const char *fName, char *buff)
 {
-	return get_http_headers(fName, buff);
+	const char *hdr;
+	int hlen;
+
+	hdr = get_http_headers_buf(fName, 0, buff, &hlen);
+	if (hdr != buff) {
+		memcpy(buff, hdr, hlen);
+	}
+	buff[hlen] = 0;
+	return hlen;
 }
 
 /* Initialize the file system */
 int fs_init(void)
 {
 	void rtc_initialize(void);
+#if LWIP_FS_MAPPED
+	fs_mapped_init();
+#endif
 	App_SDMMC_Init();
 	rtc_initialize();
 
@@ -363,7 +638,7 @@ struct fs_file *fs_open_default(void) {
 	memset(fds, 0, sizeof(*fds));
 	fs = &fds->fs;
 	fs->pextension = (void *) fds;	/* Store this for later use */
-	hlen = get_http_headers("default.htm", (char *) fds->scratch);
+	hlen = GetHTTP_Header("default.htm", (char *) fds->scratch);
 	fs->data = (const char *) fds->scratch;
 	memcpy((void *) &fs->data[hlen], (void *) http_index_html, sizeof(http_index_html) - 1);
 	fs->len = hlen + sizeof(http_index_html) - 1;
@@ -373,48 +648,50 @@ struct fs_file *fs_open_default(void) {
 }
 
 /* File open function */
-struct fs_file *fs_open(const char *name) {
-	FRESULT res;
-	int hlen;
-	struct file_ds *fds;
-	struct fs_file *fs;
+struct fs_file *fs_open(const char *name)
+{
+	return fs_open_file(name, name, 0);
+}
 
-	/* Too huge to keep in stack, must be protected with mutex */
-	static struct file_ds tmpds;
+/* Open a file, or its gzip copy if the client takes it */
+struct fs_file *fs_open_enc(const char *name, int gzip)
+{
+#if LWIP_FS_GZIP
+	char gzName[LWIP_FS_HDR_NAME_MAX + 3];
+	struct hdr_file *ent;
+	struct fs_file *fs;
+	int combo, len, nlen = strlen(name);
 
-	if (mutex_lock(&open_lock)) {
-		LWIP_DEBUGF(HTTPD_DEBUG, ("DFS: ERROR: Mutex Timeout!\r\n"));
-		return NULL;
+	if (!gzip || (nlen >= LWIP_FS_HDR_NAME_MAX) || mutex_lock(&open_lock)) {
+		return fs_open(name);
 	}
-	memset(&tmpds, 0, sizeof(tmpds));
-	fds = &tmpds;
-
-	res = f_open(&fds->fi, name, FA_READ);
-	if (res) {
-		LWIP_DEBUGF(HTTPD_DEBUG, ("DFS: OPEN: File %s does not exist\r\n", name));
-		mutex_unlock(&open_lock);
-		return NULL;
+	/* Only try the copy if its header is cached: once in the pool it stays
+	   there, so httpd finds it again for the response */
+	ent = get_hdr_file(name, &combo);
+	gzip = (ent != NULL) && (ent->gz != HDR_GZ_NONE) && (combo != HDR_COMBO_NONE) &&
+		   (get_http_headers(name, 1, &len) != NULL);
+	mutex_unlock(&open_lock);
+	if (!gzip) {
+		return fs_open(name);
 	}
 
-	fds = (struct file_ds *)mem_malloc(sizeof(*fds));
- 	if (fds == NULL) {
-		DEBUGSTR("Malloc Failure, Out of Memory!\r\n");
+	memcpy(gzName, name, nlen);
+	memcpy(&gzName[nlen], ".gz", 4);
+	fs = fs_open_file(gzName, name, 1);
+
+	/* Remember the outcome, the entry may have been replaced meanwhile */
+	if (!mutex_lock(&open_lock)) {
+		ent = get_hdr_file(name, &combo);
+		if (ent != NULL) {
+			ent->gz = (fs != NULL) ? HDR_GZ_FOUND : HDR_GZ_NONE;
+		}
 		mutex_unlock(&open_lock);
-		return NULL;
 	}
-	memcpy(fds, &tmpds, sizeof(*fds));
-	mutex_unlock(&open_lock);
-
-	fs = &fds->fs;
-	fds->fi_valid = 1;
-	fs->pextension = (void *) fds;	/* Store this for later use */
-	hlen = get_http_headers(name, (char *) fds->scratch);
-	fs->data = (const char *) fds->scratch;
-	fs->index = hlen;
-	fs->len = f_size(&fds->fi) + hlen;
-	fs->http_header_included = 1;
-
-	return fs;
+	if (fs != NULL) {
+		return fs;
+	}
+#endif
+	return fs_open(name);
 }
 
 /* File close function */
@@ -426,6 +703,11 @@ void fs_close(struct fs_file *file)
 		return;
 
 	fds = (struct file_ds *) file->pextension;
+	if (fds == NULL) {
+		/* Memory mapped file, only the descriptor was allocated */
+		mem_free(file);
+		return;
+	}
 
 #if (!defined(BOARD_HITEX_EVA_1850) && !defined(BOARD_HITEX_EVA_4350))
 	if (fds->fi_valid)
@@ -440,6 +722,13 @@ int fs_read(struct fs_file *file, char *buffer, int count)
 {
 	uint32_t i = 0;
 	struct file_ds *fds = (struct file_ds *) file->pextension;
+	if (fds == NULL) {
+		/* Memory mapped file, normally sent in place without a read */
+		i = MIN(count, fs_bytes_left(file));
+		memcpy(buffer, &file->data[file->index], i);
+		file->index += i;
+		return i;
+	}
 	if (f_read(&fds->fi, (uint8_t *) buffer, count, &i))
 		return 0; /* Error in reading file */
 	file->index += i;
@@ -452,6 +741,76 @@ int fs_bytes_left(struct fs_file *file)
 	return file->len - file->index;
 }
 
+/* Tell whether data lies in the memory mapped file image */
+int fs_is_mapped(const void *ptr)
+{
+#if LWIP_FS_MAPPED
+	return (mapBase != NULL) && ((const uint8_t *) ptr >= mapBase) && ((const uint8_t *) ptr < mapEnd);
+#else
+	return 0;
+#endif
+}
+
+/* Start reading the next bytes of a file from the card in the background */
+void fs_prefetch(struct fs_file *file, int count)
+{
+	struct file_ds *fds = (struct file_ds *) file->pextension;
+	FIL *fi;
+	DWORD pos, csect, clst, n;
+
+	if ((fds == NULL) || !fds->fi_valid || (count <= 0)) {
+		return;	/* Memory mapped or default file */
+	}
+	fi = &fds->fi;
+	if (fi->fptr >= fi->fsize) {
+		return;
+	}
+
+	/* Data up to the next sector boundary is in the file object already.
+	   The sector after it is only known while it is in the current
+	   cluster, at a cluster boundary f_read() follows the FAT itself. */
+	pos = (fi->fptr + SECTOR_SZ - 1) & ~(SECTOR_SZ - 1);
+	csect = (pos / SECTOR_SZ) & (fi->fs->csize - 1);
+	if (fi->fptr == 0) {
+		clst = fi->sclust;
+	}
+	else if (csect == 0) {
+		return;
+	}
+	else {
+		clst = fi->clust;
+	}
+	if ((clst < 2) || (pos >= fi->fsize)) {
+		return;
+	}
+
+	n = MIN((DWORD) (count + SECTOR_SZ - 1) / SECTOR_SZ, fi->fs->csize - csect);
+	n = MIN(n, (fi->fsize - pos + SECTOR_SZ - 1) / SECTOR_SZ);
+	sd_cache_prefetch(fi->fs->database + ((clst - 2) * fi->fs->csize) + csect, n);
+}
+
+/* Tell whether data stays valid until TCP has sent it */
+int fs_is_static(const void *ptr)
+{
+	if (((const char *) ptr >= hdrPool) && ((const char *) ptr < &hdrPool[hdrPoolUsed])) {
+		return 1;
+	}
+	return fs_is_mapped(ptr);
+}
+
+/* Get the cached HTTP header for a file name */
+const char *fs_get_http_header(const char *name, int gzip, int *len)
+{
+	const char *hdr;
+
+	if (mutex_lock(&open_lock)) {
+		return NULL;
+	}
+	hdr = get_http_headers(name, gzip, len);
+	mutex_unlock(&open_lock);
+	return hdr;
+}
+
 /**
  * @brief	SDIO controller interrupt handler
  * @return	Nothing
@@ -463,10 +822,24 @@ void SDIO_IRQHandler(void)
 	   driver and needs to be enabled/disabled in the callbacks or
 	   application as needed. This is to allow flexibility with IRQ
 	   handling for applicaitons and RTOSes. */
+	/* Non-blocking transfers (Chip_SDMMC_ReadBlocksAsync) are completed
+	   by the driver */
+	if (Chip_SDMMC_IRQHandler(LPC_SDMMC)) {
+		return;
+	}
+
 	/* Set wait exit flag to tell wait function we are ready. In an RTOS,
 	   this would trigger wakeup of a thread waiting for the IRQ. */
 	NVIC_DisableIRQ(SDIO_IRQn);
 	sdio_wait_exit = 1;
+#ifdef OS_FREE_RTOS
+	{
+		portBASE_TYPE woken = pdFALSE;
+
+		xSemaphoreGiveFromISR(sdio_event, &woken);
+		portEND_SWITCHING_ISR(woken);
+	}
+#endif
 }
 
 
@@ -67,6 +67,72 @@
 #define HTTPD_PRECALCULATED_CHECKSUM  0
 #endif
 
+/** Set this to 1 to serve files in place from a memory mapped file image at
+ * LWIP_FS_MAPPED_BASE, in internal flash or in SPIFI flash in memory mode.
+ * Files found there are sent by TCP straight from flash: no fs_read() copy,
+ * no file buffer and no TCP_WRITE_FLAG_COPY. Other names still go to the
+ * FAT file system. Without a valid image at the address nothing changes.
+ */
+#ifndef LWIP_FS_MAPPED
+#define LWIP_FS_MAPPED                0
+#endif
+
+/** Address of the file image, flash bank B by default */
+#ifndef LWIP_FS_MAPPED_BASE
+#define LWIP_FS_MAPPED_BASE           0x1B000000
+#endif
+
+/** First word of a file image, "MFS1" */
+#define FS_MAPPED_MAGIC               0x3153464D
+
+/** Entry flag: the data starts with its own HTTP header */
+#define FS_MAPPED_HDR_INCLUDED        (1 << 0)
+
+/* Layout of the file image, all words little endian and offsets from the
+   start of the image:
+     u32 magic      : FS_MAPPED_MAGIC
+     u32 count      : number of entries that follow
+     entries        : count times struct fs_mapped_entry
+     names and data : anywhere after the entries
+   Names are NUL terminated and start with '/', as in the request URI.
+   Without FS_MAPPED_HDR_INCLUDED the server adds the header from the file
+   extension (LWIP_HTTPD_DYNAMIC_HEADERS). */
+struct fs_mapped_entry {
+  u32_t name;   /* Offset of the file name */
+  u32_t data;   /* Offset of the file data */
+  u32_t len;    /* Size of the file data */
+  u32_t flags;  /* FS_MAPPED_HDR_INCLUDED */
+};
+
+/** Set this to 1 to send the gzip compressed copy of a file to clients that
+ * take it (Accept-Encoding: gzip), with "Content-Encoding: gzip" and the
+ * content type of the original. The copy is stored next to the file, on the
+ * card or in the mapped image, with ".gz" appended to the name. In the image
+ * it goes without FS_MAPPED_HDR_INCLUDED so the server adds the header.
+ * Whether a name has a copy is kept with the name in the header cache, so a
+ * name without one is looked up once. Not used for SSI files.
+ */
+#ifndef LWIP_FS_GZIP
+#define LWIP_FS_GZIP                  0
+#endif
+
+/** Size of the HTTP header cache. Each status/content type pair is built
+ * once into this area and then sent by TCP in place with the file data. When
+ * it is full, headers are built per request into the file scratch buffer.
+ */
+#ifndef LWIP_FS_HDR_CACHE_SZ
+#define LWIP_FS_HDR_CACHE_SZ          1536
+#endif
+
+/** Number of file names that remember their cached header, so the name is
+ * not parsed again on the next request */
+#ifndef LWIP_FS_HDR_CACHE_FILES
+#define LWIP_FS_HDR_CACHE_FILES       16
+#endif
+
+/** Longest file name (with the NUL) kept by the per file header table */
+#define LWIP_FS_HDR_NAME_MAX          32
+
 #if HTTPD_PRECALCULATED_CHECKSUM
 struct fsdata_chksum {
   u32_t offset;
@@ -88,6 +154,9 @@ struct fs_file {
 #if LWIP_HTTPD_CUSTOM_FILES
   u8_t is_custom_file;
 #endif /* LWIP_HTTPD_CUSTOM_FILES */
+#if LWIP_FS_GZIP
+  u8_t is_gzip;   /* The data is the gzip copy of the file */
+#endif /* LWIP_FS_GZIP */
 #if LWIP_HTTPD_FILE_STATE
   void *state;
 #endif /* LWIP_HTTPD_FILE_STATE */
@@ -131,6 +200,19 @@ struct fs_file *fs_open_default(void);
  */
 struct fs_file *fs_open(const char *name);
 
+/**
+ * @brief	Open a file, or its gzip compressed copy
+ * @param name	:	Name of the file to be opened, as in the request URI
+ * @param gzip	:	1 if the client takes Content-Encoding: gzip
+ * @return Pointer to File structure on success, with is_gzip set if the
+ *         copy "name.gz" was opened, NULL on failure
+ * @note
+ * Without LWIP_FS_GZIP, or when there is no copy, this is fs_open(). The
+ * cached header of a copy (fs_get_http_header() with @a gzip 1) has the
+ * Content-Encoding line.
+ */
+struct fs_file *fs_open_enc(const char *name, int gzip);
+
 /**
  * @brief	Closes/Frees a previously opened file function
  * The function will close the file & free the resources.
@@ -159,6 +241,46 @@ int fs_read(struct fs_file *file, char *buffer, int count);
  */
 int fs_bytes_left(struct fs_file *file);
 
+/**
+ * @brief	Tell whether data lies in the memory mapped file image
+ * @param ptr	:	Start of the data
+ * @return 1 if @a ptr is in the image, so it stays valid while TCP needs it
+ *         0 otherwise, or without LWIP_FS_MAPPED
+ */
+int fs_is_mapped(const void *ptr);
+
+/**
+ * @brief	Start reading the next bytes of a file from the card in the background
+ * @param file	:	Pointer to File structure of opened file
+ * @param count	:	Number of bytes the next fs_read() will ask for
+ * @return Nothing
+ * @note
+ * Call after fs_read(), while the data read is in the TCP send window. The
+ * card reads the following sectors into the sector cache meanwhile, so the
+ * next fs_read() doesn't wait for the card. Nothing is done for files that
+ * are not on the card or when the next data starts a new cluster.
+ */
+void fs_prefetch(struct fs_file *file, int count);
+
+/**
+ * @brief	Tell whether data stays valid until TCP has sent it
+ * @param ptr	:	Start of the data
+ * @return 1 if @a ptr is in the memory mapped file image or the HTTP header
+ *         cache, so it can be sent without TCP_WRITE_FLAG_COPY, 0 otherwise
+ */
+int fs_is_static(const void *ptr);
+
+/**
+ * @brief	Get the cached HTTP header for a file name
+ * @param name	:	Name of the file, as in the request URI
+ * @param gzip	:	1 for the header of the gzip copy (is_gzip of the file)
+ * @param len	:	Pointer to where the header length is stored
+ * @return Pointer to the header, which never changes once built, or
+ *         NULL if the cache is full. A name without extension has an empty
+ *         header with @a len 0.
+ */
+const char *fs_get_http_header(const char *name, int gzip, int *len);
+
 #if LWIP_HTTPD_FILE_STATE
 /** This user-defined function is called when a file is opened. */
 void *fs_state_init(struct fs_file *file, const char *name);
@@ -0,0 +1,364 @@
+/*
+ * @brief	SD card sector cache module
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "board.h"
+#include "sd_cache.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define SD_CACHE_NONE           0xFFFF
+#define SD_CACHE_MAX_RUN        128		/* Blocks the card descriptors cover in one transfer */
+#define SD_CACHE_DATA(i)        ((uint8_t *) SD_CACHE_BASE + ((i) * MMC_SECTOR_SIZE))
+#define SD_CACHE_BUCKET(s)      ((s) & (SD_CACHE_HASH - 1))
+#define SD_CACHE_PF_DATA        SD_CACHE_DATA(SD_CACHE_SECTORS)
+
+/* States of the read ahead transfer */
+#define SD_CACHE_PF_IDLE        0
+#define SD_CACHE_PF_BUSY        1	/* Card is reading into SD_CACHE_PF_DATA */
+#define SD_CACHE_PF_DONE        2	/* Data waits to be moved into the cache */
+
+/* Tag of one cached sector, kept in internal RAM */
+typedef struct {
+	uint32_t sector;
+	uint16_t prev;			/* LRU list, most recently used at the head */
+	uint16_t next;
+	uint16_t hnext;			/* Hash bucket chain */
+	uint8_t valid;
+	uint8_t dirty;
+} SD_CACHE_TAG_T;
+
+static SD_CACHE_TAG_T tags[SD_CACHE_SECTORS];
+static uint16_t buckets[SD_CACHE_HASH];
+static uint16_t lru_head, lru_tail;
+static SD_CACHE_STATS_T cache_stats;
+
+/* Read ahead transfer, only one as the card does one transfer at a time */
+static volatile uint8_t pf_state;
+static uint32_t pf_sector, pf_count;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Move a slot to the head of the LRU list */
+static void lru_touch(uint16_t i)
+{
+	if (i == lru_head) {
+		return;
+	}
+
+	/* Unlink, the slot is not the head so it has a previous one */
+	tags[tags[i].prev].next = tags[i].next;
+	if (i == lru_tail) {
+		lru_tail = tags[i].prev;
+	}
+	else {
+		tags[tags[i].next].prev = tags[i].prev;
+	}
+
+	tags[i].prev = SD_CACHE_NONE;
+	tags[i].next = lru_head;
+	tags[lru_head].prev = i;
+	lru_head = i;
+}
+
+/* Find the slot holding a sector */
+static uint16_t cache_lookup(uint32_t sector)
+{
+	uint16_t i = buckets[SD_CACHE_BUCKET(sector)];
+
+	while ((i != SD_CACHE_NONE) && (tags[i].sector != sector)) {
+		i = tags[i].hnext;
+	}
+
+	return i;
+}
+
+/* Remove a slot from its hash bucket */
+static void hash_remove(uint16_t i)
+{
+	uint16_t *link = &buckets[SD_CACHE_BUCKET(tags[i].sector)];
+
+	while (*link != i) {
+		link = &tags[*link].hnext;
+	}
+	*link = tags[i].hnext;
+}
+
+/* Write a dirty slot to the card */
+static int cache_write_slot(uint16_t i)
+{
+	if (Chip_SDMMC_WriteBlocks(LPC_SDMMC, SD_CACHE_DATA(i), tags[i].sector, 1) == 0) {
+		return -1;
+	}
+	cache_stats.writes++;
+	tags[i].dirty = 0;
+
+	return 0;
+}
+
+/* Reuse the least recently used slot for a sector */
+static uint16_t cache_alloc(uint32_t sector)
+{
+	uint16_t i = lru_tail;
+
+	if (tags[i].valid) {
+		if (tags[i].dirty && (cache_write_slot(i) != 0)) {
+			return SD_CACHE_NONE;
+		}
+		hash_remove(i);
+	}
+
+	tags[i].sector = sector;
+	tags[i].valid = 1;
+	tags[i].dirty = 0;
+	tags[i].hnext = buckets[SD_CACHE_BUCKET(sector)];
+	buckets[SD_CACHE_BUCKET(sector)] = i;
+	lru_touch(i);
+
+	return i;
+}
+
+/* Read ahead completion, called from the SDIO interrupt */
+static void prefetch_done(LPC_SDMMC_T *pSDMMC, int32_t bytes)
+{
+	pf_state = (bytes != 0) ? SD_CACHE_PF_DONE : SD_CACHE_PF_IDLE;
+}
+
+/* Wait for the read ahead transfer and move its sectors into the cache */
+static void prefetch_collect(void)
+{
+	uint32_t i;
+	uint16_t slot;
+
+	if (pf_state == SD_CACHE_PF_BUSY) {
+		cache_stats.waits++;
+		while (pf_state == SD_CACHE_PF_BUSY) {
+			Chip_SDMMC_PollAsync(LPC_SDMMC);
+		}
+	}
+	if (pf_state == SD_CACHE_PF_DONE) {
+		for (i = 0; i < pf_count; i++) {
+			if (cache_lookup(pf_sector + i) == SD_CACHE_NONE) {
+				slot = cache_alloc(pf_sector + i);
+				if (slot != SD_CACHE_NONE) {
+					memcpy(SD_CACHE_DATA(slot), SD_CACHE_PF_DATA + (i * MMC_SECTOR_SIZE), MMC_SECTOR_SIZE);
+				}
+			}
+		}
+		cache_stats.prefetched += pf_count;
+		pf_state = SD_CACHE_PF_IDLE;
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Empty the cache */
+void sd_cache_init(void)
+{
+	uint32_t i;
+
+	/* A read ahead of the old card is of no use */
+	while (pf_state == SD_CACHE_PF_BUSY) {
+		Chip_SDMMC_PollAsync(LPC_SDMMC);
+	}
+	pf_state = SD_CACHE_PF_IDLE;
+
+	for (i = 0; i < SD_CACHE_SECTORS; i++) {
+		tags[i].valid = 0;
+		tags[i].dirty = 0;
+		tags[i].prev = (i == 0) ? SD_CACHE_NONE : (i - 1);
+		tags[i].next = (i == (SD_CACHE_SECTORS - 1)) ? SD_CACHE_NONE : (i + 1);
+	}
+	for (i = 0; i < SD_CACHE_HASH; i++) {
+		buckets[i] = SD_CACHE_NONE;
+	}
+	lru_head = 0;
+	lru_tail = SD_CACHE_SECTORS - 1;
+	memset(&cache_stats, 0, sizeof(cache_stats));
+}
+
+/* Read sectors through the cache */
+int32_t sd_cache_read(void *buff, uint32_t sector, uint32_t count)
+{
+	uint8_t *p = (uint8_t *) buff;
+	uint32_t run, i;
+	uint16_t slot;
+
+	prefetch_collect();
+	while (count > 0) {
+		slot = cache_lookup(sector);
+		if (slot != SD_CACHE_NONE) {
+			memcpy(p, SD_CACHE_DATA(slot), MMC_SECTOR_SIZE);
+			lru_touch(slot);
+			cache_stats.hits++;
+			run = 1;
+		}
+		else {
+			/* Fetch the whole run of missing sectors in one transfer, then keep a copy */
+			for (run = 1; (run < count) && (run < SD_CACHE_MAX_RUN) &&
+				 (cache_lookup(sector + run) == SD_CACHE_NONE); run++) {}
+			if (Chip_SDMMC_ReadBlocks(LPC_SDMMC, p, sector, run) == 0) {
+				return 0;
+			}
+			cache_stats.misses += run;
+
+			for (i = 0; i < run; i++) {
+				slot = cache_alloc(sector + i);
+				if (slot != SD_CACHE_NONE) {
+					memcpy(SD_CACHE_DATA(slot), p + (i * MMC_SECTOR_SIZE), MMC_SECTOR_SIZE);
+				}
+			}
+		}
+
+		p += run * MMC_SECTOR_SIZE;
+		sector += run;
+		count -= run;
+	}
+
+	return p - (uint8_t *) buff;
+}
+
+/* Start reading sectors into the cache in the background */
+uint32_t sd_cache_prefetch(uint32_t sector, uint32_t count)
+{
+	uint32_t run;
+
+	if (pf_state == SD_CACHE_PF_BUSY) {
+		return 0;
+	}
+	prefetch_collect();
+
+	/* Read the first run of sectors that are not cached yet */
+	while ((count > 0) && (cache_lookup(sector) != SD_CACHE_NONE)) {
+		sector++;
+		count--;
+	}
+	count = MIN(count, SD_CACHE_PREFETCH_SECTORS);
+	for (run = 0; (run < count) && (cache_lookup(sector + run) == SD_CACHE_NONE); run++) {}
+	if (run == 0) {
+		return 0;
+	}
+
+	pf_sector = sector;
+	pf_count = run;
+	pf_state = SD_CACHE_PF_BUSY;
+	if (Chip_SDMMC_ReadBlocksAsync(LPC_SDMMC, SD_CACHE_PF_DATA, sector, run, prefetch_done) == 0) {
+		pf_state = SD_CACHE_PF_IDLE;
+		return 0;
+	}
+
+	return run;
+}
+
+/* Write sectors through the cache */
+int32_t sd_cache_write(const void *buff, uint32_t sector, uint32_t count)
+{
+	const uint8_t *p = (const uint8_t *) buff;
+	uint32_t run;
+	uint16_t slot;
+#if !SD_CACHE_WRITE_BACK
+	uint32_t i;
+#endif
+
+	/* The read ahead must not bring back data older than this */
+	prefetch_collect();
+	while (count > 0) {
+#if SD_CACHE_WRITE_BACK
+		/* Only the cache copy is updated, the card gets it on eviction or flush */
+		slot = cache_lookup(sector);
+		if (slot == SD_CACHE_NONE) {
+			slot = cache_alloc(sector);
+			if (slot == SD_CACHE_NONE) {
+				return 0;
+			}
+		}
+		else {
+			lru_touch(slot);
+		}
+		memcpy(SD_CACHE_DATA(slot), p, MMC_SECTOR_SIZE);
+		tags[slot].dirty = 1;
+		run = 1;
+#else
+		run = MIN(count, SD_CACHE_MAX_RUN);
+		if (Chip_SDMMC_WriteBlocks(LPC_SDMMC, (void *) p, sector, run) == 0) {
+			return 0;
+		}
+		cache_stats.writes += run;
+
+		/* Keep the cached copies up to date, FAT sectors are read before they are written */
+		for (i = 0; i < run; i++) {
+			slot = cache_lookup(sector + i);
+			if (slot != SD_CACHE_NONE) {
+				memcpy(SD_CACHE_DATA(slot), p + (i * MMC_SECTOR_SIZE), MMC_SECTOR_SIZE);
+				lru_touch(slot);
+			}
+		}
+#endif
+
+		p += run * MMC_SECTOR_SIZE;
+		sector += run;
+		count -= run;
+	}
+
+	return p - (const uint8_t *) buff;
+}
+
+/* Write all dirty sectors to the card */
+int sd_cache_flush(void)
+{
+	int ret = 0;
+	uint32_t i;
+
+	prefetch_collect();
+	for (i = 0; i < SD_CACHE_SECTORS; i++) {
+		if (tags[i].valid && tags[i].dirty && (cache_write_slot(i) != 0)) {
+			ret = -1;
+		}
+	}
+
+	return ret;
+}
+
+/* Get the cache statistics */
+void sd_cache_get_stats(SD_CACHE_STATS_T *stats)
+{
+	*stats = cache_stats;
+}
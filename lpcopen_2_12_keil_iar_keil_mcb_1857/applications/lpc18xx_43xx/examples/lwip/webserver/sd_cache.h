@@ -0,0 +1,150 @@
+/*
+ * @brief	SD card sector cache module header
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+#ifndef __SD_CACHE_H_
+#define __SD_CACHE_H_
+
+#include "board.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup EXAMPLE_LWIP_WEBSERVER_18XX43XX_SDCACHE SD card sector cache
+ * @ingroup EXAMPLE_LWIP_WEBSERVER_18XX43XX
+ * LRU cache of card sectors in external SDRAM, between the FatFs disk glue
+ * (through the FSMCI adapter in fsmci_cfg.h) and the Chip_SDMMC_* driver.
+ * FAT and directory sectors and the web pages served most often are read
+ * from SDRAM instead of the card.
+ * @{
+ */
+
+/** Start of the cache data in SDRAM, also a SDIF DMA target */
+#ifndef SD_CACHE_BASE
+#define SD_CACHE_BASE           0x28000000
+#endif
+
+/** Number of cached sectors (512 bytes each in SDRAM, 12 bytes of tags in internal RAM) */
+#ifndef SD_CACHE_SECTORS
+#define SD_CACHE_SECTORS        256
+#endif
+
+/** Set to 1 to keep written sectors in the cache until evicted or flushed,
+ * 0 writes every sector through to the card straight away */
+#ifndef SD_CACHE_WRITE_BACK
+#define SD_CACHE_WRITE_BACK     0
+#endif
+
+/** Sectors of the read-ahead buffer in SDRAM, right after the cache data */
+#ifndef SD_CACHE_PREFETCH_SECTORS
+#define SD_CACHE_PREFETCH_SECTORS 8
+#endif
+
+/** Number of lookup hash buckets, a power of 2 */
+#ifndef SD_CACHE_HASH
+#define SD_CACHE_HASH           64
+#endif
+
+#if (SD_CACHE_SECTORS < 1) || (SD_CACHE_SECTORS > 0xFFFF) || (SD_CACHE_HASH & (SD_CACHE_HASH - 1))
+#error "SD_CACHE: 1 to 65535 sectors and a power of 2 hash size"
+#endif
+
+/**
+ * @brief Cache statistics
+ */
+typedef struct {
+	uint32_t hits;			/*!< Sectors read from the cache */
+	uint32_t misses;		/*!< Sectors read from the card */
+	uint32_t writes;		/*!< Sectors written to the card */
+	uint32_t prefetched;	/*!< Sectors read ahead in the background */
+	uint32_t waits;			/*!< Accesses that had to wait for a read ahead */
+} SD_CACHE_STATS_T;
+
+/**
+ * @brief	Empty the cache
+ * @return	Nothing
+ * @note	Dirty sectors are dropped, call with a newly acquired card.
+ */
+void sd_cache_init(void);
+
+/**
+ * @brief	Read sectors through the cache
+ * @param	buff		: Buffer to fill
+ * @param	sector		: First sector to read
+ * @param	count		: Number of sectors
+ * @return	Number of bytes read, 0 on error
+ */
+int32_t sd_cache_read(void *buff, uint32_t sector, uint32_t count);
+
+/**
+ * @brief	Start reading sectors into the cache in the background
+ * @param	sector		: First sector to read
+ * @param	count		: Number of sectors, at most SD_CACHE_PREFETCH_SECTORS are read
+ * @return	Number of sectors being read, 0 if they are cached already or
+ *			the card is busy with another read ahead
+ * @note	Returns once the read is started, the sectors go into the cache
+ *			on the next call to this module, which waits for the card if the
+ *			read is still going on.
+ */
+uint32_t sd_cache_prefetch(uint32_t sector, uint32_t count);
+
+/**
+ * @brief	Write sectors through the cache
+ * @param	buff		: Data to write
+ * @param	sector		: First sector to write
+ * @param	count		: Number of sectors
+ * @return	Number of bytes written (or cached), 0 on error
+ */
+int32_t sd_cache_write(const void *buff, uint32_t sector, uint32_t count);
+
+/**
+ * @brief	Write all dirty sectors to the card
+ * @return	0 on success, -1 when a write failed
+ * @note	Nothing to do for a write-through cache.
+ */
+int sd_cache_flush(void);
+
+/**
+ * @brief	Get the cache statistics
+ * @param	stats	: Pointer to the structure to fill
+ * @return	Nothing
+ */
+void sd_cache_get_stats(SD_CACHE_STATS_T *stats);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_CACHE_H_ */
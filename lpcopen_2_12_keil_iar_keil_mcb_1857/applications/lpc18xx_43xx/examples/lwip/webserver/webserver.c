@@ -60,6 +60,11 @@ static struct netif lpc_netif;
  * Public types/enumerations/variables
  ****************************************************************************/
 
+#if LPC_LWIP_HEAP_DMAMEM
+/* lwIP heap in the AHB SRAM, see LPC_LWIP_HEAP_DMAMEM in lwipopts.h */
+DMAMEM unsigned char lpc_lwip_heap[MEM_SIZE + (2 * MEM_ALIGNMENT) + 64];
+#endif
+
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
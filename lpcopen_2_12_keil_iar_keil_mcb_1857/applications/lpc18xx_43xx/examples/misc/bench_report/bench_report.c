@@ -0,0 +1,451 @@
+/*
+ * @brief Benchmark report example
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "board.h"
+#include "ring_buffer.h"
+#include "fixdsp.h"
+#include "bench.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Report format, BENCH_FORMAT_TEXT, BENCH_FORMAT_CSV or BENCH_FORMAT_JSON */
+#ifndef BENCH_REPORT_FORMAT
+#define BENCH_REPORT_FORMAT BENCH_FORMAT_CSV
+#endif
+
+/* Report title, set per board revision */
+#ifndef BENCH_REPORT_TITLE
+#define BENCH_REPORT_TITLE "LPC18xx/43xx benchmark report"
+#endif
+
+/* Bytes processed per iteration */
+#define BLOCK_SIZE          4096
+
+/* Buffers outside the local SRAM the example runs in */
+#define AHB_SRAM_BUF        ((uint8_t *) 0x2000C000)
+#define SDRAM_BUF           ((uint8_t *) 0x28000000)
+
+/* Source and destination of a copy */
+typedef struct {
+	uint8_t *dst;
+	const uint8_t *src;
+	uint8_t dma_channel;
+} COPY_CTX_T;
+
+static uint32_t localSrc[BLOCK_SIZE / 4];
+static uint32_t localDst[BLOCK_SIZE / 4];
+
+static COPY_CTX_T copyLocal = {(uint8_t *) localDst, (const uint8_t *) localSrc, 0};
+static COPY_CTX_T copyToAhb = {AHB_SRAM_BUF, (const uint8_t *) localSrc, 0};
+static COPY_CTX_T copyToSdram = {SDRAM_BUF, (const uint8_t *) localSrc, 0};
+static COPY_CTX_T copySdram = {SDRAM_BUF + BLOCK_SIZE, SDRAM_BUF, 0};
+
+/* Ring buffer of bytes, half the block so every pass wraps */
+static RINGBUFF_T ringBuf;
+static uint8_t ringData[BLOCK_SIZE / 2];
+
+static uint32_t crcTable[256];
+
+/* Filters of the DSP benchmarks: a 32 tap Hamming windowed Q15 low pass
+   at 0.1 fs, a decimate by 4 through it and a 2 stage Butterworth Q31
+   biquad low pass at 0.05 fs (coefficients halved, postShift 1) */
+#define DSP_FIR_TAPS        32
+static const int16_t firCoeffs[DSP_FIR_TAPS] = {
+	-17, 20, 73, 135, 163, 91, -129, -466,
+	-782, -850, -435, 588, 2141, 3926, 5501, 6424,
+	6424, 5501, 3926, 2141, 588, -435, -850, -782,
+	-466, -129, 91, 163, 135, 73, 20, -17
+};
+static const int32_t biquadCoeffs[2 * 5] = {
+	21564350, 43128699, 21564350, 1676130396, -688645970,
+	21564350, 43128699, 21564350, 1676130396, -688645970
+};
+static DSP_FIR_Q15_T fir;
+static DSP_DECIM_Q15_T decim;
+static DSP_BIQUAD_Q31_T biquad;
+static int16_t firState[DSP_FIR_STATE_SIZE(DSP_FIR_TAPS)];
+static int16_t decimState[DSP_FIR_STATE_SIZE(DSP_FIR_TAPS)];
+static int32_t biquadState[DSP_BIQUAD_STATE_SIZE(2)];
+
+#ifdef BENCH_REPORT_AES
+/* AES stream job of the AES benchmarks (LPC18Sxx/43Sxx parts only) */
+typedef struct {
+	CHIP_AES_OP_MODE_T mode;
+	uint8_t *dst;
+	uint8_t *src;
+} AES_CTX_T;
+
+static AES_CTX_T aesEcbEncode = {CHIP_AES_API_CMD_ENCODE_ECB, (uint8_t *) localDst, (uint8_t *) localSrc};
+static AES_CTX_T aesCbcEncode = {CHIP_AES_API_CMD_ENCODE_CBC, (uint8_t *) localDst, (uint8_t *) localSrc};
+static AES_CTX_T aesCbcDecodeInPlace = {CHIP_AES_API_CMD_DECODE_CBC, (uint8_t *) localDst, (uint8_t *) localDst};
+
+static volatile Status aesStatus;
+#endif
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* CPU memcpy */
+static uint32_t benchMemcpy(void *ctx)
+{
+	COPY_CTX_T *pCopy = (COPY_CTX_T *) ctx;
+
+	memcpy(pCopy->dst, pCopy->src, BLOCK_SIZE);
+
+	return BLOCK_SIZE;
+}
+
+/* CPU memset */
+static uint32_t benchMemset(void *ctx)
+{
+	COPY_CTX_T *pCopy = (COPY_CTX_T *) ctx;
+
+	memset(pCopy->dst, 0x5A, BLOCK_SIZE);
+
+	return BLOCK_SIZE;
+}
+
+/* Claim a channel for the GPDMA copies */
+static bool benchDmaSetup(void *ctx)
+{
+	COPY_CTX_T *pCopy = (COPY_CTX_T *) ctx;
+
+	pCopy->dma_channel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, 0);
+
+	return pCopy->dma_channel < GPDMA_NUMBER_CHANNELS;
+}
+
+/* Release the channel of the GPDMA copies */
+static void benchDmaTeardown(void *ctx)
+{
+	Chip_GPDMA_Stop(LPC_GPDMA, ((COPY_CTX_T *) ctx)->dma_channel);
+}
+
+/* GPDMA copy, completion polled */
+static uint32_t benchDmaCopy(void *ctx)
+{
+	static GPDMA_JOB_T job;
+	COPY_CTX_T *pCopy = (COPY_CTX_T *) ctx;
+
+	if (Chip_GPDMA_MemcpyAsync(LPC_GPDMA, pCopy->dma_channel, &job, pCopy->dst, pCopy->src,
+							   BLOCK_SIZE, NULL) != SUCCESS) {
+		return 0;
+	}
+	while (Chip_GPDMA_IsJobPending(LPC_GPDMA, pCopy->dma_channel)) {
+		Chip_GPDMA_JobIRQHandler(LPC_GPDMA);
+	}
+
+	return BLOCK_SIZE;
+}
+
+/* Empty the ring buffer before the passes */
+static bool benchRingSetup(void *ctx)
+{
+	RingBuffer_Init(&ringBuf, ringData, 1, sizeof(ringData));
+
+	return true;
+}
+
+/* Ring buffer, byte by byte through a quarter of the ring at a time */
+static uint32_t benchRingByte(void *ctx)
+{
+	const uint8_t *src = (const uint8_t *) localSrc;
+	uint8_t *dst = (uint8_t *) localDst;
+	int i, j;
+
+	for (i = 0; i < BLOCK_SIZE; i += sizeof(ringData) / 4) {
+		for (j = 0; j < (int) (sizeof(ringData) / 4); j++) {
+			RingBuffer_Insert(&ringBuf, &src[i + j]);
+		}
+		for (j = 0; j < (int) (sizeof(ringData) / 4); j++) {
+			RingBuffer_Pop(&ringBuf, &dst[i + j]);
+		}
+	}
+
+	return BLOCK_SIZE;
+}
+
+/* Ring buffer, blocks of a quarter of the ring */
+static uint32_t benchRingMult(void *ctx)
+{
+	const uint8_t *src = (const uint8_t *) localSrc;
+	uint8_t *dst = (uint8_t *) localDst;
+	int i, n = sizeof(ringData) / 4;
+
+	for (i = 0; i < BLOCK_SIZE; i += n) {
+		if ((RingBuffer_InsertMult(&ringBuf, &src[i], n) != n) ||
+			(RingBuffer_PopMult(&ringBuf, &dst[i], n) != n)) {
+			return 0;
+		}
+	}
+
+	return BLOCK_SIZE;
+}
+
+/* CRC-32 (IEEE 802.3) one bit at a time */
+static uint32_t benchCrcBitwise(void *ctx)
+{
+	const uint8_t *p = (const uint8_t *) localSrc;
+	uint32_t crc = 0xFFFFFFFF;
+	int i, b;
+
+	for (i = 0; i < BLOCK_SIZE; i++) {
+		crc ^= p[i];
+		for (b = 0; b < 8; b++) {
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+	}
+	localDst[0] = ~crc;
+
+	return BLOCK_SIZE;
+}
+
+/* Build the CRC-32 table */
+static bool benchCrcSetup(void *ctx)
+{
+	uint32_t c;
+	int i, b;
+
+	for (i = 0; i < 256; i++) {
+		c = i;
+		for (b = 0; b < 8; b++) {
+			c = (c >> 1) ^ (0xEDB88320 & (0 - (c & 1)));
+		}
+		crcTable[i] = c;
+	}
+
+	return true;
+}
+
+/* CRC-32 (IEEE 802.3) a byte at a time from a 1KB table */
+static uint32_t benchCrcTable(void *ctx)
+{
+	const uint8_t *p = (const uint8_t *) localSrc;
+	uint32_t crc = 0xFFFFFFFF;
+	int i;
+
+	for (i = 0; i < BLOCK_SIZE; i++) {
+		crc = crcTable[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+	}
+	localDst[0] = ~crc;
+
+	return BLOCK_SIZE;
+}
+
+/* CRC-32 through the DSP library, a word per pass */
+static uint32_t benchCrcFixDSP(void *ctx)
+{
+	localDst[0] = DSP_CRC32(0, localSrc, BLOCK_SIZE);
+
+	return BLOCK_SIZE;
+}
+
+/* Build the sliced CRC tables before the timed passes */
+static bool benchCrcSwSetup(void *ctx)
+{
+	Chip_CRCSW_Init();
+
+	return true;
+}
+
+/* CRC-32 from the sliced RAM tables, a word per table step */
+static uint32_t benchCrcSliced(void *ctx)
+{
+	localDst[0] = Chip_CRCSW_CRC32(0, localSrc, BLOCK_SIZE);
+
+	return BLOCK_SIZE;
+}
+
+/* CRC-16 from the sliced RAM tables, a halfword per table step */
+static uint32_t benchCrc16Sliced(void *ctx)
+{
+	localDst[0] = Chip_CRCSW_CRC16(CRCSW_CRC16_INIT, localSrc, BLOCK_SIZE);
+
+	return BLOCK_SIZE;
+}
+
+/* Set up the DSP filters */
+static bool benchDspSetup(void *ctx)
+{
+	DSP_FIR_Init_Q15(&fir, firCoeffs, DSP_FIR_TAPS, firState);
+	DSP_Decimate_Init_Q15(&decim, 4, firCoeffs, DSP_FIR_TAPS, decimState);
+	DSP_Biquad_Init_Q31(&biquad, 2, biquadCoeffs, biquadState, 1);
+
+	return true;
+}
+
+/* 32 tap Q15 FIR over a block of samples */
+static uint32_t benchFirQ15(void *ctx)
+{
+	DSP_FIR_Q15(&fir, (const int16_t *) localSrc, (int16_t *) localDst, BLOCK_SIZE / 2);
+
+	return BLOCK_SIZE / 2;
+}
+
+/* Decimate a block of Q15 samples by 4 through the 32 tap FIR */
+static uint32_t benchDecimateQ15(void *ctx)
+{
+	DSP_Decimate_Q15(&decim, (const int16_t *) localSrc, (int16_t *) localDst, BLOCK_SIZE / 2);
+
+	return BLOCK_SIZE / 2;
+}
+
+/* 2 stage Q31 biquad over a block of samples */
+static uint32_t benchBiquadQ31(void *ctx)
+{
+	DSP_Biquad_Q31(&biquad, (const int32_t *) localSrc, (int32_t *) localDst, BLOCK_SIZE / 4);
+
+	return BLOCK_SIZE / 4;
+}
+
+#ifdef BENCH_REPORT_AES
+/* Store the status of the AES job */
+static void benchAesDone(AES_JOB_T *pJob, Status status)
+{
+	aesStatus = status;
+}
+
+/* Start the AES engine with a software key */
+static bool benchAesSetup(void *ctx)
+{
+	static uint8_t key[AES_BLOCK_SIZE] = {
+		0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+		0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+	};
+
+	Chip_AES_Init();
+	Chip_AES_LoadKeySW(key);
+	Chip_AES_StreamInit();
+
+	return true;
+}
+
+/* One block through the AES job queue, polled */
+static uint32_t benchAes(void *ctx)
+{
+	static AES_JOB_T job;
+	AES_CTX_T *pAes = (AES_CTX_T *) ctx;
+
+	job.AesMode = pAes->mode;
+	job.pDatOut = pAes->dst;
+	job.pDatIn = pAes->src;
+	job.Size = BLOCK_SIZE / AES_BLOCK_SIZE;
+	memset(job.iv, 0, sizeof(job.iv));
+	job.callback = benchAesDone;
+	aesStatus = ERROR;
+	if (Chip_AES_SubmitJob(&job) != SUCCESS) {
+		return 0;
+	}
+	while (Chip_AES_StreamPoll()) {}
+
+	return (aesStatus == SUCCESS) ? BLOCK_SIZE : 0;
+}
+
+#endif
+
+/* The micro-benchmarks of the report */
+static const BENCH_T benchTable[] = {
+	BENCH_ENTRY("memcpy", "local_to_local", "B", benchMemcpy, &copyLocal),
+	BENCH_ENTRY("memcpy", "local_to_ahb", "B", benchMemcpy, &copyToAhb),
+	BENCH_ENTRY("memcpy", "local_to_sdram", "B", benchMemcpy, &copyToSdram),
+	BENCH_ENTRY("memcpy", "sdram_to_sdram", "B", benchMemcpy, &copySdram),
+	BENCH_ENTRY("memset", "local", "B", benchMemset, &copyLocal),
+	BENCH_ENTRY("memset", "sdram", "B", benchMemset, &copyToSdram),
+	BENCH_ENTRY_EX("gpdma", "local_to_local", "B", benchDmaCopy, benchDmaSetup, benchDmaTeardown,
+				   &copyLocal, 0, 0, 0),
+	BENCH_ENTRY_EX("gpdma", "local_to_ahb", "B", benchDmaCopy, benchDmaSetup, benchDmaTeardown,
+				   &copyToAhb, 0, 0, 0),
+	BENCH_ENTRY_EX("gpdma", "local_to_sdram", "B", benchDmaCopy, benchDmaSetup, benchDmaTeardown,
+				   &copyToSdram, 0, 0, 0),
+	BENCH_ENTRY_EX("ringbuf", "insert_pop", "B", benchRingByte, benchRingSetup, NULL, NULL, 0, 0, 0),
+	BENCH_ENTRY_EX("ringbuf", "insert_pop_mult", "B", benchRingMult, benchRingSetup, NULL, NULL, 0, 0,
+				   0),
+	BENCH_ENTRY("crc32", "bitwise", "B", benchCrcBitwise, NULL),
+	BENCH_ENTRY_EX("crc32", "table", "B", benchCrcTable, benchCrcSetup, NULL, NULL, 0, 0, 0),
+	BENCH_ENTRY("crc32", "fixdsp", "B", benchCrcFixDSP, NULL),
+	BENCH_ENTRY_EX("crc32", "sliced", "B", benchCrcSliced, benchCrcSwSetup, NULL, NULL, 0, 0, 0),
+	BENCH_ENTRY_EX("crc16", "sliced", "B", benchCrc16Sliced, benchCrcSwSetup, NULL, NULL, 0, 0, 0),
+	BENCH_ENTRY_EX("dsp", "fir_q15_32tap", "sample", benchFirQ15, benchDspSetup, NULL, NULL, 0, 0, 0),
+	BENCH_ENTRY_EX("dsp", "decimate4_q15_32tap", "sample", benchDecimateQ15, benchDspSetup, NULL, NULL,
+				   0, 0, 0),
+	BENCH_ENTRY_EX("dsp", "biquad_q31_2stage", "sample", benchBiquadQ31, benchDspSetup, NULL, NULL,
+				   0, 0, 0),
+#ifdef BENCH_REPORT_AES
+	BENCH_ENTRY_EX("aes", "ecb_encode", "B", benchAes, benchAesSetup, NULL, &aesEcbEncode, 0, 0, 0),
+	BENCH_ENTRY_EX("aes", "cbc_encode", "B", benchAes, benchAesSetup, NULL, &aesCbcEncode, 0, 0, 0),
+	BENCH_ENTRY_EX("aes", "cbc_decode_in_place", "B", benchAes, benchAesSetup, NULL,
+				   &aesCbcDecodeInPlace, 0, 0, 0),
+#endif
+};
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Main entry point
+ * @return	Nothing
+ */
+int main(void)
+{
+	int i, failed;
+
+	SystemCoreClockUpdate();
+	Board_Init();
+
+	/* GPDMA copies are polled */
+	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_DisableIRQ(DMA_IRQn);
+
+	for (i = 0; i < BLOCK_SIZE / 4; i++) {
+		localSrc[i] = i * 0x9E3779B9;
+	}
+	memcpy(SDRAM_BUF, localSrc, BLOCK_SIZE);
+
+	Bench_Init(BENCH_REPORT_FORMAT, NULL);
+	Bench_ReportBegin(BENCH_REPORT_TITLE);
+	failed = BENCH_RUN_TABLE(benchTable);
+	Bench_ReportEnd();
+
+	if (failed) {
+		DEBUGOUT("%d benchmarks failed\r\n", failed);
+	}
+
+	while (1) {}
+}
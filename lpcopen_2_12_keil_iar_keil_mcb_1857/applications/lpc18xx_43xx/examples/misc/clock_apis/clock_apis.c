@@ -33,6 +33,7 @@
 #include <string.h>
 #include "board.h"
 #include "chip.h"
+#include "stopwatch.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -183,6 +184,17 @@ static CCUCLK_INFO_T ccu_clk_info[] = {
 	{CLK_APB2_SDIO, "SDIO", },
 };
 
+/* Core clock steps of the scaling demo: idle on the crystal, then full
+   speed through the ramp step, then the ramp rate itself */
+static const uint32_t dvfs_steps[] = {
+	12000000, MAX_CLOCK_FREQ, 12000000, DVFS_RAMP_FREQ_LIMIT, MAX_CLOCK_FREQ
+};
+
+#if defined(DEBUG_UART)
+static CHIP_DVFS_NOTIFIER_T uartNotifier;
+#endif
+static CHIP_DVFS_NOTIFIER_T stopWatchNotifier;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -204,6 +216,7 @@ int main(void)
 	bool bool_status;
 	uint32_t mainpll_freq, clkin_frq, dive_value, baseclk_frq, perclk_frq;
 	CHIP_CGU_CLKIN_T clk_in, base_input;
+	uint32_t core_frq, start, elapsed;
 	bool autoblocken;
 	bool powerdn;
 	int i;
@@ -318,6 +331,33 @@ int main(void)
 	}
 	DEBUGOUT("=========================================== \r\n");
 
+	/*
+	 * Scale the core clock down to the crystal and back up. The debug UART
+	 * and the StopWatch are registered for clock change notification, so
+	 * the console keeps its baud rate at either speed.
+	 */
+#if defined(DEBUG_UART)
+	Chip_DVFS_RegisterUART(&uartNotifier, DEBUG_UART, 115200);
+#endif
+	StopWatch_Init();
+	Chip_DVFS_RegisterStopWatch(&stopWatchNotifier);
+
+	DEBUGOUT("=========================================== \r\n");
+	DEBUGOUT("Core clock scaling \r\n");
+	DEBUGOUT("=========================================== \r\n");
+	for (i = 0; i < (sizeof(dvfs_steps) / sizeof(dvfs_steps[0])); i++) {
+		start = StopWatch_Start();
+		core_frq = Chip_DVFS_SetCoreClock(CLKIN_CRYSTAL, dvfs_steps[i]);
+		elapsed = StopWatch_TicksToUs(StopWatch_Elapsed(start));
+		if (core_frq == 0) {
+			DEBUGOUT("Core clock %d Hz not reachable \r\n", dvfs_steps[i]);
+			return 5;
+		}
+		DEBUGOUT("Core %d Hz, Main PLL %s, switch %d us \r\n", core_frq,
+				 Chip_Clock_MainPLLLocked() ? "on" : "off", elapsed);
+	}
+	DEBUGOUT("=========================================== \r\n");
+
 	while (k) ;
 
 	return 0;
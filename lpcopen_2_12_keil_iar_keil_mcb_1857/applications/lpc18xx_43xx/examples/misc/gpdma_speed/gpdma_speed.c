@@ -31,23 +31,71 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
 #include "board.h"
+#include "bench.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
  ****************************************************************************/
 
-/* Data transfer information */
-#define TRANSFER_DST_ADDR          0x28500000
-#define TRANSFER_SRC_ADDR          0x28100000
-#define TRANSFER_SIZE              0x200000
+/* Bytes moved by each run, the lower half of a region is the source and
+   the upper half the destination, so every region holds twice this */
+#define TRANSFER_SIZE              (8 * 1024)
 
-#define TRANSFER_BLOCK_SZ          (4 * 3 * 1024) /* 3K of data transfered per LLI */
-#define DMA_DESCRIPTOR_COUNT       256
+/* Bytes per descriptor, at most 0xFFF transfers of any width */
+#define TRANSFER_BLOCK_SZ          1024
+#define DMA_DESCRIPTOR_COUNT       (TRANSFER_SIZE / TRANSFER_BLOCK_SZ)
+
+/* Timed runs of each case, after one warmup run */
+#define TRANSFER_PASSES            8
+
+/* Memory regions of the matrix, kept clear of the 0x10000000 IRAM the
+   example runs in. SPIFI is only readable once the SPIFI controller is in
+   memory mode (for example when booting from it), define GPDMA_SPEED_SPIFI
+   to use it as a source. */
+typedef struct {
+	const char *name;
+	uint32_t base;
+	bool read_only;
+} XFER_REGION_T;
+
+static const XFER_REGION_T regions[] = {
+	{"local_sram", 0x10080000, false},
+	{"ahb_sram", 0x2000C000, false},
+	{"sdram", 0x28100000, false},
+#if defined(GPDMA_SPEED_SPIFI)
+	{"spifi", 0x14000000, true},
+#endif
+};
+
+/* Transfer widths and burst sizes tried, as GPDMA_WIDTH_x/GPDMA_BSIZE_x and in units */
+typedef struct {
+	uint8_t code;
+	uint8_t units;
+} XFER_PARAM_T;
+
+static const XFER_PARAM_T widths[] = {
+	{GPDMA_WIDTH_BYTE, 8}, {GPDMA_WIDTH_HALFWORD, 16}, {GPDMA_WIDTH_WORD, 32},
+};
+
+static const XFER_PARAM_T bursts[] = {
+	{GPDMA_BSIZE_1, 1}, {GPDMA_BSIZE_4, 4}, {GPDMA_BSIZE_8, 8}, {GPDMA_BSIZE_16, 16},
+	{GPDMA_BSIZE_32, 32},
+};
+
+/* Transfer timed by the harness */
+typedef struct {
+	uint32_t src;
+	uint32_t dst;
+	const XFER_PARAM_T *width;	/* NULL for the CPU memcpy */
+	bool link;
+	int num_desc;
+} XFER_CASE_T;
 
 static uint8_t ch_no;
 static DMA_TransferDescriptor_t desc_array[DMA_DESCRIPTOR_COUNT];
-static volatile int dma_xfer_complete;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -63,102 +111,152 @@ static void prepare_src_data(uint32_t *src, int sz)
 	}
 }
 
-/* Function to prepare memory to memory transfer descriptors */
-static int prepare_dma_desc(uint32_t* dst, const uint32_t* src, uint32_t sz)
+/* Function to prepare memory to memory transfer descriptors, chained for
+   a linked list transfer or each ending the transfer for single ones */
+static int prepare_dma_desc(uint32_t dst, uint32_t src, uint32_t sz, uint32_t width, uint32_t burst,
+							bool link)
 {
-	int i;
-	DMA_TransferDescriptor_t *desc;
-	int num_desc = sz / TRANSFER_BLOCK_SZ;
-
-	/* Add one more if size is not in 3K blocks */
-	num_desc += sz * TRANSFER_BLOCK_SZ != sz;
-	desc = &desc_array[0];
-	if (num_desc >= DMA_DESCRIPTOR_COUNT) {
-		DEBUGOUT("Transfer needs %d descriptors, but has "
-			"%d descriptors only\r\n", num_desc, DMA_DESCRIPTOR_COUNT);
-		return 0;
-	}
+	int i, num_desc = sz / TRANSFER_BLOCK_SZ;
+	uint32_t ctrl;
+
+	ctrl = GPDMA_DMACCxControl_SBSize(burst) | GPDMA_DMACCxControl_DBSize(burst)
+		   | GPDMA_DMACCxControl_SWidth(width) | GPDMA_DMACCxControl_DWidth(width)
+		   | GPDMA_DMACCxControl_SI | GPDMA_DMACCxControl_DI
+		   | GPDMA_DMACCxControl_TransferSize(TRANSFER_BLOCK_SZ >> width);
 
-	for (i = 0; i < num_desc; i ++)
-	{
-		Chip_GPDMA_PrepareDescriptor(LPC_GPDMA, &desc[i],
-			(uint32_t) src + (i * TRANSFER_BLOCK_SZ),
-			(uint32_t) dst + (i * TRANSFER_BLOCK_SZ),
-			(uint32_t) (sz < TRANSFER_BLOCK_SZ ? sz : TRANSFER_BLOCK_SZ),
-			GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA,
-			(i + 1 == num_desc) ? NULL: &desc[i + 1]);
-		sz -= TRANSFER_BLOCK_SZ;
+	for (i = 0; i < num_desc; i++) {
+		desc_array[i].src = src + (i * TRANSFER_BLOCK_SZ);
+		desc_array[i].dst = dst + (i * TRANSFER_BLOCK_SZ);
+		desc_array[i].lli = (link && (i + 1 < num_desc)) ? (uint32_t) &desc_array[i + 1] : 0;
+		desc_array[i].ctrl = ctrl | ((desc_array[i].lli == 0) ? GPDMA_DMACCxControl_I : 0);
 	}
 	return num_desc;
 }
 
-/* Print the result of a data transfer */
-static void print_result(const void *dst, const void *src, int sz, uint32_t stime, uint32_t etime, const char *mode)
+/* Start a prepared descriptor and poll the channel until it has stopped */
+static bool run_dma_desc(const DMA_TransferDescriptor_t *desc)
 {
-	uint32_t clk = SystemCoreClock/1000000;
-	int invalid;
-	invalid = memcmp(dst, src, sz);
-	DEBUGOUT("\r\nData transfer results [MODE: %s]\r\n"
-		"=========================================\r\n", mode);
-	DEBUGOUT("SOURCE  ADDR: 0x%08X\r\n", src);
-	DEBUGOUT("DESTN   ADDR: 0x%08X\r\n", dst);
-	DEBUGOUT("XFER    SIZE: %lu (Bytes)\r\n", sz);
-	DEBUGOUT("CPU    SPEED: %lu.%lu (MHz)\r\n", clk, (SystemCoreClock / 10000) - (clk * 100));
-	DEBUGOUT("START   TIME: %lu (ticks)\r\n", stime);
-	DEBUGOUT("END     TIME: %lu (ticks)\r\n", etime);
-	DEBUGOUT("TIME   TAKEN: %lu (uSec(s))\r\n", (etime - stime) / clk);
-	DEBUGOUT("SRC/DST COMP: %s\r\n", invalid ? "NOT MATCHING" : "MATCHING");
+	if (Chip_GPDMA_SGTransfer(LPC_GPDMA, ch_no, desc, GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA) != SUCCESS) {
+		return false;
+	}
+	while (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_ENABLED_CH, ch_no)) {}
+	Chip_GPDMA_ClearIntPending(LPC_GPDMA, GPDMA_STATCLR_INTTC, ch_no);
+	if (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_RAWINTERR, ch_no)) {
+		Chip_GPDMA_ClearIntPending(LPC_GPDMA, GPDMA_STATCLR_INTERR, ch_no);
+		return false;
+	}
+	return true;
 }
-/*****************************************************************************
- * Public functions
- ****************************************************************************/
 
-/**
- * @brief	RIT interrupt handler
- * @return	Nothing
- */
-void DMA_IRQHandler(void)
+/* One run of the transfer of the current case */
+static uint32_t run_transfer(void *ctx)
 {
-	dma_xfer_complete = 1;
-	Chip_GPDMA_Interrupt(LPC_GPDMA, ch_no);
+	XFER_CASE_T *pCase = (XFER_CASE_T *) ctx;
+	int i;
+
+	if (!pCase->width) {
+		memcpy((void *) pCase->dst, (const void *) pCase->src, TRANSFER_SIZE);
+	}
+	else if (pCase->link) {
+		if (!run_dma_desc(&desc_array[0])) {
+			return 0;
+		}
+	}
+	else {
+		for (i = 0; i < pCase->num_desc; i++) {
+			if (!run_dma_desc(&desc_array[i])) {
+				return 0;
+			}
+		}
+	}
+
+	return TRANSFER_SIZE;
+}
+
+/* Run one case through the benchmark harness and report it */
+static void print_result(const XFER_REGION_T *sreg, const XFER_REGION_T *dreg, const char *mode,
+						 const XFER_PARAM_T *width, const XFER_PARAM_T *burst, bool link)
+{
+	static char name[48];
+	XFER_CASE_T xfer;
+	BENCH_T bench;
+	BENCH_RESULT_T result;
+
+	memset(&bench, 0, sizeof(bench));
+	bench.group = mode;
+	bench.name = name;
+	bench.unit = "B";
+	bench.run = run_transfer;
+	bench.ctx = &xfer;
+	bench.warmup = 1;
+	bench.reps = TRANSFER_PASSES;
+	xfer.src = sreg->base;
+	xfer.dst = dreg->base + TRANSFER_SIZE;
+	xfer.width = width;
+	xfer.link = link;
+	xfer.num_desc = 0;
+	if (width) {
+		xfer.num_desc = prepare_dma_desc(xfer.dst, xfer.src, TRANSFER_SIZE, width->code, burst->code, link);
+		sprintf(name, "%s_to_%s_w%d_b%d", sreg->name, dreg->name, width->units, burst->units);
+	}
+	else {
+		sprintf(name, "%s_to_%s", sreg->name, dreg->name);
+	}
+
+	memset((void *) xfer.dst, 0, TRANSFER_SIZE);
+	if (Bench_Run(&bench, &result) &&
+		(memcmp((const void *) xfer.dst, (const void *) xfer.src, TRANSFER_SIZE) != 0)) {
+		result.ok = false;
+	}
+	Bench_Emit(bench.group, bench.name, bench.unit, &result);
 }
 
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
 /**
  * @brief	Main entry point
  * @return	Nothing
  */
 int main(void)
 {
-	uint32_t start_time;
-	uint32_t end_time;
-	uint32_t *dst = (uint32_t *) TRANSFER_DST_ADDR;
-	uint32_t *src = (uint32_t *) TRANSFER_SRC_ADDR;
+	int s, d, w, b;
 
 	SystemCoreClockUpdate();
 	Board_Init();
 
-	/* Initialize the DMA */
+	/* Initialize the DMA, completion is polled */
 	Chip_GPDMA_Init(LPC_GPDMA);
-
-	/* Prepare the source buffer for transfer */
-	prepare_src_data(src, TRANSFER_SIZE/sizeof(*src));
-	DEBUGSTR("***** DATA TRANSFER TEST *******\r\n");
-	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
-	memcpy(dst, src, TRANSFER_SIZE);
-	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
-	print_result(dst, src, TRANSFER_SIZE, start_time, end_time, "CPU (memcpy)");
-	memset(dst, 0, TRANSFER_SIZE);
+	NVIC_DisableIRQ(DMA_IRQn);
 	ch_no = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, 0);
-	if (prepare_dma_desc(dst, src, TRANSFER_SIZE) <= 0) {
-		DEBUGSTR("Unable to create DMA Descriptors\r\n");
-		while (1) {}
+
+	/* Results go out as CSV lines */
+	Bench_Init(BENCH_FORMAT_CSV, NULL);
+
+	/* Prepare the source buffers for transfer */
+	for (s = 0; s < (int) NELEMENTS(regions); s++) {
+		if (!regions[s].read_only) {
+			prepare_src_data((uint32_t *) regions[s].base, TRANSFER_SIZE / sizeof(uint32_t));
+		}
 	}
-	start_time = Chip_RIT_GetCounter(LPC_RITIMER);
-	Chip_GPDMA_SGTransfer(LPC_GPDMA, ch_no, &desc_array[0], GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA);
-	NVIC_EnableIRQ(DMA_IRQn);
-	while(!dma_xfer_complete); /* Set by ISR */
-	end_time = Chip_RIT_GetCounter(LPC_RITIMER);
-	print_result(dst, src, TRANSFER_SIZE, start_time, end_time, "DMA");
-	/* LED is toggled in interrupt handler */
+
+	Bench_ReportBegin("GPDMA speed, 8KB transfers");
+	for (s = 0; s < (int) NELEMENTS(regions); s++) {
+		for (d = 0; d < (int) NELEMENTS(regions); d++) {
+			if (regions[d].read_only) {
+				continue;
+			}
+			print_result(&regions[s], &regions[d], "cpu_memcpy", NULL, NULL, false);
+			for (w = 0; w < (int) NELEMENTS(widths); w++) {
+				for (b = 0; b < (int) NELEMENTS(bursts); b++) {
+					print_result(&regions[s], &regions[d], "dma_single", &widths[w], &bursts[b], false);
+					print_result(&regions[s], &regions[d], "dma_lli", &widths[w], &bursts[b], true);
+				}
+			}
+		}
+	}
+	Bench_ReportEnd();
+
 	while (1) {}
 }
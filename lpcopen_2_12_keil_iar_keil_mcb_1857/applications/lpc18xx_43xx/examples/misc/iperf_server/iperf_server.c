@@ -1,18 +1,139 @@
+#include <string.h>
+
 #include "lwip/debug.h"
 #include "lwip/stats.h"
 #include "lwip/tcp.h"
+#include "lwip/udp.h"
+#include "lwip/timers.h"
+#include "lwip/sys.h"
+#include "board.h"
+#include "stopwatch.h"
+#include "iperf_server.h"
 
 /*---------------------------------------------------------------------------*/
 /* local defines                                                                                                                 */
 /*---------------------------------------------------------------------------*/
-#define IPERF_SERVER_PORT 5001
+/* iperf 2 client header flags */
+#define HEADER_VERSION1 0x80000000
+#define RUN_NOW         0x00000001
+
+/* iperf defaults when the header leaves a field at 0 */
+#define IPERF_DEFAULT_TIME  1000     /* 10 s in 10 ms units */
+#define IPERF_DEFAULT_RATE  1000000  /* UDP, bits/s */
+
+/* Datagram size limit so each UDP test packet fits one ethernet frame */
+#define IPERF_UDP_BUFLEN    1470
+
+/* Most datagrams sent per 1 ms transmit tick while catching up on the rate */
+#define IPERF_UDP_BURST     8
+
+/* Final UDP datagram retries and spacing while waiting for the server report */
+#define IPERF_UDP_FIN_TRIES 10
+#define IPERF_UDP_FIN_MS    250
+
+/* A UDP receive test with no traffic for this long is ended without a FIN */
+#define IPERF_UDP_IDLE_US   (10 * 1000000ULL)
 
 /*---------------------------------------------------------------------------*/
 /* local data                                                                                                                    */
 /*---------------------------------------------------------------------------*/
-#if LWIP_TCP
+#if LWIP_TCP && LWIP_UDP
+
+/* Header at the start of every iperf 2 UDP datagram */
+struct iperf_udp_datagram
+{
+  s32_t id;
+  u32_t tv_sec;
+  u32_t tv_usec;
+};
+
+/* Test settings the client sends at the start of the stream (TCP) or after
+   the datagram header (UDP) when it asks for a -d or -r test */
+struct iperf_client_hdr
+{
+  s32_t flags;
+  s32_t num_threads;
+  s32_t port;
+  s32_t buffer_len;
+  s32_t win_band;
+  s32_t amount;
+};
+
+/* Report the UDP server returns in answer to the final datagram */
+struct iperf_server_hdr
+{
+  s32_t flags;
+  s32_t total_len1;
+  s32_t total_len2;
+  s32_t stop_sec;
+  s32_t stop_usec;
+  s32_t error_cnt;
+  s32_t outorder_cnt;
+  s32_t datagrams;
+  s32_t jitter1;
+  s32_t jitter2;
+};
+
+enum iperf_kinds
+{
+  IPERF_FREE = 0,
+  IPERF_TCP_RX,
+  IPERF_TCP_TX,
+  IPERF_UDP_RX,
+  IPERF_UDP_TX
+};
+
+/* One measurement, in either direction. Kept in a static table so the
+   interval report timer can walk all running tests. */
+struct iperf_session
+{
+  u8_t kind;
+  u8_t num;
+  u8_t done;
+  u8_t fin_tries;
+  ip_addr_t remote;
+  u16_t port;
+  u16_t buf_len;
+  uint64_t start_us;
+  uint64_t last_us;
+  uint64_t bytes;
+  /* values at the previous interval report */
+  uint64_t rep_us;
+  uint64_t rep_bytes;
+  u32_t rep_packets;
+  u32_t rep_lost;
+  /* transmit limits, time or byte count */
+  uint64_t end_us;
+  uint64_t limit;
+  u32_t rate;
+  /* UDP sequence and RFC 1889 jitter (in us, scaled by 16) */
+  s32_t last_id;
+  u32_t packets;
+  u32_t lost;
+  u32_t outorder;
+  u32_t jitter16;
+  u32_t last_transit;
+  /* -r test waiting for this one to finish */
+  u8_t tradeoff;
+  struct iperf_client_hdr hdr;
+  struct tcp_pcb *tpcb;
+  struct udp_pcb *upcb;
+};
 
 static struct tcp_pcb *iperf_pcb;
+static struct udp_pcb *iperf_udp_pcb;
+
+static struct iperf_session iperf_sessions[IPERF_MAX_SESSIONS];
+static u8_t iperf_num;
+
+/* Constant payload for both transmit modes. TCP queues it without a copy
+   and UDP references it from a PBUF_REF, so the data is never touched by
+   the CPU when the checksums are offloaded to the MAC. */
+static u8_t iperf_tx_buf[TCP_MSS > IPERF_UDP_BUFLEN ? TCP_MSS : IPERF_UDP_BUFLEN];
+
+/* 64-bit microsecond clock built on the stopwatch timer */
+static u32_t iperf_ticks;
+static uint64_t iperf_ticks_total;
 
 enum iperfserver_states
 {
@@ -29,6 +150,10 @@ struct iperfserver_state
   struct tcp_pcb *pcb;
   /* pbuf (chain) to recycle */
   struct pbuf *p;
+  /* measurement and the client header collected from the stream */
+  struct iperf_session *s;
+  u8_t hdr_len;
+  struct iperf_client_hdr hdr;
 };
 
 /*---------------------------------------------------------------------------*/
@@ -40,10 +165,663 @@ static void iperfserver_error(void *arg, err_t err);
 static err_t iperfserver_sent(void *arg, struct tcp_pcb *tpcb, u16_t len);
 static void iperfserver_send(struct tcp_pcb *tpcb, struct iperfserver_state *es);
 static void iperfserver_close(struct tcp_pcb *tpcb, struct iperfserver_state *es);
+static void iperf_udp_recv(void *arg, struct udp_pcb *upcb, struct pbuf *p, ip_addr_t *addr, u16_t port);
+static void iperf_udp_client_recv(void *arg, struct udp_pcb *upcb, struct pbuf *p, ip_addr_t *addr, u16_t port);
+static err_t iperf_tcp_connected(void *arg, struct tcp_pcb *tpcb, err_t err);
+static err_t iperf_tcp_tx_sent(void *arg, struct tcp_pcb *tpcb, u16_t len);
+static void iperf_tcp_tx_error(void *arg, err_t err);
+static void iperf_udp_tx_tick(void *arg);
+static void iperf_report_tick(void *arg);
+
+static uint64_t
+iperf_now_us(void)
+{
+  u32_t ticks = StopWatch_Start();
+  u32_t tps = StopWatch_TicksPerSecond();
+
+  /* Called at least once per report interval, well inside the timer wrap */
+  iperf_ticks_total += (u32_t)(ticks - iperf_ticks);
+  iperf_ticks = ticks;
+  return (iperf_ticks_total / tps) * 1000000ULL +
+         ((iperf_ticks_total % tps) * 1000000ULL) / tps;
+}
+
+static struct iperf_session *
+iperf_session_alloc(u8_t kind, ip_addr_t *remote, u16_t port)
+{
+  struct iperf_session *s = NULL;
+  int i;
+
+  /* Prefer a free slot, else reuse a finished UDP receive test that was
+     only kept to answer repeated final datagrams */
+  for (i = 0; i < IPERF_MAX_SESSIONS; i++)
+  {
+    if (iperf_sessions[i].kind == IPERF_FREE)
+    {
+      s = &iperf_sessions[i];
+      break;
+    }
+    if ((s == NULL) && iperf_sessions[i].done && (iperf_sessions[i].kind == IPERF_UDP_RX))
+    {
+      s = &iperf_sessions[i];
+    }
+  }
+  if (s != NULL)
+  {
+    memset(s, 0, sizeof(*s));
+    s->kind = kind;
+    s->num = ++iperf_num;
+    ip_addr_copy(s->remote, *remote);
+    s->port = port;
+    s->last_id = -1;
+    s->start_us = s->last_us = s->rep_us = iperf_now_us();
+  }
+  return s;
+}
+
+static void
+iperf_session_free(struct iperf_session *s)
+{
+  s->kind = IPERF_FREE;
+}
+
+static void
+iperf_report(struct iperf_session *s, uint64_t from, uint64_t to, uint64_t bytes,
+             u32_t packets, u32_t lost, u8_t final)
+{
+  uint64_t t0 = from - s->start_us;
+  uint64_t t1 = to - s->start_us;
+  uint64_t dur = to - from;
+  u32_t kbps = (dur != 0) ? (u32_t)((bytes * 8000ULL) / dur) : 0;
+
+  DEBUGOUT("[%u] %s %lu.%02lu-%lu.%02lu sec %6lu KBytes %6lu Kbits/sec",
+           s->num,
+           (s->kind == IPERF_TCP_RX) ? "TCP RX" : (s->kind == IPERF_TCP_TX) ? "TCP TX" :
+           (s->kind == IPERF_UDP_RX) ? "UDP RX" : "UDP TX",
+           (unsigned long)(t0 / 1000000), (unsigned long)((t0 % 1000000) / 10000),
+           (unsigned long)(t1 / 1000000), (unsigned long)((t1 % 1000000) / 10000),
+           (unsigned long)(bytes / 1024), (unsigned long)kbps);
+  if (s->kind == IPERF_UDP_RX)
+  {
+    u32_t jitter = s->jitter16 >> 4;
+
+    DEBUGOUT(" %lu.%03lu ms %lu/%lu (%lu%%)",
+             (unsigned long)(jitter / 1000), (unsigned long)(jitter % 1000),
+             (unsigned long)lost, (unsigned long)packets,
+             (unsigned long)((packets != 0) ? (lost * 100) / packets : 0));
+    if (final && (s->outorder != 0))
+    {
+      DEBUGOUT(" %lu out-of-order", (unsigned long)s->outorder);
+    }
+  }
+  else if (s->kind == IPERF_UDP_TX)
+  {
+    DEBUGOUT(" %lu datagrams", (unsigned long)packets);
+  }
+  DEBUGOUT("\r\n");
+}
+
+/* Reports the whole test and stops interval reporting for it */
+static void
+iperf_session_end(struct iperf_session *s)
+{
+  if (!s->done)
+  {
+    s->done = 1;
+    iperf_report(s, s->start_us, s->last_us, s->bytes, s->packets, s->lost, 1);
+  }
+}
+
+static void
+iperf_tx_setup(struct iperf_session *s, s32_t amount)
+{
+  if (amount == 0)
+  {
+    amount = -IPERF_DEFAULT_TIME;
+  }
+  if (amount < 0)
+  {
+    s->end_us = s->start_us + (uint64_t)(-amount) * 10000ULL;
+  }
+  else
+  {
+    s->limit = (uint64_t)amount;
+  }
+}
+
+static u8_t
+iperf_tx_finished(struct iperf_session *s, uint64_t now)
+{
+  if (s->limit != 0)
+  {
+    return s->bytes >= s->limit;
+  }
+  return now >= s->end_us;
+}
+
+static err_t
+iperf_tcp_client_start(ip_addr_t *addr, u16_t port, u16_t buf_len, s32_t amount)
+{
+  struct iperf_session *s;
+  struct tcp_pcb *pcb;
+
+  s = iperf_session_alloc(IPERF_TCP_TX, addr, port);
+  if (s == NULL)
+  {
+    return ERR_MEM;
+  }
+  pcb = tcp_new();
+  if (pcb == NULL)
+  {
+    iperf_session_free(s);
+    return ERR_MEM;
+  }
+  s->tpcb = pcb;
+  s->buf_len = ((buf_len == 0) || (buf_len > TCP_MSS)) ? TCP_MSS : buf_len;
+  s->limit = (amount > 0) ? (uint64_t)amount : 0;
+  s->hdr.amount = amount;
+  tcp_arg(pcb, s);
+  tcp_err(pcb, iperf_tcp_tx_error);
+  tcp_sent(pcb, iperf_tcp_tx_sent);
+  return tcp_connect(pcb, addr, port, iperf_tcp_connected);
+}
+
+static err_t
+iperf_udp_client_start(ip_addr_t *addr, u16_t port, u16_t buf_len, u32_t rate, s32_t amount)
+{
+  struct iperf_session *s;
+  struct udp_pcb *pcb;
+
+  s = iperf_session_alloc(IPERF_UDP_TX, addr, port);
+  if (s == NULL)
+  {
+    return ERR_MEM;
+  }
+  pcb = udp_new();
+  if (pcb == NULL)
+  {
+    iperf_session_free(s);
+    return ERR_MEM;
+  }
+  s->upcb = pcb;
+  if ((buf_len < sizeof(struct iperf_udp_datagram) + sizeof(struct iperf_server_hdr)) ||
+      (buf_len > IPERF_UDP_BUFLEN))
+  {
+    buf_len = IPERF_UDP_BUFLEN;
+  }
+  s->buf_len = buf_len;
+  s->rate = (rate != 0) ? rate : IPERF_DEFAULT_RATE;
+  iperf_tx_setup(s, amount);
+  udp_recv(pcb, iperf_udp_client_recv, s);
+  sys_timeout(1, iperf_udp_tx_tick, s);
+  return ERR_OK;
+}
+
+/* Starts the reverse direction of a -d or -r test. Takes copies, the
+   session the settings came from may be reused for the new test. */
+static void
+iperf_start_reverse(ip_addr_t remote, struct iperf_client_hdr hdr, u8_t udp)
+{
+  ip_addr_t *addr = &remote;
+  u16_t port = (u16_t)ntohl(hdr.port);
+  u16_t buf_len = (u16_t)ntohl(hdr.buffer_len);
+  s32_t amount = (s32_t)ntohl(hdr.amount);
+  err_t err;
+
+  if (udp)
+  {
+    err = iperf_udp_client_start(addr, port, buf_len, ntohl(hdr.win_band), amount);
+  }
+  else
+  {
+    err = iperf_tcp_client_start(addr, port, buf_len, amount);
+  }
+  if (err != ERR_OK)
+  {
+    DEBUGOUT("iperf: reverse test not started (%d)\r\n", err);
+  }
+}
+
+/* Acts on a client header: dual test now, tradeoff test at the end */
+static void
+iperf_client_hdr_check(struct iperf_session *s, const struct iperf_client_hdr *hdr, u8_t udp)
+{
+  u32_t flags = ntohl(hdr->flags);
+
+  if (flags & HEADER_VERSION1)
+  {
+    if (flags & RUN_NOW)
+    {
+      iperf_start_reverse(s->remote, *hdr, udp);
+    }
+    else
+    {
+      s->tradeoff = 1;
+      s->hdr = *hdr;
+    }
+  }
+}
+
+/* Sends the queued stream data until the send buffer is full */
+static void
+iperf_tcp_tx_fill(struct iperf_session *s, struct tcp_pcb *tpcb)
+{
+  uint64_t now = iperf_now_us();
+  err_t err;
+
+  while (!iperf_tx_finished(s, now) && (tcp_sndqueuelen(tpcb) < TCP_SND_QUEUELEN))
+  {
+    u16_t len = LWIP_MIN(tcp_sndbuf(tpcb), s->buf_len);
+
+    if (s->limit != 0)
+    {
+      len = (u16_t)LWIP_MIN((uint64_t)len, s->limit - s->bytes);
+    }
+    if (len == 0)
+    {
+      break;
+    }
+    err = tcp_write(tpcb, iperf_tx_buf, len, 0);
+    if (err != ERR_OK)
+    {
+      break;
+    }
+    s->bytes += len;
+  }
+  s->last_us = now;
+  tcp_output(tpcb);
+
+  if (iperf_tx_finished(s, now))
+  {
+    /* FIN follows the queued data */
+    tcp_arg(tpcb, NULL);
+    tcp_sent(tpcb, NULL);
+    tcp_err(tpcb, NULL);
+    if (tcp_close(tpcb) != ERR_OK)
+    {
+      tcp_abort(tpcb);
+    }
+    s->tpcb = NULL;
+    iperf_session_end(s);
+    iperf_session_free(s);
+  }
+}
+
+static err_t
+iperf_tcp_connected(void *arg, struct tcp_pcb *tpcb, err_t err)
+{
+  struct iperf_session *s = (struct iperf_session *)arg;
+
+  LWIP_UNUSED_ARG(err);
+
+  s->start_us = s->rep_us = iperf_now_us();
+  iperf_tx_setup(s, s->hdr.amount);
+  DEBUGOUT("[%u] TCP TX connected to port %u\r\n", s->num, s->port);
+  iperf_tcp_tx_fill(s, tpcb);
+  return ERR_OK;
+}
+
+static err_t
+iperf_tcp_tx_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
+{
+  LWIP_UNUSED_ARG(len);
+
+  if (arg != NULL)
+  {
+    iperf_tcp_tx_fill((struct iperf_session *)arg, tpcb);
+  }
+  return ERR_OK;
+}
+
+static void
+iperf_tcp_tx_error(void *arg, err_t err)
+{
+  struct iperf_session *s = (struct iperf_session *)arg;
+
+  if (s != NULL)
+  {
+    DEBUGOUT("[%u] TCP TX error %d\r\n", s->num, err);
+    s->tpcb = NULL;
+    iperf_session_end(s);
+    iperf_session_free(s);
+  }
+}
+
+/* Sends one UDP test datagram, a negative id marks the end of the test */
+static err_t
+iperf_udp_tx_datagram(struct iperf_session *s, s32_t id, uint64_t now)
+{
+  struct iperf_udp_datagram *dg;
+  struct pbuf *hdr, *body;
+  err_t err;
+
+  hdr = pbuf_alloc(PBUF_TRANSPORT, sizeof(*dg), PBUF_RAM);
+  if (hdr == NULL)
+  {
+    return ERR_MEM;
+  }
+  body = pbuf_alloc(PBUF_RAW, s->buf_len - sizeof(*dg), PBUF_REF);
+  if (body == NULL)
+  {
+    pbuf_free(hdr);
+    return ERR_MEM;
+  }
+  body->payload = iperf_tx_buf;
+  pbuf_cat(hdr, body);
+
+  dg = (struct iperf_udp_datagram *)hdr->payload;
+  dg->id = htonl(id);
+  dg->tv_sec = htonl((u32_t)(now / 1000000));
+  dg->tv_usec = htonl((u32_t)(now % 1000000));
+  err = udp_sendto(s->upcb, hdr, &s->remote, s->port);
+  pbuf_free(hdr);
+  return err;
+}
+
+static void
+iperf_udp_tx_end(struct iperf_session *s)
+{
+  sys_untimeout(iperf_udp_tx_tick, s);
+  udp_remove(s->upcb);
+  s->upcb = NULL;
+  iperf_session_free(s);
+}
+
+static void
+iperf_udp_tx_tick(void *arg)
+{
+  struct iperf_session *s = (struct iperf_session *)arg;
+  uint64_t now = iperf_now_us();
+
+  if (!s->done)
+  {
+    /* Datagrams due so far at the requested rate */
+    uint64_t due = ((now - s->start_us) * s->rate) / (8ULL * s->buf_len * 1000000ULL) + 1;
+    int burst = 0;
+
+    while (!iperf_tx_finished(s, now) && (s->packets < due) && (burst < IPERF_UDP_BURST))
+    {
+      if (iperf_udp_tx_datagram(s, (s32_t)s->packets, now) != ERR_OK)
+      {
+        break;
+      }
+      s->packets++;
+      s->bytes += s->buf_len;
+      burst++;
+    }
+    s->last_us = now;
+    if (!iperf_tx_finished(s, now))
+    {
+      sys_timeout(1, iperf_udp_tx_tick, s);
+      return;
+    }
+    iperf_session_end(s);
+  }
+
+  /* Repeat the final datagram until the server reports back */
+  if (s->fin_tries++ < IPERF_UDP_FIN_TRIES)
+  {
+    iperf_udp_tx_datagram(s, -(s32_t)s->packets, now);
+    sys_timeout(IPERF_UDP_FIN_MS, iperf_udp_tx_tick, s);
+  }
+  else
+  {
+    DEBUGOUT("[%u] UDP TX no server report\r\n", s->num);
+    iperf_udp_tx_end(s);
+  }
+}
+
+/* Receives the server report for a UDP transmit test */
+static void
+iperf_udp_client_recv(void *arg, struct udp_pcb *upcb, struct pbuf *p, ip_addr_t *addr, u16_t port)
+{
+  struct iperf_session *s = (struct iperf_session *)arg;
+  struct iperf_server_hdr rep;
+
+  LWIP_UNUSED_ARG(upcb);
+  LWIP_UNUSED_ARG(addr);
+  LWIP_UNUSED_ARG(port);
+
+  if (s->done &&
+      (pbuf_copy_partial(p, &rep, sizeof(rep), sizeof(struct iperf_udp_datagram)) == sizeof(rep)) &&
+      (ntohl(rep.flags) & HEADER_VERSION1))
+  {
+    u32_t jitter = ntohl(rep.jitter1) * 1000000 + ntohl(rep.jitter2);
+    u32_t datagrams = ntohl(rep.datagrams);
+    u32_t lost = ntohl(rep.error_cnt);
+
+    DEBUGOUT("[%u] Server Report: %lu.%03lu ms %lu/%lu (%lu%%) %lu out-of-order\r\n", s->num,
+             (unsigned long)(jitter / 1000), (unsigned long)(jitter % 1000),
+             (unsigned long)lost, (unsigned long)datagrams,
+             (unsigned long)((datagrams != 0) ? (lost * 100) / datagrams : 0),
+             (unsigned long)ntohl(rep.outorder_cnt));
+    pbuf_free(p);
+    iperf_udp_tx_end(s);
+    return;
+  }
+  pbuf_free(p);
+}
+
+static struct iperf_session *
+iperf_session_find(u8_t kind, ip_addr_t *addr, u16_t port)
+{
+  int i;
+
+  for (i = 0; i < IPERF_MAX_SESSIONS; i++)
+  {
+    struct iperf_session *s = &iperf_sessions[i];
+
+    if ((s->kind == kind) && (s->port == port) && ip_addr_cmp(&s->remote, addr))
+    {
+      return s;
+    }
+  }
+  return NULL;
+}
+
+/* Answers a final datagram with the server report */
+static void
+iperf_udp_send_report(struct iperf_session *s, struct udp_pcb *upcb, struct pbuf *p)
+{
+  struct iperf_server_hdr rep;
+  struct pbuf *q;
+  u16_t len = sizeof(struct iperf_udp_datagram) + sizeof(rep);
+  uint64_t dur = s->last_us - s->start_us;
+  u32_t jitter = s->jitter16 >> 4;
+
+  q = pbuf_alloc(PBUF_TRANSPORT, LWIP_MAX(len, p->tot_len), PBUF_RAM);
+  if (q == NULL)
+  {
+    return;
+  }
+  memset(q->payload, 0, q->len);
+  pbuf_copy_partial(p, q->payload, sizeof(struct iperf_udp_datagram), 0);
+
+  rep.flags = htonl(HEADER_VERSION1);
+  rep.total_len1 = htonl((u32_t)(s->bytes >> 32));
+  rep.total_len2 = htonl((u32_t)s->bytes);
+  rep.stop_sec = htonl((u32_t)(dur / 1000000));
+  rep.stop_usec = htonl((u32_t)(dur % 1000000));
+  rep.error_cnt = htonl(s->lost);
+  rep.outorder_cnt = htonl(s->outorder);
+  rep.datagrams = htonl((u32_t)s->last_id);
+  rep.jitter1 = htonl(jitter / 1000000);
+  rep.jitter2 = htonl(jitter % 1000000);
+  MEMCPY((u8_t *)q->payload + sizeof(struct iperf_udp_datagram), &rep, sizeof(rep));
+
+  udp_sendto(upcb, q, &s->remote, s->port);
+  pbuf_free(q);
+}
+
+static void
+iperf_udp_recv(void *arg, struct udp_pcb *upcb, struct pbuf *p, ip_addr_t *addr, u16_t port)
+{
+  struct iperf_session *s;
+  struct iperf_udp_datagram dg;
+  uint64_t now = iperf_now_us();
+  s32_t id;
+  u32_t transit;
+  u8_t fin;
+
+  LWIP_UNUSED_ARG(arg);
+
+  if (pbuf_copy_partial(p, &dg, sizeof(dg), 0) != sizeof(dg))
+  {
+    pbuf_free(p);
+    return;
+  }
+  id = (s32_t)ntohl(dg.id);
+  fin = (id < 0);
+
+  s = iperf_session_find(IPERF_UDP_RX, addr, port);
+  if ((s != NULL) && s->done)
+  {
+    /* Client repeats its final datagram until it gets our report */
+    if (fin)
+    {
+      iperf_udp_send_report(s, upcb, p);
+    }
+    else
+    {
+      iperf_session_free(s);
+      s = NULL;
+    }
+  }
+  if ((s == NULL) && !fin)
+  {
+    struct iperf_client_hdr hdr;
+
+    s = iperf_session_alloc(IPERF_UDP_RX, addr, port);
+    if (s != NULL)
+    {
+      DEBUGOUT("[%u] UDP RX from port %u\r\n", s->num, port);
+      if (pbuf_copy_partial(p, &hdr, sizeof(hdr), sizeof(dg)) == sizeof(hdr))
+      {
+        iperf_client_hdr_check(s, &hdr, 1);
+      }
+    }
+  }
+  if ((s == NULL) || s->done)
+  {
+    pbuf_free(p);
+    return;
+  }
+
+  s->bytes += p->tot_len;
+  s->packets++;
+  s->last_us = now;
+  if (fin)
+  {
+    id = -id;
+  }
+
+  /* RFC 1889 jitter from the change in transit time, the clock offset
+     between the hosts cancels out */
+  transit = (u32_t)(now - ((uint64_t)ntohl(dg.tv_sec) * 1000000ULL + ntohl(dg.tv_usec)));
+  if (s->packets > 1)
+  {
+    s32_t d = (s32_t)(transit - s->last_transit);
+
+    if (d < 0)
+    {
+      d = -d;
+    }
+    s->jitter16 += (u32_t)d - ((s->jitter16 + 8) >> 4);
+  }
+  s->last_transit = transit;
+
+  /* Gaps in the sequence are losses, a late datagram fills one back in */
+  if (id != s->last_id + 1)
+  {
+    if (id < s->last_id + 1)
+    {
+      s->outorder++;
+      if (s->lost != 0)
+      {
+        s->lost--;
+      }
+    }
+    else
+    {
+      s->lost += (u32_t)(id - s->last_id - 1);
+    }
+  }
+  if (id > s->last_id)
+  {
+    s->last_id = id;
+  }
+
+  if (fin)
+  {
+    s->packets = (u32_t)s->last_id;
+    iperf_session_end(s);
+    iperf_udp_send_report(s, upcb, p);
+    if (s->tradeoff)
+    {
+      iperf_start_reverse(s->remote, s->hdr, 1);
+    }
+  }
+  pbuf_free(p);
+}
+
+/* Prints the interval reports and ends stalled tests */
+static void
+iperf_report_tick(void *arg)
+{
+  uint64_t now = iperf_now_us();
+  int i;
+
+  LWIP_UNUSED_ARG(arg);
+
+  for (i = 0; i < IPERF_MAX_SESSIONS; i++)
+  {
+    struct iperf_session *s = &iperf_sessions[i];
+
+    if ((s->kind == IPERF_FREE) || s->done)
+    {
+      continue;
+    }
+    if ((s->kind == IPERF_TCP_TX) && (s->tpcb != NULL) && (s->tpcb->state == ESTABLISHED))
+    {
+      /* Catches the end of a timed test when the window has stalled */
+      iperf_tcp_tx_fill(s, s->tpcb);
+      if (s->kind == IPERF_FREE)
+      {
+        continue;
+      }
+    }
+    if ((s->kind == IPERF_UDP_RX) && ((now - s->last_us) > IPERF_UDP_IDLE_US))
+    {
+      iperf_session_end(s);
+      continue;
+    }
+    if (s->bytes != s->rep_bytes)
+    {
+      u32_t lost = (s->lost > s->rep_lost) ? s->lost - s->rep_lost : 0;
+
+      iperf_report(s, s->rep_us, now, s->bytes - s->rep_bytes,
+                   s->packets - s->rep_packets, lost, 0);
+    }
+    s->rep_us = now;
+    s->rep_bytes = s->bytes;
+    s->rep_packets = s->packets;
+    s->rep_lost = s->lost;
+  }
+  sys_timeout(IPERF_REPORT_INTERVAL_MS, iperf_report_tick, NULL);
+}
 
 void
 iperf_server_init(void)
 {
+  u32_t i;
+
+  StopWatch_Init();
+  iperf_ticks = StopWatch_Start();
+  for (i = 0; i < sizeof(iperf_tx_buf); i++)
+  {
+    iperf_tx_buf[i] = '0' + (i % 10);
+  }
+
   iperf_pcb = tcp_new();
   if (iperf_pcb != NULL)
   {
@@ -55,7 +833,7 @@ iperf_server_init(void)
       iperf_pcb = tcp_listen(iperf_pcb);
       tcp_accept(iperf_pcb, iperfserver_accept);
     }
-    else 
+    else
     {
       /* abort? output diagnostic? */
     }
@@ -64,8 +842,35 @@ iperf_server_init(void)
   {
     /* abort? output diagnostic? */
   }
+
+  iperf_udp_pcb = udp_new();
+  if (iperf_udp_pcb != NULL)
+  {
+    if (udp_bind(iperf_udp_pcb, IP_ADDR_ANY, IPERF_SERVER_PORT) == ERR_OK)
+    {
+      udp_recv(iperf_udp_pcb, iperf_udp_recv, NULL);
+    }
+    else
+    {
+      udp_remove(iperf_udp_pcb);
+      iperf_udp_pcb = NULL;
+    }
+  }
+
+  sys_timeout(IPERF_REPORT_INTERVAL_MS, iperf_report_tick, NULL);
 }
 
+err_t
+iperf_client_start(ip_addr_t *addr, u16_t port, u8_t udp, u32_t seconds, u32_t rate)
+{
+  s32_t amount = -(s32_t)(seconds * 100);
+
+  if (udp)
+  {
+    return iperf_udp_client_start(addr, port, IPERF_UDP_BUFLEN, rate, amount);
+  }
+  return iperf_tcp_client_start(addr, port, TCP_MSS, amount);
+}
 
 err_t
 iperfserver_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
@@ -86,18 +891,24 @@ iperfserver_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
     es->pcb = newpcb;
     es->retries = 0;
     es->p = NULL;
+    es->hdr_len = 0;
+    es->s = iperf_session_alloc(IPERF_TCP_RX, &newpcb->remote_ip, newpcb->remote_port);
+    if (es->s != NULL)
+    {
+      DEBUGOUT("[%u] TCP RX from port %u\r\n", es->s->num, newpcb->remote_port);
+    }
     /* pass newly allocated es to our callbacks */
     tcp_arg(newpcb, es);
     tcp_recv(newpcb, iperfserver_recv);
     tcp_err(newpcb, iperfserver_error);
-  
+
     ret_err = ERR_OK;
   }
   else
   {
     ret_err = ERR_MEM;
   }
-  return ret_err;  
+  return ret_err;
 }
 
 err_t
@@ -113,8 +924,8 @@ iperfserver_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
   {
     /* remote host closed connection */
     es->state = ES_CLOSING;
-    iperfserver_close(tpcb, es);    
-    ret_err = ERR_OK;   
+    iperfserver_close(tpcb, es);
+    ret_err = ERR_OK;
   }
   else if(err != ERR_OK)
   {
@@ -129,10 +940,25 @@ iperfserver_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
   else if(es->state == ES_ACCEPTED)
   {
     es->p = p;
-    plen = es->p->len;
+    plen = es->p->tot_len;
+    if (es->s != NULL)
+    {
+      es->s->bytes += plen;
+      es->s->last_us = iperf_now_us();
+      /* the client header may be split over several segments */
+      if (es->hdr_len < sizeof(es->hdr))
+      {
+        es->hdr_len += pbuf_copy_partial(p, (u8_t *)&es->hdr + es->hdr_len,
+                                         sizeof(es->hdr) - es->hdr_len, 0);
+        if (es->hdr_len == sizeof(es->hdr))
+        {
+          iperf_client_hdr_check(es->s, &es->hdr, 0);
+        }
+      }
+    }
     pbuf_free(es->p);   //receive the package and discard it silently for testing reception bandwidth
-    tcp_recved(tpcb, plen); 
-   
+    tcp_recved(tpcb, plen);
+
     ret_err = ERR_OK;
   }
   else if(es->state == ES_CLOSING)
@@ -164,6 +990,11 @@ iperfserver_error(void *arg, err_t err)
   es = (struct iperfserver_state *)arg;
   if (es != NULL)
   {
+    if (es->s != NULL)
+    {
+      iperf_session_end(es->s);
+      iperf_session_free(es->s);
+    }
     mem_free(es);
   }
 }
@@ -177,7 +1008,7 @@ iperfserver_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
 
   es = (struct iperfserver_state *)arg;
   es->retries = 0;
-  
+
   if(es->p != NULL)
   {
     /* still got pbufs to send */
@@ -200,9 +1031,9 @@ iperfserver_send(struct tcp_pcb *tpcb, struct iperfserver_state *es)
 {
   struct pbuf *ptr;
   err_t wr_err = ERR_OK;
- 
+
   while ((wr_err == ERR_OK) &&
-         (es->p != NULL) && 
+         (es->p != NULL) &&
          (es->p->len <= tcp_sndbuf(tpcb)))
   {
   ptr = es->p;
@@ -251,14 +1082,25 @@ iperfserver_close(struct tcp_pcb *tpcb, struct iperfserver_state *es)
   tcp_sent(tpcb, NULL);
   tcp_recv(tpcb, NULL);
   tcp_err(tpcb, NULL);
- 
-  
+
+
   if (es != NULL)
   {
+    struct iperf_session *s = es->s;
+
+    if (s != NULL)
+    {
+      iperf_session_end(s);
+      iperf_session_free(s);
+      /* -r test, the board sends once the client has finished */
+      if (s->tradeoff)
+      {
+        iperf_start_reverse(s->remote, s->hdr, 0);
+      }
+    }
     mem_free(es);
-  }  
+  }
   tcp_close(tpcb);
 }
 
-#endif /* LWIP_TCP */
-
+#endif /* LWIP_TCP && LWIP_UDP */
@@ -0,0 +1,76 @@
+/*
+ * @brief iperf 2 compatible TCP and UDP test server and client
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __IPERF_SERVER_H_
+#define __IPERF_SERVER_H_
+
+#include "lwip/ip_addr.h"
+#include "lwip/err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Port for the TCP and UDP servers, the iperf default */
+#define IPERF_SERVER_PORT           5001
+
+/* Running tests reported at a time, a dual test uses two */
+#define IPERF_MAX_SESSIONS          4
+
+/* Interval between the UART throughput reports */
+#define IPERF_REPORT_INTERVAL_MS    1000
+
+/**
+ * @brief	Starts the TCP and UDP receive servers on IPERF_SERVER_PORT
+ * @return	Nothing
+ * @note	A client run with -d (dual) or -r (tradeoff) makes the board
+ * connect back and send to the client, at the same time or once the
+ * client's test has finished. Each test prints interval and final
+ * reports to the debug UART, UDP tests add jitter and loss.
+ */
+void iperf_server_init(void);
+
+/**
+ * @brief	Starts a transmit test towards a host running "iperf -s"
+ * @param	addr	: Address of the iperf server
+ * @param	port	: Server port, normally IPERF_SERVER_PORT
+ * @param	udp		: 0 for TCP, 1 for UDP ("iperf -s -u")
+ * @param	seconds	: Test duration
+ * @param	rate	: UDP rate in bits/s, 0 for the iperf default of 1 Mbit/s
+ * @return	ERR_OK if the test was started
+ */
+err_t iperf_client_start(ip_addr_t *addr, u16_t port, u8_t udp, u32_t seconds, u32_t rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IPERF_SERVER_H_ */
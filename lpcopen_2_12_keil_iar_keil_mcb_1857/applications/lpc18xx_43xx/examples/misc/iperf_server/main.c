@@ -48,6 +48,7 @@
 #include "arch/lpc18xx_43xx_emac.h"
 #include "arch/lpc_arch.h"
 #include "echo.h"
+#include "iperf_server.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -56,10 +57,27 @@
 /* NETIF data */
 static struct netif lpc_netif;
 
+/* Define IPERF_TX_HOST to a host running "iperf -s" (or "iperf -s -u"
+   with IPERF_TX_UDP 1) to also run a transmit test once the board has
+   an address after each link up */
+/* #define IPERF_TX_HOST "10.1.10.1" */
+#define IPERF_TX_UDP        0
+#define IPERF_TX_SECONDS    10
+#define IPERF_TX_RATE       0	/* UDP bits/s, 0 for 1 Mbit/s */
+
+#ifdef IPERF_TX_HOST
+static bool txPending;
+#endif
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
 
+#if LPC_LWIP_HEAP_DMAMEM
+/* lwIP heap in the AHB SRAM, see LPC_LWIP_HEAP_DMAMEM in lwipopts.h */
+DMAMEM unsigned char lpc_lwip_heap[MEM_SIZE + (2 * MEM_ALIGNMENT) + 64];
+#endif
+
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
@@ -146,6 +164,16 @@ int main(void)
 		/* LWIP timers - ARP, DHCP, TCP, etc. */
 		sys_check_timeouts();
 
+#ifdef IPERF_TX_HOST
+		if (txPending && !ip_addr_isany(&lpc_netif.ip_addr)) {
+			ip_addr_t host;
+
+			txPending = false;
+			ipaddr_aton(IPERF_TX_HOST, &host);
+			iperf_client_start(&host, IPERF_SERVER_PORT, IPERF_TX_UDP, IPERF_TX_SECONDS, IPERF_TX_RATE);
+		}
+#endif
+
 		/* Call the PHY status update state machine once in a while
 		   to keep the link status up-to-date */
 		physts = lpcPHYStsPoll();
@@ -172,6 +200,9 @@ int main(void)
 				}
 
 				netif_set_link_up(&lpc_netif);
+#ifdef IPERF_TX_HOST
+				txPending = true;
+#endif
 				DEBUGOUT("IP_ADDR    : %s\r\n", ipaddr_ntoa_r((const ip_addr_t *) &lpc_netif.ip_addr, tmp_buff, 16));
 				DEBUGOUT("NET_MASK   : %s\r\n", ipaddr_ntoa_r((const ip_addr_t *) &lpc_netif.netmask, tmp_buff, 16));
 				DEBUGOUT("GATEWAY_IP : %s\r\n", ipaddr_ntoa_r((const ip_addr_t *) &lpc_netif.gw, tmp_buff, 16));
@@ -31,6 +31,7 @@
 
 #include "board.h"
 #include <string.h>
+#include "stopwatch.h"
 #include "spifilib_api.h"
 
 /*****************************************************************************
@@ -128,6 +129,51 @@ static SPIFI_HANDLE_T *initializeSpifi(void)
 	return pReturnVal;
 }
 
+/* Setup the SPIFI interface for quad I/O execute in place. The clock is raised
+   to the device maximum and the library programs the memory mode command
+   register with the fastest read opcode and dummy cycle count the detected
+   family supports in quad mode (it falls back to dual/single I/O if the part
+   cannot do quad). Returns true if quad mode was accepted. */
+static bool setupSpifiXip(SPIFI_HANDLE_T *pSpifi, uint32_t spifiBaseClockRate)
+{
+	uint32_t maxSpifiClock = spifiDevGetInfo(pSpifi, SPIFI_INFO_MAXCLOCK);
+	bool quad;
+
+	/* Leave memory mode so the options can be changed */
+	spifiDevSetMemMode(pSpifi, false);
+
+	Chip_Clock_SetDivider(CLK_IDIV_E, CLKIN_MAINPLL, ((spifiBaseClockRate / maxSpifiClock) + 1));
+
+	/* Enable quad.  If not supported it will be ignored */
+	spifiDevSetOpts(pSpifi, SPIFI_OPT_USE_QUAD, true);
+	quad = (spifiDevGetInfo(pSpifi, SPIFI_INFO_OPTIONS) & SPIFI_OPT_USE_QUAD) != 0;
+
+	/* Enter memMode, the read command is now issued by the SPIFI hardware on
+	   every cache line miss in the 0x14000000 window */
+	spifiDevSetMemMode(pSpifi, true);
+
+	DEBUGOUT("XIP clock rate      = %d\r\n", Chip_Clock_GetClockInputHz(CLKIN_IDIVE));
+	DEBUGOUT("XIP mode            = %s\r\n", quad ? "quad I/O" : "single/dual I/O");
+
+	return quad;
+}
+
+/* Verify kernel for the memory mapped window. It lives in internal SRAM so
+   its own instruction fetches do not compete with the data it streams from
+   SPIFI. Returns the number of words that do not match pattern. */
+static RAMFUNC uint32_t xipVerifyWords(const uint32_t *pData, uint32_t words, uint32_t pattern)
+{
+	uint32_t bad = 0;
+
+	while (words--) {
+		if (*pData++ != pattern) {
+			bad++;
+		}
+	}
+
+	return bad;
+}
+
 static void RunExample(void)
 {
 	uint32_t idx;
@@ -281,6 +327,19 @@ static void RunExample(void)
 		pageAddress += loopBytes;
 	}
 
+	/* Switch to quad XIP and read the sector back through the memory window
+	   with the SRAM resident kernel */
+	setupSpifiXip(pSpifi, spifiBaseClockRate);
+	bytesRemaining = spifiDevGetInfo(pSpifi, SPIFI_INFO_ERASE_BLOCKSIZE);
+	StopWatch_Init();
+	idx = StopWatch_Start();
+	if (xipVerifyWords((const uint32_t *) spifiGetAddrFromBlock(pSpifi, 0),
+					   bytesRemaining / sizeof(uint32_t), 0x5a5a5a5a) != 0) {
+		fatalError("XIP verify block 0", SPIFI_ERR_GEN);
+	}
+	idx = StopWatch_TicksToUs(StopWatch_Elapsed(idx));
+	DEBUGOUT("XIP read %d bytes in %d uS\r\n", bytesRemaining, idx);
+
 	/* Done, de-init will enter memory mode */
 	spifiDevDeInit(pSpifi);
 
@@ -57,6 +57,7 @@ static char menu[] =
 	" - Deep Sleep state & Wake up test      : Press '2' to select        \r\n"
 	" - Power down state & Wake up test      : Press '3' to select        \r\n"
 	" - Deep power down state & Wake up test : Press '4' to select        \r\n"
+	" - Wake up latency of all kept states   : Press '5' to select        \r\n"
 	" - Exit the demo                        : Press 'X' or 'x' to select \r\n"
 	"=============================================================================\r\n";
 static char menu1[] = "\r\nSelect the Wake up signal                      \r\n"
@@ -66,6 +67,18 @@ static char menu1[] = "\r\nSelect the Wake up signal                      \r\n"
 static char menu2[] = "PMC demo example terimnated \r\n";
 static char menu3[] = "\r\nPress 'C' or 'c' to start demo...\r\n";
 
+static const char *const stateNames[PWRMGR_STATE_COUNT] = {
+	"Sleep", "Deep Sleep", "Power Down", "Deep Power Down"
+};
+
+/* Wake up budgets the power manager is asked about after the measurements */
+static const uint32_t wakeBudgetsUs[] = {10, 100, 1000, 10000};
+
+#if defined(DEBUG_UART)
+/* Keeps the console baud rate while the power manager parks the clocks */
+static CHIP_DVFS_NOTIFIER_T uartNotifier;
+#endif
+
 /* Initial base clock states are mostly on */
 static struct CLK_BASE_STATES InitClkStates[] = {
 	{CLK_BASE_SAFE, CLKIN_IRC, true, false},
@@ -242,37 +255,45 @@ static void PMC_Post_Wakeup(uint8_t buffer)
 }
 
 /**
- * Event Router configure function
+ * WAKEUP0 pin wake up handler
  */
-static void PMC_Evrt_Configure(CHIP_EVRT_SRC_T Evrt_Src)
+static void PMC_Wakeup0_Handler(CHIP_EVRT_SRC_T Evrt_Src, void *pArg)
 {
-	/* Configure Interrupt signal from Evrt_Src pin to EVRT */
-	Chip_EVRT_ConfigIntSrcActiveType(Evrt_Src, EVRT_SRC_ACTIVE_RISING_EDGE);
-
-	/* Enable interrupt signal from Evrt_Src pin to EVRT */
-	Chip_EVRT_SetUpIntSrc(Evrt_Src, ENABLE);
-
-	/* Clear any pending interrupt */
-	Chip_EVRT_ClrPendIntSrc(Evrt_Src);
+	/* One wake up per test */
+	Chip_EVRT_SetHandler(Evrt_Src, EVRT_SRC_ACTIVE_RISING_EDGE, NULL, NULL);
+}
 
-	/* Disable EVRT interrupt in NVIC */
-	NVIC_DisableIRQ(EVENTROUTER_IRQn);
+/**
+ * RTC alarm wake up handler
+ */
+static void PMC_RTC_Handler(CHIP_EVRT_SRC_T Evrt_Src, void *pArg)
+{
+	if (Chip_RTC_GetIntPending(LPC_RTC, RTC_INT_ALARM)) {
+		Chip_RTC_ClearIntPending(LPC_RTC, RTC_INT_ALARM);
+		Chip_RTC_Enable(LPC_RTC, DISABLE);
+		Chip_EVRT_SetHandler(Evrt_Src, EVRT_SRC_ACTIVE_RISING_EDGE, NULL, NULL);
+	}
+}
 
+/**
+ * Event Router configure function
+ */
+static void PMC_Evrt_Configure(CHIP_EVRT_SRC_T Evrt_Src)
+{
 	/* preemption = 1, sub-priority = 1 */
 	NVIC_SetPriority(EVENTROUTER_IRQn, ((0x01 << 3) | 0x01));
 
-	/* Enable Event Router interrupt in NVIC */
-	NVIC_EnableIRQ(EVENTROUTER_IRQn);
+	/* Route the wake up signal to its handler */
+	Chip_EVRT_SetHandler(Evrt_Src, EVRT_SRC_ACTIVE_RISING_EDGE,
+						 (Evrt_Src == EVRT_SRC_RTC) ? PMC_RTC_Handler : PMC_Wakeup0_Handler, NULL);
 }
 
 /**
- * Power State handler function
+ * Wake up signal configure function
  */
-static void PMC_PwrState_Handler(uint8_t buffer, uint8_t Wake_RTC)
+static void PMC_Wakeup_Configure(uint8_t Wake_RTC)
 {
 	CHIP_EVRT_SRC_T Evrt_Src;
-	CHIP_PMC_PWR_STATE_T Pwr_state;
-	uint8_t confirm = 0xFF;
 
 	if (Wake_RTC) {
 		/* Configure EVRT_SRC_RTC as wake up signal */
@@ -302,6 +323,17 @@ static void PMC_PwrState_Handler(uint8_t buffer, uint8_t Wake_RTC)
 
 	/* Configure wake up signal */
 	PMC_Evrt_Configure(Evrt_Src);
+}
+
+/**
+ * Power State handler function
+ */
+static void PMC_PwrState_Handler(uint8_t buffer, uint8_t Wake_RTC)
+{
+	CHIP_PMC_PWR_STATE_T Pwr_state;
+	uint8_t confirm = 0xFF;
+
+	PMC_Wakeup_Configure(Wake_RTC);
 
 	/* Get confirmation from user to continue
 	 * Print wake up signal information to user
@@ -397,6 +429,39 @@ static void PMC_PwrState_Handler(uint8_t buffer, uint8_t Wake_RTC)
 	}
 }
 
+/**
+ * Wake up latency test: enters each state that returns through the power
+ * manager and prints what it measured, then the state it would pick for
+ * a few wake up budgets
+ */
+static void PMC_Latency_Test(uint8_t Wake_RTC)
+{
+	const CHIP_PWRMGR_STATS_T *pStats;
+	int i;
+
+	for (i = PWRMGR_SLEEP; i <= PWRMGR_POWER_DOWN; i++) {
+		PMC_Wakeup_Configure(Wake_RTC);
+		DEBUGOUT("Entering '%s' state ...\r\n", stateNames[i]);
+		if (Wake_RTC) {
+			Chip_RTC_Enable(LPC_RTC, ENABLE);
+		}
+		Chip_PWRMGR_Enter((CHIP_PWRMGR_STATE_T) i);
+		Chip_RTC_DeInit(LPC_RTC);
+	}
+
+	DEBUGSTR("\r\nState            enter(us) exit(us) wake budget(us)\r\n");
+	for (i = PWRMGR_SLEEP; i <= PWRMGR_DEEP_POWER_DOWN; i++) {
+		pStats = Chip_PWRMGR_GetStats((CHIP_PWRMGR_STATE_T) i);
+		DEBUGOUT("%-16s %9d %8d %15d\r\n", stateNames[i], pStats->maxEnterUs,
+				 pStats->maxExitUs, Chip_PWRMGR_WakeLatency((CHIP_PWRMGR_STATE_T) i));
+	}
+
+	for (i = 0; i < (sizeof(wakeBudgetsUs) / sizeof(wakeBudgetsUs[0])); i++) {
+		DEBUGOUT("Budget %dus -> '%s'\r\n", wakeBudgetsUs[i],
+				 stateNames[Chip_PWRMGR_Select(wakeBudgetsUs[i], PWRMGR_POWER_DOWN)]);
+	}
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -407,19 +472,8 @@ static void PMC_PwrState_Handler(uint8_t buffer, uint8_t Wake_RTC)
  */
 void EVRT_IRQHandler(void)
 {
-	if (Chip_EVRT_IsSourceInterrupting(EVRT_SRC_WAKEUP0)) {
-		Chip_EVRT_ClrPendIntSrc(EVRT_SRC_WAKEUP0);
-		NVIC_DisableIRQ(EVENTROUTER_IRQn);
-	}
-
-	if (Chip_EVRT_IsSourceInterrupting(EVRT_SRC_RTC)) {
-		if (Chip_RTC_GetIntPending(LPC_RTC, RTC_INT_ALARM)) {
-			Chip_RTC_ClearIntPending(LPC_RTC, RTC_INT_ALARM);
-			Chip_EVRT_ClrPendIntSrc(EVRT_SRC_RTC);
-			Chip_RTC_Enable(LPC_RTC, DISABLE);
-			NVIC_DisableIRQ(EVENTROUTER_IRQn);
-		}
-	}
+	/* Calls the handler of the source that woke the chip */
+	Chip_EVRT_IRQHandler();
 }
 
 /**
@@ -438,6 +492,12 @@ int main(void)
 	/* Initialize the Event Router */
 	Chip_EVRT_Init();
 
+	/* Power manager, the console follows its clock changes */
+	Chip_PWRMGR_Init();
+#if defined(DEBUG_UART)
+	Chip_DVFS_RegisterUART(&uartNotifier, DEBUG_UART, 115200);
+#endif
+
 	/* Print user menu on UART console */
 	DEBUGSTR(menu);
 
@@ -477,6 +537,13 @@ int main(void)
 			DEBUGSTR(menu);
 			break;
 
+		case '5':		/* Wake up latency of Sleep, Deep sleep and Power Down */
+			DEBUGSTR("Wake up latency test selected \r\n");
+			PMC_Get_Wakeup_option(&Wake_RTC);
+			PMC_Latency_Test(Wake_RTC);
+			DEBUGSTR(menu);
+			break;
+
 		case 'X':
 			DEBUGSTR(menu2);
 			exitflag = SET;
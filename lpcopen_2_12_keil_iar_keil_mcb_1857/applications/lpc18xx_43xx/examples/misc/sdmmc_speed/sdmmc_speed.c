@@ -30,8 +30,11 @@
  */
 
 #include <string.h>
+#include <stdio.h>
 #include "board.h"
 #include "chip.h"
+#include "profile.h"
+#include "bench.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -54,6 +57,23 @@
 /* Buffer size (in bytes) for R/W operations */
 #define BUFFER_SIZE     (NUM_SECTORS * MMC_SECTOR_SIZE)
 
+/* Sectors per request in the streaming write measurement */
+#define STREAM_SECTORS  32
+
+/* Sweep over request sizes of 1 to SWEEP_MAX_BLOCKS blocks (powers of 2),
+   within a SWEEP_AREA_SECTORS test area starting at START_SECTOR. Each
+   point times up to SWEEP_REQUESTS requests, fewer for large requests so
+   that a point moves at most SWEEP_POINT_BYTES, but never fewer than
+   SWEEP_MIN_REQUESTS. */
+#define SWEEP_MAX_BLOCKS    2048
+#define SWEEP_AREA_SECTORS  8192
+#define SWEEP_REQUESTS      64
+#define SWEEP_MIN_REQUESTS  4
+#define SWEEP_POINT_BYTES   (4 * 1024 * 1024)
+
+/* Sectors backed up and restored, the test area of every measurement */
+#define BACKUP_SECTORS  SWEEP_AREA_SECTORS
+
 /* Buffers to store original data of SD/MMC card.
  * The data will be stored in this buffer, once read/write measurement
  * completed, the original contents will be restored into SD/MMC card.
@@ -68,6 +88,16 @@ static uint32_t *Buff_Wr = (uint32_t *) 0x28100000;
 /* Measurement data */
 static uint32_t rd_ticks[NUM_ITER];
 static uint32_t wr_ticks[NUM_ITER];
+static uint32_t st_ticks[NUM_ITER];
+
+/* Request latencies of a sweep point */
+static uint32_t sw_ticks[SWEEP_REQUESTS];
+
+/* Non-blocking sweep request completion, bytes or -1 while in progress */
+static volatile int32_t sw_async_bytes;
+
+/* DMA descriptors covering the largest sweep request */
+static pSDMMC_DMA_T sd_dma_ring[(SWEEP_MAX_BLOCKS * MMC_SECTOR_SIZE) / MCI_DMADES1_MAXTR];
 
 /* SD/MMC card information */
 /* Number of sectors in SD/MMC card */
@@ -201,9 +231,11 @@ static void board_uart_out_string(char *str)
 static void print_meas_data(void)
 {
 	static char debugBuf[64];
-    uint64_t tot_sum_rd, tot_sum_wr;
-    uint32_t i, rd_ave, wr_ave, rd_time, wr_time;
+    uint64_t tot_sum_rd, tot_sum_wr, tot_sum_st;
+    uint32_t i, rd_ave, wr_ave, st_ave, rd_time, wr_time, st_time;
 	uint32_t clk = SystemCoreClock/1000000;
+	uint32_t bus_clk;
+	int32_t bus_width;
 
     /* Print Number of Interations */
 	debugstr("\r\n=====================\r\n");
@@ -217,13 +249,19 @@ static void print_meas_data(void)
 	debugstr(debugBuf);
 	sprintf(debugBuf, "Data Transferred : %u bytes\r\n", (MMC_SECTOR_SIZE * NUM_SECTORS));
 	debugstr(debugBuf);
-    tot_sum_rd = tot_sum_wr = 0;
+	bus_clk = Chip_SDMMC_GetBusMode(LPC_SDMMC, &bus_width) / 1000000;
+	sprintf(debugBuf, "Card Bus: %d-bit, %u MHz max%s\r\n", bus_width, bus_clk,
+			(sdcardinfo.card_info.card_type & CARD_TYPE_HS) ? ", high speed" : "");
+	debugstr(debugBuf);
+    tot_sum_rd = tot_sum_wr = tot_sum_st = 0;
     for(i = 0; i < NUM_ITER; i++) {
         tot_sum_rd += rd_ticks[i];
         tot_sum_wr += wr_ticks[i];
+        tot_sum_st += st_ticks[i];
     }
     rd_ave = tot_sum_rd / NUM_ITER;
     wr_ave = tot_sum_wr / NUM_ITER;
+    st_ave = tot_sum_st / NUM_ITER;
 	sprintf(debugBuf, "CPU Speed: %lu.%lu MHz\r\n", clk, (SystemCoreClock / 10000) - (clk * 100));
 	debugstr(debugBuf);
     sprintf(debugBuf, "Ave Ticks for Read: %u \r\n", rd_ave);
@@ -236,6 +274,115 @@ static void print_meas_data(void)
     debugstr(debugBuf);
 	sprintf(debugBuf, "WRITE:Ave Time: %u usecs Ave Speed : %u KB/sec \r\n", wr_time, ((NUM_SECTORS * MMC_SECTOR_SIZE * 1000)/wr_time));
     debugstr(debugBuf);
+	st_time = (st_ave / clk);
+	sprintf(debugBuf, "STREAM WRITE (%u sector requests): Ave Time: %u usecs Ave Speed : %u KB/sec \r\n",
+			STREAM_SECTORS, st_time, ((NUM_SECTORS * MMC_SECTOR_SIZE * 1000)/st_time));
+    debugstr(debugBuf);
+}
+
+/* Sweep report output */
+static void sweep_puts(const char *str)
+{
+	debugstr((char *) str);
+}
+
+/* Completion callback of the non-blocking sweep requests */
+static void sweep_done(LPC_SDMMC_T *pSDMMC, int32_t bytes)
+{
+	(void) pSDMMC;
+	sw_async_bytes = bytes;
+}
+
+/* One sweep request, blocking or non-blocking, returns bytes moved or 0 */
+static int32_t sweep_request(bool write, bool async, int32_t lba, int32_t blocks)
+{
+	void *buf = write ? (void *) Buff_Wr : (void *) Buff_Rd;
+	int32_t bytes;
+
+	if (!async) {
+		return write ? Chip_SDMMC_WriteBlocks(LPC_SDMMC, buf, lba, blocks) :
+			   Chip_SDMMC_ReadBlocks(LPC_SDMMC, buf, lba, blocks);
+	}
+
+	sw_async_bytes = -1;
+	bytes = write ? Chip_SDMMC_WriteBlocksAsync(LPC_SDMMC, buf, lba, blocks, sweep_done) :
+			Chip_SDMMC_ReadBlocksAsync(LPC_SDMMC, buf, lba, blocks, sweep_done);
+	if (bytes == 0) {
+		return 0;
+	}
+
+	/* The CPU is free here, the driver only needs polling for the end
+	   of the card busy phase after writes */
+	while (sw_async_bytes < 0) {
+		Chip_SDMMC_PollAsync(LPC_SDMMC);
+	}
+
+	return sw_async_bytes;
+}
+
+/* Time the requests of one sweep point and report it */
+static bool sweep_point(bool write, bool random, bool async, int32_t blocks)
+{
+	static char debugBuf[64];
+	static char name[32];
+	BENCH_RESULT_T result;
+	uint32_t i, count, start_time, seed = 0x1234567;
+	int32_t lba, slots = SWEEP_AREA_SECTORS / blocks;
+
+	count = SWEEP_POINT_BYTES / (blocks * MMC_SECTOR_SIZE);
+	if (count > SWEEP_REQUESTS) {
+		count = SWEEP_REQUESTS;
+	}
+	if (count < SWEEP_MIN_REQUESTS) {
+		count = SWEEP_MIN_REQUESTS;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (random) {
+			seed = (seed * 1664525) + 1013904223;
+			lba = START_SECTOR + (((seed >> 8) % slots) * blocks);
+		}
+		else {
+			lba = START_SECTOR + ((i % slots) * blocks);
+		}
+
+		start_time = Profile_Now();
+		if (sweep_request(write, async, lba, blocks) == 0) {
+			sprintf(debugBuf, "Sweep %s of %d blocks at %d failed!\r\n", write ? "write" : "read", blocks, lba);
+			debugstr(debugBuf);
+			return false;
+		}
+		sw_ticks[i] = Profile_Now() - start_time;
+	}
+
+	Bench_Summarize(sw_ticks, count, (uint64_t) count * blocks * MMC_SECTOR_SIZE, &result);
+	sprintf(name, "%s_%s_%d", random ? "random" : "seq", async ? "async" : "sync", blocks);
+	Bench_Emit(write ? "sd_write" : "sd_read", name, "B", &result);
+
+	return true;
+}
+
+/* Sweep request size, access pattern and API for reads and writes */
+static bool run_sweep(void)
+{
+	int32_t blocks;
+	int op, mode;
+
+	Bench_Init(BENCH_FORMAT_CSV, sweep_puts);
+	Bench_ReportBegin("SDMMC sweep");
+	for (op = 0; op < 2; op++) {
+		for (mode = 0; mode < 4; mode++) {
+			for (blocks = 1; blocks <= SWEEP_MAX_BLOCKS; blocks *= 2) {
+				if (!sweep_point(op == 0, (mode & 1) != 0, (mode & 2) != 0, blocks)) {
+					Bench_ReportEnd();
+					return false;
+				}
+			}
+		}
+	}
+	Bench_ReportEnd();
+
+	return true;
 }
 
 /*****************************************************************************
@@ -253,6 +400,12 @@ void SDIO_IRQHandler(void)
 	   driver and needs to be enabled/disabled in the callbacks or
 	   application as needed. This is to allow flexibility with IRQ
 	   handling for applicaitons and RTOSes. */
+	/* Non-blocking transfers (Chip_SDMMC_ReadBlocksAsync) are completed
+	   by the driver */
+	if (Chip_SDMMC_IRQHandler(LPC_SDMMC)) {
+		return;
+	}
+
 	/* Set wait exit flag to tell wait function we are ready. In an RTOS,
 	   this would trigger wakeup of a thread waiting for the IRQ. */
 	NVIC_DisableIRQ(SDIO_IRQn);
@@ -320,8 +473,11 @@ int main(void)
     /* Read Card information */
     tot_secs = Chip_SDMMC_GetDeviceBlocks(LPC_SDMMC);
 
+    /* R/W buffers are larger than the descriptors in sdcardinfo can cover */
+    Chip_SDMMC_SetDescriptorRing(LPC_SDMMC, sd_dma_ring, sizeof(sd_dma_ring) / sizeof(sd_dma_ring[0]));
+
     /* Make sure that the sectors are withing the card size */
-    if((START_SECTOR + NUM_SECTORS) >= tot_secs) {
+    if((START_SECTOR + BACKUP_SECTORS) >= tot_secs) {
         debugstr("Out of range parameters! ..\r\n");
 		goto error_exit;
     }
@@ -330,10 +486,13 @@ int main(void)
      * it can be restored so that SD/MMC card is not corrupted
      */
     debugstr("\r\nTaking back up of card.. \r\n");
-    act_read = Chip_SDMMC_ReadBlocks(LPC_SDMMC, (void *)Buff_Backup, START_SECTOR, NUM_SECTORS);
-    if(act_read == 0) {
-        debugstr("Taking back up of card failed!.. \r\n");
-		goto error_exit;
+    for(i = 0; i < BACKUP_SECTORS; i += SWEEP_MAX_BLOCKS) {
+        act_read = Chip_SDMMC_ReadBlocks(LPC_SDMMC, (uint8_t *) Buff_Backup + (i * MMC_SECTOR_SIZE),
+                                         START_SECTOR + i, SWEEP_MAX_BLOCKS);
+        if(act_read == 0) {
+            debugstr("Taking back up of card failed!.. \r\n");
+		    goto error_exit;
+        }
     }
 
     ite_cnt = 0;
@@ -389,16 +548,56 @@ int main(void)
         ite_cnt++;
     }
 
+    /* Streaming write: each request is queued as soon as the previous one
+     * has been accepted, and the next chunk is filled while the card takes
+     * the data, as a recorder or USB mass storage device would do
+     */
+    for(ite_cnt = 0; ite_cnt < NUM_ITER; ite_cnt++) {
+	    start_time = Chip_RIT_GetCounter(LPC_RITIMER);
+        for(i = 0; i < NUM_SECTORS; i += STREAM_SECTORS) {
+            act_written = Chip_SDMMC_StartWriteBlocks(LPC_SDMMC, (uint8_t *) Buff_Wr + (i * MMC_SECTOR_SIZE),
+                                                      START_SECTOR + i, STREAM_SECTORS);
+            if(act_written == 0) {
+                sprintf(debugBuf, "StartWriteBlocks failed for Iter: %u! \r\n", ite_cnt);
+	            debugstr(debugBuf);
+		        goto error_exit;
+            }
+            if((i + STREAM_SECTORS) < NUM_SECTORS) {
+                uint32_t *next = Buff_Wr + (((i + STREAM_SECTORS) * MMC_SECTOR_SIZE) / sizeof(uint32_t));
+                uint32_t j;
+
+                for(j = 0; j < ((STREAM_SECTORS * MMC_SECTOR_SIZE) / sizeof(uint32_t)); j++) {
+                    next[j] = j + ite_cnt;
+                }
+            }
+        }
+        act_written = Chip_SDMMC_WaitTransfer(LPC_SDMMC);
+	    end_time = Chip_RIT_GetCounter(LPC_RITIMER);
+        if(act_written == 0) {
+            sprintf(debugBuf, "Streaming write failed for Iter: %u! \r\n", ite_cnt);
+	        debugstr(debugBuf);
+		    goto error_exit;
+        }
+        st_ticks[ite_cnt] = end_time - start_time;
+    }
+
 	/* Print Measurement onto UART */
     print_meas_data();
 
+    /* Request size, access pattern and API sweep */
+    run_sweep();
+
 error_exit:
     /* Restore if back up taken */
     if(backup) {
         debugstr("\r\nRestoring the contents of SDMMC card... \r\n");
-        act_written = Chip_SDMMC_WriteBlocks(LPC_SDMMC, (void *)Buff_Backup, START_SECTOR, NUM_SECTORS);
-        if(act_written == 0) {
-            debugstr("Restoring contents failed!.. \r\n");
+        for(i = 0; i < BACKUP_SECTORS; i += SWEEP_MAX_BLOCKS) {
+            act_written = Chip_SDMMC_WriteBlocks(LPC_SDMMC, (uint8_t *) Buff_Backup + (i * MMC_SECTOR_SIZE),
+                                                 START_SECTOR + i, SWEEP_MAX_BLOCKS);
+            if(act_written == 0) {
+                debugstr("Restoring contents failed!.. \r\n");
+                break;
+            }
         }
     }
 
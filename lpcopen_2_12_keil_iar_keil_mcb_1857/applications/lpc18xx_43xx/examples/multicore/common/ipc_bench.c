@@ -0,0 +1,313 @@
+/*
+ * @brief LPC43XX IPC latency and throughput benchmark
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "app_multicore_cfg.h"
+#include "ipc_msg.h"
+#include "ipc_bench.h"
+#include "sys_os.h"
+
+/** @ingroup EXAMPLE_DUALCORE_CMN_IPC_BENCH
+ * @{
+ */
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Messages sent at each size and depth, per measurement */
+#define IPC_BENCH_ITER        256
+
+/* Largest message size and queue depth swept */
+#define IPC_BENCH_MAX_SIZE    64
+#define IPC_BENCH_MAX_DEPTH   32
+
+/* Message types, in the first word of a message */
+#define BENCH_ONEWAY          1	/* Time stamped, the M0 records the latency */
+#define BENCH_PING            2	/* Time stamped, the M0 sends it back */
+#define BENCH_PONG            3	/* Reply to BENCH_PING or BENCH_STREAM_END */
+#define BENCH_STREAM          4	/* Consumed by the M0 */
+#define BENCH_STREAM_END      5	/* Last message of a stream, the M0 replies */
+
+#define BENCH_MAGIC_VALID     0xBE4C0001
+
+/* Run control, shared by both cores at SHARED_MEM_BENCH */
+struct ipc_bench_ctl {
+	volatile uint32_t valid;	/* BENCH_MAGIC_VALID once the M4 set it up */
+	volatile uint32_t gen;		/* Run number, bumped by the M4 for a new size and depth */
+	volatile uint32_t ack;		/* Run number the M0 has set its queue up for */
+	volatile uint32_t size;		/* Message size of the run */
+	volatile uint32_t depth;	/* Queue depth of the run */
+	volatile uint32_t lat_min;	/* One-way latency, recorded by the M0 */
+	volatile uint32_t lat_max;
+	volatile uint32_t lat_sum;
+	volatile uint32_t lat_cnt;
+};
+
+static struct ipc_bench_ctl *const ctl = (struct ipc_bench_ctl *) SHARED_MEM_BENCH;
+
+/* Receive queue of this core and one message, word aligned for the time
+   stamps */
+static uint32_t bench_queue[(IPC_BENCH_MAX_SIZE * IPC_BENCH_MAX_DEPTH) / 4];
+static uint32_t bench_msg[IPC_BENCH_MAX_SIZE / 4];
+
+#ifdef CORE_M4
+static const uint8_t bench_size[] = {8, 16, 32, 64};
+static const uint8_t bench_depth[] = {2, 8, 32};
+
+/* Minimum, maximum and sum of a set of times */
+struct bench_stat {
+	uint32_t min;
+	uint32_t max;
+	uint32_t sum;
+};
+
+#else
+/* Run number this core's queue is set up for */
+static uint32_t bench_seen;
+#endif
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Time base shared by both cores */
+static INLINE uint32_t bench_now(void)
+{
+	return Chip_RIT_GetCounter(LPC_RITIMER);
+}
+
+/* Push and pop that block with an OS and poll without one */
+static void bench_push(uint16_t cpu)
+{
+	while (IPC_pushMsgTout(cpu, bench_msg, -SYS_OS_ID) != QUEUE_INSERT) {}
+}
+
+static void bench_pop(void)
+{
+	while (IPC_popMsgTout(bench_msg, -SYS_OS_ID) != QUEUE_VALID) {}
+}
+
+#ifdef CORE_M4
+static void bench_stat_reset(struct bench_stat *st)
+{
+	st->min = 0xFFFFFFFF;
+	st->max = 0;
+	st->sum = 0;
+}
+
+static void bench_stat_add(struct bench_stat *st, uint32_t t)
+{
+	if (t < st->min) {
+		st->min = t;
+	}
+	if (t > st->max) {
+		st->max = t;
+	}
+	st->sum += t;
+}
+
+/* Sets up both queues for a size and depth, waits for the M0 to follow */
+static void bench_config(int size, int depth)
+{
+	uint32_t gen;
+
+	/* Own queue first, the M0 pushes to it as soon as it acks */
+	IPC_initMsgQueue(bench_queue, size, depth);
+	ctl->size = size;
+	ctl->depth = depth;
+	ctl->lat_min = 0xFFFFFFFF;
+	ctl->lat_max = 0;
+	ctl->lat_sum = 0;
+	ctl->lat_cnt = 0;
+	gen = ctl->gen + 1;
+
+	/* Settings must reach memory before the new run number */
+	__DMB();
+	ctl->gen = gen;
+	while (ctl->ack != gen) {}
+}
+
+/* Measures one size and depth and prints the result line */
+static void bench_run(int size, int depth)
+{
+	struct bench_stat rtt;
+	uint32_t t0, t, rate;
+	int i;
+
+	bench_config(size, depth);
+	memset(bench_msg, 0, sizeof(bench_msg));
+
+	/* One-way, one message in flight so only the latency is seen */
+	for (i = 0; i < IPC_BENCH_ITER; i++) {
+		bench_msg[0] = BENCH_ONEWAY;
+		bench_msg[1] = bench_now();
+		bench_push(IPC_BENCH_CPU);
+		while (ctl->lat_cnt != (uint32_t) (i + 1)) {}
+	}
+
+	/* Ping-pong round trip */
+	bench_stat_reset(&rtt);
+	for (i = 0; i < IPC_BENCH_ITER; i++) {
+		bench_msg[0] = BENCH_PING;
+		bench_msg[1] = bench_now();
+		bench_push(IPC_BENCH_CPU);
+		do {
+			bench_pop();
+		} while (bench_msg[0] != BENCH_PONG);
+		bench_stat_add(&rtt, bench_now() - bench_msg[1]);
+	}
+
+	/* Stream, the depth of the queue is what keeps both cores busy */
+	t0 = bench_now();
+	bench_msg[0] = BENCH_STREAM;
+	for (i = 0; i < IPC_BENCH_ITER - 1; i++) {
+		bench_push(IPC_BENCH_CPU);
+	}
+	bench_msg[0] = BENCH_STREAM_END;
+	bench_push(IPC_BENCH_CPU);
+	do {
+		bench_pop();
+	} while (bench_msg[0] != BENCH_PONG);
+	t = bench_now() - t0;
+	rate = (uint32_t) (((uint64_t) IPC_BENCH_ITER * SystemCoreClock) / (t ? t : 1));
+
+	DEBUGOUT("%4d %5d %6d %6d %6d %6d %6d %6d %8d\r\n", size, depth,
+			 ctl->lat_min, ctl->lat_sum / IPC_BENCH_ITER, ctl->lat_max,
+			 rtt.min, rtt.sum / IPC_BENCH_ITER, rtt.max, rate);
+}
+
+/* Runs the whole sweep once */
+static void bench_sweep(void)
+{
+	int i, j;
+
+	DEBUGOUT("IPC benchmark, times in cycles at %d Hz\r\n", SystemCoreClock);
+	DEBUGSTR("size depth  1-way    avg    max    rtt    avg    max    msg/s\r\n");
+	for (i = 0; i < (int) sizeof(bench_size); i++) {
+		for (j = 0; j < (int) sizeof(bench_depth); j++) {
+			bench_run(bench_size[i], bench_depth[j]);
+		}
+	}
+}
+
+#else
+/* Answers the M4 for one message, returns once none came in tout ms */
+static void bench_echo(int tout)
+{
+	uint32_t t;
+
+	if (ctl->valid == BENCH_MAGIC_VALID && ctl->gen != bench_seen) {
+		bench_seen = ctl->gen;
+		IPC_initMsgQueue(bench_queue, ctl->size, ctl->depth);
+
+		/* Queue must be set up before the M4 sees the ack */
+		__DMB();
+		ctl->ack = bench_seen;
+	}
+
+	if (IPC_popMsgTout(bench_msg, tout) != QUEUE_VALID) {
+		return;
+	}
+
+	switch (bench_msg[0]) {
+	case BENCH_ONEWAY:
+		t = bench_now() - bench_msg[1];
+		if (t < ctl->lat_min) {
+			ctl->lat_min = t;
+		}
+		if (t > ctl->lat_max) {
+			ctl->lat_max = t;
+		}
+		ctl->lat_sum += t;
+
+		/* Times must reach memory before the M4 sees the count */
+		__DMB();
+		ctl->lat_cnt++;
+		break;
+
+	case BENCH_PING:
+	case BENCH_STREAM_END:
+		bench_msg[0] = BENCH_PONG;
+		bench_push(CPUID_M4);
+		break;
+
+	default:
+		break;
+	}
+}
+#endif
+
+/* Benchmark task, runs the sweep over and over on the M4 and echoes on
+   the M0 */
+static void ipc_bench_task(void *loop)
+{
+	do {
+#ifdef CORE_M4
+		bench_sweep();
+#else
+		bench_echo(loop ? 1 : 0);
+#endif
+	} while (loop);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* IPC benchmark task */
+void ipc_bench_tasks(void)
+{
+	sys_taskCreate(ipc_bench_task, (void *) SYS_OS_ID, "IPC Bench", TASK_PRIO_IPC_DISPATCH);
+}
+
+/* Initialization for the IPC benchmark */
+void IPC_BENCH_Init(void)
+{
+#ifdef CORE_M4
+	if (!(LPC_RITIMER->CTRL & RIT_CTRL_TEN)) {
+		Chip_RIT_Init(LPC_RITIMER);
+	}
+	ctl->valid = 0;
+	__DMB();
+	memset((void *) ctl, 0, sizeof(*ctl));
+	__DMB();
+	ctl->valid = BENCH_MAGIC_VALID;
+#endif
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,98 @@
+/*
+ * @brief LPC43XX IPC latency and throughput benchmark
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __IPC_BENCH_H_
+#define __IPC_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup EXAMPLE_DUALCORE_CMN_IPC_BENCH LPC43xx IPC benchmark
+ * @ingroup EXAMPLE_DUALCORE_CMN_IPC
+ * Measures the IPC queue between the M4 and one M0 core: one-way latency,
+ * ping-pong round trip and sustained messages per second, swept over the
+ * message size and the queue depth. The M4 drives the runs and prints one
+ * line per size and depth, the M0 echoes. Times are RI timer counts, which
+ * run at the M4 core clock and are read by both cores.
+ *
+ * The benchmark takes over the IPC queues of both cores, so it replaces the
+ * IPC example when EXAMPLE_IPC_BENCH is defined. It blocks through
+ * #IPC_EventHandler with an OS (sys_os.h) and polls without one (sys_sa.h).
+ * @{
+ */
+
+/**
+ * \def IPC_BENCH_CPU
+ * M0 core the M4 runs the benchmark against
+ */
+#ifndef IPC_BENCH_CPU
+#define IPC_BENCH_CPU       CPUID_M0APP
+#endif
+
+/**
+ * \def SHARED_MEM_BENCH
+ * Run control shared by both cores, placed after the IPC queue headers
+ */
+#ifndef SHARED_MEM_BENCH
+#define SHARED_MEM_BENCH    (SHARED_MEM_IPC + 0x80)
+#endif
+
+/**
+ * @brief	IPC benchmark initialization
+ *
+ * Replaces IPCEX_Init() on both cores. The M4 sets up the run control and
+ * starts the RI timer if nothing else did.
+ *
+ * @return	None
+ */
+void IPC_BENCH_Init(void);
+
+/**
+ * @brief	IPC benchmark task
+ *
+ * On the M4 this runs the latency and throughput sweep and prints the
+ * results, on the M0 it answers the M4. Without an OS it must be called
+ * repeatedly from the main loop, with one it creates the task.
+ *
+ * @return	None
+ */
+void ipc_bench_tasks(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IPC_BENCH_H_ */
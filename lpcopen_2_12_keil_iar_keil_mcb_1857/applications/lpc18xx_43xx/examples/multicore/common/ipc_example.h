@@ -136,6 +136,31 @@ void IPCEX_Init(void);
  */
 int M0Image_Boot(CPUID_T cpu, uint32_t base_addr);
 
+/**
+ * @brief		Start moving an M0 image to where it runs
+ *
+ * An image linked to run at @a src_addr is left in place and will execute
+ * from there. An image linked for @a dst_addr is copied by the GPDMA in the
+ * background, so the M4 can carry on with its own initialization before
+ * calling M0Image_LoadBoot().
+ *
+ * @param		dst_addr: Run address of a copied image, 4K aligned
+ * @param		src_addr: Address of the image
+ * @param		size	: Size of the image in bytes
+ * @return		0 when executing in place, 1 when the copy started, < 0 on failure
+ * @note		The GPDMA must be set up with Chip_GPDMA_Init() and
+ *				Chip_GPDMA_JobInit(), with DMA_IRQHandler() calling
+ *				Chip_GPDMA_JobIRQHandler() and the DMA interrupt enabled.
+ */
+int M0Image_LoadStart(uint32_t dst_addr, uint32_t src_addr, uint32_t size);
+
+/**
+ * @brief		Wait for the image given to M0Image_LoadStart() and boot it
+ * @param		cpu		: ID of the cpu to boot
+ * @return		0 on success < 0 on failure
+ */
+int M0Image_LoadBoot(CPUID_T cpu);
+
 /**
  * @}
  */
@@ -65,6 +65,44 @@ static void ipc_send_signal(void)
 	__SEV();
 }
 
+/* Signal the reader of a queue just pushed to, unless it is draining and
+   will see the new head anyway. The head store must be visible before the
+   flag is read, the reader orders its flag store before its head read the
+   same way. */
+static void ipc_push_signal(struct ipc_queue *qwr)
+{
+	__DMB();
+	if (!qwr->draining) {
+		ipc_send_signal();
+	}
+}
+
+/* Copy n messages between a buffer and the queue ring starting at index
+   idx, in up to two runs around the end of the ring */
+static void ipc_copy_in(struct ipc_queue *q, uint32_t idx, const uint8_t *src, uint32_t n)
+{
+	uint32_t pos = idx & (q->count - 1);
+	uint32_t run = q->count - pos;
+
+	if (run > n) {
+		run = n;
+	}
+	memcpy(q->data + (pos * q->size), src, run * q->size);
+	memcpy(q->data, src + (run * q->size), (n - run) * q->size);
+}
+
+static void ipc_copy_out(struct ipc_queue *q, uint32_t idx, uint8_t *dst, uint32_t n)
+{
+	uint32_t pos = idx & (q->count - 1);
+	uint32_t run = q->count - pos;
+
+	if (run > n) {
+		run = n;
+	}
+	memcpy(dst, q->data + (pos * q->size), run * q->size);
+	memcpy(dst + (run * q->size), q->data, (n - run) * q->size);
+}
+
 /* Simple event handler for non OS implementations */
 static int IPC_EventHandler_sa(IPC_EVENT_T event, uint16_t cpu, int tout)
 {
@@ -132,8 +170,10 @@ int IPC_pushMsgTout(uint16_t cpuid, const void *data, int tout)
 	}
 
 	memcpy(qwr->data + ((qwr->head & (qwr->count - 1)) * qwr->size), data, qwr->size);
+	/* the message must be in memory before the reader can see the head */
+	__DMB();
 	qwr->head++;
-	ipc_send_signal();
+	ipc_push_signal(qwr);
 
 	return QUEUE_INSERT;
 }
@@ -158,8 +198,11 @@ int IPC_popMsgTout(void *data, int tout)
 		}
 	}
 
-	/* Pop the queue Item */
+	/* Pop the queue Item, reading it only after the head that covers it
+	   and freeing its slot only after it is read */
+	__DMB();
 	memcpy(data, qrd->data + ((qrd->tail & (qrd->count - 1)) * qrd->size), qrd->size);
+	__DMB();
 	qrd->tail++;
 
 	if (raise_event) {
@@ -168,6 +211,100 @@ int IPC_popMsgTout(void *data, int tout)
 	return QUEUE_VALID;
 }
 
+/* Function to push several messages into queue with timeout */
+int IPC_pushMsgBatch(uint16_t cpuid, const void *data, int count, int tout)
+{
+	struct ipc_queue *qwr = &q_ipc[cpuid];
+	uint32_t n;
+
+	if (!QUEUE_IS_VALID(qwr) || (count <= 0)) {
+		return QUEUE_ERROR;
+	}
+
+	if ((tout == 0) && QUEUE_IS_FULL(qwr)) {
+		return QUEUE_FULL;
+	}
+
+	while (QUEUE_IS_FULL(qwr)) {
+		if (IPC_EventHandler(IPC_EVENT_WAIT_TX, cpuid, tout) && (tout > 0)) {
+			return QUEUE_TIMEOUT;
+		}
+	}
+
+	n = qwr->count - QUEUE_DATA_COUNT(qwr);
+	if (n > (uint32_t) count) {
+		n = count;
+	}
+	ipc_copy_in(qwr, qwr->head, data, n);
+	__DMB();
+	qwr->head += n;
+	ipc_push_signal(qwr);
+
+	return n;
+}
+
+/* Function to read several messages from queue with timeout */
+int IPC_popMsgBatch(void *data, int max, int tout)
+{
+	struct ipc_queue *qrd = &q_ipc[CPUID_CURR];
+	uint8_t *dst = data;
+	uint32_t popped = 0;
+	uint32_t n;
+	int raise_event;
+
+	if (!QUEUE_IS_VALID(qrd) || (max <= 0)) {
+		return QUEUE_ERROR;
+	}
+
+	while (1) {
+		/* pushes from here on are seen by the loop below, no need to
+		   signal them */
+		qrd->draining = 1;
+		__DMB();
+		while (1) {
+			n = QUEUE_DATA_COUNT(qrd);
+			if (n > (max - popped)) {
+				n = max - popped;
+			}
+			if (n) {
+				raise_event = QUEUE_IS_FULL(qrd);
+				__DMB();
+				ipc_copy_out(qrd, qrd->tail, dst + (popped * qrd->size), n);
+				__DMB();
+				qrd->tail += n;
+				popped += n;
+				if (raise_event) {
+					ipc_send_signal();
+				}
+			}
+			if (popped == (uint32_t) max) {
+				break;
+			}
+
+			/* empty: let pushes signal again, then look once more for one
+			   that saw the flag still set */
+			qrd->draining = 0;
+			__DMB();
+			if (QUEUE_IS_EMPTY(qrd)) {
+				break;
+			}
+			qrd->draining = 1;
+			__DMB();
+		}
+		qrd->draining = 0;
+
+		if (popped) {
+			return popped;
+		}
+		if (tout == 0) {
+			return QUEUE_EMPTY;
+		}
+		if (IPC_EventHandler(IPC_EVENT_WAIT_RX, CPUID_CURR, tout) && (tout > 0)) {
+			return QUEUE_TIMEOUT;
+		}
+	}
+}
+
 /* Get number of pending items in queue */
 int IPC_msgPending(uint16_t cpu)
 {
@@ -72,7 +72,8 @@ struct ipc_queue {
 	volatile uint32_t tail;		/*!< Tail index of the queue */
 	uint8_t *data;				/*!< Pointer to the data */
 	uint32_t valid;				/*!< Queue is valid only if this is #QUEUE_MAGIC_VALID */
-	uint32_t reserved[2];		/*!< Reserved entry to keep the structure aligned */
+	volatile uint32_t draining;	/*!< Reader is draining the queue, pushes need not signal it */
+	uint32_t reserved[1];		/*!< Reserved entry to keep the structure aligned */
 };
 
 /* IPC Function return values */
@@ -175,6 +176,48 @@ int IPC_pushMsgTout(uint16_t cpuid, const void *data, int tout);
  */
 int IPC_popMsgTout(void *data, int tout);
 
+/**
+ * @brief	Function to push several messages into queue with timeout
+ *
+ * This function will push up to \a count messages of the queue's message
+ * size, stored back to back at \a data, and signal the other core once.
+ * It pushes as many as fit, waiting as IPC_pushMsgTout() does only when
+ * none fit. No signal is raised while the other core is inside
+ * IPC_popMsgBatch(), which picks the messages up anyway.
+ *
+ * @param   cpuid   : ID of the CPU which will receive the messages
+ * @param	data	: Pointer to the messages to be pushed
+ * @param	count	: Number of messages at \a data
+ * @param	tout	: non-zero value - timeout value in milliseconds,
+ *                      zero value - no blocking,
+ *                      negative value - blocking
+ * @return  Number of messages pushed (1 to \a count) on success,
+ * @note	#QUEUE_FULL or #QUEUE_ERROR on failure,
+ *          #QUEUE_TIMEOUT when there is a timeout
+ */
+int IPC_pushMsgBatch(uint16_t cpuid, const void *data, int count, int tout);
+
+/**
+ * @brief	Function to read several messages from queue with timeout
+ *
+ * This function will pop up to \a max messages into \a data, back to
+ * back, waiting as IPC_popMsgTout() does only when the queue is empty.
+ * While it drains, pushes from the other core don't raise events.
+ *
+ * @param	data	: Pointer to store the popped messages, room for \a max
+ * @param	max		: Largest number of messages to pop
+ * @param	tout	: non-zero value - timeout value in milliseconds,
+ *                      zero value - no blocking,
+ *                      negative value - blocking
+ * @return	Number of messages popped (1 to \a max) on success,
+ * @note	#QUEUE_EMPTY or #QUEUE_ERROR on failure,
+ *          #QUEUE_TIMEOUT when there is a timeout. A call returning fewer
+ *          than \a max messages leaves the queue empty, with pushes
+ *          signalling again; after one returning \a max, call it again as
+ *          more messages may have arrived without a signal.
+ */
+int IPC_popMsgBatch(void *data, int max, int tout);
+
 /**
  * @brief	Function to push the message into queue with no wait
  *
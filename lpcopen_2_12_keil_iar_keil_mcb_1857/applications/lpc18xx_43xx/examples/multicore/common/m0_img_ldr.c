@@ -36,6 +36,30 @@
  * Private types/enumerations/variables
  ****************************************************************************/
 
+/* Image copy started by M0Image_LoadStart() */
+static GPDMA_JOB_T m0_copy_job;
+static uint8_t m0_copy_ch = GPDMA_NO_CHANNEL;
+static volatile int m0_copy_state;	/* 1 copying, 0 done, < 0 failed */
+static uint32_t m0_exec_addr;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Address the reset handler of an image links to, as a 1M region */
+static uint32_t m0_image_region(uint32_t image_addr)
+{
+	return (*(unsigned long *) (image_addr + 4)) & 0xFFF00000;
+}
+
+/* Image copy completion, from Chip_GPDMA_JobIRQHandler() */
+static void m0_copy_done(GPDMA_JOB_T *pJob, Status status)
+{
+	Chip_GPDMA_Stop(LPC_GPDMA, m0_copy_ch);
+	m0_copy_ch = GPDMA_NO_CHANNEL;
+	m0_copy_state = (status == SUCCESS) ? 0 : -3;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -80,3 +104,50 @@ int M0Image_Boot(CPUID_T cpuid, uint32_t m0_image_addr)
 	return 0;
 }
 
+/* Start moving an M0 image to where it runs */
+int M0Image_LoadStart(uint32_t dst_addr, uint32_t src_addr, uint32_t size)
+{
+	if (m0_copy_state > 0) {
+		return -1;
+	}
+
+	/* Linked to run where it sits, execute in place */
+	m0_exec_addr = src_addr;
+	m0_copy_state = 0;
+	if (m0_image_region(src_addr) == (src_addr & 0xFFF00000)) {
+		return 0;
+	}
+
+	/* Otherwise it must be linked for the destination */
+	if ((dst_addr & 0xFFF) || (m0_image_region(src_addr) != (dst_addr & 0xFFF00000))) {
+		return -2;
+	}
+
+	m0_copy_ch = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, GPDMA_CONN_MEMORY);
+	if (m0_copy_ch == GPDMA_NO_CHANNEL) {
+		return -1;
+	}
+
+	m0_exec_addr = dst_addr;
+	m0_copy_state = 1;
+	if (Chip_GPDMA_MemcpyAsync(LPC_GPDMA, m0_copy_ch, &m0_copy_job, (void *) dst_addr,
+							   (const void *) src_addr, size, m0_copy_done) != SUCCESS) {
+		m0_copy_done(&m0_copy_job, ERROR);
+		return -3;
+	}
+
+	return 1;
+}
+
+/* Wait for the image copy and boot the M0 */
+int M0Image_LoadBoot(CPUID_T cpuid)
+{
+	while (m0_copy_state > 0) {
+		__WFI();
+	}
+	if (m0_copy_state < 0) {
+		return m0_copy_state;
+	}
+
+	return M0Image_Boot(cpuid, m0_exec_addr);
+}
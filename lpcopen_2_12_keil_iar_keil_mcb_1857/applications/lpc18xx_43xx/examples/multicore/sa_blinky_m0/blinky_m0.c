@@ -38,6 +38,9 @@
 #include "app_multicore_cfg.h"
 #include "ipc_example.h"
 #include "ipc_msg.h"
+#ifdef EXAMPLE_IPC_BENCH
+#include "ipc_bench.h"
+#endif
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -59,7 +62,11 @@ static void prvSetupHardware(void)
 	SystemCoreClockUpdate();
 
 	/* Initialize the IPC Queue */
+#ifdef EXAMPLE_IPC_BENCH
+	IPC_BENCH_Init();
+#else
 	IPCEX_Init();
+#endif
 
 	NVIC_EnableIRQ(M4_IRQn);
 }
@@ -77,6 +84,10 @@ void M4_IRQHandler(void)
 	ipcex_msg_t msg;
 	Chip_CREG_ClearM4Event();
 
+#ifdef EXAMPLE_IPC_BENCH
+	/* Only wakes the core, ipc_bench_tasks() pops */
+	return;
+#endif
 	if (IPC_tryPopMsg(&msg) != QUEUE_VALID) {
 		return;
 	}
@@ -111,7 +122,11 @@ int main(void)
 	int loop = 1;
 	prvSetupHardware();
 	while (loop) {
+#ifdef EXAMPLE_IPC_BENCH
+		ipc_bench_tasks();
+#else
 		__WFI();
+#endif
 	}
 	return 0;
 }
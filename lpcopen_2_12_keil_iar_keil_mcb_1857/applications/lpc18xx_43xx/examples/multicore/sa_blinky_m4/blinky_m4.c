@@ -38,6 +38,9 @@
 #include "app_multicore_cfg.h"
 #include "ipc_example.h"
 #include "ipc_msg.h"
+#ifdef EXAMPLE_IPC_BENCH
+#include "ipc_bench.h"
+#endif
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -70,11 +73,16 @@ static void prvSetupHardware(void)
 	}
 #endif
 
+#ifdef EXAMPLE_IPC_BENCH
+	/* The benchmark owns the IPC queues, blinky stays off */
+	IPC_BENCH_Init();
+#else
 	/* Initialize the IPC Queue */
 	IPCEX_Init();
 
 	/* Start the tick timer */
 	SysTick_Config(SystemCoreClock / 1000);
+#endif
 }
 
 /*****************************************************************************
@@ -121,7 +129,11 @@ int main(void)
 	int loop = 1;
 	prvSetupHardware();
 	while (loop) {
+#ifdef EXAMPLE_IPC_BENCH
+		ipc_bench_tasks();
+#else
 		__WFI();
+#endif
 	}
 	return 0;
 }
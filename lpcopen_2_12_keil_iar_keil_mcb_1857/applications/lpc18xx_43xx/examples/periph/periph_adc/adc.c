@@ -62,15 +62,22 @@ static const char *WelcomeMenu = "\r\nHello NXP Semiconductors \r\n"
 							"Press \'k\' or \'l\' to set Bit accuracy "
 							"(valid only when Burst mode is enabled)\r\n"
 							"Press \'b\' to ENABLE or DISABLE Burst Mode\r\n";
-static const char *SelectMenu = "\r\nPress number 1-3 to choose ADC running mode:\r\n"
+static const char *SelectMenu = "\r\nPress number 1-4 to choose ADC running mode:\r\n"
 						   "\t1: Polling Mode \r\n"
 						   "\t2: Interrupt Mode \r\n"
-						   "\t3: DMA Mode \r\n";
+						   "\t3: DMA Mode \r\n"
+						   "\t4: DMA Streaming Mode \r\n";
 
 static ADC_CLOCK_SETUP_T ADCSetup;
 static volatile uint8_t Burst_Mode_Flag = 0, Interrupt_Continue_Flag;
 static volatile uint8_t ADC_Interrupt_Done_Flag, channelTC, dmaChannelNum;
 uint32_t DMAbuffer;
+
+/* Streaming mode: ping-pong buffer of raw samples and the average of the last half */
+#define STREAM_SAMPLES 256
+static uint32_t streamBuffer[2 * STREAM_SAMPLES];
+static ADC_STREAM_T adcStream;
+static volatile uint16_t streamAverage;
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -138,6 +145,53 @@ static void App_DMA_Test(void)
 	}
 }
 
+/* Stream callback, runs from the DMA interrupt for each filled buffer half */
+static void App_Stream_Callback(ADC_STREAM_T *pStream, const uint32_t *pSamples, uint32_t count)
+{
+	uint32_t i, sum = 0;
+
+	for (i = 0; i < count; i++) {
+		sum += ADC_DR_RESULT(pSamples[i]);
+	}
+	streamAverage = sum / count;
+}
+
+/* DMA streaming routine for ADC example */
+static void App_Stream_Test(void)
+{
+	uint32_t printed = 0;
+
+	/* Initialize GPDMA controller */
+	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_DisableIRQ(DMA_IRQn);
+	NVIC_SetPriority(DMA_IRQn, ((0x01 << 3) | 0x01));
+	NVIC_EnableIRQ(DMA_IRQn);
+
+	/* Conversions run back to back in burst mode, the DMA moves every result */
+	if ((Chip_ADC_Stream_Init(&adcStream, _LPC_ADC_ID, LPC_GPDMA, streamBuffer, STREAM_SAMPLES,
+							  App_Stream_Callback) == ERROR) ||
+		(Chip_ADC_Stream_Start(&adcStream, ADC_NO_START, ADC_TRIGGERMODE_RISING) == ERROR)) {
+		DEBUGOUT("ADC stream start failed\r\n");
+		NVIC_DisableIRQ(DMA_IRQn);
+		return;
+	}
+
+	/* Print the block average until get 'x' character */
+	while (DEBUGIN() != 'x') {
+		if ((adcStream.halves - printed) >= 1024) {
+			printed = adcStream.halves;
+			DEBUGOUT("ADC average is : 0x%04x (%d blocks of %d samples)\r\n",
+					 streamAverage, printed, STREAM_SAMPLES);
+		}
+	}
+
+	/* Stop the stream, release DMA channel */
+	Chip_ADC_Stream_Stop(&adcStream);
+	Chip_GPDMA_Stop(LPC_GPDMA, adcStream.dmaChannel);
+	NVIC_DisableIRQ(DMA_IRQn);
+	adcStream.pBuffer = NULL;
+}
+
 /* Interrupt routine for ADC example */
 static void App_Interrupt_Test(void)
 {
@@ -248,6 +302,9 @@ void ADC1_IRQHandler(void)
  */
 void DMA_IRQHandler(void)
 {
+	if (adcStream.pBuffer && Chip_ADC_Stream_IRQHandler(&adcStream)) {
+		return;
+	}
 	if (Chip_GPDMA_Interrupt(LPC_GPDMA, dmaChannelNum) == SUCCESS) {
 		channelTC++;
 	}
@@ -283,7 +340,8 @@ int main(void)
 				bufferUART = 0xFF;
 				while (bufferUART == 0xFF) {
 					bufferUART = DEBUGIN();
-					if ((bufferUART != '1') && (bufferUART != '2') && (bufferUART != '3')) {
+					if ((bufferUART != '1') && (bufferUART != '2') && (bufferUART != '3') &&
+						(bufferUART != '4')) {
 						bufferUART = 0xFF;
 					}
 				}
@@ -299,6 +357,10 @@ int main(void)
 				case '3':		/* DMA mode */
 					App_DMA_Test();
 					break;
+
+				case '4':		/* DMA streaming mode */
+					App_Stream_Test();
+					break;
 				}
 				break;
 			}
@@ -39,12 +39,18 @@
 #define CCAN_TX_MSG_ID (0x200)
 #define CCAN_RX_MSG_ID (0x100)
 #define CCAN_TX_MSG_REMOTE_ID (0x300)
+#define CCAN_RX_FIFO_OBJS   (8)		/* Message objects chained for CCAN_RX_MSG_ID */
+#define CCAN_RX_RB_SIZE     (32)	/* Received messages buffered for the main loop */
 static char WelcomeMenu[] = "\n\rHello NXP Semiconductors \r\r"
 							"CCAN DEMO : Use C_CAN to transmit and receive Message from CAN Analyzer\r\n"
 							"CCAN bit rate : 500kBit/s\r\n";
 
 uint8_t msg_received_counter = 0;
 
+/* Hardware receive FIFO for CCAN_RX_MSG_ID, drained into a ring buffer */
+static CCAN_FIFO_T rx_fifo;
+static CCAN_MSG_OBJ_T rx_buffer[CCAN_RX_RB_SIZE];
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -60,7 +66,7 @@ uint8_t msg_received_counter = 0;
 void CAN0_IRQHandler(void)
 {
 	CCAN_MSG_OBJ_T msg_buf;
-	uint32_t can_int, can_stat, i;
+	uint32_t can_int, can_stat;
 	while ( (can_int = Chip_CCAN_GetIntID(LPC_C_CAN0)) != 0 ) {
 		if (can_int & CCAN_INT_STATUS) {
 			can_stat = Chip_CCAN_GetStatus(LPC_C_CAN0);
@@ -80,21 +86,13 @@ void CAN0_IRQHandler(void)
 			Chip_CCAN_ClearStatus(LPC_C_CAN0, CCAN_STAT_TXOK);
 			Chip_CCAN_ClearStatus(LPC_C_CAN0, CCAN_STAT_RXOK);
 		}
+		else if (Chip_CCAN_FIFO_IRQHandler(&rx_fifo, CCAN_INT_MSG_NUM(can_int))) {
+			/* Received messages are handled in the main loop */
+		}
 		else if ((1 <= CCAN_INT_MSG_NUM(can_int)) && (CCAN_INT_MSG_NUM(can_int) <= 0x20)) {
-			// Process msg num canint
-			Chip_CCAN_GetMsgObject(LPC_C_CAN0, CCAN_MSG_IF1, can_int, &msg_buf);
+			// Process msg num canint, IF1 is left to the main loop for sending
+			Chip_CCAN_GetMsgObject(LPC_C_CAN0, CCAN_MSG_IF2, can_int, &msg_buf);
 			switch (msg_buf.id) {
-			case CCAN_RX_MSG_ID:
-				DEBUGOUT("Msg ID :%x\r\n", msg_buf.id);
-				DEBUGOUT("Msg data :");
-				for (i = 0; i < msg_buf.dlc; i++) {
-					DEBUGOUT("%x ", msg_buf.data[i]);
-				}
-				DEBUGOUT("\r\nFeed back...\r\n");
-				msg_buf.id += 1;
-				Chip_CCAN_Send(LPC_C_CAN0, CCAN_MSG_IF1, false, &msg_buf);
-				break;
-
 			case CCAN_TX_MSG_ID:
 				break;
 
@@ -102,7 +100,7 @@ void CAN0_IRQHandler(void)
 				msg_received_counter++;
 				if (msg_received_counter == 5) {
 					DEBUGOUT("Remote transmit total is 5. Delete remote ID\r\n");
-					Chip_CCAN_DeleteReceiveID(LPC_C_CAN0, CCAN_MSG_IF1, CCAN_TX_MSG_REMOTE_ID);
+					Chip_CCAN_DeleteReceiveID(LPC_C_CAN0, CCAN_MSG_IF2, CCAN_TX_MSG_REMOTE_ID);
 				}
 				break;
 
@@ -115,7 +113,8 @@ void CAN0_IRQHandler(void)
 
 int main(void)
 {
-	CCAN_MSG_OBJ_T send_obj;
+	CCAN_MSG_OBJ_T send_obj, msg_buf;
+	uint32_t i, hw_overruns = 0, rb_overruns = 0;
 	SystemCoreClockUpdate();
 	Board_Init();
 	DEBUGOUT(WelcomeMenu);
@@ -142,9 +141,27 @@ int main(void)
 	Chip_CCAN_Send(LPC_C_CAN0, CCAN_MSG_IF1, true, &send_obj);
 	Chip_CCAN_ClearStatus(LPC_C_CAN0, CCAN_STAT_TXOK);
 
-	Chip_CCAN_AddReceiveID(LPC_C_CAN0, CCAN_MSG_IF1, CCAN_RX_MSG_ID);
+	Chip_CCAN_FIFO_Init(LPC_C_CAN0, &rx_fifo, CCAN_MSG_IF2, rx_buffer, CCAN_RX_RB_SIZE);
+	Chip_CCAN_FIFO_AddGroup(&rx_fifo, CCAN_MSG_IF1, CCAN_RX_MSG_ID, CCAN_MSG_ID_STD_MASK, CCAN_RX_FIFO_OBJS);
 
 	NVIC_EnableIRQ(C_CAN0_IRQn);
 
-	while (1) {}
+	while (1) {
+		while (Chip_CCAN_FIFO_Read(&rx_fifo, &msg_buf)) {
+			DEBUGOUT("Msg ID :%x\r\n", msg_buf.id);
+			DEBUGOUT("Msg data :");
+			for (i = 0; i < msg_buf.dlc; i++) {
+				DEBUGOUT("%x ", msg_buf.data[i]);
+			}
+			DEBUGOUT("\r\nFeed back...\r\n");
+			msg_buf.id += 1;
+			Chip_CCAN_Send(LPC_C_CAN0, CCAN_MSG_IF1, false, &msg_buf);
+		}
+
+		if ((rx_fifo.hwOverruns != hw_overruns) || (rx_fifo.rbOverruns != rb_overruns)) {
+			hw_overruns = rx_fifo.hwOverruns;
+			rb_overruns = rx_fifo.rbOverruns;
+			DEBUGOUT("Lost messages : %d in FIFO, %d in buffer\r\n", hw_overruns, rb_overruns);
+		}
+	}
 }
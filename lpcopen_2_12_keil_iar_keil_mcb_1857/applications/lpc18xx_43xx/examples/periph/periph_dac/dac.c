@@ -39,13 +39,20 @@
 static char WelcomeMenu[] = "\r\nHello NXP Semiconductors \r\n"
 							"DAC DEMO \r\n"
 							"Press \'c\' to continue or \'x\' to quit\r\n";
-static char SelectMenu[] = "\r\nPress number 1-3 to choose DAC running mode:\r\n"
+static char SelectMenu[] = "\r\nPress number 1-4 to choose DAC running mode:\r\n"
 						   "\t1: Polling Mode \r\n"
 						   "\t2: Interrupt Mode \r\n"
-						   "\t3: DMA Mode \r\n";
+						   "\t3: DMA Mode \r\n"
+						   "\t4: DMA Waveform Mode \r\n";
 static volatile uint8_t channelTC, dmaChannelNum;
 static volatile uint8_t DAC_Interrupt_Done_Flag, Interrupt_Continue_Flag;
 uint32_t DMAbuffer;
+
+/* Waveform mode: one period of a triangle wave, played at WAVE_RATE samples/s */
+#define WAVE_SAMPLES 256
+#define WAVE_RATE    100000
+static uint32_t waveTable[WAVE_SAMPLES];
+static DAC_STREAM_T dacStream;
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -95,6 +102,41 @@ static void App_DMA_Test(void)
 	NVIC_DisableIRQ(DMA_IRQn);
 }
 
+/* DMA waveform routine for DAC example */
+static void App_Wave_Test(void)
+{
+	uint16_t value;
+	int i;
+
+	/* Build a full scale triangle */
+	for (i = 0; i < WAVE_SAMPLES; i++) {
+		value = (i < (WAVE_SAMPLES / 2)) ? (i * 2 * 0x3FF / WAVE_SAMPLES) :
+				((WAVE_SAMPLES - i) * 2 * 0x3FF / WAVE_SAMPLES);
+		Chip_DAC_Stream_Format(LPC_DAC, &waveTable[i], &value, 1);
+	}
+
+	/* Initialize GPDMA controller */
+	Chip_GPDMA_Init(LPC_GPDMA);
+
+	/* The table loops in hardware, no interrupt is needed */
+	if ((Chip_DAC_Stream_InitTable(&dacStream, LPC_DAC, LPC_GPDMA, waveTable, WAVE_SAMPLES) == ERROR) ||
+		(Chip_DAC_Stream_Start(&dacStream, WAVE_RATE) == ERROR)) {
+		DEBUGOUT("DAC waveform start failed\r\n");
+		return;
+	}
+	DEBUGOUT("Triangle output at %d Hz, press 'x' to stop\r\n", WAVE_RATE / WAVE_SAMPLES);
+
+	while (DEBUGIN() != 'x') {}
+
+	/* Stop the waveform, release DMA channel */
+	Chip_DAC_Stream_Stop(&dacStream);
+	Chip_GPDMA_Stop(LPC_GPDMA, dacStream.dmaChannel);
+
+	/* Back to the counter setup used by the other modes */
+	Chip_DAC_SetDMATimeOut(LPC_DAC, 0xFFFF);
+	Chip_DAC_ConfigDAConverterControl(LPC_DAC, (DAC_CNT_ENA | DAC_DMA_ENA));
+}
+
 /* Interrupt routine for DAC example */
 static void App_Interrupt_Test(void)
 {
@@ -201,7 +243,8 @@ int main(void)
 				bufferUART = 0xFF;
 				while (bufferUART == 0xFF) {
 					bufferUART = DEBUGIN();
-					if ((bufferUART != '1') && (bufferUART != '2') && (bufferUART != '3')) {
+					if ((bufferUART != '1') && (bufferUART != '2') && (bufferUART != '3') &&
+						(bufferUART != '4')) {
 						bufferUART = 0xFF;
 					}
 				}
@@ -217,6 +260,10 @@ int main(void)
 				case '3':		/* DMA mode */
 					App_DMA_Test();
 					break;
+
+				case '4':		/* DMA waveform mode */
+					App_Wave_Test();
+					break;
 				}
 				break;
 			}
@@ -44,15 +44,21 @@
 #define ENET_NUM_TX_DESC 4
 #define ENET_NUM_RX_DESC 4
 
-static ENET_ENHTXDESC_T TXDescs[ENET_NUM_TX_DESC];
-static ENET_ENHRXDESC_T RXDescs[ENET_NUM_RX_DESC];
+/* Descriptors and buffers are only touched by the ENET DMA and the
+   handlers here, keep them off the bank the CPU runs its stack from */
+static DMAMEM ENET_ENHTXDESC_T TXDescs[ENET_NUM_TX_DESC];
+static DMAMEM ENET_ENHRXDESC_T RXDescs[ENET_NUM_RX_DESC];
 
 /* Transmit/receive buffers and indices */
-static uint8_t TXBuffer[ENET_NUM_TX_DESC][EMAC_ETH_MAX_FLEN];
-static uint8_t RXBuffer[ENET_NUM_RX_DESC][EMAC_ETH_MAX_FLEN];
+static DMAMEM uint8_t TXBuffer[ENET_NUM_TX_DESC][EMAC_ETH_MAX_FLEN];
+static DMAMEM uint8_t RXBuffer[ENET_NUM_RX_DESC][EMAC_ETH_MAX_FLEN];
 static int32_t rxFill, rxGet, rxAvail, rxNumDescs;
 static int32_t txFill, txGet, txUsed, txNumDescs;
 
+/* PHY status from the link change callback */
+static volatile uint32_t linkSts;
+static volatile bool linkChanged;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -61,14 +67,11 @@ static int32_t txFill, txGet, txUsed, txNumDescs;
  * Private functions
  ****************************************************************************/
 
-/* Local delay function used by the ENET or PHY drivers . This can be
-   replaced with something more accurate if needed. */
-static void localMsDelay(uint32_t ms)
+/* PHY link change callback, the MAC speed and duplex are already set */
+static void linkChange(uint32_t physts)
 {
-	ms = ms * 50000;
-	while (ms > 0) {
-		ms--;
-	}
+	linkSts = physts;
+	linkChanged = true;
 }
 
 /* Local index and check function */
@@ -91,7 +94,7 @@ static void InitDescriptors(
 
 	/* Setup the descriptor list to a default state */
 	memset(pTXDescs, 0, numTXDescs * sizeof(*pTXDescs));
-	memset(pTXDescs, 0, numRXDescs * sizeof(*pRXDescs));
+	memset(pRXDescs, 0, numRXDescs * sizeof(*pRXDescs));
 	rxFill = rxGet = 0;
 	rxAvail = rxNumDescs = numRXDescs;
 	txNumDescs = numTXDescs;
@@ -200,6 +203,15 @@ static void *ENET_TXBuffClaim(void)
  * Public functions
  ****************************************************************************/
 
+/**
+ * @brief	SysTick interrupt handler, runs the PHY state machine
+ * @return	Nothing
+ */
+void SysTick_Handler(void)
+{
+	lpc_phy_async_tick();
+}
+
 /**
  * @brief	Handle interrupt from ethernet
  * @return	Nothing
@@ -229,11 +241,14 @@ int main(void)
 
 	/* Setup ethernet and PHY */
 	Chip_ENET_Init(LPC_ETHERNET);
+	/* The PHY comes up in the background from a 1mS tick, the MAC is
+	   usable right away and the link joins when autonegotiation is done */
 #if defined(USE_RMII)
-	lpc_phy_init(true, localMsDelay);
+	lpc_phy_init_async(true, linkChange);
 #else
-	lpc_phy_init(false, localMsDelay);
+	lpc_phy_init_async(false, linkChange);
 #endif
+	SysTick_Config(SystemCoreClock / 1000);
 
 	/* Setup MAC address for device */
 	Board_ENET_GetMacADDR(macaddr);
@@ -321,22 +336,12 @@ int main(void)
 		   static, there isn't too much to do. */
 		ENET_TXBuffClaim();
 
-		/* PHY status state machine, LED on when connected. This function will
-		   not block. */
-		physts = lpcPHYStsPoll();
-
-		/* Only check for connection state when the PHY status has changed */
-		if (physts & PHY_LINK_CHANGED) {
-			if (physts & PHY_LINK_CONNECTED) {
-				Board_LED_Set(0, true);
-
-				/* Set interface speed and duplex */
-				Chip_ENET_SetDuplex(LPC_ETHERNET, (bool) (physts & PHY_LINK_FULLDUPLX));
-				Chip_ENET_SetSpeed(LPC_ETHERNET, (bool) (physts & PHY_LINK_SPEED100));
-			}
-			else {
-				Board_LED_Set(0, false);
-			}
+		/* Only check for connection state when the PHY status has changed,
+		   LED on when connected */
+		if (linkChanged) {
+			linkChanged = false;
+			physts = linkSts;
+			Board_LED_Set(0, (physts & PHY_LINK_CONNECTED) != 0);
 
 			DEBUGOUT("Link connect status: %d\r\n", ((physts & PHY_LINK_CONNECTED) != 0));
 		}
@@ -56,7 +56,8 @@
 #warning "WARNING: Unknown board configuration!"
 #endif
 
-static I2CM_XFER_T  i2cmXferRec;
+static I2CM_QUEUE_T i2cmQueue;
+static I2CM_QUEUE_JOB_T i2cmJob;
 
 /*****************************************************************************
  * Public types/enumerations/variables
@@ -140,17 +141,19 @@ static void SetupXferRecAndExecute(uint8_t devAddr,
 								   uint16_t rxSize)
 {
 	/* Setup I2C transfer record */
-	i2cmXferRec.slaveAddr = devAddr;
-	i2cmXferRec.options = 0;
-	i2cmXferRec.status = 0;
-	i2cmXferRec.txSz = txSize;
-	i2cmXferRec.rxSz = rxSize;
-	i2cmXferRec.txBuff = txBuffPtr;
-	i2cmXferRec.rxBuff = rxBuffPtr;
-	Chip_I2CM_Xfer(LPC_I2C0, &i2cmXferRec);
+	i2cmJob.xfer.slaveAddr = devAddr;
+	i2cmJob.xfer.options = 0;
+	i2cmJob.xfer.status = 0;
+	i2cmJob.xfer.txSz = txSize;
+	i2cmJob.xfer.rxSz = rxSize;
+	i2cmJob.xfer.txBuff = txBuffPtr;
+	i2cmJob.xfer.rxBuff = rxBuffPtr;
+	i2cmJob.chain = false;
+	i2cmJob.callback = NULL;
+	Chip_I2CM_QueueSubmit(&i2cmQueue, &i2cmJob);
 
 	/* Wait for transfer completion */
-	WaitForI2cXferComplete(&i2cmXferRec);
+	WaitForI2cXferComplete(&i2cmJob.xfer);
 }
 
 /* Perform I2CM write on target board */
@@ -250,8 +253,8 @@ static void ReadBoard_I2CM()
  */
 void I2C0_IRQHandler(void)
 {
-	/* Call I2CM ISR function with the I2C device and transfer rec */
-	Chip_I2CM_XferHandler(LPC_I2C0, &i2cmXferRec);
+	/* Run the I2CM transfer queue on I2C0 */
+	Chip_I2CM_QueueIRQHandler(&i2cmQueue);
 }
 
 /**
@@ -266,6 +269,7 @@ int main(void)
 
 	SystemCoreClockUpdate();
 	Board_Init();
+	Chip_I2CM_QueueInit(&i2cmQueue, LPC_I2C0);
 	i2c_app_init(I2C0, SPEED_100KHZ);
 
 	/* Loop forever */
@@ -1,6 +1,7 @@
 /*
  * @brief I2S example
- * This example show how to use the I2S in 3 modes : Polling, Interrupt and DMA
+ * This example show how to use the I2S in 4 modes : Polling, Interrupt, DMA and
+ * a ping-pong DMA audio pipeline
  *
  * @note
  * Copyright(C) NXP Semiconductors, 2013
@@ -31,6 +32,7 @@
  */
 
 #include "board.h"
+#include <string.h>
 
 #ifndef BOARD_NXP_LPCXPRESSO_4337
 #define CODEC_I2S_BUS   LPC_I2S0
@@ -60,6 +62,9 @@
 #define BUFFER_EMPTY 1
 #define BUFFER_AVAILABLE 2
 
+/* Audio pipeline period in words (one stereo 16-bit frame per word) */
+#define AUDIO_PERIOD 256
+
 typedef struct ring_buff {
 	uint32_t buffer[256];
 	uint8_t read_index;
@@ -71,6 +76,7 @@ static char WelcomeMenu[] = "\r\nHello NXP Semiconductors \r\n"
 							"Please press \'1\' to test Polling mode\r\n"
 							"Please press \'2\' to test Interrupt mode\r\n"
 							"Please press \'3\' to test DMA mode\r\n"
+							"Please press \'4\' to test DMA audio pipeline mode\r\n"
 							"Please press \'x\' to exit test mode\r\n"
 							"Please press \'m\' to DISABLE/ENABLE mute\r\n";
 
@@ -81,6 +87,11 @@ static uint8_t channelTC;
 static uint8_t dmaChannelNum_I2S_Tx, dmaChannelNum_I2S_Rx;
 static uint8_t dma_send_receive;
 
+static I2S_AUDIO_T audioPipe;
+static uint32_t audioTx[2 * AUDIO_PERIOD], audioRx[2 * AUDIO_PERIOD];
+static uint32_t audioLatest[AUDIO_PERIOD];
+static volatile bool audioRunning;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -234,6 +245,68 @@ DEBUGOUT("I2S DMA mode\r\n");
 	}
 }
 
+/* Keeps the most recently captured period for the playback side */
+static void App_Audio_RxPeriod(I2S_AUDIO_T *pAudio, uint32_t *pPeriod, uint32_t words)
+{
+	memcpy(audioLatest, pPeriod, words * sizeof(uint32_t));
+}
+
+/* Refills the period that just played with the latest capture */
+static void App_Audio_TxPeriod(I2S_AUDIO_T *pAudio, uint32_t *pPeriod, uint32_t words)
+{
+	memcpy(pPeriod, audioLatest, words * sizeof(uint32_t));
+}
+
+/* DMA audio pipeline routine for I2S example */
+static void App_Audio_Test(void)
+{
+	uint8_t continue_Flag = 1, bufferUART = 0xFF;
+
+	DEBUGOUT("I2S DMA audio pipeline mode\r\n");
+	memset(audioTx, 0, sizeof(audioTx));
+	memset(audioLatest, 0, sizeof(audioLatest));
+
+	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_DisableIRQ(DMA_IRQn);
+	NVIC_SetPriority(DMA_IRQn, ((0x01 << 3) | 0x01));
+	NVIC_EnableIRQ(DMA_IRQn);
+
+	if ((Chip_I2S_Audio_Init(&audioPipe, CODEC_I2S_BUS, LPC_GPDMA, AUDIO_PERIOD,
+							 audioTx, App_Audio_TxPeriod, audioRx, App_Audio_RxPeriod) == ERROR) ||
+		(Chip_I2S_Audio_Start(&audioPipe) == ERROR)) {
+		DEBUGOUT("Audio pipeline start failed\r\n");
+		NVIC_DisableIRQ(DMA_IRQn);
+		DEBUGOUT(WelcomeMenu);
+		return;
+	}
+	audioRunning = true;
+
+	while (continue_Flag) {
+		bufferUART = 0xFF;
+		bufferUART = Con_GetInput();
+		switch (bufferUART) {
+		case 'x':
+			continue_Flag = 0;
+			audioRunning = false;
+			Chip_I2S_Audio_Stop(&audioPipe);
+			Chip_GPDMA_Stop(LPC_GPDMA, audioPipe.txChannel);
+			Chip_GPDMA_Stop(LPC_GPDMA, audioPipe.rxChannel);
+			NVIC_DisableIRQ(DMA_IRQn);
+			DEBUGOUT("Periods played %d, captured %d, xruns tx %d rx %d\r\n",
+					 audioPipe.txPeriods, audioPipe.rxPeriods, audioPipe.txXruns, audioPipe.rxXruns);
+			DEBUGOUT(WelcomeMenu);
+			break;
+
+		case 'm':
+			mute_toggle();
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -244,6 +317,11 @@ DEBUGOUT("I2S DMA mode\r\n");
  */
 void DMA_IRQHandler(void)
 {
+	if (audioRunning) {
+		Chip_I2S_Audio_IRQHandler(&audioPipe);
+		return;
+	}
+
 	if (dma_send_receive == 1) {
 		if (Chip_GPDMA_Interrupt(LPC_GPDMA, dmaChannelNum_I2S_Rx) == SUCCESS) {
 			channelTC++;
@@ -334,6 +412,10 @@ int main(void)
 			App_DMA_Test();
 			break;
 
+		case '4':
+			App_Audio_Test();
+			break;
+
 		case 'x':
 			continue_Flag = 0;
 			DEBUGOUT("Thanks for using\r\n");
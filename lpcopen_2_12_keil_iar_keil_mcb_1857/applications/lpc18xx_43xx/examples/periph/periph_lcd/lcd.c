@@ -41,8 +41,12 @@
 #define LOGO_WIDTH      110
 #define LOGO_HEIGHT     42
 
-/* pointer to frame buffer */
-static uint16_t *framebuffer = (uint16_t *) FRAMEBUFFER_ADDR;
+#define FRAME_BYTES     (LCD_WIDTH * LCD_HEIGHT * sizeof(uint16_t))
+#define TOUCH_SAMPLE_MS 10
+
+/* Two frame buffers in SDRAM, drawn into while the other one is shown */
+static void *framebuffers[2];
+static LCD_FB_T lcdFb;
 static volatile uint32_t msec;
 
 /*****************************************************************************
@@ -57,10 +61,30 @@ extern const unsigned short image[];
  ****************************************************************************/
 
 /* Put a pixel at the x, y coordinate */
-static void putpixel(uint32_t x, uint32_t y, uint16_t val) {
+static void putpixel(uint16_t *framebuffer, uint32_t x, uint32_t y, uint16_t val) {
 	framebuffer[x + y * LCD_WIDTH] = val;
 }
 
+/* Draw the colorbars with the NXP logo at a vertical position */
+static void drawFrame(uint16_t *framebuffer, uint32_t logo_y)
+{
+	uint32_t i, j;
+
+	/* Fill Colorbar only*/
+	for (i = 0; i < LCD_WIDTH * LCD_HEIGHT / 4; i++)
+		framebuffer[i] = 0x1F;
+	for (i = LCD_WIDTH * LCD_HEIGHT / 4; i < LCD_WIDTH * LCD_HEIGHT * 2 / 4; i++)
+		framebuffer[i] = 0x3F << 5;
+	for (i = LCD_WIDTH * LCD_HEIGHT * 2 / 4; i < LCD_WIDTH * LCD_HEIGHT * 3 / 4; i++)
+		framebuffer[i] = 0x1F << 11;
+	for (i = LCD_WIDTH * LCD_HEIGHT * 3 / 4; i < LCD_WIDTH * LCD_HEIGHT; i++)
+		framebuffer[i] = 0xFFFF;
+	/* Fill NXP logo */
+	for (j = 0; j < LOGO_HEIGHT; j++)
+		for (i = 0; i < LOGO_WIDTH; i++)
+			putpixel(framebuffer, i, j + logo_y, image[(i + j * LOGO_WIDTH)]);
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -71,9 +95,47 @@ static void putpixel(uint32_t x, uint32_t y, uint16_t val) {
  */
 void SysTick_Handler(void)
 {
+	static uint32_t touchTicks;
+
 	if (msec) {
 		msec--;
 	}
+
+	/* Sample the touch screen in the background */
+	if (++touchTicks >= TOUCH_SAMPLE_MS) {
+		touchTicks = 0;
+		Board_Touch_Sample();
+	}
+}
+
+/**
+ * @brief	I2C0 Interrupt Handler, runs the touch sampling
+ * @return	Nothing
+ */
+void I2C0_IRQHandler(void)
+{
+	Board_Touch_I2CIRQHandler();
+}
+
+#if defined(TSC_INT_GPIO_PORT)
+/**
+ * @brief	Touch controller pin interrupt Handler
+ * @return	Nothing
+ */
+void GPIO1_IRQHandler(void)
+{
+	Board_Touch_PinIRQHandler();
+}
+
+#endif
+
+/**
+ * @brief	LCD Interrupt Handler, completes page flips
+ * @return	Nothing
+ */
+void LCD_IRQHandler(void)
+{
+	Chip_LCD_FB_IRQHandler(&lcdFb);
 }
 
 /**
@@ -82,7 +144,9 @@ void SysTick_Handler(void)
  */
 int main(void)
 {
-	uint32_t i, j;
+	uint32_t logo_y = 0;
+	int logo_dir = 1;
+	uint16_t *framebuffer;
 	int cursor_x = 100, cursor_y = 150;
 	int16_t tmp_x = -1, tmp_y = -1;
 
@@ -94,24 +158,15 @@ int main(void)
 	msec = 5;
 	while (msec) {}
 
-	/* Fill Colorbar only*/
-	for (i = 0; i < LCD_WIDTH * LCD_HEIGHT / 4; i++)
-		framebuffer[i] = 0x1F;
-	for (i = LCD_WIDTH * LCD_HEIGHT / 4; i < LCD_WIDTH * LCD_HEIGHT * 2 / 4; i++)
-		framebuffer[i] = 0x3F << 5;
-	for (i = LCD_WIDTH * LCD_HEIGHT * 2 / 4; i < LCD_WIDTH * LCD_HEIGHT * 3 / 4; i++)
-		framebuffer[i] = 0x1F << 11;
-	for (i = LCD_WIDTH * LCD_HEIGHT * 3 / 4; i < LCD_WIDTH * LCD_HEIGHT; i++)
-		framebuffer[i] = 0xFFFF;
-	/* Fill NXP logo */
-	for (j = 0; j < LOGO_HEIGHT; j++)
-		for (i = 0; i < LOGO_WIDTH; i++)
-			putpixel(i, j, image[(i + j * LOGO_WIDTH)]);
+	framebuffers[0] = (void *) FRAMEBUFFER_ADDR;
+	framebuffers[1] = (void *) (FRAMEBUFFER_ADDR + FRAME_BYTES);
+	drawFrame((uint16_t *) framebuffers[0], logo_y);
 
 	Chip_LCD_Init(LPC_LCD, (LCD_CONFIG_T *) &BOARD_LCD);
 
-	Board_InitTouchController();
-	Chip_LCD_SetUPFrameBuffer(LPC_LCD,  (void *) framebuffer);
+	Board_Touch_Init();
+	Chip_LCD_FB_Init(LPC_LCD, &lcdFb, framebuffers, 2, FRAME_BYTES);
+	NVIC_EnableIRQ(LCD_IRQn);
 	Chip_LCD_PowerOn(LPC_LCD);
 	msec = 100;
 	while (msec) {}
@@ -130,8 +185,7 @@ int main(void)
 	while (msec) {}
 
 	while (1) {
-		Board_GetTouchPos((int16_t *) &tmp_x, (int16_t *) &tmp_y);
-		if ((tmp_x >= 0) && (tmp_y >= 0)) {
+		if (Board_Touch_GetLatest(&tmp_x, &tmp_y) && (tmp_x >= 0) && (tmp_y >= 0)) {
 			cursor_x = tmp_x;
 			cursor_y = tmp_y;
 		}
@@ -144,5 +198,20 @@ int main(void)
 			cursor_y = (LCD_HEIGHT - CURSOR_V_OFS);
 		}
 		Chip_LCD_Cursor_SetPos(LPC_LCD, cursor_x, cursor_y);
+
+		/* Move the logo in the back buffer once the last flip is shown */
+		framebuffer = (uint16_t *) Chip_LCD_FB_GetBackBuffer(&lcdFb);
+		if (framebuffer) {
+			if ((logo_y == 0) && (logo_dir < 0)) {
+				logo_dir = 1;
+			}
+			else if ((logo_y + LOGO_HEIGHT >= LCD_HEIGHT) && (logo_dir > 0)) {
+				logo_dir = -1;
+			}
+			logo_y += logo_dir;
+
+			drawFrame(framebuffer, logo_y);
+			Chip_LCD_FB_Flip(&lcdFb);
+		}
 	}
 }
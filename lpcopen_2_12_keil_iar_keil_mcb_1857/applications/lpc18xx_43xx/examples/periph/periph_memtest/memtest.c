@@ -49,6 +49,43 @@
 #define DRAM_SIZE (8 * 1024 * 1024)
 #endif
 
+/* Benchmark regions, kept clear of the 0x10000000 IRAM the example runs in.
+   SPIFI is only readable once the SPIFI controller is in memory mode (for
+   example when booting from it), define MEMBENCH_SPIFI to include it. */
+typedef struct {
+	const char *name;
+	uint32_t *start_addr;
+	uint32_t bytes;
+	bool read_only;
+} MEMBENCH_REGION_T;
+
+static const MEMBENCH_REGION_T benchRegions[] = {
+	{"Local SRAM bank 2", (uint32_t *) 0x10080000, (32 * 1024), false},
+	{"AHB SRAM", (uint32_t *) 0x2000C000, (16 * 1024), false},
+	{"EMC SDRAM", DRAM_BASE_ADDRESS, (64 * 1024), false},
+	{"Internal flash", (uint32_t *) 0x1A000000, (64 * 1024), true},
+#if defined(MEMBENCH_SPIFI)
+	{"SPIFI flash", (uint32_t *) 0x14000000, (64 * 1024), true},
+#endif
+};
+
+/* Contention runs, the CPU reads the lower 16KB of local SRAM bank 2 while
+   the GPDMA copies in the upper part of the same bank, in an AHB SRAM block
+   or in SDRAM. The gap to the idle figure shows which DMA placement (ENET
+   descriptors and buffers, see DMAMEM in lpc_types.h) leaves the CPU alone. */
+#define CONTEND_CPU_ADDR (uint32_t *) 0x10080000
+#define CONTEND_CPU_SIZE (16 * 1024)
+
+static const MEMBENCH_REGION_T contendRegions[] = {
+	{"Local SRAM bank 2", (uint32_t *) 0x10088000, (8 * 1024), false},
+	{"AHB SRAM", (uint32_t *) 0x2000C000, (16 * 1024), false},
+	{"EMC SDRAM", DRAM_BASE_ADDRESS, (64 * 1024), false},
+};
+
+/* Define MEMTEST_POST to run the fast power-on test of the whole SDRAM in
+   the background instead of the full CPU tests */
+/* #define MEMTEST_POST */
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -57,6 +94,112 @@
  * Private functions
  ****************************************************************************/
 
+/* Bandwidth and latency of each benchmark region, CPU against GPDMA */
+static void memBenchmark(void)
+{
+	MEM_BENCH_SETUP_T bench;
+	int i;
+
+	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_DisableIRQ(DMA_IRQn);
+
+	DEBUGSTR("\r\nRegion              read KB/s  write KB/s  copy KB/s  DMA copy KB/s  random read clks\r\n");
+	for (i = 0; i < (int) (sizeof(benchRegions) / sizeof(benchRegions[0])); i++) {
+		bench.start_addr = benchRegions[i].start_addr;
+		bench.bytes = benchRegions[i].bytes;
+		bench.read_only = benchRegions[i].read_only;
+		bench.dma_channel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, 0);
+		if (!mem_bench_run(&bench)) {
+			DEBUGOUT("%-18s benchmark failed\r\n", benchRegions[i].name);
+		}
+		else {
+			DEBUGOUT("%-18s %10d  %10d  %9d  %13d  %13d.%d\r\n", benchRegions[i].name,
+					 bench.read_kbs, bench.write_kbs, bench.copy_kbs, bench.dma_copy_kbs,
+					 bench.latency_cyc10 / 10, bench.latency_cyc10 % 10);
+		}
+		if (bench.dma_channel < GPDMA_NUMBER_CHANNELS) {
+			Chip_GPDMA_Stop(LPC_GPDMA, bench.dma_channel);
+		}
+	}
+}
+
+/* CPU read bandwidth in local SRAM with the GPDMA busy elsewhere */
+static void memContention(void)
+{
+	MEM_CONTEND_SETUP_T contend;
+	int i;
+
+	DEBUGSTR("\r\nDMA region          CPU KB/s idle  CPU KB/s with DMA  DMA KB/s\r\n");
+	for (i = 0; i < (int) (sizeof(contendRegions) / sizeof(contendRegions[0])); i++) {
+		contend.cpu_addr = CONTEND_CPU_ADDR;
+		contend.cpu_bytes = CONTEND_CPU_SIZE;
+		contend.dma_addr = contendRegions[i].start_addr;
+		contend.dma_bytes = contendRegions[i].bytes;
+		contend.dma_channel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, 0);
+		if (!mem_bench_contention(&contend)) {
+			DEBUGOUT("%-18s benchmark failed\r\n", contendRegions[i].name);
+		}
+		else {
+			DEBUGOUT("%-18s %13d  %17d  %8d\r\n", contendRegions[i].name,
+					 contend.cpu_kbs, contend.cpu_dma_kbs, contend.dma_kbs);
+		}
+		if (contend.dma_channel < GPDMA_NUMBER_CHANNELS) {
+			Chip_GPDMA_Stop(LPC_GPDMA, contend.dma_channel);
+		}
+	}
+}
+
+#ifdef MEMTEST_POST
+/* Fast power-on test of the SDRAM, stepped from the main loop with the
+   LED toggling in between as a stand-in for application start-up */
+static void memPost(void)
+{
+	MEM_POST_T post;
+	uint32_t start, loops = 0, shown = 0;
+
+	Chip_GPDMA_Init(LPC_GPDMA);
+	Chip_GPDMA_JobInit(LPC_GPDMA);
+	NVIC_DisableIRQ(DMA_IRQn);
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	start = DWT->CYCCNT;
+
+	post.start_addr = DRAM_BASE_ADDRESS;
+	post.bytes = DRAM_SIZE;
+	post.dma_channel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, 0);
+	post.dma_irq = false;
+	if (mem_post_start(&post)) {
+		DEBUGSTR("Fast SDRAM test: data and address lines passed\r\n");
+		while (mem_post_step(&post) == MEM_POST_RUNNING) {
+			if ((++loops & 0x3FF) == 0) {
+				Board_LED_Toggle(0);
+			}
+			if (mem_post_progress(&post) >= (shown + 10)) {
+				shown = mem_post_progress(&post);
+				DEBUGOUT("Fast SDRAM test: %d%%\r\n", shown);
+			}
+		}
+	}
+
+	if (post.status == MEM_POST_PASSED) {
+		DEBUGOUT("Fast SDRAM test passed in %d ms\r\n",
+				 (DWT->CYCCNT - start) / (SystemCoreClock / 1000));
+	}
+	else if (post.fail_addr == NULL) {
+		DEBUGSTR("Fast SDRAM test could not start or lost its DMA channel\r\n");
+	}
+	else {
+		DEBUGOUT("Fast SDRAM test failed at address %p\r\n", post.fail_addr);
+		DEBUGOUT(" Expected %08x, actual %08x\r\n", post.ex_val, post.is_val);
+	}
+	if (post.dma_channel < GPDMA_NUMBER_CHANNELS) {
+		Chip_GPDMA_Stop(LPC_GPDMA, post.dma_channel);
+	}
+}
+
+#endif
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -72,6 +215,10 @@ int main(void)
 	SystemCoreClockUpdate();
 	Board_Init();
 
+#ifdef MEMTEST_POST
+	memPost();
+	(void) memSetup;
+#else
 	/* Walking 0 test */
 	memSetup.start_addr = DRAM_BASE_ADDRESS;
 	memSetup.bytes = DRAM_SIZE;
@@ -137,6 +284,11 @@ int main(void)
 		DEBUGOUT("Seeded pattern test failed at address %p\r\n", memSetup.fail_addr);
 		DEBUGOUT(" Expected %08x, actual %08x\r\n", memSetup.ex_val, memSetup.is_val);
 	}
+#endif
+
+	/* Benchmark mode, run after the tests as it overwrites the regions */
+	memBenchmark();
+	memContention();
 
 	/* Never returns, for warning only */
 	return 0;
@@ -0,0 +1,241 @@
+/*
+ * @brief Contiguous file logging to the SD card
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "sd_log.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define SECTOR_SZ   512
+
+/* Log of the write in progress, for the transfer callback */
+static SD_LOG_T *activeLog;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Non-blocking write of a half finished */
+static void sdlog_write_done(LPC_SDMMC_T *pSDMMC, int32_t bytes)
+{
+	if (bytes == 0) {
+		activeLog->error = 1;
+	}
+	activeLog->busy = 0;
+}
+
+/* Wait for the half being written */
+static FRESULT sdlog_wait(SD_LOG_T *pLog)
+{
+	while (pLog->busy) {
+		Chip_SDMMC_PollAsync(LPC_SDMMC);
+	}
+	return pLog->error ? FR_DISK_ERR : FR_OK;
+}
+
+/* Write the first n bytes of the half being filled at its file offset, after
+   the write of the other half finished */
+static FRESULT sdlog_flush(SD_LOG_T *pLog, uint32_t n, bool wait)
+{
+	uint8_t *p = &pLog->buf[pLog->cur * pLog->half];
+	UINT bw;
+
+	if (sdlog_wait(pLog) != FR_OK) {
+		return FR_DISK_ERR;
+	}
+	if (pLog->sector == 0) {
+		/* Clusters not in one piece, write through FatFs */
+		if (f_lseek(&pLog->fil, pLog->pos) || f_write(&pLog->fil, p, n, &bw) || (bw != n)) {
+			return FR_DISK_ERR;
+		}
+		return FR_OK;
+	}
+
+	pLog->busy = 1;
+	activeLog = pLog;
+	if (Chip_SDMMC_WriteBlocksAsync(LPC_SDMMC, p, pLog->sector + (pLog->pos / SECTOR_SZ),
+									(n + SECTOR_SZ - 1) / SECTOR_SZ, sdlog_write_done) == 0) {
+		pLog->busy = 0;
+		pLog->error = 1;
+		return FR_DISK_ERR;
+	}
+	return wait ? sdlog_wait(pLog) : FR_OK;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Create a log file and allocate its clusters */
+FRESULT SDLog_Open(SD_LOG_T *pLog, const char *name, uint32_t size, void *buf, uint32_t bufSize)
+{
+	FRESULT res;
+	FATFS *fs;
+	uint32_t clsz, n, i;
+
+	memset(pLog, 0, sizeof(*pLog));
+	pLog->buf = (uint8_t *) buf;
+	pLog->half = (bufSize / 2) & ~(SECTOR_SZ - 1);
+	if ((pLog->half == 0) || (size == 0)) {
+		return FR_INVALID_PARAMETER;
+	}
+
+	res = f_open(&pLog->fil, name, FA_WRITE | FA_CREATE_ALWAYS);
+	if (res != FR_OK) {
+		return res;
+	}
+	fs = pLog->fil.fs;
+	clsz = (uint32_t) fs->csize * SECTOR_SZ;
+	n = (size + clsz - 1) / clsz;
+	pLog->size = n * clsz;
+
+	/* Seeking past the end in write mode has FatFs allocate the whole
+	   chain, from the last allocated cluster on */
+	res = f_lseek(&pLog->fil, pLog->size);
+	if ((res == FR_OK) && (pLog->fil.fsize != pLog->size)) {
+		res = FR_DENIED;	/* Card full */
+	}
+	if (res == FR_OK) {
+		res = f_sync(&pLog->fil);
+	}
+
+	/* Cluster i of the file must be cluster sclust + i. The position at the
+	   end of cluster i is in that cluster. */
+	for (i = 1; (i < n) && (res == FR_OK); i++) {
+		res = f_lseek(&pLog->fil, (i + 1) * clsz);
+		if (pLog->fil.clust != (pLog->fil.sclust + i)) {
+			break;
+		}
+	}
+	if (res == FR_OK) {
+		res = f_lseek(&pLog->fil, 0);
+	}
+	if (res != FR_OK) {
+		f_close(&pLog->fil);
+		f_unlink(name);
+		return res;
+	}
+
+	if (i >= n) {
+		pLog->sector = fs->database + ((pLog->fil.sclust - 2) * fs->csize);
+	}
+	return FR_OK;
+}
+
+/* Append data to the log */
+FRESULT SDLog_Write(SD_LOG_T *pLog, const void *data, uint32_t len)
+{
+	const uint8_t *src = (const uint8_t *) data;
+	FRESULT res;
+	uint32_t n;
+
+	if (pLog->error) {
+		return FR_DISK_ERR;
+	}
+	if (len > (pLog->size - SDLog_GetLength(pLog))) {
+		return FR_DENIED;
+	}
+
+	/* Let a write that waits for the card busy phase finish */
+	Chip_SDMMC_PollAsync(LPC_SDMMC);
+
+	while (len > 0) {
+		n = MIN(len, pLog->half - pLog->fill);
+		memcpy(&pLog->buf[(pLog->cur * pLog->half) + pLog->fill], src, n);
+		pLog->fill += n;
+		src += n;
+		len -= n;
+
+		if (pLog->fill == pLog->half) {
+			/* Full, write it and fill the other half meanwhile */
+			res = sdlog_flush(pLog, pLog->half, false);
+			if (res != FR_OK) {
+				return res;
+			}
+			pLog->pos += pLog->half;
+			pLog->fill = 0;
+			pLog->cur ^= 1;
+		}
+	}
+	return FR_OK;
+}
+
+/* Checkpoint: put all data on the card and its length in the directory */
+FRESULT SDLog_Sync(SD_LOG_T *pLog)
+{
+	FRESULT res;
+
+	/* A partly filled half is written now and again once it is full */
+	if (pLog->fill > 0) {
+		res = sdlog_flush(pLog, pLog->fill, true);
+	}
+	else {
+		res = sdlog_wait(pLog);
+	}
+	if (res != FR_OK) {
+		return res;
+	}
+
+	/* Directory entry with the logged length, the file keeps the clusters */
+	pLog->fil.fsize = SDLog_GetLength(pLog);
+	pLog->fil.flag |= FA__WRITTEN;
+	res = f_sync(&pLog->fil);
+	pLog->fil.fsize = pLog->size;
+	return res;
+}
+
+/* Close the log and free the clusters it didn't use */
+FRESULT SDLog_Close(SD_LOG_T *pLog)
+{
+	FRESULT res;
+
+	res = SDLog_Sync(pLog);
+	if (res == FR_OK) {
+		res = f_lseek(&pLog->fil, SDLog_GetLength(pLog));
+	}
+	if (res == FR_OK) {
+		res = f_truncate(&pLog->fil);
+	}
+	if (res == FR_OK) {
+		res = f_close(&pLog->fil);
+	}
+	else {
+		f_close(&pLog->fil);
+	}
+	activeLog = NULL;
+	return res;
+}
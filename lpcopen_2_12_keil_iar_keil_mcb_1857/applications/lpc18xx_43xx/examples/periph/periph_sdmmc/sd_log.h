@@ -0,0 +1,142 @@
+/*
+ * @brief Contiguous file logging to the SD card
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+#ifndef __SD_LOG_H_
+#define __SD_LOG_H_
+
+#include "board.h"
+#include "ff.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @defgroup EXAMPLES_PERIPH_18XX43XX_SDLOG Contiguous SD card logging
+ * @ingroup EXAMPLES_PERIPH_18XX43XX_SDMMC
+ * A log file is given all its clusters when it is opened, in one piece.
+ * Data is then written straight to the card sectors of the file with
+ * non-blocking multiple block writes (Chip_SDMMC_WriteBlocksAsync), one half
+ * of the log buffer while the other half is filled. FatFs only writes the
+ * directory entry at checkpoints (SDLog_Sync) and when the log is closed,
+ * which frees the clusters that were not used. If the clusters can't be
+ * found in one piece the log falls back to f_write().
+ * @{
+ */
+
+/**
+ * @brief Log file state
+ */
+typedef struct {
+	FIL fil;				/*!< FatFs file object */
+	uint8_t *buf;			/*!< Log buffer, two halves */
+	uint32_t half;			/*!< Size of a half, a multiple of 512 bytes */
+	uint32_t size;			/*!< Bytes allocated to the file */
+	uint32_t sector;		/*!< First card sector of the file, 0 if not contiguous */
+	uint32_t pos;			/*!< File offset of the half being filled */
+	uint32_t fill;			/*!< Bytes in the half being filled */
+	uint8_t cur;			/*!< Half being filled */
+	volatile uint8_t busy;	/*!< The other half is being written */
+	volatile uint8_t error;	/*!< A write to the card failed */
+} SD_LOG_T;
+
+/**
+ * @brief	Create a log file and allocate its clusters
+ * @param	pLog	: Log state to set up
+ * @param	name	: File name, an existing file is replaced
+ * @param	size	: Most bytes the log will hold, rounded up to whole clusters
+ * @param	buf		: Log buffer, word aligned and in RAM the SDIF DMA can read
+ * @param	bufSize	: Size of the buffer, a multiple of 1024 bytes
+ * @return	FR_OK on success, or the FatFs error
+ * @note	Needs FatFs with f_lseek() and f_truncate() (_FS_MINIMIZE 0)
+ *			and the SDIO_IRQHandler() calling Chip_SDMMC_IRQHandler(). Only
+ *			one log can be open at a time. Use a newly formatted card or one
+ *			with a large free area for the clusters to be contiguous.
+ */
+FRESULT SDLog_Open(SD_LOG_T *pLog, const char *name, uint32_t size, void *buf, uint32_t bufSize);
+
+/**
+ * @brief	Tell whether the log is written to the card directly
+ * @param	pLog	: Log state
+ * @return	true if the file is contiguous, false if f_write() is used
+ */
+STATIC INLINE bool SDLog_IsContiguous(SD_LOG_T *pLog)
+{
+	return pLog->sector != 0;
+}
+
+/**
+ * @brief	Append data to the log
+ * @param	pLog	: Log state
+ * @param	data	: Data to append
+ * @param	len		: Number of bytes
+ * @return	FR_OK on success, FR_DENIED when the allocated size is reached
+ *			(nothing is appended then), FR_DISK_ERR after a failed write
+ * @note	Copies the data into the log buffer. Each full half is handed to
+ *			the card, so this only waits when the card is slower than the
+ *			data comes in.
+ */
+FRESULT SDLog_Write(SD_LOG_T *pLog, const void *data, uint32_t len);
+
+/**
+ * @brief	Checkpoint: put all data on the card and its length in the directory
+ * @param	pLog	: Log state
+ * @return	FR_OK on success, or the FatFs error
+ * @note	Waits for the card. After a power loss the file holds the data
+ *			up to the last checkpoint.
+ */
+FRESULT SDLog_Sync(SD_LOG_T *pLog);
+
+/**
+ * @brief	Close the log and free the clusters it didn't use
+ * @param	pLog	: Log state
+ * @return	FR_OK on success, or the FatFs error
+ */
+FRESULT SDLog_Close(SD_LOG_T *pLog);
+
+/**
+ * @brief	Get the log length
+ * @param	pLog	: Log state
+ * @return	Number of bytes appended
+ */
+STATIC INLINE uint32_t SDLog_GetLength(SD_LOG_T *pLog)
+{
+	return pLog->pos + pLog->fill;
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_LOG_H_ */
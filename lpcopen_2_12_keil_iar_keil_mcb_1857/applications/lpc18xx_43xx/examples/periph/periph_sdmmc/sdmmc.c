@@ -34,6 +34,7 @@
 #include "chip.h"
 #include "rtc.h"
 #include "ff.h"
+#include "sd_log.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -51,6 +52,14 @@ static FATFS Fatfs;	/* File system object */
 static FIL Fil;	/* File object */
 static uint32_t Buff[BUFFER_SIZE/sizeof(uint32_t)];
 
+/* Logging demo: amount written, checkpoint interval and log buffer size */
+#define LOG_TEST_SIZE       (4 * 1024 * 1024)
+#define LOG_SYNC_INTERVAL   (256 * 1024)
+#define LOG_BUFFER_SIZE     (32 * 1024)
+
+static SD_LOG_T SdLog;
+static uint32_t LogBuff[LOG_BUFFER_SIZE/sizeof(uint32_t)];
+
 static volatile UINT Timer = 0;		/* Performance timer (1kHz increment) */
 static volatile int32_t sdio_wait_exit = 0;
 
@@ -134,6 +143,46 @@ static void App_SDMMC_Init()
 	Chip_SDIF_Init(LPC_SDMMC);
 }
 
+/* Write LOG_TEST_SIZE bytes to a preallocated log file and show the rate */
+static FRESULT App_Log_Test(void)
+{
+	FRESULT rc;
+	uint32_t i, start, ms;
+	char debugBuf[64];
+
+	rc = SDLog_Open(&SdLog, "LOG.BIN", LOG_TEST_SIZE, LogBuff, sizeof(LogBuff));
+	if (rc) {
+		return rc;
+	}
+	if (SDLog_IsContiguous(&SdLog)) {
+		debugstr("LOG.BIN is contiguous, writing sectors directly.\r\n");
+	}
+	else {
+		debugstr("LOG.BIN is fragmented, writing through FatFs.\r\n");
+	}
+
+	start = Chip_RIT_GetCounter(LPC_RITIMER);
+	for (i = 0; (rc == FR_OK) && (i < (LOG_TEST_SIZE / BUFFER_SIZE)); i++) {
+		Buff[0] = i;	/* Record number */
+		rc = SDLog_Write(&SdLog, Buff, BUFFER_SIZE);
+		if ((rc == FR_OK) && ((((i + 1) * BUFFER_SIZE) % LOG_SYNC_INTERVAL) == 0)) {
+			rc = SDLog_Sync(&SdLog);
+		}
+	}
+	ms = (Chip_RIT_GetCounter(LPC_RITIMER) - start) / (SystemCoreClock / 1000);
+	if (rc == FR_OK) {
+		rc = SDLog_Close(&SdLog);
+	}
+	if (rc) {
+		return rc;
+	}
+
+	sprintf(debugBuf, "%lu KB logged in %lu ms (%lu KB/s).\r\n", (unsigned long) (LOG_TEST_SIZE / 1024),
+			(unsigned long) ms, (unsigned long) ((ms > 0) ? ((LOG_TEST_SIZE / 1024) * 1000) / ms : 0));
+	debugstr(debugBuf);
+	return FR_OK;
+}
+
 #if (defined(BOARD_HITEX_EVA_1850) || defined(BOARD_HITEX_EVA_4350))
 /* Initialize the UART for debugging */
 static void board_uart_debug_init(void)
@@ -184,6 +233,11 @@ void die(FRESULT rc)
  */
 void SDIO_IRQHandler(void)
 {
+	/* Non-blocking transfers (SD_LOG_T) are handled by the driver */
+	if (Chip_SDMMC_IRQHandler(LPC_SDMMC)) {
+		return;
+	}
+
 	/* All SD based register handling is done in the callback
 	   function. The SDIO interrupt is not enabled as part of this
 	   driver and needs to be enabled/disabled in the callbacks or
@@ -309,6 +363,12 @@ int main(void)
 		die(rc);
 	}
 
+	debugstr("Logging to LOG.BIN...\r\n");
+	rc = App_Log_Test();
+	if (rc) {
+		die(rc);
+	}
+
 	debugstr("Test completed.\r\n");
 	for (;; ) {}
 }
@@ -68,6 +68,8 @@
 #define SSP_POLLING_SEL                     (0x31)
 #define SSP_INTERRUPT_SEL                   (0x32)
 #define SSP_DMA_SEL                         (0x33)
+#define SSP_DMA_QUEUE_SEL                   (0x34)
+#define SSP_QUEUE_XFERS                     (4)
 
 /* Tx buffer */
 static uint8_t Tx_Buf[BUFFER_SIZE];
@@ -81,19 +83,25 @@ static volatile uint8_t  isXferCompleted = 0;
 static uint8_t dmaChSSPTx, dmaChSSPRx;
 static volatile uint8_t isDmaTxfCompleted = 0;
 static volatile uint8_t isDmaRxfCompleted = 0;
+static SSP_DMA_QUEUE_T sspQueue;
+static SSP_XFER_T sspXfer[SSP_QUEUE_XFERS];
+static volatile uint8_t queueXfersDone = 0;
+static volatile uint8_t queueXfersFailed = 0;
 
 #if defined(DEBUG_ENABLE)
 static char sspWaitingMenu[] = "SSP Polling: waiting for transfer ...\n\r";
 static char sspIntWaitingMenu[]  = "SSP Interrupt: waiting for transfer ...\n\r";
 static char sspDMAWaitingMenu[]  = "SSP DMA: waiting for transfer ...\n\r";
+static char sspQueueWaitingMenu[]  = "SSP DMA queue: waiting for transfers ...\n\r";
 
 static char sspPassedMenu[] = "SSP: Transfer PASSED\n\r";
 static char sspFailedMenu[] = "SSP: Transfer FAILED\n\r";
 
-static char sspTransferModeSel[] = "\n\rPress 1-3 or 'q' to exit\n\r"
+static char sspTransferModeSel[] = "\n\rPress 1-4 or 'q' to exit\n\r"
 								   "\t 1: SSP Polling Read Write\n\r"
 								   "\t 2: SSP Int Read Write\n\r"
-								   "\t 3: SSP DMA Read Write\n\r";
+								   "\t 3: SSP DMA Read Write\n\r"
+								   "\t 4: SSP DMA queued Read Write\n\r";
 
 static char helloMenu[] = "Hello NXP Semiconductors \n\r";
 static char sspMenu[] = "SSP demo \n\r";
@@ -153,10 +161,19 @@ static uint8_t Buffer_Verify(void)
 	return 0;
 }
 
+/* Counts the queued transactions as they end */
+static void queueXferDone(SSP_XFER_T *pXfer, Status status)
+{
+	if (status != SUCCESS) {
+		queueXfersFailed++;
+	}
+	queueXfersDone++;
+}
+
 /* Select the Transfer mode : Polling, Interrupt or DMA */
 static void appSSPTest(void)
 {
-	int key;
+	int key, i;
 
 	DEBUGOUT(sspTransferModeSel);
 
@@ -243,6 +260,35 @@ static void appSSPTest(void)
 			Chip_SSP_DMA_Disable(LPC_SSP);
 			break;
 
+		case SSP_DMA_QUEUE_SEL:	/* SSP DMA transactions, the buffer split in back to back parts */
+			DEBUGOUT(sspQueueWaitingMenu);
+			queueXfersDone = queueXfersFailed = 0;
+
+			for (i = 0; i < SSP_QUEUE_XFERS; i++) {
+				sspXfer[i].txData = &Tx_Buf[i * (BUFFER_SIZE / SSP_QUEUE_XFERS)];
+				sspXfer[i].rxData = &Rx_Buf[i * (BUFFER_SIZE / SSP_QUEUE_XFERS)];
+				sspXfer[i].frames = (BUFFER_SIZE / SSP_QUEUE_XFERS) / SSP_DATA_BYTES(ssp_format.bits);
+				sspXfer[i].bits = ssp_format.bits;
+				sspXfer[i].clockMode = ssp_format.clockMode;
+				sspXfer[i].bitRate = 0;
+				sspXfer[i].csPort = SSP_XFER_NO_CS;
+				sspXfer[i].callback = queueXferDone;
+				if (Chip_SSP_DMA_Submit(&sspQueue, &sspXfer[i]) != SUCCESS) {
+					queueXfersFailed++;
+					queueXfersDone++;
+				}
+			}
+
+			while (queueXfersDone < SSP_QUEUE_XFERS) {}
+			if ((queueXfersFailed == 0) && (Buffer_Verify() == 0)) {
+				DEBUGOUT(sspPassedMenu);
+			}
+			else {
+				DEBUGOUT(sspFailedMenu);
+			}
+			Chip_SSP_DMA_Disable(LPC_SSP);
+			break;
+
 		case 'q':
 		case 'Q':
 			Chip_GPDMA_Stop(LPC_GPDMA, dmaChSSPTx);
@@ -357,6 +403,8 @@ void SSPIRQHANDLER(void)
  */
 void DMA_IRQHandler(void)
 {
+	Chip_SSP_DMA_IRQHandler(&sspQueue);
+
 	if (Chip_GPDMA_Interrupt(LPC_GPDMA, dmaChSSPTx) == SUCCESS) {
 		isDmaTxfCompleted = 1;
 	}
@@ -388,6 +436,7 @@ int main(void)
 
 	/* Initialize GPDMA controller */
 	Chip_GPDMA_Init(LPC_GPDMA);
+	Chip_SSP_DMA_QueueInit(&sspQueue, LPC_SSP, LPC_GPDMA, LPC_GPDMA_SSP_RX, LPC_GPDMA_SSP_TX);
 
 	/* Setting GPDMA interrupt */
 	NVIC_DisableIRQ(DMA_IRQn);
@@ -32,11 +32,31 @@
 #include "chip.h"
 #include "board.h"
 #include "string.h"
+#include "stdio.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
  ****************************************************************************/
 
+/* Set to 1 to stream the UART through GPDMA instead of the ring buffer
+   interrupt handlers; the idle count printed on exit compares the two */
+#ifndef UART_RB_USE_DMA
+#define UART_RB_USE_DMA 0
+#endif
+
+#if UART_RB_USE_DMA
+/* DMA receive ring: UART_DMA_SEGS segments of UART_DMA_SEGSZ bytes */
+#define UART_DMA_SEGS   4
+#define UART_DMA_SEGSZ  256
+
+STATIC UART_DMA_T uartdma;
+STATIC DMA_TransferDescriptor_t rxdesc[UART_DMA_SEGS];
+static uint8_t dmarxbuff[UART_DMA_SEGS * UART_DMA_SEGSZ];
+
+/* TX data must stay put until the DMA completes */
+static uint8_t dmatxbuff[UART_DMA_SEGSZ];
+#endif
+
 /* Transmit and receive ring buffers */
 STATIC RINGBUFF_T txring, rxring;
 
@@ -55,6 +75,8 @@ const char inst2[] = "Press a key to echo it back or ESC to quit\r\n";
 #define LPC_UARTX       LPC_USART0
 #define UARTx_IRQn      USART0_IRQn
 #define UARTx_IRQHandler UART0_IRQHandler
+#define UARTx_DMA_RX     GPDMA_CONN_UART0_Rx
+#define UARTx_DMA_TX     GPDMA_CONN_UART0_Tx
 #endif
 
 #if defined(BOARD_NXP_LPCXPRESSO_4337)
@@ -62,6 +84,8 @@ const char inst2[] = "Press a key to echo it back or ESC to quit\r\n";
 #define LPC_UARTX       LPC_USART0
 #define UARTx_IRQn      USART0_IRQn
 #define UARTx_IRQHandler UART0_IRQHandler
+#define UARTx_DMA_RX     GPDMA_CONN_UART0_Rx
+#define UARTx_DMA_TX     GPDMA_CONN_UART0_Tx
 #endif
 
 #if (defined(BOARD_KEIL_MCB_1857) || defined(BOARD_KEIL_MCB_4357))
@@ -69,31 +93,74 @@ const char inst2[] = "Press a key to echo it back or ESC to quit\r\n";
 #define LPC_UARTX       LPC_USART3
 #define UARTx_IRQn      USART3_IRQn
 #define UARTx_IRQHandler UART3_IRQHandler
+#define UARTx_DMA_RX     GPDMA_CONN_UART3_Rx
+#define UARTx_DMA_TX     GPDMA_CONN_UART3_Tx
 #endif
 #if (defined(BOARD_HITEX_EVA_1850) || defined(BOARD_HITEX_EVA_4350))
 /* Use UART0 for Hitex boards */
 #define LPC_UARTX       LPC_USART0
 #define UARTx_IRQn      USART0_IRQn
 #define UARTx_IRQHandler UART0_IRQHandler
+#define UARTx_DMA_RX     GPDMA_CONN_UART0_Rx
+#define UARTx_DMA_TX     GPDMA_CONN_UART0_Tx
 #endif
 #if defined(BOARD_NXP_LPCLINK2_4370)
 #define LPC_UARTX       LPC_USART2
 #define UARTx_IRQn      USART2_IRQn
 #define UARTx_IRQHandler UART2_IRQHandler
+#define UARTx_DMA_RX     GPDMA_CONN_UART2_Rx
+#define UARTx_DMA_TX     GPDMA_CONN_UART2_Tx
 #endif
 
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
 
+/* Millisecond tick and main loop passes that found no data */
+static volatile uint32_t msTicks;
+static uint32_t idleLoops;
+
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
 
+/* Send a message with whichever transport the example was built for */
+static void sendString(const char *str)
+{
+#if UART_RB_USE_DMA
+	while (Chip_UART_DMA_IsTXBusy(&uartdma)) {}
+	Chip_UART_DMA_Send(&uartdma, str, strlen(str), NULL);
+	while (Chip_UART_DMA_IsTXBusy(&uartdma)) {}
+#else
+	Chip_UART_SendRB(LPC_UARTX, &txring, str, strlen(str));
+#endif
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
 
+/**
+ * @brief	SysTick interrupt handler
+ * @return	Nothing
+ */
+void SysTick_Handler(void)
+{
+	msTicks++;
+}
+
+#if UART_RB_USE_DMA
+/**
+ * @brief	DMA interrupt handler for the UART streams
+ * @return	Nothing
+ */
+void DMA_IRQHandler(void)
+{
+	Chip_UART_DMA_IRQHandler(&uartdma);
+}
+
+#endif
+
 /**
  * @brief	UART interrupt handler using ring buffers
  * @return	Nothing
@@ -115,6 +182,8 @@ int main(void)
 {
 	uint8_t key;
 	int bytes;
+	uint32_t startTicks;
+	char msg[64];
 
 	SystemCoreClockUpdate();
 	Board_Init();
@@ -133,6 +202,20 @@ int main(void)
 	RingBuffer_Init(&rxring, rxbuff, 1, UART_RRB_SIZE);
 	RingBuffer_Init(&txring, txbuff, 1, UART_SRB_SIZE);
 
+	SysTick_Config(SystemCoreClock / 1000);
+
+#if UART_RB_USE_DMA
+	/* DMA mode FIFOs, the UART interrupts stay off and GPDMA moves the data */
+	Chip_UART_SetupFIFOS(LPC_UARTX, (UART_FCR_FIFO_EN | UART_FCR_RX_RS |
+							UART_FCR_TX_RS | UART_FCR_DMAMODE_SEL | UART_FCR_TRG_LEV0));
+
+	Chip_GPDMA_Init(LPC_GPDMA);
+	Chip_UART_DMA_Init(&uartdma, LPC_UARTX, LPC_GPDMA, UARTx_DMA_RX, UARTx_DMA_TX);
+	Chip_UART_DMA_StartRX(&uartdma, dmarxbuff, rxdesc, UART_DMA_SEGS, UART_DMA_SEGSZ, NULL);
+
+	NVIC_SetPriority(DMA_IRQn, 1);
+	NVIC_EnableIRQ(DMA_IRQn);
+#else
 	/* Reset and enable FIFOs, FIFO trigger level 3 (14 chars) */
 	Chip_UART_SetupFIFOS(LPC_UARTX, (UART_FCR_FIFO_EN | UART_FCR_RX_RS |
 							UART_FCR_TX_RS | UART_FCR_TRG_LEV3));
@@ -143,25 +226,56 @@ int main(void)
 	/* preemption = 1, sub-priority = 1 */
 	NVIC_SetPriority(UARTx_IRQn, 1);
 	NVIC_EnableIRQ(UARTx_IRQn);
+#endif
 
 	/* Send initial messages */
-	Chip_UART_SendRB(LPC_UARTX, &txring, inst1, sizeof(inst1) - 1);
-	Chip_UART_SendRB(LPC_UARTX, &txring, inst2, sizeof(inst2) - 1);
+	sendString(inst1);
+	sendString(inst2);
 
-	/* Poll the receive ring buffer for the ESC (ASCII 27) key */
+	/* Poll for received data until the ESC (ASCII 27) key, counting the
+	   passes that found nothing as a measure of free CPU time */
 	key = 0;
+	startTicks = msTicks;
 	while (key != 27) {
+#if UART_RB_USE_DMA
+		if (!Chip_UART_DMA_IsTXBusy(&uartdma)) {
+			bytes = Chip_UART_DMA_ReadRX(&uartdma, dmatxbuff, UART_DMA_SEGSZ);
+			if (bytes > 0) {
+				/* Wrap the whole burst back around */
+				key = dmatxbuff[bytes - 1];
+				Chip_UART_DMA_Send(&uartdma, dmatxbuff, bytes, NULL);
+				continue;
+			}
+		}
+		else if (Chip_UART_DMA_GetRXCount(&uartdma) > ((UART_DMA_SEGS - 1) * UART_DMA_SEGSZ)) {
+			Board_LED_Toggle(0);/* Toggle LED if the echo falls behind */
+		}
+#else
 		bytes = Chip_UART_ReadRB(LPC_UARTX, &rxring, &key, 1);
 		if (bytes > 0) {
 			/* Wrap value back around */
 			if (Chip_UART_SendRB(LPC_UARTX, &txring, (const uint8_t *) &key, 1) != 1) {
 				Board_LED_Toggle(0);/* Toggle LED if the TX FIFO is full */
 			}
+			continue;
 		}
+#endif
+		idleLoops++;
 	}
 
+	/* Idle passes per millisecond, higher means less CPU spent on the UART */
+	sprintf(msg, "\r\nIdle loops/ms: %lu\r\n",
+			(unsigned long) (idleLoops / MAX(1, msTicks - startTicks)));
+	sendString(msg);
+	while ((Chip_UART_ReadLineStatus(LPC_UARTX) & UART_LSR_TEMT) == 0) {}
+
 	/* DeInitialize UART0 peripheral */
+#if UART_RB_USE_DMA
+	NVIC_DisableIRQ(DMA_IRQn);
+	Chip_UART_DMA_Stop(&uartdma);
+#else
 	NVIC_DisableIRQ(UARTx_IRQn);
+#endif
 	Chip_UART_DeInit(LPC_UARTX);
 
 	return 1;
@@ -35,6 +35,7 @@
 #include "lpc_rom8x16.h"
 #include "lpc_winfreesystem14x16.h"
 #include "lpc_x6x13.h"
+#include "swim_fast.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -66,7 +67,6 @@ static void lcd_colorbars(void)
 	SWIM_WINDOW_T win1;
 	COLOR_T clr, *fblog;
 	CHAR str[32];
-	short int idx;
 	UNS_16 xgs, ygs = 0, curx, cury = 0, curym, xidx;
 	int last = frame_rate_counter;
 	int oldballx, oldbally, ballx, bally, balldx, balldy;
@@ -90,11 +90,8 @@ static void lcd_colorbars(void)
 	xgs = DISPLAY_WIDTH / RED_COLORS;	/* Divide pixels/line by # of red colors possible in this mode (32 shades red in RGB565) */
 	clr = BLACK;						/* start with black then increase to full color across the line */
 	for (xidx = 0; xidx < RED_COLORS; xidx++) {
-		swim_set_pen_color(&win1, clr);
-		for (idx = 0; idx <= xgs; idx++) {
-			swim_put_line(&win1, curx, cury, curx, curym);	/* Draw line */
-			curx++;
-		}
+		swim_fast_fill(&win1, curx, cury, curx + xgs, curym, clr);	/* Draw a bar of xgs + 1 lines */
+		curx += xgs + 1;
 		clr = clr + MINRED;				/* increment color value for a gradient,(RGB1:5:6:5) */
 	}
 
@@ -103,13 +100,8 @@ static void lcd_colorbars(void)
 	curx = 0;							/* Start cursor postion of X */
 	curym = cury + (ygs - 1);			/* End Cursor postion of Y  at 1/3 of panel */
 	for (xidx = 0; xidx < GREEN_COLORS; xidx++) {
-		swim_set_pen_color(&win1, clr);
-		for (idx = 0; idx <= xgs; idx++) {
-
-			swim_set_pen_color(&win1, clr);
-			swim_put_line(&win1, curx, cury, curx, curym);
-			curx++;
-		}
+		swim_fast_fill(&win1, curx, cury, curx + xgs, curym, clr);
+		curx += xgs + 1;
 		clr = clr + MINGREEN;
 	}
 
@@ -120,11 +112,8 @@ static void lcd_colorbars(void)
 	xgs = DISPLAY_WIDTH / BLUE_COLORS;	//
 	clr = BLACK;
 	for (xidx = 0; xidx < BLUE_COLORS; xidx++) {
-		swim_set_pen_color(&win1, clr);
-		for (idx = 0; idx <= xgs; idx++) {
-			swim_put_line(&win1, curx, cury, curx, curym);
-			curx++;
-		}
+		swim_fast_fill(&win1, curx, cury, curx + xgs, curym, clr);
+		curx += xgs + 1;
 		clr = clr + MINBLUE;		/* incement blue color value for a gradient, Blue=bits[4:0] in memory	(RGB1:5:6:5 mode) */
 	}
 
@@ -217,10 +206,17 @@ int main(void)
 	Chip_LCD_PowerOn(LPC_LCD);
 	Chip_LCD_EnableInts(LPC_LCD, LCD_INTMSK_VCOMPIM);
 
+	/* LCD DMA load of the 16 bpp frame buffer and of the palette modes */
+	DEBUGOUT("LCD DMA: 16 bpp %lu KB/s, 8 bpp %lu KB/s, 4 bpp %lu KB/s\r\n",
+			 (unsigned long) (Chip_LCD_GetDMABandwidth(LPC_LCD, LCD_BPP16_565) / 1024),
+			 (unsigned long) (Chip_LCD_GetDMABandwidth(LPC_LCD, LCD_BPP8) / 1024),
+			 (unsigned long) (Chip_LCD_GetDMABandwidth(LPC_LCD, LCD_BPP4) / 1024));
+
 	NVIC_EnableIRQ(LCD_IRQn);
 
 	/* Turn on backlight */
 	Board_SetLCDBacklight(1);
+	swim_fast_init();
 	lcd_colorbars();
 
 	while (1) {}
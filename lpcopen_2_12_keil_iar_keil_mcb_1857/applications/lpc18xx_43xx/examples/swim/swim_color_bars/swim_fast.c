@@ -0,0 +1,333 @@
+/*
+ * @brief Accelerated SWIM drawing primitives
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "swim_fast.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Outcodes of a point for line clipping */
+#define CLIP_LEFT   1
+#define CLIP_RIGHT  2
+#define CLIP_TOP    4
+#define CLIP_BOTTOM 8
+
+/* GPDMA channel, descriptors for one transfer and the fill source */
+static uint8_t dmaCh = GPDMA_NO_CHANNEL;
+static DMA_TransferDescriptor_t dmaDesc[SWIM_FAST_DMA_LINES];
+static volatile uint32_t fillPattern;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Frame buffer address of a virtual window pixel */
+static COLOR_T *fast_pixel(SWIM_WINDOW_T *win, INT_32 x, INT_32 y)
+{
+	return win->fb + (win->xpvmin + x) + ((win->ypvmin + y) * win->xpsize);
+}
+
+/* Clip a rectangle to the window, false if nothing is left */
+static bool fast_clip_rect(SWIM_WINDOW_T *win, INT_32 *x0, INT_32 *y0, INT_32 *x1, INT_32 *y1)
+{
+	INT_32 t;
+
+	if (*x0 > *x1) {
+		t = *x0, *x0 = *x1, *x1 = t;
+	}
+	if (*y0 > *y1) {
+		t = *y0, *y0 = *y1, *y1 = t;
+	}
+	*x0 = MAX(*x0, 0);
+	*y0 = MAX(*y0, 0);
+	*x1 = MIN(*x1, win->xpvmax - win->xpvmin);
+	*y1 = MIN(*y1, win->ypvmax - win->ypvmin);
+
+	return (*x0 <= *x1) && (*y0 <= *y1);
+}
+
+/* Fill n pixels with the doubled pixel pattern, a word at a time */
+static void fast_span(COLOR_T *p, INT_32 n, uint32_t pattern)
+{
+	uint32_t *w;
+
+	if ((((uint32_t) p & 2) != 0) && (n > 0)) {
+		*p++ = (COLOR_T) pattern;
+		n--;
+	}
+	w = (uint32_t *) p;
+	while (n >= 8) {
+		w[0] = pattern;
+		w[1] = pattern;
+		w[2] = pattern;
+		w[3] = pattern;
+		w += 4;
+		n -= 8;
+	}
+	while (n >= 2) {
+		*w++ = pattern;
+		n -= 2;
+	}
+	if (n > 0) {
+		*(COLOR_T *) w = (COLOR_T) pattern;
+	}
+}
+
+/* Run the lines of a rectangle on the GPDMA, waiting for each transfer.
+   Returns the number of lines done, the CPU does the rest. */
+static INT_32 fast_dma(uint32_t dst, int32_t dstStride, uint32_t src, int32_t srcStride,
+					   uint32_t bytes, INT_32 lines, bool fill)
+{
+	INT_32 n, done = 0;
+
+	if (dmaCh == GPDMA_NO_CHANNEL) {
+		return 0;
+	}
+	while (done < lines) {
+		n = MIN(lines - done, SWIM_FAST_DMA_LINES);
+		if (Chip_GPDMA_RectTransfer(LPC_GPDMA, dmaCh, dmaDesc, dst, dstStride, src, srcStride,
+									bytes, (uint32_t) n, fill) != SUCCESS) {
+			break;
+		}
+		while (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_ENABLED_CH, dmaCh)) {}
+		Chip_GPDMA_ClearIntPending(LPC_GPDMA, GPDMA_STATCLR_INTTC, dmaCh);
+
+		dst += n * dstStride;
+		if (!fill) {
+			src += n * srcStride;
+		}
+		done += n;
+	}
+
+	return done;
+}
+
+/* Window edges a point is outside of */
+static int fast_outcode(INT_32 x, INT_32 y, INT_32 xmax, INT_32 ymax)
+{
+	int code = 0;
+
+	if (x < 0) {
+		code |= CLIP_LEFT;
+	}
+	else if (x > xmax) {
+		code |= CLIP_RIGHT;
+	}
+	if (y < 0) {
+		code |= CLIP_TOP;
+	}
+	else if (y > ymax) {
+		code |= CLIP_BOTTOM;
+	}
+
+	return code;
+}
+
+/* Cohen-Sutherland clip of a line to the window, false if it is outside */
+static bool fast_clip_line(SWIM_WINDOW_T *win, INT_32 *x0, INT_32 *y0, INT_32 *x1, INT_32 *y1)
+{
+	INT_32 xmax = win->xpvmax - win->xpvmin, ymax = win->ypvmax - win->ypvmin;
+	INT_32 x, y;
+	int c0 = fast_outcode(*x0, *y0, xmax, ymax);
+	int c1 = fast_outcode(*x1, *y1, xmax, ymax);
+	int c;
+
+	while ((c0 | c1) != 0) {
+		if ((c0 & c1) != 0) {
+			return false;
+		}
+
+		/* Move an outside end to the edge it is beyond */
+		c = (c0 != 0) ? c0 : c1;
+		if (c & CLIP_TOP) {
+			y = 0;
+			x = *x0 + (((*x1 - *x0) * (y - *y0)) / (*y1 - *y0));
+		}
+		else if (c & CLIP_BOTTOM) {
+			y = ymax;
+			x = *x0 + (((*x1 - *x0) * (y - *y0)) / (*y1 - *y0));
+		}
+		else if (c & CLIP_LEFT) {
+			x = 0;
+			y = *y0 + (((*y1 - *y0) * (x - *x0)) / (*x1 - *x0));
+		}
+		else {
+			x = xmax;
+			y = *y0 + (((*y1 - *y0) * (x - *x0)) / (*x1 - *x0));
+		}
+
+		if (c == c0) {
+			*x0 = x, *y0 = y;
+			c0 = fast_outcode(x, y, xmax, ymax);
+		}
+		else {
+			*x1 = x, *y1 = y;
+			c1 = fast_outcode(x, y, xmax, ymax);
+		}
+	}
+
+	return true;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Get the GPDMA channel used for rectangles */
+void swim_fast_init(void)
+{
+	Chip_GPDMA_Init(LPC_GPDMA);
+	dmaCh = Chip_GPDMA_GetPriorityChannel(LPC_GPDMA, GPDMA_CONN_MEMORY, GPDMA_PRIO_BACKGROUND, false);
+}
+
+/* Fill a rectangle of a window */
+void swim_fast_fill(SWIM_WINDOW_T *win, INT_32 x0, INT_32 y0, INT_32 x1, INT_32 y1, COLOR_T color)
+{
+	COLOR_T *p;
+	uint32_t pattern = (uint32_t) color | ((uint32_t) color << 16);
+	INT_32 xsize, ysize, y = 0;
+
+	if (!fast_clip_rect(win, &x0, &y0, &x1, &y1)) {
+		return;
+	}
+	xsize = x1 - x0 + 1;
+	ysize = y1 - y0 + 1;
+	p = fast_pixel(win, x0, y0);
+
+	if ((xsize * ysize) >= SWIM_FAST_DMA_MIN_PIXELS) {
+		fillPattern = pattern;
+		y = fast_dma((uint32_t) p, win->xpsize * sizeof(COLOR_T), (uint32_t) &fillPattern, 0,
+					 xsize * sizeof(COLOR_T), ysize, true);
+	}
+	for (p += y * win->xpsize; y < ysize; y++, p += win->xpsize) {
+		fast_span(p, xsize, pattern);
+	}
+}
+
+/* Copy a rectangle of a window to another place in the window */
+void swim_fast_copy(SWIM_WINDOW_T *win, INT_32 xs, INT_32 ys, INT_32 xd, INT_32 yd, INT_32 xsize, INT_32 ysize)
+{
+	INT_32 x0 = xd, y0 = yd, x1 = xd + xsize - 1, y1 = yd + ysize - 1;
+	COLOR_T *src, *dst;
+	int32_t stride = win->xpsize;
+	INT_32 y = 0;
+
+	/* Clip the destination, then the source, moving the other along */
+	if ((xsize <= 0) || (ysize <= 0) || !fast_clip_rect(win, &x0, &y0, &x1, &y1)) {
+		return;
+	}
+	xs += x0 - xd, ys += y0 - yd;
+	xd = x0, yd = y0;
+	xsize = x1 - x0 + 1, ysize = y1 - y0 + 1;
+	x0 = xs, y0 = ys, x1 = xs + xsize - 1, y1 = ys + ysize - 1;
+	if (!fast_clip_rect(win, &x0, &y0, &x1, &y1)) {
+		return;
+	}
+	xd += x0 - xs, yd += y0 - ys;
+	xsize = x1 - x0 + 1, ysize = y1 - y0 + 1;
+	src = fast_pixel(win, x0, y0);
+	dst = fast_pixel(win, xd, yd);
+
+	/* Moving down, copy the lines from the bottom up */
+	if (yd > y0) {
+		src += (ysize - 1) * stride;
+		dst += (ysize - 1) * stride;
+		stride = -stride;
+	}
+
+	/* The GPDMA copies each line upwards, so moves to the right within
+	   the same lines are left to memmove() */
+	if (((xsize * ysize) >= SWIM_FAST_DMA_MIN_PIXELS) && !((yd == y0) && (xd > x0) && (xd < (x0 + xsize)))) {
+		y = fast_dma((uint32_t) dst, stride * (int32_t) sizeof(COLOR_T), (uint32_t) src,
+					 stride * (int32_t) sizeof(COLOR_T), xsize * sizeof(COLOR_T), ysize, false);
+	}
+	for (src += y * stride, dst += y * stride; y < ysize; y++, src += stride, dst += stride) {
+		memmove(dst, src, xsize * sizeof(COLOR_T));
+	}
+}
+
+/* Draw a line in the pen color */
+void swim_fast_line(SWIM_WINDOW_T *win, INT_32 x0, INT_32 y0, INT_32 x1, INT_32 y1)
+{
+	COLOR_T *p;
+	COLOR_T pen = win->pen;
+	INT_32 dx, dy, err, i, t;
+	int32_t sx, sy;
+
+	if (!fast_clip_line(win, &x0, &y0, &x1, &y1)) {
+		return;
+	}
+
+	if (y0 == y1) {
+		if (x0 > x1) {
+			t = x0, x0 = x1, x1 = t;
+		}
+		fast_span(fast_pixel(win, x0, y0), x1 - x0 + 1, (uint32_t) pen | ((uint32_t) pen << 16));
+		return;
+	}
+
+	/* Bresenham on the frame buffer address, no per pixel clipping */
+	p = fast_pixel(win, x0, y0);
+	dx = (x1 > x0) ? (x1 - x0) : (x0 - x1);
+	dy = (y1 > y0) ? (y1 - y0) : (y0 - y1);
+	sx = (x1 > x0) ? 1 : -1;
+	sy = (y1 > y0) ? win->xpsize : -win->xpsize;
+	if (dx >= dy) {
+		err = dx / 2;
+		for (i = 0; i <= dx; i++) {
+			*p = pen;
+			p += sx;
+			err -= dy;
+			if (err < 0) {
+				p += sy;
+				err += dx;
+			}
+		}
+	}
+	else {
+		err = dy / 2;
+		for (i = 0; i <= dy; i++) {
+			*p = pen;
+			p += sy;
+			err -= dx;
+			if (err < 0) {
+				p += sx;
+				err += dy;
+			}
+		}
+	}
+}
@@ -0,0 +1,107 @@
+/*
+ * @brief Accelerated SWIM drawing primitives
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+#ifndef __SWIM_FAST_H_
+#define __SWIM_FAST_H_
+
+#include "board.h"
+#include "lpc_swim.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* These work on the frame buffer of a SWIM window directly, with 16-bit
+   COLOR_T pixels, and are clipped to the window once per call instead of
+   once per pixel. Rectangles are filled and copied with the GPDMA. */
+
+/** Rectangles with fewer pixels are done by the CPU */
+#ifndef SWIM_FAST_DMA_MIN_PIXELS
+#define SWIM_FAST_DMA_MIN_PIXELS    256
+#endif
+
+/** Lines per GPDMA rectangle transfer, one descriptor each */
+#ifndef SWIM_FAST_DMA_LINES
+#define SWIM_FAST_DMA_LINES         64
+#endif
+
+/**
+ * @brief	Get the GPDMA channel used for rectangles
+ * @return	Nothing
+ * @note	Without a channel everything is done by the CPU.
+ */
+void swim_fast_init(void);
+
+/**
+ * @brief	Fill a rectangle of a window
+ * @param	win		: Window
+ * @param	x0		: Virtual x of one corner
+ * @param	y0		: Virtual y of one corner
+ * @param	x1		: Virtual x of the opposite corner, inclusive
+ * @param	y1		: Virtual y of the opposite corner, inclusive
+ * @param	color	: Fill color
+ * @return	Nothing
+ */
+void swim_fast_fill(SWIM_WINDOW_T *win, INT_32 x0, INT_32 y0, INT_32 x1, INT_32 y1, COLOR_T color);
+
+/**
+ * @brief	Copy a rectangle of a window to another place in the window
+ * @param	win		: Window
+ * @param	xs		: Virtual x of the top left source pixel
+ * @param	ys		: Virtual y of the top left source pixel
+ * @param	xd		: Virtual x of the top left destination pixel
+ * @param	yd		: Virtual y of the top left destination pixel
+ * @param	xsize	: Width in pixels
+ * @param	ysize	: Height in pixels
+ * @return	Nothing
+ * @note	Source and destination may overlap, for scrolling. Both are
+ *			clipped to the window.
+ */
+void swim_fast_copy(SWIM_WINDOW_T *win, INT_32 xs, INT_32 ys, INT_32 xd, INT_32 yd, INT_32 xsize, INT_32 ysize);
+
+/**
+ * @brief	Draw a line in the pen color
+ * @param	win		: Window
+ * @param	x0		: Virtual x of the start
+ * @param	y0		: Virtual y of the start
+ * @param	x1		: Virtual x of the end
+ * @param	y1		: Virtual y of the end
+ * @return	Nothing
+ * @note	The part of the line in the window is found before drawing.
+ *			Horizontal lines are filled a word at a time.
+ */
+void swim_fast_line(SWIM_WINDOW_T *win, INT_32 x0, INT_32 y0, INT_32 x1, INT_32 y1);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SWIM_FAST_H_ */
@@ -0,0 +1,104 @@
+/*
+ * @brief uC/OS-III hooks for the RTOS event trace
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include "os.h"
+#include "rtos_trace.h"
+
+#ifdef RTOS_TRACE
+
+#if (OS_CFG_APP_HOOKS_EN == 0u)
+#error "UCOS_Trace_Init() needs OS_CFG_APP_HOOKS_EN set in os_cfg.h"
+#endif
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* uC/OS-III has no task number, the TCB address stands in for it */
+STATIC INLINE uint16_t trace_task_id(OS_TCB *p_tcb)
+{
+	return (uint16_t) (((uint32_t) p_tcb) >> 2);
+}
+
+/* Called by OSTaskSwHook() with interrupts masked, OSTCBHighRdyPtr is the
+   task about to run */
+static void trace_task_sw(void)
+{
+	RTOS_Trace_Put(RTOS_TRACE_EV_TASK_IN, trace_task_id(OSTCBHighRdyPtr),
+				   (uint8_t) OSTCBHighRdyPtr->Prio);
+}
+
+/* Called by OSTaskCreateHook() */
+static void trace_task_create(OS_TCB *p_tcb)
+{
+	RTOS_Trace_Put(RTOS_TRACE_EV_TASK_CREATE, trace_task_id(p_tcb), (uint8_t) p_tcb->Prio);
+}
+
+#ifdef RTOS_TRACE_TICKS
+/* Called by OSTimeTickHook() from the tick interrupt */
+static void trace_tick(void)
+{
+	RTOS_Trace_Put(RTOS_TRACE_EV_TICK, (uint16_t) OSTickCtr, 0);
+}
+
+#endif
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start the trace and hook it into the kernel */
+void UCOS_Trace_Init(void)
+{
+	CPU_SR_ALLOC();
+
+	RTOS_Trace_Init();
+
+	CPU_CRITICAL_ENTER();
+	OS_AppTaskSwHookPtr = trace_task_sw;
+	OS_AppTaskCreateHookPtr = trace_task_create;
+#ifdef RTOS_TRACE_TICKS
+	OS_AppTimeTickHookPtr = trace_tick;
+#endif
+	CPU_CRITICAL_EXIT();
+}
+
+#endif /* RTOS_TRACE */
@@ -34,6 +34,9 @@
 
 #include "board.h"
 #include "os.h"
+#ifdef RTOS_TRACE
+#include "rtos_trace.h"
+#endif
 
 // FIXME - needs standards formatting
 
@@ -42,6 +45,10 @@ static CPU_STK vLEDTask1Stk[APP_CFG_TASK_START_STK_SIZE];
 static CPU_STK vLEDTask2Stk[APP_CFG_TASK_START_STK_SIZE];
 static CPU_STK vUARTTaskStk[APP_CFG_TASK_START_STK_SIZE];
 extern void OS_CSP_TickInit(void);
+#ifdef RTOS_TRACE
+/* One trace packet, as it would go out on a USB HID or bulk endpoint */
+static uint8_t tracePkt[RTOS_TRACE_PKT_BYTES];
+#endif
 
 /* Sets up system hardware */
 static void prvSetupHardware(void)
@@ -78,6 +85,19 @@ static void vUARTTask (void *p_arg)
 		DEBUGOUT("Tick: %d\r\n", tickCnt);
 		tickCnt++;
 
+#ifdef RTOS_TRACE
+		{
+			/* Stands in for the USB channel, only the totals are printed */
+			uint32_t recs = 0, dropped = 0;
+
+			while (RTOS_Trace_Read(tracePkt) != 0) {
+				recs += tracePkt[3];
+				dropped += tracePkt[4] | (tracePkt[5] << 8);
+			}
+			DEBUGOUT("Trace: %d records, %d dropped\r\n", recs, dropped);
+		}
+#endif
+
 		/* About a 1s delay here */
     OSTimeDlyHMSM(0u, 0u, 1u, 0u, OS_OPT_TIME_HMSM_STRICT, &err);
 	}
@@ -143,6 +163,10 @@ int main(void)
 
 	OSInit(&os_err);
 
+#ifdef RTOS_TRACE
+	UCOS_Trace_Init();
+#endif
+
 	OSTaskCreate(	(OS_TCB      *)&vLEDTask1TCB,
 								(CPU_CHAR    *)"vLEDTask1",
 								(OS_TASK_PTR  )vLEDTask1, 
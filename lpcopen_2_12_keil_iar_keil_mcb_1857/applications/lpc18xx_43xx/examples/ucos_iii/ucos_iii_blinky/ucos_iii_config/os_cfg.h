@@ -31,7 +31,11 @@
 
 
                                              /* ---------------------------- MISCELLANEOUS -------------------------- */
+#ifdef RTOS_TRACE                            /* The event trace installs its hooks (ucos_iii/common/ucos_trace.c)     */
+#define OS_CFG_APP_HOOKS_EN             1u   /* Enable (1) or Disable (0) application specific hooks                  */
+#else
 #define OS_CFG_APP_HOOKS_EN             0u   /* Enable (1) or Disable (0) application specific hooks                  */
+#endif
 #define OS_CFG_ARG_CHK_EN               0u   /* Enable (1) or Disable (0) argument checking                           */
 #define OS_CFG_CALLED_FROM_ISR_CHK_EN   0u   /* Enable (1) or Disable (0) check for called from ISR                   */
 #define OS_CFG_DBG_EN                   1u   /* Enable (1) debug code/variables                                       */
@@ -44,6 +44,55 @@ extern "C"
 #define USE_USB0
 /* #define USE_USB1 */
 
+/* Uncomment below to keep the bulk endpoints busy all the time: each dTD that
+   completes is re-armed and linked behind the last pending one of its
+   endpoint, so the controller never runs out of descriptors. Without it the
+   chain of BWTEST_DTD_NUM dTDs is re-primed only after all of them are done,
+   which leaves the endpoint idle during the re-prime. */
+/* #define BWTEST_DTD_RELINK */
+
+/* Number of dTDs per endpoint and bytes per dTD. The test buffer is 4KB
+   aligned, so the 5 page pointers of a dTD cover up to 20KB. */
+#define BWTEST_DTD_NUM          8
+#define BWTEST_DTD_BYTES        0x5000
+
+#if BWTEST_DTD_NUM < 2 || BWTEST_DTD_BYTES > 0x5000 || BWTEST_DTD_BYTES < 1
+#error "BWTest: need 2 or more dTDs per endpoint of at most 20KB each"
+#endif
+
+/* Uncomment below to turn EP2 OUT/IN into isochronous endpoints. At high
+   speed they move BWTEST_ISO_MULT packets of BWTEST_ISO_HS_MAXPACKET bytes
+   every microframe, at full speed one packet of BWTEST_ISO_FS_MAXPACKET bytes
+   every frame. Each dTD holds one (micro)frame of data and the debug UART
+   reports missed (micro)frames and completion jitter next to the throughput.
+   EP1 stays bulk. Isochronous endpoints must never run dry, so this mode
+   always uses the relinked dTD chain. */
+/* #define BWTEST_ISO */
+
+#define BWTEST_ISO_HS_MAXPACKET 1024	/* wMaxPacketSize[10:0] */
+#define BWTEST_ISO_MULT         3		/* transactions per microframe */
+#define BWTEST_ISO_FS_MAXPACKET 1023
+
+#if BWTEST_ISO_MULT < 1 || BWTEST_ISO_MULT > 3 || BWTEST_ISO_HS_MAXPACKET > 1024 || \
+	BWTEST_ISO_FS_MAXPACKET > 1023
+#error "BWTest: isochronous endpoints take at most 3 x 1024 bytes per microframe at HS and 1023 bytes at FS"
+#endif
+
+#ifdef BWTEST_ISO
+#ifndef BWTEST_DTD_RELINK
+#define BWTEST_DTD_RELINK
+#endif
+#define BWTEST_EP2_ATTRIBUTES   (USB_ENDPOINT_TYPE_ISOCHRONOUS | USB_ENDPOINT_SYNC_ASYNCHRONOUS)
+#define BWTEST_EP2_HS_MAXPACKET (BWTEST_ISO_HS_MAXPACKET | ((BWTEST_ISO_MULT - 1) << 11))
+#define BWTEST_EP2_FS_MAXPACKET BWTEST_ISO_FS_MAXPACKET
+#define BWTEST_EP2_INTERVAL     1		/* every (micro)frame */
+#else
+#define BWTEST_EP2_ATTRIBUTES   USB_ENDPOINT_TYPE_BULK
+#define BWTEST_EP2_HS_MAXPACKET 512
+#define BWTEST_EP2_FS_MAXPACKET 64
+#define BWTEST_EP2_INTERVAL     0
+#endif
+
 /* Manifest constants used by USBD ROM stack. These values SHOULD NOT BE CHANGED
    for advance features which require usage of USB_CORE_CTRL_T structure.
    Since these are the values used for compiling USB stack.
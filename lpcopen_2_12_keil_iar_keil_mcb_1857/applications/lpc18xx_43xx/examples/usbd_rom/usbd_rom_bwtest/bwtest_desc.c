@@ -114,20 +114,20 @@ ALIGNED(4) uint8_t USB_FsConfigDescriptor[] = {
 	USB_ENDPOINT_TYPE_BULK,			/* bmAttributes */
 	WBVAL(64),						/* wMaxPacketSize */
 	0,								/* bInterval */
-	/* EP2 Bulk Out Endpoint */
+	/* EP2 Out Endpoint */
 	USB_ENDPOINT_DESC_SIZE,			/* bLength */
 	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	USB_ENDPOINT_OUT(2),			/* bEndpointAddress */
-	USB_ENDPOINT_TYPE_BULK,			/* bmAttributes */
-	WBVAL(64),						/* wMaxPacketSize */
-	0,								/* bInterval */
-	/* EP2 Bulk In Endpoint */
+	BWTEST_EP2_ATTRIBUTES,			/* bmAttributes */
+	WBVAL(BWTEST_EP2_FS_MAXPACKET),	/* wMaxPacketSize */
+	BWTEST_EP2_INTERVAL,			/* bInterval */
+	/* EP2 In Endpoint */
 	USB_ENDPOINT_DESC_SIZE,			/* bLength */
 	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	USB_ENDPOINT_IN(2),				/* bEndpointAddress */
-	USB_ENDPOINT_TYPE_BULK,			/* bmAttributes */
-	WBVAL(64),						/* wMaxPacketSize */
-	0,								/* bInterval */
+	BWTEST_EP2_ATTRIBUTES,			/* bmAttributes */
+	WBVAL(BWTEST_EP2_FS_MAXPACKET),	/* wMaxPacketSize */
+	BWTEST_EP2_INTERVAL,			/* bInterval */
 	/* Terminator */
 	0								/* bLength */
 };
@@ -172,20 +172,20 @@ ALIGNED(4) uint8_t USB_HsConfigDescriptor[] = {
 	USB_ENDPOINT_TYPE_BULK,			/* bmAttributes */
 	WBVAL(512),						/* wMaxPacketSize */
 	0,								/* bInterval */
-	/* EP2 Bulk In Endpoint */
+	/* EP2 Out Endpoint */
 	USB_ENDPOINT_DESC_SIZE,			/* bLength */
 	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	USB_ENDPOINT_OUT(2),			/* bEndpointAddress */
-	USB_ENDPOINT_TYPE_BULK,			/* bmAttributes */
-	WBVAL(512),						/* wMaxPacketSize */
-	0,								/* bInterval */
-	/* EP2 Bulk In Endpoint */
+	BWTEST_EP2_ATTRIBUTES,			/* bmAttributes */
+	WBVAL(BWTEST_EP2_HS_MAXPACKET),	/* wMaxPacketSize */
+	BWTEST_EP2_INTERVAL,			/* bInterval */
+	/* EP2 In Endpoint */
 	USB_ENDPOINT_DESC_SIZE,			/* bLength */
 	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	USB_ENDPOINT_IN(2),				/* bEndpointAddress */
-	USB_ENDPOINT_TYPE_BULK,			/* bmAttributes */
-	WBVAL(512),						/* wMaxPacketSize */
-	0,								/* bInterval */
+	BWTEST_EP2_ATTRIBUTES,			/* bmAttributes */
+	WBVAL(BWTEST_EP2_HS_MAXPACKET),	/* wMaxPacketSize */
+	BWTEST_EP2_INTERVAL,			/* bInterval */
 	/* Terminator */
 	0								/* bLength */
 };
@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "app_usbd_cfg.h"
+#include "usbd_ep0patch.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -41,8 +42,7 @@
 static USBD_HANDLE_T g_hUsb;
 
 /* Endpoint 0 patch that prevents nested NAK event processing */
-static uint32_t g_ep0RxBusy = 0;/* flag indicating whether EP0 OUT/RX buffer is busy. */
-static USB_EP_HANDLER_T g_Ep0BaseHdlr;	/* variable to store the pointer to base EP0 handler */
+static USBEP0PATCH_T g_ep0Patch;
 
 #define EP1_OUT_INDEX           2
 #define EP1_OUT_BIT             _BIT(1)
@@ -56,6 +56,28 @@ static USB_EP_HANDLER_T g_Ep0BaseHdlr;	/* variable to store the pointer to base
 /* dTD field and bit defines */
 #define TD_NEXT_TERMINATE       _BIT(0)
 #define TD_IOC                  _BIT(15)
+#define TD_ACTIVE               _BIT(7)
+#define TD_BYTES(total)         (((total) >> 16) & 0x7FFF)
+#define TD_XACT_ERR             _BIT(3)
+#define TD_BUF_ERR              _BIT(5)
+
+#ifdef BWTEST_ISO
+/* dQH capabilities field bits */
+#define DQH_CAP_MAXP_SHIFT      16
+#define DQH_CAP_MAXP_MASK       (0x7FF << DQH_CAP_MAXP_SHIFT)
+#define DQH_CAP_MULT_SHIFT      30
+#define DQH_CAP_MULT_MASK       (0x3UL << DQH_CAP_MULT_SHIFT)
+
+/* FRINDEX_D counts microframes at HS, frames in bits 13:3 at FS */
+#define FRINDEX_MASK            0x3FFF
+#endif
+
+/* USBCMD_D add dTD tripwire */
+#define USBCMD_ATDTW            _BIT(14)
+
+/* Throughput is printed on the debug UART every BWTEST_REPORT_TICKS */
+#define BWTEST_TICK_HZ          10
+#define BWTEST_REPORT_TICKS     10
 #define USB_DEST_ADDR           0x20004000
 
 /* dTD Transfer Description */
@@ -86,6 +108,20 @@ typedef volatile struct {
 	volatile uint32_t gap[4];
 }  DQH_T;
 
+#ifdef BWTEST_ISO
+/* Isochronous endpoint statistics, reset every report period */
+typedef struct {
+	uint32_t started;		/*!< Set once the first dTD completed */
+	uint32_t frindex;		/*!< FRINDEX_D at the last completion */
+	uint32_t cyc;			/*!< DWT cycle count at the last completion */
+	uint32_t slots;			/*!< (Micro)frames elapsed between completions */
+	uint32_t done;			/*!< dTDs retired in those (micro)frames */
+	uint32_t errors;		/*!< dTDs retired with a transaction or buffer error */
+	uint32_t jitter;		/*!< Max deviation of a completion from its slot, in cycles */
+} BWTEST_ISO_STATS_T;
+
+#endif
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -94,34 +130,23 @@ const USBD_API_T *g_pUsbApi;
 DTD_T *g_dtdPool[4];
 int ep_count[4];
 
+#ifdef BWTEST_DTD_RELINK
+static uint32_t g_dtdHead[4];			/* oldest dTD in flight per endpoint */
+static uint32_t g_dtdTail[4];			/* last linked dTD per endpoint */
+#endif
+static uint32_t g_tdBytes[4];			/* bytes per dTD per endpoint */
+static volatile uint32_t g_epBytes[4];	/* bytes moved per endpoint */
+#ifdef BWTEST_ISO
+static BWTEST_ISO_STATS_T g_iso[2];		/* EP2 OUT and EP2 IN */
+static uint32_t g_slotCycles;			/* CPU cycles per (micro)frame */
+static bool g_isoHs;
+#endif
+static volatile uint32_t g_ticks;
+
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
 
-/* EP0_patch part of WORKAROUND for artf45032. */
-static ErrorCode_t EP0_patch(USBD_HANDLE_T hUsb, void *data, uint32_t event)
-{
-	switch (event) {
-	case USB_EVT_OUT_NAK:
-		if (g_ep0RxBusy) {
-			/* we already queued the buffer so ignore this NAK event. */
-			return LPC_OK;
-		}
-		else {
-			/* Mark EP0_RX buffer as busy and allow base handler to queue the buffer. */
-			g_ep0RxBusy = 1;
-		}
-		break;
-
-	case USB_EVT_SETUP:	/* reset the flag when new setup sequence starts */
-	case USB_EVT_OUT:
-		/* we received the packet so clear the flag. */
-		g_ep0RxBusy = 0;
-		break;
-	}
-	return g_Ep0BaseHdlr(hUsb, data, event);
-}
-
 /* If there is any error then stop here forever. */
 static void vCatchErr(uint8_t u8Err)
 {
@@ -130,6 +155,21 @@ static void vCatchErr(uint8_t u8Err)
 	while (1) {}
 }
 
+/* Arm one transfer descriptor, it becomes the end of the chain */
+static void bwtest_USB_Init_DTD(DTD_T *pTD, uint32_t bytes)
+{
+	pTD->next_dTD = TD_NEXT_TERMINATE;
+	pTD->total_bytes = (bytes << 16) | TD_IOC | TD_ACTIVE;
+	/* we will use same memory area for Rx and Tx for EP1 & EP2. Since we are
+	   just interested in throughput instead of data in this test */
+	pTD->buffer0 = USB_DEST_ADDR;
+	pTD->buffer1 = (USB_DEST_ADDR + 0x1000);
+	pTD->buffer2 = (USB_DEST_ADDR + 0x2000);
+	pTD->buffer3 = (USB_DEST_ADDR + 0x3000);
+	pTD->buffer4 = (USB_DEST_ADDR + 0x4000);
+	pTD->reserved = 0;
+}
+
 /* Program transfer descriptors for given endpoint. */
 static void bwtest_USB_Prog_DTD(uint32_t epIndex, uint32_t epBit)
 {
@@ -141,23 +181,19 @@ static void bwtest_USB_Prog_DTD(uint32_t epIndex, uint32_t epBit)
 	DTD_T *ep_TD = &g_dtdPool[epIndex - 2][0];
 
 	/* Zero out the device transfer descriptors */
-	memset((void *) dtd_phys, 0, 8 * sizeof(DTD_T));
-
-	/* set each TD to transfer 20KB */
-	for (i = 0; i < 8; i++) {
-		ep_TD[i].next_dTD = (uint32_t) (dtd_phys + ((1 + i) * sizeof(DTD_T)));
-		ep_TD[i].total_bytes = (0x5000 << 16) | TD_IOC | 0x80;
-		/* we will use same memory area for Rx and Tx for EP1 & EP2. Since we are
-		   just interested in throughput instead of data in this test */
-		ep_TD[i].buffer0 = USB_DEST_ADDR;
-		ep_TD[i].buffer1 = (USB_DEST_ADDR + 0x1000);
-		ep_TD[i].buffer2 = (USB_DEST_ADDR + 0x2000);
-		ep_TD[i].buffer3 = (USB_DEST_ADDR + 0x3000);
-		ep_TD[i].buffer4 = (USB_DEST_ADDR + 0x4000);
-		ep_TD[i].reserved = 0;
-	}
+	memset((void *) dtd_phys, 0, BWTEST_DTD_NUM * sizeof(DTD_T));
 
-	ep_TD[7].next_dTD = 0x01;	/* The next DTD pointer is INVALID */
+	/* set each TD to transfer g_tdBytes, the last one ends the chain */
+	for (i = 0; i < BWTEST_DTD_NUM; i++) {
+		bwtest_USB_Init_DTD(&ep_TD[i], g_tdBytes[epIndex - 2]);
+		if (i < (BWTEST_DTD_NUM - 1)) {
+			ep_TD[i].next_dTD = (uint32_t) (dtd_phys + ((1 + i) * sizeof(DTD_T)));
+		}
+	}
+#ifdef BWTEST_DTD_RELINK
+	g_dtdHead[epIndex - 2] = 0;
+	g_dtdTail[epIndex - 2] = BWTEST_DTD_NUM - 1;
+#endif
 
 	/* update the hardware endpoint queue */
 	ep_QH[epIndex].next_dTD = dtd_phys;
@@ -167,11 +203,139 @@ static void bwtest_USB_Prog_DTD(uint32_t epIndex, uint32_t epBit)
 	LPC_USB->ENDPTPRIME |= epBit;
 }
 
+#ifdef BWTEST_DTD_RELINK
+/* Re-arm dTD n and link it behind the last pending dTD of the endpoint,
+   following the add dTD to a non-empty list sequence of the user manual. */
+static void bwtest_USB_Relink_DTD(uint32_t epIndex, uint32_t epBit, uint32_t n)
+{
+	DQH_T *ep_QH = (DQH_T *) LPC_USB->ENDPOINTLISTADDR;
+	DTD_T *ep_TD = &g_dtdPool[epIndex - 2][0];
+	uint32_t status;
+
+	bwtest_USB_Init_DTD(&ep_TD[n], g_tdBytes[epIndex - 2]);
+	ep_TD[g_dtdTail[epIndex - 2]].next_dTD = (uint32_t) &ep_TD[n];
+	g_dtdTail[epIndex - 2] = n;
+
+	/* a prime still in progress picks the new link up */
+	if (LPC_USB->ENDPTPRIME & epBit) {
+		return;
+	}
+	/* read a consistent endpoint status, the tripwire is cleared by the
+	   controller if it touched the queue head meanwhile */
+	do {
+		LPC_USB->USBCMD_D |= USBCMD_ATDTW;
+		status = LPC_USB->ENDPTSTAT & epBit;
+	} while ((LPC_USB->USBCMD_D & USBCMD_ATDTW) == 0);
+	LPC_USB->USBCMD_D &= ~USBCMD_ATDTW;
+	if (status) {
+		return;
+	}
+
+	/* the endpoint ran dry before it saw the link, restart it at dTD n */
+	ep_QH[epIndex].next_dTD = (uint32_t) &ep_TD[n];
+	ep_QH[epIndex].total_bytes &= (~0xC0);
+	LPC_USB->ENDPTPRIME |= epBit;
+}
+
+/* Retire all dTDs the controller finished, one event may cover several.
+   Returns the number of dTDs retired. */
+static uint32_t bwtest_USB_Retire_DTD(uint32_t epIndex, uint32_t epBit)
+{
+	DTD_T *ep_TD = &g_dtdPool[epIndex - 2][0];
+	uint32_t n, i;
+
+	for (i = 0; i < BWTEST_DTD_NUM; i++) {
+		n = g_dtdHead[epIndex - 2];
+		if (ep_TD[n].total_bytes & TD_ACTIVE) {
+			break;
+		}
+#ifdef BWTEST_ISO
+		if ((epIndex >= EP2_OUT_INDEX) && (ep_TD[n].total_bytes & (TD_XACT_ERR | TD_BUF_ERR))) {
+			g_iso[epIndex - EP2_OUT_INDEX].errors++;
+		}
+#endif
+		g_epBytes[epIndex - 2] += g_tdBytes[epIndex - 2] - TD_BYTES(ep_TD[n].total_bytes);
+		g_dtdHead[epIndex - 2] = (n + 1) % BWTEST_DTD_NUM;
+		bwtest_USB_Relink_DTD(epIndex, epBit, n);
+	}
+	return i;
+}
+
+#endif
+
+#ifdef BWTEST_ISO
+/* Program the packet size and the transactions per microframe of an
+   isochronous endpoint into its queue head, the ROM stack only knows about
+   single packet endpoints. */
+static void bwtest_Iso_SetCap(uint32_t epIndex)
+{
+	DQH_T *ep_QH = (DQH_T *) LPC_USB->ENDPOINTLISTADDR;
+	uint32_t cap = ep_QH[epIndex].cap;
+
+	cap &= ~(DQH_CAP_MAXP_MASK | DQH_CAP_MULT_MASK);
+	if (g_isoHs) {
+		cap |= (BWTEST_ISO_HS_MAXPACKET << DQH_CAP_MAXP_SHIFT) | (BWTEST_ISO_MULT << DQH_CAP_MULT_SHIFT);
+	}
+	else {
+		cap |= (BWTEST_ISO_FS_MAXPACKET << DQH_CAP_MAXP_SHIFT) | (1UL << DQH_CAP_MULT_SHIFT);
+	}
+	ep_QH[epIndex].cap = cap;
+}
+
+/* Account n dTDs retired by one endpoint event against the (micro)frames
+   that passed since the previous event. Each dTD holds one (micro)frame, so
+   any surplus of frames is a frame the endpoint missed, and the distance of
+   the event from n slots after the previous one is its jitter. */
+static void bwtest_Iso_Account(BWTEST_ISO_STATS_T *pIso, uint32_t n)
+{
+	uint32_t frindex = LPC_USB->FRINDEX_D & FRINDEX_MASK;
+	uint32_t cyc = DWT->CYCCNT;
+	uint32_t slots, expect, dev;
+
+	if (n == 0) {
+		return;
+	}
+	if (pIso->started) {
+		slots = (frindex - pIso->frindex) & FRINDEX_MASK;
+		if (!g_isoHs) {
+			slots >>= 3;
+		}
+		pIso->slots += slots;
+		pIso->done += n;
+		expect = n * g_slotCycles;
+		dev = cyc - pIso->cyc;
+		dev = (dev > expect) ? (dev - expect) : (expect - dev);
+		pIso->jitter = MAX(pIso->jitter, dev);
+	}
+	pIso->started = 1;
+	pIso->frindex = frindex;
+	pIso->cyc = cyc;
+}
+
+#endif
+
 /* USB Configure Event Callback. Called automatically after active
  * configuration is selected.
  */
 static ErrorCode_t bwtest_ConfigureEvent(USBD_HANDLE_T hUsb)
 {
+	uint32_t i;
+
+	for (i = 0; i < 4; i++) {
+		g_tdBytes[i] = BWTEST_DTD_BYTES;
+	}
+#ifdef BWTEST_ISO
+	/* EP2 dTDs hold one (micro)frame worth of data */
+	g_isoHs = (((USB_CORE_CTRL_T *) hUsb)->device_speed == USB_HIGH_SPEED);
+	/* UsbEp0Patch_Install() already started the DWT cycle counter */
+	g_slotCycles = SystemCoreClock / (g_isoHs ? 8000 : 1000);
+	g_tdBytes[EP2_OUT_INDEX - 2] = g_tdBytes[EP2_IN_INDEX - 2] =
+		g_isoHs ? (BWTEST_ISO_MULT * BWTEST_ISO_HS_MAXPACKET) : BWTEST_ISO_FS_MAXPACKET;
+	memset(g_iso, 0, sizeof(g_iso));
+	bwtest_Iso_SetCap(EP2_OUT_INDEX);
+	bwtest_Iso_SetCap(EP2_IN_INDEX);
+#endif
+
 	/* setup the transfer descriptors for all bandwidth test endpoints */
 	bwtest_USB_Prog_DTD(EP1_OUT_INDEX, EP1_OUT_BIT);	/* EP1_OUT */
 	bwtest_USB_Prog_DTD(EP2_OUT_INDEX, EP2_OUT_BIT);	/* EP2_OUT */
@@ -186,16 +350,33 @@ static ErrorCode_t bwtest_ConfigureEvent(USBD_HANDLE_T hUsb)
  */
 static ErrorCode_t bwtest_EpHandler(uint32_t event, uint32_t epIndex, uint32_t epBit)
 {
+#ifdef BWTEST_DTD_RELINK
+	uint32_t n;
+#endif
+
 	switch (event) {
 
 	case USB_EVT_OUT:
 	case USB_EVT_IN:
+#ifdef BWTEST_DTD_RELINK
+		/* put finished TDs straight back behind the pending ones */
+		n = bwtest_USB_Retire_DTD(epIndex, epBit);
+#ifdef BWTEST_ISO
+		if (epIndex >= EP2_OUT_INDEX) {
+			bwtest_Iso_Account(&g_iso[epIndex - EP2_OUT_INDEX], n);
+		}
+#else
+		(void) n;
+#endif
+#else
 		/* enqueue next TD to transfer to external SRAM */
+		g_epBytes[epIndex - 2] += BWTEST_DTD_BYTES;
 		ep_count[epIndex - 2]++;
-		if (ep_count[epIndex - 2] == 8) {
+		if (ep_count[epIndex - 2] == BWTEST_DTD_NUM) {
 			ep_count[epIndex - 2] = 0;
 			bwtest_USB_Prog_DTD(epIndex, epBit);
 		}
+#endif
 		break;
 
 	case USB_EVT_IN_NAK:
@@ -302,8 +483,14 @@ static ErrorCode_t bwtest_ep0_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t even
  * Public functions
  ****************************************************************************/
 
+/* Handle interrupt from SysTick timer */
+void SysTick_Handler(void)
+{
+	g_ticks++;
+}
+
 /* Handle interrupt from USB */
-void USB_IRQHandler(void)
+HOTFUNC void USB_IRQHandler(void)
 {
 	USBD_API->hw->ISR(g_hUsb);
 }
@@ -314,7 +501,6 @@ int main(void)
 	USBD_API_INIT_PARAM_T usb_param;
 	USB_CORE_DESCS_T desc;
 	ErrorCode_t ret = LPC_OK;
-	USB_CORE_CTRL_T *pCtrl;
 
 	/* Initialize board and chip */
 	SystemCoreClockUpdate();
@@ -356,16 +542,8 @@ int main(void)
 		vCatchErr(1);
 	}
 
-	/*	WORKAROUND for artf45032 ROM driver BUG:
-	    Due to a race condition there is the chance that a second NAK event will
-	    occur before the default endpoint0 handler has completed its preparation
-	    of the DMA engine for the first NAK event. This can cause certain fields
-	    in the DMA descriptors to be in an invalid state when the USB controller
-	    reads them, thereby causing a hang.
-	 */
-	pCtrl = (USB_CORE_CTRL_T *) g_hUsb;	/* convert the handle to control structure */
-	g_Ep0BaseHdlr = pCtrl->ep_event_hdlr[0];/* retrieve the default EP0_OUT handler */
-	pCtrl->ep_event_hdlr[0] = EP0_patch;/* set our patch routine as EP0_OUT handler */
+	/* WORKAROUND for artf45032 ROM driver BUG, see usbd_ep0patch.h */
+	UsbEp0Patch_Install(&g_ep0Patch, g_hUsb);
 
 	/* allocate TDs for bandwidth test in USB accessable memory*/
 	while (usb_param.mem_base & 0x1F) {
@@ -373,19 +551,19 @@ int main(void)
 	}
 	/* allocate DTDs for EP1_OUT */
 	g_dtdPool[0] = (DTD_T *) usb_param.mem_base;
-	usb_param.mem_base += (8 * sizeof(DTD_T));
+	usb_param.mem_base += (BWTEST_DTD_NUM * sizeof(DTD_T));
 	/* allocate DTDs for EP1_IN */
 	g_dtdPool[1] = (DTD_T *) usb_param.mem_base;
-	usb_param.mem_base += (8 * sizeof(DTD_T));
+	usb_param.mem_base += (BWTEST_DTD_NUM * sizeof(DTD_T));
 	/* allocate DTDs for EP2_OUT */
 	g_dtdPool[2] = (DTD_T *) usb_param.mem_base;
-	usb_param.mem_base += (8 * sizeof(DTD_T));
+	usb_param.mem_base += (BWTEST_DTD_NUM * sizeof(DTD_T));
 	/* allocate DTDs for EP2_IN */
 	g_dtdPool[3] = (DTD_T *) usb_param.mem_base;
-	usb_param.mem_base += (8 * sizeof(DTD_T));
+	usb_param.mem_base += (BWTEST_DTD_NUM * sizeof(DTD_T));
 
 	/* update size for all four EPs */
-	usb_param.mem_size -= (4 * 8 * sizeof(DTD_T));
+	usb_param.mem_size -= (4 * BWTEST_DTD_NUM * sizeof(DTD_T));
 
 	/* register EP1 handler */
 	ret = USBD_API->core->RegisterEpHandler(g_hUsb, EP1_OUT_INDEX, bwtest_Ep1OutHandler, 0);
@@ -418,7 +596,43 @@ int main(void)
 	/* now connect */
 	USBD_API->hw->Connect(g_hUsb, 1);
 
+	/* report throughput once per BWTEST_REPORT_TICKS */
+	SysTick_Config(SystemCoreClock / BWTEST_TICK_HZ);
+
 	while (1) {
+		uint32_t i, bytes[4];
+#ifdef BWTEST_ISO
+		BWTEST_ISO_STATS_T iso[2];
+#endif
+
+		if (g_ticks >= BWTEST_REPORT_TICKS) {
+			/* snapshot and clear, counters are updated from the USB IRQ */
+			NVIC_DisableIRQ(LPC_USB_IRQ);	/* enter critical section */
+			for (i = 0; i < 4; i++) {
+				bytes[i] = g_epBytes[i];
+				g_epBytes[i] = 0;
+			}
+#ifdef BWTEST_ISO
+			for (i = 0; i < 2; i++) {
+				iso[i] = g_iso[i];
+				g_iso[i].slots = g_iso[i].done = 0;
+				g_iso[i].errors = g_iso[i].jitter = 0;
+			}
+#endif
+			g_ticks = 0;
+			NVIC_EnableIRQ(LPC_USB_IRQ);	/* exit critical section */
+			DEBUGOUT("KB/s EP1 OUT %lu IN %lu EP2 OUT %lu IN %lu\r\n",
+					 (unsigned long) (bytes[0] / 1024), (unsigned long) (bytes[1] / 1024),
+					 (unsigned long) (bytes[2] / 1024), (unsigned long) (bytes[3] / 1024));
+#ifdef BWTEST_ISO
+			for (i = 0; i < 2; i++) {
+				DEBUGOUT("ISO EP2 %s missed %lu err %lu jitter %lu us\r\n", i ? "IN " : "OUT",
+						 (unsigned long) ((iso[i].slots > iso[i].done) ? (iso[i].slots - iso[i].done) : 0),
+						 (unsigned long) iso[i].errors,
+						 (unsigned long) (iso[i].jitter / (SystemCoreClock / 1000000)));
+			}
+#endif
+		}
 		__WFI();
 	}
 }
@@ -0,0 +1,263 @@
+/*
+ * @brief Host side tool for the isochronous mode of the bandwidth test
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * @par
+ * Build with libusb-1.0 (http://libusb.info), for example:
+ *   gcc -O2 -o bwtest_iso_host bwtest_iso_host.c -lusb-1.0
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <libusb-1.0/libusb.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Must match app_usbd_cfg.h and bwtest_main.c of the firmware */
+#define BWTEST_VID              0x1FC9
+#define BWTEST_PID              0x0084	/* WCID_VENDOR_CODE */
+#define BWTEST_IF               0
+#define BWTEST_ISO_OUT_EP       0x02
+#define BWTEST_ISO_IN_EP        0x82
+
+#define MAX_XFERS               32
+#define MAX_PACKETS             256
+
+/* Per direction streaming state */
+typedef struct {
+	unsigned char ep;
+	int maxp;					/* bytes per (micro)frame */
+	int active;					/* transfers still submitted */
+	uint64_t bytes;
+	uint32_t packets;
+	uint32_t errors;			/* packets with a status other than completed */
+	uint32_t shorts;			/* IN packets shorter than maxp */
+	double cb_last;				/* time of the previous completion, us */
+	double cb_max;				/* longest gap between completions, us */
+} ISO_DIR_T;
+
+static libusb_device_handle *g_dev;
+static ISO_DIR_T g_dir[2];
+static volatile int g_run;
+static int g_packets = 64;		/* iso packets per transfer, set with -p */
+static int g_xfers = 8;			/* transfers in flight per direction, set with -n */
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Account a finished transfer and resubmit it while the test runs */
+static void LIBUSB_CALL iso_cb(struct libusb_transfer *xfer)
+{
+	ISO_DIR_T *pDir = (ISO_DIR_T *) xfer->user_data;
+	double t = now_us();
+	int i;
+
+	for (i = 0; i < xfer->num_iso_packets; i++) {
+		struct libusb_iso_packet_descriptor *pkt = &xfer->iso_packet_desc[i];
+
+		pDir->packets++;
+		if (pkt->status != LIBUSB_TRANSFER_COMPLETED) {
+			pDir->errors++;
+			continue;
+		}
+		pDir->bytes += pkt->actual_length;
+		if ((pDir->ep & 0x80) && ((int) pkt->actual_length < pDir->maxp)) {
+			pDir->shorts++;
+		}
+	}
+	if ((pDir->cb_last != 0) && ((t - pDir->cb_last) > pDir->cb_max)) {
+		pDir->cb_max = t - pDir->cb_last;
+	}
+	pDir->cb_last = t;
+
+	if (g_run && (xfer->status == LIBUSB_TRANSFER_COMPLETED) && (libusb_submit_transfer(xfer) == 0)) {
+		return;
+	}
+	pDir->active--;
+}
+
+/* Allocate and submit the transfers of one direction */
+static int iso_start(ISO_DIR_T *pDir, unsigned char ep)
+{
+	struct libusb_transfer *xfer;
+	unsigned char *buf;
+	int i;
+
+	memset(pDir, 0, sizeof(*pDir));
+	pDir->ep = ep;
+	pDir->maxp = libusb_get_max_iso_packet_size(libusb_get_device(g_dev), ep);
+	if (pDir->maxp <= 0) {
+		fprintf(stderr, "endpoint %02x is not isochronous, firmware built without BWTEST_ISO?\n", ep);
+		return -1;
+	}
+	for (i = 0; i < g_xfers; i++) {
+		xfer = libusb_alloc_transfer(g_packets);
+		buf = malloc(pDir->maxp * g_packets);
+		if ((xfer == NULL) || (buf == NULL)) {
+			return -1;
+		}
+		memset(buf, 0x55, pDir->maxp * g_packets);
+		libusb_fill_iso_transfer(xfer, g_dev, ep, buf, pDir->maxp * g_packets, g_packets,
+								 iso_cb, pDir, 1000);
+		libusb_set_iso_packet_lengths(xfer, pDir->maxp);
+		xfer->flags = LIBUSB_TRANSFER_FREE_BUFFER | LIBUSB_TRANSFER_FREE_TRANSFER;
+		if (libusb_submit_transfer(xfer) < 0) {
+			libusb_free_transfer(xfer);
+			return -1;
+		}
+		pDir->active++;
+	}
+	return 0;
+}
+
+static void iso_report(const char *name, ISO_DIR_T *pDir, double secs)
+{
+	if (pDir->ep == 0) {
+		return;
+	}
+	printf("%-3s %8.1f KB/s, %u packets of %d bytes, %u errors", name,
+		   pDir->bytes / 1024.0 / secs, pDir->packets, pDir->maxp, pDir->errors);
+	if (pDir->ep & 0x80) {
+		printf(", %u short", pDir->shorts);
+	}
+	printf(", max completion gap %.0f us\n", pDir->cb_max);
+}
+
+/* Stream on the selected isochronous endpoints for secs seconds */
+static void run_iso(int in, int out, double secs)
+{
+	struct timeval tv = {0, 100000};
+	double t0, t, tr;
+
+	g_run = 1;
+	if ((in && (iso_start(&g_dir[0], BWTEST_ISO_IN_EP) < 0)) ||
+		(out && (iso_start(&g_dir[1], BWTEST_ISO_OUT_EP) < 0))) {
+		fprintf(stderr, "starting isochronous transfers failed\n");
+		g_run = 0;
+	}
+	t0 = tr = now_us();
+	while (g_run) {
+		libusb_handle_events_timeout(NULL, &tv);
+		t = now_us();
+		if ((t - t0) >= secs * 1e6) {
+			g_run = 0;
+		}
+		else if ((t - tr) >= 1e6) {
+			/* one line per second, the device prints its view on the UART */
+			iso_report("IN", &g_dir[0], (t - t0) / 1e6);
+			iso_report("OUT", &g_dir[1], (t - t0) / 1e6);
+			tr = t;
+		}
+	}
+	/* let the submitted transfers drain */
+	while ((g_dir[0].active > 0) || (g_dir[1].active > 0)) {
+		libusb_handle_events_timeout(NULL, &tv);
+	}
+	t = now_us();
+	printf("-- total\n");
+	iso_report("IN", &g_dir[0], (t - t0) / 1e6);
+	iso_report("OUT", &g_dir[1], (t - t0) / 1e6);
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s in|out|both [-t secs] [-p packets] [-n transfers]\n", prog);
+	fprintf(stderr, "  -t  duration in seconds, default 5\n");
+	fprintf(stderr, "  -p  isochronous packets per transfer, default 64\n");
+	fprintf(stderr, "  -n  transfers kept in flight per endpoint, default 8\n");
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	int in, out, i, ret;
+	double secs = 5;
+
+	if (argc < 2) {
+		usage(argv[0]);
+		return 1;
+	}
+	for (i = 2; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "-t") == 0) {
+			secs = atof(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-p") == 0) {
+			g_packets = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-n") == 0) {
+			g_xfers = atoi(argv[i + 1]);
+		}
+	}
+	in = (strcmp(argv[1], "in") == 0) || (strcmp(argv[1], "both") == 0);
+	out = (strcmp(argv[1], "out") == 0) || (strcmp(argv[1], "both") == 0);
+	if ((!in && !out) || (g_packets <= 0) || (g_packets > MAX_PACKETS) ||
+		(g_xfers <= 0) || (g_xfers > MAX_XFERS)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (libusb_init(NULL) < 0) {
+		return 1;
+	}
+	g_dev = libusb_open_device_with_vid_pid(NULL, BWTEST_VID, BWTEST_PID);
+	if (g_dev == NULL) {
+		fprintf(stderr, "LPC bandwidth test device %04x:%04x not found\n", BWTEST_VID, BWTEST_PID);
+		libusb_exit(NULL);
+		return 1;
+	}
+	ret = libusb_claim_interface(g_dev, BWTEST_IF);
+	if (ret < 0) {
+		fprintf(stderr, "claiming interface failed: %s\n", libusb_error_name(ret));
+	}
+	else {
+		run_iso(in, out, secs);
+		libusb_release_interface(g_dev, BWTEST_IF);
+	}
+
+	libusb_close(g_dev);
+	libusb_exit(NULL);
+	return ret < 0 ? 1 : 0;
+}
@@ -48,6 +48,13 @@ extern "C"
 #define USE_USB0
 /* #define USE_USB1 */
 
+/* Uncomment below to move the bridged data with GPDMA instead of the UART
+   interrupt: UART Rx streams into two ping-pong buffers and the receive
+   character timeout flushes a partly filled one to USB, UART Tx is sent
+   straight out of the CDC OUT buffers. Keeps the CPU load per byte low at
+   baud rates up to 3 Mbaud. */
+/* #define UCOM_GPDMA */
+
 /* Manifest constants used by USBD ROM stack. These values SHOULD NOT BE CHANGED
    for advance features which require usage of USB_CORE_CTRL_T structure.
    Since these are the values used for compiling USB stack.
@@ -84,12 +91,24 @@ extern "C"
 #define USB_CDC_OUT_EP          0x01
 #define USB_CDC_INT_EP          0x82
 
+/* GPDMA mode buffer sizes, two of each are taken from USB RAM. A buffer is
+   one GPDMA transfer, at most 4095 bytes. */
+#define UCOM_DMA_TXBUF_SZ       USB_HS_MAX_BULK_PACKET	/* CDC OUT buffer, one HS packet */
+#define UCOM_DMA_RXBUF_SZ       1024	/* UART Rx buffer */
+#if UCOM_DMA_TXBUF_SZ > 4095 || UCOM_DMA_RXBUF_SZ > 4095
+#error "CDC_UART: GPDMA buffers are limited to 4095 bytes"
+#endif
+
 /* On LPC18xx/43xx the USB controller requires endpoint queue heads to start on
    a 4KB aligned memory. Hence the mem_base value passed to USB stack init should
    be 4KB aligned. The following manifest constants are used to define this memory.
  */
 #define USB_STACK_MEM_BASE      0x20000000
+#ifdef UCOM_GPDMA
+#define USB_STACK_MEM_SIZE      0x00003000	/* room for the ping-pong buffers */
+#else
 #define USB_STACK_MEM_SIZE      0x00002000
+#endif
 
 /* USB descriptor arrays defined *_desc.c file */
 extern const uint8_t USB_DeviceDescriptor[];
@@ -98,15 +117,6 @@ extern uint8_t USB_FsConfigDescriptor[];
 extern const uint8_t USB_StringDescriptor[];
 extern const uint8_t USB_DeviceQualifier[];
 
-/**
- * @brief	Find the address of interface descriptor for given class type.
- * @param	pDesc		: Pointer to configuration descriptor in which the desired class
- *			interface descriptor to be found.
- * @param	intfClass	: Interface class type to be searched.
- * @return	If found returns the address of requested interface else returns NULL.
- */
-extern USB_INTERFACE_DESCRIPTOR *find_IntfDesc(const uint8_t *pDesc, uint32_t intfClass);
-
 /**
  * @}
  */
@@ -33,6 +33,8 @@
 #include <stdio.h>
 #include <string.h>
 #include "app_usbd_cfg.h"
+#include "usbd_ep0patch.h"
+#include "usbd_descidx.h"
 #include "cdc_uart.h"
 
 /*****************************************************************************
@@ -41,8 +43,10 @@
 static USBD_HANDLE_T g_hUsb;
 
 /* Endpoint 0 patch that prevents nested NAK event processing */
-static uint32_t g_ep0RxBusy = 0;/* flag indicating whether EP0 OUT/RX buffer is busy. */
-static USB_EP_HANDLER_T g_Ep0BaseHdlr;	/* variable to store the pointer to base EP0 handler */
+static USBEP0PATCH_T g_ep0Patch;
+
+/* Configuration descriptor index, built once after stack init */
+static USBDESCIDX_T g_descIdx;
 
 /*****************************************************************************
  * Public types/enumerations/variables
@@ -53,30 +57,6 @@ const USBD_API_T *g_pUsbApi;
  * Private functions
  ****************************************************************************/
 
-/* EP0_patch part of WORKAROUND for artf45032. */
-ErrorCode_t EP0_patch(USBD_HANDLE_T hUsb, void *data, uint32_t event)
-{
-	switch (event) {
-	case USB_EVT_OUT_NAK:
-		if (g_ep0RxBusy) {
-			/* we already queued the buffer so ignore this NAK event. */
-			return LPC_OK;
-		}
-		else {
-			/* Mark EP0_RX buffer as busy and allow base handler to queue the buffer. */
-			g_ep0RxBusy = 1;
-		}
-		break;
-
-	case USB_EVT_SETUP:	/* reset the flag when new setup sequence starts */
-	case USB_EVT_OUT:
-		/* we received the packet so clear the flag. */
-		g_ep0RxBusy = 0;
-		break;
-	}
-	return g_Ep0BaseHdlr(hUsb, data, event);
-}
-
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -85,39 +65,11 @@ ErrorCode_t EP0_patch(USBD_HANDLE_T hUsb, void *data, uint32_t event)
  * @brief	Handle interrupt from USB
  * @return	Nothing
  */
-void USB_IRQHandler(void)
+HOTFUNC void USB_IRQHandler(void)
 {
 	USBD_API->hw->ISR(g_hUsb);
 }
 
-/* Find the address of interface descriptor for given class type. */
-USB_INTERFACE_DESCRIPTOR *find_IntfDesc(const uint8_t *pDesc, uint32_t intfClass)
-{
-	USB_COMMON_DESCRIPTOR *pD;
-	USB_INTERFACE_DESCRIPTOR *pIntfDesc = 0;
-	uint32_t next_desc_adr;
-
-	pD = (USB_COMMON_DESCRIPTOR *) pDesc;
-	next_desc_adr = (uint32_t) pDesc;
-
-	while (pD->bLength) {
-		/* is it interface descriptor */
-		if (pD->bDescriptorType == USB_INTERFACE_DESCRIPTOR_TYPE) {
-
-			pIntfDesc = (USB_INTERFACE_DESCRIPTOR *) pD;
-			/* did we find the right interface descriptor */
-			if (pIntfDesc->bInterfaceClass == intfClass) {
-				break;
-			}
-		}
-		pIntfDesc = 0;
-		next_desc_adr = (uint32_t) pD + pD->bLength;
-		pD = (USB_COMMON_DESCRIPTOR *) next_desc_adr;
-	}
-
-	return pIntfDesc;
-}
-
 /**
  * @brief	main routine for blinky example
  * @return	Function should not exit.
@@ -127,7 +79,6 @@ int main(void)
 	USBD_API_INIT_PARAM_T usb_param;
 	USB_CORE_DESCS_T desc;
 	ErrorCode_t ret = LPC_OK;
-	USB_CORE_CTRL_T *pCtrl;
 
 	/* Initialize board and chip */
 	SystemCoreClockUpdate();
@@ -167,16 +118,11 @@ int main(void)
 	ret = USBD_API->hw->Init(&g_hUsb, &desc, &usb_param);
 	if (ret == LPC_OK) {
 
-		/*	WORKAROUND for artf45032 ROM driver BUG:
-		    Due to a race condition there is the chance that a second NAK event will
-		    occur before the default endpoint0 handler has completed its preparation
-		    of the DMA engine for the first NAK event. This can cause certain fields
-		    in the DMA descriptors to be in an invalid state when the USB controller
-		    reads them, thereby causing a hang.
-		 */
-		pCtrl = (USB_CORE_CTRL_T *) g_hUsb;	/* convert the handle to control structure */
-		g_Ep0BaseHdlr = pCtrl->ep_event_hdlr[0];/* retrieve the default EP0_OUT handler */
-		pCtrl->ep_event_hdlr[0] = EP0_patch;/* set our patch routine as EP0_OUT handler */
+		/* WORKAROUND for artf45032 ROM driver BUG, see usbd_ep0patch.h */
+		UsbEp0Patch_Install(&g_ep0Patch, g_hUsb);
+
+		/* index the configuration descriptors once for the class init code */
+		UsbDescIdx_Build(&g_descIdx, g_hUsb, &desc);
 
 		/* Init UCOM - USB to UART bridge interface */
 		ret = UCOM_init(g_hUsb, &desc, &usb_param);
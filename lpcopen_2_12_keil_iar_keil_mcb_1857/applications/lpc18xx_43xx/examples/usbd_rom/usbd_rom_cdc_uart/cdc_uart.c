@@ -31,7 +31,9 @@
 #include <string.h>
 #include "board.h"
 #include "app_usbd_cfg.h"
+#include "usbd_descidx.h"
 #include "cdc_uart.h"
+#include "usb_mem.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -59,20 +61,29 @@
 #define LPC_UART LPC_USART0
 #define UARTx_IRQn  USART0_IRQn
 #define UARTx_IRQHandler UART0_IRQHandler
+#define UARTx_DMA_TX GPDMA_CONN_UART0_Tx
+#define UARTx_DMA_RX GPDMA_CONN_UART0_Rx
 #elif (UARTNum == 1)
 #define LPC_UART LPC_UART1
 #define UARTx_IRQn  UART1_IRQn
 #define UARTx_IRQHandler UART1_IRQHandler
+#define UARTx_DMA_TX GPDMA_CONN_UART1_Tx
+#define UARTx_DMA_RX GPDMA_CONN_UART1_Rx
 #elif (UARTNum == 2)
 #define LPC_UART LPC_USART2
 #define UARTx_IRQn  USART2_IRQn
 #define UARTx_IRQHandler UART2_IRQHandler
+#define UARTx_DMA_TX GPDMA_CONN_UART2_Tx
+#define UARTx_DMA_RX GPDMA_CONN_UART2_Rx
 #elif (UARTNum == 3)
 #define LPC_UART LPC_USART3
 #define UARTx_IRQn  USART3_IRQn
 #define UARTx_IRQHandler UART3_IRQHandler
+#define UARTx_DMA_TX GPDMA_CONN_UART3_Tx
+#define UARTx_DMA_RX GPDMA_CONN_UART3_Rx
 #endif
 
+#ifndef UCOM_GPDMA
 /* Ring buffer size */
 #define UCOM_TXBUF_SZ           USB_HS_MAX_BULK_PACKET	/* This should be as big as MAXP */
 #define UCOM_RXBUF_SZ           64			/* The size should always be 2^n type.*/
@@ -97,6 +108,44 @@ typedef struct UCOM_DATA {
 	volatile uint8_t uartTxBusy;/*!< UART is busy sending packet */
 } UCOM_DATA_T;
 
+#else
+/* Buffer sizes, two of each */
+#define UCOM_TXBUF_SZ           UCOM_DMA_TXBUF_SZ
+#define UCOM_RXBUF_SZ           UCOM_DMA_RXBUF_SZ
+
+/* Remaining transfer count of a GPDMA channel */
+#define UCOM_DMA_LEFT(ch)       (LPC_GPDMA->CH[(ch)].CONTROL & 0xFFF)
+
+/**
+ * Structure containing Virtual Comm port control data. UART Rx is streamed
+ * by GPDMA into rxBuf[rxFill] while USB sends out of rxBuf[rxUsb], UART Tx
+ * is fed by GPDMA out of the CDC OUT buffers txBuf[].
+ */
+typedef struct UCOM_DATA {
+	USBD_HANDLE_T hUsb;			/*!< Handle to USB stack */
+	USBD_HANDLE_T hCdc;			/*!< Handle to CDC class controller */
+
+	uint8_t *rxBuf[2];			/*!< UART Rx ping-pong buffers */
+	uint16_t rxSent[2];			/*!< Bytes of each Rx buffer queued on USB */
+	uint8_t rxFill;				/*!< Rx buffer GPDMA writes to */
+	uint8_t rxUsb;				/*!< Rx buffer USB reads from */
+	uint8_t rxStalled;			/*!< GPDMA stopped, both Rx buffers wait for USB */
+	uint8_t rxDmaCh;			/*!< GPDMA channel of UART Rx */
+
+	uint8_t *txBuf[2];			/*!< CDC OUT buffers */
+	uint16_t txLen[2];			/*!< Bytes received in each OUT buffer */
+	uint8_t txHead;				/*!< OUT buffers received from USB */
+	uint8_t txTail;				/*!< OUT buffers sent on the UART */
+	uint8_t txDmaCh;			/*!< GPDMA channel of UART Tx */
+	uint8_t usbRxArmed;			/*!< Read is queued on the OUT endpoint */
+
+	uint16_t usbTxLen;			/*!< Length of the IN transfer in flight */
+	volatile uint8_t usbTxBusy;	/*!< USB is busy sending previous packet */
+	uint8_t usbTxZlp;			/*!< Last IN transfer ended on a packet boundary */
+} UCOM_DATA_T;
+
+#endif
+
 /** Virtual Comm port control data instance. */
 static UCOM_DATA_T g_uCOM;
 
@@ -111,6 +160,7 @@ static USB_EP_HANDLER_T g_defaultCdcHdlr;
  * Private functions
  ****************************************************************************/
 
+#ifndef UCOM_GPDMA
 /* UART port init routine */
 static void UCOM_UartInit(void)
 {
@@ -187,6 +237,176 @@ static ErrorCode_t UCOM_bulk_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event
 	return LPC_OK;
 }
 
+#else
+/* Start GPDMA on an Rx buffer */
+static void UCOM_RxDmaStart(UCOM_DATA_T *pUcom, uint32_t idx)
+{
+	pUcom->rxFill = idx;
+	pUcom->rxSent[idx] = 0;
+	pUcom->rxStalled = 0;
+	Chip_GPDMA_Transfer(LPC_GPDMA, pUcom->rxDmaCh, UARTx_DMA_RX, (uint32_t) pUcom->rxBuf[idx],
+						GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA, UCOM_RXBUF_SZ);
+}
+
+/* UART port init routine */
+static void UCOM_UartInit(void)
+{
+	Board_UART_Init(LPC_UART);
+
+	Chip_UART_Init(LPC_UART);
+	Chip_UART_SetBaud(LPC_UART, 115200);
+	Chip_UART_ConfigData(LPC_UART, (UART_LCR_WLEN8 | UART_LCR_SBS_1BIT));
+	/* FIFO requests GPDMA at the trigger level and on a character timeout */
+	Chip_UART_SetupFIFOS(LPC_UART, (UART_FCR_FIFO_EN | UART_FCR_DMAMODE_SEL | UART_FCR_TRG_LEV2));
+	Chip_UART_TXEnable(LPC_UART);
+
+	Chip_GPDMA_Init(LPC_GPDMA);
+	g_uCOM.rxDmaCh = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, UARTx_DMA_RX);
+	g_uCOM.txDmaCh = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, UARTx_DMA_TX);
+
+	/* The receive interrupt only reports the character timeout and trigger
+	   level, the data itself is moved by GPDMA */
+	Chip_UART_IntEnable(LPC_UART, UART_IER_RBRINT);
+
+	/* Priority = 1, same as USB so the handlers do not preempt each other */
+	NVIC_SetPriority(UARTx_IRQn, 1);
+	NVIC_EnableIRQ(UARTx_IRQn);
+	NVIC_SetPriority(DMA_IRQn, 1);
+	NVIC_EnableIRQ(DMA_IRQn);
+
+	/* start streaming UART Rx */
+	g_uCOM.rxUsb = 0;
+	UCOM_RxDmaStart(&g_uCOM, 0);
+}
+
+/* Queue the Rx bytes GPDMA has landed on the IN endpoint, if it is idle */
+static void UCOM_RxToUsb(UCOM_DATA_T *pUcom)
+{
+	uint32_t idx = pUcom->rxUsb, count;
+
+	if (pUcom->usbTxBusy || !USB_IsConfigured(pUcom->hUsb)) {
+		return;
+	}
+	if ((pUcom->rxSent[idx] == UCOM_RXBUF_SZ) && (idx != pUcom->rxFill)) {
+		/* buffer sent out completely, GPDMA may have it again */
+		idx ^= 1;
+		pUcom->rxUsb = idx;
+		if (pUcom->rxStalled) {
+			UCOM_RxDmaStart(pUcom, idx ^ 1);
+		}
+	}
+	/* the buffer behind the one GPDMA is filling is always full */
+	if ((idx == pUcom->rxFill) && !pUcom->rxStalled) {
+		count = UCOM_RXBUF_SZ - UCOM_DMA_LEFT(pUcom->rxDmaCh);
+	}
+	else {
+		count = UCOM_RXBUF_SZ;
+	}
+	count -= pUcom->rxSent[idx];
+
+	if (count || pUcom->usbTxZlp) {
+		pUcom->usbTxBusy = 1;
+		pUcom->usbTxZlp = 0;
+		pUcom->usbTxLen = USBD_API->hw->WriteEP(pUcom->hUsb, USB_CDC_IN_EP,
+												&pUcom->rxBuf[idx][pUcom->rxSent[idx]], count);
+		pUcom->rxSent[idx] += pUcom->usbTxLen;
+	}
+}
+
+/* Rx buffer full, GPDMA moves on to the other one unless USB still sends it */
+static void UCOM_RxDmaDone(UCOM_DATA_T *pUcom)
+{
+	if (!USB_IsConfigured(pUcom->hUsb)) {
+		/* nobody to send to, the data is dropped */
+		pUcom->rxUsb = pUcom->rxFill;
+		UCOM_RxDmaStart(pUcom, pUcom->rxFill);
+	}
+	else if (pUcom->rxUsb == pUcom->rxFill) {
+		UCOM_RxDmaStart(pUcom, pUcom->rxFill ^ 1);
+	}
+	else {
+		/* the UART FIFO holds the next bytes until USB frees a buffer */
+		pUcom->rxStalled = 1;
+	}
+	UCOM_RxToUsb(pUcom);
+}
+
+/* Queue a read on the OUT endpoint while an OUT buffer is free */
+static void UCOM_TxArm(UCOM_DATA_T *pUcom)
+{
+	if (!pUcom->usbRxArmed && ((uint8_t) (pUcom->txHead - pUcom->txTail) < 2)) {
+		pUcom->usbRxArmed = 1;
+		USBD_API->hw->ReadReqEP(pUcom->hUsb, USB_CDC_OUT_EP, pUcom->txBuf[pUcom->txHead & 1], UCOM_TXBUF_SZ);
+	}
+}
+
+/* Send the oldest received OUT buffer on the UART */
+static void UCOM_TxDmaStart(UCOM_DATA_T *pUcom)
+{
+	uint32_t idx = pUcom->txTail & 1;
+
+	Chip_GPDMA_Transfer(LPC_GPDMA, pUcom->txDmaCh, (uint32_t) pUcom->txBuf[idx], UARTx_DMA_TX,
+						GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, pUcom->txLen[idx]);
+}
+
+/* OUT buffer is in the UART FIFO, hand it back to USB */
+static void UCOM_TxDmaDone(UCOM_DATA_T *pUcom)
+{
+	pUcom->txTail++;
+	if (pUcom->txHead != pUcom->txTail) {
+		UCOM_TxDmaStart(pUcom);
+	}
+	UCOM_TxArm(pUcom);
+}
+
+/* UCOM bulk EP_IN and EP_OUT endpoints handler */
+static ErrorCode_t UCOM_bulk_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
+{
+	UCOM_DATA_T *pUcom = (UCOM_DATA_T *) data;
+	uint32_t idx, maxp;
+
+	switch (event) {
+	/* A transfer from us to the USB host that we queued has completed. */
+	case USB_EVT_IN:
+		pUcom->usbTxBusy = 0;
+		/* a transfer ending on a packet boundary needs a ZLP to end the host read */
+		maxp = UsbDescIdx_GetMaxPacket(hUsb, USB_CDC_IN_EP);
+		pUcom->usbTxZlp = (pUcom->usbTxLen != 0) && (maxp != 0) && ((pUcom->usbTxLen % maxp) == 0);
+		UCOM_RxToUsb(pUcom);
+		if (!pUcom->usbTxBusy) {
+			/* idle again, let the UART report the next bytes */
+			Chip_UART_IntEnable(LPC_UART, UART_IER_RBRINT);
+		}
+		break;
+
+	case USB_EVT_OUT_NAK:
+		UCOM_TxArm(pUcom);
+		break;
+
+	/* We received a transfer from the USB host . */
+	case USB_EVT_OUT:
+		idx = pUcom->txHead & 1;
+		pUcom->usbRxArmed = 0;
+		pUcom->txLen[idx] = USBD_API->hw->ReadEP(hUsb, USB_CDC_OUT_EP, pUcom->txBuf[idx]);
+		if (pUcom->txLen[idx] != 0) {
+			pUcom->txHead++;
+			if ((uint8_t) (pUcom->txHead - pUcom->txTail) == 1) {
+				/* UART Tx was idle, kick start it */
+				UCOM_TxDmaStart(pUcom);
+			}
+		}
+		UCOM_TxArm(pUcom);
+		break;
+
+	default:
+		break;
+	}
+
+	return LPC_OK;
+}
+
+#endif
+
 /* Set line coding call back routine */
 static ErrorCode_t UCOM_SetLineCode(USBD_HANDLE_T hCDC, CDC_LINE_CODING *line_coding)
 {
@@ -328,6 +548,7 @@ static ErrorCode_t CDC_ep0_override_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_
  * Public functions
  ****************************************************************************/
 
+#ifndef UCOM_GPDMA
 /**
  * @brief	UART interrupt handler sub-routine
  * @return	Nothing
@@ -368,6 +589,47 @@ void UARTx_IRQHandler(void)
 
 }
 
+#else
+/**
+ * @brief	UART interrupt handler sub-routine
+ * @return	Nothing
+ */
+void UARTx_IRQHandler(void)
+{
+	if ((Chip_UART_ReadIntIDReg(LPC_UART) & UART_IIR_INTID_MASK) == UART_IIR_INTID_CTI) {
+		/* GPDMA drains the FIFO on the timeout, let it finish before
+		   flushing the partly filled buffer */
+		while ((Chip_UART_ReadLineStatus(LPC_UART) & UART_LSR_RDR) &&
+			   Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_ENABLED_CH, g_uCOM.rxDmaCh)) {}
+	}
+	UCOM_RxToUsb(&g_uCOM);
+
+	/* With an IN transfer in flight its completion picks up the next bytes,
+	   so the trigger level interrupt stays masked until then */
+	if (g_uCOM.usbTxBusy) {
+		Chip_UART_IntDisable(LPC_UART, UART_IER_RBRINT);
+	}
+}
+
+/**
+ * @brief	GPDMA interrupt handler sub-routine
+ * @return	Nothing
+ */
+void DMA_IRQHandler(void)
+{
+	/* an error ends the transfer just as well, both restart the channel */
+	if (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_INT, g_uCOM.rxDmaCh)) {
+		Chip_GPDMA_Interrupt(LPC_GPDMA, g_uCOM.rxDmaCh);
+		UCOM_RxDmaDone(&g_uCOM);
+	}
+	if (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_INT, g_uCOM.txDmaCh)) {
+		Chip_GPDMA_Interrupt(LPC_GPDMA, g_uCOM.txDmaCh);
+		UCOM_TxDmaDone(&g_uCOM);
+	}
+}
+
+#endif
+
 /* UART to USB com port init routine */
 ErrorCode_t UCOM_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT_PARAM_T *pUsbParam)
 {
@@ -376,6 +638,10 @@ ErrorCode_t UCOM_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 	uint32_t ep_indx;
 	USB_CDC_CTRL_T *pCDC;
 	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;
+	USBMEM_T mem;
+#ifdef UCOM_GPDMA
+	uint32_t i;
+#endif
 
 	/* Store USB stack handle for future use. */
 	g_uCOM.hUsb = hUsb;
@@ -383,8 +649,8 @@ ErrorCode_t UCOM_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 	memset((void *) &cdc_param, 0, sizeof(USBD_CDC_INIT_PARAM_T));
 	cdc_param.mem_base = pUsbParam->mem_base;
 	cdc_param.mem_size = pUsbParam->mem_size;
-	cdc_param.cif_intf_desc = (uint8_t *) find_IntfDesc(pDesc->high_speed_desc, CDC_COMMUNICATION_INTERFACE_CLASS);
-	cdc_param.dif_intf_desc = (uint8_t *) find_IntfDesc(pDesc->high_speed_desc, CDC_DATA_INTERFACE_CLASS);
+	cdc_param.cif_intf_desc = (uint8_t *) UsbDescIdx_FindIntf(hUsb, USB_HIGH_SPEED, CDC_COMMUNICATION_INTERFACE_CLASS);
+	cdc_param.dif_intf_desc = (uint8_t *) UsbDescIdx_FindIntf(hUsb, USB_HIGH_SPEED, CDC_DATA_INTERFACE_CLASS);
 	cdc_param.SetLineCode = UCOM_SetLineCode;
 
 	/* Init CDC interface */
@@ -392,12 +658,24 @@ ErrorCode_t UCOM_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 
 	if (ret == LPC_OK) {
 		/* allocate transfer buffers */
-		g_uCOM.txBuf = (uint8_t *) cdc_param.mem_base;
-		cdc_param.mem_base += UCOM_TXBUF_SZ;
-		cdc_param.mem_size -= UCOM_TXBUF_SZ;
-		g_uCOM.rxBuf = (uint8_t *) cdc_param.mem_base;
-		cdc_param.mem_base += UCOM_RXBUF_SZ;
-		cdc_param.mem_size -= UCOM_RXBUF_SZ;
+		UsbMem_Init(&mem, cdc_param.mem_base, cdc_param.mem_size);
+#ifndef UCOM_GPDMA
+		g_uCOM.txBuf = UsbMem_Alloc(&mem, UCOM_TXBUF_SZ, 4);
+		g_uCOM.rxBuf = UsbMem_Alloc(&mem, UCOM_RXBUF_SZ, 4);
+		if ((g_uCOM.txBuf == NULL) || (g_uCOM.rxBuf == NULL)) {
+			return ERR_FAILED;
+		}
+#else
+		for (i = 0; i < 2; i++) {
+			g_uCOM.txBuf[i] = UsbMem_Alloc(&mem, UCOM_TXBUF_SZ, 4);
+			g_uCOM.rxBuf[i] = UsbMem_Alloc(&mem, UCOM_RXBUF_SZ, 4);
+			if ((g_uCOM.txBuf[i] == NULL) || (g_uCOM.rxBuf[i] == NULL)) {
+				return ERR_FAILED;
+			}
+		}
+#endif
+		cdc_param.mem_base = mem.mem_base;
+		cdc_param.mem_size = mem.mem_size;
 
 		/* register endpoint interrupt handler */
 		ep_indx = (((USB_CDC_IN_EP & 0x0F) << 1) + 1);
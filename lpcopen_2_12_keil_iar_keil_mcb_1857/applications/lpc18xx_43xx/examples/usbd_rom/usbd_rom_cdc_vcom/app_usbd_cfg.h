@@ -89,7 +89,7 @@ extern "C"
    be 4KB aligned. The following manifest constants are used to define this memory.
  */
 #define USB_STACK_MEM_BASE      0x20000000
-#define USB_STACK_MEM_SIZE      0x00002000
+#define USB_STACK_MEM_SIZE      0x00007000	/* room for the VCOM ring and OUT buffers */
 
 /* USB descriptor arrays defined *_desc.c file */
 extern const uint8_t USB_DeviceDescriptor[];
@@ -98,15 +98,6 @@ extern uint8_t USB_FsConfigDescriptor[];
 extern const uint8_t USB_StringDescriptor[];
 extern const uint8_t USB_DeviceQualifier[];
 
-/**
- * @brief	Find the address of interface descriptor for given class type.
- * @param	pDesc		: Pointer to configuration descriptor in which the desired class
- *			interface descriptor to be found.
- * @param	intfClass	: Interface class type to be searched.
- * @return	If found returns the address of requested interface else returns NULL.
- */
-extern USB_INTERFACE_DESCRIPTOR *find_IntfDesc(const uint8_t *pDesc, uint32_t intfClass);
-
 /**
  * @}
  */
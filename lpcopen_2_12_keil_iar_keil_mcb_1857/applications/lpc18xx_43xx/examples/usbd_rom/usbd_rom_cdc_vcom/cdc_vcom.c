@@ -30,8 +30,10 @@
  */
 #include <string.h>
 #include "app_usbd_cfg.h"
+#include "usbd_descidx.h"
 #include "board.h"
 #include "cdc_vcom.h"
+#include "usb_mem.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -53,13 +55,55 @@ VCOM_DATA_T g_vCOM;
  * Private functions
  ****************************************************************************/
 
+/* Give the next contiguous part of the IN ring to the controller. Called from
+   the USB IRQ or with it disabled. */
+static void VCOM_TxNext(VCOM_DATA_T *pVcom)
+{
+	uint32_t ofs, len = pVcom->tx_head - pVcom->tx_tail;
+
+	if (len == 0) {
+		pVcom->tx_flags &= ~VCOM_TX_BUSY;
+		return;
+	}
+	ofs = pVcom->tx_tail & (VCOM_TX_BUF_SZ - 1);
+	len = MIN(len, VCOM_TX_BUF_SZ - ofs);
+	len = MIN(len, VCOM_TX_XFER_SZ);
+
+	pVcom->tx_flags |= VCOM_TX_BUSY;
+	pVcom->tx_xfer = len;
+	USBD_API->hw->WriteEP(pVcom->hUsb, USB_CDC_IN_EP, &pVcom->tx_buff[ofs], len);
+}
+
+/* Queue a free OUT buffer, USB then fills one while the application reads the other */
+static void VCOM_RxArm(VCOM_DATA_T *pVcom)
+{
+	if (((pVcom->rx_flags & (VCOM_RX_BUF_QUEUED | VCOM_RX_DB_QUEUED)) == 0) &&
+		((uint8_t) (pVcom->rx_head - pVcom->rx_tail) < VCOM_RX_BUF_NUM)) {
+		USBD_API->hw->ReadReqEP(pVcom->hUsb, USB_CDC_OUT_EP,
+								pVcom->rx_buff[pVcom->rx_head % VCOM_RX_BUF_NUM], VCOM_RX_BUF_SZ);
+		pVcom->rx_flags |= VCOM_RX_BUF_QUEUED;
+	}
+}
+
 /* VCOM bulk EP_IN endpoint handler */
 static ErrorCode_t VCOM_bulk_in_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 {
 	VCOM_DATA_T *pVcom = (VCOM_DATA_T *) data;
+	uint32_t maxp;
 
 	if (event == USB_EVT_IN) {
-		pVcom->tx_flags &= ~VCOM_TX_BUSY;
+		pVcom->tx_tail += pVcom->tx_xfer;
+		maxp = UsbDescIdx_GetMaxPacket(hUsb, USB_CDC_IN_EP);
+		if ((pVcom->tx_head == pVcom->tx_tail) && (pVcom->tx_xfer != 0) && (maxp != 0) &&
+			((pVcom->tx_xfer % maxp) == 0)) {
+			/* burst ended on a packet boundary, a ZLP completes the host read */
+			pVcom->tx_xfer = 0;
+			USBD_API->hw->WriteEP(hUsb, USB_CDC_IN_EP, pVcom->tx_buff, 0);
+		}
+		else {
+			/* back-to-back with whatever was written meanwhile */
+			VCOM_TxNext(pVcom);
+		}
 	}
 	return LPC_OK;
 }
@@ -69,17 +113,22 @@ static ErrorCode_t VCOM_bulk_out_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t e
 {
 	VCOM_DATA_T *pVcom = (VCOM_DATA_T *) data;
 
+	uint32_t idx;
+
 	switch (event) {
 	case USB_EVT_OUT:
-		pVcom->rx_count = USBD_API->hw->ReadEP(hUsb, USB_CDC_OUT_EP, pVcom->rx_buff);
 		if (pVcom->rx_flags & VCOM_RX_BUF_QUEUED) {
+			idx = pVcom->rx_head % VCOM_RX_BUF_NUM;
+			pVcom->rx_count[idx] = USBD_API->hw->ReadEP(hUsb, USB_CDC_OUT_EP, pVcom->rx_buff[idx]);
 			pVcom->rx_flags &= ~VCOM_RX_BUF_QUEUED;
-			if (pVcom->rx_count != 0) {
-				pVcom->rx_flags |= VCOM_RX_BUF_FULL;
+			if (pVcom->rx_count[idx] != 0) {
+				pVcom->rx_head++;
 			}
-
+			/* queue the other buffer right away */
+			VCOM_RxArm(pVcom);
 		}
 		else if (pVcom->rx_flags & VCOM_RX_DB_QUEUED) {
+			pVcom->rx_req_count = USBD_API->hw->ReadEP(hUsb, USB_CDC_OUT_EP, NULL);
 			pVcom->rx_flags &= ~VCOM_RX_DB_QUEUED;
 			pVcom->rx_flags |= VCOM_RX_DONE;
 		}
@@ -87,10 +136,7 @@ static ErrorCode_t VCOM_bulk_out_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t e
 
 	case USB_EVT_OUT_NAK:
 		/* queue free buffer for RX */
-		if ((pVcom->rx_flags & (VCOM_RX_BUF_FULL | VCOM_RX_BUF_QUEUED)) == 0) {
-			USBD_API->hw->ReadReqEP(hUsb, USB_CDC_OUT_EP, pVcom->rx_buff, VCOM_RX_BUF_SZ);
-			pVcom->rx_flags |= VCOM_RX_BUF_QUEUED;
-		}
+		VCOM_RxArm(pVcom);
 		break;
 
 	default:
@@ -107,6 +153,9 @@ static ErrorCode_t VCOM_SetLineCode(USBD_HANDLE_T hCDC, CDC_LINE_CODING *line_co
 
 	/* Called when baud rate is changed/set. Using it to know host connection state */
 	pVcom->tx_flags = VCOM_TX_CONNECTED;	/* reset other flags */
+	/* drop what was queued for a previous session */
+	pVcom->tx_tail = pVcom->tx_head;
+	pVcom->tx_xfer = 0;
 
 	return LPC_OK;
 }
@@ -170,13 +219,15 @@ ErrorCode_t vcom_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 	ErrorCode_t ret = LPC_OK;
 	uint32_t ep_indx;
 	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;
+	USBMEM_T mem;
+	uint32_t i;
 
 	g_vCOM.hUsb = hUsb;
 	memset((void *) &cdc_param, 0, sizeof(USBD_CDC_INIT_PARAM_T));
 	cdc_param.mem_base = pUsbParam->mem_base;
 	cdc_param.mem_size = pUsbParam->mem_size;
-	cdc_param.cif_intf_desc = (uint8_t *) find_IntfDesc(pDesc->high_speed_desc, CDC_COMMUNICATION_INTERFACE_CLASS);
-	cdc_param.dif_intf_desc = (uint8_t *) find_IntfDesc(pDesc->high_speed_desc, CDC_DATA_INTERFACE_CLASS);
+	cdc_param.cif_intf_desc = (uint8_t *) UsbDescIdx_FindIntf(hUsb, USB_HIGH_SPEED, CDC_COMMUNICATION_INTERFACE_CLASS);
+	cdc_param.dif_intf_desc = (uint8_t *) UsbDescIdx_FindIntf(hUsb, USB_HIGH_SPEED, CDC_DATA_INTERFACE_CLASS);
 	cdc_param.SetLineCode = VCOM_SetLineCode;
 
 	ret = USBD_API->cdc->init(hUsb, &cdc_param, &g_vCOM.hCdc);
@@ -196,12 +247,19 @@ ErrorCode_t vcom_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 	pCtrl->ep0_hdlr_cb[pCtrl->num_ep0_hdlrs - 1] = CDC_ep0_override_hdlr;
 
 	/* allocate transfer buffers */
-	if (cdc_param.mem_size < VCOM_RX_BUF_SZ) {
+	UsbMem_Init(&mem, cdc_param.mem_base, cdc_param.mem_size);
+	for (i = 0; i < VCOM_RX_BUF_NUM; i++) {
+		g_vCOM.rx_buff[i] = UsbMem_Alloc(&mem, VCOM_RX_BUF_SZ, 4);
+		if (g_vCOM.rx_buff[i] == NULL) {
+			return ERR_FAILED;
+		}
+	}
+	g_vCOM.tx_buff = UsbMem_Alloc(&mem, VCOM_TX_BUF_SZ, 4);
+	if (g_vCOM.tx_buff == NULL) {
 		return ERR_FAILED;
 	}
-	g_vCOM.rx_buff = (uint8_t *) cdc_param.mem_base;
-	cdc_param.mem_base += VCOM_RX_BUF_SZ;
-	cdc_param.mem_size -= VCOM_RX_BUF_SZ;
+	cdc_param.mem_base = mem.mem_base;
+	cdc_param.mem_size = mem.mem_size;
 
 	/* register endpoint interrupt handler */
 	ep_indx = (((USB_CDC_IN_EP & 0x0F) << 1) + 1);
@@ -228,21 +286,25 @@ ErrorCode_t vcom_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 uint32_t vcom_bread(uint8_t *pBuf, uint32_t buf_len)
 {
 	VCOM_DATA_T *pVcom = &g_vCOM;
-	uint16_t cnt = 0;
-	/* read from the default buffer if any data present */
-	if (pVcom->rx_count) {
-		cnt = (pVcom->rx_count < buf_len) ? pVcom->rx_count : buf_len;
-		memcpy(pBuf, pVcom->rx_buff, cnt);
+	uint32_t cnt = 0, idx;
+
+	/* read from the oldest filled buffer if any data present */
+	if (pVcom->rx_head != pVcom->rx_tail) {
+		idx = pVcom->rx_tail % VCOM_RX_BUF_NUM;
+		cnt = MIN(pVcom->rx_count[idx] - pVcom->rx_rd_count, buf_len);
+		memcpy(pBuf, &pVcom->rx_buff[idx][pVcom->rx_rd_count], cnt);
 		pVcom->rx_rd_count += cnt;
 
-		/* enter critical section */
-		NVIC_DisableIRQ(LPC_USB_IRQ);
-		if (pVcom->rx_rd_count >= pVcom->rx_count) {
-			pVcom->rx_flags &= ~VCOM_RX_BUF_FULL;
-			pVcom->rx_rd_count = pVcom->rx_count = 0;
+		if (pVcom->rx_rd_count >= pVcom->rx_count[idx]) {
+			/* enter critical section */
+			NVIC_DisableIRQ(LPC_USB_IRQ);
+			pVcom->rx_rd_count = 0;
+			pVcom->rx_tail++;
+			/* the buffer is free again, queue it if USB was waiting for one */
+			VCOM_RxArm(pVcom);
+			/* exit critical section */
+			NVIC_EnableIRQ(LPC_USB_IRQ);
 		}
-		/* exit critical section */
-		NVIC_EnableIRQ(LPC_USB_IRQ);
 	}
 	return cnt;
 }
@@ -274,8 +336,8 @@ uint32_t vcom_read_cnt(void)
 	uint32_t ret = 0;
 
 	if (pVcom->rx_flags & VCOM_RX_DONE) {
-		ret = pVcom->rx_count;
-		pVcom->rx_count = 0;
+		ret = pVcom->rx_req_count;
+		pVcom->rx_req_count = 0;
 	}
 
 	return ret;
@@ -285,14 +347,22 @@ uint32_t vcom_read_cnt(void)
 uint32_t vcom_write(uint8_t *pBuf, uint32_t len)
 {
 	VCOM_DATA_T *pVcom = &g_vCOM;
-	uint32_t ret = 0;
+	uint32_t ret = 0, ofs, cnt;
 
-	if ( (pVcom->tx_flags & VCOM_TX_CONNECTED) && ((pVcom->tx_flags & VCOM_TX_BUSY) == 0) ) {
-		pVcom->tx_flags |= VCOM_TX_BUSY;
+	if (pVcom->tx_flags & VCOM_TX_CONNECTED) {
+		/* tx_tail only moves forward in the IRQ, the free space can only grow */
+		ret = MIN(len, VCOM_TX_BUF_SZ - (pVcom->tx_head - pVcom->tx_tail));
+		ofs = pVcom->tx_head & (VCOM_TX_BUF_SZ - 1);
+		cnt = MIN(ret, VCOM_TX_BUF_SZ - ofs);
+		memcpy(&pVcom->tx_buff[ofs], pBuf, cnt);
+		memcpy(pVcom->tx_buff, pBuf + cnt, ret - cnt);
 
 		/* enter critical section */
 		NVIC_DisableIRQ(LPC_USB_IRQ);
-		ret = USBD_API->hw->WriteEP(pVcom->hUsb, USB_CDC_IN_EP, pBuf, len);
+		pVcom->tx_head += ret;
+		if ((pVcom->tx_flags & VCOM_TX_BUSY) == 0) {
+			VCOM_TxNext(pVcom);
+		}
 		/* exit critical section */
 		NVIC_EnableIRQ(LPC_USB_IRQ);
 	}
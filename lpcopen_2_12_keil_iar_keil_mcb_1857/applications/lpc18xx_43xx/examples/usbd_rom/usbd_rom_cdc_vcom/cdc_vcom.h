@@ -43,23 +43,37 @@ extern "C"
  * @{
  */
 
-#define VCOM_RX_BUF_SZ      512
+#define VCOM_RX_BUF_SZ      2048		/* OUT buffer, a multiple of the HS packet size */
+#define VCOM_RX_BUF_NUM     2			/* OUT buffers, USB fills one while the other is read */
+#define VCOM_TX_BUF_SZ      16384		/* IN ring buffer. Must be a power of 2. */
+#define VCOM_TX_XFER_SZ     4096		/* Max bytes given to the controller in one dTD */
 #define VCOM_TX_CONNECTED   _BIT(8)		/* connection state is for both RX/Tx */
 #define VCOM_TX_BUSY        _BIT(0)
 #define VCOM_RX_DONE        _BIT(0)
-#define VCOM_RX_BUF_FULL    _BIT(1)
 #define VCOM_RX_BUF_QUEUED  _BIT(2)
 #define VCOM_RX_DB_QUEUED   _BIT(3)
 
+#if (VCOM_TX_BUF_SZ & (VCOM_TX_BUF_SZ - 1)) != 0 || (VCOM_TX_XFER_SZ % USB_HS_MAX_BULK_PACKET) != 0 || \
+	VCOM_TX_XFER_SZ > VCOM_TX_BUF_SZ || VCOM_TX_XFER_SZ > 16384 || (VCOM_RX_BUF_SZ % USB_HS_MAX_BULK_PACKET) != 0
+#error "CDC_VCOM: buffer sizes must be whole HS packets and a transfer must fit one dTD"
+#endif
+
 /**
  * Structure containing Virtual Comm port control data
  */
 typedef struct VCOM_DATA {
 	USBD_HANDLE_T hUsb;
 	USBD_HANDLE_T hCdc;
-	uint8_t *rx_buff;
-	uint16_t rx_rd_count;
-	uint16_t rx_count;
+	uint8_t *rx_buff[VCOM_RX_BUF_NUM];
+	uint16_t rx_count[VCOM_RX_BUF_NUM];
+	uint16_t rx_rd_count;				/*!< Bytes already read from the oldest OUT buffer */
+	uint16_t rx_req_count;				/*!< Bytes received by vcom_read_req() */
+	uint8_t rx_head;					/*!< OUT buffers filled by USB */
+	uint8_t rx_tail;					/*!< OUT buffers drained by vcom_bread() */
+	uint8_t *tx_buff;					/*!< IN ring buffer */
+	volatile uint32_t tx_head;			/*!< Bytes put in the ring by vcom_write() */
+	uint32_t tx_tail;					/*!< Bytes sent to the host */
+	uint32_t tx_xfer;					/*!< Bytes of the IN transfer in flight, at tx_tail */
 	volatile uint16_t tx_flags;
 	volatile uint16_t rx_flags;
 } VCOM_DATA_T;
@@ -113,6 +127,11 @@ static INLINE uint32_t vcom_connected(void) {
  * @param	pBuf	: Pointer to buffer to be written
  * @param	buf_len	: Length of the buffer passed
  * @return	Number of bytes written
+ * @note	The data is copied into the IN ring buffer and goes out in
+ *			transfers of up to VCOM_TX_XFER_SZ bytes, each started from the
+ *			completion of the previous one. Fewer than @a buf_len bytes are
+ *			taken when the ring is full. A burst ending on a packet boundary
+ *			is closed with a zero length packet.
  */
 uint32_t vcom_write (uint8_t *pBuf, uint32_t buf_len);
 
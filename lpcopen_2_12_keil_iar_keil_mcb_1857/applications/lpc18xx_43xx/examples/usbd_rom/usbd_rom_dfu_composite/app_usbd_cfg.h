@@ -64,6 +64,11 @@ extern "C"
 #define DFU_XFER_BLOCK_SZ     (USB_DFU_XFER_SIZE)
 #define DFU_MAX_BLOCKS        (DFU_MAX_IMAGE_LEN / DFU_XFER_BLOCK_SZ)
 
+/* Define to also accept images compressed with dfu_lzpack (usbd_dfulz).
+   They are detected by their header and decoded into DFU_DEST_BASE while
+   they download; raw images still download in place. */
+/* #define DFU_LZ_IMAGE */
+
 /* Manifest constants to select appropriate USB instance */
 #ifdef USE_USB0
 #define LPC_USB_BASE            LPC_USB0_BASE
@@ -112,15 +117,6 @@ extern const uint8_t USB_DeviceQualifier[];
 extern const uint8_t DFU_DeviceDescriptor[];
 extern const uint8_t DFU_ConfigDescriptor[];
 
-/**
- * @brief	Find the address of interface descriptor for given class type.
- * @param	pDesc		: Pointer to configuration descriptor in which the desired class
- *			interface descriptor to be found.
- * @param	intfClass	: Interface class type to be searched.
- * @return	If found returns the address of requested interface else returns NULL.
- */
-extern USB_INTERFACE_DESCRIPTOR *find_IntfDesc(const uint8_t *pDesc, uint32_t intfClass);
-
 /**
  * @}
  */
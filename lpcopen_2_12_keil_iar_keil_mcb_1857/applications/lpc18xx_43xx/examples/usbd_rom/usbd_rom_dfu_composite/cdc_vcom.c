@@ -30,8 +30,10 @@
  */
 #include <string.h>
 #include "app_usbd_cfg.h"
+#include "usbd_descidx.h"
 #include "board.h"
 #include "cdc_vcom.h"
+#include "usb_mem.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -170,13 +172,14 @@ ErrorCode_t vcom_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 	ErrorCode_t ret = LPC_OK;
 	uint32_t ep_indx;
 	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;
+	USBMEM_T mem;
 
 	g_vCOM.hUsb = hUsb;
 	memset((void *) &cdc_param, 0, sizeof(USBD_CDC_INIT_PARAM_T));
 	cdc_param.mem_base = pUsbParam->mem_base;
 	cdc_param.mem_size = pUsbParam->mem_size;
-	cdc_param.cif_intf_desc = (uint8_t *) find_IntfDesc(pDesc->high_speed_desc, CDC_COMMUNICATION_INTERFACE_CLASS);
-	cdc_param.dif_intf_desc = (uint8_t *) find_IntfDesc(pDesc->high_speed_desc, CDC_DATA_INTERFACE_CLASS);
+	cdc_param.cif_intf_desc = (uint8_t *) UsbDescIdx_FindIntf(hUsb, USB_HIGH_SPEED, CDC_COMMUNICATION_INTERFACE_CLASS);
+	cdc_param.dif_intf_desc = (uint8_t *) UsbDescIdx_FindIntf(hUsb, USB_HIGH_SPEED, CDC_DATA_INTERFACE_CLASS);
 	cdc_param.SetLineCode = VCOM_SetLineCode;
 
 	ret = USBD_API->cdc->init(hUsb, &cdc_param, &g_vCOM.hCdc);
@@ -196,12 +199,13 @@ ErrorCode_t vcom_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT
 	pCtrl->ep0_hdlr_cb[pCtrl->num_ep0_hdlrs - 1] = CDC_ep0_override_hdlr;
 
 	/* allocate transfer buffers */
-	if (cdc_param.mem_size < VCOM_RX_BUF_SZ) {
+	UsbMem_Init(&mem, cdc_param.mem_base, cdc_param.mem_size);
+	g_vCOM.rx_buff = UsbMem_Alloc(&mem, VCOM_RX_BUF_SZ, 4);
+	if (g_vCOM.rx_buff == NULL) {
 		return ERR_FAILED;
 	}
-	g_vCOM.rx_buff = (uint8_t *) cdc_param.mem_base;
-	cdc_param.mem_base += VCOM_RX_BUF_SZ;
-	cdc_param.mem_size -= VCOM_RX_BUF_SZ;
+	cdc_param.mem_base = mem.mem_base;
+	cdc_param.mem_size = mem.mem_size;
 
 	/* register endpoint interrupt handler */
 	ep_indx = (((USB_CDC_IN_EP & 0x0F) << 1) + 1);
@@ -32,6 +32,7 @@
 #include <string.h>
 #include "board.h"
 #include "app_usbd_cfg.h"
+#include "usbd_descidx.h"
 #include "msc_disk.h"
 
 /*****************************************************************************
@@ -101,7 +102,7 @@ ErrorCode_t mscDisk_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_I
 	msc_param.MSC_Read = translate_rd;
 	msc_param.MSC_Verify = translate_verify;
 	msc_param.MSC_GetWriteBuf = translate_GetWrBuf;
-	msc_param.intf_desc = (uint8_t *) find_IntfDesc(pDesc->high_speed_desc, USB_DEVICE_CLASS_STORAGE);
+	msc_param.intf_desc = (uint8_t *) UsbDescIdx_FindIntf(hUsb, USB_HIGH_SPEED, USB_DEVICE_CLASS_STORAGE);
 
 	ret = USBD_API->msc->init(hUsb, &msc_param);
 	/* update memory variables */
@@ -33,6 +33,9 @@
 #include "app_usbd_cfg.h"
 #include "ms_timer.h"
 #include "dfu.h"
+#ifdef DFU_LZ_IMAGE
+#include "usbd_dfulz.h"
+#endif
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -44,11 +47,22 @@ typedef struct {
 	USBD_HANDLE_T hUsb;				/*!< Handle to USB stack. */
 	volatile uint32_t fDetach;		/*!< Flag indicating DFU_DETACH request is received. */
 	volatile uint32_t fDownloadDone;/*!< Flag indicating DFU_DOWNLOAD finished. */
+#ifdef DFU_LZ_IMAGE
+	uint32_t fLz;					/*!< Download is a compressed image. */
+#endif
 } DFU_Ctrl_T;
 
 /** Singleton instance of DFU control */
 static DFU_Ctrl_T g_dfu;
 
+#ifdef DFU_LZ_IMAGE
+/** Decoder of a compressed download */
+static DFULZ_T g_dfuLz;
+
+/** Transfer buffer for block 0 and for all blocks of a compressed image */
+static uint32_t g_dfuLzXfer[DFU_XFER_BLOCK_SZ / sizeof(uint32_t)];
+#endif
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -76,6 +90,12 @@ static void dfu_detach(USBD_HANDLE_T hUsb)
 /* Set a flag when a DFU firmware reload has finished. */
 static void dfu_done(void)
 {
+#ifdef DFU_LZ_IMAGE
+	/* Don't start a compressed image that is incomplete or fails its CRC */
+	if (g_dfu.fLz && (DfuLz_IsDone(&g_dfuLz) == false)) {
+		return;
+	}
+#endif
 	/* Signal DFU user task that DFU download has finished. */
 	g_dfu.fDownloadDone = 1;
 }
@@ -117,6 +137,50 @@ static uint32_t dfu_rd(uint32_t block_num, uint8_t * *pBuff, uint32_t length)
 	return length;
 }
 
+#ifdef DFU_LZ_IMAGE
+/* Pick the download mode of a DFU_LZ_IMAGE build. Block 0 is received into
+ * the transfer buffer to look for a container header. A raw image is copied
+ * to DFU_DEST_BASE and the rest of it received in place, a compressed one
+ * keeps using the transfer buffer. Returns true for a compressed image.
+ */
+static bool dfu_lz_select(uint32_t block_num, uint32_t length)
+{
+	if (block_num == 0) {
+		if (length == 0) {
+			/* Block 0 always goes to the transfer buffer */
+			g_dfu.fLz = 1;
+		}
+		else {
+			g_dfu.fLz = DfuLz_IsContainer(g_dfuLzXfer);
+			if (g_dfu.fLz) {
+				DfuLz_Init(&g_dfuLz, DFU_MAX_IMAGE_LEN);
+			}
+			else {
+				memcpy((void *) DFU_DEST_BASE, g_dfuLzXfer, length);
+			}
+		}
+	}
+
+	return (bool) (g_dfu.fLz != 0);
+}
+
+/* Decode a received block of a compressed image straight into DFU_DEST_BASE */
+static uint8_t dfu_lz_decode(uint8_t * *pBuff, uint32_t length)
+{
+	const uint8_t *pIn = (const uint8_t *) g_dfuLzXfer;
+
+	while (length != 0) {
+		if (DfuLz_Feed(&g_dfuLz, &pIn, &length, (uint8_t *) DFU_DEST_BASE + g_dfuLz.raw_done) < 0) {
+			return DFU_STATUS_errFILE;
+		}
+	}
+	*pBuff = (uint8_t *) g_dfuLzXfer;
+
+	return DFU_STATUS_OK;
+}
+
+#endif
+
 /* DFU write callback is called during DFU_DOWNLOAD state. In this example
  * we will write the data to DFU_DEST_BASE memory area.
  */
@@ -128,6 +192,12 @@ uint8_t dfu_wr(uint32_t block_num, uint8_t * *pBuff, uint32_t length, uint8_t *b
 		return DFU_STATUS_errADDRESS;
 	}
 
+#ifdef DFU_LZ_IMAGE
+	if (dfu_lz_select(block_num, length)) {
+		return dfu_lz_decode(pBuff, length);
+	}
+#endif
+
 	dest_addr += (block_num * DFU_XFER_BLOCK_SZ);
 	dest_addr += length;
 	*pBuff = (uint8_t *) dest_addr;
@@ -44,10 +44,139 @@ extern "C"
  * @{
  */
 
-/* Comment below and uncomment USE_USB1 to enable USB1 */
+/* Comment below and uncomment USE_USB1 to enable USB1. Define both to serve
+   a host on each controller at the same time, every controller then runs its
+   own ROM stack instance in its own USB RAM window. */
 #define USE_USB0
 /* #define USE_USB1 */
 
+/* Uncomment below to use high-bandwidth interrupt endpoints at high speed.
+   Only USB0 has an on-chip HS PHY, so the option has no effect on USB1. */
+/* #define HID_HS_HIGH_BANDWIDTH */
+
+/* Uncomment below to start every IN report payload with a header holding a
+   per channel 16 bit sequence number and the USB frame index at submission
+   time, letting the host detect lost or reordered reports and reconstruct
+   sample timing. */
+/* #define HID_IN_HEADER */
+
+/* Uncomment below as well to grow that header by the payload length and a
+   CRC-16 of the report (crcsw_18xx_43xx.h), so the host can check each
+   report end to end. */
+/* #define HID_IN_HEADER_CRC */
+
+/* Uncomment below to add a vendor class interface with a bulk IN/OUT
+   endpoint pair next to the HID interface, for bulk data such as waveform
+   dumps. Windows binds WinUSB to it through the WCID descriptors without an
+   INF file, see hid_bulk.h. */
+/* #define HID_VENDOR_BULK */
+
+/* Uncomment below to record every USB interrupt (pending status bits,
+   completed endpoints and ROM ISR duration in DWT cycles) into a trace ring
+   read with feature report HID_REPORT_ID_TRACE. With HID_TRACE_UART also
+   defined the main loop prints the entries on the debug UART instead, see
+   hid_trace.h. */
+/* #define HID_ISR_TRACE */
+/* #define HID_TRACE_UART */
+
+/* Uncomment below to time the USB interrupt, the HID endpoint handler and
+   the telemetry report build with the chip library profiling regions
+   (profile.h): count, min, max, mean and a log2 histogram of DWT cycles
+   per region. Feature report HID_REPORT_ID_PROF reads them; with
+   HID_PROF_UART also defined the main loop prints them on the debug UART
+   once a second, see hid_prof.h. */
+/* #define CHIP_PROFILE_ENABLE */
+/* #define HID_PROF_UART */
+
+/* Uncomment below to keep a table of the example's memory use with the
+   board library memory diagnostics (memdiag.h): the painted main stack
+   and the high-water mark of each port's USB_STACK_MEM_SIZE window.
+   Feature report HID_REPORT_ID_MEM reads one entry at a time; with
+   HID_MEMDIAG_UART also defined the main loop prints the table on the
+   debug UART every 10 seconds, see hid_mem.h. */
+/* #define HID_MEMDIAG */
+/* #define HID_MEMDIAG_UART */
+
+/* Uncomment below to trace USB interrupt entry and exit as binary ITM
+   events on the SWO pin (itm_trace.h), at HID_SWO_BAUD. The GPDMA job
+   handler of the chip library and the LPCUSBLib DcdIrqHandler() are traced
+   when those libraries are built with CHIP_ITM_TRACE_ENABLE defined too.
+   Decode a raw SWO capture with pctools/itm_decode.c. */
+/* #define CHIP_ITM_TRACE_ENABLE */
+#define HID_SWO_BAUD 2000000
+
+/* Uncomment below to follow USB suspend: while the host suspends the bus the
+   core runs from the IRC and SysTick is stopped, in USB0 only builds the PHY
+   clock and the USB PLL are stopped too. BUTTON1 then signals remote wakeup
+   if the host enabled it. Resume to first IN report latency is printed on
+   the debug UART, see hid_suspend.h. */
+/* #define HID_SUSPEND */
+
+/* Uncomment below to timestamp sensor events with the SCT (see
+   sct_tstamp_18xx_43xx.h): edges on CTIN_x input HID_SCT_TSTAMP_INPUT are
+   captured in hardware, and each telemetry report carries the SCT count at
+   submission, the latest captured event and the number of events since the
+   previous report, all in SCT clock ticks. Mux the CTIN pin, or point
+   HID_SCT_TSTAMP_ROUTE at another GIMA source such as an I2S frame sync. */
+/* #define HID_SCT_TSTAMP */
+#define HID_SCT_TSTAMP_INPUT         0
+#define HID_SCT_TSTAMP_ROUTE         (SCTTS_GIMA_SELECT(0) | SCTTS_GIMA_SYNCH)
+#define HID_SCT_TSTAMP_DEPTH         16		/* timestamp queue entries, power of 2 */
+
+/* Uncomment below to report edges of an event pin straight from its pin
+   interrupt (see hid_event.h): the handler fills a preformatted report in
+   place in USB RAM and commits it on channel HID_CHAN_EVENT, which is
+   scheduled ahead of all other channels, so an edge reaches the host within
+   one interrupt interval. The pin defaults to BUTTON1, which HID_SUSPEND
+   also watches on pin interrupt 0 to signal remote wakeup. */
+/* #define HID_EVENT_FASTPATH */
+#define HID_EVENT_GPIO_PORT          BUTTONS_BUTTON1_GPIO_PORT_NUM
+#define HID_EVENT_GPIO_BIT           BUTTONS_BUTTON1_GPIO_BIT_NUM
+#define HID_EVENT_PININT_INDEX       1
+#define HID_EVENT_PININT_IRQn        PIN_INT1_IRQn
+#define HID_EVENT_PININT_HANDLER     GPIO1_IRQHandler
+
+/* Uncomment below to send telemetry as packed sensor frames (see hid_pack.h):
+   each sample is a frame of HID_PACK_CHANNELS 16 bit channels, the first
+   frame of a report is sent as is and the following ones as zig-zag varint
+   steps, so slowly changing channels take one byte per sample instead of
+   two. pctools/hid_pack_decode.c turns the reports back into samples. */
+/* #define HID_TELEMETRY_PACK */
+#define HID_PACK_CHANNELS            4
+#define HID_PACK_DEADLINE_US         20000
+
+/* Uncomment below to build the telemetry reports from the SOF interrupt
+   (see hid_sof.h) instead of the main loop: the sample is captured and its
+   report queued HID_SOF_LEAD_US ahead of the (micro)frame the host polls
+   the telemetry IN endpoint in, rounded up to whole (micro)frames and at
+   least one, so the time from capture to poll is the same every interval. */
+/* #define HID_SOF_SCHED */
+#define HID_SOF_LEAD_US              125
+
+/* Uncomment below to stream ADC0 channel HID_ADC_CHANNEL (the potentiometer
+   of the MCB1857) in burst mode at HID_ADC_RATE samples per second on the
+   telemetry channel (see hid_adc.h): the GPDMA moves every conversion result
+   straight into the IN report slots in USB RAM and the DMA interrupt only
+   commits the full ones. */
+/* #define HID_ADC_STREAM */
+#define HID_ADC_CHANNEL              ADC_CH1
+#define HID_ADC_RATE                 400000
+
+/* Uncomment below to bridge C_CAN0 to the telemetry channel (see hid_can.h):
+   received frames are stamped in microseconds and packed many to an IN
+   report, sent when full or HID_CAN_DEADLINE_US after its first frame, and
+   an OUT report on the channel carries several frames to send. A fully
+   loaded 1 Mbit/s bus is up to about 9000 frames a second, some 17 of them
+   fit a 255 byte report, so at high speed enable HID_HS_HIGH_BANDWIDTH or
+   lower HID_HS_EP_INTERVAL to keep up. A full speed port moves 64 bytes a
+   millisecond, about half of such a bus. */
+/* #define HID_CAN_BRIDGE */
+#define HID_CAN_BITRATE              1000000
+#define HID_CAN_RX_OBJS              16		/* message objects chained for receive */
+#define HID_CAN_RB_SIZE              64		/* received frames waiting for an IN slot */
+#define HID_CAN_TX_RB_SIZE           64		/* frames waiting to be sent */
+#define HID_CAN_DEADLINE_US          2000
+
 /* Manifest constants used by USBD ROM stack. These values SHOULD NOT BE CHANGED
    for advance features which require usage of USB_CORE_CTRL_T structure.
    Since these are the values used for compiling USB stack.
@@ -59,32 +188,384 @@ extern "C"
 #define USB_HS_MAX_BULK_PACKET  512		/*!< MAXP for HS bulk EPs used for building USBD ROM. DON'T CHANGE. */
 #define USB_DFU_XFER_SIZE       2048	/*!< Max DFU transfer size used for building USBD ROM. DON'T CHANGE. */
 
-/* Manifest constants to select appropriate USB instance */
-#ifdef USE_USB0
-#define LPC_USB_BASE            LPC_USB0_BASE
-#define LPC_USB                 LPC_USB0
-#define LPC_USB_IRQ             USB0_IRQn
-#define USB_IRQHandler          USB0_IRQHandler
-#define USB_init_pin_clk        Chip_USB0_Init
+/* Manifest constants to select the USB instances, a port is one controller
+   running the example. USB0 is always port 0 when enabled. */
+#if defined(USE_USB0) && defined(USE_USB1)
+#define HID_NUM_PORTS           2
+#elif defined(USE_USB0) || defined(USE_USB1)
+#define HID_NUM_PORTS           1
+#else
+#error "HID_Generic: define USE_USB0 and/or USE_USB1"
+#endif
+
+/* The event pin interrupt submits reports too, so it is masked with the USB
+   interrupts */
+#ifdef HID_EVENT_FASTPATH
+#define HID_EVENT_IRQ_DISABLE() NVIC_DisableIRQ(HID_EVENT_PININT_IRQn)
+#define HID_EVENT_IRQ_ENABLE()  NVIC_EnableIRQ(HID_EVENT_PININT_IRQn)
+#else
+#define HID_EVENT_IRQ_DISABLE()
+#define HID_EVENT_IRQ_ENABLE()
+#endif
+
+/* So is the GPDMA interrupt of the ADC stream */
+#ifdef HID_ADC_STREAM
+#define HID_ADC_IRQ_DISABLE()   NVIC_DisableIRQ(DMA_IRQn)
+#define HID_ADC_IRQ_ENABLE()    NVIC_EnableIRQ(DMA_IRQn)
+#else
+#define HID_ADC_IRQ_DISABLE()
+#define HID_ADC_IRQ_ENABLE()
+#endif
+
+/* And the C_CAN interrupt of the CAN bridge */
+#ifdef HID_CAN_BRIDGE
+#define HID_CAN_IRQ_DISABLE()   NVIC_DisableIRQ(C_CAN0_IRQn)
+#define HID_CAN_IRQ_ENABLE()    NVIC_EnableIRQ(C_CAN0_IRQn)
+#else
+#define HID_CAN_IRQ_DISABLE()
+#define HID_CAN_IRQ_ENABLE()
+#endif
+
+/* Critical section around state touched from the USB interrupts of all ports */
+#if defined(USE_USB0) && defined(USE_USB1)
+#define HID_USB_IRQ_DISABLE()   do { NVIC_DisableIRQ(USB0_IRQn); NVIC_DisableIRQ(USB1_IRQn); HID_EVENT_IRQ_DISABLE(); HID_ADC_IRQ_DISABLE(); HID_CAN_IRQ_DISABLE(); } while (0)
+#define HID_USB_IRQ_ENABLE()    do { NVIC_EnableIRQ(USB0_IRQn); NVIC_EnableIRQ(USB1_IRQn); HID_EVENT_IRQ_ENABLE(); HID_ADC_IRQ_ENABLE(); HID_CAN_IRQ_ENABLE(); } while (0)
+#elif defined(USE_USB0)
+#define HID_USB_IRQ_DISABLE()   do { NVIC_DisableIRQ(USB0_IRQn); HID_EVENT_IRQ_DISABLE(); HID_ADC_IRQ_DISABLE(); HID_CAN_IRQ_DISABLE(); } while (0)
+#define HID_USB_IRQ_ENABLE()    do { NVIC_EnableIRQ(USB0_IRQn); HID_EVENT_IRQ_ENABLE(); HID_ADC_IRQ_ENABLE(); HID_CAN_IRQ_ENABLE(); } while (0)
+#else
+#define HID_USB_IRQ_DISABLE()   do { NVIC_DisableIRQ(USB1_IRQn); HID_EVENT_IRQ_DISABLE(); HID_ADC_IRQ_DISABLE(); HID_CAN_IRQ_DISABLE(); } while (0)
+#define HID_USB_IRQ_ENABLE()    do { NVIC_EnableIRQ(USB1_IRQn); HID_EVENT_IRQ_ENABLE(); HID_ADC_IRQ_ENABLE(); HID_CAN_IRQ_ENABLE(); } while (0)
+#endif
+
+/* bmAttributes of the configuration, remote wakeup is offered with HID_SUSPEND */
+#ifdef HID_SUSPEND
+#define HID_CONFIG_ATTRIBUTES        (USB_CONFIG_SELF_POWERED | USB_CONFIG_REMOTE_WAKEUP)
+#else
+#define HID_CONFIG_ATTRIBUTES        USB_CONFIG_SELF_POWERED
+#endif
+
+/* Number of HID interfaces, 1 to 3. Each HID interface has an interrupt
+   IN/OUT endpoint pair, a report descriptor and a usb_hid_init() instance
+   of its own, and carries the logical channels HID_CHAN_INTF() maps onto
+   it. The host reserves interrupt bandwidth per endpoint and opens each
+   interface as a separate device, so streams on different interfaces don't
+   share an interval and can be read from different threads. */
+#define HID_NUM_HID_INTF             1
+
+/* HID In/Out Endpoint Address of HID interface n, interface 0 uses
+   endpoint 1, the others 3 and 4 (the bulk interface has endpoint 2) */
+#define HID_INTF_EP_NUM(n)           (((n) == 0) ? 1 : ((n) + 2))
+#define HID_INTF_EP_IN(n)            (0x80 | HID_INTF_EP_NUM(n))
+#define HID_INTF_EP_OUT(n)           HID_INTF_EP_NUM(n)
+#define HID_EP_IN                    HID_INTF_EP_IN(0)
+#define HID_EP_OUT                   HID_INTF_EP_OUT(0)
+
+/* Vendor bulk interface and endpoint addresses, the bulk interface follows
+   the HID interfaces */
+#define HID_BULK_INTERFACE_NUM       HID_NUM_HID_INTF
+#define HID_BULK_EP_IN               0x82
+#define HID_BULK_EP_OUT              0x02
+/* Bytes moved by one queued bulk transfer, a multiple of the HS packet size */
+#define HID_BULK_XFER_BYTES          2048
+/* Number of bulk transfers queued per direction. Must be a power of 2. */
+#define HID_BULK_IN_QUEUE_DEPTH      4
+#define HID_BULK_OUT_QUEUE_DEPTH     2
+/* bMS_VendorCode of the Microsoft OS string descriptor */
+#define HID_WCID_VENDOR_CODE         0x81
+
+#ifdef HID_VENDOR_BULK
+#define HID_NUM_INTERFACES           (HID_NUM_HID_INTF + 1)
+#define HID_BULK_MEM_SIZE            ((HID_BULK_IN_QUEUE_DEPTH + HID_BULK_OUT_QUEUE_DEPTH) * HID_BULK_XFER_BYTES)
+#else
+#define HID_NUM_INTERFACES           HID_NUM_HID_INTF
+#define HID_BULK_MEM_SIZE            0
+#endif
+/* Highest endpoint number used plus one (EP0, HID and bulk endpoints) */
+#if HID_NUM_HID_INTF > 1
+#define HID_MAX_NUM_EP               (HID_INTF_EP_NUM(HID_NUM_HID_INTF - 1) + 1)
+#elif defined(HID_VENDOR_BULK)
+#define HID_MAX_NUM_EP               3
+#else
+#define HID_MAX_NUM_EP               2
+#endif
+
+/* HID interrupt endpoint parameters. In high-bandwidth mode the HS endpoints
+   carry up to HID_HS_EP_MULT packets of HID_HS_EP_MAXPACKET bytes every
+   microframe and one IN/OUT report spans all of them. The FS endpoints keep
+   the 64 byte limit of the full-speed interrupt transfer type.
+ */
+#if defined(HID_HS_HIGH_BANDWIDTH) && defined(USE_USB0)
+#define HID_HS_EP_MAXPACKET          1024	/* wMaxPacketSize[10:0] */
+#define HID_HS_EP_MULT               3		/* transactions per microframe */
+#define HID_HS_EP_INTERVAL           0x01	/* every microframe */
+#define HID_FS_EP_MAXPACKET          64
+#define HID_FS_EP_INTERVAL           0x01	/* 1ms */
+#define HID_INPUT_REPORT_BYTES       (HID_HS_EP_MAXPACKET * HID_HS_EP_MULT)
+#define HID_OUTPUT_REPORT_BYTES      (HID_HS_EP_MAXPACKET * HID_HS_EP_MULT)
+#else
+#define HID_HS_EP_MAXPACKET          0x00ff
+#define HID_HS_EP_MULT               1
+#define HID_HS_EP_INTERVAL           0x08	/* 16ms */
+#define HID_FS_EP_MAXPACKET          0x0004
+#define HID_FS_EP_INTERVAL           0x20	/* 32ms */
+#define HID_INPUT_REPORT_BYTES       255
+#define HID_OUTPUT_REPORT_BYTES      255
+#endif
+#define HID_FEATURE_REPORT_BYTES     255
+
+/* wMaxPacketSize value, bits 12:11 hold the number of additional transactions */
+#define HID_HS_EP_WMAXPACKET         (HID_HS_EP_MAXPACKET | ((HID_HS_EP_MULT - 1) << 11))
+
+/* Number of IN report buffers queued in USB RAM per channel. Must be a power of 2. */
+#define HID_IN_QUEUE_DEPTH           4
+/* Number of OUT report buffers received into ahead of the application. Must be a power of 2. */
+#if HID_HS_EP_MULT > 1
+#define HID_OUT_QUEUE_DEPTH          2
+#else
+#define HID_OUT_QUEUE_DEPTH          4
+#endif
+
+/* Logical channels multiplexed over the interrupt endpoints by report ID.
+   Channel n uses report ID (n + 1) and a lower channel number has a higher
+   priority when the next IN report is scheduled, except that the pin event
+   channel goes first. Every report carries its ID in the first byte,
+   leaving HID_CHAN_PAYLOAD_BYTES of payload.
+ */
+#define HID_CHAN_CONTROL             0		/* control replies and acks */
+#define HID_CHAN_LOG                 1		/* log lines */
+#define HID_CHAN_TELEMETRY           2		/* bulk telemetry */
+#ifdef HID_EVENT_FASTPATH
+#define HID_CHAN_EVENT               3		/* pin events from the ISR */
+#define HID_NUM_CHANNELS             4		/* at most 4 */
+/* Channel scheduled at position i, the event channel first */
+#define HID_CHAN_SCHED(i)            (((i) + HID_CHAN_EVENT) % HID_NUM_CHANNELS)
+#else
+#define HID_NUM_CHANNELS             3		/* at most 4 */
+#define HID_CHAN_SCHED(i)            (i)
+#endif
+#define HID_CHAN_REPORT_ID(ch)       ((ch) + 1)
+#define HID_REPORT_ID_CHAN(id)       ((id) - 1)
+#define HID_IS_CHAN_REPORT_ID(id)    (((id) >= 1) && ((id) <= HID_NUM_CHANNELS))
+/* HID interface carrying channel ch, every interface needs one channel at
+   least. Telemetry gets the second interface, the log channel the third.
+   Feature reports always go through interface 0. */
+#if HID_NUM_HID_INTF == 3
+#define HID_CHAN_INTF(ch)            (((ch) == HID_CHAN_TELEMETRY) ? 1 : (((ch) == HID_CHAN_LOG) ? 2 : 0))
+#elif HID_NUM_HID_INTF == 2
+#define HID_CHAN_INTF(ch)            (((ch) == HID_CHAN_TELEMETRY) ? 1 : 0)
+#else
+#define HID_CHAN_INTF(ch)            0
+#endif
+
+/* Optional IN report header, behind the report ID:
+     byte 0..1 : sequence number of the channel, little endian
+     byte 2..3 : FRINDEX at submission, bits 13:3 frame, bits 2:0 microframe
+   and with HID_IN_HEADER_CRC
+     byte 4..5 : payload bytes that follow the header, little endian
+     byte 6..7 : CRC-16 (CCITT, start 0xFFFF) of the report ID, bytes 0..5
+                 and the payload, little endian
+ */
+#if defined(HID_IN_HEADER_CRC) && !defined(HID_IN_HEADER)
+#error "HID_Generic: HID_IN_HEADER_CRC extends HID_IN_HEADER"
+#endif
+#ifdef HID_IN_HEADER_CRC
+#define HID_IN_HDR_BYTES             8
+#elif defined(HID_IN_HEADER)
+#define HID_IN_HDR_BYTES             4
 #else
-#undef USB_IRQHandler
-#define LPC_USB_BASE            LPC_USB1_BASE
-#define LPC_USB                 LPC_USB1
-#define LPC_USB_IRQ             USB1_IRQn
-#define USB_IRQHandler          USB1_IRQHandler
-#define USB_init_pin_clk        Chip_USB1_Init
+#define HID_IN_HDR_BYTES             0
 #endif
+#define HID_CHAN_PAYLOAD_BYTES       (HID_INPUT_REPORT_BYTES - 1 - HID_IN_HDR_BYTES)
 
-/* HID In/Out Endpoint Address */
-#define HID_EP_IN       0x81
-#define HID_EP_OUT      0x01
+/* Tick of the RITimer timer wheel (timerwheel_18xx_43xx.h) that times the
+   example's timeouts. The wheel only interrupts when a timer is due, a
+   shorter tick costs no CPU time. */
+#define HID_TWHEEL_TICK_US           100
+
+/* Short messages put through hid_coalesce.h are packed into one report of
+   the coalescing channel. A partly filled report is sent at the latest
+   HID_COALESCE_DEADLINE_US after its first message, timed with the timer
+   wheel and rounded up to whole HID_TWHEEL_TICK_US ticks.
+ */
+#define HID_COALESCE_DEADLINE_US     10000
+
+/* Feature report ID used to stream configuration blobs over EP0 in
+   HID_FEATURE_REPORT_BYTES sized chunks, see hid_blob.h */
+#define HID_REPORT_ID_BLOB           0x10
+
+/* Feature report ID selecting the benchmark mode, see hid_bench.h */
+#define HID_REPORT_ID_BENCH          0x11
+#define HID_BENCH_REPORT_BYTES       16
+
+/* Feature report ID returning USB event statistics, see hid_stats.h */
+#define HID_REPORT_ID_STATS          0x12
+#define HID_STATS_REPORT_BYTES       48
+
+/* Feature report ID draining the USB interrupt trace, see hid_trace.h. The
+   report is built in the feature report buffer. */
+#define HID_REPORT_ID_TRACE          0x13
+#define HID_TRACE_DEPTH              64		/* entries in the trace ring */
+#define HID_TRACE_ENTRY_BYTES        16
+#define HID_TRACE_REPORT_ENTRIES     15
+#define HID_TRACE_REPORT_BYTES       (4 + (HID_TRACE_REPORT_ENTRIES * HID_TRACE_ENTRY_BYTES))
+
+/* Feature report ID reading the profiling regions, see hid_prof.h */
+#define HID_REPORT_ID_PROF           0x14
+#define HID_PROF_REPORT_BYTES        72
+
+/* Feature report ID reading the memory usage table, see hid_mem.h */
+#define HID_REPORT_ID_MEM            0x15
+#define HID_MEM_REPORT_BYTES         40
+
+/* Sanity checks on the parameters above, hid_desc.c generates the HS and FS
+   descriptors from them and checks the generated lengths */
+#if HID_NUM_HID_INTF < 1 || HID_NUM_HID_INTF > 3
+#error "HID_Generic: 1 to 3 HID interfaces are supported"
+#endif
+#if HID_MAX_NUM_EP > USB_MAX_EP_NUM || HID_NUM_INTERFACES > USB_MAX_IF_NUM
+#error "HID_Generic: more endpoints or interfaces than the USBD ROM build supports"
+#endif
+#if HID_NUM_HID_INTF > 1 && HID_HS_EP_MULT > 1
+#error "HID_Generic: high-bandwidth endpoints take the periodic bandwidth of one HID interface"
+#endif
+#if (HID_EP_IN & 0x80) == 0 || (HID_EP_OUT & 0x80) != 0
+#error "HID_Generic: HID_EP_IN must be an IN and HID_EP_OUT an OUT endpoint address"
+#endif
+#if (HID_EP_IN & 0x0F) == 0 || (HID_EP_IN & 0x0F) >= USB_MAX_EP_NUM || \
+	(HID_EP_OUT & 0x0F) == 0 || (HID_EP_OUT & 0x0F) >= USB_MAX_EP_NUM
+#error "HID_Generic: endpoint number out of range of the USBD ROM build"
+#endif
+#if HID_HS_EP_MAXPACKET < 1 || HID_HS_EP_MAXPACKET > 1024
+#error "HID_Generic: HS interrupt endpoints are limited to 1024 byte packets"
+#endif
+#if HID_HS_EP_MULT < 1 || HID_HS_EP_MULT > 3
+#error "HID_Generic: HS interrupt endpoints allow 1 to 3 transactions per microframe"
+#endif
+#if (HID_HS_EP_MULT == 2 && HID_HS_EP_MAXPACKET < 513) || (HID_HS_EP_MULT == 3 && HID_HS_EP_MAXPACKET < 683)
+#error "HID_Generic: packet size too small for the number of transactions per microframe"
+#endif
+#if HID_FS_EP_MAXPACKET < 1 || HID_FS_EP_MAXPACKET > 64
+#error "HID_Generic: FS interrupt endpoints are limited to 64 byte packets"
+#endif
+#if HID_HS_EP_INTERVAL < 1 || HID_HS_EP_INTERVAL > 16
+#error "HID_Generic: HS bInterval must be 1 to 16"
+#endif
+#if HID_FS_EP_INTERVAL < 1 || HID_FS_EP_INTERVAL > 255
+#error "HID_Generic: FS bInterval must be 1 to 255"
+#endif
+#if HID_INPUT_REPORT_BYTES < 2 || HID_INPUT_REPORT_BYTES > (HID_HS_EP_MAXPACKET * HID_HS_EP_MULT) || \
+	HID_OUTPUT_REPORT_BYTES < 2 || HID_OUTPUT_REPORT_BYTES > (HID_HS_EP_MAXPACKET * HID_HS_EP_MULT)
+#error "HID_Generic: a report must fit the HS endpoint bandwidth of one service interval"
+#endif
+#if HID_HS_EP_MULT > 1 && (HID_INPUT_REPORT_BYTES != (HID_HS_EP_MAXPACKET * HID_HS_EP_MULT) || \
+						   HID_OUTPUT_REPORT_BYTES != (HID_HS_EP_MAXPACKET * HID_HS_EP_MULT))
+#error "HID_Generic: high-bandwidth reports must fill all transactions of a microframe"
+#endif
+#if HID_FEATURE_REPORT_BYTES > 255 || HID_BENCH_REPORT_BYTES > 255 || HID_STATS_REPORT_BYTES > 255 || \
+	HID_PROF_REPORT_BYTES > 255 || HID_MEM_REPORT_BYTES > 255
+#error "HID_Generic: feature reports are described with an 8 bit report count"
+#endif
+#if HID_TRACE_REPORT_BYTES > HID_FEATURE_REPORT_BYTES
+#error "HID_Generic: trace report must fit the feature report buffer"
+#endif
+#if HID_REPORT_ID_BLOB <= HID_NUM_CHANNELS || HID_REPORT_ID_BENCH <= HID_NUM_CHANNELS || \
+	HID_REPORT_ID_STATS <= HID_NUM_CHANNELS || HID_REPORT_ID_TRACE <= HID_NUM_CHANNELS || \
+	HID_REPORT_ID_PROF <= HID_NUM_CHANNELS || HID_REPORT_ID_MEM <= HID_NUM_CHANNELS
+#error "HID_Generic: feature report IDs collide with channel report IDs"
+#endif
+#if (HID_IN_QUEUE_DEPTH & (HID_IN_QUEUE_DEPTH - 1)) != 0 || (HID_OUT_QUEUE_DEPTH & (HID_OUT_QUEUE_DEPTH - 1)) != 0
+#error "HID_Generic: report queue depths must be a power of 2"
+#endif
+#if (HID_TRACE_DEPTH & (HID_TRACE_DEPTH - 1)) != 0 || HID_TRACE_DEPTH < 2
+#error "HID_Generic: trace ring depth must be a power of 2"
+#endif
+#if (HID_BULK_EP_IN & 0x80) == 0 || (HID_BULK_EP_OUT & 0x80) != 0 || \
+	(HID_BULK_EP_IN & 0x0F) == (HID_EP_IN & 0x0F) || (HID_BULK_EP_OUT & 0x0F) == (HID_EP_OUT & 0x0F) || \
+	(HID_BULK_EP_IN & 0x0F) >= USB_MAX_EP_NUM || (HID_BULK_EP_OUT & 0x0F) >= USB_MAX_EP_NUM
+#error "HID_Generic: bulk endpoints must be a free IN and OUT endpoint of the USBD ROM build"
+#endif
+#if (HID_BULK_XFER_BYTES % USB_HS_MAX_BULK_PACKET) != 0 || HID_BULK_XFER_BYTES > 16384
+#error "HID_Generic: bulk transfers must be whole HS packets and fit one dTD"
+#endif
+#if (HID_BULK_IN_QUEUE_DEPTH & (HID_BULK_IN_QUEUE_DEPTH - 1)) != 0 || \
+	(HID_BULK_OUT_QUEUE_DEPTH & (HID_BULK_OUT_QUEUE_DEPTH - 1)) != 0
+#error "HID_Generic: bulk queue depths must be a power of 2"
+#endif
+#if defined(HID_VENDOR_BULK) && HID_NUM_PORTS > 1
+#error "HID_Generic: the vendor bulk interface runs on a single controller"
+#endif
+#if HID_COALESCE_DEADLINE_US < 10 || HID_COALESCE_DEADLINE_US > 1000000
+#error "HID_Generic: coalescing deadline must be 10us to 1s"
+#endif
+#if defined(HID_SOF_SCHED) && defined(HID_TELEMETRY_PACK)
+#error "HID_Generic: the SOF scheduler and the frame packer both own the telemetry channel"
+#endif
+#if defined(HID_SOF_SCHED) && (HID_SOF_LEAD_US < 0 || HID_SOF_LEAD_US > 1000000)
+#error "HID_Generic: SOF capture lead must be up to 1s"
+#endif
+#ifdef HID_ADC_STREAM
+#if defined(HID_SOF_SCHED) || defined(HID_TELEMETRY_PACK)
+#error "HID_Generic: the ADC stream owns the telemetry channel"
+#endif
+#ifdef HID_SCT_TSTAMP
+#error "HID_Generic: ADC stream reports have no room for the SCT timestamps"
+#endif
+#if HID_ADC_RATE < 1000 || HID_ADC_RATE > 400000
+#error "HID_Generic: ADC rate must be 1k to 400k samples per second"
+#endif
+#if HID_IN_QUEUE_DEPTH < 4
+#error "HID_Generic: the ADC stream needs 2 slots for the DMA and 2 to send from"
+#endif
+#endif
+#ifdef HID_CAN_BRIDGE
+#if defined(HID_SOF_SCHED) || defined(HID_TELEMETRY_PACK) || defined(HID_ADC_STREAM)
+#error "HID_Generic: the CAN bridge owns the telemetry channel"
+#endif
+#ifdef HID_SCT_TSTAMP
+#error "HID_Generic: CAN bridge reports have no room for the SCT timestamps"
+#endif
+#if HID_CAN_BITRATE < 10000 || HID_CAN_BITRATE > 1000000
+#error "HID_Generic: CAN bit rate must be 10k to 1M bit/s"
+#endif
+#if HID_CAN_RX_OBJS < 1 || HID_CAN_RX_OBJS > 31
+#error "HID_Generic: the CAN receive chain takes 1 to 31 message objects, the last one sends"
+#endif
+#if (HID_CAN_RB_SIZE & (HID_CAN_RB_SIZE - 1)) != 0 || (HID_CAN_TX_RB_SIZE & (HID_CAN_TX_RB_SIZE - 1)) != 0
+#error "HID_Generic: CAN frame queue sizes must be a power of 2"
+#endif
+#if HID_CAN_DEADLINE_US < 10 || HID_CAN_DEADLINE_US > 65535
+#error "HID_Generic: CAN report deadline must be 10us to 65535us, frame offsets are 16 bit"
+#endif
+#endif
+#ifdef HID_TELEMETRY_PACK
+#if HID_PACK_CHANNELS < 1 || (8 + (2 * HID_PACK_CHANNELS)) > HID_CHAN_PAYLOAD_BYTES
+#error "HID_Generic: a packed frame must fit one telemetry report"
+#endif
+#if HID_PACK_DEADLINE_US < 10 || HID_PACK_DEADLINE_US > 1000000
+#error "HID_Generic: packing deadline must be 10us to 1s"
+#endif
+#ifdef HID_SCT_TSTAMP
+#error "HID_Generic: packed telemetry has no room for the SCT timestamps"
+#endif
+#endif
 
 /* On LPC18xx/43xx the USB controller requires endpoint queue heads to start on
    a 4KB aligned memory. Hence the mem_base value passed to USB stack init should
    be 4KB aligned. The following manifest constants are used to define this memory.
  */
 #define USB_STACK_MEM_BASE      0x20000000
-#define USB_STACK_MEM_SIZE      0x00002000
+#if defined(HID_HS_HIGH_BANDWIDTH) && defined(USE_USB0)
+#define USB_STACK_MEM_SIZE      (0x0000D000 + HID_BULK_MEM_SIZE)	/* room for the larger report queues */
+#else
+#define USB_STACK_MEM_SIZE      (0x00003000 + HID_BULK_MEM_SIZE + ((HID_NUM_HID_INTF - 1) * 0x800))
+#endif
+#if (HID_NUM_PORTS * USB_STACK_MEM_SIZE) > 0x00010000
+#error "HID_Generic: USB RAM windows exceed the 64KB AHB SRAM"
+#endif
+/* Each port gets a USB_STACK_MEM_SIZE window, USB1 follows the one of USB0 */
+#define USB0_STACK_MEM_BASE     USB_STACK_MEM_BASE
+#define USB1_STACK_MEM_BASE     (USB_STACK_MEM_BASE + ((HID_NUM_PORTS - 1) * USB_STACK_MEM_SIZE))
 
 /* USB descriptor arrays defined *_desc.c file */
 extern const uint8_t USB_DeviceDescriptor[];
@@ -92,15 +573,10 @@ extern uint8_t USB_HsConfigDescriptor[];
 extern uint8_t USB_FsConfigDescriptor[];
 extern const uint8_t USB_StringDescriptor[];
 extern const uint8_t USB_DeviceQualifier[];
-
-/**
- * @brief	Find the address of interface descriptor for given class type.
- * @param	pDesc		: Pointer to configuration descriptor in which the desired class
- *			interface descriptor to be found.
- * @param	intfClass	: Interface class type to be searched.
- * @return	If found returns the address of requested interface else returns NULL.
- */
-extern USB_INTERFACE_DESCRIPTOR *find_IntfDesc(const uint8_t *pDesc, uint32_t intfClass);
+#ifdef HID_VENDOR_BULK
+extern const uint8_t WCID_String_Descriptor[];
+extern const uint8_t WCID_CompatID_Descriptor[];
+#endif
 
 /**
  * @}
@@ -0,0 +1,207 @@
+/*
+ * @brief Zero copy ADC to HID report stream
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "hid_generic.h"
+#include "hid_bench.h"
+#include "hid_adc.h"
+
+#ifdef HID_ADC_STREAM
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Linked descriptors: the one filling, the one loaded next and the one
+   aimed at a new slot meanwhile */
+#define ADC_RING                3
+
+typedef struct {
+	USBD_HANDLE_T hUsb;				/*!< Port the reports go to */
+	uint32_t chan;					/*!< Channel the reports are sent on */
+	uint32_t seq;					/*!< Sequence number of the slot filling */
+	uint8_t dmaChannel;				/*!< Claimed GPDMA channel */
+	uint8_t cur;					/*!< Descriptor the DMA completes next */
+	uint8_t *pSlot[ADC_RING];		/*!< Slot payload of each descriptor, NULL for scratch */
+	HID_Adc_Stats_T stats;			/*!< Counters */
+	DMA_TransferDescriptor_t desc[ADC_RING];	/*!< Circular list */
+} HID_Adc_Ctrl_T;
+
+static HID_Adc_Ctrl_T g_adc;
+
+/* Target of results without a free slot */
+static uint32_t g_scratch[HID_ADC_SLOT_SAMPLES];
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Point descriptor n at the next free slot, or at the scratch buffer */
+static void adc_aim(HID_Adc_Ctrl_T *pAdc, uint32_t n)
+{
+	uint8_t *pSlot = NULL;
+
+	/* while a benchmark runs it owns the channel */
+	if (!hid_bench_active(pAdc->hUsb)) {
+		pSlot = hid_generic_slot_get_next(pAdc->hUsb, pAdc->chan);
+	}
+	pAdc->pSlot[n] = pSlot;
+	pAdc->desc[n].dst = (pSlot != NULL) ? (uint32_t) &pSlot[HID_ADC_HDR_BYTES] : (uint32_t) g_scratch;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Handle the GPDMA interrupt, a slot is full
+ * @return	Nothing
+ */
+HOTFUNC void DMA_IRQHandler(void)
+{
+	HID_Adc_Ctrl_T *pAdc = &g_adc;
+	uint32_t n = pAdc->cur;
+	uint32_t i, overruns = 0;
+	const uint32_t *pWord;
+	uint8_t *pSlot;
+
+	if (!Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_INT, pAdc->dmaChannel)) {
+		return;
+	}
+	if (Chip_GPDMA_Interrupt(LPC_GPDMA, pAdc->dmaChannel) == ERROR) {
+		/* the channel halts on a bus error */
+		pAdc->stats.errors++;
+		Chip_ADC_SetBurstCmd(LPC_ADC0, DISABLE);
+		return;
+	}
+
+	/* The DMA runs in descriptor n + 1 by now. The USB interrupts can't run
+	   meanwhile (same priority) and the main loop's critical sections mask
+	   this interrupt, so the channel queue is ours until the commit. */
+	pAdc->cur = (uint8_t) ((n + 1) % ADC_RING);
+	pSlot = pAdc->pSlot[n];
+	if (pSlot != NULL) {
+		pWord = (const uint32_t *) &pSlot[HID_ADC_HDR_BYTES];
+		for (i = 0; i < HID_ADC_SLOT_SAMPLES; i++) {
+			overruns += ADC_DR_OVERRUN(pWord[i]);
+		}
+		pSlot[0] = (uint8_t) pAdc->seq;
+		pSlot[1] = (uint8_t) (pAdc->seq >> 8);
+		pSlot[2] = (uint8_t) (pAdc->seq >> 16);
+		pSlot[3] = (uint8_t) (pAdc->seq >> 24);
+		/* fails when a bus reset dropped the slot */
+		if (hid_generic_slot_commit(pAdc->hUsb, pAdc->chan, HID_ADC_REPORT_BYTES) == LPC_OK) {
+			pAdc->stats.slots++;
+			pAdc->stats.overruns += overruns;
+		}
+		else {
+			pAdc->stats.dropped++;
+		}
+	}
+	else {
+		pAdc->stats.dropped++;
+	}
+	pAdc->seq++;
+
+	/* loaded by the DMA once descriptor n + 1 is full */
+	adc_aim(pAdc, (n + 2) % ADC_RING);
+}
+
+/* Set up and start the ADC stream */
+ErrorCode_t hid_adc_init(USBD_HANDLE_T hUsb, uint32_t chan)
+{
+	HID_Adc_Ctrl_T *pAdc = &g_adc;
+	ADC_CLOCK_SETUP_T setup;
+	uint32_t ctrl, i;
+
+	memset(pAdc, 0, sizeof(*pAdc));
+	pAdc->hUsb = hUsb;
+	pAdc->chan = chan;
+
+	Chip_ADC_Init(LPC_ADC0, &setup);
+	Chip_ADC_SetSampleRate(LPC_ADC0, &setup, HID_ADC_RATE);
+	Chip_ADC_EnableChannel(LPC_ADC0, HID_ADC_CHANNEL, ENABLE);
+
+	Chip_GPDMA_Init(LPC_GPDMA);
+	pAdc->dmaChannel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, GPDMA_CONN_ADC_0);
+	if (pAdc->dmaChannel >= GPDMA_NUMBER_CHANNELS) {
+		return ERR_FAILED;
+	}
+
+	/* One word per request, the global data register read clears the
+	   request. Every descriptor interrupts, one per slot. */
+	ctrl = GPDMA_DMACCxControl_TransferSize(HID_ADC_SLOT_SAMPLES) |
+		   GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1) |
+		   GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) |
+		   GPDMA_DMACCxControl_DestTransUseAHBMaster1 | GPDMA_DMACCxControl_DI | GPDMA_DMACCxControl_I;
+	for (i = 0; i < ADC_RING; i++) {
+		pAdc->desc[i].src = (uint32_t) &LPC_ADC0->GDR;
+		pAdc->desc[i].lli = (uint32_t) &pAdc->desc[(i + 1) % ADC_RING];
+		pAdc->desc[i].ctrl = ctrl;
+	}
+	/* the third descriptor is aimed when the first one completes */
+	adc_aim(pAdc, 0);
+	adc_aim(pAdc, 1);
+	pAdc->desc[2].dst = (uint32_t) g_scratch;
+
+#ifdef USE_USB0
+	NVIC_SetPriority(DMA_IRQn, NVIC_GetPriority(USB0_IRQn));
+#else
+	NVIC_SetPriority(DMA_IRQn, NVIC_GetPriority(USB1_IRQn));
+#endif
+	NVIC_ClearPendingIRQ(DMA_IRQn);
+	NVIC_EnableIRQ(DMA_IRQn);
+
+	/* Only the global DONE flag requests DMA, drop a stale result first */
+	LPC_ADC0->INTEN = (1UL << 8);
+	(void) LPC_ADC0->GDR;
+	if (Chip_GPDMA_SGTransferPeripheral(LPC_GPDMA, pAdc->dmaChannel, GPDMA_CONN_ADC_0, &pAdc->desc[0],
+										GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR) {
+		LPC_ADC0->INTEN = 0;
+		return ERR_FAILED;
+	}
+	Chip_ADC_SetBurstCmd(LPC_ADC0, ENABLE);
+
+	return LPC_OK;
+}
+
+/* Get the ADC stream counters */
+const HID_Adc_Stats_T *hid_adc_get_stats(void)
+{
+	return &g_adc.stats;
+}
+
+#endif /* HID_ADC_STREAM */
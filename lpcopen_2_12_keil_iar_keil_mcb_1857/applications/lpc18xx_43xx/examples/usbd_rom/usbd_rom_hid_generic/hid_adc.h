@@ -0,0 +1,102 @@
+/*
+ * @brief Zero copy ADC to HID report stream
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_ADC_H_
+#define __HID_ADC_H_
+
+#include "board.h"
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* ADC0 converts HID_ADC_CHANNEL back to back in burst mode and a GPDMA
+   channel moves every result into the payload of an IN report slot handed
+   out by hid_generic_slot_get_next(), nothing is copied by the CPU. Three
+   linked descriptors take turns: the DMA fills one slot and moves on to the
+   next one by itself, while the DMA interrupt commits the full slot and
+   aims the third descriptor at a fresh one. The interrupt has one slot time
+   (HID_ADC_SLOT_SAMPLES / HID_ADC_RATE) to do so. When the channel queue
+   has no free slot the results go to a scratch buffer and the slot counts
+   as dropped. Payload layout (little endian):
+     byte 0..3  : slot sequence number, a gap shows dropped slots
+     byte 4..   : HID_ADC_SLOT_SAMPLES raw ADC global data register words,
+                  ADC_DR_RESULT() gives the 10 bit result and
+                  ADC_DR_OVERRUN() flags results lost before it
+ */
+#define HID_ADC_HDR_BYTES           4
+#define HID_ADC_SLOT_SAMPLES        ((HID_CHAN_PAYLOAD_BYTES - HID_ADC_HDR_BYTES) / 4)
+#define HID_ADC_REPORT_BYTES        (HID_ADC_HDR_BYTES + (4 * HID_ADC_SLOT_SAMPLES))
+
+/**
+ * @brief ADC stream counters
+ */
+typedef struct {
+	uint32_t slots;			/*!< Slots committed to the IN queue */
+	uint32_t dropped;		/*!< Slots filled into the scratch buffer or lost to a bus reset */
+	uint32_t overruns;		/*!< Committed results flagged with ADC_DR_OVERRUN() */
+	uint32_t errors;		/*!< GPDMA errors, the stream stops on an error */
+} HID_Adc_Stats_T;
+
+/**
+ * @brief	Set up and start the ADC stream.
+ * @param	hUsb	: Handle to USB device stack of the port the reports go to
+ * @param	chan	: Logical channel the reports are sent on
+ * @return	LPC_OK, or ERR_FAILED when no GPDMA channel is free
+ * @note	The channel is owned by the stream from now on, two of its slots
+ *			stay handed out to the DMA. The GPDMA interrupt runs at the
+ *			priority of the USB interrupts so neither preempts the other.
+ *			While the device is not configured or a benchmark runs the
+ *			results go to the scratch buffer.
+ */
+ErrorCode_t hid_adc_init(USBD_HANDLE_T hUsb, uint32_t chan);
+
+/**
+ * @brief	Get the ADC stream counters.
+ * @return	Pointer to the counters, updated from the GPDMA interrupt
+ */
+const HID_Adc_Stats_T *hid_adc_get_stats(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_ADC_H_ */
@@ -0,0 +1,196 @@
+/*
+ * @brief Throughput and latency benchmark modes used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <stdint.h>
+#include <string.h>
+#include "stopwatch.h"
+#include "hid_generic.h"
+#include "hid_bench.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#if HID_BENCH_PROBE_BYTES > HID_CHAN_PAYLOAD_BYTES
+#error "HID_Generic: the latency probe answer must fit one report"
+#endif
+
+/**
+ * @brief Structure to hold benchmark state and counters
+ */
+typedef struct {
+	USBD_HANDLE_T hUsb;		/*!< Port the benchmark was started on */
+	volatile uint8_t mode;	/*!< Active benchmark mode, HID_BENCH_MODE_xxx */
+	uint32_t tx_seq;		/*!< Sequence number of next IN report */
+	volatile uint32_t rx_count;	/*!< OUT reports received */
+	volatile uint32_t rx_lost;	/*!< OUT reports missing from the sequence */
+	uint32_t rx_seq;		/*!< Sequence number expected in next OUT report */
+} HID_Bench_Ctrl_T;
+
+static HID_Bench_Ctrl_T g_bench;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static uint32_t rd_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static void wr_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t) val;
+	p[1] = (uint8_t) (val >> 8);
+	p[2] = (uint8_t) (val >> 16);
+	p[3] = (uint8_t) (val >> 24);
+}
+
+/* Answer a probe OUT report with its arrival and the answer's queue time */
+static void bench_probe(HID_Bench_Ctrl_T *pBench, const uint8_t *pReport)
+{
+	uint16_t frame;
+	uint32_t arrival = hid_generic_out_stamp(pBench->hUsb, &frame);
+	uint8_t *buf = hid_generic_slot_get(pBench->hUsb, HID_CHAN_CONTROL);
+
+	if (buf == NULL) {
+		pBench->rx_lost++;
+		return;
+	}
+	memcpy(buf, &pReport[1], HID_BENCH_SEQ_BYTES);
+	wr_le32(&buf[4], arrival);
+	buf[12] = (uint8_t) frame;
+	buf[13] = (uint8_t) (frame >> 8);
+	wr_le32(&buf[16], StopWatch_TicksPerSecond());
+	/* last, as close to the commit as possible */
+	frame = hid_generic_frame_index(pBench->hUsb);
+	buf[14] = (uint8_t) frame;
+	buf[15] = (uint8_t) (frame >> 8);
+	wr_le32(&buf[8], StopWatch_Start());
+	hid_generic_slot_commit(pBench->hUsb, HID_CHAN_CONTROL, HID_BENCH_PROBE_BYTES);
+	pBench->tx_seq++;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Benchmark work done from main loop */
+void hid_bench_task(void)
+{
+	HID_Bench_Ctrl_T *pBench = &g_bench;
+	uint8_t *buf;
+
+	if (pBench->mode != HID_BENCH_MODE_IN) {
+		return;
+	}
+	/* keep the telemetry queue full so every interval carries a report, the
+	   sequence number is written straight into the USB RAM slot */
+	while ((buf = hid_generic_slot_get(pBench->hUsb, HID_CHAN_TELEMETRY)) != NULL) {
+		wr_le32(buf, pBench->tx_seq);
+		if (hid_generic_slot_commit(pBench->hUsb, HID_CHAN_TELEMETRY, HID_CHAN_PAYLOAD_BYTES) != LPC_OK) {
+			break;
+		}
+		pBench->tx_seq++;
+	}
+}
+
+/* Check if a benchmark is running */
+uint32_t hid_bench_active(USBD_HANDLE_T hUsb)
+{
+	return (g_bench.mode != HID_BENCH_MODE_OFF) && (g_bench.hUsb == hUsb);
+}
+
+/* OUT report hook, called for every OUT report taken from the receive queue */
+uint32_t hid_bench_out(USBD_HANDLE_T hUsb, const uint8_t *pReport, uint32_t len)
+{
+	HID_Bench_Ctrl_T *pBench = &g_bench;
+	uint32_t seq;
+
+	if ((pBench->mode == HID_BENCH_MODE_PROBE) && (pBench->hUsb == hUsb) &&
+		(len >= (1 + HID_BENCH_SEQ_BYTES)) && (pReport[0] == HID_CHAN_REPORT_ID(HID_CHAN_CONTROL))) {
+		pBench->rx_count++;
+		bench_probe(pBench, pReport);
+		return 1;
+	}
+	if ((pBench->mode != HID_BENCH_MODE_OUT) || (pBench->hUsb != hUsb) ||
+		(len < (1 + HID_BENCH_SEQ_BYTES))) {
+		/* ping-pong relies on the normal loopback path */
+		return 0;
+	}
+	seq = rd_le32(&pReport[1]);
+	/* a sequence number from the past means the host restarted, resync */
+	if ((int32_t) (seq - pBench->rx_seq) > 0) {
+		pBench->rx_lost += seq - pBench->rx_seq;
+	}
+	pBench->rx_seq = seq + 1;
+	pBench->rx_count++;
+	return 1;
+}
+
+/* Build benchmark feature report */
+uint16_t hid_bench_get_report(uint8_t *pReport)
+{
+	HID_Bench_Ctrl_T *pBench = &g_bench;
+
+	pReport[0] = HID_REPORT_ID_BENCH;
+	pReport[1] = pBench->mode;
+	pReport[2] = 0;
+	pReport[3] = 0;
+	wr_le32(&pReport[4], pBench->tx_seq);
+	wr_le32(&pReport[8], pBench->rx_count);
+	wr_le32(&pReport[12], pBench->rx_lost);
+	return HID_BENCH_REPORT_BYTES;
+}
+
+/* Select benchmark mode */
+ErrorCode_t hid_bench_set_report(USBD_HANDLE_T hUsb, const uint8_t *pReport, uint16_t length)
+{
+	HID_Bench_Ctrl_T *pBench = &g_bench;
+
+	if ((length < 2) || (pReport[0] != HID_REPORT_ID_BENCH) ||
+		(pReport[1] > HID_BENCH_MODE_PROBE)) {
+		return ERR_USBD_STALL;
+	}
+	pBench->tx_seq = 0;
+	pBench->rx_count = 0;
+	pBench->rx_lost = 0;
+	pBench->rx_seq = 0;
+	pBench->hUsb = hUsb;
+	pBench->mode = pReport[1];
+	return LPC_OK;
+}
@@ -0,0 +1,134 @@
+/*
+ * @brief Throughput and latency benchmark modes used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_BENCH_H_
+#define __HID_BENCH_H_
+
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* Benchmark modes, selected by host with SET_REPORT(Feature, HID_REPORT_ID_BENCH) */
+#define HID_BENCH_MODE_OFF          0	/* normal operation: telemetry and loopback */
+#define HID_BENCH_MODE_IN           1	/* device streams sequence numbered IN reports */
+#define HID_BENCH_MODE_OUT          2	/* device sinks OUT reports and checks sequence */
+#define HID_BENCH_MODE_PINGPONG     3	/* OUT reports are echoed, host uses HID_CHAN_CONTROL */
+#define HID_BENCH_MODE_PROBE        4	/* OUT reports are answered with device timestamps */
+
+/* Benchmark reports carry a 32 bit little endian sequence number in the
+   first payload bytes, right after the report ID. */
+#define HID_BENCH_SEQ_BYTES         4
+
+/* In HID_BENCH_MODE_PROBE every OUT report of HID_CHAN_CONTROL is answered
+   on the same channel with (little endian):
+     byte 0..3  : sequence number of the OUT report
+     byte 4..7  : StopWatch ticks when the OUT report completed, taken in
+                  the OUT endpoint interrupt
+     byte 8..11 : StopWatch ticks when the answer was queued
+     byte 12..13: frame index (FRINDEX) when the OUT report completed
+     byte 14..15: frame index when the answer was queued
+     byte 16..19: StopWatch ticks per second
+   With its own send and receive times the host can split the round trip
+   into host to device, device and device to host legs.
+ */
+#define HID_BENCH_PROBE_BYTES       20
+
+/* Layout of the benchmark feature report:
+     byte 0     : HID_REPORT_ID_BENCH
+     byte 1     : mode, HID_BENCH_MODE_xxx
+     byte 2..3  : reserved
+     byte 4..7  : IN reports queued by device (GET only)
+     byte 8..11 : OUT reports received by device (GET only)
+     byte 12..15: OUT reports detected lost from sequence gaps (GET only)
+   Writing the report selects the mode and clears all counters. The benchmark
+   runs on the port the report was written on, one port at a time.
+   HID_BENCH_REPORT_BYTES is defined in app_usbd_cfg.h for the descriptor.
+ */
+
+/**
+ * @brief	Run benchmark work from the main loop.
+ * @return	Nothing
+ * @note	In HID_BENCH_MODE_IN it fills every free telemetry slot with a
+ *			sequence numbered report.
+ */
+void hid_bench_task(void);
+
+/**
+ * @brief	Check whether a benchmark mode is active on a port.
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @return	Non-zero when a benchmark is running on the port and application
+ *			traffic should stay off its interrupt endpoints.
+ */
+uint32_t hid_bench_active(USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Offer a received OUT report to the benchmark.
+ * @param	hUsb	: Handle to USB device stack of the port it came from
+ * @param	pReport	: Pointer to OUT report including report ID
+ * @param	len		: Length of the report
+ * @return	Non-zero when the benchmark consumed the report, zero when it
+ *			should be handled (looped back) as usual.
+ */
+uint32_t hid_bench_out(USBD_HANDLE_T hUsb, const uint8_t *pReport, uint32_t len);
+
+/**
+ * @brief	Handle GET_REPORT(Feature) for HID_REPORT_ID_BENCH.
+ * @param	pReport	: Pointer to report buffer to fill
+ * @return	Length of the report written to @a pReport.
+ */
+uint16_t hid_bench_get_report(uint8_t *pReport);
+
+/**
+ * @brief	Handle SET_REPORT(Feature) for HID_REPORT_ID_BENCH.
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @param	pReport	: Pointer to report received in the data stage
+ * @param	length	: Length of the received report
+ * @return	LPC_OK when the mode was accepted, else ERR_USBD_STALL.
+ */
+ErrorCode_t hid_bench_set_report(USBD_HANDLE_T hUsb, const uint8_t *pReport, uint16_t length);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_BENCH_H_ */
@@ -0,0 +1,223 @@
+/*
+ * @brief Chunked feature report transfer used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <stdint.h>
+#include <string.h>
+#include "hid_blob.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/**
+ * @brief Structure to hold state of the blob transfers in both directions
+ */
+typedef struct {
+	uint8_t *rx_buf;	/*!< Application buffer receiving the blob */
+	uint32_t rx_size;	/*!< Size of application buffer */
+	volatile uint32_t rx_count;	/*!< Highest byte offset written so far */
+	volatile uint32_t rx_done;	/*!< Blob size once the last chunk arrived */
+	uint8_t rx_seq;		/*!< Sequence number expected next */
+	uint8_t rx_active;	/*!< Flag indicating a START chunk was received */
+
+	const uint8_t *tx_buf;	/*!< Application buffer with blob for host */
+	uint32_t tx_size;	/*!< Size of the blob for host */
+	uint32_t tx_offset;	/*!< Read offset of next GET_REPORT */
+	volatile uint32_t tx_done;	/*!< Flag indicating host read the last chunk */
+	uint8_t tx_seq;		/*!< Sequence number of next chunk for host */
+} HID_Blob_Ctrl_T;
+
+static HID_Blob_Ctrl_T g_blob;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static uint32_t rd_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static void wr_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t) val;
+	p[1] = (uint8_t) (val >> 8);
+	p[2] = (uint8_t) (val >> 16);
+	p[3] = (uint8_t) (val >> 24);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Offer application buffer for next blob from host */
+ErrorCode_t hid_blob_recv_req(uint8_t *pBuf, uint32_t buf_len)
+{
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	g_blob.rx_buf = pBuf;
+	g_blob.rx_size = buf_len;
+	g_blob.rx_count = 0;
+	g_blob.rx_done = 0;
+	g_blob.rx_active = 0;
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return LPC_OK;
+}
+
+/* Size of completely received blob */
+uint32_t hid_blob_recv_cnt(void)
+{
+	return g_blob.rx_done;
+}
+
+/* Offer application blob to be read by host */
+ErrorCode_t hid_blob_send_req(const uint8_t *pBuf, uint32_t len)
+{
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	g_blob.tx_buf = pBuf;
+	g_blob.tx_size = len;
+	g_blob.tx_offset = 0;
+	g_blob.tx_seq = 0;
+	g_blob.tx_done = 0;
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return LPC_OK;
+}
+
+/* Check if host read the whole blob */
+uint32_t hid_blob_send_done(void)
+{
+	return g_blob.tx_done;
+}
+
+/* Build next chunk for GET_REPORT(Feature) */
+uint16_t hid_blob_get_report(uint8_t *pReport)
+{
+	HID_Blob_Ctrl_T *pBlob = &g_blob;
+	uint32_t cnt = 0;
+	uint8_t flags = 0;
+
+	if (pBlob->tx_buf == NULL) {
+		flags = HID_BLOB_FLAG_ERROR;
+	}
+	else {
+		if (pBlob->tx_offset == 0) {
+			flags |= HID_BLOB_FLAG_START;
+		}
+		cnt = MIN(pBlob->tx_size - pBlob->tx_offset, HID_BLOB_CHUNK_BYTES);
+		memcpy(&pReport[HID_BLOB_HDR_SIZE], pBlob->tx_buf + pBlob->tx_offset, cnt);
+		if ((pBlob->tx_offset + cnt) >= pBlob->tx_size) {
+			flags |= HID_BLOB_FLAG_END;
+			pBlob->tx_done = 1;
+		}
+	}
+
+	pReport[0] = HID_REPORT_ID_BLOB;
+	pReport[1] = flags;
+	pReport[2] = pBlob->tx_seq++;
+	pReport[3] = (uint8_t) cnt;
+	wr_le32(&pReport[4], pBlob->tx_offset);
+	pBlob->tx_offset += cnt;
+
+	/* Feature reports have fixed size, clear the unused tail */
+	memset(&pReport[HID_BLOB_HDR_SIZE + cnt], 0, HID_BLOB_CHUNK_BYTES - cnt);
+	return HID_FEATURE_REPORT_BYTES;
+}
+
+/* Store chunk received by SET_REPORT(Feature) */
+ErrorCode_t hid_blob_set_report(const uint8_t *pReport, uint16_t length)
+{
+	HID_Blob_Ctrl_T *pBlob = &g_blob;
+	uint8_t flags, seq;
+	uint32_t cnt, offset;
+
+	if ((length < HID_BLOB_HDR_SIZE) || (pReport[0] != HID_REPORT_ID_BLOB)) {
+		return ERR_USBD_STALL;
+	}
+	flags = pReport[1];
+	seq = pReport[2];
+	cnt = pReport[3];
+	offset = rd_le32(&pReport[4]);
+
+	if (flags & HID_BLOB_FLAG_SEEK) {
+		/* host wants to (re)read from a given offset */
+		if ((pBlob->tx_buf == NULL) || (offset > pBlob->tx_size)) {
+			return ERR_USBD_STALL;
+		}
+		pBlob->tx_offset = offset;
+		pBlob->tx_seq = seq;
+		pBlob->tx_done = 0;
+		return LPC_OK;
+	}
+
+	if (flags & HID_BLOB_FLAG_START) {
+		pBlob->rx_active = 1;
+		pBlob->rx_count = 0;
+		pBlob->rx_done = 0;
+		pBlob->rx_seq = seq;
+	}
+	/* A repeated chunk (host retry after a lost status stage) is accepted
+	   again, any other sequence gap aborts the transfer. */
+	if ((pBlob->rx_active == 0) || (pBlob->rx_buf == NULL) || (pBlob->rx_done != 0) ||
+		((seq != pBlob->rx_seq) && (seq != (uint8_t) (pBlob->rx_seq - 1)))) {
+		pBlob->rx_active = 0;
+		return ERR_USBD_STALL;
+	}
+	if ((cnt > (uint32_t) (length - HID_BLOB_HDR_SIZE)) || (cnt > HID_BLOB_CHUNK_BYTES) ||
+		(offset > pBlob->rx_size) || (cnt > (pBlob->rx_size - offset))) {
+		pBlob->rx_active = 0;
+		return ERR_USBD_STALL;
+	}
+
+	/* payload goes straight to its place in the application buffer */
+	memcpy(pBlob->rx_buf + offset, &pReport[HID_BLOB_HDR_SIZE], cnt);
+	if ((offset + cnt) > pBlob->rx_count) {
+		pBlob->rx_count = offset + cnt;
+	}
+	if (seq == pBlob->rx_seq) {
+		pBlob->rx_seq++;
+	}
+	if (flags & HID_BLOB_FLAG_END) {
+		pBlob->rx_active = 0;
+		pBlob->rx_done = pBlob->rx_count;
+	}
+	return LPC_OK;
+}
@@ -0,0 +1,116 @@
+/*
+ * @brief Chunked feature report transfer used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_BLOB_H_
+#define __HID_BLOB_H_
+
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* Layout of a blob feature report. Every chunk carries its own header so the
+   host can stream configuration blobs of any size over EP0:
+     byte 0     : HID_REPORT_ID_BLOB
+     byte 1     : flags, HID_BLOB_FLAG_xxx
+     byte 2     : sequence number, incremented for every chunk
+     byte 3     : number of payload bytes in this chunk
+     byte 4..7  : offset of the payload within the blob, little endian
+     byte 8..   : payload
+ */
+#define HID_BLOB_HDR_SIZE           8
+#define HID_BLOB_CHUNK_BYTES        (HID_FEATURE_REPORT_BYTES - HID_BLOB_HDR_SIZE)
+
+#define HID_BLOB_FLAG_START         _BIT(0)		/* first chunk, restarts the transfer */
+#define HID_BLOB_FLAG_END           _BIT(1)		/* last chunk of the blob */
+#define HID_BLOB_FLAG_SEEK          _BIT(2)		/* SET only: move the read offset, no payload */
+#define HID_BLOB_FLAG_ERROR         _BIT(7)		/* GET only: no blob was offered by application */
+
+/**
+ * @brief	Offer an application buffer to receive the next blob written by host.
+ * @param	pBuf	: Pointer to destination buffer, written in place by SET_REPORT
+ * @param	buf_len	: Size of the destination buffer
+ * @return	Always returns LPC_OK.
+ */
+ErrorCode_t hid_blob_recv_req(uint8_t *pBuf, uint32_t buf_len);
+
+/**
+ * @brief	Gets size of the received blob.
+ * @return	Total number of bytes once the host sent the chunk flagged
+ *			HID_BLOB_FLAG_END, else 0.
+ */
+uint32_t hid_blob_recv_cnt(void);
+
+/**
+ * @brief	Offer an application buffer holding a blob to be read by host.
+ * @param	pBuf	: Pointer to blob data, must stay valid until read
+ * @param	len		: Size of the blob
+ * @return	Always returns LPC_OK.
+ */
+ErrorCode_t hid_blob_send_req(const uint8_t *pBuf, uint32_t len);
+
+/**
+ * @brief	Check whether the host has read the whole blob.
+ * @return	Non-zero once the chunk flagged HID_BLOB_FLAG_END was read.
+ */
+uint32_t hid_blob_send_done(void);
+
+/**
+ * @brief	Handle GET_REPORT(Feature) for HID_REPORT_ID_BLOB.
+ * @param	pReport	: Pointer to USB RAM report buffer to fill
+ * @return	Length of the report written to @a pReport.
+ */
+uint16_t hid_blob_get_report(uint8_t *pReport);
+
+/**
+ * @brief	Handle SET_REPORT(Feature) for HID_REPORT_ID_BLOB.
+ * @param	pReport	: Pointer to report received in the data stage
+ * @param	length	: Length of the received report
+ * @return	LPC_OK when the chunk was accepted, else ERR_USBD_STALL.
+ */
+ErrorCode_t hid_blob_set_report(const uint8_t *pReport, uint16_t length);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_BLOB_H_ */
@@ -0,0 +1,335 @@
+/*
+ * @brief Vendor bulk interface of the composite HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <stdint.h>
+#include <string.h>
+#include "app_usbd_cfg.h"
+#include "usbd_descidx.h"
+#include "hid_bulk.h"
+
+#ifdef HID_VENDOR_BULK
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define HID_BULK_IN_QUEUE_MASK   (HID_BULK_IN_QUEUE_DEPTH - 1)
+#define HID_BULK_OUT_QUEUE_MASK  (HID_BULK_OUT_QUEUE_DEPTH - 1)
+
+/* Index of an endpoint in the USBD ROM endpoint handler table */
+#define HID_BULK_EP_INDEX(ep_adr)   ((((ep_adr) & 0x0F) << 1) + (((ep_adr) & 0x80) ? 1 : 0))
+
+/**
+ * @brief Structure to hold the bulk transfer queues
+ */
+typedef struct {
+	USBD_HANDLE_T hUsb;	/*!< Handle to USB stack. */
+	uint8_t *in_buf[HID_BULK_IN_QUEUE_DEPTH];	/*!< IN transfer buffers in USB RAM */
+	uint16_t in_len[HID_BULK_IN_QUEUE_DEPTH];	/*!< Length of each queued IN transfer */
+	volatile uint32_t in_head;	/*!< Producer index, next free IN buffer */
+	volatile uint32_t in_tail;	/*!< Consumer index, oldest queued IN buffer */
+	uint8_t in_reserved;	/*!< Flag indicating the head IN buffer is handed out for filling */
+	volatile uint8_t in_busy;	/*!< Flag indicating a transfer is pending on the IN endpoint */
+	uint8_t in_zlp;		/*!< Flag indicating the pending IN transfer is a zero length packet */
+	uint8_t *out_buf[HID_BULK_OUT_QUEUE_DEPTH];	/*!< OUT transfer buffers in USB RAM */
+	uint16_t out_len[HID_BULK_OUT_QUEUE_DEPTH];	/*!< Bytes received in each OUT buffer */
+	volatile uint32_t out_head;	/*!< Producer index, OUT buffer being received */
+	volatile uint32_t out_tail;	/*!< Consumer index, oldest received OUT buffer */
+	volatile uint8_t out_busy;	/*!< Flag indicating a read is pending on the OUT endpoint */
+} HID_Bulk_Ctrl_T;
+
+static HID_Bulk_Ctrl_T g_bulk;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Drop all queued transfers */
+static void Bulk_Flush(HID_Bulk_Ctrl_T *pBulk)
+{
+	pBulk->in_head = pBulk->in_tail = 0;
+	pBulk->in_reserved = 0;
+	pBulk->in_busy = 0;
+	pBulk->in_zlp = 0;
+	pBulk->out_head = pBulk->out_tail = 0;
+	pBulk->out_busy = 0;
+}
+
+/* Start the oldest queued IN transfer if the endpoint is idle.
+   Must be called from USB ISR context or with USB interrupt disabled. */
+static void Bulk_ArmIn(HID_Bulk_Ctrl_T *pBulk)
+{
+	uint32_t idx;
+
+	if (pBulk->in_busy || (pBulk->in_head == pBulk->in_tail)) {
+		return;
+	}
+	idx = pBulk->in_tail & HID_BULK_IN_QUEUE_MASK;
+	pBulk->in_busy = 1;
+	USBD_API->hw->WriteEP(pBulk->hUsb, HID_BULK_EP_IN, pBulk->in_buf[idx], pBulk->in_len[idx]);
+}
+
+/* Queue a read into the next free OUT buffer if the endpoint is idle.
+   Must be called from USB ISR context or with USB interrupt disabled. */
+static void Bulk_ArmOut(HID_Bulk_Ctrl_T *pBulk)
+{
+	if (pBulk->out_busy || ((pBulk->out_head - pBulk->out_tail) >= HID_BULK_OUT_QUEUE_DEPTH)) {
+		return;
+	}
+	pBulk->out_busy = 1;
+	USBD_API->hw->ReadReqEP(pBulk->hUsb, HID_BULK_EP_OUT,
+							pBulk->out_buf[pBulk->out_head & HID_BULK_OUT_QUEUE_MASK], HID_BULK_XFER_BYTES);
+}
+
+/* USB bulk EP_IN endpoint handler */
+static ErrorCode_t Bulk_IN_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
+{
+	HID_Bulk_Ctrl_T *pBulk = (HID_Bulk_Ctrl_T *) data;
+	uint32_t len, maxp;
+
+	if (event == USB_EVT_IN) {
+		pBulk->in_busy = 0;
+		if (pBulk->in_zlp) {
+			pBulk->in_zlp = 0;
+		}
+		else {
+			len = pBulk->in_len[pBulk->in_tail & HID_BULK_IN_QUEUE_MASK];
+			pBulk->in_tail++;
+			/* a short transfer ending on a packet boundary needs a zero length
+			   packet to end the host's read */
+			maxp = UsbDescIdx_GetMaxPacket(hUsb, HID_BULK_EP_IN);
+			if ((len < HID_BULK_XFER_BYTES) && ((len % maxp) == 0)) {
+				pBulk->in_zlp = 1;
+				pBulk->in_busy = 1;
+				USBD_API->hw->WriteEP(hUsb, HID_BULK_EP_IN, pBulk->in_buf[0], 0);
+				return LPC_OK;
+			}
+		}
+		Bulk_ArmIn(pBulk);
+	}
+	return LPC_OK;
+}
+
+/* USB bulk EP_OUT endpoint handler */
+static ErrorCode_t Bulk_OUT_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
+{
+	HID_Bulk_Ctrl_T *pBulk = (HID_Bulk_Ctrl_T *) data;
+	uint32_t idx;
+
+	/* A transfer ends on a short packet or when the buffer is full */
+	if (event == USB_EVT_OUT) {
+		idx = pBulk->out_head & HID_BULK_OUT_QUEUE_MASK;
+		pBulk->out_len[idx] = (uint16_t) USBD_API->hw->ReadEP(hUsb, HID_BULK_EP_OUT, pBulk->out_buf[idx]);
+		pBulk->out_head++;
+		pBulk->out_busy = 0;
+		Bulk_ArmOut(pBulk);
+	}
+	return LPC_OK;
+}
+
+/* Handler for WCID USB device requests. */
+static ErrorCode_t WCID_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
+{
+	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;
+	ErrorCode_t ret = ERR_USBD_UNHANDLED;
+
+	if (event == USB_EVT_SETUP) {
+		switch (pCtrl->SetupPacket.bmRequestType.BM.Type) {
+		case REQUEST_STANDARD:
+			if ((pCtrl->SetupPacket.bmRequestType.BM.Recipient == REQUEST_TO_DEVICE) &&
+				(pCtrl->SetupPacket.bRequest == USB_REQUEST_GET_DESCRIPTOR) &&
+				(pCtrl->SetupPacket.wValue.WB.H == USB_STRING_DESCRIPTOR_TYPE) &&
+				(pCtrl->SetupPacket.wValue.WB.L == 0x00EE)) {
+				pCtrl->EP0Data.pData = (uint8_t *) WCID_String_Descriptor;
+				pCtrl->EP0Data.Count = MIN(pCtrl->SetupPacket.wLength, WCID_String_Descriptor[0]);
+				USBD_API->core->DataInStage(pCtrl);
+				ret = LPC_OK;
+			}
+			break;
+
+		case REQUEST_VENDOR:
+			if ((pCtrl->SetupPacket.bRequest == HID_WCID_VENDOR_CODE) &&
+				(pCtrl->SetupPacket.bmRequestType.BM.Recipient == REQUEST_TO_DEVICE) &&
+				(pCtrl->SetupPacket.wIndex.W == 0x0004)) {
+				pCtrl->EP0Data.pData = (uint8_t *) WCID_CompatID_Descriptor;
+				pCtrl->EP0Data.Count = MIN(pCtrl->SetupPacket.wLength, WCID_CompatID_Descriptor[0]);
+				USBD_API->core->DataInStage(pCtrl);
+				ret = LPC_OK;
+			}
+			break;
+		}
+	}
+
+	return ret;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize the bulk interface */
+ErrorCode_t hid_bulk_init(USBD_HANDLE_T hUsb, USBMEM_T *pMem)
+{
+	HID_Bulk_Ctrl_T *pBulk = &g_bulk;
+	ErrorCode_t ret;
+	uint32_t i;
+
+	/* transfer buffers start on a word boundary, each one fits in one dTD */
+	for (i = 0; i < HID_BULK_IN_QUEUE_DEPTH; i++) {
+		pBulk->in_buf[i] = UsbMem_Alloc(pMem, HID_BULK_XFER_BYTES, 4);
+		if (pBulk->in_buf[i] == NULL) {
+			return ERR_FAILED;
+		}
+	}
+	for (i = 0; i < HID_BULK_OUT_QUEUE_DEPTH; i++) {
+		pBulk->out_buf[i] = UsbMem_Alloc(pMem, HID_BULK_XFER_BYTES, 4);
+		if (pBulk->out_buf[i] == NULL) {
+			return ERR_FAILED;
+		}
+	}
+	pBulk->hUsb = hUsb;
+	Bulk_Flush(pBulk);
+
+	/* register WCID handler */
+	ret = USBD_API->core->RegisterClassHandler(hUsb, WCID_hdlr, pBulk);
+	if (ret == LPC_OK) {
+		ret = USBD_API->core->RegisterEpHandler(hUsb, HID_BULK_EP_INDEX(HID_BULK_EP_OUT), Bulk_OUT_Hdlr, pBulk);
+	}
+	if (ret == LPC_OK) {
+		ret = USBD_API->core->RegisterEpHandler(hUsb, HID_BULK_EP_INDEX(HID_BULK_EP_IN), Bulk_IN_Hdlr, pBulk);
+	}
+	return ret;
+}
+
+/* USB Configure Event Callback */
+ErrorCode_t hid_bulk_configure_event(USBD_HANDLE_T hUsb)
+{
+	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;
+
+	/* endpoints were just (re)configured, nothing is pending on them anymore */
+	Bulk_Flush(&g_bulk);
+	if (pCtrl->config_value != 0) {
+		Bulk_ArmOut(&g_bulk);
+	}
+	return LPC_OK;
+}
+
+/* Hand out the next free IN buffer */
+uint8_t *hid_bulk_in_get(void)
+{
+	HID_Bulk_Ctrl_T *pBulk = &g_bulk;
+	uint8_t *pBuf = NULL;
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	if (pBulk->in_reserved) {
+		pBuf = pBulk->in_buf[pBulk->in_head & HID_BULK_IN_QUEUE_MASK];
+	}
+	else if (USB_IsConfigured(pBulk->hUsb) &&
+			 ((pBulk->in_head - pBulk->in_tail) < HID_BULK_IN_QUEUE_DEPTH)) {
+		pBulk->in_reserved = 1;
+		pBuf = pBulk->in_buf[pBulk->in_head & HID_BULK_IN_QUEUE_MASK];
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return pBuf;
+}
+
+/* Queue the filled IN buffer */
+ErrorCode_t hid_bulk_in_commit(uint32_t len)
+{
+	HID_Bulk_Ctrl_T *pBulk = &g_bulk;
+	ErrorCode_t ret = ERR_FAILED;
+
+	if ((len == 0) || (len > HID_BULK_XFER_BYTES)) {
+		return ERR_API_INVALID_PARAM1;
+	}
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	if (pBulk->in_reserved) {
+		pBulk->in_len[pBulk->in_head & HID_BULK_IN_QUEUE_MASK] = (uint16_t) len;
+		pBulk->in_head++;
+		pBulk->in_reserved = 0;
+		Bulk_ArmIn(pBulk);
+		ret = LPC_OK;
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return ret;
+}
+
+/* Get the oldest received OUT transfer */
+uint8_t *hid_bulk_out_get(uint32_t *pLen)
+{
+	HID_Bulk_Ctrl_T *pBulk = &g_bulk;
+	uint8_t *pBuf = NULL;
+	uint32_t idx;
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	if (pBulk->out_head != pBulk->out_tail) {
+		idx = pBulk->out_tail & HID_BULK_OUT_QUEUE_MASK;
+		*pLen = pBulk->out_len[idx];
+		pBuf = pBulk->out_buf[idx];
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return pBuf;
+}
+
+/* Give the oldest OUT buffer back to the endpoint */
+void hid_bulk_out_release(void)
+{
+	HID_Bulk_Ctrl_T *pBulk = &g_bulk;
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	if (pBulk->out_head != pBulk->out_tail) {
+		pBulk->out_tail++;
+		if (USB_IsConfigured(pBulk->hUsb)) {
+			Bulk_ArmOut(pBulk);
+		}
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+}
+
+#endif /* HID_VENDOR_BULK */
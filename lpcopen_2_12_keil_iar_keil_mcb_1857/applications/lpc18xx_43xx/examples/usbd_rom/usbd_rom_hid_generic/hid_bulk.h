@@ -0,0 +1,116 @@
+/*
+ * @brief Vendor bulk interface of the composite HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_BULK_H_
+#define __HID_BULK_H_
+
+#include "app_usbd_cfg.h"
+#include "usb_mem.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* Built with HID_VENDOR_BULK the device is a composite of the HID interface,
+   which keeps the low latency control path on its interrupt endpoints, and a
+   vendor class interface with a bulk endpoint pair for high throughput data.
+   Each direction has a queue of HID_BULK_XFER_BYTES buffers in USB RAM; the
+   completion event of one transfer arms the next queued one, so the endpoint
+   moves full 512 byte HS packets back to back while the application fills or
+   drains the other buffers. The WCID descriptors let Windows bind WinUSB to
+   the bulk interface, libusb and WinUSB host code can open it directly.
+ */
+
+/**
+ * @brief	Initialize the bulk interface and register its handlers.
+ * @param	hUsb	: Handle to USB device stack
+ * @param	pMem	: USB RAM arena the transfer buffers are taken from
+ * @return	LPC_OK on success, else ERR_FAILED or the USBD ROM error code.
+ */
+ErrorCode_t hid_bulk_init(USBD_HANDLE_T hUsb, USBMEM_T *pMem);
+
+/**
+ * @brief	Restart the bulk queues, call from the USB configure event.
+ * @param	hUsb	: Handle to USB device stack
+ * @return	LPC_OK
+ */
+ErrorCode_t hid_bulk_configure_event(USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Get the next free bulk IN buffer for in place filling.
+ * @return	Pointer to a HID_BULK_XFER_BYTES buffer in USB RAM, or NULL when
+ *			all buffers are queued or the device is not configured.
+ * @note	Until hid_bulk_in_commit() is called the same buffer is returned.
+ */
+uint8_t *hid_bulk_in_get(void);
+
+/**
+ * @brief	Queue the buffer obtained with hid_bulk_in_get().
+ * @param	len		: Number of bytes written, 1 to HID_BULK_XFER_BYTES
+ * @return	LPC_OK on success, ERR_API_INVALID_PARAM1 for a bad length and
+ *			ERR_FAILED when no buffer was handed out or the queue was
+ *			restarted meanwhile.
+ * @note	A transfer shorter than HID_BULK_XFER_BYTES that ends on a packet
+ *			boundary is followed by a zero length packet, so a host reading
+ *			HID_BULK_XFER_BYTES at a time sees every transfer end.
+ */
+ErrorCode_t hid_bulk_in_commit(uint32_t len);
+
+/**
+ * @brief	Get the oldest received bulk OUT transfer.
+ * @param	pLen	: Pointer to store the number of bytes received
+ * @return	Pointer to the received data in USB RAM, or NULL when none.
+ * @note	The buffer stays valid until hid_bulk_out_release() is called.
+ */
+uint8_t *hid_bulk_out_get(uint32_t *pLen);
+
+/**
+ * @brief	Give the buffer returned by hid_bulk_out_get() back to the OUT
+ *			queue.
+ * @return	Nothing
+ */
+void hid_bulk_out_release(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_BULK_H_ */
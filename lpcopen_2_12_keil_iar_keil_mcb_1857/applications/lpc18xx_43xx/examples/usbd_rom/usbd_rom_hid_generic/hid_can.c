@@ -0,0 +1,375 @@
+/*
+ * @brief C_CAN to HID bridge with batched frame reports
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "stopwatch.h"
+#include "hid_generic.h"
+#include "hid_bench.h"
+#include "hid_can.h"
+
+#ifdef HID_CAN_BRIDGE
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Message object sending the OUT frames, above the receive chain */
+#define CAN_TX_OBJ              CCAN_MSG_MAX_NUM
+
+/* Extended id flag of CCAN_MSG_OBJ_T */
+#define CAN_ID_EXT              (1UL << 30)
+
+typedef struct {
+	USBD_HANDLE_T hUsb;				/*!< Port the reports go to */
+	uint32_t chan;					/*!< Channel the frames are sent and received on */
+	uint8_t *pBuf;					/*!< Payload of the IN slot being filled, NULL if none */
+	uint32_t fill;					/*!< Payload bytes used in pBuf */
+	uint32_t frames;				/*!< Frames packed in pBuf */
+	uint32_t base;					/*!< Microsecond time of the first frame in pBuf */
+	uint32_t dropped;				/*!< Frames dropped since the last report */
+	uint32_t fifoLost;				/*!< FIFO overruns already counted as dropped */
+	uint32_t lastTicks;				/*!< StopWatch count the time base was updated at */
+	uint64_t ticks;					/*!< StopWatch ticks since hid_can_init() */
+	uint32_t errStat;				/*!< Error state bits of the last status interrupt */
+	volatile uint32_t txBusy;		/*!< CAN_TX_OBJ holds a frame not sent yet */
+	RINGBUFF_T txRb;				/*!< Frames waiting for CAN_TX_OBJ */
+	CCAN_FIFO_T fifo;				/*!< Receive chain, drained on message object interrupts */
+	CHIP_TWHEEL_TIMER_T deadline;	/*!< Deadline of the report being packed */
+	HID_Can_Stats_T stats;			/*!< Counters */
+} HID_Can_Ctrl_T;
+
+static HID_Can_Ctrl_T g_can;
+
+static CCAN_MSG_OBJ_T g_canRxBuf[HID_CAN_RB_SIZE];
+static CCAN_MSG_OBJ_T g_canTxBuf[HID_CAN_TX_RB_SIZE];
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Store a 16-bit value little endian */
+static void put_u16(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+}
+
+/* Store a 32-bit value little endian */
+static void put_u32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) (v >> 16);
+	p[3] = (uint8_t) (v >> 24);
+}
+
+/* Microseconds since hid_can_init(), called with interrupts masked. The
+   StopWatch counter wraps, so it is folded into a 64-bit tick count. */
+static uint32_t can_now_us(HID_Can_Ctrl_T *pCan)
+{
+	uint32_t now = StopWatch_Start();
+	uint32_t rate = StopWatch_TicksPerSecond();
+
+	pCan->ticks += (uint32_t) (now - pCan->lastTicks);
+	pCan->lastTicks = now;
+	return (uint32_t) ((pCan->ticks / rate) * 1000000) +
+		   (uint32_t) (((pCan->ticks % rate) * 1000000) / rate);
+}
+
+/* Hand the packed report to the channel queue, called with interrupts
+   masked or from the deadline callback */
+static void can_send(HID_Can_Ctrl_T *pCan)
+{
+	Chip_TWHEEL_Stop(&pCan->deadline);
+	if (pCan->pBuf != NULL) {
+		put_u16(&pCan->pBuf[4], pCan->frames);
+		put_u16(&pCan->pBuf[6], MIN(pCan->dropped, 0xFFFF));
+		pCan->dropped = 0;
+		/* the slot is not cleared, the frame count bounds the data */
+		if (hid_generic_slot_commit(pCan->hUsb, pCan->chan, pCan->fill) == LPC_OK) {
+			pCan->stats.reports++;
+		}
+		pCan->pBuf = NULL;
+		pCan->fill = 0;
+		pCan->frames = 0;
+	}
+}
+
+/* The deadline of the packed report expired, called from the RITimer
+   interrupt */
+static void can_expired(CHIP_TWHEEL_TIMER_T *pTimer)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();	/* enter critical section */
+	can_send((HID_Can_Ctrl_T *) pTimer->pArg);
+	__set_PRIMASK(primask);	/* exit critical section */
+}
+
+/* Pack a received frame, called with interrupts masked */
+static void can_put(HID_Can_Ctrl_T *pCan, const CCAN_MSG_OBJ_T *pMsg, uint32_t us)
+{
+	uint32_t dlc = MIN(pMsg->dlc, 8);
+	uint8_t *p;
+
+	/* the frame does not fit, or is too late for the 16 bit offset */
+	if ((pCan->pBuf != NULL) &&
+		(((pCan->fill + HID_CAN_REC_HDR_BYTES + dlc) > HID_CHAN_PAYLOAD_BYTES) ||
+		 ((us - pCan->base) > 0xFFFF))) {
+		can_send(pCan);
+	}
+	if (pCan->pBuf == NULL) {
+		/* while a benchmark runs it owns the channel */
+		if (!hid_bench_active(pCan->hUsb)) {
+			pCan->pBuf = hid_generic_slot_get(pCan->hUsb, pCan->chan);
+		}
+		if (pCan->pBuf == NULL) {
+			pCan->dropped++;
+			pCan->stats.rxDropped++;
+			return;
+		}
+		pCan->base = us;
+		put_u32(&pCan->pBuf[0], us);
+		pCan->fill = HID_CAN_HDR_BYTES;
+		Chip_TWHEEL_Start(&pCan->deadline, Chip_TWHEEL_UsToTicks(HID_CAN_DEADLINE_US), 0);
+	}
+
+	p = &pCan->pBuf[pCan->fill];
+	put_u16(&p[0], us - pCan->base);
+	put_u32(&p[2], pMsg->id);
+	p[6] = (uint8_t) dlc;
+	memcpy(&p[7], pMsg->data, dlc);
+	pCan->fill += HID_CAN_REC_HDR_BYTES + dlc;
+	pCan->frames++;
+	pCan->stats.rxFrames++;
+
+	/* no room for even a frame without data, don't wait for the deadline */
+	if ((pCan->fill + HID_CAN_REC_HDR_BYTES) > HID_CHAN_PAYLOAD_BYTES) {
+		can_send(pCan);
+	}
+}
+
+/* Pack the frames the receive chain was drained into. Frames drained by
+   one interrupt share its time stamp, at 1 Mbit/s that is normally a
+   single frame. */
+static void can_drain(HID_Can_Ctrl_T *pCan)
+{
+	CCAN_MSG_OBJ_T msg;
+	uint32_t us, lost, primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();	/* enter critical section */
+	us = can_now_us(pCan);
+	while (Chip_CCAN_FIFO_Read(&pCan->fifo, &msg)) {
+		can_put(pCan, &msg, us);
+	}
+	lost = pCan->fifo.hwOverruns + pCan->fifo.rbOverruns;
+	pCan->dropped += lost - pCan->fifoLost;
+	pCan->stats.rxDropped += lost - pCan->fifoLost;
+	pCan->fifoLost = lost;
+	__set_PRIMASK(primask);	/* exit critical section */
+}
+
+/* Load the next queued frame into the send object, called from the CAN
+   interrupt or with it masked */
+static void can_tx_next(HID_Can_Ctrl_T *pCan)
+{
+	CCAN_MSG_OBJ_T msg;
+
+	if (RingBuffer_Pop(&pCan->txRb, &msg)) {
+		Chip_CCAN_SetMsgObject(LPC_C_CAN0, CCAN_MSG_IF1, CCAN_TX_DIR, false, CAN_TX_OBJ, &msg);
+		pCan->txBusy = 1;
+	}
+	else {
+		pCan->txBusy = 0;
+	}
+}
+
+/* Count the error state changes, restart the controller after bus off */
+static void can_status(HID_Can_Ctrl_T *pCan)
+{
+	uint32_t stat = Chip_CCAN_GetStatus(LPC_C_CAN0);
+	uint32_t rise = stat & ~pCan->errStat;
+
+	if (rise & CCAN_STAT_EPASS) {
+		pCan->stats.errPassive++;
+	}
+	if (rise & CCAN_STAT_BOFF) {
+		pCan->stats.busOff++;
+		/* the controller set INIT, it joins the bus again once it has
+		   seen 128 times 11 recessive bits */
+		LPC_C_CAN0->CNTL &= ~CCAN_CTRL_INIT;
+	}
+	pCan->errStat = stat & (CCAN_STAT_EPASS | CCAN_STAT_BOFF);
+	Chip_CCAN_ClearStatus(LPC_C_CAN0, CCAN_STAT_TXOK | CCAN_STAT_RXOK);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Handle interrupt from C_CAN0
+ * @return	Nothing
+ */
+HOTFUNC void CAN0_IRQHandler(void)
+{
+	HID_Can_Ctrl_T *pCan = &g_can;
+	uint32_t intId;
+
+	while ((intId = Chip_CCAN_GetIntID(LPC_C_CAN0)) != 0) {
+		if (intId & CCAN_INT_STATUS) {
+			can_status(pCan);
+		}
+		else if (Chip_CCAN_FIFO_IRQHandler(&pCan->fifo, CCAN_INT_MSG_NUM(intId))) {
+			can_drain(pCan);
+		}
+		else {
+			Chip_CCAN_ClearMsgIntPend(LPC_C_CAN0, CCAN_MSG_IF1, CCAN_INT_MSG_NUM(intId), CCAN_TX_DIR);
+			if (CCAN_INT_MSG_NUM(intId) == CAN_TX_OBJ) {
+				pCan->stats.txFrames++;
+				can_tx_next(pCan);
+			}
+		}
+	}
+}
+
+/* Set up C_CAN0 and start bridging */
+ErrorCode_t hid_can_init(USBD_HANDLE_T hUsb, uint32_t chan)
+{
+	HID_Can_Ctrl_T *pCan = &g_can;
+
+	memset(pCan, 0, sizeof(*pCan));
+	pCan->hUsb = hUsb;
+	pCan->chan = chan;
+	pCan->lastTicks = StopWatch_Start();
+	RingBuffer_Init(&pCan->txRb, g_canTxBuf, sizeof(CCAN_MSG_OBJ_T), HID_CAN_TX_RB_SIZE);
+	Chip_TWHEEL_Setup(&pCan->deadline, can_expired, pCan, 0);
+
+	Chip_Clock_SetBaseClock(CLK_BASE_APB3, CLKIN_IDIVC, true, false);
+	Chip_CCAN_Init(LPC_C_CAN0);
+	Chip_CCAN_SetBitRate(LPC_C_CAN0, HID_CAN_BITRATE);
+
+	/* One chain takes every standard and extended id, a zero mask with the
+	   extended bit not compared */
+	Chip_CCAN_FIFO_Init(LPC_C_CAN0, &pCan->fifo, CCAN_MSG_IF2, g_canRxBuf, HID_CAN_RB_SIZE);
+	if (Chip_CCAN_FIFO_AddGroup(&pCan->fifo, CCAN_MSG_IF1, 0, 0, HID_CAN_RX_OBJS) == 0) {
+		return ERR_FAILED;
+	}
+
+	/* No status change interrupts, they would come with every frame. The
+	   error interrupt reports the error passive and bus off changes. */
+	Chip_CCAN_EnableInt(LPC_C_CAN0, CCAN_CTRL_IE | CCAN_CTRL_EIE);
+#ifdef USE_USB0
+	NVIC_SetPriority(C_CAN0_IRQn, NVIC_GetPriority(USB0_IRQn));
+#else
+	NVIC_SetPriority(C_CAN0_IRQn, NVIC_GetPriority(USB1_IRQn));
+#endif
+	NVIC_ClearPendingIRQ(C_CAN0_IRQn);
+	NVIC_EnableIRQ(C_CAN0_IRQn);
+
+	return LPC_OK;
+}
+
+/* Queue the frames of an OUT report */
+ErrorCode_t hid_can_out(const uint8_t *pData, uint32_t len)
+{
+	HID_Can_Ctrl_T *pCan = &g_can;
+	CCAN_MSG_OBJ_T msg;
+	uint32_t n, i, pos, dlc;
+
+	if (len == 0) {
+		return LPC_OK;
+	}
+	n = pData[0];
+
+	/* check the whole report first, it is queued all or nothing */
+	for (i = 0, pos = 1; i < n; i++) {
+		if ((pos + HID_CAN_OUT_REC_HDR_BYTES) > len) {
+			break;
+		}
+		dlc = pData[pos + 4];
+		if ((dlc > 8) || ((pos + HID_CAN_OUT_REC_HDR_BYTES + dlc) > len)) {
+			break;
+		}
+		pos += HID_CAN_OUT_REC_HDR_BYTES + dlc;
+	}
+	if ((i != n) || (n > HID_CAN_TX_RB_SIZE)) {
+		pCan->stats.txBadReports++;
+		return LPC_OK;
+	}
+	if ((uint32_t) RingBuffer_GetFree(&pCan->txRb) < n) {
+		return ERR_BUSY;
+	}
+
+	for (i = 0, pos = 1; i < n; i++) {
+		msg.id = pData[pos] | ((uint32_t) pData[pos + 1] << 8) |
+				 ((uint32_t) pData[pos + 2] << 16) | ((uint32_t) pData[pos + 3] << 24);
+		msg.id &= (msg.id & CAN_ID_EXT) ? (CAN_ID_EXT | CCAN_MSG_ID_EXT_MASK) : CCAN_MSG_ID_STD_MASK;
+		msg.dlc = pData[pos + 4];
+		memcpy(msg.data, &pData[pos + HID_CAN_OUT_REC_HDR_BYTES], msg.dlc);
+		RingBuffer_Insert(&pCan->txRb, &msg);
+		pos += HID_CAN_OUT_REC_HDR_BYTES + msg.dlc;
+	}
+
+	/* the CAN interrupt loads the next frame once one is sent, start it
+	   if the send object is idle */
+	NVIC_DisableIRQ(C_CAN0_IRQn);
+	if (!pCan->txBusy) {
+		can_tx_next(pCan);
+	}
+	NVIC_EnableIRQ(C_CAN0_IRQn);
+
+	return LPC_OK;
+}
+
+/* Keep the time base running */
+void hid_can_task(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();	/* enter critical section */
+	can_now_us(&g_can);
+	__set_PRIMASK(primask);	/* exit critical section */
+}
+
+/* Get the CAN bridge counters */
+const HID_Can_Stats_T *hid_can_get_stats(void)
+{
+	return &g_can.stats;
+}
+
+#endif /* HID_CAN_BRIDGE */
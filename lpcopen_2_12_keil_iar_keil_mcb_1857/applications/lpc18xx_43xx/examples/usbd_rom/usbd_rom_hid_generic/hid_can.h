@@ -0,0 +1,126 @@
+/*
+ * @brief C_CAN to HID bridge with batched frame reports
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_CAN_H_
+#define __HID_CAN_H_
+
+#include "board.h"
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* C_CAN0 receives every frame into a chain of HID_CAN_RX_OBJS message
+   objects (the receive FIFO of ccan_18xx_43xx.h). The CAN interrupt drains
+   the chain, stamps the frames and packs them straight into an IN report
+   slot of the channel, which is sent once the next frame does not fit or
+   HID_CAN_DEADLINE_US after its first frame. IN payload layout (little
+   endian):
+     byte 0..3  : microsecond time of the first frame
+     byte 4..5  : frames in the report
+     byte 6..7  : frames dropped since the previous report, saturated
+     byte 8..   : frame records of 7 + dlc bytes each:
+                  u16 microseconds after the first frame,
+                  u32 id (bit 30 set for an extended id, as CCAN_MSG_OBJ_T),
+                  u8 dlc, dlc data bytes
+   OUT reports on the channel carry frames to send: byte 0 is the number
+   of frames, followed by records of u32 id, u8 dlc and dlc data bytes.
+   They are queued in the order received and sent by one message object,
+   so the bus sees them in that order too. */
+#define HID_CAN_HDR_BYTES           8
+#define HID_CAN_REC_HDR_BYTES       7
+#define HID_CAN_REC_MAX_BYTES       (HID_CAN_REC_HDR_BYTES + 8)
+#define HID_CAN_OUT_REC_HDR_BYTES   5
+
+/**
+ * @brief CAN bridge counters
+ */
+typedef struct {
+	uint32_t rxFrames;		/*!< Frames packed into IN reports */
+	uint32_t rxDropped;		/*!< Frames without a free IN slot, or lost in the FIFO */
+	uint32_t reports;		/*!< IN reports committed */
+	uint32_t txFrames;		/*!< Frames sent on the bus */
+	uint32_t txBadReports;	/*!< OUT reports rejected for a malformed record */
+	uint32_t busOff;		/*!< Bus off events, the controller is restarted */
+	uint32_t errPassive;	/*!< Error passive events */
+} HID_Can_Stats_T;
+
+/**
+ * @brief	Set up C_CAN0 and start bridging it to a HID channel.
+ * @param	hUsb	: Handle to USB device stack of the port the reports go to
+ * @param	chan	: Logical channel the frames are sent and received on
+ * @return	LPC_OK, or ERR_FAILED when the message objects do not suffice
+ * @note	The channel is owned by the bridge from now on. The CAN interrupt
+ *			runs at the priority of the USB interrupts so neither preempts
+ *			the other. While the device is not configured or a benchmark
+ *			runs the received frames are dropped.
+ */
+ErrorCode_t hid_can_init(USBD_HANDLE_T hUsb, uint32_t chan);
+
+/**
+ * @brief	Queue the frames of an OUT report for sending.
+ * @param	pData	: OUT report payload, after the report ID
+ * @param	len		: Length of the payload
+ * @return	LPC_OK when the frames were queued or the report was rejected,
+ *			ERR_BUSY when the send queue has no room for all of them
+ * @note	Called from the main loop. On ERR_BUSY keep the OUT report and
+ *			offer it again later, the host is throttled by NAKs meanwhile.
+ */
+ErrorCode_t hid_can_out(const uint8_t *pData, uint32_t len);
+
+/**
+ * @brief	Keep the microsecond time base running while the bus is idle.
+ * @return	Nothing
+ * @note	Call from the main loop at least once per StopWatch counter wrap.
+ */
+void hid_can_task(void);
+
+/**
+ * @brief	Get the CAN bridge counters.
+ * @return	Pointer to the counters, updated from the CAN interrupt
+ */
+const HID_Can_Stats_T *hid_can_get_stats(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_CAN_H_ */
@@ -0,0 +1,157 @@
+/*
+ * @brief Coalescing of short messages into HID IN reports used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <stdint.h>
+#include <string.h>
+#include "hid_generic.h"
+#include "hid_coalesce.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/**
+ * @brief Structure to hold the report being packed
+ */
+typedef struct {
+	uint8_t *pBuf;			/*!< Payload of the IN slot being filled, NULL if none */
+	uint32_t fill;			/*!< Payload bytes used in pBuf */
+	USBD_HANDLE_T hUsb;		/*!< Port the reports are sent on */
+	uint32_t chan;			/*!< Logical channel the reports are sent on */
+	CHIP_TWHEEL_TIMER_T deadline;	/*!< Deadline of the report being packed */
+} HID_Coalesce_Ctrl_T;
+
+static HID_Coalesce_Ctrl_T g_coalesce;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Hand the packed report to the channel queue, called with interrupts
+   masked or from the deadline callback */
+static ErrorCode_t coalesce_send(HID_Coalesce_Ctrl_T *pCo)
+{
+	ErrorCode_t ret = LPC_OK;
+
+	Chip_TWHEEL_Stop(&pCo->deadline);
+	if (pCo->pBuf != NULL) {
+		/* the slot is not cleared, terminate the list if the report is short */
+		if (pCo->fill < HID_CHAN_PAYLOAD_BYTES) {
+			pCo->pBuf[pCo->fill++] = 0;
+		}
+		ret = hid_generic_slot_commit(pCo->hUsb, pCo->chan, pCo->fill);
+		pCo->pBuf = NULL;
+		pCo->fill = 0;
+	}
+	return ret;
+}
+
+/* The deadline of the packed report expired, called from the RITimer
+   interrupt */
+static void coalesce_expired(CHIP_TWHEEL_TIMER_T *pTimer)
+{
+	coalesce_send((HID_Coalesce_Ctrl_T *) pTimer->pArg);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize coalescing */
+void hid_coalesce_init(USBD_HANDLE_T hUsb, uint32_t chan)
+{
+	HID_Coalesce_Ctrl_T *pCo = &g_coalesce;
+
+	pCo->pBuf = NULL;
+	pCo->fill = 0;
+	pCo->hUsb = hUsb;
+	pCo->chan = chan;
+	Chip_TWHEEL_Setup(&pCo->deadline, coalesce_expired, pCo, 0);
+}
+
+/* Pack a message */
+ErrorCode_t hid_coalesce_put(const uint8_t *pMsg, uint32_t len)
+{
+	HID_Coalesce_Ctrl_T *pCo = &g_coalesce;
+	ErrorCode_t ret = LPC_OK;
+	uint32_t primask;
+
+	if ((len == 0) || (len > HID_COALESCE_MSG_MAX)) {
+		return ERR_API_INVALID_PARAM2;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();	/* enter critical section */
+	/* the message does not fit behind the ones already packed */
+	if ((pCo->pBuf != NULL) && ((pCo->fill + 1 + len) > HID_CHAN_PAYLOAD_BYTES)) {
+		coalesce_send(pCo);
+	}
+	if (pCo->pBuf == NULL) {
+		pCo->pBuf = hid_generic_slot_get(pCo->hUsb, pCo->chan);
+	}
+	if (pCo->pBuf == NULL) {
+		ret = ERR_BUSY;
+	}
+	else {
+		pCo->pBuf[pCo->fill] = (uint8_t) len;
+		memcpy(&pCo->pBuf[pCo->fill + 1], pMsg, len);
+		if (pCo->fill == 0) {
+			Chip_TWHEEL_Start(&pCo->deadline, Chip_TWHEEL_UsToTicks(HID_COALESCE_DEADLINE_US), 0);
+		}
+		pCo->fill += 1 + len;
+		/* no room for even a one byte message, don't wait for the deadline */
+		if ((pCo->fill + 2) > HID_CHAN_PAYLOAD_BYTES) {
+			coalesce_send(pCo);
+		}
+	}
+	__set_PRIMASK(primask);	/* exit critical section */
+
+	return ret;
+}
+
+/* Send the partly filled report */
+ErrorCode_t hid_coalesce_flush(void)
+{
+	ErrorCode_t ret;
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();	/* enter critical section */
+	ret = coalesce_send(&g_coalesce);
+	__set_PRIMASK(primask);	/* exit critical section */
+
+	return ret;
+}
@@ -0,0 +1,96 @@
+/*
+ * @brief Coalescing of short messages into HID IN reports used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_COALESCE_H_
+#define __HID_COALESCE_H_
+
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* Messages are packed back to back into the payload of one IN report of the
+   coalescing channel, each framed as
+     byte 0     : message length n, 1 to HID_COALESCE_MSG_MAX
+     byte 1..n  : message
+   A zero length byte or the end of the report ends the list. The report goes
+   out when the next message does not fit, or HID_COALESCE_DEADLINE_US after
+   its first message was put, whichever comes first.
+ */
+#define HID_COALESCE_MSG_MAX        (HID_CHAN_PAYLOAD_BYTES - 1)
+
+/**
+ * @brief	Initialize message coalescing.
+ * @param	hUsb	: Handle to USB device stack of the port the reports go to
+ * @param	chan	: Logical channel the packed reports are sent on
+ * @return	Nothing
+ * @note	The channel is owned by the coalescer from now on, the slot it
+ *			fills stays handed out until the report is flushed. The
+ *			deadline is a timer wheel timer, Chip_TWHEEL_Init() must have
+ *			been called.
+ */
+void hid_coalesce_init(USBD_HANDLE_T hUsb, uint32_t chan);
+
+/**
+ * @brief	Append a short message to the report being packed.
+ * @param	pMsg	: Pointer to message
+ * @param	len		: Length of the message, 1 to HID_COALESCE_MSG_MAX
+ * @return	LPC_OK when the message was packed, ERR_BUSY when the channel
+ *			queue has no free slot (or the device is not configured) and
+ *			ERR_API_INVALID_PARAM2 for a bad length.
+ * @note	Interrupts are masked while the message is packed, so it may
+ *			be called from any context.
+ */
+ErrorCode_t hid_coalesce_put(const uint8_t *pMsg, uint32_t len);
+
+/**
+ * @brief	Send the partly filled report now instead of at the deadline.
+ * @return	LPC_OK when nothing was pending or the report was queued,
+ *			ERR_FAILED when it was dropped by a bus reset or reconfiguration.
+ */
+ErrorCode_t hid_coalesce_flush(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_COALESCE_H_ */
@@ -39,32 +39,144 @@
  * Public types/enumerations/variables
  ****************************************************************************/
 
-#define HID_INPUT_REPORT_BYTES       255				/* size of report in Bytes */
-#define HID_OUTPUT_REPORT_BYTES      255				/* size of report in Bytes */
-#define HID_FEATURE_REPORT_BYTES     255				/* size of report in Bytes */
+/* Input and output report of one logical channel. The report ID byte is part
+   of HID_INPUT_REPORT_BYTES/HID_OUTPUT_REPORT_BYTES on the wire. */
+#define HID_CHANNEL_REPORTS(ch)									\
+	HID_ReportID(HID_CHAN_REPORT_ID(ch)),						\
+	HID_ReportCount16((HID_INPUT_REPORT_BYTES - 1)),				\
+	HID_Usage(0x01),											\
+	HID_Input(HID_Data | HID_Variable | HID_Absolute),			\
+	HID_ReportCount16((HID_OUTPUT_REPORT_BYTES - 1)),				\
+	HID_Usage(0x01),											\
+	HID_Output(HID_Data | HID_Variable | HID_Absolute)
+
+/* Top level collection of HID interface n, the usage tells the interfaces
+   apart on hosts that don't report interface numbers */
+#define HID_COLLECTION_BEGIN(n)									\
+	HID_UsagePageVendor(0x00),									\
+	HID_Usage(0x01 + (n)),										\
+	HID_Collection(HID_Application),							\
+	HID_LogicalMin(0),	/* value range: 0 - 0xFF */				\
+	HID_LogicalMaxS(0xFF),										\
+	HID_ReportSize(8)	/* 8 bits */
 
 /**
- * HID Report Descriptor
+ * HID Report Descriptor of HID interface 0, all feature reports
  */
 const uint8_t HID_ReportDescriptor[] = {
-	HID_UsagePageVendor(0x00),
-	HID_Usage(0x01),
-	HID_Collection(HID_Application),
-	HID_LogicalMin(0),	/* value range: 0 - 0xFF */
-	HID_LogicalMaxS(0xFF),
-	HID_ReportSize(8),	/* 8 bits */
-	HID_ReportCount(HID_INPUT_REPORT_BYTES),
-	HID_Usage(0x01),
-	HID_Input(HID_Data | HID_Variable | HID_Absolute),
-	HID_ReportCount(HID_OUTPUT_REPORT_BYTES),
-	HID_Usage(0x01),
-	HID_Output(HID_Data | HID_Variable | HID_Absolute),
-	HID_ReportCount(HID_FEATURE_REPORT_BYTES),
-	HID_Usage(0x01),
+	HID_COLLECTION_BEGIN(0),
+	HID_CHANNEL_REPORTS(0),
+	/* chunked blob transfer over EP0 */
+	HID_ReportID(HID_REPORT_ID_BLOB),
+	HID_ReportCount(HID_FEATURE_REPORT_BYTES - 1),
+	HID_Usage(0x02),
+	HID_Feature(HID_Data | HID_Variable | HID_Absolute),
+	/* benchmark mode and counters */
+	HID_ReportID(HID_REPORT_ID_BENCH),
+	HID_ReportCount(HID_BENCH_REPORT_BYTES - 1),
+	HID_Usage(0x03),
+	HID_Feature(HID_Data | HID_Variable | HID_Absolute),
+	/* USB event statistics */
+	HID_ReportID(HID_REPORT_ID_STATS),
+	HID_ReportCount(HID_STATS_REPORT_BYTES - 1),
+	HID_Usage(0x04),
+	HID_Feature(HID_Data | HID_Variable | HID_Absolute),
+#ifdef HID_ISR_TRACE
+	/* USB interrupt trace */
+	HID_ReportID(HID_REPORT_ID_TRACE),
+	HID_ReportCount(HID_TRACE_REPORT_BYTES - 1),
+	HID_Usage(0x05),
+	HID_Feature(HID_Data | HID_Variable | HID_Absolute),
+#endif
+#ifdef CHIP_PROFILE_ENABLE
+	/* profiling regions */
+	HID_ReportID(HID_REPORT_ID_PROF),
+	HID_ReportCount(HID_PROF_REPORT_BYTES - 1),
+	HID_Usage(0x06),
+	HID_Feature(HID_Data | HID_Variable | HID_Absolute),
+#endif
+#ifdef HID_MEMDIAG
+	/* memory usage table */
+	HID_ReportID(HID_REPORT_ID_MEM),
+	HID_ReportCount(HID_MEM_REPORT_BYTES - 1),
+	HID_Usage(0x07),
 	HID_Feature(HID_Data | HID_Variable | HID_Absolute),
+#endif
+#if HID_NUM_CHANNELS > 1 && HID_CHAN_INTF(1) == 0
+	HID_CHANNEL_REPORTS(1),
+#endif
+#if HID_NUM_CHANNELS > 2 && HID_CHAN_INTF(2) == 0
+	HID_CHANNEL_REPORTS(2),
+#endif
+#if HID_NUM_CHANNELS > 3 && HID_CHAN_INTF(3) == 0
+	HID_CHANNEL_REPORTS(3),
+#endif
+#if HID_NUM_CHANNELS > 4
+#error "HID_Generic: HID_ReportDescriptor describes at most 4 channels"
+#endif
+#if HID_CHAN_INTF(HID_CHAN_CONTROL) != 0
+#error "HID_Generic: the control channel must stay on HID interface 0"
+#endif
+	HID_EndCollection,
+};
+
+#if HID_NUM_HID_INTF > 1
+/**
+ * HID Report Descriptor of HID interface 1
+ */
+const uint8_t HID_Report1Descriptor[] = {
+	HID_COLLECTION_BEGIN(1),
+#if HID_NUM_CHANNELS > 1 && HID_CHAN_INTF(1) == 1
+	HID_CHANNEL_REPORTS(1),
+#endif
+#if HID_NUM_CHANNELS > 2 && HID_CHAN_INTF(2) == 1
+	HID_CHANNEL_REPORTS(2),
+#endif
+#if HID_NUM_CHANNELS > 3 && HID_CHAN_INTF(3) == 1
+	HID_CHANNEL_REPORTS(3),
+#endif
 	HID_EndCollection,
 };
-const uint16_t HID_ReportDescSize = sizeof(HID_ReportDescriptor);
+#endif
+
+#if HID_NUM_HID_INTF > 2
+/**
+ * HID Report Descriptor of HID interface 2
+ */
+const uint8_t HID_Report2Descriptor[] = {
+	HID_COLLECTION_BEGIN(2),
+#if HID_NUM_CHANNELS > 1 && HID_CHAN_INTF(1) == 2
+	HID_CHANNEL_REPORTS(1),
+#endif
+#if HID_NUM_CHANNELS > 2 && HID_CHAN_INTF(2) == 2
+	HID_CHANNEL_REPORTS(2),
+#endif
+#if HID_NUM_CHANNELS > 3 && HID_CHAN_INTF(3) == 2
+	HID_CHANNEL_REPORTS(3),
+#endif
+	HID_EndCollection,
+};
+#endif
+
+/* Report descriptor of each HID interface, for usb_hid_init() */
+const uint8_t *const HID_ReportDescs[HID_NUM_HID_INTF] = {
+	HID_ReportDescriptor,
+#if HID_NUM_HID_INTF > 1
+	HID_Report1Descriptor,
+#endif
+#if HID_NUM_HID_INTF > 2
+	HID_Report2Descriptor,
+#endif
+};
+const uint16_t HID_ReportDescSizes[HID_NUM_HID_INTF] = {
+	sizeof(HID_ReportDescriptor),
+#if HID_NUM_HID_INTF > 1
+	sizeof(HID_Report1Descriptor),
+#endif
+#if HID_NUM_HID_INTF > 2
+	sizeof(HID_Report2Descriptor),
+#endif
+};
 
 /**
  * USB Standard Device Descriptor
@@ -98,62 +210,126 @@ ALIGNED(4) const uint8_t USB_DeviceQualifier[] = {
 	0x00									/* bReserved */
 };
 
+#ifdef HID_VENDOR_BULK
+/* Vendor class interface with the bulk endpoint pair, bound to WinUSB
+   through the WCID descriptors below */
+#define HID_BULK_DESC_LENGTH	\
+	(USB_INTERFACE_DESC_SIZE + 2 * USB_ENDPOINT_DESC_SIZE)
+
+#define HID_BULK_INTERFACE_DESC(wMaxPacket)							\
+	/* Bulk interface, Alternate Setting 0, Vendor Class */		\
+	USB_INTERFACE_DESC_SIZE,		/* bLength */					\
+	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */			\
+	HID_BULK_INTERFACE_NUM,			/* bInterfaceNumber */			\
+	0x00,							/* bAlternateSetting */			\
+	0x02,							/* bNumEndpoints */				\
+	0xFF,							/* bInterfaceClass */			\
+	0x00,							/* bInterfaceSubClass */		\
+	0x00,							/* bInterfaceProtocol */		\
+	0x05,							/* iInterface */				\
+	/* Endpoint, Bulk In */											\
+	USB_ENDPOINT_DESC_SIZE,			/* bLength */					\
+	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */			\
+	HID_BULK_EP_IN,					/* bEndpointAddress */			\
+	USB_ENDPOINT_TYPE_BULK,			/* bmAttributes */				\
+	WBVAL(wMaxPacket),				/* wMaxPacketSize */			\
+	0,								/* bInterval */					\
+	/* Endpoint, Bulk Out */										\
+	USB_ENDPOINT_DESC_SIZE,			/* bLength */					\
+	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */			\
+	HID_BULK_EP_OUT,				/* bEndpointAddress */			\
+	USB_ENDPOINT_TYPE_BULK,			/* bmAttributes */				\
+	WBVAL(wMaxPacket),				/* wMaxPacketSize */			\
+	0,								/* bInterval */
+#else
+#define HID_BULK_DESC_LENGTH                 0
+#define HID_BULK_INTERFACE_DESC(wMaxPacket)
+#endif
+
+/* HID interface n with its interrupt endpoint pair */
+#define HID_INTF_DESC_LENGTH	\
+	(USB_INTERFACE_DESC_SIZE + HID_DESC_SIZE + 2 * USB_ENDPOINT_DESC_SIZE)
+
+#define HID_INTERFACE_DESC(n, wDescLength, wMaxPacket, bInterval)	\
+	/* Interface n, Alternate Setting 0, HID Class */				\
+	USB_INTERFACE_DESC_SIZE,		/* bLength */					\
+	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */			\
+	(n),							/* bInterfaceNumber */			\
+	0x00,							/* bAlternateSetting */			\
+	0x02,							/* bNumEndpoints */				\
+	USB_DEVICE_CLASS_HUMAN_INTERFACE,	/* bInterfaceClass */		\
+	HID_SUBCLASS_NONE,				/* bInterfaceSubClass */		\
+	HID_PROTOCOL_NONE,				/* bInterfaceProtocol */		\
+	0x04,							/* iInterface */				\
+	/* HID Class Descriptor */										\
+	/* HID_DESC_OFFSET = 0x0012 for interface 0 */					\
+	HID_DESC_SIZE,					/* bLength */					\
+	HID_HID_DESCRIPTOR_TYPE,		/* bDescriptorType */			\
+	WBVAL(0x0111),					/* bcdHID : 1.11*/				\
+	0x00,							/* bCountryCode */				\
+	0x01,							/* bNumDescriptors */			\
+	HID_REPORT_DESCRIPTOR_TYPE,		/* bDescriptorType */			\
+	WBVAL(wDescLength),				/* wDescriptorLength */			\
+	/* Endpoint, HID Interrupt In */								\
+	USB_ENDPOINT_DESC_SIZE,			/* bLength */					\
+	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */			\
+	HID_INTF_EP_IN(n),				/* bEndpointAddress */			\
+	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */				\
+	WBVAL(wMaxPacket),				/* wMaxPacketSize */			\
+	bInterval,						/* bInterval */					\
+	/* Endpoint, HID Interrupt Out */								\
+	USB_ENDPOINT_DESC_SIZE,			/* bLength */					\
+	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */			\
+	HID_INTF_EP_OUT(n),				/* bEndpointAddress */			\
+	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */				\
+	WBVAL(wMaxPacket),				/* wMaxPacketSize */			\
+	bInterval,						/* bInterval */
+
+#if HID_NUM_HID_INTF > 1
+#define HID_INTERFACE1_DESC(wMaxPacket, bInterval)	\
+	HID_INTERFACE_DESC(1, sizeof(HID_Report1Descriptor), wMaxPacket, bInterval)
+#else
+#define HID_INTERFACE1_DESC(wMaxPacket, bInterval)
+#endif
+#if HID_NUM_HID_INTF > 2
+#define HID_INTERFACE2_DESC(wMaxPacket, bInterval)	\
+	HID_INTERFACE_DESC(2, sizeof(HID_Report2Descriptor), wMaxPacket, bInterval)
+#else
+#define HID_INTERFACE2_DESC(wMaxPacket, bInterval)
+#endif
+
+/* wTotalLength of the configuration descriptor, shared by both speeds */
+#define HID_CONFIG_DESC_TOTAL_LENGTH	\
+	(USB_CONFIGURATION_DESC_SIZE   +	\
+	 (HID_NUM_HID_INTF * HID_INTF_DESC_LENGTH) +	\
+	 HID_BULK_DESC_LENGTH)
+
+/* Configuration descriptor: HS and FS only differ in the endpoint
+   wMaxPacketSize and bInterval, both generated from app_usbd_cfg.h */
+#define HID_CONFIG_DESCRIPTOR(wMaxPacket, bInterval, wBulkMaxPacket)	\
+	/* Configuration 1 */											\
+	USB_CONFIGURATION_DESC_SIZE,		/* bLength */				\
+	USB_CONFIGURATION_DESCRIPTOR_TYPE,	/* bDescriptorType */		\
+	WBVAL(HID_CONFIG_DESC_TOTAL_LENGTH),	/* wTotalLength */		\
+	HID_NUM_INTERFACES,				/* bNumInterfaces */			\
+	0x01,							/* bConfigurationValue */		\
+	0x00,							/* iConfiguration */			\
+	HID_CONFIG_ATTRIBUTES,			/* bmAttributes */				\
+	USB_CONFIG_POWER_MA(100),		/* bMaxPower */					\
+																	\
+	HID_INTERFACE_DESC(0, sizeof(HID_ReportDescriptor), wMaxPacket, bInterval)	\
+	HID_INTERFACE1_DESC(wMaxPacket, bInterval)						\
+	HID_INTERFACE2_DESC(wMaxPacket, bInterval)						\
+	HID_BULK_INTERFACE_DESC(wBulkMaxPacket)							\
+	/* Terminator */												\
+	0								/* bLength */
+
 /**
  * USB HSConfiguration Descriptor
  * All Descriptors (Configuration, Interface, Endpoint, Class, Vendor)
  */
 ALIGNED(4) uint8_t USB_HsConfigDescriptor[] = {
-	/* Configuration 1 */
-	USB_CONFIGURATION_DESC_SIZE,		/* bLength */
-	USB_CONFIGURATION_DESCRIPTOR_TYPE,	/* bDescriptorType */
-	WBVAL(								/* wTotalLength */
-		USB_CONFIGURATION_DESC_SIZE   +
-		USB_INTERFACE_DESC_SIZE       +
-		HID_DESC_SIZE                 +
-		USB_ENDPOINT_DESC_SIZE        +
-		USB_ENDPOINT_DESC_SIZE
-		),
-	0x01,							/* bNumInterfaces */
-	0x01,							/* bConfigurationValue */
-	0x00,							/* iConfiguration */
-	USB_CONFIG_SELF_POWERED,		/* bmAttributes */
-	USB_CONFIG_POWER_MA(100),		/* bMaxPower */
-
-	/* Interface 0, Alternate Setting 0, HID Class */
-	USB_INTERFACE_DESC_SIZE,		/* bLength */
-	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
-	0x00,							/* bInterfaceNumber */
-	0x00,							/* bAlternateSetting */
-	0x02,							/* bNumEndpoints */
-	USB_DEVICE_CLASS_HUMAN_INTERFACE,	/* bInterfaceClass */
-	HID_SUBCLASS_NONE,				/* bInterfaceSubClass */
-	HID_PROTOCOL_NONE,				/* bInterfaceProtocol */
-	0x04,							/* iInterface */
-	/* HID Class Descriptor */
-	/* HID_DESC_OFFSET = 0x0012 */
-	HID_DESC_SIZE,					/* bLength */
-	HID_HID_DESCRIPTOR_TYPE,		/* bDescriptorType */
-	WBVAL(0x0111),					/* bcdHID : 1.11*/
-	0x00,							/* bCountryCode */
-	0x01,							/* bNumDescriptors */
-	HID_REPORT_DESCRIPTOR_TYPE,		/* bDescriptorType */
-	WBVAL(sizeof(HID_ReportDescriptor)),	/* wDescriptorLength */
-	/* Endpoint, HID Interrupt In */
-	USB_ENDPOINT_DESC_SIZE,			/* bLength */
-	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
-	HID_EP_IN,						/* bEndpointAddress */
-	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */
-	WBVAL(0x00ff),					/* wMaxPacketSize */
-	0x08,		/* 16ms */          /* bInterval */
-	/* Endpoint, HID Interrupt Out */
-	USB_ENDPOINT_DESC_SIZE,			/* bLength */
-	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
-	HID_EP_OUT,						/* bEndpointAddress */
-	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */
-	WBVAL(0x00ff),					/* wMaxPacketSize */
-	0x08,		/* 16ms */          /* bInterval */
-	/* Terminator */
-	0								/* bLength */
+	HID_CONFIG_DESCRIPTOR(HID_HS_EP_WMAXPACKET, HID_HS_EP_INTERVAL, USB_HS_MAX_BULK_PACKET)
 };
 
 /**
@@ -161,59 +337,25 @@ ALIGNED(4) uint8_t USB_HsConfigDescriptor[] = {
  * All Descriptors (Configuration, Interface, Endpoint, Class, Vendor)
  */
 ALIGNED(4) uint8_t USB_FsConfigDescriptor[] = {
-	/* Configuration 1 */
-	USB_CONFIGURATION_DESC_SIZE,		/* bLength */
-	USB_CONFIGURATION_DESCRIPTOR_TYPE,	/* bDescriptorType */
-	WBVAL(								/* wTotalLength */
-		USB_CONFIGURATION_DESC_SIZE   +
-		USB_INTERFACE_DESC_SIZE       +
-		HID_DESC_SIZE                 +
-		USB_ENDPOINT_DESC_SIZE        +
-		USB_ENDPOINT_DESC_SIZE
-		),
-	0x01,							/* bNumInterfaces */
-	0x01,							/* bConfigurationValue */
-	0x00,							/* iConfiguration */
-	USB_CONFIG_SELF_POWERED,		/* bmAttributes */
-	USB_CONFIG_POWER_MA(100),		/* bMaxPower */
-
-	/* Interface 0, Alternate Setting 0, HID Class */
-	USB_INTERFACE_DESC_SIZE,		/* bLength */
-	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
-	0x00,							/* bInterfaceNumber */
-	0x00,							/* bAlternateSetting */
-	0x02,							/* bNumEndpoints */
-	USB_DEVICE_CLASS_HUMAN_INTERFACE,	/* bInterfaceClass */
-	HID_SUBCLASS_NONE,				/* bInterfaceSubClass */
-	HID_PROTOCOL_NONE,				/* bInterfaceProtocol */
-	0x04,							/* iInterface */
-	/* HID Class Descriptor */
-	/* HID_DESC_OFFSET = 0x0012 */
-	HID_DESC_SIZE,					/* bLength */
-	HID_HID_DESCRIPTOR_TYPE,		/* bDescriptorType */
-	WBVAL(0x0111),					/* bcdHID : 1.11*/
-	0x00,							/* bCountryCode */
-	0x01,							/* bNumDescriptors */
-	HID_REPORT_DESCRIPTOR_TYPE,		/* bDescriptorType */
-	WBVAL(sizeof(HID_ReportDescriptor)),	/* wDescriptorLength */
-	/* Endpoint, HID Interrupt In */
-	USB_ENDPOINT_DESC_SIZE,			/* bLength */
-	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
-	HID_EP_IN,						/* bEndpointAddress */
-	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */
-	WBVAL(0x0004),					/* wMaxPacketSize */
-	0x20,		/* 16ms */          /* bInterval */
-	/* Endpoint, HID Interrupt Out */
-	USB_ENDPOINT_DESC_SIZE,			/* bLength */
-	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
-	HID_EP_OUT,						/* bEndpointAddress */
-	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */
-	WBVAL(0x0004),					/* wMaxPacketSize */
-	0x20,							/* bInterval: 16ms */
-	/* Terminator */
-	0								/* bLength */
+	HID_CONFIG_DESCRIPTOR(HID_FS_EP_MAXPACKET, HID_FS_EP_INTERVAL, USB_FS_MAX_BULK_PACKET)
 };
 
+/* Checks on the generated descriptors, a failing one gives a negative array size */
+#define HID_DESC_ASSERT(name, pred)  typedef char name[(pred) ? 1 : -1]
+
+HID_DESC_ASSERT(hid_hs_total_length_check,
+				sizeof(USB_HsConfigDescriptor) == (HID_CONFIG_DESC_TOTAL_LENGTH + 1));
+HID_DESC_ASSERT(hid_fs_total_length_check,
+				sizeof(USB_FsConfigDescriptor) == (HID_CONFIG_DESC_TOTAL_LENGTH + 1));
+HID_DESC_ASSERT(hid_report_desc_length_check, sizeof(HID_ReportDescriptor) <= 0xFFFF);
+#if HID_NUM_HID_INTF > 1
+/* every HID interface needs channel reports, not just the 14 byte collection */
+HID_DESC_ASSERT(hid_report1_desc_check, sizeof(HID_Report1Descriptor) > 16);
+#endif
+#if HID_NUM_HID_INTF > 2
+HID_DESC_ASSERT(hid_report2_desc_check, sizeof(HID_Report2Descriptor) > 16);
+#endif
+
 /**
  * USB String Descriptor (optional)
  */
@@ -274,10 +416,53 @@ const uint8_t USB_StringDescriptor[] = {
 	'7', 0,
 	'8', 0,
 	'9', 0,
-	/* Index 0x04: Interface 0, Alternate Setting 0 */
+	/* Index 0x04: HID interfaces, Alternate Setting 0 */
 	(3 * 2 + 2),					/* bLength (3 Char + Type + length) */
 	USB_STRING_DESCRIPTOR_TYPE,		/* bDescriptorType */
 	'H', 0,
 	'I', 0,
 	'D', 0,
+#ifdef HID_VENDOR_BULK
+	/* Index 0x05: Bulk interface, Alternate Setting 0 */
+	(4 * 2 + 2),					/* bLength (4 Char + Type + length) */
+	USB_STRING_DESCRIPTOR_TYPE,		/* bDescriptorType */
+	'B', 0,
+	'u', 0,
+	'l', 0,
+	'k', 0,
+#endif
+};
+
+#ifdef HID_VENDOR_BULK
+/* WCID USB: Microsoft String Descriptor */
+ALIGNED(4) const uint8_t WCID_String_Descriptor[] = {
+	(8 * 2 + 2),					/* bLength (8 Char + Type + length) */
+	USB_STRING_DESCRIPTOR_TYPE,		/* bDescriptorType */
+	'M', 0,
+	'S', 0,
+	'F', 0,
+	'T', 0,
+	'1', 0,
+	'0', 0,
+	'0', 0,
+	HID_WCID_VENDOR_CODE, 0,
+};
+
+/* WCID USB: Microsoft Compatible ID Feature Descriptor, binds WinUSB to the
+   bulk interface only, the HID interface keeps the inbox HID driver */
+ALIGNED(4) const uint8_t WCID_CompatID_Descriptor[] = {
+	0x28, 0x00, 0x00, 0x00,						/* Length 40 bytes */
+	0x00, 0x01,									/* Version */
+	0x04, 0x00,									/* Compatibility ID Descriptor index  */
+	0x01,										/* Number of sections */
+	0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00,							/* Reserved: 7 bytes */
+	HID_BULK_INTERFACE_NUM,						/* Interface Number */
+	0x01,										/* Reserved */
+	'W', 'I', 'N', 'U', 'S', 'B', 0x00, 0x00,	/* Compatible ID: 8 bytes ASCII */
+	0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00,						/* Sub-Compatible ID: 8 bytes ASCII*/
+	0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00,									/* Reserved: 6 bytes */
 };
+#endif
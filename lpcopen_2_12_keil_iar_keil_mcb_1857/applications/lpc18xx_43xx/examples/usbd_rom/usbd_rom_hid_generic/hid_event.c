@@ -0,0 +1,146 @@
+/*
+ * @brief Pin interrupt to HID IN report fast path used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "hid_generic.h"
+#include "hid_event.h"
+
+#ifdef HID_EVENT_FASTPATH
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+typedef struct {
+	USBD_HANDLE_T hUsb;					/*!< Port the reports are sent on */
+	uint16_t seq;						/*!< Sequence number of the next event */
+	HID_Event_Stats_T stats;			/*!< Counters */
+	uint8_t report[HID_EVENT_REPORT_BYTES];	/*!< Preformatted report */
+} HID_Event_Ctrl_T;
+
+static HID_Event_Ctrl_T g_event;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+STATIC INLINE void put_u32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) (v >> 16);
+	p[3] = (uint8_t) (v >> 24);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Handle interrupt from the event pin, reports the edge
+ * @return	Nothing
+ */
+HOTFUNC void HID_EVENT_PININT_HANDLER(void)
+{
+	HID_Event_Ctrl_T *pEv = &g_event;
+	uint32_t start = DWT->CYCCNT;
+	uint32_t cycles;
+	uint8_t *pSlot;
+
+	Chip_PININT_ClearIntStatus(LPC_GPIO_PIN_INT, PININTCH(HID_EVENT_PININT_INDEX));
+	pEv->stats.events++;
+
+	/* The USB interrupts can't run meanwhile (same priority), and the main
+	   loop's critical sections mask this interrupt too, so the channel
+	   queue is ours until the commit */
+	pSlot = hid_generic_slot_get(pEv->hUsb, HID_CHAN_EVENT);
+	if (pSlot == NULL) {
+		pEv->stats.dropped++;
+		pEv->seq++;
+		return;
+	}
+
+	memcpy(pSlot, pEv->report, HID_EVENT_REPORT_BYTES);
+	pSlot[0] = Chip_GPIO_GetPinState(LPC_GPIO_PORT, HID_EVENT_GPIO_PORT, HID_EVENT_GPIO_BIT) ? 0 : 1;
+	pSlot[2] = (uint8_t) pEv->seq;
+	pSlot[3] = (uint8_t) (pEv->seq >> 8);
+	put_u32(&pSlot[4], start);
+#ifdef HID_SCT_TSTAMP
+	put_u32(&pSlot[8], Chip_SCTTS_Now(LPC_SCT));
+#endif
+	pEv->seq++;
+	if (hid_generic_slot_commit(pEv->hUsb, HID_CHAN_EVENT, HID_EVENT_REPORT_BYTES) != LPC_OK) {
+		pEv->stats.dropped++;
+	}
+
+	cycles = DWT->CYCCNT - start;
+	if (cycles > pEv->stats.isr_max_cycles) {
+		pEv->stats.isr_max_cycles = cycles;
+	}
+}
+
+/* Set up the event pin interrupt */
+void hid_event_init(USBD_HANDLE_T hUsb)
+{
+	memset(&g_event, 0, sizeof(g_event));
+	g_event.hUsb = hUsb;
+
+	Board_Buttons_Init();
+	Chip_SCU_GPIOIntPinSel(HID_EVENT_PININT_INDEX, HID_EVENT_GPIO_PORT, HID_EVENT_GPIO_BIT);
+
+	/* report both edges, press and release */
+	Chip_PININT_ClearIntStatus(LPC_GPIO_PIN_INT, PININTCH(HID_EVENT_PININT_INDEX));
+	Chip_PININT_SetPinModeEdge(LPC_GPIO_PIN_INT, PININTCH(HID_EVENT_PININT_INDEX));
+	Chip_PININT_EnableIntLow(LPC_GPIO_PIN_INT, PININTCH(HID_EVENT_PININT_INDEX));
+	Chip_PININT_EnableIntHigh(LPC_GPIO_PIN_INT, PININTCH(HID_EVENT_PININT_INDEX));
+
+#ifdef USE_USB0
+	NVIC_SetPriority(HID_EVENT_PININT_IRQn, NVIC_GetPriority(USB0_IRQn));
+#else
+	NVIC_SetPriority(HID_EVENT_PININT_IRQn, NVIC_GetPriority(USB1_IRQn));
+#endif
+	NVIC_ClearPendingIRQ(HID_EVENT_PININT_IRQn);
+	NVIC_EnableIRQ(HID_EVENT_PININT_IRQn);
+}
+
+/* Get the event fast path counters */
+const HID_Event_Stats_T *hid_event_get_stats(void)
+{
+	return &g_event.stats;
+}
+
+#endif /* HID_EVENT_FASTPATH */
@@ -0,0 +1,96 @@
+/*
+ * @brief Pin interrupt to HID IN report fast path used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_EVENT_H_
+#define __HID_EVENT_H_
+
+#include "board.h"
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* Each edge of the event pin is reported on channel HID_CHAN_EVENT straight
+   from its pin interrupt: the handler copies a preformatted report into a
+   free IN slot in USB RAM, patches in the pin state, sequence number and
+   time stamps, and commits it, so the report is primed on the endpoint
+   before the handler returns. The channel is scheduled ahead of the others,
+   so the host sees the edge at the latest one interrupt interval after the
+   report in flight. Payload layout (little endian):
+     byte 0       : pin state after the edge, 1 = pressed (pin low)
+     byte 1       : reserved, 0
+     byte 2..3    : event sequence number, a gap shows dropped events
+     byte 4..7    : DWT cycle count at interrupt entry
+     byte 8..11   : SCT time stamp (HID_SCT_TSTAMP builds only, else 0)
+ */
+#define HID_EVENT_REPORT_BYTES      12
+
+/**
+ * @brief Event fast path counters
+ */
+typedef struct {
+	uint32_t events;			/*!< Edges seen by the pin interrupt */
+	uint32_t dropped;			/*!< Edges not reported, no free slot or not configured */
+	uint32_t isr_max_cycles;	/*!< Longest interrupt entry to commit, in DWT cycles */
+} HID_Event_Stats_T;
+
+/**
+ * @brief	Set up the event pin interrupt.
+ * @param	hUsb	: Handle to USB device stack of the port the reports go to
+ * @return	Nothing
+ * @note	Uses HID_EVENT_GPIO_PORT/HID_EVENT_GPIO_BIT on pin interrupt
+ *			HID_EVENT_PININT_INDEX, at the priority of the USB interrupts
+ *			so neither preempts the other.
+ */
+void hid_event_init(USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Get the event fast path counters.
+ * @return	Pointer to the counters, updated from interrupt context
+ */
+const HID_Event_Stats_T *hid_event_get_stats(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_EVENT_H_ */
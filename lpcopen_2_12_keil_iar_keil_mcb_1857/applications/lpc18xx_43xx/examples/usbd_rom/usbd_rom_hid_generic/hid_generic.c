@@ -33,40 +33,334 @@
 #include <stdint.h>
 #include <string.h>
 #include "usbd_rom_api.h"
+#include "stopwatch.h"
+#include "hid_generic.h"
+#include "hid_blob.h"
+#include "hid_bench.h"
+#include "hid_stats.h"
+#include "hid_trace.h"
+#include "hid_prof.h"
+#include "hid_mem.h"
+#include "hid_suspend.h"
+#include "hid_sof.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
  ****************************************************************************/
 
-/* Buffer to hold report data */
-static uint8_t *loopback_report;
+#define HID_IN_QUEUE_MASK   (HID_IN_QUEUE_DEPTH - 1)
+#define HID_OUT_QUEUE_MASK  (HID_OUT_QUEUE_DEPTH - 1)
+
+#if HID_HS_EP_MULT > 1
+/* dQH capabilities field bits */
+#define DQH_CAP_MAXP_SHIFT  16
+#define DQH_CAP_MAXP_MASK   (0x7FF << DQH_CAP_MAXP_SHIFT)
+#define DQH_CAP_MULT_MASK   (0x3UL << 30)
+
+/* dQH  Queue Head */
+typedef volatile struct {
+	volatile uint32_t cap;
+	volatile uint32_t curr_dTD;
+	volatile uint32_t next_dTD;
+	volatile uint32_t total_bytes;
+	volatile uint32_t buffer0;
+	volatile uint32_t buffer1;
+	volatile uint32_t buffer2;
+	volatile uint32_t buffer3;
+	volatile uint32_t buffer4;
+	volatile uint32_t reserved;
+	volatile uint32_t setup[2];
+	volatile uint32_t gap[4];
+}  DQH_T;
+#endif
+
+/**
+ * @brief Structure to hold the IN report queue of one logical channel
+ */
+typedef struct {
+	uint8_t *buf[HID_IN_QUEUE_DEPTH];	/*!< IN report buffers in USB RAM */
+	uint16_t len[HID_IN_QUEUE_DEPTH];	/*!< Length of each queued IN report */
+	volatile uint32_t head;	/*!< Producer index, next free IN slot */
+	volatile uint32_t tail;	/*!< Consumer index, oldest queued IN slot */
+	uint8_t reserved;	/*!< Number of slots from head handed out for in place filling */
+#ifdef HID_IN_HEADER
+	uint16_t seq;		/*!< Sequence number of next IN report */
+#endif
+} HID_Chan_Queue_T;
+
+/**
+ * @brief Structure to hold the interrupt endpoint pair of one HID interface
+ */
+typedef struct {
+	uint8_t ep_in;		/*!< Interrupt IN endpoint address */
+	uint8_t ep_out;		/*!< Interrupt OUT endpoint address */
+	volatile uint8_t tx_busy;	/*!< Flag indicating whether a report is pending in endpoint queue. */
+	uint8_t tx_chan;	/*!< Channel which owns the report pending in endpoint queue. */
+	uint8_t *out_buf[HID_OUT_QUEUE_DEPTH];	/*!< OUT report buffers in USB RAM */
+	uint16_t out_len[HID_OUT_QUEUE_DEPTH];	/*!< Length of each received OUT report */
+	uint32_t out_time[HID_OUT_QUEUE_DEPTH];	/*!< StopWatch ticks when each OUT report completed */
+	uint16_t out_frame[HID_OUT_QUEUE_DEPTH];	/*!< Frame index when each OUT report completed */
+	volatile uint32_t out_head;	/*!< Producer index, OUT buffer being received */
+	volatile uint32_t out_tail;	/*!< Consumer index, oldest received OUT report */
+	volatile uint8_t rx_busy;	/*!< Flag indicating a read is pending in endpoint queue. */
+} HID_Intf_T;
+
+/**
+ * @brief Structure to hold the generic HID report pipeline of one port
+ */
+typedef struct {
+	USBD_HANDLE_T hUsb;	/*!< Handle to USB stack, NULL while the entry is free. */
+	LPC_USBHS_T *pRegs;	/*!< Registers of the controller the stack runs on. */
+	HID_Chan_Queue_T chan[HID_NUM_CHANNELS];	/*!< Per channel IN queues, index 0 has highest priority */
+	HID_Intf_T intf[HID_NUM_HID_INTF];	/*!< Endpoints of each HID interface, channels map onto them by HID_CHAN_INTF() */
+	uint8_t out_intf;	/*!< Interface of the OUT report returned by hid_generic_out_get() */
+	uint8_t loopback_value;	/*!< First payload byte of the last SET_REPORT(Output), returned by GET_REPORT(Input) */
+	uint8_t *feature_report;	/*!< USB RAM staging buffer for feature report data stages bigger than EP0Buf */
+} HID_Generic_Ctrl_T;
+
+/** One instance of generic HID control per port */
+static HID_Generic_Ctrl_T g_hidGeneric[HID_NUM_PORTS];
 
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
 
-extern const uint8_t HID_ReportDescriptor[];
-extern const uint16_t HID_ReportDescSize;
+extern const uint8_t *const HID_ReportDescs[HID_NUM_HID_INTF];
+extern const uint16_t HID_ReportDescSizes[HID_NUM_HID_INTF];
 
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
 
+/* Find the instance serving a USB stack handle, NULL if there is none */
+static HID_Generic_Ctrl_T *HID_GetCtrl(USBD_HANDLE_T hUsb)
+{
+	uint32_t i;
+
+	for (i = 0; i < HID_NUM_PORTS; i++) {
+		if ((hUsb != NULL) && (g_hidGeneric[i].hUsb == hUsb)) {
+			return &g_hidGeneric[i];
+		}
+	}
+	return NULL;
+}
+
+/* Drop all queued IN reports */
+static void HID_FlushIn(HID_Generic_Ctrl_T *pHid)
+{
+	uint32_t ch, n;
+
+	for (ch = 0; ch < HID_NUM_CHANNELS; ch++) {
+		pHid->chan[ch].head = pHid->chan[ch].tail = 0;
+		/* a slot handed out before can no longer be committed */
+		pHid->chan[ch].reserved = 0;
+	}
+	for (n = 0; n < HID_NUM_HID_INTF; n++) {
+		pHid->intf[n].tx_busy = 0;
+	}
+}
+
+/* Drop all received OUT reports */
+static void HID_FlushOut(HID_Generic_Ctrl_T *pHid)
+{
+	uint32_t n;
+
+	for (n = 0; n < HID_NUM_HID_INTF; n++) {
+		pHid->intf[n].out_head = pHid->intf[n].out_tail = 0;
+		pHid->intf[n].rx_busy = 0;
+	}
+}
+
+/* Queue a read into the next free OUT buffer if the endpoint is idle, so the
+   next report is taken without NAKing the host. When all buffers wait for
+   the application the host is NAKed until one is released.
+   Must be called from USB ISR context or with USB interrupt disabled. */
+static void HID_ArmNextOut(HID_Generic_Ctrl_T *pHid, HID_Intf_T *pIf)
+{
+	if (pIf->rx_busy || ((pIf->out_head - pIf->out_tail) >= HID_OUT_QUEUE_DEPTH)) {
+		return;
+	}
+	pIf->rx_busy = 1;
+	USBD_API->hw->ReadReqEP(pHid->hUsb, pIf->ep_out, pIf->out_buf[pIf->out_head & HID_OUT_QUEUE_MASK],
+							HID_OUTPUT_REPORT_BYTES);
+}
+
+/* Hand the next report of HID interface n to the controller if its IN
+   endpoint is idle. The scheduler always picks the oldest report of the
+   highest priority channel of the interface that has data, so control
+   replies never wait behind bulk telemetry, and pin events
+   (HID_EVENT_FASTPATH) never wait behind anything.
+   Must be called from USB ISR context or with USB interrupt disabled. */
+static void HID_ArmNextIn(HID_Generic_Ctrl_T *pHid, uint32_t n)
+{
+	HID_Intf_T *pIf = &pHid->intf[n];
+	HID_Chan_Queue_T *pQ;
+	uint32_t i, ch, idx;
+
+	if (pIf->tx_busy) {
+		return;
+	}
+	for (i = 0; i < HID_NUM_CHANNELS; i++) {
+		ch = HID_CHAN_SCHED(i);
+		pQ = &pHid->chan[ch];
+		if ((HID_CHAN_INTF(ch) == n) && (pQ->head != pQ->tail)) {
+			idx = pQ->tail & HID_IN_QUEUE_MASK;
+			pIf->tx_busy = 1;
+			pIf->tx_chan = (uint8_t) ch;
+			USBD_API->hw->WriteEP(pHid->hUsb, pIf->ep_in, pQ->buf[idx], pQ->len[idx]);
+			break;
+		}
+	}
+}
+
+#if HID_HS_EP_MULT > 1
+/* Program the full 1024 byte packet size into the endpoint queue head. The
+   Mult field stays 0 for interrupt endpoints: the controller then answers
+   every IN/OUT token of the microframe from the same dTD, which splits an
+   IN report and reassembles an OUT report across HID_HS_EP_MULT packets. */
+static void HID_SetHsMaxPacket(HID_Generic_Ctrl_T *pHid, uint32_t ep_adr)
+{
+	DQH_T *ep_QH = (DQH_T *) pHid->pRegs->ENDPOINTLISTADDR;
+	uint32_t epIndex = ((ep_adr & 0x0F) << 1) + ((ep_adr & 0x80) ? 1 : 0);
+	uint32_t cap = ep_QH[epIndex].cap;
+
+	cap &= ~(DQH_CAP_MAXP_MASK | DQH_CAP_MULT_MASK);
+	cap |= (HID_HS_EP_MAXPACKET << DQH_CAP_MAXP_SHIFT);
+	ep_QH[epIndex].cap = cap;
+}
+
+#endif
+
+/* Queue the filled head slot of a channel, its payload holds len bytes, and
+   arm the endpoint.
+   Must be called from USB ISR context or with USB interrupt disabled. */
+static void HID_CommitIn(HID_Generic_Ctrl_T *pHid, uint32_t ch, uint32_t len)
+{
+	HID_Chan_Queue_T *pQ = &pHid->chan[ch];
+	uint8_t *pBuf = pQ->buf[pQ->head & HID_IN_QUEUE_MASK];
+
+	pBuf[0] = HID_CHAN_REPORT_ID(ch);
+#ifdef HID_IN_HEADER
+	{
+		/* The frame index register carries the frame number of the last SOF,
+		   reading it saves taking the SOF event 8000 times a second. The
+		   sequence number is not reset by a flush so dropped reports show up
+		   as a gap on the host. */
+		uint32_t frindex = pHid->pRegs->FRINDEX_D & 0x3FFF;
+
+		pBuf[1] = (uint8_t) pQ->seq;
+		pBuf[2] = (uint8_t) (pQ->seq >> 8);
+		pBuf[3] = (uint8_t) frindex;
+		pBuf[4] = (uint8_t) (frindex >> 8);
+		pQ->seq++;
+#ifdef HID_IN_HEADER_CRC
+		{
+			/* the padding of a full size report is not covered */
+			uint16_t crc;
+
+			pBuf[5] = (uint8_t) len;
+			pBuf[6] = (uint8_t) (len >> 8);
+			crc = Chip_CRCSW_CRC16(CRCSW_CRC16_INIT, pBuf, 7);
+			crc = Chip_CRCSW_CRC16(crc, pBuf + 1 + HID_IN_HDR_BYTES, len);
+			pBuf[7] = (uint8_t) crc;
+			pBuf[8] = (uint8_t) (crc >> 8);
+		}
+#endif
+	}
+#endif
+	len += 1 + HID_IN_HDR_BYTES;
+#if HID_HS_EP_MULT > 1
+	/* A report spanning several packets must always be sent in full size, a
+	   shorter one ending on a packet boundary would be merged by the host with
+	   the next report. */
+	memset(pBuf + len, 0, HID_INPUT_REPORT_BYTES - len);
+	len = HID_INPUT_REPORT_BYTES;
+#endif
+	pQ->len[pQ->head & HID_IN_QUEUE_MASK] = (uint16_t) len;
+	pQ->head++;
+
+	HID_ArmNextIn(pHid, HID_CHAN_INTF(ch));
+}
+
+/* Copy a payload behind the channel's report ID into the next free IN slot
+   and arm the endpoint.
+   Must be called from USB ISR context or with USB interrupt disabled. */
+static ErrorCode_t HID_QueueIn(HID_Generic_Ctrl_T *pHid, uint32_t ch, const uint8_t *pData, uint32_t len)
+{
+	HID_Chan_Queue_T *pQ = &pHid->chan[ch];
+
+	/* the head slot may be handed out to the application for in place filling */
+	if (pQ->reserved || ((pQ->head - pQ->tail) >= HID_IN_QUEUE_DEPTH)) {
+		HID_STATS_INC(queue_full);
+		return ERR_BUSY;
+	}
+	memcpy(&pQ->buf[pQ->head & HID_IN_QUEUE_MASK][1 + HID_IN_HDR_BYTES], pData, len);
+	HID_CommitIn(pHid, ch, len);
+
+	return LPC_OK;
+}
+
 /*  HID get report callback function. */
 static ErrorCode_t HID_GetReport(USBD_HANDLE_T hHid, USB_SETUP_PACKET *pSetup, uint8_t * *pBuffer, uint16_t *plength)
 {
-	/* ReportID = SetupPacket.wValue.WB.L; */
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(((USB_HID_CTRL_T *) hHid)->pUsbCtrl);
+	uint32_t n = ((USB_HID_CTRL_T *) hHid)->if_num;
+	uint8_t report_id = pSetup->wValue.WB.L;
+
+	if (pHid == NULL) {
+		return ERR_USBD_STALL;
+	}
+
 	switch (pSetup->wValue.WB.H) {
 	case HID_REPORT_INPUT:
-		*pBuffer[0] = *loopback_report;
-		*plength = 1;
+		if (!HID_IS_CHAN_REPORT_ID(report_id) || (HID_CHAN_INTF(HID_REPORT_ID_CHAN(report_id)) != n)) {
+			return ERR_USBD_STALL;
+		}
+		(*pBuffer)[0] = report_id;
+		(*pBuffer)[1] = pHid->loopback_value;
+		*plength = 2;
 		break;
 
 	case HID_REPORT_OUTPUT:
 		return ERR_USBD_STALL;			/* Not Supported */
 
 	case HID_REPORT_FEATURE:
-		return ERR_USBD_STALL;			/* Not Supported */
+		/* feature reports are only described on interface 0 */
+		if (n != 0) {
+			return ERR_USBD_STALL;
+		}
+		if (report_id == HID_REPORT_ID_BLOB) {
+			*pBuffer = pHid->feature_report;
+			*plength = hid_blob_get_report(pHid->feature_report);
+		}
+		else if (report_id == HID_REPORT_ID_BENCH) {
+			*plength = hid_bench_get_report(*pBuffer);
+		}
+		else if (report_id == HID_REPORT_ID_STATS) {
+			*plength = hid_stats_get_report(*pBuffer);
+		}
+#ifdef HID_ISR_TRACE
+		else if (report_id == HID_REPORT_ID_TRACE) {
+			*pBuffer = pHid->feature_report;
+			*plength = hid_trace_get_report(pHid->feature_report);
+		}
+#endif
+#ifdef CHIP_PROFILE_ENABLE
+		else if (report_id == HID_REPORT_ID_PROF) {
+			*pBuffer = pHid->feature_report;
+			*plength = hid_prof_get_report(pHid->feature_report);
+		}
+#endif
+#ifdef HID_MEMDIAG
+		else if (report_id == HID_REPORT_ID_MEM) {
+			*pBuffer = pHid->feature_report;
+			*plength = hid_mem_get_report(pHid->feature_report);
+		}
+#endif
+		else {
+			return ERR_USBD_STALL;
+		}
+		break;
 	}
 	return LPC_OK;
 }
@@ -74,49 +368,110 @@ static ErrorCode_t HID_GetReport(USBD_HANDLE_T hHid, USB_SETUP_PACKET *pSetup, u
 /* HID set report callback function. */
 static ErrorCode_t HID_SetReport(USBD_HANDLE_T hHid, USB_SETUP_PACKET *pSetup, uint8_t * *pBuffer, uint16_t length)
 {
-	/* we will reuse standard EP0Buf */
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(((USB_HID_CTRL_T *) hHid)->pUsbCtrl);
+	uint32_t n = ((USB_HID_CTRL_T *) hHid)->if_num;
+
+	if (pHid == NULL) {
+		return ERR_USBD_STALL;
+	}
+	if ((pSetup->wValue.WB.H == HID_REPORT_FEATURE) && (n != 0)) {
+		return ERR_USBD_STALL;
+	}
 	if (length == 0) {
+		/* feature reports do not fit EP0Buf, receive them in our own buffer.
+		   Everything else reuses standard EP0Buf. */
+		if (pSetup->wValue.WB.H == HID_REPORT_FEATURE) {
+			*pBuffer = pHid->feature_report;
+		}
 		return LPC_OK;
 	}
 
-	/* ReportID = SetupPacket.wValue.WB.L; */
 	switch (pSetup->wValue.WB.H) {
 	case HID_REPORT_INPUT:
 		return ERR_USBD_STALL;			/* Not Supported */
 
 	case HID_REPORT_OUTPUT:
-		*loopback_report = **pBuffer;
+		/* first byte of the data stage is the report ID */
+		if ((length < 2) || !HID_IS_CHAN_REPORT_ID((*pBuffer)[0]) ||
+			(HID_CHAN_INTF(HID_REPORT_ID_CHAN((*pBuffer)[0])) != n)) {
+			return ERR_USBD_STALL;
+		}
+		pHid->loopback_value = (*pBuffer)[1];
 		break;
 
 	case HID_REPORT_FEATURE:
-		return ERR_USBD_STALL;			/* Not Supported */
+		if (pSetup->wValue.WB.L == HID_REPORT_ID_BENCH) {
+			return hid_bench_set_report(pHid->hUsb, *pBuffer, length);
+		}
+		if (pSetup->wValue.WB.L == HID_REPORT_ID_STATS) {
+			return hid_stats_set_report(*pBuffer, length);
+		}
+#ifdef CHIP_PROFILE_ENABLE
+		if (pSetup->wValue.WB.L == HID_REPORT_ID_PROF) {
+			return hid_prof_set_report(*pBuffer, length);
+		}
+#endif
+#ifdef HID_MEMDIAG
+		if (pSetup->wValue.WB.L == HID_REPORT_ID_MEM) {
+			return hid_mem_set_report(*pBuffer, length);
+		}
+#endif
+		return hid_blob_set_report(*pBuffer, length);
 	}
 	return LPC_OK;
 }
 
-/* HID Interrupt endpoint event handler. */
+/* HID Interrupt endpoint event handler, data is the HID function driver of
+   the interface the endpoint belongs to. */
 static ErrorCode_t HID_Ep_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 {
-	USB_HID_CTRL_T *pHidCtrl = (USB_HID_CTRL_T *) data;
-	unsigned int report_pending = 0;
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	uint32_t n = ((USB_HID_CTRL_T *) data)->if_num;
+	uint32_t idx, cyc = hid_stats_cyc_start();
+	HID_Intf_T *pIf;
+	PROFILE_ENTER(HID_PROF_EP_HDLR);
+
+	if ((pHid == NULL) || (n >= HID_NUM_HID_INTF)) {
+		return LPC_OK;
+	}
+	pIf = &pHid->intf[n];
 
 	switch (event) {
 	case USB_EVT_IN:
-		report_pending = 0;
+		HID_STATS_INC(in_complete);
+#ifdef HID_SOF_SCHED
+		/* the frame index still holds the frame the host polled in */
+		hid_sof_in_done(hUsb, pIf->tx_chan);
+#endif
+		/* controller is done with the slot, release it and send the next one */
+		pHid->chan[pIf->tx_chan].tail++;
+		pIf->tx_busy = 0;
+		HID_ArmNextIn(pHid, n);
+#ifdef HID_SUSPEND
+		hid_suspend_in_done(hUsb);
+#endif
 		break;
 
 	case USB_EVT_OUT_NAK:
-		USBD_API->hw->ReadReqEP(hUsb, pHidCtrl->epout_adr, loopback_report, 1);
+		/* only seen while no read is queued */
+		HID_STATS_INC(out_nak);
+		HID_ArmNextOut(pHid, pIf);
 		break;
 
 	case USB_EVT_OUT:
-		USBD_API->hw->ReadEP(hUsb, pHidCtrl->epout_adr, loopback_report);
-		if (!report_pending) {
-			report_pending = 1;
-			USBD_API->hw->WriteEP(hUsb, pHidCtrl->epin_adr, loopback_report, 1);
-		}
+		HID_STATS_INC(out_complete);
+		/* hand the report to the application and re-arm right away */
+		idx = pIf->out_head & HID_OUT_QUEUE_MASK;
+		pIf->out_time[idx] = StopWatch_Start();
+		pIf->out_frame[idx] = (uint16_t) (pHid->pRegs->FRINDEX_D & 0x3FFF);
+		pIf->out_len[idx] = (uint16_t) USBD_API->hw->ReadEP(hUsb, pIf->ep_out, pIf->out_buf[idx]);
+		pIf->out_head++;
+		pIf->rx_busy = 0;
+		HID_ArmNextOut(pHid, pIf);
 		break;
 	}
+	hid_stats_cyc_end(cyc);
+	PROFILE_EXIT(HID_PROF_EP_HDLR);
 	return LPC_OK;
 }
 
@@ -127,27 +482,54 @@ static ErrorCode_t HID_Ep_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 /* HID init routine */
 ErrorCode_t usb_hid_init(USBD_HANDLE_T hUsb,
 						 USB_INTERFACE_DESCRIPTOR *pIntfDesc,
-						 uint32_t *mem_base,
-						 uint32_t *mem_size)
+						 USBMEM_T *pMem,
+						 uint32_t usb_reg_base)
 {
 	USBD_HID_INIT_PARAM_T hid_param;
 	USB_HID_REPORT_T reports_data[1];
 	ErrorCode_t ret = LPC_OK;
+	HID_Generic_Ctrl_T *pHid;
+	HID_Intf_T *pIf;
+	uint32_t ch, i, n;
+	uint8_t *pBuf;
+
+	if ((pIntfDesc == 0) || (pIntfDesc->bInterfaceClass != USB_DEVICE_CLASS_HUMAN_INTERFACE) ||
+		(pIntfDesc->bInterfaceNumber >= HID_NUM_HID_INTF)) {
+		return ERR_FAILED;
+	}
+	n = pIntfDesc->bInterfaceNumber;
+#ifdef HID_IN_HEADER_CRC
+	/* build the CRC tables now rather than in the first IN commit */
+	Chip_CRCSW_Init();
+#endif
+
+	if (n == 0) {
+		/* take the first free instance */
+		for (i = 0; (i < HID_NUM_PORTS) && (g_hidGeneric[i].hUsb != NULL); i++) {}
+		if (i == HID_NUM_PORTS) {
+			return ERR_FAILED;
+		}
+		pHid = &g_hidGeneric[i];
+	}
+	else {
+		/* further interfaces join the instance of interface 0 */
+		pHid = HID_GetCtrl(hUsb);
+		if (pHid == NULL) {
+			return ERR_FAILED;
+		}
+	}
+	pIf = &pHid->intf[n];
 
 	memset((void *) &hid_param, 0, sizeof(USBD_HID_INIT_PARAM_T));
 	/* HID paramas */
 	hid_param.max_reports = 1;
 	/* Init reports_data */
-	reports_data[0].len = HID_ReportDescSize;
+	reports_data[0].len = HID_ReportDescSizes[n];
 	reports_data[0].idle_time = 0;
-	reports_data[0].desc = (uint8_t *) &HID_ReportDescriptor[0];
-
-	if ((pIntfDesc == 0) || (pIntfDesc->bInterfaceClass != USB_DEVICE_CLASS_HUMAN_INTERFACE)) {
-		return ERR_FAILED;
-	}
+	reports_data[0].desc = (uint8_t *) HID_ReportDescs[n];
 
-	hid_param.mem_base = *mem_base;
-	hid_param.mem_size = *mem_size;
+	hid_param.mem_base = pMem->mem_base;
+	hid_param.mem_size = pMem->mem_size;
 	hid_param.intf_desc = (uint8_t *) pIntfDesc;
 	/* user defined functions */
 	hid_param.HID_GetReport = HID_GetReport;
@@ -157,12 +539,294 @@ ErrorCode_t usb_hid_init(USBD_HANDLE_T hUsb,
 	hid_param.report_data  = reports_data;
 
 	ret = USBD_API->hid->init(hUsb, &hid_param);
-	/* allocate USB accessable memory space for report data */
-	loopback_report =  (uint8_t *) hid_param.mem_base;
-	hid_param.mem_base += 4;
-	hid_param.mem_size += 4;
-	/* update memory variables */
-	*mem_base = hid_param.mem_base;
-	*mem_size = hid_param.mem_size;
+	if (ret != LPC_OK) {
+		return ret;
+	}
+	ret = UsbMem_Update(pMem, hid_param.mem_base, hid_param.mem_size);
+	if (ret != LPC_OK) {
+		return ret;
+	}
+
+	/* allocate USB accessable memory space for the OUT reports of the interface */
+	pIf->ep_in = HID_INTF_EP_IN(n);
+	pIf->ep_out = HID_INTF_EP_OUT(n);
+	for (i = 0; i < HID_OUT_QUEUE_DEPTH; i++) {
+		pIf->out_buf[i] = UsbMem_Alloc(pMem, HID_OUTPUT_REPORT_BYTES, 4);
+		if (pIf->out_buf[i] == NULL) {
+			return ERR_FAILED;
+		}
+	}
+	if (n != 0) {
+		return ret;
+	}
+
+	/* and for feature report and the IN report queues of all channels */
+	pHid->feature_report = UsbMem_Alloc(pMem, HID_FEATURE_REPORT_BYTES, 4);
+	if (pHid->feature_report == NULL) {
+		return ERR_FAILED;
+	}
+	memset(pHid->feature_report, 0, HID_FEATURE_REPORT_BYTES);
+	for (ch = 0; ch < HID_NUM_CHANNELS; ch++) {
+		for (i = 0; i < HID_IN_QUEUE_DEPTH; i++) {
+			/* Start each slot 3 bytes into a word so the payload behind the report
+			   ID (and the 4 byte header) is word aligned for DMA filling; the
+			   controller takes any byte address for a transfer. */
+			pBuf = UsbMem_Alloc(pMem, HID_INPUT_REPORT_BYTES + 3, 4);
+			if (pBuf == NULL) {
+				return ERR_FAILED;
+			}
+			pHid->chan[ch].buf[i] = pBuf + 3;
+			pHid->chan[ch].len[i] = 0;
+		}
+	}
+	pHid->pRegs = (LPC_USBHS_T *) usb_reg_base;
+	HID_FlushIn(pHid);
+	HID_FlushOut(pHid);
+	/* the instance only serves events once it is complete */
+	pHid->hUsb = hUsb;
+
 	return ret;
 }
+
+/* USB Configure Event Callback */
+ErrorCode_t hid_generic_configure_event(USBD_HANDLE_T hUsb)
+{
+	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	uint32_t n;
+
+	if (pHid == NULL) {
+		return LPC_OK;
+	}
+	/* endpoints were just (re)configured, nothing is pending on them anymore */
+	HID_FlushIn(pHid);
+	HID_FlushOut(pHid);
+
+	if (pCtrl->config_value != 0) {
+		for (n = 0; n < HID_NUM_HID_INTF; n++) {
+#if HID_HS_EP_MULT > 1
+			if (pCtrl->device_speed == USB_HIGH_SPEED) {
+				HID_SetHsMaxPacket(pHid, pHid->intf[n].ep_in);
+				HID_SetHsMaxPacket(pHid, pHid->intf[n].ep_out);
+			}
+#endif
+			/* pre-queue the first OUT buffer instead of waiting for a NAK */
+			HID_ArmNextOut(pHid, &pHid->intf[n]);
+		}
+	}
+#ifdef HID_SOF_SCHED
+	hid_sof_configure(hUsb);
+#endif
+	return LPC_OK;
+}
+
+/* Queue an IN report for transmission */
+ErrorCode_t hid_generic_send(USBD_HANDLE_T hUsb, uint32_t chan, const uint8_t *pData, uint32_t len)
+{
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	ErrorCode_t ret;
+
+	if (pHid == NULL) {
+		return ERR_API_INVALID_PARAM1;
+	}
+	if (chan >= HID_NUM_CHANNELS) {
+		return ERR_API_INVALID_PARAM2;
+	}
+	if (len > HID_CHAN_PAYLOAD_BYTES) {
+		return ERR_API_INVALID_PARAMS;
+	}
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	if (USB_IsConfigured(pHid->hUsb)) {
+		ret = HID_QueueIn(pHid, chan, pData, len);
+	}
+	else {
+		/* drop anything queued before we got disconnected. */
+		HID_FlushIn(pHid);
+		ret = ERR_FAILED;
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return ret;
+}
+
+/* Hand out the next free IN slot of a channel for in place filling */
+uint8_t *hid_generic_slot_get(USBD_HANDLE_T hUsb, uint32_t chan)
+{
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	HID_Chan_Queue_T *pQ;
+	uint8_t *pSlot = NULL;
+
+	if ((pHid == NULL) || (chan >= HID_NUM_CHANNELS)) {
+		return NULL;
+	}
+	pQ = &pHid->chan[chan];
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	if (pQ->reserved) {
+		/* the application still owns it, hand out the same slot again */
+		pSlot = &pQ->buf[pQ->head & HID_IN_QUEUE_MASK][1 + HID_IN_HDR_BYTES];
+	}
+	else if (USB_IsConfigured(pHid->hUsb) && ((pQ->head - pQ->tail) < HID_IN_QUEUE_DEPTH)) {
+		pQ->reserved = 1;
+		pSlot = &pQ->buf[pQ->head & HID_IN_QUEUE_MASK][1 + HID_IN_HDR_BYTES];
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return pSlot;
+}
+
+/* Hand out the IN slot behind the ones already handed out */
+uint8_t *hid_generic_slot_get_next(USBD_HANDLE_T hUsb, uint32_t chan)
+{
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	HID_Chan_Queue_T *pQ;
+	uint8_t *pSlot = NULL;
+
+	if ((pHid == NULL) || (chan >= HID_NUM_CHANNELS)) {
+		return NULL;
+	}
+	pQ = &pHid->chan[chan];
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	if (USB_IsConfigured(pHid->hUsb) && ((pQ->head - pQ->tail + pQ->reserved) < HID_IN_QUEUE_DEPTH)) {
+		pSlot = &pQ->buf[(pQ->head + pQ->reserved) & HID_IN_QUEUE_MASK][1 + HID_IN_HDR_BYTES];
+		pQ->reserved++;
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return pSlot;
+}
+
+/* Queue an IN slot filled in place */
+ErrorCode_t hid_generic_slot_commit(USBD_HANDLE_T hUsb, uint32_t chan, uint32_t len)
+{
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	ErrorCode_t ret = LPC_OK;
+
+	if (pHid == NULL) {
+		return ERR_API_INVALID_PARAM1;
+	}
+	if (chan >= HID_NUM_CHANNELS) {
+		return ERR_API_INVALID_PARAM2;
+	}
+	if (len > HID_CHAN_PAYLOAD_BYTES) {
+		return ERR_API_INVALID_PARAM3;
+	}
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	if (pHid->chan[chan].reserved) {
+		/* slots are committed in the order they were handed out */
+		pHid->chan[chan].reserved--;
+		HID_CommitIn(pHid, chan, len);
+	}
+	else {
+		/* never handed out, or dropped by a bus reset/reconfiguration */
+		ret = ERR_FAILED;
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return ret;
+}
+
+/* Get the oldest received OUT report */
+uint8_t *hid_generic_out_get(USBD_HANDLE_T hUsb, uint32_t *pLen)
+{
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	HID_Intf_T *pIf;
+	uint8_t *pReport = NULL;
+	uint32_t idx, n;
+
+	if (pHid == NULL) {
+		return NULL;
+	}
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	for (n = 0; n < HID_NUM_HID_INTF; n++) {
+		pIf = &pHid->intf[n];
+		if (pIf->out_head != pIf->out_tail) {
+			idx = pIf->out_tail & HID_OUT_QUEUE_MASK;
+			*pLen = pIf->out_len[idx];
+			pReport = pIf->out_buf[idx];
+			pHid->out_intf = (uint8_t) n;
+			break;
+		}
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return pReport;
+}
+
+/* Arrival time of the report returned by hid_generic_out_get() */
+uint32_t hid_generic_out_stamp(USBD_HANDLE_T hUsb, uint16_t *pFrame)
+{
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	HID_Intf_T *pIf;
+	uint32_t idx;
+
+	if (pHid == NULL) {
+		return 0;
+	}
+	/* the entry is not touched by the interrupt until it is released */
+	pIf = &pHid->intf[pHid->out_intf];
+	idx = pIf->out_tail & HID_OUT_QUEUE_MASK;
+	if (pFrame != NULL) {
+		*pFrame = pIf->out_frame[idx];
+	}
+	return pIf->out_time[idx];
+}
+
+/* Frame index of the port */
+uint16_t hid_generic_frame_index(USBD_HANDLE_T hUsb)
+{
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+
+	return (pHid != NULL) ? (uint16_t) (pHid->pRegs->FRINDEX_D & 0x3FFF) : 0;
+}
+
+/* Give the oldest OUT buffer back to the endpoint */
+void hid_generic_out_release(USBD_HANDLE_T hUsb)
+{
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	HID_Intf_T *pIf;
+
+	if (pHid == NULL) {
+		return;
+	}
+	pIf = &pHid->intf[pHid->out_intf];
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	if (pIf->out_head != pIf->out_tail) {
+		pIf->out_tail++;
+		if (USB_IsConfigured(pHid->hUsb)) {
+			HID_ArmNextOut(pHid, pIf);
+		}
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+}
+
+/* Number of free IN report slots of a channel */
+uint32_t hid_generic_in_free(USBD_HANDLE_T hUsb, uint32_t chan)
+{
+	HID_Generic_Ctrl_T *pHid = HID_GetCtrl(hUsb);
+	HID_Chan_Queue_T *pQ;
+
+	if ((pHid == NULL) || (chan >= HID_NUM_CHANNELS)) {
+		return 0;
+	}
+	pQ = &pHid->chan[chan];
+
+	return HID_IN_QUEUE_DEPTH - (pQ->head - pQ->tail);
+}
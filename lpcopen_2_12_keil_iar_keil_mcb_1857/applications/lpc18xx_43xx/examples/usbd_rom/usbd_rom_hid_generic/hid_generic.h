@@ -33,6 +33,7 @@
 #define __HID_GENERIC_H_
 
 #include "app_usbd_cfg.h"
+#include "usb_mem.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -47,15 +48,136 @@ extern "C"
  * @brief	Generic HID interface init routine.
  * @param	hUsb		: Handle to USB device stack
  * @param	pIntfDesc	: Pointer to HID interface descriptor
- * @param	mem_base	: Pointer to memory address which can be used by HID driver
- * @param	mem_size	: Size of the memory passed
- * @return	On success returns LPC_OK. Params mem_base and mem_size are updated
- *			to point to new base and available size.
+ * @param	pMem		: Pointer to USB RAM arena used by HID driver and report buffers
+ * @param	usb_reg_base	: Register base of the controller @a hUsb runs on
+ * @return	On success returns LPC_OK. The memory taken is accounted in @a pMem.
+ * @note	Call once per HID interface of a port, interface 0 first; the
+ *			bInterfaceNumber of @a pIntfDesc selects the report descriptor
+ *			and endpoints. Up to HID_NUM_PORTS ports run side by side. All
+ *			other functions take the stack handle of the port they act on
+ *			and reach the interface through the channel.
  */
 ErrorCode_t usb_hid_init(USBD_HANDLE_T hUsb,
 						 USB_INTERFACE_DESCRIPTOR *pIntfDesc,
-						 uint32_t *mem_base,
-						 uint32_t *mem_size);
+						 USBMEM_T *pMem,
+						 uint32_t usb_reg_base);
+
+/**
+ * @brief	USB configure event handler of the generic HID interface.
+ * @param	hUsb	: Handle to USB device stack
+ * @return	Always returns LPC_OK.
+ * @note	Should be installed as USBD_API_INIT_PARAM_T::USB_Configure_Event.
+ *			In HID_HS_HIGH_BANDWIDTH mode it programs the 1024 byte packet
+ *			size of the HS interrupt endpoints into their queue heads.
+ */
+ErrorCode_t hid_generic_configure_event(USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Queue an IN report for transmission on a logical channel.
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @param	chan	: Logical channel, HID_CHAN_CONTROL .. HID_NUM_CHANNELS - 1
+ * @param	pData	: Pointer to report payload, copied into a USB RAM report
+ *					  buffer behind the channel's report ID
+ * @param	len		: Length of the payload, at most HID_CHAN_PAYLOAD_BYTES
+ * @return	LPC_OK when the report was queued, ERR_BUSY when all
+ *			HID_IN_QUEUE_DEPTH buffers of the channel are in use, ERR_FAILED
+ *			when the device is not configured and ERR_API_INVALID_PARAMx
+ *			for a bad argument. The call never blocks.
+ * @note	Whenever the IN endpoint of the channel's HID interface
+ *			(HID_CHAN_INTF()) becomes free the oldest report of the lowest
+ *			numbered non-empty channel of that interface is sent next.
+ */
+ErrorCode_t hid_generic_send(USBD_HANDLE_T hUsb, uint32_t chan, const uint8_t *pData, uint32_t len);
+
+/**
+ * @brief	Get the next free IN report slot of a channel for in place filling.
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @param	chan	: Logical channel
+ * @return	Pointer to the payload area of the slot in USB RAM, right behind
+ *			the report ID (and header when HID_IN_HEADER is set) and word aligned, or NULL when the channel queue is
+ *			full or the device is not configured.
+ * @note	The application (or a DMA channel) writes up to
+ *			HID_CHAN_PAYLOAD_BYTES into the slot, then hands it to the
+ *			controller with hid_generic_slot_commit(); nothing is copied. Until
+ *			then the same slot is returned again and hid_generic_send() on the
+ *			channel returns ERR_BUSY.
+ */
+uint8_t *hid_generic_slot_get(USBD_HANDLE_T hUsb, uint32_t chan);
+
+/**
+ * @brief	Get one more IN report slot of a channel, behind the slots already
+ *			handed out.
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @param	chan	: Logical channel
+ * @return	Pointer to the payload area of the slot, as for
+ *			hid_generic_slot_get(), or NULL when the channel queue has no
+ *			further free slot or the device is not configured.
+ * @note	Lets a DMA channel move on to the next slot before the CPU has
+ *			committed the current one. Each hid_generic_slot_commit() queues
+ *			the oldest slot handed out, and hid_generic_slot_get() returns
+ *			that slot while any is handed out.
+ */
+uint8_t *hid_generic_slot_get_next(USBD_HANDLE_T hUsb, uint32_t chan);
+
+/**
+ * @brief	Queue the IN report slot obtained with hid_generic_slot_get().
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @param	chan	: Logical channel
+ * @param	len		: Number of payload bytes written into the slot
+ * @return	LPC_OK on success, ERR_FAILED when no slot was handed out or it
+ *			was dropped by a bus reset or reconfiguration.
+ */
+ErrorCode_t hid_generic_slot_commit(USBD_HANDLE_T hUsb, uint32_t chan, uint32_t len);
+
+/**
+ * @brief	Get the oldest OUT report received on the interrupt OUT endpoints.
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @param	pLen	: Pointer to store the report length, report ID included
+ * @return	Pointer to the report in USB RAM, report ID in the first byte, or
+ *			NULL when no report is waiting.
+ * @note	Reports are received into a ring of HID_OUT_QUEUE_DEPTH buffers,
+ *			the next buffer is queued to the controller as soon as one
+ *			completes. The host is only NAKed once all of them hold reports
+ *			the application has not released with hid_generic_out_release().
+ *			With several HID interfaces each has its own ring, interface 0
+ *			is served first; the report ID tells the channel.
+ */
+uint8_t *hid_generic_out_get(USBD_HANDLE_T hUsb, uint32_t *pLen);
+
+/**
+ * @brief	Get the arrival time of the report returned by hid_generic_out_get().
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @param	pFrame	: Pointer to store the frame index at arrival, may be NULL
+ * @return	StopWatch_Start() ticks taken when the OUT endpoint interrupt
+ *			completed the report
+ * @note	Valid until hid_generic_out_release(). The stopwatch must have
+ *			been started with StopWatch_Init().
+ */
+uint32_t hid_generic_out_stamp(USBD_HANDLE_T hUsb, uint16_t *pFrame);
+
+/**
+ * @brief	Read the frame index of a port.
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @return	FRINDEX_D, the number of the current microframe modulo 2^14 at
+ *			high speed, the frame number times 8 at full speed
+ */
+uint16_t hid_generic_frame_index(USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Release the report returned by hid_generic_out_get() so its buffer
+ *			can receive again.
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @return	Nothing
+ */
+void hid_generic_out_release(USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Get number of free IN report buffers of a channel.
+ * @param	hUsb	: Handle to USB device stack of the port
+ * @param	chan	: Logical channel
+ * @return	Number of reports that can be queued on @a chan with hid_generic_send().
+ */
+uint32_t hid_generic_in_free(USBD_HANDLE_T hUsb, uint32_t chan);
 
 /**
  * @}
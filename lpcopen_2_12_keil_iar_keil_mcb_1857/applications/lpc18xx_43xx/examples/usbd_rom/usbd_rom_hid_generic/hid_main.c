@@ -33,16 +33,68 @@
 #include <stdio.h>
 #include <string.h>
 #include "app_usbd_cfg.h"
+#include "stopwatch.h"
+#include "usbd_ep0patch.h"
+#include "usbd_descidx.h"
+#include "board_log.h"
+#include "itm_trace.h"
 #include "hid_generic.h"
+#include "hid_bench.h"
+#include "hid_coalesce.h"
+#include "hid_pack.h"
+#include "hid_sof.h"
+#include "hid_adc.h"
+#include "hid_bulk.h"
+#include "hid_stats.h"
+#include "hid_trace.h"
+#include "hid_prof.h"
+#include "hid_mem.h"
+#include "hid_suspend.h"
+#include "hid_event.h"
+#include "hid_can.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
  ****************************************************************************/
-static USBD_HANDLE_T g_hUsb;
+/* One USB controller running the HID function */
+typedef struct {
+	uint32_t usb_reg_base;				/*!< LPC_USB0_BASE or LPC_USB1_BASE */
+	IRQn_Type irq;						/*!< Controller interrupt */
+	void (*init_pin_clk)(void);			/*!< Enables the clocks and pinmux */
+	uint32_t mem_base;					/*!< Start of the ROM stack memory window */
+	const uint8_t *pHsDesc;				/*!< Configuration used at high speed */
+	const uint8_t *pQualifier;			/*!< Device qualifier, NULL for full speed only */
+	USBD_HANDLE_T hUsb;					/*!< Handle from the ROM stack */
+	USBMEM_T usbMem;					/*!< USB accessible memory of this port */
+	USBEP0PATCH_T ep0Patch;				/*!< EP0 NAK workaround of this port */
+	USBDESCIDX_T descIdx;				/*!< Cached descriptor index of this port */
+} HID_Port_T;
 
-/* Endpoint 0 patch that prevents nested NAK event processing */
-static uint32_t g_ep0RxBusy = 0;/* flag indicating whether EP0 OUT/RX buffer is busy. */
-static USB_EP_HANDLER_T g_Ep0BaseHdlr;	/* variable to store the pointer to base EP0 handler */
+/* USB0 is port 0, USB1 is the last port. USB1 has only a full speed PHY, so
+   to pass USBCV test it has both descriptor arrays point to the same
+   location and device_qualifier set to 0. */
+static HID_Port_T g_port[HID_NUM_PORTS] = {
+#ifdef USE_USB0
+	{LPC_USB0_BASE, USB0_IRQn, Chip_USB0_Init, USB0_STACK_MEM_BASE,
+	 USB_HsConfigDescriptor, USB_DeviceQualifier},
+#endif
+#ifdef USE_USB1
+	{LPC_USB1_BASE, USB1_IRQn, Chip_USB1_Init, USB1_STACK_MEM_BASE,
+	 USB_FsConfigDescriptor, NULL},
+#endif
+};
+
+/* Telemetry sample rate, one new sample per SysTick */
+#define TELEMETRY_RATE_HZ   (1000)
+
+static volatile uint32_t g_sampleCnt;	/* samples produced by SysTick */
+static uint32_t g_sampleSent;			/* samples already reported to host */
+static uint32_t g_sampleLogged;			/* last sample given a log line */
+
+#ifdef HID_SCT_TSTAMP
+static SCTTS_EVENT_T g_tsQueue[HID_SCT_TSTAMP_DEPTH];
+static SCTTS_EVENT_T g_tsLast;			/* latest event reported to host */
+#endif
 
 /*****************************************************************************
  * Public types/enumerations/variables
@@ -53,28 +105,256 @@ const USBD_API_T *g_pUsbApi;
  * Private functions
  ****************************************************************************/
 
-/* EP0_patch part of WORKAROUND for artf45032. */
-ErrorCode_t EP0_patch(USBD_HANDLE_T hUsb, void *data, uint32_t event)
+/* Offer received OUT reports to the benchmark, else loop them back on the
+   channel they came from. A report waits in the OUT queue while that
+   channel's IN queue is full, so a burst from the host is throttled by NAKs
+   instead of losing reports. With HID_CAN_BRIDGE the telemetry channel
+   reports of port 0 carry frames to send on the bus instead, they wait the
+   same way while the send queue is full. */
+static void out_loopback(USBD_HANDLE_T hUsb)
 {
-	switch (event) {
-	case USB_EVT_OUT_NAK:
-		if (g_ep0RxBusy) {
-			/* we already queued the buffer so ignore this NAK event. */
-			return LPC_OK;
+	uint8_t *pReport;
+	uint32_t len, ch;
+
+	while ((pReport = hid_generic_out_get(hUsb, &len)) != NULL) {
+		if (!hid_bench_out(hUsb, pReport, len) && (len > 1) && HID_IS_CHAN_REPORT_ID(pReport[0])) {
+			ch = HID_REPORT_ID_CHAN(pReport[0]);
+#ifdef HID_CAN_BRIDGE
+			if ((hUsb == g_port[0].hUsb) && (ch == HID_CHAN_TELEMETRY)) {
+				if ((hid_can_out(&pReport[1], len - 1) == ERR_BUSY) && USB_IsConfigured(hUsb)) {
+					break;
+				}
+				hid_generic_out_release(hUsb);
+				continue;
+			}
+#endif
+			if ((hid_generic_in_free(hUsb, ch) == 0) && USB_IsConfigured(hUsb)) {
+				break;
+			}
+			hid_generic_send(hUsb, ch, &pReport[1], MIN(len - 1, HID_CHAN_PAYLOAD_BYTES));
 		}
-		else {
-			/* Mark EP0_RX buffer as busy and allow base handler to queue the buffer. */
-			g_ep0RxBusy = 1;
+		hid_generic_out_release(hUsb);
+	}
+}
+
+#ifdef HID_VENDOR_BULK
+/* USB Configure Event Callback of the composite device */
+static ErrorCode_t Composite_Configure_Event(USBD_HANDLE_T hUsb)
+{
+	hid_generic_configure_event(hUsb);
+	return hid_bulk_configure_event(hUsb);
+}
+
+/* Loop bulk OUT transfers back on the bulk IN endpoint */
+static void bulk_loopback(void)
+{
+	uint8_t *pOut, *pIn;
+	uint32_t len;
+
+	while ((pOut = hid_bulk_out_get(&len)) != NULL) {
+		if (len != 0) {
+			pIn = hid_bulk_in_get();
+			if (pIn == NULL) {
+				/* IN queue full, the OUT buffer is kept until there is room */
+				if (USB_IsConfigured(g_port[0].hUsb)) {
+					break;
+				}
+			}
+			else {
+				memcpy(pIn, pOut, len);
+				hid_bulk_in_commit(len);
+			}
 		}
-		break;
+		hid_bulk_out_release();
+	}
+}
 
-	case USB_EVT_SETUP:	/* reset the flag when new setup sequence starts */
-	case USB_EVT_OUT:
-		/* we received the packet so clear the flag. */
-		g_ep0RxBusy = 0;
-		break;
+#endif
+
+#ifdef HID_SCT_TSTAMP
+/* Drain the captured events, keep the latest one for the next report */
+static uint32_t tstamp_drain(void)
+{
+	SCTTS_EVENT_T ev;
+	uint32_t n = 0;
+
+	while (Chip_SCTTS_Pop(&ev)) {
+		g_tsLast = ev;
+		n++;
+	}
+	return n;
+}
+
+/* Store a 32-bit value little endian */
+static void put_u32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) (v >> 16);
+	p[3] = (uint8_t) (v >> 24);
+}
+
+#endif
+
+#if !defined(HID_TELEMETRY_PACK) && !defined(HID_ADC_STREAM) && !defined(HID_CAN_BRIDGE)
+/* Fill a telemetry report with the samples up to sample */
+static void telemetry_build(uint8_t *buf, uint32_t sample)
+{
+	memset(buf, 0, HID_CHAN_PAYLOAD_BYTES);
+	buf[0] = (uint8_t) sample;
+	buf[1] = (uint8_t) (sample >> 8);
+	buf[2] = (uint8_t) (sample >> 16);
+	buf[3] = (uint8_t) (sample >> 24);
+	buf[4] = (uint8_t) (sample - g_sampleSent);	/* samples covered */
+#ifdef HID_SCT_TSTAMP
+	buf[8] = (uint8_t) MIN(tstamp_drain(), 0xFF);	/* events covered */
+	buf[9] = g_tsLast.input;
+	put_u32(&buf[12], g_tsLast.ticks);
+	/* last, so the stamp is as close to the commit as possible */
+	put_u32(&buf[16], Chip_SCTTS_Now(LPC_SCT));
+#endif
+}
+
+#endif
+
+#ifdef HID_SOF_SCHED
+/* Capture point of the SOF scheduler, HID_SOF_LEAD_US ahead of the host
+   poll, called from the USB interrupt. A real application latches its
+   sensors here. */
+static uint32_t telemetry_capture(uint8_t *buf)
+{
+	uint32_t sample = g_sampleCnt;
+
+	/* while a benchmark runs it owns the channel */
+	if (hid_bench_active(g_port[0].hUsb)) {
+		return 0;
 	}
-	return g_Ep0BaseHdlr(hUsb, data, event);
+	telemetry_build(buf, sample);
+	g_sampleSent = sample;
+	return HID_CHAN_PAYLOAD_BYTES;
+}
+
+#endif
+
+#ifdef HID_TELEMETRY_PACK
+/* Stand-in for the application's sensor channels: slow triangle waves of
+   different slopes, derived from the sample number */
+static void telemetry_frame(uint32_t sample, int16_t *pFrame)
+{
+	uint32_t i, t;
+
+	for (i = 0; i < HID_PACK_CHANNELS; i++) {
+		t = (sample * (i + 1)) & 0x1FFF;
+		pFrame[i] = (int16_t) ((t < 0x1000 ? t : (0x1FFF - t)) - 0x800);
+	}
+}
+
+#endif
+
+/* Service a USB interrupt of one port */
+static HOTFUNC void port_isr(HID_Port_T *pPort)
+{
+	PROFILE_ENTER(HID_PROF_USB_ISR);
+	ITM_TRACE2(ITM_EV_USB_IRQ_ENTER, pPort - g_port, ((LPC_USBHS_T *) pPort->usb_reg_base)->USBSTS_D);
+
+#ifdef HID_SUSPEND
+	hid_suspend_isr();
+#endif
+#ifdef HID_ISR_TRACE
+	hid_trace_isr(pPort->hUsb, (LPC_USBHS_T *) pPort->usb_reg_base, pPort - g_port);
+#else
+	USBD_API->hw->ISR(pPort->hUsb);
+#endif
+	ITM_TRACE(ITM_EV_USB_IRQ_EXIT);
+	PROFILE_EXIT(HID_PROF_USB_ISR);
+}
+
+/* Bring up the ROM stack and the HID function on one controller */
+static ErrorCode_t port_init(HID_Port_T *pPort)
+{
+	USBD_API_INIT_PARAM_T usb_param;
+	USB_CORE_DESCS_T desc;
+	ErrorCode_t ret = LPC_OK;
+	uint32_t i;
+
+	/* enable clocks and pinmux */
+	pPort->init_pin_clk();
+
+	/* initialize call back structures */
+	memset((void *) &usb_param, 0, sizeof(USBD_API_INIT_PARAM_T));
+	usb_param.usb_reg_base = pPort->usb_reg_base;
+	UsbMem_Init(&pPort->usbMem, pPort->mem_base, USB_STACK_MEM_SIZE);
+	usb_param.mem_base = pPort->usbMem.mem_base;
+	usb_param.mem_size = pPort->usbMem.mem_size;
+	usb_param.max_num_ep = HID_MAX_NUM_EP;
+#ifdef HID_VENDOR_BULK
+	usb_param.USB_Configure_Event = Composite_Configure_Event;
+#else
+	usb_param.USB_Configure_Event = hid_generic_configure_event;
+#endif
+#ifdef HID_SUSPEND
+	hid_suspend_init_param(&usb_param);
+#endif
+#ifdef HID_SOF_SCHED
+	hid_sof_init_param(&usb_param);
+#endif
+
+	/* Set the USB descriptors */
+	desc.device_desc = (uint8_t *) USB_DeviceDescriptor;
+	desc.string_desc = (uint8_t *) USB_StringDescriptor;
+	desc.high_speed_desc = (uint8_t *) pPort->pHsDesc;
+	desc.full_speed_desc = (uint8_t *) USB_FsConfigDescriptor;
+	desc.device_qualifier = (uint8_t *) pPort->pQualifier;
+
+	/* USB Initialization */
+	ret = USBD_API->hw->Init(&pPort->hUsb, &desc, &usb_param);
+	if (ret == LPC_OK) {
+		ret = UsbMem_Update(&pPort->usbMem, usb_param.mem_base, usb_param.mem_size);
+	}
+#ifdef HID_SUSPEND
+	if (ret == LPC_OK) {
+		ret = hid_suspend_attach(pPort->hUsb, pPort->usb_reg_base);
+	}
+#endif
+#ifdef HID_SOF_SCHED
+	/* telemetry goes to port 0 only */
+	if ((ret == LPC_OK) && (pPort == &g_port[0])) {
+		ret = hid_sof_attach(pPort->hUsb, pPort->usb_reg_base, HID_CHAN_TELEMETRY, telemetry_capture);
+	}
+#endif
+	if (ret == LPC_OK) {
+
+		/* WORKAROUND for artf45032 ROM driver BUG, see usbd_ep0patch.h */
+		UsbEp0Patch_Install(&pPort->ep0Patch, pPort->hUsb);
+		hid_stats_ep0_attach(&pPort->ep0Patch);
+
+		/* index the configuration descriptors once for the class init code */
+		ret = UsbDescIdx_Build(&pPort->descIdx, pPort->hUsb, &desc);
+	}
+	if (ret == LPC_OK) {
+
+		/* one HID function driver per HID interface, interface 0 first */
+		for (i = 0; (i < HID_NUM_HID_INTF) && (ret == LPC_OK); i++) {
+			ret = usb_hid_init(pPort->hUsb, UsbDescIdx_FindIntfNum(pPort->hUsb, USB_HIGH_SPEED, i),
+							   &pPort->usbMem, pPort->usb_reg_base);
+		}
+#ifdef HID_VENDOR_BULK
+		if (ret == LPC_OK) {
+			ret = hid_bulk_init(pPort->hUsb, &pPort->usbMem);
+		}
+#endif
+		if (ret == LPC_OK) {
+			/*  enable USB interrrupts */
+			NVIC_EnableIRQ(pPort->irq);
+			/* now connect */
+			USBD_API->hw->Connect(pPort->hUsb, 1);
+		}
+		/* printed after the connect, the debug UART is slow */
+		DEBUGOUT("USB%d RAM: %d of %d bytes used, %d bytes short\r\n",
+				 (pPort->usb_reg_base == LPC_USB0_BASE) ? 0 : 1,
+				 UsbMem_GetHighWater(&pPort->usbMem), USB_STACK_MEM_SIZE, pPort->usbMem.overflow);
+	}
+	return ret;
 }
 
 /*****************************************************************************
@@ -82,127 +362,264 @@ ErrorCode_t EP0_patch(USBD_HANDLE_T hUsb, void *data, uint32_t event)
  ****************************************************************************/
 
 /**
- * @brief	Handle interrupt from USB0
+ * @brief	Handle interrupt from SysTick timer
  * @return	Nothing
  */
-void USB_IRQHandler(void)
+void SysTick_Handler(void)
 {
-	USBD_API->hw->ISR(g_hUsb);
+	/* Stand-in for the application's data source: a new sample is ready */
+	g_sampleCnt++;
 }
 
 /**
- * @brief	Find the address of interface descriptor for given class type.
- * @return	If found returns the address of requested interface else returns NULL.
+ * @brief	Handle interrupt from RITimer, drives the timer wheel
+ * @return	Nothing
  */
-USB_INTERFACE_DESCRIPTOR *find_IntfDesc(const uint8_t *pDesc, uint32_t intfClass)
+HOTFUNC void RIT_IRQHandler(void)
 {
-	USB_COMMON_DESCRIPTOR *pD;
-	USB_INTERFACE_DESCRIPTOR *pIntfDesc = 0;
-	uint32_t next_desc_adr;
+	Chip_TWHEEL_IRQHandler();
+}
 
-	pD = (USB_COMMON_DESCRIPTOR *) pDesc;
-	next_desc_adr = (uint32_t) pDesc;
+#ifdef HID_SCT_TSTAMP
+/**
+ * @brief	Handle interrupt from SCT
+ * @return	Nothing
+ */
+HOTFUNC void SCT_IRQHandler(void)
+{
+	Chip_SCTTS_IRQHandler(LPC_SCT);
+}
 
-	while (pD->bLength) {
-		/* is it interface descriptor */
-		if (pD->bDescriptorType == USB_INTERFACE_DESCRIPTOR_TYPE) {
+#endif
 
-			pIntfDesc = (USB_INTERFACE_DESCRIPTOR *) pD;
-			/* did we find the right interface descriptor */
-			if (pIntfDesc->bInterfaceClass == intfClass) {
-				break;
-			}
-		}
-		pIntfDesc = 0;
-		next_desc_adr = (uint32_t) pD + pD->bLength;
-		pD = (USB_COMMON_DESCRIPTOR *) next_desc_adr;
-	}
+#ifdef USE_USB0
+/**
+ * @brief	Handle interrupt from USB0
+ * @return	Nothing
+ */
+HOTFUNC void USB0_IRQHandler(void)
+{
+	port_isr(&g_port[0]);
+}
+
+#endif
 
-	return pIntfDesc;
+#ifdef USE_USB1
+/**
+ * @brief	Handle interrupt from USB1
+ * @return	Nothing
+ */
+HOTFUNC void USB1_IRQHandler(void)
+{
+	port_isr(&g_port[HID_NUM_PORTS - 1]);
 }
 
+#endif
+
 /**
  * @brief	main routine for USB device example
  * @return	Function should not exit.
  */
 int main(void)
 {
-	USBD_API_INIT_PARAM_T usb_param;
-	USB_CORE_DESCS_T desc;
-	ErrorCode_t ret = LPC_OK;
-	USB_CORE_CTRL_T *pCtrl;
+	uint32_t i;
 
 	/* Initialize board and chip */
 	SystemCoreClockUpdate();
 	Board_Init();
+#ifdef HID_MEMDIAG
+	/* paint the main stack while it is still shallow */
+	hid_mem_init();
+#endif
 
-	/* enable clocks and pinmux */
-	USB_init_pin_clk();
+	/* start cycle counter used to profile the USB event handlers */
+	hid_stats_init();
+	/* time base of the OUT report stamps and the latency probe */
+	StopWatch_Init();
+#ifdef HID_ISR_TRACE
+	hid_trace_init();
+#endif
+#ifdef CHIP_PROFILE_ENABLE
+	hid_prof_init();
+#endif
+#ifdef CHIP_ITM_TRACE_ENABLE
+	ITM_Trace_Init(HID_SWO_BAUD);
+#endif
+#ifdef HID_SUSPEND
+	hid_suspend_init();
+#endif
 
 	/* Init USB API structure */
 	g_pUsbApi = (const USBD_API_T *) LPC_ROM_API->usbdApiBase;
 
-	/* initialize call back structures */
-	memset((void *) &usb_param, 0, sizeof(USBD_API_INIT_PARAM_T));
-	usb_param.usb_reg_base = LPC_USB_BASE;
-	usb_param.mem_base = USB_STACK_MEM_BASE;
-	usb_param.mem_size = USB_STACK_MEM_SIZE;
-	usb_param.max_num_ep = 2;
+	/* Each controller gets its own ROM stack instance and memory window */
+	for (i = 0; i < HID_NUM_PORTS; i++) {
+		port_init(&g_port[i]);
+	}
+#ifdef HID_MEMDIAG
+	for (i = 0; i < HID_NUM_PORTS; i++) {
+		hid_mem_add_arena((g_port[i].usb_reg_base == LPC_USB0_BASE) ? "usb0_ram" : "usb1_ram",
+						  &g_port[i].usbMem);
+	}
+#ifdef HID_SCT_TSTAMP
+	MemDiag_AddStatic("sct_tstamp", g_tsQueue, sizeof(g_tsQueue));
+#endif
+#endif
+	Board_BootMark(BOARD_BOOT_APP);
 
-	/* Set the USB descriptors */
-	desc.device_desc = (uint8_t *) USB_DeviceDescriptor;
-	desc.string_desc = (uint8_t *) USB_StringDescriptor;
+	/* The host is now enumerating the device, finish the board set up that
+	   BOARD_FAST_BOOT left out */
+	Board_Deferred_Init();
+	/* DEBUGLOG() output, printed from the main loop */
+	Board_Log_Init();
+#ifdef BOARD_BOOT_PROFILE
+	DEBUGOUT("Boot: mux %luus clk %luus extmem %luus init %luus connect %luus\r\n",
+			 (unsigned long) Board_BootTimeUs(BOARD_BOOT_MUXING),
+			 (unsigned long) Board_BootTimeUs(BOARD_BOOT_CLOCKING),
+			 (unsigned long) Board_BootTimeUs(BOARD_BOOT_EXTMEM),
+			 (unsigned long) Board_BootTimeUs(BOARD_BOOT_INIT),
+			 (unsigned long) Board_BootTimeUs(BOARD_BOOT_APP));
+#endif
 
-#ifdef USE_USB0
-	desc.high_speed_desc = USB_HsConfigDescriptor;
-	desc.full_speed_desc = USB_FsConfigDescriptor;
-	desc.device_qualifier = (uint8_t *) USB_DeviceQualifier;
-#else
-	/* Note, to pass USBCV test full-speed only devices should have both
-	 * descriptor arrays point to same location and device_qualifier set
-	 * to 0.
-	 */
-	desc.high_speed_desc = USB_HsConfigDescriptor;
-	desc.full_speed_desc = USB_FsConfigDescriptor;
-	desc.device_qualifier = 0;
+	/* log lines are short, pack them into full reports of the log channel,
+	   flushed at the latest by a timer wheel deadline */
+	Chip_TWHEEL_Init(HID_TWHEEL_TICK_US);
+	hid_coalesce_init(g_port[0].hUsb, HID_CHAN_LOG);
+#ifdef HID_TELEMETRY_PACK
+	/* telemetry frames are delta packed, several samples per report */
+	hid_pack_init(g_port[0].hUsb, HID_CHAN_TELEMETRY);
+#endif
+#ifdef HID_ADC_STREAM
+	/* telemetry reports are filled with ADC results by the GPDMA */
+	if (hid_adc_init(g_port[0].hUsb, HID_CHAN_TELEMETRY) != LPC_OK) {
+		DEBUGOUT("ADC stream: no free GPDMA channel\r\n");
+	}
+#endif
+#ifdef HID_CAN_BRIDGE
+	/* C_CAN0 frames are packed into telemetry reports by the CAN interrupt */
+	if (hid_can_init(g_port[0].hUsb, HID_CHAN_TELEMETRY) != LPC_OK) {
+		DEBUGOUT("CAN bridge: no room for the receive chain\r\n");
+	}
+#endif
+#ifdef HID_EVENT_FASTPATH
+	/* BUTTON1 edges are reported from the pin interrupt itself */
+	hid_event_init(g_port[0].hUsb);
 #endif
 
-	/* USB Initialization */
-	ret = USBD_API->hw->Init(&g_hUsb, &desc, &usb_param);
-	if (ret == LPC_OK) {
+#ifdef HID_SCT_TSTAMP
+	/* Timestamp sensor edges in the time base of the telemetry reports */
+	Chip_SCTTS_Init(LPC_SCT, g_tsQueue, HID_SCT_TSTAMP_DEPTH);
+	Chip_SCTTS_RouteInput(HID_SCT_TSTAMP_INPUT, HID_SCT_TSTAMP_ROUTE);
+	Chip_SCTTS_EnableInput(LPC_SCT, HID_SCT_TSTAMP_INPUT, SCTTS_EDGE_RISE);
+	DEBUGOUT("SCT timestamps: %lu ticks/s\r\n", (unsigned long) Chip_SCTTS_GetRate());
+#endif
 
-		/*	WORKAROUND for artf45032 ROM driver BUG:
-		    Due to a race condition there is the chance that a second NAK event will
-		    occur before the default endpoint0 handler has completed its preparation
-		    of the DMA engine for the first NAK event. This can cause certain fields
-		    in the DMA descriptors to be in an invalid state when the USB controller
-		    reads them, thereby causing a hang.
-		 */
-		pCtrl = (USB_CORE_CTRL_T *) g_hUsb;	/* convert the handle to control structure */
-		g_Ep0BaseHdlr = pCtrl->ep_event_hdlr[0];/* retrieve the default EP0_OUT handler */
-		pCtrl->ep_event_hdlr[0] = EP0_patch;/* set our patch routine as EP0_OUT handler */
-
-		ret = usb_hid_init(g_hUsb,
-						   (USB_INTERFACE_DESCRIPTOR *) &USB_HsConfigDescriptor[sizeof(USB_CONFIGURATION_DESCRIPTOR)],
-						   &usb_param.mem_base,
-						   &usb_param.mem_size);
-		if (ret == LPC_OK) {
-			/*  enable USB interrrupts */
-			NVIC_EnableIRQ(LPC_USB_IRQ);
-			/* now connect */
-			USBD_API->hw->Connect(g_hUsb, 1);
-		}
-	}
+	/* Start producing telemetry samples */
+	SysTick_Config(SystemCoreClock / TELEMETRY_RATE_HZ);
 
 	while (1) {
-  char buf[255];
-	int i;
-	for(i=0;i<255;i++)
-	{ 
-		 buf[i]=i;
-	}
-	  USBD_API->hw->WriteEP(g_hUsb, HID_EP_IN, buf, 255);
-		/* Sleep until next IRQ happens */
+#ifdef HID_TELEMETRY_PACK
+		int16_t frame[HID_PACK_CHANNELS];
+#elif !defined(HID_SOF_SCHED) && !defined(HID_ADC_STREAM) && !defined(HID_CAN_BRIDGE)
+		uint8_t *buf;
+#endif
+		char line[16];
+		uint32_t sample = g_sampleCnt;
+		uint32_t benching = 0;
+
+		/* callbacks of the deferred timer wheel timers */
+		Chip_TWHEEL_Run();
+		for (i = 0; i < HID_NUM_PORTS; i++) {
+			out_loopback(g_port[i].hUsb);
+			if (hid_bench_active(g_port[i].hUsb)) {
+				benching = 1;
+			}
+		}
+#ifdef HID_VENDOR_BULK
+		bulk_loopback();
+#endif
+#ifdef HID_CAN_BRIDGE
+		hid_can_task();
+#endif
+#ifdef HID_ISR_TRACE
+		hid_trace_task();
+#endif
+		Board_Log_Task();
+#ifdef CHIP_PROFILE_ENABLE
+		hid_prof_task(sample);
+#endif
+#ifdef HID_MEMDIAG
+		hid_mem_task(sample);
+#endif
+#ifdef HID_SUSPEND
+		hid_suspend_task();
+		/* SysTick keeps running while only some ports are suspended, the
+		   samples meant for a suspended port 0 are dropped */
+		if (hid_suspend_active(g_port[0].hUsb)) {
+			g_sampleSent = sample;
+			g_sampleLogged = sample;
+			__WFI();
+			continue;
+		}
+#endif
+		/* while a benchmark runs it owns the interrupt endpoints */
+		if (benching) {
+			hid_bench_task();
+			g_sampleSent = sample;
+			g_sampleLogged = sample;
+			__WFI();
+			continue;
+		}
+
+		/* Build a report only when there is a new sample and the queue has
+		   room for it. The report is written in place into a USB RAM slot and
+		   goes out from the IN complete interrupt, so nothing is re-written
+		   while the controller reads it. Samples arriving while the queue is
+		   full are folded into the next report. When not configured no slot
+		   is handed out and the sample is dropped, there is nothing to catch
+		   up on once the host shows up. Telemetry and log go to port 0 only. */
+#ifdef HID_TELEMETRY_PACK
+		/* Packed telemetry: every sample is a frame of its own, packed while
+		   the channel queue takes them and retried on the next pass when it
+		   is full. hid_pack sends a report once it is full or its deadline
+		   expires. */
+		while (g_sampleSent != sample) {
+			PROFILE_ENTER(HID_PROF_TELEMETRY);
+			telemetry_frame(g_sampleSent + 1, frame);
+			if ((hid_pack_put(g_sampleSent + 1, frame) != LPC_OK) &&
+				USB_IsConfigured(g_port[0].hUsb)) {
+				PROFILE_EXIT(HID_PROF_TELEMETRY);
+				break;
+			}
+			g_sampleSent++;
+			PROFILE_EXIT(HID_PROF_TELEMETRY);
+		}
+#elif !defined(HID_SOF_SCHED) && !defined(HID_ADC_STREAM) && !defined(HID_CAN_BRIDGE)
+		if (sample != g_sampleSent) {
+			PROFILE_ENTER(HID_PROF_TELEMETRY);
+
+			buf = hid_generic_slot_get(g_port[0].hUsb, HID_CHAN_TELEMETRY);
+			if (buf != NULL) {
+				telemetry_build(buf, sample);
+				hid_generic_slot_commit(g_port[0].hUsb, HID_CHAN_TELEMETRY, HID_CHAN_PAYLOAD_BYTES);
+				g_sampleSent = sample;
+			}
+			else if (!USB_IsConfigured(g_port[0].hUsb)) {
+				g_sampleSent = sample;
+			}
+			PROFILE_EXIT(HID_PROF_TELEMETRY);
+		}
+#endif
+		/* A short log line per sample, the coalescer packs them into one log
+		   report per HID_COALESCE_DEADLINE_US instead of a report each. It
+		   is retried with the next sample while no slot is free. */
+		if (sample != g_sampleLogged) {
+			if ((hid_coalesce_put((uint8_t *) line, sprintf(line, "sample %lu", (unsigned long) sample)) == LPC_OK) ||
+				!USB_IsConfigured(g_port[0].hUsb)) {
+				g_sampleLogged = sample;
+			}
+		}
+		/* Sleep until next IRQ (SysTick sample or USB event) happens */
 		__WFI();
 	}
 }
@@ -0,0 +1,135 @@
+/*
+ * @brief Memory usage report of the HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "hid_mem.h"
+
+#ifdef HID_MEMDIAG
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define HID_MEM_NAME_BYTES      16
+
+static uint8_t g_memSel;		/* entry returned by the next GET_REPORT */
+#ifdef HID_MEMDIAG_UART
+static uint32_t g_memDumped;	/* time of the last UART dump */
+#endif
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void wr_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t) val;
+	p[1] = (uint8_t) (val >> 8);
+	p[2] = (uint8_t) (val >> 16);
+	p[3] = (uint8_t) (val >> 24);
+}
+
+/* High-water callback of a USB RAM arena */
+static uint32_t mem_arena_used(void *ctx)
+{
+	return UsbMem_GetHighWater((USBMEM_T *) ctx);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start the memory table and paint the main stack */
+void hid_mem_init(void)
+{
+	MemDiag_Init();
+	g_memSel = 0;
+}
+
+/* Register the USB RAM arena of a port */
+void hid_mem_add_arena(const char *name, USBMEM_T *pMem)
+{
+	MemDiag_Add(name, MEMDIAG_POOL, (const void *) pMem->start, pMem->size, mem_arena_used, pMem);
+}
+
+/* Print the memory table on the debug UART every 10 seconds */
+void hid_mem_task(uint32_t now)
+{
+#ifdef HID_MEMDIAG_UART
+	if ((now - g_memDumped) < 10000) {
+		return;
+	}
+	g_memDumped = now;
+	MemDiag_Report(NULL);
+#endif
+}
+
+/* Build memory usage feature report */
+uint16_t hid_mem_get_report(uint8_t *pReport)
+{
+	MEMDIAG_INFO_T info;
+	int count = MemDiag_GetCount();
+
+	memset(pReport, 0, HID_MEM_REPORT_BYTES);
+	pReport[0] = HID_REPORT_ID_MEM;
+	pReport[1] = g_memSel;
+	pReport[2] = (uint8_t) count;
+	if (MemDiag_Get(g_memSel, &info)) {
+		pReport[3] = (uint8_t) info.kind;
+		pReport[4] = (uint8_t) info.region;
+		strncpy((char *) &pReport[8], info.name, HID_MEM_NAME_BYTES - 1);
+		wr_le32(&pReport[24], info.addr);
+		wr_le32(&pReport[28], info.size);
+		wr_le32(&pReport[32], info.used);
+	}
+
+	/* a dump is count reads in a row */
+	g_memSel = (count != 0) ? (uint8_t) ((g_memSel + 1) % count) : 0;
+	return HID_MEM_REPORT_BYTES;
+}
+
+/* Select an entry */
+ErrorCode_t hid_mem_set_report(const uint8_t *pReport, uint16_t length)
+{
+	if ((length < 2) || (pReport[0] != HID_REPORT_ID_MEM) || (pReport[1] >= MemDiag_GetCount())) {
+		return ERR_USBD_STALL;
+	}
+	g_memSel = pReport[1];
+	return LPC_OK;
+}
+
+#endif /* HID_MEMDIAG */
@@ -0,0 +1,113 @@
+/*
+ * @brief Memory usage report of the HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_MEM_H_
+#define __HID_MEM_H_
+
+#include "board.h"
+#include "app_usbd_cfg.h"
+#include "usb_mem.h"
+#include "memdiag.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* Layout of the memory usage feature report:
+     byte 0     : HID_REPORT_ID_MEM
+     byte 1     : index of the entry returned
+     byte 2     : number of entries
+     byte 3     : MEMDIAG_KIND_T of the entry
+     byte 4     : MEMDIAG_REGION_T of the entry
+     byte 5..7  : reserved
+     byte 8..23 : entry name, NUL padded
+     byte 24..  : address, bytes set aside and most bytes used, each 32 bit
+                  little endian
+   Each read returns the selected entry and selects the next one, so the
+   host reads as many reports as byte 2 says for a full dump. Writing the
+   report selects the entry in byte 1.
+   HID_MEM_REPORT_BYTES is defined in app_usbd_cfg.h for the descriptor.
+ */
+
+/**
+ * @brief	Start the memory table and paint the main stack.
+ * @return	Nothing
+ * @note	Call first thing in main(), before the stack gets deep.
+ */
+void hid_mem_init(void);
+
+/**
+ * @brief	Register the USB RAM arena of a port.
+ * @param	name	: Constant entry name
+ * @param	pMem	: Arena, its high-water mark is read on every report
+ * @return	Nothing
+ */
+void hid_mem_add_arena(const char *name, USBMEM_T *pMem);
+
+/**
+ * @brief	Print the memory table on the debug UART every 10 seconds.
+ * @param	now		: Free running millisecond count
+ * @return	Nothing
+ * @note	Call from the main loop; does nothing unless HID_MEMDIAG_UART
+ *			is defined.
+ */
+void hid_mem_task(uint32_t now);
+
+/**
+ * @brief	Handle GET_REPORT(Feature) for HID_REPORT_ID_MEM.
+ * @param	pReport	: Pointer to report buffer of HID_MEM_REPORT_BYTES
+ * @return	Length of the report written to @a pReport.
+ */
+uint16_t hid_mem_get_report(uint8_t *pReport);
+
+/**
+ * @brief	Handle SET_REPORT(Feature) for HID_REPORT_ID_MEM.
+ * @param	pReport	: Pointer to report received in the data stage
+ * @param	length	: Length of the received report
+ * @return	LPC_OK when accepted, else ERR_USBD_STALL.
+ */
+ErrorCode_t hid_mem_set_report(const uint8_t *pReport, uint16_t length);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_MEM_H_ */
@@ -0,0 +1,200 @@
+/*
+ * @brief Delta/varint packing of 16 bit sensor frames into HID reports
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <stdint.h>
+#include <string.h>
+#include "hid_generic.h"
+#include "hid_pack.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Largest varint of a 16 bit step */
+#define PACK_VARINT_MAX     3
+
+/**
+ * @brief Structure to hold the report being packed
+ */
+typedef struct {
+	uint8_t *pBuf;			/*!< Payload of the IN slot being filled, NULL if none */
+	uint32_t fill;			/*!< Payload bytes used in pBuf */
+	uint32_t frames;		/*!< Frames packed in pBuf */
+	uint32_t next;			/*!< Sample number the next frame must have to join pBuf */
+	uint16_t prev[HID_PACK_CHANNELS];	/*!< Last packed sample of each channel */
+	USBD_HANDLE_T hUsb;		/*!< Port the reports are sent on */
+	uint32_t chan;			/*!< Logical channel the reports are sent on */
+	CHIP_TWHEEL_TIMER_T deadline;	/*!< Deadline of the report being packed */
+} HID_Pack_Ctrl_T;
+
+static HID_Pack_Ctrl_T g_pack;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Write the zig-zag varint of the step from prev to val, returns its length */
+static uint32_t pack_varint(uint8_t *p, uint16_t prev, uint16_t val)
+{
+	int16_t d = (int16_t) (uint16_t) (val - prev);
+	uint32_t zz = ((uint32_t) (uint16_t) d << 1) ^ (uint32_t) (d < 0 ? 0x1FFFF : 0);
+	uint32_t n = 0;
+
+	while (zz >= 0x80) {
+		p[n++] = (uint8_t) (zz | 0x80);
+		zz >>= 7;
+	}
+	p[n++] = (uint8_t) zz;
+	return n;
+}
+
+/* Hand the packed report to the channel queue, called with interrupts
+   masked or from the deadline callback */
+static ErrorCode_t pack_send(HID_Pack_Ctrl_T *pPk)
+{
+	ErrorCode_t ret = LPC_OK;
+
+	Chip_TWHEEL_Stop(&pPk->deadline);
+	if (pPk->pBuf != NULL) {
+		pPk->pBuf[4] = (uint8_t) pPk->frames;
+		pPk->pBuf[5] = (uint8_t) (pPk->frames >> 8);
+		/* the slot is not cleared, the frame count bounds the data */
+		ret = hid_generic_slot_commit(pPk->hUsb, pPk->chan, pPk->fill);
+		pPk->pBuf = NULL;
+		pPk->fill = 0;
+		pPk->frames = 0;
+	}
+	return ret;
+}
+
+/* The deadline of the packed report expired, called from the RITimer
+   interrupt */
+static void pack_expired(CHIP_TWHEEL_TIMER_T *pTimer)
+{
+	pack_send((HID_Pack_Ctrl_T *) pTimer->pArg);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize packing */
+void hid_pack_init(USBD_HANDLE_T hUsb, uint32_t chan)
+{
+	HID_Pack_Ctrl_T *pPk = &g_pack;
+
+	pPk->pBuf = NULL;
+	pPk->fill = 0;
+	pPk->frames = 0;
+	pPk->hUsb = hUsb;
+	pPk->chan = chan;
+	Chip_TWHEEL_Setup(&pPk->deadline, pack_expired, pPk, 0);
+}
+
+/* Pack a frame */
+ErrorCode_t hid_pack_put(uint32_t sample, const int16_t *pFrame)
+{
+	HID_Pack_Ctrl_T *pPk = &g_pack;
+	uint8_t enc[HID_PACK_CHANNELS * PACK_VARINT_MAX];
+	ErrorCode_t ret = LPC_OK;
+	uint32_t primask, len, i;
+
+	primask = __get_PRIMASK();
+	__disable_irq();	/* enter critical section */
+	len = 0;
+	if (pPk->pBuf != NULL) {
+		if (sample == pPk->next) {
+			for (i = 0; i < HID_PACK_CHANNELS; i++) {
+				len += pack_varint(&enc[len], pPk->prev[i], (uint16_t) pFrame[i]);
+			}
+		}
+		/* the frame does not fit, or does not follow the ones packed */
+		if ((len == 0) || ((pPk->fill + len) > HID_CHAN_PAYLOAD_BYTES)) {
+			pack_send(pPk);
+		}
+	}
+	if (pPk->pBuf == NULL) {
+		pPk->pBuf = hid_generic_slot_get(pPk->hUsb, pPk->chan);
+		if (pPk->pBuf != NULL) {
+			pPk->pBuf[0] = (uint8_t) sample;
+			pPk->pBuf[1] = (uint8_t) (sample >> 8);
+			pPk->pBuf[2] = (uint8_t) (sample >> 16);
+			pPk->pBuf[3] = (uint8_t) (sample >> 24);
+			pPk->pBuf[6] = HID_PACK_CHANNELS;
+			pPk->pBuf[7] = 0;
+			/* absolute first frame */
+			for (len = 0, i = 0; i < HID_PACK_CHANNELS; i++) {
+				enc[len++] = (uint8_t) pFrame[i];
+				enc[len++] = (uint8_t) ((uint16_t) pFrame[i] >> 8);
+			}
+			pPk->fill = HID_PACK_HDR_BYTES;
+			Chip_TWHEEL_Start(&pPk->deadline, Chip_TWHEEL_UsToTicks(HID_PACK_DEADLINE_US), 0);
+		}
+	}
+	if (pPk->pBuf == NULL) {
+		ret = ERR_BUSY;
+	}
+	else {
+		memcpy(&pPk->pBuf[pPk->fill], enc, len);
+		pPk->fill += len;
+		pPk->frames++;
+		pPk->next = sample + 1;
+		for (i = 0; i < HID_PACK_CHANNELS; i++) {
+			pPk->prev[i] = (uint16_t) pFrame[i];
+		}
+		/* no room for even a frame of one byte steps, don't wait for the
+		   deadline */
+		if ((pPk->fill + HID_PACK_CHANNELS) > HID_CHAN_PAYLOAD_BYTES) {
+			pack_send(pPk);
+		}
+	}
+	__set_PRIMASK(primask);	/* exit critical section */
+
+	return ret;
+}
+
+/* Send the partly filled report */
+ErrorCode_t hid_pack_flush(void)
+{
+	ErrorCode_t ret;
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();	/* enter critical section */
+	ret = pack_send(&g_pack);
+	__set_PRIMASK(primask);	/* exit critical section */
+
+	return ret;
+}
@@ -0,0 +1,107 @@
+/*
+ * @brief Delta/varint packing of 16 bit sensor frames into HID reports
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_PACK_H_
+#define __HID_PACK_H_
+
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* A frame is one 16 bit sample of each of HID_PACK_CHANNELS channels.
+   Consecutive frames are packed into the payload of one IN report of the
+   packing channel as
+     byte 0..3  : sample number of the first frame, little endian
+     byte 4..5  : number of frames in the report, little endian
+     byte 6     : channels per frame
+     byte 7     : 0, reserved
+     byte 8..   : first frame, one signed 16 bit sample per channel, little
+                  endian
+     then       : each following frame as one varint per channel
+   A varint holds the difference to the previous sample of the channel,
+   taken modulo 2^16 and zig-zag mapped ((d << 1) ^ (d >> 15)) so small
+   steps of either sign are small numbers, in 7 bit groups least significant
+   first with bit 7 set on all but the last byte: 1 byte for steps of -64 to
+   63, at most 3 bytes. Every report starts with an absolute frame, so a lost
+   report costs its own frames only. The report goes out when the next frame
+   does not fit, when a frame does not follow the previous one, or
+   HID_PACK_DEADLINE_US after its first frame was put, whichever comes first.
+ */
+#define HID_PACK_HDR_BYTES          8
+
+/**
+ * @brief	Initialize frame packing.
+ * @param	hUsb	: Handle to USB device stack of the port the reports go to
+ * @param	chan	: Logical channel the packed reports are sent on
+ * @return	Nothing
+ * @note	The channel is owned by the packer from now on, the slot it
+ *			fills stays handed out until the report is flushed. The
+ *			deadline is a timer wheel timer, Chip_TWHEEL_Init() must have
+ *			been called.
+ */
+void hid_pack_init(USBD_HANDLE_T hUsb, uint32_t chan);
+
+/**
+ * @brief	Append a frame to the report being packed.
+ * @param	sample	: Sample number of the frame
+ * @param	pFrame	: Pointer to HID_PACK_CHANNELS samples
+ * @return	LPC_OK when the frame was packed, ERR_BUSY when the channel
+ *			queue has no free slot (or the device is not configured).
+ * @note	Interrupts are masked while the frame is packed, so it may be
+ *			called from any context. A frame whose sample number is not
+ *			the one after the previous frame starts a new report, the host
+ *			sees the gap in the sample numbers.
+ */
+ErrorCode_t hid_pack_put(uint32_t sample, const int16_t *pFrame);
+
+/**
+ * @brief	Send the partly filled report now instead of at the deadline.
+ * @return	LPC_OK when nothing was pending or the report was queued,
+ *			ERR_FAILED when it was dropped by a bus reset or reconfiguration.
+ */
+ErrorCode_t hid_pack_flush(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_PACK_H_ */
@@ -0,0 +1,151 @@
+/*
+ * @brief Profiling regions of the HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "hid_prof.h"
+
+#ifdef CHIP_PROFILE_ENABLE
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define HID_PROF_NAME_BYTES     16
+
+static const char *const g_profNames[HID_PROF_NUM_REGIONS] = {
+	"usb_isr", "ep_hdlr", "telemetry"
+};
+
+static uint8_t g_profSel;		/* region returned by the next GET_REPORT */
+#ifdef HID_PROF_UART
+static uint32_t g_profDumped;	/* time of the last UART dump */
+#endif
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void wr_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t) val;
+	p[1] = (uint8_t) (val >> 8);
+	p[2] = (uint8_t) (val >> 16);
+	p[3] = (uint8_t) (val >> 24);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Name the regions and start the time base */
+void hid_prof_init(void)
+{
+	int i;
+
+	for (i = 0; i < HID_PROF_NUM_REGIONS; i++) {
+		Profile_SetName(i, g_profNames[i]);
+	}
+	Profile_Init();
+	g_profSel = 0;
+}
+
+/* Print all regions on the debug UART once a second */
+void hid_prof_task(uint32_t now)
+{
+#ifdef HID_PROF_UART
+	PROFILE_REGION_T r;
+	int i, b;
+
+	if ((now - g_profDumped) < 1000) {
+		return;
+	}
+	g_profDumped = now;
+
+	for (i = 0; i < HID_PROF_NUM_REGIONS; i++) {
+		Profile_Get(i, &r);
+		DEBUGOUT("%-10s n %lu min %lu max %lu avg %lu cyc |", r.name, (unsigned long) r.count,
+				 (unsigned long) r.min, (unsigned long) r.max, (unsigned long) Profile_Mean(&r));
+		for (b = 0; b < PROFILE_HIST_BINS; b++) {
+			DEBUGOUT(" %lu", (unsigned long) r.hist[b]);
+		}
+		DEBUGOUT("\r\n");
+	}
+#endif
+}
+
+/* Build profiling feature report */
+uint16_t hid_prof_get_report(uint8_t *pReport)
+{
+	PROFILE_REGION_T r;
+	int b;
+
+	Profile_Get(g_profSel, &r);
+	memset(pReport, 0, HID_PROF_REPORT_BYTES);
+	pReport[0] = HID_REPORT_ID_PROF;
+	pReport[1] = g_profSel;
+	pReport[2] = HID_PROF_NUM_REGIONS;
+	if (r.name != NULL) {
+		strncpy((char *) &pReport[4], r.name, HID_PROF_NAME_BYTES - 1);
+	}
+	wr_le32(&pReport[20], r.count);
+	wr_le32(&pReport[24], r.min);
+	wr_le32(&pReport[28], r.max);
+	wr_le32(&pReport[32], Profile_Mean(&r));
+	wr_le32(&pReport[36], Profile_TicksPerSecond());
+	for (b = 0; b < PROFILE_HIST_BINS; b++) {
+		wr_le32(&pReport[40 + (b * 4)], r.hist[b]);
+	}
+
+	/* a dump is HID_PROF_NUM_REGIONS reads in a row */
+	g_profSel = (g_profSel + 1) % HID_PROF_NUM_REGIONS;
+	return HID_PROF_REPORT_BYTES;
+}
+
+/* Select a region or clear all of them */
+ErrorCode_t hid_prof_set_report(const uint8_t *pReport, uint16_t length)
+{
+	if ((length < 3) || (pReport[0] != HID_REPORT_ID_PROF) || (pReport[1] >= HID_PROF_NUM_REGIONS)) {
+		return ERR_USBD_STALL;
+	}
+	g_profSel = pReport[1];
+	if (pReport[2] & 1) {
+		Profile_Reset(-1);
+	}
+	return LPC_OK;
+}
+
+#endif /* CHIP_PROFILE_ENABLE */
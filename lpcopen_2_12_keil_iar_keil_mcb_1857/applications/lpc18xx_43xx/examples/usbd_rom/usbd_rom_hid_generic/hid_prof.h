@@ -0,0 +1,112 @@
+/*
+ * @brief Profiling regions of the HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_PROF_H_
+#define __HID_PROF_H_
+
+#include "board.h"
+#include "app_usbd_cfg.h"
+#include "profile.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/**
+ * @brief Regions timed with PROFILE_ENTER()/PROFILE_EXIT()
+ */
+enum {
+	HID_PROF_USB_ISR,		/*!< USB interrupt of a port, incl. the ROM stack */
+	HID_PROF_EP_HDLR,		/*!< HID interrupt endpoint handler */
+	HID_PROF_TELEMETRY,		/*!< Building one telemetry report */
+	HID_PROF_NUM_REGIONS
+};
+
+/* Layout of the profiling feature report:
+     byte 0     : HID_REPORT_ID_PROF
+     byte 1     : index of the region returned
+     byte 2     : HID_PROF_NUM_REGIONS
+     byte 3     : reserved
+     byte 4..19 : region name, NUL padded
+     byte 20..  : count, min, max, mean, ticks per second and the
+                  PROFILE_HIST_BINS histogram bins, each 32 bit little
+                  endian. Durations are in DWT cycles.
+   Each read returns the selected region and selects the next one, so the
+   host reads HID_PROF_NUM_REGIONS reports for a full dump. Writing the
+   report selects the region in byte 1, bit 0 of byte 2 clears all regions.
+   HID_PROF_REPORT_BYTES is defined in app_usbd_cfg.h for the descriptor.
+ */
+
+/**
+ * @brief	Name the regions and start the time base.
+ * @return	Nothing
+ */
+void hid_prof_init(void);
+
+/**
+ * @brief	Print all regions on the debug UART once a second.
+ * @param	now		: Free running millisecond count
+ * @return	Nothing
+ * @note	Call from the main loop; does nothing unless HID_PROF_UART is
+ *			defined.
+ */
+void hid_prof_task(uint32_t now);
+
+/**
+ * @brief	Handle GET_REPORT(Feature) for HID_REPORT_ID_PROF.
+ * @param	pReport	: Pointer to report buffer of HID_PROF_REPORT_BYTES
+ * @return	Length of the report written to @a pReport.
+ */
+uint16_t hid_prof_get_report(uint8_t *pReport);
+
+/**
+ * @brief	Handle SET_REPORT(Feature) for HID_REPORT_ID_PROF.
+ * @param	pReport	: Pointer to report received in the data stage
+ * @param	length	: Length of the received report
+ * @return	LPC_OK when accepted, else ERR_USBD_STALL.
+ */
+ErrorCode_t hid_prof_set_report(const uint8_t *pReport, uint16_t length);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_PROF_H_ */
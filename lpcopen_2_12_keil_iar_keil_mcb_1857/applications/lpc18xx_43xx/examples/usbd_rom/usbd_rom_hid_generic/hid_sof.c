@@ -0,0 +1,185 @@
+/*
+ * @brief SOF synchronized report scheduling
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "hid_generic.h"
+#include "hid_sof.h"
+
+#ifdef HID_SOF_SCHED
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* USBINTR_D SOF received interrupt enable */
+#define USBINTR_SRE             _BIT(7)
+
+/* Length of a frame and a microframe */
+#define FS_FRAME_US             1000
+#define HS_UFRAME_US            125
+
+typedef struct {
+	USBD_HANDLE_T hUsb;				/*!< Scheduled port, NULL if none */
+	LPC_USBHS_T *pRegs;				/*!< Controller registers of the port */
+	uint32_t chan;					/*!< Channel the reports are sent on */
+	HID_SOF_CAPTURE_T capture;		/*!< Builds a report */
+	uint8_t high_speed;				/*!< Frame index counts microframes */
+	uint8_t phase_valid;			/*!< A completed report gave the phase */
+	HID_Sof_Stats_T stats;			/*!< Counters, phase, period and lead */
+} HID_Sof_Ctrl_T;
+
+static HID_Sof_Ctrl_T g_sof;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Current (micro)frame in the unit of the service interval */
+static INLINE uint32_t sof_now(HID_Sof_Ctrl_T *pSof)
+{
+	uint32_t frindex = pSof->pRegs->FRINDEX_D;
+
+	return pSof->high_speed ? (frindex & 0x3FFF) : ((frindex >> 3) & 0x7FF);
+}
+
+/* SOF of the port, capture when the next poll is lead (micro)frames away */
+static ErrorCode_t sof_event(USBD_HANDLE_T hUsb)
+{
+	HID_Sof_Ctrl_T *pSof = &g_sof;
+	uint32_t len;
+	uint8_t *pBuf;
+
+	if (hUsb != pSof->hUsb) {
+		return LPC_OK;
+	}
+	if (((sof_now(pSof) + pSof->stats.lead - pSof->stats.phase) & (pSof->stats.period - 1)) != 0) {
+		return LPC_OK;
+	}
+	pBuf = hid_generic_slot_get(hUsb, pSof->chan);
+	if (pBuf == NULL) {
+		pSof->stats.missed++;
+		return LPC_OK;
+	}
+	len = pSof->capture(pBuf);
+	if ((len != 0) && (hid_generic_slot_commit(hUsb, pSof->chan, len) == LPC_OK)) {
+		pSof->stats.captures++;
+	}
+	return LPC_OK;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Register the SOF callback */
+void hid_sof_init_param(USBD_API_INIT_PARAM_T *pParam)
+{
+	pParam->USB_SOF_Event = sof_event;
+}
+
+/* Bind the scheduled port and channel */
+ErrorCode_t hid_sof_attach(USBD_HANDLE_T hUsb, uint32_t usb_reg_base, uint32_t chan, HID_SOF_CAPTURE_T capture)
+{
+	HID_Sof_Ctrl_T *pSof = &g_sof;
+
+	memset(pSof, 0, sizeof(HID_Sof_Ctrl_T));
+	pSof->pRegs = (LPC_USBHS_T *) usb_reg_base;
+	pSof->chan = chan;
+	pSof->capture = capture;
+	pSof->stats.period = 1;
+	pSof->stats.lead = 1;
+	pSof->hUsb = hUsb;
+	return LPC_OK;
+}
+
+/* Set up for the negotiated speed after a (re)configuration */
+void hid_sof_configure(USBD_HANDLE_T hUsb)
+{
+	HID_Sof_Ctrl_T *pSof = &g_sof;
+	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;
+	uint32_t period, frame_us, lead;
+
+	if (hUsb != pSof->hUsb) {
+		return;
+	}
+	if (pCtrl->config_value == 0) {
+		pSof->pRegs->USBINTR_D &= ~USBINTR_SRE;
+		return;
+	}
+
+	pSof->high_speed = (pCtrl->device_speed == USB_HIGH_SPEED);
+	if (pSof->high_speed) {
+		/* bInterval is the exponent of a power of 2 microframe interval */
+		period = 1 << (HID_HS_EP_INTERVAL - 1);
+		frame_us = HS_UFRAME_US;
+	}
+	else {
+		/* hosts round a full-speed interval down to a power of 2 */
+		for (period = 1; (period << 1) <= HID_FS_EP_INTERVAL; period <<= 1) {}
+		frame_us = FS_FRAME_US;
+	}
+	lead = (HID_SOF_LEAD_US + frame_us - 1) / frame_us;
+	pSof->stats.period = (uint16_t) period;
+	pSof->stats.lead = (uint16_t) MIN(MAX(lead, 1), period);
+	pSof->stats.phase = 0;
+	pSof->phase_valid = 0;
+	pSof->pRegs->USBINTR_D |= USBINTR_SRE;
+}
+
+/* Learn the poll phase from a completed report */
+void hid_sof_in_done(USBD_HANDLE_T hUsb, uint32_t chan)
+{
+	HID_Sof_Ctrl_T *pSof = &g_sof;
+	uint16_t phase;
+
+	if ((hUsb != pSof->hUsb) || (chan != pSof->chan)) {
+		return;
+	}
+	phase = (uint16_t) (sof_now(pSof) & (pSof->stats.period - 1));
+	if (pSof->phase_valid && (phase != pSof->stats.phase)) {
+		pSof->stats.phase_changes++;
+	}
+	pSof->stats.phase = phase;
+	pSof->phase_valid = 1;
+}
+
+/* Get the counters */
+const HID_Sof_Stats_T *hid_sof_get_stats(void)
+{
+	return &g_sof.stats;
+}
+
+#endif /* HID_SOF_SCHED */
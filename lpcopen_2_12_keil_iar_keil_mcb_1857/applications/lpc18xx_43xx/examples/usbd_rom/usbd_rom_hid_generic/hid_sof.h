@@ -0,0 +1,125 @@
+/*
+ * @brief SOF synchronized report scheduling
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_SOF_H_
+#define __HID_SOF_H_
+
+#include "board.h"
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/* The host polls an interrupt IN endpoint in the same (micro)frame of every
+   service interval. The frame index of each completed IN report of the
+   scheduled channel gives that phase, and the SOF interrupt of the frame
+   HID_SOF_LEAD_US ahead of the next poll (rounded up to whole frames, at
+   least one) captures the sample and queues its report. The time from
+   capture to poll then no longer depends on when the main loop runs. */
+
+/**
+ * @brief Capture callback, builds one report in place
+ * @param	pPayload	: Payload area of a free IN slot of the channel
+ * @return	Payload length, or 0 to send nothing this interval
+ * @note	Called from the USB interrupt.
+ */
+typedef uint32_t (*HID_SOF_CAPTURE_T)(uint8_t *pPayload);
+
+/**
+ * @brief SOF scheduler counters
+ */
+typedef struct {
+	uint32_t captures;		/*!< Reports built by the capture callback */
+	uint32_t missed;		/*!< Capture points without a free slot */
+	uint32_t phase_changes;	/*!< Poll phase differed from the learnt one */
+	uint16_t phase;			/*!< Poll (micro)frame modulo the interval */
+	uint16_t period;		/*!< Service interval in (micro)frames */
+	uint16_t lead;			/*!< Capture lead in (micro)frames */
+} HID_Sof_Stats_T;
+
+/**
+ * @brief	Register the SOF callback.
+ * @param	pParam	: ROM stack init parameters of one port, before hw->Init()
+ * @return	Nothing
+ */
+void hid_sof_init_param(USBD_API_INIT_PARAM_T *pParam);
+
+/**
+ * @brief	Bind the port and channel the scheduler feeds.
+ * @param	hUsb			: Handle of the port's USB stack
+ * @param	usb_reg_base	: LPC_USB0_BASE or LPC_USB1_BASE
+ * @param	chan			: Logical channel the reports are sent on
+ * @param	capture			: Capture callback
+ * @return	LPC_OK
+ * @note	One port is scheduled, the SOF events of other ports are
+ *			ignored. The channel is owned by the scheduler from now on.
+ */
+ErrorCode_t hid_sof_attach(USBD_HANDLE_T hUsb, uint32_t usb_reg_base, uint32_t chan, HID_SOF_CAPTURE_T capture);
+
+/**
+ * @brief	Enable or disable the SOF interrupt after a (re)configuration.
+ * @param	hUsb	: Handle of the port's USB stack
+ * @return	Nothing
+ * @note	Called from the configure event, sets up interval and lead for
+ *			the negotiated speed and forgets the poll phase.
+ */
+void hid_sof_configure(USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Take the poll phase from a completed IN report.
+ * @param	hUsb	: Handle of the port's USB stack
+ * @param	chan	: Channel of the completed report
+ * @return	Nothing
+ * @note	Called from the HID IN endpoint handler on every completed report.
+ */
+void hid_sof_in_done(USBD_HANDLE_T hUsb, uint32_t chan);
+
+/**
+ * @brief	Get the scheduler counters.
+ * @return	Pointer to the counters, updated from interrupt context
+ */
+const HID_Sof_Stats_T *hid_sof_get_stats(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_SOF_H_ */
@@ -0,0 +1,165 @@
+/*
+ * @brief USB event statistics used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <stdint.h>
+#include <string.h>
+#include "hid_stats.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/** Singleton instance of the event counters */
+HID_Stats_T g_hidStats;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void wr_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t) val;
+	p[1] = (uint8_t) (val >> 8);
+	p[2] = (uint8_t) (val >> 16);
+	p[3] = (uint8_t) (val >> 24);
+}
+
+/* Clear all counters */
+static void hid_stats_clear(void)
+{
+	HID_Stats_T *pStats = &g_hidStats;
+	uint32_t i;
+
+	for (i = 0; i < HID_NUM_PORTS; i++) {
+		if (pStats->pEp0[i] != NULL) {
+			UsbEp0Patch_ClearStats(pStats->pEp0[i]);
+		}
+	}
+	pStats->in_complete = 0;
+	pStats->out_complete = 0;
+	pStats->out_nak = 0;
+	pStats->queue_full = 0;
+	pStats->cyc_cnt = 0;
+	pStats->cyc_min = 0xFFFFFFFF;
+	pStats->cyc_max = 0;
+	pStats->cyc_sum = 0;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Enable cycle counter and clear statistics */
+void hid_stats_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	memset(&g_hidStats, 0, sizeof(g_hidStats));
+	hid_stats_clear();
+}
+
+/* Include a port's EP0 patch counters in the report */
+void hid_stats_ep0_attach(USBEP0PATCH_T *pPatch)
+{
+	uint32_t i;
+
+	for (i = 0; i < HID_NUM_PORTS; i++) {
+		if ((g_hidStats.pEp0[i] == NULL) || (g_hidStats.pEp0[i] == pPatch)) {
+			g_hidStats.pEp0[i] = pPatch;
+			return;
+		}
+	}
+}
+
+/* Account cycles of a timed handler call */
+void hid_stats_cyc_end(uint32_t start)
+{
+	HID_Stats_T *pStats = &g_hidStats;
+	uint32_t cyc = DWT->CYCCNT - start;
+
+	if (cyc < pStats->cyc_min) {
+		pStats->cyc_min = cyc;
+	}
+	if (cyc > pStats->cyc_max) {
+		pStats->cyc_max = cyc;
+	}
+	pStats->cyc_sum += cyc;
+	pStats->cyc_cnt++;
+}
+
+/* Build statistics feature report */
+uint16_t hid_stats_get_report(uint8_t *pReport)
+{
+	HID_Stats_T s;
+	uint32_t ep0_nak = 0, ep0_nested = 0, ep0_cyc = 0, i;
+
+	/* snapshot so the report is consistent, called from USB IRQ context
+	   so the counters can not move underneath us */
+	s = g_hidStats;
+	for (i = 0; i < HID_NUM_PORTS; i++) {
+		if (s.pEp0[i] != NULL) {
+			ep0_nak += s.pEp0[i]->nak_cnt;
+			ep0_nested += s.pEp0[i]->nak_nested;
+			ep0_cyc = MAX(ep0_cyc, s.pEp0[i]->cyc_max);
+		}
+	}
+	pReport[0] = HID_REPORT_ID_STATS;
+	pReport[1] = pReport[2] = pReport[3] = 0;
+	wr_le32(&pReport[4], s.in_complete);
+	wr_le32(&pReport[8], s.out_complete);
+	wr_le32(&pReport[12], s.out_nak);
+	wr_le32(&pReport[16], ep0_nak);
+	wr_le32(&pReport[20], ep0_nested);
+	wr_le32(&pReport[24], s.queue_full);
+	wr_le32(&pReport[28], s.cyc_cnt);
+	wr_le32(&pReport[32], s.cyc_cnt ? s.cyc_min : 0);
+	wr_le32(&pReport[36], s.cyc_max);
+	wr_le32(&pReport[40], s.cyc_cnt ? (uint32_t) (s.cyc_sum / s.cyc_cnt) : 0);
+	wr_le32(&pReport[44], ep0_cyc);
+	return HID_STATS_REPORT_BYTES;
+}
+
+/* Clear statistics on request from host */
+ErrorCode_t hid_stats_set_report(const uint8_t *pReport, uint16_t length)
+{
+	if ((length < 1) || (pReport[0] != HID_REPORT_ID_STATS)) {
+		return ERR_USBD_STALL;
+	}
+	hid_stats_clear();
+	return LPC_OK;
+}
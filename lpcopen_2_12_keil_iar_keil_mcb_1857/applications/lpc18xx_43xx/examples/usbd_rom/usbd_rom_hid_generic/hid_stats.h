@@ -0,0 +1,133 @@
+/*
+ * @brief USB event statistics used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_STATS_H_
+#define __HID_STATS_H_
+
+#include "board.h"
+#include "app_usbd_cfg.h"
+#include "usbd_ep0patch.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/**
+ * @brief Event counters updated from the USB interrupt
+ */
+typedef struct {
+	uint32_t in_complete;	/*!< Interrupt IN transfers completed */
+	uint32_t out_complete;	/*!< Interrupt OUT transfers completed */
+	uint32_t out_nak;		/*!< Interrupt OUT NAK events (read re-arms) */
+	uint32_t queue_full;	/*!< IN reports dropped or refused, queue full */
+	uint32_t cyc_cnt;		/*!< Number of timed HID endpoint handler calls */
+	uint32_t cyc_min;		/*!< Fastest handler call in core cycles */
+	uint32_t cyc_max;		/*!< Slowest handler call in core cycles */
+	uint64_t cyc_sum;		/*!< Sum of handler cycles */
+	USBEP0PATCH_T *pEp0[HID_NUM_PORTS];	/*!< EP0 patches of the ports, for their counters */
+} HID_Stats_T;
+
+/* Layout of the statistics feature report:
+     byte 0     : HID_REPORT_ID_STATS
+     byte 1..3  : reserved
+     byte 4..   : in_complete, out_complete, out_nak, ep0_nak, ep0_nak_nested,
+                  queue_full, cyc_cnt, cyc_min, cyc_max, average cycles and
+                  worst-case EP0 handler cycles, each 32 bit little endian.
+                  The EP0 values are summed (maximum for the cycles) over
+                  the ports, taken from their usbd_ep0patch instances.
+   Writing the report clears all counters.
+   HID_STATS_REPORT_BYTES is defined in app_usbd_cfg.h for the descriptor.
+ */
+
+extern HID_Stats_T g_hidStats;
+
+/** Count one event, called from the USB interrupt only */
+#define HID_STATS_INC(field)    (g_hidStats.field++)
+
+/**
+ * @brief	Start the DWT cycle counter and clear all counters.
+ * @return	Nothing
+ */
+void hid_stats_init(void);
+
+/**
+ * @brief	Include the counters of a port's EP0 patch in the report.
+ * @param	pPatch	: Installed EP0 patch instance of the port
+ * @return	Nothing
+ */
+void hid_stats_ep0_attach(USBEP0PATCH_T *pPatch);
+
+/**
+ * @brief	Read the cycle counter at the start of a timed section.
+ * @return	Current DWT cycle count.
+ */
+STATIC INLINE uint32_t hid_stats_cyc_start(void)
+{
+	return DWT->CYCCNT;
+}
+
+/**
+ * @brief	Account the cycles spent in a timed section.
+ * @param	start	: Value returned by hid_stats_cyc_start()
+ * @return	Nothing
+ */
+void hid_stats_cyc_end(uint32_t start);
+
+/**
+ * @brief	Handle GET_REPORT(Feature) for HID_REPORT_ID_STATS.
+ * @param	pReport	: Pointer to report buffer to fill
+ * @return	Length of the report written to @a pReport.
+ */
+uint16_t hid_stats_get_report(uint8_t *pReport);
+
+/**
+ * @brief	Handle SET_REPORT(Feature) for HID_REPORT_ID_STATS.
+ * @param	pReport	: Pointer to report received in the data stage
+ * @param	length	: Length of the received report
+ * @return	LPC_OK when counters were cleared, else ERR_USBD_STALL.
+ */
+ErrorCode_t hid_stats_set_report(const uint8_t *pReport, uint16_t length);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_STATS_H_ */
@@ -0,0 +1,346 @@
+/*
+ * @brief USB suspend, resume and remote wakeup used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "hid_suspend.h"
+
+#ifdef HID_SUSPEND
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Pin interrupt of the wakeup button */
+#define WAKE_PININT_INDEX       0
+#define WAKE_PININT_HANDLER     GPIO0_IRQHandler
+#define WAKE_PININT_NVIC_NAME   PIN_INT0_IRQn
+
+/* PORTSC1_D PHY low power suspend, stops the PHY clock */
+#define PORTSC1_PHCD            _BIT(23)
+
+/* USB1 takes its 60MHz from the USB PLL too, so the PLL only goes down when
+   USB0 is the only port */
+#if defined(USE_USB0) && !defined(USE_USB1)
+#define SUSPEND_USB_PLL_OFF
+#endif
+
+/* A core clock above 110MHz has to be reached through an intermediate step
+   of at least 50us. The step is taken from the main PLL through IDIVB. */
+#define RAMP_FREQ_LIMIT         110000000UL
+#define RAMP_STEP_US            50
+
+/* State of one port */
+typedef struct {
+	USBD_HANDLE_T hUsb;					/*!< Handle of the port's USB stack */
+	LPC_USBHS_T *pRegs;					/*!< Controller registers of the port */
+	uint8_t suspended;					/*!< Bus suspended by the host */
+	uint8_t wake_enabled;				/*!< Host enabled remote wakeup */
+} HID_Suspend_Port_T;
+
+typedef struct {
+	HID_Suspend_Port_T port[HID_NUM_PORTS];	/*!< Bound ports */
+	uint32_t num_ports;						/*!< Number of bound ports */
+	uint32_t gated;							/*!< Clocks are gated */
+	CHIP_CGU_CLKIN_T mx_input;				/*!< Core clock source while running */
+	bool mx_autoblock;						/*!< Core clock autoblock while running */
+	bool mx_pd;								/*!< Core clock power down while running */
+	HID_Suspend_Port_T *pMeasure;			/*!< Port waiting for its first IN report */
+	uint32_t start_cyc;						/*!< DWT count when pMeasure was set */
+	uint32_t samples;						/*!< First-report samples taken */
+	uint32_t printed;						/*!< First-report samples printed */
+	uint32_t remote;						/*!< Last sample started from the button */
+	HID_Suspend_Stats_T stats;				/*!< Counters */
+} HID_Suspend_Ctrl_T;
+
+static HID_Suspend_Ctrl_T g_suspend;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static HID_Suspend_Port_T *suspend_port(USBD_HANDLE_T hUsb)
+{
+	uint32_t i;
+
+	for (i = 0; i < g_suspend.num_ports; i++) {
+		if (g_suspend.port[i].hUsb == hUsb) {
+			return &g_suspend.port[i];
+		}
+	}
+	return NULL;
+}
+
+static bool all_suspended(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < g_suspend.num_ports; i++) {
+		if (!g_suspend.port[i].suspended) {
+			return false;
+		}
+	}
+	return g_suspend.num_ports != 0;
+}
+
+/* Run the core from the IRC and stop the clocks only USB traffic needs */
+static void clocks_gate(void)
+{
+	if (g_suspend.gated) {
+		return;
+	}
+	/* no samples while the host does not listen, and no 1ms wakeups */
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+	Chip_Clock_GetBaseClockOpts(CLK_BASE_MX, &g_suspend.mx_input, &g_suspend.mx_autoblock, &g_suspend.mx_pd);
+	Chip_Clock_SetBaseClock(CLK_BASE_MX, CLKIN_IRC, true, false);
+#ifdef SUSPEND_USB_PLL_OFF
+	/* PHY clock off first, the PHY wakes by itself on resume signaling */
+	g_suspend.port[0].pRegs->PORTSC1_D |= PORTSC1_PHCD;
+	Chip_Clock_DisablePLL(CGU_USB_PLL);
+#endif
+	SystemCoreClockUpdate();
+
+	g_suspend.gated = 1;
+	g_suspend.stats.suspends++;
+}
+
+/* Bring back the clocks of clocks_gate(), called with the USB IRQs masked or
+   from USB IRQ context */
+static void clocks_restore(void)
+{
+	uint32_t start;
+
+	if (!g_suspend.gated) {
+		return;
+	}
+	start = DWT->CYCCNT;
+#ifdef SUSPEND_USB_PLL_OFF
+	Chip_Clock_EnablePLL(CGU_USB_PLL);
+	while (!(Chip_Clock_GetPLLStatus(CGU_USB_PLL) & CGU_PLL_LOCKED)) {}
+	g_suspend.port[0].pRegs->PORTSC1_D &= ~PORTSC1_PHCD;
+#endif
+	/* still on the IRC, the count is in IRC cycles */
+	g_suspend.stats.restore_us = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000);
+
+	if ((g_suspend.mx_input == CLKIN_MAINPLL) && (Chip_Clock_GetClockInputHz(CLKIN_MAINPLL) > RAMP_FREQ_LIMIT)) {
+		Chip_Clock_SetDivider(CLK_IDIV_B, CLKIN_MAINPLL, 2);
+		Chip_Clock_SetBaseClock(CLK_BASE_MX, CLKIN_IDIVB, true, false);
+		SystemCoreClockUpdate();
+		start = DWT->CYCCNT;
+		while ((DWT->CYCCNT - start) < ((SystemCoreClock / 1000000) * RAMP_STEP_US)) {}
+		g_suspend.stats.restore_us += RAMP_STEP_US;
+	}
+	Chip_Clock_SetBaseClock(CLK_BASE_MX, g_suspend.mx_input, g_suspend.mx_autoblock, g_suspend.mx_pd);
+	SystemCoreClockUpdate();
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+	g_suspend.gated = 0;
+	g_suspend.stats.resumes++;
+}
+
+/* Start a first-report measurement on a port */
+static void measure_start(HID_Suspend_Port_T *pPort, uint32_t remote)
+{
+	if (g_suspend.pMeasure == NULL) {
+		g_suspend.pMeasure = pPort;
+		g_suspend.start_cyc = DWT->CYCCNT;
+		g_suspend.remote = remote;
+	}
+}
+
+/* USB Suspend Event Callback */
+static ErrorCode_t suspend_event(USBD_HANDLE_T hUsb)
+{
+	HID_Suspend_Port_T *pPort = suspend_port(hUsb);
+
+	if (pPort != NULL) {
+		pPort->suspended = 1;
+		if (g_suspend.pMeasure == pPort) {
+			/* suspended again before a report went out, no sample */
+			g_suspend.pMeasure = NULL;
+		}
+		if (all_suspended()) {
+			clocks_gate();
+		}
+	}
+	return LPC_OK;
+}
+
+/* USB Resume Event Callback, the clocks are back already, see hid_suspend_isr() */
+static ErrorCode_t resume_event(USBD_HANDLE_T hUsb)
+{
+	HID_Suspend_Port_T *pPort = suspend_port(hUsb);
+
+	if ((pPort != NULL) && pPort->suspended) {
+		pPort->suspended = 0;
+		measure_start(pPort, 0);
+	}
+	return LPC_OK;
+}
+
+/* USB Remote Wakeup Config Callback */
+static ErrorCode_t wakeup_cfg_event(USBD_HANDLE_T hUsb, uint32_t enable)
+{
+	HID_Suspend_Port_T *pPort = suspend_port(hUsb);
+
+	if (pPort != NULL) {
+		pPort->wake_enabled = (enable != 0);
+	}
+	USBD_API->hw->WakeUpCfg(hUsb, enable);
+	return LPC_OK;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	Handle interrupt from the wakeup button
+ * @return	Nothing
+ */
+void WAKE_PININT_HANDLER(void)
+{
+	HID_Suspend_Port_T *pPort;
+	uint32_t i;
+
+	Chip_PININT_ClearIntStatus(LPC_GPIO_PIN_INT, PININTCH(WAKE_PININT_INDEX));
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	for (i = 0; i < g_suspend.num_ports; i++) {
+		pPort = &g_suspend.port[i];
+		if (pPort->suspended && pPort->wake_enabled) {
+			/* resume signaling needs the controller clocked */
+			clocks_restore();
+			USBD_API->hw->WakeUp(pPort->hUsb);
+			g_suspend.stats.remote_wakeups++;
+			measure_start(pPort, 1);
+		}
+	}
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+}
+
+/* Set up the wakeup button pin interrupt */
+void hid_suspend_init(void)
+{
+	memset(&g_suspend, 0, sizeof(g_suspend));
+
+	Board_Buttons_Init();
+	Chip_SCU_GPIOIntPinSel(WAKE_PININT_INDEX, BUTTONS_BUTTON1_GPIO_PORT_NUM, BUTTONS_BUTTON1_GPIO_BIT_NUM);
+
+	/* the button pulls the pin low */
+	Chip_PININT_ClearIntStatus(LPC_GPIO_PIN_INT, PININTCH(WAKE_PININT_INDEX));
+	Chip_PININT_SetPinModeEdge(LPC_GPIO_PIN_INT, PININTCH(WAKE_PININT_INDEX));
+	Chip_PININT_EnableIntLow(LPC_GPIO_PIN_INT, PININTCH(WAKE_PININT_INDEX));
+
+	NVIC_ClearPendingIRQ(WAKE_PININT_NVIC_NAME);
+	NVIC_EnableIRQ(WAKE_PININT_NVIC_NAME);
+}
+
+/* Register the suspend, resume and wakeup config callbacks */
+void hid_suspend_init_param(USBD_API_INIT_PARAM_T *pParam)
+{
+	pParam->USB_Suspend_Event = suspend_event;
+	pParam->USB_Resume_Event = resume_event;
+	pParam->USB_WakeUpCfg = wakeup_cfg_event;
+}
+
+/* Bind a port */
+ErrorCode_t hid_suspend_attach(USBD_HANDLE_T hUsb, uint32_t usb_reg_base)
+{
+	HID_Suspend_Port_T *pPort;
+
+	if (g_suspend.num_ports >= HID_NUM_PORTS) {
+		return ERR_FAILED;
+	}
+	pPort = &g_suspend.port[g_suspend.num_ports];
+	pPort->hUsb = hUsb;
+	pPort->pRegs = (LPC_USBHS_T *) usb_reg_base;
+	pPort->suspended = 0;
+	pPort->wake_enabled = 0;
+	g_suspend.num_ports++;
+	return LPC_OK;
+}
+
+/* Restore the clocks if they are gated */
+void hid_suspend_isr(void)
+{
+	clocks_restore();
+}
+
+/* Take the first-report latency sample after a resume */
+void hid_suspend_in_done(USBD_HANDLE_T hUsb)
+{
+	uint32_t us;
+
+	if ((g_suspend.pMeasure != NULL) && (g_suspend.pMeasure->hUsb == hUsb)) {
+		us = (DWT->CYCCNT - g_suspend.start_cyc) / (SystemCoreClock / 1000000);
+		g_suspend.stats.first_report_us = us;
+		g_suspend.stats.first_report_max_us = MAX(g_suspend.stats.first_report_max_us, us);
+		g_suspend.pMeasure = NULL;
+		g_suspend.samples++;
+	}
+}
+
+/* Tell whether a port is suspended */
+bool hid_suspend_active(USBD_HANDLE_T hUsb)
+{
+	HID_Suspend_Port_T *pPort = suspend_port(hUsb);
+
+	return (pPort != NULL) && pPort->suspended;
+}
+
+/* Print a new resume measurement */
+void hid_suspend_task(void)
+{
+	if (g_suspend.printed != g_suspend.samples) {
+		g_suspend.printed = g_suspend.samples;
+		DEBUGOUT("Resume: clocks %lu us, first report %lu us (max %lu us)%s\r\n",
+				 (unsigned long) g_suspend.stats.restore_us, (unsigned long) g_suspend.stats.first_report_us,
+				 (unsigned long) g_suspend.stats.first_report_max_us, g_suspend.remote ? ", remote wakeup" : "");
+	}
+}
+
+/* Get the suspend and resume counters */
+const HID_Suspend_Stats_T *hid_suspend_get_stats(void)
+{
+	return &g_suspend.stats;
+}
+
+#endif /* HID_SUSPEND */
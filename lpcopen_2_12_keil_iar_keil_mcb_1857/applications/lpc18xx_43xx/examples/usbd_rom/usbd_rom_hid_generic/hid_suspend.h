@@ -0,0 +1,134 @@
+/*
+ * @brief USB suspend, resume and remote wakeup used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_SUSPEND_H_
+#define __HID_SUSPEND_H_
+
+#include "board.h"
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/**
+ * @brief Suspend and resume counters, times in microseconds
+ */
+typedef struct {
+	uint32_t suspends;			/*!< Suspend events that gated the clocks */
+	uint32_t resumes;			/*!< Resumes that restored the clocks */
+	uint32_t remote_wakeups;	/*!< Resume signaling started from the wakeup button */
+	uint32_t restore_us;		/*!< Last clock restore, PLL lock included */
+	uint32_t first_report_us;	/*!< Last resume (or button press) to first IN report done */
+	uint32_t first_report_max_us;	/*!< Longest first_report_us seen */
+} HID_Suspend_Stats_T;
+
+/* While every port is suspended the core runs from the 12MHz IRC instead of
+   the main PLL and SysTick is stopped, so only USB and the wakeup button
+   interrupt the WFI of the main loop. In USB0 only builds the PHY clock is
+   also stopped (PORTSC1 PHCD) and the USB PLL is powered down. The first
+   interrupt of a port, or the wakeup button, brings the clocks back before
+   the ROM stack runs. */
+
+/**
+ * @brief	Set up the wakeup button pin interrupt.
+ * @return	Nothing
+ * @note	Uses BUTTON1 (GPIO2[0] on P4_0) on pin interrupt 0. Call once
+ *			before the ports are initialized.
+ */
+void hid_suspend_init(void);
+
+/**
+ * @brief	Register the suspend, resume and wakeup config callbacks.
+ * @param	pParam	: ROM stack init parameters of one port, before hw->Init()
+ * @return	Nothing
+ */
+void hid_suspend_init_param(USBD_API_INIT_PARAM_T *pParam);
+
+/**
+ * @brief	Bind a port, after hw->Init() returned its handle.
+ * @param	hUsb			: Handle of the port's USB stack
+ * @param	usb_reg_base	: LPC_USB0_BASE or LPC_USB1_BASE
+ * @return	LPC_OK or ERR_FAILED when all HID_NUM_PORTS are bound
+ */
+ErrorCode_t hid_suspend_attach(USBD_HANDLE_T hUsb, uint32_t usb_reg_base);
+
+/**
+ * @brief	Restore the clocks if they are gated.
+ * @return	Nothing
+ * @note	Called from the USB IRQ handlers before USBD_API->hw->ISR(), the
+ *			ROM stack must not run on a stopped controller clock.
+ */
+void hid_suspend_isr(void);
+
+/**
+ * @brief	Take the first-report latency sample after a resume.
+ * @param	hUsb	: Handle of the port's USB stack
+ * @return	Nothing
+ * @note	Called from the HID IN endpoint handler on every completed report.
+ */
+void hid_suspend_in_done(USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Tell whether a port is suspended by the host.
+ * @param	hUsb	: Handle of the port's USB stack
+ * @return	true while the port is suspended
+ */
+bool hid_suspend_active(USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Print a new resume measurement on the debug UART.
+ * @return	Nothing
+ * @note	Call from the main loop.
+ */
+void hid_suspend_task(void);
+
+/**
+ * @brief	Get the suspend and resume counters.
+ * @return	Pointer to the counters, updated from interrupt context
+ */
+const HID_Suspend_Stats_T *hid_suspend_get_stats(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_SUSPEND_H_ */
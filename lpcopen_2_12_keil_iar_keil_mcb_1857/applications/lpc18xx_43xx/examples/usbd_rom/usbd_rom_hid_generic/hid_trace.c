@@ -0,0 +1,164 @@
+/*
+ * @brief USB interrupt trace used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <string.h>
+#include "ring_buffer.h"
+#include "board_log.h"
+#include "hid_trace.h"
+
+#ifdef HID_ISR_TRACE
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Trace ring, filled from the USB IRQs and drained by the feature report or
+   the main loop */
+typedef struct {
+	RINGBUFF_T ring;								/*!< Ring over g_traceEntries[] */
+	uint32_t dropped;								/*!< Entries lost on a full ring */
+} HID_Trace_Ctrl_T;
+
+static HID_Trace_Ctrl_T g_trace;
+
+/* Ring storage, only read back after the ISR wrote it so the start up code
+   need not clear it */
+static NOINIT HID_Trace_Entry_T g_traceEntries[HID_TRACE_DEPTH];
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void wr_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t) val;
+	p[1] = (uint8_t) (val >> 8);
+	p[2] = (uint8_t) (val >> 16);
+	p[3] = (uint8_t) (val >> 24);
+}
+
+/* Pop one entry, the main loop and the EP0 handler may both drain */
+static int trace_pop(HID_Trace_Entry_T *pEntry)
+{
+	int ret;
+
+	/* enter critical section */
+	HID_USB_IRQ_DISABLE();
+	ret = RingBuffer_Pop(&g_trace.ring, pEntry);
+	/* exit critical section */
+	HID_USB_IRQ_ENABLE();
+
+	return ret;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Empty the trace ring */
+void hid_trace_init(void)
+{
+	RingBuffer_Init(&g_trace.ring, g_traceEntries, sizeof(HID_Trace_Entry_T), HID_TRACE_DEPTH);
+	g_trace.dropped = 0;
+}
+
+/* Run the ROM ISR and record the interrupt */
+void hid_trace_isr(USBD_HANDLE_T hUsb, LPC_USBHS_T *pRegs, uint32_t port)
+{
+	HID_Trace_Entry_T e;
+	uint32_t cpl;
+
+	/* sample before the ROM ISR acknowledges the events */
+	e.start = DWT->CYCCNT;
+	e.sts = pRegs->USBSTS_D & pRegs->USBINTR_D;
+	cpl = pRegs->ENDPTCOMPLETE;
+	e.ep = (uint16_t) ((cpl & 0x3F) | ((cpl >> 8) & 0x3F00));
+	e.setup = (uint8_t) (pRegs->ENDPTSETUPSTAT & 0x3F);
+	e.port = (uint8_t) port;
+
+	USBD_API->hw->ISR(hUsb);
+
+	e.cycles = DWT->CYCCNT - e.start;
+	if (!RingBuffer_Insert(&g_trace.ring, &e)) {
+		g_trace.dropped++;
+	}
+}
+
+/* Pass one pending entry to the deferred debug log */
+void hid_trace_task(void)
+{
+#ifdef HID_TRACE_UART
+	HID_Trace_Entry_T e;
+
+	if (trace_pop(&e)) {
+		DEBUGLOG("USB%d @%lu sts %05lx ep %04x setup %02x %lu cyc\r\n", e.port,
+				 (unsigned long) e.start, (unsigned long) e.sts, e.ep, e.setup, (unsigned long) e.cycles);
+	}
+#endif
+}
+
+/* Build trace feature report */
+uint16_t hid_trace_get_report(uint8_t *pReport)
+{
+	HID_Trace_Entry_T e;
+	uint8_t *p = &pReport[4];
+	uint32_t n = 0, dropped;
+
+	while ((n < HID_TRACE_REPORT_ENTRIES) && trace_pop(&e)) {
+		wr_le32(&p[0], e.start);
+		wr_le32(&p[4], e.cycles);
+		wr_le32(&p[8], e.sts);
+		p[12] = (uint8_t) e.ep;
+		p[13] = (uint8_t) (e.ep >> 8);
+		p[14] = e.setup;
+		p[15] = e.port;
+		p += HID_TRACE_ENTRY_BYTES;
+		n++;
+	}
+	memset(p, 0, (HID_TRACE_REPORT_ENTRIES - n) * HID_TRACE_ENTRY_BYTES);
+
+	/* called from USB IRQ context, the counter can not move underneath us */
+	dropped = MIN(g_trace.dropped, 0xFFFF);
+	g_trace.dropped = 0;
+	pReport[0] = HID_REPORT_ID_TRACE;
+	pReport[1] = (uint8_t) n;
+	pReport[2] = (uint8_t) dropped;
+	pReport[3] = (uint8_t) (dropped >> 8);
+	return HID_TRACE_REPORT_BYTES;
+}
+
+#endif /* HID_ISR_TRACE */
@@ -0,0 +1,114 @@
+/*
+ * @brief USB interrupt trace used with HID example
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __HID_TRACE_H_
+#define __HID_TRACE_H_
+
+#include "board.h"
+#include "app_usbd_cfg.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_HID_GENERIC
+ * @{
+ */
+
+/**
+ * @brief One USB interrupt as seen on entry to the ROM ISR
+ */
+typedef struct {
+	uint32_t start;			/*!< DWT cycle count at ISR entry */
+	uint32_t cycles;		/*!< Core cycles spent in the ROM ISR */
+	uint32_t sts;			/*!< Pending and enabled USBSTS_D bits */
+	uint16_t ep;			/*!< ENDPTCOMPLETE, RX bits 5:0 and TX bits 13:8 */
+	uint8_t setup;			/*!< ENDPTSETUPSTAT bits 5:0 */
+	uint8_t port;			/*!< Index of the port that interrupted */
+} HID_Trace_Entry_T;
+
+/* Layout of the trace feature report:
+     byte 0     : HID_REPORT_ID_TRACE
+     byte 1     : number of entries that follow, 0 when the ring is empty
+     byte 2..3  : entries dropped on a full ring since the previous read,
+                  16 bit little endian, saturating
+     byte 4..   : up to HID_TRACE_REPORT_ENTRIES entries of
+                  HID_TRACE_ENTRY_BYTES, the fields of HID_Trace_Entry_T
+                  in order, little endian
+   Reading the report removes the returned entries from the ring; with
+   HID_TRACE_UART defined the main loop prints them on the debug UART
+   instead and the report is mostly empty.
+ */
+
+/**
+ * @brief	Empty the trace ring.
+ * @return	Nothing
+ */
+void hid_trace_init(void);
+
+/**
+ * @brief	Run the ROM ISR of one port and record the interrupt.
+ * @param	hUsb	: Handle of the port's USB stack
+ * @param	pRegs	: Controller registers of the port
+ * @param	port	: Index of the port, recorded with the entry
+ * @return	Nothing
+ * @note	Called from the USB IRQ handlers in place of USBD_API->hw->ISR().
+ *			The cycle count needs the DWT counter, see hid_stats_init().
+ */
+void hid_trace_isr(USBD_HANDLE_T hUsb, LPC_USBHS_T *pRegs, uint32_t port);
+
+/**
+ * @brief	Pass one pending entry to the deferred debug log.
+ * @return	Nothing
+ * @note	Call from the main loop; does nothing unless HID_TRACE_UART is
+ *			defined. Board_Log_Task() prints the entries without waiting on
+ *			the UART.
+ */
+void hid_trace_task(void);
+
+/**
+ * @brief	Handle GET_REPORT(Feature) for HID_REPORT_ID_TRACE.
+ * @param	pReport	: Pointer to report buffer of HID_TRACE_REPORT_BYTES
+ * @return	Length of the report written to @a pReport.
+ */
+uint16_t hid_trace_get_report(uint8_t *pReport);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_TRACE_H_ */
@@ -0,0 +1,406 @@
+/*
+ * @brief Asynchronous host side HID report reader
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hid_async.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <hidsdi.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define MAX_READS               64
+#define POLL_US                 200		/* consumer wait step */
+
+struct hid_async {
+	/* Queue: the reader owns head, the consumer owns tail */
+	_Atomic uint32_t head;
+	_Atomic uint32_t tail;
+	uint32_t mask;
+	int slot_bytes;
+	hid_async_report *slots;
+	uint8_t *mem;
+
+	_Atomic int stop;
+	_Atomic uint64_t reports, dropped, errors;
+	_Atomic uint32_t max_fill;
+
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE thread;
+	int reads;
+	int read_bytes;
+	OVERLAPPED ov[MAX_READS];
+	int pending[MAX_READS];
+	uint8_t *buf[MAX_READS];
+	LARGE_INTEGER freq;
+#else
+	hid_device *dev;
+	pthread_t thread;
+	uint8_t *scratch;		/* target of reads while the queue is full */
+#endif
+};
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static uint64_t now_ns(hid_async *h)
+{
+#ifdef _WIN32
+	LARGE_INTEGER c;
+
+	QueryPerformanceCounter(&c);
+	return (uint64_t) ((double) c.QuadPart * 1e9 / (double) h->freq.QuadPart);
+#else
+	struct timespec ts;
+
+	(void) h;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static void sleep_us(int us)
+{
+#ifdef _WIN32
+	Sleep((us + 999) / 1000);
+#else
+	struct timespec ts;
+
+	ts.tv_sec = 0;
+	ts.tv_nsec = us * 1000L;
+	nanosleep(&ts, NULL);
+#endif
+}
+
+/* Free queue slot for the next report or NULL if the queue is full */
+static hid_async_report *slot_get(hid_async *h)
+{
+	uint32_t head = atomic_load_explicit(&h->head, memory_order_relaxed);
+
+	if ((head - atomic_load_explicit(&h->tail, memory_order_acquire)) > h->mask) {
+		return NULL;
+	}
+	return &h->slots[head & h->mask];
+}
+
+/* Stamp and publish a report, or count it dropped without a slot */
+static void slot_commit(hid_async *h, hid_async_report *pSlot, uint64_t t_ns, int len)
+{
+	uint64_t index = atomic_fetch_add_explicit(&h->reports, 1, memory_order_relaxed);
+	uint32_t head, fill;
+
+	if (pSlot == NULL) {
+		atomic_fetch_add_explicit(&h->dropped, 1, memory_order_relaxed);
+		return;
+	}
+	pSlot->t_ns = t_ns;
+	pSlot->index = index;
+	pSlot->len = len;
+	head = atomic_load_explicit(&h->head, memory_order_relaxed) + 1;
+	atomic_store_explicit(&h->head, head, memory_order_release);
+	fill = head - atomic_load_explicit(&h->tail, memory_order_relaxed);
+	if (fill > atomic_load_explicit(&h->max_fill, memory_order_relaxed)) {
+		atomic_store_explicit(&h->max_fill, fill, memory_order_relaxed);
+	}
+}
+
+#ifdef _WIN32
+/* Queue an overlapped read on buffer n, 0 on failure */
+static int read_submit(hid_async *h, int n)
+{
+	ResetEvent(h->ov[n].hEvent);
+	if (ReadFile(h->file, h->buf[n], h->read_bytes, NULL, &h->ov[n]) ||
+		(GetLastError() == ERROR_IO_PENDING)) {
+		h->pending[n] = 1;
+		return 1;
+	}
+	atomic_fetch_add_explicit(&h->errors, 1, memory_order_relaxed);
+	return 0;
+}
+
+/* Reads complete in the order they were queued: wait for the oldest, hand
+   its report over and queue it again, so reads - 1 stay pending meanwhile */
+static DWORD WINAPI reader_thread(LPVOID arg)
+{
+	hid_async *h = arg;
+	hid_async_report *pSlot;
+	DWORD len;
+	int n, len_ok;
+
+	for (n = 0; n < h->reads; n++) {
+		read_submit(h, n);
+	}
+	n = 0;
+	while (!atomic_load_explicit(&h->stop, memory_order_relaxed)) {
+		if (!h->pending[n] && !read_submit(h, n)) {
+			/* device gone, retry until closed */
+			sleep_us(10000);
+			continue;
+		}
+		if (WaitForSingleObject(h->ov[n].hEvent, 100) == WAIT_TIMEOUT) {
+			continue;
+		}
+		h->pending[n] = 0;
+		len_ok = GetOverlappedResult(h->file, &h->ov[n], &len, FALSE);
+		if (len_ok) {
+			pSlot = slot_get(h);
+			if (pSlot != NULL) {
+				if ((int) len > h->slot_bytes) {
+					len = h->slot_bytes;
+				}
+				memcpy(pSlot->data, h->buf[n], len);
+			}
+			slot_commit(h, pSlot, now_ns(h), (int) len);
+		}
+		else {
+			atomic_fetch_add_explicit(&h->errors, 1, memory_order_relaxed);
+		}
+		read_submit(h, n);
+		n = (n + 1) % h->reads;
+	}
+	CancelIo(h->file);
+	for (n = 0; n < h->reads; n++) {
+		if (h->pending[n]) {
+			GetOverlappedResult(h->file, &h->ov[n], &len, TRUE);
+		}
+	}
+	return 0;
+}
+
+static int reader_start(hid_async *h, const char *path, int reads)
+{
+	PHIDP_PREPARSED_DATA pp;
+	HIDP_CAPS caps;
+	DWORD tid;
+	int n;
+
+	QueryPerformanceFrequency(&h->freq);
+	h->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+						  NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+	if (h->file == INVALID_HANDLE_VALUE) {
+		return -1;
+	}
+	HidD_SetNumInputBuffers(h->file, HID_ASYNC_DRIVER_BUFFERS);
+	/* ReadFile() takes nothing shorter than the longest input report */
+	h->read_bytes = h->slot_bytes;
+	if (HidD_GetPreparsedData(h->file, &pp)) {
+		if ((HidP_GetCaps(pp, &caps) == HIDP_STATUS_SUCCESS) && (caps.InputReportByteLength > h->read_bytes)) {
+			h->read_bytes = caps.InputReportByteLength;
+		}
+		HidD_FreePreparsedData(pp);
+	}
+	h->reads = reads > MAX_READS ? MAX_READS : reads;
+	for (n = 0; n < h->reads; n++) {
+		h->ov[n].hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		h->buf[n] = malloc(h->read_bytes);
+		if ((h->ov[n].hEvent == NULL) || (h->buf[n] == NULL)) {
+			return -1;
+		}
+	}
+	h->thread = CreateThread(NULL, 0, reader_thread, h, 0, &tid);
+	if (h->thread == NULL) {
+		return -1;
+	}
+	SetThreadPriority(h->thread, THREAD_PRIORITY_TIME_CRITICAL);
+	return 0;
+}
+
+static void reader_stop(hid_async *h)
+{
+	int n;
+
+	if (h->thread != NULL) {
+		WaitForSingleObject(h->thread, INFINITE);
+		CloseHandle(h->thread);
+	}
+	for (n = 0; n < h->reads; n++) {
+		if (h->ov[n].hEvent != NULL) {
+			CloseHandle(h->ov[n].hEvent);
+		}
+		free(h->buf[n]);
+	}
+	if (h->file != INVALID_HANDLE_VALUE) {
+		CloseHandle(h->file);
+	}
+}
+
+#else
+/* Reads straight into the next free slot */
+static void *reader_thread(void *arg)
+{
+	hid_async *h = arg;
+	hid_async_report *pSlot;
+	int len;
+
+	while (!atomic_load_explicit(&h->stop, memory_order_relaxed)) {
+		pSlot = slot_get(h);
+		len = hid_read_timeout(h->dev, pSlot != NULL ? pSlot->data : h->scratch, h->slot_bytes, 100);
+		if (len > 0) {
+			slot_commit(h, pSlot, now_ns(h), len);
+		}
+		else if (len < 0) {
+			atomic_fetch_add_explicit(&h->errors, 1, memory_order_relaxed);
+			sleep_us(10000);
+		}
+	}
+	return NULL;
+}
+
+static int reader_start(hid_async *h, hid_device *dev, int reads)
+{
+	(void) reads;
+	h->dev = dev;
+	h->scratch = malloc(h->slot_bytes);
+	if ((h->scratch == NULL) || (pthread_create(&h->thread, NULL, reader_thread, h) != 0)) {
+		free(h->scratch);
+		h->scratch = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+static void reader_stop(hid_async *h)
+{
+	if (h->scratch != NULL) {
+		pthread_join(h->thread, NULL);
+		free(h->scratch);
+	}
+}
+
+#endif
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start reading reports */
+hid_async *hid_async_open(hid_device *dev, const char *path, int report_bytes, int depth, int reads)
+{
+	hid_async *h;
+	uint32_t n, slots = 1;
+	int ret;
+
+	if ((report_bytes < 1) || (depth < 1) || (reads < 1)) {
+		return NULL;
+	}
+	while (slots < (uint32_t) depth) {
+		slots <<= 1;
+	}
+	h = calloc(1, sizeof(*h));
+	if (h == NULL) {
+		return NULL;
+	}
+	h->mask = slots - 1;
+	h->slot_bytes = report_bytes;
+	h->slots = calloc(slots, sizeof(hid_async_report));
+	h->mem = malloc((size_t) slots * report_bytes);
+	if ((h->slots == NULL) || (h->mem == NULL)) {
+		free(h->slots);
+		free(h->mem);
+		free(h);
+		return NULL;
+	}
+	for (n = 0; n < slots; n++) {
+		h->slots[n].data = &h->mem[(size_t) n * report_bytes];
+	}
+
+#ifdef _WIN32
+	(void) dev;
+	h->file = INVALID_HANDLE_VALUE;
+	ret = reader_start(h, path, reads);
+#else
+	(void) path;
+	ret = reader_start(h, dev, reads);
+#endif
+	if (ret < 0) {
+		hid_async_close(h);
+		return NULL;
+	}
+	return h;
+}
+
+/* Get the oldest queued report without copying it */
+const hid_async_report *hid_async_peek(hid_async *h, int timeout_ms)
+{
+	uint32_t tail = atomic_load_explicit(&h->tail, memory_order_relaxed);
+	long waited = 0;
+
+	while (atomic_load_explicit(&h->head, memory_order_acquire) == tail) {
+		if (waited >= timeout_ms * 1000L) {
+			return NULL;
+		}
+		sleep_us(POLL_US);
+		waited += POLL_US;
+	}
+	return &h->slots[tail & h->mask];
+}
+
+/* Free the report returned by the last hid_async_peek() */
+void hid_async_release(hid_async *h)
+{
+	atomic_store_explicit(&h->tail, atomic_load_explicit(&h->tail, memory_order_relaxed) + 1,
+						  memory_order_release);
+}
+
+/* Copy the reader statistics */
+void hid_async_get_stats(hid_async *h, hid_async_stats *pStats)
+{
+	pStats->reports = atomic_load(&h->reports);
+	pStats->dropped = atomic_load(&h->dropped);
+	pStats->errors = atomic_load(&h->errors);
+	pStats->max_fill = atomic_load(&h->max_fill);
+}
+
+/* Stop the reader thread and free the reader */
+void hid_async_close(hid_async *h)
+{
+	atomic_store(&h->stop, 1);
+	reader_stop(h);
+	free(h->slots);
+	free(h->mem);
+	free(h);
+}
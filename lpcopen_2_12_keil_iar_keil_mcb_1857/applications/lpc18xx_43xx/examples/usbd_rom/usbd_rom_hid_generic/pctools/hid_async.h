@@ -0,0 +1,131 @@
+/*
+ * @brief Asynchronous host side HID report reader
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * @par
+ * A reader thread keeps the interrupt IN pipe of one HID interface busy,
+ * stamps every report with the host monotonic clock as it completes and
+ * hands it to the application through a lock-free single producer, single
+ * consumer queue, so a slow consumer costs queue slots instead of reports.
+ * On Windows the thread keeps several overlapped ReadFile() calls
+ * outstanding on its own handle and raises the HID class driver ring to
+ * HID_ASYNC_DRIVER_BUFFERS reports. Elsewhere it loops on hid_read_timeout()
+ * of hidapi, which already queues reports behind one submitted transfer
+ * (libusb) or in the kernel (hidraw). Link with hid_async.c, hidapi and
+ * -lpthread, or -lhid -lsetupapi on Windows (MinGW gcc, C11 atomics).
+ */
+
+#ifndef __HID_ASYNC_H_
+#define __HID_ASYNC_H_
+
+#include <stdint.h>
+#include <hidapi/hidapi.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Number of input reports the Windows HID class driver buffers per handle
+   (HidD_SetNumInputBuffers(), 2 to 512) */
+#define HID_ASYNC_DRIVER_BUFFERS    512
+
+/** Reader statistics */
+typedef struct {
+	uint64_t reports;		/*!< Reports read */
+	uint64_t dropped;		/*!< Reports read while the queue was full */
+	uint64_t errors;		/*!< Failed reads */
+	uint32_t max_fill;		/*!< Highest number of queued reports */
+} hid_async_stats;
+
+/** One queued report */
+typedef struct {
+	uint64_t t_ns;			/*!< Host monotonic clock when the read completed */
+	uint64_t index;			/*!< Number of reports read before this one */
+	int len;				/*!< Bytes in data, report ID first */
+	uint8_t *data;			/*!< Report, valid until hid_async_release() */
+} hid_async_report;
+
+/** Reader of one HID interface */
+typedef struct hid_async hid_async;
+
+/**
+ * @brief	Start reading reports
+ * @param	dev				: hidapi handle of the interface, read through on
+ *                            all but Windows
+ * @param	path			: hidapi path of the interface, opened again for
+ *                            overlapped reads on Windows
+ * @param	report_bytes	: Largest report including the report ID
+ * @param	depth			: Queue slots, rounded up to a power of 2
+ * @param	reads			: Reads kept outstanding (Windows), at least 1
+ * @return	The reader or NULL on failure
+ * @note	dev stays owned by the caller and may still be used for feature
+ * reports and writes, but not for hid_read() while the reader runs. Size
+ * depth for the longest time the application may not consume, at the
+ * report rate: 8192 slots hold one second of 8 kHz reports.
+ */
+hid_async *hid_async_open(hid_device *dev, const char *path, int report_bytes, int depth, int reads);
+
+/**
+ * @brief	Get the oldest queued report without copying it
+ * @param	h			: Reader
+ * @param	timeout_ms	: Time to wait for a report, 0 to poll
+ * @return	The report or NULL if none arrived in time
+ * @note	Only one thread may consume. Call hid_async_release() when done.
+ */
+const hid_async_report *hid_async_peek(hid_async *h, int timeout_ms);
+
+/**
+ * @brief	Free the report returned by the last hid_async_peek()
+ * @param	h	: Reader
+ * @return	Nothing
+ */
+void hid_async_release(hid_async *h);
+
+/**
+ * @brief	Copy the reader statistics
+ * @param	h		: Reader
+ * @param	pStats	: Filled with the counters since hid_async_open()
+ * @return	Nothing
+ */
+void hid_async_get_stats(hid_async *h, hid_async_stats *pStats);
+
+/**
+ * @brief	Stop the reader thread and free the reader
+ * @param	h	: Reader
+ * @return	Nothing
+ * @note	Reports still queued are discarded.
+ */
+void hid_async_close(hid_async *h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HID_ASYNC_H_ */
@@ -0,0 +1,729 @@
+/*
+ * @brief Host side tool for the generic HID benchmark modes
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * @par
+ * Build with hidapi (http://github.com/signal11/hidapi) and the asynchronous
+ * reader, for example:
+ *   gcc -O2 -o hid_bench_host hid_bench_host.c hid_async.c -lhidapi-libusb -lpthread
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <hidapi/hidapi.h>
+#include "hid_async.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Must match app_usbd_cfg.h and hid_bench.h of the firmware */
+#define HID_VID                 0x1FC9
+#define HID_PID                 0x0081
+#define REPORT_ID_CONTROL       1		/* HID_CHAN_REPORT_ID(HID_CHAN_CONTROL) */
+#define REPORT_ID_TELEMETRY     3		/* HID_CHAN_REPORT_ID(HID_CHAN_TELEMETRY) */
+#define REPORT_ID_BENCH         0x11
+#define BENCH_REPORT_BYTES      16
+#define REPORT_ID_STATS         0x12
+#define STATS_REPORT_BYTES      48
+#define REPORT_ID_TRACE         0x13
+#define TRACE_ENTRY_BYTES       16
+#define TRACE_REPORT_BYTES      (4 + 15 * TRACE_ENTRY_BYTES)
+#define REPORT_ID_PROF          0x14
+#define PROF_REPORT_BYTES       72
+#define PROF_HIST_BINS          8
+#define REPORT_ID_MEM           0x15
+#define MEM_REPORT_BYTES        40
+#define BENCH_MODE_OFF          0
+#define BENCH_MODE_IN           1
+#define BENCH_MODE_OUT          2
+#define BENCH_MODE_PINGPONG     3
+#define BENCH_MODE_PROBE        4
+#define PROBE_BYTES             20
+
+#define MAX_REPORT_BYTES        3072
+#define MAX_CHANNELS            4
+#define IN_HDR_BYTES            4		/* HID_IN_HDR_BYTES of a HID_IN_HEADER build */
+
+static hid_device *g_dev;
+static char *g_path;		/* hidapi path of g_dev */
+static int g_depth;			/* async reader queue slots, set with -a */
+static int g_hdr;			/* IN report header bytes, set with -H */
+static uint8_t g_buf[MAX_REPORT_BYTES + 1];
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static uint32_t rd_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static void wr_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t) val;
+	p[1] = (uint8_t) (val >> 8);
+	p[2] = (uint8_t) (val >> 16);
+	p[3] = (uint8_t) (val >> 24);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *) a, y = *(const double *) b;
+
+	return (x > y) - (x < y);
+}
+
+/* Select benchmark mode, clears the firmware counters */
+static int bench_set_mode(uint8_t mode)
+{
+	uint8_t rep[BENCH_REPORT_BYTES];
+
+	memset(rep, 0, sizeof(rep));
+	rep[0] = REPORT_ID_BENCH;
+	rep[1] = mode;
+	return hid_send_feature_report(g_dev, rep, sizeof(rep)) < 0 ? -1 : 0;
+}
+
+/* Read firmware counters: IN reports queued, OUT received, OUT lost */
+static int bench_get_counters(uint32_t *tx, uint32_t *rx, uint32_t *lost)
+{
+	uint8_t rep[BENCH_REPORT_BYTES];
+
+	rep[0] = REPORT_ID_BENCH;
+	if (hid_get_feature_report(g_dev, rep, sizeof(rep)) < BENCH_REPORT_BYTES) {
+		return -1;
+	}
+	*tx = rd_le32(&rep[4]);
+	*rx = rd_le32(&rep[8]);
+	*lost = rd_le32(&rep[12]);
+	return 0;
+}
+
+/* Device to host streaming */
+static void run_in(int report_bytes, double secs)
+{
+	uint32_t seq, next = 0, count = 0, lost = 0, tx, rx, rx_lost;
+	double t0, t;
+	int len;
+
+	bench_set_mode(BENCH_MODE_IN);
+	t0 = now_us();
+	do {
+		len = hid_read_timeout(g_dev, g_buf, report_bytes, 100);
+		t = now_us();
+		if ((len < 5 + g_hdr) || (g_buf[0] != REPORT_ID_TELEMETRY)) {
+			continue;
+		}
+		seq = rd_le32(&g_buf[1 + g_hdr]);
+		if (count && (seq != next)) {
+			lost += seq - next;
+		}
+		next = seq + 1;
+		count++;
+	} while ((t - t0) < secs * 1e6);
+	/* read counters first, selecting a mode clears them */
+	if (bench_get_counters(&tx, &rx, &rx_lost) < 0) {
+		tx = 0;
+	}
+	bench_set_mode(BENCH_MODE_OFF);
+
+	printf("IN: %u reports of %d bytes in %.2f s, device queued %u\n",
+		   count, report_bytes, (t - t0) / 1e6, tx);
+	printf("IN: %.3f MB/s, %.0f reports/s, %u lost\n",
+		   (double) count * report_bytes / (t - t0), count * 1e6 / (t - t0), lost);
+}
+
+/* Device to host streaming through the asynchronous reader, which also
+   shows the spread of report arrival times on the host */
+static void run_in_async(int report_bytes, double secs)
+{
+	const hid_async_report *rep;
+	hid_async_stats st;
+	hid_async *h;
+	uint32_t seq, next = 0, count = 0, lost = 0, tx, rx, rx_lost;
+	uint64_t t0 = 0, t = 0, t_last = 0, dt, dt_min = 0, dt_max = 0;
+
+	h = hid_async_open(g_dev, g_path, report_bytes, g_depth, 8);
+	if (h == NULL) {
+		fprintf(stderr, "starting the reader failed\n");
+		return;
+	}
+	bench_set_mode(BENCH_MODE_IN);
+	while ((rep = hid_async_peek(h, 1000)) != NULL) {
+		if ((rep->len >= 5 + g_hdr) && (rep->data[0] == REPORT_ID_TELEMETRY)) {
+			t = rep->t_ns;
+			if (count == 0) {
+				t0 = t;
+			}
+			else {
+				dt = t - t_last;
+				if ((count == 1) || (dt < dt_min)) {
+					dt_min = dt;
+				}
+				if (dt > dt_max) {
+					dt_max = dt;
+				}
+			}
+			t_last = t;
+			seq = rd_le32(&rep->data[1 + g_hdr]);
+			if (count && (seq != next)) {
+				lost += seq - next;
+			}
+			next = seq + 1;
+			count++;
+		}
+		hid_async_release(h);
+		if ((count > 1) && ((t - t0) >= secs * 1e9)) {
+			break;
+		}
+	}
+	if (bench_get_counters(&tx, &rx, &rx_lost) < 0) {
+		tx = 0;
+	}
+	bench_set_mode(BENCH_MODE_OFF);
+	hid_async_get_stats(h, &st);
+	hid_async_close(h);
+
+	if (count < 2) {
+		printf("IN: %u reports\n", count);
+		return;
+	}
+	printf("IN: %u reports of %d bytes in %.2f s, device queued %u\n",
+		   count, report_bytes, (t - t0) / 1e9, tx);
+	printf("IN: %.3f MB/s, %.0f reports/s, %u lost\n",
+		   (double) count * report_bytes * 1e3 / (t - t0), count * 1e9 / (t - t0), lost);
+	printf("IN: arrival spacing us min %.1f avg %.1f max %.1f, reader queue max %u of %d, %llu dropped\n",
+		   dt_min / 1e3, (t - t0) / 1e3 / (count - 1), dt_max / 1e3, st.max_fill, g_depth,
+		   (unsigned long long) st.dropped);
+}
+
+/* Host to device streaming */
+static void run_out(int report_bytes, double secs)
+{
+	uint32_t seq = 0, tx, rx, lost;
+	double t0, t;
+
+	bench_set_mode(BENCH_MODE_OUT);
+	memset(g_buf, 0, sizeof(g_buf));
+	t0 = now_us();
+	do {
+		g_buf[0] = REPORT_ID_TELEMETRY;
+		wr_le32(&g_buf[1], seq);
+		if (hid_write(g_dev, g_buf, report_bytes) < 0) {
+			fprintf(stderr, "write failed: %ls\n", hid_error(g_dev));
+			break;
+		}
+		seq++;
+		t = now_us();
+	} while ((t - t0) < secs * 1e6);
+	t = now_us();
+	if (bench_get_counters(&tx, &rx, &lost) < 0) {
+		fprintf(stderr, "reading counters failed\n");
+		rx = lost = 0;
+	}
+	bench_set_mode(BENCH_MODE_OFF);
+
+	printf("OUT: %u reports of %d bytes written in %.2f s, device got %u\n",
+		   seq, report_bytes, (t - t0) / 1e6, rx);
+	printf("OUT: %.3f MB/s, %.0f reports/s, %u lost\n",
+		   (double) rx * report_bytes / (t - t0), rx * 1e6 / (t - t0), lost);
+}
+
+/* Round trip latency of echoed reports */
+static void run_pingpong(int report_bytes, int count)
+{
+	double *rtt, t0, t;
+	uint32_t seq;
+	int n = 0, lost = 0, len;
+
+	rtt = malloc(count * sizeof(double));
+	if (rtt == NULL) {
+		return;
+	}
+	bench_set_mode(BENCH_MODE_PINGPONG);
+	memset(g_buf, 0, sizeof(g_buf));
+	for (seq = 0; seq < (uint32_t) count; seq++) {
+		g_buf[0] = REPORT_ID_CONTROL;
+		wr_le32(&g_buf[1], seq);
+		t0 = now_us();
+		if (hid_write(g_dev, g_buf, report_bytes) < 0) {
+			fprintf(stderr, "write failed: %ls\n", hid_error(g_dev));
+			break;
+		}
+		/* wait for the echo, skipping late echoes of earlier reports */
+		do {
+			len = hid_read_timeout(g_dev, g_buf, report_bytes, 100);
+			t = now_us();
+		} while ((len > 0) && ((g_buf[0] != REPORT_ID_CONTROL) || (rd_le32(&g_buf[1 + g_hdr]) != seq)));
+		if (len <= 0) {
+			lost++;
+			continue;
+		}
+		rtt[n++] = t - t0;
+	}
+	bench_set_mode(BENCH_MODE_OFF);
+
+	printf("PINGPONG: %d of %d reports of %d bytes echoed, %d lost\n", n, count, report_bytes, lost);
+	if (n) {
+		qsort(rtt, n, sizeof(double), cmp_double);
+		printf("PINGPONG: rtt us min %.0f p50 %.0f p90 %.0f p99 %.0f max %.0f\n",
+			   rtt[0], rtt[n / 2], rtt[(n * 9) / 10], rtt[(n * 99) / 100], rtt[n - 1]);
+	}
+	free(rtt);
+}
+
+static void print_pct(const char *name, double *v, int n)
+{
+	qsort(v, n, sizeof(double), cmp_double);
+	printf("PROBE: %-14s us min %7.1f p50 %7.1f p90 %7.1f p99 %7.1f max %7.1f\n",
+		   name, v[0], v[n / 2], v[(n * 9) / 10], v[(n * 99) / 100], v[n - 1]);
+}
+
+/* Round trips answered with the device's OUT arrival and IN queue times,
+   split into host to device, device and device to host legs */
+static void run_probe(int report_bytes, int count)
+{
+	double *t_wr, *t_rd, *d_in, *d_out, *rtt, *up, *dev, *down, *frames;
+	double tps, t, t0 = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, slope, icpt, min_up, min_down, k;
+	uint32_t seq, arrival0 = 0, arrival, queued;
+	int n = 0, lost = 0, len, i;
+	const uint8_t *p;
+
+	t_wr = malloc(9 * count * sizeof(double));
+	if (t_wr == NULL) {
+		return;
+	}
+	t_rd = t_wr + count;
+	d_in = t_rd + count;
+	d_out = d_in + count;
+	rtt = d_out + count;
+	up = rtt + count;
+	dev = up + count;
+	down = dev + count;
+	frames = down + count;
+
+	bench_set_mode(BENCH_MODE_PROBE);
+	memset(g_buf, 0, sizeof(g_buf));
+	for (seq = 0; seq < (uint32_t) count; seq++) {
+		g_buf[0] = REPORT_ID_CONTROL;
+		wr_le32(&g_buf[1], seq);
+		t = now_us();
+		if (hid_write(g_dev, g_buf, report_bytes) < 0) {
+			fprintf(stderr, "write failed: %ls\n", hid_error(g_dev));
+			break;
+		}
+		do {
+			len = hid_read_timeout(g_dev, g_buf, report_bytes, 100);
+		} while ((len > 0) && ((g_buf[0] != REPORT_ID_CONTROL) || (len < 1 + g_hdr + PROBE_BYTES) ||
+							   (rd_le32(&g_buf[1 + g_hdr]) != seq)));
+		if (len <= 0) {
+			lost++;
+			continue;
+		}
+		p = &g_buf[1 + g_hdr];
+		tps = rd_le32(&p[16]);
+		arrival = rd_le32(&p[4]);
+		queued = rd_le32(&p[8]);
+		if (n == 0) {
+			t0 = t;
+			arrival0 = arrival;
+		}
+		/* host times in us since the first send, keeps the fit exact */
+		t_wr[n] = t - t0;
+		t_rd[n] = now_us() - t0;
+		/* device times in us since the first arrival, the stopwatch wraps
+		   after minutes */
+		d_out[n] = (uint32_t) (arrival - arrival0) * 1e6 / tps;
+		d_in[n] = d_out[n] + (uint32_t) (queued - arrival) * 1e6 / tps;
+		frames[n] = (uint16_t) ((p[14] | (p[15] << 8)) - (p[12] | (p[13] << 8))) & 0x3FFF;
+		n++;
+	}
+	bench_set_mode(BENCH_MODE_OFF);
+
+	printf("PROBE: %d of %d reports of %d bytes answered, %d lost\n", n, count, report_bytes, lost);
+	if (n < 2) {
+		free(t_wr);
+		return;
+	}
+	/* The clocks differ by an offset and a drift of some ppm. Fit the
+	   device arrival time against the host send time, then split what is
+	   left of the offset so the fastest legs of either direction are
+	   equal: the one-way legs are only as symmetric as their minimums. */
+	for (i = 0; i < n; i++) {
+		sx += t_wr[i];
+		sy += d_out[i] - t_wr[i];
+		sxx += t_wr[i] * t_wr[i];
+		sxy += t_wr[i] * (d_out[i] - t_wr[i]);
+	}
+	slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+	icpt = (sy - slope * sx) / n;
+	min_up = min_down = 1e30;
+	for (i = 0; i < n; i++) {
+		k = icpt + slope * t_wr[i];
+		up[i] = d_out[i] - k - t_wr[i];
+		down[i] = t_rd[i] - (d_in[i] - k);
+		if (up[i] < min_up) {
+			min_up = up[i];
+		}
+		if (down[i] < min_down) {
+			min_down = down[i];
+		}
+	}
+	k = (min_up - min_down) / 2;
+	for (i = 0; i < n; i++) {
+		up[i] -= k;
+		down[i] += k;
+		rtt[i] = t_rd[i] - t_wr[i];
+		dev[i] = d_in[i] - d_out[i];
+	}
+	printf("PROBE: clock drift %.1f ppm\n", slope * 1e6);
+	print_pct("round trip", rtt, n);
+	print_pct("host->device", up, n);
+	print_pct("device", dev, n);
+	print_pct("device->host", down, n);
+	qsort(frames, n, sizeof(double), cmp_double);
+	printf("PROBE: frame index advance from OUT to answer min %.0f p50 %.0f max %.0f\n",
+		   frames[0], frames[n / 2], frames[n - 1]);
+	free(t_wr);
+}
+
+/* Check the IN report headers of a HID_IN_HEADER build for lost or
+   reordered reports and show the spacing of reports in USB frame time */
+static void run_gaps(int report_bytes, double secs)
+{
+	struct {
+		uint32_t count, lost, reorder;
+		uint16_t seq, frindex;
+		uint32_t dt_min, dt_max;
+		double dt_sum;
+	} ch[MAX_CHANNELS];
+	uint32_t dt;
+	uint16_t seq, frindex;
+	double t0, t;
+	int len, i;
+
+	memset(ch, 0, sizeof(ch));
+	t0 = now_us();
+	do {
+		len = hid_read_timeout(g_dev, g_buf, report_bytes, 100);
+		t = now_us();
+		if ((len < 1 + IN_HDR_BYTES) || (g_buf[0] < 1) || (g_buf[0] > MAX_CHANNELS)) {
+			continue;
+		}
+		i = g_buf[0] - 1;
+		seq = (uint16_t) (g_buf[1] | (g_buf[2] << 8));
+		frindex = (uint16_t) (g_buf[3] | (g_buf[4] << 8));
+		if (ch[i].count) {
+			int16_t diff = (int16_t) (seq - (uint16_t) (ch[i].seq + 1));
+
+			if (diff > 0) {
+				ch[i].lost += diff;
+				printf("chan %d: %d reports lost before seq %u\n", i, diff, seq);
+			}
+			else if (diff < 0) {
+				ch[i].reorder++;
+				printf("chan %d: seq %u out of order, expected %u\n", i, seq, (uint16_t) (ch[i].seq + 1));
+			}
+			/* frame index counts microframes and wraps at 2^14 */
+			dt = (frindex - ch[i].frindex) & 0x3FFF;
+			if ((ch[i].count == 1) || (dt < ch[i].dt_min)) {
+				ch[i].dt_min = dt;
+			}
+			if (dt > ch[i].dt_max) {
+				ch[i].dt_max = dt;
+			}
+			ch[i].dt_sum += dt;
+		}
+		ch[i].seq = seq;
+		ch[i].frindex = frindex;
+		ch[i].count++;
+	} while ((t - t0) < secs * 1e6);
+
+	for (i = 0; i < MAX_CHANNELS; i++) {
+		if (ch[i].count == 0) {
+			continue;
+		}
+		printf("chan %d: %u reports, %u lost, %u out of order", i, ch[i].count, ch[i].lost, ch[i].reorder);
+		if (ch[i].count > 1) {
+			printf(", spacing in microframes min %u avg %.1f max %u",
+				   ch[i].dt_min, ch[i].dt_sum / (ch[i].count - 1), ch[i].dt_max);
+		}
+		printf("\n");
+	}
+}
+
+/* Dump the device USB event statistics, optionally clearing them */
+static void run_stats(int clear)
+{
+	static const char *const names[] = {
+		"in_complete", "out_complete", "out_nak", "ep0_nak", "ep0_nak_nested",
+		"queue_full", "handler_calls", "handler_cyc_min", "handler_cyc_max", "handler_cyc_avg",
+		"ep0_cyc_max"
+	};
+	uint8_t rep[STATS_REPORT_BYTES];
+	unsigned int i;
+
+	rep[0] = REPORT_ID_STATS;
+	if (hid_get_feature_report(g_dev, rep, sizeof(rep)) < STATS_REPORT_BYTES) {
+		fprintf(stderr, "reading statistics failed: %ls\n", hid_error(g_dev));
+		return;
+	}
+	for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		printf("%-16s %u\n", names[i], rd_le32(&rep[4 + i * 4]));
+	}
+	if (clear) {
+		memset(rep, 0, sizeof(rep));
+		rep[0] = REPORT_ID_STATS;
+		hid_send_feature_report(g_dev, rep, sizeof(rep));
+	}
+}
+
+/* Drain the device USB interrupt trace (firmware built with HID_ISR_TRACE) */
+static void run_trace(void)
+{
+	uint8_t rep[TRACE_REPORT_BYTES];
+	const uint8_t *p;
+	unsigned int n, dropped;
+
+	do {
+		rep[0] = REPORT_ID_TRACE;
+		if (hid_get_feature_report(g_dev, rep, sizeof(rep)) < 4) {
+			fprintf(stderr, "reading trace failed: %ls\n", hid_error(g_dev));
+			return;
+		}
+		n = rep[1];
+		dropped = rep[2] | (rep[3] << 8);
+		if (dropped) {
+			printf("-- %u entries dropped\n", dropped);
+		}
+		for (p = &rep[4]; n > 0; n--, p += TRACE_ENTRY_BYTES) {
+			printf("USB%u @%10u sts %05x ep %04x setup %02x %6u cyc\n", p[15], rd_le32(&p[0]),
+				   rd_le32(&p[8]), p[12] | (p[13] << 8), p[14], rd_le32(&p[4]));
+		}
+	} while (rep[1] != 0);
+}
+
+/* Dump the device profiling regions (firmware built with CHIP_PROFILE_ENABLE),
+   optionally clearing them */
+static void run_prof(int clear)
+{
+	uint8_t rep[PROF_REPORT_BYTES];
+	unsigned int i, n, b;
+	double us;
+
+	/* start the walk at region 0 */
+	memset(rep, 0, sizeof(rep));
+	rep[0] = REPORT_ID_PROF;
+	if (hid_send_feature_report(g_dev, rep, sizeof(rep)) < 0) {
+		fprintf(stderr, "selecting region failed: %ls\n", hid_error(g_dev));
+		return;
+	}
+	n = 1;
+	for (i = 0; i < n; i++) {
+		rep[0] = REPORT_ID_PROF;
+		if (hid_get_feature_report(g_dev, rep, sizeof(rep)) < PROF_REPORT_BYTES) {
+			fprintf(stderr, "reading profile failed: %ls\n", hid_error(g_dev));
+			return;
+		}
+		n = rep[2];
+		rep[19] = 0;
+		us = 1e6 / rd_le32(&rep[36]);
+		printf("%-10s n %10u min %8.2f max %8.2f avg %8.2f us |", (const char *) &rep[4], rd_le32(&rep[20]),
+			   rd_le32(&rep[24]) * us, rd_le32(&rep[28]) * us, rd_le32(&rep[32]) * us);
+		for (b = 0; b < PROF_HIST_BINS; b++) {
+			printf(" %u", rd_le32(&rep[40 + b * 4]));
+		}
+		printf("\n");
+	}
+	if (clear) {
+		memset(rep, 0, sizeof(rep));
+		rep[0] = REPORT_ID_PROF;
+		rep[2] = 1;
+		hid_send_feature_report(g_dev, rep, sizeof(rep));
+	}
+}
+
+/* Dump the device memory usage table (firmware built with HID_MEMDIAG) */
+static void run_mem(void)
+{
+	static const char *const kinds[] = {"static", "pool", "stack"};
+	static const char *const regions[] = {"local0", "local1", "ahb", "sdram", "other"};
+	uint8_t rep[MEM_REPORT_BYTES];
+	unsigned int i, n, size, used;
+
+	/* start the walk at entry 0 */
+	memset(rep, 0, sizeof(rep));
+	rep[0] = REPORT_ID_MEM;
+	if (hid_send_feature_report(g_dev, rep, sizeof(rep)) < 0) {
+		fprintf(stderr, "selecting entry failed: %ls\n", hid_error(g_dev));
+		return;
+	}
+	n = 1;
+	for (i = 0; i < n; i++) {
+		rep[0] = REPORT_ID_MEM;
+		if (hid_get_feature_report(g_dev, rep, sizeof(rep)) < MEM_REPORT_BYTES) {
+			fprintf(stderr, "reading memory table failed: %ls\n", hid_error(g_dev));
+			return;
+		}
+		n = rep[2];
+		rep[23] = 0;
+		size = rd_le32(&rep[28]);
+		used = rd_le32(&rep[32]);
+		printf("%-15s %-6s %-6s 0x%08x %8u used %8u (%3u%%)\n", (const char *) &rep[8],
+			   (rep[3] < 3) ? kinds[rep[3]] : "?", (rep[4] < 5) ? regions[rep[4]] : "?",
+			   rd_le32(&rep[24]), size, used, size ? (unsigned int) (((double) used * 100) / size) : 0);
+	}
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s in|out|pingpong [-s report_bytes] [-t secs] [-n count] [-a depth]\n", prog);
+	fprintf(stderr, "       %s probe [-s report_bytes] [-n count]\n", prog);
+	fprintf(stderr, "       %s gaps [-s report_bytes] [-t secs]\n", prog);
+	fprintf(stderr, "       %s stats|stats-clear|trace|prof|prof-clear|mem\n", prog);
+	fprintf(stderr, "  -s  report size incl. report ID, 255 (default) or 3072 for HID_HS_HIGH_BANDWIDTH\n");
+	fprintf(stderr, "  -t  duration of in/out tests in seconds, default 5\n");
+	fprintf(stderr, "  -n  number of ping-pong or probe round trips, default 1000\n");
+	fprintf(stderr, "  -H  firmware built with HID_IN_HEADER (implied by gaps)\n");
+	fprintf(stderr, "  -a  run in through the asynchronous reader with this many queue slots\n");
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	struct hid_device_info *devs;
+	int report_bytes = 255, count = 1000, i;
+	double secs = 5;
+
+	if (argc < 2) {
+		usage(argv[0]);
+		return 1;
+	}
+	for (i = 2; i < argc; i++) {
+		if (strcmp(argv[i], "-H") == 0) {
+			g_hdr = IN_HDR_BYTES;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			break;
+		}
+		if (strcmp(argv[i], "-s") == 0) {
+			report_bytes = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-t") == 0) {
+			secs = atof(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-n") == 0) {
+			count = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-a") == 0) {
+			g_depth = atoi(argv[i + 1]);
+		}
+		i++;
+	}
+	if ((report_bytes < 8) || (report_bytes > MAX_REPORT_BYTES) || (count <= 0) || (g_depth < 0)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (hid_init() < 0) {
+		return 1;
+	}
+	devs = hid_enumerate(HID_VID, HID_PID);
+	if (devs != NULL) {
+		g_path = strdup(devs->path);
+		g_dev = hid_open_path(g_path);
+	}
+	hid_free_enumeration(devs);
+	if (g_dev == NULL) {
+		fprintf(stderr, "LPC HID device %04x:%04x not found\n", HID_VID, HID_PID);
+		return 1;
+	}
+
+	if ((strcmp(argv[1], "in") == 0) && g_depth) {
+		run_in_async(report_bytes, secs);
+	}
+	else if (strcmp(argv[1], "in") == 0) {
+		run_in(report_bytes, secs);
+	}
+	else if (strcmp(argv[1], "out") == 0) {
+		run_out(report_bytes, secs);
+	}
+	else if (strcmp(argv[1], "pingpong") == 0) {
+		run_pingpong(report_bytes, count);
+	}
+	else if (strcmp(argv[1], "probe") == 0) {
+		run_probe(report_bytes, count);
+	}
+	else if (strcmp(argv[1], "gaps") == 0) {
+		run_gaps(report_bytes, secs);
+	}
+	else if (strcmp(argv[1], "stats") == 0) {
+		run_stats(0);
+	}
+	else if (strcmp(argv[1], "stats-clear") == 0) {
+		run_stats(1);
+	}
+	else if (strcmp(argv[1], "trace") == 0) {
+		run_trace();
+	}
+	else if (strcmp(argv[1], "prof") == 0) {
+		run_prof(0);
+	}
+	else if (strcmp(argv[1], "prof-clear") == 0) {
+		run_prof(1);
+	}
+	else if (strcmp(argv[1], "mem") == 0) {
+		run_mem();
+	}
+	else {
+		usage(argv[0]);
+	}
+
+	hid_close(g_dev);
+	free(g_path);
+	hid_exit();
+	return 0;
+}
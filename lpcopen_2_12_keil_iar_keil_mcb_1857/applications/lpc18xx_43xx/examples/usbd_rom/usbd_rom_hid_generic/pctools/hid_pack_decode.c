@@ -0,0 +1,245 @@
+/*
+ * @brief Host side decoder for packed HID telemetry (HID_TELEMETRY_PACK)
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * @par
+ * Reads the telemetry reports of a HID_TELEMETRY_PACK build and prints one
+ * CSV line per sample: the sample number and one column per channel. Gaps
+ * in the sample numbers (reports dropped while the queue was full) go to
+ * stderr. Build with hidapi (http://github.com/signal11/hidapi), for example:
+ *   gcc -O2 -o hid_pack_decode hid_pack_decode.c -lhidapi-libusb
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <hidapi/hidapi.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Must match app_usbd_cfg.h and hid_pack.h of the firmware */
+#define HID_VID                 0x1FC9
+#define HID_PID                 0x0081
+#define REPORT_ID_TELEMETRY     3		/* HID_CHAN_REPORT_ID(HID_CHAN_TELEMETRY) */
+#define PACK_HDR_BYTES          8
+#define IN_HDR_BYTES            4		/* HID_IN_HDR_BYTES of a HID_IN_HEADER build */
+
+#define MAX_REPORT_BYTES        3072
+#define MAX_CHANNELS            64
+
+static hid_device *g_dev;
+static int g_hdr;			/* IN report header bytes, set with -H */
+static uint8_t g_buf[MAX_REPORT_BYTES + 1];
+
+static uint32_t g_next;		/* sample number expected next */
+static int g_started;		/* g_next is valid */
+static uint64_t g_samples, g_lost, g_bytes;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static uint32_t rd_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/* Read a zig-zag varint step, returns its length or 0 if it runs past end */
+static int rd_step(const uint8_t *p, const uint8_t *end, int16_t *pStep)
+{
+	uint32_t zz = 0;
+	int n = 0;
+
+	do {
+		if ((p + n >= end) || (n >= 3)) {
+			return 0;
+		}
+		zz |= (uint32_t) (p[n] & 0x7F) << (7 * n);
+	} while (p[n++] & 0x80);
+	*pStep = (int16_t) (uint16_t) ((zz >> 1) ^ (0U - (zz & 1)));
+	return n;
+}
+
+/* Decode the payload of one packed report, prints its samples */
+static int decode_report(const uint8_t *p, int len)
+{
+	const uint8_t *end = p + len;
+	uint16_t val[MAX_CHANNELS];
+	uint32_t sample, frames, f;
+	int16_t step;
+	int chans, i, n;
+
+	if (len < PACK_HDR_BYTES) {
+		return -1;
+	}
+	sample = rd_le32(p);
+	frames = p[4] | (p[5] << 8);
+	chans = p[6];
+	if ((chans == 0) || (chans > MAX_CHANNELS) || (frames == 0) ||
+		(len < PACK_HDR_BYTES + 2 * chans)) {
+		return -1;
+	}
+	if (g_started && (sample != g_next)) {
+		fprintf(stderr, "gap: samples %lu to %lu missing\n",
+				(unsigned long) g_next, (unsigned long) (sample - 1));
+		g_lost += (uint32_t) (sample - g_next);
+	}
+	p += PACK_HDR_BYTES;
+	for (i = 0; i < chans; i++, p += 2) {
+		val[i] = p[0] | (p[1] << 8);
+	}
+	for (f = 0; f < frames; f++) {
+		if (f > 0) {
+			for (i = 0; i < chans; i++, p += n) {
+				n = rd_step(p, end, &step);
+				if (n == 0) {
+					fprintf(stderr, "report of sample %lu truncated at frame %lu\n",
+							(unsigned long) sample, (unsigned long) f);
+					return -1;
+				}
+				val[i] = (uint16_t) (val[i] + (uint16_t) step);
+			}
+		}
+		printf("%lu", (unsigned long) (sample + f));
+		for (i = 0; i < chans; i++) {
+			printf(",%d", (int16_t) val[i]);
+		}
+		printf("\n");
+	}
+	g_next = sample + frames;
+	g_started = 1;
+	g_samples += frames;
+	g_bytes += len;
+	return 0;
+}
+
+/* Open HID interface intf of the device, any interface for -1. A build with
+   HID_NUM_HID_INTF > 1 sends telemetry on interface 1. */
+static hid_device *open_intf(int intf)
+{
+	struct hid_device_info *devs, *d;
+	hid_device *dev = NULL;
+
+	if (intf < 0) {
+		return hid_open(HID_VID, HID_PID, NULL);
+	}
+	devs = hid_enumerate(HID_VID, HID_PID);
+	for (d = devs; d != NULL; d = d->next) {
+		if (d->interface_number == intf) {
+			dev = hid_open_path(d->path);
+			break;
+		}
+	}
+	hid_free_enumeration(devs);
+	return dev;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-s report_bytes] [-n reports] [-i interface] [-H]\n", prog);
+	fprintf(stderr, "  -s  report size incl. report ID, 255 (default) or 3072 for HID_HS_HIGH_BANDWIDTH\n");
+	fprintf(stderr, "  -n  number of reports to decode, default 0 (until interrupted)\n");
+	fprintf(stderr, "  -i  HID interface number, 1 for HID_NUM_HID_INTF > 1 builds, default any\n");
+	fprintf(stderr, "  -H  firmware built with HID_IN_HEADER\n");
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	int report_bytes = 255, count = 0, reports = 0, intf = -1, len, i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-H") == 0) {
+			g_hdr = IN_HDR_BYTES;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return 1;
+		}
+		if (strcmp(argv[i], "-s") == 0) {
+			report_bytes = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-n") == 0) {
+			count = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "-i") == 0) {
+			intf = atoi(argv[i + 1]);
+		}
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+		i++;
+	}
+	if ((report_bytes < 1 + IN_HDR_BYTES + PACK_HDR_BYTES + 2) || (report_bytes > MAX_REPORT_BYTES) || (count < 0)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (hid_init() < 0) {
+		return 1;
+	}
+	g_dev = open_intf(intf);
+	if (g_dev == NULL) {
+		fprintf(stderr, "LPC HID device %04x:%04x not found\n", HID_VID, HID_PID);
+		return 1;
+	}
+
+	while ((count == 0) || (reports < count)) {
+		len = hid_read_timeout(g_dev, g_buf, report_bytes, 1000);
+		if (len < 0) {
+			fprintf(stderr, "read failed\n");
+			break;
+		}
+		/* other channels share the endpoint */
+		if ((len <= 1 + g_hdr) || (g_buf[0] != REPORT_ID_TELEMETRY)) {
+			continue;
+		}
+		if (decode_report(&g_buf[1 + g_hdr], len - 1 - g_hdr) < 0) {
+			fprintf(stderr, "bad packed report\n");
+		}
+		reports++;
+	}
+	if (g_bytes != 0) {
+		fprintf(stderr, "%llu samples in %d reports, %.2f bytes per sample, %llu lost\n",
+				(unsigned long long) g_samples, reports, (double) g_bytes / g_samples,
+				(unsigned long long) g_lost);
+	}
+
+	hid_close(g_dev);
+	hid_exit();
+	return 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * @brief Host side decoder for the ITM event trace (itm_trace.h)
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * @par
+ * Reads a raw SWO capture (ITM packets, NRZ, formatter bypassed) from a
+ * file or stdin, as saved by the debugger's SWO viewer or OpenOCD
+ * ("tpiu config internal swo.bin uart off <core_hz> <swo_baud>"), and
+ * prints one line per event. Build with:
+ *   gcc -O2 -o itm_decode itm_decode.c
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Must match itm_trace.h of the firmware */
+#define PORT_EVENT              1
+#define PORT_DATA               2
+#define EV_USER                 0x40
+#define STAMP_MASK              0x00FFFFFF
+
+#define MAX_PAYLOAD             8
+
+/* Names of the IDs defined by itm_trace.h */
+static const char *const evNames[EV_USER] = {
+	[0x01] = "usb_irq_enter",
+	[0x02] = "usb_irq_exit",
+	[0x03] = "dcd_irq_enter",
+	[0x04] = "dcd_irq_exit",
+	[0x05] = "enet_irq_enter",
+	[0x06] = "enet_irq_exit",
+	[0x07] = "dma_irq_enter",
+	[0x08] = "dma_irq_exit",
+};
+
+/* Event waiting for its payload words */
+static struct {
+	int valid;
+	uint32_t id;
+	uint64_t cycles;
+	uint32_t payload[MAX_PAYLOAD];
+	int count;
+} pending;
+
+/* Unwrapped cycle count of the previous event */
+static uint64_t lastCycles;
+static uint32_t lastStamp;
+static int haveStamp;
+
+/* Time of the last *_ENTER event of each ID, for the *_EXIT durations */
+static uint64_t enterCycles[256];
+static int entered[256];
+
+static double coreHz = 180e6;
+static unsigned long events, overflows;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Print the pending event */
+static void flushEvent(void)
+{
+	int i;
+
+	if (!pending.valid) {
+		return;
+	}
+	pending.valid = 0;
+	events++;
+
+	printf("%12.3f us  ", (double) pending.cycles * 1e6 / coreHz);
+	if ((pending.id < EV_USER) && evNames[pending.id]) {
+		printf("%-16s", evNames[pending.id]);
+	}
+	else {
+		printf("event 0x%02x      ", (unsigned) pending.id);
+	}
+	for (i = 0; i < pending.count; i++) {
+		printf(" 0x%08x", (unsigned) pending.payload[i]);
+	}
+
+	/* Known IDs come in ENTER (odd) and EXIT (even) pairs */
+	if ((pending.id < EV_USER) && (pending.id & 1)) {
+		enterCycles[pending.id] = pending.cycles;
+		entered[pending.id] = 1;
+	}
+	else if ((pending.id < EV_USER) && (pending.id > 0) && entered[pending.id - 1]) {
+		entered[pending.id - 1] = 0;
+		printf("  (%llu cycles)", (unsigned long long) (pending.cycles - enterCycles[pending.id - 1]));
+	}
+	printf("\n");
+}
+
+/* Handle one word of a stimulus port */
+static void stimulus(int port, uint32_t value)
+{
+	uint32_t stamp;
+
+	if (port == PORT_EVENT) {
+		flushEvent();
+		/* Events must come at least once per 2^24 cycles to unwrap */
+		stamp = value & STAMP_MASK;
+		if (haveStamp) {
+			lastCycles += (stamp - lastStamp) & STAMP_MASK;
+		}
+		lastStamp = stamp;
+		haveStamp = 1;
+
+		pending.valid = 1;
+		pending.id = value >> 24;
+		pending.cycles = lastCycles;
+		pending.count = 0;
+	}
+	else if ((port == PORT_DATA) && pending.valid && (pending.count < MAX_PAYLOAD)) {
+		pending.payload[pending.count++] = value;
+	}
+}
+
+/* Skip the continuation bytes of a packet, bit 7 set means more follow */
+static void skipContinuation(FILE *in, int header)
+{
+	int c = header;
+
+	while ((c != EOF) && (c & 0x80)) {
+		c = fgetc(in);
+	}
+}
+
+/* Decode the ITM packet stream */
+static void decode(FILE *in)
+{
+	static const int sizes[4] = {0, 1, 2, 4};
+	uint32_t value;
+	int h, c, i, n;
+
+	while ((h = fgetc(in)) != EOF) {
+		if (h == 0x00) {
+			/* Synchronisation, zeros up to a 0x80 */
+			while ((c = fgetc(in)) == 0x00) {}
+			if ((c != 0x80) && (c != EOF)) {
+				ungetc(c, in);
+			}
+		}
+		else if (h == 0x70) {
+			overflows++;
+			flushEvent();
+			printf("-- overflow, events lost\n");
+		}
+		else if ((h & 0x03) != 0) {
+			/* Source packet, software (stimulus port) or hardware (DWT) */
+			n = sizes[h & 0x03];
+			value = 0;
+			for (i = 0; i < n; i++) {
+				if ((c = fgetc(in)) == EOF) {
+					return;
+				}
+				value |= (uint32_t) c << (8 * i);
+			}
+			if ((h & 0x04) == 0) {
+				stimulus(h >> 3, value);
+			}
+		}
+		else {
+			/* Timestamp and extension packets */
+			skipContinuation(in, h);
+		}
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	FILE *in = stdin;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-f") == 0) && (i + 1 < argc)) {
+			coreHz = atof(argv[++i]);
+		}
+		else if (argv[i][0] == '-') {
+			fprintf(stderr, "usage: %s [-f core_hz] [swo.bin]\n", argv[0]);
+			return 1;
+		}
+		else if ((in = fopen(argv[i], "rb")) == NULL) {
+			perror(argv[i]);
+			return 1;
+		}
+	}
+	if (coreHz <= 0) {
+		coreHz = 180e6;
+	}
+
+	decode(in);
+	flushEvent();
+	fprintf(stderr, "%lu events, %lu overflows\n", events, overflows);
+
+	return 0;
+}
@@ -79,6 +79,15 @@ extern "C"
 #define HID_EP_IN       0x81
 #define HID_EP_OUT      0x01
 
+/* Uncomment below for an N-key-rollover keyboard: in report protocol every
+   key is a bit of a KEYBOARD_NKRO_REPORT_SIZE byte bitmap report, the
+   interrupt endpoint is polled every 1 ms (FS) or 125 us (HS) and the keys
+   are scanned from SysTick at KEYBOARD_SCAN_HZ, a changed report being
+   queued on the IN endpoint straight from the scan interrupt. The 8 byte
+   report is still sent after SET_PROTOCOL(boot), for BIOS hosts. */
+/* #define KEYBOARD_NKRO */
+#define KEYBOARD_SCAN_HZ 1000
+
 /* On LPC18xx/43xx the USB controller requires endpoint queue heads to start on
    a 4KB aligned memory. Hence the mem_base value passed to USB stack init should
    be 4KB aligned. The following manifest constants are used to define this memory.
@@ -93,15 +102,6 @@ extern uint8_t USB_FsConfigDescriptor[];
 extern const uint8_t USB_StringDescriptor[];
 extern const uint8_t USB_DeviceQualifier[];
 
-/**
- * @brief	Find the address of interface descriptor for given class type.
- * @param	pDesc		: Pointer to configuration descriptor in which the desired class
- *			interface descriptor to be found.
- * @param	intfClass	: Interface class type to be searched.
- * @return	If found returns the address of requested interface else returns NULL.
- */
-extern USB_INTERFACE_DESCRIPTOR *find_IntfDesc(const uint8_t *pDesc, uint32_t intfClass);
-
 /**
  * @}
  */
@@ -30,6 +30,7 @@
  */
 
 #include "app_usbd_cfg.h"
+#include "hid_keyboard.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -42,6 +43,39 @@
 /**
  * HID Keyboard Report Descriptor
  */
+#ifdef KEYBOARD_NKRO
+const uint8_t Keyboard_ReportDescriptor[] = {
+	HID_UsagePage(HID_USAGE_PAGE_GENERIC),
+	HID_Usage(HID_USAGE_GENERIC_KEYBOARD),
+	HID_Collection(HID_Application),
+	HID_UsagePage(HID_USAGE_PAGE_KEYBOARD),
+	HID_UsageMin(224),
+	HID_UsageMax(231),
+	HID_LogicalMin(0),
+	HID_LogicalMax(1),
+	HID_ReportSize(1),
+	HID_ReportCount(8),
+	HID_Input(HID_Data | HID_Variable | HID_Absolute),
+	HID_ReportCount(5),
+	HID_ReportSize(1),
+	HID_UsagePage(HID_USAGE_PAGE_LED),
+	HID_UsageMin(1),
+	HID_UsageMax(5),
+	HID_Output(HID_Data | HID_Variable | HID_Absolute),
+	HID_ReportCount(1),
+	HID_ReportSize(3),
+	HID_Output(HID_Constant),
+	HID_ReportCount(KEYBOARD_NKRO_MAX_USAGE + 1),
+	HID_ReportSize(1),
+	HID_LogicalMin(0),
+	HID_LogicalMax(1),
+	HID_UsagePage(HID_USAGE_PAGE_KEYBOARD),
+	HID_UsageMin(0),
+	HID_UsageMax(KEYBOARD_NKRO_MAX_USAGE),
+	HID_Input(HID_Data | HID_Variable | HID_Absolute),
+	HID_EndCollection,
+};
+#else
 const uint8_t Keyboard_ReportDescriptor[] = {
 	HID_UsagePage(HID_USAGE_PAGE_GENERIC),
 	HID_Usage(HID_USAGE_GENERIC_KEYBOARD),
@@ -76,6 +110,7 @@ const uint8_t Keyboard_ReportDescriptor[] = {
 	HID_Input(HID_Array),
 	HID_EndCollection,
 };
+#endif
 const uint16_t Keyboard_ReportDescSize = sizeof(Keyboard_ReportDescriptor);
 
 /**
@@ -154,8 +189,8 @@ ALIGNED(4) uint8_t USB_HsConfigDescriptor[] = {
 	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	HID_EP_IN,						/* bEndpointAddress */
 	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */
-	WBVAL(0x0008),					/* wMaxPacketSize */
-	0x08,							/* bInterval */
+	WBVAL(KEYBOARD_EP_MAXP),		/* wMaxPacketSize */
+	KEYBOARD_HS_INTERVAL,			/* bInterval */
 	/* Terminator */
 	0								/* bLength */
 };
@@ -204,8 +239,8 @@ ALIGNED(4) uint8_t USB_FsConfigDescriptor[] = {
 	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	HID_EP_IN,						/* bEndpointAddress */
 	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */
-	WBVAL(0x0008),					/* wMaxPacketSize */
-	0x0A,										/* bInterval */
+	WBVAL(KEYBOARD_EP_MAXP),		/* wMaxPacketSize */
+	KEYBOARD_FS_INTERVAL,			/* bInterval */
 	/* Terminator */
 	0								/* bLength */
 };
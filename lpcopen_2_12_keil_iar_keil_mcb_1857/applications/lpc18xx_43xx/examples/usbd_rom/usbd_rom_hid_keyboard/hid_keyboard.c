@@ -44,10 +44,21 @@
  */
 typedef struct {
 	USBD_HANDLE_T hUsb;	/*!< Handle to USB stack. */
-	uint8_t report[KEYBOARD_REPORT_SIZE];	/*!< Last report data  */
+	uint8_t report[KEYBOARD_EP_MAXP];	/*!< Last report data  */
 	uint8_t tx_busy;	/*!< Flag indicating whether a report is pending in endpoint queue. */
+#ifdef KEYBOARD_NKRO
+	uint8_t scan[KEYBOARD_EP_MAXP];	/*!< Report of the last scan, sent once the endpoint is free */
+	uint16_t scan_len;	/*!< Size of the scan report */
+	uint16_t report_len;	/*!< Size of the last sent report, 0 forces a resend */
+	uint8_t pending;	/*!< Flag indicating the scan report differs from the one in flight */
+	uint8_t protocol;	/*!< KEYBOARD_PROTOCOL_BOOT or KEYBOARD_PROTOCOL_REPORT */
+#endif
 } Keyboard_Ctrl_T;
 
+/* HID SET_PROTOCOL values */
+#define KEYBOARD_PROTOCOL_BOOT      0
+#define KEYBOARD_PROTOCOL_REPORT    1
+
 /** Singleton instance of Keyboard control */
 static Keyboard_Ctrl_T g_keyBoard;
 
@@ -62,39 +73,65 @@ extern const uint16_t Keyboard_ReportDescSize;
  * Private functions
  ****************************************************************************/
 
-/* Routine to update keyboard state */
-static void Keyboard_UpdateReport(void)
+/* Routine to scan the board keys, returns the number of pressed key usages */
+static int Keyboard_ScanKeys(uint8_t *keys)
 {
-	uint8_t joystick_status = Joystick_GetStatus();
-
-	HID_KEYBOARD_CLEAR_REPORT(&g_keyBoard.report[0]);
+	int n = 0;
 
-	switch (joystick_status) {
+	switch (Joystick_GetStatus()) {
 	case JOY_PRESS:
-		HID_KEYBOARD_REPORT_SET_KEY_PRESS(g_keyBoard.report, 0x53);
+		keys[n++] = 0x53;
 		break;
 
 	case JOY_LEFT:
-		HID_KEYBOARD_REPORT_SET_KEY_PRESS(g_keyBoard.report, 0x5C);
+		keys[n++] = 0x5C;
 		break;
 
 	case JOY_RIGHT:
-		HID_KEYBOARD_REPORT_SET_KEY_PRESS(g_keyBoard.report, 0x5E);
+		keys[n++] = 0x5E;
 		break;
 
 	case JOY_UP:
-		HID_KEYBOARD_REPORT_SET_KEY_PRESS(g_keyBoard.report, 0x60);
+		keys[n++] = 0x60;
 		break;
 
 	case JOY_DOWN:
-		HID_KEYBOARD_REPORT_SET_KEY_PRESS(g_keyBoard.report, 0x5A);
-		break;
-	
-	case NO_BUTTON_PRESSED:
-		if (Buttons_GetStatus() != NO_BUTTON_PRESSED)
-			HID_KEYBOARD_REPORT_SET_KEY_PRESS(g_keyBoard.report, 0x57);
+		keys[n++] = 0x5A;
 		break;
 	}
+	if (Buttons_GetStatus() != NO_BUTTON_PRESSED) {
+		keys[n++] = 0x57;
+	}
+	return n;
+}
+
+/* Routine to update keyboard state, returns the report size */
+static uint16_t Keyboard_UpdateReport(uint8_t *report)
+{
+	uint8_t keys[2];
+	int n = Keyboard_ScanKeys(keys);
+#ifdef KEYBOARD_NKRO
+	int i;
+
+	/* All pressed keys are reported, in the boot format up to 6 of them */
+	if (g_keyBoard.protocol == KEYBOARD_PROTOCOL_REPORT) {
+		memset(report, 0, KEYBOARD_NKRO_REPORT_SIZE);
+		for (i = 0; i < n; i++) {
+			HID_KEYBOARD_NKRO_SET_KEY_PRESS(report, keys[i]);
+		}
+		return KEYBOARD_NKRO_REPORT_SIZE;
+	}
+	HID_KEYBOARD_CLEAR_REPORT(report);
+	for (i = 0; i < n; i++) {
+		report[2 + i] = keys[i];
+	}
+#else
+	HID_KEYBOARD_CLEAR_REPORT(report);
+	if (n != 0) {
+		HID_KEYBOARD_REPORT_SET_KEY_PRESS(report, keys[0]);
+	}
+#endif
+	return KEYBOARD_REPORT_SIZE;
 }
 
 /* HID Get Report Request Callback. Called automatically on HID Get Report Request */
@@ -106,9 +143,7 @@ static ErrorCode_t Keyboard_GetReport(USBD_HANDLE_T hHid,
 	/* ReportID = SetupPacket.wValue.WB.L; */
 	switch (pSetup->wValue.WB.H) {
 	case HID_REPORT_INPUT:
-		Keyboard_UpdateReport();
-		memcpy(*pBuffer, &g_keyBoard.report[0], KEYBOARD_REPORT_SIZE);
-		*plength = KEYBOARD_REPORT_SIZE;
+		*plength = Keyboard_UpdateReport(*pBuffer);
 		break;
 
 	case HID_REPORT_OUTPUT:				/* Not Supported */
@@ -146,12 +181,39 @@ static ErrorCode_t Keyboard_SetReport(USBD_HANDLE_T hHid, USB_SETUP_PACKET *pSet
 	return LPC_OK;
 }
 
+#ifdef KEYBOARD_NKRO
+/* Queue the scan report on the IN endpoint */
+static void Keyboard_SendScan(void)
+{
+	memcpy(g_keyBoard.report, g_keyBoard.scan, g_keyBoard.scan_len);
+	g_keyBoard.report_len = g_keyBoard.scan_len;
+	g_keyBoard.pending = 0;
+	g_keyBoard.tx_busy = 1;
+	USBD_API->hw->WriteEP(g_keyBoard.hUsb, HID_EP_IN, &g_keyBoard.report[0], g_keyBoard.report_len);
+}
+
+/* HID Set Protocol Request Callback, the next scan resends in the new format */
+static ErrorCode_t Keyboard_SetProtocol(USBD_HANDLE_T hHid, USB_SETUP_PACKET *pSetup, uint8_t protocol)
+{
+	g_keyBoard.protocol = protocol;
+	g_keyBoard.report_len = 0;
+	return LPC_OK;
+}
+
+#endif
+
 /* HID interrupt IN endpoint handler */
 static ErrorCode_t Keyboard_EpIN_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 {
 	switch (event) {
 	case USB_EVT_IN:
 		g_keyBoard.tx_busy = 0;
+#ifdef KEYBOARD_NKRO
+		/* A change seen while the last report was in flight goes out now */
+		if (g_keyBoard.pending) {
+			Keyboard_SendScan();
+		}
+#endif
 		break;
 	}
 	return LPC_OK;
@@ -190,6 +252,12 @@ ErrorCode_t Keyboard_init(USBD_HANDLE_T hUsb,
 	hid_param.HID_GetReport = Keyboard_GetReport;
 	hid_param.HID_SetReport = Keyboard_SetReport;
 	hid_param.HID_EpIn_Hdlr  = Keyboard_EpIN_Hdlr;
+#ifdef KEYBOARD_NKRO
+	hid_param.HID_SetProtocol = Keyboard_SetProtocol;
+	g_keyBoard.protocol = KEYBOARD_PROTOCOL_REPORT;
+	g_keyBoard.report_len = 0;
+	g_keyBoard.pending = 0;
+#endif
 	/* Init reports_data */
 	reports_data[0].len = Keyboard_ReportDescSize;
 	reports_data[0].idle_time = 0;
@@ -210,13 +278,14 @@ ErrorCode_t Keyboard_init(USBD_HANDLE_T hUsb,
 /* Keyboard tasks */
 void Keyboard_Tasks(void)
 {
+#ifndef KEYBOARD_NKRO
 	/* check device is configured before sending report. */
 	if ( USB_IsConfigured(g_keyBoard.hUsb)) {
 		/* send report data */
 		if (g_keyBoard.tx_busy == 0) {
 			g_keyBoard.tx_busy = 1;
 			/* update report based on board state */
-			Keyboard_UpdateReport();
+			Keyboard_UpdateReport(&g_keyBoard.report[0]);
 			USBD_API->hw->WriteEP(g_keyBoard.hUsb, HID_EP_IN, &g_keyBoard.report[0], KEYBOARD_REPORT_SIZE);
 		}
 	}
@@ -224,5 +293,36 @@ void Keyboard_Tasks(void)
 		/* reset busy flag if we get disconnected. */
 		g_keyBoard.tx_busy = 0;
 	}
+#endif
+}
+
+#ifdef KEYBOARD_NKRO
+/* Keyboard scan, queues a changed report on the IN endpoint */
+void Keyboard_Scan(void)
+{
+	if (!USB_IsConfigured(g_keyBoard.hUsb)) {
+		/* Hosts start in report protocol after a reset */
+		g_keyBoard.tx_busy = 0;
+		g_keyBoard.pending = 0;
+		g_keyBoard.report_len = 0;
+		g_keyBoard.protocol = KEYBOARD_PROTOCOL_REPORT;
+		return;
+	}
+
+	g_keyBoard.scan_len = Keyboard_UpdateReport(g_keyBoard.scan);
+	if ((g_keyBoard.scan_len == g_keyBoard.report_len) &&
+		(memcmp(g_keyBoard.scan, g_keyBoard.report, g_keyBoard.scan_len) == 0)) {
+		g_keyBoard.pending = 0;
+		return;
+	}
 
+	/* Straight into the IN queue, or as soon as the endpoint frees up */
+	if (g_keyBoard.tx_busy) {
+		g_keyBoard.pending = 1;
+	}
+	else {
+		Keyboard_SendScan();
+	}
 }
+
+#endif
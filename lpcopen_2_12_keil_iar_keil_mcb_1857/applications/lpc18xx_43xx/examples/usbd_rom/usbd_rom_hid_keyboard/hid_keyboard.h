@@ -48,6 +48,22 @@ extern "C"
 #define HID_KEYBOARD_CLEAR_REPORT(x)                memset(x, 0, 8);
 #define HID_KEYBOARD_REPORT_SET_KEY_PRESS(x, val)   x[2] = (uint8_t) val;
 
+/* NKRO report: modifier bits followed by one bit per usage 0 to 119 */
+#define KEYBOARD_NKRO_REPORT_SIZE                   16
+#define KEYBOARD_NKRO_MAX_USAGE                     119
+#define HID_KEYBOARD_NKRO_SET_KEY_PRESS(x, val)     x[1 + ((val) >> 3)] |= (uint8_t) (1 << ((val) & 7));
+
+/* Interrupt IN endpoint size and intervals */
+#ifdef KEYBOARD_NKRO
+#define KEYBOARD_EP_MAXP                            KEYBOARD_NKRO_REPORT_SIZE
+#define KEYBOARD_HS_INTERVAL                        0x01	/* 125 us */
+#define KEYBOARD_FS_INTERVAL                        0x01	/* 1 ms */
+#else
+#define KEYBOARD_EP_MAXP                            KEYBOARD_REPORT_SIZE
+#define KEYBOARD_HS_INTERVAL                        0x08
+#define KEYBOARD_FS_INTERVAL                        0x0A
+#endif
+
 /**
  * @brief	HID keyboard interface init routine.
  * @param	hUsb		: Handle to USB device stack
@@ -68,6 +84,15 @@ extern ErrorCode_t Keyboard_init(USBD_HANDLE_T hUsb,
  */
 extern void Keyboard_Tasks(void);
 
+/**
+ * @brief	Keyboard scan, queues a changed report on the IN endpoint
+ * @return	Nothing
+ * @note	Used with KEYBOARD_NKRO, called from SysTick_Handler() at
+ *			KEYBOARD_SCAN_HZ. SysTick and the USB interrupt must have
+ *			the same priority, so neither preempts the other.
+ */
+extern void Keyboard_Scan(void);
+
 /**
  * @}
  */
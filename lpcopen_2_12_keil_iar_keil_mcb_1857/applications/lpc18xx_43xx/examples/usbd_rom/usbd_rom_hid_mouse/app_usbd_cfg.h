@@ -79,6 +79,17 @@ extern "C"
 #define HID_EP_IN       0x81
 #define HID_EP_OUT      0x01
 
+/* Uncomment below to integrate motion between host polls: motion samples
+   from the sensor or QEI are added with Mouse_AddMotion() into an
+   accumulator saturating at MOUSE_ACCUM_LIMIT counts, and exactly one
+   report is queued per host poll, carrying as much of it as fits in a
+   report. The interrupt endpoint is polled every 1 ms (FS) or 125 us (HS,
+   8 kHz). The example samples the joystick from SysTick at MOUSE_SAMPLE_HZ
+   as the motion source. */
+/* #define MOUSE_ACCUM */
+#define MOUSE_ACCUM_LIMIT 32767
+#define MOUSE_SAMPLE_HZ   1000
+
 /* On LPC18xx/43xx the USB controller requires endpoint queue heads to start on
    a 4KB aligned memory. Hence the mem_base value passed to USB stack init should
    be 4KB aligned. The following manifest constants are used to define this memory.
@@ -93,15 +104,6 @@ extern uint8_t USB_FsConfigDescriptor[];
 extern const uint8_t USB_StringDescriptor[];
 extern const uint8_t USB_DeviceQualifier[];
 
-/**
- * @brief	Find the address of interface descriptor for given class type.
- * @param	pDesc		: Pointer to configuration descriptor in which the desired class
- *			interface descriptor to be found.
- * @param	intfClass	: Interface class type to be searched.
- * @return	If found returns the address of requested interface else returns NULL.
- */
-extern USB_INTERFACE_DESCRIPTOR *find_IntfDesc(const uint8_t *pDesc, uint32_t intfClass);
-
 /**
  * @}
  */
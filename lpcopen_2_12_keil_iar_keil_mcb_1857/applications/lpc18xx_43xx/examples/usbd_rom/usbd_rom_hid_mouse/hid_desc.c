@@ -30,6 +30,7 @@
  */
 
 #include "app_usbd_cfg.h"
+#include "hid_mouse.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -149,7 +150,7 @@ ALIGNED(4) uint8_t USB_HsConfigDescriptor[] = {
 	HID_EP_IN,						/* bEndpointAddress */
 	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */
 	WBVAL(0x0008),					/* wMaxPacketSize */
-	0x08,							/* bInterval : 16ms */
+	MOUSE_HS_INTERVAL,				/* bInterval */
 	/* Terminator */
 	0								/* bLength */
 };
@@ -199,7 +200,7 @@ ALIGNED(4) uint8_t USB_FsConfigDescriptor[] = {
 	HID_EP_IN,						/* bEndpointAddress */
 	USB_ENDPOINT_TYPE_INTERRUPT,	/* bmAttributes */
 	WBVAL(0x0008),					/* wMaxPacketSize */
-	0x0A,							/* bInterval: 10ms */
+	MOUSE_FS_INTERVAL,				/* bInterval */
 	/* Terminator */
 	0								/* bLength */
 };
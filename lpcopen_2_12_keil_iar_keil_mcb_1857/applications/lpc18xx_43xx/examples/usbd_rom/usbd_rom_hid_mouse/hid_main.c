@@ -33,6 +33,8 @@
 #include <stdio.h>
 #include <string.h>
 #include "app_usbd_cfg.h"
+#include "usbd_ep0patch.h"
+#include "usbd_descidx.h"
 #include "hid_mouse.h"
 
 /*****************************************************************************
@@ -41,8 +43,10 @@
 static USBD_HANDLE_T g_hUsb;
 
 /* Endpoint 0 patch that prevents nested NAK event processing */
-static uint32_t g_ep0RxBusy = 0;/* flag indicating whether EP0 OUT/RX buffer is busy. */
-static USB_EP_HANDLER_T g_Ep0BaseHdlr;	/* variable to store the pointer to base EP0 handler */
+static USBEP0PATCH_T g_ep0Patch;
+
+/* Configuration descriptor index, built once after stack init */
+static USBDESCIDX_T g_descIdx;
 
 /*****************************************************************************
  * Public types/enumerations/variables
@@ -53,30 +57,6 @@ const USBD_API_T *g_pUsbApi;
  * Private functions
  ****************************************************************************/
 
-/* EP0_patch part of WORKAROUND for artf45032. */
-ErrorCode_t EP0_patch(USBD_HANDLE_T hUsb, void *data, uint32_t event)
-{
-	switch (event) {
-	case USB_EVT_OUT_NAK:
-		if (g_ep0RxBusy) {
-			/* we already queued the buffer so ignore this NAK event. */
-			return LPC_OK;
-		}
-		else {
-			/* Mark EP0_RX buffer as busy and allow base handler to queue the buffer. */
-			g_ep0RxBusy = 1;
-		}
-		break;
-
-	case USB_EVT_SETUP:	/* reset the flag when new setup sequence starts */
-	case USB_EVT_OUT:
-		/* we received the packet so clear the flag. */
-		g_ep0RxBusy = 0;
-		break;
-	}
-	return g_Ep0BaseHdlr(hUsb, data, event);
-}
-
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -85,39 +65,50 @@ ErrorCode_t EP0_patch(USBD_HANDLE_T hUsb, void *data, uint32_t event)
  * @brief	Handle interrupt from USB0
  * @return	Nothing
  */
-void USB_IRQHandler(void)
+HOTFUNC void USB_IRQHandler(void)
 {
 	USBD_API->hw->ISR(g_hUsb);
 }
 
-/* Find the address of interface descriptor for given class type. */
-USB_INTERFACE_DESCRIPTOR *find_IntfDesc(const uint8_t *pDesc, uint32_t intfClass)
+#ifdef MOUSE_ACCUM
+/**
+ * @brief	Handle interrupt from SysTick timer, samples the joystick as motion source
+ * @return	Nothing
+ */
+void SysTick_Handler(void)
 {
-	USB_COMMON_DESCRIPTOR *pD;
-	USB_INTERFACE_DESCRIPTOR *pIntfDesc = 0;
-	uint32_t next_desc_adr;
-
-	pD = (USB_COMMON_DESCRIPTOR *) pDesc;
-	next_desc_adr = (uint32_t) pDesc;
-
-	while (pD->bLength) {
-		/* is it interface descriptor */
-		if (pD->bDescriptorType == USB_INTERFACE_DESCRIPTOR_TYPE) {
-
-			pIntfDesc = (USB_INTERFACE_DESCRIPTOR *) pD;
-			/* did we find the right interface descriptor */
-			if (pIntfDesc->bInterfaceClass == intfClass) {
-				break;
-			}
-		}
-		pIntfDesc = 0;
-		next_desc_adr = (uint32_t) pD + pD->bLength;
-		pD = (USB_COMMON_DESCRIPTOR *) next_desc_adr;
-	}
+	int32_t dx = 0, dy = 0;
+	uint8_t buttons = 0;
 
-	return pIntfDesc;
+	switch (Joystick_GetStatus()) {
+	case JOY_PRESS:
+		buttons |= 0x01;
+		break;
+
+	case JOY_LEFT:
+		dx = -1;
+		break;
+
+	case JOY_RIGHT:
+		dx = 1;
+		break;
+
+	case JOY_UP:
+		dy = -1;
+		break;
+
+	case JOY_DOWN:
+		dy = 1;
+		break;
+	}
+	if (Buttons_GetStatus() != NO_BUTTON_PRESSED) {
+		buttons |= 0x02;
+	}
+	Mouse_AddMotion(dx, dy, buttons);
 }
 
+#endif
+
 /**
  * @brief	main routine for USB mouse example
  * @return	Function should not exit.
@@ -127,7 +118,6 @@ int main(void)
 	USBD_API_INIT_PARAM_T usb_param;
 	USB_CORE_DESCS_T desc;
 	ErrorCode_t ret = LPC_OK;
-	USB_CORE_CTRL_T *pCtrl;
 
 	/* Initialize board and chip */
 	SystemCoreClockUpdate();
@@ -168,21 +158,21 @@ int main(void)
 	ret = USBD_API->hw->Init(&g_hUsb, &desc, &usb_param);
 	if (ret == LPC_OK) {
 
-		/*	WORKAROUND for artf45032 ROM driver BUG:
-		    Due to a race condition there is the chance that a second NAK event will
-		    occur before the default endpoint0 handler has completed its preparation
-		    of the DMA engine for the first NAK event. This can cause certain fields
-		    in the DMA descriptors to be in an invalid state when the USB controller
-		    reads them, thereby causing a hang.
-		 */
-		pCtrl = (USB_CORE_CTRL_T *) g_hUsb;	/* convert the handle to control structure */
-		g_Ep0BaseHdlr = pCtrl->ep_event_hdlr[0];/* retrieve the default EP0_OUT handler */
-		pCtrl->ep_event_hdlr[0] = EP0_patch;/* set our patch routine as EP0_OUT handler */
+		/* WORKAROUND for artf45032 ROM driver BUG, see usbd_ep0patch.h */
+		UsbEp0Patch_Install(&g_ep0Patch, g_hUsb);
+
+		/* index the configuration descriptors once for the class init code */
+		UsbDescIdx_Build(&g_descIdx, g_hUsb, &desc);
 
 		ret = Mouse_Init(g_hUsb,
-						 (USB_INTERFACE_DESCRIPTOR *) &USB_HsConfigDescriptor[sizeof(USB_CONFIGURATION_DESCRIPTOR)],
+						 UsbDescIdx_FindIntf(g_hUsb, USB_HIGH_SPEED, USB_DEVICE_CLASS_HUMAN_INTERFACE),
 						 &usb_param.mem_base, &usb_param.mem_size);
 		if (ret == LPC_OK) {
+#ifdef MOUSE_ACCUM
+			/* Sample at the USB priority, so sampling and the IN handler never nest */
+			SysTick_Config(SystemCoreClock / MOUSE_SAMPLE_HZ);
+			NVIC_SetPriority(SysTick_IRQn, NVIC_GetPriority(LPC_USB_IRQ));
+#endif
 			/*  enable USB interrrupts */
 			NVIC_EnableIRQ(LPC_USB_IRQ);
 			/* now connect */
@@ -46,6 +46,12 @@ typedef struct {
 	USBD_HANDLE_T hUsb;	/*!< Handle to USB stack. */
 	uint8_t report[MOUSE_REPORT_SIZE];	/*!< Last report data  */
 	uint8_t tx_busy;	/*!< Flag indicating whether a report is pending in endpoint queue. */
+#ifdef MOUSE_ACCUM
+	int32_t acc_x;		/*!< Horizontal motion not reported yet */
+	int32_t acc_y;		/*!< Vertical motion not reported yet */
+	uint8_t buttons;	/*!< Current button state */
+	uint8_t sent_buttons;	/*!< Button state of the last queued report */
+#endif
 } Mouse_Ctrl_T;
 
 /** Singleton instance of mouse control */
@@ -122,14 +128,55 @@ static void Mouse_UpdateReport(void)
 	}
 }
 
+#ifdef MOUSE_ACCUM
+/* Saturate a value to +/- limit */
+static int32_t Mouse_Clamp(int32_t val, int32_t limit)
+{
+	if (val > limit) {
+		return limit;
+	}
+	if (val < -limit) {
+		return -limit;
+	}
+	return val;
+}
+
+/* Queue one report with as much accumulated motion as fits, the rest stays for the next poll */
+static void Mouse_SendAccum(void)
+{
+	int32_t dx = Mouse_Clamp(g_mouse.acc_x, 127);
+	int32_t dy = Mouse_Clamp(g_mouse.acc_y, 127);
+
+	/* Nothing new, the endpoint NAKs the host polls until there is */
+	if ((dx == 0) && (dy == 0) && (g_mouse.buttons == g_mouse.sent_buttons)) {
+		return;
+	}
+	g_mouse.acc_x -= dx;
+	g_mouse.acc_y -= dy;
+	g_mouse.sent_buttons = g_mouse.buttons;
+
+	g_mouse.report[0] = g_mouse.buttons;
+	setXYMouseReport(g_mouse.report, (int8_t) dx, (int8_t) dy);
+	g_mouse.tx_busy = 1;
+	USBD_API->hw->WriteEP(g_mouse.hUsb, HID_EP_IN, &g_mouse.report[0], MOUSE_REPORT_SIZE);
+}
+
+#endif
+
 /* HID Get Report Request Callback. Called automatically on HID Get Report Request */
 static ErrorCode_t Mouse_GetReport(USBD_HANDLE_T hHid, USB_SETUP_PACKET *pSetup, uint8_t * *pBuffer, uint16_t *plength)
 {
 	/* ReportID = SetupPacket.wValue.WB.L; */
 	switch (pSetup->wValue.WB.H) {
 	case HID_REPORT_INPUT:
+#ifdef MOUSE_ACCUM
+		/* The interrupt pipe owns the motion, only the buttons are returned here */
+		CLEAR_HID_MOUSE_REPORT(*pBuffer);
+		(*pBuffer)[0] = g_mouse.buttons;
+#else
 		Mouse_UpdateReport();
 		*pBuffer = &g_mouse.report[0];
+#endif
 		*plength = MOUSE_REPORT_SIZE;
 		break;
 
@@ -166,6 +213,10 @@ static ErrorCode_t Mouse_EpIN_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t even
 		    busy flag for main loop to queue next packet.
 		 */
 		g_mouse.tx_busy = 0;
+#ifdef MOUSE_ACCUM
+		/* The host took one report, the next one waits for its next poll */
+		Mouse_SendAccum();
+#endif
 		break;
 	}
 	return LPC_OK;
@@ -218,6 +269,10 @@ ErrorCode_t Mouse_Init(USBD_HANDLE_T hUsb,
 	/* store stack handle for later use. */
 	g_mouse.hUsb = hUsb;
 	g_mouse.tx_busy = 0;
+#ifdef MOUSE_ACCUM
+	g_mouse.acc_x = g_mouse.acc_y = 0;
+	g_mouse.buttons = g_mouse.sent_buttons = 0;
+#endif
 
 	return ret;
 }
@@ -225,6 +280,7 @@ ErrorCode_t Mouse_Init(USBD_HANDLE_T hUsb,
 /* Mouse tasks */
 void Mouse_Tasks(void)
 {
+#ifndef MOUSE_ACCUM
 	/* check device is configured before sending report. */
 	if ( USB_IsConfigured(g_mouse.hUsb)) {
 		if (g_mouse.tx_busy == 0) {
@@ -239,5 +295,29 @@ void Mouse_Tasks(void)
 		/* reset busy flag if we get disconnected. */
 		g_mouse.tx_busy = 0;
 	}
+#endif
+}
+
+#ifdef MOUSE_ACCUM
+/* Add a motion sample to the accumulator */
+void Mouse_AddMotion(int32_t dx, int32_t dy, uint8_t buttons)
+{
+	if (!USB_IsConfigured(g_mouse.hUsb)) {
+		/* Motion while disconnected is dropped */
+		g_mouse.tx_busy = 0;
+		g_mouse.acc_x = g_mouse.acc_y = 0;
+		g_mouse.sent_buttons = g_mouse.buttons = buttons;
+		return;
+	}
+
+	/* Saturate, a host that stops polling must not wrap the counts */
+	g_mouse.acc_x = Mouse_Clamp(g_mouse.acc_x + Mouse_Clamp(dx, MOUSE_ACCUM_LIMIT), MOUSE_ACCUM_LIMIT);
+	g_mouse.acc_y = Mouse_Clamp(g_mouse.acc_y + Mouse_Clamp(dy, MOUSE_ACCUM_LIMIT), MOUSE_ACCUM_LIMIT);
+	g_mouse.buttons = buttons;
 
+	if (g_mouse.tx_busy == 0) {
+		Mouse_SendAccum();
+	}
 }
+
+#endif
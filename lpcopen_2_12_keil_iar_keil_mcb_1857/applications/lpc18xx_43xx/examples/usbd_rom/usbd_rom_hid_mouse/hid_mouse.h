@@ -46,6 +46,15 @@ extern "C"
 #define MOUSE_REPORT_SIZE        3
 #define CLEAR_HID_MOUSE_REPORT(x)   memset(x, 0, MOUSE_REPORT_SIZE);
 
+/* Interrupt IN endpoint intervals */
+#ifdef MOUSE_ACCUM
+#define MOUSE_HS_INTERVAL        0x01	/* 125 us */
+#define MOUSE_FS_INTERVAL        0x01	/* 1 ms */
+#else
+#define MOUSE_HS_INTERVAL        0x08	/* 16 ms */
+#define MOUSE_FS_INTERVAL        0x0A	/* 10 ms */
+#endif
+
 /**
  * @brief	HID mouse interface init routine.
  * @param	hUsb		: Handle to USB device stack
@@ -66,6 +75,18 @@ extern ErrorCode_t Mouse_Init(USBD_HANDLE_T hUsb,
  */
 extern void Mouse_Tasks(void);
 
+/**
+ * @brief	Add a motion sample to the accumulator
+ * @param	dx		: Horizontal motion in counts
+ * @param	dy		: Vertical motion in counts
+ * @param	buttons	: Button state, bit 0 left, bit 1 right, bit 2 middle
+ * @return	Nothing
+ * @note	Used with MOUSE_ACCUM. Call from an interrupt at the USB interrupt
+ *			priority, so the accumulator is never updated from two places at
+ *			once. With the IN endpoint idle the report is queued at once.
+ */
+extern void Mouse_AddMotion(int32_t dx, int32_t dy, uint8_t buttons);
+
 /**
  * @}
  */
@@ -35,6 +35,7 @@
 #include "usbd_rom_api.h"
 #include "hid_sio.h"
 #include "lpcusbsio_i2c.h"
+#include "stopwatch.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -80,6 +81,16 @@ typedef struct __HID_SIO_CTRL_T {
 	uint8_t epout_adr;		/*!< Interrupt OUT endpoint associated with this HID instance. */
 	uint16_t pad0;
 
+	I2CM_XFER_T xfer;		/*!< Request transfer run from the I2C interrupt */
+	I2CM_XFER_T *pXfer;		/*!< Transfer in progress */
+	HID_I2C_IN_REPORT_T *xferIn;	/*!< Response posted on completion, NULL for script transfers */
+	uint16_t xferTxLen;		/*!< Transmit size reported back in the response, 0 if not reported */
+	uint16_t xferRxLen;		/*!< Receive size of the transfer in progress */
+	volatile uint8_t xferBusy;	/*!< Flag indicating an I2C transfer is in progress */
+	uint8_t xferPort;		/*!< I2C port of the transfer in progress */
+	uint8_t xferAsync;		/*!< Flag indicating the current request is answered on completion */
+	uint8_t pad1;
+
 	uint8_t reqQ[HID_I2C_MAX_PACKETS][HID_I2C_PACKET_SZ];		/*!< Requests queue */
 	uint8_t respQ[HID_I2C_MAX_PACKETS][HID_I2C_PACKET_SZ];	/*!< Response queue */
 } HID_SIO_CTRL_T;
@@ -89,6 +100,10 @@ typedef struct __HID_SIO_CTRL_T {
 #define HID_SIO_MINOR_VER			0
 static const char *g_fwVersion = "(" __DATE__ " " __TIME__ ")";
 
+/* Bridge instance serviced by the I2C interrupt handlers */
+static HID_SIO_CTRL_T *g_pHidSio;
+static const IRQn_Type g_i2cIrq[2] = {I2C0_IRQn, I2C1_IRQn};
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -104,6 +119,8 @@ static void InitI2CPorts(HID_SIO_CTRL_T *pHidI2c)
 {
 	Chip_SCU_I2C0PinConfig(I2C0_FAST_MODE_PLUS);
 	NVIC_DisableIRQ(I2C0_IRQn);
+	/* Same priority as USB so completions and EP handlers never nest */
+	NVIC_SetPriority(I2C0_IRQn, NVIC_GetPriority(LPC_USB_IRQ));
 	pHidI2c->pI2C[0] = LPC_I2C0;
 
 #if (HID_SIO_I2C_PORTS == 2)	
@@ -111,6 +128,7 @@ static void InitI2CPorts(HID_SIO_CTRL_T *pHidI2c)
 	Chip_SCU_PinMuxSet(0xE, 13, (SCU_MODE_ZIF_DIS | SCU_MODE_INBUFF_EN | SCU_MODE_FUNC2));
 	Chip_SCU_PinMuxSet(0xE, 15, (SCU_MODE_ZIF_DIS | SCU_MODE_INBUFF_EN | SCU_MODE_FUNC2));
 	NVIC_DisableIRQ(I2C1_IRQn);
+	NVIC_SetPriority(I2C1_IRQn, NVIC_GetPriority(LPC_USB_IRQ));
 	/* bind to I2C port */
 	pHidI2c->pI2C[1] = LPC_I2C1;
 #endif
@@ -129,6 +147,21 @@ static INLINE void HID_I2C_IncIndex(uint8_t *index)
 	*index = (*index + 1) & (HID_I2C_MAX_PACKETS - 1);
 }
 
+/* Kick-start response tx if it is idling and we have something to send. Must
+   be called with the USB and I2C interrupts unable to preempt the caller. */
+static void HID_SIO_KickResponse(HID_SIO_CTRL_T *pHidI2c)
+{
+	if ((pHidI2c->respIdle) && (pHidI2c->respRdIndx != pHidI2c->respWrIndx)) {
+
+		pHidI2c->respIdle = 0;
+		USBD_API->hw->WriteEP(pHidI2c->hUsb,
+							  pHidI2c->epin_adr,
+							  &pHidI2c->respQ[pHidI2c->respRdIndx][0],
+							  HID_I2C_PACKET_SZ);
+		HID_I2C_IncIndex(&pHidI2c->respRdIndx);
+	}
+}
+
 /*  HID get report callback function. */
 static ErrorCode_t HID_I2C_GetReport(USBD_HANDLE_T hHid, USB_SETUP_PACKET *pSetup,
 									 uint8_t * *pBuffer, uint16_t *plength)
@@ -196,6 +229,81 @@ static uint32_t HID_I2C_StatusCheckLoop(HID_SIO_CTRL_T *pHidI2c, uint8_t port)
 	return pHidI2c->resetReq;
 }
 
+/* Transfer finished or aborted, post the response if one is attached. Runs
+   from the I2C interrupt, which has the same priority as the USB interrupt,
+   or from HID_SIO_process() with both masked. */
+static void HID_I2C_XferDone(HID_SIO_CTRL_T *pHidI2c)
+{
+	HID_I2C_IN_REPORT_T *pIn = pHidI2c->xferIn;
+	I2CM_XFER_T *xfer = pHidI2c->pXfer;
+
+	NVIC_DisableIRQ(g_i2cIrq[pHidI2c->xferPort]);
+	pHidI2c->xferBusy = 0;
+
+	if (pIn != NULL) {
+		pHidI2c->xferIn = NULL;
+
+		/* Update the length we have to send back */
+		pIn->length += pHidI2c->xferRxLen - xfer->rxSz;
+		if (pHidI2c->xferTxLen > 0) {
+			pIn->length += pHidI2c->xferTxLen - xfer->txSz;
+		}
+		/* update response with the I2CM status returned. No translation
+		   needed as they map directly to base LPCUSBSIO status. */
+		pIn->resp = xfer->status;
+
+		/* request is done, queue its response */
+		HID_I2C_IncIndex(&pHidI2c->reqRdIndx);
+		HID_I2C_IncIndex(&pHidI2c->respWrIndx);
+		HID_SIO_KickResponse(pHidI2c);
+	}
+}
+
+/* Start an I2C master transfer serviced by the I2C interrupt. With a
+   response attached the request completes from the interrupt. */
+static void HID_I2C_XferStart(HID_SIO_CTRL_T *pHidI2c, uint8_t port, I2CM_XFER_T *xfer,
+							  HID_I2C_IN_REPORT_T *pIn, uint16_t txLen, uint16_t rxLen)
+{
+	pHidI2c->pXfer = xfer;
+	pHidI2c->xferIn = pIn;
+	pHidI2c->xferTxLen = txLen;
+	pHidI2c->xferRxLen = rxLen;
+	pHidI2c->xferPort = port;
+	pHidI2c->xferAsync = (pIn != NULL);
+	pHidI2c->xferBusy = 1;
+
+	/* start transfer, the start condition raises the first interrupt */
+	Chip_I2CM_Xfer(pHidI2c->pI2C[port], xfer);
+	NVIC_EnableIRQ(g_i2cIrq[port]);
+}
+
+/* Abort the transfer in progress on a host reset request */
+static void HID_I2C_XferAbort(HID_SIO_CTRL_T *pHidI2c)
+{
+	NVIC_DisableIRQ(LPC_USB_IRQ); /* enter critical section */
+	NVIC_DisableIRQ(g_i2cIrq[pHidI2c->xferPort]);
+	if (pHidI2c->xferBusy) {
+		pHidI2c->pXfer->status = HID_I2C_RES_ERROR;
+		HID_I2C_XferDone(pHidI2c);
+	}
+	NVIC_EnableIRQ(LPC_USB_IRQ); /* exit critical section */
+}
+
+/* Run an I2C master transfer to completion, returns the transfer status */
+static uint32_t HID_I2C_Xfer(HID_SIO_CTRL_T *pHidI2c, uint8_t port, I2CM_XFER_T *xfer)
+{
+	HID_I2C_XferStart(pHidI2c, port, xfer, NULL, 0, 0);
+
+	/* only the main loop waits here, USB is serviced meanwhile */
+	while (pHidI2c->xferBusy) {
+		if (pHidI2c->resetReq) {
+			HID_I2C_XferAbort(pHidI2c);
+		}
+	}
+
+	return xfer->status;
+}
+
 static int32_t HID_I2C_HandleReadStates(HID_SIO_CTRL_T *pHidI2c,
 										HID_I2C_OUT_REPORT_T *pOut,
 										HID_I2C_IN_REPORT_T *pIn,
@@ -281,9 +389,37 @@ static void HID_I2C_HandleRWReq(HID_SIO_CTRL_T *pHidI2c,
 								int32_t read)
 {
 	HID_I2C_RW_PARAMS_T *pRWParam = (HID_I2C_RW_PARAMS_T *) &pOut->data[0];
+	I2CM_XFER_T *xfer = &pHidI2c->xfer;
 	int32_t handled = 0;
 	uint32_t status;
 
+	/* A complete addressed transaction runs on the interrupt driven transfer
+	   engine. Partial transactions keep the bus across requests and are
+	   polled below. */
+	if ((pRWParam->options & (HID_I2C_TRANSFER_OPTIONS_START_BIT | HID_I2C_TRANSFER_OPTIONS_STOP_BIT |
+							  HID_I2C_TRANSFER_OPTIONS_NO_ADDRESS)) ==
+		(HID_I2C_TRANSFER_OPTIONS_START_BIT | HID_I2C_TRANSFER_OPTIONS_STOP_BIT)) {
+		memset(xfer, 0, sizeof(I2CM_XFER_T));
+		xfer->slaveAddr = pRWParam->slaveAddr;
+		if (read) {
+			if ((pRWParam->options & HID_I2C_TRANSFER_OPTIONS_NACK_LAST_BYTE) == 0) {
+				xfer->options = I2CM_XFER_OPTION_LAST_RX_ACK;
+			}
+			xfer->rxBuff = &pIn->data[0];
+			xfer->rxSz = pRWParam->length;
+			HID_I2C_XferStart(pHidI2c, pOut->sesId, xfer, pIn, 0, pRWParam->length);
+		}
+		else {
+			if ((pRWParam->options & HID_I2C_TRANSFER_OPTIONS_BREAK_ON_NACK) == 0) {
+				xfer->options = I2CM_XFER_OPTION_IGNORE_NACK;
+			}
+			xfer->txBuff = &pRWParam->data[0];
+			xfer->txSz = pRWParam->length;
+			HID_I2C_XferStart(pHidI2c, pOut->sesId, xfer, pIn, pRWParam->length, 0);
+		}
+		return;
+	}
+
 	/* clear state change interrupt status */
 	Chip_I2CM_ClearSI(pHidI2c->pI2C[pOut->sesId]);
 
@@ -352,39 +488,219 @@ static void HID_I2C_HandleXferReq(HID_SIO_CTRL_T *pHidI2c,
 								  HID_I2C_IN_REPORT_T *pIn)
 {
 	HID_I2C_XFER_PARAMS_T *pXfrParam = (HID_I2C_XFER_PARAMS_T *) &pOut->data[0];
+	I2CM_XFER_T *xfer = &pHidI2c->xfer;
+
+	memset(xfer, 0, sizeof(I2CM_XFER_T));
+	xfer->slaveAddr = pXfrParam->slaveAddr;
+	xfer->txBuff = &pXfrParam->data[0];
+	xfer->rxBuff = &pIn->data[0];
+	xfer->rxSz = pXfrParam->rxLength;
+	xfer->txSz = pXfrParam->txLength;
+	xfer->options = pXfrParam->options;
+
+	/* The response is posted from the I2C interrupt on completion */
+	HID_I2C_XferStart(pHidI2c, pOut->sesId, xfer, pIn, 0, pXfrParam->rxLength);
+}
+
+static INLINE uint32_t HID_SIO_Get32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/* Size of a script op including its parameters, 0 if it is malformed */
+static uint32_t HID_SIO_ScriptOpLen(const uint8_t *op, uint32_t avail)
+{
+	uint32_t len;
+
+	switch (op[0]) {
+	case HID_SIO_SCRIPT_I2C_XFER:
+		len = (avail >= 6) ? (6 + op[4]) : 0;
+		break;
+
+	case HID_SIO_SCRIPT_SPI_XFER:
+		len = (avail >= 3) ? (3 + op[2]) : 0;
+		break;
+
+	case HID_SIO_SCRIPT_GPIO_SET:
+		len = 10;
+		break;
+
+	case HID_SIO_SCRIPT_GPIO_GET:
+		len = 2;
+		break;
+
+	case HID_SIO_SCRIPT_DELAY_US:
+		len = 3;
+		break;
+
+	case HID_SIO_SCRIPT_SKIP_NE:
+		len = 4;
+		break;
+
+	case HID_SIO_SCRIPT_I2C_POLL:
+		len = 7;
+		break;
+
+	default:
+		len = 0;
+		break;
+	}
+
+	return (len <= avail) ? len : 0;
+}
+
+/* Run a single script op. Read data is appended at *pRx, the last byte
+   read is kept in *pLast for conditional ops. */
+static uint32_t HID_SIO_RunScriptOp(HID_SIO_CTRL_T *pHidI2c, uint8_t *op,
+									uint8_t **pRx, uint8_t *rxEnd,
+									uint8_t *pLast, uint32_t *pSkip)
+{
 	I2CM_XFER_T xfer;
-	uint32_t ret = 0;
+	Chip_SSP_DATA_SETUP_T sspXfer;
+	uint32_t rxLen, value, tries;
+
+	switch (op[0]) {
+	case HID_SIO_SCRIPT_I2C_XFER:
+		rxLen = op[5];
+		if ((op[1] >= HID_SIO_I2C_PORTS) || ((*pRx + rxLen) > rxEnd)) {
+			return HID_I2C_RES_ERROR;
+		}
+		memset(&xfer, 0, sizeof(I2CM_XFER_T));
+		xfer.slaveAddr = op[2];
+		xfer.options = op[3];
+		xfer.txBuff = &op[6];
+		xfer.txSz = op[4];
+		xfer.rxBuff = *pRx;
+		xfer.rxSz = rxLen;
+		HID_I2C_Xfer(pHidI2c, op[1], &xfer);
+
+		rxLen -= xfer.rxSz;
+		if (rxLen > 0) {
+			*pLast = (*pRx)[rxLen - 1];
+			*pRx += rxLen;
+		}
+		return xfer.status;
 
-	memset(&xfer, 0, sizeof(I2CM_XFER_T));
-	xfer.slaveAddr = pXfrParam->slaveAddr;
-	xfer.txBuff = &pXfrParam->data[0];
-	xfer.rxBuff = &pIn->data[0];
-	xfer.rxSz = pXfrParam->rxLength;
-	xfer.txSz = pXfrParam->txLength;
-	xfer.options = pXfrParam->options;
+	case HID_SIO_SCRIPT_SPI_XFER:
+		rxLen = op[2];
+		if ((op[1] >= HID_SIO_SPI_PORTS) || ((*pRx + rxLen) > rxEnd)) {
+			return HID_I2C_RES_ERROR;
+		}
+		sspXfer.tx_data = &op[3];
+		sspXfer.tx_cnt = 0;
+		sspXfer.rx_data = *pRx;
+		sspXfer.rx_cnt = 0;
+		sspXfer.length = rxLen;
+		if (Chip_SSP_RWFrames_Blocking(pHidI2c->pSSP[op[1]], &sspXfer) != rxLen) {
+			return HID_I2C_RES_ERROR;
+		}
+		if (rxLen > 0) {
+			*pLast = (*pRx)[rxLen - 1];
+			*pRx += rxLen;
+		}
+		break;
 
-	/* start transfer */
-	Chip_I2CM_Xfer(pHidI2c->pI2C[pOut->sesId], &xfer);
+	case HID_SIO_SCRIPT_GPIO_SET:
+		if (op[1] >= HID_SIO_GPIO_PORTS) {
+			return HID_I2C_RES_ERROR;
+		}
+		Chip_GPIO_SetValue(LPC_GPIO_PORT, op[1], HID_SIO_Get32(&op[2]));
+		Chip_GPIO_ClearValue(LPC_GPIO_PORT, op[1], HID_SIO_Get32(&op[6]));
+		break;
 
-	while (ret == 0) {
-		/* wait for status change interrupt */
-		if (HID_I2C_StatusCheckLoop(pHidI2c, pOut->sesId) == 0) {
-			/* call state change handler */
-			ret = Chip_I2CM_XferHandler(pHidI2c->pI2C[pOut->sesId], &xfer);
+	case HID_SIO_SCRIPT_GPIO_GET:
+		if ((op[1] >= HID_SIO_GPIO_PORTS) || ((*pRx + 4) > rxEnd)) {
+			return HID_I2C_RES_ERROR;
 		}
-		else {
-			xfer.status = HID_I2C_RES_ERROR;
-			break;
+		value = Chip_GPIO_GetPortValue(LPC_GPIO_PORT, op[1]);
+		(*pRx)[0] = value;
+		(*pRx)[1] = value >> 8;
+		(*pRx)[2] = value >> 16;
+		(*pRx)[3] = value >> 24;
+		*pLast = value;
+		*pRx += 4;
+		break;
+
+	case HID_SIO_SCRIPT_DELAY_US:
+		StopWatch_DelayUs(op[1] | (op[2] << 8));
+		break;
+
+	case HID_SIO_SCRIPT_SKIP_NE:
+		if ((*pLast & op[1]) != op[2]) {
+			*pSkip = op[3];
+		}
+		break;
+
+	case HID_SIO_SCRIPT_I2C_POLL:
+		if ((op[1] >= HID_SIO_I2C_PORTS) || ((*pRx + 1) > rxEnd)) {
+			return HID_I2C_RES_ERROR;
 		}
+		for (tries = 0; tries <= op[6]; tries++) {
+			if (tries > 0) {
+				StopWatch_DelayMs(1);
+			}
+			memset(&xfer, 0, sizeof(I2CM_XFER_T));
+			xfer.slaveAddr = op[2];
+			xfer.txBuff = &op[3];
+			xfer.txSz = 1;
+			xfer.rxBuff = pLast;
+			xfer.rxSz = 1;
+			if (HID_I2C_Xfer(pHidI2c, op[1], &xfer) != HID_I2C_RES_OK) {
+				return xfer.status;
+			}
+			if ((*pLast & op[4]) == op[5]) {
+				**pRx = *pLast;
+				*pRx += 1;
+				return HID_I2C_RES_OK;
+			}
+		}
+		return HID_I2C_RES_ERROR;
+	}
+
+	return HID_I2C_RES_OK;
+}
+
+/* Run a transaction script and return all read data in one response */
+static void HID_SIO_HandleScriptReq(HID_SIO_CTRL_T *pHidI2c,
+									HID_I2C_OUT_REPORT_T *pOut,
+									HID_I2C_IN_REPORT_T *pIn)
+{
+	uint8_t *op = &pOut->data[0];
+	uint8_t *opEnd = (uint8_t *) pOut + HID_I2C_PACKET_SZ;
+	uint8_t *rx = &pIn->data[1];
+	uint8_t *rxEnd = (uint8_t *) pIn + HID_I2C_PACKET_SZ;
+	uint8_t last = 0;
+	uint32_t len, skip = 0, count = 0, status = HID_I2C_RES_OK;
+
+	/* Bound the script by the report length if the host set one */
+	if ((pOut->length > HID_I2C_HEADER_SZ) && (pOut->length < HID_I2C_PACKET_SZ)) {
+		opEnd = (uint8_t *) pOut + pOut->length;
 	}
 
-	/* Update the length we have to send back */
-	if ((pXfrParam->rxLength - xfer.rxSz) > 0) {
-		pIn->length += pXfrParam->rxLength - xfer.rxSz;
+	while ((op < opEnd) && (*op != HID_SIO_SCRIPT_END)) {
+		len = HID_SIO_ScriptOpLen(op, opEnd - op);
+		if (len == 0) {
+			status = HID_I2C_RES_INVALID_CMD;
+			break;
+		}
+
+		if (skip > 0) {
+			skip--;
+		}
+		else {
+			status = HID_SIO_RunScriptOp(pHidI2c, op, &rx, rxEnd, &last, &skip);
+			if (status != HID_I2C_RES_OK) {
+				break;
+			}
+		}
+		count++;
+		op += len;
 	}
-	/* update response with the I2CM status returned. No translation
-	   needed as they map directly to base LPCUSBSIO status. */
-	pIn->resp = xfer.status;
+
+	/* Ops completed, followed by the read data */
+	pIn->data[0] = count;
+	pIn->length += 1 + (rx - &pIn->data[1]);
+	pIn->resp = status;
 }
 
 /* Handle SIO requests */
@@ -405,6 +721,10 @@ void SIO_RequestHandler(USBD_HANDLE_T hSIOHid, HID_I2C_OUT_REPORT_T *pOut, HID_I
 		/* update response */
 		pIn->resp = HID_I2C_RES_OK;
 		break;
+
+	case HID_SIO_REQ_SCRIPT:
+		HID_SIO_HandleScriptReq((HID_SIO_CTRL_T *) hSIOHid, pOut, pIn);
+		break;
 	}
 }
 
@@ -566,9 +886,13 @@ ErrorCode_t HID_SIO_init(USBD_HANDLE_T hUsb,
 		/* set response is idling. For HID_I2C_process() to kickstart transmission if response
 		   data is pending. */
 		pHidI2c->respIdle = 1;
+		g_pHidSio = pHidI2c;
 
 		/* bind to I2C port */
 		InitI2CPorts(pHidI2c);
+		/* bind to SPI port and set up the timer used for script delays */
+		InitSPIPorts(pHidI2c);
+		StopWatch_Init();
 
 		/* move to next descriptor */
 		new_addr = (uint32_t) pIntfDesc + pIntfDesc->bLength;
@@ -623,7 +947,14 @@ void HID_SIO_process(USBD_HANDLE_T hSIOHid)
 		}
 		/* set state to connected */
 		pHidI2c->state = HID_I2C_STATE_CONNECTED;
-		if (pHidI2c->reqWrIndx != pHidI2c->reqRdIndx) {
+		if (pHidI2c->xferBusy) {
+			/* Request in progress on the I2C engine, a host reset aborts it
+			   so the reset request queued behind it can run. */
+			if (pHidI2c->resetReq) {
+				HID_I2C_XferAbort(pHidI2c);
+			}
+		}
+		else if (pHidI2c->reqWrIndx != pHidI2c->reqRdIndx) {
 
 			/* process the current packet */
 			pOut = (HID_I2C_OUT_REPORT_T *) &pHidI2c->reqQ[pHidI2c->reqRdIndx][0];
@@ -655,24 +986,33 @@ void HID_SIO_process(USBD_HANDLE_T hSIOHid)
 				SIO_RequestHandler(hSIOHid, pOut, pIn);
 			}
 
-			HID_I2C_IncIndex(&pHidI2c->reqRdIndx);
-			HID_I2C_IncIndex(&pHidI2c->respWrIndx);
+			/* Requests handed to the I2C engine are completed from its interrupt */
+			if (pHidI2c->xferAsync) {
+				pHidI2c->xferAsync = 0;
+			}
+			else {
+				HID_I2C_IncIndex(&pHidI2c->reqRdIndx);
+				HID_I2C_IncIndex(&pHidI2c->respWrIndx);
+			}
 		}
 
 		/* Kick-start response tx if it is idling and we have something to send. */
-		if ((pHidI2c->respIdle) && (pHidI2c->respRdIndx != pHidI2c->respWrIndx)) {
-
-			pHidI2c->respIdle = 0;
-			USBD_API->hw->WriteEP(pHidI2c->hUsb,
-								  pHidI2c->epin_adr,
-								  &pHidI2c->respQ[pHidI2c->respRdIndx][0],
-								  HID_I2C_PACKET_SZ);
-			HID_I2C_IncIndex(&pHidI2c->respRdIndx);
+		NVIC_DisableIRQ(LPC_USB_IRQ); /* enter critical section */
+		NVIC_DisableIRQ(g_i2cIrq[pHidI2c->xferPort]);
+		HID_SIO_KickResponse(pHidI2c);
+		if (pHidI2c->xferBusy) {
+			NVIC_EnableIRQ(g_i2cIrq[pHidI2c->xferPort]);
 		}
+		NVIC_EnableIRQ(LPC_USB_IRQ); /* exit critical section */
 	}
 	else {
 		/* check if we just got dis-connected */
 		if (pHidI2c->state != HID_I2C_STATE_DISCON) {
+			/* drop a transfer in progress, there is nobody to answer */
+			NVIC_DisableIRQ(g_i2cIrq[pHidI2c->xferPort]);
+			pHidI2c->xferBusy = 0;
+			pHidI2c->xferIn = NULL;
+			pHidI2c->xferAsync = 0;
 			/* reset indexes */
 			pHidI2c->reqWrIndx = pHidI2c->reqRdIndx = 0;
 			pHidI2c->respRdIndx = pHidI2c->respWrIndx = 0;
@@ -682,3 +1022,27 @@ void HID_SIO_process(USBD_HANDLE_T hSIOHid)
 		pHidI2c->state = HID_I2C_STATE_DISCON;
 	}
 }
+
+/**
+ * @brief	I2C0 interrupt handler, runs the bridge transfer state machine
+ * @return	Nothing
+ */
+void I2C0_IRQHandler(void)
+{
+	if (Chip_I2CM_XferHandler(g_pHidSio->pI2C[0], g_pHidSio->pXfer)) {
+		HID_I2C_XferDone(g_pHidSio);
+	}
+}
+
+#if (HID_SIO_I2C_PORTS == 2)
+/**
+ * @brief	I2C1 interrupt handler, runs the bridge transfer state machine
+ * @return	Nothing
+ */
+void I2C1_IRQHandler(void)
+{
+	if (Chip_I2CM_XferHandler(g_pHidSio->pI2C[1], g_pHidSio->pXfer)) {
+		HID_I2C_XferDone(g_pHidSio);
+	}
+}
+#endif
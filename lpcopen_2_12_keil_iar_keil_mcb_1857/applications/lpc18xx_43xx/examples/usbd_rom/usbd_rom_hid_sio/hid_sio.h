@@ -44,6 +44,25 @@ extern "C"
  * @{
  */
 
+/**
+ * Scripted transaction request. The OUT report data holds a sequence of
+ * script ops which are run back to back on the device. The IN report data
+ * returns the number of ops completed followed by all data read by the ops.
+ */
+#ifndef HID_SIO_REQ_SCRIPT
+#define HID_SIO_REQ_SCRIPT          (HID_SIO_REQ_DEV_INFO + 1)
+#endif
+
+/* Script op codes, multi-byte values are little endian */
+#define HID_SIO_SCRIPT_END          0x00	/*!< End of script */
+#define HID_SIO_SCRIPT_I2C_XFER     0x01	/*!< port, addr, options, txLen, rxLen, tx data[txLen] */
+#define HID_SIO_SCRIPT_SPI_XFER     0x02	/*!< port, len, tx data[len]; rx data returned */
+#define HID_SIO_SCRIPT_GPIO_SET     0x03	/*!< port, set mask[4], clear mask[4] */
+#define HID_SIO_SCRIPT_GPIO_GET     0x04	/*!< port; port value[4] returned */
+#define HID_SIO_SCRIPT_DELAY_US     0x05	/*!< delay in uS[2] */
+#define HID_SIO_SCRIPT_SKIP_NE      0x06	/*!< mask, value, count: skip count ops if (last byte read & mask) != value */
+#define HID_SIO_SCRIPT_I2C_POLL     0x07	/*!< port, addr, reg, mask, value, tries: read reg 1mS apart until it matches */
+
 /**
  * @brief	HID_SIO interface init routine.
  * @param	hUsb		: Handle to USB device stack
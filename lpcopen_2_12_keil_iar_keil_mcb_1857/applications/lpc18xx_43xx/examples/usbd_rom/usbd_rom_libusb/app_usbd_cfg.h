@@ -79,6 +79,15 @@ extern "C"
 #define LUSB_OUT_EP                     0x01
 #define LUSB_INT_EP                     0x82
 
+/* Number of read and of send requests that can be queued on the bulk
+   endpoints at once. The next queued request is primed as soon as the
+   current one completes. Must be a power of 2. */
+#define LUSB_REQ_QUEUE_DEPTH            4
+
+#if (LUSB_REQ_QUEUE_DEPTH < 1) || (LUSB_REQ_QUEUE_DEPTH & (LUSB_REQ_QUEUE_DEPTH - 1))
+#error "libusbdev: LUSB_REQ_QUEUE_DEPTH must be a power of 2"
+#endif
+
 /* On LPC18xx/43xx the USB controller requires endpoint queue heads to start on
    a 4KB aligned memory. Hence the mem_base value passed to USB stack init should
    be 4KB aligned. The following manifest constants are used to define this memory.
@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "app_usbd_cfg.h"
+#include "usbd_ep0patch.h"
 #include "libusbdev.h"
 
 /*****************************************************************************
@@ -41,18 +42,39 @@
  ****************************************************************************/
 
 /* Endpoint 0 patch that prevents nested NAK event processing */
-static uint32_t g_ep0RxBusy = 0;/* flag indicating whether EP0 OUT/RX buffer is busy. */
-static USB_EP_HANDLER_T g_Ep0BaseHdlr;	/* variable to store the pointer to base EP0 handler */
+static USBEP0PATCH_T g_ep0Patch;
+
+#define LUSB_REQ_QUEUE_MASK     (LUSB_REQ_QUEUE_DEPTH - 1)
+
+/**
+ * Structure holding one queued bulk transfer request
+ */
+typedef struct _LUSB_REQ_ {
+	uint8_t *pBuf;			/*!< Transfer buffer */
+	uint32_t len;			/*!< Requested length, received length once done */
+	LUSB_DONE_CB_T cb;		/*!< Completion callback, 0 for polled requests */
+	void *arg;				/*!< Argument passed to the callback */
+} LUSB_REQ_T;
+
+/**
+ * Request queue of one bulk endpoint. The indexes run freely: requests
+ * [tail, prime) are done, [prime, head) pending and request prime is the
+ * one on the endpoint whenever prime != head.
+ */
+typedef struct _LUSB_REQ_QUEUE_ {
+	LUSB_REQ_T req[LUSB_REQ_QUEUE_DEPTH];
+	uint32_t head;			/*!< Next free slot */
+	uint32_t prime;			/*!< Request primed on the endpoint */
+	uint32_t tail;			/*!< Oldest request not yet released */
+} LUSB_REQ_QUEUE_T;
 
 /**
  * Structure containing Virtual Comm port control data
  */
 typedef struct _LUSB_CTRL_ {
 	USBD_HANDLE_T hUsb;
-	uint8_t *pRxBuf;
-	uint32_t rxBuffLen;
-	uint8_t *pTxBuf;
-	uint32_t txBuffLen;
+	LUSB_REQ_QUEUE_T rxQ;
+	LUSB_REQ_QUEUE_T txQ;
 	uint32_t newStatus;
 	uint32_t curStatus;
 	volatile uint8_t connected;
@@ -69,6 +91,77 @@ const USBD_API_T *g_pUsbApi;
  * Private functions
  ****************************************************************************/
 
+/* Hand the request at the prime index to the USB DMA */
+static void lusb_PrimeReq(LUSB_CTRL_T *pUSB, LUSB_REQ_QUEUE_T *pQ, uint32_t ep)
+{
+	LUSB_REQ_T *pReq = &pQ->req[pQ->prime & LUSB_REQ_QUEUE_MASK];
+
+	if (ep & 0x80) {
+		USBD_API->hw->WriteEP(pUSB->hUsb, ep, pReq->pBuf, pReq->len);
+	}
+	else {
+		USBD_API->hw->ReadReqEP(pUSB->hUsb, ep, pReq->pBuf, pReq->len);
+	}
+}
+
+/* Release done requests with a callback from the tail of the queue, their
+   slot is free again once the callback got the transfer. */
+static void lusb_ReleaseReq(LUSB_REQ_QUEUE_T *pQ)
+{
+	while ((pQ->tail != pQ->prime) && pQ->req[pQ->tail & LUSB_REQ_QUEUE_MASK].cb) {
+		pQ->tail++;
+	}
+}
+
+/* Add a request to the queue of endpoint ep, primes it if the endpoint is idle */
+static ErrorCode_t lusb_QueueReq(LUSB_REQ_QUEUE_T *pQ, uint32_t ep, uint8_t *pBuf, uint32_t buf_len,
+								 LUSB_DONE_CB_T cb, void *arg)
+{
+	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) &g_lusb;
+	LUSB_REQ_T *pReq;
+	ErrorCode_t ret = ERR_FAILED;
+
+	/* enter critical section, completions update the queue from the USB IRQ */
+	NVIC_DisableIRQ(LPC_USB_IRQ);
+	if ((pQ->head - pQ->tail) < LUSB_REQ_QUEUE_DEPTH) {
+		pReq = &pQ->req[pQ->head & LUSB_REQ_QUEUE_MASK];
+		pReq->pBuf = pBuf;
+		pReq->len = buf_len;
+		pReq->cb = cb;
+		pReq->arg = arg;
+		if (pQ->prime == pQ->head++) {
+			lusb_PrimeReq(pUSB, pQ, ep);
+		}
+		ret = LPC_OK;
+	}
+	/* exit critical section */
+	NVIC_EnableIRQ(LPC_USB_IRQ);
+
+	return ret;
+}
+
+/* Complete the primed request of endpoint ep with len bytes transferred.
+   The next pending request is primed before the callback runs, so the
+   endpoint is busy again while the application handles the data. */
+static void lusb_CompleteReq(LUSB_CTRL_T *pUSB, LUSB_REQ_QUEUE_T *pQ, uint32_t ep, uint32_t len)
+{
+	LUSB_REQ_T req;
+
+	if (pQ->prime == pQ->head) {
+		return;
+	}
+	pQ->req[pQ->prime & LUSB_REQ_QUEUE_MASK].len = len;
+	req = pQ->req[pQ->prime & LUSB_REQ_QUEUE_MASK];
+	pQ->prime++;
+	if (pQ->prime != pQ->head) {
+		lusb_PrimeReq(pUSB, pQ, ep);
+	}
+	lusb_ReleaseReq(pQ);
+	if (req.cb) {
+		req.cb(req.pBuf, len, req.arg);
+	}
+}
+
 /* Handle USB RESET event */
 ErrorCode_t lusb_ResetEvent(USBD_HANDLE_T hUsb)
 {
@@ -85,8 +178,9 @@ ErrorCode_t lusb_BulkIN_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) data;
 
 	if (event == USB_EVT_IN) {
-		pUSB->txBuffLen = 0;
-		pUSB->pTxBuf = 0;
+		lusb_CompleteReq(pUSB, &pUSB->txQ, LUSB_IN_EP, pUSB->txQ.req[pUSB->txQ.prime & LUSB_REQ_QUEUE_MASK].len);
+		/* sends have nothing to collect, release the polled ones as well */
+		pUSB->txQ.tail = pUSB->txQ.prime;
 	}
 	return LPC_OK;
 }
@@ -118,9 +212,10 @@ ErrorCode_t lusb_BulkOUT_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) data;
 
 	/* We received a transfer from the USB host. */
-	if (event == USB_EVT_OUT) {
-		pUSB->rxBuffLen = USBD_API->hw->ReadEP(hUsb, LUSB_OUT_EP, pUSB->pRxBuf);
-		pUSB->pRxBuf = 0;
+	if ((event == USB_EVT_OUT) && (pUSB->rxQ.prime != pUSB->rxQ.head)) {
+		lusb_CompleteReq(pUSB, &pUSB->rxQ, LUSB_OUT_EP,
+						 USBD_API->hw->ReadEP(hUsb, LUSB_OUT_EP,
+											  pUSB->rxQ.req[pUSB->rxQ.prime & LUSB_REQ_QUEUE_MASK].pBuf));
 	}
 
 	return LPC_OK;
@@ -196,36 +291,12 @@ ErrorCode_t WCID_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
 	return ret;
 }
 
-/* EP0_patch part of WORKAROUND for artf45032. */
-static ErrorCode_t EP0_patch(USBD_HANDLE_T hUsb, void *data, uint32_t event)
-{
-	switch (event) {
-	case USB_EVT_OUT_NAK:
-		if (g_ep0RxBusy) {
-			/* we already queued the buffer so ignore this NAK event. */
-			return LPC_OK;
-		}
-		else {
-			/* Mark EP0_RX buffer as busy and allow base handler to queue the buffer. */
-			g_ep0RxBusy = 1;
-		}
-		break;
-
-	case USB_EVT_SETUP:	/* reset the flag when new setup sequence starts */
-	case USB_EVT_OUT:
-		/* we received the packet so clear the flag. */
-		g_ep0RxBusy = 0;
-		break;
-	}
-	return g_Ep0BaseHdlr(hUsb, data, event);
-}
-
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
 
 /* Handle interrupt from USB */
-void USB_IRQHandler(void)
+HOTFUNC void USB_IRQHandler(void)
 {
 	USBD_API->hw->ISR(g_lusb.hUsb);
 }
@@ -236,7 +307,6 @@ int libusbdev_init(uint32_t memBase, uint32_t memSize)
 	USBD_API_INIT_PARAM_T usb_param;
 	USB_CORE_DESCS_T desc;
 	ErrorCode_t ret = LPC_OK;
-	USB_CORE_CTRL_T *pCtrl;
 
 	/* enable clocks and USB PHY/pads */
 	USB_init_pin_clk();
@@ -273,16 +343,8 @@ int libusbdev_init(uint32_t memBase, uint32_t memSize)
 	ret = USBD_API->hw->Init(&g_lusb.hUsb, &desc, &usb_param);
 	if (ret == LPC_OK) {
 
-		/*	WORKAROUND for artf45032 ROM driver BUG:
-		    Due to a race condition there is the chance that a second NAK event will
-		    occur before the default endpoint0 handler has completed its preparation
-		    of the DMA engine for the first NAK event. This can cause certain fields
-		    in the DMA descriptors to be in an invalid state when the USB controller
-		    reads them, thereby causing a hang.
-		 */
-		pCtrl = (USB_CORE_CTRL_T *) g_lusb.hUsb;/* convert the handle to control structure */
-		g_Ep0BaseHdlr = pCtrl->ep_event_hdlr[0];/* retrieve the default EP0_OUT handler */
-		pCtrl->ep_event_hdlr[0] = EP0_patch;/* set our patch routine as EP0_OUT handler */
+		/* WORKAROUND for artf45032 ROM driver BUG, see usbd_ep0patch.h */
+		UsbEp0Patch_Install(&g_ep0Patch, g_lusb.hUsb);
 
 		/* register WCID handler */
 		ret = USBD_API->core->RegisterClassHandler(g_lusb.hUsb, WCID_hdlr, &g_lusb);
@@ -314,35 +376,36 @@ bool libusbdev_Connected(void)
 	return USB_IsConfigured(g_lusb.hUsb);
 }
 
+/* Queue the read buffer to USB DMA, with a completion callback */
+ErrorCode_t libusbdev_QueueReadReqCb(uint8_t *pBuf, uint32_t buf_len, LUSB_DONE_CB_T cb, void *arg)
+{
+	return lusb_QueueReq(&g_lusb.rxQ, LUSB_OUT_EP, pBuf, buf_len, cb, arg);
+}
+
 /* Queue the read buffer to USB DMA */
 ErrorCode_t libusbdev_QueueReadReq(uint8_t *pBuf, uint32_t buf_len)
 {
-	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) &g_lusb;
-	ErrorCode_t ret = ERR_FAILED;
-
-	/* Check if a read request is pending */
-	if (pUSB->pRxBuf == 0) {
-		/* Queue the read request */
-		pUSB->pRxBuf = pBuf;
-		pUSB->rxBuffLen = buf_len;
-		USBD_API->hw->ReadReqEP(pUSB->hUsb, LUSB_OUT_EP, pBuf, buf_len);
-		ret = LPC_OK;
-	}
-
-	return ret;
+	return lusb_QueueReq(&g_lusb.rxQ, LUSB_OUT_EP, pBuf, buf_len, 0, 0);
 }
 
-/* Check if queued read buffer got any data */
+/* Check if the oldest queued read buffer got any data */
 int32_t libusbdev_QueueReadDone(void)
 {
-	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) &g_lusb;
+	LUSB_REQ_QUEUE_T *pQ = &g_lusb.rxQ;
+	int32_t ret = -1;
 
-	/* A read request is pending */
-	if (pUSB->pRxBuf) {
-		return -1;
+	/* enter critical section */
+	NVIC_DisableIRQ(LPC_USB_IRQ);
+	if (pQ->tail != pQ->prime) {
+		/* data received, return the length and release the request */
+		ret = pQ->req[pQ->tail & LUSB_REQ_QUEUE_MASK].len;
+		pQ->tail++;
+		lusb_ReleaseReq(pQ);
 	}
-	/* if data received return the length */
-	return pUSB->rxBuffLen;
+	/* exit critical section */
+	NVIC_EnableIRQ(LPC_USB_IRQ);
+
+	return ret;
 }
 
 /* A blocking read call */
@@ -350,8 +413,8 @@ int32_t libusbdev_Read(uint8_t *pBuf, uint32_t buf_len)
 {
 	int32_t ret = -1;
 
-	/* Queue read request  */
-	if (libusbdev_QueueReadReq(pBuf, buf_len) == LPC_OK) {
+	/* Queue read request, only if no other read is queued */
+	if ((g_lusb.rxQ.head == g_lusb.rxQ.tail) && (libusbdev_QueueReadReq(pBuf, buf_len) == LPC_OK)) {
 		/* wait for Rx to complete */
 		while ( (ret = libusbdev_QueueReadDone()) == -1) {
 			/* Sleep until next IRQ happens */
@@ -362,32 +425,36 @@ int32_t libusbdev_Read(uint8_t *pBuf, uint32_t buf_len)
 	return ret;
 }
 
+/* Queue the given buffer for transmision to USB host application, with a
+   completion callback. */
+ErrorCode_t libusbdev_QueueSendReqCb(uint8_t *pBuf, uint32_t buf_len, LUSB_DONE_CB_T cb, void *arg)
+{
+	return lusb_QueueReq(&g_lusb.txQ, LUSB_IN_EP, pBuf, buf_len, cb, arg);
+}
+
 /* Queue the given buffer for transmision to USB host application. */
 ErrorCode_t libusbdev_QueueSendReq(uint8_t *pBuf, uint32_t buf_len)
 {
-	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) &g_lusb;
-	ErrorCode_t ret = ERR_FAILED;
-
-	/* Check if a read request is pending */
-	if (pUSB->pTxBuf == 0) {
-		/* Queue the read request */
-		pUSB->pTxBuf = pBuf;
-		pUSB->txBuffLen = buf_len;
-
-		USBD_API->hw->WriteEP(pUSB->hUsb, LUSB_IN_EP, pBuf, buf_len);
-		ret = LPC_OK;
-	}
-
-	return ret;
+	return lusb_QueueReq(&g_lusb.txQ, LUSB_IN_EP, pBuf, buf_len, 0, 0);
 }
 
-/* Check if queued send is done. */
+/* Check if queued sends are done. */
 int32_t libusbdev_QueueSendDone(void)
 {
-	LUSB_CTRL_T *pUSB = (LUSB_CTRL_T *) &g_lusb;
+	LUSB_REQ_QUEUE_T *pQ = &g_lusb.txQ;
+	int32_t ret = 0;
+	uint32_t i;
+
+	/* enter critical section */
+	NVIC_DisableIRQ(LPC_USB_IRQ);
+	/* return remaining length of all pending sends */
+	for (i = pQ->prime; i != pQ->head; i++) {
+		ret += pQ->req[i & LUSB_REQ_QUEUE_MASK].len;
+	}
+	/* exit critical section */
+	NVIC_EnableIRQ(LPC_USB_IRQ);
 
-	/* return remaining length */
-	return pUSB->txBuffLen;
+	return ret;
 }
 
 /* Send the given buffer to USB host application */
@@ -397,7 +464,7 @@ ErrorCode_t libusbdev_Send(uint8_t *pBuf, uint32_t buf_len)
 
 	/* Queue read request  */
 	if (ret == LPC_OK) {
-		/* wait for Rx to complete */
+		/* wait for Tx to complete */
 		while ( libusbdev_QueueSendDone() != 0) {
 			/* Sleep until next IRQ happens */
 			__WFI();
@@ -44,6 +44,18 @@ extern "C"
  * @{
  */
 
+/**
+ * @brief	Bulk transfer completion callback
+ * @param	pBuf	: Buffer passed when the request was queued
+ * @param	len		: Number of bytes transferred
+ * @param	arg		: Argument passed when the request was queued
+ * @return	Nothing
+ * @note	Called from USB interrupt context. The next queued request is
+ *			already primed and the request slot is free again, so the
+ *			callback may queue the buffer right back.
+ */
+typedef void (*LUSB_DONE_CB_T)(uint8_t *pBuf, uint32_t len, void *arg);
+
 /**
  * @brief	Initialize USB interface.
  * @param	mem_base	: Pointer to memory address which can be used by libusbdev driver
@@ -62,13 +74,30 @@ extern bool libusbdev_Connected(void);
  * @brief	Queue the read buffer to USB DMA
  * @param	pBuf	: Pointer to buffer where read data should be copied
  * @param	buf_len	: Length of the buffer passed
- * @return	Returns LPC_OK on success.
+ * @return	Returns LPC_OK on success, ERR_FAILED if LUSB_REQ_QUEUE_DEPTH
+ *			read requests are queued already.
+ * @note	Requests are filled in the order they were queued. Collect
+ *			the completed ones with libusbdev_QueueReadDone().
  */
 extern ErrorCode_t libusbdev_QueueReadReq(uint8_t *pBuf, uint32_t buf_len);
 
 /**
- * @brief	Check if queued read buffer got any data
- * @return	Returns length of data received. Returns -1 if read is still pending.
+ * @brief	Queue the read buffer to USB DMA with a completion callback
+ * @param	pBuf	: Pointer to buffer where read data should be copied
+ * @param	buf_len	: Length of the buffer passed
+ * @param	cb		: Called once the buffer got data
+ * @param	arg		: Argument passed to @a cb
+ * @return	Returns LPC_OK on success, ERR_FAILED if LUSB_REQ_QUEUE_DEPTH
+ *			read requests are queued already.
+ * @note	Do not mix with polled requests: a completed polled request
+ *			keeps the slots of later requests until it is collected.
+ */
+extern ErrorCode_t libusbdev_QueueReadReqCb(uint8_t *pBuf, uint32_t buf_len, LUSB_DONE_CB_T cb, void *arg);
+
+/**
+ * @brief	Check if the oldest queued read buffer got any data
+ * @return	Returns length of data received and releases the request.
+ *			Returns -1 if the read is still pending.
  * @note	Since on USB, zero length packets are transferred -1 is used for
  *			Rx pending indication.
  */
@@ -78,7 +107,7 @@ extern int32_t libusbdev_QueueReadDone (void);
  * @brief	A blocking read call
  * @param	pBuf	: Pointer to buffer where read data should be copied
  * @param	buf_len	: Length of the buffer passed
- * @return	Return number of bytes read. Returns -1 if previous read is pending.
+ * @return	Return number of bytes read. Returns -1 if any read request is queued.
  */
 extern int32_t libusbdev_Read(uint8_t *pBuf, uint32_t buf_len);
 
@@ -86,14 +115,26 @@ extern int32_t libusbdev_Read(uint8_t *pBuf, uint32_t buf_len);
  * @brief	Queue the given buffer for transmission to USB host application.
  * @param	pBuf	: Pointer to buffer to be written
  * @param	buf_len	: Length of the buffer passed
- * @return	Returns LPC_OK on success.
+ * @return	Returns LPC_OK on success, ERR_FAILED if LUSB_REQ_QUEUE_DEPTH
+ *			send requests are queued already.
  */
 extern ErrorCode_t libusbdev_QueueSendReq(uint8_t *pBuf, uint32_t buf_len);
 
 /**
- * @brief	Check if queued send is done.
- * @return	Returns length of remaining data to be sent.
- *			0 indicates transfer done.
+ * @brief	Queue the given buffer for transmission with a completion callback
+ * @param	pBuf	: Pointer to buffer to be written
+ * @param	buf_len	: Length of the buffer passed
+ * @param	cb		: Called once the buffer was sent
+ * @param	arg		: Argument passed to @a cb
+ * @return	Returns LPC_OK on success, ERR_FAILED if LUSB_REQ_QUEUE_DEPTH
+ *			send requests are queued already.
+ */
+extern ErrorCode_t libusbdev_QueueSendReqCb(uint8_t *pBuf, uint32_t buf_len, LUSB_DONE_CB_T cb, void *arg);
+
+/**
+ * @brief	Check if queued sends are done.
+ * @return	Returns length of remaining data of all queued sends.
+ *			0 indicates all transfers done.
  */
 extern int32_t libusbdev_QueueSendDone (void);
 
@@ -45,8 +45,8 @@
 /* Application defined LUSB interrupt status  */
 #define LUSB_DATA_PENDING       _BIT(0)
 
-/* Packet buffer for processing */
-static uint8_t g_rxBuff[PACKET_BUFFER_SIZE];
+/* Packet buffers for processing, one per queued request */
+static uint8_t g_rxBuff[LUSB_REQ_QUEUE_DEPTH][PACKET_BUFFER_SIZE];
 
 /*****************************************************************************
  * Public types/enumerations/variables
@@ -56,6 +56,21 @@ static uint8_t g_rxBuff[PACKET_BUFFER_SIZE];
  * Private functions
  ****************************************************************************/
 
+/* Read completion, called from USB IRQ */
+static void rx_done(uint8_t *pBuf, uint32_t len, void *arg)
+{
+	/* Dummy process read data ......*/
+	/* requeue read request */
+	libusbdev_QueueReadReqCb(pBuf, PACKET_BUFFER_SIZE, rx_done, arg);
+}
+
+/* Send completion, called from USB IRQ */
+static void tx_done(uint8_t *pBuf, uint32_t len, void *arg)
+{
+	/* requeue send request */
+	libusbdev_QueueSendReqCb(pBuf, PACKET_BUFFER_SIZE, tx_done, arg);
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -66,6 +81,8 @@ static uint8_t g_rxBuff[PACKET_BUFFER_SIZE];
  */
 int main(void)
 {
+	int i;
+
 	/* Initialize board and chip */
 	SystemCoreClockUpdate();
 	Board_Init();
@@ -80,19 +97,16 @@ int main(void)
 			__WFI();
 		}
 
-		while (libusbdev_Connected()) {
-
-			if (libusbdev_QueueReadDone() != -1) {
-
-				/* Dummy process read data ......*/
-				/* requeue read request */
-				libusbdev_QueueReadReq(g_rxBuff, PACKET_BUFFER_SIZE);
-			}
+		/* keep all requests queued, so the endpoints always have a primed
+		   buffer while the callbacks requeue the completed ones */
+		for (i = 0; i < LUSB_REQ_QUEUE_DEPTH; i++) {
+			libusbdev_QueueReadReqCb(g_rxBuff[i], PACKET_BUFFER_SIZE, rx_done, 0);
+			libusbdev_QueueSendReqCb(g_rxBuff[i], PACKET_BUFFER_SIZE, tx_done, 0);
+		}
 
-			if (libusbdev_QueueSendDone() == 0) {
-				/* Queue send request */
-				libusbdev_QueueSendReq(g_rxBuff, PACKET_BUFFER_SIZE);
-			}
+		while (libusbdev_Connected()) {
+			/* Sleep until next IRQ happens */
+			__WFI();
 		}
 	}
 }
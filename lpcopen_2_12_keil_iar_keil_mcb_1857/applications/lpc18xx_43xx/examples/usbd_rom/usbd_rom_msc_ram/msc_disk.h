@@ -44,13 +44,42 @@ extern "C"
  */
 
 /* MSC Disk Image Definitions */
+/* Define to keep the disk image in the external SDRAM instead of internal RAM */
+/* #define MSC_DISK_SDRAM */
+
 /* Mass Storage Memory Layout */
+#ifdef MSC_DISK_SDRAM
+/* MT48LC4M32 on DYCS0, set up by Board_SystemInit() */
+#define MSC_SDRAM_BASE                  0x28000000
+#define MSC_SDRAM_SIZE                  (16 * 1024 * 1024)
+/* Disk size, may be overridden from the build up to the whole SDRAM */
+#ifndef MSC_SDRAM_DISK_SIZE
+#define MSC_SDRAM_DISK_SIZE             (8 * 1024 * 1024)
+#endif
+/* Bytes cleared at init so the host sees an unformatted disk, not stale SDRAM */
+#define MSC_SDRAM_CLEAR_SIZE            (64 * 1024)
+#define MSC_MEM_DISK_BASE               MSC_SDRAM_BASE
+#define MSC_MEM_DISK_SIZE               ((uint32_t) MSC_SDRAM_DISK_SIZE)
+#else
 #define MSC_MEM_DISK_BASE               0x20004000
 #define MSC_MEM_DISK_SIZE               ((uint32_t) (32 * 1024))
+#endif
 #define MSC_MEM_DISK_BLOCK_SIZE         512
 #define MSC_MEM_DISK_BLOCK_COUNT        (MSC_MEM_DISK_SIZE / MSC_MEM_DISK_BLOCK_SIZE)
 #define MSC_USB_DISK_BLOCK_SIZE         512
 
+#ifdef MSC_DISK_SDRAM
+#if (MSC_SDRAM_DISK_SIZE > MSC_SDRAM_SIZE)
+#error "MSC_SDRAM_DISK_SIZE is larger than the board SDRAM"
+#endif
+#if (MSC_SDRAM_DISK_SIZE % MSC_MEM_DISK_BLOCK_SIZE) != 0
+#error "MSC_SDRAM_DISK_SIZE must be a multiple of MSC_MEM_DISK_BLOCK_SIZE"
+#endif
+#if (MSC_SDRAM_CLEAR_SIZE > MSC_SDRAM_DISK_SIZE)
+#error "MSC_SDRAM_CLEAR_SIZE must not exceed MSC_SDRAM_DISK_SIZE"
+#endif
+#endif
+
 /**
  * @brief	MSC disk init routine
  * @param	hUsb		: Handle to USBD stack instance
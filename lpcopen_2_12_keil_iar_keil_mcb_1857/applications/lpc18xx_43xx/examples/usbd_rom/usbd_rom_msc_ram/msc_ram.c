@@ -32,6 +32,7 @@
 #include <string.h>
 #include "board.h"
 #include "app_usbd_cfg.h"
+#include "usbd_descidx.h"
 #include "msc_disk.h"
 
 /*****************************************************************************
@@ -50,6 +51,10 @@ static const uint8_t g_InquiryStr[] = {'N', 'X', 'P', ' ', ' ', ' ', ' ', ' ',
  * Private functions
  ****************************************************************************/
 
+/* The callbacks below hand the ROM stack pointers straight into the disk
+   image, so the controller DMAs to and from it without a bounce copy. With
+   MSC_DISK_SDRAM that image is the external SDRAM. */
+
 /* USB device mass storage class read callback routine */
 static void translate_rd(uint32_t offset, uint8_t * *buff_adr, uint32_t length, uint32_t hi_offset)
 {
@@ -88,6 +93,11 @@ ErrorCode_t mscDisk_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_I
 	USBD_MSC_INIT_PARAM_T msc_param;
 	ErrorCode_t ret = LPC_OK;
 
+#ifdef MSC_DISK_SDRAM
+	/* SDRAM powers up with noise, which a host may take for a partition table */
+	memset((void *) g_memDiskArea, 0, MSC_SDRAM_CLEAR_SIZE);
+#endif
+
 	memset((void *) &msc_param, 0, sizeof(USBD_MSC_INIT_PARAM_T));
 	msc_param.mem_base = pUsbParam->mem_base;
 	msc_param.mem_size = pUsbParam->mem_size;
@@ -101,7 +111,7 @@ ErrorCode_t mscDisk_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_I
 	msc_param.MSC_Read = translate_rd;
 	msc_param.MSC_Verify = translate_verify;
 	msc_param.MSC_GetWriteBuf = translate_GetWrBuf;
-	msc_param.intf_desc = (uint8_t *) find_IntfDesc(pDesc->high_speed_desc, USB_DEVICE_CLASS_STORAGE);
+	msc_param.intf_desc = (uint8_t *) UsbDescIdx_FindIntf(hUsb, USB_HIGH_SPEED, USB_DEVICE_CLASS_STORAGE);
 
 	ret = USBD_API->msc->init(hUsb, &msc_param);
 	/* update memory variables */
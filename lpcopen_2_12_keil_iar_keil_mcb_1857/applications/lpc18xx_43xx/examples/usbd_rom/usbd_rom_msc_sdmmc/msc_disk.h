@@ -0,0 +1,96 @@
+/*
+ * @brief Programming API used with the SD card backed MSC disk
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __MSC_DISK_H_
+#define __MSC_DISK_H_
+
+#include "usbd_rom_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @ingroup EXAMPLES_USBDROM_18XX43XX_MSC_SDMMC
+ * @{
+ */
+
+/* MSC Disk Definitions */
+#define MSC_SD_BLOCK_SIZE               512		/*!< SD card sector size, fixed by the SDMMC driver */
+#define MSC_SD_BLOCK_SHIFT              9
+
+/* Cache layout in external SDRAM (DYCS0). The read-ahead lines, the write-back
+   runs and the transfer buffer are all USB and SDIF DMA targets.
+ */
+#define MSC_SD_CACHE_BASE               0x28000000
+#define MSC_SD_RA_LINES                 4		/*!< Read-ahead lines, one is served while the next is fetched */
+#define MSC_SD_RA_BLOCKS                64		/*!< Blocks per line (32KB) */
+#define MSC_SD_XFER_BLOCKS              128		/*!< Max blocks in one SDIF DMA chain (64KB) */
+#define MSC_SD_WB_RUNS                  2		/*!< Write-back runs, e.g. FAT updates and file data */
+#define MSC_SD_WB_BLOCKS                128		/*!< Adjacent blocks merged into one multi-block write */
+#define MSC_SD_WB_IDLE_MS               100		/*!< Flush dirty runs after this long without a write */
+#define MSC_SD_LINE_SIZE                (MSC_SD_RA_BLOCKS * MSC_SD_BLOCK_SIZE)
+#define MSC_SD_RUN_SIZE                 (MSC_SD_WB_BLOCKS * MSC_SD_BLOCK_SIZE)
+#define MSC_SD_WB_BUF                   (MSC_SD_CACHE_BASE + (MSC_SD_RA_LINES * MSC_SD_LINE_SIZE))
+#define MSC_SD_XFER_BUF                 (MSC_SD_WB_BUF + (MSC_SD_WB_RUNS * MSC_SD_RUN_SIZE))
+
+#if (MSC_SD_RA_LINES < 2) || (MSC_SD_RA_BLOCKS > MSC_SD_XFER_BLOCKS) || (MSC_SD_WB_BLOCKS > MSC_SD_XFER_BLOCKS)
+#error "MSC_SDMMC: need two read-ahead lines, lines and runs of at most MSC_SD_XFER_BLOCKS each"
+#endif
+
+/**
+ * @brief	MSC disk init routine
+ * @param	hUsb		: Handle to USBD stack instance
+ * @param	pDesc		: Pointer to configuration descriptor
+ * @param	pUsbParam	: Pointer USB param structure returned by previous init call
+ * @return	LPC_OK on success, ERR_FAILED if no card could be acquired.
+ * @note	Waits for a card to be inserted.
+ */
+ErrorCode_t mscDisk_init (USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT_PARAM_T *pUsbParam);
+
+/**
+ * @brief	Fetch the requested read-ahead line and flush idle write-back runs
+ * @return	Nothing
+ * @note	Call from the main loop at least every few ms. The USB interrupt is
+ *			masked while the card is accessed, the controller keeps streaming
+ *			the transfer already primed from the previous line meanwhile.
+ */
+void mscDisk_task(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MSC_DISK_H_ */
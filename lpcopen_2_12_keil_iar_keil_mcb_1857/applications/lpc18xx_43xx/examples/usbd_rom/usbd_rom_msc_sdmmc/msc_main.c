@@ -0,0 +1,155 @@
+/*
+ * @brief This file contains a USB MSC SD card example using USB ROM Drivers.
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include <stdio.h>
+#include <string.h>
+#include "app_usbd_cfg.h"
+#include "usbd_ep0patch.h"
+#include "usbd_descidx.h"
+#include "msc_disk.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+static USBD_HANDLE_T g_hUsb;
+
+/* Endpoint 0 patch that prevents nested NAK event processing */
+static USBEP0PATCH_T g_ep0Patch;
+
+/* Configuration descriptor index, built once after stack init */
+static USBDESCIDX_T g_descIdx;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+const USBD_API_T *g_pUsbApi;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/**
+ * @brief	SysTick IRQ handler
+ * @return	Nothing
+ * @note	Only wakes the main loop so that idle write-back runs get flushed.
+ */
+void SysTick_Handler(void)
+{}
+
+/**
+ * @brief	Handle interrupt from USB0
+ * @return	Nothing
+ */
+HOTFUNC void USB_IRQHandler(void)
+{
+	USBD_API->hw->ISR(g_hUsb);
+}
+
+/**
+ * @brief	main routine for blinky example
+ * @return	Function should not exit.
+ */
+int main(void)
+{
+	USBD_API_INIT_PARAM_T usb_param;
+	USB_CORE_DESCS_T desc;
+	ErrorCode_t ret = LPC_OK;
+
+	/* Initialize board and chip */
+	SystemCoreClockUpdate();
+	Board_Init();
+
+	/* enable clocks and pinmux */
+	USB_init_pin_clk();
+
+	/* periodic wakeup for the write-back idle flush */
+	SysTick_Config(SystemCoreClock / 100);
+
+	/* Init USB API structure */
+	g_pUsbApi = (const USBD_API_T *) LPC_ROM_API->usbdApiBase;
+
+	/* initialize call back structures */
+	memset((void *) &usb_param, 0, sizeof(USBD_API_INIT_PARAM_T));
+	usb_param.usb_reg_base = LPC_USB_BASE;
+	usb_param.mem_base = USB_STACK_MEM_BASE;
+	usb_param.mem_size = USB_STACK_MEM_SIZE;
+	usb_param.max_num_ep = 2;
+
+	/* Set the USB descriptors */
+	desc.device_desc = (uint8_t *) USB_DeviceDescriptor;
+	desc.string_desc = (uint8_t *) USB_StringDescriptor;
+
+#ifdef USE_USB0
+	desc.high_speed_desc = USB_HsConfigDescriptor;
+	desc.full_speed_desc = USB_FsConfigDescriptor;
+	desc.device_qualifier = (uint8_t *) USB_DeviceQualifier;
+#else
+	/* Note, to pass USBCV test full-speed only devices should have both
+	   descriptor arrays point to same location and device_qualifier set to 0.
+	 */
+	desc.high_speed_desc = USB_FsConfigDescriptor;
+	desc.full_speed_desc = USB_FsConfigDescriptor;
+	desc.device_qualifier = 0;
+#endif
+
+	/* USB Initialization */
+	ret = USBD_API->hw->Init(&g_hUsb, &desc, &usb_param);
+	if (ret == LPC_OK) {
+
+		/* WORKAROUND for artf45032 ROM driver BUG, see usbd_ep0patch.h */
+		UsbEp0Patch_Install(&g_ep0Patch, g_hUsb);
+
+		/* index the configuration descriptors once for the class init code */
+		UsbDescIdx_Build(&g_descIdx, g_hUsb, &desc);
+
+		ret = mscDisk_init(g_hUsb, &desc, &usb_param);
+		if (ret == LPC_OK) {
+			/*  enable USB interrrupts */
+			NVIC_EnableIRQ(LPC_USB_IRQ);
+			/* now connect */
+			USBD_API->hw->Connect(g_hUsb, 1);
+		}
+	}
+
+	while (1) {
+		/* fetch the next read-ahead line while the host reads the current one,
+		   flush write-back runs once the host stops writing */
+		mscDisk_task();
+
+		/* Sleep until next IRQ happens */
+		__WFI();
+	}
+}
@@ -0,0 +1,470 @@
+/*
+ * @brief File contains callback to MSC driver backed by the SD card.
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "board.h"
+#include "stopwatch.h"
+#include "app_usbd_cfg.h"
+#include "usbd_descidx.h"
+#include "msc_disk.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Read-ahead cache line or write-back run */
+typedef struct {
+	uint32_t base;		/*!< First card block held by the line */
+	uint32_t count;		/*!< Valid (or dirty) blocks, 0 when the line is empty */
+	uint8_t *buf;		/*!< Line buffer in SDRAM */
+} MSC_SD_LINE_T;
+
+/* Read-ahead cache state. The USB interrupt looks up and fills lines, the main
+   loop only fetches the line requested in raBlock with the interrupt masked.
+ */
+typedef struct {
+	MSC_SD_LINE_T line[MSC_SD_RA_LINES];
+	uint32_t cur;					/*!< Line the last read was served from */
+	uint32_t victim;				/*!< Round robin replacement index */
+	volatile uint32_t raBlock;		/*!< Block to fetch ahead, or MSC_SD_RA_NONE */
+} MSC_SD_CACHE_T;
+
+#define MSC_SD_RA_NONE      0xFFFFFFFF
+
+/* Write-back state. Runs are only touched from the USB interrupt and from
+   mscDisk_task() with the interrupt masked.
+ */
+typedef struct {
+	MSC_SD_LINE_T run[MSC_SD_WB_RUNS];
+	uint32_t cur;					/*!< Run receiving the current write, or MSC_SD_WB_DIRECT */
+	uint32_t victim;				/*!< Round robin replacement index */
+	uint32_t lastWrite;				/*!< Stopwatch time of the last write */
+} MSC_SD_WB_T;
+
+#define MSC_SD_WB_DIRECT    0xFFFFFFFF
+
+static MSC_SD_CACHE_T g_cache;
+static MSC_SD_WB_T g_wb;
+static USB_EP_HANDLER_T g_mscOutHdlr;
+static uint8_t *g_xferBuf = (uint8_t *) MSC_SD_XFER_BUF;
+static uint32_t g_blockCount;
+static volatile uint32_t g_sdWaitBits;
+
+static const uint8_t g_InquiryStr[] = {'N', 'X', 'P', ' ', ' ', ' ', ' ', ' ',	   \
+									   'L', 'P', 'C', ' ', 'S', 'D', ' ', ' ',	   \
+									   'C', 'a', 'r', 'd', ' ', ' ', ' ', ' ',	   \
+									   '1', '.', '0', ' ', };
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/* SDMMC card info structure */
+mci_card_struct sdcardinfo;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Delay callback for timed SDIF/SDMMC functions */
+static void sdmmc_waitms(uint32_t time)
+{
+	StopWatch_DelayMs(time);
+}
+
+/* Remember the status bits the driver waits for */
+static void sdmmc_setup_wait(void *bits)
+{
+	g_sdWaitBits = *((uint32_t *) bits);
+}
+
+/* Polled wait for SDMMC command completion. Polling rather than the SDIO
+   interrupt lets the card be read from the USB interrupt on a cache miss. */
+static uint32_t sdmmc_polled_wait(void)
+{
+	uint32_t status;
+
+	do {
+		status = Chip_SDIF_GetIntStatus(LPC_SDMMC);
+	} while ((status & g_sdWaitBits) == 0);
+	Chip_SDIF_ClrIntStatus(LPC_SDMMC, status);
+
+	return status;
+}
+
+/* Convert a byte offset from the MSC callbacks to a card block */
+STATIC INLINE uint32_t sd_block(uint32_t offset, uint32_t hi_offset)
+{
+	return (uint32_t) ((((uint64_t) offset) | (((uint64_t) hi_offset) << 32)) >> MSC_SD_BLOCK_SHIFT);
+}
+
+/* Find the line holding blocks [blk, blk + num) */
+static MSC_SD_LINE_T *cache_find(uint32_t blk, uint32_t num, uint32_t *pIdx)
+{
+	uint32_t i;
+	MSC_SD_LINE_T *pLine;
+
+	for (i = 0; i < MSC_SD_RA_LINES; i++) {
+		pLine = &g_cache.line[i];
+		if ((pLine->count != 0) && (blk >= pLine->base) && ((blk + num) <= (pLine->base + pLine->count))) {
+			*pIdx = i;
+			return pLine;
+		}
+	}
+	return NULL;
+}
+
+/* Read a line from the card into a line other than the one being served */
+static MSC_SD_LINE_T *cache_fill(uint32_t blk, uint32_t *pIdx)
+{
+	MSC_SD_LINE_T *pLine;
+	uint32_t num;
+
+	if (g_cache.victim == g_cache.cur) {
+		g_cache.victim = (g_cache.victim + 1) % MSC_SD_RA_LINES;
+	}
+	*pIdx = g_cache.victim;
+	g_cache.victim = (g_cache.victim + 1) % MSC_SD_RA_LINES;
+
+	pLine = &g_cache.line[*pIdx];
+	num = MIN(MSC_SD_RA_BLOCKS, g_blockCount - blk);
+	pLine->base = blk;
+	pLine->count = 0;
+	if (Chip_SDMMC_ReadBlocks(LPC_SDMMC, pLine->buf, blk, num) == (int32_t) (num * MSC_SD_BLOCK_SIZE)) {
+		pLine->count = num;
+	}
+	return pLine;
+}
+
+/* Drop cached copies of blocks [blk, blk + num) */
+static void cache_invalidate(uint32_t blk, uint32_t num)
+{
+	uint32_t i;
+	MSC_SD_LINE_T *pLine;
+
+	for (i = 0; i < MSC_SD_RA_LINES; i++) {
+		pLine = &g_cache.line[i];
+		if ((blk < (pLine->base + pLine->count)) && ((blk + num) > pLine->base)) {
+			pLine->count = 0;
+		}
+	}
+}
+
+/* Write a dirty run to the card as one multi-block write */
+static void wb_flush(MSC_SD_LINE_T *pRun)
+{
+	if (pRun->count != 0) {
+		Chip_SDMMC_WriteBlocks(LPC_SDMMC, pRun->buf, pRun->base, pRun->count);
+		/* a read-ahead may have fetched the old contents meanwhile */
+		cache_invalidate(pRun->base, pRun->count);
+		pRun->count = 0;
+	}
+}
+
+/* Flush every run overlapping blocks [blk, blk + num) */
+static void wb_flush_range(uint32_t blk, uint32_t num)
+{
+	uint32_t i;
+	MSC_SD_LINE_T *pRun;
+
+	for (i = 0; i < MSC_SD_WB_RUNS; i++) {
+		pRun = &g_wb.run[i];
+		if ((blk < (pRun->base + pRun->count)) && ((blk + num) > pRun->base)) {
+			wb_flush(pRun);
+		}
+	}
+}
+
+/* Flush all dirty runs */
+static void wb_flush_all(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < MSC_SD_WB_RUNS; i++) {
+		wb_flush(&g_wb.run[i]);
+	}
+}
+
+/* Return where the host data for blocks [blk, blk + num) should be received.
+   Blocks inside or right after a run go into that run, others start a new run. */
+static uint8_t *wb_get(uint32_t blk, uint32_t num)
+{
+	uint32_t i;
+	MSC_SD_LINE_T *pRun;
+
+	if (num > MSC_SD_WB_BLOCKS) {
+		/* longer than a run, write it through the transfer buffer */
+		wb_flush_range(blk, num);
+		g_wb.cur = MSC_SD_WB_DIRECT;
+		return g_xferBuf;
+	}
+
+	for (i = 0; i < MSC_SD_WB_RUNS; i++) {
+		pRun = &g_wb.run[i];
+		if ((pRun->count != 0) && (blk >= pRun->base) && (blk <= (pRun->base + pRun->count)) &&
+			((blk + num) <= (pRun->base + MSC_SD_WB_BLOCKS))) {
+			g_wb.cur = i;
+			return &pRun->buf[(blk - pRun->base) << MSC_SD_BLOCK_SHIFT];
+		}
+	}
+
+	/* an older copy of these blocks must reach the card before the new one */
+	wb_flush_range(blk, num);
+
+	for (i = 0; i < MSC_SD_WB_RUNS; i++) {
+		if (g_wb.run[i].count == 0) {
+			break;
+		}
+	}
+	if (i == MSC_SD_WB_RUNS) {
+		i = g_wb.victim;
+		g_wb.victim = (g_wb.victim + 1) % MSC_SD_WB_RUNS;
+		wb_flush(&g_wb.run[i]);
+	}
+	g_wb.run[i].base = blk;
+	g_wb.cur = i;
+
+	return g_wb.run[i].buf;
+}
+
+/* USB device mass storage class read callback routine */
+static void translate_rd(uint32_t offset, uint8_t * *buff_adr, uint32_t length, uint32_t hi_offset)
+{
+	uint32_t blk = sd_block(offset, hi_offset);
+	uint32_t num = (length + MSC_SD_BLOCK_SIZE - 1) >> MSC_SD_BLOCK_SHIFT;
+	uint32_t idx, next;
+	MSC_SD_LINE_T *pLine;
+
+	if (num > MSC_SD_RA_BLOCKS) {
+		/* longer than a line, read it through the transfer buffer */
+		Chip_SDMMC_ReadBlocks(LPC_SDMMC, g_xferBuf, blk, MIN(num, MSC_SD_XFER_BLOCKS));
+		*buff_adr = g_xferBuf;
+		return;
+	}
+
+	/* dirty data is newer than the card and the read-ahead lines */
+	for (idx = 0; idx < MSC_SD_WB_RUNS; idx++) {
+		pLine = &g_wb.run[idx];
+		if ((blk >= pLine->base) && ((blk + num) <= (pLine->base + pLine->count))) {
+			*buff_adr = &pLine->buf[(blk - pLine->base) << MSC_SD_BLOCK_SHIFT];
+			return;
+		}
+	}
+	wb_flush_range(blk, num);
+
+	pLine = cache_find(blk, num, &idx);
+	if (pLine == NULL) {
+		/* miss, the read-ahead did not keep up or the host seeked */
+		pLine = cache_fill(blk, &idx);
+	}
+	g_cache.cur = idx;
+	*buff_adr = &pLine->buf[(blk - pLine->base) << MSC_SD_BLOCK_SHIFT];
+
+	/* host is reading this line, have the following one ready by the time it gets there */
+	next = pLine->base + pLine->count;
+	if ((pLine->count != 0) && (next < g_blockCount) && (cache_find(next, 1, &idx) == NULL)) {
+		g_cache.raBlock = next;
+	}
+}
+
+/* USB device mass storage class write callback routine */
+static void translate_wr(uint32_t offset, uint8_t * *buff_adr, uint32_t length, uint32_t hi_offset)
+{
+	uint32_t blk = sd_block(offset, hi_offset);
+	uint32_t num = length >> MSC_SD_BLOCK_SHIFT;
+	MSC_SD_LINE_T *pRun;
+	uint8_t *dst;
+
+	if (g_wb.cur == MSC_SD_WB_DIRECT) {
+		Chip_SDMMC_WriteBlocks(LPC_SDMMC, *buff_adr, blk, num);
+	}
+	else {
+		pRun = &g_wb.run[g_wb.cur];
+		dst = &pRun->buf[(blk - pRun->base) << MSC_SD_BLOCK_SHIFT];
+		if (*buff_adr != dst) {
+			/* stack received into its own buffer */
+			memcpy(dst, *buff_adr, length);
+		}
+		pRun->count = MAX(pRun->count, (blk + num) - pRun->base);
+	}
+	g_wb.lastWrite = StopWatch_Start();
+
+	/* the card copy changed, drop stale read-ahead data */
+	cache_invalidate(blk, num);
+	if ((g_cache.raBlock < (blk + num)) && ((g_cache.raBlock + MSC_SD_RA_BLOCKS) > blk)) {
+		g_cache.raBlock = MSC_SD_RA_NONE;
+	}
+
+	/* next part of the transfer is received right behind this one */
+	*buff_adr = wb_get(blk + num, num);
+}
+
+/* USB device mass storage class get write buffer callback routine */
+static void translate_GetWrBuf(uint32_t offset, uint8_t * *buff_adr, uint32_t length, uint32_t hi_offset)
+{
+	*buff_adr = wb_get(sd_block(offset, hi_offset), (length + MSC_SD_BLOCK_SIZE - 1) >> MSC_SD_BLOCK_SHIFT);
+}
+
+/* USB device mass storage class verify callback routine */
+static ErrorCode_t translate_verify(uint32_t offset, uint8_t *src, uint32_t length, uint32_t hi_offset)
+{
+	uint32_t num = (length + MSC_SD_BLOCK_SIZE - 1) >> MSC_SD_BLOCK_SHIFT;
+
+	wb_flush_range(sd_block(offset, hi_offset), num);
+	if ((num > MSC_SD_XFER_BLOCKS) ||
+		(Chip_SDMMC_ReadBlocks(LPC_SDMMC, g_xferBuf, sd_block(offset, hi_offset), num) == 0) ||
+		memcmp(g_xferBuf, src, length)) {
+		return ERR_FAILED;
+	}
+
+	return LPC_OK;
+}
+
+/* MSC bulk OUT handler placed in front of the ROM one. The CBW is already in
+   the stack's bulk buffer when the OUT event arrives, commands that expect the
+   data on the media flush the write-back runs before the ROM handles them. */
+static ErrorCode_t mscDisk_bulk_out_hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
+{
+	USB_MSC_CTRL_T *pMsc = (USB_MSC_CTRL_T *) data;
+	MSC_CBW *pCbw = (MSC_CBW *) pMsc->BulkBuf;
+
+	if ((event == USB_EVT_OUT) && (pMsc->BulkStage == MSC_BS_CBW) && (pCbw->dSignature == MSC_CBW_Signature)) {
+		switch (pCbw->CB[0]) {
+		case SCSI_SYNC_CACHE10:
+		case SCSI_START_STOP_UNIT:
+		case SCSI_MEDIA_REMOVAL:
+			wb_flush_all();
+			break;
+		}
+	}
+
+	return g_mscOutHdlr(hUsb, data, event);
+}
+
+/* Initialize the SDMMC interface and wait for a card */
+static ErrorCode_t sdmmc_init(void)
+{
+	memset(&sdcardinfo, 0, sizeof(sdcardinfo));
+	sdcardinfo.card_info.evsetup_cb = sdmmc_setup_wait;
+	sdcardinfo.card_info.waitfunc_cb = sdmmc_polled_wait;
+	sdcardinfo.card_info.msdelay_func = sdmmc_waitms;
+
+	StopWatch_Init();
+	Board_SDMMC_Init();
+	Chip_SDIF_Init(LPC_SDMMC);
+
+	DEBUGSTR("Waiting for SD card...\r\n");
+	while (Chip_SDIF_CardNDetect(LPC_SDMMC)) {}
+
+	if (Chip_SDMMC_Acquire(LPC_SDMMC, &sdcardinfo) == 0) {
+		DEBUGSTR("SD card acquire failed\r\n");
+		return ERR_FAILED;
+	}
+	g_blockCount = Chip_SDMMC_GetDeviceBlocks(LPC_SDMMC);
+	DEBUGOUT("SD card: %u blocks\r\n", g_blockCount);
+
+	return LPC_OK;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* SD card based MSC_Disk init routine */
+ErrorCode_t mscDisk_init(USBD_HANDLE_T hUsb, USB_CORE_DESCS_T *pDesc, USBD_API_INIT_PARAM_T *pUsbParam)
+{
+	USBD_MSC_INIT_PARAM_T msc_param;
+	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;
+	ErrorCode_t ret = LPC_OK;
+	uint32_t i, ep_indx;
+
+	ret = sdmmc_init();
+	if (ret != LPC_OK) {
+		return ret;
+	}
+
+	memset((void *) &g_cache, 0, sizeof(g_cache));
+	for (i = 0; i < MSC_SD_RA_LINES; i++) {
+		g_cache.line[i].buf = (uint8_t *) (MSC_SD_CACHE_BASE + (i * MSC_SD_LINE_SIZE));
+	}
+	g_cache.raBlock = MSC_SD_RA_NONE;
+	memset((void *) &g_wb, 0, sizeof(g_wb));
+	for (i = 0; i < MSC_SD_WB_RUNS; i++) {
+		g_wb.run[i].buf = (uint8_t *) (MSC_SD_WB_BUF + (i * MSC_SD_RUN_SIZE));
+	}
+
+	memset((void *) &msc_param, 0, sizeof(USBD_MSC_INIT_PARAM_T));
+	msc_param.mem_base = pUsbParam->mem_base;
+	msc_param.mem_size = pUsbParam->mem_size;
+	/* mass storage paramas */
+	msc_param.InquiryStr = (uint8_t *) g_InquiryStr;
+	msc_param.BlockCount = g_blockCount;
+	msc_param.BlockSize = MSC_SD_BLOCK_SIZE;
+	msc_param.MemorySize64 = ((uint64_t) g_blockCount) << MSC_SD_BLOCK_SHIFT;
+	msc_param.MemorySize = (uint32_t) MIN(msc_param.MemorySize64, 0xFFFFFFFF);
+	/* Install memory storage callback routines */
+	msc_param.MSC_Write = translate_wr;
+	msc_param.MSC_Read = translate_rd;
+	msc_param.MSC_Verify = translate_verify;
+	msc_param.MSC_GetWriteBuf = translate_GetWrBuf;
+	msc_param.intf_desc = (uint8_t *) UsbDescIdx_FindIntf(hUsb, USB_HIGH_SPEED, USB_DEVICE_CLASS_STORAGE);
+
+	ret = USBD_API->msc->init(hUsb, &msc_param);
+	if (ret == LPC_OK) {
+		/* hook the bulk OUT endpoint for the cache flush commands */
+		ep_indx = ((USB_MSC_OUT_EP & 0x0F) << 1);
+		g_mscOutHdlr = pCtrl->ep_event_hdlr[ep_indx];
+		ret = USBD_API->core->RegisterEpHandler(hUsb, ep_indx, mscDisk_bulk_out_hdlr, pCtrl->ep_hdlr_data[ep_indx]);
+	}
+	/* update memory variables */
+	pUsbParam->mem_base = msc_param.mem_base;
+	pUsbParam->mem_size = msc_param.mem_size;
+
+	return ret;
+}
+
+/* Fetch the pending read-ahead line, flush idle write-back runs */
+void mscDisk_task(void)
+{
+	uint32_t idx;
+
+	/* The USB interrupt is the only other user of the card and the cache. The
+	   transfer primed from the current line keeps running while it is masked. */
+	NVIC_DisableIRQ(LPC_USB_IRQ);
+	if ((g_cache.raBlock != MSC_SD_RA_NONE) && (cache_find(g_cache.raBlock, 1, &idx) == NULL)) {
+		cache_fill(g_cache.raBlock, &idx);
+	}
+	g_cache.raBlock = MSC_SD_RA_NONE;
+
+	if (StopWatch_Elapsed(g_wb.lastWrite) >= StopWatch_MsToTicks(MSC_SD_WB_IDLE_MS)) {
+		wb_flush_all();
+	}
+	NVIC_EnableIRQ(LPC_USB_IRQ);
+}
@@ -241,25 +241,133 @@ void (* const g_pfnVectors[])(void) = {
 // Functions to carry out the initialization of RW and BSS data sections. These
 // are written as separate functions rather than being inlined within the
 // ResetISR() function in order to cope with MCUs with multiple banks of
-// memory.
+// memory. They move 16 bytes per LDM/STM pair, the sections are word
+// aligned and a multiple of 4 bytes long.
 //*****************************************************************************
 __attribute__ ((section(".after_vectors")))
 void data_init(unsigned int romstart, unsigned int start, unsigned int len) {
 	unsigned int *pulDest = (unsigned int*) start;
 	unsigned int *pulSrc = (unsigned int*) romstart;
-	unsigned int loop;
-	for (loop = 0; loop < len; loop = loop + 4)
+	unsigned int loop = len >> 4;
+	if (loop != 0) {
+		__asm volatile (
+			"1:	ldmia	%0!, {r3-r6}\n"
+			"	stmia	%1!, {r3-r6}\n"
+			"	subs	%2, %2, #1\n"
+			"	bne		1b\n"
+			: "+r" (pulSrc), "+r" (pulDest), "+r" (loop)
+			:
+			: "r3", "r4", "r5", "r6", "cc", "memory");
+	}
+	for (loop = len & 0xC; loop != 0; loop = loop - 4)
 		*pulDest++ = *pulSrc++;
 }
 
 __attribute__ ((section(".after_vectors")))
 void bss_init(unsigned int start, unsigned int len) {
 	unsigned int *pulDest = (unsigned int*) start;
-	unsigned int loop;
-	for (loop = 0; loop < len; loop = loop + 4)
+	unsigned int loop = len >> 4;
+	if (loop != 0) {
+		__asm volatile (
+			"	movs	r3, #0\n"
+			"	movs	r4, #0\n"
+			"	movs	r5, #0\n"
+			"	movs	r6, #0\n"
+			"1:	stmia	%0!, {r3-r6}\n"
+			"	subs	%1, %1, #1\n"
+			"	bne		1b\n"
+			: "+r" (pulDest), "+r" (loop)
+			:
+			: "r3", "r4", "r5", "r6", "cc", "memory");
+	}
+	for (loop = len & 0xC; loop != 0; loop = loop - 4)
 		*pulDest++ = 0;
 }
 
+#ifndef DONT_USE_DMA_INIT
+//*****************************************************************************
+// Sections of DMA_INIT_MIN_BYTES or more are copied or cleared by the GPDMA
+// instead, one channel per section. The channels run in parallel with each
+// other and with the CPU doing the smaller sections, which is what makes
+// images with large tables and bss in several RAM banks start faster.
+// Define DONT_USE_DMA_INIT to do all sections with the CPU.
+//
+// As with the reset code, the GPDMA and the CCU are accessed without CMSIS.
+//*****************************************************************************
+#define DMA_INIT_MIN_BYTES 1024
+#define DMA_INIT_CHANNELS  8
+#define DMA_INIT_MAX_WORDS 4095
+
+// LPC_GPDMA->CONFIG @ 0x40002030, channel n registers @ 0x40002100 + n * 0x20
+#define DMA_INIT_CONFIG    (*(volatile unsigned int *) 0x40002030)
+#define DMA_INIT_CH(n)     ((volatile unsigned int *) (0x40002100 + ((n) * 0x20)))
+// LPC_CCU1->CLKCCU[CLK_MX_DMA].CFG @ 0x40051440
+#define DMA_INIT_CLK       (*(volatile unsigned int *) 0x40051440)
+
+// Channel control: 32 bit wide bursts of 32 on AHB master 0, destination
+// increment, plus source increment for a copy
+#define DMA_INIT_CTRL_CLEAR ((4 << 12) | (4 << 15) | (2 << 18) | (2 << 21) | (1UL << 27))
+#define DMA_INIT_CTRL_COPY  (DMA_INIT_CTRL_CLEAR | (1UL << 26))
+
+typedef struct {
+	unsigned int src;	// Next source address, stays put for a clear
+	unsigned int dst;	// Next destination address
+	unsigned int words;	// Words not yet handed to the channel
+	unsigned int ctrl;	// Channel control without the transfer size
+} dma_init_job;
+
+// Source of a clear
+static const unsigned int dma_init_zero = 0;
+
+// Starts the next chunk of at most DMA_INIT_MAX_WORDS of a job
+__attribute__ ((section(".after_vectors")))
+static void dma_init_next(unsigned int ch, dma_init_job *job) {
+	volatile unsigned int *pCh = DMA_INIT_CH(ch);
+	unsigned int words = job->words;
+	if (words > DMA_INIT_MAX_WORDS)
+		words = DMA_INIT_MAX_WORDS;
+
+	pCh[0] = job->src;				// SRCADDR
+	pCh[1] = job->dst;				// DESTADDR
+	pCh[2] = 0;						// LLI, single chunk
+	pCh[3] = job->ctrl | words;		// CONTROL
+	pCh[4] = 1;						// CONFIG, memory to memory and enable
+
+	if (job->ctrl & (1UL << 26))
+		job->src += words * 4;
+	job->dst += words * 4;
+	job->words -= words;
+}
+
+// Hands a section to a channel
+__attribute__ ((section(".after_vectors")))
+static void dma_init_start(unsigned int ch, dma_init_job *job,
+						   unsigned int src, unsigned int dst, unsigned int len) {
+	job->src = src;
+	job->dst = dst;
+	job->words = len >> 2;
+	job->ctrl = (src == (unsigned int) &dma_init_zero) ? DMA_INIT_CTRL_CLEAR : DMA_INIT_CTRL_COPY;
+	dma_init_next(ch, job);
+}
+
+// Restarts the channels that finished a chunk, returns how many are busy
+__attribute__ ((section(".after_vectors")))
+static unsigned int dma_init_poll(dma_init_job *jobs, unsigned int used) {
+	unsigned int ch, busy = 0;
+	for (ch = 0; ch < used; ch++) {
+		// A channel clears its enable bit when the chunk is done
+		if (DMA_INIT_CH(ch)[4] & 1)
+			busy++;
+		else if (jobs[ch].words != 0) {
+			dma_init_next(ch, &jobs[ch]);
+			busy++;
+		}
+	}
+	return busy;
+}
+
+#endif
+
 //*****************************************************************************
 // The following symbols are constructs generated by the linker, indicating
 // the location of various points in the "Global Section Table". This table is
@@ -341,6 +449,14 @@ ResetISR(void) {
     //
 	unsigned int LoadAddr, ExeAddr, SectionLen;
 	unsigned int *SectionTableAddr;
+#ifndef DONT_USE_DMA_INIT
+	dma_init_job DmaJobs[DMA_INIT_CHANNELS];
+	unsigned int DmaUsed = 0;
+
+	// Clock the GPDMA and enable it, little endian masters
+	DMA_INIT_CLK |= 1;
+	DMA_INIT_CONFIG = 1;
+#endif
 
 	// Load base address of Global Section Table
 	SectionTableAddr = &__data_section_table;
@@ -350,15 +466,43 @@ ResetISR(void) {
 		LoadAddr = *SectionTableAddr++;
 		ExeAddr = *SectionTableAddr++;
 		SectionLen = *SectionTableAddr++;
+#ifndef DONT_USE_DMA_INIT
+		if ((SectionLen >= DMA_INIT_MIN_BYTES) && (DmaUsed < DMA_INIT_CHANNELS)) {
+			dma_init_start(DmaUsed, &DmaJobs[DmaUsed], LoadAddr, ExeAddr, SectionLen);
+			DmaUsed++;
+			continue;
+		}
+#endif
 		data_init(LoadAddr, ExeAddr, SectionLen);
+#ifndef DONT_USE_DMA_INIT
+		dma_init_poll(DmaJobs, DmaUsed);
+#endif
 	}
 	// At this point, SectionTableAddr = &__bss_section_table;
 	// Zero fill the bss segment
 	while (SectionTableAddr < &__bss_section_table_end) {
 		ExeAddr = *SectionTableAddr++;
 		SectionLen = *SectionTableAddr++;
+#ifndef DONT_USE_DMA_INIT
+		if ((SectionLen >= DMA_INIT_MIN_BYTES) && (DmaUsed < DMA_INIT_CHANNELS)) {
+			dma_init_start(DmaUsed, &DmaJobs[DmaUsed], (unsigned int) &dma_init_zero, ExeAddr, SectionLen);
+			DmaUsed++;
+			continue;
+		}
+#endif
 		bss_init(ExeAddr, SectionLen);
+#ifndef DONT_USE_DMA_INIT
+		dma_init_poll(DmaJobs, DmaUsed);
+#endif
 	}
+#ifndef DONT_USE_DMA_INIT
+	// Wait for the sections handed to the GPDMA, then leave it disabled
+	// for the application as after reset
+	while (dma_init_poll(DmaJobs, DmaUsed) != 0) {
+		;
+	}
+	DMA_INIT_CONFIG = 0;
+#endif
 
 	// ******************************
 	// Check to see if we are running the code from a non-zero
@@ -363,3 +363,121 @@ uint16_t USB_GetHIDReportSize(HID_ReportInfo_t* const ParserData,
 
 	return 0;
 }
+
+uint8_t USB_CompileHIDReport(HID_ReportInfo_t* const ParserData,
+                             HID_CompiledReport_t* const CompiledData)
+{
+	memset(CompiledData, 0x00, sizeof(HID_CompiledReport_t));
+
+	CompiledData->UsingReportIDs = ParserData->UsingReportIDs;
+
+	for (uint8_t ReportIndex = 0; ReportIndex < ParserData->TotalDeviceReports; ReportIndex++)
+	{
+		HID_ReportSizeInfo_t*   ReportIDInfo = &ParserData->ReportIDSizes[ReportIndex];
+		HID_CompiledReportID_t* Report       = &CompiledData->Reports[CompiledData->TotalReports];
+		uint16_t                ReportBits   = ReportIDInfo->ReportSizeBits[HID_REPORT_ITEM_In];
+
+		if (!(ReportBits))
+		  continue;
+
+		Report->ReportID   = ReportIDInfo->ReportID;
+		Report->FirstField = CompiledData->TotalFields;
+		Report->ReportSize = (ReportBits >> 3) + ((ReportBits & 0x07) != 0);
+
+		for (uint8_t ItemIndex = 0; ItemIndex < ParserData->TotalReportItems; ItemIndex++)
+		{
+			HID_ReportItem_t* ReportItem = &ParserData->ReportItems[ItemIndex];
+			uint8_t           BitSize    = ReportItem->Attributes.BitSize;
+
+			if ((ReportItem->ItemType != HID_REPORT_ITEM_In) || (ReportItem->ReportID != Report->ReportID) ||
+			    (BitSize == 0) || (BitSize > 32))
+			{
+				continue;
+			}
+
+			HID_CompiledField_t* Field = &CompiledData->Fields[CompiledData->TotalFields++];
+
+			Field->Item       = ReportItem;
+			Field->ByteOffset = (ReportItem->BitOffset >> 3);
+			Field->Shift      = (ReportItem->BitOffset & 0x07);
+			Field->ByteCount  = (Field->Shift + BitSize + 7) >> 3;
+			Field->Mask       = (BitSize == 32) ? 0xFFFFFFFF : ((1UL << BitSize) - 1);
+		}
+
+		Report->TotalFields = (CompiledData->TotalFields - Report->FirstField);
+		CompiledData->TotalReports++;
+	}
+
+	return CompiledData->TotalFields;
+}
+
+uint8_t USB_DecodeHIDReport(const HID_CompiledReport_t* const CompiledData,
+                            const uint8_t* ReportData,
+                            uint16_t ReportSize)
+{
+	const HID_CompiledReportID_t* Report = NULL;
+	uint8_t ReportID = 0;
+
+	if (CompiledData->UsingReportIDs)
+	{
+		if (!(ReportSize))
+		  return 0;
+
+		ReportID = *(ReportData++);
+		ReportSize--;
+	}
+
+	for (uint8_t ReportIndex = 0; ReportIndex < CompiledData->TotalReports; ReportIndex++)
+	{
+		if (CompiledData->Reports[ReportIndex].ReportID == ReportID)
+		{
+			Report = &CompiledData->Reports[ReportIndex];
+			break;
+		}
+	}
+
+	if (Report == NULL)
+	  return 0;
+
+	const HID_CompiledField_t* Field   = &CompiledData->Fields[Report->FirstField];
+	uint8_t                    Decoded = 0;
+
+	for (uint8_t FieldsRem = Report->TotalFields; FieldsRem; FieldsRem--, Field++)
+	{
+		if ((Field->ByteOffset + Field->ByteCount) > ReportSize)
+		  continue;
+
+		const uint8_t* FieldData = &ReportData[Field->ByteOffset];
+		uint32_t       Value     = 0;
+
+		/* Gather the (at most four) whole bytes little endian, the fifth only carries the top bits */
+		for (uint8_t i = 0; (i < Field->ByteCount) && (i < 4); i++)
+		  Value |= ((uint32_t)FieldData[i] << (i * 8));
+
+		Value >>= Field->Shift;
+
+		if (Field->ByteCount > 4)
+		  Value |= ((uint32_t)FieldData[4] << (32 - Field->Shift));
+
+		Field->Item->PreviousValue = Field->Item->Value;
+		Field->Item->Value         = (Value & Field->Mask);
+		Decoded++;
+	}
+
+	return Decoded;
+}
+
+HID_ReportItem_t* USB_FindHIDReportItem(const HID_CompiledReport_t* const CompiledData,
+                                        const uint16_t Page,
+                                        const uint16_t Usage)
+{
+	for (uint8_t FieldIndex = 0; FieldIndex < CompiledData->TotalFields; FieldIndex++)
+	{
+		HID_ReportItem_t* ReportItem = CompiledData->Fields[FieldIndex].Item;
+
+		if ((ReportItem->Attributes.Usage.Page == Page) && (ReportItem->Attributes.Usage.Usage == Usage))
+		  return ReportItem;
+	}
+
+	return NULL;
+}
@@ -261,6 +261,46 @@
 				                                      */
 			} HID_ReportInfo_t;
 
+			/** @brief HID Compiled Report Field Structure.
+			 *
+			 *  Type define for the precomputed location of an IN report item, so that its value can be extracted with
+			 *  a single shift and mask instead of a walk over each of its bits.
+			 */
+			typedef struct
+			{
+				HID_ReportItem_t* Item;       /**< Parsed report item the extracted value is stored into. */
+				uint16_t          ByteOffset; /**< Offset of the first report byte holding the item, after any report ID. */
+				uint8_t           Shift;      /**< Bit position of the item within its first byte. */
+				uint8_t           ByteCount;  /**< Number of report bytes the item spans. */
+				uint32_t          Mask;       /**< Mask applied to the shifted value. */
+			} HID_CompiledField_t;
+
+			/** @brief HID Compiled Report ID Structure.
+			 *
+			 *  Type define for a run of compiled fields belonging to one IN report ID.
+			 */
+			typedef struct
+			{
+				uint8_t  ReportID;    /**< Report ID of the run, or 0x00 if the device does not use report IDs. */
+				uint8_t  FirstField;  /**< Index of the first field of the report in the \c Fields array. */
+				uint8_t  TotalFields; /**< Number of fields in the report. */
+				uint16_t ReportSize;  /**< Size in bytes of the report, excluding any report ID byte. */
+			} HID_CompiledReportID_t;
+
+			/** @brief HID Compiled Report Structure.
+			 *
+			 *  Type define for a one-time compiled form of the IN items of a @ref HID_ReportInfo_t structure, with the
+			 *  fields grouped by report ID. Built with @ref USB_CompileHIDReport() after the descriptor has been parsed.
+			 */
+			typedef struct
+			{
+				uint8_t                TotalFields; /**< Total number of fields stored in the \c Fields array. */
+				HID_CompiledField_t    Fields[HID_MAX_REPORTITEMS]; /**< IN item fields, sorted by report ID. */
+				uint8_t                TotalReports; /**< Total number of reports stored in the \c Reports array. */
+				HID_CompiledReportID_t Reports[HID_MAX_REPORT_IDS]; /**< Field runs of each IN report. */
+				bool                   UsingReportIDs; /**< Copy of the parser flag, reports start with an ID byte. */
+			} HID_CompiledReport_t;
+
 		/* Function Prototypes: */
 			/** Function to process a given HID report returned from an attached device, and store it into a given
 			 *  @ref HID_ReportInfo_t structure.
@@ -320,6 +360,48 @@
 			                              const uint8_t ReportID,
 			                              const uint8_t ReportType) ATTR_CONST ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Compiles the IN report items of a parsed HID report descriptor into a table of byte offsets, shifts and
+			 *  masks grouped by report ID. This is done once after @ref USB_ProcessHIDReport(), so that each report
+			 *  received afterwards can be decoded by @ref USB_DecodeHIDReport() without walking the item bits.
+			 *
+			 *  @note The compiled table references the report items of \c ParserData, which must stay valid while the
+			 *        compiled table is in use. Items larger than 32 bits are not compiled.
+			 *
+			 *  @param  ParserData    Pointer to a @ref HID_ReportInfo_t instance containing the parser output.
+			 *  \param[out] CompiledData  Pointer to a @ref HID_CompiledReport_t instance for the compiled output.
+			 *
+			 *  @return Number of fields compiled.
+			 */
+			uint8_t USB_CompileHIDReport(HID_ReportInfo_t* const ParserData,
+			                             HID_CompiledReport_t* const CompiledData) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** Decodes a received IN report through a compiled report table, storing the value of each field of the
+			 *  report into the \c Value member of its report item. The previous value is copied to \c PreviousValue
+			 *  first, as done by @ref USB_GetHIDReportItemInfo(). Fields which do not fit in \c ReportSize are skipped.
+			 *
+			 *  @param CompiledData  Pointer to a @ref HID_CompiledReport_t instance built by @ref USB_CompileHIDReport().
+			 *  @param ReportData    Buffer containing an IN report from an attached device.
+			 *  @param ReportSize    Size in bytes of the received report, including any report ID byte.
+			 *
+			 *  @return Number of report items updated, \c 0 if the report ID is unknown.
+			 */
+			uint8_t USB_DecodeHIDReport(const HID_CompiledReport_t* const CompiledData,
+			                            const uint8_t* ReportData,
+			                            uint16_t ReportSize) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** Looks up the first compiled IN report item with the given usage, so that the application can cache the
+			 *  item once instead of searching for it on each report.
+			 *
+			 *  @param CompiledData  Pointer to a @ref HID_CompiledReport_t instance built by @ref USB_CompileHIDReport().
+			 *  @param Page          Usage page of the item to find.
+			 *  @param Usage         Usage of the item to find.
+			 *
+			 *  @return Pointer to the matching report item, or \c NULL if none was compiled.
+			 */
+			HID_ReportItem_t* USB_FindHIDReportItem(const HID_CompiledReport_t* const CompiledData,
+			                                        const uint16_t Page,
+			                                        const uint16_t Usage) ATTR_NON_NULL_PTR_ARG(1);
+
 			/** Callback routine for the HID Report Parser. This callback <b>must</b> be implemented by the user code when
 			 *  the parser is used, to determine what report IN, OUT and FEATURE item's information is stored into the user
 			 *  @ref HID_ReportInfo_t structure. This can be used to filter only those items the application will be using, so that
@@ -0,0 +1,222 @@
+/*
+ * @brief Common definitions and declarations for the library USB CDC-NCM Class driver
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * Copyright(C) Dean Camera, 2011, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+/** @ingroup Group_USBClassNCM
+ *  @defgroup Group_USBClassNCMCommon  Common Class Definitions
+ *
+ *  @section Sec_ModDescription Module Description
+ *  Constants, Types and Enum definitions that are common to both Device and Host modes for the USB
+ *  CDC-NCM (Network Control Model) Class.
+ *
+ *  @{
+ */
+
+#ifndef _NCM_CLASS_COMMON_H_
+#define _NCM_CLASS_COMMON_H_
+
+	/* Macros: */
+		#define __INCLUDE_FROM_CDC_DRIVER
+
+	/* Includes: */
+		#include "../../Core/StdDescriptors.h"
+		#include "CDCClassCommon.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if !defined(__INCLUDE_FROM_NCM_DRIVER)
+			#error Do not include this file directly. Include LPCUSBlib/Drivers/USB.h instead.
+		#endif
+
+	/* Macros: */
+		/** Additional error code for NCM functions when a frame does not fit, or a received NTB is malformed. */
+		#define NCM_ERROR_LOGICAL_CMD_FAILED          0x80
+
+		/** Implemented NCM specification version, in BCD. */
+		#define NCM_VERSION_BCD                       0x0100
+
+		/** @name NCM Transfer Block Signatures */
+		//@{
+		#define NCM_NTH16_SIGNATURE                   0x484D434EUL /**< "NCMH", 16-bit NTB header. */
+		#define NCM_NDP16_NOCRC_SIGNATURE             0x304D434EUL /**< "NCM0", 16-bit datagram pointer table without CRC. */
+		//@}
+
+		/** @name NCM NTB Format Masks */
+		//@{
+		#define NCM_NTB_FORMAT_16                     (1 << 0)
+		#define NCM_NTB_FORMAT_32                     (1 << 1)
+		//@}
+
+		/** Maximum size in bytes of an Ethernet frame according to the Ethernet standard, including the MAC header. */
+		#define NCM_ETHERNET_FRAME_SIZE_MAX           1514
+
+	/* Enums: */
+		/** Enum for possible Class, Subclass and Protocol values of interface descriptors relating to the CDC-NCM class. */
+		enum NCM_Descriptor_ClassSubclassProtocol_t
+		{
+			NCM_CSCP_NCMSubclass        = 0x0D, /**< Descriptor Subclass value indicating that the communication interface
+			                                     *   belongs to the CDC Network Control Model subclass.
+			                                     */
+			NCM_CSCP_NCMDataProtocol    = 0x01, /**< Descriptor Protocol value indicating that the data interface carries
+			                                     *   NCM Transfer Blocks.
+			                                     */
+		};
+
+		/** Enum for the CDC-NCM class specific functional descriptor subtypes. */
+		enum NCM_DescriptorSubtypes_t
+		{
+			NCM_DSUBTYPE_CSInterface_NCM = 0x1A, /**< NCM functional descriptor. */
+		};
+
+		/** Enum for the CDC-NCM class specific control requests that can be issued by the USB bus host. */
+		enum NCM_ClassRequests_t
+		{
+			NCM_REQ_SetEthernetPacketFilter = 0x43, /**< Sets the Ethernet packet filter bitmap. */
+			NCM_REQ_GetNtbParameters        = 0x80, /**< Returns the NTB parameters of the function. */
+			NCM_REQ_GetNtbFormat            = 0x83, /**< Returns the NTB format currently in use. */
+			NCM_REQ_SetNtbFormat            = 0x84, /**< Selects the NTB format, 16 or 32 bit. */
+			NCM_REQ_GetNtbInputSize         = 0x85, /**< Returns the largest IN NTB the host accepts. */
+			NCM_REQ_SetNtbInputSize         = 0x86, /**< Sets the largest IN NTB the host accepts. */
+			NCM_REQ_GetMaxDatagramSize      = 0x87, /**< Returns the largest datagram of the function. */
+			NCM_REQ_SetMaxDatagramSize      = 0x88, /**< Sets the largest datagram the host will send. */
+		};
+
+		/** Enum for the CDC-NCM class specific notifications that can be issued by a NCM device to a host. */
+		enum NCM_ClassNotifications_t
+		{
+			NCM_NOTIF_NetworkConnection     = 0x00, /**< Link state of the network connection changed. */
+			NCM_NOTIF_ConnectionSpeedChange = 0x2A, /**< Upstream and downstream bit rates of the connection changed. */
+		};
+
+	/* Type Defines: */
+		/** @brief CDC Ethernet Networking Functional Descriptor.
+		 *
+		 *  Type define for the CDC Ethernet networking functional descriptor, carried by both ECM and NCM functions.
+		 *
+		 *  @note Regardless of CPU architecture, these values should be stored as little endian.
+		 */
+		typedef ATTR_IAR_PACKED struct
+		{
+			USB_Descriptor_Header_t Header; /**< Regular descriptor header containing the descriptor's type and length. */
+			uint8_t                 Subtype; /**< Sub type value, must be @ref CDC_DSUBTYPE_CSInterface_Ethernet. */
+			uint8_t                 MACAddressStrIndex; /**< Index of the string descriptor holding the MAC address as 12 hex digits. */
+			uint32_t                EthernetStatistics; /**< Mask of the supported Ethernet statistics. */
+			uint16_t                MaxSegmentSize; /**< Largest Ethernet frame, including the MAC header. */
+			uint16_t                NumberMCFilters; /**< Number of multicast filters supported. */
+			uint8_t                 NumberPowerFilters; /**< Number of wake-up pattern filters supported. */
+		} ATTR_PACKED USB_CDC_Descriptor_FunctionalEthernet_t;
+
+		/** @brief CDC-NCM Functional Descriptor.
+		 *
+		 *  Type define for the NCM functional descriptor, which gives the NCM version and optional requests supported.
+		 *
+		 *  @note Regardless of CPU architecture, these values should be stored as little endian.
+		 */
+		typedef ATTR_IAR_PACKED struct
+		{
+			USB_Descriptor_Header_t Header; /**< Regular descriptor header containing the descriptor's type and length. */
+			uint8_t                 Subtype; /**< Sub type value, must be @ref NCM_DSUBTYPE_CSInterface_NCM. */
+			uint16_t                NCMVersion; /**< Version of the NCM specification implemented, in BCD. */
+			uint8_t                 NetworkCapabilities; /**< Mask of the optional NCM requests supported. */
+		} ATTR_PACKED USB_CDC_Descriptor_FunctionalNCM_t;
+
+		/** @brief NCM NTB Parameter Structure.
+		 *
+		 *  Type define for the response to a @ref NCM_REQ_GetNtbParameters request.
+		 *
+		 *  @note Regardless of CPU architecture, these values should be stored as little endian.
+		 */
+		typedef ATTR_IAR_PACKED struct
+		{
+			uint16_t Length; /**< Size of this structure in bytes. */
+			uint16_t NtbFormatsSupported; /**< Mask of NCM_NTB_FORMAT_* values. */
+			uint32_t NtbInMaxSize; /**< Largest IN NTB the device can build. */
+			uint16_t NdpInDivisor; /**< Modulus IN datagrams are aligned to. */
+			uint16_t NdpInPayloadRemainder; /**< Remainder of IN datagram offsets modulo \c NdpInDivisor. */
+			uint16_t NdpInAlignment; /**< Alignment of IN datagram pointer tables. */
+			uint16_t Reserved;
+			uint32_t NtbOutMaxSize; /**< Largest OUT NTB the device can receive. */
+			uint16_t NdpOutDivisor; /**< Modulus the host should align OUT datagrams to. */
+			uint16_t NdpOutPayloadRemainder; /**< Remainder of OUT datagram offsets modulo \c NdpOutDivisor. */
+			uint16_t NdpOutAlignment; /**< Alignment the host should use for OUT datagram pointer tables. */
+			uint16_t NtbOutMaxDatagrams; /**< Largest number of datagrams in an OUT NTB, 0 for no limit. */
+		} ATTR_PACKED NCM_NTB_Parameters_t;
+
+		/** @brief NCM 16-bit Transfer Block Header.
+		 *
+		 *  Type define for the header starting every 16-bit NCM Transfer Block (NTB).
+		 *
+		 *  @note Regardless of CPU architecture, these values should be stored as little endian.
+		 */
+		typedef ATTR_IAR_PACKED struct
+		{
+			uint32_t Signature; /**< Must be @ref NCM_NTH16_SIGNATURE. */
+			uint16_t HeaderLength; /**< Size of this header in bytes. */
+			uint16_t Sequence; /**< Sequence number of the NTB. */
+			uint16_t BlockLength; /**< Total size of the NTB in bytes. */
+			uint16_t NdpIndex; /**< Offset of the first datagram pointer table in the NTB. */
+		} ATTR_PACKED NCM_NTH16_t;
+
+		/** @brief NCM 16-bit Datagram Pointer.
+		 *
+		 *  Type define for one entry of a 16-bit datagram pointer table, the table ends with an all zero entry.
+		 */
+		typedef ATTR_IAR_PACKED struct
+		{
+			uint16_t DatagramIndex; /**< Offset of the datagram in the NTB. */
+			uint16_t DatagramLength; /**< Length in bytes of the datagram. */
+		} ATTR_PACKED NCM_Datagram_Pointer16_t;
+
+		/** @brief NCM 16-bit Datagram Pointer Table Header.
+		 *
+		 *  Type define for the header of a 16-bit datagram pointer table (NDP), followed by its datagram pointers.
+		 */
+		typedef ATTR_IAR_PACKED struct
+		{
+			uint32_t Signature; /**< Must be @ref NCM_NDP16_NOCRC_SIGNATURE. */
+			uint16_t Length; /**< Size of the table in bytes, including the datagram pointers. */
+			uint16_t NextNdpIndex; /**< Offset of the next table in the NTB, or 0 for the last one. */
+		} ATTR_PACKED NCM_NDP16_t;
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
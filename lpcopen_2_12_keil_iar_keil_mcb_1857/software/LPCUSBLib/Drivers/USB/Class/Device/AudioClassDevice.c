@@ -162,6 +162,13 @@ bool Audio_Device_ConfigureEndpoints(USB_ClassInfo_Audio_Device_t* const AudioIn
 			Type         = EP_TYPE_ISOCHRONOUS;
 			DoubleBanked = true;
 		}
+		else if (EndpointNum == AudioInterfaceInfo->Config.FeedbackEndpointNumber)
+		{
+			Size         = AudioInterfaceInfo->Config.FeedbackEndpointSize;
+			Direction    = ENDPOINT_DIR_IN;
+			Type         = EP_TYPE_ISOCHRONOUS;
+			DoubleBanked = false;
+		}
 		else
 		{
 			continue;
@@ -177,9 +184,121 @@ bool Audio_Device_ConfigureEndpoints(USB_ClassInfo_Audio_Device_t* const AudioIn
 	return true;
 }
 
+void Audio_Device_USBTask(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo)
+{
+	uint8_t portnum = AudioInterfaceInfo->Config.PortNumber;
+
+	if (!(AudioInterfaceInfo->Config.FeedbackEndpointNumber) || (USB_DeviceState[portnum] != DEVICE_STATE_Configured) ||
+	    !(AudioInterfaceInfo->State.InterfaceEnabled))
+	{
+		return;
+	}
+
+	Endpoint_SelectEndpoint(portnum, AudioInterfaceInfo->Config.FeedbackEndpointNumber);
+
+	if (!(Endpoint_IsINReady(portnum)))
+	  return;
+
+	/* Full speed reports 10.14 in three bytes, high speed 16.16 in four */
+	uint32_t Feedback = AudioInterfaceInfo->State.FeedbackValue;
+
+	if (AudioInterfaceInfo->Config.FeedbackEndpointSize == 3)
+	{
+		Feedback >>= 2;
+		Endpoint_Write_8(portnum, Feedback);
+		Endpoint_Write_16_LE(portnum, Feedback >> 8);
+	}
+	else
+	{
+		Endpoint_Write_32_LE(portnum, Feedback);
+	}
+
+	Endpoint_ClearIN(portnum);
+}
+
+uint32_t Audio_Device_FeedbackFromFillLevel(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint32_t NominalRate,
+                                            const uint32_t FillLevel, const uint32_t TargetLevel)
+{
+	int32_t Limit      = (int32_t)(NominalRate >> 4);
+	int32_t Correction = ((int32_t)TargetLevel - (int32_t)FillLevel) << AUDIO_FEEDBACK_GAIN_SHIFT;
+
+	if (Correction > Limit)
+	  Correction = Limit;
+	else if (Correction < -Limit)
+	  Correction = -Limit;
+
+	AudioInterfaceInfo->State.FeedbackValue = (uint32_t)((int32_t)NominalRate + Correction);
+	return AudioInterfaceInfo->State.FeedbackValue;
+}
+
+uint32_t Audio_Device_FeedbackFromClockCount(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint32_t SampleClocks,
+                                             const uint32_t Frames)
+{
+	if (Frames)
+	  AudioInterfaceInfo->State.FeedbackValue = (uint32_t)(((uint64_t)SampleClocks << 16) / Frames);
+
+	return AudioInterfaceInfo->State.FeedbackValue;
+}
+
+static uint32_t Audio_Device_SlotIN(void* pArg, uint8_t* pSlot, uint32_t Length)
+{
+	return CALLBACK_Audio_Device_StreamSlot((USB_ClassInfo_Audio_Device_t*)pArg, ENDPOINT_DIR_IN, pSlot, Length);
+}
+
+static uint32_t Audio_Device_SlotOUT(void* pArg, uint8_t* pSlot, uint32_t Length)
+{
+	return CALLBACK_Audio_Device_StreamSlot((USB_ClassInfo_Audio_Device_t*)pArg, ENDPOINT_DIR_OUT, pSlot, Length);
+}
+
+static void Audio_Device_Xrun(void* pArg, uint8_t Direction)
+{
+	USB_ClassInfo_Audio_Device_t* AudioInterfaceInfo = (USB_ClassInfo_Audio_Device_t*)pArg;
+
+	if (Direction == ENDPOINT_DIR_IN)
+	  AudioInterfaceInfo->State.Underruns++;
+	else
+	  AudioInterfaceInfo->State.Overruns++;
+
+	EVENT_Audio_Device_StreamXrun(AudioInterfaceInfo, Direction);
+}
+
+bool Audio_Device_StartStream(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction,
+                              uint8_t* pRing, const uint16_t SlotSize, const uint8_t NumSlots)
+{
+	uint8_t EndpointNum = (Direction == ENDPOINT_DIR_IN) ? AudioInterfaceInfo->Config.DataINEndpointNumber :
+	                                                       AudioInterfaceInfo->Config.DataOUTEndpointNumber;
+
+	if (!(EndpointNum))
+	  return false;
+
+	return Endpoint_ISORing_Start(AudioInterfaceInfo->Config.PortNumber, EndpointNum, Direction, pRing, SlotSize, NumSlots,
+	                              (Direction == ENDPOINT_DIR_IN) ? Audio_Device_SlotIN : Audio_Device_SlotOUT,
+	                              Audio_Device_Xrun, AudioInterfaceInfo);
+}
+
+void Audio_Device_StopStream(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction)
+{
+	uint8_t EndpointNum = (Direction == ENDPOINT_DIR_IN) ? AudioInterfaceInfo->Config.DataINEndpointNumber :
+	                                                       AudioInterfaceInfo->Config.DataOUTEndpointNumber;
+
+	if (EndpointNum)
+	  Endpoint_ISORing_Stop(AudioInterfaceInfo->Config.PortNumber, EndpointNum, Direction);
+}
+
 void Audio_Device_Event_Stub(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo)
 {
 
 }
 
+void Audio_Device_Xrun_Stub(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction)
+{
+
+}
+
+uint32_t Audio_Device_Slot_Stub(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction,
+                                uint8_t* pSlot, const uint32_t Length)
+{
+	return 0;
+}
+
 #endif
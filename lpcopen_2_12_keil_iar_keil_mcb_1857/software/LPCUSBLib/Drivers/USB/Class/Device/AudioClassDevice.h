@@ -61,6 +61,14 @@
 		#endif
 
 	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			#if !defined(AUDIO_FEEDBACK_GAIN_SHIFT) || defined(__DOXYGEN__)
+				/** Loop gain of @ref Audio_Device_FeedbackFromFillLevel(), each sample of fill level error moves the 16.16 feedback
+				 *  value by 2^AUDIO_FEEDBACK_GAIN_SHIFT.
+				 */
+				#define AUDIO_FEEDBACK_GAIN_SHIFT    6
+			#endif
+
 		/* Type Defines: */
 			/** @brief Audio Class Device Mode Configuration and State Structure.
 			 *
@@ -93,6 +101,13 @@
 												   *   (zero if unused).
 												   */
 					uint8_t  PortNumber;				/**< Port number that this interface is running.*/
+
+					uint8_t  FeedbackEndpointNumber; /**< Endpoint number of the explicit feedback endpoint of an asynchronous
+					                                  *   OUT stream, if available (zero if unused).
+					                                  */
+					uint8_t  FeedbackEndpointSize; /**< Size in bytes of the feedback endpoint, 3 for the full speed 10.14
+					                                *   format or 4 for the high speed 16.16 format.
+					                                */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
@@ -101,6 +116,9 @@
 					bool InterfaceEnabled; /**< Set and cleared by the class driver to indicate if the host has enabled the streaming endpoints
 					                        *   of the Audio Streaming interface.
 					                        */
+					uint32_t Underruns; /**< IN slot ring underruns, see @ref Audio_Device_StartStream(). */
+					uint32_t Overruns; /**< OUT slot ring overruns, see @ref Audio_Device_StartStream(). */
+					uint32_t FeedbackValue; /**< Samples per (micro)frame in 16.16 fixed point, reported on the feedback endpoint. */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -166,22 +184,93 @@
 			 */
 			void EVENT_Audio_Device_StreamStartStop(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo);
 
-		/* Inline Functions: */
+			/**
+			 * @brief	Starts a continuous isochronous slot ring on the given Audio interface's streaming endpoint. Completed slots are
+			 *  handed to @ref CALLBACK_Audio_Device_StreamSlot() from the USB interrupt and queued again at once, so the stream keeps
+			 *  running while the application is late. Only the LPC18xx/43xx device controller supports slot rings.
+			 *
+			 * @param	AudioInterfaceInfo	: Pointer to a structure containing an Audio Class configuration and state.
+			 * @param	Direction			: ENDPOINT_DIR_IN for the DataIN endpoint, ENDPOINT_DIR_OUT for the DataOUT endpoint.
+			 * @param	pRing				: Slot buffers, NumSlots * SlotSize bytes in USB accessible RAM.
+			 * @param	SlotSize			: Bytes per slot, one slot per (micro)frame.
+			 * @param	NumSlots			: Ring depth in slots.
+			 * @return	Boolean \c true if the ring was started, \c false otherwise.
+			 */
+			bool Audio_Device_StartStream(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction,
+			                              uint8_t* pRing, const uint16_t SlotSize, const uint8_t NumSlots) ATTR_NON_NULL_PTR_ARG(1);
+
+			/**
+			 * @brief	Stops a slot ring started with @ref Audio_Device_StartStream().
+			 *
+			 * @param	AudioInterfaceInfo	: Pointer to a structure containing an Audio Class configuration and state.
+			 * @param	Direction			: ENDPOINT_DIR_IN or ENDPOINT_DIR_OUT.
+			 * @return	Nothing
+			 */
+			void Audio_Device_StopStream(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction) ATTR_NON_NULL_PTR_ARG(1);
+
+			/**
+			 * @brief	Audio class driver callback for a slot ring. For the OUT ring, @a pSlot holds @a Length received bytes and the
+			 *  callback returns the number of bytes consumed. For the IN ring, the callback fills @a pSlot with at most @a Length
+			 *  bytes and returns the number of bytes to send. Called from the USB interrupt.
+			 *
+			 * @param	AudioInterfaceInfo	: Pointer to a structure containing an Audio Class configuration and state.
+			 * @param	Direction			: ENDPOINT_DIR_IN or ENDPOINT_DIR_OUT.
+			 * @param	pSlot				: Slot buffer.
+			 * @param	Length				: Received bytes (OUT) or slot size (IN).
+			 * @return	Bytes consumed (OUT) or bytes to send (IN).
+			 */
+			uint32_t CALLBACK_Audio_Device_StreamSlot(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction,
+			                                          uint8_t* pSlot, const uint32_t Length);
+
+			/**
+			 * @brief	Audio class driver event for a slot ring underrun (IN) or overrun (OUT). The running counts are kept in
+			 *  State.Underruns and State.Overruns. Fired from the USB interrupt.
+			 *
+			 * @param	AudioInterfaceInfo	: Pointer to a structure containing an Audio Class configuration and state.
+			 * @param	Direction			: ENDPOINT_DIR_IN or ENDPOINT_DIR_OUT.
+			 * @return	Nothing
+			 */
+			void EVENT_Audio_Device_StreamXrun(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction);
+
 			/**
 			 * @brief	General management task for a given Audio class interface, required for the correct operation of the interface. This should
-			 *  be called frequently in the main program loop, before the master USB management task @ref USB_USBTask().
+			 *  be called frequently in the main program loop, before the master USB management task @ref USB_USBTask(). When a feedback
+			 *  endpoint is configured, this reports State.FeedbackValue to the host once per feedback interval.
 			 *
 			 * @param	AudioInterfaceInfo	: Pointer to a structure containing an Audio Class configuration and state.
 			 * @return	Nothing
 			 */
-PRAGMA_ALWAYS_INLINE
-			static inline void Audio_Device_USBTask(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo)
-			                                        ATTR_NON_NULL_PTR_ARG(1) ATTR_ALWAYS_INLINE;
-			static inline void Audio_Device_USBTask(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo)
-			{
-				(void)AudioInterfaceInfo;
-			}
+			void Audio_Device_USBTask(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+			/**
+			 * @brief	Derives the feedback value of an asynchronous OUT stream from the fill level of the buffer between USB and the
+			 *  codec (for example the application's sample FIFO ahead of the I2S DMA). A level above the target slows the host down, a
+			 *  level below speeds it up; the correction is limited to 1/16th of the nominal rate. The result is stored in
+			 *  State.FeedbackValue.
+			 *
+			 * @param	AudioInterfaceInfo	: Pointer to a structure containing an Audio Class configuration and state.
+			 * @param	NominalRate			: Nominal samples per (micro)frame in 16.16 fixed point, e.g. 48 << 16 for 48kHz at full speed.
+			 * @param	FillLevel			: Samples currently buffered.
+			 * @param	TargetLevel			: Samples the buffer should settle at, usually half its depth.
+			 * @return	The new feedback value.
+			 */
+			uint32_t Audio_Device_FeedbackFromFillLevel(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint32_t NominalRate,
+			                                            const uint32_t FillLevel, const uint32_t TargetLevel) ATTR_NON_NULL_PTR_ARG(1);
+
+			/**
+			 * @brief	Derives the feedback value of an asynchronous OUT stream from a count of codec sample clocks, for example the
+			 *  difference of two SCT captures of the I2S word select taken a number of SOFs apart. A master clock count should be
+			 *  divided down to samples by the caller first. The result is stored in State.FeedbackValue.
+			 *
+			 * @param	AudioInterfaceInfo	: Pointer to a structure containing an Audio Class configuration and state.
+			 * @param	SampleClocks		: Codec samples counted over the measurement period.
+			 * @param	Frames				: (Micro)frames in the measurement period, a power of two keeps the division cheap.
+			 * @return	The new feedback value.
+			 */
+			uint32_t Audio_Device_FeedbackFromClockCount(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint32_t SampleClocks,
+			                                             const uint32_t Frames) ATTR_NON_NULL_PTR_ARG(1);
 
+		/* Inline Functions: */
 			/**
 			 * @brief	Determines if the given audio interface is ready for a sample to be read from it, and selects the streaming
 			 *  OUT endpoint ready for reading.
@@ -379,6 +468,16 @@ PRAGMA_ALWAYS_INLINE
 PRAGMA_WEAK(EVENT_Audio_Device_StreamStartStop,Audio_Device_Event_Stub)				
 				void EVENT_Audio_Device_StreamStartStop(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo)
 				                                        ATTR_WEAK ATTR_NON_NULL_PTR_ARG(1) ATTR_ALIAS(Audio_Device_Event_Stub);
+				void Audio_Device_Xrun_Stub(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction);
+PRAGMA_WEAK(EVENT_Audio_Device_StreamXrun,Audio_Device_Xrun_Stub)
+				void EVENT_Audio_Device_StreamXrun(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction)
+				                                   ATTR_WEAK ATTR_NON_NULL_PTR_ARG(1) ATTR_ALIAS(Audio_Device_Xrun_Stub);
+				uint32_t Audio_Device_Slot_Stub(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction,
+				                                uint8_t* pSlot, const uint32_t Length) ATTR_CONST;
+PRAGMA_WEAK(CALLBACK_Audio_Device_StreamSlot,Audio_Device_Slot_Stub)
+				uint32_t CALLBACK_Audio_Device_StreamSlot(USB_ClassInfo_Audio_Device_t* const AudioInterfaceInfo, const uint8_t Direction,
+				                                          uint8_t* pSlot, const uint32_t Length)
+				                                          ATTR_WEAK ATTR_NON_NULL_PTR_ARG(1) ATTR_ALIAS(Audio_Device_Slot_Stub);
 			#endif
 
 	#endif	
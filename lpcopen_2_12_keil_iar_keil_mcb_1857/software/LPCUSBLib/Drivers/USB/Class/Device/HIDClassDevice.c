@@ -152,11 +152,102 @@ bool HID_Device_ConfigureEndpoints(USB_ClassInfo_HID_Device_t* const HIDInterfac
 	return true;
 }
 
+#if defined(__LPC18XX__) || defined(__LPC43XX__)
+/* Compares a new report against the previous one, a word at a time, stopping at the first difference */
+static bool HID_Device_ReportChanged(const uint8_t* New,
+                                     const uint8_t* Prev,
+                                     uint16_t Size)
+{
+	const uint32_t* NewWord  = (const uint32_t*)New;
+	const uint32_t* PrevWord = (const uint32_t*)Prev;
+
+	for (; Size >= 4; Size -= 4)
+	{
+		if (*NewWord++ != *PrevWord++)
+		  return true;
+	}
+
+	New  = (const uint8_t*)NewWord;
+	Prev = (const uint8_t*)PrevWord;
+
+	while (Size--)
+	{
+		if (*New++ != *Prev++)
+		  return true;
+	}
+
+	return false;
+}
+
+/* Called from the USB interrupt as each queued report leaves the endpoint */
+static void HID_Device_ReportSent(void* pArg,
+                                  uint32_t Length,
+                                  DCD_TRANSFER_STATUS Status)
+{
+	USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo = (USB_ClassInfo_HID_Device_t*)pArg;
+
+	(void)Length;
+
+	/* Cancelled reports belong to an endpoint that is being reconfigured, whose state has been reset */
+	if (Status != DCD_TRANSFER_CANCELLED)
+	  HIDInterfaceInfo->State.ReportINSent++;
+}
+
+static void HID_Device_USBTask_DoubleBuffered(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
+{
+	uint8_t  Fill       = HIDInterfaceInfo->State.ReportINFill;
+	uint16_t SlotSize   = HID_DEVICE_REPORT_SLOT_SIZE(HIDInterfaceInfo->Config.PrevReportINBufferSize);
+	uint8_t* Slot       = (uint8_t*)HIDInterfaceInfo->Config.ReportINDoubleBuffer + (Fill * SlotSize);
+	uint8_t* PrevSlot   = (uint8_t*)HIDInterfaceInfo->Config.ReportINDoubleBuffer + ((Fill ^ 1) * SlotSize);
+	uint8_t  ReportID   = 0;
+	uint16_t ReportINSize = 0;
+	uint8_t  PhyEP      = (2 * (HIDInterfaceInfo->Config.ReportINEndpointNumber & ENDPOINT_EPNUM_MASK)) + 1;
+
+	/* Both buffers still on the endpoint, the host has not polled yet */
+	if ((uint8_t)(HIDInterfaceInfo->State.ReportINQueued - HIDInterfaceInfo->State.ReportINSent) >= 2)
+	  return;
+
+	memset(&Slot[4], 0, HIDInterfaceInfo->Config.PrevReportINBufferSize);
+
+	bool ForceSend         = CALLBACK_HID_Device_CreateHIDReport(HIDInterfaceInfo, &ReportID, HID_REPORT_ITEM_In,
+	                                                             &Slot[4], &ReportINSize);
+	bool IdlePeriodElapsed = (HIDInterfaceInfo->State.IdleCount && !(HIDInterfaceInfo->State.IdleMSRemaining));
+	bool StatesChanged     = ((ReportID != HIDInterfaceInfo->State.ReportINID[Fill ^ 1]) ||
+	                          (ReportINSize != HIDInterfaceInfo->State.ReportINSize[Fill ^ 1]) ||
+	                          HID_Device_ReportChanged(&Slot[4], &PrevSlot[4], ReportINSize));
+
+	if (ReportINSize && (ForceSend || StatesChanged || IdlePeriodElapsed))
+	{
+		uint8_t* Report = ReportID ? &Slot[3] : &Slot[4];
+
+		Slot[3] = ReportID;
+
+		if (DcdQueueTransfer(HIDInterfaceInfo->Config.PortNumber, PhyEP, Report, ReportINSize + (ReportID ? 1 : 0),
+		                     HID_Device_ReportSent, HIDInterfaceInfo))
+		{
+			HIDInterfaceInfo->State.IdleMSRemaining = HIDInterfaceInfo->State.IdleCount;
+			HIDInterfaceInfo->State.ReportINID[Fill]   = ReportID;
+			HIDInterfaceInfo->State.ReportINSize[Fill] = ReportINSize;
+			HIDInterfaceInfo->State.ReportINQueued++;
+			HIDInterfaceInfo->State.ReportINFill ^= 1;
+		}
+	}
+}
+#endif
+
 void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 {
 	if (USB_DeviceState[HIDInterfaceInfo->Config.PortNumber] != DEVICE_STATE_Configured)
 	  return;
 
+#if defined(__LPC18XX__) || defined(__LPC43XX__)
+	if (HIDInterfaceInfo->Config.ReportINDoubleBuffer != NULL)
+	{
+		HID_Device_USBTask_DoubleBuffered(HIDInterfaceInfo);
+		return;
+	}
+#endif
+
 	Endpoint_SelectEndpoint(HIDInterfaceInfo->Config.PortNumber, HIDInterfaceInfo->Config.ReportINEndpointNumber);
 
 	if (Endpoint_IsReadWriteAllowed(HIDInterfaceInfo->Config.PortNumber))
@@ -61,6 +61,13 @@ extern "C" {
 		#endif
 
 /* Public Interface - May be used in end-application: */
+/* Macros: */
+/** Bytes taken by each buffer of the double buffered mode: a word for the report ID followed by the report */
+#define HID_DEVICE_REPORT_SLOT_SIZE(ReportSize)            (4 + (((ReportSize) + 3) & ~3))
+
+/** Storage needed by @c ReportINDoubleBuffer for input reports of up to @a ReportSize bytes */
+#define HID_DEVICE_REPORT_DOUBLE_BUFFER_SIZE(ReportSize)   (2 * HID_DEVICE_REPORT_SLOT_SIZE(ReportSize))
+
 /* Type Defines: */
 /** @brief HID Class Device Mode Configuration and State Structure.
  *
@@ -99,6 +106,17 @@ typedef struct {
 													 *  set to the size of the largest report the device can issue to the host.
 													 */
 		uint8_t  PortNumber;				/**< Port number that this interface is running.*/
+
+		void *ReportINDoubleBuffer;				/**< Pointer to word aligned, USB DMA reachable storage of
+												 *  @ref HID_DEVICE_REPORT_DOUBLE_BUFFER_SIZE(\c PrevReportINBufferSize) bytes
+												 *  to send input reports double buffered, or \c NULL to send them through the
+												 *  shared endpoint buffer. In this mode the next report is built while the
+												 *  previous one is still queued on the endpoint, so a report is ready at every
+												 *  polling interval. Change detection compares against the other buffer, taking
+												 *  report IDs into account, and @ref PrevReportINBuffer is not used by it.
+												 *
+												 * @note Only supported on LPC18xx/43xx, ignored on other devices.
+												 */
 	} Config;				/**< Config data for the USB class interface within the device. All elements in this section
 							 *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 							 */
@@ -108,6 +126,11 @@ typedef struct {
 		uint16_t IdleCount;				/**< Report idle period, in milliseconds, set by the host. */
 		uint16_t IdleMSRemaining;				/**< Total number of milliseconds remaining before the idle period elapsed - this
 												 *   should be decremented by the user application if non-zero each millisecond. */
+		uint8_t  ReportINFill;				/**< Double buffered mode: index of the buffer the next report is built in. */
+		uint8_t  ReportINQueued;				/**< Double buffered mode: count of reports queued on the endpoint. */
+		volatile uint8_t ReportINSent;				/**< Double buffered mode: count of queued reports that have completed. */
+		uint8_t  ReportINID[2];				/**< Double buffered mode: report ID held in each buffer. */
+		uint16_t ReportINSize[2];				/**< Double buffered mode: report size held in each buffer, zero if none. */
 	} State;			/**< State data for the USB class interface within the device. All elements in this section
 						 *   are reset to their defaults when the interface is enumerated.
 						 */
@@ -42,7 +42,7 @@
 
 bool MIDI_Device_ConfigureEndpoints(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
 {
-	// memset(&MIDIInterfaceInfo->State, 0x00, sizeof(MIDIInterfaceInfo->State));
+	memset(&MIDIInterfaceInfo->State, 0x00, sizeof(MIDIInterfaceInfo->State));
 
 	for (uint8_t EndpointNum = 1; EndpointNum < ENDPOINT_TOTAL_ENDPOINTS(MIDIInterfaceInfo->Config.PortNumber); EndpointNum++)
 	{
@@ -85,6 +85,12 @@ void MIDI_Device_USBTask(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
 	if (USB_DeviceState[MIDIInterfaceInfo->Config.PortNumber] != DEVICE_STATE_Configured)
 	  return;
 
+	if (MIDIInterfaceInfo->State.BatchCount &&
+	    (MIDIInterfaceInfo->State.BatchAge >= MIDIInterfaceInfo->Config.BatchDeadlineMS))
+	{
+		MIDI_Device_SendBatch(MIDIInterfaceInfo);
+	}
+
 	#if !defined(NO_CLASS_DRIVER_AUTOFLUSH)
 	MIDI_Device_Flush(MIDIInterfaceInfo);
 	#endif
@@ -109,6 +115,25 @@ uint8_t MIDI_Device_SendEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInter
 	return ENDPOINT_RWSTREAM_NoError;
 }
 
+uint8_t MIDI_Device_QueueEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo,
+                                     const MIDI_EventPacket_t* const Event)
+{
+	if (USB_DeviceState[MIDIInterfaceInfo->Config.PortNumber] != DEVICE_STATE_Configured)
+	  return ENDPOINT_RWSTREAM_DeviceDisconnected;
+
+	uint8_t BatchLimit = MIN(MIDI_DEVICE_BATCH_EVENTS, MIDIInterfaceInfo->Config.DataINEndpointSize / sizeof(MIDI_EventPacket_t));
+
+	if (!(MIDIInterfaceInfo->State.BatchCount))
+	  MIDIInterfaceInfo->State.BatchAge = 0;
+
+	MIDIInterfaceInfo->State.BatchEvents[MIDIInterfaceInfo->State.BatchCount++] = *Event;
+
+	if (MIDIInterfaceInfo->State.BatchCount >= BatchLimit)
+	  return MIDI_Device_SendBatch(MIDIInterfaceInfo);
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
 uint8_t MIDI_Device_Flush(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
 {
 	if (USB_DeviceState[MIDIInterfaceInfo->Config.PortNumber] != DEVICE_STATE_Configured)
@@ -116,6 +141,12 @@ uint8_t MIDI_Device_Flush(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
 
 	uint8_t ErrorCode;
 
+	if (MIDIInterfaceInfo->State.BatchCount)
+	{
+		if ((ErrorCode = MIDI_Device_SendBatch(MIDIInterfaceInfo)) != ENDPOINT_RWSTREAM_NoError)
+		  return ErrorCode;
+	}
+
 	Endpoint_SelectEndpoint(MIDIInterfaceInfo->Config.PortNumber, MIDIInterfaceInfo->Config.DataINEndpointNumber);
 
 	if (Endpoint_BytesInEndpoint(MIDIInterfaceInfo->Config.PortNumber))
@@ -148,5 +179,34 @@ bool MIDI_Device_ReceiveEventPacket(USB_ClassInfo_MIDI_Device_t* const MIDIInter
 	return true;
 }
 
+static uint8_t MIDI_Device_SendBatch(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
+{
+	uint8_t portnum = MIDIInterfaceInfo->Config.PortNumber;
+	uint8_t ErrorCode;
+
+	Endpoint_SelectEndpoint(portnum, MIDIInterfaceInfo->Config.DataINEndpointNumber);
+
+	/* Events left in the bank by MIDI_Device_SendEventPacket() go first, so the batch starts on a packet boundary */
+	if (Endpoint_BytesInEndpoint(portnum))
+	{
+		Endpoint_ClearIN(portnum);
+
+		if ((ErrorCode = Endpoint_WaitUntilReady()) != ENDPOINT_READYWAIT_NoError)
+		  return ErrorCode;
+	}
+
+	if ((ErrorCode = Endpoint_Write_Stream_LE(portnum, MIDIInterfaceInfo->State.BatchEvents,
+	                                          MIDIInterfaceInfo->State.BatchCount * sizeof(MIDI_EventPacket_t), NULL)) != ENDPOINT_RWSTREAM_NoError)
+	{
+		return ErrorCode;
+	}
+
+	Endpoint_ClearIN(portnum);
+
+	MIDIInterfaceInfo->State.BatchCount = 0;
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
 #endif
 
@@ -61,6 +61,14 @@ extern "C" {
 		#endif
 
 /* Public Interface - May be used in end-application: */
+/* Macros: */
+		#if !defined(MIDI_DEVICE_BATCH_EVENTS) || defined(__DOXYGEN__)
+/** Number of events @ref MIDI_Device_QueueEventPacket() can hold back, 16 fills a full speed packet, raise it to 128 to
+ *  fill a 512 byte high speed packet.
+ */
+			#define MIDI_DEVICE_BATCH_EVENTS    16
+		#endif
+
 /* Type Define: */
 /**
  * @brief MIDI Class Device Mode Configuration and State Structure.
@@ -81,18 +89,21 @@ typedef struct {
 		uint16_t DataOUTEndpointSize;				/**< Size in bytes of the outgoing MIDI OUT data endpoint, if available (zero if unused). */
 		bool     DataOUTEndpointDoubleBank;				/**< Indicates if the MIDI interface's OUT data endpoint should use double banking. */
 		uint8_t  PortNumber;				/**< Port number that this interface is running.*/
+
+		uint8_t  BatchDeadlineMS;				/**< Longest time in milliseconds an event queued by @ref MIDI_Device_QueueEventPacket()
+												 *   is held back, zero sends the queue on every @ref MIDI_Device_USBTask() call.
+												 */
 	} Config;				/**< Config data for the USB class interface within the device. All elements in this section
 							 *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 							 */
 
-#if 0
 	struct {
-		// No state information for this class
+		MIDI_EventPacket_t BatchEvents[MIDI_DEVICE_BATCH_EVENTS];	/**< Events queued by @ref MIDI_Device_QueueEventPacket(). */
+		uint8_t  BatchCount;				/**< Number of events in \c BatchEvents. */
+		uint8_t  BatchAge;					/**< Milliseconds the oldest queued event has waited. */
 	} State;			/**< State data for the USB class interface within the device. All elements in this section
 						 *   are reset to their defaults when the interface is enumerated.
 						 */
-
-#endif
 } USB_ClassInfo_MIDI_Device_t;
 
 /* Function Prototypes: */
@@ -133,9 +144,27 @@ uint8_t MIDI_Device_SendEventPacket(USB_ClassInfo_MIDI_Device_t *const MIDIInter
 									const MIDI_EventPacket_t *const Event) ATTR_NON_NULL_PTR_ARG(1)
 ATTR_NON_NULL_PTR_ARG(2);
 
+/**
+ * @brief	Queues a MIDI event packet for batched transmission. Events are held in the interface state until a full endpoint
+ *  packet's worth has been queued, which is then sent in a single transaction, or until the oldest event has waited
+ *  \c BatchDeadlineMS milliseconds, after which @ref MIDI_Device_USBTask() sends the partial batch. Dense event streams such as
+ *  controller sweeps therefore use a fraction of the transactions of @ref MIDI_Device_SendEventPacket().
+ *
+ *  @pre This function must only be called when the Device state machine is in the @ref DEVICE_STATE_Configured state or the
+ *       call will fail.
+ *
+ * @param	MIDIInterfaceInfo	: Pointer to a structure containing a MIDI Class configuration and state.
+ * @param	Event	: Pointer to a populated @ref MIDI_EventPacket_t structure containing the MIDI event to send.
+ *
+ * @return	A value from the @ref Endpoint_Stream_RW_ErrorCodes_t enum.
+ */
+uint8_t MIDI_Device_QueueEventPacket(USB_ClassInfo_MIDI_Device_t *const MIDIInterfaceInfo,
+									 const MIDI_EventPacket_t *const Event) ATTR_NON_NULL_PTR_ARG(1)
+ATTR_NON_NULL_PTR_ARG(2);
+
 /**
  * @brief	Flushes the MIDI send buffer, sending any queued MIDI events to the host. This should be called to override the
- *  @ref MIDI_Device_SendEventPacket() function's packing behaviour, to flush queued events.
+ *  @ref MIDI_Device_SendEventPacket() and @ref MIDI_Device_QueueEventPacket() functions' packing behaviour, to flush queued events.
  *
  * @param	MIDIInterfaceInfo	: Pointer to a structure containing a MIDI Class configuration and state.
  *
@@ -173,6 +202,33 @@ static inline void MIDI_Device_ProcessControlRequest(USB_ClassInfo_MIDI_Device_t
 	(void) MIDIInterfaceInfo;
 }
 
+/**
+ * @brief	Indicates that a millisecond has elapsed on the given MIDI interface, ageing the events queued by
+ *  @ref MIDI_Device_QueueEventPacket(). This should be called once per millisecond when \c BatchDeadlineMS is used, it is
+ *  recommended that this be called by the @ref EVENT_USB_Device_StartOfFrame() event, once SOF events have been enabled via
+ *  @ref USB_Device_EnableSOFEvents().
+ *
+ * @param	MIDIInterfaceInfo	: Pointer to a structure containing a MIDI Class configuration and state.
+ */
+PRAGMA_ALWAYS_INLINE
+static inline void MIDI_Device_MillisecondElapsed(USB_ClassInfo_MIDI_Device_t *const MIDIInterfaceInfo) ATTR_ALWAYS_INLINE
+ATTR_NON_NULL_PTR_ARG(1);
+static inline void MIDI_Device_MillisecondElapsed(USB_ClassInfo_MIDI_Device_t *const MIDIInterfaceInfo)
+{
+	if (MIDIInterfaceInfo->State.BatchCount && (MIDIInterfaceInfo->State.BatchAge != 0xFF)) {
+		MIDIInterfaceInfo->State.BatchAge++;
+	}
+}
+
+/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+/* Function Prototypes: */
+		#if defined(__INCLUDE_FROM_MIDI_DEVICE_C)
+static uint8_t MIDI_Device_SendBatch(USB_ClassInfo_MIDI_Device_t *const MIDIInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+		#endif
+	#endif
+
 /* Disable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
 }
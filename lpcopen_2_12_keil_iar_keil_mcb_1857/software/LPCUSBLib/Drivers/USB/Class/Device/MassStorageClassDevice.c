@@ -243,4 +243,162 @@ static void MS_Device_ReturnCommandStatus(USB_ClassInfo_MS_Device_t* const MSInt
 	Endpoint_ClearIN(MSInterfaceInfo->Config.PortNumber);
 }
 
+#if defined(__LPC18XX__) || defined(__LPC43XX__)
+static void MS_Device_BlockTransferDone(void* pArg,
+                                        uint32_t Length,
+                                        DCD_TRANSFER_STATUS Status)
+{
+	MS_Device_BlockStream_t* const Stream = (MS_Device_BlockStream_t*)pArg;
+
+	/* Cancelled transfers are only seen once the stream has been abandoned */
+	if (Status == DCD_TRANSFER_CANCELLED)
+	  return;
+
+	if (Status != DCD_TRANSFER_OK)
+	  Stream->Failed = true;
+
+	Stream->Length[Stream->Done & 1] = Length;
+	Stream->Bytes += Length;
+	Stream->Done++;
+}
+
+/* Waits until no more than MaxPending of the queued transfers are still on the endpoint */
+static bool MS_Device_WaitBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                                 MS_Device_BlockStream_t* const Stream,
+                                 const uint8_t Queued,
+                                 const uint8_t MaxPending)
+{
+	while ((uint8_t)(Queued - Stream->Done) > MaxPending)
+	{
+		#if !defined(INTERRUPT_CONTROL_ENDPOINT)
+		USB_USBTask(MSInterfaceInfo->Config.PortNumber,USB_MODE_Device);
+		#endif
+
+		if (MSInterfaceInfo->State.IsMassStoreReset ||
+		    (USB_DeviceState[MSInterfaceInfo->Config.PortNumber] == DEVICE_STATE_Unattached) ||
+		    (USB_DeviceState[MSInterfaceInfo->Config.PortNumber] == DEVICE_STATE_Suspended))
+		{
+			return false;
+		}
+	}
+
+	return !(Stream->Failed);
+}
+
+bool MS_Device_SendBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                          const uint32_t BlockAddress,
+                          const uint16_t TotalBlocks,
+                          const uint16_t BlockSize,
+                          uint8_t* const Buffer,
+                          const uint32_t BufferSize,
+                          MS_Device_BlockCallback_t Callback,
+                          void* const CallbackArg)
+{
+	uint8_t  portnum     = MSInterfaceInfo->Config.PortNumber;
+	uint8_t  PhyEP       = (2 * (MSInterfaceInfo->Config.DataINEndpointNumber & ENDPOINT_EPNUM_MASK)) + 1;
+	uint16_t ChunkBlocks = BlockSize ? (MIN(BufferSize / 2, ENDPOINT_DMA_MAX_XFER) / BlockSize) : 0;
+	uint32_t Block       = BlockAddress;
+	uint16_t BlocksRem   = TotalBlocks;
+	uint8_t  Queued      = 0;
+	bool     Success     = (ChunkBlocks != 0) && ENDPOINT_DMA_CAPABLE(Buffer);
+	MS_Device_BlockStream_t Stream;
+
+	memset(&Stream, 0x00, sizeof(Stream));
+
+	while (Success && BlocksRem)
+	{
+		uint16_t Blocks = MIN(BlocksRem, ChunkBlocks);
+		uint8_t* Chunk  = &Buffer[(uint32_t)(Queued & 1) * ChunkBlocks * BlockSize];
+
+		/* The half to fill is free once at most one transfer is left on the endpoint */
+		Success = MS_Device_WaitBlocks(MSInterfaceInfo, &Stream, Queued, 1) &&
+		          Callback(MSInterfaceInfo, CallbackArg, Chunk, Block, Blocks) &&
+		          DcdQueueTransfer(portnum, PhyEP, Chunk, (uint32_t)Blocks * BlockSize, MS_Device_BlockTransferDone, &Stream);
+
+		if (Success)
+		{
+			Queued++;
+			Block     += Blocks;
+			BlocksRem -= Blocks;
+		}
+	}
+
+	if (Success)
+	  Success = MS_Device_WaitBlocks(MSInterfaceInfo, &Stream, Queued, 0);
+
+	/* Cancels whatever is left and hands the endpoint back to the shared buffer for the status wrapper */
+	DcdQueueFlush(portnum, PhyEP);
+
+	MSInterfaceInfo->State.CommandBlock.DataTransferLength =
+		cpu_to_le32(le32_to_cpu(MSInterfaceInfo->State.CommandBlock.DataTransferLength) - Stream.Bytes);
+
+	return Success;
+}
+
+bool MS_Device_ReceiveBlocks(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+                             const uint32_t BlockAddress,
+                             const uint16_t TotalBlocks,
+                             const uint16_t BlockSize,
+                             uint8_t* const Buffer,
+                             const uint32_t BufferSize,
+                             MS_Device_BlockCallback_t Callback,
+                             void* const CallbackArg)
+{
+	uint8_t  portnum      = MSInterfaceInfo->Config.PortNumber;
+	uint8_t  PhyEP        = 2 * (MSInterfaceInfo->Config.DataOUTEndpointNumber & ENDPOINT_EPNUM_MASK);
+	uint16_t ChunkBlocks  = BlockSize ? (MIN(BufferSize / 2, ENDPOINT_DMA_MAX_XFER) / BlockSize) : 0;
+	uint32_t QueueBlock   = BlockAddress;
+	uint16_t BlocksToQueue = TotalBlocks;
+	uint32_t SlotAddress[2];
+	uint16_t SlotBlocks[2];
+	uint8_t  Queued       = 0;
+	uint8_t  Handled      = 0;
+	bool     Success      = (ChunkBlocks != 0) && !(BlockSize % MSInterfaceInfo->Config.DataOUTEndpointSize) &&
+	                        ENDPOINT_DMA_CAPABLE(Buffer);
+	MS_Device_BlockStream_t Stream;
+
+	memset(&Stream, 0x00, sizeof(Stream));
+
+	while (Success)
+	{
+		/* Keep both halves queued for the host while blocks are left to receive */
+		while (Success && BlocksToQueue && ((uint8_t)(Queued - Handled) < 2))
+		{
+			uint8_t  Slot   = Queued & 1;
+			uint16_t Blocks = MIN(BlocksToQueue, ChunkBlocks);
+
+			Success = DcdQueueTransfer(portnum, PhyEP, &Buffer[(uint32_t)Slot * ChunkBlocks * BlockSize],
+			                           (uint32_t)Blocks * BlockSize, MS_Device_BlockTransferDone, &Stream);
+			if (Success)
+			{
+				SlotAddress[Slot] = QueueBlock;
+				SlotBlocks[Slot]  = Blocks;
+				QueueBlock       += Blocks;
+				BlocksToQueue    -= Blocks;
+				Queued++;
+			}
+		}
+
+		if (!(Success) || (Handled == Queued))
+		  break;
+
+		/* Store the oldest half while the other one is still receiving, a short transfer means the host sent less */
+		uint8_t Slot = Handled & 1;
+
+		Success = MS_Device_WaitBlocks(MSInterfaceInfo, &Stream, Queued, (uint8_t)(Queued - Handled - 1)) &&
+		          (Stream.Length[Slot] == ((uint32_t)SlotBlocks[Slot] * BlockSize)) &&
+		          Callback(MSInterfaceInfo, CallbackArg, &Buffer[(uint32_t)Slot * ChunkBlocks * BlockSize],
+		                   SlotAddress[Slot], SlotBlocks[Slot]);
+		Handled++;
+	}
+
+	DcdQueueFlush(portnum, PhyEP);
+
+	MSInterfaceInfo->State.CommandBlock.DataTransferLength =
+		cpu_to_le32(le32_to_cpu(MSInterfaceInfo->State.CommandBlock.DataTransferLength) - Stream.Bytes);
+
+	return Success;
+}
+#endif
+
 #endif
@@ -103,6 +103,25 @@ typedef struct {
 
 } USB_ClassInfo_MS_Device_t;
 
+/**
+ * @brief	Storage backend callback of @ref MS_Device_SendBlocks() and @ref MS_Device_ReceiveBlocks(). For a send it must fill
+ *  the buffer with the given blocks read from the medium, for a receive it must write the buffer holding the given blocks to
+ *  the medium. It runs in the task context while the USB controller moves the other half of the buffer.
+ *
+ * @param	MSInterfaceInfo	: Pointer to a structure containing a Mass Storage Class configuration and state.
+ * @param	CallbackArg		: User argument given to the transfer function.
+ * @param	Buffer			: Pointer to the blocks to fill or to store.
+ * @param	BlockAddress	: Address of the first block on the medium.
+ * @param	Blocks			: Number of blocks in the buffer.
+ *
+ * @return	Boolean \c true if the blocks were read or written, \c false to end the transfer.
+ */
+typedef bool (*MS_Device_BlockCallback_t)(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo,
+										  void* const CallbackArg,
+										  uint8_t* const Buffer,
+										  const uint32_t BlockAddress,
+										  const uint16_t Blocks);
+
 /* Function Prototypes: */
 /**
  * @brief	Configures the endpoints of a given Mass Storage interface, ready for use. This should be linked to the library
@@ -145,6 +164,63 @@ void MS_Device_USBTask(USB_ClassInfo_MS_Device_t *const MSInterfaceInfo) ATTR_NO
  */
 bool CALLBACK_MS_Device_SCSICommandReceived(USB_ClassInfo_MS_Device_t *const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 
+#if defined(__LPC18XX__) || defined(__LPC43XX__)
+/**
+ * @brief	Sends the data phase of a SCSI read command as whole multi-sector transfers. The buffer is used as two halves of up
+ *  to 16KB each: while one half is moved to the host by chained dTDs, the callback fills the other one from the medium. The
+ *  command's data residue is reduced by the bytes sent, so the SCSI handler must not adjust it again. This should be called
+ *  from @ref CALLBACK_MS_Device_SCSICommandReceived().
+ *
+ * @param	MSInterfaceInfo	: Pointer to a structure containing a Mass Storage Class configuration and state.
+ * @param	BlockAddress	: Address of the first block to send.
+ * @param	TotalBlocks		: Number of blocks to send.
+ * @param	BlockSize		: Size in bytes of each block.
+ * @param	Buffer			: Transfer buffer of at least two blocks, in USB DMA reachable RAM.
+ * @param	BufferSize		: Size in bytes of the transfer buffer.
+ * @param	Callback		: Storage backend callback reading blocks from the medium.
+ * @param	CallbackArg		: User argument passed to @a Callback.
+ *
+ * @return	Boolean \c true if all blocks were sent, \c false if the callback failed, the transfer failed or the interface was reset.
+ * @note	Only available on LPC18xx/43xx.
+ */
+bool MS_Device_SendBlocks(USB_ClassInfo_MS_Device_t *const MSInterfaceInfo,
+						  const uint32_t BlockAddress,
+						  const uint16_t TotalBlocks,
+						  const uint16_t BlockSize,
+						  uint8_t *const Buffer,
+						  const uint32_t BufferSize,
+						  MS_Device_BlockCallback_t Callback,
+						  void *const CallbackArg) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(5) ATTR_NON_NULL_PTR_ARG(7);
+
+/**
+ * @brief	Receives the data phase of a SCSI write command as whole multi-sector transfers. Both halves of the buffer are kept
+ *  queued for the host, and each one is handed to the callback as soon as it fills while the other half is still receiving.
+ *  The command's data residue is reduced by the bytes received, so the SCSI handler must not adjust it again. This should be
+ *  called from @ref CALLBACK_MS_Device_SCSICommandReceived().
+ *
+ * @param	MSInterfaceInfo	: Pointer to a structure containing a Mass Storage Class configuration and state.
+ * @param	BlockAddress	: Address of the first block to receive.
+ * @param	TotalBlocks		: Number of blocks to receive.
+ * @param	BlockSize		: Size in bytes of each block, a multiple of the OUT endpoint size.
+ * @param	Buffer			: Transfer buffer of at least two blocks, in USB DMA reachable RAM.
+ * @param	BufferSize		: Size in bytes of the transfer buffer.
+ * @param	Callback		: Storage backend callback writing blocks to the medium.
+ * @param	CallbackArg		: User argument passed to @a Callback.
+ *
+ * @return	Boolean \c true if all blocks were received and stored, \c false if the callback failed, the host sent less data,
+ *          the transfer failed or the interface was reset.
+ * @note	Only available on LPC18xx/43xx.
+ */
+bool MS_Device_ReceiveBlocks(USB_ClassInfo_MS_Device_t *const MSInterfaceInfo,
+							 const uint32_t BlockAddress,
+							 const uint16_t TotalBlocks,
+							 const uint16_t BlockSize,
+							 uint8_t *const Buffer,
+							 const uint32_t BufferSize,
+							 MS_Device_BlockCallback_t Callback,
+							 void *const CallbackArg) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(5) ATTR_NON_NULL_PTR_ARG(7);
+#endif
+
 /* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 /* Function Prototypes: */
@@ -153,6 +229,25 @@ static void MS_Device_ReturnCommandStatus(USB_ClassInfo_MS_Device_t *const MSInt
 
 static bool MS_Device_ReadInCommandBlock(USB_ClassInfo_MS_Device_t *const MSInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 
+				#if defined(__LPC18XX__) || defined(__LPC43XX__)
+/* Transfers of a block stream, updated from the USB interrupt */
+typedef struct {
+	volatile uint8_t  Done;				/* Completed transfers */
+	volatile bool     Failed;			/* A transfer retired with an error */
+	volatile uint32_t Bytes;			/* Bytes moved by the completed transfers */
+	volatile uint32_t Length[2];		/* Bytes moved by the last completed transfer of each half */
+} MS_Device_BlockStream_t;
+
+static void MS_Device_BlockTransferDone(void *pArg,
+										uint32_t Length,
+										DCD_TRANSFER_STATUS Status);
+
+static bool MS_Device_WaitBlocks(USB_ClassInfo_MS_Device_t *const MSInterfaceInfo,
+								 MS_Device_BlockStream_t *const Stream,
+								 const uint8_t Queued,
+								 const uint8_t MaxPending) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+				#endif
+
 			#endif
 
 	#endif
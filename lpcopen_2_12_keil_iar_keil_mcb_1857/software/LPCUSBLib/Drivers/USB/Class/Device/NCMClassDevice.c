@@ -0,0 +1,577 @@
+/*
+ * @brief Device mode driver for the library USB CDC-NCM Class driver
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * Copyright(C) Dean Camera, 2011, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#define  __INCLUDE_FROM_USB_DRIVER
+#include "../../Core/USBMode.h"
+
+#if defined(USB_CAN_BE_DEVICE)
+
+#define  __INCLUDE_FROM_NCM_DRIVER
+#define  __INCLUDE_FROM_NCM_DEVICE_C
+#include "NCMClassDevice.h"
+
+#define NCM_ALIGN(x)    (((x) + (NCM_DEVICE_NTB_ALIGNMENT - 1)) & ~(NCM_DEVICE_NTB_ALIGNMENT - 1))
+
+/* Bytes the datagram pointer table of an IN NTB with the given number of datagrams takes */
+#define NCM_NDP16_SIZE(Datagrams)   (sizeof(NCM_NDP16_t) + (((Datagrams) + 1) * sizeof(NCM_Datagram_Pointer16_t)))
+
+enum NCM_Notifications_Pending_t
+{
+	NCM_PENDING_SpeedChange = (1 << 0),
+	NCM_PENDING_Connection  = (1 << 1),
+};
+
+void NCM_Device_ProcessControlRequest(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo)
+{
+	uint8_t portnum = NCMInterfaceInfo->Config.PortNumber;
+
+	if (!(Endpoint_IsSETUPReceived(portnum)))
+	  return;
+
+	if ((USB_ControlRequest.bRequest == REQ_SetInterface) &&
+	    (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_STANDARD | REQREC_INTERFACE)))
+	{
+		if (USB_ControlRequest.wIndex != NCMInterfaceInfo->Config.DataInterfaceNumber)
+		  return;
+
+		Endpoint_ClearSETUP(portnum);
+		Endpoint_ClearStatusStage(portnum);
+
+		/* Alternate setting 1 carries the data endpoints, selecting it (re)starts the data path */
+		NCMInterfaceInfo->State.InterfaceEnabled     = ((USB_ControlRequest.wValue & 0xFF) != 0);
+		NCMInterfaceInfo->State.NotificationsPending = (NCM_PENDING_SpeedChange | NCM_PENDING_Connection);
+		NCMInterfaceInfo->State.InLength             = 0;
+		NCMInterfaceInfo->State.InDatagrams          = 0;
+		NCMInterfaceInfo->State.OutLength            = 0;
+		return;
+	}
+
+	if (USB_ControlRequest.wIndex != NCMInterfaceInfo->Config.ControlInterfaceNumber)
+	  return;
+
+	switch (USB_ControlRequest.bRequest)
+	{
+		case NCM_REQ_GetNtbParameters:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE))
+			{
+				NCM_NTB_Parameters_t Parameters =
+					{
+						.Length                 = CPU_TO_LE16(sizeof(NCM_NTB_Parameters_t)),
+						.NtbFormatsSupported    = CPU_TO_LE16(NCM_NTB_FORMAT_16),
+						.NtbInMaxSize           = cpu_to_le32(NCMInterfaceInfo->Config.NTBInBufferSize),
+						.NdpInDivisor           = CPU_TO_LE16(NCM_DEVICE_NTB_ALIGNMENT),
+						.NdpInPayloadRemainder  = CPU_TO_LE16(0),
+						.NdpInAlignment         = CPU_TO_LE16(NCM_DEVICE_NTB_ALIGNMENT),
+						.NtbOutMaxSize          = cpu_to_le32(NCMInterfaceInfo->Config.NTBOutBufferSize),
+						.NdpOutDivisor          = CPU_TO_LE16(NCM_DEVICE_NTB_ALIGNMENT),
+						.NdpOutPayloadRemainder = CPU_TO_LE16(0),
+						.NdpOutAlignment        = CPU_TO_LE16(NCM_DEVICE_NTB_ALIGNMENT),
+						.NtbOutMaxDatagrams     = CPU_TO_LE16(0),
+					};
+
+				Endpoint_ClearSETUP(portnum);
+				Endpoint_Write_Control_Stream_LE(portnum, &Parameters, MIN(USB_ControlRequest.wLength, sizeof(Parameters)));
+				Endpoint_ClearOUT(portnum);
+			}
+
+			break;
+		case NCM_REQ_GetNtbFormat:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE))
+			{
+				uint16_t Format = CPU_TO_LE16(0);
+
+				Endpoint_ClearSETUP(portnum);
+				Endpoint_Write_Control_Stream_LE(portnum, &Format, MIN(USB_ControlRequest.wLength, sizeof(Format)));
+				Endpoint_ClearOUT(portnum);
+			}
+
+			break;
+		case NCM_REQ_SetNtbFormat:
+			/* Only NTB-16 is offered, NTB-32 is refused by leaving the request to be stalled */
+			if ((USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE)) &&
+			    (USB_ControlRequest.wValue == 0))
+			{
+				Endpoint_ClearSETUP(portnum);
+				Endpoint_ClearStatusStage(portnum);
+			}
+
+			break;
+		case NCM_REQ_GetNtbInputSize:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE))
+			{
+				uint32_t InputSize = cpu_to_le32(NCMInterfaceInfo->State.NTBInputSize);
+
+				Endpoint_ClearSETUP(portnum);
+				Endpoint_Write_Control_Stream_LE(portnum, &InputSize, MIN(USB_ControlRequest.wLength, sizeof(InputSize)));
+				Endpoint_ClearOUT(portnum);
+			}
+
+			break;
+		case NCM_REQ_SetNtbInputSize:
+			if ((USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE)) &&
+			    (USB_ControlRequest.wLength >= sizeof(uint32_t)) && (USB_ControlRequest.wLength <= 8))
+			{
+				uint32_t InputSize[2];
+
+				Endpoint_ClearSETUP(portnum);
+				Endpoint_Read_Control_Stream_LE(portnum, InputSize, USB_ControlRequest.wLength);
+				Endpoint_ClearIN(portnum);
+
+				NCMInterfaceInfo->State.NTBInputSize = MIN(le32_to_cpu(InputSize[0]), NCMInterfaceInfo->Config.NTBInBufferSize);
+			}
+
+			break;
+		case NCM_REQ_GetMaxDatagramSize:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE))
+			{
+				uint16_t DatagramSize = cpu_to_le16(NCMInterfaceInfo->State.MaxDatagramSize);
+
+				Endpoint_ClearSETUP(portnum);
+				Endpoint_Write_Control_Stream_LE(portnum, &DatagramSize, MIN(USB_ControlRequest.wLength, sizeof(DatagramSize)));
+				Endpoint_ClearOUT(portnum);
+			}
+
+			break;
+		case NCM_REQ_SetMaxDatagramSize:
+			if ((USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE)) &&
+			    (USB_ControlRequest.wLength == sizeof(uint16_t)))
+			{
+				uint16_t DatagramSize;
+
+				Endpoint_ClearSETUP(portnum);
+				Endpoint_Read_Control_Stream_LE(portnum, &DatagramSize, sizeof(DatagramSize));
+				Endpoint_ClearIN(portnum);
+
+				NCMInterfaceInfo->State.MaxDatagramSize = MIN(le16_to_cpu(DatagramSize), NCM_ETHERNET_FRAME_SIZE_MAX);
+			}
+
+			break;
+		case NCM_REQ_SetEthernetPacketFilter:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE))
+			{
+				Endpoint_ClearSETUP(portnum);
+				Endpoint_ClearStatusStage(portnum);
+
+				NCMInterfaceInfo->State.PacketFilter = USB_ControlRequest.wValue;
+			}
+
+			break;
+	}
+}
+
+bool NCM_Device_ConfigureEndpoints(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo)
+{
+	memset(&NCMInterfaceInfo->State, 0x00, sizeof(NCMInterfaceInfo->State));
+
+	NCMInterfaceInfo->State.NTBInputSize    = NCMInterfaceInfo->Config.NTBInBufferSize;
+	NCMInterfaceInfo->State.MaxDatagramSize = NCM_ETHERNET_FRAME_SIZE_MAX;
+
+	for (uint8_t EndpointNum = 1; EndpointNum < ENDPOINT_TOTAL_ENDPOINTS(NCMInterfaceInfo->Config.PortNumber); EndpointNum++)
+	{
+		uint16_t Size;
+		uint8_t  Type;
+		uint8_t  Direction;
+		bool     DoubleBanked;
+
+		if (EndpointNum == NCMInterfaceInfo->Config.DataINEndpointNumber)
+		{
+			Size         = NCMInterfaceInfo->Config.DataINEndpointSize;
+			Direction    = ENDPOINT_DIR_IN;
+			Type         = EP_TYPE_BULK;
+			DoubleBanked = NCMInterfaceInfo->Config.DataINEndpointDoubleBank;
+		}
+		else if (EndpointNum == NCMInterfaceInfo->Config.DataOUTEndpointNumber)
+		{
+			Size         = NCMInterfaceInfo->Config.DataOUTEndpointSize;
+			Direction    = ENDPOINT_DIR_OUT;
+			Type         = EP_TYPE_BULK;
+			DoubleBanked = NCMInterfaceInfo->Config.DataOUTEndpointDoubleBank;
+		}
+		else if (EndpointNum == NCMInterfaceInfo->Config.NotificationEndpointNumber)
+		{
+			Size         = NCMInterfaceInfo->Config.NotificationEndpointSize;
+			Direction    = ENDPOINT_DIR_IN;
+			Type         = EP_TYPE_INTERRUPT;
+			DoubleBanked = NCMInterfaceInfo->Config.NotificationEndpointDoubleBank;
+		}
+		else
+		{
+			continue;
+		}
+
+		if (!(Endpoint_ConfigureEndpoint(NCMInterfaceInfo->Config.PortNumber, EndpointNum, Type, Direction, Size,
+		                                 DoubleBanked ? ENDPOINT_BANK_DOUBLE : ENDPOINT_BANK_SINGLE)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void NCM_Device_USBTask(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo)
+{
+	if ((USB_DeviceState[NCMInterfaceInfo->Config.PortNumber] != DEVICE_STATE_Configured) ||
+	    !(NCMInterfaceInfo->State.InterfaceEnabled))
+	{
+		return;
+	}
+
+	if (NCMInterfaceInfo->State.NotificationsPending)
+	  NCM_Device_SendNotifications(NCMInterfaceInfo);
+
+	if (NCMInterfaceInfo->State.InDatagrams &&
+	    (NCMInterfaceInfo->State.InAge >= NCMInterfaceInfo->Config.AggregationTimeoutMS))
+	{
+		NCM_Device_Flush(NCMInterfaceInfo);
+	}
+}
+
+void NCM_Device_StartOfFrame(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo)
+{
+	if (NCMInterfaceInfo->State.InDatagrams && (NCMInterfaceInfo->State.InAge != 0xFFFF))
+	  NCMInterfaceInfo->State.InAge++;
+}
+
+bool NCM_Device_IsPacketReceived(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo)
+{
+	if ((USB_DeviceState[NCMInterfaceInfo->Config.PortNumber] != DEVICE_STATE_Configured) ||
+	    !(NCMInterfaceInfo->State.InterfaceEnabled))
+	{
+		return false;
+	}
+
+	if (NCMInterfaceInfo->State.OutLength)
+	  return true;
+
+	Endpoint_SelectEndpoint(NCMInterfaceInfo->Config.PortNumber, NCMInterfaceInfo->Config.DataOUTEndpointNumber);
+	return Endpoint_IsOUTReceived(NCMInterfaceInfo->Config.PortNumber);
+}
+
+uint8_t NCM_Device_ReadPacket(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo,
+                              void* Buffer,
+                              uint16_t* const PacketLength)
+{
+	uint8_t* NTB = NCMInterfaceInfo->Config.NTBOutBuffer;
+	uint8_t  ErrorCode;
+
+	if ((USB_DeviceState[NCMInterfaceInfo->Config.PortNumber] != DEVICE_STATE_Configured) ||
+	    !(NCMInterfaceInfo->State.InterfaceEnabled))
+	{
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
+
+	*PacketLength = 0;
+
+	if (!(NCMInterfaceInfo->State.OutLength))
+	{
+		if ((ErrorCode = NCM_Device_ReceiveNTB(NCMInterfaceInfo)) != ENDPOINT_RWSTREAM_NoError)
+		  return ErrorCode;
+	}
+
+	while (NCMInterfaceInfo->State.OutLength)
+	{
+		uint16_t OutLength = NCMInterfaceInfo->State.OutLength;
+		uint16_t Pointer   = NCMInterfaceInfo->State.OutPointer;
+
+		if ((Pointer + sizeof(NCM_Datagram_Pointer16_t)) > OutLength)
+		{
+			NCMInterfaceInfo->State.OutLength = 0;
+			return NCM_ERROR_LOGICAL_CMD_FAILED;
+		}
+
+		NCM_Datagram_Pointer16_t* Datagram = (NCM_Datagram_Pointer16_t*)&NTB[Pointer];
+		uint16_t DatagramIndex  = le16_to_cpu(Datagram->DatagramIndex);
+		uint16_t DatagramLength = le16_to_cpu(Datagram->DatagramLength);
+
+		if (!(DatagramIndex) || !(DatagramLength))
+		{
+			/* End of this table, carry on with the next one if the NTB chains another */
+			uint16_t NextNdpIndex = le16_to_cpu(((NCM_NDP16_t*)&NTB[NCMInterfaceInfo->State.OutNdpIndex])->NextNdpIndex);
+
+			if ((NextNdpIndex <= NCMInterfaceInfo->State.OutNdpIndex) || (NextNdpIndex & (NCM_DEVICE_NTB_ALIGNMENT - 1)) ||
+			    ((NextNdpIndex + sizeof(NCM_NDP16_t)) > OutLength) ||
+			    (le32_to_cpu(((NCM_NDP16_t*)&NTB[NextNdpIndex])->Signature) != NCM_NDP16_NOCRC_SIGNATURE))
+			{
+				NCMInterfaceInfo->State.OutLength = 0;
+				return ENDPOINT_RWSTREAM_NoError;
+			}
+
+			NCMInterfaceInfo->State.OutNdpIndex = NextNdpIndex;
+			NCMInterfaceInfo->State.OutPointer  = NextNdpIndex + sizeof(NCM_NDP16_t);
+			continue;
+		}
+
+		NCMInterfaceInfo->State.OutPointer += sizeof(NCM_Datagram_Pointer16_t);
+
+		if (((uint32_t)DatagramIndex + DatagramLength > OutLength) ||
+		    (DatagramLength > NCMInterfaceInfo->State.MaxDatagramSize))
+		{
+			continue;
+		}
+
+		memcpy(Buffer, &NTB[DatagramIndex], DatagramLength);
+		*PacketLength = DatagramLength;
+		return ENDPOINT_RWSTREAM_NoError;
+	}
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+uint8_t NCM_Device_SendPacket(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo,
+                              const void* Buffer,
+                              const uint16_t PacketLength)
+{
+	uint32_t Limit = MIN(NCMInterfaceInfo->Config.NTBInBufferSize, NCMInterfaceInfo->State.NTBInputSize);
+	uint32_t Offset;
+	uint8_t  ErrorCode;
+
+	if ((USB_DeviceState[NCMInterfaceInfo->Config.PortNumber] != DEVICE_STATE_Configured) ||
+	    !(NCMInterfaceInfo->State.InterfaceEnabled))
+	{
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
+
+	if (!(PacketLength) || (PacketLength > NCMInterfaceInfo->State.MaxDatagramSize) ||
+	    ((NCM_ALIGN(sizeof(NCM_NTH16_t)) + NCM_ALIGN(PacketLength) + NCM_NDP16_SIZE(1)) > Limit))
+	{
+		return NCM_ERROR_LOGICAL_CMD_FAILED;
+	}
+
+	Offset = NCM_ALIGN(NCMInterfaceInfo->State.InLength ? NCMInterfaceInfo->State.InLength : sizeof(NCM_NTH16_t));
+
+	if ((NCMInterfaceInfo->State.InDatagrams == NCM_DEVICE_MAX_DATAGRAMS) ||
+	    ((Offset + NCM_ALIGN(PacketLength) + NCM_NDP16_SIZE(NCMInterfaceInfo->State.InDatagrams + 1)) > Limit))
+	{
+		if ((ErrorCode = NCM_Device_Flush(NCMInterfaceInfo)) != ENDPOINT_RWSTREAM_NoError)
+		  return ErrorCode;
+
+		Offset = NCM_ALIGN(sizeof(NCM_NTH16_t));
+	}
+
+	if (!(NCMInterfaceInfo->State.InDatagrams))
+	  NCMInterfaceInfo->State.InAge = 0;
+
+	memcpy(&NCMInterfaceInfo->Config.NTBInBuffer[Offset], Buffer, PacketLength);
+
+	NCM_Datagram_Pointer16_t* Datagram = &NCMInterfaceInfo->State.InPointers[NCMInterfaceInfo->State.InDatagrams++];
+
+	Datagram->DatagramIndex  = cpu_to_le16(Offset);
+	Datagram->DatagramLength = cpu_to_le16(PacketLength);
+
+	NCMInterfaceInfo->State.InLength = Offset + PacketLength;
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+uint8_t NCM_Device_Flush(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo)
+{
+	uint8_t  portnum  = NCMInterfaceInfo->Config.PortNumber;
+	uint8_t* NTB      = NCMInterfaceInfo->Config.NTBInBuffer;
+	uint8_t  Datagrams = NCMInterfaceInfo->State.InDatagrams;
+	uint8_t  ErrorCode;
+
+	if ((USB_DeviceState[portnum] != DEVICE_STATE_Configured) || !(NCMInterfaceInfo->State.InterfaceEnabled))
+	  return ENDPOINT_RWSTREAM_DeviceDisconnected;
+
+	if (!(Datagrams))
+	  return ENDPOINT_RWSTREAM_NoError;
+
+	uint16_t NdpIndex    = NCM_ALIGN(NCMInterfaceInfo->State.InLength);
+	uint16_t BlockLength = NdpIndex + NCM_NDP16_SIZE(Datagrams);
+
+	NCM_NDP16_t* NDP = (NCM_NDP16_t*)&NTB[NdpIndex];
+
+	NDP->Signature    = CPU_TO_LE32(NCM_NDP16_NOCRC_SIGNATURE);
+	NDP->Length       = cpu_to_le16(NCM_NDP16_SIZE(Datagrams));
+	NDP->NextNdpIndex = CPU_TO_LE16(0);
+	memcpy(&NTB[NdpIndex + sizeof(NCM_NDP16_t)], NCMInterfaceInfo->State.InPointers,
+	       Datagrams * sizeof(NCM_Datagram_Pointer16_t));
+	memset(&NTB[BlockLength - sizeof(NCM_Datagram_Pointer16_t)], 0x00, sizeof(NCM_Datagram_Pointer16_t));
+
+	/* A short NTB ending on a packet boundary would need a ZLP, pad it by one byte instead */
+	if (!(BlockLength % NCMInterfaceInfo->Config.DataINEndpointSize) &&
+	    (BlockLength < MIN(NCMInterfaceInfo->Config.NTBInBufferSize, NCMInterfaceInfo->State.NTBInputSize)))
+	{
+		NTB[BlockLength++] = 0x00;
+	}
+
+	NCM_NTH16_t* NTH = (NCM_NTH16_t*)NTB;
+
+	NTH->Signature    = CPU_TO_LE32(NCM_NTH16_SIGNATURE);
+	NTH->HeaderLength = CPU_TO_LE16(sizeof(NCM_NTH16_t));
+	NTH->Sequence     = cpu_to_le16(NCMInterfaceInfo->State.InSequence++);
+	NTH->BlockLength  = cpu_to_le16(BlockLength);
+	NTH->NdpIndex     = cpu_to_le16(NdpIndex);
+
+	NCMInterfaceInfo->State.InLength    = 0;
+	NCMInterfaceInfo->State.InDatagrams = 0;
+
+	Endpoint_SelectEndpoint(portnum, NCMInterfaceInfo->Config.DataINEndpointNumber);
+
+	if ((ErrorCode = Endpoint_WaitUntilReady()) != ENDPOINT_READYWAIT_NoError)
+	  return ErrorCode;
+
+	NCM_Device_WriteNTB(NCMInterfaceInfo, NTB, BlockLength);
+	Endpoint_ClearIN(portnum);
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+static void NCM_Device_SendNotifications(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo)
+{
+	uint8_t portnum = NCMInterfaceInfo->Config.PortNumber;
+
+	Endpoint_SelectEndpoint(portnum, NCMInterfaceInfo->Config.NotificationEndpointNumber);
+
+	if (!(Endpoint_IsINReady(portnum)))
+	  return;
+
+	USB_Request_Header_t Notification = (USB_Request_Header_t)
+		{
+			.bmRequestType = (REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE),
+			.wIndex        = CPU_TO_LE16(NCMInterfaceInfo->Config.ControlInterfaceNumber),
+		};
+
+	if (NCMInterfaceInfo->State.NotificationsPending & NCM_PENDING_SpeedChange)
+	{
+		uint32_t BitRates[2] = {CPU_TO_LE32(NCM_DEVICE_LINK_SPEED), CPU_TO_LE32(NCM_DEVICE_LINK_SPEED)};
+
+		Notification.bRequest = NCM_NOTIF_ConnectionSpeedChange;
+		Notification.wValue   = CPU_TO_LE16(0);
+		Notification.wLength  = CPU_TO_LE16(sizeof(BitRates));
+
+		Endpoint_Write_Stream_LE(portnum, &Notification, sizeof(USB_Request_Header_t), NULL);
+		Endpoint_Write_Stream_LE(portnum, BitRates, sizeof(BitRates), NULL);
+		Endpoint_ClearIN(portnum);
+
+		NCMInterfaceInfo->State.NotificationsPending &= ~NCM_PENDING_SpeedChange;
+		return;
+	}
+
+	Notification.bRequest = NCM_NOTIF_NetworkConnection;
+	Notification.wValue   = CPU_TO_LE16(1);
+	Notification.wLength  = CPU_TO_LE16(0);
+
+	Endpoint_Write_Stream_LE(portnum, &Notification, sizeof(USB_Request_Header_t), NULL);
+	Endpoint_ClearIN(portnum);
+
+	NCMInterfaceInfo->State.NotificationsPending &= ~NCM_PENDING_Connection;
+}
+
+static uint8_t NCM_Device_ReceiveNTB(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo)
+{
+	uint8_t      portnum = NCMInterfaceInfo->Config.PortNumber;
+	uint8_t*     NTB     = NCMInterfaceInfo->Config.NTBOutBuffer;
+	NCM_NTH16_t* NTH     = (NCM_NTH16_t*)NTB;
+
+	Endpoint_SelectEndpoint(portnum, NCMInterfaceInfo->Config.DataOUTEndpointNumber);
+
+	if (!(Endpoint_IsOUTReceived(portnum)))
+	  return ENDPOINT_RWSTREAM_NoError;
+
+	/* Zero length packet ending an NTB that filled its last packet */
+	if (Endpoint_BytesInEndpoint(portnum) < sizeof(NCM_NTH16_t))
+	{
+		Endpoint_ClearOUT(portnum);
+		return ENDPOINT_RWSTREAM_NoError;
+	}
+
+	Endpoint_Read_Stream_LE(portnum, NTH, sizeof(NCM_NTH16_t), NULL);
+
+	uint16_t BlockLength = le16_to_cpu(NTH->BlockLength);
+	uint16_t NdpIndex    = le16_to_cpu(NTH->NdpIndex);
+
+	if ((le32_to_cpu(NTH->Signature) != NCM_NTH16_SIGNATURE) ||
+	    (le16_to_cpu(NTH->HeaderLength) != sizeof(NCM_NTH16_t)) ||
+	    (BlockLength < sizeof(NCM_NTH16_t)) || (BlockLength > NCMInterfaceInfo->Config.NTBOutBufferSize))
+	{
+		Endpoint_ClearOUT(portnum);
+		return NCM_ERROR_LOGICAL_CMD_FAILED;
+	}
+
+	Endpoint_Read_Stream_LE(portnum, &NTB[sizeof(NCM_NTH16_t)], BlockLength - sizeof(NCM_NTH16_t), NULL);
+	Endpoint_ClearOUT(portnum);
+
+	if ((NdpIndex < sizeof(NCM_NTH16_t)) || (NdpIndex & (NCM_DEVICE_NTB_ALIGNMENT - 1)) ||
+	    ((NdpIndex + sizeof(NCM_NDP16_t)) > BlockLength) ||
+	    (le32_to_cpu(((NCM_NDP16_t*)&NTB[NdpIndex])->Signature) != NCM_NDP16_NOCRC_SIGNATURE))
+	{
+		return NCM_ERROR_LOGICAL_CMD_FAILED;
+	}
+
+	NCMInterfaceInfo->State.OutLength   = BlockLength;
+	NCMInterfaceInfo->State.OutNdpIndex = NdpIndex;
+	NCMInterfaceInfo->State.OutPointer  = NdpIndex + sizeof(NCM_NDP16_t);
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+/* Sends the NTB in whole packets, each run of packets ending on a packet boundary is followed by a ClearIN so the
+ * shared IN buffer is never overrun. On LPC18xx/43xx the stream function hands the runs to the controller in place. */
+static void NCM_Device_WriteNTB(USB_ClassInfo_NCM_Device_t* const NCMInterfaceInfo,
+                                const uint8_t* Data,
+                                uint16_t Length)
+{
+	uint8_t  portnum = NCMInterfaceInfo->Config.PortNumber;
+	uint16_t mps     = NCMInterfaceInfo->Config.DataINEndpointSize;
+
+	while (Length)
+	{
+		uint16_t Chunk = MIN(Length, mps);
+
+#if defined(__LPC18XX__) || defined(__LPC43XX__)
+		if (ENDPOINT_DMA_CAPABLE(Data) && (Length > mps))
+		{
+			Chunk = MIN(Length, ENDPOINT_DMA_MAX_XFER);
+
+			if (Chunk < Length)
+			  Chunk -= (Chunk % mps);
+		}
+#endif
+
+		Endpoint_Write_Stream_LE(portnum, Data, Chunk, NULL);
+
+		Data   += Chunk;
+		Length -= Chunk;
+
+		if (Length)
+		{
+			Endpoint_ClearIN(portnum);
+			while (!(Endpoint_IsINReady(portnum)));
+		}
+	}
+}
+
+#endif
+
@@ -0,0 +1,263 @@
+/*
+ * @brief Device mode driver for the library USB CDC-NCM Class driver
+ *
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * Copyright(C) Dean Camera, 2011, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+/** @ingroup Group_USBClassNCM
+ *  @defgroup Group_USBClassNCMDevice CDC-NCM Class Device Mode Driver
+ *
+ *  @section Sec_Dependencies Module Source Dependencies
+ *  The following files must be built with any user project that uses this module:
+ *    - LPCUSBlib/Drivers/USB/Class/Device/NCMClassDevice.c <i>(Makefile source module name: LPCUSBLIB_SRC_USBCLASS)</i>
+ *
+ *  @section Sec_ModDescription Module Description
+ *  Device Mode USB Class driver framework interface, for the CDC-NCM USB Class driver.
+ *
+ *  Outgoing frames are packed into an IN NTB of up to \c NTBInBufferSize bytes, which is sent once it is full, or
+ *  once the oldest frame in it has waited \c AggregationTimeoutMS milliseconds. The timeout is counted by
+ *  @ref NCM_Device_StartOfFrame(), which the application calls from EVENT_USB_Device_StartOfFrame() with SOF events
+ *  enabled. A timeout of 0 sends the pending NTB on every call to @ref NCM_Device_USBTask().
+ *
+ *  @{
+ */
+
+#ifndef _NCM_CLASS_DEVICE_H_
+#define _NCM_CLASS_DEVICE_H_
+
+/* Includes: */
+		#include "../../USB.h"
+		#include "../Common/NCMClassCommon.h"
+
+/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+extern "C" {
+		#endif
+
+/* Preprocessor Checks: */
+		#if !defined(__INCLUDE_FROM_NCM_DRIVER)
+			#error Do not include this file directly. Include LPCUSBlib/Drivers/USB.h instead.
+		#endif
+
+/* Public Interface - May be used in end-application: */
+/* Macros: */
+		#if !defined(NCM_DEVICE_MAX_DATAGRAMS) || defined(__DOXYGEN__)
+/** Largest number of datagrams packed into one IN NTB. Each one costs four bytes in the class state. */
+			#define NCM_DEVICE_MAX_DATAGRAMS    32
+		#endif
+
+		#if !defined(NCM_DEVICE_LINK_SPEED) || defined(__DOXYGEN__)
+/** Bit rate in bits per second reported to the host in the connection speed change notification. */
+			#define NCM_DEVICE_LINK_SPEED       100000000UL
+		#endif
+
+/** Alignment of every datagram and datagram pointer table in an IN NTB, as reported in the NTB parameters. */
+		#define NCM_DEVICE_NTB_ALIGNMENT        4
+
+/* Type Defines: */
+/**
+ * @brief	CDC-NCM Class Device Mode Configuration and State Structure.
+ *
+ *  Class state structure. An instance of this structure should be made for each NCM interface
+ *  within the user application, and passed to each of the NCM class driver functions as the
+ *  \c NCMInterfaceInfo parameter. This stores each NCM interface's configuration and state information.
+ */
+typedef struct {
+	const struct {
+		uint8_t  ControlInterfaceNumber;		/**< Interface number of the NCM communication interface within the device. */
+		uint8_t  DataInterfaceNumber;			/**< Interface number of the NCM data interface within the device. */
+
+		uint8_t  DataINEndpointNumber;			/**< Endpoint number of the NCM interface's IN data endpoint. */
+		uint16_t DataINEndpointSize;			/**< Size in bytes of the NCM interface's IN data endpoint. */
+		bool     DataINEndpointDoubleBank;		/**< Indicates if the NCM interface's IN data endpoint should use double banking. */
+
+		uint8_t  DataOUTEndpointNumber;			/**< Endpoint number of the NCM interface's OUT data endpoint. */
+		uint16_t DataOUTEndpointSize;			/**< Size in bytes of the NCM interface's OUT data endpoint. */
+		bool     DataOUTEndpointDoubleBank;		/**< Indicates if the NCM interface's OUT data endpoint should use double banking. */
+
+		uint8_t  NotificationEndpointNumber;	/**< Endpoint number of the NCM interface's IN notification endpoint. */
+		uint16_t NotificationEndpointSize;		/**< Size in bytes of the NCM interface's IN notification endpoint. */
+		bool     NotificationEndpointDoubleBank;	/**< Indicates if the NCM interface's notification endpoint should use double banking. */
+
+		uint8_t  *NTBInBuffer;					/**< Buffer the IN NTB is assembled in, should sit in USB reachable SRAM. */
+		uint16_t NTBInBufferSize;				/**< Size in bytes of \c NTBInBuffer, at most 16KB. */
+		uint8_t  *NTBOutBuffer;					/**< Buffer each received OUT NTB is stored in. */
+		uint16_t NTBOutBufferSize;				/**< Size in bytes of \c NTBOutBuffer, at most 16KB. */
+		uint16_t AggregationTimeoutMS;			/**< Longest time in milliseconds a frame waits in a partly filled IN NTB. */
+
+		uint8_t  PortNumber;					/**< Port number that this interface is running.*/
+	} Config;				/**< Config data for the USB class interface within the device. All elements in this section
+							 *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
+							 */
+
+	struct {
+		bool     InterfaceEnabled;				/**< Set when the host selects the alternate setting of the data interface with endpoints. */
+		uint8_t  NotificationsPending;			/**< Link notifications still to send, speed change then connection. */
+		uint16_t PacketFilter;					/**< Ethernet packet filter bitmap set by the host. */
+		uint32_t NTBInputSize;					/**< Largest IN NTB the host accepts. */
+		uint16_t MaxDatagramSize;				/**< Largest datagram exchanged with the host. */
+
+		uint16_t InSequence;					/**< Sequence number of the next IN NTB. */
+		uint16_t InLength;						/**< Bytes of the pending IN NTB used so far, 0 when empty. */
+		uint16_t InAge;							/**< Milliseconds since the first datagram was put in the pending IN NTB. */
+		uint8_t  InDatagrams;					/**< Number of datagrams in the pending IN NTB. */
+		NCM_Datagram_Pointer16_t InPointers[NCM_DEVICE_MAX_DATAGRAMS];	/**< Datagram pointers of the pending IN NTB. */
+
+		uint16_t OutLength;						/**< Length of the OUT NTB being unpacked, 0 when none. */
+		uint16_t OutPointer;					/**< Offset of the next datagram pointer to unpack. */
+		uint16_t OutNdpIndex;					/**< Offset of the datagram pointer table being unpacked. */
+	} State;			/**< State data for the USB class interface within the device. All elements in this section
+						 *   are reset to their defaults when the interface is enumerated.
+						 */
+
+} USB_ClassInfo_NCM_Device_t;
+
+/* Function Prototypes: */
+/**
+ * @brief	Configures the endpoints of a given NCM interface, ready for use. This should be linked to the library
+ *  @ref EVENT_USB_Device_ConfigurationChanged() event so that the endpoints are configured when the configuration
+ *  containing the given NCM interface is selected.
+ *
+ *  @param	NCMInterfaceInfo	: Pointer to a structure containing a NCM Class configuration and state.
+ *
+ *  @return	 Boolean \c true if the endpoints were successfully configured, \c false otherwise.
+ */
+bool NCM_Device_ConfigureEndpoints(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+/**
+ * @brief	Processes incoming control requests from the host, that are directed to the given NCM class interface. This should be
+ *  linked to the library @ref EVENT_USB_Device_ControlRequest() event. This also handles the SET_INTERFACE request that
+ *  enables the data interface.
+ *
+ *  @param	NCMInterfaceInfo	: Pointer to a structure containing a NCM Class configuration and state.
+ *  @return	Nothing
+ */
+void NCM_Device_ProcessControlRequest(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+/**
+ * @brief	General management task for a given NCM class interface, required for the correct operation of the interface. This should
+ *  be called frequently in the main program loop, before the master USB management task @ref USB_USBTask(). It sends the
+ *  link notifications and the pending IN NTB once its aggregation timeout has expired.
+ *
+ * @param	NCMInterfaceInfo	: Pointer to a structure containing a NCM Class configuration and state.
+ * @return	Nothing
+ */
+void NCM_Device_USBTask(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+/**
+ * @brief	Millisecond tick of the aggregation timeout, to be called from the EVENT_USB_Device_StartOfFrame() event.
+ *
+ * @param	NCMInterfaceInfo	: Pointer to a structure containing a NCM Class configuration and state.
+ * @return	Nothing
+ */
+void NCM_Device_StartOfFrame(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+/**
+ * @brief	Determines if a packet is currently waiting for the device to read in and process, either in the OUT NTB
+ *  being unpacked or as a new NTB on the OUT endpoint.
+ *
+ *  @pre This function must only be called when the Device state machine is in the @ref DEVICE_STATE_Configured state or the
+ *       call will fail.
+ *
+ *  @param	NCMInterfaceInfo	: Pointer to a structure containing an NCM Class configuration and state.
+ *
+ *  @return	 Boolean \c true if a packet is waiting to be read in, \c false otherwise.
+ */
+bool NCM_Device_IsPacketReceived(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+/**
+ * @brief	Retrieves the next datagram sent by the host, receiving a new OUT NTB when the current one is used up.
+ *
+ *  @pre This function must only be called when the Device state machine is in the @ref DEVICE_STATE_Configured state or the
+ *       call will fail.
+ *
+ *  @param	NCMInterfaceInfo	: Pointer to a structure containing an NCM Class configuration and state.
+ *  @param	Buffer	: Pointer to a buffer of at least @ref NCM_ETHERNET_FRAME_SIZE_MAX bytes for the frame.
+ *  @param	PacketLength	: Pointer to where the length in bytes of the read frame is to be stored, 0 if none was read.
+ *
+ *  @return	 A value from the @ref Endpoint_Stream_RW_ErrorCodes_t enum, or @ref NCM_ERROR_LOGICAL_CMD_FAILED if a
+ *           malformed NTB was dropped.
+ */
+uint8_t NCM_Device_ReadPacket(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo,
+							  void *Buffer,
+							  uint16_t *const PacketLength) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2)
+ATTR_NON_NULL_PTR_ARG(3);
+
+/**
+ * @brief	Queues a frame for the host in the pending IN NTB. The NTB is sent first if the frame does not fit in it.
+ *
+ *  @pre This function must only be called when the Device state machine is in the @ref DEVICE_STATE_Configured state or the
+ *       call will fail.
+ *
+ *  @param	NCMInterfaceInfo	: Pointer to a structure containing an NCM Class configuration and state.
+ *  @param	Buffer	: Pointer to the frame to send.
+ *  @param	PacketLength	: Length in bytes of the frame.
+ *
+ *  @return	 A value from the @ref Endpoint_Stream_RW_ErrorCodes_t enum, or @ref NCM_ERROR_LOGICAL_CMD_FAILED if the
+ *           frame is larger than an NTB or the negotiated datagram size.
+ */
+uint8_t NCM_Device_SendPacket(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo,
+							  const void *Buffer,
+							  const uint16_t PacketLength) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+/**
+ * @brief	Sends the pending IN NTB to the host now, regardless of the aggregation timeout.
+ *
+ *  @param	NCMInterfaceInfo	: Pointer to a structure containing an NCM Class configuration and state.
+ *
+ *  @return	 A value from the @ref Endpoint_Stream_RW_ErrorCodes_t enum.
+ */
+uint8_t NCM_Device_Flush(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+/* Function Prototypes: */
+		#if defined(__INCLUDE_FROM_NCM_DEVICE_C)
+static void NCM_Device_SendNotifications(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+static uint8_t NCM_Device_ReceiveNTB(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+static void NCM_Device_WriteNTB(USB_ClassInfo_NCM_Device_t *const NCMInterfaceInfo,
+								const uint8_t *Data,
+								uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+		#endif
+
+	#endif
+
+/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+}
+		#endif
+
+#endif
+
+/** @} */
+
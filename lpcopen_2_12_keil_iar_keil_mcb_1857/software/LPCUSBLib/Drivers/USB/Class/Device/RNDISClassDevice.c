@@ -533,12 +533,146 @@ uint8_t RNDIS_Device_SendPacket(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfa
 	RNDISPacketHeader.DataOffset    = CPU_TO_LE32(sizeof(RNDIS_Packet_Message_t) - sizeof(RNDIS_Message_Header_t));
 	RNDISPacketHeader.DataLength    = cpu_to_le32(PacketLength);
 
-	Endpoint_Write_Stream_LE(RNDISInterfaceInfo->Config.PortNumber, &RNDISPacketHeader, sizeof(RNDIS_Packet_Message_t), NULL);
-	Endpoint_Write_Stream_LE(RNDISInterfaceInfo->Config.PortNumber, Buffer, PacketLength, NULL);
+	RNDIS_Device_WriteData(RNDISInterfaceInfo, (uint8_t*)&RNDISPacketHeader, sizeof(RNDIS_Packet_Message_t), true);
+	RNDIS_Device_WriteData(RNDISInterfaceInfo, Buffer, PacketLength, false);
 	Endpoint_ClearIN(RNDISInterfaceInfo->Config.PortNumber);
 
 	return ENDPOINT_RWSTREAM_NoError;
 }
 
+uint8_t RNDIS_Device_ReadPacketInPlace(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+                                       void* Buffer,
+                                       const uint16_t BufferSize,
+                                       uint16_t* const PacketLength)
+{
+	uint8_t  portnum = RNDISInterfaceInfo->Config.PortNumber;
+	uint32_t DataLength;
+
+	if ((USB_DeviceState[portnum] != DEVICE_STATE_Configured) ||
+	    (RNDISInterfaceInfo->State.CurrRNDISState != RNDIS_Data_Initialized))
+	{
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
+
+	Endpoint_SelectEndpoint(portnum, RNDISInterfaceInfo->Config.DataOUTEndpointNumber);
+
+	*PacketLength = 0;
+
+	if (!(Endpoint_IsOUTReceived(portnum)))
+		return ENDPOINT_RWSTREAM_NoError;
+
+	/* The header lands at the start of the buffer, i.e. in the headroom of the frame */
+	RNDIS_Packet_Message_t* RNDISPacketHeader = (RNDIS_Packet_Message_t*)Buffer;
+	Endpoint_Read_Stream_LE(portnum, RNDISPacketHeader, sizeof(RNDIS_Packet_Message_t), NULL);
+
+	DataLength = le32_to_cpu(RNDISPacketHeader->DataLength);
+
+	if ((DataLength > ETHERNET_FRAME_SIZE_MAX) || ((RNDIS_DEVICE_PACKET_HEADROOM + DataLength) > BufferSize))
+	{
+		Endpoint_StallTransaction(portnum);
+
+		return RNDIS_ERROR_LOGICAL_CMD_FAILED;
+	}
+
+	*PacketLength = (uint16_t)DataLength;
+
+	Endpoint_Read_Stream_LE(portnum, (uint8_t*)Buffer + RNDIS_DEVICE_PACKET_HEADROOM, *PacketLength, NULL);
+	Endpoint_ClearOUT(portnum);
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+uint8_t RNDIS_Device_SendPacketChain(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+                                     const RNDIS_Packet_Segment_t* Segments,
+                                     const uint8_t TotalSegments)
+{
+	uint8_t  portnum = RNDISInterfaceInfo->Config.PortNumber;
+	uint32_t PacketLength = 0;
+	uint8_t  ErrorCode;
+
+	if ((USB_DeviceState[portnum] != DEVICE_STATE_Configured) ||
+	    (RNDISInterfaceInfo->State.CurrRNDISState != RNDIS_Data_Initialized))
+	{
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
+
+	if (!(TotalSegments))
+	  return ENDPOINT_RWSTREAM_NoError;
+
+	for (uint8_t i = 0; i < TotalSegments; i++)
+	  PacketLength += Segments[i].Length;
+
+	Endpoint_SelectEndpoint(portnum, RNDISInterfaceInfo->Config.DataINEndpointNumber);
+
+	if ((ErrorCode = Endpoint_WaitUntilReady()) != ENDPOINT_READYWAIT_NoError)
+	  return ErrorCode;
+
+	/* Header goes in the headroom so the first segment leaves as one contiguous message */
+	uint8_t*                MessageStart      = (uint8_t*)Segments[0].Data - RNDIS_DEVICE_PACKET_HEADROOM;
+	RNDIS_Packet_Message_t* RNDISPacketHeader = (RNDIS_Packet_Message_t*)MessageStart;
+
+	memset(RNDISPacketHeader, 0, sizeof(RNDIS_Packet_Message_t));
+
+	RNDISPacketHeader->MessageType   = CPU_TO_LE32(REMOTE_NDIS_PACKET_MSG);
+	RNDISPacketHeader->MessageLength = cpu_to_le32(sizeof(RNDIS_Packet_Message_t) + PacketLength);
+	RNDISPacketHeader->DataOffset    = CPU_TO_LE32(sizeof(RNDIS_Packet_Message_t) - sizeof(RNDIS_Message_Header_t));
+	RNDISPacketHeader->DataLength    = cpu_to_le32(PacketLength);
+
+	RNDIS_Device_WriteData(RNDISInterfaceInfo, MessageStart, RNDIS_DEVICE_PACKET_HEADROOM + Segments[0].Length,
+	                       (TotalSegments > 1));
+
+	for (uint8_t i = 1; i < TotalSegments; i++)
+	  RNDIS_Device_WriteData(RNDISInterfaceInfo, Segments[i].Data, Segments[i].Length, (i + 1) < TotalSegments);
+
+	Endpoint_ClearIN(portnum);
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+/* Queues data behind what the IN buffer already holds without overrunning it: a full packet is sent as soon
+ * as more data follows, and runs of whole packets starting on a packet boundary go through the stream function,
+ * which hands them to the controller in place where the DCD allows. */
+static void RNDIS_Device_WriteData(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+                                   const uint8_t* Data,
+                                   uint16_t Length,
+                                   const bool MoreData)
+{
+	uint8_t  portnum = RNDISInterfaceInfo->Config.PortNumber;
+	uint16_t mps     = RNDISInterfaceInfo->Config.DataINEndpointSize;
+
+	while (Length)
+	{
+		uint16_t Fill = usb_data_buffer_IN_index[portnum];
+		uint16_t Chunk;
+
+		if ((Fill == 0) && (Length > mps))
+		{
+			Chunk = mps;
+#if defined(__LPC18XX__) || defined(__LPC43XX__)
+			/* The stream function keeps its last packet in the IN buffer, a whole multiple fills it exactly */
+			if (ENDPOINT_DMA_CAPABLE(Data))
+			  Chunk = MIN(Length, ENDPOINT_DMA_MAX_XFER) - (MIN(Length, ENDPOINT_DMA_MAX_XFER) % mps);
+#endif
+			Endpoint_Write_Stream_LE(portnum, Data, Chunk, NULL);
+		}
+		else
+		{
+			Chunk = MIN(Length, (uint16_t)(mps - Fill));
+
+			for (uint16_t i = 0; i < Chunk; i++)
+			  Endpoint_Write_8(portnum, Data[i]);
+		}
+
+		Data   += Chunk;
+		Length -= Chunk;
+
+		if ((usb_data_buffer_IN_index[portnum] >= mps) && (Length || MoreData))
+		{
+			Endpoint_ClearIN(portnum);
+			while (!(Endpoint_IsINReady(portnum)));
+		}
+	}
+}
+
 #endif
 
@@ -61,7 +61,23 @@ extern "C" {
 		#endif
 
 /* Public Interface - May be used in end-application: */
+/* Macros: */
+/** Bytes a frame passed to @ref RNDIS_Device_SendPacketChain() must have free in front of it for the RNDIS
+ *  packet message header, and the offset of the frame in a buffer filled by @ref RNDIS_Device_ReadPacketInPlace().
+ */
+#define RNDIS_DEVICE_PACKET_HEADROOM    sizeof(RNDIS_Packet_Message_t)
+
 /* Type Defines: */
+/**
+ * @brief	RNDIS Packet Segment Structure.
+ *
+ *  One contiguous piece of an outgoing frame, e.g. the payload of one lwIP pbuf in a chain.
+ */
+typedef struct {
+	void     *Data;		/**< Start of the segment data. */
+	uint16_t Length;	/**< Length in bytes of the segment. */
+} RNDIS_Packet_Segment_t;
+
 /**
  * @brief	RNDIS Class Device Mode Configuration and State Structure.
  *
@@ -180,6 +196,52 @@ uint8_t RNDIS_Device_SendPacket(USB_ClassInfo_RNDIS_Device_t *const RNDISInterfa
 								void *Buffer,
 								const uint16_t PacketLength);
 
+/**
+ * @brief	Retrieves the next pending packet from the device as a whole RNDIS packet message, so that the frame
+ *  lands in the nominated buffer without an intermediate copy. On LPC18xx/43xx the whole packets past the first
+ *  one are moved by the controller straight into the buffer when it sits in USB reachable SRAM.
+ *
+ *  For lwIP, allocate a PBUF_RAW pbuf of @ref RNDIS_DEVICE_PACKET_HEADROOM plus the largest Ethernet frame from
+ *  a pool in local or AHB SRAM, read into its payload, then hide the header with pbuf_header() and trim it to
+ *  @a PacketLength with pbuf_realloc().
+ *
+ *  @pre This function must only be called when the Device state machine is in the @ref DEVICE_STATE_Configured state or the
+ *       call will fail.
+ *
+ *  @param	RNDISInterfaceInfo	: Pointer to a structure containing an RNDIS Class configuration and state.
+ *  @param	Buffer	: Pointer to a buffer where the packet message is to be written to.
+ *  @param	BufferSize	: Size in bytes of @a Buffer.
+ *  @param	PacketLength	: Pointer to where the length in bytes of the read frame is to be stored, the frame
+ *                            starts @ref RNDIS_DEVICE_PACKET_HEADROOM bytes into @a Buffer.
+ *
+ *  @return	 A value from the @ref Endpoint_Stream_RW_ErrorCodes_t enum.
+ */
+uint8_t RNDIS_Device_ReadPacketInPlace(USB_ClassInfo_RNDIS_Device_t *const RNDISInterfaceInfo,
+									   void *Buffer,
+									   const uint16_t BufferSize,
+									   uint16_t *const PacketLength);
+
+/**
+ * @brief	Sends a frame made of one or more segments to the host, building the RNDIS packet message header in the
+ *  headroom in front of the first segment rather than copying the frame behind a separate header. Whole packets
+ *  of each segment are handed to the controller straight from the segment data where the DCD supports it.
+ *
+ *  For lwIP, pass the payload of each pbuf in the chain, with the first pbuf allocated with at least
+ *  @ref RNDIS_DEVICE_PACKET_HEADROOM bytes of header space (PBUF_LINK or larger).
+ *
+ *  @pre This function must only be called when the Device state machine is in the @ref DEVICE_STATE_Configured state or the
+ *       call will fail.
+ *
+ *  @param	RNDISInterfaceInfo	: Pointer to a structure containing an RNDIS Class configuration and state.
+ *  @param	Segments	: Segments of the frame, the first one preceded by @ref RNDIS_DEVICE_PACKET_HEADROOM writable bytes.
+ *  @param	TotalSegments	: Number of entries in @a Segments.
+ *
+ *  @return	 A value from the @ref Endpoint_Stream_RW_ErrorCodes_t enum.
+ */
+uint8_t RNDIS_Device_SendPacketChain(USB_ClassInfo_RNDIS_Device_t *const RNDISInterfaceInfo,
+									 const RNDIS_Packet_Segment_t *Segments,
+									 const uint8_t TotalSegments);
+
 /* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 /* Function Prototypes: */
@@ -201,6 +263,11 @@ static bool RNDIS_Device_ProcessNDISSet(USB_ClassInfo_RNDIS_Device_t *const RNDI
 										const uint16_t SetSize) ATTR_NON_NULL_PTR_ARG(1)
 ATTR_NON_NULL_PTR_ARG(3);
 
+static void RNDIS_Device_WriteData(USB_ClassInfo_RNDIS_Device_t *const RNDISInterfaceInfo,
+								   const uint8_t *Data,
+								   uint16_t Length,
+								   const bool MoreData) ATTR_NON_NULL_PTR_ARG(1);
+
 		#endif
 
 	#endif
@@ -249,5 +249,36 @@ uint8_t Audio_Host_GetSetEndpointProperty(USB_ClassInfo_Audio_Host_t* const Audi
 	return USB_Host_SendControlRequest(portnum,Data);
 }
 
+uint8_t Audio_Host_StartOutputStream(USB_ClassInfo_Audio_Host_t* const AudioInterfaceInfo,
+                                     uint8_t* const RingBuffer,
+                                     const uint16_t SlotSize,
+                                     const uint8_t NumSlots,
+                                     HCD_ISO_FILL_CALLBACK Fill,
+                                     void* UserArg)
+{
+	uint8_t portnum = AudioInterfaceInfo->Config.PortNumber;
+
+	if ((USB_HostState[portnum] != HOST_STATE_Configured) || !(AudioInterfaceInfo->State.IsActive))
+	  return HCD_STATUS_DEVICE_DISCONNECTED;
+
+	return HcdIsoStreamStart(PipeInfo[portnum][AudioInterfaceInfo->Config.DataOUTPipeNumber].PipeHandle,
+	                         RingBuffer, SlotSize, NumSlots, Fill, UserArg);
+}
+
+uint8_t Audio_Host_StopOutputStream(USB_ClassInfo_Audio_Host_t* const AudioInterfaceInfo)
+{
+	uint8_t portnum = AudioInterfaceInfo->Config.PortNumber;
+
+	return HcdIsoStreamStop(PipeInfo[portnum][AudioInterfaceInfo->Config.DataOUTPipeNumber].PipeHandle);
+}
+
+uint8_t Audio_Host_GetOutputStreamStats(USB_ClassInfo_Audio_Host_t* const AudioInterfaceInfo,
+                                        HCD_ISO_STREAM_STATS* const Stats)
+{
+	uint8_t portnum = AudioInterfaceInfo->Config.PortNumber;
+
+	return HcdIsoStreamGetStats(PipeInfo[portnum][AudioInterfaceInfo->Config.DataOUTPipeNumber].PipeHandle, Stats);
+}
+
 #endif
 
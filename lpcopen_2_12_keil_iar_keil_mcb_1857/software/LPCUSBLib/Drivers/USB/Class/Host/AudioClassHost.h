@@ -164,6 +164,46 @@
 			                                          const uint16_t DataLength,
 			                                          void* const Data) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(6);
 
+			/** @brief Starts continuous streaming on the OUT data pipe from a ring of frame slots, refilled by a callback
+			 *  from the host controller interrupt as each frame is sent. This replaces writing samples one by one with
+			 *  @ref Audio_Host_WriteSample16() and friends.
+			 *
+			 *  @pre Streaming must already be enabled with @ref Audio_Host_StartStopStreaming().
+			 *
+			 *  @param AudioInterfaceInfo : Pointer to a structure containing an Audio Class host configuration and state.
+			 *  @param RingBuffer         : NumSlots * SlotSize bytes of buffer used by the stream until it is stopped.
+			 *  @param SlotSize           : Maximum number of bytes sent in one frame, up to the OUT pipe size.
+			 *  @param NumSlots           : Number of frames queued ahead of the host controller.
+			 *  @param Fill               : Callback writing the next frame of samples, see @ref HCD_ISO_FILL_CALLBACK.
+			 *  @param UserArg            : User argument passed to Fill.
+			 *
+			 *  @return A value from the @ref HCD_STATUS enum, HCD_STATUS_OK on success.
+			 */
+			uint8_t Audio_Host_StartOutputStream(USB_ClassInfo_Audio_Host_t* const AudioInterfaceInfo,
+			                                     uint8_t* const RingBuffer,
+			                                     const uint16_t SlotSize,
+			                                     const uint8_t NumSlots,
+			                                     HCD_ISO_FILL_CALLBACK Fill,
+			                                     void* UserArg) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** @brief Stops the output stream started by @ref Audio_Host_StartOutputStream().
+			 *
+			 *  @param AudioInterfaceInfo : Pointer to a structure containing an Audio Class host configuration and state.
+			 *
+			 *  @return A value from the @ref HCD_STATUS enum, HCD_STATUS_OK on success.
+			 */
+			uint8_t Audio_Host_StopOutputStream(USB_ClassInfo_Audio_Host_t* const AudioInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** @brief Reads the frame, underrun and late frame counters of the output stream.
+			 *
+			 *  @param AudioInterfaceInfo : Pointer to a structure containing an Audio Class host configuration and state.
+			 *  @param Stats              : Pointer to where the counters are stored.
+			 *
+			 *  @return A value from the @ref HCD_STATUS enum, HCD_STATUS_OK on success.
+			 */
+			uint8_t Audio_Host_GetOutputStreamStats(USB_ClassInfo_Audio_Host_t* const AudioInterfaceInfo,
+			                                        HCD_ISO_STREAM_STATS* const Stats) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
 		/* Inline Functions: */
 			/** @brief General management task for a given Audio host class interface, required for the correct operation of
 			 *  the interface. This should be called frequently in the main program loop, before the master USB management task
@@ -473,6 +473,178 @@ uint8_t CDC_Host_Flush(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo)
 	return PIPE_READYWAIT_NoError;
 }
 
+/* Arms the slot after the filled ones, called with no transfer queued on the pipe */
+static bool CDC_Host_RxArm(CDC_Host_RxRing_t* const Ring)
+{
+	uint8_t    Head = Ring->Head;
+	uint8_t    Full = (uint8_t)((Head + (2 * Ring->SlotCount) - Ring->Tail) % (2 * Ring->SlotCount));
+	HCD_STATUS Status;
+
+	if (Full == Ring->SlotCount)
+	  return false;
+
+	Ring->Received       = 0;
+	Ring->Armed          = true;
+	Ring->TransferStatus = HCD_STATUS_TRANSFER_QUEUED;
+
+	Status = HcdDataTransferAsync(Ring->PipeHandle, &Ring->Buffer[(uint32_t)(Head % Ring->SlotCount) * Ring->SlotSize],
+	                              Ring->SlotSize, (uint16_t*)&Ring->Received, CDC_Host_RxDone, Ring);
+	if (Status != HCD_STATUS_OK)
+	{
+		Ring->Armed          = false;
+		Ring->TransferStatus = Status;
+		return false;
+	}
+
+	return true;
+}
+
+/* Called from the host controller interrupt, stores the slot and rearms the pipe into the next one */
+static void CDC_Host_RxDone(uint32_t PipeHandle,
+                            HCD_STATUS Status,
+                            void* pArg)
+{
+	CDC_Host_RxRing_t* const Ring = (CDC_Host_RxRing_t*)pArg;
+
+	(void)PipeHandle;
+
+	Ring->Armed          = false;
+	Ring->TransferStatus = Status;
+
+	if (Status != HCD_STATUS_OK)
+	  return;
+
+	/* A zero length packet leaves the slot empty, so it is simply armed again */
+	if (Ring->Received)
+	{
+		Ring->SlotLength[Ring->Head % Ring->SlotCount] = Ring->Received;
+		Ring->Head = (uint8_t)((Ring->Head + 1) % (2 * Ring->SlotCount));
+	}
+
+	if (!(CDC_Host_RxArm(Ring)) && (Ring->TransferStatus == HCD_STATUS_OK))
+	  Ring->FullCount++;
+}
+
+uint8_t CDC_Host_RxStart(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo,
+                         CDC_Host_RxRing_t* const Ring,
+                         void* Buffer,
+                         uint16_t SlotSize,
+                         const uint8_t SlotCount)
+{
+	uint8_t portnum = CDCInterfaceInfo->Config.PortNumber;
+
+	if ((USB_HostState[portnum] != HOST_STATE_Configured) || !(CDCInterfaceInfo->State.IsActive))
+	  return PIPE_RWSTREAM_DeviceDisconnected;
+
+	SlotSize  = MIN(SlotSize, 0x4000);
+	SlotSize -= (SlotSize % CDCInterfaceInfo->State.DataINPipeSize);
+	if (!(SlotSize) || (SlotCount < 2) || (SlotCount > CDC_HOST_RX_MAX_SLOTS))
+	  return PIPE_RWSTREAM_IncompleteTransfer;
+
+	memset(Ring, 0x00, sizeof(CDC_Host_RxRing_t));
+
+	Ring->Buffer         = (uint8_t*)Buffer;
+	Ring->SlotSize       = SlotSize;
+	Ring->SlotCount      = SlotCount;
+	Ring->TransferStatus = HCD_STATUS_OK;
+
+	Pipe_SelectPipe(portnum,CDCInterfaceInfo->Config.DataINPipeNumber);
+	Ring->PipeHandle = PipeInfo[portnum][pipeselected[portnum]].PipeHandle;
+
+	CDC_Host_RxArm(Ring);
+
+	return (Ring->TransferStatus == HCD_STATUS_TRANSFER_QUEUED) ? PIPE_RWSTREAM_NoError : PIPE_RWSTREAM_IncompleteTransfer;
+}
+
+void CDC_Host_RxStop(CDC_Host_RxRing_t* const Ring)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (Ring->Armed)
+	  HcdCancelTransfer(Ring->PipeHandle);
+
+	Ring->Armed          = false;
+	Ring->TransferStatus = HCD_STATUS_TRANSFER_ERROR;
+	__set_PRIMASK(primask);
+}
+
+uint8_t CDC_Host_RxTask(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo,
+                        CDC_Host_RxRing_t* const Ring)
+{
+	uint8_t portnum = CDCInterfaceInfo->Config.PortNumber;
+
+	if ((USB_HostState[portnum] != HOST_STATE_Configured) || !(CDCInterfaceInfo->State.IsActive))
+	  return PIPE_RWSTREAM_DeviceDisconnected;
+
+	/* No completion interrupt can arrive for the pipe while the ring is not armed */
+	if (Ring->Armed)
+	  return PIPE_RWSTREAM_NoError;
+
+	if (Ring->TransferStatus == HCD_STATUS_TRANSFER_Stall)
+	{
+		Pipe_SelectPipe(portnum,CDCInterfaceInfo->Config.DataINPipeNumber);
+		USB_Host_ClearEndpointStall(portnum,Pipe_GetBoundEndpointAddress(portnum));
+
+		Ring->TransferStatus = HCD_STATUS_OK;
+		CDC_Host_RxArm(Ring);
+
+		return PIPE_RWSTREAM_PipeStalled;
+	}
+
+	if (Ring->TransferStatus != HCD_STATUS_OK)
+	  return PIPE_RWSTREAM_IncompleteTransfer;
+
+	CDC_Host_RxArm(Ring);
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+uint32_t CDC_Host_RxBytesAvailable(const CDC_Host_RxRing_t* const Ring)
+{
+	uint8_t  Head  = Ring->Head;
+	uint8_t  Tail  = Ring->Tail;
+	uint32_t Bytes = 0;
+
+	while (Tail != Head)
+	{
+		Bytes += Ring->SlotLength[Tail % Ring->SlotCount];
+		Tail   = (uint8_t)((Tail + 1) % (2 * Ring->SlotCount));
+	}
+
+	return Bytes - Ring->ReadOffset;
+}
+
+uint16_t CDC_Host_RxRead(CDC_Host_RxRing_t* const Ring,
+                         void* const Buffer,
+                         const uint16_t Length)
+{
+	uint8_t* DataPtr = (uint8_t*)Buffer;
+	uint16_t Copied  = 0;
+
+	while ((Copied < Length) && (Ring->Tail != Ring->Head))
+	{
+		uint8_t  Slot = Ring->Tail % Ring->SlotCount;
+		uint16_t Copy = MIN(Length - Copied, Ring->SlotLength[Slot] - Ring->ReadOffset);
+
+		memcpy(&DataPtr[Copied], &Ring->Buffer[((uint32_t)Slot * Ring->SlotSize) + Ring->ReadOffset], Copy);
+		Copied           += Copy;
+		Ring->ReadOffset += Copy;
+
+		if (Ring->ReadOffset == Ring->SlotLength[Slot])
+		{
+			Ring->ReadOffset = 0;
+			Ring->Tail       = (uint8_t)((Ring->Tail + 1) % (2 * Ring->SlotCount));
+		}
+	}
+
+	/* Restart a ring that filled up, the interrupt stops arming once no slot is free */
+	if (Copied && !(Ring->Armed) && (Ring->TransferStatus == HCD_STATUS_OK))
+	  CDC_Host_RxArm(Ring);
+
+	return Copied;
+}
+
 #if (defined(FDEV_SETUP_STREAM) && (!defined(__IAR_SYSTEMS_ICC__) || (_DLIB_FILE_DESCRIPTOR == 1)))
 void CDC_Host_CreateStream(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo,
                            FILE* const Stream)
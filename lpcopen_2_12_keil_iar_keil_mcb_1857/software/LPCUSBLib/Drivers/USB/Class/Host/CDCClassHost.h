@@ -63,6 +63,12 @@
 		#endif
 
 	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			#if !defined(CDC_HOST_RX_MAX_SLOTS)
+				/** Maximum number of slots in a @ref CDC_Host_RxRing_t receive ring, at most 127. */
+				#define CDC_HOST_RX_MAX_SLOTS        8
+			#endif
+
 		/* Type Defines: */
 			/** @brief CDC Class Host Mode Configuration and State Structure.
 			 *
@@ -123,6 +129,32 @@
 						  */
 			} USB_ClassInfo_CDC_Host_t;
 
+			/** @brief CDC Class Host Mode Receive Ring Structure.
+			 *
+			 *  Ring of slots filled by an always-armed bulk IN transfer on the CDC data pipe. Each completed transfer is
+			 *  stored and the next free slot armed from the host controller interrupt, so the device is only NAKed when the
+			 *  application lets the ring fill up. The interrupt only writes \c Head and the application only writes
+			 *  \c Tail, so no locking is needed. An instance of this structure should be made within the user application
+			 *  and set up with @ref CDC_Host_RxStart().
+			 *
+			 *  @note @ref CDC_Host_BytesReceived() and @ref CDC_Host_ReceiveByte() must not be used while the ring runs.
+			 */
+			typedef struct
+			{
+				uint8_t* Buffer; /**< Ring storage of \c SlotCount slots of \c SlotSize bytes each. */
+				uint16_t SlotSize; /**< Size in bytes of each slot, a whole number of IN pipe packets. */
+				uint8_t  SlotCount; /**< Number of slots in the ring. */
+				volatile uint8_t  Head; /**< Count of filled slots, modulo twice \c SlotCount. Written by the interrupt only. */
+				volatile uint8_t  Tail; /**< Count of read slots, modulo twice \c SlotCount. Written by the application only. */
+				uint16_t ReadOffset; /**< Bytes already read from the oldest filled slot. */
+				volatile uint16_t SlotLength[CDC_HOST_RX_MAX_SLOTS]; /**< Bytes received into each filled slot. */
+				volatile uint16_t Received; /**< Byte count of the transfer on the bus, updated by the host controller driver. */
+				volatile bool     Armed; /**< Indicates a bulk IN transfer into the ring is queued. */
+				volatile uint8_t  TransferStatus; /**< \ref HCD_STATUS of the last finished or failed transfer. */
+				volatile uint32_t FullCount; /**< Number of times the ring filled up and the device was left NAKed. */
+				uint32_t PipeHandle; /**< Host controller handle of the IN data pipe. */
+			} CDC_Host_RxRing_t;
+
 		/* Enums: */
 			/** Enum for the possible error codes returned by the @ref CDC_Host_ConfigurePipes() function. */
 			enum CDC_Host_EnumerationFailure_ErrorCodes_t
@@ -277,6 +309,67 @@
 			 */
 			uint8_t CDC_Host_Flush(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 
+			/** @brief Sets up a receive ring on the CDC data IN pipe and arms the first transfer. The slot size is rounded down to
+			 *  a whole number of IN pipe packets, and limited to 16KB so each transfer fits a single transfer descriptor.
+			 *
+			 *  @pre This function must only be called when the Host state machine is in the @ref HOST_STATE_Configured state or the
+			 *       call will fail.
+			 *
+			 *  @param CDCInterfaceInfo : Pointer to a structure containing a CDC Class host configuration and state.
+			 *  @param Ring             : Pointer to the receive ring to set up.
+			 *  @param Buffer           : Ring storage of at least \c SlotSize * \c SlotCount bytes, reachable by the USB DMA.
+			 *  @param SlotSize         : Size in bytes of each ring slot.
+			 *  @param SlotCount        : Number of ring slots, from 2 to @ref CDC_HOST_RX_MAX_SLOTS.
+			 *
+			 *  @return A value from the @ref Pipe_Stream_RW_ErrorCodes_t enum.
+			 */
+			uint8_t CDC_Host_RxStart(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo,
+			                         CDC_Host_RxRing_t* const Ring,
+			                         void* Buffer,
+			                         uint16_t SlotSize,
+			                         const uint8_t SlotCount) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2)
+			                         ATTR_NON_NULL_PTR_ARG(3);
+
+			/** @brief Stops a receive ring, cancelling the armed transfer. Data already in the ring can still be read.
+			 *
+			 *  @param Ring : Pointer to the receive ring.
+			 *	@return	Nothing
+			 */
+			void CDC_Host_RxStop(CDC_Host_RxRing_t* const Ring) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** @brief Management task for a receive ring. This should be called frequently in the main program loop alongside
+			 *  @ref CDC_Host_USBTask(). It clears a stalled data pipe and rearms the ring, and reports transfer errors.
+			 *
+			 *  @param CDCInterfaceInfo : Pointer to a structure containing a CDC Class host configuration and state.
+			 *  @param Ring             : Pointer to the receive ring.
+			 *
+			 *  @return A value from the @ref Pipe_Stream_RW_ErrorCodes_t enum. After an error other than a stall the ring stays
+			 *          stopped until @ref CDC_Host_RxStart() is called again.
+			 */
+			uint8_t CDC_Host_RxTask(USB_ClassInfo_CDC_Host_t* const CDCInterfaceInfo,
+			                        CDC_Host_RxRing_t* const Ring) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** @brief Determines the number of received bytes waiting in a receive ring.
+			 *
+			 *  @param Ring : Pointer to the receive ring.
+			 *
+			 *  @return Total number of bytes that @ref CDC_Host_RxRead() can return immediately.
+			 */
+			uint32_t CDC_Host_RxBytesAvailable(const CDC_Host_RxRing_t* const Ring) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** @brief Reads a block of received data from a receive ring, without waiting for more to arrive. Each slot emptied
+			 *  is handed back to the interrupt, which rearms the pipe straight away if the ring had filled up.
+			 *
+			 *  @param Ring   : Pointer to the receive ring.
+			 *  @param Buffer : Pointer to a buffer where the received data is to be stored.
+			 *  @param Length : Size in bytes of the buffer.
+			 *
+			 *  @return Number of bytes copied into the buffer.
+			 */
+			uint16_t CDC_Host_RxRead(CDC_Host_RxRing_t* const Ring,
+			                         void* const Buffer,
+			                         const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
 	#if (!defined(__IAR_SYSTEMS_ICC__) || (_DLIB_FILE_DESCRIPTOR == 1))
 			/** @brief Creates a standard character stream for the given CDC Device instance so that it can be used with all the regular
 			 *  functions in the standard \c <stdio.h> library that accept a \c FILE stream as a destination (e.g. \c fprintf). The created
@@ -346,6 +439,10 @@
 				                                                   ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
 				static uint8_t DCOMP_CDC_Host_NextCDCInterfaceEndpoint(void* const CurrentDescriptor)
 				                                                       ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+				static bool CDC_Host_RxArm(CDC_Host_RxRing_t* const Ring) ATTR_NON_NULL_PTR_ARG(1);
+				static void CDC_Host_RxDone(uint32_t PipeHandle,
+				                            HCD_STATUS Status,
+				                            void* pArg);
 			#endif
 	#endif
 
@@ -263,6 +263,11 @@ uint8_t HID_Host_ReceiveReport(USB_ClassInfo_HID_Host_t* const HIDInterfaceInfo,
 	Pipe_ClearIN(portnum);
 	Pipe_Freeze();
 
+#if !defined(HID_HOST_BOOT_PROTOCOL_ONLY)
+	if (!(HIDInterfaceInfo->State.UsingBootProtocol) && (HIDInterfaceInfo->Config.HIDCompiledData != NULL))
+	  USB_DecodeHIDReport(HIDInterfaceInfo->Config.HIDCompiledData, Buffer, (BufferPos - (uint8_t*)Buffer) + ReportSize);
+#endif
+
 	return PIPE_RWSTREAM_NoError;
 }
 
@@ -430,6 +435,9 @@ uint8_t HID_Host_SetReportProtocol(USB_ClassInfo_HID_Host_t* const HIDInterfaceI
 		return HID_ERROR_LOGICAL | ErrorCode;
 	}
 
+	if (HIDInterfaceInfo->Config.HIDCompiledData != NULL)
+	  USB_CompileHIDReport(HIDInterfaceInfo->Config.HIDParserData, HIDInterfaceInfo->Config.HIDCompiledData);
+
 	uint8_t LargestReportSizeBits = HIDInterfaceInfo->Config.HIDParserData->LargestReportSizeBits;
 	HIDInterfaceInfo->State.LargestReportSize = (LargestReportSizeBits >> 3) + ((LargestReportSizeBits & 0x07) != 0);
 
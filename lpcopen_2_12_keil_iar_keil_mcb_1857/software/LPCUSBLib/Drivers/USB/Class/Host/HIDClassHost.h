@@ -93,6 +93,14 @@
 					                                  *  @note When the \c HID_HOST_BOOT_PROTOCOL_ONLY compile time token is defined,
 					                                  *        this method is unavailable.
 					                                  */
+					HID_CompiledReport_t* HIDCompiledData; /**< Optional compiled form of \c HIDParserData, built by
+					                                        *   @ref HID_Host_SetReportProtocol(). When set, each report read by
+					                                        *   @ref HID_Host_ReceiveReport() is decoded into the \c Value of its
+					                                        *   parsed report items by table lookup. May be \c NULL.
+					                                        *
+					                                        *  @note When the \c HID_HOST_BOOT_PROTOCOL_ONLY compile time token is defined,
+					                                        *        this method is unavailable.
+					                                        */
 					#endif
 
 					uint8_t  PortNumber;		/**< Port number that this interface is running.
@@ -166,6 +174,9 @@
 			 *  @note The destination buffer should be large enough to accommodate the largest report that the attached device
 			 *        can generate.
 			 *
+			 *  @note In Report protocol mode with a \c HIDCompiledData table configured, the report items of the received report
+			 *        are also decoded into their \c Value members.
+			 *
 			 *  @param HIDInterfaceInfo : Pointer to a structure containing a HID Class host configuration and state.
 			 *  @param Buffer           : Buffer to store the received report into.
 			 *
@@ -262,6 +273,7 @@
 			#if !defined(HID_HOST_BOOT_PROTOCOL_ONLY)
 			/** @brief Switches the attached HID device's reporting protocol over to the standard Report protocol mode. This also retrieves
 			 *  and parses the device's HID report descriptor, so that the size of each report can be determined in advance.
+			 *  If a \c HIDCompiledData table is configured, the parsed IN items are also compiled into it.
 			 *
 			 *  @note Whether this function is used or not, the @ref CALLBACK_HIDParser_FilterHIDReportItem() callback from the HID
 			 *        Report Parser this function references <b>must</b> be implemented in the user code.
@@ -272,7 +272,7 @@ static uint8_t MS_Host_SendReceiveData(USB_ClassInfo_MS_Host_t* const MSInterfac
                                        MS_CommandBlockWrapper_t* const SCSICommandBlock,
                                        void* BufferPtr)
 {
-	uint16_t BytesRem  = le32_to_cpu(SCSICommandBlock->DataTransferLength);
+	uint32_t BytesRem  = le32_to_cpu(SCSICommandBlock->DataTransferLength);
 	uint8_t portnum = MSInterfaceInfo->Config.PortNumber;
 #if defined(__LPC177X_8X__) || defined(__LPC407X_8X__)
 	uint8_t  ErrorCode = PIPE_RWSTREAM_NoError;
@@ -584,16 +584,13 @@ uint8_t MS_Host_PreventAllowMediumRemoval(USB_ClassInfo_MS_Host_t* const MSInter
 	return PIPE_RWSTREAM_NoError;
 }
 
-uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
-                                 const uint8_t LUNIndex,
-                                 const uint32_t BlockAddress,
-                                 const uint8_t Blocks,
-                                 const uint16_t BlockSize,
-                                 void* BlockBuffer)
+static uint8_t MS_Host_Read10(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+                              const uint8_t LUNIndex,
+                              const uint32_t BlockAddress,
+                              const uint16_t Blocks,
+                              const uint16_t BlockSize,
+                              void* BlockBuffer)
 {
-	if ((USB_HostState[MSInterfaceInfo->Config.PortNumber] != HOST_STATE_Configured) || !(MSInterfaceInfo->State.IsActive))
-	  return HOST_SENDCONTROL_DeviceDisconnected;
-
 	uint8_t ErrorCode;
 
 	MS_CommandBlockWrapper_t SCSICommandBlock = (MS_CommandBlockWrapper_t)
@@ -611,8 +608,8 @@ uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
 					(BlockAddress >> 8),
 					(BlockAddress & 0xFF),  // LSB of Block Address
 					0x00,                   // Reserved
-					0x00,                   // MSB of Total Blocks to Read
-					Blocks,                 // LSB of Total Blocks to Read
+					(Blocks >> 8),          // MSB of Total Blocks to Read
+					(Blocks & 0xFF),        // LSB of Total Blocks to Read
 					0x00                    // Unused (control)
 				}
 		};
@@ -623,10 +620,65 @@ uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
 	return PIPE_RWSTREAM_NoError;
 }
 
+uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
+                                 const uint8_t LUNIndex,
+                                 const uint32_t BlockAddress,
+                                 const uint16_t Blocks,
+                                 const uint16_t BlockSize,
+                                 void* BlockBuffer)
+{
+	if ((USB_HostState[MSInterfaceInfo->Config.PortNumber] != HOST_STATE_Configured) || !(MSInterfaceInfo->State.IsActive))
+	  return HOST_SENDCONTROL_DeviceDisconnected;
+
+	uint8_t  ErrorCode;
+	uint32_t CacheCapacity = (BlockSize == 0) ? 0 : (MSInterfaceInfo->Config.ReadAheadBufferSize / BlockSize);
+	bool     Sequential    = (BlockAddress == MSInterfaceInfo->State.NextBlockAddress);
+
+	if (CacheCapacity > 0xFFFF)
+	  CacheCapacity = 0xFFFF;
+
+	MSInterfaceInfo->State.NextBlockAddress = BlockAddress + Blocks;
+
+	if ((MSInterfaceInfo->Config.ReadAheadBuffer == NULL) || (Blocks >= CacheCapacity))
+	  return MS_Host_Read10(MSInterfaceInfo, LUNIndex, BlockAddress, Blocks, BlockSize, BlockBuffer);
+
+	/* Served entirely from the cache */
+	if (MSInterfaceInfo->State.CacheBlocks && (MSInterfaceInfo->State.CacheLUN == LUNIndex) &&
+	    (MSInterfaceInfo->State.CacheBlockSize == BlockSize) &&
+	    (BlockAddress >= MSInterfaceInfo->State.CacheBlockAddress) &&
+	    ((BlockAddress + Blocks) <= (MSInterfaceInfo->State.CacheBlockAddress + MSInterfaceInfo->State.CacheBlocks)))
+	{
+		memcpy(BlockBuffer, (uint8_t*)MSInterfaceInfo->Config.ReadAheadBuffer +
+		       (BlockAddress - MSInterfaceInfo->State.CacheBlockAddress) * BlockSize, (uint32_t)Blocks * BlockSize);
+		return PIPE_RWSTREAM_NoError;
+	}
+
+	if (!(Sequential))
+	  return MS_Host_Read10(MSInterfaceInfo, LUNIndex, BlockAddress, Blocks, BlockSize, BlockBuffer);
+
+	/* Sequential miss: fetch a whole cache worth in one CBW/data/CSW exchange */
+	MSInterfaceInfo->State.CacheBlocks = 0;
+
+	if ((ErrorCode = MS_Host_Read10(MSInterfaceInfo, LUNIndex, BlockAddress, CacheCapacity, BlockSize,
+	                                MSInterfaceInfo->Config.ReadAheadBuffer)) != PIPE_RWSTREAM_NoError)
+	{
+		/* Most likely ran past the end of the medium, read just what was asked for */
+		return MS_Host_Read10(MSInterfaceInfo, LUNIndex, BlockAddress, Blocks, BlockSize, BlockBuffer);
+	}
+
+	MSInterfaceInfo->State.CacheBlockAddress = BlockAddress;
+	MSInterfaceInfo->State.CacheBlocks       = CacheCapacity;
+	MSInterfaceInfo->State.CacheBlockSize    = BlockSize;
+	MSInterfaceInfo->State.CacheLUN          = LUNIndex;
+
+	memcpy(BlockBuffer, MSInterfaceInfo->Config.ReadAheadBuffer, (uint32_t)Blocks * BlockSize);
+	return PIPE_RWSTREAM_NoError;
+}
+
 uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
                                   const uint8_t LUNIndex,
                                   const uint32_t BlockAddress,
-                                  const uint8_t Blocks,
+                                  const uint16_t Blocks,
                                   const uint16_t BlockSize,
                                   const void* BlockBuffer)
 {
@@ -635,6 +687,14 @@ uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo
 
 	uint8_t ErrorCode;
 
+	/* Drop the read-ahead cache if the write overlaps it */
+	if (MSInterfaceInfo->State.CacheBlocks && (MSInterfaceInfo->State.CacheLUN == LUNIndex) &&
+	    (BlockAddress < (MSInterfaceInfo->State.CacheBlockAddress + MSInterfaceInfo->State.CacheBlocks)) &&
+	    ((BlockAddress + Blocks) > MSInterfaceInfo->State.CacheBlockAddress))
+	{
+		MSInterfaceInfo->State.CacheBlocks = 0;
+	}
+
 	MS_CommandBlockWrapper_t SCSICommandBlock = (MS_CommandBlockWrapper_t)
 		{
 			.DataTransferLength = cpu_to_le32((uint32_t)Blocks * BlockSize),
@@ -650,8 +710,8 @@ uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo
 					(BlockAddress >> 8),
 					(BlockAddress & 0xFF),  // LSB of Block Address
 					0x00,                   // Reserved
-					0x00,                   // MSB of Total Blocks to Write
-					Blocks,                 // LSB of Total Blocks to Write
+					(Blocks >> 8),          // MSB of Total Blocks to Write
+					(Blocks & 0xFF),        // LSB of Total Blocks to Write
 					0x00                    // Unused (control)
 				}
 		};
@@ -83,6 +83,10 @@
 					bool     DataOUTPipeDoubleBank; /**< Indicates if the Mass Storage interface's OUT data pipe should use double banking. */
 					uint8_t  PortNumber;		/**< Port number that this interface is running.
 												*/
+					void*    ReadAheadBuffer; /**< Optional host side block cache for sequential read-ahead, in USB DMA reachable
+					                           *   RAM. NULL disables read-ahead.
+					                           */
+					uint32_t ReadAheadBufferSize; /**< Size in bytes of \c ReadAheadBuffer. */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
@@ -98,6 +102,12 @@
 					uint16_t DataOUTPipeSize;  /**< Size in bytes of the Mass Storage interface's OUT data pipe. */
 
 					uint32_t TransactionTag; /**< Current transaction tag for data synchronizing of packets. */
+
+					uint32_t CacheBlockAddress; /**< First block held in the read-ahead cache. */
+					uint16_t CacheBlocks; /**< Valid blocks in the read-ahead cache, zero when empty. */
+					uint16_t CacheBlockSize; /**< Block size the read-ahead cache was filled with. */
+					uint8_t  CacheLUN; /**< LUN the read-ahead cache was filled from. */
+					uint32_t NextBlockAddress; /**< Block following the previous read, used to detect sequential reads. */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 						  *   <b>may</b> be set to initial values, but may also be ignored to default to sane values when
 						  *   the interface is enumerated.
@@ -245,6 +255,10 @@
 			                                          const bool PreventRemoval) ATTR_NON_NULL_PTR_ARG(1);
 
 			/** @brief Reads blocks of data from the attached Mass Storage device's medium.
+			 *
+			 *  When \c Config.ReadAheadBuffer is set, a read that continues where the previous read stopped fetches a
+			 *  whole cache worth of blocks in one command, and later reads inside the cached range are served
+			 *  without any bus traffic. Writes invalidate overlapping cached blocks.
 			 *
 			 *  @pre This function must only be called when the Host state machine is in the @ref HOST_STATE_Configured state or the
 			 *       call will fail.
@@ -261,7 +275,7 @@
 			uint8_t MS_Host_ReadDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
 			                                 const uint8_t LUNIndex,
 			                                 const uint32_t BlockAddress,
-			                                 const uint8_t Blocks,
+			                                 const uint16_t Blocks,
 			                                 const uint16_t BlockSize,
 			                                 void* BlockBuffer) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(6);
 
@@ -282,7 +296,7 @@
 			uint8_t MS_Host_WriteDeviceBlocks(USB_ClassInfo_MS_Host_t* const MSInterfaceInfo,
 			                                  const uint8_t LUNIndex,
 			                                  const uint32_t BlockAddress,
-			                                  const uint8_t Blocks,
+			                                  const uint16_t Blocks,
 			                                  const uint16_t BlockSize,
 			                                  const void* BlockBuffer) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(6);
 
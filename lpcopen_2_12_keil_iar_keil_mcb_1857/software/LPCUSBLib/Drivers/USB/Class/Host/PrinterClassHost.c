@@ -334,6 +334,238 @@ uint8_t PRNT_Host_SendData(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo,
 	return ErrorCode;
 }
 
+static void PRNT_Host_JobSubmit(PRNT_Host_Job_t* const Job,
+                                const uint16_t Length)
+{
+	HCD_STATUS Status;
+
+	Job->SendLength     = Length;
+	Job->InFlight       = true;
+	Job->TransferStatus = HCD_STATUS_TRANSFER_QUEUED;
+
+	Status = HcdDataTransferAsync(Job->PipeHandle, &Job->Buffer[(uint32_t)Job->SendSlot * Job->SlotSize], Length,
+	                              NULL, PRNT_Host_JobTransferDone, Job);
+	if (Status != HCD_STATUS_OK)
+	{
+		Job->InFlight       = false;
+		Job->TransferStatus = Status;
+	}
+}
+
+/* Called from the host controller interrupt, chains the next filled slot straight after the last one */
+static void PRNT_Host_JobTransferDone(uint32_t PipeHandle,
+                                      HCD_STATUS Status,
+                                      void* pArg)
+{
+	PRNT_Host_Job_t* const Job = (PRNT_Host_Job_t*)pArg;
+
+	(void)PipeHandle;
+
+	Job->TransferStatus = Status;
+
+	if (Status != HCD_STATUS_OK)
+	{
+		Job->InFlight = false;
+		return;
+	}
+
+	Job->BytesSent += Job->SendLength;
+	Job->SendSlot   = (Job->SendSlot + 1) % Job->SlotCount;
+	Job->SlotsFull--;
+
+	if (Job->SlotsFull && !(Job->Paused))
+	  PRNT_Host_JobSubmit(Job, Job->SlotSize);
+	else
+	  Job->InFlight = false;
+}
+
+uint8_t PRNT_Host_JobInit(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo,
+                          PRNT_Host_Job_t* const Job,
+                          void* Buffer,
+                          uint16_t SlotSize,
+                          const uint8_t SlotCount)
+{
+	uint8_t portnum = PRNTInterfaceInfo->Config.PortNumber;
+
+	if ((USB_HostState[portnum] != HOST_STATE_Configured) || !(PRNTInterfaceInfo->State.IsActive))
+	  return PIPE_RWSTREAM_DeviceDisconnected;
+
+	SlotSize -= (SlotSize % PRNTInterfaceInfo->State.DataOUTPipeSize);
+	if (!(SlotSize) || !(SlotCount))
+	  return PIPE_RWSTREAM_IncompleteTransfer;
+
+	memset(Job, 0x00, sizeof(PRNT_Host_Job_t));
+
+	Job->Buffer              = (uint8_t*)Buffer;
+	Job->SlotSize            = SlotSize;
+	Job->SlotCount           = SlotCount;
+	Job->TransferStatus      = HCD_STATUS_OK;
+	Job->ErrorCode           = PIPE_RWSTREAM_NoError;
+	Job->PreviousFrameNumber = USB_Host_GetFrameNumber();
+	Job->TimeoutMSRem        = PRNT_JOB_DATA_TIMEOUT_MS;
+
+	Pipe_SelectPipe(portnum,PRNTInterfaceInfo->Config.DataOUTPipeNumber);
+	Job->PipeHandle = PipeInfo[portnum][pipeselected[portnum]].PipeHandle;
+	HcdSetStreamPacketSize(Job->PipeHandle, PRNTInterfaceInfo->State.DataOUTPipeSize);
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+uint8_t PRNT_Host_JobWrite(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo,
+                           PRNT_Host_Job_t* const Job,
+                           const void* Data,
+                           uint16_t Length,
+                           uint16_t* const BytesAccepted)
+{
+	const uint8_t* DataPtr  = (const uint8_t*)Data;
+	uint16_t       Accepted = 0;
+	uint32_t       primask;
+
+	/* The slot being filled is never one of the filled slots, so it can be written without locking */
+	while (Length && (Job->SlotsFull < Job->SlotCount))
+	{
+		uint16_t Copy = MIN(Length, Job->SlotSize - Job->FillLength);
+
+		memcpy(&Job->Buffer[((uint32_t)Job->FillSlot * Job->SlotSize) + Job->FillLength], DataPtr, Copy);
+		DataPtr         += Copy;
+		Length          -= Copy;
+		Accepted        += Copy;
+		Job->FillLength += Copy;
+
+		if (Job->FillLength == Job->SlotSize)
+		{
+			Job->FillLength = 0;
+			Job->FillSlot   = (Job->FillSlot + 1) % Job->SlotCount;
+
+			primask = __get_PRIMASK();
+			__disable_irq();
+			Job->SlotsFull++;
+			__set_PRIMASK(primask);
+		}
+	}
+
+	if (BytesAccepted)
+	  *BytesAccepted = Accepted;
+
+	return PRNT_Host_JobTask(PRNTInterfaceInfo, Job);
+}
+
+uint8_t PRNT_Host_JobTask(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo,
+                          PRNT_Host_Job_t* const Job)
+{
+	uint8_t  portnum = PRNTInterfaceInfo->Config.PortNumber;
+	uint16_t CurrentFrameNumber;
+	uint16_t ElapsedMS;
+	uint8_t  ErrorCode;
+	uint32_t primask;
+
+	if (Job->ErrorCode != PIPE_RWSTREAM_NoError)
+	  return Job->ErrorCode;
+
+	if ((USB_HostState[portnum] != HOST_STATE_Configured) || !(PRNTInterfaceInfo->State.IsActive))
+	  return (Job->ErrorCode = PIPE_RWSTREAM_DeviceDisconnected);
+
+	if (!(Job->InFlight) && (Job->TransferStatus != HCD_STATUS_OK))
+	{
+		if (Job->TransferStatus == HCD_STATUS_TRANSFER_Stall)
+		{
+			Pipe_SelectPipe(portnum,PRNTInterfaceInfo->Config.DataOUTPipeNumber);
+			USB_Host_ClearEndpointStall(portnum,Pipe_GetBoundEndpointAddress(portnum));
+			return (Job->ErrorCode = PIPE_RWSTREAM_PipeStalled);
+		}
+
+		return (Job->ErrorCode = PIPE_RWSTREAM_IncompleteTransfer);
+	}
+
+	CurrentFrameNumber       = USB_Host_GetFrameNumber();
+	ElapsedMS                = (uint16_t)(CurrentFrameNumber - Job->PreviousFrameNumber);
+	Job->PreviousFrameNumber = CurrentFrameNumber;
+
+	/* Flow control, hold back new slots while the printer cannot take them */
+	if (ElapsedMS >= Job->StatusMSRem)
+	{
+		Job->StatusMSRem = PRNT_JOB_STATUS_POLL_MS;
+
+		if ((ErrorCode = PRNT_Host_GetPortStatus(PRNTInterfaceInfo, &Job->PortStatus)) != HOST_SENDCONTROL_Successful)
+		  return (Job->ErrorCode = ErrorCode);
+
+		Job->Paused = ((Job->PortStatus & PRNT_PORTSTATUS_PAPEREMPTY) || !(Job->PortStatus & PRNT_PORTSTATUS_SELECT) ||
+		               !(Job->PortStatus & PRNT_PORTSTATUS_NOTERROR));
+	}
+	else
+	{
+		Job->StatusMSRem -= ElapsedMS;
+	}
+
+	/* A printer that reports ready must keep taking data, a paused one may hold off as long as it needs */
+	if (!(Job->InFlight) || Job->Paused || (Job->BytesSent != Job->TimeoutBytesSent))
+	{
+		Job->TimeoutMSRem     = PRNT_JOB_DATA_TIMEOUT_MS;
+		Job->TimeoutBytesSent = Job->BytesSent;
+	}
+	else if (ElapsedMS >= Job->TimeoutMSRem)
+	{
+		HcdCancelTransfer(Job->PipeHandle);
+		Job->InFlight = false;
+		return (Job->ErrorCode = PIPE_RWSTREAM_Timeout);
+	}
+	else
+	{
+		Job->TimeoutMSRem -= ElapsedMS;
+	}
+
+	/* Restart the ring once the interrupt chain has stopped on an empty ring or a pause */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (!(Job->InFlight) && !(Job->Paused))
+	{
+		if (Job->SlotsFull)
+		{
+			PRNT_Host_JobSubmit(Job, Job->SlotSize);
+		}
+		else if (Job->Flushing && Job->FillLength)
+		{
+			uint16_t Length = Job->FillLength;
+
+			Job->FillLength = 0;
+			Job->FillSlot   = (Job->FillSlot + 1) % Job->SlotCount;
+			Job->SlotsFull  = 1;
+			PRNT_Host_JobSubmit(Job, Length);
+		}
+	}
+	__set_PRIMASK(primask);
+
+	if (Job->Flushing && PRNT_Host_JobIsDone(Job))
+	  Job->Flushing = false;
+
+	return PIPE_RWSTREAM_NoError;
+}
+
+uint8_t PRNT_Host_JobFlush(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo,
+                           PRNT_Host_Job_t* const Job)
+{
+	Job->Flushing = true;
+
+	return PRNT_Host_JobTask(PRNTInterfaceInfo, Job);
+}
+
+void PRNT_Host_JobAbort(PRNT_Host_Job_t* const Job)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (Job->InFlight)
+	  HcdCancelTransfer(Job->PipeHandle);
+
+	Job->InFlight       = false;
+	Job->TransferStatus = HCD_STATUS_OK;
+	Job->SlotsFull      = 0;
+	Job->SendSlot       = Job->FillSlot;
+	Job->FillLength     = 0;
+	Job->Flushing       = false;
+	__set_PRIMASK(primask);
+}
+
 uint16_t PRNT_Host_BytesReceived(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo)
 {
 	uint8_t portnum = PRNTInterfaceInfo->Config.PortNumber;
@@ -99,6 +99,41 @@
 						  */
 			} USB_ClassInfo_PRNT_Host_t;
 
+			/** @brief Printer Class Host Mode Print Job Stream Structure.
+			 *
+			 *  Ring of outgoing buffers used by the \c PRNT_Host_Job* functions to stream a long print job. An instance of
+			 *  this structure should be made within the user application for the job in progress and set up with
+			 *  @ref PRNT_Host_JobInit(). Filled slots are sent back to back from the host controller interrupt, so the
+			 *  application only has to keep the ring topped up with @ref PRNT_Host_JobWrite() and call
+			 *  @ref PRNT_Host_JobTask() regularly for the port status checks.
+			 *
+			 *  @note The data pipe must not be used by @ref PRNT_Host_SendByte(), @ref PRNT_Host_SendString() or
+			 *        @ref PRNT_Host_SendData() while a job is streaming.
+			 */
+			typedef struct
+			{
+				uint8_t* Buffer; /**< Ring storage of \c SlotCount slots of \c SlotSize bytes each. */
+				uint16_t SlotSize; /**< Size in bytes of each slot, a whole number of OUT pipe packets. */
+				uint8_t  SlotCount; /**< Number of slots in the ring. */
+				uint8_t  FillSlot; /**< Slot being filled by @ref PRNT_Host_JobWrite(). */
+				uint16_t FillLength; /**< Bytes written so far into the fill slot. */
+				volatile uint8_t  SendSlot; /**< Oldest filled slot, on the bus while \c InFlight is set. */
+				volatile uint8_t  SlotsFull; /**< Number of filled slots waiting for or in transfer. */
+				volatile uint16_t SendLength; /**< Length in bytes of the transfer on the bus. */
+				volatile bool     InFlight; /**< Indicates a bulk OUT transfer of the ring is queued. */
+				volatile uint8_t  TransferStatus; /**< \ref HCD_STATUS of the last finished or failed transfer. */
+				volatile uint32_t BytesSent; /**< Total bytes of the job accepted by the printer. */
+				volatile bool     Paused; /**< Set while the port status reports paper empty, deselected or error. */
+				bool     Flushing; /**< Indicates a partly filled slot is to be sent once the ring drains. */
+				uint8_t  PortStatus; /**< Last port status read from the printer, a mask of \c PRNT_PORTSTATUS_* bits. */
+				uint8_t  ErrorCode; /**< First error of the job, returned again by every later call. */
+				uint16_t PreviousFrameNumber; /**< Frame number at the last @ref PRNT_Host_JobTask() call. */
+				uint16_t StatusMSRem; /**< Milliseconds left until the next port status read. */
+				uint16_t TimeoutMSRem; /**< Milliseconds left for the printer to accept more data while ready. */
+				uint32_t TimeoutBytesSent; /**< \c BytesSent when the timeout was last restarted. */
+				uint32_t PipeHandle; /**< Host controller handle of the OUT data pipe. */
+			} PRNT_Host_Job_t;
+
 		/* Enums: */
 			enum PRNT_Host_EnumerationFailure_ErrorCodes_t
 			{
@@ -108,6 +143,17 @@
 				PRNT_ENUMERROR_PipeConfigurationFailed    = 3, /**< One or more pipes for the specified interface could not be configured correctly. */
 			};
 
+		/* Macros: */
+			#if !defined(PRNT_JOB_STATUS_POLL_MS)
+				/** Interval in milliseconds between port status reads while a print job streams. */
+				#define PRNT_JOB_STATUS_POLL_MS       250
+			#endif
+
+			#if !defined(PRNT_JOB_DATA_TIMEOUT_MS)
+				/** Time in milliseconds a printer reporting ready may refuse job data before the job fails. */
+				#define PRNT_JOB_DATA_TIMEOUT_MS      10000
+			#endif
+
 		/* Function Prototypes: */
 			/** @brief Host interface configuration routine, to configure a given Printer host interface instance using the
 			 *  Configuration Descriptor read from an attached USB device. This function automatically updates the given Printer
@@ -264,6 +310,91 @@
 			                              char* const DeviceIDString,
 			                              const uint16_t BufferSize) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
 
+			/** @brief Sets up a print job stream on the given ring buffer. The slot size is rounded down to a whole number of OUT
+			 *  pipe packets, so every slot but the last one of the job goes out as full packets.
+			 *
+			 *  @pre This function must only be called when the Host state machine is in the @ref HOST_STATE_Configured state or the
+			 *       call will fail.
+			 *
+			 *  @param PRNTInterfaceInfo : Pointer to a structure containing a Printer Class host configuration and state.
+			 *  @param Job               : Pointer to the print job stream to set up.
+			 *  @param Buffer            : Ring storage of at least \c SlotSize * \c SlotCount bytes, reachable by the USB DMA.
+			 *  @param SlotSize          : Size in bytes of each ring slot.
+			 *  @param SlotCount         : Number of ring slots, at least two to keep the bus busy while a slot is filled.
+			 *
+			 *  @return A value from the @ref Pipe_Stream_RW_ErrorCodes_t enum.
+			 */
+			uint8_t PRNT_Host_JobInit(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo,
+			                          PRNT_Host_Job_t* const Job,
+			                          void* Buffer,
+			                          uint16_t SlotSize,
+			                          const uint8_t SlotCount) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2)
+			                          ATTR_NON_NULL_PTR_ARG(3);
+
+			/** @brief Copies job data into the free space of the ring, without waiting for the printer. Each slot is queued for
+			 *  sending as soon as it is full. Data that does not fit is left for the application to offer again later.
+			 *
+			 *  @param PRNTInterfaceInfo : Pointer to a structure containing a Printer Class host configuration and state.
+			 *  @param Job               : Pointer to the print job stream.
+			 *  @param Data              : Pointer to the job data to send.
+			 *  @param Length            : Size in bytes of the job data.
+			 *  @param BytesAccepted     : Location where the number of bytes copied into the ring is stored, may be \c NULL.
+			 *
+			 *  @return The value returned by @ref PRNT_Host_JobTask().
+			 */
+			uint8_t PRNT_Host_JobWrite(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo,
+			                           PRNT_Host_Job_t* const Job,
+			                           const void* Data,
+			                           uint16_t Length,
+			                           uint16_t* const BytesAccepted) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2)
+			                           ATTR_NON_NULL_PTR_ARG(3);
+
+			/** @brief Management task for a streaming print job. This should be called frequently in the main program loop while
+			 *  a job is in progress. It reads the printer port status every @ref PRNT_JOB_STATUS_POLL_MS milliseconds and holds
+			 *  back further slots while the printer reports paper empty, deselected or an error, restarts the ring once the
+			 *  printer is ready again, and sends the partly filled last slot after @ref PRNT_Host_JobFlush().
+			 *
+			 *  @param PRNTInterfaceInfo : Pointer to a structure containing a Printer Class host configuration and state.
+			 *  @param Job               : Pointer to the print job stream.
+			 *
+			 *  @return A value from the @ref Pipe_Stream_RW_ErrorCodes_t enum, or from the @ref USB_Host_SendControlErrorCodes_t
+			 *          enum if the port status could not be read. Once an error is returned the job must be aborted.
+			 */
+			uint8_t PRNT_Host_JobTask(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo,
+			                          PRNT_Host_Job_t* const Job) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** @brief Marks the end of the job data, so the partly filled last slot is sent once the slots before it are sent.
+			 *  @ref PRNT_Host_JobIsDone() indicates when the printer has taken all of the job.
+			 *
+			 *  @param PRNTInterfaceInfo : Pointer to a structure containing a Printer Class host configuration and state.
+			 *  @param Job               : Pointer to the print job stream.
+			 *
+			 *  @return The value returned by @ref PRNT_Host_JobTask().
+			 */
+			uint8_t PRNT_Host_JobFlush(USB_ClassInfo_PRNT_Host_t* const PRNTInterfaceInfo,
+			                           PRNT_Host_Job_t* const Job) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** @brief Stops a print job stream, cancelling the transfer on the bus and dropping the data left in the ring. The
+			 *  printer may still hold part of the job, @ref PRNT_Host_SoftReset() can be used to discard it.
+			 *
+			 *  @param Job : Pointer to the print job stream.
+			 *	@return	Nothing
+			 */
+			void PRNT_Host_JobAbort(PRNT_Host_Job_t* const Job) ATTR_NON_NULL_PTR_ARG(1);
+
+		/* Inline Functions: */
+			/** @brief Determines if all of the job data written so far has been accepted by the printer.
+			 *
+			 *  @param Job : Pointer to the print job stream.
+			 *
+			 *  @return Boolean \c true if the ring is empty and no transfer is on the bus, \c false otherwise.
+			 */
+			static inline bool PRNT_Host_JobIsDone(const PRNT_Host_Job_t* const Job) ATTR_NON_NULL_PTR_ARG(1) ATTR_ALWAYS_INLINE;
+			static inline bool PRNT_Host_JobIsDone(const PRNT_Host_Job_t* const Job)
+			{
+				return !(Job->SlotsFull) && !(Job->FillLength) && !(Job->InFlight);
+			}
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Function Prototypes: */
@@ -272,6 +403,11 @@
 				                                                 ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
 				static uint8_t DCOMP_PRNT_Host_NextPRNTInterfaceEndpoint(void* const CurrentDescriptor)
 				                                                         ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+				static void PRNT_Host_JobSubmit(PRNT_Host_Job_t* const Job,
+				                                const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+				static void PRNT_Host_JobTransferDone(uint32_t PipeHandle,
+				                                      HCD_STATUS Status,
+				                                      void* pArg);
 			#endif
 	#endif
 
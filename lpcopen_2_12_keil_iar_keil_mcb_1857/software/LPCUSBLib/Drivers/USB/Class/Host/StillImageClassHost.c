@@ -485,5 +485,159 @@ uint8_t SI_Host_ReceiveResponse(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo)
 	return PIPE_RWSTREAM_NoError;
 }
 
+static uint8_t SI_Host_WaitStreamChunk(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo)
+{
+	uint16_t TimeoutMSRem        = SI_COMMAND_DATA_TIMEOUT_MS;
+	uint16_t PreviousFrameNumber = USB_Host_GetFrameNumber();
+	uint8_t portnum = SIInterfaceInfo->Config.PortNumber;
+	uint32_t PipeHandle = PipeInfo[portnum][pipeselected[portnum]].PipeHandle;
+	HCD_STATUS Status;
+
+	while ((Status = HcdGetPipeStatus(PipeHandle)) == HCD_STATUS_TRANSFER_QUEUED)
+	{
+		uint16_t CurrentFrameNumber = USB_Host_GetFrameNumber();
+
+		if (CurrentFrameNumber != PreviousFrameNumber)
+		{
+			PreviousFrameNumber = CurrentFrameNumber;
+
+			if (!(TimeoutMSRem--))
+			{
+				HcdCancelTransfer(PipeHandle);
+				return PIPE_RWSTREAM_Timeout;
+			}
+		}
+
+		if (USB_HostState[portnum] == HOST_STATE_Unattached)
+		  return PIPE_RWSTREAM_DeviceDisconnected;
+	}
+
+	if (Status == HCD_STATUS_TRANSFER_Stall)
+	{
+		USB_Host_ClearEndpointStall(portnum,Pipe_GetBoundEndpointAddress(portnum));
+		return PIPE_RWSTREAM_PipeStalled;
+	}
+
+	return (Status == HCD_STATUS_OK) ? PIPE_RWSTREAM_NoError : PIPE_RWSTREAM_IncompleteTransfer;
+}
+
+uint8_t SI_Host_ReadDataStream(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo,
+                               const uint32_t Bytes,
+                               void* Buffer,
+                               const uint32_t BufferSize,
+                               SI_Host_StreamCallback_t Callback,
+                               void* CallbackArg)
+{
+	uint8_t  ErrorCode  = PIPE_RWSTREAM_NoError;
+	uint8_t  portnum    = SIInterfaceInfo->Config.PortNumber;
+	uint16_t PacketSize = SIInterfaceInfo->State.DataINPipeSize;
+	uint32_t ChunkSize  = MIN(BufferSize / 2, 0xFFFF);
+	uint8_t* Half[2];
+	uint32_t BytesRem   = Bytes;
+	uint32_t Pending;
+	uint8_t  Current    = 0;
+	bool     Delivering = true;
+	bool     ShortPacket = false;
+
+	if ((USB_HostState[portnum] != HOST_STATE_Configured) || !(SIInterfaceInfo->State.IsActive))
+	  return PIPE_RWSTREAM_DeviceDisconnected;
+
+	/* Whole packets per half, at most what the 16-bit transfer count holds */
+	ChunkSize -= (ChunkSize % PacketSize);
+	if (!(ChunkSize))
+	  return PIPE_RWSTREAM_IncompleteTransfer;
+
+	Half[0] = (uint8_t*)Buffer;
+	Half[1] = (uint8_t*)Buffer + ChunkSize;
+
+	Pipe_SelectPipe(portnum,SIInterfaceInfo->Config.DataINPipeNumber);
+	Pipe_Unfreeze();
+
+	/* The first packet, read with the container header, still holds the start of the data */
+	Pending = MIN(Pipe_BytesInPipe(portnum), BytesRem);
+	if (Pending)
+	  Pipe_Read_Stream_LE(portnum,Half[1], Pending, NULL);
+	Pipe_ClearIN(portnum);
+	BytesRem -= Pending;
+
+	while (BytesRem || Pending)
+	{
+		uint32_t Length = MIN(BytesRem, ChunkSize);
+
+		/* Queue the next chunk into one half before handing over the other one */
+		if (Length)
+		  Pipe_Streaming(portnum,Half[Current], Length, PacketSize);
+
+		if (Pending && Delivering)
+		  Delivering = Callback(CallbackArg, Half[Current ^ 1], Pending);
+		Pending = 0;
+
+		if (Length)
+		{
+			if ((ErrorCode = SI_Host_WaitStreamChunk(SIInterfaceInfo)) != PIPE_RWSTREAM_NoError)
+			{
+				Pipe_ClearIN(portnum);
+				Pipe_Freeze();
+				return ErrorCode;
+			}
+
+			Pending = PipeInfo[portnum][pipeselected[portnum]].ByteTransfered;
+			Pipe_ClearIN(portnum);
+
+			/* A short packet ends the data phase early */
+			BytesRem    = (Pending < Length) ? 0 : (BytesRem - Length);
+			ShortPacket = (Pending < Length);
+			Current    ^= 1;
+		}
+	}
+
+	/* A data phase ending on a full packet is followed by a zero length packet */
+	if (!(ShortPacket) && !((Bytes + PIMA_DATA_SIZE(0)) % PacketSize))
+	{
+		Pipe_Streaming(portnum,Half[0], PacketSize, PacketSize);
+		ErrorCode = SI_Host_WaitStreamChunk(SIInterfaceInfo);
+		Pipe_ClearIN(portnum);
+	}
+
+	Pipe_Freeze();
+
+	if ((ErrorCode == PIPE_RWSTREAM_NoError) && !(Delivering))
+	  return SI_ERROR_LOGICAL_CMD_FAILED;
+
+	return ErrorCode;
+}
+
+uint8_t SI_Host_GetObjectStream(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo,
+                                const uint32_t ObjectHandle,
+                                void* Buffer,
+                                const uint32_t BufferSize,
+                                SI_Host_StreamCallback_t Callback,
+                                void* CallbackArg)
+{
+	uint8_t ErrorCode;
+	uint8_t ResponseCode;
+	uint32_t Params[1] = {cpu_to_le32(ObjectHandle)};
+	PIMA_Container_t PIMABlock;
+
+	if ((ErrorCode = SI_Host_SendCommand(SIInterfaceInfo, 0x1009, 1, Params)) != PIPE_RWSTREAM_NoError)
+	  return ErrorCode;
+
+	if ((ErrorCode = SI_Host_ReceiveBlockHeader(SIInterfaceInfo, &PIMABlock)) != PIPE_RWSTREAM_NoError)
+	  return ErrorCode;
+
+	/* A response block instead of the data means the device refused the command */
+	if (PIMABlock.Type != CPU_TO_LE16(PIMA_CONTAINER_DataBlock))
+	  return SI_ERROR_LOGICAL_CMD_FAILED;
+
+	ErrorCode = SI_Host_ReadDataStream(SIInterfaceInfo, le32_to_cpu(PIMABlock.DataLength) - PIMA_DATA_SIZE(0),
+	                                   Buffer, BufferSize, Callback, CallbackArg);
+	if ((ErrorCode != PIPE_RWSTREAM_NoError) && (ErrorCode != SI_ERROR_LOGICAL_CMD_FAILED))
+	  return ErrorCode;
+
+	ResponseCode = SI_Host_ReceiveResponse(SIInterfaceInfo);
+
+	return (ErrorCode != PIPE_RWSTREAM_NoError) ? ErrorCode : ResponseCode;
+}
+
 #endif
 
@@ -109,6 +109,18 @@
 						  */
 			} USB_ClassInfo_SI_Host_t;
 
+			/** @brief Still Image data stream callback, see @ref SI_Host_ReadDataStream().
+			 *
+			 *  @param CallbackArg : User argument given to @ref SI_Host_ReadDataStream().
+			 *  @param Data        : Next received part of the data phase.
+			 *  @param Length      : Number of bytes at \c Data.
+			 *
+			 *  @return \c true to go on, \c false to stop delivering the data.
+			 */
+			typedef bool (*SI_Host_StreamCallback_t)(void* const CallbackArg,
+			                                         const uint8_t* const Data,
+			                                         const uint32_t Length);
+
 		/* Enums: */
 			/** Enum for the possible error codes returned by the @ref SI_Host_ConfigurePipes() function. */
 			enum SI_Host_EnumerationFailure_ErrorCodes_t
@@ -283,6 +295,56 @@
 			                         void* Buffer,
 			                         const uint16_t Bytes) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
 
+			/** @brief Receives the data phase of a PIMA command as a stream, for objects too large to hold in RAM. The data is
+			 *  read with chained bulk transfers into one half of the given buffer while the callback is given the other half,
+			 *  so a callback that writes to a card runs at the same time as the bus transfer.
+			 *
+			 *  @pre This function must only be called when the Host state machine is in the @ref HOST_STATE_Configured state or the
+			 *       call will fail. The data block container header must have been read with @ref SI_Host_ReceiveBlockHeader().
+			 *
+			 *  @param SIInterfaceInfo : Pointer to a structure containing a Still Image Class host configuration and state.
+			 *  @param Bytes           : Length in bytes of the data phase after the container header.
+			 *  @param Buffer          : Pointer to the stream buffer, used as two halves.
+			 *  @param BufferSize      : Size of the stream buffer, each half is rounded down to whole packets and at most 64KB.
+			 *  @param Callback        : Called with each received part of the data, in order.
+			 *  @param CallbackArg     : User argument passed to \c Callback.
+			 *
+			 *  @return A value from the @ref Pipe_Stream_RW_ErrorCodes_t enum, or @ref SI_ERROR_LOGICAL_CMD_FAILED if the
+			 *          callback stopped the stream. The rest of the data phase is then still read and dropped, so the
+			 *          response can be received.
+			 */
+			uint8_t SI_Host_ReadDataStream(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo,
+			                               const uint32_t Bytes,
+			                               void* Buffer,
+			                               const uint32_t BufferSize,
+			                               SI_Host_StreamCallback_t Callback,
+			                               void* CallbackArg) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(3)
+			                                                  ATTR_NON_NULL_PTR_ARG(5);
+
+			/** @brief Downloads an object from the attached device with a PIMA GetObject command, delivering it to a callback
+			 *  as it arrives. See @ref SI_Host_ReadDataStream().
+			 *
+			 *  @pre This function must only be called when the Host state machine is in the @ref HOST_STATE_Configured state or the
+			 *       call will fail.
+			 *
+			 *  @param SIInterfaceInfo : Pointer to a structure containing a Still Image Class host configuration and state.
+			 *  @param ObjectHandle    : Handle of the object to download.
+			 *  @param Buffer          : Pointer to the stream buffer, used as two halves.
+			 *  @param BufferSize      : Size of the stream buffer.
+			 *  @param Callback        : Called with each received part of the object, in order.
+			 *  @param CallbackArg     : User argument passed to \c Callback.
+			 *
+			 *  @return A value from the @ref Pipe_Stream_RW_ErrorCodes_t enum, or @ref SI_ERROR_LOGICAL_CMD_FAILED if the
+			 *          device rejected the command or the callback stopped the stream.
+			 */
+			uint8_t SI_Host_GetObjectStream(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo,
+			                                const uint32_t ObjectHandle,
+			                                void* Buffer,
+			                                const uint32_t BufferSize,
+			                                SI_Host_StreamCallback_t Callback,
+			                                void* CallbackArg) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(3)
+			                                                   ATTR_NON_NULL_PTR_ARG(5);
+
 		/* Inline Functions: */
 			/** @brief General management task for a given Still Image host class interface, required for the correct operation of the
 			 *  interface. This should be called frequently in the main program loop, before the master USB management task
@@ -308,6 +370,8 @@
 				                                             ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
 				static uint8_t DCOMP_SI_Host_NextSIInterfaceEndpoint(void* const CurrentDescriptor)
 				                                                     ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+				static uint8_t SI_Host_WaitStreamChunk(USB_ClassInfo_SI_Host_t* const SIInterfaceInfo)
+				                                       ATTR_NON_NULL_PTR_ARG(1);
 			#endif
 	#endif
 
@@ -34,11 +34,92 @@
 #include "ConfigDescriptor.h"
 
 #if defined(USB_CAN_BE_HOST)
-uint8_t USB_Host_GetDeviceConfigDescriptor(const uint8_t corenum,
-										   const uint8_t ConfigNumber,
-                                           uint16_t* const ConfigSizePtr,
-                                           void* const BufferPtr,
-                                           const uint16_t BufferSize)
+#if (HOST_DESCRIPTOR_CACHE_ENTRIES > 0)
+typedef struct
+{
+	uint16_t VendorID;
+	uint16_t ProductID;
+	uint16_t ReleaseNumber;
+	uint8_t  ConfigNumber;
+	uint32_t SerialHash;	/* FNV-1a of the serial number string descriptor, 0 when the device has none */
+	uint16_t ConfigSize;	/* 0 marks an unused entry */
+	uint8_t  ConfigData[HOST_DESCRIPTOR_CACHE_SIZE];
+} USB_Host_DescriptorCacheEntry_t;
+
+static USB_Host_DescriptorCacheEntry_t DescriptorCache[HOST_DESCRIPTOR_CACHE_ENTRIES];
+static uint8_t                         DescriptorCacheNext;
+static bool                            DescriptorCacheHit[MAX_USB_CORE];
+
+/* Fills in the identity of the attached device, two control requests at most */
+static uint8_t USB_Host_IdentifyDevice(const uint8_t corenum,
+                                       const uint8_t ConfigNumber,
+                                       USB_Host_DescriptorCacheEntry_t* const Key)
+{
+	USB_Descriptor_Device_t DeviceDescriptor;
+	uint8_t                 ErrorCode;
+
+	if ((ErrorCode = USB_Host_GetDeviceDescriptor(corenum, &DeviceDescriptor)) != HOST_SENDCONTROL_Successful)
+	  return ErrorCode;
+
+	Key->VendorID      = le16_to_cpu(DeviceDescriptor.VendorID);
+	Key->ProductID     = le16_to_cpu(DeviceDescriptor.ProductID);
+	Key->ReleaseNumber = le16_to_cpu(DeviceDescriptor.ReleaseNumber);
+	Key->ConfigNumber  = ConfigNumber;
+	Key->SerialHash    = 0;
+
+	if (DeviceDescriptor.SerialNumStrIndex)
+	{
+		uint8_t SerialString[64];
+
+		if ((ErrorCode = USB_Host_GetDeviceStringDescriptor(corenum, DeviceDescriptor.SerialNumStrIndex, SerialString,
+		                                                    sizeof(SerialString))) != HOST_SENDCONTROL_Successful)
+		{
+			return ErrorCode;
+		}
+
+		Key->SerialHash = 2166136261UL;
+
+		for (uint8_t i = 0; i < MIN(SerialString[0], sizeof(SerialString)); i++)
+		  Key->SerialHash = (Key->SerialHash ^ SerialString[i]) * 16777619UL;
+	}
+
+	return HOST_SENDCONTROL_Successful;
+}
+
+static USB_Host_DescriptorCacheEntry_t* USB_Host_FindCachedDevice(const USB_Host_DescriptorCacheEntry_t* const Key)
+{
+	for (uint8_t i = 0; i < HOST_DESCRIPTOR_CACHE_ENTRIES; i++)
+	{
+		USB_Host_DescriptorCacheEntry_t* Entry = &DescriptorCache[i];
+
+		if (Entry->ConfigSize && (Entry->VendorID == Key->VendorID) && (Entry->ProductID == Key->ProductID) &&
+		    (Entry->ReleaseNumber == Key->ReleaseNumber) && (Entry->ConfigNumber == Key->ConfigNumber) &&
+		    (Entry->SerialHash == Key->SerialHash))
+		{
+			return Entry;
+		}
+	}
+
+	return NULL;
+}
+
+bool USB_Host_IsConfigDescriptorCached(const uint8_t corenum)
+{
+	return DescriptorCacheHit[corenum];
+}
+
+void USB_Host_FlushDescriptorCache(void)
+{
+	for (uint8_t i = 0; i < HOST_DESCRIPTOR_CACHE_ENTRIES; i++)
+	  DescriptorCache[i].ConfigSize = 0;
+}
+#endif
+
+static uint8_t USB_Host_FetchConfigDescriptor(const uint8_t corenum,
+                                              const uint8_t ConfigNumber,
+                                              uint16_t* const ConfigSizePtr,
+                                              void* const BufferPtr,
+                                              const uint16_t BufferSize)
 {
 	uint8_t ErrorCode;
 	uint8_t ConfigHeader[sizeof(USB_Descriptor_Configuration_Header_t)];
@@ -73,6 +154,57 @@ uint8_t USB_Host_GetDeviceConfigDescriptor(const uint8_t corenum,
 
 	return HOST_GETCONFIG_Successful;
 }
+
+uint8_t USB_Host_GetDeviceConfigDescriptor(const uint8_t corenum,
+										   const uint8_t ConfigNumber,
+                                           uint16_t* const ConfigSizePtr,
+                                           void* const BufferPtr,
+                                           const uint16_t BufferSize)
+{
+#if (HOST_DESCRIPTOR_CACHE_ENTRIES > 0)
+	USB_Host_DescriptorCacheEntry_t  Key;
+	USB_Host_DescriptorCacheEntry_t* Entry;
+	uint8_t                          ErrorCode;
+
+	DescriptorCacheHit[corenum] = false;
+
+	if ((ErrorCode = USB_Host_IdentifyDevice(corenum, ConfigNumber, &Key)) != HOST_SENDCONTROL_Successful)
+	  return ErrorCode;
+
+	if ((Entry = USB_Host_FindCachedDevice(&Key)) != NULL)
+	{
+		*ConfigSizePtr = Entry->ConfigSize;
+
+		if (Entry->ConfigSize > BufferSize)
+		  return HOST_GETCONFIG_BuffOverflow;
+
+		memcpy(BufferPtr, Entry->ConfigData, Entry->ConfigSize);
+		DescriptorCacheHit[corenum] = true;
+
+		return HOST_GETCONFIG_Successful;
+	}
+
+	if ((ErrorCode = USB_Host_FetchConfigDescriptor(corenum, ConfigNumber, ConfigSizePtr, BufferPtr,
+	                                                BufferSize)) != HOST_GETCONFIG_Successful)
+	{
+		return ErrorCode;
+	}
+
+	if (*ConfigSizePtr <= HOST_DESCRIPTOR_CACHE_SIZE)
+	{
+		Entry = &DescriptorCache[DescriptorCacheNext];
+		DescriptorCacheNext = (DescriptorCacheNext + 1) % HOST_DESCRIPTOR_CACHE_ENTRIES;
+
+		Key.ConfigSize = *ConfigSizePtr;
+		memcpy(Key.ConfigData, BufferPtr, *ConfigSizePtr);
+		*Entry = Key;
+	}
+
+	return HOST_GETCONFIG_Successful;
+#else
+	return USB_Host_FetchConfigDescriptor(corenum, ConfigNumber, ConfigSizePtr, BufferPtr, BufferSize);
+#endif
+}
 #endif
 
 void USB_GetNextDescriptorOfType(uint16_t* const BytesRem,
@@ -99,6 +99,20 @@
 			/** Returns the descriptor's size, expressed as the 8-bit value indicating the number of bytes. */
 			#define DESCRIPTOR_SIZE(DescriptorPtr)    DESCRIPTOR_PCAST(DescriptorPtr, USB_Descriptor_Header_t)->Size
 
+			#if !defined(HOST_DESCRIPTOR_CACHE_ENTRIES) || defined(__DOXYGEN__)
+				/** Number of devices whose configuration descriptor @ref USB_Host_GetDeviceConfigDescriptor() remembers,
+				 *  so a device seen before is re-enumerated without fetching it again. Zero disables the cache.
+				 */
+				#define HOST_DESCRIPTOR_CACHE_ENTRIES    0
+			#endif
+
+			#if !defined(HOST_DESCRIPTOR_CACHE_SIZE) || defined(__DOXYGEN__)
+				/** Largest configuration descriptor, in bytes, kept by each descriptor cache entry. Larger descriptors are
+				 *  always fetched from the device.
+				 */
+				#define HOST_DESCRIPTOR_CACHE_SIZE       256
+			#endif
+
 		/* Type Defines: */
 			/** Type define for a Configuration Descriptor comparator function (function taking a pointer to an array
 			 *  of type void, returning a uint8_t value).
@@ -162,6 +176,25 @@
 			                                           void* const BufferPtr,
 			                                           const uint16_t BufferSize) ATTR_NON_NULL_PTR_ARG(3) ATTR_NON_NULL_PTR_ARG(4);
 
+			#if (HOST_DESCRIPTOR_CACHE_ENTRIES > 0) || defined(__DOXYGEN__)
+			/** @brief	Indicates whether the last @ref USB_Host_GetDeviceConfigDescriptor() call on the given port was served
+			 *  		from the descriptor cache. Devices are matched on VID, PID, release number and serial number string.
+			 *  		On a hit the application may reuse whatever it derived from the descriptor on an earlier attach,
+			 *  		such as its pipe layout, instead of parsing it again.
+			 *
+			 *  @param  	corenum		: USB port number
+			 *
+			 *  @return Boolean \c true if the descriptor came from the cache, \c false otherwise.
+			 */
+			bool USB_Host_IsConfigDescriptorCached(const uint8_t corenum);
+
+			/** @brief	Forgets every device held in the descriptor cache, for example after a device firmware update.
+			 *
+			 *  @return Nothing.
+			 */
+			void USB_Host_FlushDescriptorCache(void);
+			#endif
+
 			/** @brief	Skips to the next sub-descriptor inside the configuration descriptor of the specified type value.
 			 *  		The bytes remaining value is automatically decremented.
 			 *
@@ -77,6 +77,64 @@ extern uint8_t endpointhandle0[];
 extern uint8_t endpointhandle1[];
 
 #define endpointhandle(corenum)				((corenum) ? endpointhandle1 : endpointhandle0)
+
+/* Type Defines: */
+/** Isochronous ring slot callback. For an OUT ring, @a pSlot holds @a Length received bytes and the
+ *  callback returns the number of bytes it consumed. For an IN ring, the callback fills @a pSlot with
+ *  at most @a Length bytes and returns the number of bytes to send.
+ */
+typedef uint32_t (*ENDPOINT_ISO_SLOT_CALLBACK)(void *pArg, uint8_t *pSlot, uint32_t Length);
+
+/** Isochronous ring under/overrun callback, @a Direction is ENDPOINT_DIR_IN or ENDPOINT_DIR_OUT */
+typedef void (*ENDPOINT_ISO_XRUN_CALLBACK)(void *pArg, uint8_t Direction);
+
+/** Isochronous ring statistics */
+typedef struct {
+	uint32_t Slots;			/* Slots retired by the controller */
+	uint32_t Underruns;		/* IN slots the application left empty, or the IN queue ran dry */
+	uint32_t Overruns;		/* OUT data the application did not consume, or the OUT queue ran dry */
+	uint32_t Errors;		/* Slots retired with a transaction or buffer error */
+} ENDPOINT_ISO_RING_STATS;
+
+/* Function Prototypes: */
+/**
+ * @brief	Starts a continuous isochronous ring of @a NumSlots dTDs on an isochronous endpoint.
+ *  Each slot is @a SlotSize bytes of @a pRing, one slot per (micro)frame. Retired slots are handed
+ *  to @a Slot and queued again from the transfer complete interrupt.
+ * @param	corenum		: ID Number of USB Core to be processed.
+ * @param	Number		: Logical endpoint number, already configured as isochronous.
+ * @param	Direction	: ENDPOINT_DIR_IN or ENDPOINT_DIR_OUT.
+ * @param	pRing		: Slot buffers, NumSlots * SlotSize bytes in USB accessible RAM.
+ * @param	SlotSize	: Slot size in bytes.
+ * @param	NumSlots	: Ring depth.
+ * @param	Slot		: Slot callback, called from the USB interrupt.
+ * @param	Xrun		: Optional under/overrun callback, called from the USB interrupt.
+ * @param	pArg		: Argument passed to both callbacks.
+ * @return	true if the ring was started, false if the DCD does not support rings or no ring is free.
+ */
+bool Endpoint_ISORing_Start(uint8_t corenum, uint8_t Number, uint8_t Direction,
+							uint8_t *pRing, uint16_t SlotSize, uint8_t NumSlots,
+							ENDPOINT_ISO_SLOT_CALLBACK Slot, ENDPOINT_ISO_XRUN_CALLBACK Xrun, void *pArg);
+
+/**
+ * @brief	Stops an isochronous ring and flushes its endpoint.
+ * @param	corenum		: ID Number of USB Core to be processed.
+ * @param	Number		: Logical endpoint number.
+ * @param	Direction	: ENDPOINT_DIR_IN or ENDPOINT_DIR_OUT.
+ * @return	Nothing
+ */
+void Endpoint_ISORing_Stop(uint8_t corenum, uint8_t Number, uint8_t Direction);
+
+/**
+ * @brief	Reads the statistics of a running isochronous ring.
+ * @param	corenum		: ID Number of USB Core to be processed.
+ * @param	Number		: Logical endpoint number.
+ * @param	Direction	: ENDPOINT_DIR_IN or ENDPOINT_DIR_OUT.
+ * @param	pStats		: Filled with the ring statistics.
+ * @return	true if a ring is running on the endpoint.
+ */
+bool Endpoint_ISORing_GetStats(uint8_t corenum, uint8_t Number, uint8_t Direction, ENDPOINT_ISO_RING_STATS *pStats);
+
 #endif /* __ENDPOINT_COMMON_H__ */
 
 /** @} */
@@ -209,6 +209,10 @@ void USB_IRQHandler(void)
 
 	LPC_USB->INTSTAT = IntStat;
 
+	#if defined(USB_EVENT_DRIVEN_TASK)
+	USB_SignalTask(0);
+	#endif
+
 	/* SOF Interrupt */
 	if (IntStat & FRAME_INT) {}
 
@@ -295,6 +299,22 @@ void USB_IRQHandler(void)
 #endif
 }
 
+bool Endpoint_ISORing_Start(uint8_t corenum, uint8_t Number, uint8_t Direction,
+							uint8_t *pRing, uint16_t SlotSize, uint8_t NumSlots,
+							ENDPOINT_ISO_SLOT_CALLBACK Slot, ENDPOINT_ISO_XRUN_CALLBACK Xrun, void *pArg)
+{
+	/* Isochronous rings are only implemented for the LPC18xx/43xx DCD */
+	return false;
+}
+
+void Endpoint_ISORing_Stop(uint8_t corenum, uint8_t Number, uint8_t Direction)
+{}
+
+bool Endpoint_ISORing_GetStats(uint8_t corenum, uint8_t Number, uint8_t Direction, ENDPOINT_ISO_RING_STATS *pStats)
+{
+	return false;
+}
+
 //#endif	// defined(USB_DEVICE_ROM_DRIVER)
 
 #endif /*__LPC11UXX__ || __LPC1347__*/
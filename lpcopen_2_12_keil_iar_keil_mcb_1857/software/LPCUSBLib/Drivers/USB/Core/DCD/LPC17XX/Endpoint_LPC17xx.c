@@ -497,4 +497,20 @@ uint32_t Dummy_EPGetISOAddress(uint32_t EPNum, uint32_t *last_packet_size)
 	return (uint32_t) iso_buffer;
 }
 
+bool Endpoint_ISORing_Start(uint8_t corenum, uint8_t Number, uint8_t Direction,
+							uint8_t *pRing, uint16_t SlotSize, uint8_t NumSlots,
+							ENDPOINT_ISO_SLOT_CALLBACK Slot, ENDPOINT_ISO_XRUN_CALLBACK Xrun, void *pArg)
+{
+	/* Isochronous rings are only implemented for the LPC18xx/43xx DCD */
+	return false;
+}
+
+void Endpoint_ISORing_Stop(uint8_t corenum, uint8_t Number, uint8_t Direction)
+{}
+
+bool Endpoint_ISORing_GetStats(uint8_t corenum, uint8_t Number, uint8_t Direction, ENDPOINT_ISO_RING_STATS *pStats)
+{
+	return false;
+}
+
 #endif /*__LPC17XX__ || __LPC40XX__*/
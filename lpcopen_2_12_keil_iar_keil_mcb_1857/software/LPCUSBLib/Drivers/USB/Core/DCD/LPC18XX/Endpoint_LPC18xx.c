@@ -34,13 +34,17 @@
 
 #if (defined(__LPC18XX__) || defined(__LPC43XX__)) && defined(USB_CAN_BE_DEVICE)
 #include "../../Endpoint.h"
+#include "itm_trace.h"
 #include <string.h>
 
 #if defined(USB_DEVICE_ROM_DRIVER)
 PRAGMA_ALIGN_2048
 uint8_t usb_RomDriver_buffer[ROMDRIVER_MEM_SIZE] ATTR_ALIGNED(2048) __BSS(USBRAM_SECTION);
+#if (USB_ROM_MSC_CLASS)
 PRAGMA_ALIGN_4
 uint8_t usb_RomDriver_MSC_buffer[ROMDRIVER_MSC_MEM_SIZE] ATTR_ALIGNED(4) __BSS(USBRAM_SECTION);
+#endif
+#if (USB_ROM_CDC_CLASS)
 PRAGMA_ALIGN_4
 uint8_t usb_RomDriver_CDC_buffer[ROMDRIVER_CDC_MEM_SIZE] ATTR_ALIGNED(4) __BSS(USBRAM_SECTION);
 /** Endpoint IN buffer, used for DMA operation */
@@ -49,12 +53,38 @@ uint8_t UsbdCdc_EPIN_buffer[CDC_MAX_BULK_EP_SIZE] ATTR_ALIGNED(4) __BSS(USBRAM_S
 /** Endpoint OUT buffer, used for DMA operation */
 PRAGMA_ALIGN_4
 uint8_t UsbdCdc_EPOUT_buffer[CDC_MAX_BULK_EP_SIZE] ATTR_ALIGNED(4) __BSS(USBRAM_SECTION);
+#endif
+#if (USB_ROM_HID_CLASS)
 PRAGMA_ALIGN_4
 uint8_t usb_RomDriver_HID_buffer[ROMDRIVER_HID_MEM_SIZE] ATTR_ALIGNED(4) __BSS(USBRAM_SECTION);
+#endif
 
 #endif
 
-#define STREAM_TDs      16
+/* dTDs used by Endpoint_Streaming() per core */
+#ifndef ENDPOINT_STREAM_TDS
+#define ENDPOINT_STREAM_TDS      16
+#endif
+#define STREAM_TDs      ENDPOINT_STREAM_TDS
+
+/* Isochronous rings per core and maximum ring depth, see Endpoint_ISORing_Start() */
+#ifndef ENDPOINT_ISO_RINGS
+#define ENDPOINT_ISO_RINGS              2
+#endif
+#ifndef ENDPOINT_ISO_RING_MAX_TDS
+#define ENDPOINT_ISO_RING_MAX_TDS       8
+#endif
+#define ISO_RING_MAX_SLOT_SIZE          3072	/* 3 x 1024 byte high bandwidth packets */
+
+/* dTDs per core shared by the queued transfers of DcdQueueTransfer() */
+#ifndef ENDPOINT_QUEUE_TDS
+#define ENDPOINT_QUEUE_TDS              16
+#endif
+#if ENDPOINT_QUEUE_TDS > 255
+#error ENDPOINT_QUEUE_TDS must be less than 256
+#endif
+#define QUEUE_TD_NONE                   0xFF
+#define QUEUE_TD_MAX_XFER               0x4000	/* 5 buffer pages always cover 16KB */
 
 PRAGMA_ALIGN_2048
 volatile DeviceQueueHead dQueueHead0[USED_PHYSICAL_ENDPOINTS0] ATTR_ALIGNED(2048) __BSS(USBRAM_SECTION);
@@ -68,6 +98,14 @@ PRAGMA_ALIGN_32
 DeviceTransferDescriptor dStreamTD0[STREAM_TDs] ATTR_ALIGNED(32) __BSS(USBRAM_SECTION);
 PRAGMA_ALIGN_32
 DeviceTransferDescriptor dStreamTD1[STREAM_TDs] ATTR_ALIGNED(32) __BSS(USBRAM_SECTION);
+PRAGMA_ALIGN_32
+DeviceTransferDescriptor dIsoRingTD0[ENDPOINT_ISO_RINGS][ENDPOINT_ISO_RING_MAX_TDS] ATTR_ALIGNED(32) __BSS(USBRAM_SECTION);
+PRAGMA_ALIGN_32
+DeviceTransferDescriptor dIsoRingTD1[ENDPOINT_ISO_RINGS][ENDPOINT_ISO_RING_MAX_TDS] ATTR_ALIGNED(32) __BSS(USBRAM_SECTION);
+PRAGMA_ALIGN_32
+DeviceTransferDescriptor dQueueTD0[ENDPOINT_QUEUE_TDS] ATTR_ALIGNED(32) __BSS(USBRAM_SECTION);
+PRAGMA_ALIGN_32
+DeviceTransferDescriptor dQueueTD1[ENDPOINT_QUEUE_TDS] ATTR_ALIGNED(32) __BSS(USBRAM_SECTION);
 PRAGMA_ALIGN_4
 uint8_t iso_buffer[512] ATTR_ALIGNED(4);
 volatile DeviceQueueHead * const dQueueHead[LPC18_43_MAX_USB_CORE] = {dQueueHead0, dQueueHead1};
@@ -85,6 +123,52 @@ typedef struct {
 
 static STREAM_VAR_t Stream_Variable[LPC18_43_MAX_USB_CORE];
 
+/* Isochronous ring: every slot stays queued. Retired dTDs are handed to the application and
+ * appended behind the current tail, so the controller never waits for a whole queue re-prime. */
+typedef struct {
+	bool InUse;
+	uint8_t PhyEP;
+	uint8_t NumSlots;
+	uint8_t Head;						/* oldest dTD still owned by the controller */
+	uint16_t SlotSize;
+	uint8_t *pRing;
+	DeviceTransferDescriptor *pTD;
+	ENDPOINT_ISO_SLOT_CALLBACK Slot;
+	ENDPOINT_ISO_XRUN_CALLBACK Xrun;
+	void *pArg;
+	ENDPOINT_ISO_RING_STATS Stats;
+} ISO_RING_T;
+
+static ISO_RING_T Iso_Ring[LPC18_43_MAX_USB_CORE][ENDPOINT_ISO_RINGS];
+
+/* Queued transfers: dTDs of an endpoint are linked in hardware and, by index, in Info[].Next.
+ * Free dTDs are linked through Info[].Next from FreeHead. */
+typedef struct {
+	uint8_t Next;
+	uint8_t Last;						/* last dTD of its transfer */
+	uint32_t Length;					/* bytes programmed into the dTD */
+	DCD_TRANSFER_CALLBACK Callback;
+	void *pArg;
+} QUEUE_TD_INFO_T;
+
+typedef struct {
+	bool Enabled;
+	uint8_t Head;
+	uint8_t Tail;
+	uint32_t Done;						/* bytes so far of the transfer at Head */
+} QUEUE_EP_T;
+
+typedef struct {
+	QUEUE_TD_INFO_T Info[ENDPOINT_QUEUE_TDS];
+	uint8_t FreeHead;
+	QUEUE_EP_T Ep[USED_PHYSICAL_ENDPOINTS0];
+} QUEUE_T;
+
+static QUEUE_T Dcd_Queue[LPC18_43_MAX_USB_CORE];
+DeviceTransferDescriptor * const dQueueTD_Tbl[LPC18_43_MAX_USB_CORE] = {dQueueTD0, dQueueTD1};
+
+static void DcdQueueInit(uint8_t corenum);
+
 PRAGMA_WEAK(CALLBACK_HAL_GetISOBufferAddress, Dummy_EPGetISOAddress)
 uint32_t CALLBACK_HAL_GetISOBufferAddress(const uint32_t EPNum, uint32_t *last_packet_size) ATTR_WEAK ATTR_ALIAS(
 	Dummy_EPGetISOAddress);
@@ -153,6 +237,8 @@ void HAL_Reset(uint8_t corenum)
 	// usb_data_buffer_IN_size = 0;
 	usb_data_buffer_IN_index[corenum] = 0;
 	Stream_Variable[corenum].stream_total_packets = 0;
+	memset(Iso_Ring[corenum], 0, sizeof(Iso_Ring[corenum]));
+	DcdQueueInit(corenum);
 }
 
 bool Endpoint_ConfigureEndpoint(uint8_t corenum, const uint8_t Number, const uint8_t Type,
@@ -164,6 +250,9 @@ bool Endpoint_ConfigureEndpoint(uint8_t corenum, const uint8_t Number, const uin
 	__IO uint32_t * pEndPointCtrl = &ENDPTCTRL_REG(corenum, Number);
 	uint32_t EndPtCtrl = *pEndPointCtrl;
 	
+	if ((PhyEP < USED_PHYSICAL_ENDPOINTS(corenum)) && Dcd_Queue[corenum].Ep[PhyEP].Enabled) {
+		DcdQueueFlush(corenum, PhyEP);
+	}
 	pdQueueHead = &(dQueueHead[corenum][PhyEP]);
 	memset((void *) pdQueueHead, 0, sizeof(DeviceQueueHead) );
 	
@@ -271,6 +360,381 @@ void Endpoint_Streaming(uint8_t corenum, uint8_t *buffer, uint16_t packetsize,
 #endif
 }
 
+static ISO_RING_T *IsoRingFind(uint8_t corenum, uint8_t PhyEP)
+{
+	uint8_t i;
+	for (i = 0; i < ENDPOINT_ISO_RINGS; i++) {
+		if (Iso_Ring[corenum][i].InUse && (Iso_Ring[corenum][i].PhyEP == PhyEP)) {
+			return &Iso_Ring[corenum][i];
+		}
+	}
+	return NULL;
+}
+
+/* Prepare dTD SlotIdx, OUT slots receive up to SlotSize, IN slots are filled by the application */
+static void IsoRingPrepareSlot(ISO_RING_T *pRing, uint8_t SlotIdx)
+{
+	uint8_t *pSlot = pRing->pRing + SlotIdx * pRing->SlotSize;
+	uint32_t length = pRing->SlotSize;
+
+	if (pRing->PhyEP & 1) {
+		length = pRing->Slot(pRing->pArg, pSlot, pRing->SlotSize);
+		if (length > pRing->SlotSize) {
+			length = pRing->SlotSize;
+		}
+		if ((length == 0) && pRing->InUse) {
+			pRing->Stats.Underruns++;	/* zero length packet goes out */
+			if (pRing->Xrun) {
+				pRing->Xrun(pRing->pArg, ENDPOINT_DIR_IN);
+			}
+		}
+	}
+	DcdPrepareTD(&pRing->pTD[SlotIdx], pSlot, length, 1);
+}
+
+static void IsoRingPrime(uint8_t corenum, ISO_RING_T *pRing)
+{
+	volatile DeviceQueueHead *pdQueueHead = &(dQueueHead[corenum][pRing->PhyEP]);
+
+	pdQueueHead->Mult = 1;
+	pdQueueHead->overlay.Halted = 0;
+	pdQueueHead->overlay.Active = 0;
+	pdQueueHead->overlay.NextTD = (uint32_t) &pRing->pTD[pRing->Head];
+	USB_REG(corenum)->ENDPTPRIME |= _BIT(EP_Physical2BitPosition(pRing->PhyEP));
+}
+
+/* Add dTD tripwire: after linking new dTDs behind a live tail, find out whether the
+ * controller still owns the endpoint or already walked off the old tail */
+static bool DcdEndpointPrimed(uint8_t corenum, uint8_t PhyEP)
+{
+	LPC_USBHS_T *USB_Reg = USB_REG(corenum);
+	uint32_t bit = _BIT(EP_Physical2BitPosition(PhyEP));
+	uint32_t epstat;
+
+	if (USB_Reg->ENDPTPRIME & bit) {
+		return true;
+	}
+	do {
+		USB_Reg->USBCMD_D |= USBCMD_D_AddTDTripWire;
+		epstat = USB_Reg->ENDPTSTAT & bit;
+	} while (!(USB_Reg->USBCMD_D & USBCMD_D_AddTDTripWire));
+	USB_Reg->USBCMD_D &= ~USBCMD_D_AddTDTripWire;
+	return epstat != 0;
+}
+
+/* Called on transfer complete: recycle every retired dTD in ring order */
+static void IsoRingRecycle(uint8_t corenum, ISO_RING_T *pRing)
+{
+	uint8_t n, tail, idx;
+
+	for (n = 0; n < pRing->NumSlots && !pRing->pTD[pRing->Head].Active; n++) {
+		DeviceTransferDescriptor *pTD = &pRing->pTD[pRing->Head];
+		idx = pRing->Head;
+
+		pRing->Stats.Slots++;
+		if (pTD->TransactionErr || pTD->BufferErr || pTD->Halted) {
+			pRing->Stats.Errors++;
+		}
+		if (!(pRing->PhyEP & 1)) {
+			uint32_t received = pRing->SlotSize - pTD->TotalBytes;
+			if (pRing->Slot(pRing->pArg, pRing->pRing + idx * pRing->SlotSize, received) < received) {
+				pRing->Stats.Overruns++;
+				if (pRing->Xrun) {
+					pRing->Xrun(pRing->pArg, ENDPOINT_DIR_OUT);
+				}
+			}
+		}
+
+		/* Re-queue behind the current tail, the slot before this one in ring order */
+		IsoRingPrepareSlot(pRing, idx);
+		tail = (idx == 0) ? pRing->NumSlots - 1 : idx - 1;
+		pRing->pTD[tail].NextTD = (uint32_t) pTD;
+		pRing->Head = (idx + 1 == pRing->NumSlots) ? 0 : idx + 1;
+	}
+	if ((n == 0) || DcdEndpointPrimed(corenum, pRing->PhyEP)) {
+		return;
+	}
+
+	/* Ring ran dry before it was refilled, frames were lost */
+	if (pRing->PhyEP & 1) {
+		pRing->Stats.Underruns++;
+	}
+	else {
+		pRing->Stats.Overruns++;
+	}
+	if (pRing->Xrun) {
+		pRing->Xrun(pRing->pArg, (pRing->PhyEP & 1) ? ENDPOINT_DIR_IN : ENDPOINT_DIR_OUT);
+	}
+	IsoRingPrime(corenum, pRing);
+}
+
+bool Endpoint_ISORing_Start(uint8_t corenum, uint8_t Number, uint8_t Direction,
+							uint8_t *pRing, uint16_t SlotSize, uint8_t NumSlots,
+							ENDPOINT_ISO_SLOT_CALLBACK Slot, ENDPOINT_ISO_XRUN_CALLBACK Xrun, void *pArg)
+{
+	uint8_t PhyEP = 2 * Number + (Direction == ENDPOINT_DIR_OUT ? 0 : 1);
+	ISO_RING_T *pIsoRing = NULL;
+	uint8_t i;
+
+	if ((pRing == NULL) || (Slot == NULL) || (NumSlots < 2) || (NumSlots > ENDPOINT_ISO_RING_MAX_TDS) ||
+		(SlotSize == 0) || (SlotSize > ISO_RING_MAX_SLOT_SIZE) || (PhyEP >= USED_PHYSICAL_ENDPOINTS(corenum)) ||
+		(IsoRingFind(corenum, PhyEP) != NULL)) {
+		return false;
+	}
+	for (i = 0; i < ENDPOINT_ISO_RINGS; i++) {
+		if (!Iso_Ring[corenum][i].InUse) {
+			pIsoRing = &Iso_Ring[corenum][i];
+			break;
+		}
+	}
+	if (pIsoRing == NULL) {
+		return false;
+	}
+
+	/* Drop the single dTD queued by Endpoint_ConfigureEndpoint() */
+	USB_REG(corenum)->ENDPTFLUSH = _BIT(EP_Physical2BitPosition(PhyEP));
+	while (USB_REG(corenum)->ENDPTFLUSH) ;
+
+	memset(pIsoRing, 0, sizeof(ISO_RING_T));
+	pIsoRing->PhyEP = PhyEP;
+	pIsoRing->NumSlots = NumSlots;
+	pIsoRing->SlotSize = SlotSize;
+	pIsoRing->pRing = pRing;
+	pIsoRing->pTD = corenum ? dIsoRingTD1[i] : dIsoRingTD0[i];
+	pIsoRing->Slot = Slot;
+	pIsoRing->Xrun = Xrun;
+	pIsoRing->pArg = pArg;
+
+	for (i = 0; i < NumSlots; i++) {
+		IsoRingPrepareSlot(pIsoRing, i);
+		if (i > 0) {
+			pIsoRing->pTD[i - 1].NextTD = (uint32_t) &pIsoRing->pTD[i];
+		}
+	}
+	pIsoRing->InUse = true;
+	IsoRingPrime(corenum, pIsoRing);
+	return true;
+}
+
+void Endpoint_ISORing_Stop(uint8_t corenum, uint8_t Number, uint8_t Direction)
+{
+	uint8_t PhyEP = 2 * Number + (Direction == ENDPOINT_DIR_OUT ? 0 : 1);
+	ISO_RING_T *pIsoRing = IsoRingFind(corenum, PhyEP);
+
+	if (pIsoRing == NULL) {
+		return;
+	}
+	pIsoRing->InUse = false;
+	USB_REG(corenum)->ENDPTFLUSH = _BIT(EP_Physical2BitPosition(PhyEP));
+	while (USB_REG(corenum)->ENDPTFLUSH) ;
+	dQueueHead[corenum][PhyEP].overlay.NextTD = LINK_TERMINATE;
+}
+
+bool Endpoint_ISORing_GetStats(uint8_t corenum, uint8_t Number, uint8_t Direction, ENDPOINT_ISO_RING_STATS *pStats)
+{
+	ISO_RING_T *pIsoRing = IsoRingFind(corenum, 2 * Number + (Direction == ENDPOINT_DIR_OUT ? 0 : 1));
+
+	if (pIsoRing == NULL) {
+		return false;
+	}
+	*pStats = pIsoRing->Stats;
+	return true;
+}
+
+static void DcdQueueInit(uint8_t corenum)
+{
+	QUEUE_T *pQueue = &Dcd_Queue[corenum];
+	uint8_t i;
+
+	memset(pQueue, 0, sizeof(QUEUE_T));
+	for (i = 0; i < ENDPOINT_QUEUE_TDS; i++) {
+		pQueue->Info[i].Next = (i + 1 < ENDPOINT_QUEUE_TDS) ? i + 1 : QUEUE_TD_NONE;
+	}
+	pQueue->FreeHead = 0;
+	for (i = 0; i < USED_PHYSICAL_ENDPOINTS0; i++) {
+		pQueue->Ep[i].Head = pQueue->Ep[i].Tail = QUEUE_TD_NONE;
+	}
+}
+
+static void DcdQueuePrime(uint8_t corenum, uint8_t PhyEP, uint8_t TdIdx)
+{
+	volatile DeviceQueueHead *pdQueueHead = &(dQueueHead[corenum][PhyEP]);
+
+	pdQueueHead->overlay.Halted = 0;
+	pdQueueHead->overlay.Active = 0;
+	pdQueueHead->overlay.NextTD = (uint32_t) &dQueueTD_Tbl[corenum][TdIdx];
+	USB_REG(corenum)->ENDPTPRIME |= _BIT(EP_Physical2BitPosition(PhyEP));
+}
+
+bool DcdQueueTransfer(uint8_t corenum, uint8_t PhyEP, uint8_t *pData, uint32_t length,
+					  DCD_TRANSFER_CALLBACK Callback, void *pArg)
+{
+	QUEUE_T *pQueue = &Dcd_Queue[corenum];
+	QUEUE_EP_T *pEp;
+	DeviceTransferDescriptor *pTD = dQueueTD_Tbl[corenum];
+	uint8_t first = QUEUE_TD_NONE, prev = QUEUE_TD_NONE, idx;
+	uint32_t primask;
+
+	if ((PhyEP >= USED_PHYSICAL_ENDPOINTS(corenum)) || (!(PhyEP & 1) && (length > QUEUE_TD_MAX_XFER))) {
+		return false;
+	}
+	pEp = &pQueue->Ep[PhyEP];
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (!pEp->Enabled) {
+		/* Leave the shared buffer scheme: no NAK driven priming for this endpoint */
+		USB_REG(corenum)->ENDPTNAKEN &= ~_BIT(EP_Physical2BitPosition(PhyEP));
+		pEp->Enabled = true;
+	}
+
+	/* Build the whole chain first, a zero length IN transfer still takes one dTD */
+	do {
+		uint32_t chunk = (length > QUEUE_TD_MAX_XFER) ? QUEUE_TD_MAX_XFER : length;
+
+		idx = pQueue->FreeHead;
+		if (idx == QUEUE_TD_NONE) {
+			/* Out of dTDs, give back what was taken for this transfer */
+			while (first != QUEUE_TD_NONE) {
+				idx = pQueue->Info[first].Next;
+				pQueue->Info[first].Next = pQueue->FreeHead;
+				pQueue->FreeHead = first;
+				first = idx;
+			}
+			__set_PRIMASK(primask);
+			return false;
+		}
+		pQueue->FreeHead = pQueue->Info[idx].Next;
+
+		DcdPrepareTD(&pTD[idx], pData, chunk, 0);
+		pQueue->Info[idx].Next = QUEUE_TD_NONE;
+		pQueue->Info[idx].Last = 0;
+		pQueue->Info[idx].Length = chunk;
+		if (prev == QUEUE_TD_NONE) {
+			first = idx;
+		}
+		else {
+			pTD[prev].NextTD = (uint32_t) &pTD[idx];
+			pQueue->Info[prev].Next = idx;
+		}
+		prev = idx;
+		pData += chunk;
+		length -= chunk;
+	} while (length > 0);
+
+	pTD[prev].IntOnComplete = 1;
+	pQueue->Info[prev].Last = 1;
+	pQueue->Info[prev].Callback = Callback;
+	pQueue->Info[prev].pArg = pArg;
+
+	if (pEp->Head == QUEUE_TD_NONE) {
+		pEp->Head = first;
+		pEp->Tail = prev;
+		pEp->Done = 0;
+		DcdQueuePrime(corenum, PhyEP, first);
+	}
+	else {
+		pTD[pEp->Tail].NextTD = (uint32_t) &pTD[first];
+		pQueue->Info[pEp->Tail].Next = first;
+		pEp->Tail = prev;
+		if (!DcdEndpointPrimed(corenum, PhyEP)) {
+			/* Controller went idle before the link was seen, every older dTD has retired */
+			DcdQueuePrime(corenum, PhyEP, first);
+		}
+	}
+
+	__set_PRIMASK(primask);
+	return true;
+}
+
+/* Retire completed dTDs from the head of the endpoint queue and report finished transfers */
+static void DcdQueueComplete(uint8_t corenum, uint8_t PhyEP, bool Cancel)
+{
+	QUEUE_T *pQueue = &Dcd_Queue[corenum];
+	QUEUE_EP_T *pEp = &pQueue->Ep[PhyEP];
+	DeviceTransferDescriptor *pTD = dQueueTD_Tbl[corenum];
+
+	while (pEp->Head != QUEUE_TD_NONE) {
+		uint8_t idx = pEp->Head;
+		QUEUE_TD_INFO_T *pInfo = &pQueue->Info[idx];
+		DCD_TRANSFER_STATUS status = DCD_TRANSFER_OK;
+		uint8_t last;
+
+		if (!Cancel && pTD[idx].Active) {
+			break;
+		}
+		if (Cancel) {
+			status = DCD_TRANSFER_CANCELLED;
+		}
+		else if (pTD[idx].Halted || pTD[idx].TransactionErr || pTD[idx].BufferErr) {
+			status = DCD_TRANSFER_ERROR;
+		}
+		else {
+			pEp->Done += pInfo->Length - pTD[idx].TotalBytes;
+		}
+
+		last = pInfo->Last;
+		pEp->Head = pInfo->Next;
+		if (pEp->Head == QUEUE_TD_NONE) {
+			pEp->Tail = QUEUE_TD_NONE;
+		}
+		pInfo->Next = pQueue->FreeHead;
+		pQueue->FreeHead = idx;
+
+		if (last || (status != DCD_TRANSFER_OK)) {
+			uint32_t done = pEp->Done;
+			DCD_TRANSFER_CALLBACK Callback = last ? pInfo->Callback : NULL;
+			void *pArg = pInfo->pArg;
+
+			/* On an error drop the rest of the transfer up to its last dTD */
+			if (!last) {
+				USB_REG(corenum)->ENDPTFLUSH = _BIT(EP_Physical2BitPosition(PhyEP));
+				while (USB_REG(corenum)->ENDPTFLUSH) ;
+			}
+			while (!last && (pEp->Head != QUEUE_TD_NONE)) {
+				idx = pEp->Head;
+				pInfo = &pQueue->Info[idx];
+				last = pInfo->Last;
+				Callback = pInfo->Callback;
+				pArg = pInfo->pArg;
+				pEp->Head = pInfo->Next;
+				if (pEp->Head == QUEUE_TD_NONE) {
+					pEp->Tail = QUEUE_TD_NONE;
+				}
+				pInfo->Next = pQueue->FreeHead;
+				pQueue->FreeHead = idx;
+			}
+			pEp->Done = 0;
+			if (Callback) {
+				Callback(pArg, done, status);
+			}
+		}
+	}
+
+	/* The controller stops on a halted dTD, carry on with the next transfer */
+	if (!Cancel && (pEp->Head != QUEUE_TD_NONE) && !DcdEndpointPrimed(corenum, PhyEP)) {
+		DcdQueuePrime(corenum, PhyEP, pEp->Head);
+	}
+}
+
+void DcdQueueFlush(uint8_t corenum, uint8_t PhyEP)
+{
+	uint32_t primask;
+
+	if (PhyEP >= USED_PHYSICAL_ENDPOINTS(corenum)) {
+		return;
+	}
+	primask = __get_PRIMASK();
+	__disable_irq();
+	USB_REG(corenum)->ENDPTFLUSH = _BIT(EP_Physical2BitPosition(PhyEP));
+	while (USB_REG(corenum)->ENDPTFLUSH) ;
+	dQueueHead[corenum][PhyEP].overlay.NextTD = LINK_TERMINATE;
+	DcdQueueComplete(corenum, PhyEP, true);
+	Dcd_Queue[corenum].Ep[PhyEP].Enabled = false;
+	__set_PRIMASK(primask);
+}
+
 void DcdInsertTD(uint32_t head, uint32_t newtd)
 {
 	DeviceTransferDescriptor *pTD = (DeviceTransferDescriptor *) head;
@@ -289,9 +753,9 @@ void DcdPrepareTD(DeviceTransferDescriptor *pDTD, uint8_t *pData, uint32_t lengt
 	pDTD->Active = 1;
 	pDTD->BufferPage[0] = (uint32_t) pData;
 	pDTD->BufferPage[1] = ((uint32_t) pData + 0x1000) & 0xfffff000;
-	//	pDTD->BufferPage[2] = ((uint32_t) pData + 0x2000) & 0xfffff000;
-	//	pDTD->BufferPage[3] = ((uint32_t) pData + 0x3000) & 0xfffff000;
-	//	pDTD->BufferPage[4] = ((uint32_t) pData + 0x4000) & 0xfffff000;
+	pDTD->BufferPage[2] = ((uint32_t) pData + 0x2000) & 0xfffff000;
+	pDTD->BufferPage[3] = ((uint32_t) pData + 0x3000) & 0xfffff000;
+	pDTD->BufferPage[4] = ((uint32_t) pData + 0x4000) & 0xfffff000;
 }
 
 void DcdDataTransfer(uint8_t corenum, uint8_t PhyEP, uint8_t *pData, uint32_t length)
@@ -341,13 +805,20 @@ void TransferCompleteISR(uint8_t corenum)
 	uint8_t * ISO_Address;
  	LPC_USBHS_T *	USB_Reg = USB_REG(corenum);
 	STREAM_VAR_t * current_stream = &Stream_Variable[corenum];
+	ISO_RING_T * iso_ring;
 	uint32_t ENDPTCOMPLETE = USB_Reg->ENDPTCOMPLETE;
 	USB_Reg->ENDPTCOMPLETE = ENDPTCOMPLETE;
 	if (ENDPTCOMPLETE) {
 		uint8_t n;
 		for (n = 0; n < USED_PHYSICAL_ENDPOINTS(corenum) / 2; n++) {	/* LOGICAL */
 			if ( ENDPTCOMPLETE & _BIT(n) ) {/* OUT */
-				if (((ENDPTCTRL_REG(corenum, n) >> 2) & EP_TYPE_MASK) == EP_TYPE_ISOCHRONOUS) {	// iso out endpoint
+				if ((iso_ring = IsoRingFind(corenum, 2 * n)) != NULL) {
+					IsoRingRecycle(corenum, iso_ring);
+				}
+				else if (Dcd_Queue[corenum].Ep[2 * n].Enabled) {
+					DcdQueueComplete(corenum, 2 * n, false);
+				}
+				else if (((ENDPTCTRL_REG(corenum, n) >> 2) & EP_TYPE_MASK) == EP_TYPE_ISOCHRONOUS) {	// iso out endpoint
 					uint32_t size = dQueueHead[corenum][2 * n].TransferCount;
                                         size -= dQueueHead[corenum][2 * n].overlay.TotalBytes;
 					// copy to share buffer
@@ -387,7 +858,13 @@ void TransferCompleteISR(uint8_t corenum)
 				EVENT_USB_Device_TransferComplete(n, 0);
 			}
 			if ( ENDPTCOMPLETE & _BIT( (n + 16) ) ) {	/* IN */
-				if (((ENDPTCTRL_REG(corenum, n) >> 18) & EP_TYPE_MASK) == EP_TYPE_ISOCHRONOUS) {	// iso in endpoint
+				if ((iso_ring = IsoRingFind(corenum, 2 * n + 1)) != NULL) {
+					IsoRingRecycle(corenum, iso_ring);
+				}
+				else if (Dcd_Queue[corenum].Ep[2 * n + 1].Enabled) {
+					DcdQueueComplete(corenum, 2 * n + 1, false);
+				}
+				else if (((ENDPTCTRL_REG(corenum, n) >> 18) & EP_TYPE_MASK) == EP_TYPE_ISOCHRONOUS) {	// iso in endpoint
 					uint32_t size;
 					ISO_Address = (uint8_t *) CALLBACK_HAL_GetISOBufferAddress(n, &size);
 					DcdDataTransfer(corenum, 2 * n + 1, ISO_Address, size);
@@ -438,6 +915,7 @@ void DcdIrqHandler(uint8_t corenum)
 	}
 
 	USB_Reg->USBSTS_D = USBSTS_D;	/* Acknowledge Interrupt */
+	ITM_TRACE2(ITM_EV_DCD_IRQ_ENTER, corenum, USBSTS_D);
 
 	/* Process Interrupt Sources */
 	if (USBSTS_D & USBSTS_D_UsbInt) {
@@ -462,6 +940,9 @@ void DcdIrqHandler(uint8_t corenum)
 			for (LogicalEP = 0; LogicalEP < USED_PHYSICAL_ENDPOINTS(corenum) / 2; LogicalEP++)
 				if (ENDPTNAK & _BIT(LogicalEP)) {	/* Only OUT Endpoint is NAK enable */
 					uint8_t PhyEP = 2 * LogicalEP;
+					if (Dcd_Queue[corenum].Ep[PhyEP].Enabled) {
+						continue;
+					}
 					if ( !(USB_Reg->ENDPTSTAT & _BIT(LogicalEP)) ) {/* Is In ready */
 						/* Check read OUT flag */
 						if (!dQueueHead[corenum][PhyEP].IsOutReceived) {
@@ -517,6 +998,7 @@ void DcdIrqHandler(uint8_t corenum)
 	if (USBSTS_D & USBSTS_D_UsbErrorInt) {					/* Error Interrupt */
 		// while(1){}
 	}
+	ITM_TRACE(ITM_EV_DCD_IRQ_EXIT);
 }
 
 uint32_t Dummy_EPGetISOAddress(uint32_t EPNum, uint32_t *last_packet_size)
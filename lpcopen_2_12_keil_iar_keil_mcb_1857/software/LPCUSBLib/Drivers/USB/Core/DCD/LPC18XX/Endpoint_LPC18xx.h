@@ -106,25 +106,42 @@ typedef struct _ROM {
 
 				#define ROMDRIVER_USB0_BASE LPC_USB0_BASE
 				#define ROMDRIVER_USB1_BASE LPC_USB1_BASE
-				#define ROMDRIVER_MEM_SIZE  0x1000
+
+/* Work buffers of the ROM stack and its class drivers, only reserved for the classes
+   enabled with USB_ROM_x_CLASS in LPCUSBlibConfig.h */
+				#ifndef ROMDRIVER_MEM_SIZE
+					#define ROMDRIVER_MEM_SIZE  0x1000
+				#endif
 extern uint8_t usb_RomDriver_buffer[ROMDRIVER_MEM_SIZE];
 
-				#define ROMDRIVER_MSC_MEM_SIZE  0x1000
+				#if (USB_ROM_MSC_CLASS)
+					#ifndef ROMDRIVER_MSC_MEM_SIZE
+						#define ROMDRIVER_MSC_MEM_SIZE  0x1000
+					#endif
 extern uint8_t usb_RomDriver_MSC_buffer[ROMDRIVER_MSC_MEM_SIZE];
+				#endif
 
-				#define ROMDRIVER_CDC_MEM_SIZE  0x800
+				#if (USB_ROM_CDC_CLASS)
+					#ifndef ROMDRIVER_CDC_MEM_SIZE
+						#define ROMDRIVER_CDC_MEM_SIZE  0x800
+					#endif
 extern uint8_t usb_RomDriver_CDC_buffer[ROMDRIVER_CDC_MEM_SIZE];
-				#define ROMDRIVER_CDC_DATA_BUFFER_SIZE  640
-				#if (USB_FORCED_FULLSPEED)
-					#define CDC_MAX_BULK_EP_SIZE            64
-				#else
-					#define CDC_MAX_BULK_EP_SIZE            512
-				#endif
+					#define ROMDRIVER_CDC_DATA_BUFFER_SIZE  640
+					#if (USB_FORCED_FULLSPEED)
+						#define CDC_MAX_BULK_EP_SIZE            64
+					#else
+						#define CDC_MAX_BULK_EP_SIZE            512
+					#endif
 extern uint8_t UsbdCdc_EPIN_buffer[CDC_MAX_BULK_EP_SIZE];
 extern uint8_t UsbdCdc_EPOUT_buffer[CDC_MAX_BULK_EP_SIZE];
+				#endif
 
-				#define ROMDRIVER_HID_MEM_SIZE  0x800
+				#if (USB_ROM_HID_CLASS)
+					#ifndef ROMDRIVER_HID_MEM_SIZE
+						#define ROMDRIVER_HID_MEM_SIZE  0x800
+					#endif
 extern uint8_t usb_RomDriver_HID_buffer[ROMDRIVER_HID_MEM_SIZE];
+				#endif
 /*==========================================================================*/
 			#endif
 
@@ -274,8 +291,49 @@ typedef struct {
 extern volatile DeviceQueueHead * const dQueueHead[];
 extern DeviceTransferDescriptor * const dTransferDescriptor[];
 
+/* Memory the USB DMA master can fetch from and store to: local SRAM and AHB SRAM.
+ * dTD buffer pointers are byte granular, so no further alignment is needed. */
+#define ENDPOINT_DMA_CAPABLE(p)     (((((uint32_t) (p)) >= 0x10000000) && (((uint32_t) (p)) < 0x10092000)) || \
+									 ((((uint32_t) (p)) >= 0x20000000) && (((uint32_t) (p)) < 0x20010000)))
+/* Largest single dTD transfer, five buffer pages always cover 16KB */
+#define ENDPOINT_DMA_MAX_XFER       0x4000
+
 void DcdDataTransfer(uint8_t corenum, uint8_t EPNum, uint8_t *pData, uint32_t cnt);
 
+/** Status passed to a queued transfer completion callback */
+typedef enum {
+	DCD_TRANSFER_OK = 0,
+	DCD_TRANSFER_ERROR,			/* dTD retired halted or with a transaction/buffer error */
+	DCD_TRANSFER_CANCELLED		/* removed by DcdQueueFlush() or a bus reset */
+} DCD_TRANSFER_STATUS;
+
+/** Queued transfer completion callback, called from the USB interrupt with the bytes transferred */
+typedef void (*DCD_TRANSFER_CALLBACK)(void *pArg, uint32_t Length, DCD_TRANSFER_STATUS Status);
+
+/**
+ * @brief	Queues a transfer on a physical endpoint behind any transfers already in flight.
+ *  IN transfers are split over as many chained dTDs as needed. OUT transfers complete on a short
+ *  packet and therefore must fit one dTD (16KB). The first call switches the endpoint to queued
+ *  mode, in which the Endpoint_Read/Write shared buffers are no longer used for it.
+ * @param	corenum		: ID Number of USB Core to be processed.
+ * @param	PhyEP		: Physical endpoint number.
+ * @param	pData		: Transfer buffer in USB accessible RAM.
+ * @param	length		: Transfer length in bytes.
+ * @param	Callback	: Optional completion callback.
+ * @param	pArg		: Argument passed to @a Callback.
+ * @return	true if queued, false if out of dTDs or @a length is not valid.
+ */
+bool DcdQueueTransfer(uint8_t corenum, uint8_t PhyEP, uint8_t *pData, uint32_t length,
+					  DCD_TRANSFER_CALLBACK Callback, void *pArg);
+
+/**
+ * @brief	Flushes the endpoint, cancels every queued transfer and leaves queued mode.
+ * @param	corenum		: ID Number of USB Core to be processed.
+ * @param	PhyEP		: Physical endpoint number.
+ * @return	Nothing
+ */
+void DcdQueueFlush(uint8_t corenum, uint8_t PhyEP);
+
 void Endpoint_Streaming(uint8_t corenum, uint8_t *buffer, uint16_t packetsize,
 						uint16_t totalpackets, uint16_t dummypackets);
 
@@ -37,6 +37,66 @@
 #include "EndpointStream.h"
 
 #if !defined(CONTROL_ONLY_DEVICE)
+#if defined(__LPC18XX__) || defined(__LPC43XX__)
+/* Whole packets of a large stream are moved by pointing the dTD straight at the caller's
+ * buffer. Only the head already sitting in, and the tail shorter than a packet left for,
+ * the shared endpoint buffer go through the byte copy. */
+static uint16_t Endpoint_DirectLength(uint8_t corenum, uint8_t PhyEP, const void *Buffer, uint32_t Length)
+{
+	uint32_t mps = dQueueHead[corenum][PhyEP].MaxPacketSize;
+
+	if ((mps == 0) || (Length < mps) || !ENDPOINT_DMA_CAPABLE(Buffer)) {
+		return 0;
+	}
+	if (Length > ENDPOINT_DMA_MAX_XFER) {
+		Length = ENDPOINT_DMA_MAX_XFER;
+	}
+	return Length - (Length % mps);
+}
+
+static uint16_t Endpoint_Write_Direct(uint8_t corenum, const uint8_t *Buffer, uint16_t Length)
+{
+	uint8_t PhyEP = endpointhandle(corenum)[endpointselected[corenum]];
+	uint16_t done = 0, chunk;
+
+	if ((endpointselected[corenum] == ENDPOINT_CONTROLEP) || (usb_data_buffer_IN_index[corenum] != 0) || (Length == 0)) {
+		return 0;
+	}
+	/* Keep at least one byte for the copy path, so Endpoint_ClearIN() ends the transfer as before */
+	Length--;
+	while ((chunk = Endpoint_DirectLength(corenum, PhyEP, Buffer + done, Length - done)) != 0) {
+		DcdDataTransfer(corenum, PhyEP, (uint8_t *) Buffer + done, chunk);
+		while ( !Endpoint_IsINReady(corenum) ) ;	/* Buffer belongs to the controller until retired */
+		done += chunk;
+	}
+	return done;
+}
+
+static uint16_t Endpoint_Read_Direct(uint8_t corenum, uint8_t *Buffer, uint16_t Length, bool *ShortPacket)
+{
+	uint8_t PhyEP = endpointhandle(corenum)[endpointselected[corenum]];
+	uint16_t done = 0, chunk, received;
+
+	*ShortPacket = false;
+	if ((endpointselected[corenum] == ENDPOINT_CONTROLEP) || (usb_data_buffer_OUT_size[corenum] != 0)) {
+		return 0;
+	}
+	while ((chunk = Endpoint_DirectLength(corenum, PhyEP, Buffer + done, Length - done)) != 0) {
+		dQueueHead[corenum][PhyEP].IsOutReceived = 0;
+		DcdDataTransfer(corenum, PhyEP, Buffer + done, chunk);
+		while (!dQueueHead[corenum][PhyEP].IsOutReceived) ;
+		received = usb_data_buffer_OUT_size[corenum];
+		usb_data_buffer_OUT_size[corenum] = 0;
+		done += received;
+		if (received < chunk) {
+			*ShortPacket = true;	/* short packet ends the host's transfer */
+			break;
+		}
+	}
+	return done;
+}
+#endif
+
 uint8_t Endpoint_Discard_Stream(uint8_t corenum,
 								uint16_t Length,
 								uint16_t *const BytesProcessed)
@@ -66,14 +126,20 @@ uint8_t Endpoint_Write_Stream_LE(uint8_t corenum,
 								 uint16_t Length,
 								 uint16_t *const BytesProcessed)
 {
-	uint16_t i;
+	uint16_t i = 0;
 
 	while ( !Endpoint_IsINReady(corenum) ) {	/*-- Wait until ready --*/
 		Delay_MS(2);
 	}
-	for (i = 0; i < Length; i++)
+#if defined(__LPC18XX__) || defined(__LPC43XX__)
+	i = Endpoint_Write_Direct(corenum, (const uint8_t *) Buffer, Length);
+#endif
+	for (; i < Length; i++)
 		Endpoint_Write_8(corenum, ((uint8_t *) Buffer)[i]);
 
+	if (BytesProcessed != NULL) {
+		*BytesProcessed = Length;
+	}
 	return ENDPOINT_RWSTREAM_NoError;
 }
 
@@ -104,6 +170,32 @@ uint8_t Endpoint_Read_Stream_LE(uint8_t corenum,
 		return ENDPOINT_RWSTREAM_IncompleteTransfer;
 	}
 
+#if defined(__LPC18XX__) || defined(__LPC43XX__)
+	if ((endpointselected[corenum] != ENDPOINT_CONTROLEP) && (Length > usb_data_buffer_OUT_size[corenum])) {
+		uint8_t PhyEP = endpointhandle(corenum)[endpointselected[corenum]];
+		uint16_t head = usb_data_buffer_OUT_size[corenum];
+		bool ShortPacket;
+
+		/* Head: what the shared buffer already holds */
+		for (i = 0; i < head; i++)
+			((uint8_t *) Buffer)[i] = Endpoint_Read_8(corenum);
+		i += Endpoint_Read_Direct(corenum, (uint8_t *) Buffer + i, Length - i, &ShortPacket);
+		if ((i < Length) && !ShortPacket) {
+			/* Tail: let the NAK handler prime the shared buffer for the next packet */
+			usb_data_buffer_OUT_index[corenum] = 0;
+			dQueueHead[corenum][PhyEP].IsOutReceived = 0;
+			USB_REG(corenum)->ENDPTNAKEN |= (1 << endpointselected[corenum]);
+			while (!dQueueHead[corenum][PhyEP].IsOutReceived) ;
+			for (; (i < Length) && (usb_data_buffer_OUT_size[corenum] > 0); i++)
+				((uint8_t *) Buffer)[i] = Endpoint_Read_8(corenum);
+		}
+		if (BytesProcessed != NULL) {
+			*BytesProcessed = i;
+		}
+		return ENDPOINT_RWSTREAM_NoError;
+	}
+#endif
+
 	for (i = 0; i < Length; i++) {
 		#if defined(__LPC175X_6X__) || defined(__LPC177X_8X__) || defined(__LPC407X_8X__)
 		if (endpointselected[corenum] != ENDPOINT_CONTROLEP) {
@@ -49,3 +49,10 @@ void USB_Host_DeviceEnumerationFailed_Event_Stub(const uint8_t ErrorCode,
 {
 }
 #endif
+
+#if defined(USB_EVENT_DRIVEN_TASK)
+void USB_TaskPending_Event_Stub(const uint8_t corenum)
+{
+
+}
+#endif
@@ -319,6 +319,18 @@
 			void EVENT_USB_Device_StartOfFrame(void);
 		#endif
 
+		#if defined(USB_EVENT_DRIVEN_TASK) || defined(__DOXYGEN__)
+			/** Event for pending USB management work, fired from the USB interrupt each time it marks @ref USB_USBTask()
+			 *  as having work to do. Under an RTOS this should wake the task running @ref USB_USBTask(), for example with
+			 *  a FreeRTOS \c vTaskNotifyGiveFromISR(); bare-metal applications can rely on @ref USB_WaitForTask() instead.
+			 *
+			 *  @note This event only exists if the \c USB_EVENT_DRIVEN_TASK token is supplied to the compiler.
+			 *
+			 *  @param corenum : ID Number of USB Core with pending work.
+			 */
+			void EVENT_USB_TaskPending(const uint8_t corenum);
+		#endif
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Function Prototypes: */
@@ -373,6 +385,12 @@ PRAGMA_WEAK(EVENT_USB_Device_Reset,USB_Event_Stub)
 PRAGMA_WEAK(EVENT_USB_Device_StartOfFrame,USB_Event_Stub)				
 					void EVENT_USB_Device_StartOfFrame(void) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
 				#endif
+
+				#if defined(USB_EVENT_DRIVEN_TASK)
+				void USB_TaskPending_Event_Stub(const uint8_t corenum);
+PRAGMA_WEAK(EVENT_USB_TaskPending,USB_TaskPending_Event_Stub)
+					void EVENT_USB_TaskPending(const uint8_t corenum) ATTR_WEAK ATTR_ALIAS(USB_TaskPending_Event_Stub);
+				#endif
 			#endif
 	#endif
 
@@ -110,6 +110,10 @@ void USB_IRQHandler(void)
 		DcdIrqHandler(0);
 		#endif
 	}
+
+	#if defined(USB_EVENT_DRIVEN_TASK)
+	USB_SignalTask(0);
+	#endif
 }
 
 #endif /*__LPC17XX__ || __LPC40XX__*/
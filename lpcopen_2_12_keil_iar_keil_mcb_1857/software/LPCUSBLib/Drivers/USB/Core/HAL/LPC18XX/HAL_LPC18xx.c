@@ -200,6 +200,10 @@ void USB0_IRQHandler(void)
 			#endif
 		#endif
 	}
+
+	#if defined(USB_EVENT_DRIVEN_TASK)
+	USB_SignalTask(0);
+	#endif
 }
 
 void USB1_IRQHandler(void)
@@ -218,6 +222,10 @@ void USB1_IRQHandler(void)
 			#endif
 		#endif
 	}
+
+	#if defined(USB_EVENT_DRIVEN_TASK)
+	USB_SignalTask(1);
+	#endif
 }
 
 #endif /*__LPC18XX__*/
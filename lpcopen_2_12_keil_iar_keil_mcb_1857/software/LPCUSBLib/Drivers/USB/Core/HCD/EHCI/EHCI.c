@@ -52,6 +52,10 @@ NextLinkPointer PeriodFrameList0[FRAME_LIST_SIZE] ATTR_ALIGNED(4096) __BSS(USBRA
 PRAGMA_ALIGN_4096
 NextLinkPointer PeriodFrameList1[FRAME_LIST_SIZE] ATTR_ALIGNED(4096) __BSS(USBRAM_SECTION);		/* Period Frame List */
 Pipe_Stream_Handle_T PipeStreaming[MAX_USB_CORE];
+static EHCI_HOST_POOLS_T ehci_pools[MAX_USB_CORE];
+static HCD_TRANSFER_NOTIFY ehci_notify[MAX_USB_CORE][HCD_MAX_QHD];
+static EHCI_PERIODIC_BW_T ehci_bw[MAX_USB_CORE];
+static EHCI_ISO_STREAM_T ehci_iso_stream[MAX_USB_CORE][HCD_MAX_QHD];
 /*=======================================================================*/
 /* G L O B A L   F U N C T I O N S                                       */
 /*=======================================================================*/
@@ -164,6 +168,10 @@ HCD_STATUS HcdOpenPipe(uint8_t HostID,
 	case INTERRUPT_TRANSFER:
 		ASSERT_STATUS_OK(AllocQhd(HostID, DeviceAddr, DeviceSpeed, EndpointNumber, TransferType, TransferDir,
 								  MaxPacketSize, Interval, Mult, HSHubDevAddr, HSHubPortNum, &HeadIdx) );
+		if (PeriodicReserve(HostID, HeadIdx, TransferType) != HCD_STATUS_OK) {
+			FreeQhd(HostID, HeadIdx);
+			ASSERT_STATUS_OK_MESSAGE(HCD_STATUS_NOT_ENOUGH_BANDWIDTH, "Periodic schedule is full");
+		}
 		DisablePeriodSchedule(HostID);
 		InsertLinkPointer(&HcdIntHead(HostID)->Horizontal, &HcdQHD(HostID, HeadIdx)->Horizontal, QHD_TYPE);
 		EnablePeriodSchedule(HostID);
@@ -179,6 +187,10 @@ HCD_STATUS HcdOpenPipe(uint8_t HostID,
 #endif
 		ASSERT_STATUS_OK(AllocQhd(HostID, DeviceAddr, DeviceSpeed, EndpointNumber, TransferType, TransferDir,
 								  MaxPacketSize, Interval, Mult, HSHubDevAddr, HSHubPortNum, &HeadIdx) );
+		if (PeriodicReserve(HostID, HeadIdx, TransferType) != HCD_STATUS_OK) {
+			FreeQhd(HostID, HeadIdx);
+			ASSERT_STATUS_OK_MESSAGE(HCD_STATUS_NOT_ENOUGH_BANDWIDTH, "Periodic schedule is full");
+		}
 		EnablePeriodSchedule(HostID);
 		break;
 	}
@@ -199,11 +211,13 @@ HCD_STATUS HcdClosePipe(uint32_t PipeHandle)
 	case CONTROL_TRANSFER:
 	case BULK_TRANSFER:
 	case INTERRUPT_TRANSFER:
+		PeriodicRelease(HostID, HeadIdx);
 		RemoveQueueHead(HostID, HeadIdx);
 		USB_REG(HostID)->USBCMD_H |= EHC_USBCMD_IntAsyncAdvanceDoorbell;	/* DoorBell Handshake: Queue Head will only be free in AsyncAdvanceIsr */
 		break;
 
 	case ISOCHRONOUS_TRANSFER:
+		PeriodicRelease(HostID, HeadIdx);
 		FreeQhd(HostID, HeadIdx);
 		DisablePeriodSchedule(HostID);
 		break;
@@ -218,6 +232,8 @@ HCD_STATUS HcdCancelTransfer(uint32_t PipeHandle)
 
 	ASSERT_STATUS_OK(PipehandleParse(PipeHandle, &HostID, &XferType, &HeadIdx) );
 
+	ehci_notify[HostID][HeadIdx].Callback = NULL;	/* cancelled transfers are not reported */
+	ehci_iso_stream[HostID][HeadIdx].Running = 0;
 	DisableSchedule(HostID, (XferType == INTERRUPT_TRANSFER) || (XferType == ISOCHRONOUS_TRANSFER) ? 1 : 0);
 
 	if (XferType == ISOCHRONOUS_TRANSFER) {	/* ISOCHRONOUS_TRANSFER */
@@ -233,7 +249,7 @@ HCD_STATUS HcdCancelTransfer(uint32_t PipeHandle)
 					if (HeadIdx == pItd->IhdIdx) {
 						/*-- remove matched ITD --*/
 						pNextPointer->Link = pItd->Horizontal.Link;
-						FreeHsItd(pItd);
+						FreeHsItd(HostID, pItd);
 						continue;	/*-- skip advance pNextPointer due to TD removal --*/
 					}
 				}
@@ -243,7 +259,7 @@ HCD_STATUS HcdCancelTransfer(uint32_t PipeHandle)
 					if (HeadIdx == pSItd->IhdIdx) {
 						/*-- removed matched SITD --*/
 						pNextPointer->Link = pSItd->Horizontal.Link;
-						FreeSItd(pSItd);
+						FreeSItd(HostID, pSItd);
 						continue;	/*-- skip advance pNextPointer due to TD removal --*/
 					}
 				}
@@ -261,7 +277,7 @@ HCD_STATUS HcdCancelTransfer(uint32_t PipeHandle)
 
 			pQtd->Active = 0;
 			pQtd->IntOnComplete = 0;/* no interrupt scenario on this TD */
-			FreeQtd(pQtd);
+			FreeQtd(HostID, pQtd);
 		}
 		HcdQHD(HostID, HeadIdx)->FirstQtd = LINK_TERMINATE;
 	}
@@ -371,6 +387,35 @@ HCD_STATUS HcdDataTransfer(uint32_t PipeHandle,
 	return HCD_STATUS_OK;
 }
 
+HCD_STATUS HcdDataTransferAsync(uint32_t PipeHandle,
+								uint8_t *const buffer,
+								uint32_t const length,
+								uint16_t *const pActualTransferred,
+								HCD_TRANSFER_CALLBACK Callback,
+								void *pArg)
+{
+	uint8_t HostID, HeadIdx;
+	HCD_TRANSFER_TYPE XferType;
+	HCD_STATUS status;
+	uint32_t primask;
+
+	ASSERT_STATUS_OK(PipehandleParse(PipeHandle, &HostID, &XferType, &HeadIdx) );
+
+	/* Hold off the completion ISR until both the callback and the queued status are in place */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	ehci_notify[HostID][HeadIdx].Callback = Callback;
+	ehci_notify[HostID][HeadIdx].pArg = pArg;
+	ehci_notify[HostID][HeadIdx].PipeHandle = PipeHandle;
+	status = HcdDataTransfer(PipeHandle, buffer, length, pActualTransferred);
+	if (status != HCD_STATUS_OK) {
+		ehci_notify[HostID][HeadIdx].Callback = NULL;
+	}
+	__set_PRIMASK(primask);
+
+	return status;
+}
+
 HCD_STATUS HcdGetPipeStatus(uint32_t PipeHandle)/* TODO can be implemented based on overlay */
 {
 	uint8_t HostID, HeadIdx;
@@ -381,11 +426,52 @@ HCD_STATUS HcdGetPipeStatus(uint32_t PipeHandle)/* TODO can be implemented based
 	return (HCD_STATUS)HcdQHD(HostID, HeadIdx)->status;
 }
 
+/*---------- Descriptor Pool Routines ----------*/
+static void PoolInit(EHCI_POOL_T *pPool, uint8_t *pFree, uint8_t Size)
+{
+	pPool->pFree = pFree;
+	pPool->NumFree = 0;
+	pPool->Size = Size;
+	pPool->HighWater = 0;
+}
+
+/* Take a free descriptor index, returns -1 if the pool is exhausted */
+static int32_t PoolGet(EHCI_POOL_T *pPool)
+{
+	uint32_t primask = __get_PRIMASK();
+	int32_t Idx = -1;
+
+	/* Descriptors are allocated and released from both task and ISR context */
+	__disable_irq();
+	if (pPool->NumFree > 0) {
+		Idx = pPool->pFree[--pPool->NumFree];
+		if ((pPool->Size - pPool->NumFree) > pPool->HighWater) {
+			pPool->HighWater = pPool->Size - pPool->NumFree;
+		}
+	}
+	__set_PRIMASK(primask);
+
+	return Idx;
+}
+
+static void PoolPut(EHCI_POOL_T *pPool, uint8_t Idx)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	pPool->pFree[pPool->NumFree++] = Idx;
+	__set_PRIMASK(primask);
+}
+
 static void FreeQhd(uint8_t HostID, uint8_t QhdIdx)
 {
+	if (HcdQHD(HostID, QhdIdx)->inUse == 0) {
+		return;
+	}
 	HcdQHD(HostID, QhdIdx)->status = HCD_STATUS_STRUCTURE_IS_FREE;
 	HcdQHD(HostID, QhdIdx)->Horizontal.Link |= LINK_TERMINATE;
 	HcdQHD(HostID, QhdIdx)->inUse = 0;
+	PoolPut(&ehci_pools[HostID].Qhd, QhdIdx);
 }
 
 static HCD_STATUS AllocQhd(uint8_t HostID,
@@ -401,12 +487,13 @@ static HCD_STATUS AllocQhd(uint8_t HostID,
 						   uint8_t HSHubPortNum,
 						   uint32_t *pQhdIdx)
 {
-	/* Looking for a free QHD */
-	for ( (*pQhdIdx) = 0; (*pQhdIdx) < HCD_MAX_QTD && HcdQHD(HostID, *pQhdIdx)->inUse; (*pQhdIdx)++) {}
+	/* Take a free QHD */
+	int32_t Idx = PoolGet(&ehci_pools[HostID].Qhd);
 
-	if ((*pQhdIdx) == HCD_MAX_QTD ) {
+	if (Idx < 0) {
 		return HCD_STATUS_NOT_ENOUGH_ENDPOINT;
 	}
+	*pQhdIdx = (uint32_t) Idx;
 
 	memset(HcdQHD(HostID, *pQhdIdx), 0, sizeof(HCD_QHD) );
 
@@ -430,8 +517,7 @@ static HCD_STATUS AllocQhd(uint8_t HostID,
 		   *pQhdIdx)->ControlEndpointFlag = (DeviceSpeed != HIGH_SPEED && TransferType == CONTROL_TRANSFER) ? 1 : 0;
 	HcdQHD(HostID, *pQhdIdx)->NakCountReload = 0;	/* infinite NAK/NYET */
 
-	/*-- Currently All interrupt endpoints will be served as 1 (micro)frame polling, thus Interval parameter is ignored --*/
-	/*-- For High Speed Interval should be used to compute the uFrameSMask --*/
+	/*-- Interrupt endpoints are visited every frame, PeriodicReserve narrows the masks to the planned microframes --*/
 	HcdQHD(HostID,
 		   *pQhdIdx)->uFrameSMask =
 		(TransferType == INTERRUPT_TRANSFER) ? (DeviceSpeed == HIGH_SPEED ? 0xFF : 0x01) : 0;
@@ -479,11 +565,162 @@ static HCD_STATUS RemoveQueueHead(uint8_t HostID, uint8_t QhdIdx)
 	return HCD_STATUS_OK;
 }
 
+/*---------- Periodic Bandwidth Routines ----------*/
+/* Byte times of a data payload including worst case bit stuffing */
+static __INLINE uint32_t BitStuffBytes(uint32_t ByteCount)
+{
+	return (ByteCount * 7 + 5) / 6;
+}
+
+/* Microframes of a frame polled at Period microframes starting from Phase */
+static uint8_t PeriodicMask(uint8_t Phase, uint8_t Period)
+{
+	uint8_t Mask = 0;
+
+	for (; Phase < 8; Phase += Period) {
+		Mask |= 1 << Phase;
+	}
+	return Mask;
+}
+
+static uint32_t PeriodicMaxLoad(EHCI_PERIODIC_BW_T *pBw, uint8_t Mask)
+{
+	uint32_t MaxLoad = 0;
+	uint8_t i;
+
+	for (i = 0; i < 8; i++) {
+		if ((Mask & (1 << i)) && (pBw->uFrameLoad[i] > MaxLoad)) {
+			MaxLoad = pBw->uFrameLoad[i];
+		}
+	}
+	return MaxLoad;
+}
+
+/* Pick the least loaded microframes for a periodic head and program its S-mask/C-mask.
+   Fails without changing anything when the pipe would oversubscribe the schedule */
+static HCD_STATUS PeriodicReserve(uint8_t HostID, uint8_t HeadIdx, HCD_TRANSFER_TYPE XferType)
+{
+	EHCI_PERIODIC_BW_T *pBw = &ehci_bw[HostID];
+	EHCI_PERIODIC_RESV_T *pResv = &pBw->Resv[HeadIdx];
+	PHCD_QHD pQhd = HcdQHD(HostID, HeadIdx);
+	uint32_t ByteCount = pQhd->MaxPackageSize * pQhd->Mult;
+	uint32_t BestLoad = 0xFFFFFFFF;
+	uint8_t BestPhase = 0;
+	uint8_t Phase, Mask, i;
+
+	memset(pResv, 0, sizeof(EHCI_PERIODIC_RESV_T));
+
+	if (pQhd->EndpointSpeed == HIGH_SPEED) {
+		/*-- bInterval is 2^(Interval-1) microframes, anything longer than a frame is served every frame --*/
+		uint8_t Period = ((XferType == ISOCHRONOUS_TRANSFER) || (pQhd->Interval == 0)) ? 1 :
+						 (pQhd->Interval >= 4 ? 8 : (1 << (pQhd->Interval - 1)));
+		uint32_t HsCost = HS_XACT_OVERHEAD * pQhd->Mult + BitStuffBytes(ByteCount);
+
+		for (Phase = 0; Phase < Period; Phase++) {
+			uint32_t Load = PeriodicMaxLoad(pBw, PeriodicMask(Phase, Period));
+			if (Load < BestLoad) {
+				BestLoad = Load;
+				BestPhase = Phase;
+			}
+		}
+		if (BestLoad + HsCost > HS_UFRAME_PERIODIC_BUDGET) {
+			return HCD_STATUS_NOT_ENOUGH_BANDWIDTH;
+		}
+		pResv->HsCost = HsCost;
+		pResv->HsMask = PeriodicMask(BestPhase, Period);
+		if (XferType == INTERRUPT_TRANSFER) {
+			pQhd->uFrameSMask = pResv->HsMask;
+		}
+	}
+	else {	/*-- Full/Low speed behind a TT: balance start split slots --*/
+		uint32_t FsCost = FS_XACT_OVERHEAD + BitStuffBytes(ByteCount);
+		uint32_t FsTotal = 0;
+		uint32_t HsCost;
+		uint8_t SplitMask;
+		uint8_t LastPhase;
+
+		if (pQhd->EndpointSpeed == LOW_SPEED) {
+			FsCost *= LS_BYTE_TIMES;
+		}
+		for (i = 0; i < SPLIT_START_SLOTS; i++) {
+			FsTotal += pBw->SplitLoad[i];
+		}
+		if (FsTotal + FsCost > FS_FRAME_PERIODIC_BUDGET) {
+			return HCD_STATUS_NOT_ENOUGH_BANDWIDTH;
+		}
+
+		if (XferType == ISOCHRONOUS_TRANSFER) {	/*-- ISO OUT: one start split per 188 bytes, no complete split --*/
+			uint8_t SplitCount = (ByteCount + SPLIT_MAX_LEN_UFRAME - 1) / SPLIT_MAX_LEN_UFRAME;
+
+			if (SplitCount == 0) {
+				SplitCount = 1;
+			}
+			SplitMask = (1 << SplitCount) - 1;
+			LastPhase = MIN(SPLIT_START_SLOTS - 1, 8 - SplitCount);
+			HsCost = HS_XACT_OVERHEAD + BitStuffBytes(MIN(ByteCount, SPLIT_MAX_LEN_UFRAME));
+		}
+		else {
+			SplitMask = SPLIT_INT_SMASK | SPLIT_INT_CMASK;
+			LastPhase = SPLIT_START_SLOTS - 1;
+			HsCost = HS_XACT_OVERHEAD + BitStuffBytes(ByteCount);
+		}
+
+		for (Phase = 0; Phase <= LastPhase; Phase++) {
+			Mask = SplitMask << Phase;
+			if ((PeriodicMaxLoad(pBw, Mask) + HsCost <= HS_UFRAME_PERIODIC_BUDGET) &&
+				(pBw->SplitLoad[Phase] < BestLoad)) {
+				BestLoad = pBw->SplitLoad[Phase];
+				BestPhase = Phase;
+			}
+		}
+		if (BestLoad == 0xFFFFFFFF) {
+			return HCD_STATUS_NOT_ENOUGH_BANDWIDTH;
+		}
+		pResv->HsCost = HsCost;
+		pResv->FsCost = FsCost;
+		pResv->HsMask = SplitMask << BestPhase;
+		pBw->SplitLoad[BestPhase] += FsCost;
+		if (XferType == INTERRUPT_TRANSFER) {
+			pQhd->uFrameSMask = SPLIT_INT_SMASK << BestPhase;
+			pQhd->uFrameCMask = SPLIT_INT_CMASK << BestPhase;
+		}
+	}
+
+	pResv->Phase = BestPhase;
+	for (i = 0; i < 8; i++) {
+		if (pResv->HsMask & (1 << i)) {
+			pBw->uFrameLoad[i] += pResv->HsCost;
+		}
+	}
+	return HCD_STATUS_OK;
+}
+
+static void PeriodicRelease(uint8_t HostID, uint8_t HeadIdx)
+{
+	EHCI_PERIODIC_BW_T *pBw = &ehci_bw[HostID];
+	EHCI_PERIODIC_RESV_T *pResv = &pBw->Resv[HeadIdx];
+	uint8_t i;
+
+	for (i = 0; i < 8; i++) {
+		if (pResv->HsMask & (1 << i)) {
+			pBw->uFrameLoad[i] -= pResv->HsCost;
+		}
+	}
+	if (pResv->FsCost) {
+		pBw->SplitLoad[pResv->Phase] -= pResv->FsCost;
+	}
+	memset(pResv, 0, sizeof(EHCI_PERIODIC_RESV_T));
+}
+
 /*---------- Queue TD Routines ----------*/
-static void FreeQtd(PHCD_QTD pQtd)
+static void FreeQtd(uint8_t HostID, PHCD_QTD pQtd)
 {
+	if (pQtd->inUse == 0) {
+		return;
+	}
 	pQtd->NextQtd |= LINK_TERMINATE;
 	pQtd->inUse = 0;
+	PoolPut(&ehci_pools[HostID].Qtd, (uint8_t) (pQtd - HcdQTD(HostID, 0)));
 }
 
 /** Direction, DataToggle parameter only has meaning for control transfer, for other transfer use 0 for these paras */
@@ -495,12 +732,13 @@ static HCD_STATUS AllocQTD(uint8_t HostID,
 						   uint8_t DataToggle,
 						   uint8_t IOC)
 {
-	for ((*pTdIdx) = 0; (*pTdIdx) < HCD_MAX_QTD && HcdQTD(HostID, *pTdIdx)->inUse; (*pTdIdx)++) {}
+	int32_t TdIdx = PoolGet(&ehci_pools[HostID].Qtd);
 
-	if ((*pTdIdx) < HCD_MAX_QTD) {
+	if (TdIdx >= 0) {
 		uint8_t idx = 1;
 		uint32_t BytesInPage;
 
+		*pTdIdx = (uint32_t) TdIdx;
 		memset(HcdQTD(HostID, *pTdIdx), 0, sizeof(HCD_QTD));
 
 		HcdQTD(HostID, *pTdIdx)->NextQtd = 1;
@@ -538,16 +776,17 @@ static HCD_STATUS QueueQTDs (uint8_t HostID,
 							 uint8_t DataToggle)
 {
 	uint32_t TailTdIdx=0xFFFFFFFF;
+	bool is_chained = false;
 
 	while (xferLen > 0)
 	{
 		uint32_t TdLen;
 		uint32_t MaxTDLen = QTD_MAX_XFER_LENGTH - Offset4k((uint32_t)dataBuff);
 
+		/* Fill each qTD up to its 5 pages, whole packets only so no short packet ends the chain early */
 		if(PipeStreaming[HostID].PacketSize > 0)
-			TdLen = MIN(xferLen, PipeStreaming[HostID].PacketSize);
-		else
-			TdLen = MIN(xferLen, MaxTDLen);
+			MaxTDLen -= MaxTDLen % PipeStreaming[HostID].PacketSize;
+		TdLen = MIN(xferLen, MaxTDLen);
 		xferLen -= TdLen;
 
 		if (TailTdIdx == 0xFFFFFFFF)
@@ -568,7 +807,8 @@ static HCD_STATUS QueueQTDs (uint8_t HostID,
 				PipeStreaming[HostID].BufferAddress = (uint32_t)dataBuff;
 				PipeStreaming[HostID].RemainBytes = xferLen + TdLen;
 				PipeStreaming[HostID].DataToggle = DataToggle;
-				HcdQTD(HostID,HCD_MAX_QTD - 1)->IntOnComplete = 1;
+				HcdQTD(HostID,TailTdIdx)->IntOnComplete = 1;
+				is_chained = true;	/* rest is queued from RemoveCompletedQTD when this chain completes */
 				break;
 			}
 		}
@@ -576,17 +816,21 @@ static HCD_STATUS QueueQTDs (uint8_t HostID,
 		else DataToggle = 1;
 		dataBuff += TdLen;
 	}
-	if(xferLen == 0)
+	if(!is_chained)
 	{
 		memset(&PipeStreaming[HostID], 0, sizeof(Pipe_Stream_Handle_T));
 	}
 	return HCD_STATUS_OK;
 }
 
-static void FreeHsItd(PHCD_HS_ITD pItd)
+static void FreeHsItd(uint8_t HostID, PHCD_HS_ITD pItd)
 {
+	if (pItd->inUse == 0) {
+		return;
+	}
 	pItd->Horizontal.Link |= LINK_TERMINATE;
 	pItd->inUse = 0;
+	PoolPut(&ehci_pools[HostID].HsItd, (uint8_t) (pItd - HcdHsITD(HostID, 0)));
 }
 
 HCD_STATUS AllocHsItd(uint8_t HostID,
@@ -597,12 +841,14 @@ HCD_STATUS AllocHsItd(uint8_t HostID,
 					  uint8_t XactPerITD,
 					  uint8_t IntOnComplete)
 {
-	for ((*pTdIdx) = 0; (*pTdIdx) < HCD_MAX_HS_ITD && HcdHsITD(HostID, *pTdIdx)->inUse; (*pTdIdx)++) {}
-	if ((*pTdIdx) < HCD_MAX_HS_ITD) {
+	int32_t Idx = PoolGet(&ehci_pools[HostID].HsItd);
+
+	if (Idx >= 0) {
 		uint8_t i;
 		uint8_t XactStep = 8 / XactPerITD;
 		uint32_t MaxXactLen = HcdQHD(HostID, IhdIdx)->MaxPackageSize * HcdQHD(HostID, IhdIdx)->Mult;
 
+		*pTdIdx = (uint32_t) Idx;
 		memset(HcdHsITD(HostID, *pTdIdx), 0, sizeof(HCD_HS_ITD));
 
 		HcdHsITD(HostID, *pTdIdx)->inUse = 1;
@@ -687,10 +933,14 @@ static HCD_STATUS QueueITDs(uint8_t HostID, uint8_t IhdIdx, uint8_t *dataBuff, u
 	return HCD_STATUS_OK;
 }
 
-static void FreeSItd(PHCD_SITD pSItd)
+static void FreeSItd(uint8_t HostID, PHCD_SITD pSItd)
 {
+	if (pSItd->inUse == 0) {
+		return;
+	}
 	pSItd->Horizontal.Link |= LINK_TERMINATE;
 	pSItd->inUse = 0;
+	PoolPut(&ehci_pools[HostID].SItd, (uint8_t) (pSItd - HcdSITD(HostID, 0)));
 }
 
 static HCD_STATUS AllocSItd(uint8_t HostID,
@@ -703,11 +953,16 @@ static HCD_STATUS AllocSItd(uint8_t HostID,
 #define TCount_Pos 0
 #define TPos_Pos 3
 
-	for ((*pTdIdx) = 0; (*pTdIdx) < HCD_MAX_SITD && HcdSITD(HostID, *pTdIdx)->inUse; (*pTdIdx)++) {}
+	int32_t Idx = PoolGet(&ehci_pools[HostID].SItd);
 
-	if ((*pTdIdx) < HCD_MAX_SITD) {
+	if (Idx >= 0) {
 		uint8_t TCount = TDLen / SPLIT_MAX_LEN_UFRAME + (TDLen % SPLIT_MAX_LEN_UFRAME ? 1 : 0);	/*-- Number of Split Transactions --*/
 
+		if (TCount == 0) {
+			TCount = 1;	/*-- an empty packet still needs its start split --*/
+		}
+
+		*pTdIdx = (uint32_t) Idx;
 		memset(HcdSITD(HostID, *pTdIdx), 0, sizeof(HCD_SITD) );
 
 		HcdSITD(HostID, *pTdIdx)->inUse = 1;
@@ -722,7 +977,7 @@ static HCD_STATUS AllocSItd(uint8_t HostID,
 		HcdSITD(HostID, *pTdIdx)->PortNumber = HcdQHD(HostID, HeadIdx)->PortNumber;
 		HcdSITD(HostID, *pTdIdx)->Direction = HcdQHD(HostID, HeadIdx)->Direction;
 		/*-- Word 3 --*/
-		HcdSITD(HostID, *pTdIdx)->uFrameSMask = (1 << TCount) - 1;
+		HcdSITD(HostID, *pTdIdx)->uFrameSMask = ((1 << TCount) - 1) << ehci_bw[HostID].Resv[HeadIdx].Phase;
 		HcdSITD(HostID, *pTdIdx)->uFrameCMask = 0;
 		/*-- Word 4 --*/
 		HcdSITD(HostID, *pTdIdx)->Active = 1;
@@ -790,6 +1045,142 @@ static HCD_STATUS QueueSITDs(uint8_t HostID, uint8_t HeadIdx, uint8_t *dataBuff,
 	return HCD_STATUS_OK;
 }
 
+/*---------- ISO Stream Routines ----------*/
+static uint32_t IsoStreamFill(uint8_t HostID, uint8_t HeadIdx, uint8_t Slot)
+{
+	EHCI_ISO_STREAM_T *pStream = &ehci_iso_stream[HostID][HeadIdx];
+	uint32_t Len = pStream->Fill(pStream->PipeHandle, pStream->pRing + Slot * pStream->SlotSize,
+								 pStream->SlotSize, pStream->pArg);
+
+	if (Len == 0) {
+		pStream->Stats.Underruns++;
+	}
+	return MIN(Len, pStream->SlotSize);
+}
+
+static HCD_STATUS IsoStreamQueueSlot(uint8_t HostID, uint8_t HeadIdx, uint8_t Slot, uint32_t FrameIdx)
+{
+	EHCI_ISO_STREAM_T *pStream = &ehci_iso_stream[HostID][HeadIdx];
+	uint32_t Len = IsoStreamFill(HostID, HeadIdx, Slot);
+	uint32_t TdIdx;
+
+	ASSERT_STATUS_OK(AllocSItd(HostID, &TdIdx, HeadIdx, pStream->pRing + Slot * pStream->SlotSize, Len, 1) );
+	HcdSITD(HostID, TdIdx)->RingSlot = Slot;
+	InsertLinkPointer(&EHCI_FRAME_LIST(HostID)[FrameIdx], &HcdSITD(HostID, TdIdx)->Horizontal, SITD_TYPE);
+	return HCD_STATUS_OK;
+}
+
+/* Refill a retired stream siTD and queue it NumSlots frames after the frame it ran in, pSItd is already unlinked */
+static void IsoStreamRearm(uint8_t HostID, PHCD_SITD pSItd, uint32_t FrameIdx)
+{
+	uint8_t HeadIdx = pSItd->IhdIdx;
+	uint8_t Slot = pSItd->RingSlot;
+	EHCI_ISO_STREAM_T *pStream = &ehci_iso_stream[HostID][HeadIdx];
+	uint32_t CurFrame = (USB_REG(HostID)->FRINDEX_H >> 3) % FRAME_LIST_SIZE;
+	uint32_t Target = (FrameIdx + pStream->NumSlots) % FRAME_LIST_SIZE;
+	uint32_t Ahead = (Target + FRAME_LIST_SIZE - CurFrame) % FRAME_LIST_SIZE;
+
+	pStream->Stats.FramesSent++;
+	if (pSItd->MissedUframe || pSItd->TransactionError || pSItd->BufferError || pSItd->ERR) {
+		pStream->Stats.Errors++;
+	}
+	FreeSItd(HostID, pSItd);
+
+	/*-- The target frame must still be ahead of the controller, otherwise the ring has slipped --*/
+	if ((Ahead == 0) || (Ahead > pStream->NumSlots)) {
+		pStream->Stats.LateFrames++;
+		Target = (CurFrame + 2) % FRAME_LIST_SIZE;
+	}
+	if (IsoStreamQueueSlot(HostID, HeadIdx, Slot, Target) != HCD_STATUS_OK) {
+		pStream->Stats.Errors++;
+	}
+}
+
+HCD_STATUS HcdIsoStreamStart(uint32_t PipeHandle,
+							 uint8_t *pRing,
+							 uint16_t SlotSize,
+							 uint8_t NumSlots,
+							 HCD_ISO_FILL_CALLBACK Fill,
+							 void *pArg)
+{
+	uint8_t HostID, HeadIdx, Slot;
+	HCD_TRANSFER_TYPE XferType;
+	EHCI_ISO_STREAM_T *pStream;
+	uint32_t FrameIdx;
+	uint32_t primask;
+	HCD_STATUS status = HCD_STATUS_OK;
+
+	ASSERT_STATUS_OK(PipehandleParse(PipeHandle, &HostID, &XferType, &HeadIdx) );
+
+	if ((XferType != ISOCHRONOUS_TRANSFER) || (pRing == NULL) || (Fill == NULL) ||
+		(SlotSize == 0) || (SlotSize > HcdQHD(HostID, HeadIdx)->MaxPackageSize) ||
+		(NumSlots < 2) || (NumSlots > FRAME_LIST_SIZE / 2) || (NumSlots > HCD_MAX_SITD)) {
+		ASSERT_STATUS_OK_MESSAGE(HCD_STATUS_PARAMETER_INVALID, "ISO stream needs an ISO pipe, a fill callback and 2..FRAME_LIST_SIZE/2 slots");
+	}
+	if ((HcdQHD(HostID, HeadIdx)->EndpointSpeed == HIGH_SPEED) || HcdQHD(HostID, HeadIdx)->Direction) {
+		ASSERT_STATUS_OK_MESSAGE(HCD_STATUS_TRANSFER_TYPE_NOT_SUPPORTED, "Only full speed ISO OUT streams are supported");
+	}
+
+	pStream = &ehci_iso_stream[HostID][HeadIdx];
+	if (pStream->Running) {
+		ASSERT_STATUS_OK(HcdIsoStreamStop(PipeHandle) );
+	}
+	memset(pStream, 0, sizeof(EHCI_ISO_STREAM_T));
+	pStream->Fill = Fill;
+	pStream->pArg = pArg;
+	pStream->PipeHandle = PipeHandle;
+	pStream->pRing = pRing;
+	pStream->SlotSize = SlotSize;
+	pStream->NumSlots = NumSlots;
+
+	/* Queue the whole ring at once so the ISR never sees a partial ring */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	HcdQHD(HostID, HeadIdx)->status = (uint32_t) HCD_STATUS_TRANSFER_QUEUED;
+	FrameIdx = (USB_REG(HostID)->FRINDEX_H >> 3) + 2;
+	for (Slot = 0; Slot < NumSlots && status == HCD_STATUS_OK; Slot++) {
+		status = IsoStreamQueueSlot(HostID, HeadIdx, Slot, (FrameIdx + Slot) % FRAME_LIST_SIZE);
+	}
+	pStream->Running = (status == HCD_STATUS_OK) ? 1 : 0;
+	__set_PRIMASK(primask);
+
+	if (status != HCD_STATUS_OK) {
+		HcdIsoStreamStop(PipeHandle);
+	}
+	return status;
+}
+
+HCD_STATUS HcdIsoStreamStop(uint32_t PipeHandle)
+{
+	uint8_t HostID, HeadIdx;
+	HCD_TRANSFER_TYPE XferType;
+
+	ASSERT_STATUS_OK(PipehandleParse(PipeHandle, &HostID, &XferType, &HeadIdx) );
+
+	/*-- Cancel stops the re-arming and unlinks every siTD of the head --*/
+	ASSERT_STATUS_OK(HcdCancelTransfer(PipeHandle) );
+	HcdQHD(HostID, HeadIdx)->status = HCD_STATUS_OK;
+	return HCD_STATUS_OK;
+}
+
+HCD_STATUS HcdIsoStreamGetStats(uint32_t PipeHandle, HCD_ISO_STREAM_STATS *pStats)
+{
+	uint8_t HostID, HeadIdx;
+	HCD_TRANSFER_TYPE XferType;
+	uint32_t primask;
+
+	ASSERT_STATUS_OK(PipehandleParse(PipeHandle, &HostID, &XferType, &HeadIdx) );
+	if (pStats == NULL) {
+		ASSERT_STATUS_OK(HCD_STATUS_PARAMETER_INVALID);
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*pStats = ehci_iso_stream[HostID][HeadIdx].Stats;
+	__set_PRIMASK(primask);
+	return HCD_STATUS_OK;
+}
+
 static HCD_STATUS WaitForTransferComplete(uint8_t HostID, uint8_t EdIdx)/* TODO indentical to OHCI now */
 {
 
@@ -804,6 +1195,18 @@ static HCD_STATUS WaitForTransferComplete(uint8_t HostID, uint8_t EdIdx)/* TODO
 
 }
 
+/* Call the pending completion callback once the head has left the queued state */
+static void TransferDoneNotify(uint8_t HostID, uint8_t QhdIdx)
+{
+	HCD_TRANSFER_NOTIFY *pNotify = &ehci_notify[HostID][QhdIdx];
+	HCD_TRANSFER_CALLBACK Callback = pNotify->Callback;
+
+	if ((Callback != NULL) && (HcdQHD(HostID, QhdIdx)->status != HCD_STATUS_TRANSFER_QUEUED)) {
+		pNotify->Callback = NULL;	/* cleared first, the callback may queue the next transfer */
+		Callback(pNotify->PipeHandle, (HCD_STATUS) HcdQHD(HostID, QhdIdx)->status, pNotify->pArg);
+	}
+}
+
 static HCD_STATUS PipehandleParse(uint32_t Pipehandle, uint8_t *pHostID, HCD_TRANSFER_TYPE *XferType, uint8_t *pIdx)
 {
 	Pipe_Handle_T *pHandle = (Pipe_Handle_T *) (&Pipehandle);
@@ -962,7 +1365,7 @@ static void RemoveCompletedQTD(uint8_t HostID, PHCD_QHD pQhd)
 		{
 			pQhd->status = HCD_STATUS_TRANSFER_Stall;
 		}
-		FreeQtd(pQtd);
+		FreeQtd(HostID, pQtd);
 	}
 	pQhd->FirstQtd = TdLink;
 	if(is_data_remain)
@@ -975,9 +1378,10 @@ static void RemoveCompletedQTD(uint8_t HostID, PHCD_QHD pQhd)
 		pQhd->FirstQtd = Align32( (uint32_t) HcdQTD(HostID,pQtd) );
 		pQhd->Overlay.NextQtd = (uint32_t) HcdQTD(HostID,pQtd);
 	}	
+	TransferDoneNotify(HostID, (uint8_t) (pQhd - HcdQHD(HostID, 0)));
 }
 
-static void RemoveErrorQTD(PHCD_QHD pQhd)
+static void RemoveErrorQTD(uint8_t HostID, PHCD_QHD pQhd)
 {
 	PHCD_QTD pQtd;
 	uint32_t TdLink = pQhd->FirstQtd;
@@ -1001,10 +1405,11 @@ static void RemoveErrorQTD(PHCD_QHD pQhd)
 			TdLink = pQtd->NextQtd;
 			pQtd->Active = 0;
 			pQtd->IntOnComplete = 0;
-			FreeQtd(pQtd);
+			FreeQtd(HostID, pQtd);
 		}
 		pQhd->FirstQtd = LINK_TERMINATE;
 		pQhd->Overlay.Halted = 0;
+		TransferDoneNotify(HostID, (uint8_t) (pQhd - HcdQHD(HostID, 0)));
 	}
 }
 
@@ -1044,10 +1449,11 @@ static void PeriodScheduleIsr(uint8_t HostID)
 						( pItd->Transaction[6].IntOnComplete == 1) || ( pItd->Transaction[7].IntOnComplete == 1) ) {
 						/*-- request complete, signal on Iso Head --*/
 						HcdQHD(HostID, pItd->IhdIdx)->status = HCD_STATUS_OK;
+						TransferDoneNotify(HostID, pItd->IhdIdx);
 					}
 					/*-- remove executed ITD --*/
 					pNextPointer->Link = pItd->Horizontal.Link;
-					FreeHsItd(pItd);
+					FreeHsItd(HostID, pItd);
 					continue;	/*-- skip advance pNextPointer due to TD removal --*/
 				}
 			}
@@ -1055,14 +1461,21 @@ static void PeriodScheduleIsr(uint8_t HostID)
 				PHCD_SITD pSItd = (PHCD_SITD) Align32(pNextPointer->Link);
 
 				if (pSItd->Active == 0) {
+					if (ehci_iso_stream[HostID][pSItd->IhdIdx].Running) {
+						/*-- stream slot: refill and move it NumSlots frames ahead --*/
+						pNextPointer->Link = pSItd->Horizontal.Link;
+						IsoStreamRearm(HostID, pSItd, i);
+						continue;	/*-- skip advance pNextPointer due to TD removal --*/
+					}
 					if (pSItd->IntOnComplete) {
 						/*-- request complete, signal on Iso Head --*/
 						HcdQHD(HostID, pSItd->IhdIdx)->status = HCD_STATUS_OK;
+						TransferDoneNotify(HostID, pSItd->IhdIdx);
 					}
 
 					/*-- removed executed SITD --*/
 					pNextPointer->Link = pSItd->Horizontal.Link;
-					FreeSItd(pSItd);
+					FreeSItd(HostID, pSItd);
 					continue;	/*-- skip advance pNextPointer due to TD removal --*/
 				}
 			}
@@ -1091,7 +1504,7 @@ static void UsbErrorIsr(uint8_t HostID)
 	while ( isValidLink(pQhd->Horizontal.Link) &&
 			Align32(pQhd->Horizontal.Link) != (uint32_t) HcdAsyncHead(HostID) ) {
 		pQhd = (PHCD_QHD) Align32(pQhd->Horizontal.Link);
-		RemoveErrorQTD(pQhd);
+		RemoveErrorQTD(HostID, pQhd);
 	}
 }
 
@@ -1151,6 +1564,34 @@ static __INLINE HCD_STATUS EHciHostInit(uint8_t HostID)
 	/*---------- Host Data Structure Init ----------*/
 	//	memset(&ehci_data[HostID], 0, sizeof(EHCI_HOST_DATA_T) );
 
+	memset(&ehci_bw[HostID], 0, sizeof(EHCI_PERIODIC_BW_T));
+
+	/*-- Descriptor pools hold every descriptor not marked in use --*/
+	PoolInit(&ehci_pools[HostID].Qhd, ehci_pools[HostID].QhdFree, HCD_MAX_QHD);
+	for (idx = HCD_MAX_QHD; idx > 0; idx--) {
+		if (HcdQHD(HostID, idx - 1)->inUse == 0) {
+			PoolPut(&ehci_pools[HostID].Qhd, idx - 1);
+		}
+	}
+	PoolInit(&ehci_pools[HostID].Qtd, ehci_pools[HostID].QtdFree, HCD_MAX_QTD);
+	for (idx = HCD_MAX_QTD; idx > 0; idx--) {
+		if (HcdQTD(HostID, idx - 1)->inUse == 0) {
+			PoolPut(&ehci_pools[HostID].Qtd, idx - 1);
+		}
+	}
+	PoolInit(&ehci_pools[HostID].HsItd, ehci_pools[HostID].HsItdFree, HCD_MAX_HS_ITD);
+	for (idx = HCD_MAX_HS_ITD; idx > 0; idx--) {
+		if (HcdHsITD(HostID, idx - 1)->inUse == 0) {
+			PoolPut(&ehci_pools[HostID].HsItd, idx - 1);
+		}
+	}
+	PoolInit(&ehci_pools[HostID].SItd, ehci_pools[HostID].SItdFree, HCD_MAX_SITD);
+	for (idx = HCD_MAX_SITD; idx > 0; idx--) {
+		if (HcdSITD(HostID, idx - 1)->inUse == 0) {
+			PoolPut(&ehci_pools[HostID].SItd, idx - 1);
+		}
+	}
+
 	/*---------- USBINT ----------*/
 	USB_REG(HostID)->USBINTR_H &= ~EHC_USBINTR_ALL;	/* Disable All Interrupt */
 	USB_REG(HostID)->USBSTS_H  &= ~EHC_USBINTR_ALL;	/* Clear All Interrupt Status */
@@ -1242,6 +1683,24 @@ static void EnablePeriodSchedule(uint8_t HostID)
 	EnableSchedule(HostID, 1);
 }
 
+HCD_STATUS HcdGetPoolStats(uint8_t HostID, HCD_POOL_STATS *pStats)
+{
+	if ((HostID >= MAX_USB_CORE) || (pStats == NULL)) {
+		return HCD_STATUS_PARAMETER_INVALID;
+	}
+
+	pStats->QhdSize = ehci_pools[HostID].Qhd.Size;
+	pStats->QhdHighWater = ehci_pools[HostID].Qhd.HighWater;
+	pStats->TdSize = ehci_pools[HostID].Qtd.Size;
+	pStats->TdHighWater = ehci_pools[HostID].Qtd.HighWater;
+	pStats->IsoTdSize = ehci_pools[HostID].HsItd.Size;
+	pStats->IsoTdHighWater = ehci_pools[HostID].HsItd.HighWater;
+	pStats->SplitIsoTdSize = ehci_pools[HostID].SItd.Size;
+	pStats->SplitIsoTdHighWater = ehci_pools[HostID].SItd.HighWater;
+
+	return HCD_STATUS_OK;
+}
+
 void HcdSetStreamPacketSize(uint32_t PipeHandle, uint16_t packetsize)
 {
 	uint8_t HostID = 0, HeadIdx;
@@ -47,11 +47,24 @@
 /*=======================================================================*/
 /*  EHCI C O N F I G U R A T I O N                        */
 /*=======================================================================*/
+/* Descriptor pool sizes, each can be overridden from the project configuration (max 255) */
+#ifndef HCD_MAX_QHD
 #define HCD_MAX_QHD					HCD_MAX_ENDPOINT		/* USBD_USB_HC_EHCI */
+#endif
+#ifndef HCD_MAX_QTD
 //#define	HCD_MAX_QTD					(HCD_MAX_ENDPOINT+3)	/* USBD_USB_HC_EHCI */
 #define	HCD_MAX_QTD					8						/* USBD_USB_HC_EHCI */
+#endif
+#ifndef HCD_MAX_HS_ITD
 #define	HCD_MAX_HS_ITD				4						/* USBD_USB_HC_EHCI */
+#endif
+#ifndef HCD_MAX_SITD
 #define HCD_MAX_SITD				16						/* USBD_USB_HC_EHCI */
+#endif
+
+#if (HCD_MAX_QHD > 255) || (HCD_MAX_QTD > 255) || (HCD_MAX_HS_ITD > 255) || (HCD_MAX_SITD > 255)
+#error "EHCI descriptor pools are indexed with 8 bits"
+#endif
 
 #define FRAMELIST_SIZE_BITS         5			/* (0:1024) - (1:512) - (2:256) - (3:128) - (4:64) - (5:32) - (6:16) - (7:8) */
 #define FRAME_LIST_SIZE             (1024 >> FRAMELIST_SIZE_BITS)
@@ -173,6 +186,16 @@
 //#define LINK_TERMINATE                          0x01
 #define SPLIT_MAX_LEN_UFRAME                    188
 
+/* Periodic bandwidth budgets, in byte times (USB 2.0 5.7.4 and 5.11.3) */
+#define HS_UFRAME_PERIODIC_BUDGET               6000				/* 80% of the 7500 byte times of a microframe */
+#define HS_XACT_OVERHEAD                        55					/* tokens, handshake and inter-packet delays of a HS transaction */
+#define FS_FRAME_PERIODIC_BUDGET                1350				/* 90% of the 1500 byte times of a frame, shared by all TTs */
+#define FS_XACT_OVERHEAD                        14					/* tokens, handshake and inter-packet delays of a FS transaction */
+#define LS_BYTE_TIMES                           8					/* a low speed byte lasts 8 full speed byte times */
+#define SPLIT_START_SLOTS                       4					/* start split microframes 0..3, complete splits follow in +2..+4 */
+#define SPLIT_INT_SMASK                         0x01				/* start split relative to the slot */
+#define SPLIT_INT_CMASK                         0x1C				/* complete splits 2, 3 and 4 microframes after the start split */
+
 /*=======================================================================*/
 /*  E H C I		S T R U C T U R E S				*/
 /*=======================================================================*/
@@ -360,7 +383,8 @@ typedef struct st_EHCD_SITD {
 	/*-- HCD ARERA 4 bytes --*/
 	uint8_t inUse;
 	uint8_t IhdIdx;
-	uint8_t reserved2[2];
+	uint8_t RingSlot;	/* Frame slot of an ISO stream */
+	uint8_t reserved2;
 } ATTR_ALIGNED (32) HCD_SITD, *PHCD_SITD;
 
 typedef struct st_EHCI_HOST_DATA {
@@ -372,6 +396,53 @@ typedef struct st_EHCI_HOST_DATA {
 	HCD_SITD            siTDs[HCD_MAX_SITD];			/* Split Iso Transfer Descriptor */
 } EHCI_HOST_DATA_T;
 
+/* Free list of descriptor indexes, used as a stack so allocation and release are O(1) */
+typedef struct st_EHCI_POOL {
+	uint8_t *pFree;			/* Free descriptor indexes, [0..NumFree-1] are valid */
+	uint8_t NumFree;		/* Number of free descriptors */
+	uint8_t Size;			/* Number of descriptors in the pool */
+	uint8_t HighWater;		/* Largest number of descriptors in use at once */
+} EHCI_POOL_T;
+
+/* Descriptor pools of a host, not accessed by the controller so kept out of USB RAM */
+typedef struct st_EHCI_HOST_POOLS {
+	EHCI_POOL_T Qhd;
+	EHCI_POOL_T Qtd;
+	EHCI_POOL_T HsItd;
+	EHCI_POOL_T SItd;
+	uint8_t QhdFree[HCD_MAX_QHD];
+	uint8_t QtdFree[HCD_MAX_QTD];
+	uint8_t HsItdFree[HCD_MAX_HS_ITD];
+	uint8_t SItdFree[HCD_MAX_SITD];
+} EHCI_HOST_POOLS_T;
+
+/* Periodic bandwidth reserved by one interrupt or isochronous head */
+typedef struct st_EHCI_PERIODIC_RESV {
+	uint16_t HsCost;		/* HS byte times reserved in each microframe of HsMask */
+	uint16_t FsCost;		/* FS byte times reserved on the TT, split transactions only */
+	uint8_t HsMask;			/* Microframes holding HsCost, 0 if nothing reserved */
+	uint8_t Phase;			/* First scheduled microframe, start split slot for split transactions */
+} EHCI_PERIODIC_RESV_T;
+
+/* Periodic load of a host. Every periodic head is visited each frame, so only microframes inside a frame are planned */
+typedef struct st_EHCI_PERIODIC_BW {
+	uint16_t uFrameLoad[8];						/* HS byte times reserved in each microframe */
+	uint16_t SplitLoad[SPLIT_START_SLOTS];		/* FS byte times started from each start split slot */
+	EHCI_PERIODIC_RESV_T Resv[HCD_MAX_QHD];
+} EHCI_PERIODIC_BW_T;
+
+/* Continuous ISO OUT stream on an ISO head, its siTDs are re-armed from PeriodScheduleIsr */
+typedef struct st_EHCI_ISO_STREAM {
+	HCD_ISO_FILL_CALLBACK Fill;
+	void *pArg;
+	uint32_t PipeHandle;
+	uint8_t *pRing;					/* NumSlots buffers of SlotSize bytes */
+	uint16_t SlotSize;
+	uint8_t NumSlots;
+	volatile uint8_t Running;
+	HCD_ISO_STREAM_STATS Stats;
+} EHCI_ISO_STREAM_T;
+
 typedef enum {
 	ITD_TYPE = 0,
 	QHD_TYPE,
@@ -457,6 +528,13 @@ static INLINE bool        isValidLink(uint32_t link);
 
 static INLINE bool IsInterruptQhd (uint8_t HostID, uint8_t QhdIdx);
 
+/********************************* Descriptor Pools *********************************/
+static void PoolInit(EHCI_POOL_T *pPool, uint8_t *pFree, uint8_t Size);
+
+static int32_t PoolGet(EHCI_POOL_T *pPool);
+
+static void PoolPut(EHCI_POOL_T *pPool, uint8_t Idx);
+
 /********************************* Queue Head & Queue TD *********************************/
 static void FreeQhd(uint8_t HostID, uint8_t QhdIdx);
 
@@ -477,7 +555,7 @@ static HCD_STATUS InsertLinkPointer(NextLinkPointer *pList, NextLinkPointer *pNe
 
 static HCD_STATUS RemoveQueueHead(uint8_t HostID, uint8_t QhdIdx);
 
-static void FreeQtd(PHCD_QTD pQtd);
+static void FreeQtd(uint8_t HostID, PHCD_QTD pQtd);
 
 static HCD_STATUS AllocQTD (uint8_t HostID,
 							uint32_t *pTdIdx,
@@ -494,8 +572,13 @@ static HCD_STATUS QueueQTDs (uint8_t HostID,
 							 HCD_TRANSFER_DIR PIDCode,
 							 uint8_t DataToggle);
 
+/********************************* Periodic Bandwidth *********************************/
+static HCD_STATUS PeriodicReserve(uint8_t HostID, uint8_t HeadIdx, HCD_TRANSFER_TYPE XferType);
+
+static void PeriodicRelease(uint8_t HostID, uint8_t HeadIdx);
+
 /********************************* ISO Head & ISO TD & Split ISO *********************************/
-static void FreeHsItd(PHCD_HS_ITD pItd);
+static void FreeHsItd(uint8_t HostID, PHCD_HS_ITD pItd);
 
 static HCD_STATUS AllocHsItd(uint8_t HostID,
 							 uint32_t *pTdIdx,
@@ -507,7 +590,7 @@ static HCD_STATUS AllocHsItd(uint8_t HostID,
 
 static HCD_STATUS QueueITDs(uint8_t HostID, uint8_t IhdIdx, uint8_t *dataBuff, uint32_t xferLen);
 
-static void FreeSItd(PHCD_SITD pSItd);
+static void FreeSItd(uint8_t HostID, PHCD_SITD pSItd);
 
 static HCD_STATUS AllocSItd(uint8_t HostID,
 							uint32_t *TdIdx,
@@ -518,9 +601,17 @@ static HCD_STATUS AllocSItd(uint8_t HostID,
 
 static HCD_STATUS QueueSITDs(uint8_t HostID, uint8_t HeadIdx, uint8_t *dataBuff, uint32_t xferLen);
 
+static uint32_t IsoStreamFill(uint8_t HostID, uint8_t HeadIdx, uint8_t Slot);
+
+static HCD_STATUS IsoStreamQueueSlot(uint8_t HostID, uint8_t HeadIdx, uint8_t Slot, uint32_t FrameIdx);
+
+static void IsoStreamRearm(uint8_t HostID, PHCD_SITD pSItd, uint32_t FrameIdx);
+
 /********************************* Transfer Routines *********************************/
 static HCD_STATUS WaitForTransferComplete(uint8_t HostID, uint8_t EpIdx);
 
+static void TransferDoneNotify(uint8_t HostID, uint8_t QhdIdx);
+
 static HCD_STATUS PipehandleParse(uint32_t Pipehandle, uint8_t *pHostID, HCD_TRANSFER_TYPE *XferType, uint8_t *pIdx);
 
 static void PipehandleCreate(uint32_t *pPipeHandle, uint8_t HostID, HCD_TRANSFER_TYPE XferType, uint8_t idx);
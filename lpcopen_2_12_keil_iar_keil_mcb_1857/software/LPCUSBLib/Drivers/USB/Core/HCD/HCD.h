@@ -148,9 +148,49 @@ typedef enum {
 	HCD_STATUS_TRANSFER_TYPE_NOT_SUPPORTED,	/**< USB transfer set up status: transfer is not supported */
 
 	HCD_STATUS_PIPEHANDLE_INVALID,			/**< USB transfer set up status: pipe handle information is not valid */
-	HCD_STATUS_PARAMETER_INVALID			/**< USB transfer set up status: wrong supply parameters */
+	HCD_STATUS_PARAMETER_INVALID,			/**< USB transfer set up status: wrong supply parameters */
+	HCD_STATUS_NOT_ENOUGH_BANDWIDTH			/**< USB transfer set up status: periodic schedule cannot fit the pipe (EHCI) */
 } HCD_STATUS;
 
+/** Completion callback of \ref HcdDataTransferAsync(), called from the host controller interrupt
+ */
+typedef void (*HCD_TRANSFER_CALLBACK)(uint32_t PipeHandle, HCD_STATUS Status, void *pArg);
+
+/** Pending completion callback of a pipe, kept by the host controller driver
+ */
+typedef struct {
+	HCD_TRANSFER_CALLBACK Callback;	/**< Called once when the transfer leaves the queued state */
+	void *pArg;						/**< User argument passed back to Callback */
+	uint32_t PipeHandle;			/**< Pipe handle passed back to Callback */
+} HCD_TRANSFER_NOTIFY;
+
+/** Fill callback of an isochronous OUT stream, called from the host controller interrupt as each frame slot retires.
+ *  Writes up to MaxLength bytes for the next frame into pBuffer and returns the byte count, 0 sends an empty packet
+ */
+typedef uint32_t (*HCD_ISO_FILL_CALLBACK)(uint32_t PipeHandle, uint8_t *pBuffer, uint32_t MaxLength, void *pArg);
+
+/** Counters of an isochronous stream started by \ref HcdIsoStreamStart()
+ */
+typedef struct {
+	uint32_t FramesSent;			/**< Frame slots retired by the controller */
+	uint32_t Underruns;				/**< Slots the fill callback left empty */
+	uint32_t LateFrames;			/**< Slots re-armed after their frame had passed, each one is a gap on the bus */
+	uint32_t Errors;				/**< Slots retired with a transaction, buffer or missed microframe error */
+} HCD_ISO_STREAM_STATS;
+
+/** Descriptor pool sizes and the peak number of descriptors used since init
+ */
+typedef struct {
+	uint8_t QhdSize;				/**< Queue heads / endpoint descriptors in the pool */
+	uint8_t QhdHighWater;			/**< Most queue heads used at once */
+	uint8_t TdSize;					/**< Transfer descriptors (qTD / GTD) in the pool */
+	uint8_t TdHighWater;			/**< Most transfer descriptors used at once */
+	uint8_t IsoTdSize;				/**< Isochronous transfer descriptors in the pool */
+	uint8_t IsoTdHighWater;			/**< Most isochronous transfer descriptors used at once */
+	uint8_t SplitIsoTdSize;			/**< Split isochronous transfer descriptors in the pool (EHCI) */
+	uint8_t SplitIsoTdHighWater;	/**< Most split isochronous transfer descriptors used at once */
+} HCD_POOL_STATS;
+
 /**
  * @brief  Initiate host driver
  *
@@ -297,6 +337,26 @@ HCD_STATUS HcdDataTransfer(uint32_t PipeHandle,
 						   uint32_t const length,
 						   uint16_t *const pActualTransferred);
 
+/**
+ * @brief  Queue a non-control transfer and return without waiting for it
+ *
+ * @param  PipeHandle	: encoded pipe handle information
+ * @param  buffer		: pointer to transferred data buffer
+ * @param  length		: size of this transfer
+ * @param  pActualTransferred: return actual transfer bytes through pointer
+ * @param  Callback		: called from the host interrupt when the transfer completes or fails, may be NULL
+ * @param  pArg			: user argument passed to Callback
+ * @return \ref HCD_STATUS code
+ * @note   Callback is not called for a transfer removed by \ref HcdCancelTransfer().
+ *         \ref HcdGetPipeStatus() can still be polled instead of, or as well as, the callback.
+ */
+HCD_STATUS HcdDataTransferAsync(uint32_t PipeHandle,
+								uint8_t *const buffer,
+								uint32_t const length,
+								uint16_t *const pActualTransferred,
+								HCD_TRANSFER_CALLBACK Callback,
+								void *pArg);
+
 /**
  * @brief  Get current pipe status
  *
@@ -314,6 +374,51 @@ HCD_STATUS HcdGetPipeStatus(uint32_t PipeHandle);
  */
 void HcdSetStreamPacketSize(uint32_t PipeHandle, uint16_t packetsize);
 
+/**
+ * @brief  Get descriptor pool usage, used to size the HCD_MAX_* pools
+ *
+ * @param  HostID		: USB port number
+ * @param  pStats		: pointer to return pool sizes and high-water marks
+ * @return \ref HCD_STATUS code
+ */
+HCD_STATUS HcdGetPoolStats(uint8_t HostID, HCD_POOL_STATS *pStats);
+
+/**
+ * @brief  Start a continuous isochronous OUT stream on a ring of frame slots
+ *
+ * @param  PipeHandle	: encoded pipe handle information of an isochronous OUT pipe
+ * @param  pRing		: NumSlots * SlotSize bytes of buffer owned by the stream until it is stopped
+ * @param  SlotSize		: most bytes sent in one frame, up to the pipe max packet size
+ * @param  NumSlots		: frames queued ahead of the controller
+ * @param  Fill			: called for every slot at start and then each time a slot retires
+ * @param  pArg			: user argument passed to Fill
+ * @return \ref HCD_STATUS code
+ * @note   Only full speed streams behind the EHCI transaction translator are supported.
+ */
+HCD_STATUS HcdIsoStreamStart(uint32_t PipeHandle,
+							 uint8_t *pRing,
+							 uint16_t SlotSize,
+							 uint8_t NumSlots,
+							 HCD_ISO_FILL_CALLBACK Fill,
+							 void *pArg);
+
+/**
+ * @brief  Stop an isochronous stream and release its frame slots
+ *
+ * @param  PipeHandle	: encoded pipe handle information
+ * @return \ref HCD_STATUS code
+ */
+HCD_STATUS HcdIsoStreamStop(uint32_t PipeHandle);
+
+/**
+ * @brief  Get the counters of an isochronous stream
+ *
+ * @param  PipeHandle	: encoded pipe handle information
+ * @param  pStats		: pointer to return the stream counters
+ * @return \ref HCD_STATUS code
+ */
+HCD_STATUS HcdIsoStreamGetStats(uint32_t PipeHandle, HCD_ISO_STREAM_STATS *pStats);
+
 #ifdef LPCUSBlib_DEBUG
 	#define hcd_printf          printf
 void assert_status_ok_message(HCD_STATUS status,
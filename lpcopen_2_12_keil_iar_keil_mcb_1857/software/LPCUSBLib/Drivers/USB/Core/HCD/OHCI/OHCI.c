@@ -45,6 +45,7 @@
 
 PRAGMA_ALIGN_256
 OHCI_HOST_DATA_T ohci_data[MAX_USB_CORE] __BSS(USBRAM_SECTION) ATTR_ALIGNED(256);
+static HCD_TRANSFER_NOTIFY ohci_notify[MAX_ED];
 
 /*=======================================================================*/
 /*  G L O B A L   S Y M B O L   D E C L A R A T I O N S                  */
@@ -197,6 +198,7 @@ HCD_STATUS HcdCancelTransfer(uint32_t PipeHandle)
 
 	ASSERT_STATUS_OK(PipehandleParse(PipeHandle, &HostID, &EdIdx) );
 
+	ohci_notify[EdIdx].Callback = NULL;	/* cancelled transfers are not reported */
 	HcdED(EdIdx)->hcED.Skip = 1;
 
 	/* Clear SOF and wait for the next frame */
@@ -393,6 +395,34 @@ HCD_STATUS HcdDataTransfer(uint32_t PipeHandle,
 	return HCD_STATUS_OK;
 }
 
+HCD_STATUS HcdDataTransferAsync(uint32_t PipeHandle,
+								uint8_t *const buffer,
+								uint32_t const length,
+								uint16_t *const pActualTransferred,
+								HCD_TRANSFER_CALLBACK Callback,
+								void *pArg)
+{
+	uint8_t HostID, EdIdx;
+	HCD_STATUS status;
+	uint32_t primask;
+
+	ASSERT_STATUS_OK(PipehandleParse(PipeHandle, &HostID, &EdIdx) );
+
+	/* Hold off the done queue ISR until both the callback and the queued status are in place */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	ohci_notify[EdIdx].Callback = Callback;
+	ohci_notify[EdIdx].pArg = pArg;
+	ohci_notify[EdIdx].PipeHandle = PipeHandle;
+	status = HcdDataTransfer(PipeHandle, buffer, length, pActualTransferred);
+	if (status != HCD_STATUS_OK) {
+		ohci_notify[EdIdx].Callback = NULL;
+	}
+	__set_PRIMASK(primask);
+
+	return status;
+}
+
 HCD_STATUS HcdGetPipeStatus(uint32_t PipeHandle)
 {
 	uint8_t HostID, EdIdx;
@@ -480,6 +510,19 @@ static void ProcessDoneQueue(uint8_t HostID, uint32_t donehead)
 		}
 
 		/* Post Semaphore to signal TDs are transfer */
+		TransferDoneNotify(EdIdx);
+	}
+}
+
+/* Call the pending completion callback once the ED has left the queued state */
+static void TransferDoneNotify(uint8_t EdIdx)
+{
+	HCD_TRANSFER_NOTIFY *pNotify = &ohci_notify[EdIdx];
+	HCD_TRANSFER_CALLBACK Callback = pNotify->Callback;
+
+	if ((Callback != NULL) && (HcdED(EdIdx)->status != HCD_STATUS_TRANSFER_QUEUED)) {
+		pNotify->Callback = NULL;	/* cleared first, the callback may queue the next transfer */
+		Callback(pNotify->PipeHandle, (HCD_STATUS) HcdED(EdIdx)->status, pNotify->pArg);
 	}
 }
 
@@ -1066,4 +1109,33 @@ void HcdSetStreamPacketSize(uint32_t PipeHandle, uint16_t packetsize)
 {
 }
 
+HCD_STATUS HcdGetPoolStats(uint8_t HostID, HCD_POOL_STATS *pStats)
+{
+	if (pStats == NULL) {
+		return HCD_STATUS_PARAMETER_INVALID;
+	}
+	memset(pStats, 0, sizeof(HCD_POOL_STATS));	/* OHCI descriptors are not pooled */
+	return HCD_STATUS_OK;
+}
+
+HCD_STATUS HcdIsoStreamStart(uint32_t PipeHandle,
+							 uint8_t *pRing,
+							 uint16_t SlotSize,
+							 uint8_t NumSlots,
+							 HCD_ISO_FILL_CALLBACK Fill,
+							 void *pArg)
+{
+	return HCD_STATUS_TRANSFER_TYPE_NOT_SUPPORTED;
+}
+
+HCD_STATUS HcdIsoStreamStop(uint32_t PipeHandle)
+{
+	return HCD_STATUS_TRANSFER_TYPE_NOT_SUPPORTED;
+}
+
+HCD_STATUS HcdIsoStreamGetStats(uint32_t PipeHandle, HCD_ISO_STREAM_STATS *pStats)
+{
+	return HCD_STATUS_TRANSFER_TYPE_NOT_SUPPORTED;
+}
+
 #endif
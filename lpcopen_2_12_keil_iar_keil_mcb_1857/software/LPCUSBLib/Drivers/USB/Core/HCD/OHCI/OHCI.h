@@ -375,6 +375,8 @@ static HCD_STATUS QueueGTDs (uint32_t EdIdx, uint8_t *dataBuff, uint32_t xferLen
 
 static HCD_STATUS WaitForTransferComplete(uint8_t EdIdx);
 
+static void TransferDoneNotify(uint8_t EdIdx);
+
 #endif /*defined(__LPC_OHCI__)*/
 
 /** @} */
@@ -79,27 +79,104 @@ typedef struct MemBlockInfo_t {
 #define  HEADER_POINTER(x)          ((uint8_t *)x - sizeof(sMemBlockInfo))
 #define  NEXT_BLOCK(x)            	((PMemBlockInfo) ( ((x)->next==0) ? 0 : ((uint32_t)head +(x)->next) ))
 #define  LINK_TO_THIS_BLOCK(x)      (((uint32_t)(x))-((uint32_t)head))
+#if TEST_NEW_ALLOC
+#define  BLOCK_IS_FREE(x)           ((x)->type != MEM_USED)
+#else
+#define  BLOCK_IS_FREE(x)           ((x)->isFree == 1)
+#endif
+
+/* Size-class slabs sit at the front of USB_Mem_Buffer, each object aligned to SLAB_ALIGN.
+ * A free object holds the link to the next free object of its class. */
+#define  SLAB_ALIGN                 (32)
+#define  SLAB_ROUND(x)              (((x) + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1))
+
+typedef struct MemSlabObj_t {
+	struct MemSlabObj_t *next;
+} sMemSlabObj;
+
+typedef struct {
+	uint8_t *base;			// first object of this class
+	uint8_t *end;			// one past the last object of this class
+	sMemSlabObj *freeList;
+	USB_MEM_SLAB_STATS stats;
+} sMemSlab;
+
+static const uint16_t slab_obj_size[USB_MEM_SLAB_CLASSES] = {64, 512};
+static const uint16_t slab_obj_count[USB_MEM_SLAB_CLASSES] = {USB_MEM_SLAB_64_COUNT, USB_MEM_SLAB_512_COUNT};
+
+static sMemSlab mem_slab[USB_MEM_SLAB_CLASSES];
+static PMemBlockInfo mem_heap;		// head of the first-fit heap behind the slabs
+static uint32_t mem_heap_size;
+static uint32_t mem_heap_failures;
 
 PRAGMA_ALIGN_4
 static uint8_t USB_Mem_Buffer[USBRAM_BUFFER_SIZE] ATTR_ALIGNED(4) __BSS(USBRAM_SECTION);
 
 void USB_Memory_Init(uint32_t Memory_Pool_Size)
 {
-	PMemBlockInfo head = (PMemBlockInfo) USB_Mem_Buffer;
+	PMemBlockInfo head;
+	uint8_t *limit = USB_Mem_Buffer + Memory_Pool_Size;
+	uint8_t *p = (uint8_t *) SLAB_ROUND((uint32_t) USB_Mem_Buffer);
+	uint32_t i, n;
+
+	for (i = 0; i < USB_MEM_SLAB_CLASSES; i++) {
+		sMemSlab *slab = &mem_slab[i];
+
+		slab->base = p;
+		slab->freeList = NULL;
+		slab->stats.ObjSize = slab_obj_size[i];
+		slab->stats.Total = slab->stats.InUse = slab->stats.HighWater = 0;
+		slab->stats.Misses = 0;
+		/* Always leave room for one minimal heap block behind the slabs */
+		for (n = 0; n < slab_obj_count[i] &&
+			 (uint32_t) (limit - p) >= slab_obj_size[i] + HEADER_SIZE + ALIGN_FOUR_BYTES; n++) {
+			((sMemSlabObj *) p)->next = slab->freeList;
+			slab->freeList = (sMemSlabObj *) p;
+			slab->stats.Total++;
+			p += slab_obj_size[i];
+		}
+		slab->end = p;
+	}
 
+	head = mem_heap = (PMemBlockInfo) p;
 	head->next = 0;
-	head->size = (Memory_Pool_Size & 0xfffffffc) - HEADER_SIZE ;// align memory size
+	head->size = (((uint32_t) (limit - p)) & 0xfffffffc) - HEADER_SIZE ;// align memory size
 #if TEST_NEW_ALLOC
 	head->type = MEM_FREE;
 #else
 	head->isFree = 1;
 #endif
+	mem_heap_size = head->size;
+	mem_heap_failures = 0;
 }
 
 uint8_t* USB_Memory_Alloc(uint32_t size, uint32_t num_aligned_bytes)
 {
 	PMemBlockInfo freeBlock=NULL, newBlock, blk_ptr = NULL;
-	PMemBlockInfo head = (PMemBlockInfo) USB_Mem_Buffer;
+	PMemBlockInfo head = mem_heap;
+	uint32_t i;
+
+	/* Smallest fitting size class first, O(1) pop from its free list */
+	if ((size > 0) && ((num_aligned_bytes == 0) || ((SLAB_ALIGN % num_aligned_bytes) == 0))) {
+		for (i = 0; i < USB_MEM_SLAB_CLASSES; i++) {
+			sMemSlab *slab = &mem_slab[i];
+
+			if (size <= slab->stats.ObjSize) {
+				if (slab->freeList != NULL) {
+					sMemSlabObj *obj = slab->freeList;
+					slab->freeList = obj->next;
+					if (++slab->stats.InUse > slab->stats.HighWater) {
+						slab->stats.HighWater = slab->stats.InUse;
+					}
+					return (uint8_t *) obj;
+				}
+				if (slab->stats.Total > 0) {
+					slab->stats.Misses++;
+					break;
+				}
+			}
+		}
+	}
 
 #if TEST_NEW_ALLOC
 	for (blk_ptr = head; blk_ptr != NULL; blk_ptr = NEXT_BLOCK(blk_ptr)) // 1st-fit technique
@@ -162,6 +239,7 @@ uint8_t* USB_Memory_Alloc(uint32_t size, uint32_t num_aligned_bytes)
 	}
 
 	if (blk_ptr == NULL) {
+		mem_heap_failures++;
 		return ((uint8_t *) NULL);
 	}
 
@@ -183,6 +261,7 @@ uint8_t* USB_Memory_Alloc(uint32_t size, uint32_t num_aligned_bytes)
 	}
 
 	if (blk_ptr == NULL) {
+		mem_heap_failures++;
 		return ((uint8_t *) NULL);
 	}
 
@@ -213,14 +292,27 @@ uint8_t* USB_Memory_Alloc(uint32_t size, uint32_t num_aligned_bytes)
 void USB_Memory_Free(uint8_t *ptr)
 {
 	PMemBlockInfo prev;
-	PMemBlockInfo head = (PMemBlockInfo) USB_Mem_Buffer;
+	PMemBlockInfo head = mem_heap;
 	PMemBlockInfo blk_ptr;
+	uint32_t i;
 
 	if (ptr == NULL)
 	{
 		return;
 	}
 
+	/* Slab objects go back on their class free list */
+	for (i = 0; i < USB_MEM_SLAB_CLASSES; i++) {
+		sMemSlab *slab = &mem_slab[i];
+
+		if ((ptr >= slab->base) && (ptr < slab->end)) {
+			((sMemSlabObj *) ptr)->next = slab->freeList;
+			slab->freeList = (sMemSlabObj *) ptr;
+			slab->stats.InUse--;
+			return;
+		}
+	}
+
 	blk_ptr = (PMemBlockInfo) HEADER_POINTER(ptr);
 	
 #if TEST_NEW_ALLOC
@@ -283,4 +375,37 @@ void USB_Memory_Free(uint8_t *ptr)
 	return;
 }
 
+void USB_Memory_GetStats(USB_MEM_STATS *pStats)
+{
+	PMemBlockInfo head = mem_heap;
+	PMemBlockInfo blk_ptr;
+	uint32_t i;
+
+	for (i = 0; i < USB_MEM_SLAB_CLASSES; i++) {
+		pStats->Slab[i] = mem_slab[i].stats;
+	}
+
+	pStats->HeapSize = mem_heap_size;
+	pStats->HeapUsed = pStats->HeapFree = pStats->HeapLargestFree = 0;
+	pStats->HeapBlocks = pStats->HeapFreeBlocks = 0;
+	pStats->HeapFailures = mem_heap_failures;
+
+	for (blk_ptr = head; blk_ptr != NULL; blk_ptr = NEXT_BLOCK(blk_ptr)) {
+		pStats->HeapBlocks++;
+		if (BLOCK_IS_FREE(blk_ptr)) {
+			pStats->HeapFreeBlocks++;
+			pStats->HeapFree += blk_ptr->size;
+			if (blk_ptr->size > pStats->HeapLargestFree) {
+				pStats->HeapLargestFree = blk_ptr->size;
+			}
+		}
+		else {
+			pStats->HeapUsed += blk_ptr->size;
+		}
+	}
+
+	pStats->Fragmentation = (pStats->HeapFree == 0) ? 0 :
+							(uint8_t) (100 - (pStats->HeapLargestFree * 100) / pStats->HeapFree);
+}
+
 #endif
@@ -36,9 +36,43 @@
 #include "lpc_types.h"
 #include "../../../Common/Common.h"
 
+/* Public Interface - May be used in end-application: */
+/* Macros: */
+#ifndef USB_MEM_SLAB_64_COUNT
+#define USB_MEM_SLAB_64_COUNT		4
+#endif
+#ifndef USB_MEM_SLAB_512_COUNT
+#define USB_MEM_SLAB_512_COUNT		4
+#endif
+#define USB_MEM_SLAB_CLASSES		2		/* 64 and 512 byte size classes */
+
+/* Type Defines: */
+/** Usage of one size-class slab */
+typedef struct {
+	uint16_t ObjSize;		/* Object size of this class in bytes */
+	uint16_t Total;			/* Objects carved for this class */
+	uint16_t InUse;			/* Objects currently allocated */
+	uint16_t HighWater;		/* Largest InUse seen since init */
+	uint32_t Misses;		/* Requests of this class sent to the heap because the slab was empty */
+} USB_MEM_SLAB_STATS;
+
+/** Usage and fragmentation of the USB memory pool */
+typedef struct {
+	USB_MEM_SLAB_STATS Slab[USB_MEM_SLAB_CLASSES];
+	uint32_t HeapSize;		/* Bytes managed by the first-fit heap */
+	uint32_t HeapUsed;		/* Bytes in allocated heap blocks */
+	uint32_t HeapFree;		/* Bytes in free heap blocks */
+	uint32_t HeapLargestFree;	/* Largest single free heap block */
+	uint16_t HeapBlocks;	/* Heap blocks, free and used */
+	uint16_t HeapFreeBlocks;	/* Free heap blocks */
+	uint32_t HeapFailures;	/* Allocations that found no fitting block */
+	uint8_t  Fragmentation;	/* Percentage of free heap not in the largest free block */
+} USB_MEM_STATS;
+
 /* Function Prototypes: */
 void USB_Memory_Init(uint32_t Memory_Pool_Size);
 uint8_t* USB_Memory_Alloc(uint32_t size, uint32_t num_aligned_bytes);
 void USB_Memory_Free(uint8_t *ptr);
+void USB_Memory_GetStats(USB_MEM_STATS *pStats);
 
 #endif /* __USBMEMORY_H__ */
@@ -49,8 +49,19 @@ volatile uint8_t     USB_HostState[MAX_USB_CORE];
 volatile uint8_t     USB_DeviceState[MAX_USB_CORE];
 #endif
 
+#if defined(USB_EVENT_DRIVEN_TASK)
+volatile bool        USB_TaskPending[MAX_USB_CORE];
+#endif
+
 void USB_USBTask(uint8_t corenum, uint8_t mode)
 {
+	#if defined(USB_EVENT_DRIVEN_TASK)
+	if (!(USB_TaskPending[corenum]))
+	  return;
+
+	USB_TaskPending[corenum] = false;
+	#endif
+
 	#if defined(USB_HOST_ONLY)
  		USB_HostTask(corenum);
 	#elif defined(USB_DEVICE_ONLY)
@@ -90,6 +101,29 @@ static void USB_HostTask(uint8_t corenum)
 	Pipe_SelectPipe(corenum,PIPE_CONTROLPIPE);
 	USB_Host_ProcessNextHostState(corenum);
 	Pipe_SelectPipe(corenum,PrevPipe);
+
+	#if defined(USB_EVENT_DRIVEN_TASK)
+	/* Enumeration advances one step per pass, keep running until it settles */
+	if ((USB_HostState[corenum] != HOST_STATE_Unattached) && (USB_HostState[corenum] < HOST_STATE_Addressed))
+	  USB_TaskPending[corenum] = true;
+	#endif
 }
 #endif
 
+#if defined(USB_EVENT_DRIVEN_TASK)
+void USB_SignalTask(uint8_t corenum)
+{
+	USB_TaskPending[corenum] = true;
+	EVENT_USB_TaskPending(corenum);
+}
+
+void USB_WaitForTask(uint8_t corenum)
+{
+	__disable_irq();
+
+	if (!(USB_TaskPending[corenum]))
+	  __WFI();
+
+	__enable_irq();
+}
+#endif
@@ -145,6 +145,17 @@
 				#endif
 			#endif
 
+			#if defined(USB_EVENT_DRIVEN_TASK) || defined(__DOXYGEN__)
+				/** Set from the USB interrupt when @ref USB_USBTask() has work to do on the given core, and cleared
+				 *  by @ref USB_USBTask() as it starts on that work.
+				 *
+				 *  @note This global is only present if the \c USB_EVENT_DRIVEN_TASK token is supplied to the compiler.
+				 *
+				 *  @ingroup Group_USBManagement
+				 */
+				extern volatile bool USB_TaskPending[MAX_USB_CORE];
+			#endif
+
 		/* Function Prototypes: */
 			/** This is the main USB management task. The USB driver requires this task to be executed
 			 *  continuously when the USB system is active (device attached in host mode, or attached to a host
@@ -164,12 +175,38 @@
 			 *  If in device mode (only), the control endpoint can instead be managed via interrupts entirely by the library
 			 *  by defining the INTERRUPT_CONTROL_ENDPOINT token and passing it to the compiler via the -D switch.
 			 *
+			 *  Defining the USB_EVENT_DRIVEN_TASK token instead makes the task event driven: the USB interrupt marks the
+			 *  core as having pending work and the task returns at once while nothing has changed. The main loop can then
+			 *  sleep in @ref USB_WaitForTask(), or an RTOS task can block until @ref EVENT_USB_TaskPending() wakes it.
+			 *  While host enumeration is in progress the task keeps itself pending so the state machine runs to completion.
+			 *
 			 *  @see @ref Group_Events for more information on the USB events.
 			 *
 			 *  @ingroup Group_USBManagement
 			 */
 			void USB_USBTask(uint8_t corenum, uint8_t mode);
 
+			#if defined(USB_EVENT_DRIVEN_TASK) || defined(__DOXYGEN__)
+			/** Marks the given core as having pending work for @ref USB_USBTask() and fires @ref EVENT_USB_TaskPending().
+			 *  The library calls this from the USB interrupt; an application may call it to force a task pass.
+			 *
+			 *  @param corenum : ID Number of USB Core to be processed.
+			 *
+			 *  @ingroup Group_USBManagement
+			 */
+			void USB_SignalTask(uint8_t corenum);
+
+			/** Sleeps the CPU with WFI until an interrupt arrives, unless work is already pending on the given core. The
+			 *  check and the sleep are made with interrupts masked, so a USB interrupt between them cannot be lost. This
+			 *  returns after any interrupt, so other main loop work is still serviced.
+			 *
+			 *  @param corenum : ID Number of USB Core to be processed.
+			 *
+			 *  @ingroup Group_USBManagement
+			 */
+			void USB_WaitForTask(uint8_t corenum);
+			#endif
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Function Prototypes: */
@@ -111,6 +111,11 @@
  *   <td bgcolor="#00EE00">Yes</td>
  *  </tr>
  *  <tr>
+ *   <td>NCM</td>
+ *   <td bgcolor="#00EE00">Yes</td>
+ *   <td bgcolor="#EE0000">No</td>
+ *  </tr>
+ *  <tr>
  *   <td>Printer</td>
  *   <td bgcolor="#EE0000">No</td>
 *    <td bgcolor="#00EE00">Yes</td>
@@ -387,6 +392,7 @@
 		#include "Class/HIDClass.h"
 		#include "Class/MassStorageClass.h"
 		#include "Class/MIDIClass.h"
+		#include "Class/NCMClass.h"
 		#include "Class/PrinterClass.h"
 		#include "Class/RNDISClass.h"
 		#include "Class/StillImageClass.h"
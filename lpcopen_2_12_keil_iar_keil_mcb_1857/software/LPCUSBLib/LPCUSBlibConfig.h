@@ -53,12 +53,28 @@
  */
 #define USBRAM_BUFFER_SIZE  (4*1024)
 
+/** Number of 64 byte and 512 byte size-class slab objects carved from the front of the
+ *  USBRAM_BUFFER_SIZE area. Requests that fit a class are served in O(1) from its slab,
+ *  anything else falls back to the first-fit heap in the remaining space.
+ */
+#define USB_MEM_SLAB_64_COUNT		4
+#define USB_MEM_SLAB_512_COUNT		4
+
 /** This option effects only on high speed parts that need to test full speed activities */
 #define USB_FORCED_FULLSPEED		0
 
 /** Define USE_USB_ROM_STACK = 1 to use MCU's internal ROM stack, 0 if otherwise */
 #define USE_USB_ROM_STACK			0
 
+/** ROM stack classes the application uses, on LPC18xx/43xx. The USB RAM work buffer of a
+ *  ROM class driver is only reserved when its class is set to 1 here. The buffer sizes
+ *  can be overridden by defining ROMDRIVER_MEM_SIZE, ROMDRIVER_MSC_MEM_SIZE,
+ *  ROMDRIVER_CDC_MEM_SIZE and ROMDRIVER_HID_MEM_SIZE before this point.
+ */
+#define USB_ROM_MSC_CLASS			1
+#define USB_ROM_CDC_CLASS			1
+#define USB_ROM_HID_CLASS			1
+
 #endif /* NXPUSBLIB_CONFIG_H_ */
 
 /**
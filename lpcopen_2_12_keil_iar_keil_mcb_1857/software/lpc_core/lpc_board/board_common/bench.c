@@ -0,0 +1,319 @@
+/*
+ * @brief    On-target benchmark harness
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "board.h"
+#include "profile.h"
+#include "bench.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+static BENCH_FORMAT_T benchFormat;
+static BENCH_PUTS_T benchPuts;
+
+/* Cost of reading the time base twice, taken off every sample */
+static uint32_t benchOverhead;
+
+/* No JSON result printed yet in the open report */
+static bool benchFirst;
+
+static uint32_t benchSamples[BENCH_MAX_SAMPLES];
+static char benchLine[192];
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Default report output */
+static void benchDebugStr(const char *str)
+{
+	DEBUGSTR((char *) str);
+}
+
+/* Prints the line buffer */
+static void benchPutLine(void)
+{
+	if (benchPuts) {
+		benchPuts(benchLine);
+	}
+	else {
+		benchDebugStr(benchLine);
+	}
+}
+
+/* Integer square root */
+static uint32_t benchSqrt(uint64_t val)
+{
+	uint64_t res = 0, bit = (uint64_t) 1 << 62;
+
+	while (bit > val) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (val >= res + bit) {
+			val -= res + bit;
+			res = (res >> 1) + bit;
+		}
+		else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return (uint32_t) res;
+}
+
+/* Sample at a percentile of a sorted sample array */
+static uint32_t benchPercentile(const uint32_t *samples, uint32_t count, uint32_t pct)
+{
+	uint32_t idx = (count * pct) / 100;
+
+	return samples[(idx < count) ? idx : (count - 1)];
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start the time base and set the report format and output */
+void Bench_Init(BENCH_FORMAT_T format, BENCH_PUTS_T puts)
+{
+	uint32_t i, t;
+
+	benchFormat = format;
+	benchPuts = puts;
+	Profile_Init();
+
+	benchOverhead = 0xFFFFFFFF;
+	for (i = 0; i < 8; i++) {
+		t = Profile_Now();
+		t = Profile_Now() - t;
+		if (t < benchOverhead) {
+			benchOverhead = t;
+		}
+	}
+}
+
+/* Open a report */
+void Bench_ReportBegin(const char *title)
+{
+	benchFirst = true;
+
+	switch (benchFormat) {
+	case BENCH_FORMAT_JSON:
+		sprintf(benchLine, "{\"title\":\"%s\",\"core_hz\":%lu,\"tick_hz\":%lu,\"results\":[",
+				title, (unsigned long) SystemCoreClock, (unsigned long) Profile_TicksPerSecond());
+		benchPutLine();
+		break;
+
+	case BENCH_FORMAT_CSV:
+		sprintf(benchLine, "# %s, core %lu Hz, ticks %lu Hz\r\n"
+				"group,name,unit,samples,min,median,mean,p90,p99,max,stddev,rate_per_s,result\r\n",
+				title, (unsigned long) SystemCoreClock, (unsigned long) Profile_TicksPerSecond());
+		benchPutLine();
+		break;
+
+	default:
+		sprintf(benchLine, "\r\n%s, core %lu Hz, times in ticks of %lu Hz\r\n"
+				"%-12s %-22s %5s %9s %9s %9s %9s %9s %12s\r\n",
+				title, (unsigned long) SystemCoreClock, (unsigned long) Profile_TicksPerSecond(),
+				"group", "name", "n", "min", "median", "mean", "p99", "max", "rate/s");
+		benchPutLine();
+		break;
+	}
+}
+
+/* Close a report */
+void Bench_ReportEnd(void)
+{
+	if (benchFormat == BENCH_FORMAT_JSON) {
+		strcpy(benchLine, "\r\n]}\r\n");
+		benchPutLine();
+	}
+}
+
+/* Run one benchmark */
+bool Bench_Run(const BENCH_T *pBench, BENCH_RESULT_T *pResult)
+{
+	uint32_t i, warmup, reps, work, start, t, primask;
+	uint64_t total = 0;
+	bool ok = true;
+
+	memset(pResult, 0, sizeof(*pResult));
+	warmup = pBench->warmup ? pBench->warmup : BENCH_DEFAULT_WARMUP;
+	reps = pBench->reps ? pBench->reps : BENCH_DEFAULT_REPS;
+	if (reps > BENCH_MAX_SAMPLES) {
+		reps = BENCH_MAX_SAMPLES;
+	}
+
+	if (pBench->setup && !pBench->setup(pBench->ctx)) {
+		return false;
+	}
+
+	for (i = 0; (i < warmup) && ok; i++) {
+		ok = pBench->run(pBench->ctx) != 0;
+	}
+
+	for (i = 0; (i < reps) && ok; i++) {
+		primask = __get_PRIMASK();
+		if ((pBench->flags & BENCH_FLAG_IRQ_ON) == 0) {
+			__disable_irq();
+		}
+		start = Profile_Now();
+		work = pBench->run(pBench->ctx);
+		t = Profile_Now() - start;
+		__set_PRIMASK(primask);
+
+		benchSamples[i] = (t > benchOverhead) ? (t - benchOverhead) : 0;
+		total += work;
+		ok = work != 0;
+	}
+
+	if (pBench->teardown) {
+		pBench->teardown(pBench->ctx);
+	}
+	if (!ok) {
+		return false;
+	}
+
+	Bench_Summarize(benchSamples, reps, total, pResult);
+
+	return true;
+}
+
+/* Run and report every entry of a table */
+int Bench_RunTable(const BENCH_T *table, int count)
+{
+	BENCH_RESULT_T result;
+	int i, failed = 0;
+
+	for (i = 0; i < count; i++) {
+		if (!Bench_Run(&table[i], &result)) {
+			failed++;
+		}
+		Bench_Emit(table[i].group, table[i].name, table[i].unit, &result);
+	}
+
+	return failed;
+}
+
+/* Summarize externally timed samples */
+void Bench_Summarize(uint32_t *samples, uint32_t count, uint64_t work, BENCH_RESULT_T *pResult)
+{
+	uint32_t i, j, t;
+	uint64_t sum = 0, var = 0;
+	int64_t d;
+
+	memset(pResult, 0, sizeof(*pResult));
+	pResult->ok = true;
+	pResult->work = work;
+	if (count == 0) {
+		return;
+	}
+
+	/* Insertion sort, there are at most a few dozen samples */
+	for (i = 1; i < count; i++) {
+		t = samples[i];
+		for (j = i; (j > 0) && (samples[j - 1] > t); j--) {
+			samples[j] = samples[j - 1];
+		}
+		samples[j] = t;
+	}
+
+	for (i = 0; i < count; i++) {
+		sum += samples[i];
+	}
+	pResult->samples = count;
+	pResult->min = samples[0];
+	pResult->max = samples[count - 1];
+	pResult->median = samples[count / 2];
+	pResult->p90 = benchPercentile(samples, count, 90);
+	pResult->p99 = benchPercentile(samples, count, 99);
+	pResult->mean = (uint32_t) (sum / count);
+	for (i = 0; i < count; i++) {
+		d = (int64_t) samples[i] - pResult->mean;
+		var += (uint64_t) (d * d);
+	}
+	pResult->stddev = benchSqrt(var / count);
+	if (sum != 0) {
+		pResult->rate = (uint32_t) ((work * Profile_TicksPerSecond()) / sum);
+	}
+}
+
+/* Print one result line of the open report */
+void Bench_Emit(const char *group, const char *name, const char *unit, const BENCH_RESULT_T *pResult)
+{
+	switch (benchFormat) {
+	case BENCH_FORMAT_JSON:
+		sprintf(benchLine, "%s\r\n{\"group\":\"%s\",\"name\":\"%s\",\"unit\":\"%s\",\"samples\":%lu,"
+				"\"min\":%lu,\"median\":%lu,\"mean\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu,"
+				"\"stddev\":%lu,\"rate_per_s\":%lu,\"ok\":%s}",
+				benchFirst ? "" : ",", group, name, unit, (unsigned long) pResult->samples,
+				(unsigned long) pResult->min, (unsigned long) pResult->median,
+				(unsigned long) pResult->mean, (unsigned long) pResult->p90,
+				(unsigned long) pResult->p99, (unsigned long) pResult->max,
+				(unsigned long) pResult->stddev, (unsigned long) pResult->rate,
+				pResult->ok ? "true" : "false");
+		benchFirst = false;
+		break;
+
+	case BENCH_FORMAT_CSV:
+		sprintf(benchLine, "%s,%s,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%s\r\n",
+				group, name, unit, (unsigned long) pResult->samples,
+				(unsigned long) pResult->min, (unsigned long) pResult->median,
+				(unsigned long) pResult->mean, (unsigned long) pResult->p90,
+				(unsigned long) pResult->p99, (unsigned long) pResult->max,
+				(unsigned long) pResult->stddev, (unsigned long) pResult->rate,
+				pResult->ok ? "OK" : "FAIL");
+		break;
+
+	default:
+		if (!pResult->ok) {
+			sprintf(benchLine, "%-12s %-22s FAILED\r\n", group, name);
+		}
+		else {
+			sprintf(benchLine, "%-12s %-22s %5lu %9lu %9lu %9lu %9lu %9lu %10lu %s\r\n",
+					group, name, (unsigned long) pResult->samples,
+					(unsigned long) pResult->min, (unsigned long) pResult->median,
+					(unsigned long) pResult->mean, (unsigned long) pResult->p99,
+					(unsigned long) pResult->max, (unsigned long) pResult->rate, unit);
+		}
+		break;
+	}
+	benchPutLine();
+}
@@ -0,0 +1,192 @@
+/*
+ * @brief    On-target benchmark harness
+ *           Runs registered micro-benchmarks with warmup and repetitions and
+ *           reports their statistics as text, CSV or JSON.
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __BENCH_H_
+#define __BENCH_H_
+
+#include "lpc_types.h"
+
+/** @defgroup BOARD_Bench BOARD: On-target benchmark harness
+ * @ingroup BOARD_Common
+ * Benchmarks are described by BENCH_T entries collected in const tables
+ * with the BENCH_ENTRY() macros and run with Bench_RunTable(). Each entry
+ * runs warmup iterations, then a number of timed iterations whose spread
+ * is summarized as min, median, mean, 90th/99th percentile, max and
+ * standard deviation. Time is taken from the profiling time base
+ * (profile.h), the DWT cycle counter on the Cortex-M3/M4. Results that are
+ * measured some other way (long transfers, network tests) are reported
+ * through Bench_Summarize() and Bench_Emit() so that every example of a
+ * board produces the same report lines.
+ *
+ * Output goes through a string callback, DEBUGSTR() by default, so the
+ * report can be sent over USB CDC instead of the UART.
+ * @{
+ */
+
+/* Largest number of timed iterations of one benchmark */
+#ifndef BENCH_MAX_SAMPLES
+#define BENCH_MAX_SAMPLES 64
+#endif
+
+/* Iterations used when an entry leaves warmup or reps at 0 */
+#define BENCH_DEFAULT_WARMUP 2
+#define BENCH_DEFAULT_REPS   16
+
+/* Entry flags */
+#define BENCH_FLAG_IRQ_ON    (1 << 0)	/*!< Leave interrupts enabled while timing (DMA or IRQ driven work) */
+
+/**
+ * @brief Report format
+ */
+typedef enum {
+	BENCH_FORMAT_TEXT,	/*!< Aligned columns for a terminal */
+	BENCH_FORMAT_CSV,	/*!< One header line and one line per result */
+	BENCH_FORMAT_JSON	/*!< One object with a results array */
+} BENCH_FORMAT_T;
+
+/**
+ * @brief Report output callback, writes a zero terminated string
+ */
+typedef void (*BENCH_PUTS_T)(const char *str);
+
+/**
+ * @brief Benchmark entry
+ */
+typedef struct {
+	const char *group;					/*!< Group, such as "memcpy" or "crc" */
+	const char *name;					/*!< Name within the group */
+	const char *unit;					/*!< Unit of the work run() returns, such as "B" or "op" */
+	uint32_t (*run)(void *ctx);			/*!< One iteration, returns the work done, 0 on failure */
+	bool (*setup)(void *ctx);			/*!< Called once before the warmup, or NULL; false skips the entry */
+	void (*teardown)(void *ctx);		/*!< Called once after the last iteration, or NULL */
+	void *ctx;							/*!< Passed to the callbacks */
+	uint16_t warmup;					/*!< Untimed iterations, 0 for BENCH_DEFAULT_WARMUP */
+	uint16_t reps;						/*!< Timed iterations, 0 for BENCH_DEFAULT_REPS */
+	uint32_t flags;						/*!< BENCH_FLAG_x */
+} BENCH_T;
+
+/** Entry of a benchmark table with the default warmup and repetitions */
+#define BENCH_ENTRY(group, name, unit, run, ctx) \
+	{(group), (name), (unit), (run), NULL, NULL, (void *) (ctx), 0, 0, 0}
+
+/** Entry of a benchmark table with setup, teardown, iteration counts and flags */
+#define BENCH_ENTRY_EX(group, name, unit, run, setup, teardown, ctx, warmup, reps, flags) \
+	{(group), (name), (unit), (run), (setup), (teardown), (void *) (ctx), (warmup), (reps), (flags)}
+
+/** Runs a table declared as a const BENCH_T array */
+#define BENCH_RUN_TABLE(table) Bench_RunTable((table), (int) NELEMENTS(table))
+
+/**
+ * @brief Benchmark result, times in ticks of the profiling time base
+ */
+typedef struct {
+	uint32_t samples;		/*!< Timed iterations */
+	uint32_t min;			/*!< Fastest iteration */
+	uint32_t median;		/*!< Median iteration */
+	uint32_t mean;			/*!< Mean iteration */
+	uint32_t p90;			/*!< 90th percentile */
+	uint32_t p99;			/*!< 99th percentile */
+	uint32_t max;			/*!< Slowest iteration */
+	uint32_t stddev;		/*!< Standard deviation */
+	uint64_t work;			/*!< Total work of the timed iterations, in the entry unit */
+	uint32_t rate;			/*!< Work per second over the timed iterations, 0 if unknown */
+	bool ok;				/*!< false if setup or an iteration failed */
+} BENCH_RESULT_T;
+
+/**
+ * @brief	Start the time base and set the report format and output
+ * @param	format	: Report format
+ * @param	puts	: Output callback, or NULL for DEBUGSTR()
+ * @return	Nothing
+ */
+void Bench_Init(BENCH_FORMAT_T format, BENCH_PUTS_T puts);
+
+/**
+ * @brief	Open a report
+ * @param	title	: Report title, such as the board name and revision
+ * @return	Nothing
+ * @note	Prints the title, core clock and time base rate, and the CSV
+ * header. All results up to Bench_ReportEnd() belong to this report.
+ */
+void Bench_ReportBegin(const char *title);
+
+/**
+ * @brief	Close a report opened with Bench_ReportBegin()
+ * @return	Nothing
+ */
+void Bench_ReportEnd(void);
+
+/**
+ * @brief	Run one benchmark
+ * @param	pBench	: Benchmark entry
+ * @param	pResult	: Where to store the result
+ * @return	true if the benchmark ran, false if it was skipped or failed
+ * @note	Does not print anything, see Bench_Emit().
+ */
+bool Bench_Run(const BENCH_T *pBench, BENCH_RESULT_T *pResult);
+
+/**
+ * @brief	Run and report every entry of a table
+ * @param	table	: Benchmark entries
+ * @param	count	: Number of entries
+ * @return	Number of entries that failed or were skipped
+ */
+int Bench_RunTable(const BENCH_T *table, int count);
+
+/**
+ * @brief	Summarize externally timed samples
+ * @param	samples	: Durations in ticks, sorted in place
+ * @param	count	: Number of samples
+ * @param	work	: Total work of the samples, in the unit they are reported in
+ * @param	pResult	: Where to store the result (ok is set to true)
+ * @return	Nothing
+ * @note	Use Profile_Now() differences as samples so they share the
+ * time base of Bench_Run().
+ */
+void Bench_Summarize(uint32_t *samples, uint32_t count, uint64_t work, BENCH_RESULT_T *pResult);
+
+/**
+ * @brief	Print one result line of the open report
+ * @param	group	: Result group
+ * @param	name	: Result name
+ * @param	unit	: Unit of the work
+ * @param	pResult	: Result from Bench_Run() or Bench_Summarize()
+ * @return	Nothing
+ */
+void Bench_Emit(const char *group, const char *name, const char *unit, const BENCH_RESULT_T *pResult);
+
+/**
+ * @}
+ */
+
+#endif /* __BENCH_H_ */
@@ -0,0 +1,257 @@
+/*
+ * @brief    Deferred debug log
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "board.h"
+#include "profile.h"
+#include "board_log.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* One recorded log call */
+typedef struct {
+#if defined(BOARD_LOG_TIMEBASE)
+	uint64_t stamp;
+#else
+	uint32_t stamp;
+#endif
+	const char *fmt;
+	uint32_t arg[BOARD_LOG_MAX_ARGS];
+} LOG_RECORD_T;
+
+static LOG_RECORD_T logRing[BOARD_LOG_ENTRIES];
+
+/* Set once a claimed record is filled in, cleared by the drain */
+static volatile uint8_t logReady[BOARD_LOG_ENTRIES];
+
+/* Free running claim and drain counts, the ring index is the low bits */
+static volatile uint32_t logHead;
+static volatile uint32_t logTail;
+
+static volatile uint32_t logDropped;
+static uint32_t logDropReported;
+
+/* Line being printed, logPos up to logLen still to send */
+static char logLine[BOARD_LOG_LINE_SIZE];
+static int logLen;
+static int logPos;
+
+/* Characters written to the empty UART FIFO at a time */
+#define LOG_UART_FIFO_DEPTH 16
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Number of arguments a format string takes */
+static HOTFUNC int logCountArgs(const char *fmt)
+{
+	int n = 0;
+
+	while (*fmt != '\0') {
+		if (*fmt++ != '%') {
+			continue;
+		}
+		if (*fmt == '%') {
+			fmt++;
+			continue;
+		}
+		/* Flags, width, precision and length, a * takes an argument */
+		while ((*fmt != '\0') && (strchr("-+ #0123456789.*hlLjzt", *fmt) != NULL)) {
+			if (*fmt++ == '*') {
+				n++;
+			}
+		}
+		n++;
+	}
+
+	return n;
+}
+
+/* Format the oldest record into logLine, false if there is none ready */
+static bool logFormatNext(void)
+{
+	LOG_RECORD_T *pRec;
+	uint32_t idx;
+	int n;
+
+	if (logDropped != logDropReported) {
+		logDropReported = logDropped;
+		logLen = snprintf(logLine, sizeof(logLine), "log: %lu records dropped\r\n",
+						  (unsigned long) logDropReported);
+		logPos = 0;
+		return true;
+	}
+
+	if (logTail == logHead) {
+		return false;
+	}
+	idx = logTail & (BOARD_LOG_ENTRIES - 1);
+	if (!logReady[idx]) {
+		/* Claimed by an interrupted writer, not filled in yet */
+		return false;
+	}
+
+	pRec = &logRing[idx];
+#if defined(BOARD_LOG_TIMEBASE)
+	{
+		uint64_t us = Chip_TIMEBASE_TicksToNs(pRec->stamp) / 1000;
+
+		n = snprintf(logLine, sizeof(logLine), "[%6lu.%06lu] ", (unsigned long) (us / 1000000),
+					 (unsigned long) (us % 1000000));
+	}
+#else
+	n = snprintf(logLine, sizeof(logLine), "[%10lu] ", (unsigned long) pRec->stamp);
+#endif
+	n += snprintf(&logLine[n], sizeof(logLine) - n, pRec->fmt, pRec->arg[0], pRec->arg[1],
+				  pRec->arg[2], pRec->arg[3], pRec->arg[4], pRec->arg[5]);
+	logLen = MIN(n, (int) sizeof(logLine) - 1);
+	logPos = 0;
+
+	logReady[idx] = 0;
+	logTail++;
+
+	return true;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Empty the log ring and start the timestamp counter */
+void Board_Log_Init(void)
+{
+	uint32_t i;
+
+#if defined(CORE_M0)
+	StopWatch_Init();
+#else
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+#if defined(BOARD_FAST_BOOT)
+	/* The drain writes the UART directly, set it up before first use */
+	Board_Debug_Init();
+#endif
+
+	for (i = 0; i < BOARD_LOG_ENTRIES; i++) {
+		logReady[i] = 0;
+	}
+	logHead = logTail = 0;
+	logDropped = logDropReported = 0;
+	logLen = logPos = 0;
+}
+
+/* Record a log line for later output */
+HOTFUNC void Board_Log(const char *fmt, ...)
+{
+	LOG_RECORD_T *pRec;
+	va_list ap;
+	uint32_t primask, idx;
+	int i, n;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if ((logHead - logTail) >= BOARD_LOG_ENTRIES) {
+		logDropped++;
+		__set_PRIMASK(primask);
+		return;
+	}
+	idx = logHead++ & (BOARD_LOG_ENTRIES - 1);
+	__set_PRIMASK(primask);
+
+	pRec = &logRing[idx];
+#if defined(BOARD_LOG_TIMEBASE)
+	pRec->stamp = Chip_TIMEBASE_Now();
+#else
+	pRec->stamp = Profile_Now();
+#endif
+	pRec->fmt = fmt;
+	n = MIN(logCountArgs(fmt), BOARD_LOG_MAX_ARGS);
+	va_start(ap, fmt);
+	for (i = 0; i < n; i++) {
+		pRec->arg[i] = va_arg(ap, uint32_t);
+	}
+	va_end(ap);
+
+	/* The record must be complete before the drain can see it */
+	__DMB();
+	logReady[idx] = 1;
+}
+
+/* Print pending log records without waiting on the UART */
+bool Board_Log_Task(void)
+{
+#if defined(DEBUG_UART) && !defined(DEBUG_SEMIHOSTING)
+	int i;
+
+	if ((logPos >= logLen) && !logFormatNext()) {
+		return logTail != logHead;
+	}
+
+	/* THRE means the transmit FIFO is empty, fill it without waiting */
+	if (Chip_UART_ReadLineStatus(DEBUG_UART) & UART_LSR_THRE) {
+		for (i = 0; (i < LOG_UART_FIFO_DEPTH) && (logPos < logLen); i++) {
+			Chip_UART_SendByte(DEBUG_UART, (uint8_t) logLine[logPos++]);
+		}
+	}
+
+	return (logPos < logLen) || (logTail != logHead) || (logDropped != logDropReported);
+
+#else
+	while (logFormatNext()) {
+		DEBUGSTR(logLine);
+	}
+	logLen = logPos = 0;
+
+	return false;
+#endif
+}
+
+/* Print all pending log records, waiting on the UART */
+void Board_Log_Flush(void)
+{
+	while (Board_Log_Task()) {}
+}
+
+/* Returns the number of records dropped on a full ring */
+uint32_t Board_Log_GetDropped(void)
+{
+	return logDropped;
+}
@@ -0,0 +1,119 @@
+/*
+ * @brief    Deferred debug log
+ *           Records log calls in a ring and prints them later from the
+ *           main loop, so debug output can stay in interrupt handlers.
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __BOARD_LOG_H_
+#define __BOARD_LOG_H_
+
+#include "lpc_types.h"
+
+/** @defgroup BOARD_Log BOARD: Deferred debug log
+ * @ingroup BOARD_Common
+ * Board_Log() stores the format string pointer, up to BOARD_LOG_MAX_ARGS
+ * 32-bit arguments and a cycle count timestamp in a ring, which takes a
+ * few hundred cycles, and never waits on the UART. Board_Log_Task()
+ * formats the oldest record and feeds the debug UART FIFO only as far as
+ * it has room, so it can be called from the main loop or an idle task.
+ * Records that find the ring full are counted and reported as dropped.
+ *
+ * Because formatting is deferred, the format string and any %s argument
+ * must be constant strings, and arguments must be 32-bit integers or
+ * pointers (no floating point or 64-bit values). A %* width takes an
+ * argument slot of its own.
+ *
+ * With BOARD_LOG_TIMEBASE defined, records are stamped with
+ * Chip_TIMEBASE_Now() instead and printed as seconds and microseconds, so
+ * log lines share the time base of the other timestamped features. The
+ * application starts the time base with Chip_TIMEBASE_Init().
+ * @{
+ */
+
+/* Number of records in the ring, a power of 2 */
+#ifndef BOARD_LOG_ENTRIES
+#define BOARD_LOG_ENTRIES   64
+#endif
+
+/* Largest number of arguments of one record, a format must not take more */
+#define BOARD_LOG_MAX_ARGS  6
+
+/* Longest printed line, including the timestamp */
+#define BOARD_LOG_LINE_SIZE 128
+
+/* DEBUGLOG() is the deferred form of DEBUGOUT(), it compiles to nothing
+   when DEBUG_ENABLE is not defined. Include this file after board.h. */
+#if defined(DEBUG_ENABLE)
+#define DEBUGLOG(...) Board_Log(__VA_ARGS__)
+#else
+#define DEBUGLOG(...)
+#endif
+
+/**
+ * @brief	Empty the log ring and start the timestamp counter
+ * @return	Nothing
+ */
+void Board_Log_Init(void);
+
+/**
+ * @brief	Record a log line for later output
+ * @param	fmt	: Constant printf format string
+ * @return	Nothing
+ * @note	Safe to call from any interrupt priority and from thread level.
+ *			Interrupts are only masked while a ring slot is claimed.
+ */
+HOTFUNC void Board_Log(const char *fmt, ...);
+
+/**
+ * @brief	Print pending log records without waiting on the UART
+ * @return	true if records or characters are still pending
+ * @note	Call from the main loop or an idle task, not from interrupts.
+ *			With semihosting or without a debug UART the lines go out
+ *			through DEBUGSTR() and this call blocks.
+ */
+bool Board_Log_Task(void);
+
+/**
+ * @brief	Print all pending log records, waiting on the UART
+ * @return	Nothing
+ */
+void Board_Log_Flush(void);
+
+/**
+ * @brief	Returns the number of records dropped on a full ring
+ * @return	Records dropped since Board_Log_Init()
+ */
+uint32_t Board_Log_GetDropped(void);
+
+/**
+ * @}
+ */
+
+#endif /* __BOARD_LOG_H_ */
@@ -0,0 +1,170 @@
+/*
+ * @brief Audio codec shadow register cache
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "board.h"
+#include "codec_regcache.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define MAP_TEST(map, reg)  ((map)[(reg) >> 5] & (1UL << ((reg) & 31)))
+#define MAP_SET(map, reg)   ((map)[(reg) >> 5] |= (1UL << ((reg) & 31)))
+#define MAP_CLR(map, reg)   ((map)[(reg) >> 5] &= ~(1UL << ((reg) & 31)))
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Returns true if the register value is kept in the shadow copy */
+static bool regcache_cached(CODEC_REGCACHE_T *pCache, uint8_t reg)
+{
+	if (reg >= pCache->numRegs) {
+		return false;
+	}
+	return (pCache->isVolatile == NULL) || !pCache->isVolatile(reg);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Forget all cached register values */
+void Codec_RegCache_Invalidate(CODEC_REGCACHE_T *pCache)
+{
+	int i;
+
+	for (i = 0; i < CODEC_REGCACHE_WORDS(pCache->numRegs); i++) {
+		pCache->pValid[i] = 0;
+		pCache->pDirty[i] = 0;
+	}
+	pCache->batch = false;
+}
+
+/* Record a value that is now in a codec register */
+void Codec_RegCache_Store(CODEC_REGCACHE_T *pCache, uint8_t reg, uint16_t val)
+{
+	if (regcache_cached(pCache, reg)) {
+		pCache->pShadow[reg] = val;
+		MAP_SET(pCache->pValid, reg);
+		MAP_CLR(pCache->pDirty, reg);
+	}
+}
+
+/* Read a codec register */
+uint16_t Codec_RegCache_Read(CODEC_REGCACHE_T *pCache, uint8_t reg)
+{
+	uint16_t val;
+
+	if (!regcache_cached(pCache, reg)) {
+		return pCache->read(reg);
+	}
+	if (!MAP_TEST(pCache->pValid, reg)) {
+		val = pCache->read(reg);
+		pCache->pShadow[reg] = val;
+		MAP_SET(pCache->pValid, reg);
+	}
+	return pCache->pShadow[reg];
+}
+
+/* Write a codec register */
+void Codec_RegCache_Write(CODEC_REGCACHE_T *pCache, uint8_t reg, uint16_t val)
+{
+	if (!regcache_cached(pCache, reg)) {
+		pCache->write(reg, val);
+		return;
+	}
+	if (MAP_TEST(pCache->pValid, reg) && (pCache->pShadow[reg] == val)) {
+		return;
+	}
+
+	pCache->pShadow[reg] = val;
+	MAP_SET(pCache->pValid, reg);
+	if (pCache->batch) {
+		MAP_SET(pCache->pDirty, reg);
+	}
+	else {
+		MAP_CLR(pCache->pDirty, reg);
+		pCache->write(reg, val);
+	}
+}
+
+/* Change bits of a codec register */
+void Codec_RegCache_Update(CODEC_REGCACHE_T *pCache, uint8_t reg, uint16_t mask, uint16_t val)
+{
+	uint16_t cur = Codec_RegCache_Read(pCache, reg);
+
+	Codec_RegCache_Write(pCache, reg, (cur & ~mask) | (val & mask));
+}
+
+/* Send all held register writes and stop batching */
+int Codec_RegCache_Flush(CODEC_REGCACHE_T *pCache)
+{
+	int ret = 1;
+	int reg, cnt, i;
+
+	pCache->batch = false;
+	for (reg = 0; reg < pCache->numRegs; reg += cnt) {
+		cnt = 1;
+		if (!MAP_TEST(pCache->pDirty, reg)) {
+			continue;
+		}
+
+		/* Collect the run of dirty registers starting here */
+		while (((reg + cnt) < pCache->numRegs) && (cnt < CODEC_REGCACHE_BURST_MAX) &&
+			   MAP_TEST(pCache->pDirty, reg + cnt)) {
+			cnt++;
+		}
+
+		if ((cnt > 1) && pCache->writeBurst) {
+			if (!pCache->writeBurst(reg, &pCache->pShadow[reg], cnt)) {
+				/* Keep the run dirty for the next flush */
+				ret = 0;
+				continue;
+			}
+		}
+		else {
+			for (i = 0; i < cnt; i++) {
+				pCache->write(reg + i, pCache->pShadow[reg + i]);
+			}
+		}
+
+		for (i = 0; i < cnt; i++) {
+			MAP_CLR(pCache->pDirty, reg + i);
+		}
+	}
+
+	return ret;
+}
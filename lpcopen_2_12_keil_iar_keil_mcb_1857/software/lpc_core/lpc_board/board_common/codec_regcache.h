@@ -0,0 +1,154 @@
+/*
+ * @brief Audio codec shadow register cache
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __CODEC_REGCACHE_H_
+#define __CODEC_REGCACHE_H_
+
+#include "lpc_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup BOARD_COMMON_CODEC_REGCACHE BOARD: Audio codec register cache
+ * @ingroup BOARD_Common
+ * Shadow copy of the 16-bit control registers of an I2C audio codec. Bit
+ * updates are done on the shadow copy so a volume or mute change costs a
+ * single register write and no bus read. Writes can be batched and sent
+ * with Codec_RegCache_Flush(), consecutive registers then go out in one
+ * burst if the codec driver provides a burst write function.
+ * @{
+ */
+
+/**
+ * @brief	Number of 32-bit words needed for a register bitmap
+ */
+#define CODEC_REGCACHE_WORDS(n)     (((n) + 31) / 32)
+
+/**
+ * @brief	Largest number of registers passed to one burst write
+ */
+#define CODEC_REGCACHE_BURST_MAX    16
+
+/**
+ * @brief Codec register cache
+ * The driver owning the cache provides the storage and the bus accessors.
+ * Registers at or above @a numRegs and registers for which @a isVolatile
+ * returns true always go to the bus.
+ */
+typedef struct {
+	uint16_t *pShadow;							/*!< Shadow values, numRegs entries */
+	uint32_t *pValid;							/*!< Bitmap of registers with a known value */
+	uint32_t *pDirty;							/*!< Bitmap of registers waiting for a flush */
+	uint16_t numRegs;							/*!< Number of cached registers */
+	bool batch;									/*!< Writes are held until Codec_RegCache_Flush() */
+	bool (*isVolatile)(uint8_t reg);			/*!< Returns true for status registers, may be NULL */
+	void (*write)(uint8_t reg, uint16_t val);	/*!< Bus write of one register */
+	uint16_t (*read)(uint8_t reg);				/*!< Bus read of one register */
+	int (*writeBurst)(uint8_t reg, const uint16_t *val, int cnt);	/*!< Bus write of consecutive registers,
+																	   returns 1 on success, may be NULL */
+} CODEC_REGCACHE_T;
+
+/**
+ * @brief	Forget all cached register values
+ * @param	pCache	: Pointer to the register cache
+ * @return	Nothing
+ * @note	Call after a codec reset. Batching is turned off.
+ */
+void Codec_RegCache_Invalidate(CODEC_REGCACHE_T *pCache);
+
+/**
+ * @brief	Record a value that is now in a codec register
+ * @param	pCache	: Pointer to the register cache
+ * @param	reg		: Register that was written or read
+ * @param	val		: Value of the register
+ * @return	Nothing
+ * @note	Used by the codec driver after a direct bus access, no bus access is done.
+ */
+void Codec_RegCache_Store(CODEC_REGCACHE_T *pCache, uint8_t reg, uint16_t val);
+
+/**
+ * @brief	Read a codec register
+ * @param	pCache	: Pointer to the register cache
+ * @param	reg		: Register to read
+ * @return	Value of the register
+ * @note	The bus is only read the first time a non volatile register is read.
+ */
+uint16_t Codec_RegCache_Read(CODEC_REGCACHE_T *pCache, uint8_t reg);
+
+/**
+ * @brief	Write a codec register
+ * @param	pCache	: Pointer to the register cache
+ * @param	reg		: Register to write
+ * @param	val		: Value to write
+ * @return	Nothing
+ * @note	Nothing is sent if the register already holds @a val. While batching
+ *          the write is held until Codec_RegCache_Flush().
+ */
+void Codec_RegCache_Write(CODEC_REGCACHE_T *pCache, uint8_t reg, uint16_t val);
+
+/**
+ * @brief	Change bits of a codec register
+ * @param	pCache	: Pointer to the register cache
+ * @param	reg		: Register to update
+ * @param	mask	: Bits to change
+ * @param	val		: New value of the bits in @a mask
+ * @return	Nothing
+ * @note	Read-modify-write on the shadow copy, see Codec_RegCache_Write().
+ */
+void Codec_RegCache_Update(CODEC_REGCACHE_T *pCache, uint8_t reg, uint16_t mask, uint16_t val);
+
+/**
+ * @brief	Start holding register writes
+ * @param	pCache	: Pointer to the register cache
+ * @return	Nothing
+ */
+STATIC INLINE void Codec_RegCache_Batch(CODEC_REGCACHE_T *pCache)
+{
+	pCache->batch = true;
+}
+
+/**
+ * @brief	Send all held register writes and stop batching
+ * @param	pCache	: Pointer to the register cache
+ * @return	1 on success, 0 if a burst write failed
+ */
+int Codec_RegCache_Flush(CODEC_REGCACHE_T *pCache);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* __CODEC_REGCACHE_H_ */
@@ -51,6 +51,11 @@ extern "C" {
  * Once initialized, just preiodically call the lpcPHYStsPoll() function
  * from the background loop or a thread and monitor the returned status
  * to determine if the PHY state has changed and the current PHY state.
+ *
+ * Alternatively call lpc_phy_init_async() instead of lpc_phy_init() and
+ * lpc_phy_async_tick() from a periodic timer. Reset, configuration and link
+ * monitoring then run without ever waiting on the MII, and a callback is
+ * made on every link change once the MAC speed and duplex are updated.
  * @{
  */
 #define PHY_LINK_ERROR     (1 << 0)	/*!< PHY status bit for link error */
@@ -60,6 +65,11 @@ extern "C" {
 #define PHY_LINK_SPEED100  (1 << 4)	/*!< PHY status bit for 100Mbps mode */
 #define PHY_LINK_FULLDUPLX (1 << 5)	/*!< PHY status bit for full duplex mode */
 
+/**
+ * @brief PHY link change callback, called with the PHY_LINK_* status
+ */
+typedef void (*p_phyLinkChange_func_t)(uint32_t physts);
+
 /**
  * @brief	Phy status update state machine
  * @return	An Or'ed value of PHY_LINK_* statuses
@@ -79,6 +89,27 @@ uint32_t lpcPHYStsPoll(void);
  */
 uint32_t lpc_phy_init(bool rmii, p_msDelay_func_t pDelayMsFunc);
 
+/**
+ * @brief	Start a non-blocking PHY initialization
+ * @param	rmii		: Initializes PHY for RMII mode if true, MII if false
+ * @param	pLinkFunc	: Link change callback, may be NULL
+ * @return	Nothing
+ * @note	Only arms the state machine, nothing is sent to the PHY until the
+ * first lpc_phy_async_tick() call.
+ */
+void lpc_phy_init_async(bool rmii, p_phyLinkChange_func_t pLinkFunc);
+
+/**
+ * @brief	Advance the non-blocking PHY state machine
+ * @return	An Or'ed value of PHY_LINK_* statuses
+ * @note	Call from a periodic timer, each call does at most one MII step and
+ * never waits. The PHY reset is given up on (PHY_LINK_ERROR) after 400
+ * calls, so a 1mS tick matches lpc_phy_init(). When the link changes the
+ * MAC is set to the new speed and duplex with Chip_ENET_SetSpeed() and
+ * Chip_ENET_SetDuplex() before the link change callback runs.
+ */
+uint32_t lpc_phy_async_tick(void);
+
 /**
  * @}
  */
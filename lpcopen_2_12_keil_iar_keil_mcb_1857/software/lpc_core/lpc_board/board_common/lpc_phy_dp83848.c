@@ -97,6 +97,23 @@ static int32_t phyustate;
 /* Pointer to delay function used for this driver */
 static p_msDelay_func_t pDelayMs;
 
+/* Non-blocking bring-up states, each waits for the MII operation started
+   by the previous state */
+typedef enum {
+	PHY_ASYNC_RESET,			/* Start the PHY reset */
+	PHY_ASYNC_RESET_POLL,		/* Read back the control register */
+	PHY_ASYNC_RESET_CHECK,		/* Wait for the reset to complete */
+	PHY_ASYNC_CONFIG,			/* Select MII or RMII */
+	PHY_ASYNC_LINK_POLL,		/* Start a link status read */
+	PHY_ASYNC_LINK_CHECK,		/* Update the link status */
+	PHY_ASYNC_FAILED			/* Reset timed out */
+} PHY_ASYNC_STATE_T;
+
+static PHY_ASYNC_STATE_T phyAsyncState;
+static bool phyAsyncRmii;
+static int32_t phyAsyncTimeout;
+static p_phyLinkChange_func_t pLinkChange;
+
 /* Write to the PHY. Will block for delays based on the pDelayMs function. Returns
    true on success, or false on failure */
 static Status lpc_mii_write(uint8_t reg, uint16_t data)
@@ -276,6 +293,88 @@ uint32_t lpcPHYStsPoll(void)
 	return physts;
 }
 
+/* Start a non-blocking PHY initialization */
+void lpc_phy_init_async(bool rmii, p_phyLinkChange_func_t pLinkFunc)
+{
+	olddphysts = physts = phyustate = 0;
+	phyAsyncRmii = rmii;
+	phyAsyncTimeout = 400;
+	pLinkChange = pLinkFunc;
+	phyAsyncState = PHY_ASYNC_RESET;
+}
+
+/* Advance the non-blocking PHY state machine */
+uint32_t lpc_phy_async_tick(void)
+{
+	uint16_t tmp;
+
+	/* Every state past the first waits on the MII operation started
+	   before it */
+	if ((phyAsyncState != PHY_ASYNC_RESET) && Chip_ENET_IsMIIBusy(LPC_ETHERNET)) {
+		return physts;
+	}
+
+	switch (phyAsyncState) {
+	case PHY_ASYNC_RESET:
+		Chip_ENET_StartMIIWrite(LPC_ETHERNET, DP8_BMCR_REG, DP8_RESET);
+		phyAsyncState = PHY_ASYNC_RESET_POLL;
+		break;
+
+	case PHY_ASYNC_RESET_POLL:
+		Chip_ENET_StartMIIRead(LPC_ETHERNET, DP8_BMCR_REG);
+		phyAsyncState = PHY_ASYNC_RESET_CHECK;
+		break;
+
+	case PHY_ASYNC_RESET_CHECK:
+		tmp = Chip_ENET_ReadMIIData(LPC_ETHERNET);
+		if (!(tmp & (DP8_RESET | DP8_POWER_DOWN))) {
+			Chip_ENET_StartMIIWrite(LPC_ETHERNET, DP8_BMCR_REG, DP8_AUTONEG);
+			phyAsyncState = PHY_ASYNC_CONFIG;
+		}
+		else if (--phyAsyncTimeout > 0) {
+			phyAsyncState = PHY_ASYNC_RESET_POLL;
+		}
+		else {
+			physts |= PHY_LINK_ERROR;
+			phyAsyncState = PHY_ASYNC_FAILED;
+		}
+		break;
+
+	case PHY_ASYNC_CONFIG:
+		if (phyAsyncRmii) {
+			Chip_ENET_StartMIIWrite(LPC_ETHERNET, DP8_PHY_RBR_REG, DP8_RBR_RMII_MODE);
+		}
+		phyAsyncState = PHY_ASYNC_LINK_POLL;
+		break;
+
+	case PHY_ASYNC_LINK_POLL:
+		Chip_ENET_StartMIIRead(LPC_ETHERNET, DP8_PHY_STAT_REG);
+		physts &= ~PHY_LINK_CHANGED;
+		phyAsyncState = PHY_ASYNC_LINK_CHECK;
+		break;
+
+	case PHY_ASYNC_LINK_CHECK:
+		lpc_update_phy_sts(Chip_ENET_ReadMIIData(LPC_ETHERNET));
+		if (physts & PHY_LINK_CHANGED) {
+			if (physts & PHY_LINK_CONNECTED) {
+				Chip_ENET_SetDuplex(LPC_ETHERNET, (bool) (physts & PHY_LINK_FULLDUPLX));
+				Chip_ENET_SetSpeed(LPC_ETHERNET, (bool) (physts & PHY_LINK_SPEED100));
+			}
+			if (pLinkChange) {
+				pLinkChange(physts);
+			}
+		}
+		phyAsyncState = PHY_ASYNC_LINK_POLL;
+		break;
+
+	case PHY_ASYNC_FAILED:
+	default:
+		break;
+	}
+
+	return physts;
+}
+
 /**
  * @}
  */
@@ -31,12 +31,16 @@
  * this code.
  */
 
+#include "chip.h"
 #include "mem_tests.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
  ****************************************************************************/
 
+/* Fill job of the power-on test */
+static GPDMA_JOB_T postJob;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -45,6 +49,231 @@
  * Private functions
  ****************************************************************************/
 
+/* Converts bytes moved in cycles core clocks to KB/s */
+static uint32_t bench_kbs(uint32_t bytes, uint32_t cycles)
+{
+	if (cycles == 0) {
+		return 0;
+	}
+
+	return (uint32_t) (((uint64_t) bytes * SystemCoreClock) / ((uint64_t) cycles * 1024));
+}
+
+/* Sequential read of bytes bytes, 4 words per loop */
+static uint32_t bench_read(const volatile uint32_t *addr, uint32_t bytes)
+{
+	uint32_t sum = 0;
+
+	while (bytes > 0) {
+		sum += addr[0] + addr[1] + addr[2] + addr[3];
+		addr += 4;
+		bytes -= 16;
+	}
+
+	return sum;
+}
+
+/* Sequential write of bytes bytes, 4 words per loop */
+static void bench_write(volatile uint32_t *addr, uint32_t bytes)
+{
+	while (bytes > 0) {
+		addr[0] = bytes;
+		addr[1] = bytes;
+		addr[2] = bytes;
+		addr[3] = bytes;
+		addr += 4;
+		bytes -= 16;
+	}
+}
+
+/* Copy of bytes bytes, 4 words per loop */
+static void bench_copy(volatile uint32_t *dst, const volatile uint32_t *src, uint32_t bytes)
+{
+	uint32_t a, b, c, d;
+
+	while (bytes > 0) {
+		a = src[0];
+		b = src[1];
+		c = src[2];
+		d = src[3];
+		dst[0] = a;
+		dst[1] = b;
+		dst[2] = c;
+		dst[3] = d;
+		src += 4;
+		dst += 4;
+		bytes -= 16;
+	}
+}
+
+/* Random reads over words words (a power of 2), the full period LCG
+   visits every word once per cycle */
+static uint32_t bench_random(const volatile uint32_t *addr, uint32_t words, uint32_t reads)
+{
+	uint32_t idx = 0, sum = 0, mask = words - 1;
+
+	while (reads > 0) {
+		idx = ((idx * 1664525) + 1013904223) & mask;
+		sum += addr[idx];
+		reads--;
+	}
+
+	return sum;
+}
+
+/* Times one CPU pass over the region until MEM_BENCH_BYTES have moved */
+static uint32_t bench_cpu(MEM_BENCH_SETUP_T *pBench, int test, uint32_t *pMoved)
+{
+	uint32_t *base = pBench->start_addr, half = pBench->bytes / 2;
+	uint32_t chunk, moved = 0, start, cycles, primask;
+	volatile uint32_t sink = 0;
+
+	chunk = (test == 2) ? half : pBench->bytes;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	start = DWT->CYCCNT;
+	while (moved < MEM_BENCH_BYTES) {
+		switch (test) {
+		case 0:
+			sink += bench_read(base, chunk);
+			break;
+
+		case 1:
+			bench_write(base, chunk);
+			break;
+
+		default:
+			bench_copy(base + (half / 4), base, chunk);
+			break;
+		}
+		moved += chunk;
+	}
+	cycles = DWT->CYCCNT - start;
+	__set_PRIMASK(primask);
+
+	(void) sink;
+	*pMoved = moved;
+	return cycles;
+}
+
+/* Times a GPDMA copy of the lower half of the region into the upper half */
+static bool bench_dma(MEM_BENCH_SETUP_T *pBench, uint32_t *pMoved, uint32_t *pCycles)
+{
+	static GPDMA_JOB_T job;
+	uint32_t *base = pBench->start_addr, half = pBench->bytes / 2;
+	uint32_t moved = 0, start;
+
+	start = DWT->CYCCNT;
+	while (moved < MEM_BENCH_BYTES) {
+		if (Chip_GPDMA_MemcpyAsync(LPC_GPDMA, pBench->dma_channel, &job, base + (half / 4), base,
+								   half, NULL) != SUCCESS) {
+			return false;
+		}
+		while (Chip_GPDMA_IsJobPending(LPC_GPDMA, pBench->dma_channel)) {
+			Chip_GPDMA_JobIRQHandler(LPC_GPDMA);
+		}
+		moved += half;
+	}
+	*pCycles = DWT->CYCCNT - start;
+	*pMoved = moved;
+
+	return true;
+}
+
+/* Restarts the contention copy once the previous one is done, returns the
+   bytes completed */
+static uint32_t bench_contend_dma(MEM_CONTEND_SETUP_T *pContend, GPDMA_JOB_T *pJob, bool *pError)
+{
+	uint32_t half = pContend->dma_bytes / 2;
+
+	Chip_GPDMA_JobIRQHandler(LPC_GPDMA);
+	if (Chip_GPDMA_IsJobPending(LPC_GPDMA, pContend->dma_channel)) {
+		return 0;
+	}
+
+	if (Chip_GPDMA_MemcpyAsync(LPC_GPDMA, pContend->dma_channel, pJob,
+							   pContend->dma_addr + (half / 4), pContend->dma_addr,
+							   half, NULL) != SUCCESS) {
+		*pError = true;
+	}
+
+	return half;
+}
+
+/* Records a power-on test failure */
+static bool post_fail(MEM_POST_T *pPost, volatile uint32_t *addr, uint32_t ex_val)
+{
+	pPost->fail_addr = (uint32_t *) addr;
+	if (addr != NULL) {
+		pPost->is_val = *addr;
+		pPost->ex_val = ex_val;
+	}
+	pPost->status = MEM_POST_FAILED;
+
+	return false;
+}
+
+/* Walking 1 on the first word, then one word at each power of 2 offset:
+   a stuck or shorted address line makes two of them alias */
+static bool post_lines(MEM_POST_T *pPost)
+{
+	volatile uint32_t *base = pPost->start_addr;
+	uint32_t words = pPost->bytes / 4, offs, test, bit;
+
+	for (bit = 0; bit < 32; bit++) {
+		base[0] = 1UL << bit;
+		if (base[0] != (1UL << bit)) {
+			return post_fail(pPost, base, 1UL << bit);
+		}
+	}
+
+	for (offs = 1; offs < words; offs <<= 1) {
+		base[offs] = 0xAAAAAAAA;
+	}
+	base[0] = 0x55555555;
+	for (offs = 1; offs < words; offs <<= 1) {
+		if (base[offs] != 0xAAAAAAAA) {
+			return post_fail(pPost, &base[offs], 0xAAAAAAAA);
+		}
+	}
+	base[0] = 0xAAAAAAAA;
+
+	for (test = 1; test < words; test <<= 1) {
+		base[test] = 0x55555555;
+		if (base[0] != 0xAAAAAAAA) {
+			return post_fail(pPost, base, 0xAAAAAAAA);
+		}
+		for (offs = 1; offs < words; offs <<= 1) {
+			if ((offs != test) && (base[offs] != 0xAAAAAAAA)) {
+				return post_fail(pPost, &base[offs], 0xAAAAAAAA);
+			}
+		}
+		base[test] = 0xAAAAAAAA;
+	}
+
+	return true;
+}
+
+/* Queues the GPDMA fill of the chunk under test for the current pass */
+static bool post_fill(MEM_POST_T *pPost)
+{
+	uint32_t chunk = pPost->bytes - pPost->offs;
+
+	if (chunk > MEM_POST_CHUNK_BYTES) {
+		chunk = MEM_POST_CHUNK_BYTES;
+	}
+	pPost->verified = 0;
+	pPost->filling = true;
+	if (Chip_GPDMA_MemsetAsync(LPC_GPDMA, pPost->dma_channel, &postJob,
+							   pPost->start_addr + (pPost->offs / 4),
+							   pPost->pass ? 0xAA : 0x55, chunk, NULL) != SUCCESS) {
+		return post_fail(pPost, NULL, 0);
+	}
+
+	return true;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -292,3 +521,211 @@ bool mem_test_pattern_seed(MEM_TEST_SETUP_T *pMemSetup, uint32_t seed, uint32_t
 
 	return true;
 }
+
+/* Memory bandwidth and latency benchmark */
+bool mem_bench_run(MEM_BENCH_SETUP_T *pBench)
+{
+	uint32_t moved, cycles, start, primask;
+	volatile uint32_t sink;
+
+	pBench->read_kbs = pBench->write_kbs = pBench->copy_kbs = 0;
+	pBench->dma_copy_kbs = pBench->latency_cyc10 = 0;
+
+	/* Must be 32-bit aligned, a power of 2 and hold 2 copy bursts */
+	if ((((uint32_t) pBench->start_addr & 0x3) != 0) || (pBench->bytes < 64) ||
+		((pBench->bytes & (pBench->bytes - 1)) != 0)) {
+		return false;
+	}
+
+	/* Core cycle counter */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	cycles = bench_cpu(pBench, 0, &moved);
+	pBench->read_kbs = bench_kbs(moved, cycles);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	start = DWT->CYCCNT;
+	sink = bench_random(pBench->start_addr, pBench->bytes / 4, MEM_BENCH_READS);
+	cycles = DWT->CYCCNT - start;
+	__set_PRIMASK(primask);
+	(void) sink;
+	pBench->latency_cyc10 = (cycles * 10) / MEM_BENCH_READS;
+
+	if (pBench->read_only) {
+		return true;
+	}
+
+	cycles = bench_cpu(pBench, 1, &moved);
+	pBench->write_kbs = bench_kbs(moved, cycles);
+
+	cycles = bench_cpu(pBench, 2, &moved);
+	pBench->copy_kbs = bench_kbs(moved, cycles);
+
+	if (pBench->dma_channel < GPDMA_NUMBER_CHANNELS) {
+		if (!bench_dma(pBench, &moved, &cycles)) {
+			return false;
+		}
+		pBench->dma_copy_kbs = bench_kbs(moved, cycles);
+	}
+
+	return true;
+}
+
+/* Memory bus contention benchmark */
+bool mem_bench_contention(MEM_CONTEND_SETUP_T *pContend)
+{
+	static GPDMA_JOB_T job;
+	uint32_t moved, dmaMoved, cycles, start, primask, offs;
+	volatile uint32_t sink = 0;
+	bool error = false;
+
+	pContend->cpu_kbs = pContend->cpu_dma_kbs = pContend->dma_kbs = 0;
+
+	if ((((uint32_t) pContend->cpu_addr & 0x3) != 0) || (pContend->cpu_bytes == 0) ||
+		((pContend->cpu_bytes % MEM_CONTEND_CHUNK) != 0) ||
+		(((uint32_t) pContend->dma_addr & 0x3) != 0) || (pContend->dma_bytes == 0) ||
+		((pContend->dma_bytes & 0x1F) != 0) || (pContend->dma_channel >= GPDMA_NUMBER_CHANNELS)) {
+		return false;
+	}
+
+	/* Core cycle counter */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* CPU alone */
+	moved = 0;
+	start = DWT->CYCCNT;
+	while (moved < MEM_BENCH_BYTES) {
+		sink += bench_read(pContend->cpu_addr, pContend->cpu_bytes);
+		moved += pContend->cpu_bytes;
+	}
+	cycles = DWT->CYCCNT - start;
+	pContend->cpu_kbs = bench_kbs(moved, cycles);
+
+	/* CPU with the GPDMA kept busy, checked after each chunk */
+	moved = dmaMoved = offs = 0;
+	bench_contend_dma(pContend, &job, &error);
+	start = DWT->CYCCNT;
+	while ((moved < MEM_BENCH_BYTES) && !error) {
+		sink += bench_read(pContend->cpu_addr + (offs / 4), MEM_CONTEND_CHUNK);
+		moved += MEM_CONTEND_CHUNK;
+		offs += MEM_CONTEND_CHUNK;
+		if (offs >= pContend->cpu_bytes) {
+			offs = 0;
+		}
+		dmaMoved += bench_contend_dma(pContend, &job, &error);
+	}
+	cycles = DWT->CYCCNT - start;
+	pContend->cpu_dma_kbs = bench_kbs(moved, cycles);
+
+	/* Only completed copies count, the last one is waited for */
+	while (Chip_GPDMA_IsJobPending(LPC_GPDMA, pContend->dma_channel)) {
+		Chip_GPDMA_JobIRQHandler(LPC_GPDMA);
+	}
+	pContend->dma_kbs = bench_kbs(dmaMoved, cycles);
+
+	__set_PRIMASK(primask);
+	(void) sink;
+
+	return !error;
+}
+
+/* Start the fast power-on memory test */
+bool mem_post_start(MEM_POST_T *pPost)
+{
+	pPost->tested_bytes = pPost->offs = 0;
+	pPost->pass = 0;
+	pPost->filling = false;
+	pPost->status = MEM_POST_FAILED;
+
+	if ((((uint32_t) pPost->start_addr & 0x3) != 0) || (pPost->bytes < 4) ||
+		((pPost->bytes & 0x3) != 0) || (pPost->dma_channel >= GPDMA_NUMBER_CHANNELS)) {
+		return false;
+	}
+
+	pPost->status = MEM_POST_RUNNING;
+	if (!post_lines(pPost)) {
+		return false;
+	}
+
+	return post_fill(pPost);
+}
+
+/* Advance the fast power-on memory test */
+MEM_POST_STATUS_T mem_post_step(MEM_POST_T *pPost)
+{
+	const volatile uint32_t *addr;
+	uint32_t chunk, bytes, expect;
+
+	if (pPost->status != MEM_POST_RUNNING) {
+		return pPost->status;
+	}
+
+	if (pPost->filling) {
+		if (!pPost->dma_irq) {
+			Chip_GPDMA_JobIRQHandler(LPC_GPDMA);
+		}
+		if (Chip_GPDMA_IsJobPending(LPC_GPDMA, pPost->dma_channel)) {
+			return MEM_POST_RUNNING;
+		}
+		pPost->filling = false;
+	}
+
+	chunk = pPost->bytes - pPost->offs;
+	if (chunk > MEM_POST_CHUNK_BYTES) {
+		chunk = MEM_POST_CHUNK_BYTES;
+	}
+	bytes = chunk - pPost->verified;
+	if (bytes > MEM_POST_VERIFY_BYTES) {
+		bytes = MEM_POST_VERIFY_BYTES;
+	}
+
+	/* Compare a slice of the chunk with the fill pattern */
+	expect = pPost->pass ? 0xAAAAAAAA : 0x55555555;
+	addr = pPost->start_addr + ((pPost->offs + pPost->verified) / 4);
+	pPost->verified += bytes;
+	while (bytes > 0) {
+		if (*addr != expect) {
+			post_fail(pPost, (volatile uint32_t *) addr, expect);
+			return MEM_POST_FAILED;
+		}
+		addr++;
+		bytes -= 4;
+	}
+	if (pPost->verified < chunk) {
+		return MEM_POST_RUNNING;
+	}
+
+	/* Chunk done with both patterns, on to the next one */
+	if (pPost->pass == 0) {
+		pPost->pass = 1;
+	}
+	else {
+		pPost->pass = 0;
+		pPost->offs += chunk;
+		pPost->tested_bytes = pPost->offs;
+		if (pPost->offs >= pPost->bytes) {
+			pPost->status = MEM_POST_PASSED;
+			return MEM_POST_PASSED;
+		}
+	}
+	post_fill(pPost);
+
+	return pPost->status;
+}
+
+/* Fast power-on memory test progress */
+uint32_t mem_post_progress(const MEM_POST_T *pPost)
+{
+	if (pPost->status == MEM_POST_PASSED) {
+		return 100;
+	}
+
+	/* In KB so an SDRAM size times 100 cannot overflow */
+	return (pPost->tested_bytes / 1024) * 100 / ((pPost->bytes / 1024) + 1);
+}
@@ -109,6 +109,151 @@ bool mem_test_pattern(MEM_TEST_SETUP_T *pMemSetup);
  */
 bool mem_test_pattern_seed(MEM_TEST_SETUP_T *pMemSetup, uint32_t seed, uint32_t incr);
 
+/* Bytes each benchmark pass moves, the region is cycled through as needed */
+#ifndef MEM_BENCH_BYTES
+#define MEM_BENCH_BYTES (256 * 1024)
+#endif
+
+/* Number of random reads timed for the latency figure */
+#ifndef MEM_BENCH_READS
+#define MEM_BENCH_READS 4096
+#endif
+
+/**
+ * @brief Memory benchmark region and result structure
+ */
+typedef struct {
+	uint32_t *start_addr;	/*!< Starting address of the region, 32-bit aligned */
+	uint32_t bytes;			/*!< Size in bytes of the region, a power of 2 of at least 64 */
+	bool read_only;			/*!< Only run the read and latency tests (flash, SPIFI) */
+	uint8_t dma_channel;	/*!< GPDMA channel for the DMA copy, or GPDMA_NO_CHANNEL to skip it */
+	uint32_t read_kbs;		/*!< CPU sequential read bandwidth in KB/s (returned) */
+	uint32_t write_kbs;		/*!< CPU sequential write bandwidth in KB/s (returned) */
+	uint32_t copy_kbs;		/*!< CPU copy bandwidth in KB/s, bytes copied (returned) */
+	uint32_t dma_copy_kbs;	/*!< GPDMA copy bandwidth in KB/s, bytes copied (returned) */
+	uint32_t latency_cyc10;	/*!< Random read cost in tenths of core clocks (returned) */
+} MEM_BENCH_SETUP_T;
+
+/**
+ * @brief	Memory bandwidth and latency benchmark
+ * @param	pBench	: Benchmark setup (and returned results)
+ * @return	true if the benchmark ran, or false on an invalid setup or DMA error
+ * @note	Timed with the DWT cycle counter against SystemCoreClock, with
+ * interrupts disabled around each CPU pass. Copies move the lower half of
+ * the region into the upper half, so a writable region is overwritten.
+ * Results not measured (read only regions, no DMA channel) are 0. The DMA
+ * copy polls Chip_GPDMA_JobIRQHandler(), so the GPDMA must be initialized
+ * and the DMA interrupt left disabled while this runs. The random read
+ * figure includes the couple of clocks needed to step the address.
+ */
+bool mem_bench_run(MEM_BENCH_SETUP_T *pBench);
+
+/* Bytes the CPU reads between two checks of the DMA job in the contention
+   benchmark, small enough that the GPDMA is rarely left idle */
+#ifndef MEM_CONTEND_CHUNK
+#define MEM_CONTEND_CHUNK 1024
+#endif
+
+/**
+ * @brief Memory bus contention benchmark setup and result structure
+ */
+typedef struct {
+	uint32_t *cpu_addr;		/*!< Region the CPU reads, 32-bit aligned */
+	uint32_t cpu_bytes;		/*!< Size in bytes of the CPU region, a multiple of MEM_CONTEND_CHUNK */
+	uint32_t *dma_addr;		/*!< Region the GPDMA copies within, 32-bit aligned */
+	uint32_t dma_bytes;		/*!< Size in bytes of the DMA region, a multiple of 32 */
+	uint8_t dma_channel;	/*!< GPDMA channel for the copies */
+	uint32_t cpu_kbs;		/*!< CPU sequential read bandwidth in KB/s, DMA idle (returned) */
+	uint32_t cpu_dma_kbs;	/*!< CPU sequential read bandwidth in KB/s, DMA running (returned) */
+	uint32_t dma_kbs;		/*!< GPDMA copy bandwidth in KB/s while the CPU reads (returned) */
+} MEM_CONTEND_SETUP_T;
+
+/**
+ * @brief	Memory bus contention benchmark
+ * @param	pContend	: Benchmark setup (and returned results)
+ * @return	true if the benchmark ran, or false on an invalid setup or DMA error
+ * @note	Times the CPU reading its region alone, then again while the
+ * GPDMA keeps copying the lower half of the DMA region into the upper
+ * half. Comparing cpu_kbs and cpu_dma_kbs shows how much DMA traffic in
+ * one memory costs the CPU in another, or in the same one, so DMA buffers
+ * can be placed in a bank the CPU's data doesn't use. The DMA region is
+ * overwritten and must not overlap the CPU region. The same GPDMA rules as
+ * for mem_bench_run() apply.
+ */
+bool mem_bench_contention(MEM_CONTEND_SETUP_T *pContend);
+
+/* Bytes filled by one GPDMA job, the region is tested a chunk at a time */
+#ifndef MEM_POST_CHUNK_BYTES
+#define MEM_POST_CHUNK_BYTES (64 * 1024)
+#endif
+
+/* Bytes the CPU verifies in one mem_post_step() call */
+#ifndef MEM_POST_VERIFY_BYTES
+#define MEM_POST_VERIFY_BYTES 4096
+#endif
+
+/**
+ * @brief Fast power-on test state
+ */
+typedef enum {
+	MEM_POST_RUNNING,		/*!< Chunks left, keep calling mem_post_step() */
+	MEM_POST_PASSED,		/*!< Whole region tested */
+	MEM_POST_FAILED			/*!< Failed, see fail_addr */
+} MEM_POST_STATUS_T;
+
+/**
+ * @brief Fast power-on test setup, progress and result structure
+ */
+typedef struct {
+	uint32_t *start_addr;		/*!< Starting address of the region, 32-bit aligned */
+	uint32_t bytes;				/*!< Size in bytes of the region, a multiple of 4 */
+	uint8_t dma_channel;		/*!< GPDMA channel for the fills */
+	bool dma_irq;				/*!< DMA_IRQHandler() calls Chip_GPDMA_JobIRQHandler(), else it is polled */
+	MEM_POST_STATUS_T status;	/*!< Test state (returned) */
+	uint32_t tested_bytes;		/*!< Bytes verified with both patterns (returned) */
+	uint32_t *fail_addr;		/*!< Failed address, NULL on a DMA error (returned only if failed) */
+	uint32_t is_val;			/*!< Failed value of test (returned only if failed) */
+	uint32_t ex_val;			/*!< Expected value of test (returned only if failed) */
+	uint32_t offs;				/*!< Driver use: offset of the chunk under test */
+	uint32_t verified;			/*!< Driver use: bytes of the chunk verified in this pass */
+	uint8_t pass;				/*!< Driver use: 0 for the 0x55 fill, 1 for 0xAA */
+	bool filling;				/*!< Driver use: fill of the chunk in progress */
+} MEM_POST_T;
+
+/**
+ * @brief	Start the fast power-on memory test of a region
+ * @param	pPost	: Test setup (and returned results)
+ * @return	true if the test is under way, or false on an invalid setup,
+ * a data or address line fault or a DMA error
+ * @note	The data lines (walking 1 on the first word) and the address
+ * lines (one word at each power of 2 offset, checked for aliasing) are
+ * tested by the CPU before returning, which takes a few hundred accesses.
+ * The cells are then tested chunk by chunk from mem_post_step(): the GPDMA
+ * fills a chunk with 0x55 bytes while the CPU is free, the CPU verifies
+ * it, and the same again with 0xAA, so every bit is seen at 0 and at 1.
+ * The region is overwritten and must not be used until the test is over;
+ * chunks below tested_bytes are done with and may be used early. The GPDMA
+ * must be initialized with Chip_GPDMA_JobInit(). One test runs at a time.
+ */
+bool mem_post_start(MEM_POST_T *pPost);
+
+/**
+ * @brief	Advance the fast power-on memory test
+ * @param	pPost	: Test started with mem_post_start()
+ * @return	Test state, also in pPost->status
+ * @note	Never waits for the GPDMA, and verifies at most
+ * MEM_POST_VERIFY_BYTES per call, so it can run from the main loop or
+ * an idle task while the application starts up.
+ */
+MEM_POST_STATUS_T mem_post_step(MEM_POST_T *pPost);
+
+/**
+ * @brief	Fast power-on memory test progress
+ * @param	pPost	: Test started with mem_post_start()
+ * @return	Percentage of the region tested, 0 to 100
+ */
+uint32_t mem_post_progress(const MEM_POST_T *pPost);
+
 /**
  * @}
  */
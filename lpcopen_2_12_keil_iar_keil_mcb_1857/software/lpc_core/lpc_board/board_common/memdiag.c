@@ -0,0 +1,257 @@
+/*
+ * @brief    Memory usage diagnostics
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "board.h"
+#include "memdiag.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* One registered entry */
+typedef struct {
+	const char *name;
+	MEMDIAG_USED_T used;
+	void *ctx;
+	uint32_t addr;
+	uint32_t size;
+	uint8_t kind;
+	uint8_t region;
+} MEMDIAG_ENTRY_T;
+
+/* Address ranges of the regions, sized for the largest LPC43xx parts */
+static const struct {
+	const char *name;
+	uint32_t start;
+	uint32_t end;
+} diagRegions[MEMDIAG_NUM_REGIONS] = {
+	{"local0", 0x10000000, 0x10020000},
+	{"local1", 0x10080000, 0x10092000},
+	{"ahb",    0x20000000, 0x20010000},
+	{"sdram",  0x28000000, 0x30000000},
+	{"other",  0, 0}
+};
+
+static MEMDIAG_ENTRY_T diagTable[MEMDIAG_MAX_ENTRIES];
+static int diagCount;
+
+static char diagLine[96];
+
+#if defined(__ICCARM__)
+#pragma section = "CSTACK"
+#endif
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Region holding an address */
+static MEMDIAG_REGION_T diagRegionOf(uint32_t addr)
+{
+	int i;
+
+	for (i = 0; i < MEMDIAG_REGION_OTHER; i++) {
+		if ((addr >= diagRegions[i].start) && (addr < diagRegions[i].end)) {
+			return (MEMDIAG_REGION_T) i;
+		}
+	}
+
+	return MEMDIAG_REGION_OTHER;
+}
+
+/* Prints the line buffer */
+static void diagPutLine(MEMDIAG_PUTS_T puts)
+{
+	if (puts) {
+		puts(diagLine);
+	}
+	else {
+		DEBUGSTR((char *) diagLine);
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Empty the table and register the painted main stack */
+void MemDiag_Init(void)
+{
+	uint32_t base, size;
+
+	diagCount = 0;
+
+#if defined(__ICCARM__)
+	base = (uint32_t) __section_begin("CSTACK");
+	size = (uint32_t) __section_end("CSTACK") - base;
+#else
+	/* the initial stack pointer is the first word of the vector table */
+	size = MEMDIAG_MSP_SIZE;
+	base = *((volatile uint32_t *) SCB->VTOR) - size;
+#endif
+	MemDiag_AddStack("msp", (void *) base, size);
+}
+
+/* Register an entry */
+int MemDiag_Add(const char *name, MEMDIAG_KIND_T kind, const void *addr, uint32_t size,
+				MEMDIAG_USED_T used, void *ctx)
+{
+	MEMDIAG_ENTRY_T *pEntry;
+
+	if (diagCount >= MEMDIAG_MAX_ENTRIES) {
+		return -1;
+	}
+	pEntry = &diagTable[diagCount];
+	pEntry->name = name;
+	pEntry->used = used;
+	pEntry->ctx = ctx;
+	pEntry->addr = (uint32_t) addr;
+	pEntry->size = size;
+	pEntry->kind = (uint8_t) kind;
+	pEntry->region = (uint8_t) ((addr != NULL) ? diagRegionOf((uint32_t) addr) : MEMDIAG_REGION_OTHER);
+
+	if ((kind == MEMDIAG_STACK) && (used == NULL)) {
+		MemDiag_PaintStack((void *) addr, size);
+	}
+
+	return diagCount++;
+}
+
+/* Paint a stack, stopping short of the stack pointer */
+void MemDiag_PaintStack(void *base, uint32_t size)
+{
+	uint32_t here = (uint32_t) &size;
+	uint32_t *p = (uint32_t *) (((uint32_t) base + 3) & ~3);
+	uint32_t *end = (uint32_t *) (((uint32_t) base + size) & ~3);
+
+	/* a local of this call marks how deep the live stack is */
+	if ((here >= (uint32_t) p) && (here < (uint32_t) end)) {
+		end = (here > ((uint32_t) p + MEMDIAG_PAINT_GUARD)) ?
+			  (uint32_t *) ((here - MEMDIAG_PAINT_GUARD) & ~3) : p;
+	}
+	while (p < end) {
+		*p++ = MEMDIAG_STACK_FILL;
+	}
+}
+
+/* Deepest overwritten word of a painted stack */
+uint32_t MemDiag_StackUsed(const void *base, uint32_t size)
+{
+	const uint32_t *p = (const uint32_t *) (((uint32_t) base + 3) & ~3);
+	const uint32_t *end = (const uint32_t *) (((uint32_t) base + size) & ~3);
+
+	/* stacks grow down, the paint left intact sits at the bottom */
+	while ((p < end) && (*p == MEMDIAG_STACK_FILL)) {
+		p++;
+	}
+
+	return ((uint32_t) base + size) - (uint32_t) p;
+}
+
+/* Return the number of registered entries */
+int MemDiag_GetCount(void)
+{
+	return diagCount;
+}
+
+/* Read an entry */
+bool MemDiag_Get(int index, MEMDIAG_INFO_T *pInfo)
+{
+	const MEMDIAG_ENTRY_T *pEntry;
+
+	if ((index < 0) || (index >= diagCount)) {
+		return false;
+	}
+	pEntry = &diagTable[index];
+	pInfo->name = pEntry->name;
+	pInfo->kind = (MEMDIAG_KIND_T) pEntry->kind;
+	pInfo->region = (MEMDIAG_REGION_T) pEntry->region;
+	pInfo->addr = pEntry->addr;
+	pInfo->size = pEntry->size;
+	if (pEntry->used != NULL) {
+		pInfo->used = pEntry->used(pEntry->ctx);
+	}
+	else if (pEntry->kind == MEMDIAG_STACK) {
+		pInfo->used = MemDiag_StackUsed((const void *) pEntry->addr, pEntry->size);
+	}
+	else {
+		pInfo->used = pEntry->size;
+	}
+
+	return true;
+}
+
+/* Return the name of a region */
+const char *MemDiag_RegionName(MEMDIAG_REGION_T region)
+{
+	return diagRegions[(region < MEMDIAG_NUM_REGIONS) ? region : MEMDIAG_REGION_OTHER].name;
+}
+
+/* Print all entries and the per region totals */
+void MemDiag_Report(MEMDIAG_PUTS_T puts)
+{
+	static const char *const kindNames[] = {"static", "pool", "stack"};
+	uint32_t regSize[MEMDIAG_NUM_REGIONS], regUsed[MEMDIAG_NUM_REGIONS];
+	MEMDIAG_INFO_T info;
+	int i;
+
+	memset(regSize, 0, sizeof(regSize));
+	memset(regUsed, 0, sizeof(regUsed));
+
+	sprintf(diagLine, "%-12s %-6s %-6s %-10s %8s %8s %4s\r\n", "name", "kind", "region", "addr",
+			"size", "used", "%");
+	diagPutLine(puts);
+	for (i = 0; MemDiag_Get(i, &info); i++) {
+		sprintf(diagLine, "%-12s %-6s %-6s 0x%08lx %8lu %8lu %4lu\r\n", info.name, kindNames[info.kind],
+				MemDiag_RegionName(info.region), (unsigned long) info.addr, (unsigned long) info.size,
+				(unsigned long) info.used,
+				(unsigned long) ((info.size != 0) ? (((uint64_t) info.used * 100) / info.size) : 0));
+		diagPutLine(puts);
+		regSize[info.region] += info.size;
+		regUsed[info.region] += info.used;
+	}
+
+	/* what shrinking every entry to its high-water mark would give back */
+	for (i = 0; i < MEMDIAG_NUM_REGIONS; i++) {
+		if (regSize[i] != 0) {
+			sprintf(diagLine, "region %-6s set aside %8lu used %8lu spare %8lu\r\n", diagRegions[i].name,
+					(unsigned long) regSize[i], (unsigned long) regUsed[i],
+					(unsigned long) ((regSize[i] > regUsed[i]) ? (regSize[i] - regUsed[i]) : 0));
+			diagPutLine(puts);
+		}
+	}
+}
@@ -0,0 +1,200 @@
+/*
+ * @brief    Memory usage diagnostics
+ *           Reports static allocations, pool high-water marks and painted
+ *           stack depths per SRAM region.
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __MEMDIAG_H_
+#define __MEMDIAG_H_
+
+#include "lpc_types.h"
+
+/** @defgroup BOARD_MemDiag BOARD: Memory usage diagnostics
+ * @ingroup BOARD_Common
+ * Keeps a table of the memory an application has set aside and how much
+ * of it is really used, so that buffers can be sized from measurements:
+ * - static allocations (buffers, rings, DMA descriptors), counted in full
+ *   against the SRAM region that holds them,
+ * - pools and heaps (USB RAM arena, lwIP pools, RTOS task stacks) whose
+ *   high-water mark is read through a callback when the table is reported,
+ * - stacks that are painted with MEMDIAG_STACK_FILL and scanned for the
+ *   deepest word overwritten since, the main stack (MSP) included.
+ *
+ * MemDiag_Report() prints the table and the per-region totals through a
+ * string callback, DEBUGSTR() by default. MemDiag_Get() returns one entry
+ * at a time for a binary report, such as a HID feature report.
+ * @{
+ */
+
+/* Largest number of registered entries */
+#ifndef MEMDIAG_MAX_ENTRIES
+#define MEMDIAG_MAX_ENTRIES 24
+#endif
+
+/* Main stack size when the toolchain does not say; the Keil startup files
+   reserve Stack_Size (0x800) bytes. IAR takes the size of block CSTACK. */
+#ifndef MEMDIAG_MSP_SIZE
+#define MEMDIAG_MSP_SIZE    0x800
+#endif
+
+/* Stack paint word, the FreeRTOS stack fill byte so stacks painted by the
+   kernel scan the same way */
+#define MEMDIAG_STACK_FILL  0xA5A5A5A5
+
+/* Bytes below the stack pointer left unpainted when painting the live stack */
+#define MEMDIAG_PAINT_GUARD 64
+
+/**
+ * @brief Entry type
+ */
+typedef enum {
+	MEMDIAG_STATIC,		/*!< Fixed allocation, always fully used */
+	MEMDIAG_POOL,		/*!< Pool or heap, high-water mark from a callback */
+	MEMDIAG_STACK		/*!< Stack, high-water mark from a callback or from the paint */
+} MEMDIAG_KIND_T;
+
+/**
+ * @brief SRAM regions entries are counted against, by address
+ */
+typedef enum {
+	MEMDIAG_REGION_LOCAL0,	/*!< Local SRAM at 0x10000000 */
+	MEMDIAG_REGION_LOCAL1,	/*!< Local SRAM at 0x10080000 */
+	MEMDIAG_REGION_AHB,		/*!< AHB SRAM at 0x20000000 */
+	MEMDIAG_REGION_SDRAM,	/*!< External SDRAM at 0x28000000 */
+	MEMDIAG_REGION_OTHER,	/*!< Anything else, or no address given */
+	MEMDIAG_NUM_REGIONS
+} MEMDIAG_REGION_T;
+
+/**
+ * @brief High-water callback, returns the most bytes ever in use
+ */
+typedef uint32_t (*MEMDIAG_USED_T)(void *ctx);
+
+/**
+ * @brief Report output callback, writes a zero terminated string
+ */
+typedef void (*MEMDIAG_PUTS_T)(const char *str);
+
+/**
+ * @brief Entry as returned by MemDiag_Get()
+ */
+typedef struct {
+	const char *name;		/*!< Name given at registration */
+	MEMDIAG_KIND_T kind;	/*!< Entry type */
+	MEMDIAG_REGION_T region;/*!< Region holding the entry */
+	uint32_t addr;			/*!< Start address, 0 if not known */
+	uint32_t size;			/*!< Bytes set aside */
+	uint32_t used;			/*!< Most bytes ever in use */
+} MEMDIAG_INFO_T;
+
+/**
+ * @brief	Empty the table and register the painted main stack
+ * @return	Nothing
+ * @note	Call early in main(), the MSP below the caller's frame is painted
+ *			and everything deeper used before this call is not seen.
+ */
+void MemDiag_Init(void);
+
+/**
+ * @brief	Register an entry
+ * @param	name	: Constant name string, shown in the report
+ * @param	kind	: Entry type
+ * @param	addr	: Start address, or NULL if not known
+ * @param	size	: Bytes set aside
+ * @param	used	: High-water callback, or NULL
+ * @param	ctx		: Passed to @a used
+ * @return	Index of the entry, or -1 when the table is full
+ * @note	A MEMDIAG_STACK entry without a callback is painted here, up to
+ *			MEMDIAG_PAINT_GUARD bytes below the stack pointer when it is the
+ *			stack in use, and scanned when the entry is read.
+ */
+int MemDiag_Add(const char *name, MEMDIAG_KIND_T kind, const void *addr, uint32_t size,
+				MEMDIAG_USED_T used, void *ctx);
+
+/** Register a static allocation */
+#define MemDiag_AddStatic(name, addr, size) \
+	MemDiag_Add((name), MEMDIAG_STATIC, (addr), (size), NULL, NULL)
+
+/** Register a stack to paint and scan */
+#define MemDiag_AddStack(name, base, size) \
+	MemDiag_Add((name), MEMDIAG_STACK, (base), (size), NULL, NULL)
+
+/**
+ * @brief	Paint a stack with MEMDIAG_STACK_FILL
+ * @param	base	: Lowest address of the stack
+ * @param	size	: Size of the stack in bytes
+ * @return	Nothing
+ * @note	When the stack pointer is inside the stack, only the part more
+ *			than MEMDIAG_PAINT_GUARD bytes below it is painted.
+ */
+void MemDiag_PaintStack(void *base, uint32_t size);
+
+/**
+ * @brief	Return the deepest use of a painted stack
+ * @param	base	: Lowest address of the stack
+ * @param	size	: Size of the stack in bytes
+ * @return	Bytes from the top of the stack down to the deepest overwritten word
+ */
+uint32_t MemDiag_StackUsed(const void *base, uint32_t size);
+
+/**
+ * @brief	Return the number of registered entries
+ * @return	Number of entries
+ */
+int MemDiag_GetCount(void);
+
+/**
+ * @brief	Read an entry, calling its high-water callback or scanning its paint
+ * @param	index	: Entry index, 0 to MemDiag_GetCount() - 1
+ * @param	pInfo	: Pointer to the entry copy to fill
+ * @return	false if @a index is out of range
+ */
+bool MemDiag_Get(int index, MEMDIAG_INFO_T *pInfo);
+
+/**
+ * @brief	Return the name of a region
+ * @param	region	: Region
+ * @return	Short constant name, such as "ahb"
+ */
+const char *MemDiag_RegionName(MEMDIAG_REGION_T region);
+
+/**
+ * @brief	Print all entries and the bytes set aside and used per region
+ * @param	puts	: Output callback, or NULL for DEBUGSTR()
+ * @return	Nothing
+ * @note	Not for interrupt context, the callbacks and the scans run here.
+ */
+void MemDiag_Report(MEMDIAG_PUTS_T puts);
+
+/**
+ * @}
+ */
+
+#endif /* __MEMDIAG_H_ */
@@ -30,6 +30,7 @@
  */
 
 #include "board.h"
+#include "codec_regcache.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -64,6 +65,20 @@ static const uint8_t UDA_decimator_regs_dat[] = {
 	UDA1380_U8(UDA1380_REG_AGC_DEFAULT_VALUE)
 };
 
+/* Read-only interpolation filter status register */
+#define UDA_INTERFIL_STATUS    0x18
+
+/* Register cache of the UDA_TOTAL_REG control registers */
+static uint16_t uda_regs[UDA_TOTAL_REG];
+static uint32_t uda_regs_valid[CODEC_REGCACHE_WORDS(UDA_TOTAL_REG)];
+static uint32_t uda_regs_dirty[CODEC_REGCACHE_WORDS(UDA_TOTAL_REG)];
+static bool uda_reg_volatile(uint8_t reg);
+static int uda_reg_write_burst(uint8_t reg, const uint16_t *val, int cnt);
+static CODEC_REGCACHE_T uda_cache = {
+	uda_regs, uda_regs_valid, uda_regs_dirty, UDA_TOTAL_REG, false,
+	uda_reg_volatile, UDA1380_REG_Write, UDA1380_REG_Read, uda_reg_write_burst
+};
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -71,6 +86,26 @@ static const uint8_t UDA_decimator_regs_dat[] = {
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
+/* Status registers are not cached */
+static bool uda_reg_volatile(uint8_t reg)
+{
+	return reg == UDA_INTERFIL_STATUS;
+}
+
+/* Write a run of consecutive registers in one I2C transfer */
+static int uda_reg_write_burst(uint8_t reg, const uint16_t *val, int cnt)
+{
+	uint8_t buff[1 + (2 * CODEC_REGCACHE_BURST_MAX)];
+	int i;
+
+	buff[0] = reg;
+	for (i = 0; i < cnt; i++) {
+		buff[1 + (2 * i)] = val[i] >> 8;
+		buff[2 + (2 * i)] = val[i] & 0xFF;
+	}
+	return UDA1380_REG_WriteMult(buff, 1 + (2 * cnt));
+}
+
 /* Set the default values to the codec registers */
 static int Audio_Codec_SetDefaultValues(const uint8_t *values, int sz)
 {
@@ -94,13 +129,16 @@ void UDA1380_REG_Write(uint8_t reg, uint16_t val)
 	uint8_t dat[3];
 	dat[0] = reg; dat[1] = val >> 8; dat[2] = val & 0xFF;
 	Chip_I2C_MasterSend(UDA1380_I2C_BUS, I2CDEV_UDA1380_ADDR, dat, sizeof(dat));
+	Codec_RegCache_Store(&uda_cache, reg, val);
 }
 
 /* Read data from UDA register */
 uint16_t UDA1380_REG_Read(uint8_t reg) {
 	uint8_t rx_data[2];
 	if (Chip_I2C_MasterCmdRead(UDA1380_I2C_BUS, I2CDEV_UDA1380_ADDR, reg, rx_data, 2) == 2) {
-		return (rx_data[0] << 8) | rx_data[1];
+		uint16_t val = (rx_data[0] << 8) | rx_data[1];
+		Codec_RegCache_Store(&uda_cache, reg, val);
+		return val;
 	}
 	return 0;
 }
@@ -132,12 +170,39 @@ int UDA1380_REG_VerifyMult(uint8_t reg, const uint8_t *value, uint8_t *buff, int
 	return i == len;
 }
 
+/* Read a register through the register cache */
+uint16_t UDA1380_REG_ReadCached(uint8_t reg)
+{
+	return Codec_RegCache_Read(&uda_cache, reg);
+}
+
+/* Change bits of a register without reading the codec */
+void UDA1380_REG_Update(uint8_t reg, uint16_t mask, uint16_t val)
+{
+	Codec_RegCache_Update(&uda_cache, reg, mask, val);
+}
+
+/* Hold register updates until flushed */
+void UDA1380_REG_Batch(void)
+{
+	Codec_RegCache_Batch(&uda_cache);
+}
+
+/* Write all held register updates */
+int UDA1380_REG_Flush(void)
+{
+	return Codec_RegCache_Flush(&uda_cache);
+}
+
 /* UDA1380 initialize function */
 int UDA1380_Init(int input)
 {
 	I2C_EVENTHANDLER_T old = Chip_I2C_GetMasterEventHandler(UDA1380_I2C_BUS);
 	int ret;
 
+	/* The codec may have been reset, start with an empty register cache */
+	Codec_RegCache_Invalidate(&uda_cache);
+
 	/* Initialize I2C */
 	Board_I2C_Init(UDA1380_I2C_BUS);
 	Chip_I2C_Init(UDA1380_I2C_BUS);
@@ -173,5 +238,15 @@ int UDA1380_Init(int input)
 /* Write multiple registers in one go */
 int UDA1380_REG_WriteMult(const uint8_t *buff, int len)
 {
-	return Chip_I2C_MasterSend(UDA1380_I2C_BUS, I2CDEV_UDA1380_ADDR, buff, len) == len;
+	int i;
+
+	if (Chip_I2C_MasterSend(UDA1380_I2C_BUS, I2CDEV_UDA1380_ADDR, buff, len) != len) {
+		return 0;
+	}
+
+	/* Registers auto increment from buff[0] */
+	for (i = 1; (i + 1) < len; i += 2) {
+		Codec_RegCache_Store(&uda_cache, buff[0] + (i >> 1), (buff[i] << 8) | buff[i + 1]);
+	}
+	return 1;
 }
@@ -159,6 +159,40 @@ int UDA1380_REG_WriteMult(const uint8_t *buff, int len);
  */
 int UDA1380_REG_VerifyMult(uint8_t reg, const uint8_t *value, uint8_t *buff, int len);
 
+/**
+ * @brief	Read a UDA1380 register through the register cache
+ * @param	reg		: Register from which the value to be read
+ * @return	Returns the value of the register
+ * @note	Only the first read of a control register goes to the codec,
+ * status registers are always read from the codec.
+ */
+uint16_t UDA1380_REG_ReadCached(uint8_t reg);
+
+/**
+ * @brief	Change bits of a UDA1380 register
+ * @param	reg		: Register to be updated
+ * @param	mask	: Bits to be changed
+ * @param	val		: New value of the bits in @a mask
+ * @return	Nothing
+ * @note	The current value comes from the register cache, so no I2C read
+ * is done and the register is only written if its value changes.
+ */
+void UDA1380_REG_Update(uint8_t reg, uint16_t mask, uint16_t val);
+
+/**
+ * @brief	Hold UDA1380_REG_Update() writes until UDA1380_REG_Flush()
+ * @return	Nothing
+ */
+void UDA1380_REG_Batch(void);
+
+/**
+ * @brief	Write all held register changes to the UDA1380
+ * @return	1 on Success, 0 on failure
+ * @note	Consecutive registers are written in one I2C transfer where the
+ * codec supports it.
+ */
+int UDA1380_REG_Flush(void);
+
 /**
  * @brief	Initialize UDA1380 to its default state
  * @param	input	: Audio input source (Must be one of  #UDA1380_LINE_IN
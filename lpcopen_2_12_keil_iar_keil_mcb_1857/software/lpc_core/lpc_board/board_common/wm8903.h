@@ -240,6 +240,40 @@ int WM8903_REG_WriteMult(const uint8_t *buff, int len);
  */
 int WM8903_REG_VerifyMult(uint8_t reg, const uint8_t *value, uint8_t *buff, int len);
 
+/**
+ * @brief	Read a WM8903 register through the register cache
+ * @param	reg		: Register from which the value to be read
+ * @return	Returns the value of the register
+ * @note	Only the first read of a control register goes to the codec,
+ * status registers are always read from the codec.
+ */
+uint16_t WM8903_REG_ReadCached(uint8_t reg);
+
+/**
+ * @brief	Change bits of a WM8903 register
+ * @param	reg		: Register to be updated
+ * @param	mask	: Bits to be changed
+ * @param	val		: New value of the bits in @a mask
+ * @return	Nothing
+ * @note	The current value comes from the register cache, so no I2C read
+ * is done and the register is only written if its value changes.
+ */
+void WM8903_REG_Update(uint8_t reg, uint16_t mask, uint16_t val);
+
+/**
+ * @brief	Hold WM8903_REG_Update() writes until WM8903_REG_Flush()
+ * @return	Nothing
+ */
+void WM8903_REG_Batch(void);
+
+/**
+ * @brief	Write all held register changes to the WM8903
+ * @return	1 on Success, 0 on failure
+ * @note	Consecutive registers are written in one I2C transfer where the
+ * codec supports it.
+ */
+int WM8903_REG_Flush(void);
+
 /**
  * @brief	Initialize WM8903 to its default state
  * @param	input	: Audio input source (Must be one of  WM8903_LINE_IN
@@ -30,6 +30,7 @@
  */
 
 #include "board.h"
+#include "codec_regcache.h"
 #include "wm8904.h"
 
 /*****************************************************************************
@@ -135,6 +136,16 @@ const WM8904_Init_Seq_t g_wm8904_input_init[] = {
 
 };
 
+/* Register cache of the control registers below the interrupt status register */
+static uint16_t wm8904_regs[WM8904_INTERRUPT_STATUS];
+static uint32_t wm8904_regs_valid[CODEC_REGCACHE_WORDS(WM8904_INTERRUPT_STATUS)];
+static uint32_t wm8904_regs_dirty[CODEC_REGCACHE_WORDS(WM8904_INTERRUPT_STATUS)];
+static bool wm8904_reg_volatile(uint8_t reg);
+static CODEC_REGCACHE_T wm8904_cache = {
+	wm8904_regs, wm8904_regs_valid, wm8904_regs_dirty, WM8904_INTERRUPT_STATUS, false,
+	wm8904_reg_volatile, WM8904_REG_Write, WM8904_REG_Read, NULL
+};
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -143,6 +154,23 @@ int WM8904_MultiRegWrite(const WM8904_Init_Seq_t* seq, uint32_t cnt);
 /*****************************************************************************
  * Private functions
  ****************************************************************************/
+/* Status, self clearing and read back registers are not cached */
+static bool wm8904_reg_volatile(uint8_t reg)
+{
+	switch (reg) {
+	case WM8904_SW_RESET_AND_ID:
+	case WM8904_REVISION:
+	case WM8904_DC_SERVO_0:
+	case WM8904_DC_SERVO_1:
+	case WM8904_DC_SERVO_READBACK_0:
+	case WM8904_WRITE_SEQUENCER_4:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
 /* Set the default values to the codec registers */
 static int Audio_Codec_SetDefaultValues(const uint8_t *values, int sz)
 {
@@ -169,7 +197,9 @@ static int Audio_Codec_SetDefaultValues(const uint8_t *values, int sz)
 uint16_t WM8904_REG_Read(uint8_t reg) {
 	uint8_t rx_data[2];
 	if (Chip_I2C_MasterCmdRead(WM8904_I2C_BUS, I2CDEV_WM8904_ADDR, reg, rx_data, 2) == 2) {
-		return (rx_data[0] << 8) | rx_data[1];
+		uint16_t val = (rx_data[0] << 8) | rx_data[1];
+		Codec_RegCache_Store(&wm8904_cache, reg, val);
+		return val;
 	}
 	return 0;
 }
@@ -180,6 +210,13 @@ void WM8904_REG_Write(uint8_t reg, uint16_t val)
 	uint8_t dat[3];
 	dat[0] = reg; dat[1] = val >> 8; dat[2] = val & 0xFF;
 	Chip_I2C_MasterSend(WM8904_I2C_BUS, I2CDEV_WM8904_ADDR, dat, sizeof(dat));
+	if (reg == WM8904_SW_RESET_AND_ID) {
+		/* Software reset, all registers are back at their defaults */
+		Codec_RegCache_Invalidate(&wm8904_cache);
+	}
+	else {
+		Codec_RegCache_Store(&wm8904_cache, reg, val);
+	}
 }
 
 /* Write data to codec register and verify the value by reading it back */
@@ -209,12 +246,39 @@ int WM8904_REG_VerifyMult(uint8_t reg, const uint8_t *value, uint8_t *buff, int
 	return i == len;
 }
 
+/* Read a register through the register cache */
+uint16_t WM8904_REG_ReadCached(uint8_t reg)
+{
+	return Codec_RegCache_Read(&wm8904_cache, reg);
+}
+
+/* Change bits of a register without reading the codec */
+void WM8904_REG_Update(uint8_t reg, uint16_t mask, uint16_t val)
+{
+	Codec_RegCache_Update(&wm8904_cache, reg, mask, val);
+}
+
+/* Hold register updates until flushed */
+void WM8904_REG_Batch(void)
+{
+	Codec_RegCache_Batch(&wm8904_cache);
+}
+
+/* Write all held register updates */
+int WM8904_REG_Flush(void)
+{
+	return Codec_RegCache_Flush(&wm8904_cache);
+}
+
 /* WM8904 initialize function */
 int WM8904_Init(int input)
 {
 	I2C_EVENTHANDLER_T old = Chip_I2C_GetMasterEventHandler(WM8904_I2C_BUS);
 	int ret;
 
+	/* The codec may have been reset, start with an empty register cache */
+	Codec_RegCache_Invalidate(&wm8904_cache);
+
 	/* Initialize I2C */
 	Board_I2C_Init(WM8904_I2C_BUS);
 	Chip_I2C_Init(WM8904_I2C_BUS);
@@ -57,6 +57,37 @@ const int32_t ad_top = 3805;// 237;
 const int32_t ad_right = 360;
 const int32_t ad_bottom = 237;	// 3805;
 
+/* Touch service sampling states, each one an I2C transfer */
+typedef enum {
+	TOUCH_IDLE,			/* Not sampling */
+	TOUCH_READ_CTRL,	/* Reading TSC_CTRL for the pen state */
+	TOUCH_READ_FIFO,	/* Reading the number of FIFO samples */
+	TOUCH_READ_DATA,	/* Reading one FIFO sample */
+	TOUCH_CLEAR_INT		/* Clearing the interrupt status */
+} TOUCH_STATE_T;
+
+/* Latest touch position slot, one word written by the I2C interrupt */
+#define TOUCH_SLOT_X(v)     ((int16_t) ((v) & 0xFFF))
+#define TOUCH_SLOT_Y(v)     ((int16_t) (((v) >> 12) & 0xFFF))
+#define TOUCH_SLOT_VALID    (1UL << 30)
+#define TOUCH_SLOT_DOWN     (1UL << 31)
+
+static struct {
+	volatile TOUCH_STATE_T state;
+	volatile bool ready;		/* Board_Touch_Init() was called */
+	volatile bool retry;		/* The bus was busy, sample again */
+	I2C_XFER_T xfer;
+	uint8_t tx[2];
+	uint8_t rx[4];
+	uint8_t samples;			/* FIFO samples left to read */
+	uint8_t taps;				/* Samples in the median history */
+	int16_t histX[TOUCH_MEDIAN_TAPS];
+	int16_t histY[TOUCH_MEDIAN_TAPS];
+	int32_t iirX, iirY;			/* Filtered position, TOUCH_IIR_SHIFT fraction bits */
+	bool down;					/* Pen down seen by this sample */
+	volatile uint32_t slot;		/* Published position, see TOUCH_SLOT_* */
+} touch;
+
 const LCD_CONFIG_T MCB4300_LCD = {
 	8,						/*!< Horizontal back porch in clocks */
 	4,						/*!< Horizontal front porch in clocks */
@@ -77,6 +108,11 @@ const LCD_CONFIG_T MCB4300_LCD = {
 	0						/*!< Dual panel, 1 = dual panel display */
 };
 
+#if defined(BOARD_FAST_BOOT)
+/* Debug UART set up on first use and Board_Deferred_Init() done flags */
+static bool debugReady, deferredDone;
+#endif
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -205,6 +241,175 @@ static Status getTSCCoord(int16_t *x, int16_t *y)
 	return SUCCESS;
 }
 
+/* Scale raw STMPE811 coordinates to the panel */
+static void calibrateTouch(int16_t x, int16_t y, int16_t *pX, int16_t *pY)
+{
+	int16_t rng;
+
+	/* calibrate X */
+	rng = ad_right - ad_left;
+	if (rng < 0) {
+		rng = -rng;
+	}
+	x -= (ad_right < ad_left) ? ad_right : ad_left;
+	*pX = (x * C_GLCD_H_SIZE) / rng;
+	if (ad_left > ad_right) {
+		*pX = C_GLCD_H_SIZE - *pX;
+	}
+
+	/* calibrate Y */
+	rng = ad_bottom - ad_top;
+	if (rng < 0) {
+		rng = -rng;
+	}
+	y -= (ad_bottom < ad_top) ? ad_bottom : ad_top;
+	*pY = (y * C_GLCD_V_SIZE) / rng;
+	if (ad_top > ad_bottom) {
+		*pY = C_GLCD_V_SIZE - *pY;
+	}
+}
+
+/* Median of the raw samples in a history */
+static int16_t touchMedian(const int16_t *pHist, uint8_t taps)
+{
+	int16_t sorted[TOUCH_MEDIAN_TAPS], v;
+	int i, j;
+
+	for (i = 0; i < taps; i++) {
+		v = pHist[i];
+		for (j = i; (j > 0) && (sorted[j - 1] > v); j--) {
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = v;
+	}
+
+	return sorted[taps / 2];
+}
+
+/* Start the I2C transfer for a sampling state, register read or write */
+static void touchStart(TOUCH_STATE_T state, uint8_t reg, int rxSz)
+{
+	touch.state = state;
+	touch.tx[0] = reg;
+	touch.tx[1] = 0x1F;	/* Only written by TOUCH_CLEAR_INT */
+	touch.xfer.slaveAddr = TSC_I2C_ADDR;
+	touch.xfer.txBuff = touch.tx;
+	touch.xfer.txSz = (rxSz > 0) ? 1 : 2;
+	touch.xfer.rxBuff = touch.rx;
+	touch.xfer.rxSz = rxSz;
+	if (!Chip_I2C_MasterTransferStart(TSC_I2C_BUS, &touch.xfer)) {
+		/* A blocking transfer owns the bus, pick up again from the next
+		   Board_Touch_Sample() or Board_Touch_GetLatest() call */
+		touch.state = TOUCH_IDLE;
+		touch.retry = true;
+#if defined(TSC_INT_GPIO_PORT)
+		Chip_PININT_EnableIntLow(LPC_GPIO_PIN_INT, PININTCH(TSC_INT_PININT_INDEX));
+#endif
+	}
+}
+
+/* Filter one FIFO sample into the touch position */
+static void touchFilter(void)
+{
+	int16_t x, y;
+	int i;
+
+	x = (touch.rx[0] << 4) | ((touch.rx[1] & 0xF0) >> 4);
+	y = ((touch.rx[1] & 0x0F) << 8) | touch.rx[2];
+
+	/* Restart the filters on pen down */
+	if (touch.taps == 0) {
+		touch.iirX = x << TOUCH_IIR_SHIFT;
+		touch.iirY = y << TOUCH_IIR_SHIFT;
+	}
+
+	/* Median rejects single sample spikes, the IIR smooths the jitter */
+	if (touch.taps < TOUCH_MEDIAN_TAPS) {
+		touch.taps++;
+	}
+	for (i = touch.taps - 1; i > 0; i--) {
+		touch.histX[i] = touch.histX[i - 1];
+		touch.histY[i] = touch.histY[i - 1];
+	}
+	touch.histX[0] = x;
+	touch.histY[0] = y;
+	touch.iirX += touchMedian(touch.histX, touch.taps) - (touch.iirX >> TOUCH_IIR_SHIFT);
+	touch.iirY += touchMedian(touch.histY, touch.taps) - (touch.iirY >> TOUCH_IIR_SHIFT);
+}
+
+/* Publish the pen state and filtered position */
+static void touchPublish(void)
+{
+	int16_t x, y;
+
+	if (touch.down && (touch.taps > 0)) {
+		calibrateTouch((int16_t) (touch.iirX >> TOUCH_IIR_SHIFT), (int16_t) (touch.iirY >> TOUCH_IIR_SHIFT), &x, &y);
+		if (x < 0) {
+			x = 0;
+		}
+		if (y < 0) {
+			y = 0;
+		}
+		touch.slot = TOUCH_SLOT_DOWN | TOUCH_SLOT_VALID | (((uint32_t) y & 0xFFF) << 12) | ((uint32_t) x & 0xFFF);
+	}
+	else if (!touch.down) {
+		/* Keep the last position, as Board_GetTouchPos() does */
+		touch.slot &= ~TOUCH_SLOT_DOWN;
+	}
+}
+
+/* Advance the sampling state machine after a transfer finished */
+static void touchStep(void)
+{
+	bool ok = (touch.xfer.status == I2C_STATUS_DONE);
+
+	switch (touch.state) {
+	case TOUCH_READ_CTRL:
+		touch.down = ok && ((touch.rx[0] & (1 << 7)) != 0);
+		if (touch.down) {
+			touchStart(TOUCH_READ_FIFO, FIFO_SIZE, 1);
+		}
+		else {
+			touch.taps = 0;
+			touchPublish();
+			touchStart(TOUCH_CLEAR_INT, INT_STA, 0);
+		}
+		break;
+
+	case TOUCH_READ_FIFO:
+		touch.samples = ok ? MIN(touch.rx[0], TOUCH_MAX_FIFO_READS) : 0;
+		if (touch.samples > 0) {
+			touchStart(TOUCH_READ_DATA, DATA_XYZ, 4);
+		}
+		else {
+			touchStart(TOUCH_CLEAR_INT, INT_STA, 0);
+		}
+		break;
+
+	case TOUCH_READ_DATA:
+		if (ok) {
+			touchFilter();
+		}
+		if (ok && (--touch.samples > 0)) {
+			touchStart(TOUCH_READ_DATA, DATA_XYZ, 4);
+		}
+		else {
+			touchPublish();
+			touchStart(TOUCH_CLEAR_INT, INT_STA, 0);
+		}
+		break;
+
+	case TOUCH_CLEAR_INT:
+	default:
+		/* The INT output is released, wait for the next pen interrupt */
+		touch.state = TOUCH_IDLE;
+#if defined(TSC_INT_GPIO_PORT)
+		Chip_PININT_EnableIntLow(LPC_GPIO_PIN_INT, PININTCH(TSC_INT_PININT_INDEX));
+#endif
+		break;
+	}
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -235,12 +440,20 @@ void Board_Debug_Init(void)
 	/* Enable UART Transmit */
 	Chip_UART_TXEnable(DEBUG_UART);
 #endif
+#if defined(BOARD_FAST_BOOT)
+	debugReady = true;
+#endif
 }
 
 /* Sends a character on the UART */
 void Board_UARTPutChar(char ch)
 {
 #if defined(DEBUG_UART)
+#if defined(BOARD_FAST_BOOT)
+	if (!debugReady) {
+		Board_Debug_Init();
+	}
+#endif
 	/* Wait for space in FIFO */
 	while ((Chip_UART_ReadLineStatus(DEBUG_UART) & UART_LSR_THRE) == 0) {}
 	Chip_UART_SendByte(DEBUG_UART, (uint8_t) ch);
@@ -251,6 +464,11 @@ void Board_UARTPutChar(char ch)
 int Board_UARTGetChar(void)
 {
 #if defined(DEBUG_UART)
+#if defined(BOARD_FAST_BOOT)
+	if (!debugReady) {
+		Board_Debug_Init();
+	}
+#endif
 	if (Chip_UART_ReadLineStatus(DEBUG_UART) & UART_LSR_RDR) {
 		return (int) Chip_UART_ReadByte(DEBUG_UART);
 	}
@@ -321,23 +539,48 @@ void Board_ENET_GetMacADDR(uint8_t *mcaddr)
    board hardware */
 void Board_Init(void)
 {
-	/* Sets up DEBUG UART */
+#if !defined(BOARD_FAST_BOOT)
+	/* Sets up DEBUG UART, with BOARD_FAST_BOOT that is done on first use */
 	DEBUGINIT();
+#endif
 
 	/* Initializes GPIO */
 	Chip_GPIO_Init(LPC_GPIO_PORT);
 
-	/* Setup GPIOs for USB demos */
-	Chip_SCU_PinMuxSet(0x9, 5, (SCU_MODE_PULLUP | SCU_MODE_INBUFF_EN | SCU_MODE_FUNC2));			/* P9_5 USB1_VBUS_EN, USB1 VBus function */
-	Chip_SCU_PinMuxSet(0x2, 5, (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_FUNC2));	/* P2_5 USB1_VBUS, MUST CONFIGURE THIS SIGNAL FOR USB1 NORMAL OPERATION */
-	Chip_SCU_PinMuxSet(0x6, 3, (SCU_MODE_PULLUP | SCU_MODE_INBUFF_EN | SCU_MODE_FUNC1));			/* P6_3 USB0_PWR_EN, USB0 VBus function */
+	/* The USB power pins are part of the boot pin table (board_sysinit.c) */
 
 	/* Initialize LEDs */
 	Board_LED_Init();
+#if !defined(BOARD_FAST_BOOT)
+#if defined(USE_RMII)
+	Chip_ENET_RMIIEnable(LPC_ETHERNET);
+#else
+	Chip_ENET_MIIEnable(LPC_ETHERNET);
+#endif
+#endif
+	Board_BootMark(BOARD_BOOT_INIT);
+}
+
+/* Finishes the board set up left out by BOARD_FAST_BOOT */
+void Board_Deferred_Init(void)
+{
+#if defined(BOARD_FAST_BOOT)
+	if (deferredDone) {
+		return;
+	}
+	deferredDone = true;
+
+	/* The clock, SPIFI and USB power pins are already set, this only
+	   applies the system pin table */
+	Board_SetupMuxing();
+	Board_SetupExtMemory();
+	Board_BootMark(BOARD_BOOT_EXTMEM);
 #if defined(USE_RMII)
 	Chip_ENET_RMIIEnable(LPC_ETHERNET);
 #else
 	Chip_ENET_MIIEnable(LPC_ETHERNET);
+#endif
+	Board_BootMark(BOARD_BOOT_DEFERRED);
 #endif
 }
 
@@ -560,33 +803,13 @@ bool Board_GetTouchPos(int16_t *pX, int16_t *pY)
 /* Get touch screen position */
 bool Board_I2C_GetTouchPos(int16_t *pX, int16_t *pY)
 {
-	int16_t x, y, rng;
+	int16_t x, y;
 	if (detectTSCTouch()) {
 		getTSCCoord(&x, &y);
 		g_isPenDn = 1;
 		g_isNewPenDn = 1;
 
-		/* calibrate X */
-		rng = ad_right - ad_left;
-		if (rng < 0) {
-			rng = -rng;
-		}
-		x -= (ad_right < ad_left) ? ad_right : ad_left;
-		*pX = (x * C_GLCD_H_SIZE) / rng;
-		if (ad_left > ad_right) {
-			*pX = C_GLCD_H_SIZE - *pX;
-		}
-
-		/* calibrate Y */
-		rng = ad_bottom - ad_top;
-		if (rng < 0) {
-			rng = -rng;
-		}
-		y -= (ad_bottom < ad_top) ? ad_bottom : ad_top;
-		*pY = (y * C_GLCD_V_SIZE) / rng;
-		if (ad_top > ad_bottom) {
-			*pY = C_GLCD_V_SIZE - *pY;
-		}
+		calibrateTouch(x, y, pX, pY);
 	}
 	else {
 		g_isPenDn = 0;
@@ -605,6 +828,94 @@ bool Board_I2C_GetTouchPos(int16_t *pX, int16_t *pY)
 	return false;
 }
 
+/* Start the interrupt driven touch service */
+void Board_Touch_Init(void)
+{
+	Board_InitTouchController();
+
+	/* Drive INT, active low level, until the status is cleared */
+	Chip_I2C_SetMasterEventHandler(TSC_I2C_BUS, Chip_I2C_EventHandlerPolling);
+	writeTSCReg(INT_CTRL, 0x01);
+	Chip_I2C_SetMasterEventHandler(TSC_I2C_BUS, Chip_I2C_EventHandler);
+
+	touch.state = TOUCH_IDLE;
+	touch.retry = false;
+	touch.taps = 0;
+	touch.slot = 0;
+	touch.ready = true;
+
+#if defined(TSC_INT_GPIO_PORT)
+	Chip_GPIO_SetPinDIRInput(LPC_GPIO_PORT, TSC_INT_GPIO_PORT, TSC_INT_GPIO_PIN);
+	Chip_SCU_GPIOIntPinSel(TSC_INT_PININT_INDEX, TSC_INT_GPIO_PORT, TSC_INT_GPIO_PIN);
+	Chip_PININT_SetPinModeLevel(LPC_GPIO_PIN_INT, PININTCH(TSC_INT_PININT_INDEX));
+	Chip_PININT_EnableIntLow(LPC_GPIO_PIN_INT, PININTCH(TSC_INT_PININT_INDEX));
+	NVIC_ClearPendingIRQ((IRQn_Type) (PIN_INT0_IRQn + TSC_INT_PININT_INDEX));
+	NVIC_EnableIRQ((IRQn_Type) (PIN_INT0_IRQn + TSC_INT_PININT_INDEX));
+#endif
+
+	NVIC_EnableIRQ(I2C0_IRQn);
+}
+
+/* Start sampling the touch screen controller */
+void Board_Touch_Sample(void)
+{
+	uint32_t primask;
+	bool start;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	start = touch.ready && (touch.state == TOUCH_IDLE);
+	if (start) {
+		touch.state = TOUCH_READ_CTRL;
+		touch.retry = false;
+	}
+	__set_PRIMASK(primask);
+
+	if (start) {
+		touchStart(TOUCH_READ_CTRL, TSC_CTRL, 1);
+	}
+}
+
+/* Touch service pin interrupt handler */
+void Board_Touch_PinIRQHandler(void)
+{
+#if defined(TSC_INT_GPIO_PORT)
+	/* INT stays low until the sample clears it, so mask the level interrupt
+	   until then */
+	Chip_PININT_DisableIntLow(LPC_GPIO_PIN_INT, PININTCH(TSC_INT_PININT_INDEX));
+	Chip_PININT_ClearIntStatus(LPC_GPIO_PIN_INT, PININTCH(TSC_INT_PININT_INDEX));
+#endif
+	Board_Touch_Sample();
+}
+
+/* Touch service I2C interrupt handler */
+void Board_Touch_I2CIRQHandler(void)
+{
+	Chip_I2C_MasterStateHandler(TSC_I2C_BUS);
+
+	if ((touch.state != TOUCH_IDLE) && (touch.xfer.status != I2C_STATUS_BUSY)) {
+		Chip_I2C_MasterTransferFinish(TSC_I2C_BUS);
+		touchStep();
+	}
+}
+
+/* Get the latest filtered touch position */
+bool Board_Touch_GetLatest(int16_t *pX, int16_t *pY)
+{
+	uint32_t slot = touch.slot;
+
+	if (touch.retry) {
+		Board_Touch_Sample();
+	}
+
+	if (slot & TOUCH_SLOT_VALID) {
+		*pX = TOUCH_SLOT_X(slot);
+		*pY = TOUCH_SLOT_Y(slot);
+	}
+
+	return (slot & TOUCH_SLOT_DOWN) != 0;
+}
+
 /* Turn on LCD backlight */
 void Board_SetLCDBacklight(uint8_t Intensity)
 {
@@ -69,6 +69,22 @@ extern "C" {
 	Board_UARTPutSTR functions. */
 #define DEBUG_UART LPC_USART3
 
+/** Define BOARD_FAST_BOOT to bring up only the core clocks, the clock and
+    SPIFI pins and the USB pins, GPIO and LEDs before the application runs.
+	The rest of the pin muxing, the external memories and the Ethernet
+	interface wait for Board_Deferred_Init() and the debug UART is set up on
+	first use. Images that place code or data in external memory can't use
+	this option.
+ */
+//#define BOARD_FAST_BOOT
+
+/** Define BOARD_BOOT_PROFILE to timestamp the boot stages with the DWT cycle
+    counter, see Board_BootTimeUs(). The stamps are kept in the RTC general
+	purpose registers from BOARD_BOOT_REGFILE_INDEX up, so they survive the
+	C library start up code that runs between SystemInit and main.
+ */
+//#define BOARD_BOOT_PROFILE
+
 /**
  * @}
  */
@@ -163,6 +179,17 @@ extern const LCD_CONFIG_T MCB4300_LCD;
 #define TSC_SHIELD      0x59
 #define DATA_XYZ        0xD7
 
+/* Touch service: define TSC_INT_GPIO_PORT/TSC_INT_GPIO_PIN as the GPIO the
+   STMPE811 INT output (active low) is wired to and the service samples on
+   pen interrupts through pin interrupt TSC_INT_PININT_INDEX. Without them,
+   call Board_Touch_Sample() periodically instead. */
+#ifndef TSC_INT_PININT_INDEX
+#define TSC_INT_PININT_INDEX    1
+#endif
+#define TOUCH_MEDIAN_TAPS       3	/* Raw samples a median is taken over */
+#define TOUCH_IIR_SHIFT         2	/* IIR smoothing, new = old + (in - old) / 2^shift */
+#define TOUCH_MAX_FIFO_READS    8	/* FIFO samples read per pen interrupt */
+
 /**
  * @brief	Sets up board specific ADC interface
  * @return	Nothing
@@ -274,6 +301,50 @@ bool Board_GetTouchPos(int16_t *pX, int16_t *pY);
  */
 bool Board_I2C_GetTouchPos(int16_t *pX, int16_t *pY);
 
+/**
+ * @brief	Start the interrupt driven touch service
+ * @return	Nothing
+ * @note	Initializes the touch screen controller. Sampling runs from the
+ * I2C interrupt, which must call Board_Touch_I2CIRQHandler(), and is started
+ * by the pin interrupt (Board_Touch_PinIRQHandler()) or Board_Touch_Sample().
+ * Blocking transfers on #TSC_I2C_BUS must use the interrupt event handler.
+ */
+void Board_Touch_Init(void);
+
+/**
+ * @brief	Start sampling the touch screen controller
+ * @return	Nothing
+ * @note	Does nothing while a sample is in progress. Call periodically,
+ * for example from a timer interrupt, when the controller interrupt output
+ * is not connected.
+ */
+void Board_Touch_Sample(void);
+
+/**
+ * @brief	Touch service pin interrupt handler
+ * @return	Nothing
+ * @note	Call from the handler of pin interrupt #TSC_INT_PININT_INDEX.
+ */
+void Board_Touch_PinIRQHandler(void);
+
+/**
+ * @brief	Touch service I2C interrupt handler
+ * @return	Nothing
+ * @note	Call from the #TSC_I2C_BUS interrupt handler instead of
+ * Chip_I2C_MasterStateHandler(), which it calls for all transfers.
+ */
+void Board_Touch_I2CIRQHandler(void);
+
+/**
+ * @brief	Get the latest filtered touch position, without waiting
+ * @param	pX	: pointer to X position, kept when no position was published yet
+ * @param	pY	: pointer to Y position, kept when no position was published yet
+ * @return	true if the pen is down
+ * @note	The position is published by the touch service as one word, so
+ * this may be called from any context.
+ */
+bool Board_Touch_GetLatest(int16_t *pX, int16_t *pY);
+
 /**
  * @brief	Set LCD Backlight
  * @return	Nothing
@@ -319,6 +390,68 @@ void Board_Audio_Init(LPC_I2S_T *pI2S, int micIn);
  */
 void Board_DAC_Init(LPC_DAC_T *pDAC);
 
+/**
+ * @brief	Calibrates the SDRAM timings for this board and part
+ * @param	store	: true to save the result in EEPROM for later boots
+ * @return	true if tighter timings were found and applied, false if the
+ *			board defaults are kept
+ * @note	Sweeps the EMC read strategy and clock delay, then lowers the CAS
+ * latency, RAS (tRCD) latency and tRP while a fast pattern test keeps
+ * passing. A stored result is applied by Board_SetupExtMemory() at boot as
+ * long as the EMC clock is unchanged. The SDRAM contents are destroyed, so
+ * call it before anything lives in SDRAM; code and stack must not be there.
+ */
+bool Board_SDRAM_Calibrate(bool store);
+
+/**
+ * @brief Boot stages timestamped when BOARD_BOOT_PROFILE is defined
+ */
+typedef enum {
+	BOARD_BOOT_MUXING,		/*!< Pin muxing done */
+	BOARD_BOOT_CLOCKING,	/*!< Core and base clocks running */
+	BOARD_BOOT_EXTMEM,		/*!< External memories up */
+	BOARD_BOOT_INIT,		/*!< Board_Init() done */
+	BOARD_BOOT_DEFERRED,	/*!< Board_Deferred_Init() done */
+	BOARD_BOOT_APP,			/*!< Application marker, e.g. USB connect */
+	BOARD_BOOT_STAGES
+} BOARD_BOOT_STAGE_T;
+
+/** First RTC general purpose register used for the boot stamps */
+#ifndef BOARD_BOOT_REGFILE_INDEX
+#define BOARD_BOOT_REGFILE_INDEX (64 - BOARD_BOOT_STAGES)
+#endif
+
+/**
+ * @brief	Timestamps a boot stage
+ * @param	stage	: Stage that has just completed
+ * @return	Nothing
+ * @note	Does nothing unless BOARD_BOOT_PROFILE is defined. The board code
+ * marks all stages except BOARD_BOOT_APP, which the application marks when
+ * it is ready, for instance when the USB device connects.
+ */
+void Board_BootMark(BOARD_BOOT_STAGE_T stage);
+
+/**
+ * @brief	Returns the time from Board_SystemInit() to a boot stage
+ * @param	stage	: Boot stage
+ * @return	Time in microseconds, 0 if the stage wasn't reached or
+ *			BOARD_BOOT_PROFILE isn't defined
+ * @note	The cycles up to BOARD_BOOT_CLOCKING are counted at the IRC rate,
+ * so that stage is an upper bound, the later ones use SystemCoreClock.
+ */
+uint32_t Board_BootTimeUs(BOARD_BOOT_STAGE_T stage);
+
+/**
+ * @brief	Finishes the board set up left out by BOARD_FAST_BOOT
+ * @return	Nothing
+ * @note	Applies the remaining pin muxing, sets up the external memories
+ * and enables the Ethernet interface. Only the first call does something,
+ * and without BOARD_FAST_BOOT it does nothing since Board_SystemInit() and
+ * Board_Init() already did it all. Call it once the time critical part of
+ * the application (USB enumeration) is under way.
+ */
+void Board_Deferred_Init(void);
+
 /**
  * @}
  */
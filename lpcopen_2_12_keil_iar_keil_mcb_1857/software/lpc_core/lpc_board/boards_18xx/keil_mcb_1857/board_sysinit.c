@@ -24,7 +24,9 @@
  * this code.
  */
 
+#include <stddef.h>
 #include "board.h"
+#include "mem_tests.h"
 
 /* The System initialization code is called prior to the application and
    initializes the board for run-time operation. Board initialization
@@ -56,16 +58,26 @@ STATIC const struct CLK_BASE_STATES InitClkStates[] = {
 	{CLK_BASE_USB1, CLKIN_IDIVD, true, true}
 };
 
-/* SPIFI high speed pin mode setup */
-STATIC const PINMUX_GRP_T spifipinmuxing[] = {
+/* Pins needed before the clocks are switched and before USB connects:
+   SPIFI high speed pin mode setup and the USB power pins */
+STATIC const PINMUX_GRP_T bootpinmuxing[] = {
 	{0x3, 3,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},
 	{0x3, 4,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},
 	{0x3, 5,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},
 	{0x3, 6,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},
 	{0x3, 7,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},
-	{0x3, 8,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)}
+	{0x3, 8,  (SCU_PINIO_FAST | SCU_MODE_FUNC3)},
+	/* P9_5 USB1_VBUS_EN, USB1 VBus function */
+	{0x9, 5,  (SCU_MODE_PULLUP | SCU_MODE_INBUFF_EN | SCU_MODE_FUNC2)},
+	/* P2_5 USB1_VBUS, must be configured for USB1 normal operation */
+	{0x2, 5,  (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_FUNC2)},
+	/* P6_3 USB0_PWR_EN, USB0 VBus function */
+	{0x6, 3,  (SCU_MODE_PULLUP | SCU_MODE_INBUFF_EN | SCU_MODE_FUNC1)}
 };
 
+/* Every pin appears once with its final setting, the table is written in
+   a single pass. P1.4, P1.5, P1.6 and P6.6 are the SPIFI-speed EMC control
+   pins, PD.10 and PD.13 are LEDs rather than EMC signals. */
 STATIC const PINMUX_GRP_T pinmuxing[] = {
 	/* RMII pin group */
 	{0x1, 19,
@@ -197,18 +209,8 @@ STATIC const PINMUX_GRP_T pinmuxing[] = {
 	{0xA, 4,
 	 (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_HIGHSPEEDSLEW_EN | SCU_MODE_FUNC3)},
 	/* EMC control signals */
-	{0x1, 4,
-	 (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_HIGHSPEEDSLEW_EN | SCU_MODE_FUNC3)},
-	{0x6, 6,
-	 (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_HIGHSPEEDSLEW_EN | SCU_MODE_FUNC1)},
-	{0xD, 13,
-	 (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_HIGHSPEEDSLEW_EN | SCU_MODE_FUNC2)},
-	{0xD, 10,
-	 (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_HIGHSPEEDSLEW_EN | SCU_MODE_FUNC2)},
 	{0x6, 9,
 	 (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_HIGHSPEEDSLEW_EN | SCU_MODE_FUNC3)},
-	{0x1, 6,
-	 (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_HIGHSPEEDSLEW_EN | SCU_MODE_FUNC3)},
 	{0x6, 4,
 	 (SCU_MODE_INACT | SCU_MODE_INBUFF_EN | SCU_MODE_ZIF_DIS | SCU_MODE_HIGHSPEEDSLEW_EN | SCU_MODE_FUNC3)},
 	{0x6, 5,
@@ -324,6 +326,29 @@ STATIC const IP_EMC_DYN_CONFIG_T MT48LC4M32_config = {
 	}
 };
 
+/* SDRAM timings found by Board_SDRAM_Calibrate(), kept in the last EEPROM
+   page and applied over MT48LC4M32_config at boot when the EMC clock still
+   matches */
+#ifndef BOARD_SDRAM_TUNE_PAGE
+#define BOARD_SDRAM_TUNE_PAGE (EEPROM_PAGE_NUM - 1)
+#endif
+#define SDRAM_TUNE_MAGIC 0x53445254
+
+typedef struct {
+	uint32_t magic;
+	uint32_t emcRate;		/* EMC clock the timings were found at */
+	uint32_t readConfig;	/* DYNAMICREADCONFIG read strategy, 1..3 */
+	uint32_t clkDelay;		/* EMCDELAYCLK delay, 0..7 */
+	uint32_t tRP;			/* DYNAMICRP value, EMC clocks - 1 */
+	uint32_t ras;			/* RAS (tRCD) latency in EMC clocks */
+	uint32_t cas;			/* CAS latency in EMC clocks */
+	uint32_t check;			/* Inverted XOR of the words above */
+} SDRAM_TUNE_T;
+
+/* SDRAM regions the calibration pattern test runs over */
+#define SDRAM_TUNE_TEST_BYTES (16 * 1024)
+#define SDRAM_TUNE_PASSES     3
+
 /* Keil NorFlash timing and chip Config */
 /* FIXME : Keil NOR FLASH not yet tested */
 STATIC const IP_EMC_STATIC_CONFIG_T S29GL64N90_config = {
@@ -349,17 +374,136 @@ STATIC const IP_EMC_STATIC_CONFIG_T S29GL64N90_config = {
  * Private functions
  ****************************************************************************/
 
-/*****************************************************************************
- * Public functions
- ****************************************************************************/
+/* Checksum of a tuning record */
+static uint32_t sdramTuneCheck(const SDRAM_TUNE_T *pTune)
+{
+	const uint32_t *pWords = (const uint32_t *) pTune;
+	uint32_t i, check = 0;
 
-/* Sets up system pin muxing */
-void Board_SetupMuxing(void)
+	for (i = 0; i < (offsetof(SDRAM_TUNE_T, check) / sizeof(uint32_t)); i++) {
+		check ^= pWords[i];
+	}
+
+	return ~check;
+}
+
+/* Reads back a stored tuning record, true if it is valid for this EMC clock */
+static bool sdramLoadTune(SDRAM_TUNE_T *pTune)
 {
-	int i;
+	const uint32_t *pEeprom = (const uint32_t *) EEPROM_ADDRESS(BOARD_SDRAM_TUNE_PAGE, 0);
+	uint32_t *pWords = (uint32_t *) pTune;
+	uint32_t i;
 
-	/* Setup system level pin muxing */
-	Chip_SCU_SetPinMuxing(pinmuxing, sizeof(pinmuxing) / sizeof(PINMUX_GRP_T));
+	Chip_EEPROM_Init(LPC_EEPROM);
+	for (i = 0; i < (sizeof(SDRAM_TUNE_T) / sizeof(uint32_t)); i++) {
+		pWords[i] = pEeprom[i];
+	}
+
+	return (pTune->magic == SDRAM_TUNE_MAGIC) && (pTune->check == sdramTuneCheck(pTune)) &&
+		   (pTune->emcRate == Chip_Clock_GetEMCRate());
+}
+
+/* Stores a tuning record in its EEPROM page */
+static void sdramStoreTune(SDRAM_TUNE_T *pTune)
+{
+	uint32_t *pEeprom = (uint32_t *) EEPROM_ADDRESS(BOARD_SDRAM_TUNE_PAGE, 0);
+	const uint32_t *pWords = (const uint32_t *) pTune;
+	uint32_t i;
+
+	pTune->magic = SDRAM_TUNE_MAGIC;
+	pTune->check = sdramTuneCheck(pTune);
+
+	Chip_EEPROM_Init(LPC_EEPROM);
+	Chip_EEPROM_SetAutoProg(LPC_EEPROM, EEPROM_AUTOPROG_OFF);
+	for (i = 0; i < (sizeof(SDRAM_TUNE_T) / sizeof(uint32_t)); i++) {
+		pEeprom[i] = pWords[i];
+	}
+	Chip_EEPROM_EraseProgramPage(LPC_EEPROM);
+}
+
+/* (Re)initializes the SDRAM, with the board defaults if pTune is NULL */
+static void sdramApply(const SDRAM_TUNE_T *pTune)
+{
+	IP_EMC_DYN_CONFIG_T config = MT48LC4M32_config;
+	uint32_t delay = CLK0_DELAY;
+
+	if (pTune) {
+		delay = pTune->clkDelay;
+		config.ReadConfig = pTune->readConfig;
+		config.tRP = EMC_CLOCK(pTune->tRP);
+		config.DevConfig[0].RAS = pTune->ras;
+		config.DevConfig[0].ModeRegister = (config.DevConfig[0].ModeRegister & ~(0x7 << EMC_DYN_MODE_CAS_BIT)) |
+										   (pTune->cas << EMC_DYN_MODE_CAS_BIT);
+	}
+
+	LPC_SCU->EMCDELAYCLK = ((delay) | (delay << 4) | (delay << 8) | (delay << 12));
+	Chip_EMC_Dynamic_Init(&config);
+}
+
+/* Fast pattern test at both ends of the SDRAM, SDRAM_TUNE_PASSES times */
+static bool sdramTest(void)
+{
+	uint32_t *regions[2] = {
+		(uint32_t *) EMC_ADDRESS_DYCS0,
+		(uint32_t *) (EMC_ADDRESS_DYCS0 + (8 * 1024 * 1024) - SDRAM_TUNE_TEST_BYTES)
+	};
+	MEM_TEST_SETUP_T memSetup;
+	int pass, i;
+
+	for (pass = 0; pass < SDRAM_TUNE_PASSES; pass++) {
+		for (i = 0; i < 2; i++) {
+			memSetup.start_addr = regions[i];
+			memSetup.bytes = SDRAM_TUNE_TEST_BYTES;
+			if (!mem_test_pattern_seed(&memSetup, 0x12345678 + pass, 0x50005) ||
+				!mem_test_address(&memSetup) || !mem_test_walking1(&memSetup)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/* Finds the read strategy and clock delay to use with the other timings in
+   pTune: the lowest latency strategy with a passing delay window at least 3
+   steps wide, centred in that window */
+static bool sdramFindReadWindow(SDRAM_TUNE_T *pTune)
+{
+	uint32_t readConfig, delay, start, run, bestStart, bestRun;
+
+	for (readConfig = 1; readConfig <= 3; readConfig++) {
+		pTune->readConfig = readConfig;
+		bestStart = bestRun = run = start = 0;
+		for (delay = 0; delay < 8; delay++) {
+			pTune->clkDelay = delay;
+			sdramApply(pTune);
+			if (sdramTest()) {
+				if (run++ == 0) {
+					start = delay;
+				}
+				if (run > bestRun) {
+					bestRun = run;
+					bestStart = start;
+				}
+			}
+			else {
+				run = 0;
+			}
+		}
+
+		if (bestRun >= 3) {
+			pTune->clkDelay = bestStart + (bestRun / 2);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Pins needed before the clocks are switched: clock pins and SPIFI */
+static void boardSetupBootMuxing(void)
+{
+	int i;
 
 	/* Clock pins only, group field not used */
 	for (i = 0; i < (sizeof(pinclockmuxing) / sizeof(pinclockmuxing[0])); i++) {
@@ -367,12 +511,47 @@ void Board_SetupMuxing(void)
 	}
 
 	/* SPIFI pin setup is done prior to setting up system clocking */
-	Chip_SCU_SetPinMuxing(spifipinmuxing, sizeof(spifipinmuxing) / sizeof(PINMUX_GRP_T));
+	Chip_SCU_SetPinMuxing(bootpinmuxing, sizeof(bootpinmuxing) / sizeof(PINMUX_GRP_T));
+}
+
+#if defined(BOARD_BOOT_PROFILE)
+/* Restarts the cycle counter and clears the boot stamps */
+static void boardBootStart(void)
+{
+	int i;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	for (i = 0; i < BOARD_BOOT_STAGES; i++) {
+		Chip_REGFILE_Write(LPC_REGFILE, BOARD_BOOT_REGFILE_INDEX + i, 0);
+	}
+}
+
+#endif
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Sets up system pin muxing */
+void Board_SetupMuxing(void)
+{
+	/* Setup system level pin muxing */
+	Chip_SCU_SetPinMuxing(pinmuxing, sizeof(pinmuxing) / sizeof(PINMUX_GRP_T));
+
+#if !defined(BOARD_FAST_BOOT)
+	/* With BOARD_FAST_BOOT these were set by Board_SystemInit() already */
+	boardSetupBootMuxing();
+#endif
 }
 
 /* Setup external memories */
 void Board_SetupExtMemory(void)
 {
+	SDRAM_TUNE_T tune;
+
 	/* Setup EMC Delays */
 	/* Move all clock delays together */
 	LPC_SCU->EMCDELAYCLK = ((CLK0_DELAY) | (CLK0_DELAY << 4) | (CLK0_DELAY << 8) | (CLK0_DELAY << 12));
@@ -388,8 +567,13 @@ void Board_SetupExtMemory(void)
 
 	/* Init EMC Controller -Enable-LE mode */
 	Chip_EMC_Init(1, 0, 0);
-	/* Init EMC Dynamic Controller */
-	Chip_EMC_Dynamic_Init((IP_EMC_DYN_CONFIG_T *) &MT48LC4M32_config);
+	/* Init EMC Dynamic Controller, with the calibrated timings if stored */
+	if (sdramLoadTune(&tune)) {
+		sdramApply(&tune);
+	}
+	else {
+		sdramApply(NULL);
+	}
 	/* Init EMC Static Controller CS0 */
 	Chip_EMC_Static_Init((IP_EMC_STATIC_CONFIG_T *) &S29GL64N90_config);
 
@@ -436,10 +620,118 @@ void Board_SetupClocking(void)
 /* Set up and initialize hardware prior to call to main */
 void Board_SystemInit(void)
 {
+#if defined(BOARD_BOOT_PROFILE)
+	boardBootStart();
+#endif
+
+#if defined(BOARD_FAST_BOOT)
+	/* Only the clocks and the pins needed to run from SPIFI, the rest is left
+	   to Board_Deferred_Init() so USB can connect as early as possible */
+	boardSetupBootMuxing();
+	Board_BootMark(BOARD_BOOT_MUXING);
+	Board_SetupClocking();
+	Board_BootMark(BOARD_BOOT_CLOCKING);
+#else
 	/* Setup system clocking and memory. This is done early to allow the
 	   application and tools to clear memory and use scatter loading to
 	   external memory. */
 	Board_SetupMuxing();
+	Board_BootMark(BOARD_BOOT_MUXING);
 	Board_SetupClocking();
+	Board_BootMark(BOARD_BOOT_CLOCKING);
 	Board_SetupExtMemory();
+	Board_BootMark(BOARD_BOOT_EXTMEM);
+#endif
 }
+
+/* Timestamps a boot stage */
+void Board_BootMark(BOARD_BOOT_STAGE_T stage)
+{
+#if defined(BOARD_BOOT_PROFILE)
+	Chip_REGFILE_Write(LPC_REGFILE, BOARD_BOOT_REGFILE_INDEX + stage, DWT->CYCCNT);
+#endif
+}
+
+/* Returns the time from Board_SystemInit() to a boot stage */
+uint32_t Board_BootTimeUs(BOARD_BOOT_STAGE_T stage)
+{
+#if defined(BOARD_BOOT_PROFILE)
+	uint32_t stamp = Chip_REGFILE_Read(LPC_REGFILE, BOARD_BOOT_REGFILE_INDEX + stage);
+	uint32_t clocked = Chip_REGFILE_Read(LPC_REGFILE, BOARD_BOOT_REGFILE_INDEX + BOARD_BOOT_CLOCKING);
+
+	if (stamp == 0) {
+		return 0;
+	}
+	/* Everything up to the clock switch ran from the IRC or the crystal */
+	if (stage <= BOARD_BOOT_CLOCKING) {
+		return stamp / (CGU_IRC_FREQ / 1000000);
+	}
+	return (clocked / (CGU_IRC_FREQ / 1000000)) +
+		   (uint32_t) (((uint64_t) (stamp - clocked) * 1000000) / SystemCoreClock);
+#else
+	return 0;
+#endif
+}
+
+/* Tightens the SDRAM timings against a pattern test */
+bool Board_SDRAM_Calibrate(bool store)
+{
+	SDRAM_TUNE_T tune;
+	uint32_t value;
+
+	/* Start from the board defaults as programmed */
+	sdramApply(NULL);
+	tune.emcRate = Chip_Clock_GetEMCRate();
+	tune.readConfig = LPC_EMC->DYNAMICREADCONFIG & 0x3;
+	tune.clkDelay = CLK0_DELAY;
+	tune.tRP = LPC_EMC->DYNAMICRP;
+	tune.ras = LPC_EMC->DYNAMICRASCAS0 & 0x3;
+	tune.cas = (LPC_EMC->DYNAMICRASCAS0 >> 8) & 0x3;
+
+	/* The read window moves with the CAS latency, find it again for each */
+	if (!sdramFindReadWindow(&tune)) {
+		sdramApply(NULL);
+		return false;
+	}
+	for (value = tune.cas - 1; value >= 2; value--) {
+		SDRAM_TUNE_T trial = tune;
+
+		trial.cas = value;
+		if (!sdramFindReadWindow(&trial)) {
+			break;
+		}
+		tune = trial;
+	}
+
+	/* Then the row timings, one clock at a time */
+	while (tune.ras > 1) {
+		tune.ras--;
+		sdramApply(&tune);
+		if (!sdramTest()) {
+			tune.ras++;
+			break;
+		}
+	}
+	while (tune.tRP > 0) {
+		tune.tRP--;
+		sdramApply(&tune);
+		if (!sdramTest()) {
+			tune.tRP++;
+			break;
+		}
+	}
+
+	/* Confirm the final set, falling back to the defaults */
+	sdramApply(&tune);
+	if (!sdramTest() || !sdramTest()) {
+		sdramApply(NULL);
+		return false;
+	}
+
+	if (store) {
+		sdramStoreTune(&tune);
+	}
+
+	return true;
+}
+
@@ -255,3 +255,107 @@ Status Chip_ADC_ReadByte(LPC_ADC_T *pADC, ADC_CHANNEL_T channel, uint8_t *data)
 	return rt;
 }
 
+/* Set up a continuous ADC acquisition into a ping-pong buffer */
+Status Chip_ADC_Stream_Init(ADC_STREAM_T *pStream, LPC_ADC_T *pADC, LPC_GPDMA_T *pGPDMA,
+							uint32_t *pBuffer, uint32_t samples, ADC_STREAM_CALLBACK_T callback)
+{
+	uint32_t ctrl;
+	int i;
+
+	if ((samples == 0) || (samples > ADC_STREAM_MAX_SAMPLES)) {
+		return ERROR;
+	}
+
+	pStream->pADC = pADC;
+	pStream->pGPDMA = pGPDMA;
+	pStream->conn = (pADC == LPC_ADC0) ? GPDMA_CONN_ADC_0 : GPDMA_CONN_ADC_1;
+	pStream->pBuffer = pBuffer;
+	pStream->samples = samples;
+	pStream->callback = callback;
+	pStream->halves = 0;
+	pStream->errors = 0;
+
+	pStream->dmaChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, pStream->conn);
+	if (pStream->dmaChannel >= GPDMA_NUMBER_CHANNELS) {
+		return ERROR;
+	}
+
+	/* One word per request, the global data register read clears the request */
+	ctrl = GPDMA_DMACCxControl_TransferSize(samples) |
+		   GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1) |
+		   GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) |
+		   GPDMA_DMACCxControl_DestTransUseAHBMaster1 | GPDMA_DMACCxControl_DI | GPDMA_DMACCxControl_I;
+	for (i = 0; i < 2; i++) {
+		pStream->desc[i].src = (uint32_t) &pADC->GDR;
+		pStream->desc[i].dst = (uint32_t) &pBuffer[i * samples];
+		pStream->desc[i].lli = (uint32_t) &pStream->desc[i ^ 1];
+		pStream->desc[i].ctrl = ctrl;
+	}
+
+	return SUCCESS;
+}
+
+/* Start a continuous ADC acquisition */
+Status Chip_ADC_Stream_Start(ADC_STREAM_T *pStream, ADC_START_MODE_T mode, ADC_EDGE_CFG_T EdgeOption)
+{
+	LPC_ADC_T *pADC = pStream->pADC;
+
+	pStream->half = 0;
+
+	/* Only the global DONE flag requests DMA, drop a stale result first */
+	pADC->INTEN = (1UL << 8);
+	(void) pADC->GDR;
+
+	if (Chip_GPDMA_SGTransferPeripheral(pStream->pGPDMA, pStream->dmaChannel, pStream->conn, &pStream->desc[0],
+										GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR) {
+		pADC->INTEN = 0;
+		return ERROR;
+	}
+
+	if (mode == ADC_NO_START) {
+		Chip_ADC_SetBurstCmd(pADC, ENABLE);
+	}
+	else {
+		Chip_ADC_SetBurstCmd(pADC, DISABLE);
+		Chip_ADC_SetStartMode(pADC, mode, EdgeOption);
+	}
+
+	return SUCCESS;
+}
+
+/* Stop a continuous ADC acquisition */
+void Chip_ADC_Stream_Stop(ADC_STREAM_T *pStream)
+{
+	Chip_ADC_SetBurstCmd(pStream->pADC, DISABLE);
+	Chip_GPDMA_ChannelCmd(pStream->pGPDMA, pStream->dmaChannel, DISABLE);
+	Chip_GPDMA_ClearIntPending(pStream->pGPDMA, GPDMA_STATCLR_INTTC, pStream->dmaChannel);
+	Chip_GPDMA_ClearIntPending(pStream->pGPDMA, GPDMA_STATCLR_INTERR, pStream->dmaChannel);
+	pStream->pADC->INTEN = 0;
+}
+
+/* GPDMA interrupt handler for an ADC stream */
+bool Chip_ADC_Stream_IRQHandler(ADC_STREAM_T *pStream)
+{
+	uint32_t *pSamples;
+
+	if (!Chip_GPDMA_IntGetStatus(pStream->pGPDMA, GPDMA_STAT_INT, pStream->dmaChannel)) {
+		return false;
+	}
+
+	if (Chip_GPDMA_Interrupt(pStream->pGPDMA, pStream->dmaChannel) == ERROR) {
+		/* The channel halts on a bus error */
+		pStream->errors++;
+		Chip_ADC_Stream_Stop(pStream);
+		return true;
+	}
+
+	pSamples = &pStream->pBuffer[pStream->half * pStream->samples];
+	pStream->half ^= 1;
+	pStream->halves++;
+	if (pStream->callback) {
+		pStream->callback(pStream, pSamples, pStream->samples);
+	}
+
+	return true;
+}
+
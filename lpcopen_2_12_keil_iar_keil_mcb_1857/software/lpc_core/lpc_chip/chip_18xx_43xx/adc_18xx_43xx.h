@@ -32,6 +32,9 @@
 #ifndef __ADC_18XX_43XX_H_
 #define __ADC_18XX_43XX_H_
 
+/* The streaming engine keeps its GPDMA descriptors in the stream handle */
+#include "gpdma_18xx_43xx.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -65,6 +68,7 @@ typedef struct {					/*!< ADCn Structure */
 #define ADC_CR_BITACC(n)        ((((n) & 0x7) << 17))	/*!< Number of ADC accuracy bits */
 #define ADC_DR_DONE(n)          (((n) >> 31))			/*!< Mask for reading the ADC done status */
 #define ADC_DR_OVERRUN(n)       ((((n) >> 30) & (1UL)))	/*!< Mask for reading the ADC overrun status */
+#define ADC_DR_CHANNEL(n)       ((((n) >> 24) & 0x7))	/*!< Mask for getting the channel of a global data register value */
 #define ADC_CR_CH_SEL(n)        ((1UL << (n)))			/*!< Selects which of the AD0.0:7 pins is (are) to be sampled and converted */
 #define ADC_CR_CLKDIV(n)        ((((n) & 0xFF) << 8))	/*!< The APB clock (PCLK) is divided by (this value plus one) to produce the clock for the A/D */
 #define ADC_CR_BURST            ((1UL << 16))			/*!< Repeated conversions A/D enable bit */
@@ -257,6 +261,85 @@ void Chip_ADC_EnableChannel(LPC_ADC_T *pADC, ADC_CHANNEL_T channel, FunctionalSt
  */
 void Chip_ADC_SetBurstCmd(LPC_ADC_T *pADC, FunctionalState NewState);
 
+/** Largest number of samples in one half of an ADC stream buffer */
+#define ADC_STREAM_MAX_SAMPLES  0xFFF
+
+struct ADC_STREAM;
+
+/**
+ * @brief ADC stream buffer callback
+ * Called from Chip_ADC_Stream_IRQHandler() when one half of the buffer is
+ * full. @a pSamples holds raw global data register values, use ADC_DR_RESULT()
+ * and ADC_DR_CHANNEL() on them. The DMA fills the other half meanwhile, so the
+ * samples must be consumed before it is full too.
+ */
+typedef void (*ADC_STREAM_CALLBACK_T)(struct ADC_STREAM *pStream, const uint32_t *pSamples, uint32_t count);
+
+/**
+ * @brief ADC continuous acquisition handle
+ */
+typedef struct ADC_STREAM {
+	LPC_ADC_T *pADC;				/*!< ADC peripheral */
+	LPC_GPDMA_T *pGPDMA;			/*!< GPDMA controller */
+	uint8_t conn;					/*!< GPDMA_CONN_ADC_0 or GPDMA_CONN_ADC_1 */
+	uint8_t dmaChannel;				/*!< Claimed GPDMA channel */
+	uint8_t half;					/*!< Buffer half the DMA completes next, 0 or 1 */
+	uint32_t *pBuffer;				/*!< Sample buffer, 2 * samples words */
+	uint32_t samples;				/*!< Samples in each half of the buffer */
+	ADC_STREAM_CALLBACK_T callback;	/*!< Half full callback or NULL */
+	void *pData;					/*!< Caller data for the callback */
+	uint32_t halves;				/*!< Number of buffer halves completed */
+	uint32_t errors;				/*!< DMA errors, the stream stops on an error */
+	DMA_TransferDescriptor_t desc[2];	/*!< Circular list, one descriptor per buffer half */
+} ADC_STREAM_T;
+
+/**
+ * @brief	Set up a continuous ADC acquisition into a ping-pong buffer
+ * @param	pStream		: Stream handle to initialize
+ * @param	pADC		: The base of ADC peripheral on the chip, already initialized
+ *						  and with the sampled channels enabled
+ * @param	pGPDMA		: The GPDMA controller, already initialized
+ * @param	pBuffer		: Sample buffer of 2 * @a samples words
+ * @param	samples		: Samples per buffer half, 1 to ADC_STREAM_MAX_SAMPLES
+ * @param	callback	: Half full callback, may be NULL
+ * @return	SUCCESS, or ERROR if @a samples is out of range or no GPDMA channel is free
+ * @note	One GPDMA channel is claimed. Call Chip_ADC_Stream_IRQHandler()
+ *			from the DMA interrupt handler.
+ */
+Status Chip_ADC_Stream_Init(ADC_STREAM_T *pStream, LPC_ADC_T *pADC, LPC_GPDMA_T *pGPDMA,
+							uint32_t *pBuffer, uint32_t samples, ADC_STREAM_CALLBACK_T callback);
+
+/**
+ * @brief	Start a continuous ADC acquisition
+ * @param	pStream		: Stream handle
+ * @param	mode		: ADC_NO_START to convert back to back in burst mode, or the
+ *						  hardware trigger (ADC_START_ON_CTOUT15 ... ADC_START_ON_MCOA2)
+ *						  starting each conversion
+ * @param	EdgeOption	: Trigger edge, ignored in burst mode
+ * @return	SUCCESS or ERROR if the DMA could not be started
+ * @note	Every conversion result is moved by the DMA, without CPU work. In
+ *			burst mode all enabled channels are converted in turn, with a
+ *			hardware trigger only a single channel should be enabled. The
+ *			buffer is filled from its first half.
+ */
+Status Chip_ADC_Stream_Start(ADC_STREAM_T *pStream, ADC_START_MODE_T mode, ADC_EDGE_CFG_T EdgeOption);
+
+/**
+ * @brief	Stop a continuous ADC acquisition
+ * @param	pStream		: Stream handle
+ * @return	Nothing
+ * @note	The GPDMA channel stays claimed for the next Chip_ADC_Stream_Start().
+ */
+void Chip_ADC_Stream_Stop(ADC_STREAM_T *pStream);
+
+/**
+ * @brief	GPDMA interrupt handler for an ADC stream
+ * @param	pStream		: Stream handle
+ * @return	true if the interrupt was for this stream's channel
+ * @note	Runs the callback for each filled buffer half.
+ */
+bool Chip_ADC_Stream_IRQHandler(ADC_STREAM_T *pStream);
+
 /**
  * @}
  */
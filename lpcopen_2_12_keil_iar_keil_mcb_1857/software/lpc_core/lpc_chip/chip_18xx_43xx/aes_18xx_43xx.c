@@ -30,6 +30,7 @@
  */
 
 #include "chip.h"
+#include <string.h>
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -40,6 +41,10 @@
 
 static unsigned long *BOOTROM_API_TABLE;
 
+/* AES stream job queue */
+static AES_JOB_T *JobHead;
+static AES_JOB_T *JobTail;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -59,6 +64,24 @@ static uint32_t (*aes_Operate)(uint8_t *pDatOut, uint8_t *pDatIn, uint32_t size)
 static uint32_t (*aes_ProgramKey1)(uint8_t *pKey);
 static uint32_t (*aes_ProgramKey2)(uint8_t *pKey);
 
+/* Remove the completed head job, returns it */
+static AES_JOB_T *popJob(void)
+{
+	AES_JOB_T *pJob;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	pJob = JobHead;
+	JobHead = pJob->pNext;
+	if (JobHead == NULL) {
+		JobTail = NULL;
+	}
+	__set_PRIMASK(primask);
+
+	return pJob;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -145,3 +168,100 @@ uint32_t Chip_AES_ProgramKey(uint32_t KeyNum, uint8_t *pKey)
 	}
 	return status;
 }
+
+/* Initialize the AES job queue */
+void Chip_AES_StreamInit(void)
+{
+	JobHead = JobTail = NULL;
+}
+
+/* Queue an AES job */
+Status Chip_AES_SubmitJob(AES_JOB_T *pJob)
+{
+	uint32_t primask;
+
+	if (pJob->AesMode > CHIP_AES_API_CMD_DECODE_CBC) {
+		return ERROR;
+	}
+
+	pJob->pNext = NULL;
+	pJob->done = 0;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (JobHead == NULL) {
+		JobHead = JobTail = pJob;
+	}
+	else {
+		JobTail->pNext = pJob;
+		JobTail = pJob;
+	}
+	__set_PRIMASK(primask);
+
+	return SUCCESS;
+}
+
+/* Returns whether AES jobs are in progress or queued */
+bool Chip_AES_IsJobPending(void)
+{
+	return JobHead != NULL;
+}
+
+/* Process the next chunk of the AES job queue */
+bool Chip_AES_StreamPoll(void)
+{
+	AES_JOB_T *pJob = JobHead;
+	uint8_t next_iv[AES_BLOCK_SIZE];
+	uint8_t *pIn, *pOut;
+	uint32_t blocks;
+	Status status = SUCCESS;
+
+	if (pJob == NULL) {
+		return false;
+	}
+
+	blocks = pJob->Size - pJob->done;
+	if (blocks > AES_STREAM_CHUNK_BLOCKS) {
+		blocks = AES_STREAM_CHUNK_BLOCKS;
+	}
+
+	if (blocks) {
+		pIn = pJob->pDatIn + (pJob->done * AES_BLOCK_SIZE);
+		pOut = pJob->pDatOut + (pJob->done * AES_BLOCK_SIZE);
+
+		/* Other users of the engine may run between chunks, so the mode and
+		   the chaining value are loaded again for every chunk. Decoding chains
+		   on the last ciphertext block, which in-place operation overwrites. */
+		if (pJob->AesMode == CHIP_AES_API_CMD_DECODE_CBC) {
+			memcpy(next_iv, pIn + ((blocks - 1) * AES_BLOCK_SIZE), AES_BLOCK_SIZE);
+		}
+		if (aes_SetMode(pJob->AesMode) != 0) {
+			status = ERROR;
+		}
+		else {
+			if ((pJob->AesMode == CHIP_AES_API_CMD_ENCODE_CBC) ||
+				(pJob->AesMode == CHIP_AES_API_CMD_DECODE_CBC)) {
+				aes_LoadIV_SW(pJob->iv);
+			}
+			if (aes_Operate(pOut, pIn, blocks) != 0) {
+				status = ERROR;
+			}
+			else if (pJob->AesMode == CHIP_AES_API_CMD_ENCODE_CBC) {
+				memcpy(pJob->iv, pOut + ((blocks - 1) * AES_BLOCK_SIZE), AES_BLOCK_SIZE);
+			}
+			else if (pJob->AesMode == CHIP_AES_API_CMD_DECODE_CBC) {
+				memcpy(pJob->iv, next_iv, AES_BLOCK_SIZE);
+			}
+		}
+		pJob->done += blocks;
+	}
+
+	if ((status == ERROR) || (pJob->done >= pJob->Size)) {
+		popJob();
+		if (pJob->callback) {
+			pJob->callback(pJob, status);
+		}
+	}
+
+	return JobHead != NULL;
+}
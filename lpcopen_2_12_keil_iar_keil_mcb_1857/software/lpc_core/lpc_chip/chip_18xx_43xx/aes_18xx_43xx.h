@@ -124,6 +124,70 @@ uint32_t Chip_AES_Operate(uint8_t *pDatOut, uint8_t *pDatIn, uint32_t Size);
  */
 uint32_t Chip_AES_ProgramKey(uint32_t KeyNum, uint8_t *pKey);
 
+/* Size of an AES block in bytes */
+#define AES_BLOCK_SIZE 16
+
+/* Blocks processed by each Chip_AES_StreamPoll() call, bounds the time
+   spent in one call */
+#ifndef AES_STREAM_CHUNK_BLOCKS
+#define AES_STREAM_CHUNK_BLOCKS 32
+#endif
+
+struct AES_JOB;
+
+/**
+ * @brief AES job completion callback, status is ERROR if the ROM reported a failure
+ */
+typedef void (*AES_JOB_CALLBACK_T)(struct AES_JOB *pJob, Status status);
+
+/**
+ * @brief AES stream job, owned by the driver from submission until its callback runs
+ */
+typedef struct AES_JOB {
+	CHIP_AES_OP_MODE_T AesMode;				/*!< ECB or CBC, encode or decode */
+	uint8_t *pDatOut;						/*!< Output data, may be pDatIn for in-place operation */
+	uint8_t *pDatIn;						/*!< Input data */
+	uint32_t Size;							/*!< Size of the data in 128-bit blocks */
+	uint8_t iv[AES_BLOCK_SIZE];				/*!< CBC initialization vector, holds the chaining value for a follow-up job on completion */
+	AES_JOB_CALLBACK_T callback;			/*!< Called from Chip_AES_StreamPoll(), or NULL */
+	struct AES_JOB *pNext;					/*!< Driver use: next queued job */
+	uint32_t done;							/*!< Driver use: blocks processed */
+} AES_JOB_T;
+
+/**
+ * @brief	Initialize the AES job queue
+ * @return	Nothing
+ * @note	Call after Chip_AES_Init() and after loading the key. Every job
+ *			uses the key loaded at the time it is processed.
+ */
+void Chip_AES_StreamInit(void);
+
+/**
+ * @brief	Queue an AES job
+ * @param	pJob	: Job to queue, filled in except for the driver use fields
+ * @return	ERROR if the mode is not supported, SUCCESS when the job was queued
+ * @note	May be called from interrupt handlers, including job callbacks.
+ *			A CBC stream split across jobs continues when the iv of the next
+ *			job is copied from the previous one in its callback.
+ */
+Status Chip_AES_SubmitJob(AES_JOB_T *pJob);
+
+/**
+ * @brief	Returns whether AES jobs are in progress or queued
+ * @return	true if the job queue is not empty
+ */
+bool Chip_AES_IsJobPending(void);
+
+/**
+ * @brief	Process the next chunk of the AES job queue
+ * @return	true if jobs are still queued after this call
+ * @note	Call this from the main loop or an idle task. Each call runs at
+ *			most AES_STREAM_CHUNK_BLOCKS blocks through the engine and runs
+ *			the callback of a job that completes. Must not be called from
+ *			a job callback.
+ */
+bool Chip_AES_StreamPoll(void);
+
 /**
  * @}
  */
@@ -30,6 +30,7 @@
  */
 
 #include "chip.h"
+#include "string.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -82,6 +83,144 @@ STATIC uint8_t getFreeMsgObject(LPC_CCAN_T *pCCAN)
 	return 0;	// No free object
 }
 
+/* Return the first of num consecutive free message objects; 0 if not found */
+STATIC uint8_t getFreeMsgRun(LPC_CCAN_T *pCCAN, uint8_t num)
+{
+	uint32_t msg_valid;
+	uint8_t i, run = 0;
+	msg_valid = Chip_CCAN_GetValidMsg(pCCAN);
+	for (i = 0; (i < CCAN_MSG_MAX_NUM) && (num > 0); i++) {
+		run = ((msg_valid >> i) & 1UL) ? 0 : run + 1;
+		if (run == num) {
+			return i + 2 - num;
+		}
+	}
+	return 0;
+}
+
+/* Configure a message object to receive the IDs matching id under mask */
+STATIC void setRxFilterObject(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint8_t msgNum,
+							  uint32_t id, uint32_t mask, bool endOfBuffer)
+{
+	pCCAN->IF[IFSel].MCTRL = CCAN_IF_MCTRL_UMSK | CCAN_IF_MCTRL_RXIE | (endOfBuffer ? CCAN_IF_MCTRL_EOB : 0);
+	if (!(id & (0x1 << 30))) {		/* Standard frame */
+		pCCAN->IF[IFSel].MSK2 = CCAN_IF_MASK2_MDIR(1) | ((mask & CCAN_MSG_ID_STD_MASK) << 2);
+		pCCAN->IF[IFSel].MSK1 = 0x0000;
+		pCCAN->IF[IFSel].ARB2 = CCAN_IF_ARB2_MSGVAL | CCAN_IF_ARB2_DIR(CCAN_RX_DIR) |
+								((id & CCAN_MSG_ID_STD_MASK) << 2);
+		pCCAN->IF[IFSel].ARB1 = 0x0000;
+	}
+	else {							/* Extended frame */
+		pCCAN->IF[IFSel].MSK2 = CCAN_IF_MASK2_MXTD | CCAN_IF_MASK2_MDIR(1) |
+								((mask & CCAN_MSG_ID_EXT_MASK) >> 16);
+		pCCAN->IF[IFSel].MSK1 = mask & 0x0000FFFF;
+		pCCAN->IF[IFSel].ARB2 = CCAN_IF_ARB2_MSGVAL | CCAN_IF_ARB2_XTD | CCAN_IF_ARB2_DIR(CCAN_RX_DIR) |
+								((id & CCAN_MSG_ID_EXT_MASK) >> 16);
+		pCCAN->IF[IFSel].ARB1 = id & 0x0000FFFF;
+	}
+	Chip_CCAN_TransferMsgObject(pCCAN, IFSel, CCAN_IF_CMDMSK_WR | CCAN_IF_CMDMSK_CTRL |
+								CCAN_IF_CMDMSK_MASK | CCAN_IF_CMDMSK_ARB, msgNum);
+}
+
+/* ID bits of a filter, by frame type */
+STATIC uint32_t filterIdMask(uint32_t id)
+{
+	return (id & (0x1 << 30)) ? CCAN_MSG_ID_EXT_MASK : CCAN_MSG_ID_STD_MASK;
+}
+
+/* Number of IDs a filter accepts */
+STATIC uint32_t filterSize(const CCAN_FILTER_T *pFilter)
+{
+	uint32_t dontCare = filterIdMask(pFilter->id) & ~pFilter->mask, size = 1;
+
+	while (dontCare) {
+		size <<= (dontCare & 1);
+		dontCare >>= 1;
+	}
+	return size;
+}
+
+/* Smallest filter accepting everything two filters accept */
+STATIC void filterMerge(const CCAN_FILTER_T *pA, const CCAN_FILTER_T *pB, CCAN_FILTER_T *pOut)
+{
+	pOut->mask = pA->mask & pB->mask & ~(pA->id ^ pB->id);
+	pOut->id = (pA->id & pOut->mask) | (pA->id & (0x1 << 30));
+}
+
+/* Check if a filter accepts every ID another one accepts */
+STATIC bool filterCovers(const CCAN_FILTER_T *pOuter, const CCAN_FILTER_T *pInner)
+{
+	return !((pOuter->id ^ pInner->id) & (0x1 << 30)) &&
+		   ((pInner->mask & pOuter->mask) == pOuter->mask) &&
+		   ((pInner->id & pOuter->mask) == (pOuter->id & pOuter->mask));
+}
+
+/* Add a filter to a plan of at most maxFilters, merging the pair that adds
+   the fewest unwanted IDs when the plan is full */
+STATIC int planAddFilter(CCAN_FILTER_T *pFilters, int count, int maxFilters, const CCAN_FILTER_T *pNew)
+{
+	CCAN_FILTER_T merged, a, b;
+	uint32_t cost, bestCost = 0xFFFFFFFF;
+	int i, j, best_i = -1, best_j = -1;
+
+	for (i = 0; i < count; i++) {
+		if (filterCovers(&pFilters[i], pNew)) {
+			return count;
+		}
+	}
+	if (count < maxFilters) {
+		pFilters[count] = *pNew;
+		return count + 1;
+	}
+
+	/* Pair index count stands for the new filter */
+	for (i = 0; i < count; i++) {
+		for (j = i + 1; j <= count; j++) {
+			a = pFilters[i];
+			b = (j == count) ? *pNew : pFilters[j];
+			if ((a.id ^ b.id) & (0x1 << 30)) {
+				continue;	/* Standard and extended IDs never share a filter */
+			}
+			filterMerge(&a, &b, &merged);
+			cost = filterSize(&merged) - filterSize(&a) - filterSize(&b);
+			if ((int32_t) cost < 0) {
+				cost = 0;	/* Overlapping filters */
+			}
+			if (cost < bestCost) {
+				bestCost = cost;
+				best_i = i;
+				best_j = j;
+			}
+		}
+	}
+	if (best_i < 0) {
+		return -1;
+	}
+
+	filterMerge(&pFilters[best_i], (best_j == count) ? pNew : &pFilters[best_j], &merged);
+	if (best_j < count) {
+		pFilters[best_j] = *pNew;
+	}
+	pFilters[best_i] = merged;
+
+	/* Drop filters the merged one now covers */
+	i = 0;
+	while (i < count) {
+		if ((i != best_i) && filterCovers(&merged, &pFilters[i])) {
+			count--;
+			pFilters[i] = pFilters[count];
+			if (best_i == count) {
+				best_i = i;
+			}
+		}
+		else {
+			i++;
+		}
+	}
+
+	return count;
+}
+
 STATIC void freeMsgObject(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint8_t msgNum)
 {
 	Chip_CCAN_SetValidMsg(pCCAN, IFSel, msgNum, false);
@@ -233,7 +372,8 @@ void Chip_CCAN_GetMsgObject(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint8_t msgN
 		*pData = (pCCAN->IF[IFSel].DB2 << 16) | pCCAN->IF[IFSel].DB1;
 
 		if (pMsgObj->id & (0x1 << 30)) {
-			pMsgObj->id &= CCAN_MSG_ID_EXT_MASK;
+			/* keep bit 30, it tells the extended id from a standard one */
+			pMsgObj->id = (pMsgObj->id & CCAN_MSG_ID_EXT_MASK) | (0x1 << 30);
 		}
 		else {
 			pMsgObj->id >>= 18;
@@ -296,6 +436,163 @@ void Chip_CCAN_AddReceiveID(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint32_t id)
 	Chip_CCAN_SetMsgObject(pCCAN, IFSel, CCAN_RX_DIR, false, msgNum, &temp);
 }
 
+/* Initialize a CCAN receive FIFO */
+void Chip_CCAN_FIFO_Init(LPC_CCAN_T *pCCAN, CCAN_FIFO_T *pFifo, CCAN_MSG_IF_T IFSel,
+						 CCAN_MSG_OBJ_T *pBuffer, int count)
+{
+	memset(pFifo, 0, sizeof(*pFifo));
+	pFifo->pCCAN = pCCAN;
+	pFifo->IFSel = IFSel;
+	RingBuffer_Init(&pFifo->rb, pBuffer, sizeof(CCAN_MSG_OBJ_T), count);
+}
+
+/* Add a filter group to a CCAN receive FIFO */
+uint8_t Chip_CCAN_FIFO_AddGroup(CCAN_FIFO_T *pFifo, CCAN_MSG_IF_T IFSel, uint32_t id, uint32_t mask, uint8_t numObjs)
+{
+	LPC_CCAN_T *pCCAN = pFifo->pCCAN;
+	uint8_t first, i;
+
+	if (pFifo->numGroups >= CCAN_FIFO_MAX_GROUPS) {
+		return 0;
+	}
+	first = getFreeMsgRun(pCCAN, numObjs);
+	if (!first) {
+		return 0;
+	}
+
+	/* Every object of the chain uses the same filter, the controller stores
+	   into the lowest numbered one without new data. Only the last object
+	   ends the chain. */
+	for (i = first; i < first + numObjs; i++) {
+		setRxFilterObject(pCCAN, IFSel, i, id, mask, (i == first + numObjs - 1));
+		pFifo->objMask |= 1UL << (i - 1);
+	}
+
+	pFifo->groups[pFifo->numGroups].first = first;
+	pFifo->groups[pFifo->numGroups].last = first + numObjs - 1;
+	pFifo->numGroups++;
+
+	return first;
+}
+
+/* Drain a CCAN receive FIFO into its ring buffer */
+int Chip_CCAN_FIFO_IRQHandler(CCAN_FIFO_T *pFifo, uint32_t msgNum)
+{
+	LPC_CCAN_T *pCCAN = pFifo->pCCAN;
+	CCAN_MSG_IF_T IFSel = pFifo->IFSel;
+	CCAN_MSG_OBJ_T msg;
+	uint32_t readMask;
+	uint8_t g, i;
+
+	if ((msgNum < 1) || (msgNum > CCAN_MSG_MAX_NUM) || !((pFifo->objMask >> (msgNum - 1)) & 1UL)) {
+		return 0;
+	}
+
+	for (g = 0; g < pFifo->numGroups; g++) {
+		do {
+			readMask = 0;
+			for (i = pFifo->groups[g].first; i <= pFifo->groups[g].last; i++) {
+				/* Sample per object, so messages stored behind the objects
+				   already read are picked up in the same pass */
+				if (!(((pCCAN->ND1 | (pCCAN->ND2 << 16)) >> (i - 1)) & 1UL)) {
+					continue;
+				}
+
+				/* Read and clear the interrupt, but keep NewDat so the
+				   controller keeps filling the chain behind this object */
+				Chip_CCAN_GetMsgObject(pCCAN, IFSel, i, &msg);
+				if (pCCAN->IF[IFSel].MCTRL & CCAN_IF_MCTRL_MLST) {
+					pFifo->hwOverruns++;
+					pCCAN->IF[IFSel].MCTRL &= ~(CCAN_IF_MCTRL_MLST | CCAN_IF_MCTRL_INTP);
+					Chip_CCAN_TransferMsgObject(pCCAN, IFSel, CCAN_IF_CMDMSK_WR | CCAN_IF_CMDMSK_CTRL, i);
+				}
+				if (RingBuffer_Insert(&pFifo->rb, &msg)) {
+					pFifo->received++;
+				}
+				else {
+					pFifo->rbOverruns++;
+				}
+				readMask |= 1UL << (i - 1);
+			}
+
+			/* Hand the drained objects back to the controller */
+			for (i = pFifo->groups[g].first; i <= pFifo->groups[g].last; i++) {
+				if ((readMask >> (i - 1)) & 1UL) {
+					Chip_CCAN_ClearNewDataFlag(pCCAN, IFSel, i);
+				}
+			}
+		} while (readMask);
+	}
+
+	return 1;
+}
+
+/* Compute mask/ID filters that accept a set of ID ranges */
+int Chip_CCAN_PlanFilters(const CCAN_ID_RANGE_T *pRanges, int numRanges, CCAN_FILTER_T *pFilters, int maxFilters)
+{
+	CCAN_FILTER_T block;
+	uint32_t lo, hi, ext, span;
+	int count = 0, r;
+
+	for (r = 0; r < numRanges; r++) {
+		ext = pRanges[r].first & (0x1 << 30);
+		lo = pRanges[r].first & filterIdMask(ext);
+		hi = pRanges[r].last & filterIdMask(ext);
+
+		/* Split the range into exact aligned power of 2 blocks */
+		while (lo <= hi) {
+			span = 1;
+			while (!(lo & span) && ((lo | ((span << 1) - 1)) <= hi) && (((span << 1) - 1) <= filterIdMask(ext))) {
+				span <<= 1;
+			}
+			block.id = lo | ext;
+			block.mask = filterIdMask(ext) & ~(span - 1);
+			count = planAddFilter(pFilters, count, maxFilters, &block);
+			if (count < 0) {
+				return 0;
+			}
+			if ((lo | (span - 1)) >= hi) {
+				break;
+			}
+			lo += span;
+		}
+	}
+
+	return count;
+}
+
+/* Check if an ID is in a set of ID ranges */
+bool Chip_CCAN_IsIDInRanges(const CCAN_ID_RANGE_T *pRanges, int numRanges, uint32_t id, bool extended)
+{
+	uint32_t ext = extended ? (0x1 << 30) : 0;
+	int r;
+
+	for (r = 0; r < numRanges; r++) {
+		if (((pRanges[r].first & (0x1 << 30)) == ext) &&
+			(id >= (pRanges[r].first & filterIdMask(ext))) && (id <= (pRanges[r].last & filterIdMask(ext)))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Program receive filters into free message objects */
+int Chip_CCAN_AddReceiveFilters(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, const CCAN_FILTER_T *pFilters, int numFilters)
+{
+	uint8_t msgNum;
+	int i;
+
+	for (i = 0; i < numFilters; i++) {
+		msgNum = getFreeMsgObject(pCCAN);
+		if (!msgNum) {
+			break;
+		}
+		setRxFilterObject(pCCAN, IFSel, msgNum, pFilters[i].id, pFilters[i].mask, true);
+	}
+
+	return i;
+}
+
 /* Remove a registered message ID from receiving */
 void Chip_CCAN_DeleteReceiveID(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint32_t id)
 {
@@ -32,6 +32,8 @@
 #ifndef __CCAN_18XX_43XX_H_
 #define __CCAN_18XX_43XX_H_
 
+#include "ring_buffer.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -494,6 +496,139 @@ void Chip_CCAN_AddReceiveID(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint32_t id)
  */
 void Chip_CCAN_DeleteReceiveID(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, uint32_t id);
 
+/**
+ * @brief CCAN receive ID range, first and last ID are inclusive
+ */
+typedef struct {
+	uint32_t first;	/**< First ID, if bit 30 is set then the range is extended IDs */
+	uint32_t last;	/**< Last ID, the same as first for a single ID */
+} CCAN_ID_RANGE_T;
+
+/**
+ * @brief CCAN acceptance filter, one message object
+ */
+typedef struct {
+	uint32_t id;	/**< ID to match, if bit 30 is set then this is extended frame */
+	uint32_t mask;	/**< ID bits that must match, 0 bits are don't care */
+} CCAN_FILTER_T;
+
+/**
+ * @brief	Compute mask/ID filters that accept a set of ID ranges
+ * @param	pRanges		: IDs to receive
+ * @param	numRanges	: Number of entries in @a pRanges
+ * @param	pFilters	: Filters computed, at least @a maxFilters entries
+ * @param	maxFilters	: Maximum number of filters, the message objects to spend
+ * @return	Number of filters in @a pFilters, or 0 if the ranges cannot be
+ * covered (standard and extended ranges with @a maxFilters of 1)
+ * @note	Each range is split into exact aligned blocks. While there are
+ * more blocks than @a maxFilters, the two filters whose merged filter adds
+ * the fewest unwanted IDs are merged, so the filters accept every ID in
+ * @a pRanges plus as few others as the filter count allows. Check received
+ * IDs with Chip_CCAN_IsIDInRanges() to drop the rest. Planning is
+ * quadratic in @a maxFilters for every block, so plan once at startup.
+ */
+int Chip_CCAN_PlanFilters(const CCAN_ID_RANGE_T *pRanges, int numRanges, CCAN_FILTER_T *pFilters, int maxFilters);
+
+/**
+ * @brief	Check if an ID is in a set of ID ranges
+ * @param	pRanges		: IDs to receive
+ * @param	numRanges	: Number of entries in @a pRanges
+ * @param	id			: Received message ID
+ * @param	extended	: true if @a id is an extended ID
+ * @return	true if @a id is in one of the ranges
+ */
+bool Chip_CCAN_IsIDInRanges(const CCAN_ID_RANGE_T *pRanges, int numRanges, uint32_t id, bool extended);
+
+/**
+ * @brief	Program receive filters into free message objects
+ * @param	pCCAN		: The base of CCAN peripheral on the chip
+ * @param	IFSel		: The Message interface to be used
+ * @param	pFilters	: Filters to program, from Chip_CCAN_PlanFilters()
+ * @param	numFilters	: Number of entries in @a pFilters
+ * @return	Number of filters programmed, less than @a numFilters when
+ * the message objects ran out
+ */
+int Chip_CCAN_AddReceiveFilters(LPC_CCAN_T *pCCAN, CCAN_MSG_IF_T IFSel, const CCAN_FILTER_T *pFilters, int numFilters);
+
+/** Maximum number of filter groups in a receive FIFO */
+#define CCAN_FIFO_MAX_GROUPS                          4
+
+/**
+ * @brief CCAN receive FIFO filter group, a chain of message objects
+ */
+typedef struct {
+	uint8_t first;	/**< First message object of the chain */
+	uint8_t last;	/**< Last message object of the chain, EoB set */
+} CCAN_FIFO_GROUP_T;
+
+/**
+ * @brief CCAN receive FIFO structure
+ */
+typedef struct {
+	LPC_CCAN_T *pCCAN;		/**< CCAN peripheral the FIFO receives on */
+	CCAN_MSG_IF_T IFSel;	/**< Message interface used by the interrupt handler */
+	RINGBUFF_T rb;			/**< Received messages, CCAN_MSG_OBJ_T items */
+	uint32_t objMask;		/**< Message objects owned by the FIFO, bit 0 is object 1 */
+	uint8_t numGroups;		/**< Number of filter groups in use */
+	CCAN_FIFO_GROUP_T groups[CCAN_FIFO_MAX_GROUPS];	/**< Filter groups */
+	uint32_t received;		/**< Messages moved to the ring buffer */
+	uint32_t hwOverruns;	/**< Messages lost because a chain was full (MsgLst) */
+	uint32_t rbOverruns;	/**< Messages dropped because the ring buffer was full */
+} CCAN_FIFO_T;
+
+/**
+ * @brief	Initialize a CCAN receive FIFO
+ * @param	pCCAN	: The base of CCAN peripheral on the chip
+ * @param	pFifo	: Pointer to the FIFO structure to initialize
+ * @param	IFSel	: The Message interface used by Chip_CCAN_FIFO_IRQHandler()
+ * @param	pBuffer	: Ring buffer storage for received messages
+ * @param	count	: Number of messages in @a pBuffer, must be a power of 2
+ * @return	Nothing
+ * @note	No other code may use @a IFSel while the CCAN interrupt is
+ * enabled, the other interface stays free for sending.
+ */
+void Chip_CCAN_FIFO_Init(LPC_CCAN_T *pCCAN, CCAN_FIFO_T *pFifo, CCAN_MSG_IF_T IFSel,
+						 CCAN_MSG_OBJ_T *pBuffer, int count);
+
+/**
+ * @brief	Add a filter group to a CCAN receive FIFO
+ * @param	pFifo	: Pointer to the FIFO structure
+ * @param	IFSel	: The Message interface to be used
+ * @param	id		: Message ID to receive, if bit 30 is set this is an extended ID
+ * @param	mask	: ID bits that must match @a id, CCAN_MSG_ID_STD_MASK or
+ *					  CCAN_MSG_ID_EXT_MASK to receive only @a id
+ * @param	numObjs	: Number of message objects chained for the group
+ * @return	First message object of the group, or 0 if there are not
+ * enough consecutive free message objects
+ * @note	The chain holds @a numObjs messages in hardware until
+ * Chip_CCAN_FIFO_IRQHandler() drains it, so size it for the longest burst
+ * that can arrive within the interrupt latency.
+ */
+uint8_t Chip_CCAN_FIFO_AddGroup(CCAN_FIFO_T *pFifo, CCAN_MSG_IF_T IFSel, uint32_t id, uint32_t mask, uint8_t numObjs);
+
+/**
+ * @brief	Drain a CCAN receive FIFO into its ring buffer
+ * @param	pFifo	: Pointer to the FIFO structure
+ * @param	msgNum	: Message object number from Chip_CCAN_GetIntID()
+ * @return	1 if @a msgNum belongs to the FIFO and was handled, otherwise 0
+ * @note	Call from the CCAN interrupt handler for message interrupts.
+ * All filter groups are drained, lowest message object first. Objects
+ * are handed back to the controller only after their chain was read, so
+ * messages of one group keep their order.
+ */
+int Chip_CCAN_FIFO_IRQHandler(CCAN_FIFO_T *pFifo, uint32_t msgNum);
+
+/**
+ * @brief	Read a received message from a CCAN receive FIFO
+ * @param	pFifo	: Pointer to the FIFO structure
+ * @param	pMsgObj	: Pointer to the message buffer to fill
+ * @return	1 if a message was read, 0 if the FIFO is empty
+ */
+STATIC INLINE int Chip_CCAN_FIFO_Read(CCAN_FIFO_T *pFifo, CCAN_MSG_OBJ_T *pMsgObj)
+{
+	return RingBuffer_Pop(&pFifo->rb, pMsgObj);
+}
+
 /**
  * @}
  */
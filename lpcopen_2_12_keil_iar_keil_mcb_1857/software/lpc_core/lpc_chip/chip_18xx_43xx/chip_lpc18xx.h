@@ -176,6 +176,7 @@ extern "C" {
 #include "ccan_18xx_43xx.h"
 #include "dac_18xx_43xx.h"
 #include "eeprom_18xx_43xx.h"
+#include "eeprom_store_18xx_43xx.h"
 #include "emc_18xx_43xx.h"
 #include "enet_18xx_43xx.h"
 #include "fmc_18xx_43xx.h"
@@ -194,14 +195,22 @@ extern "C" {
 #include "rtc_18xx_43xx.h"
 #include "sct_18xx_43xx.h"
 #include "sct_pwm_18xx_43xx.h"
+#include "sct_tstamp_18xx_43xx.h"
 #include "sdmmc_18xx_43xx.h"
 #include "ssp_18xx_43xx.h"
 #include "timer_18xx_43xx.h"
+#include "timebase_18xx_43xx.h"
 #include "uart_18xx_43xx.h"
 #include "usbhs_18xx_43xx.h"
 #include "wwdt_18xx_43xx.h"
 #include "romapi_18xx_43xx.h"
+#include "iap_store_18xx_43xx.h"
 #include "i2cm_18xx_43xx.h"
+#include "dvfs_18xx_43xx.h"
+#include "pwrmgr_18xx_43xx.h"
+#include "timerwheel_18xx_43xx.h"
+#include "timerlog_18xx_43xx.h"
+#include "crcsw_18xx_43xx.h"
 
 #ifdef __cplusplus
 }
@@ -70,6 +70,14 @@ static const CLK_PERIPH_TO_BASE_T periph_to_base[] = {
 /* Variables to use audio and usb pll frequency */
 static uint32_t audio_usb_pll_freq[CGU_AUDIO_PLL+1];
 
+/* Base clock rates worked out since the last clock change. Bit n of
+   baseRateValid is set when baseRate[n] holds the rate of base clock n,
+   rateGeneration counts the changes so a rate computed across one is
+   not kept. */
+static uint32_t baseRate[CLK_BASE_LAST];
+static volatile uint32_t baseRateValid;
+static volatile uint32_t rateGeneration;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -143,6 +151,7 @@ void Chip_Clock_EnableCrystal(void)
 
 	}
 	LPC_CGU->XTAL_OSC_CTRL = OldCrystalConfig;
+	Chip_Clock_InvalidateRates();
 
 	/* Delay for 250uSec */
 	while(delay--) {}
@@ -153,6 +162,7 @@ void Chip_Clock_DisableCrystal(void)
 {
 	/* Disable crystal oscillator */
 	LPC_CGU->XTAL_OSC_CTRL |= 1;
+	Chip_Clock_InvalidateRates();
 }
 
 /* Configures the main PLL */
@@ -252,6 +262,7 @@ uint32_t Chip_Clock_SetupMainPLLMult(CHIP_CGU_CLKIN_T Input, uint32_t mult)
 		return 0;
 	}
 	LPC_CGU->PLL1_CTRL = PLLReg & ~(1 << 0);
+	Chip_Clock_InvalidateRates();
 
 	/* Wait for 50uSec */
 	while(delay--) {}
@@ -295,6 +306,7 @@ void Chip_Clock_DisableMainPLL(void)
 {
 	/* power down main PLL */
 	LPC_CGU->PLL1_CTRL |= 1;
+	Chip_Clock_InvalidateRates();
 }
 
 /* Disables the main PLL */
@@ -302,6 +314,7 @@ void Chip_Clock_EnableMainPLL(void)
 {
 	/* power down main PLL */
 	LPC_CGU->PLL1_CTRL &= ~1;
+	Chip_Clock_InvalidateRates();
 }
 
 /* Returns the lock status of the main PLL */
@@ -328,6 +341,7 @@ void Chip_Clock_SetDivider(CHIP_CGU_IDIV_T Divider, CHIP_CGU_CLKIN_T Input, uint
 	else {
 		LPC_CGU->IDIV_CTRL[Divider] = reg | 1;	/* Power down this divider */
 	}
+	Chip_Clock_InvalidateRates();
 }
 
 /* Gets a CGU clock divider source */
@@ -431,7 +445,41 @@ uint32_t Chip_Clock_GetClockInputHz(CHIP_CGU_CLKIN_T input)
 /* Returns the frequency of the specified base clock source */
 uint32_t Chip_Clock_GetBaseClocktHz(CHIP_CGU_BASE_CLK_T clock)
 {
-	return Chip_Clock_GetClockInputHz(Chip_Clock_GetBaseClock(clock));
+	uint32_t rate, generation, primask;
+
+	if (clock >= CLK_BASE_NONE) {
+		return 0;
+	}
+	if (baseRateValid & (1 << clock)) {
+		return baseRate[clock];
+	}
+
+	generation = rateGeneration;
+	rate = Chip_Clock_GetClockInputHz(Chip_Clock_GetBaseClock(clock));
+
+	/* A rate of 0 (powered down, main PLL not locked yet) is not kept */
+	if (rate != 0) {
+		primask = __get_PRIMASK();
+		__disable_irq();
+		if (generation == rateGeneration) {
+			baseRate[clock] = rate;
+			baseRateValid |= (1 << clock);
+		}
+		__set_PRIMASK(primask);
+	}
+
+	return rate;
+}
+
+/* Drops the base clock rates worked out so far */
+void Chip_Clock_InvalidateRates(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	rateGeneration++;
+	baseRateValid = 0;
+	__set_PRIMASK(primask);
 }
 
 /* Sets a CGU Base Clock clock source */
@@ -460,6 +508,7 @@ void Chip_Clock_SetBaseClock(CHIP_CGU_BASE_CLK_T BaseClock, CHIP_CGU_CLKIN_T Inp
 	else {
 		LPC_CGU->BASE_CLK[BaseClock] = reg | 1;	/* Power down this base clock */
 	}
+	Chip_Clock_InvalidateRates();
 }
 
 /* Reads CGU Base Clock clock source information */
@@ -487,6 +536,7 @@ void Chip_Clock_EnableBaseClock(CHIP_CGU_BASE_CLK_T BaseClock)
 {
 	if (BaseClock < CLK_BASE_NONE) {
 		LPC_CGU->BASE_CLK[BaseClock] &= ~1;
+		Chip_Clock_InvalidateRates();
 	}
 }
 
@@ -495,6 +545,7 @@ void Chip_Clock_DisableBaseClock(CHIP_CGU_BASE_CLK_T BaseClock)
 {
 	if (BaseClock < CLK_BASE_NONE) {
 		LPC_CGU->BASE_CLK[BaseClock] |= 1;
+		Chip_Clock_InvalidateRates();
 	}
 }
 
@@ -687,18 +738,21 @@ void Chip_Clock_SetupPLL(CHIP_CGU_CLKIN_T Input, CHIP_CGU_USB_AUDIO_PLL_T pllnum
 		LPC_CGU->PLL0AUDIO_FRAC = pPLLSetup->fract;
 	}
 	audio_usb_pll_freq[pllnum] = pPLLSetup->freq;
+	Chip_Clock_InvalidateRates();
 }
 
 /* Enables the audio or USB PLL */
 void Chip_Clock_EnablePLL(CHIP_CGU_USB_AUDIO_PLL_T pllnum)
 {
 	LPC_CGU->PLL[pllnum].PLL_CTRL &= ~1;
+	Chip_Clock_InvalidateRates();
 }
 
 /* Disables the audio or USB PLL */
 void Chip_Clock_DisablePLL(CHIP_CGU_USB_AUDIO_PLL_T pllnum)
 {
 	LPC_CGU->PLL[pllnum].PLL_CTRL |= 1;
+	Chip_Clock_InvalidateRates();
 }
 
 /* Returns the PLL status */
@@ -176,6 +176,17 @@ uint32_t Chip_Clock_GetClockInputHz(CHIP_CGU_CLKIN_T input);
  */
 uint32_t Chip_Clock_GetBaseClocktHz(CHIP_CGU_BASE_CLK_T clock);
 
+/**
+ * @brief	Forget the base clock rates returned so far
+ * @return	Nothing
+ * @note	Chip_Clock_GetBaseClocktHz() and Chip_Clock_GetRate() keep the
+ * rate of each base clock once it has been worked out from the divider and
+ * PLL chain, so later calls are a single load. Every clock setting function
+ * of this driver calls this, code that changes the CGU registers, or the
+ * ENET clock mode in CREG6, in any other way must call it as well.
+ */
+void Chip_Clock_InvalidateRates(void);
+
 /**
  * @brief	Sets a CGU Base Clock clock source
  * @param	BaseClock	: CHIP_CGU_BASE_CLK_T value indicating which base clock to set
@@ -0,0 +1,210 @@
+/*
+ * @brief LPC18xx_43xx table driven CRC-32 and CRC-16
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Reflected CRC-32 polynomial and CRC-16 CCITT polynomial */
+#define CRC32_POLY              0xEDB88320
+#define CRC16_POLY              0x1021
+
+/* crc32Tbl[0] takes a byte, crc32Tbl[k] the byte k places further */
+static uint32_t crc32Tbl[4][256];
+static uint16_t crc16Tbl[2][256];
+static volatile bool crcReady;
+
+/* Copy state of Chip_CRCSW_CRC32_DMA() */
+static GPDMA_JOB_T crcJob;
+static volatile bool crcJobDone;
+static volatile Status crcJobStatus;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Completion of a chunk copy */
+static void crcJobCallback(GPDMA_JOB_T *pJob, Status status)
+{
+	crcJobStatus = status;
+	crcJobDone = true;
+}
+
+/* Queue the copy of a chunk, false if the CPU has to do the rest */
+static bool crcJobStart(uint8_t ChannelNum, void *pDst, const uint8_t *pSrc, uint32_t bytes)
+{
+	crcJobDone = false;
+	crcJobStatus = SUCCESS;
+	return Chip_GPDMA_MemcpyAsync(LPC_GPDMA, ChannelNum, &crcJob, pDst, pSrc, bytes,
+								  crcJobCallback) == SUCCESS;
+}
+
+/* Wait for the chunk copy, false if it failed */
+static bool crcJobWait(void)
+{
+	while (!crcJobDone) {}
+	return crcJobStatus == SUCCESS;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Build the CRC tables */
+void Chip_CRCSW_Init(void)
+{
+	uint32_t i, j, c;
+
+	for (i = 0; i < 256; i++) {
+		c = i;
+		for (j = 0; j < 8; j++) {
+			c = (c >> 1) ^ (CRC32_POLY & (0 - (c & 1)));
+		}
+		crc32Tbl[0][i] = c;
+
+		c = i << 8;
+		for (j = 0; j < 8; j++) {
+			c = (c << 1) ^ ((c & 0x8000) ? CRC16_POLY : 0);
+		}
+		crc16Tbl[0][i] = (uint16_t) c;
+	}
+	/* a table further on is the previous one shifted through a zero byte */
+	for (i = 0; i < 256; i++) {
+		for (j = 1; j < 4; j++) {
+			c = crc32Tbl[j - 1][i];
+			crc32Tbl[j][i] = (c >> 8) ^ crc32Tbl[0][c & 0xFF];
+		}
+		c = crc16Tbl[0][i];
+		crc16Tbl[1][i] = (uint16_t) ((c << 8) ^ crc16Tbl[0][c >> 8]);
+	}
+	crcReady = true;
+}
+
+/* Update a CRC-32 */
+HOTFUNC uint32_t Chip_CRCSW_CRC32(uint32_t crc, const void *pData, uint32_t size)
+{
+	const uint8_t *p = (const uint8_t *) pData;
+
+	if (!crcReady) {
+		Chip_CRCSW_Init();
+	}
+	crc = ~crc;
+
+	/* Bytes up to a word boundary, then a word per table step */
+	while ((size != 0) && (((uint32_t) p & 3) != 0)) {
+		crc = crc32Tbl[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+		size--;
+	}
+	while (size >= 4) {
+		crc ^= *(const uint32_t *) p;
+		crc = crc32Tbl[3][crc & 0xFF] ^ crc32Tbl[2][(crc >> 8) & 0xFF] ^
+			  crc32Tbl[1][(crc >> 16) & 0xFF] ^ crc32Tbl[0][crc >> 24];
+		p += 4;
+		size -= 4;
+	}
+	while (size--) {
+		crc = crc32Tbl[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+/* Update a CRC-16 */
+HOTFUNC uint16_t Chip_CRCSW_CRC16(uint16_t crc, const void *pData, uint32_t size)
+{
+	const uint8_t *p = (const uint8_t *) pData;
+	uint32_t c = crc;
+
+	if (!crcReady) {
+		Chip_CRCSW_Init();
+	}
+
+	/* Two bytes per table step, most significant bit first */
+	while (size >= 2) {
+		c ^= ((uint32_t) p[0] << 8) | p[1];
+		c = crc16Tbl[1][c >> 8] ^ crc16Tbl[0][c & 0xFF];
+		p += 2;
+		size -= 2;
+	}
+	if (size != 0) {
+		c = ((c << 8) & 0xFFFF) ^ crc16Tbl[0][(c >> 8) ^ *p];
+	}
+
+	return (uint16_t) c;
+}
+
+/* Update a CRC-32 with data the GPDMA copies into SRAM */
+uint32_t Chip_CRCSW_CRC32_DMA(uint32_t crc, uint8_t ChannelNum, const void *pData, uint32_t size,
+							  void *pBuf, uint32_t bufSize)
+{
+	const uint8_t *pSrc = (const uint8_t *) pData;
+	uint8_t *pHalf[2];
+	uint32_t half = (bufSize / 2) & ~3UL;
+	uint32_t len, next, cur = 0;
+
+	pHalf[0] = (uint8_t *) pBuf;
+	pHalf[1] = (uint8_t *) pBuf + half;
+	if ((half == 0) || (size <= half)) {
+		return Chip_CRCSW_CRC32(crc, pData, size);
+	}
+
+	len = half;
+	if (!crcJobStart(ChannelNum, pHalf[0], pSrc, len)) {
+		return Chip_CRCSW_CRC32(crc, pData, size);
+	}
+	while (size != 0) {
+		if (!crcJobWait()) {
+			break;
+		}
+		/* start the copy of the next chunk, then the CRC of this one */
+		next = MIN(size - len, half);
+		if ((next != 0) && !crcJobStart(ChannelNum, pHalf[cur ^ 1], pSrc + len, next)) {
+			crc = Chip_CRCSW_CRC32(crc, pHalf[cur], len);
+			pSrc += len;
+			size -= len;
+			break;
+		}
+		crc = Chip_CRCSW_CRC32(crc, pHalf[cur], len);
+		pSrc += len;
+		size -= len;
+		len = next;
+		cur ^= 1;
+	}
+
+	/* what the GPDMA could not copy */
+	return Chip_CRCSW_CRC32(crc, pSrc, size);
+}
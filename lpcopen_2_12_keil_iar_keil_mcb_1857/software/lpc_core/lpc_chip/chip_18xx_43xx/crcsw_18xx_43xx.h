@@ -0,0 +1,104 @@
+/*
+ * @brief LPC18xx_43xx table driven CRC-32 and CRC-16
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __CRCSW_18XX_43XX_H_
+#define __CRCSW_18XX_43XX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup CRCSW_18XX_43XX CHIP: LPC18xx/43xx table driven CRC
+ * @ingroup CHIP_18XX_43XX_Drivers
+ * The LPC18xx/43xx has no CRC engine. These CRCs take a word (CRC-32) or a
+ * halfword (CRC-16) per table step instead of a byte: four 256 entry tables
+ * for CRC-32 and two for CRC-16, 5KB built in RAM by Chip_CRCSW_Init().
+ * The lookups of a step do not depend on each other and RAM has no flash
+ * wait states, so a word costs about what a byte does bytewise. For images in slow memory such as SPIFI, Chip_CRCSW_CRC32_DMA()
+ * lets the GPDMA copy the next chunk into SRAM while the CPU runs the CRC
+ * of the current one.
+ * @{
+ */
+
+/** Start value of a CRC-16 */
+#define CRCSW_CRC16_INIT        0xFFFF
+
+/**
+ * @brief	Build the CRC tables
+ * @return	Nothing
+ * @note	The CRC functions call this on their first use. Call it at
+ *			start up to keep that out of time critical code.
+ */
+void Chip_CRCSW_Init(void);
+
+/**
+ * @brief	Update a CRC-32 (IEEE 802.3, as zlib and DSP_CRC32())
+ * @param	crc		: CRC of the data so far, 0 to start
+ * @param	pData	: Data
+ * @param	size	: Number of bytes
+ * @return	CRC of the data so far including pData
+ */
+HOTFUNC uint32_t Chip_CRCSW_CRC32(uint32_t crc, const void *pData, uint32_t size);
+
+/**
+ * @brief	Update a CRC-16 (CCITT polynomial 0x1021, most significant bit first)
+ * @param	crc		: CRC of the data so far, CRCSW_CRC16_INIT to start
+ * @param	pData	: Data
+ * @param	size	: Number of bytes
+ * @return	CRC of the data so far including pData, there is no final XOR
+ */
+HOTFUNC uint16_t Chip_CRCSW_CRC16(uint16_t crc, const void *pData, uint32_t size);
+
+/**
+ * @brief	Update a CRC-32 with data the GPDMA copies into SRAM
+ * @param	crc			: CRC of the data so far, 0 to start
+ * @param	ChannelNum	: GPDMA channel *must be obtained using Chip_GPDMA_GetFreeChannel()*
+ * @param	pData		: Data, typically in SPIFI or external memory
+ * @param	size		: Number of bytes
+ * @param	pBuf		: SRAM buffer, split in two halves the copy and CRC alternate on
+ * @param	bufSize		: Size of pBuf, a multiple of 8 bytes
+ * @return	CRC of the data so far including pData
+ * @note	Needs Chip_GPDMA_JobInit() and Chip_GPDMA_JobIRQHandler() in
+ *			DMA_IRQHandler(). Blocks until done. If a copy can not be
+ *			queued or fails, the rest is done by the CPU from pData.
+ */
+uint32_t Chip_CRCSW_CRC32_DMA(uint32_t crc, uint8_t ChannelNum, const void *pData, uint32_t size,
+							  void *pBuf, uint32_t bufSize);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRCSW_18XX_43XX_H_ */
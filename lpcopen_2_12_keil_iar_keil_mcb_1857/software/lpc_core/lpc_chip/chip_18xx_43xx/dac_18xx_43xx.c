@@ -43,6 +43,45 @@
  * Private functions
  ****************************************************************************/
 
+/* Claim a channel and build the circular descriptor list of a stream */
+static Status dacStreamSetup(DAC_STREAM_T *pStream, LPC_DAC_T *pDAC, LPC_GPDMA_T *pGPDMA,
+							 uint32_t *pBuffer, uint32_t samples, int nodes)
+{
+	uint32_t ctrl;
+	int i;
+
+	if ((samples == 0) || (samples > DAC_STREAM_MAX_SAMPLES)) {
+		return ERROR;
+	}
+
+	pStream->pDAC = pDAC;
+	pStream->pGPDMA = pGPDMA;
+	pStream->pBuffer = pBuffer;
+	pStream->samples = samples;
+	pStream->halves = 0;
+	pStream->errors = 0;
+
+	pStream->dmaChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, GPDMA_CONN_DAC);
+	if (pStream->dmaChannel >= GPDMA_NUMBER_CHANNELS) {
+		return ERROR;
+	}
+
+	/* One word per counter time out, interrupts only when there is a refill to do */
+	ctrl = GPDMA_DMACCxControl_TransferSize(samples) |
+		   GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1) |
+		   GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) |
+		   GPDMA_DMACCxControl_DestTransUseAHBMaster1 | GPDMA_DMACCxControl_SI |
+		   (pStream->callback ? GPDMA_DMACCxControl_I : 0);
+	for (i = 0; i < nodes; i++) {
+		pStream->desc[i].src = (uint32_t) &pBuffer[i * samples];
+		pStream->desc[i].dst = (uint32_t) &pDAC->CR;
+		pStream->desc[i].lli = (uint32_t) &pStream->desc[(i + 1) % nodes];
+		pStream->desc[i].ctrl = ctrl;
+	}
+
+	return SUCCESS;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -83,3 +122,93 @@ void Chip_DAC_SetBias(LPC_DAC_T *pDAC, uint32_t bias)
 	}
 }
 
+/* Set up double buffered playback with a refill callback */
+Status Chip_DAC_Stream_Init(DAC_STREAM_T *pStream, LPC_DAC_T *pDAC, LPC_GPDMA_T *pGPDMA,
+							uint32_t *pBuffer, uint32_t samples, DAC_STREAM_CALLBACK_T callback)
+{
+	pStream->callback = callback;
+	return dacStreamSetup(pStream, pDAC, pGPDMA, pBuffer, samples, 2);
+}
+
+/* Set up playback of a waveform table in a loop */
+Status Chip_DAC_Stream_InitTable(DAC_STREAM_T *pStream, LPC_DAC_T *pDAC, LPC_GPDMA_T *pGPDMA,
+								 const uint32_t *pTable, uint32_t samples)
+{
+	pStream->callback = NULL;
+	return dacStreamSetup(pStream, pDAC, pGPDMA, (uint32_t *) pTable, samples, 1);
+}
+
+/* Convert 10-bit values to DAC sample words */
+void Chip_DAC_Stream_Format(LPC_DAC_T *pDAC, uint32_t *pSamples, const uint16_t *pValues, uint32_t count)
+{
+	uint32_t bias = pDAC->CR & DAC_BIAS_EN;
+
+	while (count--) {
+		*pSamples++ = bias | DAC_VALUE(*pValues);
+		pValues++;
+	}
+}
+
+/* Start waveform playback */
+Status Chip_DAC_Stream_Start(DAC_STREAM_T *pStream, uint32_t rate)
+{
+	uint32_t div;
+
+	if (rate == 0) {
+		return ERROR;
+	}
+	div = Chip_Clock_GetRate(CLK_APB3_DAC) / rate;
+	if ((div == 0) || (div > 0xFFFF)) {
+		return ERROR;
+	}
+
+	pStream->half = 0;
+	Chip_DAC_ConfigDAConverterControl(pStream->pDAC, 0);
+	Chip_DAC_SetDMATimeOut(pStream->pDAC, div);
+
+	if (Chip_GPDMA_SGTransferPeripheral(pStream->pGPDMA, pStream->dmaChannel, GPDMA_CONN_DAC, &pStream->desc[0],
+										GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == ERROR) {
+		return ERROR;
+	}
+
+	/* Counter time outs request DMA and move the pre-buffer to the output */
+	Chip_DAC_ConfigDAConverterControl(pStream->pDAC, DAC_DBLBUF_ENA | DAC_CNT_ENA | DAC_DMA_ENA);
+
+	return SUCCESS;
+}
+
+/* Stop waveform playback */
+void Chip_DAC_Stream_Stop(DAC_STREAM_T *pStream)
+{
+	Chip_DAC_ConfigDAConverterControl(pStream->pDAC, 0);
+	Chip_GPDMA_ChannelCmd(pStream->pGPDMA, pStream->dmaChannel, DISABLE);
+	Chip_GPDMA_ClearIntPending(pStream->pGPDMA, GPDMA_STATCLR_INTTC, pStream->dmaChannel);
+	Chip_GPDMA_ClearIntPending(pStream->pGPDMA, GPDMA_STATCLR_INTERR, pStream->dmaChannel);
+}
+
+/* GPDMA interrupt handler for a DAC stream */
+bool Chip_DAC_Stream_IRQHandler(DAC_STREAM_T *pStream)
+{
+	uint32_t *pSamples;
+
+	if (!Chip_GPDMA_IntGetStatus(pStream->pGPDMA, GPDMA_STAT_INT, pStream->dmaChannel)) {
+		return false;
+	}
+
+	if (Chip_GPDMA_Interrupt(pStream->pGPDMA, pStream->dmaChannel) == ERROR) {
+		/* The channel halts on a bus error */
+		pStream->errors++;
+		Chip_DAC_Stream_Stop(pStream);
+		return true;
+	}
+
+	pSamples = &pStream->pBuffer[pStream->half * pStream->samples];
+	pStream->half ^= 1;
+	pStream->halves++;
+	if (pStream->callback) {
+		pStream->callback(pStream, pSamples, pStream->samples);
+	}
+
+	return true;
+}
+
@@ -32,6 +32,9 @@
 #ifndef __DAC_18XX_43XX_H_
 #define __DAC_18XX_43XX_H_
 
+/* The streaming engine keeps its GPDMA descriptors in the stream handle */
+#include "gpdma_18xx_43xx.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -155,6 +158,103 @@ STATIC INLINE IntStatus Chip_DAC_GetIntStatus(LPC_DAC_T *pDAC)
 	return (pDAC->CTRL & 0x01) ? SET : RESET;
 }
 
+/** Largest number of samples in a waveform table or in one half of a stream buffer */
+#define DAC_STREAM_MAX_SAMPLES  0xFFF
+
+struct DAC_STREAM;
+
+/**
+ * @brief DAC stream refill callback
+ * Called from Chip_DAC_Stream_IRQHandler() when one half of the buffer has
+ * been played. The @a count words at @a pSamples must be refilled, with
+ * Chip_DAC_Stream_Format() or DAC_VALUE(), before the DMA comes back to them.
+ */
+typedef void (*DAC_STREAM_CALLBACK_T)(struct DAC_STREAM *pStream, uint32_t *pSamples, uint32_t count);
+
+/**
+ * @brief DAC waveform playback handle
+ */
+typedef struct DAC_STREAM {
+	LPC_DAC_T *pDAC;				/*!< DAC peripheral */
+	LPC_GPDMA_T *pGPDMA;			/*!< GPDMA controller */
+	uint8_t dmaChannel;				/*!< Claimed GPDMA channel */
+	uint8_t half;					/*!< Buffer half the DMA finishes next, 0 or 1 */
+	uint32_t *pBuffer;				/*!< Sample words written to the DAC register */
+	uint32_t samples;				/*!< Table size, or samples in each half of the buffer */
+	DAC_STREAM_CALLBACK_T callback;	/*!< Refill callback, NULL in waveform table mode */
+	void *pData;					/*!< Caller data for the callback */
+	uint32_t halves;				/*!< Number of buffer halves played */
+	uint32_t errors;				/*!< DMA errors, playback stops on an error */
+	DMA_TransferDescriptor_t desc[2];	/*!< Circular list, one descriptor per table or buffer half */
+} DAC_STREAM_T;
+
+/**
+ * @brief	Set up double buffered playback with a refill callback
+ * @param	pStream		: Stream handle to initialize
+ * @param	pDAC		: pointer to LPC_DAC_T, already initialized
+ * @param	pGPDMA		: The GPDMA controller, already initialized
+ * @param	pBuffer		: Sample buffer of 2 * @a samples words, both halves filled
+ * @param	samples		: Samples per buffer half, 1 to DAC_STREAM_MAX_SAMPLES
+ * @param	callback	: Refill callback
+ * @return	SUCCESS, or ERROR if @a samples is out of range or no GPDMA channel is free
+ * @note	One GPDMA channel is claimed. Call Chip_DAC_Stream_IRQHandler()
+ *			from the DMA interrupt handler.
+ */
+Status Chip_DAC_Stream_Init(DAC_STREAM_T *pStream, LPC_DAC_T *pDAC, LPC_GPDMA_T *pGPDMA,
+							uint32_t *pBuffer, uint32_t samples, DAC_STREAM_CALLBACK_T callback);
+
+/**
+ * @brief	Set up playback of a waveform table in a loop
+ * @param	pStream		: Stream handle to initialize
+ * @param	pDAC		: pointer to LPC_DAC_T, already initialized
+ * @param	pGPDMA		: The GPDMA controller, already initialized
+ * @param	pTable		: One period of the waveform in sample words
+ * @param	samples		: Table size, 1 to DAC_STREAM_MAX_SAMPLES
+ * @return	SUCCESS, or ERROR if @a samples is out of range or no GPDMA channel is free
+ * @note	The table is replayed without any interrupt until stopped.
+ */
+Status Chip_DAC_Stream_InitTable(DAC_STREAM_T *pStream, LPC_DAC_T *pDAC, LPC_GPDMA_T *pGPDMA,
+								 const uint32_t *pTable, uint32_t samples);
+
+/**
+ * @brief	Convert 10-bit values to DAC sample words
+ * @param	pDAC		: pointer to LPC_DAC_T
+ * @param	pSamples	: Sample words to write
+ * @param	pValues		: 10-bit output values
+ * @param	count		: Number of values
+ * @return	Nothing
+ * @note	The current bias setting of the DAC is kept in every sample word.
+ */
+void Chip_DAC_Stream_Format(LPC_DAC_T *pDAC, uint32_t *pSamples, const uint16_t *pValues, uint32_t count);
+
+/**
+ * @brief	Start waveform playback
+ * @param	pStream		: Stream handle
+ * @param	rate		: Sample rate in Hz, at most 1 MHz (400 kHz with the bias set)
+ * @return	SUCCESS, or ERROR if the rate can't be made by the DAC counter or the DMA could not be started
+ * @note	The DAC counter paces the DMA and the double buffered DAC register
+ *			updates the output on each counter time out, so the sample timing
+ *			does not depend on DMA or CPU latency.
+ */
+Status Chip_DAC_Stream_Start(DAC_STREAM_T *pStream, uint32_t rate);
+
+/**
+ * @brief	Stop waveform playback
+ * @param	pStream		: Stream handle
+ * @return	Nothing
+ * @note	The output holds the last sample. The GPDMA channel stays claimed
+ *			for the next Chip_DAC_Stream_Start().
+ */
+void Chip_DAC_Stream_Stop(DAC_STREAM_T *pStream);
+
+/**
+ * @brief	GPDMA interrupt handler for a DAC stream
+ * @param	pStream		: Stream handle
+ * @return	true if the interrupt was for this stream's channel
+ * @note	Runs the refill callback for each played buffer half.
+ */
+bool Chip_DAC_Stream_IRQHandler(DAC_STREAM_T *pStream);
+
 /**
  * @}
  */
@@ -0,0 +1,305 @@
+/*
+ * @brief LPC18xx/43xx core clock scaling with clock change notifiers
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include "stopwatch.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Registered notifiers */
+static CHIP_DVFS_NOTIFIER_T *notifiers;
+
+/* Base clocks and dividers that belong on the main PLL, one bit each. They
+   are collected when first parked on the PLL input and put back once the
+   PLL runs again. */
+static uint32_t pllBases;
+static uint32_t pllDividers;
+static bool parked;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void notifyAll(CHIP_DVFS_EVENT_T event)
+{
+	CHIP_DVFS_NOTIFIER_T *pNotifier;
+
+	for (pNotifier = notifiers; pNotifier != NULL; pNotifier = pNotifier->next) {
+		pNotifier->notify(pNotifier, event);
+	}
+}
+
+/* Switch the main PLL users to Input, keeping their other settings */
+static void moveUsers(CHIP_CGU_CLKIN_T Input)
+{
+	CHIP_CGU_CLKIN_T in;
+	bool autoblocken, powerdn;
+	int i;
+
+	for (i = 0; i < CLK_BASE_LAST; i++) {
+		if (pllBases & (1 << i)) {
+			Chip_Clock_GetBaseClockOpts((CHIP_CGU_BASE_CLK_T) i, &in, &autoblocken, &powerdn);
+			Chip_Clock_SetBaseClock((CHIP_CGU_BASE_CLK_T) i, Input, autoblocken, powerdn);
+		}
+	}
+	for (i = 0; i < CLK_IDIV_LAST; i++) {
+		if (pllDividers & (1 << i)) {
+			Chip_Clock_SetDivider((CHIP_CGU_IDIV_T) i, Input,
+								  Chip_Clock_GetDividerDivisor((CHIP_CGU_IDIV_T) i) + 1);
+		}
+	}
+}
+
+/* Move everything off the main PLL so it can be stopped or reprogrammed */
+static void parkUsers(CHIP_CGU_CLKIN_T Input)
+{
+	CHIP_CGU_CLKIN_T in;
+	bool autoblocken, powerdn;
+	int i;
+
+	if (!parked) {
+		/* the core always follows, even if it did not run from the PLL */
+		pllBases = 1 << CLK_BASE_MX;
+		for (i = 0; i < CLK_BASE_LAST; i++) {
+			/* powered down bases count too, they may be enabled later */
+			Chip_Clock_GetBaseClockOpts((CHIP_CGU_BASE_CLK_T) i, &in, &autoblocken, &powerdn);
+			if (in == CLKIN_MAINPLL) {
+				pllBases |= 1 << i;
+			}
+		}
+		pllDividers = 0;
+		for (i = 0; i < CLK_IDIV_LAST; i++) {
+			if (Chip_Clock_GetDividerSource((CHIP_CGU_IDIV_T) i) == CLKIN_MAINPLL) {
+				pllDividers |= 1 << i;
+			}
+		}
+		parked = true;
+	}
+	moveUsers(Input);
+}
+
+/* Program the main PLL and wait for it to lock */
+static uint32_t startPLL(CHIP_CGU_CLKIN_T Input, uint32_t MinHz, uint32_t Hz)
+{
+	uint32_t freq = Chip_Clock_SetupMainPLLHz(Input, MinHz, Hz, Hz);
+
+	if (freq != 0) {
+		while (!Chip_Clock_MainPLLLocked()) {}
+	}
+	return freq;
+}
+
+/* Keep the SysTick period when it runs from the core clock */
+static void rescaleSysTick(uint32_t oldHz, uint32_t newHz)
+{
+	const uint32_t mask = SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_CLKSOURCE_Msk;
+	uint64_t load;
+
+	if (((SysTick->CTRL & mask) == mask) && (oldHz != 0)) {
+		load = (((uint64_t) (SysTick->LOAD + 1)) * newHz) / oldHz;
+		if (load > (SysTick_LOAD_RELOAD_Msk + 1)) {
+			load = SysTick_LOAD_RELOAD_Msk + 1;
+		}
+		SysTick->LOAD = (uint32_t) load - 1;
+		SysTick->VAL = 0;
+	}
+}
+
+static void uartNotify(CHIP_DVFS_NOTIFIER_T *pNotifier, CHIP_DVFS_EVENT_T event)
+{
+	LPC_USART_T *pUART = (LPC_USART_T *) pNotifier->pPeriph;
+
+	if (event == DVFS_PRE_CHANGE) {
+		/* a character on the wire would be garbled by the new divider */
+		while ((Chip_UART_ReadLineStatus(pUART) & UART_LSR_TEMT) == 0) {}
+	}
+	else {
+		Chip_UART_SetBaudFDR(pUART, pNotifier->rate);
+	}
+}
+
+static void sspNotify(CHIP_DVFS_NOTIFIER_T *pNotifier, CHIP_DVFS_EVENT_T event)
+{
+	LPC_SSP_T *pSSP = (LPC_SSP_T *) pNotifier->pPeriph;
+
+	if (event == DVFS_PRE_CHANGE) {
+		while (Chip_SSP_GetStatus(pSSP, SSP_STAT_BSY) == SET) {}
+	}
+	else {
+		Chip_SSP_SetBitRate(pSSP, pNotifier->rate);
+	}
+}
+
+static void i2cNotify(CHIP_DVFS_NOTIFIER_T *pNotifier, CHIP_DVFS_EVENT_T event)
+{
+	if (event == DVFS_POST_CHANGE) {
+		Chip_I2C_SetClockRate((I2C_ID_T) (uint32_t) pNotifier->pPeriph, pNotifier->rate);
+	}
+}
+
+static void stopWatchNotify(CHIP_DVFS_NOTIFIER_T *pNotifier, CHIP_DVFS_EVENT_T event)
+{
+	if (event == DVFS_POST_CHANGE) {
+		StopWatch_Init();
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Register a clock change notifier */
+void Chip_DVFS_Register(CHIP_DVFS_NOTIFIER_T *pNotifier)
+{
+	CHIP_DVFS_NOTIFIER_T *p;
+
+	for (p = notifiers; p != NULL; p = p->next) {
+		if (p == pNotifier) {
+			return;
+		}
+	}
+	pNotifier->next = notifiers;
+	notifiers = pNotifier;
+}
+
+/* Remove a clock change notifier */
+void Chip_DVFS_Unregister(CHIP_DVFS_NOTIFIER_T *pNotifier)
+{
+	CHIP_DVFS_NOTIFIER_T **pp;
+
+	for (pp = &notifiers; *pp != NULL; pp = &(*pp)->next) {
+		if (*pp == pNotifier) {
+			*pp = pNotifier->next;
+			return;
+		}
+	}
+}
+
+/* Change the core clock and rescale the registered drivers */
+uint32_t Chip_DVFS_SetCoreClock(CHIP_CGU_CLKIN_T clkin, uint32_t freq)
+{
+	uint32_t oldHz, inHz, pllHz = 0, primask;
+
+	SystemCoreClockUpdate();
+	oldHz = SystemCoreClock;
+
+	/* let the drivers finish what is on the wire at the old rate */
+	notifyAll(DVFS_PRE_CHANGE);
+
+	if (clkin == CLKIN_CRYSTAL) {
+		Chip_Clock_EnableCrystal();
+	}
+	inHz = Chip_Clock_GetClockInputHz(clkin);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (freq > oldHz) {
+		Chip_CREG_SetFlashAcceleration(freq);
+	}
+
+	parkUsers(clkin);
+	if (freq > inHz) {
+		if (freq > DVFS_RAMP_FREQ_LIMIT) {
+			/* step through the ramp rate on the PLL, see Chip_SetupCoreClock() */
+			if (startPLL(clkin, inHz, DVFS_RAMP_FREQ_LIMIT) != 0) {
+				Chip_Clock_SetBaseClock(CLK_BASE_MX, CLKIN_MAINPLL, true, false);
+			}
+		}
+		pllHz = startPLL(clkin, inHz, freq);
+		if (pllHz != 0) {
+			moveUsers(CLKIN_MAINPLL);
+			parked = false;
+		}
+		else {
+			/* rate not reachable, stay on the PLL input */
+			Chip_Clock_SetBaseClock(CLK_BASE_MX, clkin, true, false);
+		}
+	}
+	if (parked) {
+		Chip_Clock_DisableMainPLL();
+	}
+
+	/* flash wait states down to the rate reached */
+	SystemCoreClockUpdate();
+	Chip_CREG_SetFlashAcceleration(SystemCoreClock);
+	rescaleSysTick(oldHz, SystemCoreClock);
+
+	notifyAll(DVFS_POST_CHANGE);
+	__set_PRIMASK(primask);
+
+	if ((freq > inHz) && (pllHz == 0)) {
+		return 0;
+	}
+	return SystemCoreClock;
+}
+
+/* Keep a UART at its baud rate across clock changes */
+void Chip_DVFS_RegisterUART(CHIP_DVFS_NOTIFIER_T *pNotifier, LPC_USART_T *pUART, uint32_t baud)
+{
+	pNotifier->notify = uartNotify;
+	pNotifier->pPeriph = pUART;
+	pNotifier->rate = baud;
+	Chip_DVFS_Register(pNotifier);
+}
+
+/* Keep an SSP at its bit rate across clock changes */
+void Chip_DVFS_RegisterSSP(CHIP_DVFS_NOTIFIER_T *pNotifier, LPC_SSP_T *pSSP, uint32_t bitRate)
+{
+	pNotifier->notify = sspNotify;
+	pNotifier->pPeriph = pSSP;
+	pNotifier->rate = bitRate;
+	Chip_DVFS_Register(pNotifier);
+}
+
+/* Keep an I2C bus at its clock rate across clock changes */
+void Chip_DVFS_RegisterI2C(CHIP_DVFS_NOTIFIER_T *pNotifier, I2C_ID_T id, uint32_t clockrate)
+{
+	pNotifier->notify = i2cNotify;
+	pNotifier->pPeriph = (void *) (uint32_t) id;
+	pNotifier->rate = clockrate;
+	Chip_DVFS_Register(pNotifier);
+}
+
+/* Keep the StopWatch tick conversions right across clock changes */
+void Chip_DVFS_RegisterStopWatch(CHIP_DVFS_NOTIFIER_T *pNotifier)
+{
+	pNotifier->notify = stopWatchNotify;
+	pNotifier->pPeriph = NULL;
+	pNotifier->rate = 0;
+	Chip_DVFS_Register(pNotifier);
+}
@@ -0,0 +1,152 @@
+/*
+ * @brief LPC18xx/43xx core clock scaling with clock change notifiers
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef _DVFS_18XX_43XX_H_
+#define _DVFS_18XX_43XX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup DVFS_18XX_43XX CHIP: LPC18xx/43xx core clock scaling
+ * @ingroup CLOCK_18XX_43XX
+ * Changes the core clock at run time and tells registered drivers about
+ * it. Every base clock and divider running from the main PLL moves with
+ * the core: below the PLL input rate they are parked on the PLL input and
+ * the PLL is stopped, above it they go back to the PLL. Notifiers are
+ * called before the change, with interrupts enabled so transfers can
+ * drain, and after it with interrupts masked, so no interrupt sees a
+ * peripheral programmed for the old rate. The flash accelerator and a
+ * running SysTick are adjusted by the service itself.
+ * @{
+ */
+
+/** A core clock above this rate has to be reached through a step at this rate */
+#define DVFS_RAMP_FREQ_LIMIT    110000000UL
+
+/**
+ * @brief Clock change events
+ */
+typedef enum {
+	DVFS_PRE_CHANGE,	/*!< Clocks are about to change, finish transfers */
+	DVFS_POST_CHANGE,	/*!< Clocks have changed, reprogram rates */
+} CHIP_DVFS_EVENT_T;
+
+struct CHIP_DVFS_NOTIFIER;
+
+/** Clock change callback */
+typedef void (*CHIP_DVFS_CALLBACK_T)(struct CHIP_DVFS_NOTIFIER *pNotifier, CHIP_DVFS_EVENT_T event);
+
+/**
+ * @brief Clock change notifier, storage is owned by the caller
+ */
+typedef struct CHIP_DVFS_NOTIFIER {
+	CHIP_DVFS_CALLBACK_T notify;		/*!< Called for each event */
+	void *pPeriph;						/*!< Peripheral of the stock notifiers */
+	uint32_t rate;						/*!< Baud, bit or bus rate to keep */
+	struct CHIP_DVFS_NOTIFIER *next;	/*!< Next registered notifier */
+} CHIP_DVFS_NOTIFIER_T;
+
+/**
+ * @brief	Register a clock change notifier
+ * @param	pNotifier	: Notifier with notify (and its own fields) filled in
+ * @return	Nothing
+ * @note	Registering a notifier twice has no effect.
+ */
+void Chip_DVFS_Register(CHIP_DVFS_NOTIFIER_T *pNotifier);
+
+/**
+ * @brief	Remove a clock change notifier
+ * @param	pNotifier	: Registered notifier
+ * @return	Nothing
+ */
+void Chip_DVFS_Unregister(CHIP_DVFS_NOTIFIER_T *pNotifier);
+
+/**
+ * @brief	Change the core clock and rescale the registered drivers
+ * @param	clkin	: PLL input, or direct source at low rates (CLKIN_CRYSTAL or CLKIN_IRC)
+ * @param	freq	: Desired core clock in Hz
+ * @return	New core clock in Hz (SystemCoreClock), 0 if the PLL can not reach @a freq
+ * @note	A rate up to the rate of @a clkin runs the core straight from
+ *			@a clkin at its own rate with the main PLL powered down, e.g.
+ *			12MHz when idle.
+ *			Above DVFS_RAMP_FREQ_LIMIT the switch steps through that rate
+ *			as Chip_SetupCoreClock() does. Call from thread level only.
+ */
+uint32_t Chip_DVFS_SetCoreClock(CHIP_CGU_CLKIN_T clkin, uint32_t freq);
+
+/**
+ * @brief	Keep a UART at its baud rate across clock changes
+ * @param	pNotifier	: Notifier storage
+ * @param	pUART		: UART to rescale
+ * @param	baud		: Baud rate, set with Chip_UART_SetBaudFDR()
+ * @return	Nothing
+ * @note	Waits for the transmitter to empty before the change.
+ */
+void Chip_DVFS_RegisterUART(CHIP_DVFS_NOTIFIER_T *pNotifier, LPC_USART_T *pUART, uint32_t baud);
+
+/**
+ * @brief	Keep an SSP at its bit rate across clock changes
+ * @param	pNotifier	: Notifier storage
+ * @param	pSSP		: SSP to rescale
+ * @param	bitRate		: Bit rate, set with Chip_SSP_SetBitRate()
+ * @return	Nothing
+ * @note	Waits for the SSP to go idle before the change.
+ */
+void Chip_DVFS_RegisterSSP(CHIP_DVFS_NOTIFIER_T *pNotifier, LPC_SSP_T *pSSP, uint32_t bitRate);
+
+/**
+ * @brief	Keep an I2C bus at its clock rate across clock changes
+ * @param	pNotifier	: Notifier storage
+ * @param	id			: I2C bus to rescale
+ * @param	clockrate	: Bus clock, set with Chip_I2C_SetClockRate()
+ * @return	Nothing
+ */
+void Chip_DVFS_RegisterI2C(CHIP_DVFS_NOTIFIER_T *pNotifier, I2C_ID_T id, uint32_t clockrate);
+
+/**
+ * @brief	Keep the StopWatch tick conversions right across clock changes
+ * @param	pNotifier	: Notifier storage
+ * @return	Nothing
+ * @note	The tick rate follows the timer clock, a stopwatch started
+ *			before a change measures in mixed ticks.
+ */
+void Chip_DVFS_RegisterStopWatch(CHIP_DVFS_NOTIFIER_T *pNotifier);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DVFS_18XX_43XX_H_ */
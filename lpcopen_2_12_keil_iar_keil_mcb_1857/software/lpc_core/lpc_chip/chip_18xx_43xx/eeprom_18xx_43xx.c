@@ -35,6 +35,9 @@
  * Private types/enumerations/variables
  ****************************************************************************/
 
+/* Wait function of Chip_EEPROM_WaitForIntStatus(), NULL to spin */
+static EEPROM_WAITFUNC_T eepromWaitFunc;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -89,12 +92,27 @@ void Chip_EEPROM_EraseProgramPage(LPC_EEPROM_T *pEEPROM)
 void Chip_EEPROM_WaitForIntStatus(LPC_EEPROM_T *pEEPROM, uint32_t mask)
 {
 	uint32_t status;
-	while (1) {
-		status = Chip_EEPROM_GetIntStatus(pEEPROM);
-		if ((status & mask) == mask) {
-			break;
+
+	if (eepromWaitFunc != NULL) {
+		eepromWaitFunc(pEEPROM, mask);
+	}
+	else {
+		while (1) {
+			status = Chip_EEPROM_GetIntStatus(pEEPROM);
+			if ((status & mask) == mask) {
+				break;
+			}
 		}
 	}
 	Chip_EEPROM_ClearIntStatus(pEEPROM, mask);
 }
 
+/* Set the wait function */
+EEPROM_WAITFUNC_T Chip_EEPROM_SetWaitFunc(EEPROM_WAITFUNC_T func)
+{
+	EEPROM_WAITFUNC_T old = eepromWaitFunc;
+
+	eepromWaitFunc = func;
+	return old;
+}
+
@@ -97,6 +97,11 @@ typedef struct {				/* EEPROM Structure */
  */
 #define EEPROM_INT_ENDOFPROG            (1 << 2)
 
+/**
+ * @brief EEPROM wait function, returns once all bits of mask are set in INTSTAT
+ */
+typedef void (*EEPROM_WAITFUNC_T)(LPC_EEPROM_T *pEEPROM, uint32_t mask);
+
 /**
  * @brief	Put EEPROM device in power down mode
  * @param	pEEPROM	: Pointer to EEPROM peripheral block structure
@@ -197,9 +202,22 @@ void Chip_EEPROM_EraseProgramPage(LPC_EEPROM_T *pEEPROM);
  * @param	pEEPROM	: Pointer to EEPROM peripheral block structure
  * @param	mask	: Expected interrupt
  * @return	Nothing
+ * @note	Spins on the status register unless a wait function was set
+ *			with Chip_EEPROM_SetWaitFunc(). The status bits are cleared on
+ *			return either way.
  */
 void Chip_EEPROM_WaitForIntStatus(LPC_EEPROM_T *pEEPROM, uint32_t mask);
 
+/**
+ * @brief	Set the function Chip_EEPROM_WaitForIntStatus() waits with
+ * @param	func	: Wait function, NULL to spin on the status register
+ * @return	Previous wait function
+ * @note	An RTOS application can sleep in this function, so erase and
+ *			program cycles, including those of the EEPROM store, give the
+ *			CPU to other tasks.
+ */
+EEPROM_WAITFUNC_T Chip_EEPROM_SetWaitFunc(EEPROM_WAITFUNC_T func);
+
 /**
  * @brief	Enable EEPROM interrupt
  * @param	pEEPROM	: Pointer to EEPROM peripheral block structure
@@ -0,0 +1,339 @@
+/*
+ * @brief LPC18xx/43xx EEPROM record store
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include "string.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Page layout: magic, sequence number, then records up to an end word. A
+   record is a header word (key [7:0], data length [15:8], check [31:16])
+   followed by the data padded to words. */
+#define STORE_MAGIC         0x5453564B	/* "KVST" */
+#define STORE_HDR_BYTES     8
+#define STORE_END           0xFFFFFFFF
+#define STORE_NO_RECORD     0xFFFF
+#define STORE_NO_PAGE       0xFF
+#define STORE_PAGE_WORDS    (EEPROM_PAGE_SIZE / 4)
+#define STORE_REC_BYTES(len)    (4 + (((len) + 3) & ~3))
+
+#define REC_KEY(hdr)        ((hdr) & 0xFF)
+#define REC_LEN(hdr)        (((hdr) >> 8) & 0xFF)
+#define REC_CHECK(hdr)      ((hdr) >> 16)
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Byte n of the data following a record header */
+STATIC INLINE uint8_t recordByte(const uint32_t *pRec, int n)
+{
+	return (uint8_t) (pRec[1 + (n >> 2)] >> ((n & 3) * 8));
+}
+
+/* Fletcher-16 over the key, length and data of a record */
+STATIC uint16_t recordCheck(const uint32_t *pRec, uint8_t key, uint8_t len)
+{
+	uint32_t sum1 = key, sum2 = key;
+	int i;
+
+	sum1 = (sum1 + len) % 255;
+	sum2 = (sum2 + sum1) % 255;
+	for (i = 0; i < len; i++) {
+		sum1 = (sum1 + recordByte(pRec, i)) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+
+	return (uint16_t) ((sum2 << 8) | sum1);
+}
+
+/* Current contents of a ring page, the RAM copy if there is one */
+STATIC const uint32_t *pageWords(EEPROM_STORE_T *pStore, uint8_t page)
+{
+	if (pStore->buf[0].page == page) {
+		return pStore->buf[0].data;
+	}
+	if (pStore->buf[1].page == page) {
+		return pStore->buf[1].data;
+	}
+	return (const uint32_t *) EEPROM_ADDRESS(pStore->firstPage + page, 0);
+}
+
+/* Walk the records of a page, optionally indexing them; returns the end offset */
+STATIC int scanPage(EEPROM_STORE_T *pStore, const uint32_t *pWords, uint8_t page, bool addToIndex)
+{
+	uint32_t hdr;
+	int offset = STORE_HDR_BYTES;
+
+	while (offset + 4 <= EEPROM_PAGE_SIZE) {
+		hdr = pWords[offset / 4];
+		if ((hdr == STORE_END) || (REC_LEN(hdr) > EEPROM_STORE_MAX_DATA) ||
+			(offset + STORE_REC_BYTES(REC_LEN(hdr)) > EEPROM_PAGE_SIZE) ||
+			(REC_CHECK(hdr) != recordCheck(&pWords[offset / 4], REC_KEY(hdr), REC_LEN(hdr)))) {
+			/* End of the page, or a record cut short by a reset */
+			break;
+		}
+		if (addToIndex && (REC_KEY(hdr) < EEPROM_STORE_MAX_KEYS)) {
+			pStore->index[REC_KEY(hdr)] = (page << 8) | offset;
+		}
+		offset += STORE_REC_BYTES(REC_LEN(hdr));
+	}
+
+	return offset;
+}
+
+/* Start an empty page in a page buffer */
+STATIC void startPage(EEPROM_STORE_T *pStore, EEPROM_STORE_BUF_T *pBuf, uint8_t page)
+{
+	memset(pBuf->data, 0xFF, sizeof(pBuf->data));
+	pBuf->data[0] = STORE_MAGIC;
+	pBuf->data[1] = ++pStore->seq;
+	pBuf->page = page;
+	pBuf->used = STORE_HDR_BYTES;
+	pBuf->dirty = true;
+}
+
+/* Copy a page buffer to the page latch and start the program cycle */
+STATIC void programPage(EEPROM_STORE_T *pStore, EEPROM_STORE_BUF_T *pBuf)
+{
+	uint32_t *pEeprom = (uint32_t *) EEPROM_ADDRESS(pStore->firstPage + pBuf->page, 0);
+	int i;
+
+	for (i = 0; i < STORE_PAGE_WORDS; i++) {
+		pEeprom[i] = pBuf->data[i];
+	}
+	Chip_EEPROM_ClearIntStatus(pStore->pEEPROM, EEPROM_INT_ENDOFPROG);
+	Chip_EEPROM_SetCmd(pStore->pEEPROM, EEPROM_CMD_ERASE_PRG_PAGE);
+	pStore->programming = true;
+	pBuf->dirty = false;
+	pStore->programs++;
+}
+
+/* Wait for a running program cycle */
+STATIC void waitProgram(EEPROM_STORE_T *pStore)
+{
+	if (pStore->programming) {
+		Chip_EEPROM_WaitForIntStatus(pStore->pEEPROM, EEPROM_INT_ENDOFPROG);
+		pStore->programming = false;
+	}
+}
+
+/* Move on to the next, oldest, page of the ring keeping its current records */
+STATIC void nextPage(EEPROM_STORE_T *pStore)
+{
+	EEPROM_STORE_BUF_T *pNew = &pStore->buf[pStore->cur ^ 1];
+	uint32_t old[STORE_PAGE_WORDS];
+	uint8_t page = (pStore->buf[pStore->cur].page + 1) % pStore->numPages;
+	uint16_t loc;
+	int key, bytes;
+
+	/* The spare buffer still holds a full page that was never programmed */
+	if (pNew->dirty) {
+		waitProgram(pStore);
+		programPage(pStore, pNew);
+	}
+	waitProgram(pStore);
+
+	memcpy(old, pageWords(pStore, page), sizeof(old));
+	startPage(pStore, pNew, page);
+	for (key = 0; key < EEPROM_STORE_MAX_KEYS; key++) {
+		loc = pStore->index[key];
+		if ((loc != STORE_NO_RECORD) && ((loc >> 8) == page)) {
+			bytes = STORE_REC_BYTES(REC_LEN(old[(loc & 0xFF) / 4]));
+			memcpy((uint8_t *) pNew->data + pNew->used, (uint8_t *) old + (loc & 0xFF), bytes);
+			pStore->index[key] = (page << 8) | pNew->used;
+			pNew->used += bytes;
+		}
+	}
+	pStore->cur ^= 1;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Open an EEPROM record store */
+void Chip_EEPROM_Store_Init(EEPROM_STORE_T *pStore, LPC_EEPROM_T *pEEPROM, uint8_t firstPage, uint8_t numPages)
+{
+	const uint32_t *pWords;
+	EEPROM_STORE_BUF_T *pBuf;
+	uint32_t seq, lastSeq = 0;
+	int i, page, last = -1, end;
+
+	memset(pStore, 0, sizeof(*pStore));
+	pStore->pEEPROM = pEEPROM;
+	pStore->firstPage = firstPage;
+	pStore->numPages = numPages;
+	pStore->buf[0].page = pStore->buf[1].page = STORE_NO_PAGE;
+	for (i = 0; i < EEPROM_STORE_MAX_KEYS; i++) {
+		pStore->index[i] = STORE_NO_RECORD;
+	}
+	Chip_EEPROM_SetAutoProg(pEEPROM, EEPROM_AUTOPROG_OFF);
+
+	/* Replay the valid pages oldest first, later records replace earlier ones */
+	while (1) {
+		page = -1;
+		for (i = 0; i < numPages; i++) {
+			pWords = (const uint32_t *) EEPROM_ADDRESS(firstPage + i, 0);
+			seq = pWords[1];
+			if ((pWords[0] == STORE_MAGIC) && (seq > lastSeq) && ((page < 0) || (seq < pStore->seq))) {
+				page = i;
+				pStore->seq = seq;
+			}
+		}
+		if (page < 0) {
+			break;
+		}
+		scanPage(pStore, (const uint32_t *) EEPROM_ADDRESS(firstPage + page, 0), page, true);
+		lastSeq = pStore->seq;
+		last = page;
+	}
+	pStore->seq = lastSeq;
+
+	/* Keep appending to the newest page */
+	pBuf = &pStore->buf[0];
+	if (last < 0) {
+		startPage(pStore, pBuf, 0);
+		pBuf->dirty = false;
+	}
+	else {
+		memcpy(pBuf->data, (const void *) EEPROM_ADDRESS(firstPage + last, 0), sizeof(pBuf->data));
+		end = scanPage(pStore, pBuf->data, last, false);
+		memset((uint8_t *) pBuf->data + end, 0xFF, EEPROM_PAGE_SIZE - end);
+		pBuf->page = last;
+		pBuf->used = end;
+	}
+}
+
+/* Read the latest record of a key */
+int Chip_EEPROM_Store_Read(EEPROM_STORE_T *pStore, uint8_t key, void *pData, int maxLen)
+{
+	const uint32_t *pRec;
+	uint8_t *pBytes = (uint8_t *) pData;
+	uint16_t loc;
+	int i, len;
+
+	if ((key >= EEPROM_STORE_MAX_KEYS) || (pStore->index[key] == STORE_NO_RECORD)) {
+		return -1;
+	}
+
+	loc = pStore->index[key];
+	pRec = &pageWords(pStore, loc >> 8)[(loc & 0xFF) / 4];
+	len = REC_LEN(pRec[0]);
+	for (i = 0; (i < len) && (i < maxLen); i++) {
+		pBytes[i] = recordByte(pRec, i);
+	}
+
+	return len;
+}
+
+/* Write a record for a key */
+bool Chip_EEPROM_Store_Write(EEPROM_STORE_T *pStore, uint8_t key, const void *pData, int len)
+{
+	const uint8_t *pBytes = (const uint8_t *) pData;
+	const uint32_t *pRec;
+	EEPROM_STORE_BUF_T *pBuf;
+	uint32_t *pDst;
+	uint16_t loc;
+	int i, tries;
+
+	if ((key >= EEPROM_STORE_MAX_KEYS) || (len < 0) || (len > EEPROM_STORE_MAX_DATA)) {
+		return false;
+	}
+
+	/* Unchanged values cost nothing */
+	loc = pStore->index[key];
+	if (loc != STORE_NO_RECORD) {
+		pRec = &pageWords(pStore, loc >> 8)[(loc & 0xFF) / 4];
+		if (REC_LEN(pRec[0]) == len) {
+			for (i = 0; (i < len) && (recordByte(pRec, i) == pBytes[i]); i++) {}
+			if (i == len) {
+				return true;
+			}
+		}
+	}
+
+	for (tries = 0; pStore->buf[pStore->cur].used + STORE_REC_BYTES(len) > EEPROM_PAGE_SIZE; tries++) {
+		if (tries >= pStore->numPages) {
+			return false;
+		}
+		nextPage(pStore);
+	}
+
+	pBuf = &pStore->buf[pStore->cur];
+	pDst = &pBuf->data[pBuf->used / 4];
+	for (i = 1; i < STORE_REC_BYTES(len) / 4; i++) {
+		pDst[i] = 0;
+	}
+	for (i = 0; i < len; i++) {
+		pDst[1 + (i >> 2)] |= (uint32_t) pBytes[i] << ((i & 3) * 8);
+	}
+	pDst[0] = key | (len << 8);
+	pDst[0] |= (uint32_t) recordCheck(pDst, key, len) << 16;
+
+	pStore->index[key] = (pBuf->page << 8) | pBuf->used;
+	pBuf->used += STORE_REC_BYTES(len);
+	pBuf->dirty = true;
+
+	return true;
+}
+
+/* Program pending store pages, without waiting */
+bool Chip_EEPROM_Store_Service(EEPROM_STORE_T *pStore, bool commitAll)
+{
+	EEPROM_STORE_BUF_T *pFull = &pStore->buf[pStore->cur ^ 1];
+	EEPROM_STORE_BUF_T *pCur = &pStore->buf[pStore->cur];
+
+	if (pStore->programming) {
+		if (!(Chip_EEPROM_GetIntStatus(pStore->pEEPROM) & EEPROM_INT_ENDOFPROG)) {
+			return false;
+		}
+		Chip_EEPROM_ClearIntStatus(pStore->pEEPROM, EEPROM_INT_ENDOFPROG);
+		pStore->programming = false;
+	}
+
+	if (pFull->dirty) {
+		programPage(pStore, pFull);
+		return false;
+	}
+	if (pCur->dirty && commitAll) {
+		programPage(pStore, pCur);
+		return false;
+	}
+
+	return true;
+}
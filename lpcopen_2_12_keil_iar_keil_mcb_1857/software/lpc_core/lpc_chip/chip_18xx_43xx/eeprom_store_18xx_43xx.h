@@ -0,0 +1,142 @@
+/*
+ * @brief LPC18xx/43xx EEPROM record store
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef _EEPROM_STORE_18XX_43XX_H_
+#define _EEPROM_STORE_18XX_43XX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup EEPROM_STORE_18XX_43XX CHIP: LPC18xx/43xx EEPROM record store
+ * @ingroup EEPROM_18XX_43XX
+ * Small key/value records appended to a ring of EEPROM pages. Writes only
+ * go to a RAM copy of the current page, and whole pages are programmed
+ * later by Chip_EEPROM_Store_Service() without waiting for the program
+ * cycle. When the ring wraps, the still current records of the oldest
+ * page are carried into the page that replaces it, so every page of the
+ * ring is erased equally often. A RAM index gives the latest record of a
+ * key without searching.
+ * @{
+ */
+
+/** Number of keys in a store, keys are 0 to EEPROM_STORE_MAX_KEYS - 1 */
+#define EEPROM_STORE_MAX_KEYS       32
+
+/** Largest record data, a record and the page header fill a page */
+#define EEPROM_STORE_MAX_DATA       (EEPROM_PAGE_SIZE - 12)
+
+/**
+ * @brief EEPROM store page buffer
+ */
+typedef struct {
+	uint32_t data[EEPROM_PAGE_SIZE / 4];	/*!< Page contents */
+	uint8_t page;							/*!< Page number in the ring, 0xFF if unused */
+	uint8_t used;							/*!< Bytes used, header included */
+	bool dirty;								/*!< Changed since the last program */
+} EEPROM_STORE_BUF_T;
+
+/**
+ * @brief EEPROM record store
+ */
+typedef struct {
+	LPC_EEPROM_T *pEEPROM;				/*!< EEPROM peripheral */
+	uint8_t firstPage;					/*!< First EEPROM page of the ring */
+	uint8_t numPages;					/*!< Number of pages in the ring, 2 or more */
+	uint32_t seq;						/*!< Sequence number of the current page */
+	EEPROM_STORE_BUF_T buf[2];			/*!< Current page and a full page waiting to be programmed */
+	uint8_t cur;						/*!< Index in buf[] of the current page */
+	bool programming;					/*!< A page program cycle is running */
+	uint16_t index[EEPROM_STORE_MAX_KEYS];	/*!< Latest record per key, page << 8 | offset */
+	uint32_t programs;					/*!< Page program cycles started */
+} EEPROM_STORE_T;
+
+/**
+ * @brief	Open an EEPROM record store
+ * @param	pStore		: Pointer to the store structure to initialize
+ * @param	pEEPROM		: The base of EEPROM peripheral on the chip
+ * @param	firstPage	: First EEPROM page used by the store
+ * @param	numPages	: Number of EEPROM pages used, at least 2
+ * @return	Nothing
+ * @note	Rebuilds the index from the pages. Pages without a valid header
+ * are taken as free, so an unused range formats itself. Records damaged
+ * by a reset during a program cycle are skipped, their keys read back
+ * the previous value. Chip_EEPROM_Init() must have been called.
+ */
+void Chip_EEPROM_Store_Init(EEPROM_STORE_T *pStore, LPC_EEPROM_T *pEEPROM, uint8_t firstPage, uint8_t numPages);
+
+/**
+ * @brief	Read the latest record of a key
+ * @param	pStore	: Pointer to the store structure
+ * @param	key		: Key to read
+ * @param	pData	: Buffer to read the record data to
+ * @param	maxLen	: Size of @a pData, longer records are truncated
+ * @return	Length of the record data, or -1 if the key was never written
+ */
+int Chip_EEPROM_Store_Read(EEPROM_STORE_T *pStore, uint8_t key, void *pData, int maxLen);
+
+/**
+ * @brief	Write a record for a key
+ * @param	pStore	: Pointer to the store structure
+ * @param	key		: Key to write
+ * @param	pData	: Record data
+ * @param	len		: Length of the record data, EEPROM_STORE_MAX_DATA at most
+ * @return	true if the record was stored, false if it is too large or the
+ * current records of all keys do not fit in the ring
+ * @note	A record equal to the latest one for the key is not written
+ * again. The record is only in RAM until the page holding it has been
+ * programmed. This only waits for the EEPROM when the current page fills
+ * up while the page before it is still waiting to be programmed.
+ */
+bool Chip_EEPROM_Store_Write(EEPROM_STORE_T *pStore, uint8_t key, const void *pData, int len);
+
+/**
+ * @brief	Program pending store pages, without waiting
+ * @param	pStore		: Pointer to the store structure
+ * @param	commitAll	: true to also program the partly filled current page
+ * @return	true if all records (with @a commitAll, otherwise all full
+ * pages) are programmed, false if a program cycle is still needed
+ * @note	Starts at most one page program cycle per call. Call it from the
+ * main loop; use @a commitAll after configuration changes or before power
+ * down. Leaving small writes in the current page and committing them
+ * together saves program cycles.
+ */
+bool Chip_EEPROM_Store_Service(EEPROM_STORE_T *pStore, bool commitAll);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EEPROM_STORE_18XX_43XX_H_ */
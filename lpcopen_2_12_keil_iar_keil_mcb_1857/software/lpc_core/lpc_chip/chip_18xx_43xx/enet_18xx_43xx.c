@@ -38,6 +38,11 @@
 /* Saved address for PHY and clock divider */
 STATIC uint32_t phyCfg;
 
+/* Nominal PTP addend, the base of the rate trim */
+STATIC uint32_t ptpAddend;
+
+#define PTP_NS_PER_SEC 1000000000UL
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -56,6 +61,12 @@ STATIC INLINE void reset(LPC_ENET_T *pENET)
 	Chip_ENET_Reset(pENET);
 }
 
+/* Advance a ring index */
+STATIC INLINE uint16_t ringNext(uint16_t idx, uint16_t num)
+{
+	return (idx + 1 == num) ? 0 : idx + 1;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -157,3 +168,427 @@ void Chip_ENET_SetSpeed(LPC_ENET_T *pENET, bool speed100)
 	}
 }
 
+/* Set up zero-copy RX and TX descriptor rings */
+Status Chip_ENET_Ring_Init(ENET_RING_T *pRing, LPC_ENET_T *pENET,
+						   ENET_ENHRXDESC_T *pRxDescs, void **pRxHandles, uint16_t numRx,
+						   ENET_ENHTXDESC_T *pTxDescs, void **pTxHandles, uint16_t numTx,
+						   uint16_t bufSize, ENET_RING_ALLOC_T alloc, ENET_RING_FREE_T release, void *pData)
+{
+	uint16_t i;
+
+	if ((bufSize < EMAC_ETH_MAX_FLEN) || (numRx == 0) || (numTx == 0)) {
+		return ERROR;
+	}
+
+	pRing->pENET = pENET;
+	pRing->pRxDescs = pRxDescs;
+	pRing->pRxHandles = pRxHandles;
+	pRing->pTxDescs = pTxDescs;
+	pRing->pTxHandles = pTxHandles;
+	pRing->numRx = numRx;
+	pRing->numTx = numTx;
+	pRing->rxNext = pRing->rxFill = 0;
+	pRing->rxEmpty = numRx;
+	pRing->txNext = pRing->txDone = pRing->txUsed = 0;
+	pRing->bufSize = bufSize;
+	pRing->alloc = alloc;
+	pRing->release = release;
+	pRing->pData = pData;
+	pRing->txCsum = 0;
+	pRing->rxCsum = false;
+	pRing->rxDint = 0;
+	pRing->rxPolling = false;
+	pRing->rxPolls = 0;
+	pRing->rxFrames = pRing->rxErrors = pRing->rxCsumErrors = pRing->txFrames = 0;
+	pRing->txStampNext = 0;
+	pRing->txStamp = NULL;
+	pRing->rxStampValid = false;
+
+	/* Ring mode rather than chained, the last descriptor wraps */
+	for (i = 0; i < numRx; i++) {
+		pRxDescs[i].STATUS = 0;
+		pRxDescs[i].CTRL = (i == numRx - 1) ? RDES_ENH_RER : 0;
+		pRxDescs[i].B1ADD = pRxDescs[i].B2ADD = 0;
+		pRxHandles[i] = NULL;
+	}
+	for (i = 0; i < numTx; i++) {
+		pTxDescs[i].CTRLSTAT = (i == numTx - 1) ? TDES_ENH_TER : 0;
+		pTxDescs[i].BSIZE = 0;
+		pTxDescs[i].B1ADD = pTxDescs[i].B2ADD = 0;
+		pTxHandles[i] = NULL;
+	}
+
+	Chip_ENET_InitDescriptors(pENET, pTxDescs, pRxDescs);
+	Chip_ENET_Ring_RxReplenish(pRing);
+
+	return SUCCESS;
+}
+
+/* Give buffers to every RX descriptor that has none */
+uint32_t Chip_ENET_Ring_RxReplenish(ENET_RING_T *pRing)
+{
+	ENET_ENHRXDESC_T *pDesc;
+	uint8_t *pPayload;
+	void *pHandle;
+	uint32_t added = 0;
+
+	while (pRing->rxEmpty > 0) {
+		pHandle = pRing->alloc(pRing->pData, &pPayload);
+		if (pHandle == NULL) {
+			break;
+		}
+
+		pDesc = &pRing->pRxDescs[pRing->rxFill];
+		pRing->pRxHandles[pRing->rxFill] = pHandle;
+		pDesc->B1ADD = (uint32_t) pPayload;
+		pDesc->CTRL = (pDesc->CTRL & RDES_ENH_RER) | pRing->rxDint | RDES_ENH_BS1(pRing->bufSize);
+		pDesc->STATUS = RDES_OWN;
+
+		pRing->rxFill = ringNext(pRing->rxFill, pRing->numRx);
+		pRing->rxEmpty--;
+		added++;
+	}
+
+	/* One poll demand for the whole batch */
+	if (added) {
+		Chip_ENET_RXStart(pRing->pENET);
+	}
+
+	return added;
+}
+
+/* Enable or disable hardware checksum offload on the rings */
+void Chip_ENET_Ring_SetChecksumOffload(ENET_RING_T *pRing, bool tx, bool rx)
+{
+	LPC_ENET_T *pENET = pRing->pENET;
+
+	/* Full insertion: IP header and payload including the pseudo-header */
+	pRing->txCsum = tx ? TDES_ENH_CIC(3) : 0;
+	pRing->rxCsum = rx;
+
+	if (tx) {
+		pENET->DMA_OP_MODE |= DMA_OM_TSF;
+	}
+	else {
+		pENET->DMA_OP_MODE &= ~DMA_OM_TSF;
+	}
+
+	if (rx) {
+		pENET->MAC_CONFIG |= MAC_CFG_IPC;
+		pENET->DMA_OP_MODE = (pENET->DMA_OP_MODE & ~DMA_OM_DT) | DMA_OM_RSF;
+	}
+	else {
+		pENET->DMA_OP_MODE &= ~DMA_OM_RSF;
+	}
+}
+
+/* Take the next received frame off the RX ring */
+void *Chip_ENET_Ring_Receive(ENET_RING_T *pRing, uint32_t *pLength, uint8_t *pCsum)
+{
+	ENET_ENHRXDESC_T *pDesc;
+	uint32_t status, ext;
+	uint8_t csum;
+	void *pHandle;
+
+	while (pRing->rxEmpty < pRing->numRx) {
+		pDesc = &pRing->pRxDescs[pRing->rxNext];
+		status = pDesc->STATUS;
+		if (status & RDES_OWN) {
+			break;
+		}
+
+		pHandle = pRing->pRxHandles[pRing->rxNext];
+		pRing->pRxHandles[pRing->rxNext] = NULL;
+		pRing->rxNext = ringNext(pRing->rxNext, pRing->numRx);
+		pRing->rxEmpty++;
+
+		if (((status & (RDES_FS | RDES_LS)) == (RDES_FS | RDES_LS)) && !(status & RDES_ES)) {
+			csum = ENET_CSUM_UNCHECKED;
+			if (pRing->rxCsum && (status & RDES_ESA)) {
+				ext = pDesc->EXTSTAT;
+				if (ext & (RDES_ENH_IPHE | RDES_ENH_IPPLE)) {
+					pRing->rxCsumErrors++;
+					pRing->release(pRing->pData, pHandle);
+					continue;
+				}
+				if ((ext & (RDES_ENH_IPV4 | RDES_ENH_IPV6)) && !(ext & RDES_ENH_IPCSB)) {
+					csum = ENET_CSUM_GOOD;
+				}
+			}
+			if (pCsum) {
+				*pCsum = csum;
+			}
+
+			/* The last descriptor holds the snapshot of the frame */
+			pRing->rxStampValid = (status & RDES_TSA) != 0;
+			if (pRing->rxStampValid) {
+				pRing->rxStamp.nsec = pDesc->RTSL;
+				pRing->rxStamp.sec = pDesc->RTSH;
+			}
+
+			pRing->rxFrames++;
+			*pLength = RDES_FLMSK(status) - 4;
+			return pHandle;
+		}
+
+		pRing->rxErrors++;
+		pRing->release(pRing->pData, pHandle);
+	}
+
+	return NULL;
+}
+
+/* Coalesce receive interrupts with the receive watchdog */
+void Chip_ENET_Ring_SetRxCoalescing(ENET_RING_T *pRing, uint8_t count)
+{
+	pRing->rxDint = count ? RDES_DINT : 0;
+	Chip_ENET_SetRxWatchdog(pRing->pENET, count);
+}
+
+/* Receive interrupt half of the hybrid interrupt/poll RX mode */
+HOTFUNC bool Chip_ENET_Ring_RxIRQHandler(ENET_RING_T *pRing)
+{
+	LPC_ENET_T *pENET = pRing->pENET;
+
+	if (!(pENET->DMA_STAT & (DMA_ST_RI | DMA_ST_RU))) {
+		return pRing->rxPolling;
+	}
+
+	/* Mask until the poll finds the ring empty */
+	pENET->DMA_INT_EN &= ~(DMA_IE_RIE | DMA_IE_RUE);
+	pENET->DMA_STAT = DMA_ST_RI | DMA_ST_RU;
+	pRing->rxPolling = true;
+
+	return true;
+}
+
+/* Drain the RX ring with a bounded budget */
+uint32_t Chip_ENET_Ring_RxPoll(ENET_RING_T *pRing, uint32_t budget, ENET_RING_RECV_T recv)
+{
+	LPC_ENET_T *pENET = pRing->pENET;
+	uint32_t done = 0, length;
+	uint8_t csum;
+	void *pHandle;
+
+	while (done < budget) {
+		pHandle = Chip_ENET_Ring_Receive(pRing, &length, &csum);
+		if (pHandle == NULL) {
+			break;
+		}
+		recv(pRing->pData, pHandle, length, csum);
+		done++;
+	}
+	Chip_ENET_Ring_RxReplenish(pRing);
+
+	if (done == budget) {
+		pRing->rxPolls++;
+		return done;
+	}
+
+	/* Ring empty, go back to interrupts. A frame that completed before the
+	   status was cleared would not raise one, so look again afterwards. */
+	pENET->DMA_STAT = DMA_ST_RI | DMA_ST_RU;
+	pENET->DMA_INT_EN |= DMA_IE_RIE | DMA_IE_RUE;
+	if ((pRing->rxEmpty < pRing->numRx) && !(pRing->pRxDescs[pRing->rxNext].STATUS & RDES_OWN)) {
+		pENET->DMA_INT_EN &= ~(DMA_IE_RIE | DMA_IE_RUE);
+		pRing->rxPolling = true;
+		return budget;
+	}
+	pRing->rxPolling = false;
+
+	return done;
+}
+
+/* Queue a frame on the TX ring without copying it */
+Status Chip_ENET_Ring_Transmit(ENET_RING_T *pRing, const ENET_SEGMENT_T *pSegs, uint32_t numSegs,
+							   void *pHandle)
+{
+	ENET_ENHTXDESC_T *pDesc;
+	uint16_t idx, first;
+	uint32_t i, ctrl;
+
+	if ((numSegs == 0) || (numSegs > Chip_ENET_Ring_TxFree(pRing))) {
+		return ERROR;
+	}
+
+	first = idx = pRing->txNext;
+	for (i = 0; i < numSegs; i++) {
+		pDesc = &pRing->pTxDescs[idx];
+		ctrl = pDesc->CTRLSTAT & TDES_ENH_TER;
+		if (i == 0) {
+			ctrl |= TDES_ENH_FS | pRing->txCsum | pRing->txStampNext;
+		}
+		if (i == numSegs - 1) {
+			ctrl |= TDES_ENH_LS | TDES_ENH_IC;
+			pRing->pTxHandles[idx] = pHandle;
+		}
+		else {
+			pRing->pTxHandles[idx] = NULL;
+		}
+
+		pDesc->B1ADD = (uint32_t) pSegs[i].pPayload;
+		pDesc->BSIZE = TDES_ENH_BS1(pSegs[i].len);
+		/* The first descriptor is handed over last so the DMA never
+		   starts on a partly built frame */
+		pDesc->CTRLSTAT = (i == 0) ? ctrl : (ctrl | TDES_OWN);
+
+		idx = ringNext(idx, pRing->numTx);
+	}
+	pRing->pTxDescs[first].CTRLSTAT |= TDES_OWN;
+
+	pRing->txStampNext = 0;
+	pRing->txNext = idx;
+	pRing->txUsed += numSegs;
+	pRing->txFrames++;
+
+	Chip_ENET_TXStart(pRing->pENET);
+
+	return SUCCESS;
+}
+
+/* Release the frames the TX DMA has finished with */
+uint32_t Chip_ENET_Ring_TxReclaim(ENET_RING_T *pRing)
+{
+	ENET_ENHTXDESC_T *pDesc;
+	ENET_PTP_TIME_T stamp;
+	uint32_t reclaimed = 0;
+	void *pHandle;
+
+	while ((pRing->txUsed > 0) && !(pRing->pTxDescs[pRing->txDone].CTRLSTAT & TDES_OWN)) {
+		pDesc = &pRing->pTxDescs[pRing->txDone];
+		pHandle = pRing->pTxHandles[pRing->txDone];
+		if ((pDesc->CTRLSTAT & TDES_TTSS) && (pRing->txStamp != NULL)) {
+			/* Only the last descriptor of a frame reports the snapshot */
+			stamp.nsec = pDesc->TTSL;
+			stamp.sec = pDesc->TTSH;
+			pRing->txStamp(pRing->pData, pHandle, &stamp);
+		}
+		if (pHandle != NULL) {
+			pRing->pTxHandles[pRing->txDone] = NULL;
+			pRing->release(pRing->pData, pHandle);
+		}
+
+		pRing->txDone = ringNext(pRing->txDone, pRing->numTx);
+		pRing->txUsed--;
+		reclaimed++;
+	}
+
+	return reclaimed;
+}
+
+/* Start the PTP system time with fine correction */
+Status Chip_ENET_PTP_Init(LPC_ENET_T *pENET, uint32_t incrNs, uint32_t snap, const ENET_PTP_TIME_T *pTime)
+{
+	uint32_t clk = Chip_Clock_GetRate(CLK_MX_ETHERNET);
+	uint32_t rate;
+
+	if ((incrNs == 0) || (incrNs > 0xFF)) {
+		return ERROR;
+	}
+	rate = PTP_NS_PER_SEC / incrNs;
+	if (rate >= clk) {
+		return ERROR;
+	}
+
+	/* Masked, the application polls or uses the target time itself */
+	pENET->MAC_INTR_MASK |= MAC_IM_TS;
+
+	pENET->MAC_TIMESTP_CTRL = MAC_TS_TSENA | MAC_TS_TSCFUP | MAC_TS_TSCTRL | snap;
+	pENET->SUBSECOND_INCR = incrNs;
+
+	/* The accumulator overflows, and the time advances, rate times a second */
+	ptpAddend = (uint32_t) ((((uint64_t) rate) << 32) / clk);
+	pENET->ADDEND = ptpAddend;
+	pENET->MAC_TIMESTP_CTRL |= MAC_TS_TSADDR;
+	while (pENET->MAC_TIMESTP_CTRL & MAC_TS_TSADDR) {}
+
+	Chip_ENET_PTP_SetTime(pENET, pTime);
+
+	return SUCCESS;
+}
+
+/* Read the PTP system time */
+void Chip_ENET_PTP_GetTime(LPC_ENET_T *pENET, ENET_PTP_TIME_T *pTime)
+{
+	uint32_t sec;
+
+	/* Read the seconds again in case the nanoseconds rolled over */
+	do {
+		sec = pENET->SECONDS;
+		pTime->nsec = pENET->NANOSECONDS;
+		pTime->sec = pENET->SECONDS;
+	} while (sec != pTime->sec);
+}
+
+/* Set the PTP system time */
+void Chip_ENET_PTP_SetTime(LPC_ENET_T *pENET, const ENET_PTP_TIME_T *pTime)
+{
+	pENET->SECONDSUPDATE = pTime->sec;
+	pENET->NANOSECONDSUPDATE = pTime->nsec;
+	pENET->MAC_TIMESTP_CTRL |= MAC_TS_TSINIT;
+	while (pENET->MAC_TIMESTP_CTRL & MAC_TS_TSINIT) {}
+}
+
+/* Step the PTP system time */
+void Chip_ENET_PTP_AdjTime(LPC_ENET_T *pENET, int32_t deltaNs)
+{
+	uint32_t mag = (deltaNs < 0) ? (uint32_t) -deltaNs : (uint32_t) deltaNs;
+
+	/* Both fields are subtracted together when ADDSUB is set */
+	pENET->SECONDSUPDATE = mag / PTP_NS_PER_SEC;
+	pENET->NANOSECONDSUPDATE = (mag % PTP_NS_PER_SEC) | ((deltaNs < 0) ? MAC_TSNS_ADDSUB : 0);
+	pENET->MAC_TIMESTP_CTRL |= MAC_TS_TSUPDT;
+	while (pENET->MAC_TIMESTP_CTRL & MAC_TS_TSUPDT) {}
+}
+
+/* Trim the rate of the PTP system time */
+void Chip_ENET_PTP_AdjFreq(LPC_ENET_T *pENET, int32_t ppb)
+{
+	int64_t adj = ((int64_t) ptpAddend * ppb) / (int64_t) PTP_NS_PER_SEC;
+
+	pENET->ADDEND = (uint32_t) ((int64_t) ptpAddend + adj);
+	pENET->MAC_TIMESTP_CTRL |= MAC_TS_TSADDR;
+	while (pENET->MAC_TIMESTP_CTRL & MAC_TS_TSADDR) {}
+}
+
+/* Pair a free running counter with the PTP system time */
+void Chip_ENET_PTP_CrossStamp(LPC_ENET_T *pENET, const volatile uint32_t *pCounter, ENET_PTP_XSTAMP_T *pXStamp)
+{
+	uint32_t primask, before, after;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	before = *pCounter;
+	Chip_ENET_PTP_GetTime(pENET, &pXStamp->time);
+	after = *pCounter;
+	__set_PRIMASK(primask);
+
+	pXStamp->window = after - before;
+	pXStamp->ticks = before + (pXStamp->window >> 1);
+}
+
+/* Convert a counter value to PTP time */
+void Chip_ENET_PTP_TicksToTime(const ENET_PTP_XSTAMP_T *pFirst, const ENET_PTP_XSTAMP_T *pLast,
+							   uint32_t ticks, ENET_PTP_TIME_T *pTime)
+{
+	int64_t spanNs = ((int64_t) pLast->time.sec - (int64_t) pFirst->time.sec) * PTP_NS_PER_SEC +
+					 ((int64_t) pLast->time.nsec - (int64_t) pFirst->time.nsec);
+	uint32_t spanTicks = pLast->ticks - pFirst->ticks;
+	int32_t offTicks = (int32_t) (ticks - pLast->ticks);
+	int64_t ns = (int64_t) pLast->time.nsec;
+	int64_t sec;
+
+	if (spanTicks != 0) {
+		ns += ((int64_t) offTicks * spanNs) / (int64_t) spanTicks;
+	}
+
+	/* Normalize, the offset may be either side of the last pairing */
+	sec = ns / (int64_t) PTP_NS_PER_SEC;
+	ns -= sec * (int64_t) PTP_NS_PER_SEC;
+	if (ns < 0) {
+		ns += PTP_NS_PER_SEC;
+		sec--;
+	}
+	pTime->sec = (uint32_t) ((int64_t) pLast->time.sec + sec);
+	pTime->nsec = (uint32_t) ns;
+}
@@ -175,6 +175,7 @@ typedef struct {							/*!< ETHERNET Structure */
  * @brief MAC_INTR_MASK register bit defines
  */
 #define MAC_IM_PMT     (1 << 3)		/*!< PMT Interrupt Mask */
+#define MAC_IM_TS      (1 << 9)		/*!< Time Stamp Interrupt Mask */
 
 /*
  * @brief MAC_ADDR0_HIGH register bit defines
@@ -206,6 +207,11 @@ typedef struct {							/*!< ETHERNET Structure */
 #define MAC_TS_TSCLKT(n) ((n) << 16)	/*!< Select the type of clock node, n = see menual */
 #define MAC_TS_TSENMA  (1 << 18)	/*!< Enable MAC address for PTP frame filtering */
 
+/*
+ * @brief NANOSECONDSUPDATE register bit defines
+ */
+#define MAC_TSNS_ADDSUB (1UL << 31)	/*!< Subtract the update value from the system time */
+
 /*
  * @brief DMA_BUS_MODE register bit defines
  */
@@ -448,6 +454,99 @@ typedef struct {
 	__IO uint32_t RTSH;			/*!< Timestamp value high */
 } ENET_ENHRXDESC_T;
 
+/**
+ * @brief PTP system time, nanoseconds roll over to seconds at 10^9
+ */
+typedef struct {
+	uint32_t sec;				/*!< Seconds */
+	uint32_t nsec;				/*!< Nanoseconds, 0 to 999999999 */
+} ENET_PTP_TIME_T;
+
+/**
+ * @brief Pairing of a free running counter with the PTP system time
+ */
+typedef struct {
+	uint32_t ticks;				/*!< Counter value at the middle of the reading */
+	ENET_PTP_TIME_T time;		/*!< PTP system time */
+	uint32_t window;			/*!< Counter ticks the reading took, bounds the pairing error */
+} ENET_PTP_XSTAMP_T;
+
+/**
+ * @brief Transmit timestamp hook, called from Chip_ENET_Ring_TxReclaim for a
+ * frame queued after Chip_ENET_Ring_RequestTxTimestamp, before its handle is
+ * released
+ */
+typedef void (*ENET_RING_TSTAMP_T)(void *pData, void *pHandle, const ENET_PTP_TIME_T *pTime);
+
+/**
+ * @brief Descriptor ring buffer allocation hook
+ * Returns an opaque buffer handle (for example an lwIP pbuf from a pool)
+ * and its payload address, or NULL once the pool is exhausted
+ */
+typedef void *(*ENET_RING_ALLOC_T)(void *pData, uint8_t **ppPayload);
+
+/**
+ * @brief Descriptor ring buffer release hook, called with a handle from a TX
+ * frame the DMA has finished with or an RX buffer dropped on error
+ */
+typedef void (*ENET_RING_FREE_T)(void *pData, void *pHandle);
+
+/**
+ * @brief Frame delivery hook used by Chip_ENET_Ring_RxPoll, ownership of
+ * pHandle passes to the hook
+ */
+typedef void (*ENET_RING_RECV_T)(void *pData, void *pHandle, uint32_t length, uint8_t csum);
+
+/**
+ * @brief Transmit scatter segment, one per TX descriptor (e.g. one per pbuf)
+ */
+typedef struct {
+	const void *pPayload;		/*!< Segment data, sent in place */
+	uint16_t len;				/*!< Segment length in bytes */
+} ENET_SEGMENT_T;
+
+/**
+ * @brief Receive checksum status reported per frame
+ */
+#define ENET_CSUM_UNCHECKED 0		/*!< Not verified (offload off, not IP, or bypassed) */
+#define ENET_CSUM_GOOD      1		/*!< IP header and TCP/UDP/ICMP payload verified */
+
+/**
+ * @brief Zero-copy descriptor ring state
+ */
+typedef struct {
+	LPC_ENET_T *pENET;			/*!< ENET peripheral the rings belong to */
+	ENET_ENHRXDESC_T *pRxDescs;	/*!< RX descriptor ring */
+	void **pRxHandles;			/*!< Buffer handle owned by each RX descriptor */
+	ENET_ENHTXDESC_T *pTxDescs;	/*!< TX descriptor ring */
+	void **pTxHandles;			/*!< Frame handle released with each last TX segment */
+	uint16_t numRx;				/*!< Number of RX descriptors */
+	uint16_t numTx;				/*!< Number of TX descriptors */
+	uint16_t rxNext;			/*!< Next RX descriptor to be received */
+	uint16_t rxFill;			/*!< Next RX descriptor to be given a buffer */
+	uint16_t rxEmpty;			/*!< RX descriptors waiting for a buffer */
+	uint16_t txNext;			/*!< Next TX descriptor to be queued */
+	uint16_t txDone;			/*!< Next TX descriptor to be reclaimed */
+	uint16_t txUsed;			/*!< TX descriptors queued and not yet reclaimed */
+	uint16_t bufSize;			/*!< Size of each RX buffer, at least EMAC_ETH_MAX_FLEN */
+	uint32_t txCsum;			/*!< Checksum insertion bits for each first TX segment */
+	bool rxCsum;				/*!< Receive checksum verification enabled */
+	uint32_t rxDint;			/*!< RDES_DINT when completion interrupts are coalesced */
+	bool rxPolling;				/*!< RX interrupt masked, ring drained by Chip_ENET_Ring_RxPoll */
+	ENET_RING_ALLOC_T alloc;	/*!< RX buffer allocation hook */
+	ENET_RING_FREE_T release;	/*!< Buffer release hook */
+	void *pData;				/*!< Hook context */
+	uint32_t rxFrames;			/*!< Good frames received */
+	uint32_t rxErrors;			/*!< Frames dropped on a receive error */
+	uint32_t rxCsumErrors;		/*!< Frames dropped on a checksum error */
+	uint32_t txFrames;			/*!< Frames transmitted */
+	uint32_t rxPolls;			/*!< Poll passes that used their whole budget */
+	uint32_t txStampNext;		/*!< TDES_ENH_TTSE for the next queued frame */
+	ENET_RING_TSTAMP_T txStamp;	/*!< Transmit timestamp hook, NULL to drop them */
+	ENET_PTP_TIME_T rxStamp;	/*!< Timestamp of the last received frame */
+	bool rxStampValid;			/*!< rxStamp holds a timestamp */
+} ENET_RING_T;
+
 /**
  * @brief	Resets the ethernet interface
  * @param	pENET	: The base of ENET peripheral on the chip
@@ -583,6 +682,8 @@ STATIC INLINE void Chip_ENET_RXDisable(LPC_ENET_T *pENET)
 STATIC INLINE void Chip_ENET_RMIIEnable(LPC_ENET_T *pENET)
 {
 	LPC_CREG->CREG6 |= 0x4;
+	/* The ENET RX/TX clock inputs change rate with the mode */
+	Chip_Clock_InvalidateRates();
 }
 
 /**
@@ -596,6 +697,8 @@ STATIC INLINE void Chip_ENET_RMIIEnable(LPC_ENET_T *pENET)
 STATIC INLINE void Chip_ENET_MIIEnable(LPC_ENET_T *pENET)
 {
 	LPC_CREG->CREG6 &= ~0x7;
+	/* The ENET RX/TX clock inputs change rate with the mode */
+	Chip_Clock_InvalidateRates();
 }
 
 /**
@@ -614,6 +717,20 @@ void Chip_ENET_SetDuplex(LPC_ENET_T *pENET, bool full);
  */
 void Chip_ENET_SetSpeed(LPC_ENET_T *pENET, bool speed100);
 
+/**
+ * @brief	Sets the receive interrupt watchdog timer
+ * @param	pENET	: The base of ENET peripheral on the chip
+ * @param	count	: Timeout in units of 256 AHB clocks, 0 disables the watchdog
+ * @return	Nothing
+ * @note	When a frame lands in a descriptor with RDES_DINT set, the receive
+ * interrupt is held off until the watchdog expires, so one interrupt
+ * covers every frame received in that window.
+ */
+STATIC INLINE void Chip_ENET_SetRxWatchdog(LPC_ENET_T *pENET, uint8_t count)
+{
+	pENET->DMA_REC_INT_WDT = count;
+}
+
 /**
  * @brief	Configures the initial ethernet descriptors
  * @param	pENET		: The base of ENET peripheral on the chip
@@ -651,6 +768,260 @@ STATIC INLINE void Chip_ENET_TXStart(LPC_ENET_T *pENET)
 	pENET->DMA_TRANS_POLL_DEMAND = 1;
 }
 
+/**
+ * @brief	Set up zero-copy RX and TX descriptor rings
+ * @param	pRing		: Ring state to set up
+ * @param	pENET		: The base of ENET peripheral on the chip
+ * @param	pRxDescs	: RX descriptor storage, numRx entries
+ * @param	pRxHandles	: RX handle storage, numRx entries
+ * @param	numRx		: Number of RX descriptors
+ * @param	pTxDescs	: TX descriptor storage, numTx entries
+ * @param	pTxHandles	: TX handle storage, numTx entries
+ * @param	numTx		: Number of TX descriptors
+ * @param	bufSize		: Payload size of every RX buffer from alloc
+ * @param	alloc		: RX buffer allocation hook
+ * @param	release		: Buffer release hook
+ * @param	pData		: Context passed to the hooks
+ * @return	SUCCESS, or ERROR if a buffer cannot hold a full frame
+ * @note	RX descriptors point straight at the payloads handed out by
+ * alloc, and received frames are returned as those same handles, so
+ * with an lwIP PBUF_POOL behind alloc no frame is ever copied. The
+ * rings are loaded into the DMA and filled from the pool; the caller
+ * still enables RX/TX.
+ */
+Status Chip_ENET_Ring_Init(ENET_RING_T *pRing, LPC_ENET_T *pENET,
+						   ENET_ENHRXDESC_T *pRxDescs, void **pRxHandles, uint16_t numRx,
+						   ENET_ENHTXDESC_T *pTxDescs, void **pTxHandles, uint16_t numTx,
+						   uint16_t bufSize, ENET_RING_ALLOC_T alloc, ENET_RING_FREE_T release, void *pData);
+
+/**
+ * @brief	Give buffers to every RX descriptor that has none
+ * @param	pRing	: Ring state
+ * @return	Number of descriptors refilled
+ * @note	Descriptors freed by Chip_ENET_Ring_Receive are refilled here
+ * in one batch with a single receive poll demand, call it once after
+ * draining the ring rather than per frame. Stops early if alloc runs
+ * out; the remaining descriptors are retried on the next call.
+ */
+uint32_t Chip_ENET_Ring_RxReplenish(ENET_RING_T *pRing);
+
+/**
+ * @brief	Enable or disable hardware checksum offload on the rings
+ * @param	pRing	: Ring state
+ * @param	tx		: true to insert IP and TCP/UDP/ICMP checksums on transmit
+ * @param	rx		: true to verify them on receive
+ * @return	Nothing
+ * @note	Checksum insertion needs the whole frame in the TX FIFO, so
+ * enabling tx switches the DMA to transmit store and forward; rx does
+ * the same for receive so the MAC can drop bad frames itself. With both
+ * on the stack can be built with CHECKSUM_GEN_* and CHECKSUM_CHECK_* set
+ * to 0 (see LPC_CHECKSUM_OFFLOAD in the lwIP example configs). Call it
+ * before the frames it should apply to are queued.
+ */
+void Chip_ENET_Ring_SetChecksumOffload(ENET_RING_T *pRing, bool tx, bool rx);
+
+/**
+ * @brief	Coalesce receive interrupts with the receive watchdog
+ * @param	pRing	: Ring state
+ * @param	count	: Watchdog timeout in units of 256 AHB clocks, 0 for an
+ *					  interrupt on every frame
+ * @return	Nothing
+ * @note	Applies to descriptors as they are (re)filled.
+ */
+void Chip_ENET_Ring_SetRxCoalescing(ENET_RING_T *pRing, uint8_t count);
+
+/**
+ * @brief	Receive interrupt half of the hybrid interrupt/poll RX mode
+ * @param	pRing	: Ring state
+ * @return	true if frames are pending and the RX poll should be scheduled
+ * @note	Call from the ENET interrupt. On a receive interrupt (or receive
+ * buffer unavailable) the receive interrupt is masked and the ring enters
+ * polled mode; the caller then wakes the tcpip thread to call
+ * Chip_ENET_Ring_RxPoll. Other DMA_STAT bits are left to the caller.
+ */
+HOTFUNC bool Chip_ENET_Ring_RxIRQHandler(ENET_RING_T *pRing);
+
+/**
+ * @brief	Drain the RX ring with a bounded budget
+ * @param	pRing	: Ring state
+ * @param	budget	: Maximum number of frames to deliver
+ * @param	recv	: Frame delivery hook
+ * @return	Number of frames delivered
+ * @note	Refills the ring once per pass. If the ring runs empty before the
+ * budget is spent the receive interrupt is unmasked again and the ring
+ * leaves polled mode; a return equal to budget means the caller should
+ * poll again (after letting other work run).
+ */
+uint32_t Chip_ENET_Ring_RxPoll(ENET_RING_T *pRing, uint32_t budget, ENET_RING_RECV_T recv);
+
+/**
+ * @brief	Take the next received frame off the RX ring
+ * @param	pRing		: Ring state
+ * @param	pLength		: Frame length in bytes, without the CRC
+ * @param	pCsum		: Checksum status, ENET_CSUM_*, may be NULL
+ * @return	Buffer handle holding the frame, or NULL when none is ready
+ * @note	Ownership of the handle passes to the caller. Frames with an
+ * error, or that do not fit one buffer, are released through release,
+ * as are frames failing verification while receive offload is enabled.
+ * A frame reported ENET_CSUM_UNCHECKED still needs a software check.
+ */
+void *Chip_ENET_Ring_Receive(ENET_RING_T *pRing, uint32_t *pLength, uint8_t *pCsum);
+
+/**
+ * @brief	Queue a frame on the TX ring without copying it
+ * @param	pRing		: Ring state
+ * @param	pSegs		: Frame segments, sent in order
+ * @param	numSegs		: Number of segments
+ * @param	pHandle		: Handle released through release once sent, may be NULL
+ * @return	SUCCESS, or ERROR if the ring lacks numSegs free descriptors
+ * @note	The segment memory must stay valid until pHandle is released
+ * (take a pbuf_ref() on the chain and free it in the hook).
+ */
+Status Chip_ENET_Ring_Transmit(ENET_RING_T *pRing, const ENET_SEGMENT_T *pSegs, uint32_t numSegs,
+							   void *pHandle);
+
+/**
+ * @brief	Release the frames the TX DMA has finished with
+ * @param	pRing	: Ring state
+ * @return	Number of descriptors reclaimed
+ */
+uint32_t Chip_ENET_Ring_TxReclaim(ENET_RING_T *pRing);
+
+/**
+ * @brief	Returns the number of free TX descriptors
+ * @param	pRing	: Ring state
+ * @return	Free TX descriptors, one is needed per segment
+ */
+STATIC INLINE uint32_t Chip_ENET_Ring_TxFree(ENET_RING_T *pRing)
+{
+	return pRing->numTx - pRing->txUsed;
+}
+
+/**
+ * @brief	Set the transmit timestamp hook of a ring
+ * @param	pRing	: Ring state
+ * @param	hook	: Hook receiving the transmit timestamps, NULL to drop them
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_ENET_Ring_SetTxTimestampHook(ENET_RING_T *pRing, ENET_RING_TSTAMP_T hook)
+{
+	pRing->txStamp = hook;
+}
+
+/**
+ * @brief	Capture the transmit timestamp of the next queued frame
+ * @param	pRing	: Ring state
+ * @return	Nothing
+ * @note	Call right before Chip_ENET_Ring_Transmit() of a PTP event
+ * message. The time the frame's start of frame delimiter left the MAC
+ * is passed to the ring's transmit timestamp hook when it is reclaimed.
+ */
+STATIC INLINE void Chip_ENET_Ring_RequestTxTimestamp(ENET_RING_T *pRing)
+{
+	pRing->txStampNext = TDES_ENH_TTSE;
+}
+
+/**
+ * @brief	Get the receive timestamp of the last frame taken off the RX ring
+ * @param	pRing	: Ring state
+ * @param	pTime	: Pointer to store the time the frame's start of frame delimiter reached the MAC
+ * @return	true if the frame was timestamped
+ * @note	Call after Chip_ENET_Ring_Receive(), or from the ENET_RING_RECV_T
+ * hook of Chip_ENET_Ring_RxPoll(). Which frames are timestamped is set
+ * by the snapshot flags of Chip_ENET_PTP_Init().
+ */
+STATIC INLINE bool Chip_ENET_Ring_RxTimestamp(ENET_RING_T *pRing, ENET_PTP_TIME_T *pTime)
+{
+	*pTime = pRing->rxStamp;
+	return pRing->rxStampValid;
+}
+
+/**
+ * @brief Snapshot flags for Chip_ENET_PTP_Init(), every received frame
+ */
+#define ENET_PTP_SNAP_ALL       MAC_TS_TSENAL
+
+/**
+ * @brief Snapshot flags for Chip_ENET_PTP_Init(), PTPv2 event messages over UDP/IPv4 and Ethernet
+ */
+#define ENET_PTP_SNAP_V2_EVENT  (MAC_TS_TSVER2 | MAC_TS_TSIPENA | MAC_TS_TSIPV4E | MAC_TS_TSEVNT)
+
+/**
+ * @brief	Start the PTP system time with fine correction
+ * @param	pENET	: The base of ENET peripheral on the chip
+ * @param	incrNs	: Nanoseconds added per time update, the timestamp
+ *					  resolution (for example 20 for a 50 MHz update rate)
+ * @param	snap	: Receive snapshot flags, ENET_PTP_SNAP_* or MAC_TS_* snapshot bits
+ * @param	pTime	: Initial system time
+ * @return	SUCCESS, or ERROR if the ENET clock is too slow for @a incrNs
+ * @note	The system time counts in nanoseconds with digital rollover.
+ * The update rate 10^9 / @a incrNs must stay below the ENET register
+ * clock, the addend register then divides that clock down to it and
+ * Chip_ENET_PTP_AdjFreq() trims the addend.
+ */
+Status Chip_ENET_PTP_Init(LPC_ENET_T *pENET, uint32_t incrNs, uint32_t snap, const ENET_PTP_TIME_T *pTime);
+
+/**
+ * @brief	Read the PTP system time
+ * @param	pENET	: The base of ENET peripheral on the chip
+ * @param	pTime	: Pointer to store the system time
+ * @return	Nothing
+ */
+void Chip_ENET_PTP_GetTime(LPC_ENET_T *pENET, ENET_PTP_TIME_T *pTime);
+
+/**
+ * @brief	Set the PTP system time
+ * @param	pENET	: The base of ENET peripheral on the chip
+ * @param	pTime	: New system time
+ * @return	Nothing
+ */
+void Chip_ENET_PTP_SetTime(LPC_ENET_T *pENET, const ENET_PTP_TIME_T *pTime);
+
+/**
+ * @brief	Step the PTP system time
+ * @param	pENET	: The base of ENET peripheral on the chip
+ * @param	deltaNs	: Nanoseconds to add, negative to go back
+ * @return	Nothing
+ * @note	For offsets past a few milliseconds; smaller ones are better
+ * slewed out with Chip_ENET_PTP_AdjFreq() so the time stays monotonic.
+ */
+void Chip_ENET_PTP_AdjTime(LPC_ENET_T *pENET, int32_t deltaNs);
+
+/**
+ * @brief	Trim the rate of the PTP system time
+ * @param	pENET	: The base of ENET peripheral on the chip
+ * @param	ppb		: Rate correction in parts per billion, relative to the
+ *					  nominal rate set by Chip_ENET_PTP_Init()
+ * @return	Nothing
+ */
+void Chip_ENET_PTP_AdjFreq(LPC_ENET_T *pENET, int32_t ppb);
+
+/**
+ * @brief	Pair a free running counter with the PTP system time
+ * @param	pENET		: The base of ENET peripheral on the chip
+ * @param	pCounter	: Counter to pair, &LPC_SCT->COUNT_U for the SCT timestamp service
+ * @param	pXStamp		: Pointer to store the pairing
+ * @return	Nothing
+ * @note	The counter is read on both sides of the system time with
+ * interrupts off. Two pairings taken a while apart convert counter
+ * captures, such as SCT sample timestamps, to PTP time with
+ * Chip_ENET_PTP_TicksToTime().
+ */
+void Chip_ENET_PTP_CrossStamp(LPC_ENET_T *pENET, const volatile uint32_t *pCounter, ENET_PTP_XSTAMP_T *pXStamp);
+
+/**
+ * @brief	Convert a counter value to PTP time
+ * @param	pFirst	: Older pairing
+ * @param	pLast	: Newer pairing
+ * @param	ticks	: Counter value to convert, within 2^31 ticks of @a pLast
+ * @param	pTime	: Pointer to store the PTP time
+ * @return	Nothing
+ * @note	The counter rate is taken from the two pairings, so it tracks
+ * the drift between the counter clock and the PTP time.
+ */
+void Chip_ENET_PTP_TicksToTime(const ENET_PTP_XSTAMP_T *pFirst, const ENET_PTP_XSTAMP_T *pLast,
+							   uint32_t ticks, ENET_PTP_TIME_T *pTime);
+
 /**
  * @brief	Initialize ethernet interface
  * @param	pENET	: The base of ENET peripheral on the chip
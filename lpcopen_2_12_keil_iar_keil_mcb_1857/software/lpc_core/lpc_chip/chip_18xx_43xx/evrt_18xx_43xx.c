@@ -35,6 +35,16 @@
  * Private types/enumerations/variables
  ****************************************************************************/
 
+/* Number of event router inputs */
+#define EVRT_SRC_COUNT ((int) EVRT_SRC_RESET + 1)
+
+/* Source handlers set with Chip_EVRT_SetHandler() */
+typedef struct {
+	CHIP_EVRT_HANDLER_T handler;
+	void *pArg;
+} EVRT_HANDLER_ENTRY_T;
+static EVRT_HANDLER_ENTRY_T evrtHandlers[EVRT_SRC_COUNT];
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -109,3 +119,46 @@ IntStatus Chip_EVRT_IsSourceInterrupting(CHIP_EVRT_SRC_T EVRT_Src)
 	}
 	else {return RESET; }
 }
+
+/* Route a source through the event router to a handler */
+void Chip_EVRT_SetHandler(CHIP_EVRT_SRC_T EVRT_Src, CHIP_EVRT_SRC_ACTIVE_T type,
+						  CHIP_EVRT_HANDLER_T handler, void *pArg)
+{
+	Chip_EVRT_SetUpIntSrc(EVRT_Src, DISABLE);
+	evrtHandlers[EVRT_Src].handler = handler;
+	evrtHandlers[EVRT_Src].pArg = pArg;
+
+	if (handler != NULL) {
+		Chip_EVRT_ConfigIntSrcActiveType(EVRT_Src, type);
+		Chip_EVRT_ClrPendIntSrc(EVRT_Src);
+		Chip_EVRT_SetUpIntSrc(EVRT_Src, ENABLE);
+		NVIC_ClearPendingIRQ(EVENTROUTER_IRQn);
+		NVIC_EnableIRQ(EVENTROUTER_IRQn);
+	}
+}
+
+/* Call the handlers of the enabled sources that fired */
+void Chip_EVRT_IRQHandler(void)
+{
+	uint32_t pending = LPC_EVRT->STATUS & LPC_EVRT->ENABLE;
+	uint32_t edge = LPC_EVRT->EDGE;
+	int src;
+
+	for (src = 0; pending != 0; src++, pending >>= 1) {
+		if (!(pending & 1)) {
+			continue;
+		}
+
+		/* An edge is cleared first so one during the handler isn't lost,
+		   a level only once the handler has cleared its cause */
+		if (edge & (1 << src)) {
+			Chip_EVRT_ClrPendIntSrc((CHIP_EVRT_SRC_T) src);
+		}
+		if (evrtHandlers[src].handler != NULL) {
+			evrtHandlers[src].handler((CHIP_EVRT_SRC_T) src, evrtHandlers[src].pArg);
+		}
+		if (!(edge & (1 << src))) {
+			Chip_EVRT_ClrPendIntSrc((CHIP_EVRT_SRC_T) src);
+		}
+	}
+}
@@ -160,6 +160,42 @@ STATIC INLINE void Chip_EVRT_ClrPendIntSrc(CHIP_EVRT_SRC_T EVRT_Src)
 	LPC_EVRT->CLR_STAT = (1 << (uint8_t) EVRT_Src);
 }
 
+/**
+ * @brief Event router source handler
+ * @param	EVRT_Src	: Source that fired
+ * @param	pArg		: Argument given to Chip_EVRT_SetHandler()
+ */
+typedef void (*CHIP_EVRT_HANDLER_T)(CHIP_EVRT_SRC_T EVRT_Src, void *pArg);
+
+/**
+ * @brief	Route a source through the event router to a handler
+ * @param	EVRT_Src	: EVRT source, should be one of CHIP_EVRT_SRC_T type
+ * @param	type		: EVRT type, should be one of CHIP_EVRT_SRC_ACTIVE_T type
+ * @param	handler		: Called from Chip_EVRT_IRQHandler(), or NULL to stop routing the source
+ * @param	pArg		: Passed to the handler
+ * @return	Nothing
+ * @note	Configures the active type, clears a pending event, enables the
+ * source and the event router interrupt. The same source configuration
+ * wakes the chip from deep sleep and power down, so after a wake up the
+ * interrupt goes straight to the handler of the source that woke it
+ * (USB0/USB1 wake up, RTC, ETH wake up packet, WAKEUPn pins, alarm timer)
+ * without the application polling each peripheral. GPIO group interrupts
+ * are not event router inputs, route the pins through a WAKEUPn input
+ * for a GPIO wake up from deep sleep. WAKEUPn pins and other one shot
+ * events should use an edge type.
+ */
+void Chip_EVRT_SetHandler(CHIP_EVRT_SRC_T EVRT_Src, CHIP_EVRT_SRC_ACTIVE_T type,
+						  CHIP_EVRT_HANDLER_T handler, void *pArg);
+
+/**
+ * @brief	Call the handlers of the enabled sources that fired
+ * @return	Nothing
+ * @note	Call this from EVRT_IRQHandler(). A level source is cleared after
+ * its handler returns, so the handler must clear the cause in the
+ * peripheral; an edge source is cleared before the handler is called.
+ */
+void Chip_EVRT_IRQHandler(void);
+
 /**
  * @}
  */
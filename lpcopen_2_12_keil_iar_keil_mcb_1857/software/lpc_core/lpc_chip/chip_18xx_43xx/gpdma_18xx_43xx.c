@@ -30,6 +30,8 @@
  */
 
 #include "chip.h"
+#include "string.h"
+#include "itm_trace.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -38,6 +40,21 @@
 /* Channel array to monitor free channel */
 static DMA_ChannelHandle_t ChannelHandlerArray[GPDMA_NUMBER_CHANNELS];
 
+/* Priority class each allocated channel was handed to, and allocator counts */
+static uint8_t ChannelClass[GPDMA_NUMBER_CHANNELS];
+static GPDMA_ALLOC_STATS_T AllocStats;
+
+/* First channel of each priority class range, the last entry ends the table */
+static const uint8_t PrioFirstChannel[GPDMA_PRIO_CLASSES + 1] = {0, 2, 6, GPDMA_NUMBER_CHANNELS};
+
+/* Job descriptor pool, free descriptors are linked through their lli field */
+static DMA_TransferDescriptor_t JobDescPool[GPDMA_JOB_NUM_DESCRIPTORS];
+static DMA_TransferDescriptor_t *JobDescFree;
+
+/* Per channel job queues, the head job is the one running */
+static GPDMA_JOB_T *JobHead[GPDMA_NUMBER_CHANNELS];
+static GPDMA_JOB_T *JobTail[GPDMA_NUMBER_CHANNELS];
+
 /* Optimized Peripheral Source and Destination burst size (18xx,43xx) */
 static const uint8_t GPDMA_LUTPerBurst[] = {
 	GPDMA_BSIZE_4,	/* MEMORY             */
@@ -148,7 +165,7 @@ volatile static const void *GPDMA_LUTPerAddr[] = {
  * Private functions
  ****************************************************************************/
 /* Control which set of peripherals is connected to the DMA controller */
-STATIC uint8_t configDMAMux(uint32_t gpdma_peripheral_connection_number)
+STATIC HOTFUNC uint8_t configDMAMux(uint32_t gpdma_peripheral_connection_number)
 {
 	uint8_t function, channel;
 
@@ -379,12 +396,12 @@ uint32_t makeCtrlWord(const GPDMA_CH_CFG_T *GPDMAChannelConfig,
 }
 
 /* Set up the DPDMA according to the specification configuration details */
-Status setupChannel(LPC_GPDMA_T *pGPDMA,
-					GPDMA_CH_CFG_T *GPDMAChannelConfig,
-					uint32_t CtrlWord,
-					uint32_t LinkListItem,
-					uint8_t SrcPeripheral,
-					uint8_t DstPeripheral)
+HOTFUNC Status setupChannel(LPC_GPDMA_T *pGPDMA,
+							GPDMA_CH_CFG_T *GPDMAChannelConfig,
+							uint32_t CtrlWord,
+							uint32_t LinkListItem,
+							uint8_t SrcPeripheral,
+							uint8_t DstPeripheral)
 {
 	GPDMA_CH_T *pDMAch;
 
@@ -422,6 +439,161 @@ Status setupChannel(LPC_GPDMA_T *pGPDMA,
 	return SUCCESS;
 }
 
+/* Return a job's descriptor chain to the pool, interrupts must be masked */
+static HOTFUNC void freeJobDescriptors(GPDMA_JOB_T *pJob)
+{
+	DMA_TransferDescriptor_t *dsc = pJob->pDesc, *next;
+
+	while (dsc) {
+		next = (DMA_TransferDescriptor_t *) dsc->lli;
+		dsc->lli = (uint32_t) JobDescFree;
+		JobDescFree = dsc;
+		dsc = next;
+	}
+	pJob->pDesc = NULL;
+}
+
+/* Start the descriptor chain of a job on an idle channel */
+static HOTFUNC Status startJob(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, GPDMA_JOB_T *pJob)
+{
+	switch (pJob->TransferType) {
+	case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA:
+		return Chip_GPDMA_SGTransferPeripheral(pGPDMA, ChannelNum, pJob->dst, pJob->pDesc, pJob->TransferType);
+
+	case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA:
+		return Chip_GPDMA_SGTransferPeripheral(pGPDMA, ChannelNum, pJob->src, pJob->pDesc, pJob->TransferType);
+
+	default:
+		return Chip_GPDMA_SGTransfer(pGPDMA, ChannelNum, pJob->pDesc, pJob->TransferType);
+	}
+}
+
+/* Append a job with its descriptors built to the channel queue, starting
+   it if the channel was idle; interrupts must be masked */
+static Status queueJob(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, GPDMA_JOB_T *pJob)
+{
+	pJob->pNext = NULL;
+	if (JobHead[ChannelNum] == NULL) {
+		if (startJob(pGPDMA, ChannelNum, pJob) == ERROR) {
+			freeJobDescriptors(pJob);
+			return ERROR;
+		}
+		JobHead[ChannelNum] = JobTail[ChannelNum] = pJob;
+	}
+	else {
+		JobTail[ChannelNum]->pNext = pJob;
+		JobTail[ChannelNum] = pJob;
+	}
+
+	return SUCCESS;
+}
+
+/* Claim a free channel in [first, last), interrupts must be masked */
+static uint8_t claimChannel(LPC_GPDMA_T *pGPDMA, uint8_t first, uint8_t last, GPDMA_PRIO_T prio)
+{
+	uint8_t ch;
+
+	for (ch = first; ch < last; ch++) {
+		if (!Chip_GPDMA_IntGetStatus(pGPDMA, GPDMA_STAT_ENABLED_CH, ch) &&
+			(ChannelHandlerArray[ch].ChannelStatus == DISABLE) && (JobHead[ch] == NULL)) {
+			ChannelHandlerArray[ch].ChannelStatus = ENABLE;
+			ChannelClass[ch] = (uint8_t) prio;
+			return ch;
+		}
+	}
+
+	return GPDMA_NO_CHANNEL;
+}
+
+/* Stop a channel and take its jobs off the queue, returned as a list
+   for the caller to fail; interrupts must be masked */
+static GPDMA_JOB_T *abortJobs(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum)
+{
+	GPDMA_JOB_T *pJob, *pList = JobHead[ChannelNum];
+
+	Chip_GPDMA_Stop(pGPDMA, ChannelNum);
+	for (pJob = pList; pJob; pJob = pJob->pNext) {
+		freeJobDescriptors(pJob);
+	}
+	JobHead[ChannelNum] = JobTail[ChannelNum] = NULL;
+
+	return pList;
+}
+
+/* Queue a memory to memory job of bytes bytes, with the source address
+   held fixed for fills */
+static Status memoryJob(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, GPDMA_JOB_T *pJob,
+						uint32_t dst, uint32_t src, uint32_t bytes, bool fill)
+{
+	DMA_TransferDescriptor_t *dsc, *prev = NULL;
+	uint32_t width, burst, chunk, ctrl, primask;
+	Status ret;
+
+	/* Widest item the alignment allows, and a burst that fills the 16 byte
+	   channel FIFO */
+	if (((dst | (fill ? 0 : src) | bytes) & 3) == 0) {
+		width = GPDMA_WIDTH_WORD;
+		burst = GPDMA_BSIZE_4;
+	}
+	else if (((dst | (fill ? 0 : src) | bytes) & 1) == 0) {
+		width = GPDMA_WIDTH_HALFWORD;
+		burst = GPDMA_BSIZE_8;
+	}
+	else {
+		width = GPDMA_WIDTH_BYTE;
+		burst = GPDMA_BSIZE_16;
+	}
+	ctrl = GPDMA_DMACCxControl_SBSize(burst) | GPDMA_DMACCxControl_DBSize(burst)
+		   | GPDMA_DMACCxControl_SWidth(width) | GPDMA_DMACCxControl_DWidth(width)
+		   | GPDMA_DMACCxControl_DI | (fill ? 0 : GPDMA_DMACCxControl_SI);
+
+	pJob->src = src;
+	pJob->dst = dst;
+	pJob->Size = bytes;
+	pJob->TransferType = GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* Build the descriptor chain, the last node raises the interrupt */
+	pJob->pDesc = NULL;
+	while (bytes > 0) {
+		dsc = JobDescFree;
+		if (dsc == NULL) {
+			freeJobDescriptors(pJob);
+			__set_PRIMASK(primask);
+			return ERROR;
+		}
+		JobDescFree = (DMA_TransferDescriptor_t *) dsc->lli;
+
+		chunk = MIN(bytes, 0xFFF << width);
+		dsc->src = src;
+		dsc->dst = dst;
+		dsc->lli = 0;
+		dsc->ctrl = ctrl | GPDMA_DMACCxControl_TransferSize(chunk >> width) | GPDMA_DMACCxControl_I;
+		if (prev) {
+			prev->lli = (uint32_t) dsc;
+			prev->ctrl &= ~GPDMA_DMACCxControl_I;
+		}
+		else {
+			pJob->pDesc = dsc;
+		}
+		prev = dsc;
+
+		if (!fill) {
+			src += chunk;
+		}
+		dst += chunk;
+		bytes -= chunk;
+	}
+
+	ret = queueJob(pGPDMA, ChannelNum, pJob);
+
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -446,6 +618,7 @@ void Chip_GPDMA_Init(LPC_GPDMA_T *pGPDMA)
 	for (i = 0; i < GPDMA_NUMBER_CHANNELS; i++) {
 		ChannelHandlerArray[i].ChannelStatus = DISABLE;
 	}
+	memset(&AllocStats, 0, sizeof(AllocStats));
 }
 
 /* Shutdown the GPDMA */
@@ -471,8 +644,8 @@ void Chip_GPDMA_Stop(LPC_GPDMA_T *pGPDMA,
 }
 
 /* The GPDMA stream interrupt status checking */
-Status Chip_GPDMA_Interrupt(LPC_GPDMA_T *pGPDMA,
-							uint8_t ChannelNum)
+HOTFUNC Status Chip_GPDMA_Interrupt(LPC_GPDMA_T *pGPDMA,
+									uint8_t ChannelNum)
 {
 
 	if (Chip_GPDMA_IntGetStatus(pGPDMA, GPDMA_STAT_INT, ChannelNum)) {
@@ -493,13 +666,13 @@ Status Chip_GPDMA_Interrupt(LPC_GPDMA_T *pGPDMA,
 	return ERROR;
 }
 
-int Chip_GPDMA_InitChannelCfg(LPC_GPDMA_T *pGPDMA,
-							  GPDMA_CH_CFG_T *GPDMACfg,
-							  uint8_t  ChannelNum,
-							  uint32_t src,
-							  uint32_t dst,
-							  uint32_t Size,
-							  GPDMA_FLOW_CONTROL_T TransferType)
+HOTFUNC int Chip_GPDMA_InitChannelCfg(LPC_GPDMA_T *pGPDMA,
+									  GPDMA_CH_CFG_T *GPDMACfg,
+									  uint8_t  ChannelNum,
+									  uint32_t src,
+									  uint32_t dst,
+									  uint32_t Size,
+									  GPDMA_FLOW_CONTROL_T TransferType)
 {
 	int rval = -1;
 	GPDMACfg->ChannelNum = ChannelNum;
@@ -544,7 +717,7 @@ int Chip_GPDMA_InitChannelCfg(LPC_GPDMA_T *pGPDMA,
 }
 
 /* Read the status from different registers according to the type */
-IntStatus Chip_GPDMA_IntGetStatus(LPC_GPDMA_T *pGPDMA, GPDMA_STATUS_T type, uint8_t channel)
+HOTFUNC IntStatus Chip_GPDMA_IntGetStatus(LPC_GPDMA_T *pGPDMA, GPDMA_STATUS_T type, uint8_t channel)
 {
 	/**
 	 * TODO check the channel <=8 type is exited
@@ -571,7 +744,7 @@ IntStatus Chip_GPDMA_IntGetStatus(LPC_GPDMA_T *pGPDMA, GPDMA_STATUS_T type, uint
 }
 
 /* Clear the Interrupt Flag from different registers according to the type */
-void Chip_GPDMA_ClearIntPending(LPC_GPDMA_T *pGPDMA, GPDMA_STATECLEAR_T type, uint8_t channel)
+HOTFUNC void Chip_GPDMA_ClearIntPending(LPC_GPDMA_T *pGPDMA, GPDMA_STATECLEAR_T type, uint8_t channel)
 {
 	if (type == GPDMA_STATCLR_INTTC) {
 		/* clears the terminal count interrupt request on DMA channel */
@@ -584,7 +757,7 @@ void Chip_GPDMA_ClearIntPending(LPC_GPDMA_T *pGPDMA, GPDMA_STATECLEAR_T type, ui
 }
 
 /* Enable or Disable the GPDMA Channel */
-void Chip_GPDMA_ChannelCmd(LPC_GPDMA_T *pGPDMA, uint8_t channelNum, FunctionalState NewState)
+HOTFUNC void Chip_GPDMA_ChannelCmd(LPC_GPDMA_T *pGPDMA, uint8_t channelNum, FunctionalState NewState)
 {
 	GPDMA_CH_T *pDMAch;
 
@@ -689,10 +862,10 @@ Status Chip_GPDMA_PrepareDescriptor(LPC_GPDMA_T *pGPDMA,
 }
 
 /* Do a DMA scatter-gather transfer M2M, M2P,P2M or P2P using DMA descriptors */
-Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T *pGPDMA,
-							 uint8_t ChannelNum,
-							 const DMA_TransferDescriptor_t *DMADescriptor,
-							 GPDMA_FLOW_CONTROL_T TransferType)
+HOTFUNC Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T *pGPDMA,
+									 uint8_t ChannelNum,
+									 const DMA_TransferDescriptor_t *DMADescriptor,
+									 GPDMA_FLOW_CONTROL_T TransferType)
 {
 	const DMA_TransferDescriptor_t *dsc = DMADescriptor;
 	GPDMA_CH_CFG_T GPDMACfg;
@@ -729,6 +902,169 @@ Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T *pGPDMA,
 	return SUCCESS;
 }
 
+/* Copy or fill a rectangle of memory, one descriptor per line */
+Status Chip_GPDMA_RectTransfer(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, DMA_TransferDescriptor_t *pDesc,
+							   uint32_t dst, int32_t dstStride, uint32_t src, int32_t srcStride,
+							   uint32_t lineBytes, uint32_t lines, bool fill)
+{
+	uint32_t width, burst, ctrl, align, i;
+
+	if ((lines == 0) || (lineBytes == 0)) {
+		return SUCCESS;
+	}
+
+	/* Widest item every line allows, as for memoryJob() */
+	align = dst | (uint32_t) dstStride | lineBytes | (fill ? 0 : (src | (uint32_t) srcStride));
+	if ((align & 3) == 0) {
+		width = GPDMA_WIDTH_WORD;
+		burst = GPDMA_BSIZE_4;
+	}
+	else if ((align & 1) == 0) {
+		width = GPDMA_WIDTH_HALFWORD;
+		burst = GPDMA_BSIZE_8;
+	}
+	else {
+		width = GPDMA_WIDTH_BYTE;
+		burst = GPDMA_BSIZE_16;
+	}
+	if ((lineBytes >> width) > 0xFFF) {
+		return ERROR;
+	}
+	ctrl = GPDMA_DMACCxControl_SBSize(burst) | GPDMA_DMACCxControl_DBSize(burst)
+		   | GPDMA_DMACCxControl_SWidth(width) | GPDMA_DMACCxControl_DWidth(width)
+		   | GPDMA_DMACCxControl_DI | (fill ? 0 : GPDMA_DMACCxControl_SI)
+		   | GPDMA_DMACCxControl_TransferSize(lineBytes >> width);
+
+	for (i = 0; i < lines; i++) {
+		pDesc[i].src = src;
+		pDesc[i].dst = dst;
+		pDesc[i].lli = (uint32_t) &pDesc[i + 1];
+		pDesc[i].ctrl = ctrl;
+		dst += dstStride;
+		if (!fill) {
+			src += srcStride;
+		}
+	}
+	pDesc[lines - 1].lli = 0;
+	pDesc[lines - 1].ctrl |= GPDMA_DMACCxControl_I;
+
+	return Chip_GPDMA_SGTransfer(pGPDMA, ChannelNum, pDesc, GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA);
+}
+
+/* Do a DMA scatter-gather transfer between a peripheral and memory */
+HOTFUNC Status Chip_GPDMA_SGTransferPeripheral(LPC_GPDMA_T *pGPDMA,
+											   uint8_t ChannelNum,
+											   uint32_t PeripheralConnection_ID,
+											   const DMA_TransferDescriptor_t *DMADescriptor,
+											   GPDMA_FLOW_CONTROL_T TransferType)
+{
+	GPDMA_CH_CFG_T GPDMACfg;
+	uint8_t SrcPeripheral = 0, DstPeripheral = 0;
+
+	GPDMACfg.ChannelNum = ChannelNum;
+	GPDMACfg.TransferType = TransferType;
+	GPDMACfg.SrcAddr = DMADescriptor->src;
+	GPDMACfg.DstAddr = DMADescriptor->dst;
+
+	switch (TransferType) {
+	case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA:
+		DstPeripheral = configDMAMux(PeripheralConnection_ID);
+		break;
+
+	case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA:
+		SrcPeripheral = configDMAMux(PeripheralConnection_ID);
+		break;
+
+	default:
+		return ERROR;
+	}
+
+	if (setupChannel(pGPDMA, &GPDMACfg, DMADescriptor->ctrl, DMADescriptor->lli,
+					 SrcPeripheral, DstPeripheral) == ERROR) {
+		return ERROR;
+	}
+
+	/* Start the Channel */
+	Chip_GPDMA_ChannelCmd(pGPDMA, ChannelNum, ENABLE);
+	return SUCCESS;
+}
+
+/* Get a free GPDMA channel in the range of a priority class */
+uint8_t Chip_GPDMA_GetPriorityChannel(LPC_GPDMA_T *pGPDMA, uint32_t PeripheralConnection_ID,
+									  GPDMA_PRIO_T prio, bool preempt)
+{
+	GPDMA_JOB_T *pAborted = NULL, *pJob;
+	uint32_t primask;
+	uint8_t ch, cls;
+
+	(void) PeripheralConnection_ID;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	AllocStats.requests[prio]++;
+
+	/* Own range first, then the lower priority ones if allowed to leave it */
+	ch = claimChannel(pGPDMA, PrioFirstChannel[prio], PrioFirstChannel[prio + 1], prio);
+	if (prio != GPDMA_PRIO_BACKGROUND) {
+		for (cls = prio + 1; (ch == GPDMA_NO_CHANNEL) && (cls < GPDMA_PRIO_CLASSES); cls++) {
+			ch = claimChannel(pGPDMA, PrioFirstChannel[cls], PrioFirstChannel[cls + 1], prio);
+		}
+		if (ch != GPDMA_NO_CHANNEL) {
+			if (ch >= PrioFirstChannel[prio + 1]) {
+				AllocStats.fallbacks[prio]++;
+			}
+		}
+		else if (preempt) {
+			/* Take over the highest priority channel a background client holds */
+			for (ch = 0; ch < GPDMA_NUMBER_CHANNELS; ch++) {
+				if ((ChannelHandlerArray[ch].ChannelStatus == ENABLE) &&
+					(ChannelClass[ch] == GPDMA_PRIO_BACKGROUND)) {
+					break;
+				}
+			}
+			if (ch < GPDMA_NUMBER_CHANNELS) {
+				pAborted = abortJobs(pGPDMA, ch);
+				ChannelHandlerArray[ch].ChannelStatus = ENABLE;
+				ChannelClass[ch] = (uint8_t) prio;
+				AllocStats.preemptions++;
+			}
+			else {
+				ch = GPDMA_NO_CHANNEL;
+			}
+		}
+	}
+	if (ch == GPDMA_NO_CHANNEL) {
+		AllocStats.failures[prio]++;
+	}
+
+	__set_PRIMASK(primask);
+
+	/* Fail the preempted jobs outside the critical section */
+	while (pAborted) {
+		pJob = pAborted;
+		pAborted = pJob->pNext;
+		if (pJob->callback) {
+			pJob->callback(pJob, ERROR);
+		}
+	}
+
+	return ch;
+}
+
+/* Read the channel allocator statistics */
+void Chip_GPDMA_GetAllocStats(LPC_GPDMA_T *pGPDMA, GPDMA_ALLOC_STATS_T *stats)
+{
+	uint32_t primask;
+
+	(void) pGPDMA;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*stats = AllocStats;
+	__set_PRIMASK(primask);
+}
+
 /* Get a free GPDMA channel for one DMA connection */
 uint8_t Chip_GPDMA_GetFreeChannel(LPC_GPDMA_T *pGPDMA,
 								  uint32_t PeripheralConnection_ID)
@@ -744,3 +1080,194 @@ uint8_t Chip_GPDMA_GetFreeChannel(LPC_GPDMA_T *pGPDMA,
 	return 0;
 }
 
+
+/* Initialize the GPDMA job queues and descriptor pool */
+void Chip_GPDMA_JobInit(LPC_GPDMA_T *pGPDMA)
+{
+	int i;
+
+	JobDescFree = NULL;
+	for (i = 0; i < GPDMA_JOB_NUM_DESCRIPTORS; i++) {
+		JobDescPool[i].lli = (uint32_t) JobDescFree;
+		JobDescFree = &JobDescPool[i];
+	}
+
+	for (i = 0; i < GPDMA_NUMBER_CHANNELS; i++) {
+		JobHead[i] = JobTail[i] = NULL;
+	}
+}
+
+/* Queue a transfer on a GPDMA channel */
+Status Chip_GPDMA_SubmitJob(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, GPDMA_JOB_T *pJob)
+{
+	DMA_TransferDescriptor_t *dsc, *prev = NULL;
+	uint32_t src = pJob->src, dst = pJob->dst, left = pJob->Size;
+	uint32_t chunk, maxChunk, step;
+	uint32_t primask;
+	Status ret;
+
+	/* Memory to memory sizes are in bytes moved as words, peripheral sizes
+	   are in items of the peripheral width */
+	switch (pJob->TransferType) {
+	case GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA:
+		maxChunk = 0xFFF * 4;
+		step = 1;
+		break;
+
+	case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA:
+		maxChunk = 0xFFF;
+		step = 1 << GPDMA_LUTPerWid[dst];
+		break;
+
+	case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA:
+		maxChunk = 0xFFF;
+		step = 1 << GPDMA_LUTPerWid[src];
+		break;
+
+	default:
+		return ERROR;
+	}
+
+	if (left == 0) {
+		return ERROR;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* Build the descriptor chain, the last node raises the interrupt */
+	pJob->pDesc = NULL;
+	while (left > 0) {
+		dsc = JobDescFree;
+		if (dsc == NULL) {
+			freeJobDescriptors(pJob);
+			__set_PRIMASK(primask);
+			return ERROR;
+		}
+		JobDescFree = (DMA_TransferDescriptor_t *) dsc->lli;
+
+		chunk = MIN(left, maxChunk);
+		Chip_GPDMA_PrepareDescriptor(pGPDMA, dsc, src, dst, chunk, pJob->TransferType, NULL);
+		if (prev) {
+			prev->lli = (uint32_t) dsc;
+			prev->ctrl &= ~GPDMA_DMACCxControl_I;
+		}
+		else {
+			pJob->pDesc = dsc;
+		}
+		prev = dsc;
+
+		/* Only the memory ends of the transfer move on */
+		if (pJob->TransferType != GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) {
+			src += chunk * step;
+		}
+		if (pJob->TransferType != GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) {
+			dst += chunk * step;
+		}
+		left -= chunk;
+	}
+
+	ret = queueJob(pGPDMA, ChannelNum, pJob);
+
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+/* Returns whether a GPDMA channel has jobs in progress or queued */
+bool Chip_GPDMA_IsJobPending(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum)
+{
+	(void) pGPDMA;
+
+	return JobHead[ChannelNum] != NULL;
+}
+
+/* GPDMA interrupt handler for the job queues */
+HOTFUNC void Chip_GPDMA_JobIRQHandler(LPC_GPDMA_T *pGPDMA)
+{
+	GPDMA_JOB_T *pJob, *pFailed, *pFailedList;
+	Status status;
+	uint32_t primask;
+	uint8_t ch;
+
+	ITM_TRACE1(ITM_EV_DMA_IRQ_ENTER, pGPDMA->INTSTAT);
+	for (ch = 0; ch < GPDMA_NUMBER_CHANNELS; ch++) {
+		if ((JobHead[ch] == NULL) || !Chip_GPDMA_IntGetStatus(pGPDMA, GPDMA_STAT_INT, ch)) {
+			continue;
+		}
+
+		status = Chip_GPDMA_Interrupt(pGPDMA, ch);
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		/* Retire the finished job and keep the channel busy with the next,
+		   jobs that cannot be started are failed after unmasking */
+		pJob = JobHead[ch];
+		freeJobDescriptors(pJob);
+		JobHead[ch] = pJob->pNext;
+		pFailedList = NULL;
+		while ((JobHead[ch] != NULL) && (startJob(pGPDMA, ch, JobHead[ch]) == ERROR)) {
+			pFailed = JobHead[ch];
+			freeJobDescriptors(pFailed);
+			JobHead[ch] = pFailed->pNext;
+			pFailed->pNext = pFailedList;
+			pFailedList = pFailed;
+		}
+		if (JobHead[ch] == NULL) {
+			JobTail[ch] = NULL;
+		}
+
+		__set_PRIMASK(primask);
+
+		if (pJob->callback) {
+			pJob->callback(pJob, status);
+		}
+		while (pFailedList) {
+			pFailed = pFailedList;
+			pFailedList = pFailed->pNext;
+			if (pFailed->callback) {
+				pFailed->callback(pFailed, ERROR);
+			}
+		}
+	}
+	ITM_TRACE(ITM_EV_DMA_IRQ_EXIT);
+}
+
+/* Copy memory in the background */
+Status Chip_GPDMA_MemcpyAsync(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, GPDMA_JOB_T *pJob,
+							  void *dst, const void *src, uint32_t bytes,
+							  GPDMA_JOB_CALLBACK_T callback)
+{
+	pJob->callback = callback;
+
+	if (bytes < GPDMA_MEMOP_DMA_THRESHOLD) {
+		memcpy(dst, src, bytes);
+		if (callback) {
+			callback(pJob, SUCCESS);
+		}
+		return SUCCESS;
+	}
+
+	return memoryJob(pGPDMA, ChannelNum, pJob, (uint32_t) dst, (uint32_t) src, bytes, false);
+}
+
+/* Fill memory in the background */
+Status Chip_GPDMA_MemsetAsync(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, GPDMA_JOB_T *pJob,
+							  void *dst, uint8_t value, uint32_t bytes,
+							  GPDMA_JOB_CALLBACK_T callback)
+{
+	pJob->callback = callback;
+
+	if (bytes < GPDMA_MEMOP_DMA_THRESHOLD) {
+		memset(dst, value, bytes);
+		if (callback) {
+			callback(pJob, SUCCESS);
+		}
+		return SUCCESS;
+	}
+
+	/* The DMA reads the pattern from the job, replicated to any item width */
+	pJob->fill = value * 0x01010101UL;
+	return memoryJob(pGPDMA, ChannelNum, pJob, (uint32_t) dst, (uint32_t) &pJob->fill, bytes, true);
+}
@@ -251,6 +251,60 @@ typedef struct DMA_TransferDescriptor {
 	uint32_t ctrl;	/*!< Control word that has transfer size, type etc. */
 } DMA_TransferDescriptor_t;
 
+/**
+ * @brief GPDMA channel priority classes, channel 0 has the highest hardware priority
+ */
+typedef enum {
+	GPDMA_PRIO_REALTIME = 0,	/*!< Channels 0-1: audio, streaming peripherals */
+	GPDMA_PRIO_NORMAL,			/*!< Channels 2-5: communication peripherals */
+	GPDMA_PRIO_BACKGROUND,		/*!< Channels 6-7: memory copies, bulk moves */
+	GPDMA_PRIO_CLASSES
+} GPDMA_PRIO_T;
+
+/** Returned by Chip_GPDMA_GetPriorityChannel() when no channel could be found */
+#define GPDMA_NO_CHANNEL 0xFF
+
+/**
+ * @brief GPDMA channel allocator statistics, indexed by priority class
+ */
+typedef struct {
+	uint32_t requests[GPDMA_PRIO_CLASSES];	/*!< Channel requests made */
+	uint32_t fallbacks[GPDMA_PRIO_CLASSES];	/*!< Requests served from a lower priority range */
+	uint32_t preemptions;					/*!< Background channels taken over */
+	uint32_t failures[GPDMA_PRIO_CLASSES];	/*!< Requests that got no channel */
+} GPDMA_ALLOC_STATS_T;
+
+/* Number of descriptors shared by all queued GPDMA jobs */
+#ifndef GPDMA_JOB_NUM_DESCRIPTORS
+#define GPDMA_JOB_NUM_DESCRIPTORS 16
+#endif
+
+/* Chip_GPDMA_MemcpyAsync()/MemsetAsync() sizes below this many bytes are done by the CPU */
+#ifndef GPDMA_MEMOP_DMA_THRESHOLD
+#define GPDMA_MEMOP_DMA_THRESHOLD 256
+#endif
+
+struct GPDMA_JOB;
+
+/**
+ * @brief GPDMA job completion callback, status is SUCCESS or ERROR on a bus error
+ */
+typedef void (*GPDMA_JOB_CALLBACK_T)(struct GPDMA_JOB *pJob, Status status);
+
+/**
+ * @brief GPDMA job, owned by the driver from submission until its callback runs
+ */
+typedef struct GPDMA_JOB {
+	uint32_t src;							/*!< Source address or PeripheralConnection_ID, as for Chip_GPDMA_Transfer() */
+	uint32_t dst;							/*!< Destination address or PeripheralConnection_ID */
+	uint32_t Size;							/*!< Number of DMA transfers (bytes for memory to memory) */
+	GPDMA_FLOW_CONTROL_T TransferType;		/*!< M2M, M2P or P2M controller DMA transfer */
+	GPDMA_JOB_CALLBACK_T callback;			/*!< Called from Chip_GPDMA_JobIRQHandler(), or NULL */
+	struct GPDMA_JOB *pNext;				/*!< Driver use: next job queued on the channel */
+	DMA_TransferDescriptor_t *pDesc;		/*!< Driver use: descriptor chain taken from the pool */
+	uint32_t fill;							/*!< Driver use: Chip_GPDMA_MemsetAsync() pattern */
+} GPDMA_JOB_T;
+
 /**
  * @brief	Initialize the GPDMA
  * @param	pGPDMA	: The base of GPDMA on the chip
@@ -278,13 +332,13 @@ void Chip_GPDMA_DeInit(LPC_GPDMA_T *pGPDMA);
  * @param	TransferType	: Select the transfer controller and the type of transfer. (See, #GPDMA_FLOW_CONTROL_T)
  * @return	ERROR on error, SUCCESS on success
  */
-int Chip_GPDMA_InitChannelCfg(LPC_GPDMA_T *pGPDMA,
-							  GPDMA_CH_CFG_T *GPDMACfg,
-							  uint8_t  ChannelNum,
-							  uint32_t src,
-							  uint32_t dst,
-							  uint32_t Size,
-							  GPDMA_FLOW_CONTROL_T TransferType);
+HOTFUNC int Chip_GPDMA_InitChannelCfg(LPC_GPDMA_T *pGPDMA,
+									  GPDMA_CH_CFG_T *GPDMACfg,
+									  uint8_t  ChannelNum,
+									  uint32_t src,
+									  uint32_t dst,
+									  uint32_t Size,
+									  GPDMA_FLOW_CONTROL_T TransferType);
 
 /**
  * @brief	Enable or Disable the GPDMA Channel
@@ -293,7 +347,7 @@ int Chip_GPDMA_InitChannelCfg(LPC_GPDMA_T *pGPDMA,
  * @param	NewState	: ENABLE to enable GPDMA or DISABLE to disable GPDMA
  * @return	Nothing
  */
-void Chip_GPDMA_ChannelCmd(LPC_GPDMA_T *pGPDMA, uint8_t channelNum, FunctionalState NewState);
+HOTFUNC void Chip_GPDMA_ChannelCmd(LPC_GPDMA_T *pGPDMA, uint8_t channelNum, FunctionalState NewState);
 
 /**
  * @brief	Stop a stream DMA transfer
@@ -311,7 +365,7 @@ void Chip_GPDMA_Stop(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum);
  *              - SUCCESS	: DMA transfer success
  *              - ERROR		: DMA transfer failed
  */
-Status Chip_GPDMA_Interrupt(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum);
+HOTFUNC Status Chip_GPDMA_Interrupt(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum);
 
 /**
  * @brief	Read the status from different registers according to the type
@@ -326,7 +380,7 @@ Status Chip_GPDMA_Interrupt(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum);
  * @param	channel	: The GPDMA channel : 0 - 7
  * @return	SET is interrupt is pending or RESET if not pending
  */
-IntStatus Chip_GPDMA_IntGetStatus(LPC_GPDMA_T *pGPDMA, GPDMA_STATUS_T type, uint8_t channel);
+HOTFUNC IntStatus Chip_GPDMA_IntGetStatus(LPC_GPDMA_T *pGPDMA, GPDMA_STATUS_T type, uint8_t channel);
 
 /**
  * @brief	Clear the Interrupt Flag from different registers according to the type
@@ -337,7 +391,7 @@ IntStatus Chip_GPDMA_IntGetStatus(LPC_GPDMA_T *pGPDMA, GPDMA_STATUS_T type, uint
  * @param	channel	: The GPDMA channel : 0 - 7
  * @return	Nothing
  */
-void Chip_GPDMA_ClearIntPending(LPC_GPDMA_T *pGPDMA, GPDMA_STATECLEAR_T type, uint8_t channel);
+HOTFUNC void Chip_GPDMA_ClearIntPending(LPC_GPDMA_T *pGPDMA, GPDMA_STATECLEAR_T type, uint8_t channel);
 
 /**
  * @brief	Get a free GPDMA channel for one DMA connection
@@ -381,10 +435,54 @@ Status Chip_GPDMA_Transfer(LPC_GPDMA_T *pGPDMA,
  * @param	TransferType	: Select the transfer controller and the type of transfer. (See, #GPDMA_FLOW_CONTROL_T)
  * @return	ERROR on error, SUCCESS on success
  */
-Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T *pGPDMA,
-							 uint8_t ChannelNum,
-							 const DMA_TransferDescriptor_t *DMADescriptor,
-							 GPDMA_FLOW_CONTROL_T TransferType);
+HOTFUNC Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T *pGPDMA,
+									 uint8_t ChannelNum,
+									 const DMA_TransferDescriptor_t *DMADescriptor,
+									 GPDMA_FLOW_CONTROL_T TransferType);
+
+/**
+ * @brief	Copy or fill a rectangle of memory, one descriptor per line
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	ChannelNum	: Channel used for transfer *must be obtained using Chip_GPDMA_GetFreeChannel()*
+ * @param	pDesc		: Storage for lines descriptors, owned by the driver until the channel is idle
+ * @param	dst			: Address of the first destination line
+ * @param	dstStride	: Byte offset from one destination line to the next, may be negative
+ * @param	src			: Address of the first source line, or of a 32-bit fill pattern
+ * @param	srcStride	: Byte offset from one source line to the next, may be negative
+ * @param	lineBytes	: Number of bytes per line
+ * @param	lines		: Number of lines
+ * @param	fill		: true to fill from the pattern at src, which is held fixed
+ * @return	ERROR if a line is too long for one descriptor or the channel is busy, SUCCESS otherwise
+ * @note	Word, halfword or byte transfers are used depending on the
+ *			alignment of the lines. The channel raises its terminal count
+ *			status after the last line, poll GPDMA_STAT_ENABLED_CH or use
+ *			Chip_GPDMA_Interrupt() to find when the transfer is done. Each
+ *			line is copied upwards, so overlapping copies need the lines in
+ *			an order (stride sign) that does not read already written data.
+ */
+Status Chip_GPDMA_RectTransfer(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, DMA_TransferDescriptor_t *pDesc,
+							   uint32_t dst, int32_t dstStride, uint32_t src, int32_t srcStride,
+							   uint32_t lineBytes, uint32_t lines, bool fill);
+
+/**
+ * @brief	Do a peripheral DMA transfer using linked list of descriptors
+ * @param	pGPDMA			: The base of GPDMA on the chip
+ * @param	ChannelNum		: Channel used for transfer *must be obtained using Chip_GPDMA_GetFreeChannel()*
+ * @param	PeripheralConnection_ID	: GPDMA_CONN_* connection of the peripheral end
+ * @param	DMADescriptor	: First node in the linked list of descriptors
+ * @param	TransferType	: GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA or GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA
+ * @return	ERROR on error, SUCCESS on success
+ * @note	Chip_GPDMA_SGTransfer() can only recover the peripheral
+ *			request line for memory to memory lists, as the descriptors
+ *			hold the FIFO address rather than the connection. The list
+ *			may be circular (last node linking back to the first), in
+ *			which case the channel runs until Chip_GPDMA_Stop() is called.
+ */
+HOTFUNC Status Chip_GPDMA_SGTransferPeripheral(LPC_GPDMA_T *pGPDMA,
+											   uint8_t ChannelNum,
+											   uint32_t PeripheralConnection_ID,
+											   const DMA_TransferDescriptor_t *DMADescriptor,
+											   GPDMA_FLOW_CONTROL_T TransferType);
 
 /**
  * @brief	Prepare a single DMA descriptor
@@ -407,6 +505,110 @@ Status Chip_GPDMA_PrepareDescriptor(LPC_GPDMA_T *pGPDMA,
 									GPDMA_FLOW_CONTROL_T TransferType,
 									const DMA_TransferDescriptor_t *NextDescriptor);
 
+/**
+ * @brief	Get a free GPDMA channel in the range of a priority class
+ * @param	pGPDMA					: The base of GPDMA on the chip
+ * @param	PeripheralConnection_ID	: DMA connection the channel is for
+ * @param	prio					: Priority class of the client
+ * @param	preempt					: true to take over a background channel when none is free
+ * @return	The channel number, or GPDMA_NO_CHANNEL if none is available
+ * @note	The highest priority free channel of the class range is
+ *			returned. Realtime and normal clients fall back to the lower
+ *			priority ranges when their own is full; background clients
+ *			never leave theirs. When preempting, the background channel
+ *			is stopped and its queued jobs complete with ERROR, leaving
+ *			the background client to request a channel again. Release a
+ *			channel with Chip_GPDMA_Stop().
+ */
+uint8_t Chip_GPDMA_GetPriorityChannel(LPC_GPDMA_T *pGPDMA, uint32_t PeripheralConnection_ID,
+									  GPDMA_PRIO_T prio, bool preempt);
+
+/**
+ * @brief	Read the channel allocator statistics
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	stats	: Filled with the counts since Chip_GPDMA_Init()
+ * @return	Nothing
+ */
+void Chip_GPDMA_GetAllocStats(LPC_GPDMA_T *pGPDMA, GPDMA_ALLOC_STATS_T *stats);
+
+/**
+ * @brief	Initialize the GPDMA job queues and descriptor pool
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @return	Nothing
+ * @note	Call after Chip_GPDMA_Init(). Channels used for jobs must only
+ *			be serviced through Chip_GPDMA_JobIRQHandler(); any number of
+ *			drivers may queue jobs on the same channel.
+ */
+void Chip_GPDMA_JobInit(LPC_GPDMA_T *pGPDMA);
+
+/**
+ * @brief	Queue a transfer on a GPDMA channel
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	ChannelNum	: Channel used for transfer *must be obtained using Chip_GPDMA_GetFreeChannel()*
+ * @param	pJob		: Job to queue, filled in except for the driver use fields
+ * @return	ERROR if the transfer type is not supported or the descriptor
+ *			pool is exhausted, SUCCESS when the job was queued
+ * @note	Transfers longer than one descriptor can move (4095 transfers)
+ *			are split over a chain taken from the pool, which is returned
+ *			when the job completes. The job starts at once if the channel
+ *			is idle, otherwise after the jobs queued ahead of it. May be
+ *			called from interrupt handlers, including job callbacks.
+ */
+Status Chip_GPDMA_SubmitJob(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, GPDMA_JOB_T *pJob);
+
+/**
+ * @brief	Returns whether a GPDMA channel has jobs in progress or queued
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	ChannelNum	: Channel number
+ * @return	true if the channel job queue is not empty
+ */
+bool Chip_GPDMA_IsJobPending(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum);
+
+/**
+ * @brief	Copy memory in the background
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	ChannelNum	: Channel used for transfer *must be obtained using Chip_GPDMA_GetFreeChannel()*
+ * @param	pJob		: Job storage, owned by the driver until the callback runs
+ * @param	dst			: Destination address
+ * @param	src			: Source address
+ * @param	bytes		: Number of bytes to copy
+ * @param	callback	: Completion callback, or NULL
+ * @return	ERROR if the descriptor pool is exhausted, SUCCESS otherwise
+ * @note	Copies shorter than GPDMA_MEMOP_DMA_THRESHOLD are done by the
+ *			CPU before returning, with the callback run from this call.
+ *			Longer ones are queued as a job and use word, halfword or byte
+ *			transfers depending on the alignment of dst, src and bytes.
+ */
+Status Chip_GPDMA_MemcpyAsync(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, GPDMA_JOB_T *pJob,
+							  void *dst, const void *src, uint32_t bytes,
+							  GPDMA_JOB_CALLBACK_T callback);
+
+/**
+ * @brief	Fill memory in the background
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	ChannelNum	: Channel used for transfer *must be obtained using Chip_GPDMA_GetFreeChannel()*
+ * @param	pJob		: Job storage, owned by the driver until the callback runs
+ * @param	dst			: Destination address
+ * @param	value		: Byte value to fill with
+ * @param	bytes		: Number of bytes to fill
+ * @param	callback	: Completion callback, or NULL
+ * @return	ERROR if the descriptor pool is exhausted, SUCCESS otherwise
+ * @note	Same threshold and width selection as Chip_GPDMA_MemcpyAsync().
+ */
+Status Chip_GPDMA_MemsetAsync(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum, GPDMA_JOB_T *pJob,
+							  void *dst, uint8_t value, uint32_t bytes,
+							  GPDMA_JOB_CALLBACK_T callback);
+
+/**
+ * @brief	GPDMA interrupt handler for the job queues
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @return	Nothing
+ * @note	Call this from DMA_IRQHandler(). Completes the current job of
+ *			each interrupting channel, starts the next queued job and then
+ *			runs the completion callback.
+ */
+HOTFUNC void Chip_GPDMA_JobIRQHandler(LPC_GPDMA_T *pGPDMA);
+
 /**
  * @}
  */
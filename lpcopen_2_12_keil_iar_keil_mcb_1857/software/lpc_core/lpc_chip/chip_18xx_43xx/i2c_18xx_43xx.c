@@ -30,6 +30,7 @@
  */
 
 #include "chip.h"
+#include <string.h>
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -65,6 +66,9 @@ static struct i2c_interface i2c[I2C_NUM_INTERFACE] = {
 
 static struct i2c_slave_interface i2c_slave[I2C_NUM_INTERFACE][I2C_SLAVE_NUM_INTERFACE];
 
+/* Register map slaves */
+static I2C_REGSLAVE_T *i2c_regslave[I2C_NUM_INTERFACE];
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -127,6 +131,24 @@ STATIC INLINE int isMasterState(LPC_I2C_T *pI2C)
 	return getCurState(pI2C) < 0x60;
 }
 
+/* Make xfer the active master transfer unless one is in progress */
+static bool claimMaster(struct i2c_interface *iic, I2C_XFER_T *xfer)
+{
+	uint32_t primask;
+	bool claimed = false;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (!iic->mXfer) {
+		xfer->status = I2C_STATUS_BUSY;
+		iic->mXfer = xfer;
+		claimed = true;
+	}
+	__set_PRIMASK(primask);
+
+	return claimed;
+}
+
 /* Set OWN slave address for specific slave ID */
 STATIC void setSlaveAddr(LPC_I2C_T *pI2C, I2C_SLAVE_ID sid, uint8_t addr, uint8_t mask)
 {
@@ -323,6 +345,24 @@ int handleSlaveXferState(LPC_I2C_T *pI2C, I2C_XFER_T *xfer)
 	return ret;
 }
 
+/* Swap in a committed shadow map at a transfer start */
+STATIC INLINE void regSlaveStart(I2C_REGSLAVE_T *pRS)
+{
+	if (pRS->swap) {
+		pRS->live ^= 1;
+		pRS->stale = true;
+		pRS->swap = false;
+	}
+}
+
+/* Advance the register pointer, wrapping after the last register */
+STATIC INLINE void regSlaveNext(I2C_REGSLAVE_T *pRS)
+{
+	if (++pRS->ptr >= pRS->size) {
+		pRS->ptr = 0;
+	}
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -418,8 +458,9 @@ int Chip_I2C_MasterTransfer(I2C_ID_T id, I2C_XFER_T *xfer)
 	struct i2c_interface *iic = &i2c[id];
 
 	iic->mEvent(id, I2C_EVENT_LOCK);
-	xfer->status = I2C_STATUS_BUSY;
-	iic->mXfer = xfer;
+
+	/* Wait for a transfer started by Chip_I2C_MasterTransferStart() */
+	while (!claimMaster(iic, xfer)) {}
 
 	/* If slave xfer not in progress */
 	if (!iic->sXfer) {
@@ -440,6 +481,35 @@ int Chip_I2C_MasterTransfer(I2C_ID_T id, I2C_XFER_T *xfer)
 	return (int) xfer->status;
 }
 
+/* Start a master transfer without waiting for it to finish */
+int Chip_I2C_MasterTransferStart(I2C_ID_T id, I2C_XFER_T *xfer)
+{
+	struct i2c_interface *iic = &i2c[id];
+
+	if (!claimMaster(iic, xfer)) {
+		return 0;
+	}
+
+	/* If slave xfer not in progress */
+	if (!iic->sXfer) {
+		startMasterXfer(iic->ip);
+	}
+	return 1;
+}
+
+/* Release the master after a transfer started by Chip_I2C_MasterTransferStart() */
+void Chip_I2C_MasterTransferFinish(I2C_ID_T id)
+{
+	struct i2c_interface *iic = &i2c[id];
+
+	iic->mXfer = 0;
+
+	/* Start slave if one is active */
+	if (SLAVE_ACTIVE(iic)) {
+		startSlaverXfer(iic->ip);
+	}
+}
+
 /* Master tx only */
 int Chip_I2C_MasterSend(I2C_ID_T id, uint8_t slaveAddr, const uint8_t *buff, uint8_t len)
 {
@@ -540,6 +610,133 @@ void Chip_I2C_SlaveStateHandler(I2C_ID_T id)
 	}
 }
 
+/* Setup register map slave */
+void Chip_I2C_RegSlaveSetup(I2C_ID_T id, uint8_t slaveAddr, uint8_t addrMask, I2C_REGSLAVE_T *pRS)
+{
+	struct i2c_interface *iic = &i2c[id];
+
+	pRS->head = pRS->tail = 0;
+	pRS->live = 0;
+	pRS->swap = false;
+	pRS->stale = true;
+	pRS->first = pRS->wrote = false;
+	pRS->ptr = 0;
+	pRS->bursts = pRS->overruns = 0;
+	i2c_regslave[id] = pRS;
+
+	setSlaveAddr(iic->ip, I2C_SLAVE_0, slaveAddr, addrMask);
+	if (!SLAVE_ACTIVE(iic) && !iic->mXfer) {
+		startSlaverXfer(iic->ip);
+	}
+	iic->flags |= 1 << (I2C_SLAVE_0 + 8);
+}
+
+/* Register map slave state handler */
+void Chip_I2C_RegSlaveHandler(I2C_ID_T id)
+{
+	LPC_I2C_T *pI2C = LPC_I2Cx(id);
+	I2C_REGSLAVE_T *pRS = i2c_regslave[id];
+	uint8_t val;
+
+	switch (getCurState(pI2C)) {
+	case 0x60:			/* SLA+W received */
+	case 0x68:			/* Arbitration lost, SLA+W received */
+	case 0x70:			/* General call received */
+	case 0x78:			/* Arbitration lost, general call received */
+		regSlaveStart(pRS);
+		pRS->first = true;
+		break;
+
+	case 0x80:			/* Data received, ACK sent */
+	case 0x90:			/* General call data received, ACK sent */
+		val = (uint8_t) pI2C->DAT;
+		if (pRS->first) {
+			pRS->ptr = val;
+			pRS->first = false;
+			break;
+		}
+		if ((uint16_t) (pRS->head - pRS->tail) < pRS->ringSize) {
+			pRS->ring[pRS->head & (pRS->ringSize - 1)] = (uint16_t) ((pRS->ptr << 8) | val);
+			pRS->head++;
+		}
+		else {
+			pRS->overruns++;
+		}
+		if (pRS->writeThrough && (pRS->ptr < pRS->size)) {
+			pRS->map[pRS->live][pRS->ptr] = val;
+		}
+		pRS->wrote = true;
+		regSlaveNext(pRS);
+		break;
+
+	case 0xA8:			/* SLA+R received */
+	case 0xB0:			/* Arbitration lost, SLA+R received */
+		regSlaveStart(pRS);
+
+	/* Fall through */
+	case 0xB8:			/* Data sent, ACK received */
+		pI2C->DAT = (pRS->ptr < pRS->size) ? pRS->map[pRS->live][pRS->ptr] : 0xFF;
+		regSlaveNext(pRS);
+		break;
+
+	case 0xA0:			/* STOP or repeated START received */
+		if (pRS->wrote) {
+			pRS->bursts++;
+			pRS->wrote = false;
+		}
+		break;
+
+	case 0x00:			/* Bus error */
+		pI2C->CONSET = I2C_CON_STO;
+		break;
+
+	default:			/* NAK or last byte states, wait for the next address */
+		break;
+	}
+
+	pI2C->CONSET = I2C_CON_AA;
+	pI2C->CONCLR = I2C_CON_SI;
+}
+
+/* Get shadow register map */
+uint8_t *Chip_I2C_RegSlaveShadow(I2C_ID_T id)
+{
+	I2C_REGSLAVE_T *pRS = i2c_regslave[id];
+	uint8_t *shadow;
+
+	if (pRS->swap) {
+		return NULL;
+	}
+	shadow = pRS->map[pRS->live ^ 1];
+	if (pRS->stale) {
+		memcpy(shadow, pRS->map[pRS->live], pRS->size);
+		pRS->stale = false;
+	}
+	return shadow;
+}
+
+/* Publish shadow register map */
+void Chip_I2C_RegSlaveCommit(I2C_ID_T id)
+{
+	i2c_regslave[id]->swap = true;
+}
+
+/* Get oldest posted register write */
+bool Chip_I2C_RegSlaveGetWrite(I2C_ID_T id, uint8_t *reg, uint8_t *val)
+{
+	I2C_REGSLAVE_T *pRS = i2c_regslave[id];
+	uint16_t entry;
+
+	if (pRS->head == pRS->tail) {
+		return false;
+	}
+	entry = pRS->ring[pRS->tail & (pRS->ringSize - 1)];
+	pRS->tail++;
+	*reg = (uint8_t) (entry >> 8);
+	*val = (uint8_t) entry;
+	return true;
+}
+
 /* Disable I2C device */
 void Chip_I2C_Disable(I2C_ID_T id)
 {
@@ -161,6 +161,30 @@ typedef enum {
  */
 typedef void (*I2C_EVENTHANDLER_T)(I2C_ID_T, I2C_EVENT_T);
 
+/**
+ * @brief	Register map slave data structure definitions
+ * @note
+ * The application fills in the fields up to @a writeThrough, the
+ * rest belong to the driver and are set up by Chip_I2C_RegSlaveSetup().
+ */
+typedef struct {
+	uint8_t *map[2];		/**< Register map and its shadow, @a size bytes each */
+	uint16_t size;			/**< Number of registers in the map (1 to 256) */
+	uint16_t *ring;			/**< Posted write ring, entries are (register << 8) | value */
+	uint16_t ringSize;		/**< Number of entries in @a ring, must be a power of 2 */
+	bool writeThrough;		/**< true to also store posted writes into the live map */
+	volatile uint16_t head;	/**< Posted write ring head, advanced by the ISR */
+	volatile uint16_t tail;	/**< Posted write ring tail, advanced by the application */
+	volatile uint8_t live;	/**< Index of the map the ISR is serving */
+	volatile bool swap;		/**< A committed shadow waits for the next transfer start */
+	volatile bool stale;	/**< Shadow holds the previous map and must be refreshed */
+	bool first;				/**< Next received byte is the register pointer */
+	bool wrote;				/**< Current transfer has posted a write */
+	uint16_t ptr;			/**< Current register pointer */
+	volatile uint32_t bursts;	/**< Completed write transfers */
+	volatile uint32_t overruns;	/**< Writes dropped because the ring was full */
+} I2C_REGSLAVE_T;
+
 /**
  * @brief	Initializes the LPC_I2C peripheral with specified parameter.
  * @param	id			: I2C peripheral ID (I2C0, I2C1 ... etc)
@@ -216,6 +240,27 @@ uint32_t Chip_I2C_GetClockRate(I2C_ID_T id);
  */
 int Chip_I2C_MasterTransfer(I2C_ID_T id, I2C_XFER_T *xfer);
 
+/**
+ * @brief	Start a master transfer without waiting for it to finish
+ * @param	id		: I2C peripheral selected (I2C0, I2C1 etc)
+ * @param	xfer	: Pointer to a I2C_XFER_T structure, as for Chip_I2C_MasterTransfer()
+ * @return	1 if the transfer was started, 0 if another master transfer is in progress
+ * @note	The I2C interrupt must be enabled and its handler must call
+ * Chip_I2C_MasterStateHandler(). The transfer is done once the @a status
+ * member of @a xfer is no longer I2C_STATUS_BUSY, the caller must then
+ * call Chip_I2C_MasterTransferFinish() before the next transfer can start.
+ * May be called from interrupt handlers. Chip_I2C_MasterTransfer() waits
+ * for a started transfer to be finished.
+ */
+int Chip_I2C_MasterTransferStart(I2C_ID_T id, I2C_XFER_T *xfer);
+
+/**
+ * @brief	Release the master after a transfer started by Chip_I2C_MasterTransferStart()
+ * @param	id		: I2C peripheral selected (I2C0, I2C1 etc)
+ * @return	Nothing
+ */
+void Chip_I2C_MasterTransferFinish(I2C_ID_T id);
+
 /**
  * @brief	Transmit data to I2C slave using I2C Master mode
  * @param	id			: I2C peripheral ID (I2C0, I2C1 .. etc)
@@ -378,6 +423,67 @@ void Chip_I2C_SlaveSetup(I2C_ID_T id,
  */
 void Chip_I2C_SlaveStateHandler(I2C_ID_T id);
 
+/**
+ * @brief	Setup a register map I2C slave
+ * @param	id			: I2C peripheral ID (I2C0, I2C1 ... etc)
+ * @param	slaveAddr	: 7bit Slave address (From Bit1 to Bit7)
+ * @param	addrMask	: Address mask, same as Chip_I2C_SlaveSetup()
+ * @param	pRS			: Pointer to register map slave structure
+ * @return	Nothing
+ * @note
+ * The slave emulates a typical register based device at high bus rates
+ * without any per byte callbacks. The first byte of a write transfer
+ * sets the register pointer, every following byte is posted into
+ * @a pRS->ring as a (register, value) pair and the pointer is
+ * incremented. A read transfer is served from the live map directly
+ * in the interrupt handler starting at the register pointer, which
+ * wraps to 0 after the last register. Registers outside the map read
+ * as 0xFF. The slave always acknowledges, so the application must
+ * drain the ring fast enough; writes that find the ring full are
+ * counted in @a pRS->overruns and dropped.<br>
+ * The application interrupt handler must call Chip_I2C_RegSlaveHandler()
+ * instead of Chip_I2C_SlaveStateHandler(). I2C_SLAVE_0 is used for the
+ * address match.
+ */
+void Chip_I2C_RegSlaveSetup(I2C_ID_T id, uint8_t slaveAddr, uint8_t addrMask, I2C_REGSLAVE_T *pRS);
+
+/**
+ * @brief	Register map slave state handler
+ * @param	id		: I2C peripheral ID (I2C0, I2C1 ... etc)
+ * @return	Nothing
+ */
+void Chip_I2C_RegSlaveHandler(I2C_ID_T id);
+
+/**
+ * @brief	Get the shadow register map for updating
+ * @param	id		: I2C peripheral ID (I2C0, I2C1 ... etc)
+ * @return	Pointer to the shadow map, or NULL while a commit is pending
+ * @note
+ * The shadow is refreshed from the live map before it is returned the
+ * first time after a swap, so only the changed registers need writing.
+ * Call Chip_I2C_RegSlaveCommit() to publish the shadow.
+ */
+uint8_t *Chip_I2C_RegSlaveShadow(I2C_ID_T id);
+
+/**
+ * @brief	Publish the shadow register map
+ * @param	id		: I2C peripheral ID (I2C0, I2C1 ... etc)
+ * @return	Nothing
+ * @note
+ * The maps are swapped at the start of the next transfer, so a master
+ * never reads a mix of old and new register contents in one transfer.
+ */
+void Chip_I2C_RegSlaveCommit(I2C_ID_T id);
+
+/**
+ * @brief	Get the oldest posted register write
+ * @param	id		: I2C peripheral ID (I2C0, I2C1 ... etc)
+ * @param	reg		: Pointer to store the register number
+ * @param	val		: Pointer to store the written value
+ * @return	true if a write was returned, false if the ring is empty
+ */
+bool Chip_I2C_RegSlaveGetWrite(I2C_ID_T id, uint8_t *reg, uint8_t *val);
+
 /**
  * @brief	I2C peripheral state change checking
  * @param	id		: I2C peripheral ID (I2C0, I2C1 ... etc)
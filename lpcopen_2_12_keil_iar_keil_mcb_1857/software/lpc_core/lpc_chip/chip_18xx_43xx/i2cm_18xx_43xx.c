@@ -38,6 +38,10 @@
 /* Control flags */
 #define I2C_CON_FLAGS (I2C_CON_AA | I2C_CON_SI | I2C_CON_STO | I2C_CON_STA)
 
+/* Flag to keep clear on successful completion, STA to chain with a repeated START */
+#define I2C_CON_DONE(xfer) \
+	(((xfer)->options & I2CM_XFER_OPTION_REPEAT_START) ? I2C_CON_STA : I2C_CON_STO)
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -109,7 +113,7 @@ uint32_t Chip_I2CM_XferHandler(LPC_I2C_T *pI2C, I2CM_XFER_T *xfer)
 			}
 			else {
 				xfer->status = I2CM_STATUS_OK;
-				cclr &= ~I2C_CON_STO;
+				cclr &= ~I2C_CON_DONE(xfer);
 			}
 
 		}
@@ -131,7 +135,7 @@ uint32_t Chip_I2CM_XferHandler(LPC_I2C_T *pI2C, I2CM_XFER_T *xfer)
 		}
 		if (xfer->rxSz == 0) {
 			xfer->status = I2CM_STATUS_OK;
-			cclr &= ~I2C_CON_STO;
+			cclr &= ~I2C_CON_DONE(xfer);
 		}
 		break;
 
@@ -262,3 +266,93 @@ uint32_t Chip_I2CM_Read(LPC_I2C_T *pI2C, uint8_t *buff, uint32_t len)
 
 	return rxLen;
 }
+
+/* Initialize an I2C transfer queue */
+void Chip_I2CM_QueueInit(I2CM_QUEUE_T *pQueue, LPC_I2C_T *pI2C)
+{
+	pQueue->pI2C = pI2C;
+	pQueue->pHead = NULL;
+	pQueue->pTail = NULL;
+	pQueue->restarts = 0;
+}
+
+/* Queue an I2C transfer */
+void Chip_I2CM_QueueSubmit(I2CM_QUEUE_T *pQueue, I2CM_QUEUE_JOB_T *pJob)
+{
+	uint32_t primask;
+
+	pJob->pNext = NULL;
+	pJob->xfer.status = I2CM_STATUS_BUSY;
+	pJob->xfer.options &= ~I2CM_XFER_OPTION_REPEAT_START;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (pQueue->pHead == NULL) {
+		pQueue->pHead = pJob;
+		pQueue->pTail = pJob;
+		Chip_I2CM_Xfer(pQueue->pI2C, &pJob->xfer);
+	}
+	else {
+		pQueue->pTail->pNext = pJob;
+		pQueue->pTail = pJob;
+	}
+	__set_PRIMASK(primask);
+}
+
+/* Transfer queue interrupt handler */
+void Chip_I2CM_QueueIRQHandler(I2CM_QUEUE_T *pQueue)
+{
+	I2CM_QUEUE_JOB_T *pJob = pQueue->pHead;
+	I2CM_QUEUE_JOB_T *pNext;
+	bool restart;
+
+	if (pJob == NULL) {
+		/* Nothing queued, stale state change */
+		Chip_I2CM_ClearSI(pQueue->pI2C);
+		return;
+	}
+
+	/* Decide before the last state change whether this job ends with a repeated START,
+	   a job queued after that point is started after a STOP instead */
+	if (pJob->chain && (pJob->pNext != NULL)) {
+		pJob->xfer.options |= I2CM_XFER_OPTION_REPEAT_START;
+	}
+	else {
+		pJob->xfer.options &= ~I2CM_XFER_OPTION_REPEAT_START;
+	}
+
+	if (Chip_I2CM_XferHandler(pQueue->pI2C, &pJob->xfer) == 0) {
+		return;
+	}
+
+	restart = (pJob->xfer.options & I2CM_XFER_OPTION_REPEAT_START) &&
+			  (pJob->xfer.status == I2CM_STATUS_OK);
+	pJob->xfer.options &= ~I2CM_XFER_OPTION_REPEAT_START;
+
+	/* Hand the bus to the next job before running the callback */
+	pNext = pJob->pNext;
+	pQueue->pHead = pNext;
+	if (pNext == NULL) {
+		pQueue->pTail = NULL;
+	}
+	else if (restart) {
+		/* Repeated START already requested, next state change is 0x10 */
+		pQueue->restarts++;
+	}
+	else {
+		Chip_I2CM_Xfer(pQueue->pI2C, &pNext->xfer);
+	}
+
+	if (pJob->callback) {
+		pJob->callback(pJob);
+	}
+}
+
+/* Queue an I2C transfer and wait for it to finish */
+uint16_t Chip_I2CM_QueueXferBlocking(I2CM_QUEUE_T *pQueue, I2CM_QUEUE_JOB_T *pJob)
+{
+	Chip_I2CM_QueueSubmit(pQueue, pJob);
+	while (*(volatile uint16_t *) &pJob->xfer.status == I2CM_STATUS_BUSY) {}
+
+	return pJob->xfer.status;
+}
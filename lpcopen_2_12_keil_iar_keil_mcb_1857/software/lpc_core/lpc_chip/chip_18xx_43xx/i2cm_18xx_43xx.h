@@ -65,6 +65,9 @@ extern "C" {
 #define I2CM_XFER_OPTION_IGNORE_NACK     0x01
 /** ACK last byte received. By default we NACK last byte we receive per I2C spec. */
 #define I2CM_XFER_OPTION_LAST_RX_ACK     0x02
+/** End a successful transfer with a repeated START instead of a STOP. Used by the
+    transfer queue to chain the next transfer without releasing the bus. */
+#define I2CM_XFER_OPTION_REPEAT_START    0x04
 
 /**
  * @}
@@ -101,6 +104,37 @@ typedef struct {
 	uint8_t *rxBuff;		/*!< Pointer memory where bytes received from I2C be stored */
 } I2CM_XFER_T;
 
+struct I2CM_QUEUE_JOB;
+
+/**
+ * @brief I2C queued transfer completion callback
+ * Called from Chip_I2CM_QueueIRQHandler() once the transfer has finished,
+ * the result is in the @a status member of the job's transfer.
+ */
+typedef void (*I2CM_QUEUE_CALLBACK_T)(struct I2CM_QUEUE_JOB *pJob);
+
+/**
+ * @brief I2C queued transfer (one per device request)
+ */
+typedef struct I2CM_QUEUE_JOB {
+	I2CM_XFER_T xfer;				/*!< Transfer to run, status holds the result */
+	bool chain;						/*!< Device accepts the next queued transfer after a
+									   repeated START, false to always end with STOP */
+	I2CM_QUEUE_CALLBACK_T callback;	/*!< Completion callback or NULL */
+	void *pData;					/*!< Caller data for the callback */
+	struct I2CM_QUEUE_JOB *pNext;	/*!< Next queued job, owned by the queue */
+} I2CM_QUEUE_JOB_T;
+
+/**
+ * @brief I2C transfer queue, serializes the transfers of several device drivers on one bus
+ */
+typedef struct {
+	LPC_I2C_T *pI2C;				/*!< I2C peripheral the queue drives */
+	I2CM_QUEUE_JOB_T *pHead;		/*!< Job owning the bus, NULL when idle */
+	I2CM_QUEUE_JOB_T *pTail;		/*!< Last queued job */
+	uint32_t restarts;				/*!< Jobs started with a repeated START instead of STOP/START */
+} I2CM_QUEUE_T;
+
 /**
  * @brief	Initialize I2C Interface
  * @param	pI2C	: Pointer to selected I2C peripheral
@@ -407,6 +441,61 @@ uint32_t Chip_I2CM_Write(LPC_I2C_T *pI2C, const uint8_t *buff, uint32_t len);
  */
 uint32_t Chip_I2CM_Read(LPC_I2C_T *pI2C, uint8_t *buff, uint32_t len);
 
+/**
+ * @brief	Initialize an I2C transfer queue
+ * @param	pQueue	: Pointer to the queue to initialize
+ * @param	pI2C	: Pointer to selected I2C peripheral
+ * @return	Nothing
+ * @note	The I2C peripheral must already be initialized and its bus speed
+ *          set. Call Chip_I2CM_QueueIRQHandler() from the I2C interrupt
+ *          handler and enable the I2C interrupt in the NVIC.
+ */
+void Chip_I2CM_QueueInit(I2CM_QUEUE_T *pQueue, LPC_I2C_T *pI2C);
+
+/**
+ * @brief	Queue an I2C transfer
+ * @param	pQueue	: Pointer to the transfer queue
+ * @param	pJob	: Pointer to the job to queue
+ * @return	Nothing
+ * @note	The transfer is started at once if the bus is idle, otherwise
+ *          it runs after the jobs queued before it. When the job ahead
+ *          has its @a chain member set the transfer starts with a repeated
+ *          START and no STOP is sent in between. The job and its buffers
+ *          must stay valid until the status of its transfer is no longer
+ *          I2CM_STATUS_BUSY. May be called from interrupt context.
+ */
+void Chip_I2CM_QueueSubmit(I2CM_QUEUE_T *pQueue, I2CM_QUEUE_JOB_T *pJob);
+
+/**
+ * @brief	Check whether the transfer queue has work pending
+ * @param	pQueue	: Pointer to the transfer queue
+ * @return	true if a job owns the bus, false if the queue is idle
+ */
+static INLINE bool Chip_I2CM_QueueIsBusy(I2CM_QUEUE_T *pQueue)
+{
+	return pQueue->pHead != NULL;
+}
+
+/**
+ * @brief	Transfer queue interrupt handler
+ * @param	pQueue	: Pointer to the transfer queue
+ * @return	Nothing
+ * @note	Call from the I2C interrupt handler. Runs the state machine for
+ *          the job owning the bus, starts the next job when it finishes
+ *          and then calls the finished job's callback.
+ */
+void Chip_I2CM_QueueIRQHandler(I2CM_QUEUE_T *pQueue);
+
+/**
+ * @brief	Queue an I2C transfer and wait for it to finish
+ * @param	pQueue	: Pointer to the transfer queue
+ * @param	pJob	: Pointer to the job to run, its callback is still called
+ * @return	Returns the status of the transfer (I2CM_STATUS_*)
+ * @note	Must not be called from the I2C interrupt or with interrupts
+ *          disabled, the queue is driven by Chip_I2CM_QueueIRQHandler().
+ */
+uint16_t Chip_I2CM_QueueXferBlocking(I2CM_QUEUE_T *pQueue, I2CM_QUEUE_JOB_T *pJob);
+
 /**
  * @}
  */
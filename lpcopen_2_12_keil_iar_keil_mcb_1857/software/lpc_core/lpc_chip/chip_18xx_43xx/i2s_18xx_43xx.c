@@ -43,6 +43,45 @@
  * Private functions
  ****************************************************************************/
 
+/* Build the circular two period list of one audio direction */
+static void audioBuildList(DMA_TransferDescriptor_t *pDesc, uint32_t *pBuffer, uint32_t period,
+						   volatile uint32_t *pFifo, bool tx)
+{
+	uint32_t ctrl;
+	int i;
+
+	ctrl = GPDMA_DMACCxControl_TransferSize(period) |
+		   GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_4) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_4) |
+		   GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) |
+		   GPDMA_DMACCxControl_I;
+	ctrl |= tx ? (GPDMA_DMACCxControl_SI | GPDMA_DMACCxControl_DestTransUseAHBMaster1) :
+			(GPDMA_DMACCxControl_DI | GPDMA_DMACCxControl_SrcTransUseAHBMaster1);
+
+	for (i = 0; i < 2; i++) {
+		pDesc[i].src = tx ? (uint32_t) &pBuffer[i * period] : (uint32_t) pFifo;
+		pDesc[i].dst = tx ? (uint32_t) pFifo : (uint32_t) &pBuffer[i * period];
+		pDesc[i].lli = (uint32_t) &pDesc[i ^ 1];
+		pDesc[i].ctrl = ctrl;
+	}
+}
+
+/* Returns the period that just elapsed on a channel, resyncing after an xrun */
+static uint32_t audioElapsed(LPC_GPDMA_T *pGPDMA, uint8_t ch, DMA_TransferDescriptor_t *pDesc,
+							 uint8_t *pHalf, uint32_t *pXruns)
+{
+	uint8_t half = *pHalf;
+
+	/* While the other period runs the channel links back to this one; a link
+	   to the other period means both elapsed and the DMA is here again */
+	if (pGPDMA->CH[ch].LLI == (uint32_t) &pDesc[half ^ 1]) {
+		(*pXruns)++;
+		half ^= 1;
+	}
+	*pHalf = half ^ 1;
+
+	return half;
+}
+
 /* Get divider value */
 STATIC Status getClkDiv(LPC_I2S_T *pI2S, I2S_AUDIO_FORMAT_T *format, uint16_t *pxDiv, uint16_t *pyDiv, uint32_t *pN)
 {
@@ -255,3 +294,138 @@ void Chip_I2S_DMA_RxCmd(LPC_I2S_T *pI2S,
 	}
 }
 
+/* Set up a DMA audio pipeline */
+Status Chip_I2S_Audio_Init(I2S_AUDIO_T *pAudio, LPC_I2S_T *pI2S, LPC_GPDMA_T *pGPDMA, uint32_t period,
+						   uint32_t *pTxBuffer, I2S_AUDIO_CALLBACK_T txCallback,
+						   uint32_t *pRxBuffer, I2S_AUDIO_CALLBACK_T rxCallback)
+{
+	if ((period == 0) || (period > I2S_AUDIO_MAX_PERIOD) || ((pTxBuffer == NULL) && (pRxBuffer == NULL))) {
+		return ERROR;
+	}
+
+	pAudio->pI2S = pI2S;
+	pAudio->pGPDMA = pGPDMA;
+	pAudio->period = period;
+	pAudio->pTxBuffer = pTxBuffer;
+	pAudio->pRxBuffer = pRxBuffer;
+	pAudio->txCallback = txCallback;
+	pAudio->rxCallback = rxCallback;
+	pAudio->txPeriods = pAudio->rxPeriods = 0;
+	pAudio->txXruns = pAudio->rxXruns = 0;
+	pAudio->txChannel = pAudio->rxChannel = GPDMA_NO_CHANNEL;
+
+	if (pI2S == LPC_I2S0) {
+		pAudio->txConn = GPDMA_CONN_I2S_Tx_Channel_0;
+		pAudio->rxConn = GPDMA_CONN_I2S_Rx_Channel_1;
+	}
+	else {
+		pAudio->txConn = GPDMA_CONN_I2S1_Tx_Channel_0;
+		pAudio->rxConn = GPDMA_CONN_I2S1_Rx_Channel_1;
+	}
+
+	if (pTxBuffer) {
+		pAudio->txChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, pAudio->txConn);
+		if (pAudio->txChannel >= GPDMA_NUMBER_CHANNELS) {
+			return ERROR;
+		}
+		audioBuildList(pAudio->txDesc, pTxBuffer, period, &pI2S->TXFIFO, true);
+	}
+	if (pRxBuffer) {
+		pAudio->rxChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, pAudio->rxConn);
+		if (pAudio->rxChannel >= GPDMA_NUMBER_CHANNELS) {
+			return ERROR;
+		}
+		audioBuildList(pAudio->rxDesc, pRxBuffer, period, (volatile uint32_t *) &pI2S->RXFIFO, false);
+	}
+
+	return SUCCESS;
+}
+
+/* Start a DMA audio pipeline */
+Status Chip_I2S_Audio_Start(I2S_AUDIO_T *pAudio)
+{
+	pAudio->txHalf = pAudio->rxHalf = 0;
+
+	/* Channels first, the FIFO requests start the flow */
+	if ((pAudio->pRxBuffer != NULL) &&
+		(Chip_GPDMA_SGTransferPeripheral(pAudio->pGPDMA, pAudio->rxChannel, pAudio->rxConn, &pAudio->rxDesc[0],
+										 GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR)) {
+		return ERROR;
+	}
+	if ((pAudio->pTxBuffer != NULL) &&
+		(Chip_GPDMA_SGTransferPeripheral(pAudio->pGPDMA, pAudio->txChannel, pAudio->txConn, &pAudio->txDesc[0],
+										 GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == ERROR)) {
+		Chip_I2S_Audio_Stop(pAudio);
+		return ERROR;
+	}
+
+	if (pAudio->pRxBuffer != NULL) {
+		Chip_I2S_DMA_RxCmd(pAudio->pI2S, I2S_DMA_REQUEST_CHANNEL_2, ENABLE, I2S_AUDIO_FIFO_DEPTH);
+		Chip_I2S_RxStart(pAudio->pI2S);
+	}
+	if (pAudio->pTxBuffer != NULL) {
+		Chip_I2S_DMA_TxCmd(pAudio->pI2S, I2S_DMA_REQUEST_CHANNEL_1, ENABLE, I2S_AUDIO_FIFO_DEPTH);
+		Chip_I2S_TxStart(pAudio->pI2S);
+	}
+
+	return SUCCESS;
+}
+
+/* Stop a DMA audio pipeline */
+void Chip_I2S_Audio_Stop(I2S_AUDIO_T *pAudio)
+{
+	uint8_t ch[2];
+	int i;
+
+	Chip_I2S_DMA_TxCmd(pAudio->pI2S, I2S_DMA_REQUEST_CHANNEL_1, DISABLE, I2S_AUDIO_FIFO_DEPTH);
+	Chip_I2S_DMA_RxCmd(pAudio->pI2S, I2S_DMA_REQUEST_CHANNEL_2, DISABLE, I2S_AUDIO_FIFO_DEPTH);
+
+	ch[0] = pAudio->txChannel;
+	ch[1] = pAudio->rxChannel;
+	for (i = 0; i < 2; i++) {
+		if (ch[i] < GPDMA_NUMBER_CHANNELS) {
+			Chip_GPDMA_ChannelCmd(pAudio->pGPDMA, ch[i], DISABLE);
+			Chip_GPDMA_ClearIntPending(pAudio->pGPDMA, GPDMA_STATCLR_INTTC, ch[i]);
+			Chip_GPDMA_ClearIntPending(pAudio->pGPDMA, GPDMA_STATCLR_INTERR, ch[i]);
+		}
+	}
+}
+
+/* GPDMA interrupt handler for a DMA audio pipeline */
+bool Chip_I2S_Audio_IRQHandler(I2S_AUDIO_T *pAudio)
+{
+	LPC_GPDMA_T *pGPDMA = pAudio->pGPDMA;
+	bool handled = false;
+	uint32_t half;
+
+	if ((pAudio->rxChannel < GPDMA_NUMBER_CHANNELS) &&
+		Chip_GPDMA_IntGetStatus(pGPDMA, GPDMA_STAT_INT, pAudio->rxChannel)) {
+		handled = true;
+		if (Chip_GPDMA_Interrupt(pGPDMA, pAudio->rxChannel) == ERROR) {
+			Chip_I2S_Audio_Stop(pAudio);
+			return true;
+		}
+		half = audioElapsed(pGPDMA, pAudio->rxChannel, pAudio->rxDesc, &pAudio->rxHalf, &pAudio->rxXruns);
+		pAudio->rxPeriods++;
+		if (pAudio->rxCallback) {
+			pAudio->rxCallback(pAudio, &pAudio->pRxBuffer[half * pAudio->period], pAudio->period);
+		}
+	}
+
+	if ((pAudio->txChannel < GPDMA_NUMBER_CHANNELS) &&
+		Chip_GPDMA_IntGetStatus(pGPDMA, GPDMA_STAT_INT, pAudio->txChannel)) {
+		handled = true;
+		if (Chip_GPDMA_Interrupt(pGPDMA, pAudio->txChannel) == ERROR) {
+			Chip_I2S_Audio_Stop(pAudio);
+			return true;
+		}
+		half = audioElapsed(pGPDMA, pAudio->txChannel, pAudio->txDesc, &pAudio->txHalf, &pAudio->txXruns);
+		pAudio->txPeriods++;
+		if (pAudio->txCallback) {
+			pAudio->txCallback(pAudio, &pAudio->pTxBuffer[half * pAudio->period], pAudio->period);
+		}
+	}
+
+	return handled;
+}
+
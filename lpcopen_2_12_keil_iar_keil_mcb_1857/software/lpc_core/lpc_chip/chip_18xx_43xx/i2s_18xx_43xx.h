@@ -32,6 +32,9 @@
 #ifndef __I2S_18XX_43XX_H_
 #define __I2S_18XX_43XX_H_
 
+/* The audio pipeline keeps its GPDMA descriptors in the pipeline handle */
+#include "gpdma_18xx_43xx.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -549,6 +552,96 @@ void Chip_I2S_DMA_TxCmd(LPC_I2S_T *pI2S, I2S_DMA_CHANNEL_T dmaNum, FunctionalSta
  */
 void Chip_I2S_DMA_RxCmd(LPC_I2S_T *pI2S, I2S_DMA_CHANNEL_T dmaNum, FunctionalState newState, uint8_t depth);
 
+/** Largest audio pipeline period, in FIFO words */
+#define I2S_AUDIO_MAX_PERIOD    0xFFF
+
+/** FIFO level at which the audio pipeline requests a DMA burst */
+#define I2S_AUDIO_FIFO_DEPTH    4
+
+struct I2S_AUDIO;
+
+/**
+ * @brief I2S audio pipeline period callback
+ * Called from Chip_I2S_Audio_IRQHandler() once per elapsed period. For
+ * transmit, the @a words at @a pPeriod have just been played and must be
+ * refilled; for receive, they have just been captured. Each word is one
+ * FIFO entry (one stereo frame for 16-bit stereo audio). The callback has
+ * one period of time before the DMA comes back to the same words.
+ */
+typedef void (*I2S_AUDIO_CALLBACK_T)(struct I2S_AUDIO *pAudio, uint32_t *pPeriod, uint32_t words);
+
+/**
+ * @brief I2S full duplex DMA audio pipeline, one ping-pong buffer per direction
+ */
+typedef struct I2S_AUDIO {
+	LPC_I2S_T *pI2S;					/*!< I2S peripheral, already configured for the audio format */
+	LPC_GPDMA_T *pGPDMA;				/*!< GPDMA controller */
+	uint8_t txConn;						/*!< GPDMA connection of the transmit FIFO */
+	uint8_t rxConn;						/*!< GPDMA connection of the receive FIFO */
+	uint8_t txChannel;					/*!< GPDMA channel for transmit, GPDMA_NO_CHANNEL if unused */
+	uint8_t rxChannel;					/*!< GPDMA channel for receive, GPDMA_NO_CHANNEL if unused */
+	uint8_t txHalf;						/*!< Transmit period the DMA finishes next, 0 or 1 */
+	uint8_t rxHalf;						/*!< Receive period the DMA finishes next, 0 or 1 */
+	uint32_t period;					/*!< Words per period */
+	uint32_t *pTxBuffer;				/*!< 2 periods of transmit words or NULL */
+	uint32_t *pRxBuffer;				/*!< 2 periods of receive words or NULL */
+	I2S_AUDIO_CALLBACK_T txCallback;	/*!< Transmit period elapsed callback or NULL */
+	I2S_AUDIO_CALLBACK_T rxCallback;	/*!< Receive period elapsed callback or NULL */
+	void *pData;						/*!< Caller data for the callbacks */
+	uint32_t txPeriods;					/*!< Transmit periods elapsed */
+	uint32_t rxPeriods;					/*!< Receive periods elapsed */
+	uint32_t txXruns;					/*!< Transmit underruns, periods played before their refill */
+	uint32_t rxXruns;					/*!< Receive overruns, periods captured over before being read */
+	DMA_TransferDescriptor_t txDesc[2];	/*!< Circular transmit list */
+	DMA_TransferDescriptor_t rxDesc[2];	/*!< Circular receive list */
+} I2S_AUDIO_T;
+
+/**
+ * @brief   Set up a DMA audio pipeline
+ * @param	pAudio		: Pipeline handle to initialize
+ * @param	pI2S		: The base I2S peripheral on the chip, configured with
+ *						  Chip_I2S_TxConfig()/Chip_I2S_RxConfig()
+ * @param	pGPDMA		: The GPDMA controller, already initialized
+ * @param	period		: Words per period, 1 to I2S_AUDIO_MAX_PERIOD
+ * @param	pTxBuffer	: Transmit buffer of 2 * @a period words, NULL for receive only
+ * @param	txCallback	: Transmit refill callback, may be NULL
+ * @param	pRxBuffer	: Receive buffer of 2 * @a period words, NULL for transmit only
+ * @param	rxCallback	: Receive callback, may be NULL
+ * @return	SUCCESS, or ERROR if @a period is out of range or GPDMA channels are missing
+ * @note	One GPDMA channel is claimed per direction. Call Chip_I2S_Audio_IRQHandler()
+ *			from the DMA interrupt handler. The latency of each direction is
+ *			one to two periods.
+ */
+Status Chip_I2S_Audio_Init(I2S_AUDIO_T *pAudio, LPC_I2S_T *pI2S, LPC_GPDMA_T *pGPDMA, uint32_t period,
+						   uint32_t *pTxBuffer, I2S_AUDIO_CALLBACK_T txCallback,
+						   uint32_t *pRxBuffer, I2S_AUDIO_CALLBACK_T rxCallback);
+
+/**
+ * @brief   Start a DMA audio pipeline
+ * @param	pAudio		: Pipeline handle
+ * @return	SUCCESS or ERROR if a DMA channel could not be started
+ * @note	The transmit buffer should hold the first two periods of audio.
+ *			Both directions start together so their periods stay aligned.
+ */
+Status Chip_I2S_Audio_Start(I2S_AUDIO_T *pAudio);
+
+/**
+ * @brief   Stop a DMA audio pipeline
+ * @param	pAudio		: Pipeline handle
+ * @return	Nothing
+ * @note	The GPDMA channels stay claimed for the next Chip_I2S_Audio_Start().
+ */
+void Chip_I2S_Audio_Stop(I2S_AUDIO_T *pAudio);
+
+/**
+ * @brief   GPDMA interrupt handler for a DMA audio pipeline
+ * @param	pAudio		: Pipeline handle
+ * @return	true if the interrupt was for one of the pipeline's channels
+ * @note	Runs the period callbacks and counts xruns, a period the DMA went
+ *			past before its interrupt was served.
+ */
+bool Chip_I2S_Audio_IRQHandler(I2S_AUDIO_T *pAudio);
+
 /**
  * @}
  */
@@ -0,0 +1,494 @@
+/*
+ * @brief LPC18xx/43xx Flash log structured store
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include "string.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Sector layout: a 16 byte header (magic, sequence number, its complement,
+   erased word), then records. A record is a header of 3 words (magic and
+   key, data length, CRC32 of the first two words and the data) followed
+   by the data padded to words. Erased words skip to the next page, which
+   is where appending resumes after a commit or a reset. */
+#define STORE_SECTOR_MAGIC  0x474F4C53	/* "SLOG" */
+#define STORE_SECTOR_HDR    16
+#define STORE_REC_MAGIC     0x4B56
+#define STORE_REC_HDR       12
+#define STORE_ERASED        0xFFFFFFFF
+#define STORE_REC_BYTES(len)    (STORE_REC_HDR + (((len) + 3) & ~3))
+#define STORE_PAGE_ALIGN(addr)  (((addr) + IAP_STORE_PAGE_SIZE - 1) & ~(IAP_STORE_PAGE_SIZE - 1))
+
+/* Flash bank layout: 8 sectors of 8KB, then 64KB sectors */
+#define FLASH_BANK_A_BASE   0x1A000000
+#define FLASH_BANK_B_BASE   0x1B000000
+#define FLASH_SMALL_SECTORS 8
+
+/* CRC32 (IEEE 802.3), 4 bits at a time */
+static const uint32_t crcNibble[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Update a CRC32 with a block of bytes */
+STATIC uint32_t crc32Update(uint32_t crc, const uint8_t *pData, uint32_t len)
+{
+	while (len--) {
+		crc ^= *pData++;
+		crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+		crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+	}
+	return crc;
+}
+
+/* CRC32 of a record header and its data */
+STATIC uint32_t recordCRC(const uint32_t *pHdr, const uint8_t *pData, uint32_t len)
+{
+	uint32_t crc;
+
+	crc = crc32Update(0xFFFFFFFF, (const uint8_t *) pHdr, 8);
+	return ~crc32Update(crc, pData, len);
+}
+
+/* Flash address of a store sector */
+STATIC uint32_t sectorBase(IAP_STORE_T *pStore, int s)
+{
+	uint32_t sector = pStore->firstSector + s;
+	uint32_t base = (pStore->bank == IAP_FLASH_BANK_B) ? FLASH_BANK_B_BASE : FLASH_BANK_A_BASE;
+
+	if (sector < FLASH_SMALL_SECTORS) {
+		return base + (sector * 0x2000);
+	}
+	return base + (FLASH_SMALL_SECTORS * 0x2000) + ((sector - FLASH_SMALL_SECTORS) * 0x10000);
+}
+
+/* End address of a store sector */
+STATIC uint32_t sectorEnd(IAP_STORE_T *pStore, int s)
+{
+	return sectorBase(pStore, s) + (((pStore->firstSector + s) < FLASH_SMALL_SECTORS) ? 0x2000 : 0x10000);
+}
+
+/* Store sector holding a flash address, -1 if none */
+STATIC int addrSector(IAP_STORE_T *pStore, uint32_t addr)
+{
+	int s;
+
+	for (s = 0; s < pStore->numSectors; s++) {
+		if ((addr >= sectorBase(pStore, s)) && (addr < sectorEnd(pStore, s))) {
+			return s;
+		}
+	}
+	return -1;
+}
+
+/* Read a store byte, from the page buffer if it is not programmed yet */
+STATIC uint8_t readByte(IAP_STORE_T *pStore, uint32_t addr)
+{
+	if (pStore->bufAddr && (addr >= pStore->bufAddr) && (addr < pStore->bufAddr + IAP_STORE_PAGE_SIZE)) {
+		return ((uint8_t *) pStore->buf)[addr - pStore->bufAddr];
+	}
+	return *(volatile uint8_t *) addr;
+}
+
+/* Read a store word */
+STATIC uint32_t readWord(IAP_STORE_T *pStore, uint32_t addr)
+{
+	return readByte(pStore, addr) | (readByte(pStore, addr + 1) << 8) |
+		   (readByte(pStore, addr + 2) << 16) | ((uint32_t) readByte(pStore, addr + 3) << 24);
+}
+
+/* Erase a store sector */
+STATIC uint8_t eraseSector(IAP_STORE_T *pStore, int s)
+{
+	uint32_t primask, sector = pStore->firstSector + s;
+	uint8_t ret;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	ret = Chip_IAP_PreSectorForReadWrite(sector, sector, pStore->bank);
+	if (ret == IAP_CMD_SUCCESS) {
+		ret = Chip_IAP_EraseSector(sector, sector, pStore->bank);
+	}
+	__set_PRIMASK(primask);
+	pStore->erases++;
+
+	return ret;
+}
+
+/* Program the page buffer */
+STATIC uint8_t programPage(IAP_STORE_T *pStore)
+{
+	uint32_t primask, sector = pStore->firstSector + pStore->active;
+	uint8_t ret;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	ret = Chip_IAP_PreSectorForReadWrite(sector, sector, pStore->bank);
+	if (ret == IAP_CMD_SUCCESS) {
+		ret = Chip_IAP_CopyRamToFlash(pStore->bufAddr, pStore->buf, IAP_STORE_PAGE_SIZE);
+	}
+	__set_PRIMASK(primask);
+	pStore->bufAddr = 0;
+
+	return ret;
+}
+
+/* Append bytes to the active sector, programming pages as they fill */
+STATIC uint8_t appendBytes(IAP_STORE_T *pStore, const uint8_t *pData, uint32_t len)
+{
+	uint32_t off, n;
+	uint8_t ret;
+
+	while (len > 0) {
+		if (!pStore->bufAddr) {
+			pStore->bufAddr = pStore->wrAddr & ~(IAP_STORE_PAGE_SIZE - 1);
+			memset(pStore->buf, 0xFF, sizeof(pStore->buf));
+		}
+		off = pStore->wrAddr - pStore->bufAddr;
+		n = MIN(len, IAP_STORE_PAGE_SIZE - off);
+		memcpy((uint8_t *) pStore->buf + off, pData, n);
+		pStore->wrAddr += n;
+		pData += n;
+		len -= n;
+
+		if (off + n == IAP_STORE_PAGE_SIZE) {
+			ret = programPage(pStore);
+			if (ret != IAP_CMD_SUCCESS) {
+				return ret;
+			}
+		}
+	}
+
+	return IAP_CMD_SUCCESS;
+}
+
+/* Number of free sectors */
+STATIC int freeSectors(IAP_STORE_T *pStore)
+{
+	int s, count = 0;
+
+	for (s = 0; s < pStore->numSectors; s++) {
+		if ((pStore->sectorSeq[s] == 0) && (s != pStore->active)) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/* Start appending to a free sector, the next one after the active sector */
+STATIC uint8_t startSector(IAP_STORE_T *pStore)
+{
+	uint32_t hdr[STORE_SECTOR_HDR / 4];
+	uint8_t ret;
+	int i, s = -1;
+
+	for (i = 1; i <= pStore->numSectors; i++) {
+		s = (pStore->active + i + pStore->numSectors) % pStore->numSectors;
+		if ((pStore->sectorSeq[s] == 0) && (s != pStore->active)) {
+			break;
+		}
+		s = -1;
+	}
+	if (s < 0) {
+		return IAP_PARAM_ERROR;
+	}
+
+	/* Leave the old sector with its last page programmed */
+	if (pStore->bufAddr) {
+		ret = programPage(pStore);
+		if (ret != IAP_CMD_SUCCESS) {
+			return ret;
+		}
+	}
+
+	/* Free sectors may hold data that was never a valid store sector */
+	if (Chip_IAP_BlankCheckSector(pStore->firstSector + s, pStore->firstSector + s, pStore->bank) != IAP_CMD_SUCCESS) {
+		ret = eraseSector(pStore, s);
+		if (ret != IAP_CMD_SUCCESS) {
+			return ret;
+		}
+	}
+
+	pStore->sectorSeq[s] = ++pStore->seq;
+	pStore->active = s;
+	pStore->wrAddr = sectorBase(pStore, s);
+	hdr[0] = STORE_SECTOR_MAGIC;
+	hdr[1] = pStore->seq;
+	hdr[2] = ~pStore->seq;
+	hdr[3] = STORE_ERASED;
+
+	return appendBytes(pStore, (const uint8_t *) hdr, sizeof(hdr));
+}
+
+/* Make room for a record in the active sector */
+STATIC uint8_t ensureSpace(IAP_STORE_T *pStore, uint32_t bytes, bool forReclaim)
+{
+	int tries;
+
+	if ((pStore->active >= 0) && (pStore->wrAddr + bytes <= sectorEnd(pStore, pStore->active))) {
+		return IAP_CMD_SUCCESS;
+	}
+
+	/* Writes leave the last free sector to reclaiming, reclaim now if
+	   Chip_IAP_Store_Service() did not keep up */
+	for (tries = 0; !forReclaim && (freeSectors(pStore) <= 1) && (tries < pStore->numSectors); tries++) {
+		while (Chip_IAP_Store_Service(pStore) && (pStore->gcSector >= 0)) {}
+	}
+
+	return startSector(pStore);
+}
+
+/* Index the records of a sector, returns the end of its programmed area */
+STATIC uint32_t scanSector(IAP_STORE_T *pStore, int s)
+{
+	const uint32_t *pRec;
+	uint32_t addr = sectorBase(pStore, s) + STORE_SECTOR_HDR, end = sectorEnd(pStore, s), page, last;
+
+	while (addr + STORE_REC_HDR <= end) {
+		pRec = (const uint32_t *) addr;
+		if (((pRec[0] >> 16) == STORE_REC_MAGIC) && ((pRec[0] & 0xFFFF) < IAP_STORE_MAX_KEYS) &&
+			(pRec[1] <= end - addr - STORE_REC_HDR) &&
+			(pRec[2] == recordCRC(pRec, (const uint8_t *) &pRec[3], pRec[1]))) {
+			pStore->index[pRec[0] & 0xFFFF] = addr;
+			addr += STORE_REC_BYTES(pRec[1]);
+		}
+		else {
+			/* Padding after a commit, or a record cut short by a reset */
+			addr = STORE_PAGE_ALIGN(addr + 1);
+		}
+	}
+
+	/* Appending resumes after the last page that was programmed */
+	last = sectorBase(pStore, s) + IAP_STORE_PAGE_SIZE;
+	for (page = end - IAP_STORE_PAGE_SIZE; page >= last; page -= IAP_STORE_PAGE_SIZE) {
+		for (pRec = (const uint32_t *) page; (uint32_t) pRec < page + IAP_STORE_PAGE_SIZE; pRec++) {
+			if (*pRec != STORE_ERASED) {
+				return page + IAP_STORE_PAGE_SIZE;
+			}
+		}
+	}
+	return last;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Open a flash log structured store */
+void Chip_IAP_Store_Init(IAP_STORE_T *pStore, uint8_t bank, uint8_t firstSector, uint8_t numSectors)
+{
+	const uint32_t *pHdr;
+	uint32_t lastSeq = 0, next;
+	int s, pick;
+
+	memset(pStore, 0, sizeof(*pStore));
+	pStore->bank = bank;
+	pStore->firstSector = firstSector;
+	pStore->numSectors = MIN(numSectors, IAP_STORE_MAX_SECTORS);
+	pStore->active = -1;
+	pStore->gcSector = -1;
+
+	for (s = 0; s < pStore->numSectors; s++) {
+		pHdr = (const uint32_t *) sectorBase(pStore, s);
+		if ((pHdr[0] == STORE_SECTOR_MAGIC) && (pHdr[1] == ~pHdr[2]) && (pHdr[1] != 0)) {
+			pStore->sectorSeq[s] = pHdr[1];
+		}
+	}
+
+	/* Replay the sectors oldest first, later records replace earlier ones */
+	while (1) {
+		pick = -1;
+		next = 0;
+		for (s = 0; s < pStore->numSectors; s++) {
+			if ((pStore->sectorSeq[s] > lastSeq) && ((pick < 0) || (pStore->sectorSeq[s] < next))) {
+				pick = s;
+				next = pStore->sectorSeq[s];
+			}
+		}
+		if (pick < 0) {
+			break;
+		}
+		pStore->wrAddr = scanSector(pStore, pick);
+		pStore->active = pick;
+		lastSeq = next;
+	}
+	pStore->seq = lastSeq;
+}
+
+/* Read the latest record of a key */
+int Chip_IAP_Store_Read(IAP_STORE_T *pStore, uint16_t key, void *pData, int maxLen)
+{
+	uint8_t *pBytes = (uint8_t *) pData;
+	uint32_t addr;
+	int i, len;
+
+	if ((key >= IAP_STORE_MAX_KEYS) || !pStore->index[key]) {
+		return -1;
+	}
+
+	addr = pStore->index[key];
+	len = (int) readWord(pStore, addr + 4);
+	for (i = 0; (i < len) && (i < maxLen); i++) {
+		pBytes[i] = readByte(pStore, addr + STORE_REC_HDR + i);
+	}
+
+	return len;
+}
+
+/* Append a record for a key */
+uint8_t Chip_IAP_Store_Write(IAP_STORE_T *pStore, uint16_t key, const void *pData, int len)
+{
+	static const uint8_t pad[3] = {0, 0, 0};
+	const uint8_t *pBytes = (const uint8_t *) pData;
+	uint32_t hdr[STORE_REC_HDR / 4], addr, minSize = 0xFFFFFFFF;
+	uint8_t ret;
+	int i, s;
+
+	for (s = 0; s < pStore->numSectors; s++) {
+		minSize = MIN(minSize, sectorEnd(pStore, s) - sectorBase(pStore, s));
+	}
+	if ((key >= IAP_STORE_MAX_KEYS) || (len < 0) || (STORE_REC_BYTES(len) > minSize - STORE_SECTOR_HDR)) {
+		return IAP_PARAM_ERROR;
+	}
+
+	/* Unchanged values cost nothing */
+	addr = pStore->index[key];
+	if (addr && (readWord(pStore, addr + 4) == (uint32_t) len)) {
+		for (i = 0; (i < len) && (readByte(pStore, addr + STORE_REC_HDR + i) == pBytes[i]); i++) {}
+		if (i == len) {
+			return IAP_CMD_SUCCESS;
+		}
+	}
+
+	ret = ensureSpace(pStore, STORE_REC_BYTES(len), false);
+	if (ret != IAP_CMD_SUCCESS) {
+		return ret;
+	}
+
+	hdr[0] = (STORE_REC_MAGIC << 16) | key;
+	hdr[1] = len;
+	hdr[2] = recordCRC(hdr, pBytes, len);
+	addr = pStore->wrAddr;
+	ret = appendBytes(pStore, (const uint8_t *) hdr, sizeof(hdr));
+	if (ret == IAP_CMD_SUCCESS) {
+		ret = appendBytes(pStore, pBytes, len);
+	}
+	if (ret == IAP_CMD_SUCCESS) {
+		ret = appendBytes(pStore, pad, STORE_REC_BYTES(len) - STORE_REC_HDR - len);
+	}
+	if (ret == IAP_CMD_SUCCESS) {
+		pStore->index[key] = addr;
+	}
+
+	return ret;
+}
+
+/* Program the partly filled page of a store */
+uint8_t Chip_IAP_Store_Commit(IAP_STORE_T *pStore)
+{
+	if (!pStore->bufAddr) {
+		return IAP_CMD_SUCCESS;
+	}
+
+	/* The rest of the page can not be programmed again */
+	pStore->wrAddr = STORE_PAGE_ALIGN(pStore->wrAddr);
+	return programPage(pStore);
+}
+
+/* Do one step of sector reclaiming */
+bool Chip_IAP_Store_Service(IAP_STORE_T *pStore)
+{
+	uint8_t chunk[32];
+	uint32_t src, bytes, n, addr;
+	int s, key;
+
+	if (pStore->gcSector < 0) {
+		if (freeSectors(pStore) > 1) {
+			return false;
+		}
+
+		/* Reclaim the oldest sector */
+		for (s = 0; s < pStore->numSectors; s++) {
+			if ((pStore->sectorSeq[s] != 0) && (s != pStore->active) &&
+				((pStore->gcSector < 0) || (pStore->sectorSeq[s] < pStore->sectorSeq[pStore->gcSector]))) {
+				pStore->gcSector = s;
+			}
+		}
+		if (pStore->gcSector < 0) {
+			return false;
+		}
+	}
+
+	/* Move one current record out of the sector */
+	for (key = 0; key < IAP_STORE_MAX_KEYS; key++) {
+		src = pStore->index[key];
+		if (src && (addrSector(pStore, src) == pStore->gcSector)) {
+			bytes = STORE_REC_BYTES(((const uint32_t *) src)[1]);
+			if (ensureSpace(pStore, bytes, true) != IAP_CMD_SUCCESS) {
+				pStore->gcSector = -1;
+				return false;
+			}
+			addr = pStore->wrAddr;
+			while (bytes > 0) {
+				n = MIN(bytes, sizeof(chunk));
+				memcpy(chunk, (const void *) src, n);
+				if (appendBytes(pStore, chunk, n) != IAP_CMD_SUCCESS) {
+					pStore->gcSector = -1;
+					return false;
+				}
+				src += n;
+				bytes -= n;
+			}
+			pStore->index[key] = addr;
+			return true;
+		}
+	}
+
+	/* The copies must survive a reset before the originals go */
+	if (Chip_IAP_Store_Commit(pStore) == IAP_CMD_SUCCESS) {
+		if (eraseSector(pStore, pStore->gcSector) == IAP_CMD_SUCCESS) {
+			pStore->sectorSeq[pStore->gcSector] = 0;
+		}
+	}
+	pStore->gcSector = -1;
+
+	return true;
+}
@@ -0,0 +1,146 @@
+/*
+ * @brief LPC18xx/43xx Flash log structured store
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __IAP_STORE_18XX_43XX_H_
+#define __IAP_STORE_18XX_43XX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup IAP_STORE_18XX_43XX CHIP: LPC18xx/43xx Flash log structured store
+ * @ingroup IAP_18XX_43XX
+ * Key/value records too large for the EEPROM, appended to a log in
+ * reserved internal flash sectors through IAP. A write only programs
+ * erased 512 byte flash pages, so no sector erase is needed until a
+ * sector has to be reclaimed. Chip_IAP_Store_Service() does that in small
+ * steps when the caller has time: it copies the current records out of
+ * the oldest sector, commits them and then erases the sector. Every
+ * record carries a CRC, so a record cut short by a reset is ignored and
+ * its key reads back the previous value. A RAM index built at init gives
+ * the latest record of a key without searching.
+ * @{
+ */
+
+/** Number of keys in a store, keys are 0 to IAP_STORE_MAX_KEYS - 1 */
+#define IAP_STORE_MAX_KEYS          64
+
+/** Maximum number of flash sectors in a store */
+#define IAP_STORE_MAX_SECTORS       8
+
+/** Flash program unit, the smallest Chip_IAP_CopyRamToFlash() size */
+#define IAP_STORE_PAGE_SIZE         512
+
+/**
+ * @brief Flash log structured store
+ */
+typedef struct {
+	uint8_t bank;								/*!< Flash bank, IAP_FLASH_BANK_A or IAP_FLASH_BANK_B */
+	uint8_t firstSector;						/*!< First flash sector of the store */
+	uint8_t numSectors;							/*!< Number of sectors, at least 2 */
+	int8_t active;								/*!< Sector being appended, -1 if none yet */
+	uint32_t seq;								/*!< Sequence number of the newest sector */
+	uint32_t sectorSeq[IAP_STORE_MAX_SECTORS];	/*!< Sequence number per sector, 0 if free */
+	uint32_t wrAddr;							/*!< Next free flash address in the active sector */
+	uint32_t bufAddr;							/*!< Flash address of the page in buf, 0 if none */
+	uint32_t buf[IAP_STORE_PAGE_SIZE / 4];		/*!< Page being filled */
+	uint32_t index[IAP_STORE_MAX_KEYS];			/*!< Latest record per key, 0 if none */
+	int8_t gcSector;							/*!< Sector being reclaimed, -1 if none */
+	uint32_t erases;							/*!< Sector erases done */
+} IAP_STORE_T;
+
+/**
+ * @brief	Open a flash log structured store
+ * @param	pStore		: Pointer to the store structure to initialize
+ * @param	bank		: Flash bank of the sectors
+ * @param	firstSector	: First flash sector used by the store
+ * @param	numSectors	: Number of flash sectors used, 2 to IAP_STORE_MAX_SECTORS
+ * @return	Nothing
+ * @note	The sectors must not hold code or other data. Sectors without a
+ * valid store header are taken as free and erased when first used.
+ */
+void Chip_IAP_Store_Init(IAP_STORE_T *pStore, uint8_t bank, uint8_t firstSector, uint8_t numSectors);
+
+/**
+ * @brief	Read the latest record of a key
+ * @param	pStore	: Pointer to the store structure
+ * @param	key		: Key to read
+ * @param	pData	: Buffer to read the record data to
+ * @param	maxLen	: Size of @a pData, longer records are truncated
+ * @return	Length of the record data, or -1 if the key was never written
+ */
+int Chip_IAP_Store_Read(IAP_STORE_T *pStore, uint16_t key, void *pData, int maxLen);
+
+/**
+ * @brief	Append a record for a key
+ * @param	pStore	: Pointer to the store structure
+ * @param	key		: Key to write
+ * @param	pData	: Record data
+ * @param	len		: Length of the record data, less than the smallest sector
+ * @return	IAP_CMD_SUCCESS, IAP_PARAM_ERROR if the record is too large or the
+ * current records of all keys do not fit, or an IAP error code
+ * @note	A record equal to the latest one for the key is not written
+ * again. Full pages are programmed as they fill, the last partial page
+ * stays in RAM until Chip_IAP_Store_Commit(). A sector erase is only done
+ * here if Chip_IAP_Store_Service() was not called often enough to keep a
+ * sector free. Interrupts are disabled during each IAP call.
+ */
+uint8_t Chip_IAP_Store_Write(IAP_STORE_T *pStore, uint16_t key, const void *pData, int len);
+
+/**
+ * @brief	Program the partly filled page of a store
+ * @param	pStore	: Pointer to the store structure
+ * @return	IAP_CMD_SUCCESS or an IAP error code
+ * @note	All records written before the call survive a reset once it
+ * returns. The rest of the page is left unused, so commit batches of
+ * records rather than every record.
+ */
+uint8_t Chip_IAP_Store_Commit(IAP_STORE_T *pStore);
+
+/**
+ * @brief	Do one step of sector reclaiming
+ * @param	pStore	: Pointer to the store structure
+ * @return	true if a step was done, false if no sector needs reclaiming
+ * @note	Call from the idle loop until it returns false. A step copies
+ * one record or erases one sector; only the erase step takes long
+ * (hundreds of milliseconds for a 64KB sector).
+ */
+bool Chip_IAP_Store_Service(IAP_STORE_T *pStore);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IAP_STORE_18XX_43XX_H_ */
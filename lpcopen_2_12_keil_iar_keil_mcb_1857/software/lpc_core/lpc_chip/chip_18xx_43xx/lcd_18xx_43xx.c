@@ -37,6 +37,9 @@
 
 static LCD_CURSOR_SIZE_OPT_T LCD_Cursor_Size = LCD_CURSOR_64x64;
 
+/* Bits each pixel takes in the frame buffer, by LCD_BPP_OPT_T */
+static const uint8_t lcdStoreBits[8] = {1, 2, 4, 8, 16, 32, 16, 16};
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -45,6 +48,44 @@ static LCD_CURSOR_SIZE_OPT_T LCD_Cursor_Size = LCD_CURSOR_64x64;
  * Private functions
  ****************************************************************************/
 
+/* Update the frame buffer state from the buffer the controller is scanning.
+   Returns the index of a queued buffer that is now shown, or -1 */
+static int fbUpdate(LCD_FB_T *pFb)
+{
+	uint32_t curr = pFb->pLCD->UPCURR;
+	uint8_t i;
+
+	for (i = 0; i < pFb->numBuffers; i++) {
+		uint32_t base = (uint32_t) pFb->pBuffers[i];
+
+		if ((curr >= base) && (curr <= (base + pFb->size))) {
+			pFb->front = i;
+			if (i == pFb->queued) {
+				pFb->queued = LCD_FB_NONE;
+				pFb->flips++;
+				return i;
+			}
+			break;
+		}
+	}
+
+	return -1;
+}
+
+/* Panel clocks per frame, from the timing registers */
+static uint32_t lcdFrameClocks(LPC_LCD_T *pLCD)
+{
+	uint32_t timh = pLCD->TIMH, timv = pLCD->TIMV;
+	uint32_t line, lines;
+
+	line = ((((timh >> 2) & 0x3F) + 1) * 16) + (((timh >> 8) & 0xFF) + 1)
+		   + (((timh >> 16) & 0xFF) + 1) + (((timh >> 24) & 0xFF) + 1);
+	lines = ((timv & 0x3FF) + 1) + (((timv >> 10) & 0x3F) + 1)
+			+ (((timv >> 16) & 0xFF) + 1) + (((timv >> 24) & 0xFF) + 1);
+
+	return line * lines;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -136,6 +177,33 @@ void Chip_LCD_DeInit(LPC_LCD_T *pLCD)
 	Chip_Clock_Disable(CLK_MX_LCD);
 }
 
+/* Get the frame buffer size for the panel timing set up */
+uint32_t Chip_LCD_GetFrameBufferSize(LPC_LCD_T *pLCD, LCD_BPP_OPT_T bpp)
+{
+	uint32_t ppl = (((pLCD->TIMH >> 2) & 0x3F) + 1) * 16;
+	uint32_t lpp = (pLCD->TIMV & 0x3FF) + 1;
+
+	if (pLCD->CTRL & (1 << 7)) {
+		lpp *= 2;	/* Dual panel */
+	}
+
+	return (ppl * lpp * lcdStoreBits[bpp & 0x7]) / 8;
+}
+
+/* Estimate the memory bandwidth the LCD DMA uses */
+uint32_t Chip_LCD_GetDMABandwidth(LPC_LCD_T *pLCD, LCD_BPP_OPT_T bpp)
+{
+	uint32_t pol = pLCD->POL;
+	uint32_t pclk = Chip_Clock_GetRate(CLK_MX_LCD);
+
+	/* Panel clock divider, bypassed or PCD + 2 */
+	if ((pol & (1 << 26)) == 0) {
+		pclk /= ((pol & 0x1F) | (((pol >> 27) & 0x1F) << 5)) + 2;
+	}
+
+	return (uint32_t) (((uint64_t) Chip_LCD_GetFrameBufferSize(pLCD, bpp) * pclk) / lcdFrameClocks(pLCD));
+}
+
 /* Configure Cursor */
 void Chip_LCD_Cursor_Config(LPC_LCD_T *pLCD, LCD_CURSOR_SIZE_OPT_T cursor_size, bool sync)
 {
@@ -158,7 +226,7 @@ void Chip_LCD_Cursor_WriteImage(LPC_LCD_T *pLCD, uint8_t cursor_num, void *Image
 		i = 0;
 		j = 256;
 	}
-	fifoptr = (void *) &(pLCD->CRSR_IMG[0]);
+	fifoptr = (void *) &(pLCD->CRSR_IMG[i]);
 
 	/* Copy Cursor Image content to FIFO */
 	for (; i < j; i++) {
@@ -169,6 +237,23 @@ void Chip_LCD_Cursor_WriteImage(LPC_LCD_T *pLCD, uint8_t cursor_num, void *Image
 	}
 }
 
+/* Move the cursor, also partly off the left or top edge */
+void Chip_LCD_Cursor_Move(LPC_LCD_T *pLCD, int32_t x, int32_t y)
+{
+	uint16_t clipx = 0, clipy = 0;
+
+	if (x < 0) {
+		clipx = (uint16_t) MIN(-x, 63);
+		x = 0;
+	}
+	if (y < 0) {
+		clipy = (uint16_t) MIN(-y, 63);
+		y = 0;
+	}
+	Chip_LCD_Cursor_SetClip(pLCD, clipx, clipy);
+	Chip_LCD_Cursor_SetPos(pLCD, (uint16_t) x, (uint16_t) y);
+}
+
 /* Load LCD Palette */
 void Chip_LCD_LoadPalette(LPC_LCD_T *pLCD, void *palette)
 {
@@ -200,7 +285,131 @@ void Chip_LCD_LoadPalette(LPC_LCD_T *pLCD, void *palette)
 		pal_entry.Ru = (*pal_ptr++) >> 3;	/* get red */
 		pal_ptr++;	/* skip over the unused byte */
 
-		pLCD->PAL[i] = *((uint32_t *)&pal_entry);
+		((__IO uint32_t *) pLCD->PAL)[i] = *((uint32_t *)&pal_entry);
 	}
 }
 
+/* Set palette entries for the 1, 2, 4 and 8 bpp modes */
+void Chip_LCD_SetPalette(LPC_LCD_T *pLCD, uint16_t first, const uint32_t *pRGB, uint16_t num)
+{
+	__IO uint32_t *pPal = (__IO uint32_t *) pLCD->PAL;
+	uint32_t rgb, entry, shift;
+
+	/* Two entries per palette word, written as words */
+	while ((num > 0) && (first < 256)) {
+		rgb = *pRGB++;
+		entry = ((rgb >> 19) & 0x1F) | (((rgb >> 11) & 0x1F) << 5) | (((rgb >> 3) & 0x1F) << 10)
+				| (((rgb >> 10) & 1) << 15);
+		shift = (first & 1) * 16;
+		pPal[first / 2] = (pPal[first / 2] & ~(0xFFFF << shift)) | (entry << shift);
+		first++;
+		num--;
+	}
+}
+
+/* Initialize the frame buffer manager and show the first buffer */
+void Chip_LCD_FB_Init(LPC_LCD_T *pLCD, LCD_FB_T *pFb, void *const *pBuffers, uint8_t numBuffers, uint32_t size)
+{
+	uint8_t i;
+
+	if (numBuffers > LCD_FB_MAX_BUFFERS) {
+		numBuffers = LCD_FB_MAX_BUFFERS;
+	}
+
+	pFb->pLCD = pLCD;
+	for (i = 0; i < numBuffers; i++) {
+		pFb->pBuffers[i] = pBuffers[i];
+	}
+	pFb->size = size;
+	pFb->numBuffers = numBuffers;
+	pFb->front = 0;
+	pFb->queued = LCD_FB_NONE;
+	pFb->back = LCD_FB_NONE;
+	pFb->flips = 0;
+
+	pLCD->INTMSK &= ~LCD_INTMSK_LNBUIM;
+	pLCD->INTCLR = LCD_INTMSK_LNBUIM;
+	Chip_LCD_SetUPFrameBuffer(pLCD, pBuffers[0]);
+}
+
+/* Get a back buffer to draw into */
+void *Chip_LCD_FB_GetBackBuffer(LCD_FB_T *pFb)
+{
+	uint8_t i;
+
+	if (pFb->back == LCD_FB_NONE) {
+		for (i = 0; i < pFb->numBuffers; i++) {
+			if ((i != pFb->front) && (i != pFb->queued)) {
+				pFb->back = i;
+				break;
+			}
+		}
+
+		if (pFb->back == LCD_FB_NONE) {
+			return NULL;
+		}
+	}
+
+	return pFb->pBuffers[pFb->back];
+}
+
+/* Wait for a free back buffer to draw into */
+void *Chip_LCD_FB_WaitBackBuffer(LCD_FB_T *pFb)
+{
+	void *pBuffer;
+
+	while ((pBuffer = Chip_LCD_FB_GetBackBuffer(pFb)) == NULL) {}
+
+	return pBuffer;
+}
+
+/* Queue a frame buffer to be shown from the start of the next frame */
+void Chip_LCD_FB_Queue(LCD_FB_T *pFb, uint8_t index)
+{
+	LPC_LCD_T *pLCD = pFb->pLCD;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* Catch up with a frame that started since the last interrupt, so a
+	   dropped buffer really is no longer scanned. If the controller loads the
+	   old base address after this point, the pending interrupt moves the
+	   front buffer to it before the caller can draw again. */
+	pLCD->INTCLR = LCD_INTMSK_LNBUIM;
+	fbUpdate(pFb);
+
+	pFb->queued = index;
+	Chip_LCD_SetUPFrameBuffer(pLCD, pFb->pBuffers[index]);
+	pLCD->INTMSK |= LCD_INTMSK_LNBUIM;
+
+	__set_PRIMASK(primask);
+}
+
+/* Queue the back buffer to be shown from the start of the next frame */
+void Chip_LCD_FB_Flip(LCD_FB_T *pFb)
+{
+	if (pFb->back != LCD_FB_NONE) {
+		Chip_LCD_FB_Queue(pFb, pFb->back);
+		pFb->back = LCD_FB_NONE;
+	}
+}
+
+/* Frame buffer manager interrupt handler */
+int Chip_LCD_FB_IRQHandler(LCD_FB_T *pFb)
+{
+	LPC_LCD_T *pLCD = pFb->pLCD;
+	int shown = -1;
+
+	if (pLCD->INTSTAT & LCD_INTMSK_LNBUIM) {
+		pLCD->INTCLR = LCD_INTMSK_LNBUIM;
+		shown = fbUpdate(pFb);
+
+		/* Nothing left to wait for, stop the per frame interrupt */
+		if (pFb->queued == LCD_FB_NONE) {
+			pLCD->INTMSK &= ~LCD_INTMSK_LNBUIM;
+		}
+	}
+
+	return shown;
+}
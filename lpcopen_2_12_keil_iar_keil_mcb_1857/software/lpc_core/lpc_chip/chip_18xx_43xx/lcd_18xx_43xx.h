@@ -107,6 +107,23 @@ typedef enum {
 	LCD_COLOR_FORMAT_BGR
 } LCD_COLOR_FORMAT_OPT_T;
 
+/**
+ * @brief LCD frame buffer bits per pixel, the LCD_CTRL LcdBpp field
+ * The 1, 2, 4 and 8 bpp modes look the colors up in the palette
+ * (Chip_LCD_SetPalette()). 24 bpp pixels are stored in 32 bits and 12 bpp
+ * pixels in 16 bits.
+ */
+typedef enum {
+	LCD_BPP1 = 0,		/*!< 1 bpp, palette */
+	LCD_BPP2,			/*!< 2 bpp, palette */
+	LCD_BPP4,			/*!< 4 bpp, palette */
+	LCD_BPP8,			/*!< 8 bpp, palette */
+	LCD_BPP16,			/*!< 16 bpp, 1:5:5:5 */
+	LCD_BPP24,			/*!< 24 bpp, TFT only */
+	LCD_BPP16_565,		/*!< 16 bpp, 5:6:5 */
+	LCD_BPP12_444		/*!< 12 bpp, 4:4:4 */
+} LCD_BPP_OPT_T;
+
 /** LCD Interrupt control mask register bits */
 #define LCD_INTMSK_FUFIM   0x2	/*!< FIFO underflow interrupt enable */
 #define LCD_INTMSK_LNBUIM  0x4	/*!< LCD next base address update interrupt enable */
@@ -133,7 +150,7 @@ typedef struct {
 	uint8_t  IHS;	/*!< Invert HSYNC, 1 = invert */
 	uint8_t  IVS;	/*!< Invert VSYNC, 1 = invert */
 	uint8_t  ACB;	/*!< AC bias frequency in clocks (not used) */
-	uint8_t  BPP;	/*!< Maximum bits per pixel the display supports */
+	uint8_t  BPP;	/*!< Frame buffer bits per pixel, an LCD_BPP_OPT_T value */
 	LCD_PANEL_OPT_T  LCD;	/*!< LCD panel type */
 	LCD_COLOR_FORMAT_OPT_T  color_format;	/*!<BGR or RGB */
 	uint8_t  Dual;	/*!< Dual panel, 1 = dual panel display */
@@ -147,6 +164,30 @@ typedef enum {
 	LCD_CURSOR_64x64
 } LCD_CURSOR_SIZE_OPT_T;
 
+/** Maximum number of frame buffers handled by the frame buffer manager */
+#define LCD_FB_MAX_BUFFERS  3
+
+/** No frame buffer, see LCD_FB_T */
+#define LCD_FB_NONE         0xFF
+
+/**
+ * @brief LCD frame buffer manager state
+ * The manager page flips between 2 or 3 frame buffers. A buffer queued with
+ * Chip_LCD_FB_Flip() or Chip_LCD_FB_Queue() is only loaded by the controller
+ * at the start of the next frame, so the buffer being scanned out is never
+ * handed out for drawing.
+ */
+typedef struct {
+	LPC_LCD_T *pLCD;							/*!< LCD controller scanning the buffers */
+	void *pBuffers[LCD_FB_MAX_BUFFERS];			/*!< Frame buffer addresses */
+	uint32_t size;								/*!< Size of each frame buffer in bytes */
+	uint8_t numBuffers;							/*!< Number of frame buffers, 2 or 3 */
+	volatile uint8_t front;						/*!< Buffer being scanned out */
+	volatile uint8_t queued;					/*!< Buffer waiting for the next frame, or LCD_FB_NONE */
+	uint8_t back;								/*!< Buffer handed out for drawing, or LCD_FB_NONE */
+	volatile uint32_t flips;					/*!< Number of queued buffers that were shown */
+} LCD_FB_T;
+
 /**
  * @brief	Initialize the LCD controller
  * @param	pLCD				: The base of LCD peripheral on the chip
@@ -231,6 +272,50 @@ STATIC INLINE void Chip_LCD_SetLPFrameBuffer(LPC_LCD_T *pLCD, void *buffer)
 	pLCD->LPBASE = (uint32_t) buffer;
 }
 
+/**
+ * @brief	Set the frame buffer bits per pixel
+ * @param	pLCD	: The base of LCD peripheral on the chip
+ * @param	bpp		: Bits per pixel
+ * @return	None
+ * @note	Change the mode with the controller disabled or from the vertical
+ *			compare interrupt, together with the frame buffer address.
+ */
+STATIC INLINE void Chip_LCD_SetBPP(LPC_LCD_T *pLCD, LCD_BPP_OPT_T bpp)
+{
+	pLCD->CTRL = (pLCD->CTRL & ~(0x7 << 1)) | ((uint32_t) bpp << 1);
+}
+
+/**
+ * @brief	Get the frame buffer bits per pixel
+ * @param	pLCD	: The base of LCD peripheral on the chip
+ * @return	Bits per pixel mode
+ */
+STATIC INLINE LCD_BPP_OPT_T Chip_LCD_GetBPP(LPC_LCD_T *pLCD)
+{
+	return (LCD_BPP_OPT_T) ((pLCD->CTRL >> 1) & 0x7);
+}
+
+/**
+ * @brief	Get the frame buffer size for the panel timing set up
+ * @param	pLCD	: The base of LCD peripheral on the chip
+ * @param	bpp		: Bits per pixel mode the size is for
+ * @return	Bytes per frame, both panels of a dual panel display
+ */
+uint32_t Chip_LCD_GetFrameBufferSize(LPC_LCD_T *pLCD, LCD_BPP_OPT_T bpp);
+
+/**
+ * @brief	Estimate the memory bandwidth the LCD DMA uses
+ * @param	pLCD	: The base of LCD peripheral on the chip
+ * @param	bpp		: Bits per pixel mode the estimate is for
+ * @return	Bytes per second read from the frame buffer
+ * @note	Uses the timing and panel clock divider programmed by
+ *			Chip_LCD_Init() for a TFT panel and the LCD branch clock rate, so
+ *			modes can be compared before switching. The cursor image is
+ *			internal and adds nothing. 8 bpp halves the 16 bpp load and 4 bpp
+ *			quarters it.
+ */
+uint32_t Chip_LCD_GetDMABandwidth(LPC_LCD_T *pLCD, LCD_BPP_OPT_T bpp);
+
 /**
  * @brief	Configure Cursor
  * @param	pLCD		: The base of LCD peripheral on the chip
@@ -310,6 +395,18 @@ STATIC INLINE void Chip_LCD_Cursor_SetPos(LPC_LCD_T *pLCD, uint16_t x, uint16_t
 	pLCD->CRSR_XY = (x & 0x3FF) | ((y & 0x3FF) << 16);
 }
 
+/**
+ * @brief	Move the cursor, also partly off the left or top edge
+ * @param	pLCD	: The base of LCD peripheral on the chip
+ * @param	x		: Horizontal position of the left of the cursor image, may be negative
+ * @param	y		: Vertical position of the top of the cursor image, may be negative
+ * @return	None
+ * @note	The part of the image left of or above the panel is clipped with
+ *			the cursor clip register. Subtract the hotspot of a pointer image
+ *			from the pointer position.
+ */
+void Chip_LCD_Cursor_Move(LPC_LCD_T *pLCD, int32_t x, int32_t y);
+
 /**
  * @brief	Set Cursor Clipping Position
  * @param	pLCD	: The base of LCD peripheral on the chip
@@ -358,12 +455,74 @@ STATIC INLINE void Chip_LCD_ClearInts(LPC_LCD_T *pLCD, uint32_t ints)
 /**
  * @brief	Write Cursor Image into Internal Cursor Image Buffer
  * @param	pLCD		: The base of LCD peripheral on the chip
- * @param	cursor_num	: Cursor index
- * @param	Image		: Pointer to image data
+ * @param	cursor_num	: Cursor index, 0..3 for 32x32 cursors
+ * @param	Image		: Pointer to image data, 256 bytes for a 32x32 and 1KB for a 64x64 cursor
  * @return	None
+ * @note	The image has 2 bits per pixel: 0 and 1 select cursor palette 0
+ *			and 1, 2 is transparent and 3 inverts the frame buffer pixel.
+ *			Each 32-bit word holds 16 pixels, the leftmost in bits 31:30.
  */
 void Chip_LCD_Cursor_WriteImage(LPC_LCD_T *pLCD, uint8_t cursor_num, void *Image);
 
+/**
+ * @brief	Initialize the frame buffer manager and show the first buffer
+ * @param	pLCD		: The base of LCD peripheral on the chip
+ * @param	pFb			: Frame buffer manager state to initialize
+ * @param	pBuffers	: Addresses of the frame buffers
+ * @param	numBuffers	: Number of frame buffers, 2 (double) or 3 (triple buffering)
+ * @param	size		: Size of each frame buffer in bytes
+ * @return	None
+ * @note	Chip_LCD_FB_IRQHandler() must be called from the LCD interrupt,
+ * which the application enables in the NVIC. The manager uses the LCD next
+ * base address update interrupt only while a flip is pending.
+ */
+void Chip_LCD_FB_Init(LPC_LCD_T *pLCD, LCD_FB_T *pFb, void *const *pBuffers, uint8_t numBuffers, uint32_t size);
+
+/**
+ * @brief	Get a back buffer to draw into
+ * @param	pFb	: Frame buffer manager state
+ * @return	Address of the back buffer, or NULL if all buffers are still shown or
+ *			waiting to be shown
+ * @note	The same buffer is returned until it is passed to Chip_LCD_FB_Flip().
+ */
+void *Chip_LCD_FB_GetBackBuffer(LCD_FB_T *pFb);
+
+/**
+ * @brief	Wait for a free back buffer to draw into
+ * @param	pFb	: Frame buffer manager state
+ * @return	Address of the back buffer
+ * @note	With double buffering this waits for the previous flip to complete
+ * at the start of a frame. With triple buffering a buffer is free right away.
+ */
+void *Chip_LCD_FB_WaitBackBuffer(LCD_FB_T *pFb);
+
+/**
+ * @brief	Queue a frame buffer to be shown from the start of the next frame
+ * @param	pFb		: Frame buffer manager state
+ * @param	index	: Index of the buffer to show
+ * @return	None
+ * @note	A buffer queued earlier that has not been shown yet is dropped and
+ * becomes free again. Use this function when the caller, such as emWin
+ * multiple buffering, selects the buffers itself.
+ */
+void Chip_LCD_FB_Queue(LCD_FB_T *pFb, uint8_t index);
+
+/**
+ * @brief	Queue the back buffer to be shown from the start of the next frame
+ * @param	pFb	: Frame buffer manager state
+ * @return	None
+ */
+void Chip_LCD_FB_Flip(LCD_FB_T *pFb);
+
+/**
+ * @brief	Frame buffer manager interrupt handler
+ * @param	pFb	: Frame buffer manager state
+ * @return	Index of the buffer that was queued and is now shown, or -1 if no
+ *			queued buffer was loaded by the controller
+ * @note	Call this function from LCD_IRQHandler().
+ */
+int Chip_LCD_FB_IRQHandler(LCD_FB_T *pFb);
+
 /**
  * @brief	Load LCD Palette
  * @param	pLCD	: The base of LCD peripheral on the chip
@@ -372,6 +531,18 @@ void Chip_LCD_Cursor_WriteImage(LPC_LCD_T *pLCD, uint8_t cursor_num, void *Image
  */
 void Chip_LCD_LoadPalette(LPC_LCD_T *pLCD, void *palette);
 
+/**
+ * @brief	Set palette entries for the 1, 2, 4 and 8 bpp modes
+ * @param	pLCD	: The base of LCD peripheral on the chip
+ * @param	first	: First palette entry to set
+ * @param	pRGB	: Colors as 0x00RRGGBB
+ * @param	num		: Number of entries to set, first + num must be at most 256
+ * @return	None
+ * @note	Entries hold 5 bits per color; the intensity bit carries the
+ *			next green bit. A 4 bpp frame buffer only uses entries 0..15.
+ */
+void Chip_LCD_SetPalette(LPC_LCD_T *pLCD, uint16_t first, const uint32_t *pRGB, uint16_t num);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,184 @@
+/*
+ * @brief LPC18xx/43xx Motor Control PWM driver
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Shadow transfer hold of all channels */
+#define MCPWM_DISUP_ALL     (MCPWM_CON_DISUP(0) | MCPWM_CON_DISUP(1) | MCPWM_CON_DISUP(2))
+
+/* Timers of all channels */
+#define MCPWM_RUN_ALL       (MCPWM_CON_RUN(0) | MCPWM_CON_RUN(1) | MCPWM_CON_RUN(2))
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize the MCPWM, all timers stopped */
+void Chip_MCPWM_Init(LPC_MCPWM_T *pMCPWM)
+{
+	int i;
+
+	Chip_Clock_Enable(CLK_APB1_MOTOCON);
+	Chip_RGU_TriggerReset(RGU_MOTOCONPWM_RST);
+	while (Chip_RGU_InReset(RGU_MOTOCONPWM_RST)) {}
+
+	pMCPWM->CON_CLR = 0xFFFFFFFF;
+	pMCPWM->INTEN_CLR = 0xFFFFFFFF;
+	pMCPWM->INTF_CLR = 0xFFFFFFFF;
+	for (i = 0; i < 3; i++) {
+		pMCPWM->TC[i] = 0;
+	}
+}
+
+/* Shut down the MCPWM */
+void Chip_MCPWM_DeInit(LPC_MCPWM_T *pMCPWM)
+{
+	pMCPWM->CON_CLR = 0xFFFFFFFF;
+	pMCPWM->INTEN_CLR = 0xFFFFFFFF;
+	Chip_Clock_Disable(CLK_APB1_MOTOCON);
+}
+
+/* Set up a synchronized multi phase drive */
+Status Chip_MCPWM_DriveInit(MCPWM_DRIVE_T *pDrive, LPC_MCPWM_T *pMCPWM, const MCPWM_DRIVE_CFG_T *pCfg)
+{
+	uint32_t rate = Chip_Clock_GetRate(CLK_APB1_MOTOCON);
+	uint32_t period, dt, con, i;
+
+	if ((pCfg->freqHz == 0) || ((pCfg->adcTrig != MCPWM_ADCTRIG_NONE) && !pCfg->centre)) {
+		return ERROR;
+	}
+
+	/* The centre aligned timer counts up to LIM and back, so a period is
+	   2 * LIM clocks; the active time is LIM - MAT (twice that centred) */
+	period = pCfg->centre ? (rate / (2 * pCfg->freqHz)) : ((rate / pCfg->freqHz) - 1);
+	dt = (uint32_t) (((uint64_t) pCfg->deadTimeNs * rate + 999999999) / 1000000000);
+	if ((period < 2) || (dt > MCPWM_DT_MAX) ||
+		((pCfg->adcTrig != MCPWM_ADCTRIG_NONE) && ((pCfg->trigLead == 0) || (pCfg->trigLead >= period)))) {
+		return ERROR;
+	}
+
+	pDrive->pMCPWM = pMCPWM;
+	pDrive->period = period;
+	pDrive->phases = (pCfg->adcTrig == MCPWM_ADCTRIG_NONE) ? 3 : 2;
+	pDrive->trigEdge = (pCfg->adcTrig == MCPWM_ADCTRIG_VALLEY) ? ADC_TRIGGERMODE_FALLING : ADC_TRIGGERMODE_RISING;
+
+	pMCPWM->CON_CLR = 0xFFFFFFFF;
+	pMCPWM->CCP = 0;
+	pMCPWM->DT = dt | (dt << 10) | (dt << 20);
+
+	con = MCPWM_CON_ACMODE;
+	for (i = 0; i < 3; i++) {
+		pMCPWM->TC[i] = 0;
+		pMCPWM->LIM[i] = period;
+		pMCPWM->MAT[i] = period;
+		if (pCfg->centre) {
+			con |= MCPWM_CON_CENTER(i);
+		}
+		if (i < pDrive->phases) {
+			if (pCfg->activeLow) {
+				con |= MCPWM_CON_POLA(i);
+			}
+			if (dt != 0) {
+				con |= MCPWM_CON_DTE(i);
+			}
+		}
+	}
+
+	/* MCOA2 goes active trigLead before the top of the count and passive
+	   trigLead before the bottom, the ADC starts on that edge */
+	if (pCfg->adcTrig == MCPWM_ADCTRIG_PEAK) {
+		pMCPWM->MAT[2] = period - pCfg->trigLead;
+	}
+	else if (pCfg->adcTrig == MCPWM_ADCTRIG_VALLEY) {
+		pMCPWM->MAT[2] = pCfg->trigLead;
+	}
+	pMCPWM->CON_SET = con;
+
+	return SUCCESS;
+}
+
+/* Start a drive, all channels in the same clock */
+void Chip_MCPWM_DriveStart(MCPWM_DRIVE_T *pDrive)
+{
+	pDrive->pMCPWM->CON_SET = MCPWM_RUN_ALL;
+}
+
+/* Stop a drive, outputs passive */
+void Chip_MCPWM_DriveStop(MCPWM_DRIVE_T *pDrive)
+{
+	LPC_MCPWM_T *pMCPWM = pDrive->pMCPWM;
+	int i;
+
+	pMCPWM->CON_CLR = MCPWM_RUN_ALL;
+	for (i = 0; i < 3; i++) {
+		pMCPWM->TC[i] = 0;
+	}
+}
+
+/* Set the duty of all phases at once */
+HOTFUNC void Chip_MCPWM_DriveSetDuty(MCPWM_DRIVE_T *pDrive, const uint32_t *pActive)
+{
+	LPC_MCPWM_T *pMCPWM = pDrive->pMCPWM;
+	uint32_t i, active;
+
+	/* A period boundary while DISUP is set only postpones the transfer */
+	pMCPWM->CON_SET = MCPWM_DISUP_ALL;
+	for (i = 0; i < pDrive->phases; i++) {
+		active = pActive[i];
+		if (active > pDrive->period) {
+			active = pDrive->period;
+		}
+		pMCPWM->MAT[i] = pDrive->period - active;
+	}
+	pMCPWM->CON_CLR = MCPWM_DISUP_ALL;
+}
+
+/* Start an ADC stream converting at the drive's trigger */
+Status Chip_MCPWM_DriveStartADC(MCPWM_DRIVE_T *pDrive, ADC_STREAM_T *pStream)
+{
+	if (pDrive->phases == 3) {
+		return ERROR;
+	}
+
+	return Chip_ADC_Stream_Start(pStream, ADC_START_ON_MCOA2, (ADC_EDGE_CFG_T) pDrive->trigEdge);
+}
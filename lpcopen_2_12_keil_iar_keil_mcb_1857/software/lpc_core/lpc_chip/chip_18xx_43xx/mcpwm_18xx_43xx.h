@@ -69,6 +69,138 @@ typedef struct {					/*!< MCPWM Structure        */
 	__O  uint32_t  CAP_CLR;			/*!< Capture clear address  */
 } LPC_MCPWM_T;
 
+/**
+ * Macro defines for the CON register, n is the channel 0 to 2
+ */
+#define MCPWM_CON_RUN(n)        (1 << ((n) * 8))		/*!< Timer of channel n runs */
+#define MCPWM_CON_CENTER(n)     (1 << (((n) * 8) + 1))	/*!< Centre aligned, TC counts up and down */
+#define MCPWM_CON_POLA(n)       (1 << (((n) * 8) + 2))	/*!< MCOAn passive high */
+#define MCPWM_CON_DTE(n)        (1 << (((n) * 8) + 3))	/*!< Dead time between MCOAn and MCOBn */
+#define MCPWM_CON_DISUP(n)      (1 << (((n) * 8) + 4))	/*!< Hold the LIM/MAT shadow registers */
+#define MCPWM_CON_INVBDC        (1 << 29)				/*!< MCOB outputs in phase with MCOA */
+#define MCPWM_CON_ACMODE        (1 << 30)				/*!< All channels run from the channel 0 TC and LIM */
+#define MCPWM_CON_DCMODE        (1UL << 31)				/*!< Channel 0 drives all outputs, masked by CCP */
+
+/**
+ * Macro defines for the interrupt registers (INTEN, INTF), n is the channel 0 to 2
+ */
+#define MCPWM_INT_ILIM(n)       (1 << ((n) * 4))		/*!< TC reached LIM */
+#define MCPWM_INT_IMAT(n)       (1 << (((n) * 4) + 1))	/*!< TC reached MAT */
+#define MCPWM_INT_ICAP(n)       (1 << (((n) * 4) + 2))	/*!< Capture event */
+#define MCPWM_INT_ABORT         (1 << 15)				/*!< Fast abort input */
+
+/** Largest dead time, in MCPWM clocks */
+#define MCPWM_DT_MAX            0x3FF
+
+/**
+ * @brief ADC trigger of a drive, through the MCOA2 start input of the ADCs
+ */
+typedef enum {
+	MCPWM_ADCTRIG_NONE,					/*!< No trigger, channel 2 is a phase */
+	MCPWM_ADCTRIG_PEAK,					/*!< Centre of the active output time */
+	MCPWM_ADCTRIG_VALLEY				/*!< Centre of the passive output time (low side shunts) */
+} MCPWM_ADCTRIG_T;
+
+/**
+ * @brief Drive set up
+ */
+typedef struct {
+	uint32_t freqHz;					/*!< PWM frequency */
+	uint32_t deadTimeNs;				/*!< Dead time between the A and B outputs, 0 for none */
+	bool centre;						/*!< Centre aligned, else edge aligned */
+	bool activeLow;						/*!< MCOA outputs active low */
+	MCPWM_ADCTRIG_T adcTrig;			/*!< ADC trigger, takes channel 2 */
+	uint16_t trigLead;					/*!< MCPWM clocks the trigger comes before the centre, at least 1 */
+} MCPWM_DRIVE_CFG_T;
+
+/**
+ * @brief Drive state
+ */
+typedef struct {
+	LPC_MCPWM_T *pMCPWM;				/*!< MCPWM block */
+	uint32_t period;					/*!< LIM, the duty full scale */
+	uint8_t phases;						/*!< Phase channels, 3, or 2 with an ADC trigger */
+	uint8_t trigEdge;					/*!< ADC_EDGE_CFG_T of the trigger */
+} MCPWM_DRIVE_T;
+
+/**
+ * @brief	Initialize the MCPWM, all timers stopped
+ * @param	pMCPWM	: The base of MCPWM peripheral on the chip
+ * @return	Nothing
+ */
+void Chip_MCPWM_Init(LPC_MCPWM_T *pMCPWM);
+
+/**
+ * @brief	Shut down the MCPWM
+ * @param	pMCPWM	: The base of MCPWM peripheral on the chip
+ * @return	Nothing
+ */
+void Chip_MCPWM_DeInit(LPC_MCPWM_T *pMCPWM);
+
+/**
+ * @brief	Set up a synchronized multi phase drive
+ * @param	pDrive	: Drive storage
+ * @param	pMCPWM	: The base of MCPWM peripheral on the chip
+ * @param	pCfg	: Drive set up
+ * @return	SUCCESS, or ERROR when the frequency or dead time is out of range
+ * @note	All channels run from the channel 0 timer (AC mode), so they
+ *			can't drift apart. Duties start at 0. With an ADC trigger,
+ *			channel 2 becomes the trigger: its match sits trigLead clocks
+ *			before the period centre, and MCOA2 starts the ADC there (route
+ *			no pin to MCOA2/MCOB2). That leaves two phases; a three phase
+ *			bridge runs without the trigger. The trigger needs centre
+ *			aligned mode.
+ */
+Status Chip_MCPWM_DriveInit(MCPWM_DRIVE_T *pDrive, LPC_MCPWM_T *pMCPWM, const MCPWM_DRIVE_CFG_T *pCfg);
+
+/**
+ * @brief	Start a drive, all channels in the same clock
+ * @param	pDrive	: Drive
+ * @return	Nothing
+ */
+void Chip_MCPWM_DriveStart(MCPWM_DRIVE_T *pDrive);
+
+/**
+ * @brief	Stop a drive, outputs passive
+ * @param	pDrive	: Drive
+ * @return	Nothing
+ */
+void Chip_MCPWM_DriveStop(MCPWM_DRIVE_T *pDrive);
+
+/**
+ * @brief	Get the duty full scale
+ * @param	pDrive	: Drive
+ * @return	MCPWM clocks of active time for 100% duty
+ */
+STATIC INLINE uint32_t Chip_MCPWM_DriveGetPeriod(const MCPWM_DRIVE_T *pDrive)
+{
+	return pDrive->period;
+}
+
+/**
+ * @brief	Set the duty of all phases at once
+ * @param	pDrive	: Drive
+ * @param	pActive	: Active time of each phase, 0 to the period
+ *					  (Chip_MCPWM_DriveGetPeriod()), one entry per phase
+ * @return	Nothing
+ * @note	The shadow transfer is held while the match registers are
+ *			written, so all phases switch at the same period boundary
+ *			(the centre of the passive time in centre aligned mode) and
+ *			never mix old and new duties. Safe from an interrupt.
+ */
+HOTFUNC void Chip_MCPWM_DriveSetDuty(MCPWM_DRIVE_T *pDrive, const uint32_t *pActive);
+
+/**
+ * @brief	Start an ADC stream converting at the drive's trigger
+ * @param	pDrive	: Drive set up with an ADC trigger
+ * @param	pStream	: ADC stream set up with Chip_ADC_Stream_Init(), one channel enabled
+ * @return	SUCCESS, or ERROR without a trigger or when the DMA could not start
+ * @note	Each PWM period one conversion is started by the hardware and
+ *			moved by the GPDMA, the CPU only sees the buffer half callbacks.
+ *			Start one stream per ADC to sample two currents at once.
+ */
+Status Chip_MCPWM_DriveStartADC(MCPWM_DRIVE_T *pDrive, ADC_STREAM_T *pStream);
+
 /**
  * @}
  */
@@ -0,0 +1,238 @@
+/*
+ * @brief LPC18xx/43xx power state manager with wake latency budgets
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "chip.h"
+#include "stopwatch.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* What was running before a deep state and has to come back */
+typedef struct {
+	CHIP_CGU_CLKIN_T coreIn;	/* PLL input, or the core source without PLL */
+	uint32_t coreHz;			/* Core clock to restore */
+	bool usbPLL;				/* USB PLL was running */
+	bool crystal;				/* Crystal oscillator was running */
+	bool sdram;					/* SDRAM was in use and is in self refresh */
+} PWRMGR_SAVED_T;
+
+static CHIP_PWRMGR_STATS_T stats[PWRMGR_STATE_COUNT];
+
+static CHIP_DVFS_NOTIFIER_T stopWatchNotifier;
+
+static const uint32_t hwWakeUs[PWRMGR_STATE_COUNT] = {
+	PWRMGR_HW_WAKE_US_SLEEP,
+	PWRMGR_HW_WAKE_US_DEEP_SLEEP,
+	PWRMGR_HW_WAKE_US_POWER_DOWN,
+	PWRMGR_HW_WAKE_US_DEEP_POWER_DOWN
+};
+
+static const CHIP_PMC_PWR_STATE_T pmcState[PWRMGR_STATE_COUNT] = {
+	(CHIP_PMC_PWR_STATE_T) 0,
+	PMC_DeepSleep,
+	PMC_PowerDown,
+	PMC_DeepPowerDown
+};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* StopWatch ticks to uS. Ticks counted across a clock change are converted
+   at the slower of the two tick rates, so the result is an upper bound. */
+static uint32_t ticksToUs(uint32_t ticks, uint32_t rate1, uint32_t rate2)
+{
+	uint32_t rate = MIN(rate1, rate2);
+
+	if (rate == 0) {
+		return 0;
+	}
+	return (uint32_t) (((uint64_t) ticks * 1000000) / rate);
+}
+
+static void record(CHIP_PWRMGR_STATE_T state, uint32_t enterUs, uint32_t exitUs)
+{
+	CHIP_PWRMGR_STATS_T *pStats = &stats[state];
+
+	pStats->enterUs = enterUs;
+	pStats->exitUs = exitUs;
+	pStats->maxEnterUs = MAX(pStats->maxEnterUs, enterUs);
+	pStats->maxExitUs = MAX(pStats->maxExitUs, exitUs);
+	pStats->count++;
+}
+
+/* Stop what is running and would be lost or needs a clock in a deep state */
+static void saveAndStop(PWRMGR_SAVED_T *pSaved)
+{
+	CHIP_CGU_CLKIN_T in = Chip_Clock_GetBaseClock(CLK_BASE_MX);
+
+	/* SDRAM first, while the EMC still runs at its programmed rate */
+	pSaved->sdram = ((LPC_CCU1->CLKCCU[CLK_MX_EMC].STAT & 1) != 0) &&
+					((LPC_EMC->CONTROL & 1) != 0) && (LPC_EMC->DYNAMICREFRESH != 0);
+	if (pSaved->sdram) {
+		LPC_EMC->DYNAMICCONTROL |= (1 << 2);
+		while (!(LPC_EMC->STATUS & (1 << 2))) {}
+	}
+
+	pSaved->coreHz = SystemCoreClock;
+	if (in == CLKIN_MAINPLL) {
+		in = (CHIP_CGU_CLKIN_T) ((LPC_CGU->PLL1_CTRL >> 24) & 0xF);
+	}
+	pSaved->coreIn = in;
+	pSaved->usbPLL = (Chip_Clock_GetPLLStatus(CGU_USB_PLL) & CGU_PLL_LOCKED) != 0;
+	pSaved->crystal = (LPC_CGU->XTAL_OSC_CTRL & 1) == 0;
+
+	/* Everything on the main PLL moves to the IRC and the PLL stops */
+	Chip_DVFS_SetCoreClock(CLKIN_IRC, CGU_IRC_FREQ);
+	if (pSaved->usbPLL) {
+		Chip_Clock_DisablePLL(CGU_USB_PLL);
+	}
+	if (pSaved->crystal) {
+		Chip_Clock_DisableCrystal();
+	}
+
+	/* Branch clocks with the wake up bit set stop with the core */
+	Chip_Clock_StartPowerDown();
+}
+
+/* Bring back what saveAndStop() stopped */
+static void restore(const PWRMGR_SAVED_T *pSaved)
+{
+	/* Chip_PMC_Set_PwrState() leaves SLEEPDEEP set */
+	SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+	Chip_Clock_ClearPowerDown();
+
+	if (pSaved->crystal) {
+		Chip_Clock_EnableCrystal();
+	}
+	Chip_DVFS_SetCoreClock(pSaved->coreIn, pSaved->coreHz);
+	if (pSaved->usbPLL) {
+		Chip_Clock_EnablePLL(CGU_USB_PLL);
+		while (!(Chip_Clock_GetPLLStatus(CGU_USB_PLL) & CGU_PLL_LOCKED)) {}
+	}
+
+	if (pSaved->sdram) {
+		LPC_EMC->DYNAMICCONTROL &= ~(1 << 2);
+		while (LPC_EMC->STATUS & (1 << 2)) {}
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start the StopWatch and clear the latency figures */
+void Chip_PWRMGR_Init(void)
+{
+	StopWatch_Init();
+	Chip_DVFS_RegisterStopWatch(&stopWatchNotifier);
+	memset(stats, 0, sizeof(stats));
+}
+
+/* Wake up latency a state is chosen on */
+uint32_t Chip_PWRMGR_WakeLatency(CHIP_PWRMGR_STATE_T state)
+{
+	uint32_t exitUs = stats[state].maxExitUs;
+
+	if ((stats[state].count == 0) && (state != PWRMGR_SLEEP)) {
+		exitUs = PWRMGR_EST_RESTORE_US;
+	}
+	return exitUs + hwWakeUs[state];
+}
+
+/* Pick the deepest state that wakes within a budget */
+CHIP_PWRMGR_STATE_T Chip_PWRMGR_Select(uint32_t budgetUs, CHIP_PWRMGR_STATE_T deepest)
+{
+	int state;
+
+	for (state = deepest; state > PWRMGR_SLEEP; state--) {
+		if (Chip_PWRMGR_WakeLatency((CHIP_PWRMGR_STATE_T) state) <= budgetUs) {
+			break;
+		}
+	}
+	return (CHIP_PWRMGR_STATE_T) state;
+}
+
+/* Enter a power state and return once woken and restored */
+void Chip_PWRMGR_Enter(CHIP_PWRMGR_STATE_T state)
+{
+	PWRMGR_SAVED_T saved;
+	uint32_t start, enterTicks, rateFull, rateLow;
+
+	rateFull = StopWatch_TicksPerSecond();
+	start = StopWatch_Start();
+
+	if (state == PWRMGR_SLEEP) {
+		enterTicks = StopWatch_Elapsed(start);
+		SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+		Chip_PMC_Sleep();
+		start = StopWatch_Start();
+		record(state, ticksToUs(enterTicks, rateFull, rateFull),
+			   ticksToUs(StopWatch_Elapsed(start), rateFull, rateFull));
+		return;
+	}
+
+	saveAndStop(&saved);
+	rateLow = StopWatch_TicksPerSecond();
+	enterTicks = StopWatch_Elapsed(start);
+	if (state == PWRMGR_DEEP_POWER_DOWN) {
+		/* Only the enter time is seen, waking is a reset */
+		record(state, ticksToUs(enterTicks, rateFull, rateLow), 0);
+	}
+
+	Chip_PMC_Set_PwrState(pmcState[state]);
+
+	start = StopWatch_Start();
+	restore(&saved);
+	record(state, ticksToUs(enterTicks, rateFull, rateLow),
+		   ticksToUs(StopWatch_Elapsed(start), rateLow, StopWatch_TicksPerSecond()));
+}
+
+/* Enter the deepest state that wakes within a budget */
+CHIP_PWRMGR_STATE_T Chip_PWRMGR_Idle(uint32_t budgetUs, CHIP_PWRMGR_STATE_T deepest)
+{
+	CHIP_PWRMGR_STATE_T state = Chip_PWRMGR_Select(budgetUs, deepest);
+
+	Chip_PWRMGR_Enter(state);
+	return state;
+}
+
+/* Measured latencies of a power state */
+const CHIP_PWRMGR_STATS_T *Chip_PWRMGR_GetStats(CHIP_PWRMGR_STATE_T state)
+{
+	return &stats[state];
+}
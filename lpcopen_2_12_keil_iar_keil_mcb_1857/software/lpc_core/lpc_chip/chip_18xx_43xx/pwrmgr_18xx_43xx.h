@@ -0,0 +1,157 @@
+/*
+ * @brief LPC18xx/43xx power state manager with wake latency budgets
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef _PWRMGR_18XX_43XX_H_
+#define _PWRMGR_18XX_43XX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup PWRMGR_18XX_43XX CHIP: LPC18xx/43xx power state manager
+ * @ingroup PMC_18XX_43XX
+ * Enters the deepest PMC power state whose wake up latency fits a budget
+ * given by the caller. For deep sleep and power down only what is running
+ * is saved: the main PLL users are parked on the IRC through the core
+ * clock scaling service (so registered drivers keep their rates), the USB
+ * PLL and the crystal are stopped only if they ran, and SDRAM is put in
+ * self refresh only if the EMC drives it. Waking restores exactly that.
+ *
+ * Enter and exit times are measured with the StopWatch on every use. Exit
+ * time runs from the wake up interrupt returning to the clocks being back;
+ * the hardware wake up time before it, which no timer can see, is taken
+ * from PWRMGR_HW_WAKE_US_xxx. A state is chosen on its worst measured exit
+ * time plus that figure, or on PWRMGR_EST_RESTORE_US until it was used
+ * once. The wake up source is set up by the caller, usually with
+ * Chip_EVRT_SetHandler() so the wake up interrupt goes to its handler.
+ * @{
+ */
+
+/** Hardware wake up times in uS added to the measured exit times. These are
+   conservative placeholders, measure them on the board (e.g. WAKEUP0 to
+   a GPIO toggled first thing in the wake up interrupt) and override them. */
+#ifndef PWRMGR_HW_WAKE_US_SLEEP
+#define PWRMGR_HW_WAKE_US_SLEEP         2
+#endif
+#ifndef PWRMGR_HW_WAKE_US_DEEP_SLEEP
+#define PWRMGR_HW_WAKE_US_DEEP_SLEEP    50
+#endif
+#ifndef PWRMGR_HW_WAKE_US_POWER_DOWN
+#define PWRMGR_HW_WAKE_US_POWER_DOWN    100
+#endif
+/** Deep power down wakes through reset, this includes the boot time */
+#ifndef PWRMGR_HW_WAKE_US_DEEP_POWER_DOWN
+#define PWRMGR_HW_WAKE_US_DEEP_POWER_DOWN   5000
+#endif
+
+/** Clock restore time assumed for a state not used yet, mostly PLL lock */
+#ifndef PWRMGR_EST_RESTORE_US
+#define PWRMGR_EST_RESTORE_US           1000
+#endif
+
+/**
+ * @brief Power states, from the lightest to the deepest
+ */
+typedef enum {
+	PWRMGR_SLEEP,				/*!< Core clock stopped, everything else runs */
+	PWRMGR_DEEP_SLEEP,			/*!< All clocks stopped, state and SRAM kept */
+	PWRMGR_POWER_DOWN,			/*!< As deep sleep, most SRAM powered down */
+	PWRMGR_DEEP_POWER_DOWN,		/*!< Only the RTC domain runs, wakes through reset */
+	PWRMGR_STATE_COUNT
+} CHIP_PWRMGR_STATE_T;
+
+/**
+ * @brief Measured latencies of one power state, in uS
+ */
+typedef struct {
+	uint32_t enterUs;		/*!< Last time from the call to WFI */
+	uint32_t exitUs;		/*!< Last time from the wake up to clocks restored */
+	uint32_t maxEnterUs;	/*!< Worst enterUs seen */
+	uint32_t maxExitUs;		/*!< Worst exitUs seen */
+	uint32_t count;			/*!< Times the state was entered */
+} CHIP_PWRMGR_STATS_T;
+
+/**
+ * @brief	Start the StopWatch and clear the latency figures
+ * @return	Nothing
+ * @note	Registers the StopWatch with the core clock scaling service.
+ */
+void Chip_PWRMGR_Init(void);
+
+/**
+ * @brief	Wake up latency a state is chosen on
+ * @param	state	: Power state
+ * @return	Worst measured (or estimated) exit time plus the hardware wake up time, in uS
+ */
+uint32_t Chip_PWRMGR_WakeLatency(CHIP_PWRMGR_STATE_T state);
+
+/**
+ * @brief	Pick the deepest state that wakes within a budget
+ * @param	budgetUs	: Longest acceptable wake up latency in uS
+ * @param	deepest		: Deepest state allowed, usually PWRMGR_POWER_DOWN
+ * @return	The state, PWRMGR_SLEEP if nothing deeper fits
+ */
+CHIP_PWRMGR_STATE_T Chip_PWRMGR_Select(uint32_t budgetUs, CHIP_PWRMGR_STATE_T deepest);
+
+/**
+ * @brief	Enter a power state and return once woken and restored
+ * @param	state	: Power state
+ * @return	Nothing
+ * @note	Call from thread level with the wake up source enabled. Power
+ *			down keeps only part of the SRAM, stack and data must live
+ *			there. Deep power down does not return.
+ */
+void Chip_PWRMGR_Enter(CHIP_PWRMGR_STATE_T state);
+
+/**
+ * @brief	Enter the deepest state that wakes within a budget
+ * @param	budgetUs	: Longest acceptable wake up latency in uS
+ * @param	deepest		: Deepest state allowed
+ * @return	The state that was used
+ */
+CHIP_PWRMGR_STATE_T Chip_PWRMGR_Idle(uint32_t budgetUs, CHIP_PWRMGR_STATE_T deepest);
+
+/**
+ * @brief	Measured latencies of a power state
+ * @param	state	: Power state
+ * @return	Pointer to the figures, updated on every use of the state
+ */
+const CHIP_PWRMGR_STATS_T *Chip_PWRMGR_GetStats(CHIP_PWRMGR_STATE_T state);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PWRMGR_18XX_43XX_H_ */
@@ -0,0 +1,196 @@
+/*
+ * @brief LPC18xx/43xx Quadrature Encoder Interface driver
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Signed change from last to raw on a counter wrapping at range (0 for the
+   full 32 bits), taking the shorter way round */
+static HOTFUNC int32_t qei_delta(uint32_t range, uint32_t raw, uint32_t last)
+{
+	uint32_t d = raw - last;
+
+	if (range != 0) {
+		if (raw < last) {
+			d += range;
+		}
+		if (d > (range >> 1)) {
+			d -= range;
+		}
+	}
+
+	return (int32_t) d;
+}
+
+/* Make the work copy the current snapshot, readers keep using the other
+   copy until seq moves */
+static HOTFUNC void qei_publish(QEI_TRACK_T *pTrack)
+{
+	uint32_t seq = pTrack->seq + 1;
+
+	pTrack->snap[seq & 1] = pTrack->work;
+	__DMB();
+	pTrack->seq = seq;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize the QEI, counters reset and all interrupts off */
+void Chip_QEI_Init(LPC_QEI_T *pQEI)
+{
+	Chip_Clock_Enable(CLK_MX_QEI);
+
+	pQEI->IEC = QEI_INT_ALL;
+	pQEI->CLR = QEI_INT_ALL;
+	pQEI->CONF = 0;
+	pQEI->MAXPOS = 0xFFFFFFFF;
+	pQEI->FILTERPHA = 0;
+	pQEI->FILTERPHB = 0;
+	pQEI->FILTERINX = 0;
+	pQEI->CON = QEI_CON_RESP | QEI_CON_RESV | QEI_CON_RESI;
+}
+
+/* Shut down the QEI */
+void Chip_QEI_DeInit(LPC_QEI_T *pQEI)
+{
+	pQEI->IEC = QEI_INT_ALL;
+	pQEI->CLR = QEI_INT_ALL;
+	Chip_Clock_Disable(CLK_MX_QEI);
+}
+
+/* Set the velocity timer period */
+void Chip_QEI_SetVelocityRate(LPC_QEI_T *pQEI, uint32_t hz)
+{
+	pQEI->LOAD = (Chip_Clock_GetRate(CLK_MX_QEI) / hz) - 1;
+	pQEI->CON = QEI_CON_RESV;
+}
+
+/* Start tracking the position and velocity */
+void Chip_QEI_TrackStart(QEI_TRACK_T *pTrack, LPC_QEI_T *pQEI, uint32_t periodHz, uint32_t events,
+						 QEI_TRACK_CB_T callback, void *pArg)
+{
+	pTrack->pQEI = pQEI;
+	pTrack->range = pQEI->MAXPOS + 1;
+	pTrack->periodHz = periodHz;
+	pTrack->periodDelta = 0;
+	pTrack->events = events | QEI_INT_TIM | QEI_INT_INX;
+	pTrack->callback = callback;
+	pTrack->pArg = pArg;
+
+	Chip_QEI_SetVelocityRate(pQEI, periodHz);
+
+	pTrack->work.position = 0;
+	pTrack->work.indexPosition = 0;
+	pTrack->work.velocity = 0;
+	pTrack->work.raw = pQEI->POS;
+	pTrack->work.indexCount = pQEI->INXCNT;
+	pTrack->work.periods = 0;
+	pTrack->snap[0] = pTrack->work;
+	pTrack->snap[1] = pTrack->work;
+	pTrack->seq = 0;
+
+	pQEI->CLR = pTrack->events;
+	pQEI->IES = pTrack->events;
+}
+
+/* Stop tracking */
+void Chip_QEI_TrackStop(QEI_TRACK_T *pTrack)
+{
+	pTrack->pQEI->IEC = pTrack->events;
+	pTrack->pQEI->CLR = pTrack->events;
+}
+
+/* Update the tracker */
+HOTFUNC void Chip_QEI_TrackIRQHandler(QEI_TRACK_T *pTrack)
+{
+	LPC_QEI_T *pQEI = pTrack->pQEI;
+	QEI_SNAPSHOT_T *pW = &pTrack->work;
+	uint32_t status = pQEI->INTSTAT & pQEI->IE;
+	uint32_t raw, cap;
+	int32_t delta;
+
+	pQEI->CLR = status;
+
+	if ((status & (QEI_INT_TIM | QEI_INT_INX)) != 0) {
+		/* fold the change since the last update into the 64-bit count */
+		raw = pQEI->POS;
+		delta = qei_delta(pTrack->range, raw, pW->raw);
+		pW->raw = raw;
+		pW->position += delta;
+		pTrack->periodDelta += delta;
+
+		if (status & QEI_INT_INX) {
+			pW->indexPosition = pW->position;
+			pW->indexCount = pQEI->INXCNT;
+		}
+		if (status & QEI_INT_TIM) {
+			/* CAP only counts pulses, the sign comes from the position
+			   change over the period, or the direction when it is 0 */
+			cap = pQEI->CAP;
+			if ((pTrack->periodDelta < 0) || ((pTrack->periodDelta == 0) && (pQEI->STAT & QEI_STAT_DIR))) {
+				pW->velocity = -(int32_t) cap;
+			}
+			else {
+				pW->velocity = (int32_t) cap;
+			}
+			pTrack->periodDelta = 0;
+			pW->periods++;
+		}
+		qei_publish(pTrack);
+	}
+
+	if (pTrack->callback != NULL) {
+		pTrack->callback(pTrack, status);
+	}
+}
+
+/* Get the extended position right now */
+int64_t Chip_QEI_TrackGetPosition(const QEI_TRACK_T *pTrack)
+{
+	QEI_SNAPSHOT_T snap;
+
+	Chip_QEI_TrackSnapshot(pTrack, &snap);
+
+	return snap.position + qei_delta(pTrack->range, pTrack->pQEI->POS, snap.raw);
+}
@@ -75,6 +75,307 @@ typedef struct {				/*!< QEI Structure          */
 	__O  uint32_t  SET;			/*!< Interrupt status set register */
 } LPC_QEI_T;
 
+/**
+ * Macro defines for the CON register
+ */
+#define QEI_CON_RESP        (1 << 0)	/*!< Reset the position counter */
+#define QEI_CON_RESPI       (1 << 1)	/*!< Reset the position counter on the next index pulse */
+#define QEI_CON_RESV        (1 << 2)	/*!< Reset the velocity counter and timer */
+#define QEI_CON_RESI        (1 << 3)	/*!< Reset the index counter */
+
+/**
+ * Macro defines for the CONF register
+ */
+#define QEI_CONF_DIRINV     (1 << 0)	/*!< Invert the direction */
+#define QEI_CONF_SIGMODE    (1 << 1)	/*!< PhA is direction, PhB is clock */
+#define QEI_CONF_CAPMODE    (1 << 2)	/*!< Count both PhA and PhB edges (4x) */
+#define QEI_CONF_INVINX     (1 << 3)	/*!< Invert the index input */
+#define QEI_CONF_CRESPI     (1 << 4)	/*!< Reset the position counter on every index pulse */
+#define QEI_CONF_INXGATE(x) (((x) & 0xF) << 16)	/*!< PhA/PhB states the index is accepted in */
+
+/**
+ * Macro defines for the STAT register
+ */
+#define QEI_STAT_DIR        (1 << 0)	/*!< Counting down */
+
+/**
+ * Macro defines for the interrupt registers (IEC, IES, INTSTAT, IE, CLR, SET)
+ */
+#define QEI_INT_INX         (1 << 0)	/*!< Index pulse */
+#define QEI_INT_TIM         (1 << 1)	/*!< Velocity timer reload, CAP latched */
+#define QEI_INT_VELC        (1 << 2)	/*!< Captured velocity below VELCOMP */
+#define QEI_INT_DIR         (1 << 3)	/*!< Direction change */
+#define QEI_INT_ERR         (1 << 4)	/*!< Encoder phase error */
+#define QEI_INT_ENCLK       (1 << 5)	/*!< Encoder clock pulse */
+#define QEI_INT_POS0        (1 << 6)	/*!< Position equals CMPOS0 */
+#define QEI_INT_POS1        (1 << 7)	/*!< Position equals CMPOS1 */
+#define QEI_INT_POS2        (1 << 8)	/*!< Position equals CMPOS2 */
+#define QEI_INT_REV0        (1 << 9)	/*!< Index count equals INXCMP0 */
+#define QEI_INT_POS0REV     (1 << 10)	/*!< Both POS0 and REV0 */
+#define QEI_INT_POS1REV     (1 << 11)	/*!< Both POS1 and REV1 */
+#define QEI_INT_POS2REV     (1 << 12)	/*!< Both POS2 and REV2 */
+#define QEI_INT_REV1        (1 << 13)	/*!< Index count equals INXCMP1 */
+#define QEI_INT_REV2        (1 << 14)	/*!< Index count equals INXCMP2 */
+#define QEI_INT_MAXPOS      (1 << 15)	/*!< Position counter wrapped at MAXPOS */
+#define QEI_INT_ALL         0xFFFF
+
+/**
+ * @brief	Initialize the QEI, counters reset and all interrupts off
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @return	Nothing
+ * @note	The position counter counts over the full 32 bits, see
+ *			Chip_QEI_SetMaxPosition().
+ */
+void Chip_QEI_Init(LPC_QEI_T *pQEI);
+
+/**
+ * @brief	Shut down the QEI
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @return	Nothing
+ */
+void Chip_QEI_DeInit(LPC_QEI_T *pQEI);
+
+/**
+ * @brief	Set the counting mode
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @param	conf	: OR'ed QEI_CONF_* values
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_QEI_SetConfig(LPC_QEI_T *pQEI, uint32_t conf)
+{
+	pQEI->CONF = conf;
+}
+
+/**
+ * @brief	Reset counters
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @param	flags	: OR'ed QEI_CON_* values
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_QEI_Reset(LPC_QEI_T *pQEI, uint32_t flags)
+{
+	pQEI->CON = flags;
+}
+
+/**
+ * @brief	Set the position the counter wraps at
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @param	maxPos	: Highest position, counts per revolution - 1 or 0xFFFFFFFF
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_QEI_SetMaxPosition(LPC_QEI_T *pQEI, uint32_t maxPos)
+{
+	pQEI->MAXPOS = maxPos;
+}
+
+/**
+ * @brief	Get the position counter
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @return	Position, 0 to MAXPOS
+ */
+STATIC INLINE uint32_t Chip_QEI_GetPosition(LPC_QEI_T *pQEI)
+{
+	return pQEI->POS;
+}
+
+/**
+ * @brief	Get the counting direction
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @return	true when counting down
+ */
+STATIC INLINE bool Chip_QEI_IsReverse(LPC_QEI_T *pQEI)
+{
+	return (pQEI->STAT & QEI_STAT_DIR) != 0;
+}
+
+/**
+ * @brief	Set one of the three position compare registers
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @param	n		: Compare register, 0 to 2
+ * @param	pos		: Position raising QEI_INT_POSn
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_QEI_SetPositionCompare(LPC_QEI_T *pQEI, uint8_t n, uint32_t pos)
+{
+	(&pQEI->CMPOS0)[n] = pos;
+}
+
+/**
+ * @brief	Set the input filters
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @param	clocks	: Clocks an input must be stable for before it is taken, 0 for no filtering
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_QEI_SetFilter(LPC_QEI_T *pQEI, uint32_t clocks)
+{
+	pQEI->FILTERPHA = clocks;
+	pQEI->FILTERPHB = clocks;
+	pQEI->FILTERINX = clocks;
+}
+
+/**
+ * @brief	Set the velocity timer period
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @param	hz		: Velocity periods per second
+ * @return	Nothing
+ * @note	At each reload the pulses of the period are latched into CAP and
+ *			QEI_INT_TIM is raised.
+ */
+void Chip_QEI_SetVelocityRate(LPC_QEI_T *pQEI, uint32_t hz);
+
+/**
+ * @brief	Enable interrupts
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @param	mask	: OR'ed QEI_INT_* values
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_QEI_IntEnable(LPC_QEI_T *pQEI, uint32_t mask)
+{
+	pQEI->IES = mask;
+}
+
+/**
+ * @brief	Disable interrupts
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @param	mask	: OR'ed QEI_INT_* values
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_QEI_IntDisable(LPC_QEI_T *pQEI, uint32_t mask)
+{
+	pQEI->IEC = mask;
+}
+
+/**
+ * @brief	Get the pending enabled interrupts
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @return	OR'ed QEI_INT_* values
+ */
+STATIC INLINE uint32_t Chip_QEI_GetIntStatus(LPC_QEI_T *pQEI)
+{
+	return pQEI->INTSTAT & pQEI->IE;
+}
+
+/**
+ * @brief	Clear pending interrupts
+ * @param	pQEI	: The base of QEI peripheral on the chip
+ * @param	mask	: OR'ed QEI_INT_* values
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_QEI_ClearIntStatus(LPC_QEI_T *pQEI, uint32_t mask)
+{
+	pQEI->CLR = mask;
+}
+
+/**
+ * @brief Position and velocity as of the last velocity period or index pulse
+ */
+typedef struct {
+	int64_t position;					/*!< Extended position */
+	int64_t indexPosition;				/*!< Extended position at the last index pulse */
+	int32_t velocity;					/*!< Signed pulses counted in the last velocity period */
+	uint32_t raw;						/*!< POS the position was extended from */
+	uint32_t indexCount;				/*!< Index pulses seen */
+	uint32_t periods;					/*!< Velocity periods since the start */
+} QEI_SNAPSHOT_T;
+
+typedef struct QEI_TRACK QEI_TRACK_T;
+
+/**
+ * @brief	Tracker event callback, called from the QEI interrupt
+ * @param	pTrack	: Tracker
+ * @param	status	: QEI_INT_* values handled, the snapshot is already updated
+ * @return	Nothing
+ */
+typedef void (*QEI_TRACK_CB_T)(QEI_TRACK_T *pTrack, uint32_t status);
+
+/**
+ * @brief Position and velocity tracker, storage is owned by the caller
+ */
+struct QEI_TRACK {
+	LPC_QEI_T *pQEI;					/*!< QEI block */
+	volatile uint32_t seq;				/*!< Updates published, snap[seq & 1] is current */
+	QEI_SNAPSHOT_T snap[2];				/*!< Published copies */
+	QEI_SNAPSHOT_T work;				/*!< Copy the interrupt updates */
+	uint32_t range;						/*!< MAXPOS + 1, 0 for the full 32 bits */
+	uint32_t periodHz;					/*!< Velocity periods per second */
+	int32_t periodDelta;				/*!< Position change in the current velocity period */
+	uint32_t events;					/*!< Interrupts enabled by the tracker */
+	QEI_TRACK_CB_T callback;			/*!< Event callback, may be NULL */
+	void *pArg;							/*!< Caller context */
+};
+
+/**
+ * @brief	Start tracking the position and velocity
+ * @param	pTrack		: Tracker storage
+ * @param	pQEI		: The base of QEI peripheral on the chip, set up already
+ * @param	periodHz	: Velocity periods per second, also the rate the extended position is refreshed at
+ * @param	events		: Further QEI_INT_* interrupts passed to the callback
+ * @param	callback	: Event callback, may be NULL
+ * @param	pArg		: Caller context kept in @a pTrack
+ * @return	Nothing
+ * @note	The 32-bit counter is extended to 64 bits by adding the signed
+ *			change since the previous update at every velocity period and
+ *			index pulse, so it never overflows for any speed the period
+ *			can keep up with (half the MAXPOS range per period). Don't set
+ *			QEI_CONF_CRESPI, use indexPosition instead. The caller enables
+ *			QEI_IRQn and calls Chip_QEI_TrackIRQHandler() from QEI_IRQHandler.
+ */
+void Chip_QEI_TrackStart(QEI_TRACK_T *pTrack, LPC_QEI_T *pQEI, uint32_t periodHz, uint32_t events,
+						 QEI_TRACK_CB_T callback, void *pArg);
+
+/**
+ * @brief	Stop tracking
+ * @param	pTrack	: Tracker
+ * @return	Nothing
+ */
+void Chip_QEI_TrackStop(QEI_TRACK_T *pTrack);
+
+/**
+ * @brief	Update the tracker, call from QEI_IRQHandler
+ * @param	pTrack	: Tracker
+ * @return	Nothing
+ */
+HOTFUNC void Chip_QEI_TrackIRQHandler(QEI_TRACK_T *pTrack);
+
+/**
+ * @brief	Read a consistent snapshot without locking
+ * @param	pTrack	: Tracker
+ * @param	pSnap	: Snapshot copy
+ * @return	Nothing
+ * @note	The interrupt writes the copy readers don't use and then flips
+ *			seq, so this never waits on it and is safe from any priority;
+ *			it only copies again when an update landed in the middle.
+ */
+STATIC INLINE void Chip_QEI_TrackSnapshot(const QEI_TRACK_T *pTrack, QEI_SNAPSHOT_T *pSnap)
+{
+	uint32_t seq;
+
+	do {
+		seq = pTrack->seq;
+		__DMB();
+		*pSnap = pTrack->snap[seq & 1];
+		__DMB();
+	} while (seq != pTrack->seq);
+}
+
+/**
+ * @brief	Get the extended position right now
+ * @param	pTrack	: Tracker
+ * @return	Last snapshot position plus the change of POS since
+ */
+int64_t Chip_QEI_TrackGetPosition(const QEI_TRACK_T *pTrack);
+
+/**
+ * @brief	Convert a snapshot velocity to pulses per second
+ * @param	pTrack		: Tracker
+ * @param	velocity	: Velocity of a snapshot
+ * @return	Pulses per second
+ */
+STATIC INLINE int32_t Chip_QEI_TrackVelocityToHz(const QEI_TRACK_T *pTrack, int32_t velocity)
+{
+	return velocity * (int32_t) pTrack->periodHz;
+}
+
 /**
  * @}
  */
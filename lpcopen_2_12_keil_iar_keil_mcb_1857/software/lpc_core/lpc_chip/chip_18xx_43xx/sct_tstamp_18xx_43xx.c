@@ -0,0 +1,187 @@
+/*
+ * @brief LPC18xx_43xx SCT hardware timestamp service
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* CONFIG INSYNC field, keeps every CTIN_x input synchronized so the edge
+   detection of the capture events works on asynchronous signals */
+#define SCTTS_CONFIG_INSYNC_ALL     (0xFF << 9)
+
+/* EVENT[n].CTRL fields for an input only event */
+#define SCTTS_EV_IOSEL(x)           ((x) << 6)
+#define SCTTS_EV_IOCOND(x)          ((x) << 10)
+#define SCTTS_EV_COMBMODE_IO        (2 << 12)
+
+/* Edge each input was enabled for, reported with its timestamps */
+static uint8_t inputEdge[SCTTS_INPUTS];
+
+/* Mask of the enabled inputs, events and capture registers are numbered
+   after their CTIN_x input */
+static uint32_t inputMask;
+
+static uint32_t dropped;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/* Timestamp queue, filled by the SCT interrupt */
+RINGBUFF_T g_sctTsQueue;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize the SCT as a free running 32-bit timestamp counter */
+void Chip_SCTTS_Init(LPC_SCT_T *pSCT, SCTTS_EVENT_T *pQueue, int count)
+{
+	RingBuffer_Init(&g_sctTsQueue, pQueue, sizeof(SCTTS_EVENT_T), count);
+	inputMask = 0;
+	dropped = 0;
+
+	Chip_SCT_Init(pSCT);
+	Chip_SCT_SetControl(pSCT, SCT_CTRL_HALT_L);
+
+	/* Unified counter on the bus clock, no limit so it only wraps at 2^32 */
+	Chip_SCT_Config(pSCT, SCT_CONFIG_32BIT_COUNTER | SCT_CONFIG_CLKMODE_BUSCLK |
+					SCTTS_CONFIG_INSYNC_ALL);
+	pSCT->EVEN = 0;
+	pSCT->EVFLAG = 0xFFFFFFFF;
+	pSCT->LIMIT_L = 0;
+	pSCT->HALT_L = 0;
+	pSCT->STOP_L = 0;
+	pSCT->START_L = 0;
+
+	Chip_SCT_SetControl(pSCT, SCT_CTRL_CLRCTR_L | SCT_CTRL_PRE_L(0));
+	Chip_SCT_ClearControl(pSCT, SCT_CTRL_STOP_L | SCT_CTRL_HALT_L);
+
+	NVIC_ClearPendingIRQ(SCT_IRQn);
+	NVIC_EnableIRQ(SCT_IRQn);
+}
+
+/* Stop the timestamp counter and shut down the SCT */
+void Chip_SCTTS_DeInit(LPC_SCT_T *pSCT)
+{
+	NVIC_DisableIRQ(SCT_IRQn);
+	pSCT->EVEN = 0;
+	Chip_SCT_SetControl(pSCT, SCT_CTRL_HALT_L);
+	inputMask = 0;
+	Chip_SCT_DeInit(pSCT);
+}
+
+/* Start capturing timestamps on an input */
+void Chip_SCTTS_EnableInput(LPC_SCT_T *pSCT, uint8_t input, SCTTS_EDGE_T edge)
+{
+	uint32_t bit = 1 << input;
+
+	pSCT->EVEN &= ~bit;
+	inputEdge[input] = (uint8_t) edge;
+
+	/* Capture register n latches the counter on event n, which is the
+	   selected edge of CTIN_n in the only state the SCT is ever in */
+	pSCT->REGMODE_L |= bit;
+	pSCT->CAPCTRL[input].U = bit;
+	pSCT->EVENT[input].CTRL = SCTTS_EV_IOSEL(input) | SCTTS_EV_IOCOND(edge) |
+							  SCTTS_EV_COMBMODE_IO;
+	pSCT->EVENT[input].STATE = 1;
+
+	pSCT->EVFLAG = bit;
+	inputMask |= bit;
+	pSCT->EVEN |= bit;
+}
+
+/* Stop capturing timestamps on an input */
+void Chip_SCTTS_DisableInput(LPC_SCT_T *pSCT, uint8_t input)
+{
+	uint32_t bit = 1 << input;
+
+	pSCT->EVEN &= ~bit;
+	pSCT->EVENT[input].STATE = 0;
+	pSCT->CAPCTRL[input].U = 0;
+	pSCT->EVFLAG = bit;
+	inputMask &= ~bit;
+}
+
+/* Get the timestamp counter rate */
+uint32_t Chip_SCTTS_GetRate(void)
+{
+	return Chip_Clock_GetRate(CLK_MX_SCT);
+}
+
+/* Convert a tick interval to nanoseconds */
+uint32_t Chip_SCTTS_TicksToNs(uint32_t ticks)
+{
+	uint64_t ns = ((uint64_t) ticks * 1000000000) / Chip_SCTTS_GetRate();
+
+	return (ns > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t) ns;
+}
+
+/* SCT timestamp interrupt handler */
+HOTFUNC void Chip_SCTTS_IRQHandler(LPC_SCT_T *pSCT)
+{
+	uint32_t pending = pSCT->EVFLAG & inputMask;
+	SCTTS_EVENT_T ev;
+
+	/* Clear first, an edge arriving while the captures are read then
+	   raises the interrupt again */
+	pSCT->EVFLAG = pending;
+	ev.reserved = 0;
+
+	while (pending) {
+		ev.input = (uint8_t) (31 - __CLZ(pending));
+		pending &= ~(1 << ev.input);
+		ev.ticks = pSCT->CAP[ev.input].U;
+		ev.edge = inputEdge[ev.input];
+		if (!RingBuffer_Insert(&g_sctTsQueue, &ev)) {
+			dropped++;
+		}
+	}
+}
+
+/* Pop the oldest timestamp from the queue */
+bool Chip_SCTTS_Pop(SCTTS_EVENT_T *pEvent)
+{
+	return RingBuffer_Pop(&g_sctTsQueue, pEvent) != 0;
+}
+
+/* Get the number of timestamps dropped on a full queue */
+uint32_t Chip_SCTTS_GetDropped(void)
+{
+	return dropped;
+}
@@ -0,0 +1,198 @@
+/*
+ * @brief LPC18xx_43xx SCT hardware timestamp service
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __SCT_TSTAMP_18XX_43XX_H_
+#define __SCT_TSTAMP_18XX_43XX_H_
+
+#include "ring_buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup SCT_TSTAMP_18XX_43XX CHIP: LPC18XX_43XX SCT hardware timestamp service
+ *
+ * The service runs the SCT as a free running 32-bit counter clocked from the
+ * bus clock and turns each enabled CTIN_x input into a capture event. The
+ * SCT latches the counter into capture register x on the selected edge with
+ * no CPU involvement, so the timestamp resolution is one SCT clock (5.5 ns at
+ * 180 MHz) whatever the interrupt latency. The SCT interrupt then only has to
+ * move the captured value into a timestamp queue before the next edge on the
+ * same input.
+ *
+ * GIMA routes GPIO pins, the I2S frame syncs, the USB SOF outputs and other
+ * internal signals to the CTIN_x inputs, see the GIMA chapter of the user
+ * manual for the selection table of each input. Chip_SCTTS_Now() reads the
+ * same counter, so code submitting a HID report can stamp it in the same
+ * time base as the captured events.
+ *
+ * The service owns the SCT: events and match/capture registers 0 to 7 are
+ * used for the inputs and the counter is never limited, so it cannot be used
+ * together with the SCT PWM driver. The counter wraps every 2^32 ticks (about
+ * 23.8 s at 180 MHz), compute intervals with unsigned subtraction.
+ * @ingroup CHIP_18XX_43XX_Drivers
+ * @{
+ */
+
+/** Number of SCT capture inputs (CTIN_0 to CTIN_7) */
+#define SCTTS_INPUTS                    8
+
+/**
+ * @brief SCT timestamp input edges
+ */
+typedef enum {
+	SCTTS_EDGE_RISE = 1,				/*!< Capture on rising edge */
+	SCTTS_EDGE_FALL = 2,				/*!< Capture on falling edge */
+} SCTTS_EDGE_T;
+
+/**
+ * @brief SCT timestamp queue entry
+ */
+typedef struct {
+	uint32_t ticks;						/*!< Captured SCT counter value */
+	uint8_t input;						/*!< CTIN_x input that captured it */
+	uint8_t edge;						/*!< Edge it captured, SCTTS_EDGE_T */
+	uint16_t reserved;
+} SCTTS_EVENT_T;
+
+/** GIMA CTIN_x mode bits for Chip_SCTTS_RouteInput() */
+#define SCTTS_GIMA_INV                  (1 << 0)	/*!< Invert the input */
+#define SCTTS_GIMA_EDGE                 (1 << 1)	/*!< Rising edge detect */
+#define SCTTS_GIMA_SYNCH                (1 << 2)	/*!< Synchronize the input to the SCT clock */
+#define SCTTS_GIMA_PULSE                (1 << 3)	/*!< Single pulse generation */
+#define SCTTS_GIMA_SELECT(x)            (((x) & 0xF) << 4)	/*!< Input source select */
+
+/**
+ * @brief	Initialize the SCT as a free running 32-bit timestamp counter
+ * @param	pSCT	: The base of the SCT peripheral on the chip
+ * @param	pQueue	: Storage for the timestamp queue
+ * @param	count	: Number of entries in @a pQueue, must be a power of 2
+ * @return	None
+ * @note	Leaves all inputs disabled. The SCT interrupt is enabled in the
+ *          NVIC, the application's SCT_IRQHandler must call
+ *          Chip_SCTTS_IRQHandler().
+ */
+void Chip_SCTTS_Init(LPC_SCT_T *pSCT, SCTTS_EVENT_T *pQueue, int count);
+
+/**
+ * @brief	Stop the timestamp counter and shut down the SCT
+ * @param	pSCT	: The base of the SCT peripheral on the chip
+ * @return	None
+ */
+void Chip_SCTTS_DeInit(LPC_SCT_T *pSCT);
+
+/**
+ * @brief	Route a signal to a CTIN_x input through GIMA
+ * @param	input	: CTIN_x input, 0 to 7
+ * @param	mode	: SCTTS_GIMA_SELECT() of the source OR'ed with SCTTS_GIMA_* mode bits
+ * @return	None
+ * @note	SCTTS_GIMA_SELECT(0) is the CTIN_x pin itself, which must also be
+ *          muxed with Chip_SCU_PinMuxSet(). Use SCTTS_GIMA_SYNCH for
+ *          signals from other clock domains such as I2S and USB.
+ */
+STATIC INLINE void Chip_SCTTS_RouteInput(uint8_t input, uint32_t mode)
+{
+	LPC_GIMA->CTIN_IN[input] = mode;
+}
+
+/**
+ * @brief	Start capturing timestamps on an input
+ * @param	pSCT	: The base of the SCT peripheral on the chip
+ * @param	input	: CTIN_x input, 0 to 7
+ * @param	edge	: Edge to capture on
+ * @return	None
+ */
+void Chip_SCTTS_EnableInput(LPC_SCT_T *pSCT, uint8_t input, SCTTS_EDGE_T edge);
+
+/**
+ * @brief	Stop capturing timestamps on an input
+ * @param	pSCT	: The base of the SCT peripheral on the chip
+ * @param	input	: CTIN_x input, 0 to 7
+ * @return	None
+ */
+void Chip_SCTTS_DisableInput(LPC_SCT_T *pSCT, uint8_t input);
+
+/**
+ * @brief	Read the timestamp counter
+ * @param	pSCT	: The base of the SCT peripheral on the chip
+ * @return	Current SCT counter value, in the time base of the captured events
+ */
+STATIC INLINE uint32_t Chip_SCTTS_Now(LPC_SCT_T *pSCT)
+{
+	return pSCT->COUNT_U;
+}
+
+/**
+ * @brief	Get the timestamp counter rate
+ * @return	SCT ticks per second
+ */
+uint32_t Chip_SCTTS_GetRate(void);
+
+/**
+ * @brief	Convert a tick interval to nanoseconds
+ * @param	ticks	: Interval in SCT ticks
+ * @return	Interval in nanoseconds, saturated at 0xFFFFFFFF
+ */
+uint32_t Chip_SCTTS_TicksToNs(uint32_t ticks);
+
+/**
+ * @brief	SCT timestamp interrupt handler
+ * @param	pSCT	: The base of the SCT peripheral on the chip
+ * @return	None
+ * @note	Moves each pending capture into the timestamp queue, a capture
+ *          that finds the queue full is counted and dropped.
+ */
+HOTFUNC void Chip_SCTTS_IRQHandler(LPC_SCT_T *pSCT);
+
+/**
+ * @brief	Pop the oldest timestamp from the queue
+ * @param	pEvent	: Pointer to where the timestamp is copied
+ * @return	FALSE if the queue is empty, TRUE otherwise
+ * @note	The queue has one producer (the SCT interrupt), so a single
+ *          consumer may call this without disabling interrupts.
+ */
+bool Chip_SCTTS_Pop(SCTTS_EVENT_T *pEvent);
+
+/**
+ * @brief	Get the number of timestamps dropped on a full queue
+ * @return	Number of timestamps dropped since Chip_SCTTS_Init()
+ */
+uint32_t Chip_SCTTS_GetDropped(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCT_TSTAMP_18XX_43XX_H_ */
@@ -59,7 +59,9 @@ typedef struct {
 	__IO uint32_t  ENAIO[3];			/*!< Analog function select registerS */
 	__I  uint32_t  RESERVED17[27];
 	__IO uint32_t  EMCDELAYCLK;			/*!< EMC clock delay register */
-	__I  uint32_t  RESERVED18[63];
+	__I  uint32_t  RESERVED18[31];
+	__IO uint32_t  SDDELAY;				/*!< SD/MMC sample and drive delay register */
+	__I  uint32_t  RESERVED19[31];
 	__IO uint32_t  PINTSEL0;			/*!< Pin interrupt select register for pin interrupts 0 to 3. */
 	__IO uint32_t  PINTSEL1;			/*!< Pin interrupt select register for pin interrupts 4 to 7. */
 } LPC_SCU_T;
@@ -36,6 +36,9 @@
  * Private types/enumerations/variables
  ****************************************************************************/
 
+/* Board supplied timing tuning for each card clock rate */
+static SDIF_CLOCK_TUNE_FUNC_T g_clock_tune;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -151,6 +154,11 @@ void Chip_SDIF_SetClock(LPC_SDMMC_T *pSDMMC, uint32_t clk_rate, uint32_t speed)
 	/* inform CIU */
 	Chip_SDIF_SendCmd(pSDMMC, MCI_CMD_UPD_CLK | MCI_CMD_PRV_DAT_WAIT, 0);
 
+	/* retune the sample and drive points before the clock runs again */
+	if (g_clock_tune) {
+		g_clock_tune(pSDMMC, Chip_SDIF_GetClock(pSDMMC, clk_rate));
+	}
+
 	/* enable clock */
 	pSDMMC->CLKENA = MCI_CLKEN_ENABLE;
 
@@ -158,6 +166,27 @@ void Chip_SDIF_SetClock(LPC_SDMMC_T *pSDMMC, uint32_t clk_rate, uint32_t speed)
 	Chip_SDIF_SendCmd(pSDMMC, MCI_CMD_UPD_CLK | MCI_CMD_PRV_DAT_WAIT, 0);
 }
 
+/* Gets the SD bus clock speed */
+uint32_t Chip_SDIF_GetClock(LPC_SDMMC_T *pSDMMC, uint32_t clk_rate)
+{
+	uint32_t div = pSDMMC->CLKDIV & 0xFF;
+
+	/* divider 0 bypasses the divider */
+	return (div == 0) ? clk_rate : (clk_rate / (2 * div));
+}
+
+/* Registers the clock timing tuning function */
+void Chip_SDIF_SetClockTuning(SDIF_CLOCK_TUNE_FUNC_T tune)
+{
+	g_clock_tune = tune;
+}
+
+/* Sets the sample and drive delays of the card interface */
+void Chip_SDIF_SetDelay(uint32_t sample, uint32_t drive)
+{
+	LPC_SCU->SDDELAY = SDIF_DELAY_SAMPLE(sample) | SDIF_DELAY_DRIVE(drive);
+}
+
 /* Function to clear interrupt & FIFOs */
 void Chip_SDIF_SetClearIntFifo(LPC_SDMMC_T *pSDMMC)
 {
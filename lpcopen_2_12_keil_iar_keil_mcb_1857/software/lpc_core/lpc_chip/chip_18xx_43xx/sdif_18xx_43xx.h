@@ -196,6 +196,7 @@ typedef struct {				/*!< SDMMC Structure        */
 /** @brief SDIO status register definess
  */
 #define MCI_STS_GET_FCNT(x)     (((x) >> 17) & 0x1FF)
+#define MCI_STS_DATA_BUSY       (1 << 9)		/*!< Card holds DAT0 low (busy) */
 
 /** @brief SDIO FIFO threshold defines
  */
@@ -238,6 +239,14 @@ typedef int32_t (*PSCHECK_FUNC_T)(void);
 /** Function prototype for SD slot power enable or slot reset */
 typedef void (*PS_POWER_FUNC_T)(int32_t enable);
 
+/** Function prototype for card clock timing tuning, speed is the new clock in Hz */
+typedef void (*SDIF_CLOCK_TUNE_FUNC_T)(LPC_SDMMC_T *pSDMMC, uint32_t speed);
+
+/** @brief SCU SDDELAY register defines
+ */
+#define SDIF_DELAY_SAMPLE(n)    (((n) & 0xF) << 0)	/*!< Input sample delay steps */
+#define SDIF_DELAY_DRIVE(n)     (((n) & 0xF) << 8)	/*!< Output drive delay steps */
+
 /** @brief  SDIO chained DMA descriptor
  */
 typedef struct {
@@ -264,11 +273,15 @@ typedef struct _sdif_device {
 #define INIT_OP_RETRIES       50			/*!< initial OP_COND retries */
 #define SET_OP_RETRIES        1000			/*!< set OP_COND retries */
 #define SDIO_BUS_WIDTH        4				/*!< Max bus width supported */
+#ifndef SDIO_HIGH_SPEED
+#define SDIO_HIGH_SPEED       1				/*!< Switch SD cards to high speed mode when supported */
+#endif
 #define SD_MMC_ENUM_CLOCK       400000		/*!< Typical enumeration clock rate */
 #define MMC_MAX_CLOCK           20000000	/*!< Max MMC clock rate */
 #define MMC_LOW_BUS_MAX_CLOCK   26000000	/*!< Type 0 MMC card max clock rate */
 #define MMC_HIGH_BUS_MAX_CLOCK  52000000	/*!< Type 1 MMC card max clock rate */
 #define SD_MAX_CLOCK            25000000	/*!< Max SD clock rate */
+#define SD_HS_MAX_CLOCK         50000000	/*!< Max SD clock rate in high speed mode */
 
 /**
  * @brief	Set block size for the transfer
@@ -451,6 +464,34 @@ void Chip_SDIF_GetResponse(LPC_SDMMC_T *pSDMMC, uint32_t *resp);
  */
 void Chip_SDIF_SetClock(LPC_SDMMC_T *pSDMMC, uint32_t clk_rate, uint32_t speed);
 
+/**
+ * @brief	Gets the SD bus clock speed
+ * @param	pSDMMC	: SDMMC peripheral selected
+ * @param	clk_rate	: Input clock rate into the IP block
+ * @return	Clock speed to the card set by the divider
+ */
+uint32_t Chip_SDIF_GetClock(LPC_SDMMC_T *pSDMMC, uint32_t clk_rate);
+
+/**
+ * @brief	Registers the clock timing tuning function
+ * @param	tune	: Function called with each new card clock, or NULL
+ * @return	None
+ * @note	The function is called by Chip_SDIF_SetClock() with the card clock
+ * stopped, after every divider change. Boards use it to move the sample and
+ * drive points with Chip_SDIF_SetDelay() where the trace lengths need it at
+ * high speed clocks.
+ */
+void Chip_SDIF_SetClockTuning(SDIF_CLOCK_TUNE_FUNC_T tune);
+
+/**
+ * @brief	Sets the sample and drive delays of the card interface
+ * @param	sample	: Delay of the input sample point, 0 - 15 steps
+ * @param	drive	: Delay of the output drive point, 0 - 15 steps
+ * @return	None
+ * @note	Each step is about 0.5 nS.
+ */
+void Chip_SDIF_SetDelay(uint32_t sample, uint32_t drive);
+
 /**
  * @brief	Function to clear interrupt & FIFOs
  * @param	pSDMMC	: SDMMC peripheral selected
@@ -39,11 +39,33 @@
 /* Global instance of the current card */
 static mci_card_struct *g_card_info;
 
+/* Status raised while waiting for the most recent command */
+static uint32_t g_last_status;
+
+/* Optional caller descriptor ring */
+static pSDMMC_DMA_T *g_dma_ring;
+static int32_t g_dma_ring_count;
+
+/* The transfer started and not yet waited for */
+static struct {
+	int32_t bytes;		/* Bytes transferred, 0 when idle */
+	uint32_t status;	/* Status seen so far, MCI_INT_DATA_OVER once done */
+	bool counted;		/* Ended by CMD23 block count, no stop needed */
+	bool auto_stop;		/* Ended by the controller sending CMD12 */
+	bool write;			/* Card busy phase follows the data */
+	SDMMC_XFER_CB_T callback;	/* Non-blocking transfer when set */
+	volatile bool busy_wait;	/* Data over, waiting for the card to leave busy */
+} g_xfer;
+
 /* Helper definition: all SD error conditions in the status word */
 #define SD_INT_ERROR (MCI_INT_RESP_ERR | MCI_INT_RCRC | MCI_INT_DCRC | \
 					  MCI_INT_RTO | MCI_INT_DTO | MCI_INT_HTO | MCI_INT_FRUN | MCI_INT_HLE | \
 					  MCI_INT_SBE | MCI_INT_EBE)
 
+/* CMD6 arguments for the access mode group, function 1 is high speed */
+#define SD_SWITCH_HS_CHECK  0x00FFFFF1
+#define SD_SWITCH_HS_SET    0x80FFFFF1
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -122,6 +144,7 @@ static int32_t sdmmc_execute_command(LPC_SDMMC_T *pSDMMC, uint32_t cmd, uint32_t
 
 		/* wait for command response */
 		status = g_card_info->card_info.waitfunc_cb();
+		g_last_status = status;
 
 		/* We return an error if there is a timeout, even if we've fetched  a response */
 		if (status & SD_INT_ERROR) {
@@ -285,6 +308,7 @@ static int32_t prv_set_card_params(LPC_SDMMC_T *pSDMMC)
 
 		/* if positive response */
 		Chip_SDIF_SetCardType(pSDMMC, MCI_CTYPE_4BIT);
+		g_card_info->card_info.card_type |= CARD_TYPE_4BIT;
 	}
 #elif SDIO_BUS_WIDTH > 4
 #error 8-bit mode not supported yet!
@@ -300,6 +324,280 @@ static int32_t prv_set_card_params(LPC_SDMMC_T *pSDMMC)
 	return 0;
 }
 
+/* Learns whether the card supports SET_BLOCK_COUNT, card must be in trans state.
+   Returns the SD physical layer spec version from the SCR, -1 when not known */
+static int32_t prv_check_cmd23(LPC_SDMMC_T *pSDMMC)
+{
+	uint32_t scr[2];
+	int32_t spec = -1;
+
+	if ((g_card_info->card_info.card_type & CARD_TYPE_SD) == 0) {
+		/* MMC cards from spec 3.1 on all support CMD23 */
+		if (prv_get_bits(122, 125, (uint32_t *) g_card_info->card_info.csd) >= 3) {
+			g_card_info->card_info.card_type |= CARD_TYPE_CMD23;
+		}
+		return -1;
+	}
+
+	/* For SD it is the CMD_SUPPORT field of the 8 byte SCR, sent MSB first */
+	Chip_SDIF_SetBlkSizeByteCnt(pSDMMC, sizeof(scr));
+	Chip_SDIF_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) scr, sizeof(scr));
+	if (sdmmc_execute_command(pSDMMC, CMD_SD_SEND_SCR, 0, 0 | MCI_INT_DATA_OVER) == 0) {
+		if (((uint8_t *) scr)[3] & 0x02) {
+			g_card_info->card_info.card_type |= CARD_TYPE_CMD23;
+		}
+		spec = ((uint8_t *) scr)[0] & 0x0F;
+	}
+	Chip_SDIF_SetBlkSize(pSDMMC, MMC_SECTOR_SIZE);
+
+	return spec;
+}
+
+/* Sends CMD6 and reads back the 64 byte switch status, sent MSB first */
+static int32_t prv_sd_switch(LPC_SDMMC_T *pSDMMC, uint32_t arg, uint32_t *sw_status)
+{
+	int32_t status;
+
+	Chip_SDIF_SetBlkSizeByteCnt(pSDMMC, 64);
+	Chip_SDIF_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) sw_status, 64);
+	status = sdmmc_execute_command(pSDMMC, CMD_SD_SWITCH, arg, 0 | MCI_INT_DATA_OVER);
+	Chip_SDIF_SetBlkSize(pSDMMC, MMC_SECTOR_SIZE);
+
+	return status;
+}
+
+/* Moves an SD card to high speed mode (SDR25) when it supports it */
+static void prv_sd_high_speed(LPC_SDMMC_T *pSDMMC)
+{
+	uint32_t sw_status[64 / 4];
+	uint8_t *sw = (uint8_t *) sw_status;
+
+	/* Check mode first, the card reports support in bits 401 and the
+	   function it would select in bits 379:376 */
+	if ((prv_sd_switch(pSDMMC, SD_SWITCH_HS_CHECK, sw_status) != 0) ||
+		((sw[13] & 0x02) == 0) || ((sw[16] & 0x0F) != 1)) {
+		return;
+	}
+
+	if ((prv_sd_switch(pSDMMC, SD_SWITCH_HS_SET, sw_status) != 0) || ((sw[16] & 0x0F) != 1)) {
+		return;
+	}
+
+	/* The card has switched timing by the end of the status block */
+	g_card_info->card_info.card_type |= CARD_TYPE_HS;
+	g_card_info->card_info.speed = SD_HS_MAX_CLOCK;
+}
+
+/* Drops a high speed card back to the default clock after a CRC error,
+   the card stays in high speed mode which is valid at any clock up to 50MHz */
+static void prv_crc_fallback(uint32_t status)
+{
+	if ((status & (MCI_INT_RCRC | MCI_INT_DCRC)) && (g_card_info->card_info.card_type & CARD_TYPE_HS) &&
+		(g_card_info->card_info.speed > SD_MAX_CLOCK)) {
+		g_card_info->card_info.speed = SD_MAX_CLOCK;
+	}
+}
+
+/* Sets up the DMA for a transfer, on the caller ring if there is one */
+static int32_t prv_dma_setup(LPC_SDMMC_T *pSDMMC, uint32_t addr, uint32_t size)
+{
+	int32_t i, count;
+
+	if (g_dma_ring == NULL) {
+		if (size > (((sizeof(g_card_info->sdif_dev.mci_dma_dd) / sizeof(pSDMMC_DMA_T)) - 1) * MCI_DMADES1_MAXTR)) {
+			return -1;
+		}
+		Chip_SDIF_DmaSetup(pSDMMC, &g_card_info->sdif_dev, addr, size);
+		return 0;
+	}
+
+	count = (size + MCI_DMADES1_MAXTR - 1) / MCI_DMADES1_MAXTR;
+	if (count > g_dma_ring_count) {
+		return -1;
+	}
+
+	/* Reset DMA */
+	pSDMMC->CTRL |= MCI_CTRL_DMA_RESET | MCI_CTRL_FIFO_RESET;
+	while (pSDMMC->CTRL & MCI_CTRL_DMA_RESET) {}
+
+	/* The ring is already chained, only fill in the buffers */
+	for (i = 0; i < count; i++) {
+		g_dma_ring[i].des1 = MCI_DMADES1_BS1(MIN(size, MCI_DMADES1_MAXTR));
+		g_dma_ring[i].des2 = addr + (i * MCI_DMADES1_MAXTR);
+		g_dma_ring[i].des0 = MCI_DMADES0_OWN | MCI_DMADES0_CH |
+							 ((i == 0) ? MCI_DMADES0_FS : 0) |
+							 ((i == (count - 1)) ? MCI_DMADES0_LD : MCI_DMADES0_DIC);
+		size -= MIN(size, MCI_DMADES1_MAXTR);
+	}
+
+	/* Set DMA derscriptor base address */
+	pSDMMC->DBADDR = (uint32_t) &g_dma_ring[0];
+
+	return 0;
+}
+
+/* Issues a read or write, leaving the data phase running */
+static int32_t prv_start_transfer(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block,
+								  int32_t num_blocks, bool write)
+{
+	int32_t bytes = num_blocks * MMC_SECTOR_SIZE;
+	uint32_t cmd;
+	int32_t index;
+
+	/* Only one transfer in flight, a non-blocking one cannot be waited for */
+	if (g_xfer.bytes) {
+		if (g_xfer.callback) {
+			return 0;
+		}
+		Chip_SDMMC_WaitTransfer(pSDMMC);
+	}
+
+	/* if card is not acquired return immediately */
+	if ((num_blocks <= 0) || (start_block < 0) || ((start_block + num_blocks) > g_card_info->card_info.blocknr)) {
+		return 0;
+	}
+
+	/*Wait for card program to finish*/
+	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) {}
+
+	/* put card in trans state */
+	if (prv_set_trans_state(pSDMMC) != 0) {
+		return 0;
+	}
+
+	/* if high capacity card use block indexing */
+	if (g_card_info->card_info.card_type & CARD_TYPE_HC) {
+		index = start_block;
+	}
+	else {	/*fix at 512 bytes*/
+		index = start_block << 9;
+	}
+
+	/* Pre-defined block count where supported, so the card ends the
+	   transfer itself and no CMD12 is needed */
+	g_xfer.counted = (num_blocks > 1) && (g_card_info->card_info.card_type & CARD_TYPE_CMD23);
+	g_xfer.auto_stop = (num_blocks > 1) && !g_xfer.counted;
+	if (g_xfer.counted) {
+		if (sdmmc_execute_command(pSDMMC, CMD_SET_BLOCK_COUNT, num_blocks, 0) != 0) {
+			prv_crc_fallback(g_last_status);
+			return 0;
+		}
+		cmd = write ? CMD_WRITE_COUNTED : CMD_READ_COUNTED;
+	}
+	else if (num_blocks > 1) {
+		cmd = write ? CMD_WRITE_MULTIPLE : CMD_READ_MULTIPLE;
+	}
+	else {
+		cmd = write ? CMD_WRITE_SINGLE : CMD_READ_SINGLE;
+	}
+
+	/* set number of bytes to transfer */
+	Chip_SDIF_SetByteCnt(pSDMMC, bytes);
+	if (prv_dma_setup(pSDMMC, (uint32_t) buffer, bytes) != 0) {
+		return 0;
+	}
+
+	/* Only wait for the command response, the DMA carries on */
+	if (sdmmc_execute_command(pSDMMC, cmd, index, MCI_INT_CMD_DONE) != 0) {
+		prv_crc_fallback(g_last_status);
+		return 0;
+	}
+
+	g_xfer.status = g_last_status;
+	g_xfer.write = write;
+	g_xfer.callback = NULL;
+	g_xfer.busy_wait = false;
+	g_xfer.bytes = bytes;
+
+	return bytes;
+}
+
+/* Blocking transfer, retried once at the default clock when a CRC error
+   at high speed made the driver fall back */
+static int32_t prv_transfer_blocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block,
+								   int32_t num_blocks, bool write)
+{
+	uint32_t speed;
+	int32_t bytes;
+
+	do {
+		speed = g_card_info->card_info.speed;
+		bytes = prv_start_transfer(pSDMMC, buffer, start_block, num_blocks, write);
+		if (bytes != 0) {
+			bytes = Chip_SDMMC_WaitTransfer(pSDMMC);
+
+			/*Wait for card program to finish*/
+			if (write) {
+				while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) {}
+			}
+		}
+	} while ((bytes == 0) && (speed != g_card_info->card_info.speed));
+
+	return bytes;
+}
+
+/* Interrupt status bits that end the data phase of the current transfer */
+static uint32_t prv_data_wait_bits(void)
+{
+	uint32_t wait_status = MCI_INT_DATA_OVER | MCI_INT_FRUN | MCI_INT_HTO | MCI_INT_DTO |
+						   MCI_INT_DCRC | MCI_INT_SBE | MCI_INT_EBE;
+
+	if (g_xfer.auto_stop) {
+		wait_status |= MCI_INT_RTO | MCI_INT_RESP_ERR;
+	}
+
+	return wait_status;
+}
+
+/* Ends a non-blocking transfer and runs its callback */
+static void prv_async_done(LPC_SDMMC_T *pSDMMC)
+{
+	SDMMC_XFER_CB_T callback = g_xfer.callback;
+	int32_t bytes = (g_xfer.status & SD_INT_ERROR) ? 0 : g_xfer.bytes;
+
+	prv_crc_fallback(g_xfer.status);
+	g_xfer.bytes = 0;
+	g_xfer.busy_wait = false;
+	g_xfer.callback = NULL;
+	callback(pSDMMC, bytes);
+}
+
+/* Data phase of a non-blocking transfer is over, move on to the busy phase */
+static void prv_async_data_over(LPC_SDMMC_T *pSDMMC)
+{
+	if (g_xfer.write && ((g_xfer.status & SD_INT_ERROR) == 0) && (pSDMMC->STATUS & MCI_STS_DATA_BUSY)) {
+		g_xfer.busy_wait = true;
+	}
+	else {
+		prv_async_done(pSDMMC);
+	}
+}
+
+/* Starts a non-blocking transfer */
+static int32_t prv_start_async(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks,
+							   bool write, SDMMC_XFER_CB_T callback)
+{
+	uint32_t wait_status;
+	int32_t bytes;
+
+	bytes = prv_start_transfer(pSDMMC, buffer, start_block, num_blocks, write);
+	if (bytes == 0) {
+		return 0;
+	}
+	g_xfer.callback = callback;
+
+	/* Short transfers may already be over by the command response */
+	if (g_xfer.status & MCI_INT_DATA_OVER) {
+		prv_async_data_over(pSDMMC);
+	}
+	else {
+		wait_status = prv_data_wait_bits();
+		g_card_info->card_info.evsetup_cb((void *) &wait_status);
+	}
+
+	return bytes;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -475,6 +773,15 @@ uint32_t Chip_SDMMC_Acquire(LPC_SDMMC_T *pSDMMC, mci_card_struct *pcardinfo)
 		if (prv_set_card_params(pSDMMC) != 0) {
 			return 0;
 		}
+
+		/* CMD6 came with version 1.10 of the SD spec */
+#if SDIO_HIGH_SPEED
+		if (prv_check_cmd23(pSDMMC) >= 1) {
+			prv_sd_high_speed(pSDMMC);
+		}
+#else
+		prv_check_cmd23(pSDMMC);
+#endif
 	}
 
 	return prv_card_acquired();
@@ -486,6 +793,16 @@ int32_t Chip_SDMMC_GetDeviceSize(LPC_SDMMC_T *pSDMMC)
 	return g_card_info->card_info.device_size;
 }
 
+/* Get the bus mode negotiated with the card (after enumeration) */
+uint32_t Chip_SDMMC_GetBusMode(LPC_SDMMC_T *pSDMMC, int32_t *width)
+{
+	if (width) {
+		*width = (g_card_info->card_info.card_type & CARD_TYPE_4BIT) ? 4 : 1;
+	}
+
+	return g_card_info->card_info.speed;
+}
+
 /* Get the number of blocks in SD/MMC card (after enumeration) */
 int32_t Chip_SDMMC_GetDeviceBlocks(LPC_SDMMC_T *pSDMMC)
 {
@@ -495,98 +812,117 @@ int32_t Chip_SDMMC_GetDeviceBlocks(LPC_SDMMC_T *pSDMMC)
 /* Performs the read of data from the SD/MMC card */
 int32_t Chip_SDMMC_ReadBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks)
 {
-	int32_t cbRead = (num_blocks) * MMC_SECTOR_SIZE;
-	int32_t status = 0;
-	int32_t index;
-
-	/* if card is not acquired return immediately */
-	if (( start_block < 0) || ( (start_block + num_blocks) > g_card_info->card_info.blocknr) ) {
-		return 0;
-	}
+	return prv_transfer_blocks(pSDMMC, buffer, start_block, num_blocks, false);
+}
 
-	/* put card in trans state */
-	if (prv_set_trans_state(pSDMMC) != 0) {
-		return 0;
-	}
+/* Performs write of data to the SD/MMC card */
+int32_t Chip_SDMMC_WriteBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks)
+{
+	return prv_transfer_blocks(pSDMMC, buffer, start_block, num_blocks, true);
+}
 
-	/* set number of bytes to read */
-	Chip_SDIF_SetByteCnt(pSDMMC, cbRead);
+/* Use a caller descriptor ring for all data transfers */
+void Chip_SDMMC_SetDescriptorRing(LPC_SDMMC_T *pSDMMC, pSDMMC_DMA_T *ring, int32_t count)
+{
+	int32_t i;
 
-	/* if high capacity card use block indexing */
-	if (g_card_info->card_info.card_type & CARD_TYPE_HC) {
-		index = start_block;
-	}
-	else {	/*fix at 512 bytes*/
-		index = start_block << 9;	// \* g_card_info->card_info.block_len;
+	(void) pSDMMC;
 
+	/* Chain each descriptor to the next, the last one back to the start */
+	for (i = 0; ring && (i < count); i++) {
+		ring[i].des0 = 0;
+		ring[i].des3 = (uint32_t) &ring[(i + 1) % count];
 	}
-	Chip_SDIF_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) buffer, cbRead);
 
-	/* Select single or multiple read based on number of blocks */
-	if (num_blocks == 1) {
-		status = sdmmc_execute_command(pSDMMC, CMD_READ_SINGLE, index, 0 | MCI_INT_DATA_OVER);
-	}
-	else {
-		status = sdmmc_execute_command(pSDMMC, CMD_READ_MULTIPLE, index, 0 | MCI_INT_DATA_OVER);
-	}
+	g_dma_ring = ring;
+	g_dma_ring_count = ring ? count : 0;
+}
 
-	if (status != 0) {
-		cbRead = 0;
-	}
-	/*Wait for card program to finish*/
-	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) {}
+/* Start a read of data from the SD/MMC card */
+int32_t Chip_SDMMC_StartReadBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks)
+{
+	return prv_start_transfer(pSDMMC, buffer, start_block, num_blocks, false);
+}
 
-	return cbRead;
+/* Start a write of data to the SD/MMC card */
+int32_t Chip_SDMMC_StartWriteBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks)
+{
+	return prv_start_transfer(pSDMMC, buffer, start_block, num_blocks, true);
 }
 
-/* Performs write of data to the SD/MMC card */
-int32_t Chip_SDMMC_WriteBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks)
+/* Wait for the started transfer */
+int32_t Chip_SDMMC_WaitTransfer(LPC_SDMMC_T *pSDMMC)
 {
-	int32_t cbWrote = num_blocks *  MMC_SECTOR_SIZE;
-	int32_t status;
-	int32_t index;
+	uint32_t wait_status;
+	int32_t bytes = g_xfer.bytes;
 
-	/* if card is not acquired return immediately */
-	if (( start_block < 0) || ( (start_block + num_blocks) > g_card_info->card_info.blocknr) ) {
+	if (bytes == 0) {
 		return 0;
 	}
 
-	/*Wait for card program to finish*/
-	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) {}
+	/* Non-blocking transfers complete through their callback */
+	if (g_xfer.callback) {
+		while (Chip_SDMMC_PollAsync(pSDMMC)) {}
+		return (g_xfer.status & SD_INT_ERROR) ? 0 : bytes;
+	}
+	g_xfer.bytes = 0;
 
-	/* put card in trans state */
-	if (prv_set_trans_state(pSDMMC) != 0) {
+	/* Wait for the end of the data phase, including the controller sent
+	   stop command for open ended multiple block transfers */
+	if ((g_xfer.status & MCI_INT_DATA_OVER) == 0) {
+		wait_status = prv_data_wait_bits();
+		g_card_info->card_info.evsetup_cb((void *) &wait_status);
+		g_xfer.status |= g_card_info->card_info.waitfunc_cb();
+	}
+
+	if (g_xfer.status & SD_INT_ERROR) {
+		prv_crc_fallback(g_xfer.status);
 		return 0;
 	}
 
-	/* set number of bytes to write */
-	Chip_SDIF_SetByteCnt(pSDMMC, cbWrote);
+	return bytes;
+}
 
-	/* if high capacity card use block indexing */
-	if (g_card_info->card_info.card_type & CARD_TYPE_HC) {
-		index = start_block;
-	}
-	else {	/*fix at 512 bytes*/
-		index = start_block << 9;	// * g_card_info->card_info.block_len;
+/* Start a non-blocking read of data from the SD/MMC card */
+int32_t Chip_SDMMC_ReadBlocksAsync(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks,
+								   SDMMC_XFER_CB_T callback)
+{
+	return prv_start_async(pSDMMC, buffer, start_block, num_blocks, false, callback);
+}
 
-	}
+/* Start a non-blocking write of data to the SD/MMC card */
+int32_t Chip_SDMMC_WriteBlocksAsync(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks,
+									SDMMC_XFER_CB_T callback)
+{
+	return prv_start_async(pSDMMC, buffer, start_block, num_blocks, true, callback);
+}
 
-	Chip_SDIF_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) buffer, cbWrote);
+/* SDIO interrupt handling for non-blocking transfers */
+bool Chip_SDMMC_IRQHandler(LPC_SDMMC_T *pSDMMC)
+{
+	uint32_t status;
 
-	/* Select single or multiple write based on number of blocks */
-	if (num_blocks == 1) {
-		status = sdmmc_execute_command(pSDMMC, CMD_WRITE_SINGLE, index, 0 | MCI_INT_DATA_OVER);
+	if ((g_xfer.bytes == 0) || (g_xfer.callback == NULL) || g_xfer.busy_wait) {
+		return false;
 	}
-	else {
-		status = sdmmc_execute_command(pSDMMC, CMD_WRITE_MULTIPLE, index, 0 | MCI_INT_DATA_OVER);
+
+	status = Chip_SDIF_GetIntStatus(pSDMMC) & prv_data_wait_bits();
+	if (status) {
+		Chip_SDIF_ClrIntStatus(pSDMMC, status);
+		Chip_SDIF_SetIntMask(pSDMMC, 0);
+		g_xfer.status |= status;
+		prv_async_data_over(pSDMMC);
 	}
 
-	/*Wait for card program to finish*/
-	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) {}
+	return true;
+}
 
-	if (status != 0) {
-		cbWrote = 0;
+/* Progress a non-blocking transfer waiting for the card busy phase */
+bool Chip_SDMMC_PollAsync(LPC_SDMMC_T *pSDMMC)
+{
+	if (g_xfer.busy_wait && ((pSDMMC->STATUS & MCI_STS_DATA_BUSY) == 0)) {
+		prv_async_done(pSDMMC);
 	}
 
-	return cbWrote;
+	return (g_xfer.bytes != 0) && (g_xfer.callback != NULL);
 }
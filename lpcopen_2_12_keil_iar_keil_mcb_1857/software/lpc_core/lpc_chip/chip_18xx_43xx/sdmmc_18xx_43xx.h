@@ -81,6 +81,14 @@ extern "C" {
 #define CMD_STOP            CMD(MMC_STOP_TRANSMISSION, 1) | CMD_BIT_BUSY
 #define CMD_WRITE_SINGLE    CMD(MMC_WRITE_BLOCK, 1) | CMD_BIT_DATA | CMD_BIT_WRITE
 #define CMD_WRITE_MULTIPLE  CMD(MMC_WRITE_MULTIPLE_BLOCK, 1) | CMD_BIT_DATA | CMD_BIT_WRITE | CMD_BIT_AUTO_STOP
+#define CMD_SET_BLOCK_COUNT CMD(MMC_SET_BLOCK_COUNT, 1)
+#define CMD_READ_COUNTED    CMD(MMC_READ_MULTIPLE_BLOCK, 1) | CMD_BIT_DATA
+#define CMD_WRITE_COUNTED   CMD(MMC_WRITE_MULTIPLE_BLOCK, 1) | CMD_BIT_DATA | CMD_BIT_WRITE
+#define CMD_SD_SEND_SCR     CMD(SD_APP_SEND_SCR, 1) | CMD_BIT_APP | CMD_BIT_DATA
+#define CMD_SD_SWITCH       CMD(SD_SWITCH, 1) | CMD_BIT_DATA
+
+/* Completion callback of a non-blocking transfer, bytes is 0 on error */
+typedef void (*SDMMC_XFER_CB_T)(LPC_SDMMC_T *pSDMMC, int32_t bytes);
 
 /* Card specific setup data */
 typedef struct _mci_card_struct {
@@ -110,6 +118,17 @@ uint32_t Chip_SDMMC_Acquire(LPC_SDMMC_T *pSDMMC, mci_card_struct *pcardinfo);
  */
 int32_t Chip_SDMMC_GetDeviceSize(LPC_SDMMC_T *pSDMMC);
 
+/**
+ * @brief	Get the bus mode negotiated with the card (after enumeration)
+ * @param	pSDMMC	: SDMMC peripheral selected
+ * @param	width	: Pointer to where to put the bus width in bits, or NULL
+ * @return	Card clock limit in Hz, the divider gives the closest rate at or below it
+ * @note	SD cards supporting it are moved to high speed mode (CARD_TYPE_HS in
+ * card_type) with a 50MHz limit. A CRC error at that rate drops the limit to
+ * 25MHz, a blocking transfer that failed is then retried once.
+ */
+uint32_t Chip_SDMMC_GetBusMode(LPC_SDMMC_T *pSDMMC, int32_t *width);
+
 /**
  * @brief	Get the number of device blocks of SD/MMC card (after enumeration)
  * Since Chip_SDMMC_GetDeviceSize is limited to 32 bits cards with greater than
@@ -140,6 +159,97 @@ int32_t Chip_SDMMC_ReadBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_b
  */
 int32_t Chip_SDMMC_WriteBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks);
 
+/**
+ * @brief	Use a caller descriptor ring for all data transfers
+ * @param	pSDMMC	: SDMMC peripheral selected
+ * @param	ring	: Descriptor array, or NULL to go back to the card structure descriptors
+ * @param	count	: Number of descriptors, each moves up to MCI_DMADES1_MAXTR bytes
+ * @return	Nothing
+ * @note	The descriptors are chained once here, so each transfer only
+ *			fills in the buffer fields of the ones it uses. This lifts
+ *			the 64 KB limit of the descriptors in mci_card_struct.
+ */
+void Chip_SDMMC_SetDescriptorRing(LPC_SDMMC_T *pSDMMC, pSDMMC_DMA_T *ring, int32_t count);
+
+/**
+ * @brief	Start a read of data from the SD/MMC card
+ * @param	pSDMMC		: SDMMC peripheral selected
+ * @param	buffer		: Pointer to data buffer to copy to
+ * @param	start_block	: Start block number
+ * @param	num_blocks	: Number of block to read
+ * @return	Bytes queued for reading, or 0 on error
+ * @note	Returns once the card has accepted the command, with the data
+ *			moved by DMA. Finish with Chip_SDMMC_WaitTransfer(); starting
+ *			another transfer first waits for this one, and no other
+ *			card commands may be issued in between. Multiple block
+ *			transfers are preceded by CMD23 on cards that support it.
+ */
+int32_t Chip_SDMMC_StartReadBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks);
+
+/**
+ * @brief	Start a write of data to the SD/MMC card
+ * @param	pSDMMC		: SDMMC peripheral selected
+ * @param	buffer		: Pointer to data buffer to copy from, untouched until the transfer completes
+ * @param	start_block	: Start block number
+ * @param	num_blocks	: Number of block to write
+ * @return	Bytes queued for writing, or 0 on error
+ * @note	See Chip_SDMMC_StartReadBlocks(). Card programming after the
+ *			transfer overlaps with the caller preparing the next buffer.
+ */
+int32_t Chip_SDMMC_StartWriteBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks);
+
+/**
+ * @brief	Wait for the transfer started by Chip_SDMMC_StartReadBlocks()/StartWriteBlocks()
+ * @param	pSDMMC	: SDMMC peripheral selected
+ * @return	Bytes transferred, or 0 on error or if no transfer was started
+ */
+int32_t Chip_SDMMC_WaitTransfer(LPC_SDMMC_T *pSDMMC);
+
+/**
+ * @brief	Start a non-blocking read of data from the SD/MMC card
+ * @param	pSDMMC		: SDMMC peripheral selected
+ * @param	buffer		: Pointer to data buffer to copy to
+ * @param	start_block	: Start block number
+ * @param	num_blocks	: Number of block to read
+ * @param	callback	: Called once the data is in the buffer
+ * @return	Bytes queued for reading, or 0 on error or if a transfer is in progress
+ * @note	Returns after the command is issued. The application
+ *			SDIO_IRQHandler() must call Chip_SDMMC_IRQHandler() first;
+ *			the callback runs from there, or from Chip_SDMMC_PollAsync().
+ */
+int32_t Chip_SDMMC_ReadBlocksAsync(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks,
+								   SDMMC_XFER_CB_T callback);
+
+/**
+ * @brief	Start a non-blocking write of data to the SD/MMC card
+ * @param	pSDMMC		: SDMMC peripheral selected
+ * @param	buffer		: Pointer to data buffer to copy from, untouched until the callback
+ * @param	start_block	: Start block number
+ * @param	num_blocks	: Number of block to write
+ * @param	callback	: Called once the card has finished programming the data
+ * @return	Bytes queued for writing, or 0 on error or if a transfer is in progress
+ * @note	The controller has no interrupt for the end of the card busy
+ *			phase; if the card is still busy when the data phase ends,
+ *			the callback runs from a later Chip_SDMMC_PollAsync() call.
+ */
+int32_t Chip_SDMMC_WriteBlocksAsync(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks,
+									SDMMC_XFER_CB_T callback);
+
+/**
+ * @brief	SDIO interrupt handling for non-blocking transfers
+ * @param	pSDMMC	: SDMMC peripheral selected
+ * @return	true if the interrupt belonged to a non-blocking transfer,
+ *			false if the application wait callbacks should handle it
+ */
+bool Chip_SDMMC_IRQHandler(LPC_SDMMC_T *pSDMMC);
+
+/**
+ * @brief	Progress a non-blocking transfer waiting for the card busy phase
+ * @param	pSDMMC	: SDMMC peripheral selected
+ * @return	true while a non-blocking transfer is still in progress
+ */
+bool Chip_SDMMC_PollAsync(LPC_SDMMC_T *pSDMMC);
+
 /**
  * @}
  */
@@ -0,0 +1,298 @@
+/*
+ * @brief LPC43xx Serial GPIO driver
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+
+#if defined(CHIP_LPC43XX)
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Slices concatenated behind slice A, slice A takes the data pins */
+static const uint8_t sgpioChain[8] = {
+	SGPIO_SLICE_A, SGPIO_SLICE_I, SGPIO_SLICE_E, SGPIO_SLICE_J,
+	SGPIO_SLICE_C, SGPIO_SLICE_K, SGPIO_SLICE_F, SGPIO_SLICE_L
+};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* log2 of 1, 2, 4 or 8, -1 for anything else */
+static int sgpio_log2(uint32_t v)
+{
+	switch (v) {
+	case 1:
+		return 0;
+
+	case 2:
+		return 1;
+
+	case 4:
+		return 2;
+
+	case 8:
+		return 3;
+
+	default:
+		return -1;
+	}
+}
+
+/* Step past the words of one exchange, handing the half on at its end */
+static HOTFUNC void sgpio_stream_advance(SGPIO_STREAM_T *pStream)
+{
+	uint32_t *pDone;
+	uint8_t next;
+
+	pStream->pCur += pStream->numSlices;
+	if (pStream->pCur >= pStream->pEnd) {
+		/* hand the half on and continue in the other one, which should be
+		   back by now */
+		pDone = pStream->pBuf[pStream->half];
+		pStream->held[pStream->half] = 1;
+		next = pStream->half ^ 1;
+		if (pStream->held[next]) {
+			pStream->overruns++;
+		}
+		pStream->half = next;
+		pStream->pCur = pStream->pBuf[next];
+		pStream->pEnd = pStream->pCur + pStream->words;
+		if (pStream->callback != NULL) {
+			pStream->callback(pStream, pDone, pStream->words);
+		}
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize the SGPIO block, all slices stopped */
+void Chip_SGPIO_Init(LPC_SGPIO_T *pSGPIO)
+{
+	Chip_Clock_Enable(CLK_PERIPH_SGPIO);
+	Chip_RGU_TriggerReset(RGU_SGPIO_RST);
+	while (Chip_RGU_InReset(RGU_SGPIO_RST)) {}
+
+	pSGPIO->CTRL_ENABLED = 0;
+	pSGPIO->CTRL_DISABLED = 0;
+	pSGPIO->GPIO_OENREG = 0;
+	pSGPIO->CLR_EN_0 = 0xFFFF;
+	pSGPIO->CLR_EN_1 = 0xFFFF;
+	pSGPIO->CLR_EN_2 = 0xFFFF;
+	pSGPIO->CLR_EN_3 = 0xFFFF;
+	pSGPIO->CTR_STATUS_0 = 0xFFFF;
+	pSGPIO->CTR_STATUS_1 = 0xFFFF;
+	pSGPIO->CTR_STATUS_2 = 0xFFFF;
+	pSGPIO->CTR_STATUS_3 = 0xFFFF;
+}
+
+/* Shut down the SGPIO block */
+void Chip_SGPIO_DeInit(LPC_SGPIO_T *pSGPIO)
+{
+	pSGPIO->CTRL_ENABLED = 0;
+	pSGPIO->GPIO_OENREG = 0;
+	pSGPIO->CLR_EN_1 = 0xFFFF;
+	Chip_Clock_Disable(CLK_PERIPH_SGPIO);
+}
+
+/* Set up a slice */
+void Chip_SGPIO_ConfigSlice(LPC_SGPIO_T *pSGPIO, SGPIO_SLICE_T slice, uint32_t muxCfg,
+							uint32_t sliceCfg, uint32_t preset, uint32_t shifts)
+{
+	pSGPIO->SGPIO_MUX_CFG[slice] = muxCfg;
+	pSGPIO->SLICE_MUX_CFG[slice] = sliceCfg;
+	pSGPIO->PRESET[slice] = preset;
+	pSGPIO->COUNT[slice] = 0;
+	pSGPIO->POS[slice] = SGPIO_POS_RESET(shifts - 1) | SGPIO_POS_POS(shifts - 1);
+	pSGPIO->REG[slice] = 0;
+	pSGPIO->REG_SS[slice] = 0;
+}
+
+/* Set up a parallel stream into or out of ping pong buffers */
+Status Chip_SGPIO_StreamSetup(SGPIO_STREAM_T *pStream, LPC_SGPIO_T *pSGPIO, const SGPIO_STREAM_CFG_T *pCfg,
+							  uint32_t *pBuf, uint32_t words, SGPIO_STREAM_CB_T callback, void *pArg)
+{
+	static const uint8_t outCfg[4] = {SGPIO_OUT_DOUTM1, SGPIO_OUT_DOUTM2A, SGPIO_OUT_DOUTM4A, SGPIO_OUT_DOUTM8A};
+	int parallel = sgpio_log2(pCfg->width);
+	int order = sgpio_log2(pCfg->depth);
+	uint32_t muxCfg, sliceCfg, preset, pinMask, i;
+	bool capture = (pCfg->dir == SGPIO_STREAM_CAPTURE);
+
+	if ((parallel < 0) || (order < 0) || (pBuf == NULL) || (words == 0) || ((words % pCfg->depth) != 0)) {
+		return ERROR;
+	}
+	if (((pCfg->clkPin >= 0) && ((pCfg->clkPin < 8) || (pCfg->clkPin > 11))) ||
+		((pCfg->qualPin >= 0) && ((pCfg->qualPin < 8) || (pCfg->qualPin > 11))) ||
+		(pCfg->clkDiv < 1) || (pCfg->clkDiv > 4096)) {
+		return ERROR;
+	}
+
+	pStream->pSGPIO = pSGPIO;
+	pStream->dir = pCfg->dir;
+	pStream->numSlices = pCfg->depth;
+	pStream->irqSlice = SGPIO_SLICE_A;
+	pStream->sliceMask = 0;
+	pStream->pBuf[0] = pBuf;
+	pStream->pBuf[1] = pBuf + words;
+	pStream->words = words;
+	pStream->callback = callback;
+	pStream->pArg = pArg;
+
+	/* Shift clock and qualifier, the same for every slice of the chain */
+	muxCfg = 0;
+	sliceCfg = SGPIO_SLICE_PARALLEL(parallel);
+	preset = pCfg->clkDiv - 1;
+	if (pCfg->clkPin >= 0) {
+		muxCfg |= SGPIO_MUX_EXT_CLK_ENABLE | SGPIO_MUX_CLK_PIN(pCfg->clkPin - 8);
+		sliceCfg |= SGPIO_SLICE_CLKGEN_EXT;
+		if (pCfg->clkFalling) {
+			sliceCfg |= SGPIO_SLICE_CLK_CAPTURE_FALL;
+		}
+		preset = 0;
+	}
+	if (pCfg->qualPin >= 0) {
+		muxCfg |= SGPIO_MUX_QUALIFIER_MODE(SGPIO_QUAL_PIN) | SGPIO_MUX_QUALIFIER_PIN(pCfg->qualPin - 8);
+	}
+
+	/* Every slice exchanges after its 32 bits are shifted all the way
+	   through the chain. The pin end slice captures from the pins, all
+	   others (and all of them when generating) shift from the chain. */
+	for (i = 0; i < pCfg->depth; i++) {
+		uint32_t concat = 0;
+
+		if ((pCfg->depth > 1) && !(capture && (i == 0))) {
+			concat = SGPIO_MUX_CONCAT_ENABLE | SGPIO_MUX_CONCAT_ORDER(order);
+		}
+		Chip_SGPIO_ConfigSlice(pSGPIO, (SGPIO_SLICE_T) sgpioChain[i], muxCfg | concat, sliceCfg, preset,
+							   (pCfg->depth * 32) / pCfg->width);
+		pStream->sliceMask |= 1 << sgpioChain[i];
+
+		/* the slice at the far end of the chain holds the oldest data */
+		pStream->slices[pCfg->depth - 1 - i] = sgpioChain[i];
+	}
+
+	pinMask = (1 << pCfg->width) - 1;
+	if (capture) {
+		pSGPIO->GPIO_OENREG &= ~pinMask;
+	}
+	else {
+		for (i = 0; i < pCfg->width; i++) {
+			Chip_SGPIO_ConfigPin(pSGPIO, i, outCfg[parallel], SGPIO_OE_GPIO);
+		}
+		pSGPIO->GPIO_OENREG |= pinMask;
+	}
+
+	return SUCCESS;
+}
+
+/* Start a stream set up with Chip_SGPIO_StreamSetup() */
+void Chip_SGPIO_StreamStart(SGPIO_STREAM_T *pStream)
+{
+	LPC_SGPIO_T *pSGPIO = pStream->pSGPIO;
+	uint32_t *p;
+	uint32_t i;
+
+	pStream->half = 0;
+	pStream->held[0] = 0;
+	pStream->held[1] = 0;
+	pStream->overruns = 0;
+	pStream->pCur = pStream->pBuf[0];
+	pStream->pEnd = pStream->pCur + pStream->words;
+
+	if (pStream->dir == SGPIO_STREAM_GENERATE) {
+		/* the first words go out straight away, the next ones are swapped
+		   in at the first exchange */
+		p = pStream->pCur;
+		for (i = 0; i < pStream->numSlices; i++) {
+			pSGPIO->REG[pStream->slices[i]] = p[i];
+		}
+		sgpio_stream_advance(pStream);
+		p = pStream->pCur;
+		for (i = 0; i < pStream->numSlices; i++) {
+			pSGPIO->REG_SS[pStream->slices[i]] = p[i];
+		}
+		sgpio_stream_advance(pStream);
+	}
+
+	pSGPIO->CTR_STATUS_1 = 1 << pStream->irqSlice;
+	pSGPIO->SET_EN_1 = 1 << pStream->irqSlice;
+	Chip_SGPIO_EnableSlices(pSGPIO, pStream->sliceMask);
+}
+
+/* Stop a stream */
+void Chip_SGPIO_StreamStop(SGPIO_STREAM_T *pStream)
+{
+	LPC_SGPIO_T *pSGPIO = pStream->pSGPIO;
+
+	Chip_SGPIO_DisableSlices(pSGPIO, pStream->sliceMask);
+	pSGPIO->CLR_EN_1 = 1 << pStream->irqSlice;
+	pSGPIO->CTR_STATUS_1 = 1 << pStream->irqSlice;
+}
+
+/* Hand a buffer half back to the stream */
+void Chip_SGPIO_StreamRelease(SGPIO_STREAM_T *pStream, uint32_t *pBuf)
+{
+	pStream->held[(pBuf == pStream->pBuf[0]) ? 0 : 1] = 0;
+}
+
+/* Move one exchange worth of data */
+HOTFUNC void Chip_SGPIO_StreamIRQHandler(SGPIO_STREAM_T *pStream)
+{
+	LPC_SGPIO_T *pSGPIO = pStream->pSGPIO;
+	const uint8_t *pSlice = pStream->slices;
+	uint32_t i, n = pStream->numSlices;
+	uint32_t *p = pStream->pCur;
+
+	pSGPIO->CTR_STATUS_1 = 1 << pStream->irqSlice;
+
+	/* The shadow registers now hold the data just captured, or the data
+	   just sent. Move them before the chain wraps again. */
+	if (pStream->dir == SGPIO_STREAM_CAPTURE) {
+		for (i = 0; i < n; i++) {
+			p[i] = pSGPIO->REG_SS[pSlice[i]];
+		}
+	}
+	else {
+		for (i = 0; i < n; i++) {
+			pSGPIO->REG_SS[pSlice[i]] = p[i];
+		}
+	}
+	sgpio_stream_advance(pStream);
+}
+
+#endif /* defined(CHIP_LPC43XX) */
@@ -39,6 +39,12 @@ extern "C" {
 /** @defgroup SGPIO_43XX CHIP: LPC43xx Serial GPIO driver
  * @ingroup LPC_CHIP_18XX_43XX_Drivers
  * This module is present in LPC43xx MCUs only.
+ * Each of the 16 slices is a 32-bit shift register clocked by its own
+ * counter or by a pin, with a shadow register (REG_SS) swapped in every
+ * POS shift clocks. The stream functions chain slices into deep shift
+ * registers and move the shadow registers to or from ping pong buffers in
+ * the exchange interrupt, so parallel buses are captured or driven with
+ * hardware bit timing; the CPU only sees one interrupt per exchange.
  * @{
  */
 
@@ -95,6 +101,248 @@ typedef struct {						/*!< SGPIO Structure        */
 	__O  uint32_t  SET_STATUS_3;		/*!< Shift clock interrupt set status */
 } LPC_SGPIO_T;
 
+/** Number of slices, slice A is 0 and slice P is 15 */
+#define SGPIO_NUM_SLICES            16
+
+/**
+ * @brief SGPIO slices
+ */
+typedef enum {
+	SGPIO_SLICE_A = 0, SGPIO_SLICE_B, SGPIO_SLICE_C, SGPIO_SLICE_D,
+	SGPIO_SLICE_E, SGPIO_SLICE_F, SGPIO_SLICE_G, SGPIO_SLICE_H,
+	SGPIO_SLICE_I, SGPIO_SLICE_J, SGPIO_SLICE_K, SGPIO_SLICE_L,
+	SGPIO_SLICE_M, SGPIO_SLICE_N, SGPIO_SLICE_O, SGPIO_SLICE_P
+} SGPIO_SLICE_T;
+
+/**
+ * Macro defines for the OUT_MUX_CFG registers (one per SGPIO pin)
+ */
+#define SGPIO_OUT_CFG(x)            ((x) & 0xF)			/*!< Output mode, SGPIO_OUT_* */
+#define SGPIO_OUT_DOUTM1            0x0					/*!< 1-bit data of the pin's slice */
+#define SGPIO_OUT_DOUTM2A           0x1					/*!< 2-bit parallel data, mode A */
+#define SGPIO_OUT_DOUTM4A           0x5					/*!< 4-bit parallel data, mode A */
+#define SGPIO_OUT_DOUTM8A           0x9					/*!< 8-bit parallel data, mode A */
+#define SGPIO_OUT_GPIO              0x4					/*!< GPIO_OUTREG bit of the pin */
+#define SGPIO_OUT_CLK               0x8					/*!< Shift clock of the pin's slice */
+#define SGPIO_OE_CFG(x)             (((x) & 0x7) << 4)	/*!< Output enable source, SGPIO_OE_* */
+#define SGPIO_OE_GPIO               0x0					/*!< GPIO_OENREG bit of the pin */
+#define SGPIO_OE_DOUTM1             0x4					/*!< 1-bit output enable from a slice */
+
+/**
+ * Macro defines for the SGPIO_MUX_CFG registers (one per slice)
+ */
+#define SGPIO_MUX_EXT_CLK_ENABLE    (1 << 0)			/*!< Shift clock from a pin instead of COUNT */
+#define SGPIO_MUX_CLK_PIN(x)        (((x) & 0x3) << 1)	/*!< External clock pin SGPIO8 + x */
+#define SGPIO_MUX_CLK_SLICE(x)      (((x) & 0x3) << 3)	/*!< External clock slice D, H, O or P */
+#define SGPIO_MUX_QUALIFIER_MODE(x) (((x) & 0x3) << 5)	/*!< Shift qualifier, SGPIO_QUAL_* */
+#define SGPIO_MUX_QUALIFIER_PIN(x)  (((x) & 0x3) << 7)	/*!< Qualifier pin SGPIO8 + x */
+#define SGPIO_MUX_QUALIFIER_SLICE(x) (((x) & 0x3) << 9)	/*!< Qualifier slice */
+#define SGPIO_MUX_CONCAT_ENABLE     (1 << 11)			/*!< Shift in from the chain, not the data pin */
+#define SGPIO_MUX_CONCAT_ORDER(x)   (((x) & 0x3) << 12)	/*!< Chain of 1 (self loop), 2, 4 or 8 slices */
+#define SGPIO_QUAL_ENABLE           0					/*!< Always shift */
+#define SGPIO_QUAL_DISABLE          1					/*!< Never shift */
+#define SGPIO_QUAL_SLICE            2					/*!< Shift while the qualifier slice is high */
+#define SGPIO_QUAL_PIN              3					/*!< Shift while the qualifier pin is high */
+
+/**
+ * Macro defines for the SLICE_MUX_CFG registers
+ */
+#define SGPIO_SLICE_MATCH_MODE      (1 << 0)			/*!< Pattern match instead of shifting data */
+#define SGPIO_SLICE_CLK_CAPTURE_FALL (1 << 1)			/*!< External clock on falling edges */
+#define SGPIO_SLICE_CLKGEN_EXT      (1 << 2)			/*!< Shift clock from SGPIO_MUX_CFG, not COUNT */
+#define SGPIO_SLICE_INV_OUT_CLK     (1 << 3)			/*!< Invert the clock output */
+#define SGPIO_SLICE_DATA_CAPTURE(x) (((x) & 0x3) << 4)	/*!< Input data capture mode */
+#define SGPIO_SLICE_PARALLEL(x)     (((x) & 0x3) << 6)	/*!< Shift 1, 2, 4 or 8 bits per clock */
+#define SGPIO_SLICE_INV_QUALIFIER   (1 << 8)			/*!< Qualifier active low */
+
+/**
+ * Macro defines for the POS registers
+ */
+#define SGPIO_POS_POS(x)            ((x) & 0xFF)		/*!< Shifts left until the next exchange */
+#define SGPIO_POS_RESET(x)          (((x) & 0xFF) << 8)	/*!< Reload of POS after an exchange */
+
+/**
+ * @brief Parallel stream direction
+ */
+typedef enum {
+	SGPIO_STREAM_CAPTURE,				/*!< Pins to memory */
+	SGPIO_STREAM_GENERATE				/*!< Memory to pins */
+} SGPIO_STREAM_DIR_T;
+
+/**
+ * @brief Parallel stream set up
+ */
+typedef struct {
+	SGPIO_STREAM_DIR_T dir;				/*!< Capture or generate */
+	uint8_t width;						/*!< Bus width 1, 2, 4 or 8, on SGPIO0 up */
+	uint8_t depth;						/*!< Slices concatenated, 1, 2, 4 or 8 */
+	int8_t clkPin;						/*!< SGPIO8 to SGPIO11 for an external shift clock, -1 for internal */
+	int8_t qualPin;						/*!< SGPIO8 to SGPIO11 to shift only while it is high, -1 to always shift */
+	bool clkFalling;					/*!< Sample/launch data on the falling external clock edge */
+	uint16_t clkDiv;					/*!< Internal shift clock is the SGPIO clock / clkDiv, 1 to 4096 */
+} SGPIO_STREAM_CFG_T;
+
+typedef struct SGPIO_STREAM SGPIO_STREAM_T;
+
+/**
+ * @brief	Buffer half callback, called from the SGPIO interrupt
+ * @param	pStream	: Stream the half belongs to
+ * @param	pBuf	: Half just captured, or just sent and ready for new data
+ * @param	words	: Words in @a pBuf
+ * @return	Nothing
+ * @note	Return the half with Chip_SGPIO_StreamRelease() once it is consumed
+ *			or refilled, from the callback or later. A half that is still
+ *			held when the stream reaches it again counts as an overrun.
+ */
+typedef void (*SGPIO_STREAM_CB_T)(SGPIO_STREAM_T *pStream, uint32_t *pBuf, uint32_t words);
+
+/**
+ * @brief Parallel stream state, storage is owned by the caller
+ */
+struct SGPIO_STREAM {
+	LPC_SGPIO_T *pSGPIO;				/*!< SGPIO block */
+	SGPIO_STREAM_DIR_T dir;				/*!< Capture or generate */
+	uint8_t numSlices;					/*!< Slices moved on each exchange */
+	uint8_t slices[8];					/*!< Slices in buffer order */
+	uint8_t irqSlice;					/*!< Slice whose exchange interrupt is used */
+	uint16_t sliceMask;					/*!< Counters of all slices used */
+	uint32_t *pBuf[2];					/*!< Ping pong buffer halves */
+	uint32_t words;						/*!< Words per half, a multiple of numSlices */
+	uint32_t *pCur;						/*!< Next word of the active half */
+	uint32_t *pEnd;						/*!< End of the active half */
+	uint8_t half;						/*!< Active half */
+	volatile uint8_t held[2];			/*!< Half handed to the callback, not released yet */
+	uint32_t overruns;					/*!< Halves reused while still held */
+	SGPIO_STREAM_CB_T callback;			/*!< Buffer half callback */
+	void *pArg;							/*!< Caller context */
+};
+
+/**
+ * @brief	Initialize the SGPIO block, all slices stopped
+ * @param	pSGPIO	: The base of SGPIO peripheral on the chip
+ * @return	Nothing
+ */
+void Chip_SGPIO_Init(LPC_SGPIO_T *pSGPIO);
+
+/**
+ * @brief	Shut down the SGPIO block
+ * @param	pSGPIO	: The base of SGPIO peripheral on the chip
+ * @return	Nothing
+ */
+void Chip_SGPIO_DeInit(LPC_SGPIO_T *pSGPIO);
+
+/**
+ * @brief	Set up a slice
+ * @param	pSGPIO		: The base of SGPIO peripheral on the chip
+ * @param	slice		: Slice to set up
+ * @param	muxCfg		: SGPIO_MUX_CFG value, OR'ed SGPIO_MUX_* values
+ * @param	sliceCfg	: SLICE_MUX_CFG value, OR'ed SGPIO_SLICE_* values
+ * @param	preset		: COUNT reload, the internal shift clock divider minus 1
+ * @param	shifts		: Shift clocks between two exchanges of REG and REG_SS, 1 to 256
+ * @return	Nothing
+ * @note	The slice must be stopped
+ */
+void Chip_SGPIO_ConfigSlice(LPC_SGPIO_T *pSGPIO, SGPIO_SLICE_T slice, uint32_t muxCfg,
+							uint32_t sliceCfg, uint32_t preset, uint32_t shifts);
+
+/**
+ * @brief	Select what drives an SGPIO pin
+ * @param	pSGPIO	: The base of SGPIO peripheral on the chip
+ * @param	pin		: SGPIO pin, 0 to 15
+ * @param	outCfg	: SGPIO_OUT_* output mode
+ * @param	oeCfg	: SGPIO_OE_* output enable source
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_SGPIO_ConfigPin(LPC_SGPIO_T *pSGPIO, uint8_t pin, uint32_t outCfg, uint32_t oeCfg)
+{
+	pSGPIO->OUT_MUX_CFG[pin] = SGPIO_OUT_CFG(outCfg) | SGPIO_OE_CFG(oeCfg);
+}
+
+/**
+ * @brief	Start the counters of a set of slices together
+ * @param	pSGPIO	: The base of SGPIO peripheral on the chip
+ * @param	mask	: Bit n set for slice n
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_SGPIO_EnableSlices(LPC_SGPIO_T *pSGPIO, uint32_t mask)
+{
+	pSGPIO->CTRL_ENABLED |= mask;
+}
+
+/**
+ * @brief	Stop the counters of a set of slices together
+ * @param	pSGPIO	: The base of SGPIO peripheral on the chip
+ * @param	mask	: Bit n set for slice n
+ * @return	Nothing
+ */
+STATIC INLINE void Chip_SGPIO_DisableSlices(LPC_SGPIO_T *pSGPIO, uint32_t mask)
+{
+	pSGPIO->CTRL_ENABLED &= ~mask;
+}
+
+/**
+ * @brief	Set up a parallel stream into or out of ping pong buffers
+ * @param	pStream		: Stream storage
+ * @param	pSGPIO		: The base of SGPIO peripheral on the chip
+ * @param	pCfg		: Bus and clock set up
+ * @param	pBuf		: Buffer of 2 * @a words words, split in two halves
+ * @param	words		: Words per half, a multiple of the slices per exchange
+ * @param	callback	: Called as each half completes, may be NULL
+ * @param	pArg		: Caller context kept in @a pStream
+ * @return	SUCCESS, or ERROR for an unsupported width/depth or buffer size
+ * @note	Data goes through slice A and the slices concatenated behind it
+ *			(A, I, E, J, C, K, F, L), each exchange moves one word per slice
+ *			in bus order, oldest sample in the low bits. A deeper chain
+ *			means fewer interrupts for the same data rate. In generate mode
+ *			fill both halves before Chip_SGPIO_StreamStart(). Call
+ *			Chip_SGPIO_StreamIRQHandler() from SGPIO_IRQHandler.
+ */
+Status Chip_SGPIO_StreamSetup(SGPIO_STREAM_T *pStream, LPC_SGPIO_T *pSGPIO, const SGPIO_STREAM_CFG_T *pCfg,
+							  uint32_t *pBuf, uint32_t words, SGPIO_STREAM_CB_T callback, void *pArg);
+
+/**
+ * @brief	Start a stream set up with Chip_SGPIO_StreamSetup()
+ * @param	pStream	: Stream
+ * @return	Nothing
+ */
+void Chip_SGPIO_StreamStart(SGPIO_STREAM_T *pStream);
+
+/**
+ * @brief	Stop a stream
+ * @param	pStream	: Stream
+ * @return	Nothing
+ * @note	A partly filled capture half is not reported
+ */
+void Chip_SGPIO_StreamStop(SGPIO_STREAM_T *pStream);
+
+/**
+ * @brief	Hand a buffer half back to the stream
+ * @param	pStream	: Stream
+ * @param	pBuf	: Half passed to the callback
+ * @return	Nothing
+ */
+void Chip_SGPIO_StreamRelease(SGPIO_STREAM_T *pStream, uint32_t *pBuf);
+
+/**
+ * @brief	Move one exchange worth of data, call from SGPIO_IRQHandler
+ * @param	pStream	: Stream
+ * @return	Nothing
+ * @note	The slices shift on while this runs, it has until the next
+ *			exchange (32 shift clocks per slice word at 1 bit per clock, 4 at
+ *			8 bits) to read or refill the shadow registers.
+ */
+HOTFUNC void Chip_SGPIO_StreamIRQHandler(SGPIO_STREAM_T *pStream);
+
+/**
+ * @brief	Get the number of halves reused while still held
+ * @param	pStream	: Stream
+ * @return	Overrun count
+ */
+STATIC INLINE uint32_t Chip_SGPIO_StreamGetOverruns(SGPIO_STREAM_T *pStream)
+{
+	return pStream->overruns;
+}
+
 #endif
 
 /**
@@ -43,6 +43,71 @@
  * Private functions
  ****************************************************************************/
 
+/* Builds the descriptor lists of a transaction and puts it on the bus */
+STATIC Status SSP_DMA_Start(SSP_DMA_QUEUE_T *pQueue, SSP_XFER_T *pXfer)
+{
+	LPC_SSP_T *pSSP = pQueue->pSSP;
+	uint32_t width = (pXfer->bits > SSP_BITS_8) ? GPDMA_WIDTH_HALFWORD : GPDMA_WIDTH_BYTE;
+	uint32_t ctrl = GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_4) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_4) |
+					GPDMA_DMACCxControl_SWidth(width) | GPDMA_DMACCxControl_DWidth(width);
+	uint32_t left = pXfer->frames;
+	uint32_t offset, size;
+	int i;
+
+	/* Frame settings only change here, with the bus idle */
+	Chip_SSP_SetFormat(pSSP, pXfer->bits, SSP_FRAMEFORMAT_SPI, pXfer->clockMode);
+	if ((pXfer->bitRate != 0) && (pXfer->bitRate != pQueue->bitRate)) {
+		Chip_SSP_SetBitRate(pSSP, pXfer->bitRate);
+		pQueue->bitRate = pXfer->bitRate;
+	}
+
+	/* Both lists move the same frames, without address increments on the dummy side */
+	for (i = 0; left > 0; i++) {
+		size = MIN(left, 0xFFF);
+		offset = (pXfer->frames - left) << width;
+		left -= size;
+
+		pQueue->rxDesc[i].src = (uint32_t) &pSSP->DR;
+		pQueue->rxDesc[i].dst = pXfer->rxData ? ((uint32_t) pXfer->rxData + offset) : (uint32_t) &pQueue->rxDummy;
+		pQueue->rxDesc[i].lli = left ? (uint32_t) &pQueue->rxDesc[i + 1] : 0;
+		pQueue->rxDesc[i].ctrl = ctrl | GPDMA_DMACCxControl_TransferSize(size) |
+								 GPDMA_DMACCxControl_SrcTransUseAHBMaster1 |
+								 (pXfer->rxData ? GPDMA_DMACCxControl_DI : 0);
+
+		pQueue->txDesc[i].src = pXfer->txData ? ((uint32_t) pXfer->txData + offset) : (uint32_t) &pQueue->txDummy;
+		pQueue->txDesc[i].dst = (uint32_t) &pSSP->DR;
+		pQueue->txDesc[i].lli = left ? (uint32_t) &pQueue->txDesc[i + 1] : 0;
+		pQueue->txDesc[i].ctrl = ctrl | GPDMA_DMACCxControl_TransferSize(size) |
+								 GPDMA_DMACCxControl_DestTransUseAHBMaster1 |
+								 (pXfer->txData ? GPDMA_DMACCxControl_SI : 0);
+	}
+
+	/* Only the end of reception interrupts, the last frame is off the bus by then */
+	pQueue->rxDesc[i - 1].ctrl |= GPDMA_DMACCxControl_I;
+
+	/* Stale frames would shift the received data */
+	Chip_SSP_Int_FlushData(pSSP);
+	Chip_SSP_DMA_Enable(pSSP);
+
+	if (pXfer->csPort != SSP_XFER_NO_CS) {
+		Chip_GPIO_SetPinState(LPC_GPIO_PORT, pXfer->csPort, pXfer->csPin, false);
+	}
+
+	/* Receive channel first, so it is ready for the first frame */
+	if ((Chip_GPDMA_SGTransferPeripheral(pQueue->pGPDMA, pQueue->rxChannel, pQueue->rxConn, &pQueue->rxDesc[0],
+										 GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR) ||
+		(Chip_GPDMA_SGTransferPeripheral(pQueue->pGPDMA, pQueue->txChannel, pQueue->txConn, &pQueue->txDesc[0],
+										 GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == ERROR)) {
+		Chip_GPDMA_ChannelCmd(pQueue->pGPDMA, pQueue->rxChannel, DISABLE);
+		if (pXfer->csPort != SSP_XFER_NO_CS) {
+			Chip_GPIO_SetPinState(LPC_GPIO_PORT, pXfer->csPort, pXfer->csPin, true);
+		}
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
 STATIC void SSP_Write2BFifo(LPC_SSP_T *pSSP, Chip_SSP_DATA_SETUP_T *xf_setup)
 {
 	if (xf_setup->tx_data) {
@@ -116,6 +181,17 @@ STATIC CHIP_CCU_CLK_T Chip_SSP_GetClockIndex(LPC_SSP_T *pSSP)
 	return clkSSP;
 }
 
+/* Free running count of the frames the receive DMA has stored */
+STATIC uint32_t SSP_Stream_RxWritten(SSP_STREAM_T *pStream)
+{
+	uint32_t half = pStream->frames >> 1;
+	uint32_t halves = pStream->rxHalves;
+	uint32_t pos = (pStream->pGPDMA->CH[pStream->rxChannel].DESTADDR - (uint32_t) pStream->pRxRing) >> pStream->width;
+
+	/* The position may be a half ahead while the half interrupt is pending */
+	return (halves * half) + ((pos + pStream->frames - ((halves & 1) * half)) % pStream->frames);
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -450,3 +526,288 @@ void Chip_SSP_DeInit(LPC_SSP_T *pSSP)
 	Chip_Clock_Disable(Chip_SSP_GetClockIndex(pSSP));
 }
 
+/* Initialize an SSP DMA transaction queue */
+void Chip_SSP_DMA_QueueInit(SSP_DMA_QUEUE_T *pQueue, LPC_SSP_T *pSSP, LPC_GPDMA_T *pGPDMA,
+							uint32_t rxConn, uint32_t txConn)
+{
+	pQueue->pSSP = pSSP;
+	pQueue->pGPDMA = pGPDMA;
+	pQueue->rxConn = rxConn;
+	pQueue->txConn = txConn;
+	pQueue->rxChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, rxConn);
+	pQueue->txChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, txConn);
+	pQueue->txDummy = 0xFFFF;
+	pQueue->bitRate = 0;
+	pQueue->pHead = pQueue->pTail = NULL;
+
+	Chip_SSP_Enable(pSSP);
+}
+
+/* Queue an SSP DMA transaction */
+Status Chip_SSP_DMA_Submit(SSP_DMA_QUEUE_T *pQueue, SSP_XFER_T *pXfer)
+{
+	Status ret = SUCCESS;
+	uint32_t primask;
+
+	if ((pXfer->frames == 0) || (pXfer->frames > (SSP_DMA_DESCRIPTORS * 0xFFF))) {
+		return ERROR;
+	}
+	pXfer->pNext = NULL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (pQueue->pHead == NULL) {
+		/* Idle, straight on the bus */
+		ret = SSP_DMA_Start(pQueue, pXfer);
+		if (ret == SUCCESS) {
+			pQueue->pHead = pQueue->pTail = pXfer;
+		}
+	}
+	else {
+		pQueue->pTail->pNext = pXfer;
+		pQueue->pTail = pXfer;
+	}
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+/* GPDMA interrupt handler for an SSP DMA transaction queue */
+bool Chip_SSP_DMA_IRQHandler(SSP_DMA_QUEUE_T *pQueue)
+{
+	SSP_XFER_T *pDone, *pFailed = NULL, *pXfer;
+	Status status;
+	uint32_t primask;
+
+	if (Chip_GPDMA_IntGetStatus(pQueue->pGPDMA, GPDMA_STAT_INT, pQueue->rxChannel)) {
+		status = Chip_GPDMA_Interrupt(pQueue->pGPDMA, pQueue->rxChannel);
+	}
+	else if (Chip_GPDMA_IntGetStatus(pQueue->pGPDMA, GPDMA_STAT_INT, pQueue->txChannel)) {
+		/* Transmission only interrupts on a bus error, reception would never end */
+		Chip_GPDMA_Interrupt(pQueue->pGPDMA, pQueue->txChannel);
+		status = ERROR;
+	}
+	else {
+		return false;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	pDone = pQueue->pHead;
+	if (pDone == NULL) {
+		__set_PRIMASK(primask);
+		return true;
+	}
+
+	if (status == ERROR) {
+		Chip_GPDMA_ChannelCmd(pQueue->pGPDMA, pQueue->rxChannel, DISABLE);
+		Chip_GPDMA_ChannelCmd(pQueue->pGPDMA, pQueue->txChannel, DISABLE);
+		Chip_GPDMA_ClearIntPending(pQueue->pGPDMA, GPDMA_STATCLR_INTTC, pQueue->rxChannel);
+		Chip_GPDMA_ClearIntPending(pQueue->pGPDMA, GPDMA_STATCLR_INTERR, pQueue->rxChannel);
+		Chip_GPDMA_ClearIntPending(pQueue->pGPDMA, GPDMA_STATCLR_INTERR, pQueue->txChannel);
+	}
+	if (pDone->csPort != SSP_XFER_NO_CS) {
+		Chip_GPIO_SetPinState(LPC_GPIO_PORT, pDone->csPort, pDone->csPin, true);
+	}
+
+	/* Back to back, the next transaction goes on the bus before any callback runs */
+	pQueue->pHead = pDone->pNext;
+	while ((pQueue->pHead != NULL) && (SSP_DMA_Start(pQueue, pQueue->pHead) == ERROR)) {
+		pXfer = pQueue->pHead;
+		pQueue->pHead = pXfer->pNext;
+		pXfer->pNext = pFailed;
+		pFailed = pXfer;
+	}
+	__set_PRIMASK(primask);
+
+	if (pDone->callback) {
+		pDone->callback(pDone, status);
+	}
+	while (pFailed != NULL) {
+		pXfer = pFailed;
+		pFailed = pXfer->pNext;
+		if (pXfer->callback) {
+			pXfer->callback(pXfer, ERROR);
+		}
+	}
+
+	return true;
+}
+
+/* Set up SSP slave streaming into circular DMA rings */
+Status Chip_SSP_Stream_Init(SSP_STREAM_T *pStream, LPC_SSP_T *pSSP, LPC_GPDMA_T *pGPDMA,
+							uint32_t rxConn, uint32_t txConn, void *pRxRing, const void *pTxRing,
+							uint32_t frames, SSP_STREAM_CALLBACK_T callback)
+{
+	uint32_t half = frames >> 1;
+	uint32_t ctrl;
+	int i;
+
+	if ((frames < 2) || (frames & 1) || (half > 0xFFF)) {
+		return ERROR;
+	}
+
+	pStream->pSSP = pSSP;
+	pStream->pGPDMA = pGPDMA;
+	pStream->rxConn = rxConn;
+	pStream->txConn = txConn;
+	pStream->width = (Chip_SSP_GetDataSize(pSSP) > SSP_BITS_8) ? GPDMA_WIDTH_HALFWORD : GPDMA_WIDTH_BYTE;
+	pStream->pRxRing = pRxRing;
+	pStream->pTxRing = pTxRing;
+	pStream->frames = frames;
+	pStream->callback = callback;
+	pStream->overruns = 0;
+	pStream->errors = 0;
+
+	pStream->rxChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, rxConn);
+	pStream->txChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, txConn);
+	if ((pStream->rxChannel >= GPDMA_NUMBER_CHANNELS) || (pStream->txChannel >= GPDMA_NUMBER_CHANNELS)) {
+		return ERROR;
+	}
+
+	/* Each ring is two linked halves, only the receive halves interrupt */
+	ctrl = GPDMA_DMACCxControl_TransferSize(half) |
+		   GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_4) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_4) |
+		   GPDMA_DMACCxControl_SWidth(pStream->width) | GPDMA_DMACCxControl_DWidth(pStream->width);
+	for (i = 0; i < 2; i++) {
+		pStream->rxDesc[i].src = (uint32_t) &pSSP->DR;
+		pStream->rxDesc[i].dst = (uint32_t) pRxRing + ((i * half) << pStream->width);
+		pStream->rxDesc[i].lli = (uint32_t) &pStream->rxDesc[i ^ 1];
+		pStream->rxDesc[i].ctrl = ctrl | GPDMA_DMACCxControl_SrcTransUseAHBMaster1 |
+								  GPDMA_DMACCxControl_DI | GPDMA_DMACCxControl_I;
+
+		pStream->txDesc[i].src = (uint32_t) pTxRing + ((i * half) << pStream->width);
+		pStream->txDesc[i].dst = (uint32_t) &pSSP->DR;
+		pStream->txDesc[i].lli = (uint32_t) &pStream->txDesc[i ^ 1];
+		pStream->txDesc[i].ctrl = ctrl | GPDMA_DMACCxControl_DestTransUseAHBMaster1 | GPDMA_DMACCxControl_SI;
+	}
+
+	return SUCCESS;
+}
+
+/* Start SSP slave streaming */
+Status Chip_SSP_Stream_Start(SSP_STREAM_T *pStream)
+{
+	LPC_SSP_T *pSSP = pStream->pSSP;
+
+	pStream->rxHalves = 0;
+	pStream->rxRead = 0;
+	pStream->frameStart = 0;
+	pStream->frameCount = 0;
+
+	/* Stale frames would shift the received data */
+	Chip_SSP_Disable(pSSP);
+	Chip_SSP_Int_FlushData(pSSP);
+	Chip_SSP_DMA_Enable(pSSP);
+
+	if ((Chip_GPDMA_SGTransferPeripheral(pStream->pGPDMA, pStream->rxChannel, pStream->rxConn, &pStream->rxDesc[0],
+										 GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR) ||
+		(Chip_GPDMA_SGTransferPeripheral(pStream->pGPDMA, pStream->txChannel, pStream->txConn, &pStream->txDesc[0],
+										 GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == ERROR)) {
+		Chip_GPDMA_ChannelCmd(pStream->pGPDMA, pStream->rxChannel, DISABLE);
+		Chip_SSP_DMA_Disable(pSSP);
+		return ERROR;
+	}
+
+	/* The transmit FIFO is primed before the master can clock */
+	Chip_SSP_Enable(pSSP);
+
+	return SUCCESS;
+}
+
+/* Stop SSP slave streaming */
+void Chip_SSP_Stream_Stop(SSP_STREAM_T *pStream)
+{
+	Chip_SSP_Disable(pStream->pSSP);
+	Chip_SSP_DMA_Disable(pStream->pSSP);
+	Chip_GPDMA_ChannelCmd(pStream->pGPDMA, pStream->rxChannel, DISABLE);
+	Chip_GPDMA_ChannelCmd(pStream->pGPDMA, pStream->txChannel, DISABLE);
+	Chip_GPDMA_ClearIntPending(pStream->pGPDMA, GPDMA_STATCLR_INTTC, pStream->rxChannel);
+	Chip_GPDMA_ClearIntPending(pStream->pGPDMA, GPDMA_STATCLR_INTERR, pStream->rxChannel);
+	Chip_GPDMA_ClearIntPending(pStream->pGPDMA, GPDMA_STATCLR_INTERR, pStream->txChannel);
+}
+
+/* Get the received frames not consumed yet */
+uint32_t Chip_SSP_Stream_RxData(SSP_STREAM_T *pStream, void **ppData)
+{
+	uint32_t read = pStream->rxRead;
+	uint32_t index = read % pStream->frames;
+	uint32_t count = SSP_Stream_RxWritten(pStream) - read;
+
+	*ppData = (void *) ((uint32_t) pStream->pRxRing + (index << pStream->width));
+
+	return MIN(count, pStream->frames - index);
+}
+
+/* Release consumed receive frames */
+void Chip_SSP_Stream_RxRelease(SSP_STREAM_T *pStream, uint32_t frames)
+{
+	uint32_t primask;
+
+	/* The overrun resync moves the read index too */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	pStream->rxRead += frames;
+	__set_PRIMASK(primask);
+}
+
+/* Get the transmit ring position */
+uint32_t Chip_SSP_Stream_TxPosition(SSP_STREAM_T *pStream)
+{
+	uint32_t pos = (pStream->pGPDMA->CH[pStream->txChannel].SRCADDR - (uint32_t) pStream->pTxRing) >> pStream->width;
+
+	return pos % pStream->frames;
+}
+
+/* Chip select deassert handler for SSP slave streaming */
+void Chip_SSP_Stream_FrameEnd(SSP_STREAM_T *pStream)
+{
+	uint32_t end, first, spin = 0xFFFF;
+
+	/* Let single requests drain the last frames the FIFO holds */
+	while (Chip_SSP_GetStatus(pStream->pSSP, SSP_STAT_RNE) && (--spin != 0)) {}
+
+	end = SSP_Stream_RxWritten(pStream);
+	first = pStream->frameStart;
+	pStream->frameStart = end;
+	pStream->frameCount++;
+	if (pStream->callback && (end != first)) {
+		pStream->callback(pStream, first, end - first);
+	}
+}
+
+/* GPDMA interrupt handler for SSP slave streaming */
+bool Chip_SSP_Stream_IRQHandler(SSP_STREAM_T *pStream)
+{
+	uint32_t half = pStream->frames >> 1;
+	uint32_t written;
+
+	if (Chip_GPDMA_IntGetStatus(pStream->pGPDMA, GPDMA_STAT_INT, pStream->rxChannel)) {
+		if (Chip_GPDMA_Interrupt(pStream->pGPDMA, pStream->rxChannel) == ERROR) {
+			pStream->errors++;
+			Chip_SSP_Stream_Stop(pStream);
+			return true;
+		}
+	}
+	else if (Chip_GPDMA_IntGetStatus(pStream->pGPDMA, GPDMA_STAT_INT, pStream->txChannel)) {
+		/* Transmission only interrupts on a bus error */
+		Chip_GPDMA_Interrupt(pStream->pGPDMA, pStream->txChannel);
+		pStream->errors++;
+		Chip_SSP_Stream_Stop(pStream);
+		return true;
+	}
+	else {
+		return false;
+	}
+
+	pStream->rxHalves++;
+
+	/* The DMA now fills the half after the completed one, drop what it holds unread */
+	written = pStream->rxHalves * half;
+	if ((written - pStream->rxRead) > half) {
+		pStream->overruns++;
+		pStream->rxRead = written - half;
+	}
+
+	return true;
+}
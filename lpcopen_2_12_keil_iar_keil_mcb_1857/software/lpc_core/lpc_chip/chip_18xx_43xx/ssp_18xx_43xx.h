@@ -587,6 +587,232 @@ void Chip_SSP_SetMaster(LPC_SSP_T *pSSP, bool master);
  */
 void Chip_SSP_SetBitRate(LPC_SSP_T *pSSP, uint32_t bitRate);
 
+/**
+ * @brief DMA descriptors per direction of a transaction queue, each moves up to 4095 frames
+ */
+#ifndef SSP_DMA_DESCRIPTORS
+#define SSP_DMA_DESCRIPTORS     4
+#endif
+
+/**
+ * @brief Chip select port of transactions that do not drive a GPIO chip select
+ */
+#define SSP_XFER_NO_CS          0xFF
+
+struct SSP_XFER;
+
+/**
+ * @brief SSP DMA transaction completion callback, status is ERROR on a DMA bus error
+ */
+typedef void (*SSP_XFER_CALLBACK_T)(struct SSP_XFER *pXfer, Status status);
+
+/**
+ * @brief SSP DMA transaction
+ * Frames of 9 bits or more are 16 bits wide in memory, smaller ones 8 bits.
+ */
+typedef struct SSP_XFER {
+	const void *txData;				/*!< Frames to send, or NULL to send all ones */
+	void *rxData;					/*!< Buffer for the received frames, or NULL to drop them */
+	uint32_t frames;				/*!< Number of frames, up to SSP_DMA_DESCRIPTORS * 4095 */
+	uint32_t bits;					/*!< Frame size, SSP_BITS_4 to SSP_BITS_16 */
+	uint32_t clockMode;				/*!< SPI clock mode, SSP_CLOCK_MODE0 to SSP_CLOCK_MODE3 */
+	uint32_t bitRate;				/*!< SSP clock rate in Hz, 0 keeps the current rate */
+	uint8_t csPort;					/*!< GPIO port of the active low chip select, or SSP_XFER_NO_CS */
+	uint8_t csPin;					/*!< GPIO pin of the chip select */
+	SSP_XFER_CALLBACK_T callback;	/*!< Called from Chip_SSP_DMA_IRQHandler() once done, or NULL */
+	void *pData;					/*!< Free for use by the callback */
+	struct SSP_XFER *pNext;			/*!< Used by the queue */
+} SSP_XFER_T;
+
+/**
+ * @brief SSP DMA transaction queue
+ * Transactions run one after the other in submission order on one SSP in SPI
+ * master mode, using a receive and a transmit GPDMA channel.
+ */
+typedef struct {
+	LPC_SSP_T *pSSP;				/*!< SSP peripheral */
+	LPC_GPDMA_T *pGPDMA;			/*!< GPDMA controller */
+	uint32_t rxConn;				/*!< GPDMA_CONN_SSPn_Rx connection */
+	uint32_t txConn;				/*!< GPDMA_CONN_SSPn_Tx connection */
+	uint8_t rxChannel;				/*!< GPDMA channel used for reception */
+	uint8_t txChannel;				/*!< GPDMA channel used for transmission */
+	uint16_t txDummy;				/*!< Source of the all ones frames */
+	uint16_t rxDummy;				/*!< Sink of the dropped frames */
+	uint32_t bitRate;				/*!< Clock rate last set, 0 when not set */
+	SSP_XFER_T *pHead;				/*!< Transaction on the bus, NULL when idle */
+	SSP_XFER_T *pTail;				/*!< Last queued transaction */
+	DMA_TransferDescriptor_t rxDesc[SSP_DMA_DESCRIPTORS];	/*!< Receive list of the active transaction */
+	DMA_TransferDescriptor_t txDesc[SSP_DMA_DESCRIPTORS];	/*!< Transmit list of the active transaction */
+} SSP_DMA_QUEUE_T;
+
+/**
+ * @brief	Initialize an SSP DMA transaction queue
+ * @param	pQueue	: Queue to initialize
+ * @param	pSSP	: The base SSP peripheral on the chip, already initialized as SPI master
+ * @param	pGPDMA	: The GPDMA controller, already initialized
+ * @param	rxConn	: GPDMA_CONN_SSP0_Rx or GPDMA_CONN_SSP1_Rx
+ * @param	txConn	: GPDMA_CONN_SSP0_Tx or GPDMA_CONN_SSP1_Tx
+ * @return	Nothing
+ * @note	Two GPDMA channels are claimed. Chip select pins must already be
+ *			configured as GPIO outputs, driven high.
+ */
+void Chip_SSP_DMA_QueueInit(SSP_DMA_QUEUE_T *pQueue, LPC_SSP_T *pSSP, LPC_GPDMA_T *pGPDMA,
+							uint32_t rxConn, uint32_t txConn);
+
+/**
+ * @brief	Queue an SSP DMA transaction
+ * @param	pQueue	: Transaction queue
+ * @param	pXfer	: Transaction, must stay valid until its callback
+ * @return	ERROR when the frame count is out of range, SUCCESS otherwise
+ * @note	An idle queue starts the transaction straight away, otherwise it
+ *			is started from Chip_SSP_DMA_IRQHandler() as the one before ends.
+ *			Safe to call from a transaction callback.
+ */
+Status Chip_SSP_DMA_Submit(SSP_DMA_QUEUE_T *pQueue, SSP_XFER_T *pXfer);
+
+/**
+ * @brief	Returns whether an SSP DMA queue has transactions left
+ * @param	pQueue	: Transaction queue
+ * @return	true while a transaction is queued or on the bus
+ */
+STATIC INLINE bool Chip_SSP_DMA_IsBusy(SSP_DMA_QUEUE_T *pQueue)
+{
+	return pQueue->pHead != NULL;
+}
+
+/**
+ * @brief	GPDMA interrupt handler for an SSP DMA transaction queue
+ * @param	pQueue	: Transaction queue
+ * @return	true if one of the queue channels interrupted
+ * @note	Call from DMA_IRQHandler(). The chip select is released, the next
+ *			transaction is put on the bus and then the callback of the one
+ *			that ended runs.
+ */
+bool Chip_SSP_DMA_IRQHandler(SSP_DMA_QUEUE_T *pQueue);
+
+struct SSP_STREAM;
+
+/**
+ * @brief SSP slave stream frame boundary callback
+ * Called from Chip_SSP_Stream_FrameEnd() with the free running index of the
+ * first frame received since the previous chip select deassert and the number
+ * of frames received. The frames are read with Chip_SSP_Stream_RxData().
+ */
+typedef void (*SSP_STREAM_CALLBACK_T)(struct SSP_STREAM *pStream, uint32_t first, uint32_t frames);
+
+/**
+ * @brief SSP slave streaming handle
+ * Both rings are moved by circular GPDMA lists of two halves, so the SSP keeps
+ * up with the master at its maximum slave clock (PCLK / 12) without CPU work.
+ * Frames of 9 bits or more are 16 bits wide in memory, smaller ones 8 bits.
+ */
+typedef struct SSP_STREAM {
+	LPC_SSP_T *pSSP;				/*!< SSP peripheral */
+	LPC_GPDMA_T *pGPDMA;			/*!< GPDMA controller */
+	uint32_t rxConn;				/*!< GPDMA_CONN_SSPn_Rx connection */
+	uint32_t txConn;				/*!< GPDMA_CONN_SSPn_Tx connection */
+	uint8_t rxChannel;				/*!< GPDMA channel used for reception */
+	uint8_t txChannel;				/*!< GPDMA channel used for transmission */
+	uint8_t width;					/*!< GPDMA_WIDTH_BYTE or GPDMA_WIDTH_HALFWORD */
+	void *pRxRing;					/*!< Receive ring */
+	const void *pTxRing;			/*!< Transmit ring, sent over and over */
+	uint32_t frames;				/*!< Frames in each ring */
+	SSP_STREAM_CALLBACK_T callback;	/*!< Frame boundary callback or NULL */
+	void *pData;					/*!< Caller data for the callback */
+	volatile uint32_t rxHalves;		/*!< Receive ring halves completed */
+	volatile uint32_t rxRead;		/*!< Frames consumed, free running */
+	uint32_t frameStart;			/*!< Free running index of the current frame start */
+	uint32_t frameCount;			/*!< Chip select frames ended */
+	uint32_t overruns;				/*!< Receive halves written over before being consumed */
+	uint32_t errors;				/*!< DMA errors, the stream stops on an error */
+	DMA_TransferDescriptor_t rxDesc[2];	/*!< Circular receive list */
+	DMA_TransferDescriptor_t txDesc[2];	/*!< Circular transmit list */
+} SSP_STREAM_T;
+
+/**
+ * @brief	Set up SSP slave streaming into circular DMA rings
+ * @param	pStream		: Stream handle to initialize
+ * @param	pSSP		: The base SSP peripheral on the chip, already initialized
+ *						  as slave with Chip_SSP_SetMaster(false) and its frame format set
+ * @param	pGPDMA		: The GPDMA controller, already initialized
+ * @param	rxConn		: GPDMA_CONN_SSP0_Rx or GPDMA_CONN_SSP1_Rx
+ * @param	txConn		: GPDMA_CONN_SSP0_Tx or GPDMA_CONN_SSP1_Tx
+ * @param	pRxRing		: Receive ring of @a frames frames
+ * @param	pTxRing		: Transmit ring of @a frames frames
+ * @param	frames		: Frames per ring, even and from 2 to 2 * 4095
+ * @param	callback	: Frame boundary callback, may be NULL
+ * @return	SUCCESS, or ERROR if @a frames is out of range or GPDMA channels are missing
+ * @note	Two GPDMA channels are claimed. Call Chip_SSP_Stream_IRQHandler()
+ *			from the DMA interrupt handler.
+ */
+Status Chip_SSP_Stream_Init(SSP_STREAM_T *pStream, LPC_SSP_T *pSSP, LPC_GPDMA_T *pGPDMA,
+							uint32_t rxConn, uint32_t txConn, void *pRxRing, const void *pTxRing,
+							uint32_t frames, SSP_STREAM_CALLBACK_T callback);
+
+/**
+ * @brief	Start SSP slave streaming
+ * @param	pStream		: Stream handle
+ * @return	SUCCESS or ERROR if a DMA channel could not be started
+ * @note	Call with the chip select deasserted. The transmit ring should
+ *			hold the first frames to send, the SSP FIFO fetches up to 8 of
+ *			them ahead of the master clock.
+ */
+Status Chip_SSP_Stream_Start(SSP_STREAM_T *pStream);
+
+/**
+ * @brief	Stop SSP slave streaming
+ * @param	pStream		: Stream handle
+ * @return	Nothing
+ * @note	The GPDMA channels stay claimed for the next Chip_SSP_Stream_Start().
+ */
+void Chip_SSP_Stream_Stop(SSP_STREAM_T *pStream);
+
+/**
+ * @brief	Get the received frames not consumed yet
+ * @param	pStream		: Stream handle
+ * @param	ppData		: Pointer to store the address of the oldest unread frame
+ * @return	Number of contiguous unread frames at *ppData
+ * @note	Frames that wrap round the end of the ring are returned by the
+ *			next call, after Chip_SSP_Stream_RxRelease().
+ */
+uint32_t Chip_SSP_Stream_RxData(SSP_STREAM_T *pStream, void **ppData);
+
+/**
+ * @brief	Release consumed receive frames
+ * @param	pStream		: Stream handle
+ * @param	frames		: Number of frames consumed, as returned by Chip_SSP_Stream_RxData()
+ * @return	Nothing
+ */
+void Chip_SSP_Stream_RxRelease(SSP_STREAM_T *pStream, uint32_t frames);
+
+/**
+ * @brief	Get the transmit ring position
+ * @param	pStream		: Stream handle
+ * @return	Index in the transmit ring of the next frame the DMA moves to the SSP FIFO
+ * @note	Frames behind this index are free to be rewritten.
+ */
+uint32_t Chip_SSP_Stream_TxPosition(SSP_STREAM_T *pStream);
+
+/**
+ * @brief	Chip select deassert handler for SSP slave streaming
+ * @param	pStream		: Stream handle
+ * @return	Nothing
+ * @note	The SSP has no chip select interrupt, the SSEL pad must also be
+ *			routed to a pin interrupt on its rising edge whose handler calls
+ *			this function. The frames still in the receive FIFO are moved
+ *			by the DMA before the callback runs.
+ */
+void Chip_SSP_Stream_FrameEnd(SSP_STREAM_T *pStream);
+
+/**
+ * @brief	GPDMA interrupt handler for SSP slave streaming
+ * @param	pStream		: Stream handle
+ * @return	true if the interrupt was for one of the stream channels
+ * @note	Counts the receive ring halves and the overruns, a half the DMA
+ *			starts writing over while frames in it were not released.
+ */
+bool Chip_SSP_Stream_IRQHandler(SSP_STREAM_T *pStream);
+
 /**
  * @}
  */
@@ -0,0 +1,323 @@
+/*
+ * @brief LPC18xx_43xx 64-bit monotonic time base
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "chip.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+#define TIMEBASE_NS_PER_SEC     1000000000ULL
+#define TIMEBASE_NS_PER_FRAME   1000000LL
+
+/* Piece of the disciplined time scale, ticks past the reference advance at rate per second */
+typedef struct {
+	uint64_t ticks;
+	uint64_t ns;
+	uint32_t rate;
+} TIMEBASE_CAL_T;
+
+/* Pairing of the time base with another clock */
+typedef struct {
+	uint64_t ticks;
+	uint32_t frame;
+	ENET_PTP_TIME_T ptp;
+} TIMEBASE_PAIR_T;
+
+/* Two copies of each published value, the writer fills the one not
+   selected by the sequence count and then advances the count */
+static TIMEBASE_CAL_T cal[2];
+static volatile uint32_t calSeq;
+static TIMEBASE_PAIR_T sof[2];
+static volatile uint32_t sofSeq;
+static TIMEBASE_PAIR_T ptp[2];
+static volatile uint32_t ptpSeq;
+
+static uint32_t nominalRate;
+
+/* RTC window in progress */
+static uint64_t rtcStart;
+static uint32_t rtcSeconds;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+LPC_TIMER_T *g_timebaseTimer;
+volatile uint32_t g_timebaseHalves;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Copy the published slot, again if an update came in meanwhile */
+static void tbRead(const void *pSlots, uint32_t size, volatile uint32_t *pSeq, void *pOut)
+{
+	uint32_t seq;
+
+	do {
+		seq = *pSeq;
+		memcpy(pOut, (const uint8_t *) pSlots + ((seq & 1) * size), size);
+		__DMB();
+	} while (seq != *pSeq);
+}
+
+/* Slot to fill for the next update */
+STATIC INLINE uint32_t tbNextSlot(volatile uint32_t *pSeq)
+{
+	return (*pSeq + 1) & 1;
+}
+
+/* Publish the filled slot */
+STATIC INLINE void tbPublish(volatile uint32_t *pSeq)
+{
+	__DMB();
+	*pSeq = *pSeq + 1;
+}
+
+/* Ticks to nanoseconds at a rate, split so the products stay within 64 bits */
+static uint64_t tbScale(uint64_t ticks, uint32_t rate)
+{
+	return (ticks / rate) * TIMEBASE_NS_PER_SEC + ((ticks % rate) * TIMEBASE_NS_PER_SEC) / rate;
+}
+
+static uint64_t tbTicksToNs(const TIMEBASE_CAL_T *pCal, uint64_t ticks)
+{
+	if (ticks >= pCal->ticks) {
+		return pCal->ns + tbScale(ticks - pCal->ticks, pCal->rate);
+	}
+	return pCal->ns - tbScale(pCal->ticks - ticks, pCal->rate);
+}
+
+/* Signed nanoseconds from a pairing to a tick value */
+static int64_t tbSincePair(const TIMEBASE_PAIR_T *pPair, uint64_t ticks)
+{
+	TIMEBASE_CAL_T c;
+
+	tbRead(cal, sizeof(cal[0]), &calSeq, &c);
+	return (int64_t) (tbTicksToNs(&c, ticks) - tbTicksToNs(&c, pPair->ticks));
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start a timer as the 64-bit time base */
+void Chip_TIMEBASE_Init(LPC_TIMER_T *pTMR, uint32_t prescale)
+{
+	IRQn_Type irq;
+	CHIP_CCU_CLK_T clk;
+
+	if (pTMR == LPC_TIMER0) {
+		irq = TIMER0_IRQn;
+		clk = CLK_MX_TIMER0;
+	}
+	else if (pTMR == LPC_TIMER1) {
+		irq = TIMER1_IRQn;
+		clk = CLK_MX_TIMER1;
+	}
+	else if (pTMR == LPC_TIMER2) {
+		irq = TIMER2_IRQn;
+		clk = CLK_MX_TIMER2;
+	}
+	else {
+		irq = TIMER3_IRQn;
+		clk = CLK_MX_TIMER3;
+	}
+
+	Chip_TIMER_Init(pTMR);
+	Chip_TIMER_Reset(pTMR);
+	Chip_TIMER_PrescaleSet(pTMR, prescale - 1);
+
+	/* Start past 0 so the wrap match does not fire on the first count */
+	pTMR->TC = 1;
+	Chip_TIMER_SetMatch(pTMR, 0, 0);
+	Chip_TIMER_SetMatch(pTMR, 1, 0x80000000);
+	Chip_TIMER_MatchEnableInt(pTMR, 0);
+	Chip_TIMER_MatchEnableInt(pTMR, 1);
+	pTMR->IR = TIMER_IR_CLR(0) | TIMER_IR_CLR(1);
+
+	g_timebaseTimer = pTMR;
+	g_timebaseHalves = 0;
+
+	nominalRate = Chip_Clock_GetRate(clk) / prescale;
+	cal[0].ticks = 0;
+	cal[0].ns = 0;
+	cal[0].rate = nominalRate;
+	calSeq = 0;
+	sofSeq = ptpSeq = 0;
+	sof[0].ticks = sof[1].ticks = 0;
+	ptp[0].ticks = ptp[1].ticks = 0;
+	rtcSeconds = 0;
+
+	NVIC_ClearPendingIRQ(irq);
+	NVIC_EnableIRQ(irq);
+	Chip_TIMER_Enable(pTMR);
+}
+
+/* Time base interrupt handler */
+HOTFUNC void Chip_TIMEBASE_IRQHandler(void)
+{
+	uint32_t ir = g_timebaseTimer->IR & (TIMER_MATCH_INT(0) | TIMER_MATCH_INT(1));
+
+	g_timebaseTimer->IR = ir;
+	if (ir & TIMER_MATCH_INT(0)) {
+		g_timebaseHalves++;
+	}
+	if (ir & TIMER_MATCH_INT(1)) {
+		g_timebaseHalves++;
+	}
+}
+
+/* Get the disciplined time base rate */
+uint32_t Chip_TIMEBASE_GetRate(void)
+{
+	return cal[calSeq & 1].rate;
+}
+
+/* Convert time base ticks to nanoseconds */
+uint64_t Chip_TIMEBASE_TicksToNs(uint64_t ticks)
+{
+	TIMEBASE_CAL_T c;
+
+	tbRead(cal, sizeof(cal[0]), &calSeq, &c);
+	return tbTicksToNs(&c, ticks);
+}
+
+/* Discipline the time base rate against an RTC second */
+void Chip_TIMEBASE_RTCSecond(void)
+{
+	uint64_t now = Chip_TIMEBASE_Now();
+	uint64_t span;
+	uint32_t rate, slot, limit;
+
+	/* The first second only starts the window */
+	if (rtcSeconds++ == 0) {
+		rtcStart = now;
+		return;
+	}
+	if (rtcSeconds <= TIMEBASE_RTC_WINDOW) {
+		return;
+	}
+
+	span = now - rtcStart;
+	rate = (uint32_t) (span / TIMEBASE_RTC_WINDOW);
+	rtcStart = now;
+	rtcSeconds = 1;
+
+	limit = (uint32_t) (((uint64_t) nominalRate * TIMEBASE_RTC_MAX_PPM) / 1000000);
+	if ((rate > (nominalRate + limit)) || (rate < (nominalRate - limit))) {
+		return;
+	}
+
+	/* Continue from the time reached so far, only the rate changes */
+	slot = tbNextSlot(&calSeq);
+	cal[slot].ns = tbTicksToNs(&cal[calSeq & 1], now);
+	cal[slot].ticks = now;
+	cal[slot].rate = rate;
+	tbPublish(&calSeq);
+}
+
+/* Pair a USB frame number with the time base */
+void Chip_TIMEBASE_SOFStamp(uint32_t frame)
+{
+	uint32_t slot = tbNextSlot(&sofSeq);
+
+	sof[slot].ticks = Chip_TIMEBASE_Now();
+	sof[slot].frame = frame & TIMEBASE_SOF_FRAME_MASK;
+	tbPublish(&sofSeq);
+}
+
+/* Map time base ticks onto the USB frame numbering */
+uint32_t Chip_TIMEBASE_TicksToSOF(uint64_t ticks, uint32_t *pOffsetUs)
+{
+	TIMEBASE_PAIR_T pair;
+	int64_t ns, frames;
+
+	if (sofSeq == 0) {
+		return 0xFFFFFFFF;
+	}
+	tbRead(sof, sizeof(sof[0]), &sofSeq, &pair);
+
+	ns = tbSincePair(&pair, ticks);
+	frames = ns / TIMEBASE_NS_PER_FRAME;
+	ns -= frames * TIMEBASE_NS_PER_FRAME;
+	if (ns < 0) {
+		ns += TIMEBASE_NS_PER_FRAME;
+		frames--;
+	}
+
+	if (pOffsetUs != NULL) {
+		*pOffsetUs = (uint32_t) (ns / 1000);
+	}
+	return (uint32_t) (pair.frame + frames) & TIMEBASE_SOF_FRAME_MASK;
+}
+
+/* Pair the ENET PTP system time with the time base */
+void Chip_TIMEBASE_PTPCrossStamp(LPC_ENET_T *pENET)
+{
+	ENET_PTP_XSTAMP_T xstamp;
+	uint64_t now;
+	uint32_t slot = tbNextSlot(&ptpSeq);
+
+	Chip_ENET_PTP_CrossStamp(pENET, &g_timebaseTimer->TC, &xstamp);
+	now = Chip_TIMEBASE_Now();
+
+	/* Extend the 32-bit counter value of the pairing back from the current time */
+	ptp[slot].ticks = now - (uint32_t) ((uint32_t) now - xstamp.ticks);
+	ptp[slot].ptp = xstamp.time;
+	tbPublish(&ptpSeq);
+}
+
+/* Convert time base ticks to PTP time */
+bool Chip_TIMEBASE_TicksToPTP(uint64_t ticks, ENET_PTP_TIME_T *pTime)
+{
+	TIMEBASE_PAIR_T pair;
+	int64_t ns, sec;
+
+	if (ptpSeq == 0) {
+		return false;
+	}
+	tbRead(ptp, sizeof(ptp[0]), &ptpSeq, &pair);
+
+	ns = (int64_t) pair.ptp.nsec + tbSincePair(&pair, ticks);
+	sec = ns / (int64_t) TIMEBASE_NS_PER_SEC;
+	ns -= sec * (int64_t) TIMEBASE_NS_PER_SEC;
+	if (ns < 0) {
+		ns += TIMEBASE_NS_PER_SEC;
+		sec--;
+	}
+	pTime->sec = (uint32_t) ((int64_t) pair.ptp.sec + sec);
+	pTime->nsec = (uint32_t) ns;
+
+	return true;
+}
@@ -0,0 +1,191 @@
+/*
+ * @brief LPC18xx_43xx 64-bit monotonic time base
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __TIMEBASE_18XX_43XX_H_
+#define __TIMEBASE_18XX_43XX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup TIMEBASE_18XX_43XX CHIP: LPC18XX_43XX 64-bit monotonic time base
+ *
+ * The time base extends a free running 32-bit timer to 64 bits. Match 0
+ * (counter at 0) and match 1 (counter at 0x80000000) interrupt on every
+ * half period and count the halves. Chip_TIMEBASE_Now() reads the half count
+ * and then the counter. When the two disagree on which half the counter is in,
+ * a match interrupt is due but has not run yet, and the count is advanced by
+ * one. Now() never retries and never masks interrupts, so it can be called
+ * from any interrupt priority. This holds as long as the match interrupt is
+ * never held off for a whole half period, which is about 11.9 s at 180 MHz.
+ *
+ * Chip_TIMEBASE_TicksToNs() converts ticks to nanoseconds since
+ * Chip_TIMEBASE_Init(). The rate starts at the nominal timer clock, and
+ * Chip_TIMEBASE_RTCSecond() disciplines it against the RTC. Call it from the
+ * one second counter increment interrupt. Every TIMEBASE_RTC_WINDOW seconds,
+ * the ticks counted over the window become the new rate. Rates more than
+ * TIMEBASE_RTC_MAX_PPM from nominal are rejected as a missed or doubled
+ * second. The time is made continuous at each rate change, so converted times
+ * stay monotonic.
+ *
+ * Chip_TIMEBASE_SOFStamp() pairs a USB frame number with the time base, and
+ * Chip_TIMEBASE_TicksToSOF() maps any later tick value onto the USB frame
+ * numbering. Chip_TIMEBASE_PTPCrossStamp() pairs the ENET PTP system time with
+ * the time base in the same way for Chip_TIMEBASE_TicksToPTP(). The error of
+ * both mappings grows with the drift between the clocks times the age of the
+ * pairing, so pair again regularly.
+ *
+ * Calibration and pairings are published through two slots and a sequence
+ * count. A reader that is interrupted by an update simply reads again, which
+ * cannot livelock because updates only come from interrupts.
+ * @ingroup CHIP_18XX_43XX_Drivers
+ * @{
+ */
+
+/** Seconds of RTC counted before the rate is updated */
+#ifndef TIMEBASE_RTC_WINDOW
+#define TIMEBASE_RTC_WINDOW             16
+#endif
+
+/** Largest accepted deviation of a measured rate from the nominal timer clock, in ppm */
+#ifndef TIMEBASE_RTC_MAX_PPM
+#define TIMEBASE_RTC_MAX_PPM            1000
+#endif
+
+/** USB frame numbers wrap at 2^11 */
+#define TIMEBASE_SOF_FRAME_MASK         0x7FF
+
+/** Timer used by the time base, set by Chip_TIMEBASE_Init() */
+extern LPC_TIMER_T *g_timebaseTimer;
+
+/** Timer half periods elapsed, counted by Chip_TIMEBASE_IRQHandler() */
+extern volatile uint32_t g_timebaseHalves;
+
+/**
+ * @brief	Start a timer as the 64-bit time base
+ * @param	pTMR		: The base of the timer peripheral, LPC_TIMER0 to LPC_TIMER3
+ * @param	prescale	: Timer clock divisor, 1 for the full rate
+ * @return	None
+ * @note	The timer's interrupt is enabled in the NVIC, the application's
+ *          TIMERn_IRQHandler must call Chip_TIMEBASE_IRQHandler(). The time
+ *          base owns the timer, match registers 0 and 1 and its interrupt.
+ */
+void Chip_TIMEBASE_Init(LPC_TIMER_T *pTMR, uint32_t prescale);
+
+/**
+ * @brief	Time base interrupt handler
+ * @return	None
+ */
+HOTFUNC void Chip_TIMEBASE_IRQHandler(void);
+
+/**
+ * @brief	Read the time base
+ * @return	Timer ticks since Chip_TIMEBASE_Init()
+ * @note	Lock-free and safe to call from any interrupt priority.
+ */
+STATIC INLINE uint64_t Chip_TIMEBASE_Now(void)
+{
+	uint32_t halves = g_timebaseHalves;
+	uint32_t count = g_timebaseTimer->TC;
+
+	/* An even count means the lower half is expected, a mismatch is a match interrupt still pending */
+	halves += (halves ^ (count >> 31)) & 1;
+
+	return ((uint64_t) (halves >> 1) << 32) | count;
+}
+
+/**
+ * @brief	Get the disciplined time base rate
+ * @return	Timer ticks per second, measured against the RTC once available
+ */
+uint32_t Chip_TIMEBASE_GetRate(void);
+
+/**
+ * @brief	Convert time base ticks to nanoseconds
+ * @param	ticks	: Value of Chip_TIMEBASE_Now()
+ * @return	Disciplined nanoseconds since Chip_TIMEBASE_Init()
+ * @note	Uses 64-bit divisions, convert stamps in task context when
+ *          interrupt time matters.
+ */
+uint64_t Chip_TIMEBASE_TicksToNs(uint64_t ticks);
+
+/**
+ * @brief	Discipline the time base rate against an RTC second
+ * @return	None
+ * @note	Call from the RTC interrupt on RTC_INT_COUNTER_INCREASE with the
+ *          seconds increment enabled by Chip_RTC_CntIncrIntConfig(), so the
+ *          stamps are taken at a fixed latency after each second boundary.
+ */
+void Chip_TIMEBASE_RTCSecond(void);
+
+/**
+ * @brief	Pair a USB frame number with the time base
+ * @param	frame	: Frame number of the start of frame just received or sent
+ * @return	None
+ * @note	Call from the start of frame interrupt or event. At high speed
+ *          stamp on the first microframe of a frame only.
+ */
+void Chip_TIMEBASE_SOFStamp(uint32_t frame);
+
+/**
+ * @brief	Map time base ticks onto the USB frame numbering
+ * @param	ticks		: Value of Chip_TIMEBASE_Now()
+ * @param	pOffsetUs	: Pointer to store the microseconds since that frame started, or NULL
+ * @return	Frame number the ticks fall in, 0 to TIMEBASE_SOF_FRAME_MASK, or
+ *          0xFFFFFFFF before the first Chip_TIMEBASE_SOFStamp()
+ */
+uint32_t Chip_TIMEBASE_TicksToSOF(uint64_t ticks, uint32_t *pOffsetUs);
+
+/**
+ * @brief	Pair the ENET PTP system time with the time base
+ * @param	pENET	: The base of the ENET peripheral on the chip
+ * @return	None
+ * @note	The PTP time must be running, see Chip_ENET_PTP_Init().
+ */
+void Chip_TIMEBASE_PTPCrossStamp(LPC_ENET_T *pENET);
+
+/**
+ * @brief	Convert time base ticks to PTP time
+ * @param	ticks	: Value of Chip_TIMEBASE_Now()
+ * @param	pTime	: Pointer to store the PTP time
+ * @return	FALSE before the first Chip_TIMEBASE_PTPCrossStamp(), TRUE otherwise
+ */
+bool Chip_TIMEBASE_TicksToPTP(uint64_t ticks, ENET_PTP_TIME_T *pTime);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMEBASE_18XX_43XX_H_ */
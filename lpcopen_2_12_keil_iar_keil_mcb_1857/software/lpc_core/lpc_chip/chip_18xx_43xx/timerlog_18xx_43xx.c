@@ -0,0 +1,184 @@
+/*
+ * @brief LPC18xx_43xx timer capture event logger over GPDMA
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include <string.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* DMA request of match register 0 and 1 of each timer */
+static const uint8_t timerlogConn[4][2] = {
+	{GPDMA_CONN_MAT0_0, GPDMA_CONN_MAT0_1},
+	{GPDMA_CONN_MAT1_0, GPDMA_CONN_MAT1_1},
+	{GPDMA_CONN_MAT2_0, GPDMA_CONN_MAT2_1},
+	{GPDMA_CONN_MAT3_0, GPDMA_CONN_MAT3_1},
+};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static int timerlog_index(LPC_TIMER_T *pTMR)
+{
+	if (pTMR == LPC_TIMER0) {
+		return 0;
+	}
+	if (pTMR == LPC_TIMER1) {
+		return 1;
+	}
+	if (pTMR == LPC_TIMER2) {
+		return 2;
+	}
+	if (pTMR == LPC_TIMER3) {
+		return 3;
+	}
+	return -1;
+}
+
+/* Entry the DMA writes next, from the channel's destination address */
+static uint32_t timerlog_write_index(TIMERLOG_T *pLog)
+{
+	uint32_t wr;
+
+	wr = (LPC_GPDMA->CH[pLog->dmaCh].DESTADDR - (uint32_t) pLog->pBuf) / sizeof(uint32_t);
+
+	/* the end address is seen for a moment before the next descriptor loads */
+	return (wr >= pLog->count) ? 0 : wr;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start logging input edges */
+Status Chip_TIMERLOG_Start(TIMERLOG_T *pLog, LPC_TIMER_T *pReqTimer, uint8_t capIn,
+						   TIMER_CAP_SRC_STATE_T edge, int8_t matchnum, uint32_t divide,
+						   volatile uint32_t *pSource, uint32_t *pBuf, uint32_t count)
+{
+	int tmr = timerlog_index(pReqTimer);
+	uint32_t i, n, left, conn;
+
+	if ((tmr < 0) || (matchnum < 0) || (matchnum > 1) || (divide == 0) || (edge == TIMER_CAPSRC_RISING_PCLK) ||
+		(count == 0) || (count > (TIMERLOG_MAX_DESC * TIMERLOG_DESC_ENTRIES)) || (((uint32_t) pBuf & 3) != 0)) {
+		return ERROR;
+	}
+	conn = timerlogConn[tmr][matchnum];
+
+	memset(pLog, 0, sizeof(*pLog));
+	pLog->pReqTimer = pReqTimer;
+	pLog->pBuf = pBuf;
+	pLog->count = count;
+	pLog->dmaCh = Chip_GPDMA_GetPriorityChannel(LPC_GPDMA, conn, GPDMA_PRIO_REALTIME, false);
+	if (pLog->dmaCh == GPDMA_NO_CHANNEL) {
+		return ERROR;
+	}
+
+	/* Counter mode on the input edges, the match raises the request and
+	   restarts the count, as in the periph_dma_timertrig example */
+	Chip_TIMER_Init(pReqTimer);
+	Chip_TIMER_Disable(pReqTimer);
+	Chip_TIMER_Reset(pReqTimer);
+	pReqTimer->MCR = 0;
+	Chip_TIMER_TIMER_SetCountClockSrc(pReqTimer, edge, capIn);
+	Chip_TIMER_PrescaleSet(pReqTimer, 0);
+	Chip_TIMER_SetMatch(pReqTimer, matchnum, divide);
+	Chip_TIMER_ResetOnMatchEnable(pReqTimer, matchnum);
+
+	/* One word per request from the fixed source register into the buffer,
+	   the last descriptor links back to the first, no interrupts */
+	n = (count + TIMERLOG_DESC_ENTRIES - 1) / TIMERLOG_DESC_ENTRIES;
+	left = count;
+	for (i = 0; i < n; i++) {
+		uint32_t entries = MIN(left, TIMERLOG_DESC_ENTRIES);
+
+		pLog->desc[i].src = (uint32_t) pSource;
+		pLog->desc[i].dst = (uint32_t) &pBuf[count - left];
+		pLog->desc[i].lli = (uint32_t) &pLog->desc[(i + 1) % n];
+		pLog->desc[i].ctrl = GPDMA_DMACCxControl_TransferSize(entries)
+							 | GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1)
+							 | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1)
+							 | GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD)
+							 | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD)
+							 | GPDMA_DMACCxControl_SrcTransUseAHBMaster1
+							 | GPDMA_DMACCxControl_DI;
+		left -= entries;
+	}
+
+	/* a stale match flag would raise a request before the first edge */
+	Chip_TIMER_ClearMatch(pReqTimer, matchnum);
+	if (Chip_GPDMA_SGTransferPeripheral(LPC_GPDMA, pLog->dmaCh, conn, &pLog->desc[0],
+										GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR) {
+		Chip_GPDMA_Stop(LPC_GPDMA, pLog->dmaCh);
+		pLog->dmaCh = GPDMA_NO_CHANNEL;
+		return ERROR;
+	}
+	Chip_TIMER_Enable(pReqTimer);
+
+	return SUCCESS;
+}
+
+/* Stop logging and release the DMA channel */
+void Chip_TIMERLOG_Stop(TIMERLOG_T *pLog)
+{
+	if (pLog->dmaCh != GPDMA_NO_CHANNEL) {
+		Chip_TIMER_Disable(pLog->pReqTimer);
+		Chip_GPDMA_Stop(LPC_GPDMA, pLog->dmaCh);
+		pLog->wr = timerlog_write_index(pLog);
+		pLog->dmaCh = GPDMA_NO_CHANNEL;
+	}
+}
+
+/* Get the number of entries waiting to be read */
+uint32_t Chip_TIMERLOG_Available(TIMERLOG_T *pLog)
+{
+	uint32_t wr = (pLog->dmaCh == GPDMA_NO_CHANNEL) ? pLog->wr : timerlog_write_index(pLog);
+
+	return (wr >= pLog->rd) ? (wr - pLog->rd) : (wr + pLog->count - pLog->rd);
+}
+
+/* Read logged entries, oldest first */
+uint32_t Chip_TIMERLOG_Read(TIMERLOG_T *pLog, uint32_t *pDst, uint32_t max)
+{
+	uint32_t n = MIN(Chip_TIMERLOG_Available(pLog), max);
+	uint32_t first = MIN(n, pLog->count - pLog->rd);
+
+	memcpy(pDst, &pLog->pBuf[pLog->rd], first * sizeof(uint32_t));
+	memcpy(&pDst[first], pLog->pBuf, (n - first) * sizeof(uint32_t));
+	pLog->rd = (pLog->rd + n) % pLog->count;
+
+	return n;
+}
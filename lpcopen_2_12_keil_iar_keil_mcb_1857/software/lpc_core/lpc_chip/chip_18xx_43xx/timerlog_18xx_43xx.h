@@ -0,0 +1,130 @@
+/*
+ * @brief LPC18xx_43xx timer capture event logger over GPDMA
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __TIMERLOG_18XX_43XX_H_
+#define __TIMERLOG_18XX_43XX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup TIMERLOG_18XX_43XX CHIP: LPC18xx/43xx timer capture event logger
+ * @ingroup TIMER_18XX_43XX
+ * Logs input edges into a circular buffer by GPDMA, with no interrupt per
+ * edge. The DMA request multiplexer has no timer capture requests, so a
+ * request timer runs in counter mode on the input as the
+ * periph_dma_timertrig example does: it counts edges on one of its CAPn.x
+ * inputs and its match register 0 or 1, set to the edge divider and reset
+ * on match, raises a MATn.m DMA request every divider edges. Each request
+ * copies one word from a source register into the next buffer entry.
+ *
+ * The source is typically a capture register of a second, free running
+ * timer whose capture input sees the same edge (route it there through
+ * GIMA), which gives the exact edge time, or that timer's TC, which adds
+ * the DMA request latency. Encoder and frequency inputs can be logged at
+ * hundreds of kHz this way, the reader only has to keep up with the buffer.
+ * @{
+ */
+
+/** Buffer entries one descriptor covers (GPDMA transfer size field) */
+#define TIMERLOG_DESC_ENTRIES   4095
+
+/** Descriptors in the circular list, the buffer is at most 4 * 4095 entries */
+#define TIMERLOG_MAX_DESC       4
+
+/**
+ * @brief Timer capture logger, storage is owned by the caller
+ */
+typedef struct {
+	LPC_TIMER_T *pReqTimer;				/*!< Counter mode timer raising the DMA requests */
+	uint32_t *pBuf;						/*!< Circular log buffer */
+	uint32_t count;						/*!< Entries in pBuf */
+	uint32_t rd;						/*!< Next entry to read */
+	uint32_t wr;						/*!< Next entry written, latched by Chip_TIMERLOG_Stop() */
+	uint8_t dmaCh;						/*!< GPDMA channel, GPDMA_NO_CHANNEL when stopped */
+	DMA_TransferDescriptor_t desc[TIMERLOG_MAX_DESC];	/*!< Circular descriptor list */
+} TIMERLOG_T;
+
+/**
+ * @brief	Start logging input edges
+ * @param	pLog		: Logger storage
+ * @param	pReqTimer	: Timer counting the edges, LPC_TIMER0 to LPC_TIMER3
+ * @param	capIn		: CAPn.x input of @a pReqTimer the edges come in on
+ * @param	edge		: TIMER_CAPSRC_RISING_CAPN, TIMER_CAPSRC_FALLING_CAPN or TIMER_CAPSRC_BOTH_CAPN
+ * @param	matchnum	: Match register of @a pReqTimer raising the request, 0 or 1
+ * @param	divide		: Log every @a divide edges, at least 1
+ * @param	pSource		: Register copied on each request
+ * @param	pBuf		: Log buffer, word aligned
+ * @param	count		: Entries in @a pBuf, 1 to TIMERLOG_MAX_DESC * TIMERLOG_DESC_ENTRIES
+ * @return	ERROR on a bad parameter or when no DMA channel is free, SUCCESS otherwise
+ * @note	Chip_GPDMA_Init() must have been called. The channel comes from
+ *			the GPDMA_PRIO_REALTIME class. The source timer, its capture
+ *			edge and the pin muxing are set up by the caller.
+ */
+Status Chip_TIMERLOG_Start(TIMERLOG_T *pLog, LPC_TIMER_T *pReqTimer, uint8_t capIn,
+						   TIMER_CAP_SRC_STATE_T edge, int8_t matchnum, uint32_t divide,
+						   volatile uint32_t *pSource, uint32_t *pBuf, uint32_t count);
+
+/**
+ * @brief	Stop logging and release the DMA channel
+ * @param	pLog	: Logger started with Chip_TIMERLOG_Start()
+ * @return	Nothing
+ * @note	Entries logged so far can still be read.
+ */
+void Chip_TIMERLOG_Stop(TIMERLOG_T *pLog);
+
+/**
+ * @brief	Get the number of entries waiting to be read
+ * @param	pLog	: Logger started with Chip_TIMERLOG_Start()
+ * @return	Entries logged since the last read
+ * @note	The DMA keeps writing round the buffer, entries not read within
+ *			one buffer length are overwritten without notice.
+ */
+uint32_t Chip_TIMERLOG_Available(TIMERLOG_T *pLog);
+
+/**
+ * @brief	Read logged entries, oldest first
+ * @param	pLog	: Logger started with Chip_TIMERLOG_Start()
+ * @param	pDst	: Where the entries are copied
+ * @param	max		: Maximum number of entries to copy
+ * @return	Number of entries copied
+ */
+uint32_t Chip_TIMERLOG_Read(TIMERLOG_T *pLog, uint32_t *pDst, uint32_t max);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMERLOG_18XX_43XX_H_ */
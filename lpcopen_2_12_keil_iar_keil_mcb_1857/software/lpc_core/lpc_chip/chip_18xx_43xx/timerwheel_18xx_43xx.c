@@ -0,0 +1,441 @@
+/*
+ * @brief LPC18xx_43xx RITimer driven software timer wheel
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include <string.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Internal timer state in CHIP_TWHEEL_TIMER_T.flags */
+#define TWHEEL_ACTIVE           (1 << 4)	/* linked in the wheel */
+#define TWHEEL_PENDING          (1 << 5)	/* deferred callback wanted */
+#define TWHEEL_QUEUED           (1 << 6)	/* linked in the deferred list */
+
+/* CHIP_TWHEEL_TIMER_T.level of a timer taken off its slot for expiry */
+#define TWHEEL_DETACHED         0xFF
+
+#define TWHEEL_SLOT_MASK        (TWHEEL_SLOTS - 1)
+#define TWHEEL_SHIFT(l)         ((l) * TWHEEL_SLOT_BITS)
+#define TWHEEL_RANGE            (1UL << TWHEEL_SHIFT(TWHEEL_LEVELS))
+
+/* Longest compare distance programmed, keeps the compare value well ahead
+   of the free running counter */
+#define TWHEEL_MAX_CYCLES       0x7FFFFFFFUL
+
+typedef struct {
+	CHIP_TWHEEL_TIMER_T *slot[TWHEEL_LEVELS][TWHEEL_SLOTS];
+	uint32_t map[TWHEEL_LEVELS];	/* non-empty slots per level */
+	uint32_t now;					/* wheel tick processed last */
+	uint32_t lastCycles;			/* RITimer count at the start of tick 'now' */
+	uint32_t carry;					/* whole ticks counted before a clock change */
+	uint32_t cyclesPerTick;
+	uint32_t tickUs;
+	CHIP_TWHEEL_TIMER_T *pendHead;	/* expired deferred timers, oldest first */
+	CHIP_TWHEEL_TIMER_T *pendTail;
+	CHIP_DVFS_NOTIFIER_T dvfs;
+} TWHEEL_T;
+
+static TWHEEL_T wheel;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Index of the lowest set bit, value must not be 0 */
+STATIC INLINE uint32_t twheel_ffs(uint32_t value)
+{
+	return __CLZ(__RBIT(value));
+}
+
+/* Rotate the slot bitmap so slot n becomes bit 0 */
+STATIC INLINE uint32_t twheel_ror(uint32_t map, uint32_t n)
+{
+	n &= TWHEEL_SLOT_MASK;
+	return (n == 0) ? map : ((map >> n) | (map << (32 - n)));
+}
+
+/* True if no timer is linked in the wheel */
+STATIC INLINE bool twheel_empty(void)
+{
+	uint32_t l, map = 0;
+
+	for (l = 0; l < TWHEEL_LEVELS; l++) {
+		map |= wheel.map[l];
+	}
+	return map == 0;
+}
+
+static void twheel_calc_rate(void)
+{
+	wheel.cyclesPerTick = (uint32_t) (((uint64_t) Chip_Clock_GetRate(CLK_MX_RITIMER) * wheel.tickUs) / 1000000);
+	if (wheel.cyclesPerTick == 0) {
+		wheel.cyclesPerTick = 1;
+	}
+}
+
+/* Whole ticks elapsed since tick 'now' started, unprocessed */
+static HOTFUNC uint32_t twheel_elapsed(void)
+{
+	return wheel.carry + ((Chip_RIT_GetCounter(LPC_RITIMER) - wheel.lastCycles) / wheel.cyclesPerTick);
+}
+
+/* Link a timer into the slot of its level for its expiry, relative to the
+   wheel tick 'now'. A level n timer is moved down when the wheel reaches the
+   start of its slot. Timeouts beyond the wheel range wait in the furthest
+   top level slot and are placed again when it comes up. */
+static HOTFUNC void twheel_link(CHIP_TWHEEL_TIMER_T *pTimer)
+{
+	uint32_t delta = pTimer->expires - wheel.now;
+	uint32_t at = pTimer->expires;
+	uint32_t l;
+	CHIP_TWHEEL_TIMER_T **pHead;
+
+	for (l = 0; l < (TWHEEL_LEVELS - 1); l++) {
+		if (delta < (1UL << TWHEEL_SHIFT(l + 1))) {
+			break;
+		}
+	}
+	if (delta >= TWHEEL_RANGE) {
+		at = wheel.now + TWHEEL_RANGE - 1;
+	}
+	pTimer->level = (uint8_t) l;
+	pTimer->slot = (uint8_t) ((at >> TWHEEL_SHIFT(l)) & TWHEEL_SLOT_MASK);
+
+	pHead = &wheel.slot[l][pTimer->slot];
+	pTimer->next = *pHead;
+	if (pTimer->next != NULL) {
+		pTimer->next->pprev = &pTimer->next;
+	}
+	pTimer->pprev = pHead;
+	*pHead = pTimer;
+	wheel.map[l] |= 1UL << pTimer->slot;
+}
+
+static HOTFUNC void twheel_unlink(CHIP_TWHEEL_TIMER_T *pTimer)
+{
+	*pTimer->pprev = pTimer->next;
+	if (pTimer->next != NULL) {
+		pTimer->next->pprev = pTimer->pprev;
+	}
+	if ((pTimer->level != TWHEEL_DETACHED) && (wheel.slot[pTimer->level][pTimer->slot] == NULL)) {
+		wheel.map[pTimer->level] &= ~(1UL << pTimer->slot);
+	}
+}
+
+/* Take a whole slot off the wheel. The timers stay doubly linked off pList,
+   so a callback can still stop one of them. */
+static HOTFUNC void twheel_detach(uint32_t l, uint32_t slot, CHIP_TWHEEL_TIMER_T **pList)
+{
+	CHIP_TWHEEL_TIMER_T *pTimer;
+
+	*pList = wheel.slot[l][slot];
+	wheel.slot[l][slot] = NULL;
+	wheel.map[l] &= ~(1UL << slot);
+	if (*pList != NULL) {
+		(*pList)->pprev = pList;
+	}
+	for (pTimer = *pList; pTimer != NULL; pTimer = pTimer->next) {
+		pTimer->level = TWHEEL_DETACHED;
+	}
+}
+
+/* Wheel tick of the next slot holding timers, false if the wheel is empty.
+   Level 0 slots hold the timers of one tick, a higher level slot is due
+   when the wheel reaches its start. */
+static HOTFUNC bool twheel_next(uint32_t *pNext)
+{
+	uint32_t l, cur, d, at, best = 0;
+	bool found = false;
+
+	for (l = 0; l < TWHEEL_LEVELS; l++) {
+		if (wheel.map[l] != 0) {
+			cur = wheel.now >> TWHEEL_SHIFT(l);
+			d = twheel_ffs(twheel_ror(wheel.map[l], cur + 1)) + 1;
+			at = (cur + d) << TWHEEL_SHIFT(l);
+			if (!found || ((at - wheel.now) < (best - wheel.now))) {
+				best = at;
+				found = true;
+			}
+		}
+	}
+	*pNext = best;
+	return found;
+}
+
+/* Expire one timer taken off the wheel */
+static HOTFUNC void twheel_expire(CHIP_TWHEEL_TIMER_T *pTimer)
+{
+	twheel_unlink(pTimer);
+	pTimer->flags &= ~TWHEEL_ACTIVE;
+	if (pTimer->period != 0) {
+		pTimer->expires += pTimer->period;
+		pTimer->flags |= TWHEEL_ACTIVE;
+		twheel_link(pTimer);
+	}
+
+	if (pTimer->flags & TWHEEL_DEFERRED) {
+		if (pTimer->flags & TWHEEL_PENDING) {
+			if (pTimer->overruns < 0xFF) {
+				pTimer->overruns++;
+			}
+		}
+		pTimer->flags |= TWHEEL_PENDING;
+		if (!(pTimer->flags & TWHEEL_QUEUED)) {
+			pTimer->flags |= TWHEEL_QUEUED;
+			pTimer->pendNext = NULL;
+			if (wheel.pendHead == NULL) {
+				wheel.pendHead = pTimer;
+			}
+			else {
+				wheel.pendTail->pendNext = pTimer;
+			}
+			wheel.pendTail = pTimer;
+		}
+	}
+	else {
+		pTimer->callback(pTimer);
+	}
+}
+
+/* Process the wheel at tick 'now': move the higher level slots that start
+   here down, then expire the level 0 slot */
+static HOTFUNC void twheel_process(void)
+{
+	CHIP_TWHEEL_TIMER_T *pList, *pTimer;
+	int l;
+
+	for (l = TWHEEL_LEVELS - 1; l > 0; l--) {
+		if ((wheel.now & ((1UL << TWHEEL_SHIFT(l)) - 1)) == 0) {
+			twheel_detach(l, (wheel.now >> TWHEEL_SHIFT(l)) & TWHEEL_SLOT_MASK, &pList);
+			while ((pTimer = pList) != NULL) {
+				twheel_unlink(pTimer);
+				twheel_link(pTimer);
+			}
+		}
+	}
+
+	twheel_detach(0, wheel.now & TWHEEL_SLOT_MASK, &pList);
+	while (pList != NULL) {
+		twheel_expire(pList);
+	}
+}
+
+/* Set the RITimer compare to the start of the next due tick. A deadline
+   that is already past pends the interrupt instead, the compare only
+   matches on equality. */
+static HOTFUNC void twheel_program(void)
+{
+	uint32_t next, ticks, cycles;
+
+	if (!twheel_next(&next)) {
+		NVIC_DisableIRQ(RITIMER_IRQn);
+		return;
+	}
+
+	ticks = next - wheel.now;
+	ticks = (ticks > wheel.carry) ? (ticks - wheel.carry) : 0;
+	if (ticks > (TWHEEL_MAX_CYCLES / wheel.cyclesPerTick)) {
+		cycles = TWHEEL_MAX_CYCLES;
+	}
+	else {
+		cycles = ticks * wheel.cyclesPerTick;
+	}
+
+	Chip_RIT_SetCOMPVAL(LPC_RITIMER, wheel.lastCycles + cycles);
+	Chip_RIT_ClearInt(LPC_RITIMER);
+	if ((Chip_RIT_GetCounter(LPC_RITIMER) - wheel.lastCycles) >= cycles) {
+		NVIC_SetPendingIRQ(RITIMER_IRQn);
+	}
+	NVIC_EnableIRQ(RITIMER_IRQn);
+}
+
+/* Rescale the tick length when the core clock, and with it the RITimer
+   clock, changes. Ticks counted at the old rate are kept in carry. */
+static void twheel_dvfs_notify(CHIP_DVFS_NOTIFIER_T *pNotifier, CHIP_DVFS_EVENT_T event)
+{
+	uint32_t count;
+
+	if (event == DVFS_POST_CHANGE) {
+		count = Chip_RIT_GetCounter(LPC_RITIMER);
+		wheel.carry += (count - wheel.lastCycles) / wheel.cyclesPerTick;
+		wheel.lastCycles = count;
+		twheel_calc_rate();
+		if (!twheel_empty()) {
+			twheel_program();
+		}
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize the timer wheel and the RITimer */
+void Chip_TWHEEL_Init(uint32_t tickUs)
+{
+	/* the notifier is linked in a list, take it out before clearing it */
+	Chip_DVFS_Unregister(&wheel.dvfs);
+	memset(&wheel, 0, sizeof(wheel));
+	wheel.tickUs = (tickUs == 0) ? 1 : tickUs;
+
+	/* Free running counter, the compare value is moved from deadline to
+	   deadline instead of clearing the counter on a match */
+	Chip_RIT_Init(LPC_RITIMER);
+	twheel_calc_rate();
+	NVIC_DisableIRQ(RITIMER_IRQn);
+	Chip_RIT_ClearInt(LPC_RITIMER);
+	NVIC_ClearPendingIRQ(RITIMER_IRQn);
+
+	wheel.dvfs.notify = twheel_dvfs_notify;
+	Chip_DVFS_Register(&wheel.dvfs);
+}
+
+/* Set up a timer before its first start */
+void Chip_TWHEEL_Setup(CHIP_TWHEEL_TIMER_T *pTimer, CHIP_TWHEEL_CALLBACK_T callback, void *pArg, uint32_t flags)
+{
+	memset(pTimer, 0, sizeof(*pTimer));
+	pTimer->callback = callback;
+	pTimer->pArg = pArg;
+	pTimer->flags = (uint8_t) (flags & TWHEEL_DEFERRED);
+}
+
+/* Start or restart a timer */
+HOTFUNC void Chip_TWHEEL_Start(CHIP_TWHEEL_TIMER_T *pTimer, uint32_t ticks, uint32_t period)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (pTimer->flags & TWHEEL_ACTIVE) {
+		twheel_unlink(pTimer);
+	}
+	/* an idle wheel doesn't follow the counter, pick it up again */
+	else if (twheel_empty()) {
+		wheel.now += twheel_elapsed();
+		wheel.lastCycles = Chip_RIT_GetCounter(LPC_RITIMER);
+		wheel.carry = 0;
+	}
+
+	/* The wheel lags the counter by the ticks not processed yet, the
+	   expiry is taken from the counter so the lag doesn't shorten it */
+	pTimer->expires = wheel.now + twheel_elapsed() + ((ticks == 0) ? 1 : ticks);
+	pTimer->period = period;
+	pTimer->overruns = 0;
+	pTimer->flags = (pTimer->flags & ~TWHEEL_PENDING) | TWHEEL_ACTIVE;
+	twheel_link(pTimer);
+	twheel_program();
+	__set_PRIMASK(primask);
+}
+
+/* Stop a timer */
+HOTFUNC bool Chip_TWHEEL_Stop(CHIP_TWHEEL_TIMER_T *pTimer)
+{
+	uint32_t primask = __get_PRIMASK();
+	bool wasActive;
+
+	__disable_irq();
+	wasActive = (pTimer->flags & (TWHEEL_ACTIVE | TWHEEL_PENDING)) != 0;
+	if (pTimer->flags & TWHEEL_ACTIVE) {
+		twheel_unlink(pTimer);
+	}
+	/* a queued timer stays in the deferred list, Chip_TWHEEL_Run() skips it */
+	pTimer->flags &= ~(TWHEEL_ACTIVE | TWHEEL_PENDING);
+	__set_PRIMASK(primask);
+
+	/* the compare is left alone, an interrupt for a slot that emptied
+	   meanwhile just programs the next one */
+	return wasActive;
+}
+
+/* Check whether a timer is running */
+bool Chip_TWHEEL_IsActive(CHIP_TWHEEL_TIMER_T *pTimer)
+{
+	return (pTimer->flags & TWHEEL_ACTIVE) != 0;
+}
+
+/* Convert microseconds to ticks, rounded up */
+uint32_t Chip_TWHEEL_UsToTicks(uint32_t us)
+{
+	uint32_t ticks = (us + wheel.tickUs - 1) / wheel.tickUs;
+
+	return (ticks == 0) ? 1 : ticks;
+}
+
+/* Timer wheel interrupt handler */
+HOTFUNC void Chip_TWHEEL_IRQHandler(void)
+{
+	uint32_t elapsed, next, count;
+
+	Chip_RIT_ClearInt(LPC_RITIMER);
+
+	/* Catch up with the counter, jumping from one due slot to the next */
+	count = Chip_RIT_GetCounter(LPC_RITIMER);
+	elapsed = (count - wheel.lastCycles) / wheel.cyclesPerTick;
+	wheel.lastCycles += elapsed * wheel.cyclesPerTick;
+	elapsed += wheel.carry;
+	wheel.carry = 0;
+
+	while (twheel_next(&next) && ((next - wheel.now) <= elapsed)) {
+		elapsed -= next - wheel.now;
+		wheel.now = next;
+		twheel_process();
+	}
+	wheel.now += elapsed;
+
+	twheel_program();
+}
+
+/* Call the callbacks of expired TWHEEL_DEFERRED timers */
+void Chip_TWHEEL_Run(void)
+{
+	CHIP_TWHEEL_TIMER_T *pTimer;
+	uint32_t primask;
+	bool call;
+
+	while (wheel.pendHead != NULL) {
+		primask = __get_PRIMASK();
+		__disable_irq();
+		pTimer = wheel.pendHead;
+		wheel.pendHead = pTimer->pendNext;
+		call = (pTimer->flags & TWHEEL_PENDING) != 0;
+		pTimer->flags &= ~(TWHEEL_PENDING | TWHEEL_QUEUED);
+		__set_PRIMASK(primask);
+
+		if (call) {
+			pTimer->callback(pTimer);
+		}
+	}
+}
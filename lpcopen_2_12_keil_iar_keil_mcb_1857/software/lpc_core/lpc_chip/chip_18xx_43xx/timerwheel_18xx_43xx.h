@@ -0,0 +1,165 @@
+/*
+ * @brief LPC18xx_43xx RITimer driven software timer wheel
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licenser disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __TIMERWHEEL_18XX_43XX_H_
+#define __TIMERWHEEL_18XX_43XX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup TIMERWHEEL_18XX_43XX CHIP: LPC18xx/43xx RITimer software timer wheel
+ * @ingroup RITIMER_18XX_43XX
+ * Any number of one-shot and periodic software timers share the RITimer.
+ * Timers are kept in a hierarchical wheel of TWHEEL_LEVELS levels of
+ * TWHEEL_SLOTS slots each, level n slots spanning TWHEEL_SLOTS^n ticks, so
+ * starting and stopping a timer is O(1). The RITimer counter runs free and
+ * its compare value is set to the next slot that holds a timer, found from
+ * per level bitmaps, so there is no periodic tick: the interrupt only fires
+ * to expire timers or to move a level's timers down when their slot comes
+ * up. While no timer runs the interrupt is disabled.
+ *
+ * A timer's callback is called from the RITimer interrupt, or, with
+ * TWHEEL_DEFERRED, from Chip_TWHEEL_Run() in the main loop. Callbacks may
+ * start and stop timers, their own included. The tick length is set at
+ * init, timeouts are rounded up to whole ticks.
+ * The service enables and disables RITIMER_IRQn itself, so code sharing
+ * data with interrupt callbacks masks interrupts with PRIMASK instead.
+ * @{
+ */
+
+/** Bits of slot index per level */
+#define TWHEEL_SLOT_BITS        5
+/** Slots per level, one bit each in a 32-bit bitmap */
+#define TWHEEL_SLOTS            (1 << TWHEEL_SLOT_BITS)
+/** Wheel levels, timeouts up to TWHEEL_SLOTS^TWHEEL_LEVELS ticks go in one step */
+#define TWHEEL_LEVELS           4
+
+/** Timer flag: call the callback from Chip_TWHEEL_Run() instead of the interrupt */
+#define TWHEEL_DEFERRED         (1 << 0)
+
+struct CHIP_TWHEEL_TIMER;
+
+/** Timer expiry callback */
+typedef void (*CHIP_TWHEEL_CALLBACK_T)(struct CHIP_TWHEEL_TIMER *pTimer);
+
+/**
+ * @brief Software timer, storage is owned by the caller
+ */
+typedef struct CHIP_TWHEEL_TIMER {
+	struct CHIP_TWHEEL_TIMER *next;		/*!< Next timer in the slot */
+	struct CHIP_TWHEEL_TIMER **pprev;	/*!< Link pointing to this timer */
+	struct CHIP_TWHEEL_TIMER *pendNext;	/*!< Next timer waiting for Chip_TWHEEL_Run() */
+	CHIP_TWHEEL_CALLBACK_T callback;	/*!< Called when the timer expires */
+	void *pArg;							/*!< Free for the owner of the timer */
+	uint32_t expires;					/*!< Wheel tick the timer expires on */
+	uint32_t period;					/*!< Reload in ticks, 0 for a one-shot timer */
+	uint8_t flags;						/*!< TWHEEL_DEFERRED and internal state */
+	uint8_t level;						/*!< Wheel level the timer is linked in */
+	uint8_t slot;						/*!< Slot the timer is linked in */
+	uint8_t overruns;					/*!< Deferred expiries merged before Chip_TWHEEL_Run() */
+} CHIP_TWHEEL_TIMER_T;
+
+/**
+ * @brief	Initialize the timer wheel and the RITimer
+ * @param	tickUs	: Tick length in microseconds
+ * @return	Nothing
+ * @note	The timer wheel owns the RITimer, the application's
+ *			RIT_IRQHandler must call Chip_TWHEEL_IRQHandler(). It keeps its
+ *			tick length across Chip_DVFS_SetCoreClock() changes.
+ */
+void Chip_TWHEEL_Init(uint32_t tickUs);
+
+/**
+ * @brief	Set up a timer before its first start
+ * @param	pTimer		: Timer storage
+ * @param	callback	: Called on expiry
+ * @param	pArg		: Stored in pTimer->pArg for the callback
+ * @param	flags		: 0 or TWHEEL_DEFERRED
+ * @return	Nothing
+ */
+void Chip_TWHEEL_Setup(CHIP_TWHEEL_TIMER_T *pTimer, CHIP_TWHEEL_CALLBACK_T callback, void *pArg, uint32_t flags);
+
+/**
+ * @brief	Start or restart a timer
+ * @param	pTimer	: Timer set up with Chip_TWHEEL_Setup()
+ * @param	ticks	: Ticks to the first expiry, 0 is taken as 1
+ * @param	period	: Ticks between later expiries, 0 for a one-shot timer
+ * @return	Nothing
+ * @note	A running timer is first stopped.
+ */
+HOTFUNC void Chip_TWHEEL_Start(CHIP_TWHEEL_TIMER_T *pTimer, uint32_t ticks, uint32_t period);
+
+/**
+ * @brief	Stop a timer
+ * @param	pTimer	: Timer set up with Chip_TWHEEL_Setup()
+ * @return	true if the timer was running or its deferred callback pending
+ * @note	A deferred callback that has not run yet is cancelled too.
+ */
+HOTFUNC bool Chip_TWHEEL_Stop(CHIP_TWHEEL_TIMER_T *pTimer);
+
+/**
+ * @brief	Check whether a timer is running
+ * @param	pTimer	: Timer set up with Chip_TWHEEL_Setup()
+ * @return	true if the timer will expire (again)
+ */
+bool Chip_TWHEEL_IsActive(CHIP_TWHEEL_TIMER_T *pTimer);
+
+/**
+ * @brief	Convert microseconds to ticks, rounded up
+ * @param	us	: Time in microseconds
+ * @return	Ticks, at least 1
+ */
+uint32_t Chip_TWHEEL_UsToTicks(uint32_t us);
+
+/**
+ * @brief	Timer wheel interrupt handler
+ * @return	Nothing
+ * @note	Expires the due timers and programs the RITimer for the next one.
+ */
+HOTFUNC void Chip_TWHEEL_IRQHandler(void);
+
+/**
+ * @brief	Call the callbacks of expired TWHEEL_DEFERRED timers
+ * @return	Nothing
+ * @note	Call from the main loop, e.g. after each __WFI().
+ */
+void Chip_TWHEEL_Run(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMERWHEEL_18XX_43XX_H_ */
@@ -30,6 +30,7 @@
  */
 
 #include "chip.h"
+#include "string.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -38,6 +39,21 @@
 /* Autobaud status flag */
 STATIC volatile FlagStatus ABsyncSts = RESET;
 
+/* Standard baud rates whose fractional divisors are kept once found */
+static const uint32_t fdrStdBauds[] = {
+	1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600
+};
+
+/* Divisors found for a standard baud rate at the UART clock rate pclk,
+   div is 0 when the rate can't be reached at that clock */
+typedef struct {
+	uint32_t pclk;
+	uint16_t div;
+	uint8_t mul;
+	uint8_t divAdd;
+} UART_FDR_ENTRY_T;
+STATIC UART_FDR_ENTRY_T fdrTable[NELEMENTS(fdrStdBauds)];
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -67,6 +83,54 @@ STATIC CHIP_CCU_CLK_T Chip_UART_GetClockIndex(LPC_USART_T *pUART)
 	return clkUART;
 }
 
+/* Searches the divisor latch and fractional divider values closest to a
+   baud rate, returns the divisor latch value or 0 */
+STATIC uint32_t Chip_UART_FindFDR(uint32_t pclk, uint32_t baud, uint32_t *pMul, uint32_t *pDivAdd)
+{
+	uint32_t sdiv = 0, sm = 1, sd = 0;
+	uint32_t m, d;
+	uint32_t odiff = -1UL; /* old best diff */
+
+	/* Loop through all possible fractional divider values */
+	for (m = 1; odiff && m < 16; m++) {
+		for (d = 0; d < m; d++) {
+			uint32_t diff, div;
+			uint64_t dval = (((uint64_t) pclk << 28) * m) / (baud * (m + d));
+
+			/* Lower 32-bit of dval has diff */
+			diff = (uint32_t) dval;
+			/* Upper 32-bit of dval has div */
+			div = (uint32_t) (dval >> 32);
+
+			/* Closer to next div */
+			if ((int)diff < 0) {
+				diff = -diff;
+				div ++;
+			}
+
+			/* Check if new value is worse than old or out of range */
+			if (odiff < diff || !div || (div >> 16) || (div < 3 && d)) {
+				continue;
+			}
+
+			/* Store the new better values */
+			sdiv = div;
+			sd = d;
+			sm = m;
+			odiff = diff;
+
+			/* On perfect match, break loop */
+			if(!diff) {
+				break;
+			}
+		}
+	}
+
+	*pMul = sm;
+	*pDivAdd = sd;
+	return sdiv;
+}
+
 /* UART Autobaud command interrupt handler */
 STATIC void Chip_UART_ABIntHandler(LPC_USART_T *pUART)
 {
@@ -246,22 +310,45 @@ uint32_t Chip_UART_SetBaud(LPC_USART_T *pUART, uint32_t baudrate)
 /* UART receive-only interrupt handler for ring buffers */
 void Chip_UART_RXIntHandlerRB(LPC_USART_T *pUART, RINGBUFF_T *pRB)
 {
-	/* New data will be ignored if data not popped in time */
+	/* Drain the FIFO straight into ring buffer storage, one span at a
+	   time, and publish each span with a single commit */
 	while (Chip_UART_ReadLineStatus(pUART) & UART_LSR_RDR) {
-		uint8_t ch = Chip_UART_ReadByte(pUART);
-		RingBuffer_Insert(pRB, &ch);
+		uint8_t *p8;
+		int cnt = RingBuffer_GetWritePtr(pRB, (void **) &p8);
+		int i = 0;
+
+		/* New data will be ignored if data not popped in time */
+		if (cnt == 0) {
+			Chip_UART_ReadByte(pUART);
+			continue;
+		}
+
+		do {
+			p8[i++] = Chip_UART_ReadByte(pUART);
+		} while ((i < cnt) && (Chip_UART_ReadLineStatus(pUART) & UART_LSR_RDR));
+
+		RingBuffer_CommitWrite(pRB, i);
 	}
 }
 
 /* UART transmit-only interrupt handler for ring buffers */
 void Chip_UART_TXIntHandlerRB(LPC_USART_T *pUART, RINGBUFF_T *pRB)
 {
-	uint8_t ch;
-
-	/* Fill FIFO until full or until TX ring buffer is empty */
-	while ((Chip_UART_ReadLineStatus(pUART) & UART_LSR_THRE) != 0 &&
-		   RingBuffer_Pop(pRB, &ch)) {
-		Chip_UART_SendByte(pUART, ch);
+	uint8_t *p8;
+	int room, cnt, i;
+
+	/* THRE means the whole TX FIFO is empty, so refill it in one burst
+	   from at most two ring buffer spans */
+	if ((Chip_UART_ReadLineStatus(pUART) & UART_LSR_THRE) != 0) {
+		room = UART_TX_FIFO_SIZE;
+		while ((room > 0) && ((cnt = RingBuffer_GetReadPtr(pRB, (void **) &p8)) > 0)) {
+			cnt = MIN(cnt, room);
+			for (i = 0; i < cnt; i++) {
+				Chip_UART_SendByte(pUART, p8[i]);
+			}
+			RingBuffer_CommitRead(pRB, cnt);
+			room -= cnt;
+		}
 	}
 
 	/* Turn off interrupt if the ring buffer is empty */
@@ -277,18 +364,20 @@ uint32_t Chip_UART_SendRB(LPC_USART_T *pUART, RINGBUFF_T *pRB, const void *data,
 	uint32_t ret;
 	uint8_t *p8 = (uint8_t *) data;
 
-	/* Don't let UART transmit ring buffer change in the UART IRQ handler */
-	Chip_UART_IntDisable(pUART, UART_IER_THREINT);
-
-	/* Move as much data as possible into transmit ring buffer */
+	/* Move as much data as possible into transmit ring buffer, the
+	   ring buffer is safe against the IRQ handler popping from it */
 	ret = RingBuffer_InsertMult(pRB, p8, bytes);
-	Chip_UART_TXIntHandlerRB(pUART, pRB);
 
-	/* Add additional data to transmit ring buffer if possible */
-	ret += RingBuffer_InsertMult(pRB, (p8 + ret), (bytes - ret));
+	/* With the transmit interrupt off the IRQ handler is not popping,
+	   so prime the FIFO here and hand the ring buffer back to it */
+	if ((pUART->IER & UART_IER_THREINT) == 0) {
+		Chip_UART_TXIntHandlerRB(pUART, pRB);
 
-	/* Enable UART transmit interrupt */
-	Chip_UART_IntEnable(pUART, UART_IER_THREINT);
+		/* Add additional data to transmit ring buffer if possible */
+		ret += RingBuffer_InsertMult(pRB, (p8 + ret), (bytes - ret));
+
+		Chip_UART_IntEnable(pUART, UART_IER_THREINT);
+	}
 
 	return ret;
 }
@@ -321,48 +410,164 @@ void Chip_UART_IRQRBHandler(LPC_USART_T *pUART, RINGBUFF_T *pRXRB, RINGBUFF_T *p
     Chip_UART_ABIntHandler(pUART);
 }
 
-/* Determines and sets best dividers to get a target baud rate */
-uint32_t Chip_UART_SetBaudFDR(LPC_USART_T *pUART, uint32_t baud)
+/* Initialize a UART DMA streaming handle */
+void Chip_UART_DMA_Init(UART_DMA_T *pDMA, LPC_USART_T *pUART, LPC_GPDMA_T *pGPDMA,
+						uint32_t rxConn, uint32_t txConn)
 {
-	uint32_t sdiv = 0, sm = 1, sd = 0;
-	uint32_t pclk, m, d;
-	uint32_t odiff = -1UL; /* old best diff */
+	memset(pDMA, 0, sizeof(*pDMA));
+	pDMA->pUART = pUART;
+	pDMA->pGPDMA = pGPDMA;
+	pDMA->rxConn = rxConn;
+	pDMA->txConn = txConn;
+	pDMA->rxChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, rxConn);
+	pDMA->txChannel = Chip_GPDMA_GetFreeChannel(pGPDMA, txConn);
+}
 
-	/* Get base clock for the corresponding UART */
-	pclk = Chip_Clock_GetRate(Chip_UART_GetClockIndex(pUART));
+/* Start continuous DMA reception into a circular buffer */
+Status Chip_UART_DMA_StartRX(UART_DMA_T *pDMA, void *buffer, DMA_TransferDescriptor_t *desc,
+							 int segments, uint32_t segSize, UART_DMA_CALLBACK_T callback)
+{
+	uint8_t *p8 = (uint8_t *) buffer;
+	int i;
 
-	/* Loop through all possible fractional divider values */
-	for (m = 1; odiff && m < 16; m++) {
-		for (d = 0; d < m; d++) {
-			uint32_t diff, div;
-			uint64_t dval = (((uint64_t) pclk << 28) * m) / (baud * (m + d));
+	if ((segments < 2) || (segSize == 0) || (segSize > 0xFFF)) {
+		return ERROR;
+	}
 
-			/* Lower 32-bit of dval has diff */
-			diff = (uint32_t) dval;
-			/* Upper 32-bit of dval has div */
-			div = (uint32_t) (dval >> 32);
+	/* Chain the segments into a closed loop, interrupting at the end of each */
+	for (i = 0; i < segments; i++) {
+		if (Chip_GPDMA_PrepareDescriptor(pDMA->pGPDMA, &desc[i], pDMA->rxConn,
+										 (uint32_t) (p8 + (i * segSize)), segSize,
+										 GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA,
+										 &desc[(i + 1) % segments]) == ERROR) {
+			return ERROR;
+		}
+		desc[i].ctrl |= GPDMA_DMACCxControl_I;
+	}
 
-			/* Closer to next div */
-			if ((int)diff < 0) {
-				diff = -diff;
-				div ++;
-			}
+	pDMA->rxBuffer = p8;
+	pDMA->rxSize = segments * segSize;
+	pDMA->rxTail = 0;
+	pDMA->rxCallback = callback;
 
-			/* Check if new value is worse than old or out of range */
-			if (odiff < diff || !div || (div >> 16) || (div < 3 && d)) {
-				continue;
-			}
+	return Chip_GPDMA_SGTransferPeripheral(pDMA->pGPDMA, pDMA->rxChannel, pDMA->rxConn, &desc[0],
+										   GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA);
+}
 
-			/* Store the new better values */
-			sdiv = div;
-			sd = d;
-			sm = m;
-			odiff = diff;
+/* Return the number of received bytes not yet read */
+int Chip_UART_DMA_GetRXCount(UART_DMA_T *pDMA)
+{
+	uint32_t head;
 
-			/* On perfect match, break loop */
-			if(!diff) {
-				break;
-			}
+	/* The channel destination address is the next byte the DMA will write */
+	head = pDMA->pGPDMA->CH[pDMA->rxChannel].DESTADDR - (uint32_t) pDMA->rxBuffer;
+	if (head >= pDMA->rxSize) {
+		head = 0;
+	}
+
+	return (int) ((head + pDMA->rxSize - pDMA->rxTail) % pDMA->rxSize);
+}
+
+/* Copy received data out of the circular buffer */
+int Chip_UART_DMA_ReadRX(UART_DMA_T *pDMA, void *data, int bytes)
+{
+	uint8_t *p8 = (uint8_t *) data;
+	int count, cnt1;
+
+	count = Chip_UART_DMA_GetRXCount(pDMA);
+	if (count > bytes) {
+		count = bytes;
+	}
+
+	/* Copy up to the end of the buffer, then the wrapped remainder */
+	cnt1 = MIN(count, (int) (pDMA->rxSize - pDMA->rxTail));
+	memcpy(p8, pDMA->rxBuffer + pDMA->rxTail, cnt1);
+	memcpy(p8 + cnt1, pDMA->rxBuffer, count - cnt1);
+
+	pDMA->rxTail = (pDMA->rxTail + count) % pDMA->rxSize;
+
+	return count;
+}
+
+/* Transmit a caller buffer by DMA */
+Status Chip_UART_DMA_Send(UART_DMA_T *pDMA, const void *data, uint32_t bytes,
+						  UART_DMA_CALLBACK_T callback)
+{
+	if ((pDMA->txBusy) || (bytes == 0) || (bytes > 0xFFF)) {
+		return ERROR;
+	}
+
+	pDMA->txCallback = callback;
+	pDMA->txBusy = true;
+
+	if (Chip_GPDMA_Transfer(pDMA->pGPDMA, pDMA->txChannel, (uint32_t) data, pDMA->txConn,
+							GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, bytes) == ERROR) {
+		pDMA->txBusy = false;
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/* Stop DMA reception and transmission */
+void Chip_UART_DMA_Stop(UART_DMA_T *pDMA)
+{
+	Chip_GPDMA_Stop(pDMA->pGPDMA, pDMA->rxChannel);
+	Chip_GPDMA_Stop(pDMA->pGPDMA, pDMA->txChannel);
+	pDMA->txBusy = false;
+}
+
+/* GPDMA interrupt handler for UART DMA streaming */
+void Chip_UART_DMA_IRQHandler(UART_DMA_T *pDMA)
+{
+	/* Receive segment filled, the list carries on into the next one */
+	if (Chip_GPDMA_IntGetStatus(pDMA->pGPDMA, GPDMA_STAT_INT, pDMA->rxChannel)) {
+		if ((Chip_GPDMA_Interrupt(pDMA->pGPDMA, pDMA->rxChannel) == SUCCESS) && (pDMA->rxCallback)) {
+			pDMA->rxCallback(pDMA);
+		}
+	}
+
+	/* Transmit done, or aborted on a bus error */
+	if (Chip_GPDMA_IntGetStatus(pDMA->pGPDMA, GPDMA_STAT_INT, pDMA->txChannel)) {
+		Chip_GPDMA_Interrupt(pDMA->pGPDMA, pDMA->txChannel);
+		pDMA->txBusy = false;
+		if (pDMA->txCallback) {
+			pDMA->txCallback(pDMA);
+		}
+	}
+}
+
+/* Determines and sets best dividers to get a target baud rate */
+uint32_t Chip_UART_SetBaudFDR(LPC_USART_T *pUART, uint32_t baud)
+{
+	uint32_t sdiv, sm, sd;
+	uint32_t pclk;
+	UART_FDR_ENTRY_T *pEntry = NULL;
+	int i;
+
+	/* Get base clock for the corresponding UART */
+	pclk = Chip_Clock_GetRate(Chip_UART_GetClockIndex(pUART));
+
+	for (i = 0; i < (int) NELEMENTS(fdrStdBauds); i++) {
+		if (fdrStdBauds[i] == baud) {
+			pEntry = &fdrTable[i];
+			break;
+		}
+	}
+
+	/* Standard rates are only searched again when the UART clock changed */
+	if ((pEntry != NULL) && (pEntry->pclk == pclk)) {
+		sdiv = pEntry->div;
+		sm = pEntry->mul;
+		sd = pEntry->divAdd;
+	}
+	else {
+		sdiv = Chip_UART_FindFDR(pclk, baud, &sm, &sd);
+		if (pEntry != NULL) {
+			pEntry->div = (uint16_t) sdiv;
+			pEntry->mul = (uint8_t) sm;
+			pEntry->divAdd = (uint8_t) sd;
+			pEntry->pclk = pclk;
 		}
 	}
 
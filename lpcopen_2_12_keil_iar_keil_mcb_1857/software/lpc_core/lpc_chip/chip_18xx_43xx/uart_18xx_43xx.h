@@ -710,6 +710,9 @@ uint32_t Chip_UART_SetBaud(LPC_USART_T *pUART, uint32_t baudrate);
  * 			rates in-between any of the above three maximum rates could be set
  * 			using this API. Fractional dividers can only be used for rates
  * 			lower than (clk / 48) where @a clk is the base clock of the UART.
+ * 			The divisors of the standard rates from 1200 to 921600 baud are
+ * 			kept per UART clock rate, so only the first call for such a rate
+ * 			searches them.
  */
 uint32_t Chip_UART_SetBaudFDR(LPC_USART_T *pUART, uint32_t baud);
 
@@ -743,7 +746,12 @@ int Chip_UART_ReadBlocking(LPC_USART_T *pUART, void *data, int numBytes);
  * @return	Nothing
  * @note	If ring buffer support is desired for the receive side
  *			of data transfer, the UART interrupt should call this
- *			function for a receive based interrupt status.
+ *			function for a receive based interrupt status. The ring
+ *			buffer must have been initialized with 1 byte items.
+ *			The FIFO is drained in one pass per interrupt, so a FIFO
+ *			trigger level of 8 or 14 characters keeps interrupts per
+ *			byte low; the character time-out interrupt (also enabled
+ *			by UART_IER_RBRINT) collects the tail of a burst.
  */
 void Chip_UART_RXIntHandlerRB(LPC_USART_T *pUART, RINGBUFF_T *pRB);
 
@@ -754,7 +762,10 @@ void Chip_UART_RXIntHandlerRB(LPC_USART_T *pUART, RINGBUFF_T *pRB);
  * @return	Nothing
  * @note	If ring buffer support is desired for the transmit side
  *			of data transfer, the UART interrupt should call this
- *			function for a transmit based interrupt status.
+ *			function for a transmit based interrupt status. The ring
+ *			buffer must have been initialized with 1 byte items.
+ *			Each interrupt refills the whole UART_TX_FIFO_SIZE byte
+ *			transmit FIFO.
  */
 void Chip_UART_TXIntHandlerRB(LPC_USART_T *pUART, RINGBUFF_T *pRB);
 
@@ -796,6 +807,118 @@ int Chip_UART_ReadRB(LPC_USART_T *pUART, RINGBUFF_T *pRB, void *data, int bytes)
  */
 void Chip_UART_IRQRBHandler(LPC_USART_T *pUART, RINGBUFF_T *pRXRB, RINGBUFF_T *pTXRB);
 
+struct UART_DMA;
+
+/**
+ * @brief UART DMA streaming completion callback
+ */
+typedef void (*UART_DMA_CALLBACK_T)(struct UART_DMA *pDMA);
+
+/**
+ * @brief UART DMA streaming handle
+ * The receive side runs a circular GPDMA linked list over a caller
+ * buffer split in equal segments, so reception never stops for the
+ * CPU. The transmit side sends one caller buffer at a time.
+ */
+typedef struct UART_DMA {
+	LPC_USART_T *pUART;					/*!< UART peripheral */
+	LPC_GPDMA_T *pGPDMA;				/*!< GPDMA controller */
+	uint32_t rxConn;					/*!< GPDMA_CONN_UARTn_Rx connection */
+	uint32_t txConn;					/*!< GPDMA_CONN_UARTn_Tx connection */
+	uint8_t rxChannel;					/*!< GPDMA channel used for receive */
+	uint8_t txChannel;					/*!< GPDMA channel used for transmit */
+	uint8_t *rxBuffer;					/*!< Circular receive buffer */
+	uint32_t rxSize;					/*!< Receive buffer size in bytes */
+	uint32_t rxTail;					/*!< Read index into rxBuffer */
+	volatile bool txBusy;				/*!< A transmit is in progress */
+	UART_DMA_CALLBACK_T rxCallback;		/*!< Called per filled receive segment, or NULL */
+	UART_DMA_CALLBACK_T txCallback;		/*!< Called when a transmit completes, or NULL */
+} UART_DMA_T;
+
+/**
+ * @brief	Initialize a UART DMA streaming handle
+ * @param	pDMA	: Handle to initialize
+ * @param	pUART	: Pointer to selected UART peripheral
+ * @param	pGPDMA	: The base of GPDMA on the chip, already initialized with Chip_GPDMA_Init()
+ * @param	rxConn	: GPDMA_CONN_UARTn_Rx connection matching pUART
+ * @param	txConn	: GPDMA_CONN_UARTn_Tx connection matching pUART
+ * @return	Nothing
+ * @note	Claims one GPDMA channel for each direction. The UART FIFOs
+ *			must be set up with UART_FCR_DMAMODE_SEL so the UART raises
+ *			DMA requests, and the UART receive/transmit interrupts
+ *			should be left disabled.
+ */
+void Chip_UART_DMA_Init(UART_DMA_T *pDMA, LPC_USART_T *pUART, LPC_GPDMA_T *pGPDMA,
+						uint32_t rxConn, uint32_t txConn);
+
+/**
+ * @brief	Start continuous DMA reception into a circular buffer
+ * @param	pDMA		: UART DMA handle
+ * @param	buffer		: Receive buffer, segments * segSize bytes
+ * @param	desc		: Array of segments DMA descriptors, kept alive while receiving
+ * @param	segments	: Number of buffer segments, 2 or more
+ * @param	segSize		: Size of one segment in bytes, 4095 at most
+ * @param	callback	: Called from Chip_UART_DMA_IRQHandler() each time a segment fills, or NULL
+ * @return	ERROR on bad arguments, SUCCESS on success
+ * @note	Data must be read with Chip_UART_DMA_ReadRX() before the DMA
+ *			wraps around onto it; at 4 Mbaud a 4 KB buffer allows 10 ms.
+ */
+Status Chip_UART_DMA_StartRX(UART_DMA_T *pDMA, void *buffer, DMA_TransferDescriptor_t *desc,
+							 int segments, uint32_t segSize, UART_DMA_CALLBACK_T callback);
+
+/**
+ * @brief	Return the number of received bytes not yet read
+ * @param	pDMA	: UART DMA handle
+ * @return	Number of bytes available to Chip_UART_DMA_ReadRX()
+ */
+int Chip_UART_DMA_GetRXCount(UART_DMA_T *pDMA);
+
+/**
+ * @brief	Copy received data out of the circular buffer
+ * @param	pDMA	: UART DMA handle
+ * @param	data	: Pointer to buffer to fill
+ * @param	bytes	: Size of the passed buffer in bytes
+ * @return	The number of bytes copied, 0 if nothing was received
+ */
+int Chip_UART_DMA_ReadRX(UART_DMA_T *pDMA, void *data, int bytes);
+
+/**
+ * @brief	Transmit a caller buffer by DMA
+ * @param	pDMA		: UART DMA handle
+ * @param	data		: Data to send, must stay valid until the transfer completes
+ * @param	bytes		: Number of bytes to send, 1 to 4095
+ * @param	callback	: Called from Chip_UART_DMA_IRQHandler() once the data is in the UART, or NULL
+ * @return	ERROR if a transmit is already in progress or bytes is out of range, SUCCESS otherwise
+ */
+Status Chip_UART_DMA_Send(UART_DMA_T *pDMA, const void *data, uint32_t bytes,
+						  UART_DMA_CALLBACK_T callback);
+
+/**
+ * @brief	Returns whether a DMA transmit is in progress
+ * @param	pDMA	: UART DMA handle
+ * @return	true while the last Chip_UART_DMA_Send() has not completed
+ */
+STATIC INLINE bool Chip_UART_DMA_IsTXBusy(UART_DMA_T *pDMA)
+{
+	return pDMA->txBusy;
+}
+
+/**
+ * @brief	Stop DMA reception and transmission
+ * @param	pDMA	: UART DMA handle
+ * @return	Nothing
+ */
+void Chip_UART_DMA_Stop(UART_DMA_T *pDMA);
+
+/**
+ * @brief	GPDMA interrupt handler for UART DMA streaming
+ * @param	pDMA	: UART DMA handle
+ * @return	Nothing
+ * @note	Call this from DMA_IRQHandler(). It acknowledges the two
+ *			channels of the handle and runs the completion callbacks.
+ */
+void Chip_UART_DMA_IRQHandler(UART_DMA_T *pDMA);
+
 /**
  * @brief	Returns the Auto Baud status
  * @param	pUART	: Pointer to selected UART peripheral
@@ -0,0 +1,449 @@
+/*
+ * @brief Fixed point DSP kernels
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "fixdsp.h"
+#include <string.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* CRC-32 of each byte value, reflected polynomial 0xEDB88320 */
+static const uint32_t crc32Table[256] = {
+	0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
+	0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
+	0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2,
+	0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+	0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9,
+	0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172,
+	0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
+	0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+	0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423,
+	0xCFBA9599, 0xB8BDA50F, 0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924,
+	0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D, 0x76DC4190, 0x01DB7106,
+	0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+	0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D,
+	0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
+	0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950,
+	0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+	0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7,
+	0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0,
+	0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9, 0x5005713C, 0x270241AA,
+	0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+	0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
+	0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A,
+	0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84,
+	0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+	0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB,
+	0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC,
+	0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8, 0xA1D1937E,
+	0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+	0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55,
+	0x316E8EEF, 0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236,
+	0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28,
+	0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+	0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F,
+	0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38,
+	0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
+	0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+	0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69,
+	0x616BFFD3, 0x166CCF45, 0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2,
+	0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC,
+	0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+	0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693,
+	0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
+	0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Saturate to 16 and 32 bits, and count leading zeros */
+#if defined(CORE_M0)
+static INLINE int32_t dspSat16(int32_t v)
+{
+	return (v > 32767) ? 32767 : ((v < -32768) ? -32768 : v);
+}
+
+static INLINE uint32_t dspClz(uint32_t v)
+{
+	uint32_t n = 0;
+
+	while (!(v & 0x80000000UL)) {
+		v <<= 1;
+		n++;
+	}
+	return n;
+}
+
+#else
+#define dspSat16(v)     __SSAT((v), 16)
+#define dspClz(v)       __CLZ(v)
+#endif
+
+static INLINE int32_t dspSat32(int64_t v)
+{
+	if (v > (int64_t) 0x7FFFFFFF) {
+		return 0x7FFFFFFF;
+	}
+	if (v < -(int64_t) 0x80000000) {
+		return (int32_t) 0x80000000;
+	}
+	return (int32_t) v;
+}
+
+/* Circular history kept twice over, so the taps always see the last
+   numTaps samples as one run starting with the newest */
+static INLINE int16_t *firPushQ15(DSP_FIR_Q15_T *pFIR, int16_t x)
+{
+	uint32_t pos = (pFIR->pos == 0) ? (uint32_t) pFIR->numTaps - 1 : (uint32_t) pFIR->pos - 1;
+
+	pFIR->pState[pos] = x;
+	pFIR->pState[pos + pFIR->numTaps] = x;
+	pFIR->pos = (uint16_t) pos;
+	return &pFIR->pState[pos];
+}
+
+/* Sum of products of two Q15 runs, Q30 */
+static INLINE int32_t dotQ15(const int16_t *pA, const int16_t *pB, uint32_t n)
+{
+	int32_t acc = 0;
+	uint32_t i;
+
+	for (i = n >> 2; i > 0; i--) {
+		acc += (int32_t) pA[0] * pB[0];
+		acc += (int32_t) pA[1] * pB[1];
+		acc += (int32_t) pA[2] * pB[2];
+		acc += (int32_t) pA[3] * pB[3];
+		pA += 4;
+		pB += 4;
+	}
+	for (i = n & 3; i > 0; i--) {
+		acc += (int32_t) *pA++ * *pB++;
+	}
+	return acc;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize a Q15 FIR filter */
+void DSP_FIR_Init_Q15(DSP_FIR_Q15_T *pFIR, const int16_t *pCoeffs, uint16_t numTaps, int16_t *pState)
+{
+	pFIR->pCoeffs = pCoeffs;
+	pFIR->pState = pState;
+	pFIR->numTaps = numTaps;
+	pFIR->pos = 0;
+	memset(pState, 0, DSP_FIR_STATE_SIZE(numTaps) * sizeof(int16_t));
+}
+
+/* Filter a block of Q15 samples */
+HOTFUNC void DSP_FIR_Q15(DSP_FIR_Q15_T *pFIR, const int16_t *pSrc, int16_t *pDst, uint32_t count)
+{
+	const int16_t *pHist;
+
+	while (count--) {
+		pHist = firPushQ15(pFIR, *pSrc++);
+		*pDst++ = (int16_t) dspSat16(dotQ15(pFIR->pCoeffs, pHist, pFIR->numTaps) >> 15);
+	}
+}
+
+/* Initialize a Q31 FIR filter */
+void DSP_FIR_Init_Q31(DSP_FIR_Q31_T *pFIR, const int32_t *pCoeffs, uint16_t numTaps, int32_t *pState)
+{
+	pFIR->pCoeffs = pCoeffs;
+	pFIR->pState = pState;
+	pFIR->numTaps = numTaps;
+	pFIR->pos = 0;
+	memset(pState, 0, DSP_FIR_STATE_SIZE(numTaps) * sizeof(int32_t));
+}
+
+/* Filter a block of Q31 samples */
+HOTFUNC void DSP_FIR_Q31(DSP_FIR_Q31_T *pFIR, const int32_t *pSrc, int32_t *pDst, uint32_t count)
+{
+	const int32_t *pB, *pX;
+	int64_t acc;
+	uint32_t pos, i;
+
+	while (count--) {
+		pos = (pFIR->pos == 0) ? (uint32_t) pFIR->numTaps - 1 : (uint32_t) pFIR->pos - 1;
+		pFIR->pState[pos] = *pSrc;
+		pFIR->pState[pos + pFIR->numTaps] = *pSrc++;
+		pFIR->pos = (uint16_t) pos;
+
+		pB = pFIR->pCoeffs;
+		pX = &pFIR->pState[pos];
+		acc = 0;
+		for (i = (uint32_t) pFIR->numTaps >> 2; i > 0; i--) {
+			acc += (int64_t) pB[0] * pX[0];
+			acc += (int64_t) pB[1] * pX[1];
+			acc += (int64_t) pB[2] * pX[2];
+			acc += (int64_t) pB[3] * pX[3];
+			pB += 4;
+			pX += 4;
+		}
+		for (i = (uint32_t) pFIR->numTaps & 3; i > 0; i--) {
+			acc += (int64_t) *pB++ * *pX++;
+		}
+		*pDst++ = dspSat32(acc >> 31);
+	}
+}
+
+/* Initialize a Q15 FIR decimator */
+void DSP_Decimate_Init_Q15(DSP_DECIM_Q15_T *pDecim, uint16_t factor, const int16_t *pCoeffs,
+						   uint16_t numTaps, int16_t *pState)
+{
+	DSP_FIR_Init_Q15(&pDecim->fir, pCoeffs, numTaps, pState);
+	pDecim->factor = factor;
+	pDecim->phase = factor;
+}
+
+/* Filter and decimate a block of Q15 samples */
+HOTFUNC uint32_t DSP_Decimate_Q15(DSP_DECIM_Q15_T *pDecim, const int16_t *pSrc, int16_t *pDst, uint32_t count)
+{
+	const int16_t *pHist;
+	uint32_t out = 0;
+
+	while (count--) {
+		pHist = firPushQ15(&pDecim->fir, *pSrc++);
+		if (--pDecim->phase == 0) {
+			pDecim->phase = pDecim->factor;
+			pDst[out++] = (int16_t) dspSat16(dotQ15(pDecim->fir.pCoeffs, pHist, pDecim->fir.numTaps) >> 15);
+		}
+	}
+
+	return out;
+}
+
+/* Initialize a Q15 biquad cascade */
+void DSP_Biquad_Init_Q15(DSP_BIQUAD_Q15_T *pIIR, uint8_t numStages, const int16_t *pCoeffs,
+						 int16_t *pState, uint8_t postShift)
+{
+	pIIR->pCoeffs = pCoeffs;
+	pIIR->pState = pState;
+	pIIR->numStages = numStages;
+	pIIR->postShift = postShift;
+	memset(pState, 0, DSP_BIQUAD_STATE_SIZE(numStages) * sizeof(int16_t));
+}
+
+/* Filter a block of Q15 samples through a biquad cascade */
+HOTFUNC void DSP_Biquad_Q15(DSP_BIQUAD_Q15_T *pIIR, const int16_t *pSrc, int16_t *pDst, uint32_t count)
+{
+	const int16_t *pC = pIIR->pCoeffs;
+	int16_t *pS = pIIR->pState;
+	uint32_t shift = 15 - pIIR->postShift;
+	int32_t b0, b1, b2, a1, a2, x0, x1, x2, y1, y2;
+	int64_t acc;
+	uint32_t stage, i;
+
+	/* One stage at a time over the block keeps its coefficients and state
+	   in registers, later stages work in place on pDst */
+	for (stage = 0; stage < pIIR->numStages; stage++) {
+		b0 = pC[0];
+		b1 = pC[1];
+		b2 = pC[2];
+		a1 = pC[3];
+		a2 = pC[4];
+		x1 = pS[0];
+		x2 = pS[1];
+		y1 = pS[2];
+		y2 = pS[3];
+
+		for (i = 0; i < count; i++) {
+			x0 = pSrc[i];
+			acc = (int64_t) b0 * x0 + (int64_t) b1 * x1 + (int64_t) b2 * x2 +
+				  (int64_t) a1 * y1 + (int64_t) a2 * y2;
+			x2 = x1;
+			x1 = x0;
+			y2 = y1;
+			y1 = dspSat16(dspSat32(acc >> shift));
+			pDst[i] = (int16_t) y1;
+		}
+
+		pS[0] = (int16_t) x1;
+		pS[1] = (int16_t) x2;
+		pS[2] = (int16_t) y1;
+		pS[3] = (int16_t) y2;
+		pC += 5;
+		pS += 4;
+		pSrc = pDst;
+	}
+}
+
+/* Initialize a Q31 biquad cascade */
+void DSP_Biquad_Init_Q31(DSP_BIQUAD_Q31_T *pIIR, uint8_t numStages, const int32_t *pCoeffs,
+						 int32_t *pState, uint8_t postShift)
+{
+	pIIR->pCoeffs = pCoeffs;
+	pIIR->pState = pState;
+	pIIR->numStages = numStages;
+	pIIR->postShift = postShift;
+	memset(pState, 0, DSP_BIQUAD_STATE_SIZE(numStages) * sizeof(int32_t));
+}
+
+/* Filter a block of Q31 samples through a biquad cascade */
+HOTFUNC void DSP_Biquad_Q31(DSP_BIQUAD_Q31_T *pIIR, const int32_t *pSrc, int32_t *pDst, uint32_t count)
+{
+	const int32_t *pC = pIIR->pCoeffs;
+	int32_t *pS = pIIR->pState;
+	uint32_t shift = 31 - pIIR->postShift;
+	int32_t b0, b1, b2, a1, a2, x0, x1, x2, y1, y2;
+	int64_t acc;
+	uint32_t stage, i;
+
+	for (stage = 0; stage < pIIR->numStages; stage++) {
+		b0 = pC[0];
+		b1 = pC[1];
+		b2 = pC[2];
+		a1 = pC[3];
+		a2 = pC[4];
+		x1 = pS[0];
+		x2 = pS[1];
+		y1 = pS[2];
+		y2 = pS[3];
+
+		for (i = 0; i < count; i++) {
+			x0 = pSrc[i];
+			acc = (int64_t) b0 * x0 + (int64_t) b1 * x1 + (int64_t) b2 * x2 +
+				  (int64_t) a1 * y1 + (int64_t) a2 * y2;
+			x2 = x1;
+			x1 = x0;
+			y2 = y1;
+			y1 = dspSat32(acc >> shift);
+			pDst[i] = y1;
+		}
+
+		pS[0] = x1;
+		pS[1] = x2;
+		pS[2] = y1;
+		pS[3] = y2;
+		pC += 5;
+		pS += 4;
+		pSrc = pDst;
+	}
+}
+
+/* Initialize a Q15 moving RMS */
+void DSP_RMS_Init_Q15(DSP_RMS_Q15_T *pRMS, int16_t *pWindow, uint16_t length)
+{
+	pRMS->pWindow = pWindow;
+	pRMS->sumSq = 0;
+	pRMS->length = length;
+	pRMS->pos = 0;
+	memset(pWindow, 0, length * sizeof(int16_t));
+}
+
+/* Add a block of Q15 samples to a moving RMS */
+HOTFUNC int16_t DSP_RMS_Q15(DSP_RMS_Q15_T *pRMS, const int16_t *pSrc, uint32_t count)
+{
+	int16_t *pWindow = pRMS->pWindow;
+	uint64_t sumSq = pRMS->sumSq;
+	uint32_t pos = pRMS->pos;
+	uint32_t rms;
+	int32_t x, old;
+
+	while (count--) {
+		x = *pSrc++;
+		old = pWindow[pos];
+		pWindow[pos] = (int16_t) x;
+		sumSq += (uint32_t) (x * x);
+		sumSq -= (uint32_t) (old * old);
+		if (++pos == pRMS->length) {
+			pos = 0;
+		}
+	}
+	pRMS->sumSq = sumSq;
+	pRMS->pos = (uint16_t) pos;
+
+	/* Mean square is Q30, its root Q15 */
+	rms = DSP_Sqrt_U32((uint32_t) (sumSq / pRMS->length));
+	return (int16_t) ((rms > 32767) ? 32767 : rms);
+}
+
+/* Integer square root */
+uint32_t DSP_Sqrt_U32(uint32_t value)
+{
+	uint32_t root = 0, bit;
+
+	if (value == 0) {
+		return 0;
+	}
+
+	/* Start at the highest power of 4 not above the value */
+	bit = 1UL << ((31 - dspClz(value)) & ~1UL);
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+/* Update a CRC-32 */
+HOTFUNC uint32_t DSP_CRC32(uint32_t crc, const void *pData, uint32_t size)
+{
+	const uint8_t *p = (const uint8_t *) pData;
+	uint32_t word;
+
+	crc = ~crc;
+
+	/* Bytes up to a word boundary, then a word per pass */
+	while ((size != 0) && (((uint32_t) p & 3) != 0)) {
+		crc = crc32Table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+		size--;
+	}
+	while (size >= 4) {
+		word = crc ^ *(const uint32_t *) p;
+		crc = crc32Table[word & 0xFF] ^ (word >> 8);
+		crc = crc32Table[crc & 0xFF] ^ (crc >> 8);
+		crc = crc32Table[crc & 0xFF] ^ (crc >> 8);
+		crc = crc32Table[crc & 0xFF] ^ (crc >> 8);
+		p += 4;
+		size -= 4;
+	}
+	while (size--) {
+		crc = crc32Table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
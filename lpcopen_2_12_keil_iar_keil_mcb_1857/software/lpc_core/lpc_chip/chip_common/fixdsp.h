@@ -0,0 +1,269 @@
+/*
+ * @brief Fixed point DSP kernels
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __FIXDSP_H_
+#define __FIXDSP_H_
+
+#include "lpc_types.h"
+#include "cmsis.h"
+
+/** @defgroup Fix_DSP CHIP: Fixed point DSP kernels
+ * @ingroup CHIP_Common
+ * Q15 (int16_t, 1.15) and Q31 (int32_t, 1.31) filters for sensor and ADC
+ * pipelines: FIR filters, biquad IIR cascades, an FIR decimator, a moving
+ * RMS and a table driven CRC-32. The filters work on blocks of any length
+ * and keep their history in buffers owned by the caller, one instance per
+ * channel, so they can run from a DMA completion callback on each buffer
+ * as it fills. Results saturate instead of wrapping. The inner loops are
+ * unrolled by 4 for the Cortex-M3 (single cycle MLA, no SIMD) and use
+ * __SSAT and __CLZ, with C equivalents on the M0 core of the LPC43xx.
+ * Output buffers may be the input buffers.
+ * @{
+ */
+
+/** Samples of FIR state for a filter of numTaps taps */
+#define DSP_FIR_STATE_SIZE(numTaps)     (2 * (numTaps))
+
+/** Words of biquad state for a cascade of numStages stages */
+#define DSP_BIQUAD_STATE_SIZE(numStages)    (4 * (numStages))
+
+/**
+ * @brief Q15 FIR filter
+ */
+typedef struct {
+	const int16_t *pCoeffs;	/*!< Coefficients b[0] to b[numTaps - 1], Q15 */
+	int16_t *pState;		/*!< History, DSP_FIR_STATE_SIZE(numTaps) samples */
+	uint16_t numTaps;		/*!< Number of taps */
+	uint16_t pos;			/*!< Position of the newest sample in pState */
+} DSP_FIR_Q15_T;
+
+/**
+ * @brief Q31 FIR filter
+ */
+typedef struct {
+	const int32_t *pCoeffs;	/*!< Coefficients b[0] to b[numTaps - 1], Q31 */
+	int32_t *pState;		/*!< History, DSP_FIR_STATE_SIZE(numTaps) samples */
+	uint16_t numTaps;		/*!< Number of taps */
+	uint16_t pos;			/*!< Position of the newest sample in pState */
+} DSP_FIR_Q31_T;
+
+/**
+ * @brief Q15 FIR decimator, keeps one output of every factor inputs
+ */
+typedef struct {
+	DSP_FIR_Q15_T fir;		/*!< Anti-aliasing filter */
+	uint16_t factor;		/*!< Decimation factor */
+	uint16_t phase;			/*!< Inputs until the next output */
+} DSP_DECIM_Q15_T;
+
+/**
+ * @brief Q15 biquad cascade (direct form I)
+ * Each stage computes y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2],
+ * a1 and a2 have the opposite sign of the usual a[] of the transfer function.
+ */
+typedef struct {
+	const int16_t *pCoeffs;	/*!< b0, b1, b2, a1, a2 per stage, Q15 divided by 2^postShift */
+	int16_t *pState;		/*!< x[n-1], x[n-2], y[n-1], y[n-2] per stage */
+	uint8_t numStages;		/*!< Number of second order stages */
+	uint8_t postShift;		/*!< Left shift of the results, for coefficients of 1.0 and above */
+} DSP_BIQUAD_Q15_T;
+
+/**
+ * @brief Q31 biquad cascade (direct form I), see DSP_BIQUAD_Q15_T
+ */
+typedef struct {
+	const int32_t *pCoeffs;	/*!< b0, b1, b2, a1, a2 per stage, Q31 divided by 2^postShift */
+	int32_t *pState;		/*!< x[n-1], x[n-2], y[n-1], y[n-2] per stage */
+	uint8_t numStages;		/*!< Number of second order stages */
+	uint8_t postShift;		/*!< Left shift of the results, for coefficients of 1.0 and above */
+} DSP_BIQUAD_Q31_T;
+
+/**
+ * @brief Q15 moving RMS over a window of samples
+ */
+typedef struct {
+	int16_t *pWindow;		/*!< Last length samples */
+	uint64_t sumSq;			/*!< Sum of the squares of the window, Q30 */
+	uint16_t length;		/*!< Window length in samples */
+	uint16_t pos;			/*!< Position of the oldest sample in pWindow */
+} DSP_RMS_Q15_T;
+
+/**
+ * @brief	Initialize a Q15 FIR filter
+ * @param	pFIR		: Filter instance
+ * @param	pCoeffs		: numTaps coefficients, b[0] applies to the newest sample
+ * @param	numTaps		: Number of taps, at least 1
+ * @param	pState		: DSP_FIR_STATE_SIZE(numTaps) samples of history, cleared here
+ * @return	Nothing
+ */
+void DSP_FIR_Init_Q15(DSP_FIR_Q15_T *pFIR, const int16_t *pCoeffs, uint16_t numTaps, int16_t *pState);
+
+/**
+ * @brief	Filter a block of Q15 samples
+ * @param	pFIR	: Filter instance
+ * @param	pSrc	: Input samples
+ * @param	pDst	: Output samples, may be pSrc
+ * @param	count	: Number of samples
+ * @return	Nothing
+ * @note	Accumulates in 32 bits (Q30 products), coefficient sets with an
+ * absolute sum below 2.0 can't overflow. Use the Q31 filter for others.
+ */
+HOTFUNC void DSP_FIR_Q15(DSP_FIR_Q15_T *pFIR, const int16_t *pSrc, int16_t *pDst, uint32_t count);
+
+/**
+ * @brief	Initialize a Q31 FIR filter
+ * @param	pFIR		: Filter instance
+ * @param	pCoeffs		: numTaps coefficients, b[0] applies to the newest sample
+ * @param	numTaps		: Number of taps, at least 1
+ * @param	pState		: DSP_FIR_STATE_SIZE(numTaps) samples of history, cleared here
+ * @return	Nothing
+ */
+void DSP_FIR_Init_Q31(DSP_FIR_Q31_T *pFIR, const int32_t *pCoeffs, uint16_t numTaps, int32_t *pState);
+
+/**
+ * @brief	Filter a block of Q31 samples
+ * @param	pFIR	: Filter instance
+ * @param	pSrc	: Input samples
+ * @param	pDst	: Output samples, may be pSrc
+ * @param	count	: Number of samples
+ * @return	Nothing
+ * @note	Accumulates in 64 bits.
+ */
+HOTFUNC void DSP_FIR_Q31(DSP_FIR_Q31_T *pFIR, const int32_t *pSrc, int32_t *pDst, uint32_t count);
+
+/**
+ * @brief	Initialize a Q15 FIR decimator
+ * @param	pDecim		: Decimator instance
+ * @param	factor		: Decimation factor, at least 1
+ * @param	pCoeffs		: numTaps anti-aliasing filter coefficients
+ * @param	numTaps		: Number of taps, at least 1
+ * @param	pState		: DSP_FIR_STATE_SIZE(numTaps) samples of history, cleared here
+ * @return	Nothing
+ */
+void DSP_Decimate_Init_Q15(DSP_DECIM_Q15_T *pDecim, uint16_t factor, const int16_t *pCoeffs,
+						   uint16_t numTaps, int16_t *pState);
+
+/**
+ * @brief	Filter and decimate a block of Q15 samples
+ * @param	pDecim	: Decimator instance
+ * @param	pSrc	: Input samples
+ * @param	pDst	: Output samples, room for count / factor + 1, may be pSrc
+ * @param	count	: Number of input samples, need not be a multiple of the factor
+ * @return	Number of output samples written
+ * @note	The filter is only evaluated for the samples that are kept.
+ */
+HOTFUNC uint32_t DSP_Decimate_Q15(DSP_DECIM_Q15_T *pDecim, const int16_t *pSrc, int16_t *pDst, uint32_t count);
+
+/**
+ * @brief	Initialize a Q15 biquad cascade
+ * @param	pIIR		: Filter instance
+ * @param	numStages	: Number of stages
+ * @param	pCoeffs		: 5 coefficients per stage
+ * @param	pState		: DSP_BIQUAD_STATE_SIZE(numStages) samples of history, cleared here
+ * @param	postShift	: Left shift of the results, 0 to 14
+ * @return	Nothing
+ */
+void DSP_Biquad_Init_Q15(DSP_BIQUAD_Q15_T *pIIR, uint8_t numStages, const int16_t *pCoeffs,
+						 int16_t *pState, uint8_t postShift);
+
+/**
+ * @brief	Filter a block of Q15 samples through a biquad cascade
+ * @param	pIIR	: Filter instance
+ * @param	pSrc	: Input samples
+ * @param	pDst	: Output samples, may be pSrc
+ * @param	count	: Number of samples
+ * @return	Nothing
+ */
+HOTFUNC void DSP_Biquad_Q15(DSP_BIQUAD_Q15_T *pIIR, const int16_t *pSrc, int16_t *pDst, uint32_t count);
+
+/**
+ * @brief	Initialize a Q31 biquad cascade
+ * @param	pIIR		: Filter instance
+ * @param	numStages	: Number of stages
+ * @param	pCoeffs		: 5 coefficients per stage
+ * @param	pState		: DSP_BIQUAD_STATE_SIZE(numStages) words of history, cleared here
+ * @param	postShift	: Left shift of the results, 0 to 30
+ * @return	Nothing
+ */
+void DSP_Biquad_Init_Q31(DSP_BIQUAD_Q31_T *pIIR, uint8_t numStages, const int32_t *pCoeffs,
+						 int32_t *pState, uint8_t postShift);
+
+/**
+ * @brief	Filter a block of Q31 samples through a biquad cascade
+ * @param	pIIR	: Filter instance
+ * @param	pSrc	: Input samples
+ * @param	pDst	: Output samples, may be pSrc
+ * @param	count	: Number of samples
+ * @return	Nothing
+ */
+HOTFUNC void DSP_Biquad_Q31(DSP_BIQUAD_Q31_T *pIIR, const int32_t *pSrc, int32_t *pDst, uint32_t count);
+
+/**
+ * @brief	Initialize a Q15 moving RMS
+ * @param	pRMS	: RMS instance
+ * @param	pWindow	: length samples of window, cleared here
+ * @param	length	: Window length, at least 1
+ * @return	Nothing
+ */
+void DSP_RMS_Init_Q15(DSP_RMS_Q15_T *pRMS, int16_t *pWindow, uint16_t length);
+
+/**
+ * @brief	Add a block of Q15 samples to a moving RMS
+ * @param	pRMS	: RMS instance
+ * @param	pSrc	: Input samples
+ * @param	count	: Number of samples
+ * @return	RMS of the last length samples, Q15
+ * @note	The sum of squares is updated per sample, the root is only
+ * taken once per call.
+ */
+HOTFUNC int16_t DSP_RMS_Q15(DSP_RMS_Q15_T *pRMS, const int16_t *pSrc, uint32_t count);
+
+/**
+ * @brief	Integer square root
+ * @param	value	: Value
+ * @return	floor(sqrt(value)), of a Q30 value this is the Q15 root
+ */
+uint32_t DSP_Sqrt_U32(uint32_t value);
+
+/**
+ * @brief	Update a CRC-32 (IEEE 802.3, as zlib and Ethernet)
+ * @param	crc		: CRC of the data so far, 0 to start
+ * @param	pData	: Data
+ * @param	size	: Number of bytes
+ * @return	CRC of the data so far including pData
+ */
+HOTFUNC uint32_t DSP_CRC32(uint32_t crc, const void *pData, uint32_t size);
+
+/**
+ * @}
+ */
+
+#endif /* __FIXDSP_H_ */
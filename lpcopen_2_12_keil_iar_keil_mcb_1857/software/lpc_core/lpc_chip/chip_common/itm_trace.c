@@ -0,0 +1,99 @@
+/*
+ * @brief Binary event trace over the ITM and SWO
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include "itm_trace.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* ITM lock access key */
+#define ITM_LAR_KEY             0xC5ACCE55
+
+/* TPIU selected pin protocol, asynchronous NRZ */
+#define TPI_SPPR_NRZ            2
+
+/* ATB ID of the ITM trace source */
+#define ITM_TRACE_BUS_ID        1
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+#if !defined(CORE_M0)
+/* Events dropped on a full ITM FIFO */
+volatile uint32_t itmTraceDropped;
+#endif
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Set up the SWO pin output and the trace stimulus ports */
+void ITM_Trace_Init(uint32_t baud)
+{
+#if !defined(CORE_M0)
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+	/* SWO in NRZ mode from the core clock, formatter bypassed */
+	TPI->SPPR = TPI_SPPR_NRZ;
+	TPI->ACPR = (SystemCoreClock / baud) - 1;
+	TPI->FFCR = TPI_FFCR_TrigIn_Msk;
+
+	/* Cycle counter for the event stamps, with an ITM synchronisation
+	   packet every 2^24 cycles so the decoder can lock on mid-stream */
+	DWT->CTRL = (DWT->CTRL & ~DWT_CTRL_SYNCTAP_Msk) | (1 << DWT_CTRL_SYNCTAP_Pos) |
+				DWT_CTRL_CYCCNTENA_Msk;
+
+	ITM->LAR = ITM_LAR_KEY;
+	ITM->TCR = (ITM_TRACE_BUS_ID << ITM_TCR_TraceBusID_Pos) | ITM_TCR_SWOENA_Msk |
+			   ITM_TCR_SYNCENA_Msk | ITM_TCR_ITMENA_Msk;
+	ITM->TPR = 0;
+	ITM->TER |= (1 << ITM_TRACE_PORT_EVENT) | (1 << ITM_TRACE_PORT_DATA);
+
+	itmTraceDropped = 0;
+#endif
+}
+
+/* Returns the number of events dropped on a full ITM FIFO */
+uint32_t ITM_Trace_GetDropped(void)
+{
+#if !defined(CORE_M0)
+	return itmTraceDropped;
+#else
+	return 0;
+#endif
+}
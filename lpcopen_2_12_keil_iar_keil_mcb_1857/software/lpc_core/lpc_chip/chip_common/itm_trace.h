@@ -0,0 +1,185 @@
+/*
+ * @brief Binary event trace over the ITM and SWO
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __ITM_TRACE_H_
+#define __ITM_TRACE_H_
+
+#include "lpc_types.h"
+#include "cmsis.h"
+
+/** @defgroup ITM_Trace CHIP: Binary event trace over the ITM and SWO
+ * @ingroup CHIP_Common
+ * Writes one 32-bit word per event to an ITM stimulus port: the event ID
+ * in bits 31:24 and the low 24 bits of the DWT cycle counter below it.
+ * Optional payload words follow on a second port. An event costs a
+ * handful of cycles and never waits: when the ITM FIFO is full the event
+ * is dropped and counted. Payload words of an accepted event wait for
+ * FIFO space, at most the SWO time of one packet. The host tool pctools/itm_decode.c in the
+ * usbd_rom_hid_generic example turns the SWO stream into a timeline.
+ *
+ * The ITM_TRACE*() macros only generate code when CHIP_ITM_TRACE_ENABLE
+ * is defined, so instrumentation can stay in the source of production
+ * builds. The M0 core of the LPC43xx has no ITM and never traces.
+ * @{
+ */
+
+/** Stimulus port of the event words */
+#ifndef ITM_TRACE_PORT_EVENT
+#define ITM_TRACE_PORT_EVENT    1
+#endif
+
+/** Stimulus port of the payload words */
+#ifndef ITM_TRACE_PORT_DATA
+#define ITM_TRACE_PORT_DATA     2
+#endif
+
+/** Event IDs of the instrumented drivers and examples. IDs from
+   ITM_EV_USER up are free for applications. *_ENTER and *_EXIT IDs are
+   paired by the decoder, which prints the time in between. */
+#define ITM_EV_USB_IRQ_ENTER    0x01	/*!< USB interrupt entry, payload: port, USBSTS_D */
+#define ITM_EV_USB_IRQ_EXIT     0x02	/*!< USB interrupt exit */
+#define ITM_EV_DCD_IRQ_ENTER    0x03	/*!< LPCUSBLib DcdIrqHandler() entry, payload: core, USBSTS_D */
+#define ITM_EV_DCD_IRQ_EXIT     0x04	/*!< LPCUSBLib DcdIrqHandler() exit */
+#define ITM_EV_ENET_IRQ_ENTER   0x05	/*!< Ethernet interrupt entry, payload: DMA_STAT */
+#define ITM_EV_ENET_IRQ_EXIT    0x06	/*!< Ethernet interrupt exit */
+#define ITM_EV_DMA_IRQ_ENTER    0x07	/*!< GPDMA job interrupt entry, payload: INTSTAT */
+#define ITM_EV_DMA_IRQ_EXIT     0x08	/*!< GPDMA job interrupt exit */
+#define ITM_EV_USER             0x40	/*!< First application event ID */
+
+#if defined(CHIP_ITM_TRACE_ENABLE) && !defined(CORE_M0)
+/** Trace event @a id */
+#define ITM_TRACE(id)           ITM_Trace_Event((id))
+/** Trace event @a id with one payload word */
+#define ITM_TRACE1(id, a)       ITM_Trace_Event1((id), (a))
+/** Trace event @a id with two payload words */
+#define ITM_TRACE2(id, a, b)    ITM_Trace_Event2((id), (a), (b))
+#else
+#define ITM_TRACE(id)
+#define ITM_TRACE1(id, a)
+#define ITM_TRACE2(id, a, b)
+#endif
+
+#if !defined(CORE_M0)
+/** Events dropped on a full ITM FIFO, see ITM_Trace_GetDropped() */
+extern volatile uint32_t itmTraceDropped;
+
+/* Event word of @a id at the current cycle count */
+#define ITM_TRACE_WORD(id)      (((uint32_t) (id) << 24) | (DWT->CYCCNT & 0x00FFFFFF))
+#endif
+
+/**
+ * @brief	Set up the SWO pin output and the trace stimulus ports
+ * @param	baud	: SWO bit rate, NRZ (UART) encoding
+ * @return	Nothing
+ * @note	Also starts the DWT cycle counter. A debugger that configures
+ *			SWO itself may overwrite the baud rate. SWO shares the TDO pin,
+ *			so trace needs a debugger in SWD mode.
+ */
+void ITM_Trace_Init(uint32_t baud);
+
+/**
+ * @brief	Returns the number of events dropped on a full ITM FIFO
+ * @return	Dropped events since ITM_Trace_Init()
+ */
+uint32_t ITM_Trace_GetDropped(void);
+
+#if !defined(CORE_M0)
+/**
+ * @brief	Trace an event
+ * @param	id	: Event ID, 0 to 255
+ * @return	Nothing
+ */
+STATIC INLINE void ITM_Trace_Event(uint32_t id)
+{
+	if (ITM->PORT[ITM_TRACE_PORT_EVENT].u32) {
+		ITM->PORT[ITM_TRACE_PORT_EVENT].u32 = ITM_TRACE_WORD(id);
+	}
+	else {
+		itmTraceDropped++;
+	}
+}
+
+/**
+ * @brief	Trace an event with one payload word
+ * @param	id	: Event ID, 0 to 255
+ * @param	a	: Payload word
+ * @return	Nothing
+ * @note	Interrupts are masked between the event and its payload, so an
+ *			event of a nested interrupt can't split them.
+ */
+STATIC INLINE void ITM_Trace_Event1(uint32_t id, uint32_t a)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (ITM->PORT[ITM_TRACE_PORT_EVENT].u32) {
+		ITM->PORT[ITM_TRACE_PORT_EVENT].u32 = ITM_TRACE_WORD(id);
+		while (ITM->PORT[ITM_TRACE_PORT_DATA].u32 == 0) {}
+		ITM->PORT[ITM_TRACE_PORT_DATA].u32 = a;
+	}
+	else {
+		itmTraceDropped++;
+	}
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief	Trace an event with two payload words
+ * @param	id	: Event ID, 0 to 255
+ * @param	a	: First payload word
+ * @param	b	: Second payload word
+ * @return	Nothing
+ */
+STATIC INLINE void ITM_Trace_Event2(uint32_t id, uint32_t a, uint32_t b)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (ITM->PORT[ITM_TRACE_PORT_EVENT].u32) {
+		ITM->PORT[ITM_TRACE_PORT_EVENT].u32 = ITM_TRACE_WORD(id);
+		while (ITM->PORT[ITM_TRACE_PORT_DATA].u32 == 0) {}
+		ITM->PORT[ITM_TRACE_PORT_DATA].u32 = a;
+		while (ITM->PORT[ITM_TRACE_PORT_DATA].u32 == 0) {}
+		ITM->PORT[ITM_TRACE_PORT_DATA].u32 = b;
+	}
+	else {
+		itmTraceDropped++;
+	}
+	__set_PRIMASK(primask);
+}
+
+#endif /* !defined(CORE_M0) */
+
+/**
+ * @}
+ */
+
+#endif /* __ITM_TRACE_H_ */
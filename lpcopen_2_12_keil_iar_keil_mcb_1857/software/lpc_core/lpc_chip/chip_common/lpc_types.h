@@ -205,6 +205,60 @@ typedef bool BOOL_8;
 #define INLINE inline
 #endif
 
+/* Execute a function from internal SRAM. The startup code copies it along
+   with the initialized data, so it runs at full speed when everything else
+   is executed in place from SPIFI. Keil builds need a RW execution region
+   in the scatter file that selects (.ramfunc). */
+#if defined(__ICCARM__)
+#define RAMFUNC __ramfunc
+#elif defined(__CC_ARM)
+#define RAMFUNC __attribute__ ((section(".ramfunc")))
+#else
+#define RAMFUNC __attribute__ ((section(".data.$RAM2.ramfunc"), noinline))
+#endif
+
+/* Marks code on the hot path (ISRs, ring buffers, DSP kernels). It only
+   moves to SRAM when CHIP_HOTFUNC_IN_RAM is defined, for SPIFI execute in
+   place or to keep the flash accelerator wait states and misses out of the
+   interrupt latency of internal flash builds. */
+#ifdef CHIP_HOTFUNC_IN_RAM
+#define HOTFUNC RAMFUNC
+#else
+#define HOTFUNC
+#endif
+
+/* Places a buffer that needs no zeroing in a section the start up code
+   leaves alone, so large DMA buffers and pools don't add to the start up
+   time. The contents are undefined until written. Keil builds need an UNINIT
+   execution region in the scatter file that selects (.bss.noinit), the
+   LPCXpresso linker scripts keep .bss.$RESERVED uninitialized. Without such
+   a region the buffer is simply zeroed as before. */
+#if defined(__ICCARM__)
+#define NOINIT __no_init
+#elif defined(__CC_ARM)
+#define NOINIT __attribute__ ((section(".bss.noinit"), zero_init))
+#else
+#define NOINIT __attribute__ ((section(".bss.$RESERVED")))
+#endif
+
+/* Places DMA descriptors and buffers (ENET rings, lwIP heap and pbufs) in
+   the first AHB SRAM block at 0x20000000. Each SRAM block is its own bus
+   matrix slave, so DMA traffic there doesn't stall the CPU's stack and
+   data accesses to local SRAM. LPCXpresso builds use the RAM3 (RamAHB32)
+   region, Keil builds need an execution region for (.bss.dmamem) in the
+   AHB SRAM and IAR builds a placement of the __no_init data there. Don't
+   rely on the start up contents. Define CHIP_DMAMEM_DEFAULT to leave the
+   placement to the linker. */
+#if defined(CHIP_DMAMEM_DEFAULT)
+#define DMAMEM
+#elif defined(__ICCARM__)
+#define DMAMEM __no_init
+#elif defined(__CC_ARM)
+#define DMAMEM __attribute__ ((section(".bss.dmamem"), zero_init))
+#else
+#define DMAMEM __attribute__ ((section(".bss.$RAM3")))
+#endif
+
 /**
  * @}
  */
@@ -0,0 +1,175 @@
+/*
+ * @brief Cycle accurate profiling regions
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include <string.h>
+#include "chip.h"
+#include "profile.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+static PROFILE_REGION_T regions[PROFILE_MAX_REGIONS];
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Histogram bin of a duration */
+STATIC INLINE int histBin(uint32_t ticks)
+{
+	int lg;
+
+#if defined(CORE_M0)
+	lg = 0;
+	while (ticks >>= 1) {
+		lg++;
+	}
+#else
+	lg = ticks ? (31 - __CLZ(ticks)) : 0;
+#endif
+	lg /= PROFILE_HIST_LOG2_STEP;
+
+	return (lg < PROFILE_HIST_BINS) ? lg : (PROFILE_HIST_BINS - 1);
+}
+
+/* Clear one region, keeps the name */
+static void clearRegion(PROFILE_REGION_T *pRegion)
+{
+	const char *name = pRegion->name;
+
+	memset(pRegion, 0, sizeof(*pRegion));
+	pRegion->name = name;
+	pRegion->min = 0xFFFFFFFF;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start the time base and clear all regions */
+void Profile_Init(void)
+{
+#if defined(CORE_M0)
+	StopWatch_Init();
+#else
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	Profile_Reset(-1);
+}
+
+/* Name a region */
+void Profile_SetName(int region, const char *name)
+{
+	if ((region >= 0) && (region < PROFILE_MAX_REGIONS)) {
+		regions[region].name = name;
+	}
+}
+
+/* Account one pass of a region */
+void Profile_Account(int region, uint32_t start)
+{
+	uint32_t ticks = Profile_Now() - start;
+	PROFILE_REGION_T *pRegion;
+	uint32_t primask;
+	int bin;
+
+	if ((region < 0) || (region >= PROFILE_MAX_REGIONS)) {
+		return;
+	}
+	pRegion = &regions[region];
+	bin = histBin(ticks);
+
+	/* An ISR timing the same region must not interleave its update */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (ticks < pRegion->min) {
+		pRegion->min = ticks;
+	}
+	if (ticks > pRegion->max) {
+		pRegion->max = ticks;
+	}
+	pRegion->sum += ticks;
+	pRegion->count++;
+	pRegion->hist[bin]++;
+	__set_PRIMASK(primask);
+}
+
+/* Take a consistent copy of a region */
+void Profile_Get(int region, PROFILE_REGION_T *pSnap)
+{
+	uint32_t primask;
+
+	if ((region < 0) || (region >= PROFILE_MAX_REGIONS)) {
+		memset(pSnap, 0, sizeof(*pSnap));
+		return;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*pSnap = regions[region];
+	__set_PRIMASK(primask);
+
+	if (pSnap->count == 0) {
+		pSnap->min = 0;
+	}
+}
+
+/* Clear the statistics of one or all regions */
+void Profile_Reset(int region)
+{
+	uint32_t primask;
+	int i;
+
+	for (i = 0; i < PROFILE_MAX_REGIONS; i++) {
+		if ((region < 0) || (region == i)) {
+			primask = __get_PRIMASK();
+			__disable_irq();
+			clearRegion(&regions[i]);
+			__set_PRIMASK(primask);
+		}
+	}
+}
+
+/* Returns the rate of the profiling time base */
+uint32_t Profile_TicksPerSecond(void)
+{
+#if defined(CORE_M0)
+	return StopWatch_TicksPerSecond();
+#else
+	return SystemCoreClock;
+#endif
+}
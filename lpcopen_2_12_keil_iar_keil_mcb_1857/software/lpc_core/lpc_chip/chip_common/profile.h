@@ -0,0 +1,161 @@
+/*
+ * @brief Cycle accurate profiling regions
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __PROFILE_H_
+#define __PROFILE_H_
+
+#include "lpc_types.h"
+#include "cmsis.h"
+#include "stopwatch.h"
+
+/** @defgroup Profile CHIP: Profiling regions
+ * @ingroup CHIP_Common
+ * Measures named code regions continuously. Each region keeps count,
+ * minimum, maximum, sum and a log2 histogram of its durations in a
+ * static table. The Cortex-M3/M4 cores time with the DWT cycle counter,
+ * the M0 core of the LPC43xx has no DWT and uses the StopWatch timer.
+ * Updates briefly mask interrupts, so a region may be timed from any
+ * ISR and read from thread level.
+ *
+ * The PROFILE_ENTER()/PROFILE_EXIT() macros only generate code when
+ * CHIP_PROFILE_ENABLE is defined, so instrumentation can stay in the
+ * source of production builds.
+ * @{
+ */
+
+/** Number of regions in the static table */
+#ifndef PROFILE_MAX_REGIONS
+#define PROFILE_MAX_REGIONS     16
+#endif
+
+/** Number of histogram bins per region */
+#define PROFILE_HIST_BINS       8
+
+/** Each histogram bin spans 2^PROFILE_HIST_LOG2_STEP times the previous
+   one: bin 0 counts durations below 8 ticks, bin 1 below 64 ticks, the
+   last bin everything from 2^21 ticks up */
+#define PROFILE_HIST_LOG2_STEP  3
+
+/**
+ * @brief Statistics of one profiling region
+ */
+typedef struct {
+	const char *name;					/*!< Region name, NULL when unnamed */
+	uint32_t count;						/*!< Number of timed passes */
+	uint32_t min;						/*!< Shortest pass in ticks */
+	uint32_t max;						/*!< Longest pass in ticks */
+	uint64_t sum;						/*!< Sum of all passes in ticks */
+	uint32_t hist[PROFILE_HIST_BINS];	/*!< Log2 histogram of the passes */
+} PROFILE_REGION_T;
+
+#ifdef CHIP_PROFILE_ENABLE
+/** Start timing @a region, an integer constant with an identifier name */
+#define PROFILE_ENTER(region)   uint32_t profStart_##region = Profile_Now()
+/** Stop timing @a region and account the pass */
+#define PROFILE_EXIT(region)    Profile_Account((region), profStart_##region)
+#else
+#define PROFILE_ENTER(region)
+#define PROFILE_EXIT(region)
+#endif
+
+/**
+ * @brief	Start the time base and clear all regions
+ * @return	Nothing
+ * @note	Region names are kept, call Profile_SetName() once per region.
+ */
+void Profile_Init(void);
+
+/**
+ * @brief	Name a region for the dump
+ * @param	region	: Region index, 0 to PROFILE_MAX_REGIONS - 1
+ * @param	name	: Constant string, not copied
+ * @return	Nothing
+ */
+void Profile_SetName(int region, const char *name);
+
+/**
+ * @brief	Read the profiling time base
+ * @return	Current DWT cycle count, or StopWatch ticks on the M0 core
+ */
+STATIC INLINE uint32_t Profile_Now(void)
+{
+#if defined(CORE_M0)
+	return StopWatch_Start();
+#else
+	return DWT->CYCCNT;
+#endif
+}
+
+/**
+ * @brief	Account one pass of a region
+ * @param	region	: Region index
+ * @param	start	: Value of Profile_Now() at region entry
+ * @return	Nothing
+ * @note	Safe to call from any interrupt priority.
+ */
+void Profile_Account(int region, uint32_t start);
+
+/**
+ * @brief	Take a consistent copy of a region
+ * @param	region	: Region index
+ * @param	pSnap	: Where to store the copy
+ * @return	Nothing
+ */
+void Profile_Get(int region, PROFILE_REGION_T *pSnap);
+
+/**
+ * @brief	Clear the statistics of one or all regions
+ * @param	region	: Region index, or -1 for all regions
+ * @return	Nothing
+ */
+void Profile_Reset(int region);
+
+/**
+ * @brief	Returns the rate of the profiling time base
+ * @return	Ticks per second
+ */
+uint32_t Profile_TicksPerSecond(void);
+
+/**
+ * @brief	Returns the mean duration of a region copy
+ * @param	pSnap	: Region copy from Profile_Get()
+ * @return	Mean pass in ticks, 0 if the region never ran
+ */
+STATIC INLINE uint32_t Profile_Mean(const PROFILE_REGION_T *pSnap)
+{
+	return pSnap->count ? (uint32_t) (pSnap->sum / pSnap->count) : 0;
+}
+
+/**
+ * @}
+ */
+
+#endif /* __PROFILE_H_ */
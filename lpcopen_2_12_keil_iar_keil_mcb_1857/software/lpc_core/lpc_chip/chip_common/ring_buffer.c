@@ -30,6 +30,8 @@
  */
 
 #include <string.h>
+#include "sys_config.h"
+#include "cmsis.h"
 #include "ring_buffer.h"
 
 /*****************************************************************************
@@ -63,7 +65,7 @@ int RingBuffer_Init(RINGBUFF_T *RingBuff, void *buffer, int itemSize, int count)
 }
 
 /* Insert a single item into Ring Buffer */
-int RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data)
+HOTFUNC int RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data)
 {
 	uint8_t *ptr = RingBuff->data;
 
@@ -73,13 +75,16 @@ int RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data)
 
 	ptr += RB_INDH(RingBuff) * RingBuff->itemSz;
 	memcpy(ptr, data, RingBuff->itemSz);
-	RingBuff->head++;
+
+	/* Item must be visible before the consumer can see the new head */
+	__DMB();
+	RB_VHEAD(RingBuff) = RingBuff->head + 1;
 
 	return 1;
 }
 
 /* Insert multiple items into Ring Buffer */
-int RingBuffer_InsertMult(RINGBUFF_T *RingBuff, const void *data, int num)
+HOTFUNC int RingBuffer_InsertMult(RINGBUFF_T *RingBuff, const void *data, int num)
 {
 	uint8_t *ptr = RingBuff->data;
 	int cnt1, cnt2;
@@ -103,19 +108,20 @@ int RingBuffer_InsertMult(RINGBUFF_T *RingBuff, const void *data, int num)
 	/* Write segment 1 */
 	ptr += RB_INDH(RingBuff) * RingBuff->itemSz;
 	memcpy(ptr, data, cnt1 * RingBuff->itemSz);
-	RingBuff->head += cnt1;
 
-	/* Write segment 2 */
-	ptr = (uint8_t *) RingBuff->data + RB_INDH(RingBuff) * RingBuff->itemSz;
+	/* Write segment 2, which always starts at the wrap */
 	data = (const uint8_t *) data + cnt1 * RingBuff->itemSz;
-	memcpy(ptr, data, cnt2 * RingBuff->itemSz);
-	RingBuff->head += cnt2;
+	memcpy(RingBuff->data, data, cnt2 * RingBuff->itemSz);
+
+	/* Publish both segments at once */
+	__DMB();
+	RB_VHEAD(RingBuff) = RingBuff->head + cnt1 + cnt2;
 
 	return cnt1 + cnt2;
 }
 
 /* Pop single item from Ring Buffer */
-int RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data)
+HOTFUNC int RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data)
 {
 	uint8_t *ptr = RingBuff->data;
 
@@ -123,15 +129,20 @@ int RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data)
 	if (RingBuffer_IsEmpty(RingBuff))
 		return 0;
 
+	/* Item must not be read before the head that covers it */
+	__DMB();
 	ptr += RB_INDT(RingBuff) * RingBuff->itemSz;
 	memcpy(data, ptr, RingBuff->itemSz);
-	RingBuff->tail++;
+
+	/* Item must be read before the producer can reuse its slot */
+	__DMB();
+	RB_VTAIL(RingBuff) = RingBuff->tail + 1;
 
 	return 1;
 }
 
 /* Pop multiple items from Ring buffer */
-int RingBuffer_PopMult(RINGBUFF_T *RingBuff, void *data, int num)
+HOTFUNC int RingBuffer_PopMult(RINGBUFF_T *RingBuff, void *data, int num)
 {
 	uint8_t *ptr = RingBuff->data;
 	int cnt1, cnt2;
@@ -152,16 +163,64 @@ int RingBuffer_PopMult(RINGBUFF_T *RingBuff, void *data, int num)
 	cnt2 = MIN(cnt2, num);
 	num -= cnt2;
 
-	/* Write segment 1 */
+	__DMB();
+
+	/* Read segment 1 */
 	ptr += RB_INDT(RingBuff) * RingBuff->itemSz;
 	memcpy(data, ptr, cnt1 * RingBuff->itemSz);
-	RingBuff->tail += cnt1;
 
-	/* Write segment 2 */
-	ptr = (uint8_t *) RingBuff->data + RB_INDT(RingBuff) * RingBuff->itemSz;
+	/* Read segment 2, which always starts at the wrap */
 	data = (uint8_t *) data + cnt1 * RingBuff->itemSz;
-	memcpy(data, ptr, cnt2 * RingBuff->itemSz);
-	RingBuff->tail += cnt2;
+	memcpy(data, RingBuff->data, cnt2 * RingBuff->itemSz);
+
+	/* Release both segments at once */
+	__DMB();
+	RB_VTAIL(RingBuff) = RingBuff->tail + cnt1 + cnt2;
 
 	return cnt1 + cnt2;
 }
+
+/* Get the largest contiguous free region */
+int RingBuffer_GetWritePtr(RINGBUFF_T *RingBuff, void **ptr)
+{
+	int cnt = RingBuffer_GetFree(RingBuff);
+
+	if (RB_INDH(RingBuff) + cnt >= RingBuff->count)
+		cnt = RingBuff->count - RB_INDH(RingBuff);
+
+	*ptr = (uint8_t *) RingBuff->data + RB_INDH(RingBuff) * RingBuff->itemSz;
+
+	return cnt;
+}
+
+/* Publish items written in place */
+void RingBuffer_CommitWrite(RINGBUFF_T *RingBuff, int num)
+{
+	/* Items must be visible before the consumer can see the new head */
+	__DMB();
+	RB_VHEAD(RingBuff) = RingBuff->head + num;
+}
+
+/* Get the largest contiguous filled region */
+int RingBuffer_GetReadPtr(RINGBUFF_T *RingBuff, void **ptr)
+{
+	int cnt = RingBuffer_GetCount(RingBuff);
+
+	if (RB_INDT(RingBuff) + cnt >= RingBuff->count)
+		cnt = RingBuff->count - RB_INDT(RingBuff);
+
+	*ptr = (uint8_t *) RingBuff->data + RB_INDT(RingBuff) * RingBuff->itemSz;
+
+	/* Items must not be read before the head that covers them */
+	__DMB();
+
+	return cnt;
+}
+
+/* Release items read in place */
+void RingBuffer_CommitRead(RINGBUFF_T *RingBuff, int num)
+{
+	/* Items must be read before the producer can reuse their slots */
+	__DMB();
+	RB_VTAIL(RingBuff) = RingBuff->tail + num;
+}
@@ -33,9 +33,16 @@
 #define __RING_BUFFER_H_
 
 #include "lpc_types.h"
+#include "cmsis.h"
 
 /** @defgroup Ring_Buffer CHIP: Simple ring buffer implementation
  * @ingroup CHIP_Common
+ * The ring buffer is lock-free for one producer and one consumer: only
+ * the insert functions write the head and only the pop functions write
+ * the tail, and each publishes its index with a __DMB() after the data
+ * it covers. Either side may run in an ISR, or on the other core,
+ * without disabling interrupts. Two producers or two consumers still
+ * need their own locking.
  * @{
  */
 
@@ -135,6 +142,45 @@ STATIC INLINE int RingBuffer_IsEmpty(RINGBUFF_T *RingBuff)
 	return RB_VHEAD(RingBuff) == RB_VTAIL(RingBuff);
 }
 
+/**
+ * @def		RINGBUFFER_DEFINE_TYPED(suffix, type)
+ * Generates RingBuffer_Insert<suffix>() and RingBuffer_Pop<suffix>() for
+ * a ring buffer whose item size is sizeof(@a type). The item is moved with
+ * a single load and store instead of memcpy(), with the same lock-free
+ * single-producer/single-consumer ordering as RingBuffer_Insert() and
+ * RingBuffer_Pop(). The ring buffer must have been initialized with
+ * itemSize equal to sizeof(@a type) and storage aligned to it.
+ */
+#define RINGBUFFER_DEFINE_TYPED(suffix, type)										\
+	STATIC INLINE int RingBuffer_Insert ## suffix(RINGBUFF_T *RingBuff, type item)	\
+	{																				\
+		if (RingBuffer_IsFull(RingBuff))											\
+			return 0;																\
+		((type *) RingBuff->data)[RingBuff->head & (RingBuff->count - 1)] = item;	\
+		__DMB();																	\
+		RB_VHEAD(RingBuff) = RingBuff->head + 1;									\
+		return 1;																	\
+	}																				\
+	STATIC INLINE int RingBuffer_Pop ## suffix(RINGBUFF_T *RingBuff, type *item)	\
+	{																				\
+		if (RingBuffer_IsEmpty(RingBuff))											\
+			return 0;																\
+		__DMB();																	\
+		*item = ((type *) RingBuff->data)[RingBuff->tail & (RingBuff->count - 1)];	\
+		__DMB();																	\
+		RB_VTAIL(RingBuff) = RingBuff->tail + 1;									\
+		return 1;																	\
+	}
+
+/* RingBuffer_Insert8()/RingBuffer_Pop8() for byte streams such as UART data */
+RINGBUFFER_DEFINE_TYPED(8, uint8_t)
+
+/* RingBuffer_Insert16()/RingBuffer_Pop16() for 2 byte items */
+RINGBUFFER_DEFINE_TYPED(16, uint16_t)
+
+/* RingBuffer_Insert32()/RingBuffer_Pop32() for 4 byte items */
+RINGBUFFER_DEFINE_TYPED(32, uint32_t)
+
 /**
  * @brief	Insert a single item into ring buffer
  * @param	RingBuff	: Pointer to ring buffer
@@ -144,7 +190,7 @@ STATIC INLINE int RingBuffer_IsEmpty(RINGBUFF_T *RingBuff)
  *			RingBuffer_Init() or attempted to insert
  *			when buffer is full)
  */
-int RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data);
+HOTFUNC int RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data);
 
 /**
  * @brief	Insert an array of items into ring buffer
@@ -156,7 +202,7 @@ int RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data);
  *			RingBuffer_Init() or attempted to insert
  *			when buffer is full)
  */
-int RingBuffer_InsertMult(RINGBUFF_T *RingBuff, const void *data, int num);
+HOTFUNC int RingBuffer_InsertMult(RINGBUFF_T *RingBuff, const void *data, int num);
 
 /**
  * @brief	Pop an item from the ring buffer
@@ -167,7 +213,7 @@ int RingBuffer_InsertMult(RINGBUFF_T *RingBuff, const void *data, int num);
  * 			RingBuffer_Init() or attempted to pop item when
  * 			the buffer is empty)
  */
-int RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data);
+HOTFUNC int RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data);
 
 /**
  * @brief	Pop an array of items from the ring buffer
@@ -178,7 +224,48 @@ int RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data);
  * 			0 on error (Buffer not initialized using RingBuffer_Init()
  * 			or attempted to pop when the buffer is empty)
  */
-int RingBuffer_PopMult(RINGBUFF_T *RingBuff, void *data, int num);
+HOTFUNC int RingBuffer_PopMult(RINGBUFF_T *RingBuff, void *data, int num);
+
+/**
+ * @brief	Get the largest contiguous free region of the ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	ptr			: Pointer to where the address of the region is stored
+ * @return	Number of items that can be written at @a ptr, 0 when full
+ * @note	Lets a DMA engine or USB endpoint fill ring storage in place.
+ *			The items become visible to the consumer only once
+ *			RingBuffer_CommitWrite() is called. A second call after a
+ *			partial commit returns the region past the wrap.
+ */
+int RingBuffer_GetWritePtr(RINGBUFF_T *RingBuff, void **ptr);
+
+/**
+ * @brief	Publish items written in place into the ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	num			: Number of items written, at most the count
+ *						  returned by RingBuffer_GetWritePtr()
+ * @return	Nothing
+ */
+void RingBuffer_CommitWrite(RINGBUFF_T *RingBuff, int num);
+
+/**
+ * @brief	Get the largest contiguous filled region of the ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	ptr			: Pointer to where the address of the region is stored
+ * @return	Number of items that can be read at @a ptr, 0 when empty
+ * @note	Lets a DMA engine or USB endpoint drain ring storage in
+ *			place. The items stay owned by the consumer until
+ *			RingBuffer_CommitRead() is called.
+ */
+int RingBuffer_GetReadPtr(RINGBUFF_T *RingBuff, void **ptr);
+
+/**
+ * @brief	Release items read in place from the ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	num			: Number of items consumed, at most the count
+ *						  returned by RingBuffer_GetReadPtr()
+ * @return	Nothing
+ */
+void RingBuffer_CommitRead(RINGBUFF_T *RingBuff, int num);
 
 
 /**
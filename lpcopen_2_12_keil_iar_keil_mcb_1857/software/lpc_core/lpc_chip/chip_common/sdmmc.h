@@ -275,6 +275,9 @@ typedef struct {
 #define SD_APP_OP_COND           41		/* bcr  [31:0]  OCR        R1 (R4)  */
 #define SD_APP_SEND_SCR          51		/* adtc                    R1   */
 
+/* class 10 */
+#define SD_SWITCH                 6		/* adtc [31:0]  mode/funcs R1   */
+
 /**
  * @brief MMC status in R1<br>
  * Type<br>
@@ -407,6 +410,8 @@ typedef struct {
 #define CARD_TYPE_SD    (1 << 0)
 #define CARD_TYPE_4BIT  (1 << 1)
 #define CARD_TYPE_8BIT  (1 << 2)
+#define CARD_TYPE_CMD23 (1 << 3)	/*!< card supports SET_BLOCK_COUNT before multiple block transfers */
+#define CARD_TYPE_HS    (1 << 4)	/*!< card runs in high speed mode */
 #define CARD_TYPE_HC    (OCR_HC_CCS)/*!< high capacity card > 2GB */
 
 /**
@@ -439,6 +444,11 @@ typedef struct {
  */
 #define SD_MAX_CLOCK            25000000
 
+/**
+ * @brief Max SD clock rate in high speed mode
+ */
+#define SD_HS_MAX_CLOCK         50000000
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,100 @@
+/*
+ * @brief Common USB RAM arena allocator
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "usb_mem.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Track peak usage */
+static void UsbMem_Mark(USBMEM_T *pMem)
+{
+	uint32_t used = pMem->mem_base - pMem->start;
+
+	if (used > pMem->high_water) {
+		pMem->high_water = used;
+	}
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Initialize USB RAM arena */
+void UsbMem_Init(USBMEM_T *pMem, uint32_t base, uint32_t size)
+{
+	pMem->mem_base = pMem->start = base;
+	pMem->mem_size = pMem->size = size;
+	pMem->high_water = 0;
+	pMem->overflow = 0;
+}
+
+/* Allocate aligned block from USB RAM arena */
+void *UsbMem_Alloc(USBMEM_T *pMem, uint32_t size, uint32_t align)
+{
+	uint32_t addr = (pMem->mem_base + align - 1) & ~(align - 1);
+	uint32_t need = (addr - pMem->mem_base) + size;
+
+	if (need > pMem->mem_size) {
+		pMem->overflow += need - pMem->mem_size;
+		return NULL;
+	}
+	pMem->mem_base += need;
+	pMem->mem_size -= need;
+	UsbMem_Mark(pMem);
+
+	return (void *) addr;
+}
+
+/* Account memory taken by a USB ROM init call */
+ErrorCode_t UsbMem_Update(USBMEM_T *pMem, uint32_t mem_base, uint32_t mem_size)
+{
+	/* the ROM only ever takes memory from the front of the free area */
+	if ((mem_base < pMem->mem_base) || (mem_base > (pMem->start + pMem->size)) ||
+		((mem_base + mem_size) != (pMem->start + pMem->size))) {
+		pMem->overflow++;
+		return ERR_FAILED;
+	}
+	pMem->mem_base = mem_base;
+	pMem->mem_size = mem_size;
+	UsbMem_Mark(pMem);
+
+	return LPC_OK;
+}
@@ -0,0 +1,113 @@
+/*
+ * @brief Common USB RAM arena allocator
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __USB_MEM_H_
+#define __USB_MEM_H_
+
+#include "lpc_types.h"
+#include "error.h"
+
+/** @defgroup USB_Mem CHIP: USB RAM arena allocator
+ * @ingroup CHIP_Common
+ * Bump allocator over the USB accessible memory window handed to the USB ROM
+ * stack. The mem_base and mem_size members track the free part of the window
+ * with the same meaning as the ROM driver init parameters, so they can be
+ * handed to (and updated by) the ROM init calls directly.
+ * @{
+ */
+
+/**
+ * @brief USB RAM arena structure
+ */
+typedef struct {
+	uint32_t mem_base;		/*!< Start of free memory, as passed to USB ROM init calls */
+	uint32_t mem_size;		/*!< Size of free memory, as passed to USB ROM init calls */
+	uint32_t start;			/*!< Start of the whole USB RAM window */
+	uint32_t size;			/*!< Size of the whole USB RAM window */
+	uint32_t high_water;	/*!< Most bytes of the window ever in use */
+	uint32_t overflow;		/*!< Bytes requested that did not fit, non-zero after any failure */
+} USBMEM_T;
+
+/**
+ * @brief	Initialize USB RAM arena
+ * @param	pMem	: Pointer to arena to initialize
+ * @param	base	: Start of the USB accessible memory window
+ * @param	size	: Size of the USB accessible memory window
+ * @return	Nothing
+ */
+void UsbMem_Init(USBMEM_T *pMem, uint32_t base, uint32_t size);
+
+/**
+ * @brief	Allocate a block from the USB RAM arena
+ * @param	pMem	: Pointer to arena
+ * @param	size	: Number of bytes to allocate
+ * @param	align	: Alignment of the block in bytes, must be a power of 2
+ * @return	Pointer to the block or NULL when it does not fit the window,
+ *			in which case the shortfall is added to pMem->overflow.
+ */
+void *UsbMem_Alloc(USBMEM_T *pMem, uint32_t size, uint32_t align);
+
+/**
+ * @brief	Account memory taken by a USB ROM init call
+ * @param	pMem	: Pointer to arena
+ * @param	mem_base: Value of mem_base returned by the ROM init call
+ * @param	mem_size: Value of mem_size returned by the ROM init call
+ * @return	LPC_OK on success, or ERR_FAILED when the returned values fall
+ *			outside the window or do not add up to its end.
+ */
+ErrorCode_t UsbMem_Update(USBMEM_T *pMem, uint32_t mem_base, uint32_t mem_size);
+
+/**
+ * @brief	Return number of bytes currently in use
+ * @param	pMem	: Pointer to arena
+ * @return	Bytes of the window in use
+ */
+STATIC INLINE uint32_t UsbMem_GetUsed(USBMEM_T *pMem)
+{
+	return pMem->mem_base - pMem->start;
+}
+
+/**
+ * @brief	Return high water mark of the arena
+ * @param	pMem	: Pointer to arena
+ * @return	Most bytes of the window ever in use. Use it to size
+ *			USB_STACK_MEM_SIZE tightly.
+ */
+STATIC INLINE uint32_t UsbMem_GetHighWater(USBMEM_T *pMem)
+{
+	return pMem->high_water;
+}
+
+/**
+ * @}
+ */
+
+#endif /* __USB_MEM_H_ */
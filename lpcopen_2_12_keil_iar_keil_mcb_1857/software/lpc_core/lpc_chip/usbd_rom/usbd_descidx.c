@@ -0,0 +1,196 @@
+/*
+ * @brief USB ROM stack configuration descriptor index
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include <string.h>
+#include "usbd_descidx.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Built instances, looked up by handle */
+static USBDESCIDX_T *g_descIdx[USBD_DESCIDX_MAX_INST];
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Find the table of an indexed USB stack */
+static USBDESCIDX_SPEED_T *UsbDescIdx_Get(USBD_HANDLE_T hUsb, uint32_t speed)
+{
+	uint32_t i;
+
+	for (i = 0; i < USBD_DESCIDX_MAX_INST; i++) {
+		if ((g_descIdx[i] != NULL) && (g_descIdx[i]->hUsb == hUsb)) {
+			return &g_descIdx[i]->speed[(speed == USB_HIGH_SPEED) ? 1 : 0];
+		}
+	}
+	return NULL;
+}
+
+/* Walk one configuration descriptor into its table */
+static ErrorCode_t UsbDescIdx_Parse(USBDESCIDX_SPEED_T *pTbl, const uint8_t *pDesc)
+{
+	USB_COMMON_DESCRIPTOR *pD;
+	USB_INTERFACE_DESCRIPTOR *pIntfDesc;
+	USBDESCIDX_INTF_T *pIntf = NULL;
+	uint32_t i;
+
+	memset(pTbl, 0, sizeof(USBDESCIDX_SPEED_T));
+	if (pDesc == NULL) {
+		return LPC_OK;
+	}
+
+	for (pD = (USB_COMMON_DESCRIPTOR *) pDesc; pD->bLength;
+		 pD = (USB_COMMON_DESCRIPTOR *) ((uint32_t) pD + pD->bLength)) {
+		switch (pD->bDescriptorType) {
+		case USB_INTERFACE_DESCRIPTOR_TYPE:
+			pIntfDesc = (USB_INTERFACE_DESCRIPTOR *) pD;
+			/* alternate settings share the entry of their interface */
+			for (i = 0; i < pTbl->num_intf; i++) {
+				if (pTbl->intf[i].pIntf->bInterfaceNumber == pIntfDesc->bInterfaceNumber) {
+					break;
+				}
+			}
+			if (i == pTbl->num_intf) {
+				if (i == USBD_DESCIDX_MAX_INTF) {
+					return ERR_FAILED;
+				}
+				pTbl->intf[i].pIntf = pIntfDesc;
+				pTbl->intf[i].ep_first = pTbl->num_ep;
+				pTbl->num_intf++;
+			}
+			pIntf = &pTbl->intf[i];
+			break;
+
+		case USB_ENDPOINT_DESCRIPTOR_TYPE:
+			if (pTbl->num_ep == USBD_DESCIDX_MAX_EP) {
+				return ERR_FAILED;
+			}
+			pTbl->ep[pTbl->num_ep++] = (USB_ENDPOINT_DESCRIPTOR *) pD;
+			if (pIntf != NULL) {
+				pIntf->ep_num++;
+			}
+			break;
+		}
+	}
+	return LPC_OK;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Build the descriptor index of a USB stack instance */
+ErrorCode_t UsbDescIdx_Build(USBDESCIDX_T *pIdx, USBD_HANDLE_T hUsb, const USB_CORE_DESCS_T *pDesc)
+{
+	uint32_t i;
+
+	for (i = 0; i < USBD_DESCIDX_MAX_INST; i++) {
+		if ((g_descIdx[i] == NULL) || (g_descIdx[i] == pIdx)) {
+			break;
+		}
+	}
+	if (i == USBD_DESCIDX_MAX_INST) {
+		return ERR_FAILED;
+	}
+
+	pIdx->hUsb = hUsb;
+	if ((UsbDescIdx_Parse(&pIdx->speed[0], pDesc->full_speed_desc) != LPC_OK) ||
+		(UsbDescIdx_Parse(&pIdx->speed[1], pDesc->high_speed_desc) != LPC_OK)) {
+		return ERR_FAILED;
+	}
+	g_descIdx[i] = pIdx;
+
+	return LPC_OK;
+}
+
+/* Find the first interface of a class */
+USB_INTERFACE_DESCRIPTOR *UsbDescIdx_FindIntf(USBD_HANDLE_T hUsb, uint32_t speed, uint32_t intfClass)
+{
+	USBDESCIDX_SPEED_T *pTbl = UsbDescIdx_Get(hUsb, speed);
+	uint32_t i;
+
+	if (pTbl != NULL) {
+		for (i = 0; i < pTbl->num_intf; i++) {
+			if (pTbl->intf[i].pIntf->bInterfaceClass == intfClass) {
+				return pTbl->intf[i].pIntf;
+			}
+		}
+	}
+	return NULL;
+}
+
+/* Find an interface by number */
+USB_INTERFACE_DESCRIPTOR *UsbDescIdx_FindIntfNum(USBD_HANDLE_T hUsb, uint32_t speed, uint32_t intfNum)
+{
+	USBDESCIDX_SPEED_T *pTbl = UsbDescIdx_Get(hUsb, speed);
+	uint32_t i;
+
+	if (pTbl != NULL) {
+		for (i = 0; i < pTbl->num_intf; i++) {
+			if (pTbl->intf[i].pIntf->bInterfaceNumber == intfNum) {
+				return pTbl->intf[i].pIntf;
+			}
+		}
+	}
+	return NULL;
+}
+
+/* Find an endpoint descriptor */
+USB_ENDPOINT_DESCRIPTOR *UsbDescIdx_FindEp(USBD_HANDLE_T hUsb, uint32_t speed, uint32_t epAddr)
+{
+	USBDESCIDX_SPEED_T *pTbl = UsbDescIdx_Get(hUsb, speed);
+	uint32_t i;
+
+	if (pTbl != NULL) {
+		for (i = 0; i < pTbl->num_ep; i++) {
+			if (pTbl->ep[i]->bEndpointAddress == epAddr) {
+				return pTbl->ep[i];
+			}
+		}
+	}
+	return NULL;
+}
+
+/* Packet size of an endpoint at the negotiated speed */
+uint32_t UsbDescIdx_GetMaxPacket(USBD_HANDLE_T hUsb, uint32_t epAddr)
+{
+	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;
+	USB_ENDPOINT_DESCRIPTOR *pEp = UsbDescIdx_FindEp(hUsb, pCtrl->device_speed, epAddr);
+
+	return (pEp != NULL) ? (pEp->wMaxPacketSize & 0x7FF) : 0;
+}
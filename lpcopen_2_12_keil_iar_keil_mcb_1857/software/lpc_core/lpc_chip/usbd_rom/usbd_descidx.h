@@ -0,0 +1,135 @@
+/*
+ * @brief USB ROM stack configuration descriptor index
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __USBD_DESCIDX_H_
+#define __USBD_DESCIDX_H_
+
+#include "usbd_rom_api.h"
+
+/** @defgroup USBD_DescIdx USBD: Cached configuration descriptor index
+ * @ingroup Group_USBD
+ * UsbDescIdx_Build() walks the full-speed and high-speed configuration
+ * descriptors once and records every interface and endpoint descriptor in a
+ * per-speed table. Class init code and the configure/speed dependent paths
+ * look interfaces and endpoint parameters up in the table instead of walking
+ * the descriptors again. One instance per USB controller, found by the stack
+ * handle. The ROM stack headers pull in app_usbd_cfg.h, so the module is
+ * built with the application, not the chip library.
+ * @{
+ */
+
+/** Number of USB controllers that can be indexed at the same time */
+#define USBD_DESCIDX_MAX_INST   2
+/** Max number of interfaces per configuration */
+#define USBD_DESCIDX_MAX_INTF   8
+/** Max number of endpoint descriptors per configuration, all alternate settings */
+#define USBD_DESCIDX_MAX_EP     16
+
+/**
+ * @brief Indexed interface
+ */
+typedef struct {
+	USB_INTERFACE_DESCRIPTOR *pIntf;	/*!< Descriptor of alternate setting 0 */
+	uint8_t ep_first;					/*!< Index of its first endpoint in ep[] */
+	uint8_t ep_num;						/*!< Endpoints of all its alternate settings */
+} USBDESCIDX_INTF_T;
+
+/**
+ * @brief Index of one configuration descriptor
+ */
+typedef struct {
+	uint8_t num_intf;									/*!< Entries used in intf[] */
+	uint8_t num_ep;										/*!< Entries used in ep[] */
+	USBDESCIDX_INTF_T intf[USBD_DESCIDX_MAX_INTF];		/*!< Interfaces in descriptor order */
+	USB_ENDPOINT_DESCRIPTOR *ep[USBD_DESCIDX_MAX_EP];	/*!< Endpoints in descriptor order */
+} USBDESCIDX_SPEED_T;
+
+/**
+ * @brief Descriptor index instance, one per USB controller
+ */
+typedef struct {
+	USBD_HANDLE_T hUsb;				/*!< Indexed USB stack handle */
+	USBDESCIDX_SPEED_T speed[2];	/*!< Tables indexed by USB_FULL_SPEED/USB_HIGH_SPEED */
+} USBDESCIDX_T;
+
+/**
+ * @brief	Build the descriptor index of a USB stack instance
+ * @param	pIdx	: Pointer to instance, must stay valid while the stack runs
+ * @param	hUsb	: Handle returned by USBD_API->hw->Init()
+ * @param	pDesc	: Descriptors passed to USBD_API->hw->Init()
+ * @return	LPC_OK on success, or ERR_FAILED when USBD_DESCIDX_MAX_INST
+ *			controllers are already indexed or a configuration has more
+ *			interfaces or endpoints than the table holds.
+ * @note	Call right after hw->Init() and before any class init.
+ */
+ErrorCode_t UsbDescIdx_Build(USBDESCIDX_T *pIdx, USBD_HANDLE_T hUsb, const USB_CORE_DESCS_T *pDesc);
+
+/**
+ * @brief	Find the first interface of a class
+ * @param	hUsb		: Handle of an indexed USB stack
+ * @param	speed		: USB_FULL_SPEED or USB_HIGH_SPEED configuration
+ * @param	intfClass	: bInterfaceClass to look for
+ * @return	Interface descriptor, alternate setting 0, or NULL if not found.
+ */
+USB_INTERFACE_DESCRIPTOR *UsbDescIdx_FindIntf(USBD_HANDLE_T hUsb, uint32_t speed, uint32_t intfClass);
+
+/**
+ * @brief	Find an interface by number
+ * @param	hUsb		: Handle of an indexed USB stack
+ * @param	speed		: USB_FULL_SPEED or USB_HIGH_SPEED configuration
+ * @param	intfNum		: bInterfaceNumber to look for
+ * @return	Interface descriptor, alternate setting 0, or NULL if not found.
+ */
+USB_INTERFACE_DESCRIPTOR *UsbDescIdx_FindIntfNum(USBD_HANDLE_T hUsb, uint32_t speed, uint32_t intfNum);
+
+/**
+ * @brief	Find an endpoint descriptor
+ * @param	hUsb	: Handle of an indexed USB stack
+ * @param	speed	: USB_FULL_SPEED or USB_HIGH_SPEED configuration
+ * @param	epAddr	: bEndpointAddress to look for
+ * @return	First descriptor of the endpoint, or NULL if not found.
+ */
+USB_ENDPOINT_DESCRIPTOR *UsbDescIdx_FindEp(USBD_HANDLE_T hUsb, uint32_t speed, uint32_t epAddr);
+
+/**
+ * @brief	Packet size of an endpoint at the negotiated speed
+ * @param	hUsb	: Handle of an indexed USB stack
+ * @param	epAddr	: bEndpointAddress to look for
+ * @return	wMaxPacketSize bits 10:0 of the endpoint in the configuration of
+ *			the current device speed, 0 if the endpoint is not found.
+ */
+uint32_t UsbDescIdx_GetMaxPacket(USBD_HANDLE_T hUsb, uint32_t epAddr);
+
+/**
+ * @}
+ */
+
+#endif /* __USBD_DESCIDX_H_ */
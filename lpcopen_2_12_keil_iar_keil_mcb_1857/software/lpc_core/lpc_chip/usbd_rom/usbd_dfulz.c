@@ -0,0 +1,281 @@
+/*
+ * @brief Block compressed DFU image decoder
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include <string.h>
+#include "usbd_dfulz.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Parser states */
+enum {
+	DFULZ_ST_HDR,				/* Collecting the container header */
+	DFULZ_ST_REC,				/* Collecting a record length word */
+	DFULZ_ST_BLK,				/* Collecting record data */
+	DFULZ_ST_DONE,				/* Image complete and verified */
+	DFULZ_ST_ERROR				/* Stream rejected */
+};
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Read an LZ4 length extension, returns false past the end of the input */
+static bool DfuLz_ExtLen(const uint8_t **pp, const uint8_t *pEnd, uint32_t *pLen)
+{
+	uint32_t b;
+
+	do {
+		if (*pp >= pEnd) {
+			return false;
+		}
+		b = *(*pp)++;
+		*pLen += b;
+	} while (b == 255);
+
+	return true;
+}
+
+/* Expand one LZ4 block, returns the decoded size or DFULZ_ERR */
+static int32_t DfuLz_Expand(const uint8_t *pSrc, uint32_t srcLen, uint8_t *pDst, uint32_t dstLen)
+{
+	const uint8_t *ip = pSrc, *iend = pSrc + srcLen, *m;
+	uint8_t *op = pDst, *oend = pDst + dstLen;
+	uint32_t token, len, off;
+
+	while (ip < iend) {
+		token = *ip++;
+
+		/* Literals */
+		len = token >> 4;
+		if ((len == 15) && (DfuLz_ExtLen(&ip, iend, &len) == false)) {
+			return DFULZ_ERR;
+		}
+		if ((len > (uint32_t) (iend - ip)) || (len > (uint32_t) (oend - op))) {
+			return DFULZ_ERR;
+		}
+		memcpy(op, ip, len);
+		op += len;
+		ip += len;
+
+		/* The last sequence has no match */
+		if (ip == iend) {
+			break;
+		}
+
+		/* Match, only within this block */
+		if ((iend - ip) < 2) {
+			return DFULZ_ERR;
+		}
+		off = ip[0] | ((uint32_t) ip[1] << 8);
+		ip += 2;
+		if ((off == 0) || (off > (uint32_t) (op - pDst))) {
+			return DFULZ_ERR;
+		}
+		len = (token & 0x0F) + 4;
+		if (((token & 0x0F) == 15) && (DfuLz_ExtLen(&ip, iend, &len) == false)) {
+			return DFULZ_ERR;
+		}
+		if (len > (uint32_t) (oend - op)) {
+			return DFULZ_ERR;
+		}
+		m = op - off;
+		if (off >= len) {
+			memcpy(op, m, len);
+			op += len;
+		}
+		else {
+			/* Overlapping match repeats the last off bytes */
+			while (len--) {
+				*op++ = *m++;
+			}
+		}
+	}
+
+	return (int32_t) (op - pDst);
+}
+
+/* Stage up to need bytes of an item, returns true once it is complete */
+static bool DfuLz_Stage(DFULZ_T *pLz, const uint8_t **ppIn, uint32_t *pLen, uint32_t need)
+{
+	uint32_t take = need - pLz->fill;
+
+	if (take > *pLen) {
+		take = *pLen;
+	}
+	memcpy((uint8_t *) pLz->stage + pLz->fill, *ppIn, take);
+	pLz->fill += take;
+	*ppIn += take;
+	*pLen -= take;
+
+	return (bool) (pLz->fill == need);
+}
+
+/* Image bytes in the current block */
+static uint32_t DfuLz_BlkBytes(const DFULZ_T *pLz)
+{
+	uint32_t left = pLz->hdr.raw_size - pLz->raw_done;
+
+	return (left < pLz->hdr.blk_size) ? left : pLz->hdr.blk_size;
+}
+
+/* Account for a decoded block, checks the CRC after the last one */
+static int32_t DfuLz_BlkDone(DFULZ_T *pLz, uint8_t *pOut, uint32_t n)
+{
+	pLz->crc = Chip_CRCSW_CRC32(pLz->crc, pOut, n);
+	pLz->raw_done += n;
+	pLz->fill = 0;
+
+	if (pLz->raw_done < pLz->hdr.raw_size) {
+		pLz->state = DFULZ_ST_REC;
+	}
+	else if (pLz->crc == pLz->hdr.raw_crc) {
+		pLz->state = DFULZ_ST_DONE;
+	}
+	else {
+		pLz->state = DFULZ_ST_ERROR;
+		return DFULZ_ERR;
+	}
+
+	return (int32_t) n;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Start decoding a new container */
+void DfuLz_Init(DFULZ_T *pLz, uint32_t maxRaw)
+{
+	pLz->max_raw = maxRaw;
+	pLz->state = DFULZ_ST_HDR;
+	pLz->fill = 0;
+	pLz->raw_done = 0;
+	pLz->crc = 0;
+	/* the blocks are decoded from the USB interrupt */
+	Chip_CRCSW_Init();
+}
+
+/* Decode the next part of a container */
+int32_t DfuLz_Feed(DFULZ_T *pLz, const uint8_t **ppIn, uint32_t *pLen, uint8_t *pOut)
+{
+	const uint8_t *pSrc;
+	uint32_t need, dlen;
+	int32_t n;
+
+	while (*pLen != 0) {
+		switch (pLz->state) {
+		case DFULZ_ST_HDR:
+			if (DfuLz_Stage(pLz, ppIn, pLen, sizeof(DFULZ_HDR_T)) == false) {
+				return 0;
+			}
+			memcpy(&pLz->hdr, pLz->stage, sizeof(DFULZ_HDR_T));
+			pLz->fill = 0;
+			if ((pLz->hdr.magic != DFULZ_MAGIC) || (pLz->hdr.raw_size > pLz->max_raw) ||
+				(pLz->hdr.blk_size == 0) || (pLz->hdr.blk_size > DFULZ_MAX_BLOCK)) {
+				pLz->state = DFULZ_ST_ERROR;
+				return DFULZ_ERR;
+			}
+			if (pLz->hdr.raw_size == 0) {
+				return DfuLz_BlkDone(pLz, pOut, 0);
+			}
+			pLz->state = DFULZ_ST_REC;
+			break;
+
+		case DFULZ_ST_REC:
+			if (DfuLz_Stage(pLz, ppIn, pLen, sizeof(uint32_t)) == false) {
+				return 0;
+			}
+			pLz->rec_len = pLz->stage[0];
+			pLz->fill = 0;
+			need = pLz->rec_len & ~DFULZ_BLK_STORED;
+			if ((need == 0) || (need > DfuLz_BlkBytes(pLz)) ||
+				((pLz->rec_len & DFULZ_BLK_STORED) && (need != DfuLz_BlkBytes(pLz)))) {
+				pLz->state = DFULZ_ST_ERROR;
+				return DFULZ_ERR;
+			}
+			pLz->state = DFULZ_ST_BLK;
+			break;
+
+		case DFULZ_ST_BLK:
+			need = pLz->rec_len & ~DFULZ_BLK_STORED;
+			if ((pLz->fill == 0) && (*pLen >= need)) {
+				/* Whole record in this transfer, decode in place */
+				pSrc = *ppIn;
+				*ppIn += need;
+				*pLen -= need;
+			}
+			else if (DfuLz_Stage(pLz, ppIn, pLen, need)) {
+				pSrc = (const uint8_t *) pLz->stage;
+			}
+			else {
+				return 0;
+			}
+
+			dlen = DfuLz_BlkBytes(pLz);
+			if (pLz->rec_len & DFULZ_BLK_STORED) {
+				memcpy(pOut, pSrc, need);
+				n = (int32_t) need;
+			}
+			else {
+				n = DfuLz_Expand(pSrc, need, pOut, dlen);
+			}
+			if (n != (int32_t) dlen) {
+				pLz->state = DFULZ_ST_ERROR;
+				return DFULZ_ERR;
+			}
+			return DfuLz_BlkDone(pLz, pOut, dlen);
+
+		case DFULZ_ST_DONE:
+			/* Padding after the last block */
+			*ppIn += *pLen;
+			*pLen = 0;
+			break;
+
+		default:
+			return DFULZ_ERR;
+		}
+	}
+
+	return (pLz->state == DFULZ_ST_ERROR) ? DFULZ_ERR : 0;
+}
+
+/* Check whether the whole image was decoded and its CRC matched */
+bool DfuLz_IsDone(const DFULZ_T *pLz)
+{
+	return (bool) (pLz->state == DFULZ_ST_DONE);
+}
@@ -0,0 +1,136 @@
+/*
+ * @brief Block compressed DFU image decoder
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2012
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __USBD_DFULZ_H_
+#define __USBD_DFULZ_H_
+
+#include "lpc_types.h"
+
+/** @defgroup USBD_DFULz USBD: Compressed DFU image decoder
+ * @ingroup Group_USBD
+ * Decodes a block compressed firmware image while it is being downloaded,
+ * so a DFU transfer only carries the compressed bytes. The container is a
+ * DFULZ_HDR_T followed by one record per block of hdr.blk_size image bytes
+ * (the last block may be shorter). A record is a 32-bit little endian
+ * length word and that many bytes of either an LZ4 block (without frame)
+ * or, with DFULZ_BLK_STORED set, the image bytes themselves. Blocks are
+ * independent, so the decoder only keeps one block of input staged when a
+ * record straddles two DFU transfers. The CRC-32 (as zlib) of the decoded
+ * image is checked after the last block.
+ * pctools/dfu_lzpack.c in the dfuutil examples builds containers.
+ * @{
+ */
+
+/** Container magic, "DFLZ" in memory */
+#define DFULZ_MAGIC         0x5A4C4644
+
+/** Largest image block, and the size of the decoder staging buffer */
+#ifndef DFULZ_MAX_BLOCK
+#define DFULZ_MAX_BLOCK     4096
+#endif
+
+/** Record length word flag: the record holds the block uncompressed */
+#define DFULZ_BLK_STORED    0x80000000
+
+/** DfuLz_Feed() return value on a malformed stream or a CRC mismatch */
+#define DFULZ_ERR           (-1)
+
+/**
+ * @brief Container header, at the start of the compressed stream
+ */
+typedef struct {
+	uint32_t magic;				/*!< DFULZ_MAGIC */
+	uint32_t raw_size;			/*!< Decoded image size in bytes */
+	uint32_t raw_crc;			/*!< CRC-32 of the decoded image */
+	uint32_t blk_size;			/*!< Image bytes per block, up to DFULZ_MAX_BLOCK */
+} DFULZ_HDR_T;
+
+/**
+ * @brief Decoder instance, one per download
+ */
+typedef struct {
+	DFULZ_HDR_T hdr;			/*!< Container header once parsed */
+	uint32_t max_raw;			/*!< Largest image accepted */
+	uint32_t state;				/*!< Parser state */
+	uint32_t rec_len;			/*!< Length word of the current record */
+	uint32_t fill;				/*!< Bytes of the current item staged */
+	uint32_t raw_done;			/*!< Image bytes decoded so far */
+	uint32_t crc;				/*!< CRC-32 of the decoded bytes so far */
+	uint32_t stage[DFULZ_MAX_BLOCK / sizeof(uint32_t)];	/*!< Straddling record bytes */
+} DFULZ_T;
+
+/**
+ * @brief	Start decoding a new container
+ * @param	pLz		: Pointer to decoder instance
+ * @param	maxRaw	: Largest decoded image accepted, larger ones are an error
+ * @return	Nothing
+ */
+void DfuLz_Init(DFULZ_T *pLz, uint32_t maxRaw);
+
+/**
+ * @brief	Decode the next part of a container
+ * @param	pLz		: Pointer to decoder instance
+ * @param	ppIn	: Pointer to the input pointer, advanced over the bytes consumed
+ * @param	pLen	: Pointer to the input length, reduced by the bytes consumed
+ * @param	pOut	: Buffer for one decoded block, at least hdr.blk_size bytes
+ *					  (DFULZ_MAX_BLOCK when the header is not parsed yet)
+ * @return	Number of image bytes placed in pOut, 0 when all the input was
+ *			consumed without completing a block, or DFULZ_ERR
+ * @note	Consumes input up to the end of at most one block, so call it until
+ *			*pLen is 0 and write each block out at offset raw_done minus the
+ *			returned size. The call that completes the image also checks the
+ *			CRC and returns DFULZ_ERR on a mismatch. Bytes after the last
+ *			block are ignored, so a padded download is accepted.
+ */
+int32_t DfuLz_Feed(DFULZ_T *pLz, const uint8_t **ppIn, uint32_t *pLen, uint8_t *pOut);
+
+/**
+ * @brief	Check whether a buffer starts with a container header
+ * @param	pData	: Pointer to at least 4 bytes, word aligned
+ * @return	true if the data starts with DFULZ_MAGIC
+ */
+STATIC INLINE bool DfuLz_IsContainer(const void *pData)
+{
+	return (bool) (*(const uint32_t *) pData == DFULZ_MAGIC);
+}
+
+/**
+ * @brief	Check whether the whole image was decoded and its CRC matched
+ * @param	pLz		: Pointer to decoder instance
+ * @return	true once the image is complete and verified
+ */
+bool DfuLz_IsDone(const DFULZ_T *pLz);
+
+/**
+ * @}
+ */
+
+#endif /* __USBD_DFULZ_H_ */
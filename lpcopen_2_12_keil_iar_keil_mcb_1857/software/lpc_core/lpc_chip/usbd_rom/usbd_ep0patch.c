@@ -0,0 +1,143 @@
+/*
+ * @brief USB ROM stack EP0 NAK workaround (artf45032)
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#include "chip.h"
+#include "usbd_ep0patch.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Installed instances, looked up by handle from the shared EP0 handler */
+static USBEP0PATCH_T *g_ep0Patch[USBD_EP0PATCH_MAX_INST];
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Find the instance of a patched USB stack */
+static USBEP0PATCH_T *UsbEp0Patch_Get(USBD_HANDLE_T hUsb)
+{
+	uint32_t i;
+
+	for (i = 0; i < USBD_EP0PATCH_MAX_INST; i++) {
+		if ((g_ep0Patch[i] != NULL) && (g_ep0Patch[i]->hUsb == hUsb)) {
+			return g_ep0Patch[i];
+		}
+	}
+	return NULL;
+}
+
+/* EP0 OUT handler in front of the ROM one */
+static ErrorCode_t UsbEp0Patch_Hdlr(USBD_HANDLE_T hUsb, void *data, uint32_t event)
+{
+	USBEP0PATCH_T *pPatch = UsbEp0Patch_Get(hUsb);
+	ErrorCode_t ret;
+	uint32_t start, cyc;
+
+	switch (event) {
+	case USB_EVT_OUT_NAK:
+		pPatch->nak_cnt++;
+		if (pPatch->rx_busy) {
+			/* we already queued the buffer so ignore this NAK event. */
+			pPatch->nak_nested++;
+			return LPC_OK;
+		}
+		else {
+			/* Mark EP0_RX buffer as busy and allow base handler to queue the buffer. */
+			pPatch->rx_busy = 1;
+		}
+		break;
+
+	case USB_EVT_SETUP:	/* reset the flag when new setup sequence starts */
+	case USB_EVT_OUT:
+		/* we received the packet so clear the flag. */
+		pPatch->rx_busy = 0;
+		break;
+	}
+
+	/* class request callbacks run from here, so this covers them too */
+	start = DWT->CYCCNT;
+	ret = pPatch->base_hdlr(hUsb, data, event);
+	cyc = DWT->CYCCNT - start;
+	if (cyc > pPatch->cyc_max) {
+		pPatch->cyc_max = cyc;
+		pPatch->cyc_max_evt = event;
+	}
+
+	return ret;
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Install EP0 patch on a USB stack instance */
+ErrorCode_t UsbEp0Patch_Install(USBEP0PATCH_T *pPatch, USBD_HANDLE_T hUsb)
+{
+	USB_CORE_CTRL_T *pCtrl = (USB_CORE_CTRL_T *) hUsb;	/* convert the handle to control structure */
+	uint32_t i;
+
+	for (i = 0; i < USBD_EP0PATCH_MAX_INST; i++) {
+		if ((g_ep0Patch[i] == NULL) || (g_ep0Patch[i] == pPatch)) {
+			break;
+		}
+	}
+	if (i == USBD_EP0PATCH_MAX_INST) {
+		return ERR_FAILED;
+	}
+
+	/* free running, only differences are used */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	pPatch->hUsb = hUsb;
+	pPatch->rx_busy = 0;
+	UsbEp0Patch_ClearStats(pPatch);
+	pPatch->base_hdlr = pCtrl->ep_event_hdlr[0];	/* retrieve the default EP0_OUT handler */
+	g_ep0Patch[i] = pPatch;
+	pCtrl->ep_event_hdlr[0] = UsbEp0Patch_Hdlr;	/* set our patch routine as EP0_OUT handler */
+
+	return LPC_OK;
+}
+
+/* Clear statistics of an EP0 patch instance */
+void UsbEp0Patch_ClearStats(USBEP0PATCH_T *pPatch)
+{
+	pPatch->nak_cnt = 0;
+	pPatch->nak_nested = 0;
+	pPatch->cyc_max = 0;
+	pPatch->cyc_max_evt = 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * @brief USB ROM stack EP0 NAK workaround (artf45032)
+ *
+ * @note
+ * Copyright(C) NXP Semiconductors, 2013
+ * All rights reserved.
+ *
+ * @par
+ * Software that is described herein is for illustrative purposes only
+ * which provides customers with programming information regarding the
+ * LPC products.  This software is supplied "AS IS" without any warranties of
+ * any kind, and NXP Semiconductors and its licensor disclaim any and
+ * all warranties, express or implied, including all implied warranties of
+ * merchantability, fitness for a particular purpose and non-infringement of
+ * intellectual property rights.  NXP Semiconductors assumes no responsibility
+ * or liability for the use of the software, conveys no license or rights under any
+ * patent, copyright, mask work right, or any other intellectual property rights in
+ * or to any products. NXP Semiconductors reserves the right to make changes
+ * in the software without notification. NXP Semiconductors also makes no
+ * representation or warranty that such application will be suitable for the
+ * specified use without further testing or modification.
+ *
+ * @par
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, under NXP Semiconductors' and its
+ * licensor's relevant copyrights in the software, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ */
+
+#ifndef __USBD_EP0PATCH_H_
+#define __USBD_EP0PATCH_H_
+
+#include "usbd_rom_api.h"
+
+/** @defgroup USBD_EP0Patch USBD: Shared EP0 NAK workaround
+ * @ingroup Group_USBD
+ * WORKAROUND for artf45032 ROM driver BUG:
+ * Due to a race condition there is the chance that a second NAK event will
+ * occur before the default endpoint0 handler has completed its preparation
+ * of the DMA engine for the first NAK event. This can cause certain fields
+ * in the DMA descriptors to be in an invalid state when the USB controller
+ * reads them, thereby causing a hang.
+ *
+ * UsbEp0Patch_Install() puts a filter in front of the ROM EP0 OUT handler
+ * that drops nested NAK events. One instance per USB controller; it also
+ * counts the dropped events and records the worst-case EP0 handler time in
+ * DWT core cycles, so control transfer heavy applications can be profiled.
+ * The ROM stack headers pull in app_usbd_cfg.h, so the module is built with
+ * the application, not the chip library.
+ * @{
+ */
+
+/** Number of USB controllers that can be patched at the same time */
+#define USBD_EP0PATCH_MAX_INST  2
+
+/**
+ * @brief EP0 patch instance, one per USB controller
+ */
+typedef struct {
+	USBD_HANDLE_T hUsb;				/*!< Patched USB stack handle */
+	USB_EP_HANDLER_T base_hdlr;		/*!< ROM EP0 OUT handler called by the patch */
+	volatile uint32_t rx_busy;		/*!< EP0 OUT/RX buffer is queued */
+	uint32_t nak_cnt;				/*!< EP0 OUT NAK events seen */
+	uint32_t nak_nested;			/*!< Nested NAK events suppressed */
+	uint32_t cyc_max;				/*!< Worst-case ROM EP0 handler time in core cycles */
+	uint32_t cyc_max_evt;			/*!< USB_EVT_xxx of the worst-case call */
+} USBEP0PATCH_T;
+
+/**
+ * @brief	Install the EP0 patch on a USB stack instance
+ * @param	pPatch	: Pointer to instance, must stay valid while the stack runs
+ * @param	hUsb	: Handle returned by USBD_API->hw->Init()
+ * @return	LPC_OK on success, or ERR_FAILED when USBD_EP0PATCH_MAX_INST
+ *			controllers are already patched.
+ * @note	Call right after hw->Init() and before the controller is
+ *			connected. Also starts the DWT cycle counter.
+ */
+ErrorCode_t UsbEp0Patch_Install(USBEP0PATCH_T *pPatch, USBD_HANDLE_T hUsb);
+
+/**
+ * @brief	Clear the NAK counters and worst-case latency of an instance
+ * @param	pPatch	: Pointer to instance
+ * @return	Nothing
+ */
+void UsbEp0Patch_ClearStats(USBEP0PATCH_T *pPatch);
+
+/**
+ * @}
+ */
+
+#endif /* __USBD_EP0PATCH_H_ */